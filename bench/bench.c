@@ -0,0 +1,820 @@
+/*
+ * Micro-benchmarks of the DSP and decode hot paths
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "baseband.h"
+#include "pulse_detect.h"
+#include "pulse_data.h"
+#include "pulse_slicer.h"
+#include "r_device.h"
+#include "bitbuffer.h"
+#include "bit_util.h"
+#include "data.h"
+#include "list.h"
+#include "output_file.h"
+#include "output_binary.h"
+#include "output_arrow.h"
+#include "output_log.h"
+#include "output_influx.h"
+#include "output_mqtt.h"
+#include "mongoose.h"
+#include "r_api.h"
+#include "r_private.h"
+#include "compat_time.h"
+#include "logger.h"
+#include "fatal.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define SAMPLE_RATE 250000
+/// Samples of the synthetic input, about 4 seconds.
+#define SYNTH_SAMPLES (1 << 20)
+/// Operations of each run of the per-op benchmarks.
+#define BENCH_OPS 100000
+/// Calls of each run of the slicer benchmarks.
+#define SLICER_OPS 2000
+/// Calls of each run of the decoder benchmark.
+#define DECODER_OPS 200
+/// Iterations of each run of the calibration loop.
+#define CALIBRATION_OPS 4000000
+/// Name filters of the benchmarks to run.
+#define MAX_FILTERS 8
+
+static int repeats = 5;
+static char const *filters[MAX_FILTERS];
+static int num_filters;
+static double calibration; ///< ns per iteration of the calibration loop, the results are relative to it
+static list_t results;
+static volatile uint32_t sink; ///< keeps the results of the benchmarked calls alive
+
+#ifdef __GLIBC__
+/*
+    Count the allocations of the whole process, glibc lets the program interpose malloc(),
+    calloc(), and realloc(), these call the glibc implementations. The benchmarks run on one thread.
+*/
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long allocs;
+
+void *malloc(size_t size)
+{
+    allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    allocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+static unsigned long bench_allocs(void)
+{
+    return allocs;
+}
+#else
+// without glibc only the allocations of data_t are counted
+static unsigned long bench_allocs(void)
+{
+    return data_alloc_count();
+}
+#endif
+
+/// Record the best time of a benchmark in ns per sample or per operation, and the allocations likewise.
+static void bench_report(char const *name, char const *unit, uint64_t best_ns, unsigned long ops, unsigned long run_allocs)
+{
+    double value    = (double)best_ns / ops;
+    double relative = value / calibration;
+    double allocs_per_op = (double)run_allocs / repeats / ops;
+    fprintf(stderr, "%-40s %10.2f %-9s %10.4f %8.3g allocs\n", name, value, unit, relative, allocs_per_op);
+    list_push(&results, data_make(
+            "name",     "", DATA_STRING, name,
+            "unit",     "", DATA_STRING, unit,
+            "value",    "", DATA_FORMAT, "%.3f", DATA_DOUBLE, value,
+            "relative", "", DATA_FORMAT, "%.4f", DATA_DOUBLE, relative,
+            "allocs",   "", DATA_FORMAT, "%.4g", DATA_DOUBLE, allocs_per_op,
+            "ops",      "", DATA_INT, (int)ops,
+            "best_ns",  "", DATA_DOUBLE, (double)best_ns,
+            NULL));
+}
+
+// a benchmark runs if there are no filters or the name contains one of them
+static int bench_match(char const *name)
+{
+    for (int i = 0; i < num_filters; ++i) {
+        if (strstr(name, filters[i]))
+            return 1;
+    }
+    return !num_filters;
+}
+
+/// Run a block repeats times and set the time of the fastest run.
+#define BENCH_BEST(best_ns, ...)                                        \
+    do {                                                                \
+        best_ns = UINT64_MAX;                                           \
+        for (int run_ = 0; run_ < repeats; ++run_) {                    \
+            uint64_t start_ns = time_monotonic_ns();                    \
+            __VA_ARGS__;                                                \
+            uint64_t elapsed_ns = time_monotonic_ns() - start_ns;       \
+            if (elapsed_ns < best_ns)                                   \
+                best_ns = elapsed_ns;                                   \
+        }                                                               \
+    } while (0)
+
+/// Run a block repeats times and report the fastest run, skipped if the name does not match the filters.
+#define BENCH(name, unit, ops, ...)                                            \
+    do {                                                                       \
+        if (!bench_match(name))                                                \
+            break;                                                             \
+        uint64_t best_ns;                                                      \
+        unsigned long allocs_start = bench_allocs();                           \
+        BENCH_BEST(best_ns, __VA_ARGS__);                                      \
+        bench_report(name, unit, best_ns, ops, bench_allocs() - allocs_start); \
+    } while (0)
+
+// xorshift32, the synthetic input is the same on every run
+static uint32_t rand_state = 0x2545f491;
+
+static uint32_t bench_rand(void)
+{
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+/** A dependent chain of integer and float operations to calibrate the timings.
+
+    Its time scales with the clock speed and the core like the benchmarked code, the results relative
+    to it compare between machines and runs better than the plain times.
+*/
+static uint32_t calibration_loop(unsigned ops)
+{
+    uint32_t x = 0x2545f491;
+    float f    = 0.0f;
+    for (unsigned k = 0; k < ops; ++k) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        f = f * 0.5f + (float)(x & 0xff);
+    }
+    return x + (uint32_t)f;
+}
+
+static void bench_calibration(void)
+{
+    uint64_t best_ns;
+    BENCH_BEST(best_ns, sink += calibration_loop(CALIBRATION_OPS));
+    calibration = (double)best_ns / CALIBRATION_OPS;
+    bench_report("calibration", "ns/op", best_ns, CALIBRATION_OPS, 0);
+}
+
+/** Synthesize CU8 input with an OOK PWM package every 500 ms on a 10 kHz offset carrier and noise.
+
+    A package is 4 rows of 40 bits, a 1 is a 500 us pulse and a 1000 us gap, a 0 is a 1000 us pulse
+    and a 500 us gap, the rows are 4 ms apart.
+*/
+static void synth_cu8(uint8_t *buf, unsigned n_samples)
+{
+    uint8_t row[5];
+    for (unsigned i = 0; i < sizeof(row); ++i) {
+        row[i] = (uint8_t)bench_rand();
+    }
+    unsigned const package_len = SAMPLE_RATE / 2;
+    unsigned const short_len   = SAMPLE_RATE / 2000;
+    unsigned const row_gap     = SAMPLE_RATE / 250;
+    double const dphi          = 2.0 * M_PI * 10000.0 / SAMPLE_RATE;
+
+    for (unsigned s = 0; s < n_samples; ++s) {
+        // find the level of this sample in the package
+        unsigned t  = s % package_len;
+        int on      = 0;
+        unsigned r0 = 0;
+        for (unsigned r = 0; r < 4 && !on; ++r) {
+            unsigned p = r0;
+            for (unsigned b = 0; b < 40; ++b) {
+                int one     = (row[b / 8] >> (7 - b % 8)) & 1;
+                unsigned hi = one ? short_len : 2 * short_len;
+                if (t >= p && t < p + hi)
+                    on = 1;
+                p += 3 * short_len;
+            }
+            r0 = p + row_gap;
+        }
+        double amp = on ? 60.0 : 0.0;
+        double i_v = 127.5 + amp * cos(dphi * s) + (int)(bench_rand() % 9) - 4;
+        double q_v = 127.5 + amp * sin(dphi * s) + (int)(bench_rand() % 9) - 4;
+        buf[2 * s]     = (uint8_t)(i_v < 0 ? 0 : i_v > 255 ? 255 : i_v);
+        buf[2 * s + 1] = (uint8_t)(q_v < 0 ? 0 : q_v > 255 ? 255 : q_v);
+    }
+}
+
+// read a recorded CU8 file, returns the number of samples
+static unsigned read_cu8(char const *path, uint8_t *buf, unsigned max_samples)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        exit(1);
+    }
+    unsigned n_samples = (unsigned)(fread(buf, 2, max_samples, file));
+    fclose(file);
+    if (!n_samples) {
+        fprintf(stderr, "No samples in %s\n", path);
+        exit(1);
+    }
+    return n_samples;
+}
+
+static void bench_baseband(uint8_t const *cu8_buf, int16_t const *cs16_buf, unsigned n, uint16_t *u16_buf, int16_t *am_buf, int16_t *fm_buf)
+{
+    char name[64];
+    for (unsigned idx = 0; baseband_kernels_variant(idx); ++idx) {
+        baseband_kernels_t const *k = baseband_kernels_variant(idx);
+        snprintf(name, sizeof(name), "envelope_detect (%s)", k->name);
+        BENCH(name, "ns/sample", n, sink += k->envelope_detect(cu8_buf, u16_buf, n));
+        snprintf(name, sizeof(name), "magnitude_est_cu8 (%s)", k->name);
+        BENCH(name, "ns/sample", n, sink += k->magnitude_est_cu8(cu8_buf, u16_buf, n));
+        snprintf(name, sizeof(name), "magnitude_est_cs16 (%s)", k->name);
+        BENCH(name, "ns/sample", n, sink += k->magnitude_est_cs16(cs16_buf, u16_buf, n));
+        snprintf(name, sizeof(name), "demod_fm_phase_cu8 (%s)", k->name);
+        BENCH(name, "ns/sample", n, k->demod_fm_phase_cu8(cu8_buf, fm_buf, n));
+    }
+
+    envelope_detect(cu8_buf, u16_buf, n);
+    filter_state_t lp_state;
+    for (unsigned order = 1; order <= FILTER_MAX_ORDER; order += order == 1 ? 1 : 2) {
+        baseband_low_pass_filter_init(&lp_state, order);
+        snprintf(name, sizeof(name), "baseband_low_pass_filter (order %u)", order);
+        BENCH(name, "ns/sample", n, baseband_low_pass_filter(&lp_state, u16_buf, am_buf, n));
+    }
+
+    demodfm_state_t fm_state;
+    baseband_demod_FM_reset(&fm_state);
+    BENCH("baseband_demod_FM", "ns/sample", n, baseband_demod_FM(&fm_state, cu8_buf, fm_buf, n, SAMPLE_RATE, 0.1f));
+    baseband_demod_FM_reset(&fm_state);
+    BENCH("baseband_demod_FM_cs16", "ns/sample", n, baseband_demod_FM_cs16(&fm_state, cs16_buf, fm_buf, n, SAMPLE_RATE, 0.1f));
+
+    baseband_low_pass_filter_init(&lp_state, 1);
+    baseband_demod_FM_reset(&fm_state);
+    BENCH("baseband_demod_fused (cu8)", "ns/sample", n,
+            baseband_demod_fused(&lp_state, &fm_state, cu8_buf, BASEBAND_CU8, 0, am_buf, fm_buf, n, SAMPLE_RATE, 0.1f));
+    BENCH("baseband_demod_fused (mag cu8)", "ns/sample", n,
+            baseband_demod_fused(&lp_state, &fm_state, cu8_buf, BASEBAND_CU8, 1, am_buf, fm_buf, n, SAMPLE_RATE, 0.1f));
+    BENCH("baseband_demod_fused (cs16)", "ns/sample", n,
+            baseband_demod_fused(&lp_state, &fm_state, cs16_buf, BASEBAND_CS16, 1, am_buf, fm_buf, n, SAMPLE_RATE, 0.1f));
+}
+
+// detect all packages of the demodulated buffer, returns the number of packages
+static unsigned detect_packages(pulse_detect_t *pd, int16_t const *am_buf, int16_t const *fm_buf, unsigned n, pulse_data_t *pulses, pulse_data_t *fsk_pulses)
+{
+    unsigned packages = 0;
+    pulse_detect_reset(pd);
+    while (pulse_detect_package(pd, am_buf, fm_buf, (int)n, SAMPLE_RATE, 0, pulses, fsk_pulses, FSK_PULSE_DETECT_AUTO)) {
+        packages += 1;
+    }
+    return packages;
+}
+
+static void bench_pulse_detect(int16_t const *am_buf, int16_t const *fm_buf, unsigned n, pulse_data_t *first)
+{
+    pulse_detect_t *pd = pulse_detect_create();
+    if (!pd) {
+        FATAL("Failed to create the pulse detector");
+    }
+    pulse_detect_set_levels(pd, 0, 0.0f, -12.1442f, 9.0f, 0);
+    pulse_data_t pulses     = {0};
+    pulse_data_t fsk_pulses = {0};
+
+    unsigned packages = detect_packages(pd, am_buf, fm_buf, n, &pulses, &fsk_pulses);
+    fprintf(stderr, "%u packages in %u samples\n", packages, n);
+    BENCH("pulse_detect_package", "ns/sample", n, sink += detect_packages(pd, am_buf, fm_buf, n, &pulses, &fsk_pulses));
+
+    // keep the first OOK package for the slicers
+    pulse_detect_reset(pd);
+    while (pulse_detect_package(pd, am_buf, fm_buf, (int)n, SAMPLE_RATE, 0, first, &fsk_pulses, FSK_PULSE_DETECT_AUTO) == PULSE_DATA_FSK) {
+        // skip FSK packages
+    }
+    pulse_data_free(&pulses);
+    pulse_data_free(&fsk_pulses);
+    pulse_detect_free(pd);
+}
+
+// a decoder that sees the bits and rejects them, only the slicer is timed
+static int bench_decode(r_device *decoder, bitbuffer_t *bitbuffer)
+{
+    (void)decoder;
+    sink += bitbuffer->num_rows;
+    return DECODE_ABORT_EARLY;
+}
+
+static void bench_slicers(pulse_data_t const *pulses)
+{
+    static struct {
+        char const *name;
+        int (*slicer)(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
+        float short_width, long_width, reset_limit, gap_limit, sync_width;
+    } const slicers[] = {
+            {"pulse_slicer_pcm", pulse_slicer_pcm, 500, 500, 5000, 0, 0},
+            {"pulse_slicer_ppm", pulse_slicer_ppm, 500, 1000, 5000, 2000, 0},
+            {"pulse_slicer_pwm", pulse_slicer_pwm, 500, 1000, 5000, 2000, 0},
+            {"pulse_slicer_manchester_zerobit", pulse_slicer_manchester_zerobit, 500, 0, 5000, 0, 0},
+            {"pulse_slicer_dmc", pulse_slicer_dmc, 500, 1000, 5000, 0, 0},
+            {"pulse_slicer_piwm_raw", pulse_slicer_piwm_raw, 500, 1000, 5000, 0, 0},
+            {"pulse_slicer_piwm_dc", pulse_slicer_piwm_dc, 500, 1000, 5000, 0, 0},
+            {"pulse_slicer_nrzs", pulse_slicer_nrzs, 500, 500, 5000, 0, 0},
+            {"pulse_slicer_osv1", pulse_slicer_osv1, 500, 1000, 5000, 0, 2000},
+    };
+    if (!pulses->num_pulses) {
+        fprintf(stderr, "No package for the slicers\n");
+        return;
+    }
+    fprintf(stderr, "%u pulses in the package for the slicers\n", pulses->num_pulses);
+
+    static bitbuffer_t bits;
+    for (size_t i = 0; i < sizeof(slicers) / sizeof(*slicers); ++i) {
+        r_device device    = {0};
+        device.name        = slicers[i].name;
+        device.short_width = slicers[i].short_width;
+        device.long_width  = slicers[i].long_width;
+        device.reset_limit = slicers[i].reset_limit;
+        device.gap_limit   = slicers[i].gap_limit;
+        device.sync_width  = slicers[i].sync_width;
+        device.tolerance   = 200;
+        device.decode_fn   = bench_decode;
+        BENCH(slicers[i].name, "ns/op", SLICER_OPS,
+                for (int k = 0; k < SLICER_OPS; ++k) {
+                    sink += slicers[i].slicer(pulses, &device, &bits);
+                });
+    }
+}
+
+// decode the demodulated buffer like rtl_433, returns the number of events
+static unsigned decode_packages(struct dm_state *demod, int16_t const *am_buf, int16_t const *fm_buf, unsigned n)
+{
+    unsigned events = 0;
+    int package_type;
+    pulse_detect_reset(demod->pulse_detect);
+    while ((package_type = pulse_detect_package(demod->pulse_detect, am_buf, fm_buf, (int)n, SAMPLE_RATE, 0,
+                    &demod->pulse_data, &demod->fsk_pulse_data, FSK_PULSE_DETECT_AUTO))) {
+        if (package_type == PULSE_DATA_OOK)
+            events += run_ook_demods(&demod->ook_devs, &demod->pulse_data, &demod->slicer_cache, NULL);
+        else
+            events += run_fsk_demods(&demod->fsk_devs, &demod->fsk_pulse_data, &demod->slicer_cache, NULL);
+    }
+    return events;
+}
+
+// all default decoders on a package, and the whole decoding of the input
+static void bench_decoders(uint8_t const *cu8_buf, unsigned n, int16_t *am_buf, int16_t *fm_buf, pulse_data_t *first)
+{
+    r_cfg_t *cfg = r_create_cfg();
+    register_all_protocols(cfg, 0);
+    struct dm_state *demod = cfg->demod;
+    pulse_detect_set_levels(demod->pulse_detect, 0, 0.0f, -12.1442f, 9.0f, 0);
+
+    if (first->num_pulses) {
+        BENCH("run_ook_demods (default decoders)", "ns/op", DECODER_OPS,
+                for (int k = 0; k < DECODER_OPS; ++k) {
+                    sink += run_ook_demods(&demod->ook_devs, first, &demod->slicer_cache, NULL);
+                });
+    }
+
+    filter_state_t lp_state;
+    demodfm_state_t fm_state;
+    baseband_low_pass_filter_init(&lp_state, 1);
+    baseband_demod_FM_reset(&fm_state);
+    BENCH("decode pipeline (default decoders)", "ns/sample", n,
+            baseband_demod_fused(&lp_state, &fm_state, cu8_buf, BASEBAND_CU8, 0, am_buf, fm_buf, n, SAMPLE_RATE, 0.1f);
+            sink += decode_packages(demod, am_buf, fm_buf, n));
+
+    r_free_cfg(cfg);
+}
+
+static void bench_bits(void)
+{
+    uint8_t msg[16];
+    for (unsigned i = 0; i < sizeof(msg); ++i) {
+        msg[i] = (uint8_t)bench_rand();
+    }
+    BENCH("crc4 (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += crc4(msg, sizeof(msg), 0x3, 0); });
+    BENCH("crc8 (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += crc8(msg, sizeof(msg), 0x31, 0); });
+    BENCH("crc8le (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += crc8le(msg, sizeof(msg), 0x31, 0); });
+    BENCH("crc16 (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += crc16(msg, sizeof(msg), 0x1021, 0xffff); });
+    BENCH("crc16lsb (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += crc16lsb(msg, sizeof(msg), 0x8408, 0xffff); });
+    BENCH("lfsr_digest8 (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += lfsr_digest8(msg, sizeof(msg), 0x98, 0x3e); });
+    BENCH("lfsr_digest8_reflect (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += lfsr_digest8_reflect(msg, sizeof(msg), 0x31, 0xf4); });
+    BENCH("lfsr_digest16 (16 bytes)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) { msg[0] = (uint8_t)k; sink += lfsr_digest16(msg, sizeof(msg), 0x8810, 0xba95); });
+
+    // ten rows of 200 random bits, the pattern is at the end of the last row only
+    static bitbuffer_t bits;
+    bitbuffer_clear(&bits);
+    for (unsigned r = 0; r < 10; ++r) {
+        for (unsigned b = 0; b < 200; ++b) {
+            bitbuffer_add_bit(&bits, r == 9 && b >= 184 ? (0xd391 >> (199 - b)) & 1 : (int)(bench_rand() & 1));
+        }
+        if (r < 9)
+            bitbuffer_add_row(&bits);
+    }
+    uint8_t const pattern[] = {0xd3, 0x91};
+    BENCH("bitbuffer_search (10 rows of 200 bits)", "ns/op", BENCH_OPS / 10,
+            for (int k = 0; k < BENCH_OPS / 10; ++k) {
+                for (unsigned r = 0; r < bits.num_rows; ++r) {
+                    sink += bitbuffer_search(&bits, r, 0, pattern, 16);
+                }
+            });
+}
+
+/// Kinds of representative events, the data benchmarks cycle through them.
+#define EVENT_KINDS 3
+
+// a representative event of a weather sensor, a TPMS, or a utility meter
+static data_t *make_event(int i)
+{
+    /* clang-format off */
+    switch (i % EVENT_KINDS) {
+    case 0:
+        return data_make(
+                "time",             "",             DATA_STRING, "2026-10-15 12:34:56",
+                "model",            "",             DATA_STRING, "Bench-Sensor",
+                "id",               "House Code",   DATA_INT,    i & 0xff,
+                "channel",          "Channel",      DATA_INT,    1 + i % 3,
+                "battery_ok",       "Battery",      DATA_INT,    1,
+                "temperature_C",    "Temperature",  DATA_FORMAT, "%.1f C", DATA_DOUBLE, 21.5 + (i % 10) * 0.1,
+                "humidity",         "Humidity",     DATA_FORMAT, "%u %%", DATA_INT, 45 + i % 7,
+                "wind_avg_km_h",    "Wind avg speed", DATA_FORMAT, "%.1f km/h", DATA_DOUBLE, 3.6 + (i % 5) * 0.4,
+                "rain_mm",          "Total rainfall", DATA_FORMAT, "%.1f mm", DATA_DOUBLE, 120.4,
+                "mic",              "Integrity",    DATA_STRING, "CRC",
+                NULL);
+    case 1:
+        return data_make(
+                "time",             "",             DATA_STRING, "2026-10-15 12:34:56",
+                "model",            "",             DATA_STRING, "Bench-TPMS",
+                "type",             "",             DATA_STRING, "TPMS",
+                "id",               "",             DATA_STRING, "0a1b2c3d",
+                "status",           "",             DATA_INT,    0x80 | (i & 0x7),
+                "pressure_kPa",     "Pressure",     DATA_FORMAT, "%.0f kPa", DATA_DOUBLE, 230.0 + i % 4,
+                "temperature_C",    "Temperature",  DATA_FORMAT, "%.0f C", DATA_DOUBLE, 18.0,
+                "flags",            "",             DATA_STRING, "ff12",
+                "mic",              "Integrity",    DATA_STRING, "CRC",
+                NULL);
+    default:
+        return data_make(
+                "time",             "",             DATA_STRING, "2026-10-15 12:34:56",
+                "model",            "",             DATA_STRING, "Bench-Meter",
+                "id",               "",             DATA_INT,    40000000 + (i & 0xfff),
+                "physical_tamper",  "",             DATA_INT,    0,
+                "ert_type",         "",             DATA_INT,    7,
+                "encoder_tamper",   "",             DATA_INT,    0,
+                "consumption_data", "",             DATA_INT,    1234567 + i,
+                "mic",              "Integrity",    DATA_STRING, "CRC",
+                NULL);
+    }
+    /* clang-format on */
+}
+
+// a log message as the log handler of rtl_433 makes it
+static data_t *make_log_message(void)
+{
+    /* clang-format off */
+    return data_make(
+            "time",             "",             DATA_STRING, "2026-10-15 12:34:56",
+            "src",              "",             DATA_STRING, "Bench",
+            "lvl",              "",             DATA_INT,    LOG_WARNING,
+            "msg",              "",             DATA_STRING, "A log message of the benchmark",
+            NULL);
+    /* clang-format on */
+}
+
+static char const *const event_fields[] = {"time", "model", "type", "id", "channel", "battery_ok", "temperature_C",
+        "humidity", "wind_avg_km_h", "rain_mm", "status", "pressure_kPa", "flags", "physical_tamper", "ert_type",
+        "encoder_tamper", "consumption_data", "mic"};
+
+// print the events in turn repeatedly on an output
+static void bench_output(char const *name, data_output_t *output, data_t **events)
+{
+    if (!output) {
+        FATAL("Failed to create the output");
+    }
+    data_output_start(output, event_fields, sizeof(event_fields) / sizeof(*event_fields));
+    BENCH(name, "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) {
+                data_output_print(output, events[k % EVENT_KINDS]);
+            });
+    data_output_free(output);
+}
+
+static FILE *open_null(void)
+{
+    FILE *file = fopen(NULL_DEVICE, "wb");
+    if (!file) {
+        FATAL("Failed to open the null device");
+    }
+    return file;
+}
+
+static void bench_data(void)
+{
+    BENCH("data_make", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) {
+                data_free(make_event(k));
+            });
+
+    data_t *events[EVENT_KINDS];
+    for (int i = 0; i < EVENT_KINDS; ++i) {
+        events[i] = make_event(42 + i);
+    }
+    char buf[1024];
+    BENCH("data_print_jsons", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) {
+                sink += (uint32_t)data_print_jsons(events[k % EVENT_KINDS], buf, sizeof(buf));
+            });
+    uint8_t bin[1024];
+    BENCH("data_encode_binary (cbor)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) {
+                sink += (uint32_t)data_encode_binary(BINARY_CBOR, events[k % EVENT_KINDS], bin, sizeof(bin));
+            });
+    BENCH("data_encode_binary (msgpack)", "ns/op", BENCH_OPS,
+            for (int k = 0; k < BENCH_OPS; ++k) {
+                sink += (uint32_t)data_encode_binary(BINARY_MSGPACK, events[k % EVENT_KINDS], bin, sizeof(bin));
+            });
+
+    // buffered like -F json,buffer=64k, the output cost and not a write per event
+    file_flush_t flush = {.buffer_size = 65536};
+    bench_output("output json", data_output_json_create(0, open_null(), &flush), events);
+    bench_output("output csv", data_output_csv_create(0, open_null(), &flush), events);
+    bench_output("output kv", data_output_kv_create(0, open_null()), events);
+    bench_output("output cbor", data_output_binary_create(BINARY_CBOR, 0, open_null()), events);
+    bench_output("output msgpack", data_output_binary_create(BINARY_MSGPACK, 0, open_null()), events);
+    bench_output("output arrow", data_output_arrow_create(0, open_null(), NULL), events);
+
+    data_t *log_message = make_log_message();
+    data_t *log_messages[EVENT_KINDS] = {log_message, log_message, log_message};
+    bench_output("output log", data_output_log_create(LOG_TRACE, open_null()), log_messages);
+    data_free(log_message);
+
+    // the network outputs never connect, the manager is not polled: an event is formatted,
+    // MQTT topics are expanded and then dropped, InfluxDB lines are queued with the oldest dropped
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+    if (bench_match("output influx")) {
+        char influx_param[] = "influx://127.0.0.1:1/write?db=bench,batch=1,buffer=1";
+        bench_output("output influx", data_output_influx_create(&mgr, influx_param), events);
+    }
+    if (bench_match("output mqtt")) {
+        char mqtt_param[] = "mqtt://127.0.0.1:1";
+        bench_output("output mqtt", data_output_mqtt_create(&mgr, mqtt_param, NULL), events);
+    }
+    mg_mgr_free(&mgr);
+
+    for (int i = 0; i < EVENT_KINDS; ++i) {
+        data_free(events[i]);
+    }
+}
+
+// the value of a field of a result
+static data_t *result_field(data_t *result, char const *key)
+{
+    for (data_t *d = result; d; d = d->next) {
+        if (!strcmp(d->key, key))
+            return d;
+    }
+    return NULL;
+}
+
+// the relative time of a result by name, returns 0 if it did not run
+static double result_relative(char const *name)
+{
+    for (void **iter = results.elems; iter && *iter; ++iter) {
+        if (!strcmp(result_field(*iter, "name")->value.v_ptr, name))
+            return result_field(*iter, "relative")->value.v_dbl;
+    }
+    return 0.0;
+}
+
+/// Write the relative times as a baseline of "<relative> <name>" lines.
+static void write_baseline(char const *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        exit(1);
+    }
+    fprintf(file, "# rtl_433_bench baseline, times relative to the calibration loop, kernels: %s\n", baseband_kernels()->name);
+    for (void **iter = results.elems; iter && *iter; ++iter) {
+        char const *name = result_field(*iter, "name")->value.v_ptr;
+        if (strcmp(name, "calibration"))
+            fprintf(file, "%.4f %s\n", result_field(*iter, "relative")->value.v_dbl, name);
+    }
+    fclose(file);
+    fprintf(stderr, "Wrote the baseline %s\n", path);
+}
+
+/// Check the relative times against a baseline, returns the number of regressions beyond the tolerance.
+static int check_baseline(char const *path, double tolerance)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        exit(1);
+    }
+    int checked     = 0;
+    int regressions = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char *name;
+        double baseline = strtod(line, &name);
+        if (line[0] == '#' || name == line || baseline <= 0.0)
+            continue; // a comment or empty line
+        name += strspn(name, " \t");
+        name[strcspn(name, "\r\n")] = '\0';
+        double relative = result_relative(name);
+        if (relative <= 0.0)
+            continue; // filtered or not built, e.g. a SIMD kernel
+        checked += 1;
+        double change = 100.0 * (relative / baseline - 1.0);
+        if (change > tolerance) {
+            fprintf(stderr, "REGRESSION %-40s %10.4f, baseline %.4f (%+.0f%%)\n", name, relative, baseline, change);
+            regressions += 1;
+        }
+        else if (change < -tolerance) {
+            fprintf(stderr, "Faster     %-40s %10.4f, baseline %.4f (%+.0f%%), update the baseline\n", name, relative, baseline, change);
+        }
+    }
+    fclose(file);
+    if (!checked) {
+        fprintf(stderr, "No results to check against the baseline %s\n", path);
+        return 1;
+    }
+    fprintf(stderr, "%d of %d results slower than the baseline by more than %.0f%%\n", regressions, checked, tolerance);
+    return regressions;
+}
+
+static void usage(int exit_code)
+{
+    fprintf(exit_code ? stderr : stdout,
+            "Usage: rtl_433_bench [-j] [-n <repeats>] [-r <file.cu8>] [-b <baseline>] [-t <percent>] [-w <baseline>] [<name filter> ...]\n"
+            "  -j  print the results as JSON on stdout\n"
+            "  -n  runs of each benchmark, the fastest is reported (default: 5)\n"
+            "  -r  use a recorded CU8 file at 250 kHz instead of the synthetic input\n"
+            "  -b  fail if a time relative to the calibration loop is above the baseline file\n"
+            "  -t  tolerance of the baseline check in percent (default: 20)\n"
+            "  -w  write the times relative to the calibration loop as a baseline file\n"
+            "  only the benchmarks with one of the filters in their name are run\n");
+    exit(exit_code);
+}
+
+int main(int argc, char *argv[])
+{
+    int json = 0;
+    char const *path = NULL;
+    char const *baseline_path = NULL;
+    char const *write_path = NULL;
+    double tolerance = 20.0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-j"))
+            json = 1;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            repeats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            path = argv[++i];
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            write_path = argv[++i];
+        else if (!strcmp(argv[i], "-h"))
+            usage(0);
+        else if (argv[i][0] == '-' || num_filters == MAX_FILTERS)
+            usage(1);
+        else
+            filters[num_filters++] = argv[i];
+    }
+    if (repeats < 1 || tolerance <= 0.0)
+        usage(1);
+
+    baseband_init();
+
+    uint8_t *cu8_buf = malloc(2 * SYNTH_SAMPLES);
+    if (!cu8_buf)
+        FATAL_MALLOC("main()");
+    int16_t *cs16_buf = malloc(2 * SYNTH_SAMPLES * sizeof(int16_t));
+    if (!cs16_buf)
+        FATAL_MALLOC("main()");
+    uint16_t *u16_buf = malloc(SYNTH_SAMPLES * sizeof(uint16_t));
+    if (!u16_buf)
+        FATAL_MALLOC("main()");
+    int16_t *am_buf = malloc(SYNTH_SAMPLES * sizeof(int16_t));
+    if (!am_buf)
+        FATAL_MALLOC("main()");
+    int16_t *fm_buf = malloc(SYNTH_SAMPLES * sizeof(int16_t));
+    if (!fm_buf)
+        FATAL_MALLOC("main()");
+    // fault in the output buffers, the first benchmark should not time the page faults
+    memset(u16_buf, 0, SYNTH_SAMPLES * sizeof(uint16_t));
+    memset(am_buf, 0, SYNTH_SAMPLES * sizeof(int16_t));
+    memset(fm_buf, 0, SYNTH_SAMPLES * sizeof(int16_t));
+
+    unsigned n = SYNTH_SAMPLES;
+    if (path) {
+        n = read_cu8(path, cu8_buf, SYNTH_SAMPLES);
+    }
+    else {
+        synth_cu8(cu8_buf, n);
+    }
+    for (unsigned i = 0; i < 2 * n; ++i) {
+        cs16_buf[i] = (int16_t)(cu8_buf[i] * 128 - 16320);
+    }
+    fprintf(stderr, "Input: %s, %u samples, kernels: %s\n", path ? path : "synthetic", n, baseband_kernels()->name);
+
+    bench_calibration();
+    bench_baseband(cu8_buf, cs16_buf, n, u16_buf, am_buf, fm_buf);
+
+    // the pulse detector and slicers see the default demodulation
+    filter_state_t lp_state;
+    demodfm_state_t fm_state;
+    baseband_low_pass_filter_init(&lp_state, 1);
+    baseband_demod_FM_reset(&fm_state);
+    baseband_demod_fused(&lp_state, &fm_state, cu8_buf, BASEBAND_CU8, 0, am_buf, fm_buf, n, SAMPLE_RATE, 0.1f);
+    pulse_data_t first = {0};
+    bench_pulse_detect(am_buf, fm_buf, n, &first);
+    bench_slicers(&first);
+    bench_decoders(cu8_buf, n, am_buf, fm_buf, &first);
+    pulse_data_free(&first);
+
+    bench_bits();
+    bench_data();
+
+    if (write_path)
+        write_baseline(write_path);
+    int regressions = baseline_path ? check_baseline(baseline_path, tolerance) : 0;
+
+    if (json) {
+        data_t *data = data_make(
+                "input",        "", DATA_STRING, path ? path : "synthetic",
+                "samples",      "", DATA_INT, (int)n,
+                "sample_rate",  "", DATA_INT, SAMPLE_RATE,
+                "kernels",      "", DATA_STRING, baseband_kernels()->name,
+                "repeats",      "", DATA_INT, repeats,
+                "results",      "", DATA_ARRAY, data_array((int)results.len, DATA_DATA, results.elems),
+                NULL);
+        size_t size = 65536 + results.len * 256;
+        char *text  = malloc(size);
+        if (!text)
+            FATAL_MALLOC("main()");
+        data_print_jsons(data, text, size);
+        printf("%s\n", text);
+        free(text);
+        data_free(data);
+    }
+    else {
+        for (void **iter = results.elems; iter && *iter; ++iter) {
+            data_free(*iter);
+        }
+    }
+    list_free_elems(&results, NULL);
+
+    free(cu8_buf);
+    free(cs16_buf);
+    free(u16_buf);
+    free(am_buf);
+    free(fm_buf);
+    return regressions ? 1 : 0;
+}
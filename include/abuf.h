@@ -47,4 +47,46 @@ int abuf_printf(abuf_t *buf, _Printf_format_string_ char const *restrict format,
 #endif
         ;
 
+/// Append a double like "%.*f", without printf for precisions up to 9 if the rounding is unambiguous.
+void abuf_print_fixed(abuf_t *buf, double val, int prec);
+
+/// Append a double with a printf format, "%f" and "%.Nf" with literal text around are formatted without printf.
+void abuf_print_double(abuf_t *buf, char const *format, double val);
+
+/// Append an int with a printf format, "%d" and "%u" with literal text around are formatted without printf.
+void abuf_print_int(abuf_t *buf, char const *format, int val);
+
+/// A growable buffer (string builder), kept and reused to render one output line after another.
+typedef struct gbuf {
+    char *data;
+    size_t len;  ///< length of the text, the text is always terminated
+    size_t size; ///< allocated size of the data
+    int error;   ///< an allocation failed, the text is truncated
+} gbuf_t;
+
+/// Free the data of a growable buffer, the buffer can be reused after this.
+void gbuf_free(gbuf_t *buf);
+
+/// Empty a growable buffer, keeps the allocation.
+void gbuf_clear(gbuf_t *buf);
+
+/// Append len chars of a string.
+void gbuf_put(gbuf_t *buf, char const *str, size_t len);
+
+/// Append a string.
+void gbuf_cat(gbuf_t *buf, char const *str);
+
+/// Append with a printf format, returns the number of chars the format produced.
+int gbuf_printf(gbuf_t *buf, _Printf_format_string_ char const *restrict format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+/// Append a double with a printf format, like abuf_print_double().
+void gbuf_print_double(gbuf_t *buf, char const *format, double val);
+
+/// Append an int with a printf format, like abuf_print_int().
+void gbuf_print_int(gbuf_t *buf, char const *format, int val);
+
 #endif /* INCLUDE_ABUF_H_ */
@@ -13,6 +13,7 @@
 #ifndef INCLUDE_BASEBAND_H_
 #define INCLUDE_BASEBAND_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <math.h>
 
@@ -26,15 +27,112 @@
 */
 float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
 
+/// 122/128, 51/128 Magnitude Estimator for CU8, returns the average level in dB.
+float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+
+/// 122/128, 51/128 Magnitude Estimator for CS16, returns the average level in dB.
+float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+
+/// Sample formats of the IQ input, CS8 and CF32 are processed natively on the CU8 and CS16 scales.
+typedef enum baseband_format {
+    BASEBAND_CU8,
+    BASEBAND_CS16,
+    BASEBAND_CS8,
+    BASEBAND_CF32,
+} baseband_format_t;
+
+/// Envelope detect for CS8, on the same scale as envelope_detect().
+float envelope_detect_cs8(int8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+
+/// Magnitude Estimator for CS8, on the same scale as magnitude_est_cu8().
+float magnitude_est_cs8(int8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+
+/// Magnitude Estimator for CF32, clamped to [-1,1] and on the same scale as magnitude_est_cs16().
+float magnitude_est_cf32(float const *iq_buf, uint16_t *y_buf, uint32_t len);
+
+/// Windows of a width classification, the symbol of a width is the first window with lower < width < upper.
+#define BASEBAND_WINDOWS 3
+/// Symbol of a width in none of the windows.
+#define BASEBAND_SYMBOL_OTHER BASEBAND_WINDOWS
+
+/** Envelope, magnitude, FM phase, and pulse width kernels, the level kernels return the sum of the output values.
+
+    Variants for SIMD instruction sets are bit-exact with the scalar reference,
+    baseband_init() selects the best variant supported by the CPU.
+*/
+typedef struct baseband_kernels {
+    char const *name;
+    uint32_t (*envelope_detect)(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    uint32_t (*magnitude_est_cu8)(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    uint32_t (*magnitude_est_cs16)(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    /// Instantaneous frequency of x[n] * conj(x[n-1]) for 1 <= n < len, f_buf[0] is left to the caller.
+    void (*demod_fm_phase_cu8)(uint8_t const *iq_buf, int16_t *f_buf, uint32_t len);
+    /// Symbol of each width, the index of the first window it is in or BASEBAND_SYMBOL_OTHER, an empty window is 0, 0.
+    void (*classify_widths)(int const *widths, uint8_t *symbols, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS]);
+} baseband_kernels_t;
+
+/// Return the kernel variant number @p idx supported by this CPU, NULL past the last one, 0 is the scalar reference.
+baseband_kernels_t const *baseband_kernels_variant(unsigned idx);
+
+/// Return the kernel variant selected by baseband_init().
+baseband_kernels_t const *baseband_kernels(void);
+
+/// Use the kernel variant of this name instead of the best one, e.g. "scalar" for the reference, returns -1 if the CPU does not support it.
+int baseband_select(char const *name);
+
+/** Time each kernel of each variant on a synthetic buffer and use the fastest of each.
+
+    Which variant is fastest depends on the compiler flags and the CPU, e.g. the envelope
+    with a LUT or without, so each kernel of each supported variant, and the envelope
+    without a LUT, is timed for about a ms and the fastest are combined to a "tuned" variant.
+    The choice is read from the cache file if it was made with the same variants and compiler,
+    otherwise it is saved there. Call before any threads, the choice is kept by baseband_init().
+
+    @param cache_path the file of the choice, NULL to time on each start
+    @return 1 if the choice was read from the cache, 0 if timed, -1 if a variant was chosen with baseband_select() or on failure
+*/
+int baseband_autotune(char const *cache_path);
+
+/// The variant of each kernel in use, e.g. "envelope_detect=nolut magnitude_est_cu8=avx2 ...".
+void baseband_kernel_names(char *buf, size_t size);
+
 // for evaluation
 float envelope_detect_nolut(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
-float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
 float magnitude_true_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
-float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
 float magnitude_true_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
 
+/** Cheap level estimate using only every stride-th sample, e.g. for a squelch decision.
+
+    The results are on the same dB scale as the matching full pass functions.
+    @param iq_buf input samples (I/Q samples in interleaved uint8, int8, or int16)
+    @param len number of samples in the buffer
+    @param stride distance between the samples used
+    @return the estimated average level in dB
+*/
+float envelope_level_strided(uint8_t const *iq_buf, uint32_t len, unsigned stride);
+float envelope_level_strided_cs8(int8_t const *iq_buf, uint32_t len, unsigned stride);
+float magnitude_level_strided_cu8(uint8_t const *iq_buf, uint32_t len, unsigned stride);
+float magnitude_level_strided_cs8(int8_t const *iq_buf, uint32_t len, unsigned stride);
+float magnitude_level_strided_cs16(int16_t const *iq_buf, uint32_t len, unsigned stride);
+
 #define AMP_TO_DB(x) (10.0f * ((x) > 0 ? log10f(x) : 0) - 42.1442f)  // 10*log10f(16384.0f)
 #define MAG_TO_DB(x) (20.0f * ((x) > 0 ? log10f(x) : 0) - 84.2884f)  // 20*log10f(16384.0f)
+
+/** Power ratio in dB, 10*log10(num / den), in integer arithmetic only.
+
+    The logarithm is taken from a table of 256 mantissa steps, interpolated,
+    the error is below 0.001 dB. Used per frame and per package instead of log10f(),
+    which is costly on targets without FPU.
+    @param num numerator of the ratio
+    @param den denominator of the ratio
+    @return the ratio in 1/65536 dB, 0 if num or den is 0
+*/
+int ratio_to_db_q16(uint64_t num, uint64_t den);
+
+/// AMP_TO_DB() of the average sum / n, clamped to an average of at least 1 like the level estimators.
+#define AMP_AVG_TO_DB(sum, n) (((n) > 0 && (sum) >= (n) ? ratio_to_db_q16((sum), (n)) : 0) * (1.0f / 65536) - 42.1442f)
+/// MAG_TO_DB() of the average sum / n, clamped to an average of at least 1 like the level estimators.
+#define MAG_AVG_TO_DB(sum, n) (((n) > 0 && (sum) >= (n) ? ratio_to_db_q16((sum), (n)) : 0) * (2.0f / 65536) - 84.2884f)
 #ifdef __exp10f
 #define _exp10f(x) __exp10f(x)
 #else
@@ -86,11 +184,21 @@ tabulated magnitude and amplitude values:
 */
 
 #define FILTER_ORDER 1
+/// Highest order of the selectable Butterworth low pass filters, a cascade of order / 2 biquads.
+#define FILTER_MAX_ORDER 8
 
 /// Filter state buffer.
 typedef struct filter_state {
     int16_t y[FILTER_ORDER];
-    int16_t x[FILTER_ORDER];
+    uint16_t x[FILTER_ORDER]; ///< unsigned like the input, a full scale envelope of 32768 must not wrap
+    unsigned order; ///< selected filter order, 0 or 1 for the fixed point first order filter
+#ifdef FIXED_POINT
+    int32_t coeffs[FILTER_MAX_ORDER / 2][5]; ///< b0, b1, b2, a1, a2 of each biquad, Q2.28
+    int32_t z[FILTER_MAX_ORDER / 2][2]; ///< transposed direct form II state of each biquad, Q12
+#else
+    float coeffs[FILTER_MAX_ORDER / 2][5]; ///< b0, b1, b2, a1, a2 of each biquad
+    float z[FILTER_MAX_ORDER / 2][2]; ///< transposed direct form II state of each biquad
+#endif
 } filter_state_t;
 
 /// FM_Demod state buffer.
@@ -104,11 +212,46 @@ typedef struct demodfm_state {
     int32_t blp_16[2]; ///< Current low pass filter B coeffs, 16 bit
     int64_t alp_32[2]; ///< Current low pass filter A coeffs, 32 bit
     int64_t blp_32[2]; ///< Current low pass filter B coeffs, 32 bit
+    int skipped;       ///< Samples were skipped since the last sample, restart before the next
 } demodfm_state_t;
 
-/** Reset the lowpass filter to an initial state. */
+/// Longest half window of the two-tone FSK detector, in decimated samples.
+#define TONES_MAX_HALF 64
+
+/// Two-tone FSK detector state buffer.
+typedef struct demodtones_state {
+    uint32_t rate;                   ///< Current sample rate
+    uint32_t deviation;              ///< Current tone deviation in Hz
+    unsigned decim;                  ///< Samples summed to a decimated sample
+    unsigned half;                   ///< Decimated samples of a half window, the window is two halves
+    int16_t cos_q12[TONES_MAX_HALF]; ///< Mark tone over a half window, real part, Q12
+    int16_t sin_q12[TONES_MAX_HALF]; ///< Mark tone over a half window, imag part, Q12
+    float rot_r;                     ///< Phase advance of the mark tone over a half window, real part
+    float rot_i;                     ///< Phase advance of the mark tone over a half window, imag part
+    float scale;                     ///< Output for the mark tone alone, in the units of baseband_demod_FM()
+    unsigned decim_count;            ///< Samples in the current decimated sample
+    int32_t decim_sums[2];           ///< Sums of i and q of the current decimated sample
+    unsigned count;                  ///< Decimated samples in the current half window
+    int64_t sums[4];                 ///< Sums of i*cos, q*sin, q*cos, i*sin of the current half window
+    float prev_mark[2];              ///< Mark tone correlation of the previous half window
+    float prev_space[2];             ///< Space tone correlation of the previous half window
+    int16_t y;                       ///< Last output
+    int skipped;                     ///< Samples were skipped since the last sample, restart before the next
+} demodtones_state_t;
+
+/** Reset the lowpass filter to an initial state, the selected order is kept. */
 void baseband_low_pass_filter_reset(filter_state_t *lowpass_filter);
 
+/** Select the lowpass filter order.
+
+    Order 1 is the default fixed point filter, even orders up to FILTER_MAX_ORDER
+    select a Butterworth filter with the same cutoff, steeper but more costly.
+    @param[in,out] lowpass_filter the filter to set up, also resets the state
+    @param order filter order
+    @return 0 on success, -1 if the order is not supported
+*/
+int baseband_low_pass_filter_init(filter_state_t *lowpass_filter, unsigned order);
+
 /** Lowpass filter.
 
     Function is stateful.
@@ -134,11 +277,93 @@ void baseband_demod_FM_reset(demodfm_state_t *demod_fm);
 */
 void baseband_demod_FM(demodfm_state_t *state, uint8_t const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass);
 
+/** Fused envelope, AM low pass filter, and FM demodulation.
+
+    Walks the buffer in L1 cache sized tiles, each IQ tile is read from memory once
+    and stays in cache for the envelope, the low pass filter, and the FM demod.
+    The output is identical to calling the separate functions on the whole buffer.
+
+    Function is stateful.
+    @param[in,out] lp_state AM low pass filter state
+    @param[in,out] fm_state FM demodulator state
+    @param iq_buf input samples, interleaved in the given format
+    @param format sample format of the input
+    @param use_mag_est use the magnitude estimator instead of the envelope for CU8 and CS8, CS16 and CF32 always use the magnitude
+    @param[out] am_buf low pass filtered AM output
+    @param[out] fm_buf FM output, NULL to skip the FM demod
+    @param len number of samples to process
+    @param samp_rate sample rate of samples to process
+    @param low_pass FM low-pass filter frequency or ratio
+    @return the average level in dB of the unfiltered envelope
+*/
+float baseband_demod_fused(filter_state_t *lp_state, demodfm_state_t *fm_state, void const *iq_buf, baseband_format_t format, int use_mag_est,
+        int16_t *am_buf, int16_t *fm_buf, uint32_t len, uint32_t samp_rate, float low_pass);
+
 /// For evaluation.
 void baseband_demod_FM_cs16(demodfm_state_t *state, int16_t const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass);
 
-/** Initialize tables and constants.
-    Should be called once at startup.
+/// Instantaneous frequency and low pass filter for CS8, same output as baseband_demod_FM().
+void baseband_demod_FM_cs8(demodfm_state_t *state, int8_t const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass);
+
+/// Instantaneous frequency and low pass filter for CF32, same output as baseband_demod_FM_cs16().
+void baseband_demod_FM_cf32(demodfm_state_t *state, float const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass);
+
+/** FM demodulation of the parts of a buffer with a carrier only.
+
+    The FSK pulse detector only reads the FM samples of a pulse and its short gaps.
+    The buffer is walked in tiles, a tile is demodulated if it or a neighbour has an AM sample
+    at or above the carrier level, the tile before a carrier lets the FM filter settle.
+    The first tile is demodulated if the last tile of the previous buffer was.
+    The other tiles read as 0, the FM state restarts after skipped tiles.
+    Within the carrier and its guard the output matches baseband_demod_FM() on the whole buffer,
+    except where the carrier starts at the beginning of a buffer after skipped samples.
+
+    Function is stateful.
+    @param[in,out] state FM demodulator state
+    @param iq_buf input samples, interleaved in the given format
+    @param format sample format of the input
+    @param am_buf low pass filtered AM of the same samples
+    @param carrier_level the lowest AM level of a carrier, see pulse_detect_carrier_level(), 0 to demodulate all samples
+    @param[out] y_buf output from FM demodulator
+    @param len number of samples to process
+    @param samp_rate sample rate of samples to process
+    @param low_pass Low-pass filter frequency or ratio
+    @return the number of samples demodulated
+*/
+uint32_t baseband_demod_FM_carrier(demodfm_state_t *state, void const *iq_buf, baseband_format_t format, int16_t const *am_buf, int carrier_level,
+        int16_t *y_buf, uint32_t len, uint32_t samp_rate, float low_pass);
+
+/** Reset the two-tone FSK detector to an initial state. */
+void baseband_demod_tones_reset(demodtones_state_t *state);
+
+/** Two-tone FSK detection, a cheaper alternative to baseband_demod_FM() for FSK of a known deviation.
+
+    The samples are summed to a rate of at least 8 times the deviation, then correlated with
+    the mark and space tones at +/- the deviation over a window of about a sample rate / (2 * deviation)
+    samples, where each tone has a null at the other. The window slides by halves, the output of a half window
+    is the power difference of the tones over their sum, scaled to the deviation in the units of
+    baseband_demod_FM(), e.g. for the FSK pulse detector.
+    A signal off center by more than about half the deviation reads as the nearer tone only.
+
+    Tiles without a carrier are skipped as in baseband_demod_FM_carrier().
+
+    Function is stateful.
+    @param[in,out] state detector state
+    @param iq_buf input samples, interleaved in the given format
+    @param format sample format of the input
+    @param am_buf low pass filtered AM of the same samples
+    @param carrier_level the lowest AM level of a carrier, see pulse_detect_carrier_level(), 0 to detect on all samples
+    @param[out] y_buf output of the detector
+    @param len number of samples to process
+    @param samp_rate sample rate of samples to process
+    @param deviation the tone deviation in Hz
+    @return the number of samples detected on
+*/
+uint32_t baseband_demod_tones(demodtones_state_t *state, void const *iq_buf, baseband_format_t format, int16_t const *am_buf, int carrier_level,
+        int16_t *y_buf, uint32_t len, uint32_t samp_rate, uint32_t deviation);
+
+/** Select the best kernel variant supported by this CPU.
+    Safe to call again, also from other threads, the tables are constant.
 */
 void baseband_init(void);
 
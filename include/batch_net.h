@@ -0,0 +1,124 @@
+/** @file
+    Distributed batch decoding, a coordinator hands input files to worker instances and merges their events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BATCH_NET_H_
+#define INCLUDE_BATCH_NET_H_
+
+#include <stddef.h>
+
+struct mg_mgr;
+struct data;
+struct data_output;
+
+/** Hands the input files to the workers connecting over TCP and outputs their events in input order.
+
+    The exchange is in lines of text. A worker greets with "HELLO rtl_433-batch 1" and asks
+    for files with "NEXT <n>". The coordinator answers with up to n lines "FILE <seq> <path>"
+    and a "GO", or with "END" when all files are done. The worker sends each event of a file
+    as "EVENT <seq> <json>" and finishes a file with "DONE <seq> ok" or "DONE <seq> failed".
+
+    The events of a file are held until the file and all files before it are done. The files
+    of a worker that disconnects are handed out again, their events so far are dropped,
+    each event is output once. A failed file is not retried.
+
+    The paths are sent as given, the workers must be able to read them, e.g. from shared storage.
+*/
+typedef struct batch_coordinator batch_coordinator_t;
+
+/// Outputs an event of a file, takes ownership of the data.
+typedef void (*batch_output_fn)(void *ctx, struct data *data);
+
+/** Listen for workers and hand out the files.
+
+    @param mgr the event loop to accept the workers on
+    @param host the address to bind, NULL for any
+    @param port the TCP port
+    @param files the paths of the input files, copied
+    @param count the number of files
+    @param output_fn called on the event loop for each event to output, in input order
+    @param ctx passed to the output callback
+    @return the coordinator, NULL on error
+*/
+batch_coordinator_t *batch_coordinator_create(struct mg_mgr *mgr, char const *host, char const *port,
+        char const *const *files, size_t count, batch_output_fn output_fn, void *ctx);
+
+/// Close the workers and drop the events not output, the coordinator may be NULL.
+void batch_coordinator_free(batch_coordinator_t *coord);
+
+/// Returns 1 once the events of all files are output.
+int batch_coordinator_done(batch_coordinator_t const *coord);
+
+/// Number of workers that connected so far.
+unsigned batch_coordinator_workers(batch_coordinator_t const *coord);
+
+/// Number of files a worker reported as failed.
+unsigned batch_coordinator_failed(batch_coordinator_t const *coord);
+
+/// Number of files handed out again after their worker disconnected.
+unsigned batch_coordinator_reassigned(batch_coordinator_t const *coord);
+
+/** Takes files from a coordinator and sends back the events.
+
+    The worker reads the files of an assignment, with the events going to the output
+    of batch_worker_output(), then reports each file done and polls for the next assignment.
+*/
+typedef struct batch_worker batch_worker_t;
+
+/** Connect to a coordinator, the connection is retried until the coordinator answers.
+
+    @param mgr the event loop to connect on
+    @param host the host of the coordinator
+    @param port the TCP port
+    @param max_files the most files to ask for at a time
+    @return the worker, NULL on error
+*/
+batch_worker_t *batch_worker_create(struct mg_mgr *mgr, char const *host, char const *port, unsigned max_files);
+
+/// Send what is left to send and disconnect, the worker may be NULL.
+void batch_worker_free(batch_worker_t *worker);
+
+/** Wait for the next assignment, asks for one if none is pending.
+
+    @param worker the worker
+    @param timeout_ms the most time to wait
+    @return the number of files assigned, 0 if none yet, -1 when there are no more files or the coordinator is gone
+*/
+int batch_worker_poll(batch_worker_t *worker, int timeout_ms);
+
+/// The path of a file of the assignment, valid until the next poll.
+char const *batch_worker_file(batch_worker_t const *worker, int i);
+
+/// Report a file of the assignment as done, or as failed if @p ok is 0.
+void batch_worker_done(batch_worker_t *worker, int i, int ok);
+
+/** Create an output sending the events to the coordinator.
+
+    The file of an event is found by the path pointer @p current_file points to,
+    it must be one returned by batch_worker_file(). Other events and log messages are dropped.
+
+    @param worker the worker, must outlive the output or be freed first
+    @param current_file points to the path of the file being read
+    @return the output, NULL on alloc failure
+*/
+struct data_output *batch_worker_output(batch_worker_t *worker, char const *const *current_file);
+
+/** Parse the JSON text of an event.
+
+    Strings, numbers, booleans as integers, nested objects, and arrays of a single type are kept,
+    nulls are dropped. A number with a fraction or an exponent is a double.
+
+    @param json the JSON text of an object
+    @param len the length of the text
+    @return the event, NULL if the text is not a valid event
+*/
+struct data *batch_parse_event(char const *json, size_t len);
+
+#endif /* INCLUDE_BATCH_NET_H_ */
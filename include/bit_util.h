@@ -86,6 +86,8 @@ unsigned extract_bits_symbols(uint8_t const *message, unsigned offset_bits, unsi
 
 /// CRC-4.
 ///
+/// All of the CRC functions run on a table of the polynomial, built on first use and shared by all threads.
+///
 /// @param message array of bytes to check
 /// @param nBytes number of bytes in message
 /// @param polynomial CRC polynomial
@@ -146,6 +148,9 @@ uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, ui
 
 /// Digest-8 by "LFSR-based Toeplitz hash", bits MSB to LSB.
 ///
+/// All of the LFSR digests of up to 32 bytes run on a table of the gen and key,
+/// built on first use and shared by all threads.
+///
 /// @param message bytes of message data
 /// @param bytes number of bytes to digest
 /// @param gen key stream generator, needs to includes the MSB for ROR if the LFSR is rolling
@@ -180,6 +185,38 @@ uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, ui
 /// @return digest value
 uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key);
 
+/// Bytes of a cached whitening keystream, longer buffers are whitened bit by bit past it.
+#define WHITENING_KEYSTREAM_BYTES 256
+
+/// Keystream of a whitening LFSR, built on first use and shared by all threads.
+///
+/// The LFSR shifts right, the feedback of the taps enters at the MSB of the state,
+/// the keystream bits are taken MSB first from the LSB of the state.
+///
+/// @param taps feedback taps of the state, e.g. 0x021 for PN9 (x9 + x5 + 1)
+/// @param degree number of bits of the state, 2 to 16
+/// @param seed initial state, e.g. 0x1ff
+/// @return WHITENING_KEYSTREAM_BYTES bytes of keystream, NULL if the cache is full or out of memory
+uint8_t const *whitening_keystream(uint16_t taps, unsigned degree, uint16_t seed);
+
+/// XOR a key into a buffer, a word at a time.
+///
+/// @param buffer bytes of message data
+/// @param key bytes of key, at least len
+/// @param len number of bytes to process
+void xor_keystream(uint8_t *buffer, uint8_t const *key, unsigned len);
+
+/// Apply LFSR data whitening to a buffer, whitening and de-whitening are the same.
+///
+/// The buffer is XORed with the cached keystream of whitening_keystream().
+///
+/// @param buffer bytes of message data
+/// @param len number of bytes to process
+/// @param taps feedback taps of the state
+/// @param degree number of bits of the state, 2 to 16
+/// @param seed initial state
+void lfsr_whitening(uint8_t *buffer, unsigned len, uint16_t taps, unsigned degree, uint16_t seed);
+
 /// Apply CCITT data whitening to a buffer.
 ///
 /// The CCITT data whitening process is built around a 9-bit Linear Feedback Shift Register (LFSR).
@@ -29,6 +29,21 @@
 typedef uint8_t bitrow_t[BITBUF_COLS];
 typedef bitrow_t bitarray_t[BITBUF_ROWS];
 
+// NOTE: The geometry is fixed, decoders index the rows directly and may read past the bits in use,
+//       which read as zero. A bitbuffer is zeroed in full when declared with `= {0}`, decoders
+//       should declare their temporary bitbuffers after the early checks.
+
+/// Transforms of all bits of a bitbuffer, see bitbuffer_transform().
+enum bitbuffer_transform {
+    BITBUFFER_AS_IS,             ///< no transform
+    BITBUFFER_INVERTED,          ///< as bitbuffer_invert()
+    BITBUFFER_NRZS,              ///< as bitbuffer_nrzs_decode()
+    BITBUFFER_NRZM,              ///< as bitbuffer_nrzm_decode()
+    BITBUFFER_REFLECTED,         ///< as reflect_bytes() on each row
+    BITBUFFER_NIBBLES_REFLECTED, ///< as reflect_nibbles() on each row
+    BITBUFFER_TRANSFORMS,        ///< number of transforms
+};
+
 /// Bit buffer.
 typedef struct bitbuffer {
     uint16_t num_rows;                      ///< Number of active rows
@@ -39,11 +54,22 @@ typedef struct bitbuffer {
 } bitbuffer_t;
 
 /// Clear the content of the bitbuffer.
+/// Only the rows in use are zeroed, the buffer must have been zero initialized once.
 void bitbuffer_clear(bitbuffer_t *bits);
 
+/// Copy the rows in use of a bitbuffer.
+/// The destination must have been zero initialized once, as with bitbuffer_clear().
+void bitbuffer_copy(bitbuffer_t *dst, bitbuffer_t const *src);
+
 /// Add a single bit at the end of the bitbuffer (MSB first).
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit);
 
+/// Add the top @p n bits, at most 8, of the byte @p value, as bitbuffer_add_bit() for each bit.
+void bitbuffer_add_bits(bitbuffer_t *bits, unsigned value, unsigned n);
+
+/// Add a run of @p count bits of the value @p bit, as bitbuffer_add_bit() for each bit, whole bytes at once.
+void bitbuffer_add_bits_run(bitbuffer_t *bits, int bit, unsigned count);
+
 /// Add a new row to the bitbuffer.
 void bitbuffer_add_row(bitbuffer_t *bits);
 
@@ -54,6 +80,9 @@ void bitbuffer_add_sync(bitbuffer_t *bits);
 void bitbuffer_extract_bytes(bitbuffer_t *bitbuffer, unsigned row,
         unsigned pos, uint8_t *out, unsigned len);
 
+/// Transform all bits in the bitbuffer, 8 bytes at a time, see enum bitbuffer_transform.
+void bitbuffer_transform(bitbuffer_t *bits, unsigned transform);
+
 /// Invert all bits in the bitbuffer (do not invert the empty bits).
 void bitbuffer_invert(bitbuffer_t *bits);
 
@@ -0,0 +1,89 @@
+/** @file
+    Tuning of the SDR transfer count and size from the measured callback timing.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BUF_TUNE_H_
+#define INCLUDE_BUF_TUNE_H_
+
+#include <stdint.h>
+
+/// Transfer sizes are chosen in steps of this many bytes, a multiple of the USB packet sizes.
+#define BUF_TUNE_LEN_STEP 16384
+
+/** Chooses the SDR transfers of an input from its first minutes.
+
+    A transfer holds samples for its duration and adds that to the latency, smaller
+    transfers are handed over sooner. The transfers must not be shorter than the
+    jitter of the handovers though, and the demod must keep up with the work each
+    transfer costs. The ring of transfers must bridge the longest stall, of the
+    handovers, of the processing of a buffer, and of the wait in the queue.
+
+    Over a window of signal time each buffer is measured: the time since the last
+    handover against its duration (the jitter), the processing time, the wait from the
+    handover to the processing (the ring occupancy), and lost buffers. Then the shortest
+    transfer over twice the jitter is chosen, not shorter than before if the load was
+    high and longer if buffers were lost, and enough transfers to bridge twice the
+    longest stall, at least a quarter second.
+
+    The buffers are fed from one thread.
+*/
+typedef struct buf_tune buf_tune_t;
+
+/** Create a tuner.
+
+    @param window_ns the signal time to measure
+    @return the tuner, NULL on failure
+*/
+buf_tune_t *buf_tune_create(uint64_t window_ns);
+
+void buf_tune_free(buf_tune_t *tune);
+
+/** Measure a buffer.
+
+    @param tune the tuner
+    @param publish_ns the wall time the buffer was handed over
+    @param wait_ns the time from the handover to the processing
+    @param busy_ns the time spent on the buffer
+    @param duration_ns the signal time of the buffer
+    @param lost the number of buffers dropped or overflowed before it
+    @return 1 once the window is measured, only for the buffer completing it, 0 otherwise
+*/
+int buf_tune_buffer(buf_tune_t *tune, int64_t publish_ns, uint64_t wait_ns, uint64_t busy_ns, uint64_t duration_ns, unsigned lost);
+
+/** Choose the transfers from the measurements.
+
+    @param tune the tuner
+    @param bytes_per_s the byte rate of the input
+    @param buf_len the current transfer size in bytes
+    @param max_bytes the most bytes of all transfers, e.g. the ring the memory budget counted
+    @param max_num the most transfers, e.g. the size of the event queue
+    @return 0 on success, -1 if nothing was measured
+*/
+int buf_tune_choose(buf_tune_t *tune, uint32_t bytes_per_s, uint32_t buf_len, uint64_t max_bytes, uint32_t max_num);
+
+/// The chosen transfer count, 0 until chosen.
+uint32_t buf_tune_buf_num(buf_tune_t const *tune);
+
+/// The chosen transfer size in bytes, 0 until chosen.
+uint32_t buf_tune_buf_len(buf_tune_t const *tune);
+
+/// The measured jitter of the handovers in us at a percentile.
+unsigned buf_tune_jitter_us(buf_tune_t const *tune, unsigned pct);
+
+/// The measured processing time of a buffer in us at a percentile.
+unsigned buf_tune_busy_us(buf_tune_t const *tune, unsigned pct);
+
+/// The measured wait from the handover to the processing in us at a percentile.
+unsigned buf_tune_wait_us(buf_tune_t const *tune, unsigned pct);
+
+/// The number of buffers lost while measuring.
+unsigned buf_tune_lost(buf_tune_t const *tune);
+
+#endif /* INCLUDE_BUF_TUNE_H_ */
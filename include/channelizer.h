@@ -0,0 +1,59 @@
+/** @file
+    Polyphase channelizer, splits a wide capture into decimated sub-channels.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_CHANNELIZER_H_
+#define INCLUDE_CHANNELIZER_H_
+
+#include <stdint.h>
+
+#define CHANNELIZER_MAX_CHANNELS 32
+
+/** A 2x oversampled polyphase analysis filter bank.
+
+    The sample bandwidth is split into N evenly spaced channels, channel k is centered
+    at k * rate / N (channels above N/2 wrap to negative offsets). Each channel is
+    decimated by N/2, i.e. the channel sample rate is twice the channel spacing so
+    signals near a channel edge are not lost. Output samples are CS16.
+*/
+typedef struct channelizer channelizer_t;
+
+/// Create a channelizer for @p channels channels, must be even and at most CHANNELIZER_MAX_CHANNELS.
+channelizer_t *channelizer_create(unsigned channels);
+
+void channelizer_free(channelizer_t *ch);
+
+/// Clear the filter history, e.g. on a new input stream.
+void channelizer_reset(channelizer_t *ch);
+
+/// Run the filter bank on a GPU with OpenCL, returns 0 on success, -1 to keep channelizing on the CPU.
+int channelizer_use_gpu(channelizer_t *ch);
+
+/// Return the frequency offset of a channel from the input center frequency.
+int channelizer_offset(channelizer_t const *ch, unsigned channel, uint32_t samp_rate);
+
+/// Return the sample rate of each channel for a given input sample rate.
+uint32_t channelizer_rate(channelizer_t const *ch, uint32_t samp_rate);
+
+/** Split a buffer of input samples into the channels.
+
+    Filter state is kept between calls, the buffer length need not be a multiple of the decimation.
+    @param ch the channelizer
+    @param iq_buf input samples, interleaved CU8 or CS16
+    @param sample_size 2 for CU8, 4 for CS16
+    @param len number of input samples
+    @return number of samples written to each channel output, -1 on allocation failure
+*/
+int channelizer_process(channelizer_t *ch, void const *iq_buf, int sample_size, uint32_t len);
+
+/// Return the CS16 output buffer of a channel, valid until the next call to channelizer_process().
+int16_t *channelizer_output(channelizer_t *ch, unsigned channel);
+
+#endif /* INCLUDE_CHANNELIZER_H_ */
@@ -0,0 +1,57 @@
+/** @file
+    OpenCL backend of the polyphase channelizer.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_CHANNELIZER_CL_H_
+#define INCLUDE_CHANNELIZER_CL_H_
+
+#include <stdint.h>
+
+/** Runs the polyphase filter and the inverse DFT of a channelizer on a GPU.
+
+    A whole input buffer is one batch: the raw samples are uploaded once, one work-item
+    per output sample and branch runs the filter, one per output sample and channel
+    the inverse DFT, and the CS16 channel outputs are read back.
+    Without OpenCL support or without a GPU no backend is created.
+*/
+typedef struct channelizer_cl channelizer_cl_t;
+
+/** Create the backend on the first GPU.
+
+    @param channels the number of channels N
+    @param taps the prototype filter length, a multiple of N
+    @param coeffs the prototype filter
+    @return the backend, NULL if there is no OpenCL support, no GPU, or on failure
+*/
+channelizer_cl_t *channelizer_cl_create(unsigned channels, unsigned taps, float const *coeffs);
+
+void channelizer_cl_free(channelizer_cl_t *cl);
+
+/// The name of the device, e.g. for the log.
+char const *channelizer_cl_device(channelizer_cl_t const *cl);
+
+/** Channelize a batch of samples.
+
+    @param cl the backend
+    @param ext the raw input samples, the filter history followed by the new samples, interleaved CU8 or CS16
+    @param ext_len the number of samples in @p ext
+    @param sample_size 2 for CU8, 4 for CS16
+    @param valid the index in @p ext of the first sample of the input, the history before it is zero
+    @param first the index in @p ext of the newest sample of the first output sample
+    @param decimation the input samples per output sample
+    @param n_out the number of output samples
+    @param parity the parity of the index of the first output sample
+    @param out the CS16 output, @p n_out samples of each channel one after the other
+    @return 0 on success, -1 on failure
+*/
+int channelizer_cl_process(channelizer_cl_t *cl, void const *ext, uint32_t ext_len, int sample_size, uint32_t valid,
+        uint32_t first, unsigned decimation, uint32_t n_out, unsigned parity, int16_t *out);
+
+#endif /* INCLUDE_CHANNELIZER_CL_H_ */
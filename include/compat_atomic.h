@@ -0,0 +1,67 @@
+/** @file
+    Minimal atomic load and store for single-producer/single-consumer handshakes,
+    compare-and-swap to publish shared data once or claim a slot, and a spinlock.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_COMPAT_ATOMIC_H_
+#define INCLUDE_COMPAT_ATOMIC_H_
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+// plain volatile accesses have acquire/release semantics with /volatile:ms
+#define atomic_load_acquire(p)      (_ReadWriteBarrier(), *(p))
+#define atomic_store_release(p, v)  do { _ReadWriteBarrier(); *(p) = (v); } while (0)
+/// Store @p desired if @p p still holds @p expected, returns nonzero if stored.
+#define atomic_cas_ptr(p, expected, desired) \
+    (_InterlockedCompareExchangePointer((void *volatile *)(p), (desired), (expected)) == (expected))
+/// Add @p v to the unsigned at @p p, returns the old value.
+#define atomic_fetch_add_unsigned(p, v) ((unsigned)_InterlockedExchangeAdd((long volatile *)(p), (long)(v)))
+/// Subtract @p v from the unsigned at @p p, returns the old value.
+#define atomic_fetch_sub_unsigned(p, v) ((unsigned)_InterlockedExchangeAdd((long volatile *)(p), -(long)(v)))
+/// Store @p desired if the unsigned at @p p still holds @p expected, returns nonzero if stored.
+#define atomic_cas_unsigned(p, expected, desired) \
+    ((unsigned)_InterlockedCompareExchange((long volatile *)(p), (long)(desired), (long)(expected)) == (unsigned)(expected))
+
+#else
+
+#define atomic_load_acquire(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define atomic_store_release(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+/// Add @p v to the unsigned at @p p, returns the old value.
+#define atomic_fetch_add_unsigned(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+/// Subtract @p v from the unsigned at @p p, returns the old value.
+#define atomic_fetch_sub_unsigned(p, v) __atomic_fetch_sub((p), (v), __ATOMIC_ACQ_REL)
+
+/// Store @p desired if @p p still holds @p expected, returns nonzero if stored.
+static inline int atomic_cas_ptr(void **p, void *expected, void *desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/// Store @p desired if the unsigned at @p p still holds @p expected, returns nonzero if stored.
+static inline int atomic_cas_unsigned(unsigned *p, unsigned expected, unsigned desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+#endif
+
+/// Spin until the lock at @p p (initially 0) is taken, only for a few instructions under the lock.
+static inline void atomic_spin_lock(unsigned *p)
+{
+    while (!atomic_cas_unsigned(p, 0, 1)) {
+        // another thread holds the lock
+    }
+}
+
+/// Release a lock taken with atomic_spin_lock().
+#define atomic_spin_unlock(p) atomic_store_release((p), 0)
+
+#endif /* INCLUDE_COMPAT_ATOMIC_H_ */
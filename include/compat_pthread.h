@@ -17,6 +17,7 @@ typedef HANDLE                          pthread_t;
 #define pthread_create(tp, x, p, d)     ((*tp=(HANDLE)_beginthreadex(NULL, 0, p, d, 0, NULL)) == NULL ? -1 : 0)
 #define pthread_cancel(th)              (!TerminateThread(th, 0))
 #define pthread_join(th, p)             (WaitForSingleObject(th, INFINITE))
+#define pthread_detach(th)              (CloseHandle(th) == 0 ? -1 : 0)
 #define pthread_equal(a, b)             ((a) == (b))
 #define pthread_self()                  (GetCurrentThread())
 
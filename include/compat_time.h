@@ -16,6 +16,8 @@
 #include <sys/time.h>
 #endif
 
+#include <stdint.h>
+
 /** Subtract `struct timeval` values.
 
     @param[out] result time difference result
@@ -25,6 +27,12 @@
 */
 int timeval_subtract(struct timeval *result, struct timeval const *x, struct timeval const *y);
 
+/** Get a monotonic time stamp, cheap enough to time single calls.
+
+    @return nanoseconds since an unspecified start, only differences are meaningful
+*/
+uint64_t time_monotonic_ns(void);
+
 // platform-specific functions
 
 #ifdef _WIN32
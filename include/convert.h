@@ -0,0 +1,56 @@
+/** @file
+    Sample format conversion kernels for the dumpers and the file reader.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_CONVERT_H_
+#define INCLUDE_CONVERT_H_
+
+#include <stdint.h>
+
+/** Sample format conversion kernels, the length is the number of output values.
+
+    Variants for SIMD instruction sets are bit-exact with the scalar reference,
+    convert_init() selects the best variant supported by the CPU.
+*/
+typedef struct convert_kernels {
+    char const *name;
+    /// CU8 to CS16, scale Q0.7 to Q0.15.
+    void (*cu8_to_cs16)(uint8_t const *src, int16_t *dst, unsigned long len);
+    /// CS16 to CU8, scale Q0.15 to Q0.7 rounding toward zero.
+    void (*cs16_to_cu8)(int16_t const *src, uint8_t *dst, unsigned long len);
+    /// CU8 to CS8 or CS8 to CU8, flips the sign bit, can convert in place.
+    void (*cu8_cs8)(uint8_t const *src, uint8_t *dst, unsigned long len);
+    /// CS16 to CS8, scale Q0.15 to Q0.7 rounding down.
+    void (*cs16_to_cs8)(int16_t const *src, int8_t *dst, unsigned long len);
+    /// U8 with a bias of 128 to F32, scale Q0.7 to [-1,1).
+    void (*u8_to_f32)(uint8_t const *src, float *dst, unsigned long len);
+    /// S16 to F32, scale Q0.15 to [-1,1).
+    void (*s16_to_f32)(int16_t const *src, float *dst, unsigned long len);
+    /// Every second U8 to F32, i.e. the I channel of CU8, or the Q channel starting at the second value.
+    void (*u8_channel_to_f32)(uint8_t const *src, float *dst, unsigned long len);
+    /// Every second S16 to F32, i.e. the I channel of CS16, or the Q channel starting at the second value.
+    void (*s16_channel_to_f32)(int16_t const *src, float *dst, unsigned long len);
+    /// F32 to S16, scale to Q0.15 rounding toward zero and clamp to [-1,1].
+    void (*f32_to_s16)(float const *src, int16_t *dst, unsigned long len);
+} convert_kernels_t;
+
+/// Select the best kernel variant supported by this CPU, safe to call again, also from other threads.
+void convert_init(void);
+
+/// Return the kernel variant number @p idx supported by this CPU, NULL past the last one, 0 is the scalar reference.
+convert_kernels_t const *convert_kernels_variant(unsigned idx);
+
+/// Return the kernel variant selected by convert_init().
+convert_kernels_t const *convert_kernels(void);
+
+/// Use the kernel variant of this name instead of the best one, e.g. "scalar" for the reference, returns -1 if the CPU does not support it.
+int convert_select(char const *name);
+
+#endif /* INCLUDE_CONVERT_H_ */
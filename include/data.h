@@ -75,8 +75,54 @@ typedef struct data {
     data_value_t value;
     data_type_t type;
     unsigned    retain; /**< incremented on data_retain, data_free only frees if this is zero */
+    unsigned    storage; /**< DATA_BLOCK_START, DATA_OWN_KEY, DATA_OWN_FORMAT, and the well-known key from DATA_KEY_SHIFT */
 } data_t;
 
+/// The item starts the allocation of the items made by one data_make() call, the strings are in the same allocation.
+#define DATA_BLOCK_START 1
+/// The key was replaced with an allocated string, see data_replace_key() and data_borrow_key().
+#define DATA_OWN_KEY 2
+/// The format was replaced with an allocated string, see data_replace_format().
+#define DATA_OWN_FORMAT 4
+/// The well-known key of the item is kept in the storage bits from here.
+#define DATA_KEY_SHIFT 8
+
+/// Well-known keys, items with these keys point to one interned string and are checked with data_key_is().
+enum data_key {
+    DATA_KEY_OTHER, /**< not a well-known key */
+    DATA_KEY_TIME,
+    DATA_KEY_TAG,
+    DATA_KEY_MODEL,
+    DATA_KEY_TYPE,
+    DATA_KEY_SUBTYPE,
+    DATA_KEY_ID,
+    DATA_KEY_CHANNEL,
+    DATA_KEY_MIC,
+    DATA_KEY_PROTOCOL,
+    DATA_KEY_MOD,
+    DATA_KEY_FREQ,
+    DATA_KEY_FREQ1,
+    DATA_KEY_FREQ2,
+    DATA_KEY_RSSI,
+    DATA_KEY_SNR,
+    DATA_KEY_NOISE,
+    DATA_KEY_CODES,
+    DATA_KEY_SRC,
+    DATA_KEY_LVL,
+    DATA_KEY_MSG,
+    DATA_KEY_NUM_ROWS,
+    DATA_KEY_COUNT, /**< invalid */
+};
+
+/// Check if an item has a well-known key, without a string compare.
+#define data_key_is(data, name) (((data)->storage >> DATA_KEY_SHIFT) == (name))
+
+/// Get the well-known key of an item, DATA_KEY_OTHER if it has none.
+#define data_key_of(data) ((enum data_key)((data)->storage >> DATA_KEY_SHIFT))
+
+/// Get the string of a well-known key, e.g. to look up the key once.
+R_API char const *data_key_name(enum data_key key);
+
 /** Constructs a structured data object.
 
     Example:
@@ -89,7 +135,7 @@ typedef struct data {
 
     Most of the time the function copies perhaps what you expect it to. Things
     it copies:
-    - string contents for keys and values
+    - string contents for keys and values, the well-known keys of enum data_key are interned instead
     - numerical arrays
     - string arrays (copied deeply)
 
@@ -170,13 +216,36 @@ R_API data_array_t *data_array(int num_values, data_type_t type, void const *ptr
 /** Releases a data array. */
 R_API void data_array_free(data_array_t *array);
 
+/** Return the number of data items, arrays, and JSON texts allocated so far, to count the allocations per event. */
+R_API unsigned data_alloc_count(void);
+
 /** Retain a structure object, returns the structure object passed in. */
 R_API data_t *data_retain(data_t *data);
 
 /** Releases a structure object if retain is zero, decrement retain otherwise. */
 R_API void data_free(data_t *data);
 
+/** Replace the key of an item with an allocated string, the item takes ownership. */
+R_API void data_replace_key(data_t *data, char *key);
+
+/** Replace the format of an item with an allocated string or NULL, the item takes ownership. */
+R_API void data_replace_format(data_t *data, char *format);
+
+/** Point the key of an item to a string that outlives the item, the item does not take ownership. */
+R_API void data_borrow_key(data_t *data, char const *key);
+
+/** Point the format of an item to a string that outlives the item or NULL, the item does not take ownership. */
+R_API void data_borrow_format(data_t *data, char const *format);
+
 struct data_output;
+struct output_filter;
+
+/** The JSON text of an event, made on the first use and shared by all outputs of the event. */
+typedef struct data_json {
+    data_t *data; ///< the event
+    char *text;   ///< the JSON text, NULL until made by data_output_jsons()
+    size_t len;   ///< length of the text
+} data_json_t;
 
 typedef struct data_output {
     void (R_API_CALLCONV *print_data)(struct data_output *output, data_t *data, char const *format);
@@ -187,7 +256,12 @@ typedef struct data_output {
     void (R_API_CALLCONV *output_start)(struct data_output *output, char const *const *fields, int num_fields);
     void (R_API_CALLCONV *output_print)(struct data_output *output, data_t *data);
     void (R_API_CALLCONV *output_free)(struct data_output *output);
+    void (R_API_CALLCONV *output_flush)(struct data_output *output); ///< optional, waits for queued events
+    void (R_API_CALLCONV *output_poll)(struct data_output *output); ///< optional, called from the timer
     int log_level; ///< the maximum log level (verbosity) allowed, more verbose messages must be ignored.
+    data_json_t *json; ///< the JSON text of the event being printed, see data_output_jsons()
+    struct output_filter *filter; ///< the events not matching are dropped before printing, NULL for all events
+    unsigned tenant; ///< only the events of this tenant pipeline are printed, 0 for the default pipeline
 } data_output_t;
 
 /** Setup known field keys and start output, used by CSV only.
@@ -202,6 +276,21 @@ R_API void data_output_start(struct data_output *output, char const *const *fiel
 /** Prints a structured data object, flushes the output if applicable. */
 R_API void data_output_print(struct data_output *output, data_t *data);
 
+/** Prints an event with the JSON text shared by the outputs, the caller frees the text after the last output. */
+R_API void data_output_print_shared(struct data_output *output, data_t *data, data_json_t *json);
+
+/** Get the JSON text of the event being printed, the text is made only once for all outputs.
+
+    @return the text, or NULL if @p data is not the printed event or there was a memory allocation error.
+*/
+R_API char const *data_output_jsons(struct data_output *output, data_t *data, size_t *len);
+
+/** Waits until the events given to the output are printed, for outputs printing on their own thread. */
+R_API void data_output_flush(struct data_output *output);
+
+/** Lets the output write buffered events, called periodically from the timer. */
+R_API void data_output_poll(struct data_output *output);
+
 R_API void data_output_free(struct data_output *output);
 
 /* data output helpers */
@@ -212,4 +301,9 @@ R_API void print_array_value(data_output_t *output, data_array_t *array, char co
 
 R_API size_t data_print_jsons(data_t *data, char *dst, size_t len);
 
+/** Print the data as compact JSON like data_print_jsons(), but a double always prints with a
+    decimal point or an exponent, e.g. -8.0 as "-8.0" instead of "-8", to read back as a double.
+*/
+R_API size_t data_print_jsons_typed(data_t *data, char *dst, size_t len);
+
 #endif // INCLUDE_DATA_H_
@@ -0,0 +1,56 @@
+/** @file
+    Decimating front-end, shifts and reduces a wide capture to a lower sample rate.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DECIMATOR_H_
+#define INCLUDE_DECIMATOR_H_
+
+#include <stdint.h>
+
+#define DECIMATOR_MAX_FACTOR 64
+
+/** A numerically controlled oscillator, a CIC decimator, and a final half-band stage.
+
+    The NCO mixes the signal at the shift frequency down to baseband, the CIC filter
+    then decimates by factor / 2 and the half-band filter by 2. The usable bandwidth
+    is about half the output sample rate. Output samples are CS16.
+*/
+typedef struct decimator decimator_t;
+
+/// Create a decimator, @p factor must be a power of two from 2 to DECIMATOR_MAX_FACTOR.
+decimator_t *decimator_create(unsigned factor, int shift);
+
+void decimator_free(decimator_t *dec);
+
+/// Clear the filter history, e.g. on a new input stream.
+void decimator_reset(decimator_t *dec);
+
+/// Return the frequency offset of the output from the input center frequency.
+int decimator_shift(decimator_t const *dec);
+
+/// Return the output sample rate for a given input sample rate.
+uint32_t decimator_rate(decimator_t const *dec, uint32_t samp_rate);
+
+/** Shift and decimate a buffer of input samples.
+
+    Filter state is kept between calls, the buffer length need not be a multiple of the factor.
+    @param dec the decimator
+    @param iq_buf input samples, interleaved CU8 or CS16
+    @param sample_size 2 for CU8, 4 for CS16
+    @param len number of input samples
+    @param samp_rate input sample rate, sets the NCO step
+    @return number of samples written to the output, -1 on allocation failure
+*/
+int decimator_process(decimator_t *dec, void const *iq_buf, int sample_size, uint32_t len, uint32_t samp_rate);
+
+/// Return the CS16 output buffer, valid until the next call to decimator_process().
+int16_t *decimator_output(decimator_t *dec);
+
+#endif /* INCLUDE_DECIMATOR_H_ */
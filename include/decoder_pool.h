@@ -0,0 +1,46 @@
+/** @file
+    Runs the decoders of a priority on a worker pool.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DECODER_POOL_H_
+#define INCLUDE_DECODER_POOL_H_
+
+struct r_device;
+struct r_cfg;
+struct data;
+struct bitbuffer;
+
+/** Decoders of the same priority only read the package and write their own state,
+    they are run in parallel and their output is replayed in the order of the decoders.
+
+    Decoders with the same slice group share the sliced bits, they run in order on one task.
+    The tasks with the highest hit rate of their decoders are started first.
+*/
+typedef struct decoder_pool decoder_pool_t;
+
+/// Run one decoder on the current package with the scratch bits of the worker, returns the number of events.
+typedef int (*decoder_pool_fn)(struct r_device *decoder, struct bitbuffer *bits, void *ctx);
+
+/// Create a pool of @p threads workers including the caller, returns NULL if threads are not available.
+decoder_pool_t *decoder_pool_create(unsigned threads);
+
+void decoder_pool_free(decoder_pool_t *pool);
+
+/// Run @p fn on each of the @p count decoders, then replay the output in the order of the decoders.
+/// Returns the sum of the events.
+int decoder_pool_run(decoder_pool_t *pool, void **decoders, unsigned count, decoder_pool_fn fn, void *ctx);
+
+/// Check if the caller runs a decoder of the pool.
+int decoder_pool_is_current(decoder_pool_t *pool);
+
+/// Keep the output if the caller runs a decoder of the pool, returns 1 if the data was taken.
+int decoder_pool_keep_output(decoder_pool_t *pool, struct r_cfg *cfg, struct data *data, int level);
+
+#endif /* INCLUDE_DECODER_POOL_H_ */
@@ -0,0 +1,64 @@
+/** @file
+    Usage of each decoder, for a config of the protocols seen at a site.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DECODER_USAGE_H_
+#define INCLUDE_DECODER_USAGE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** Totals of the successful decodes, the aborts, and the time of each decoder.
+
+    E.g. most of the default decoders never decode a message at a site, but each still
+    slices and checks every package. The totals are recorded over a period and then
+    written as a config with a protocol line for each decoder that decoded a message,
+    with the share of the decoder time the others used, i.e. the time saved with the config.
+
+    The decoders are kept by protocol number, those without one, e.g. flex decoders, by name.
+    The totals of each stats interval are added, the receivers add from their own threads.
+    Adding and cloning are locked, a shared table is cloned to be written.
+*/
+typedef struct decoder_usage decoder_usage_t;
+
+/// Create an empty table, returns NULL on failure.
+decoder_usage_t *decoder_usage_create(void);
+
+void decoder_usage_free(decoder_usage_t *usage);
+
+/// Copy a table, e.g. to add the counts not yet recorded, returns NULL on failure.
+decoder_usage_t *decoder_usage_clone(decoder_usage_t *usage);
+
+/** Add the counts of a decoder.
+
+    @param usage the table
+    @param protocol_num the protocol number, 0 to keep the decoder by name
+    @param name the decoder name
+    @param ok the successful decodes
+    @param aborts the decodes that failed or aborted
+    @param cpu_ns the time spent slicing and decoding
+*/
+void decoder_usage_add(decoder_usage_t *usage, unsigned protocol_num, char const *name, unsigned ok, unsigned aborts, uint64_t cpu_ns);
+
+/// The number of decoders with a successful decode.
+unsigned decoder_usage_seen(decoder_usage_t const *usage);
+
+/** Write a config with a protocol line for each decoder with a successful decode.
+
+    The header comments estimate the time saved, the decoders not seen are listed as comments.
+
+    @param usage the table
+    @param fp the file to write to
+    @param seconds the time the table was recorded over
+    @return 0 on success, -1 on a write error
+*/
+int decoder_usage_write(decoder_usage_t const *usage, FILE *fp, double seconds);
+
+#endif /* INCLUDE_DECODER_USAGE_H_ */
@@ -38,6 +38,19 @@ r_device *decoder_create(r_device const *dev_template, unsigned user_data_size);
 /// The memory can be freely used by a decoder and is of the size given to `decoder_create()`.
 void *decoder_user_data(r_device *decoder);
 
+/// Search the preamble the decoder declared, works as `bitbuffer_search()` on `decoder->preamble.pattern`.
+///
+/// The offsets may come from one scan of the bits for all decoders of the same slicer,
+/// call this only on the bits given to the decoder, unchanged or inverted in full if `preamble.inverted` is set.
+unsigned decoder_search_preamble(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned start);
+
+/// Manchester decode a row, works as `bitbuffer_manchester_decode()`.
+///
+/// The decoded bits may come from one decoding of the rows for all decoders of the same slicer,
+/// call this only on the bits given to the decoder, unchanged or inverted in full.
+unsigned decoder_manchester_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        bitbuffer_t *outbuf, unsigned max);
+
 /// Output data.
 void decoder_output_data(r_device *decoder, data_t *data);
 
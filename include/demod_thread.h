@@ -0,0 +1,74 @@
+/** @file
+    Demodulation worker thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DEMOD_THREAD_H_
+#define INCLUDE_DEMOD_THREAD_H_
+
+#include "sdr.h"
+
+struct mg_mgr;
+struct data;
+
+/** Moves the demodulation off the event loop.
+
+    SDR events are queued by the acquire thread and processed on the demod thread.
+    Output data produced on the demod thread is queued and handed back to the
+    event loop, there the data is passed to the outputs.
+*/
+typedef struct demod_thread demod_thread_t;
+
+/// Process an SDR event, called on the demod thread.
+typedef void (*demod_process_fn)(sdr_event_t *ev, void *ctx);
+
+/// Deliver output data, called on the event loop thread.
+typedef void (*demod_deliver_fn)(struct data *data, int level, void *ctx);
+
+/** Create and start the demod thread, returns NULL if threads are not available.
+
+    @param queue_size the most data events queued, at least the number of SDR ring slots,
+                      the control events have room of their own
+*/
+demod_thread_t *demod_thread_start(struct mg_mgr *mgr, unsigned queue_size, demod_process_fn process, demod_deliver_fn deliver, void *ctx);
+
+/// Stop the demod thread, discards pending SDR events and delivers pending output data.
+void demod_thread_stop(demod_thread_t *dt);
+
+/** Queue an SDR event, never blocks.
+
+    A data event holds its ring slot until processed, it always fits while the ring has no more than queue_size slots.
+    Returns -1 and counts the event as dropped if the room of the control events is full.
+*/
+int demod_thread_push(demod_thread_t *dt, sdr_event_t const *ev);
+
+/** Merge queued data events into larger blocks while the demod thread is behind.
+
+    Data buffers that directly follow each other in memory, as consecutive ring slots do,
+    are handed to the process function as one event of up to @p merge_len bytes.
+    The merged count of the event tells how many more ring slots it holds.
+
+    @param dt the demod thread
+    @param merge_len the maximum length of a merged event in bytes, 0 to disable
+*/
+void demod_thread_set_merge(demod_thread_t *dt, unsigned merge_len);
+
+/// Discard all pending SDR events and wait for the event currently processed, e.g. before closing the SDR.
+void demod_thread_drain(demod_thread_t *dt);
+
+/// Check if the caller runs on the demod thread.
+int demod_thread_is_current(demod_thread_t *dt);
+
+/// Queue output data from the demod thread for the event loop, takes ownership of the data.
+void demod_thread_post(demod_thread_t *dt, struct data *data, int level);
+
+/// Deliver all queued output data, must be called on the event loop thread.
+void demod_thread_flush(demod_thread_t *dt);
+
+#endif /* INCLUDE_DEMOD_THREAD_H_ */
@@ -0,0 +1,62 @@
+/** @file
+    Duty-cycled listening for periodic transmitters.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DUTY_CYCLE_H_
+#define INCLUDE_DUTY_CYCLE_H_
+
+#include <stdint.h>
+
+/** Learns the period of each transmitter and only listens when one is due.
+
+    Most sensors transmit every 30 to 120 seconds for a fraction of a second, the input
+    is mostly noise. After a full listen window the period of each transmitter (by model
+    and id) is known and only the windows around the next transmissions are demodulated,
+    widened by a tolerance and a drift allowance that grows with the time since the
+    transmitter was last heard. A full listen window repeats to catch new transmitters.
+
+    Without a periodic transmitter learned the input is always demodulated.
+    A transmitter missing several periods in a row is dropped until heard again.
+
+    All times are in ms of the input, e.g. sample positions, and don't depend on the wall time.
+    Events and frames may be fed from different threads.
+*/
+typedef struct duty_cycle duty_cycle_t;
+
+/** Create a duty cycle.
+
+    @param survey_ms the length of a full listen window, the first starts with the input
+    @param every_ms the time from the start of one full listen window to the next, at least survey_ms
+    @return the duty cycle, NULL on failure
+*/
+duty_cycle_t *duty_cycle_create(uint64_t survey_ms, uint64_t every_ms);
+
+void duty_cycle_free(duty_cycle_t *dc);
+
+/** Account an event of a transmitter.
+
+    @param dc the duty cycle
+    @param key the transmitter, e.g. model and id
+    @param time_ms the time of the transmission
+*/
+void duty_cycle_event(duty_cycle_t *dc, char const *key, uint64_t time_ms);
+
+/** Check if the input at a time should be demodulated.
+
+    @param dc the duty cycle
+    @param time_ms the time of the start of a frame, not decreasing
+    @return 1 to demodulate the frame, 0 to skip it
+*/
+int duty_cycle_listen(duty_cycle_t *dc, uint64_t time_ms);
+
+/// The number of periodic transmitters currently expected.
+unsigned duty_cycle_periodic(duty_cycle_t *dc);
+
+#endif /* INCLUDE_DUTY_CYCLE_H_ */
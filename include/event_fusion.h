@@ -0,0 +1,75 @@
+/** @file
+    Cross-receiver event fusion, drops the events other receivers got with a better signal.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_FUSION_H_
+#define INCLUDE_EVENT_FUSION_H_
+
+#include <stdint.h>
+
+struct mg_mgr;
+struct data;
+
+/** Receivers in range of the same sensors join a multicast group and output each message once.
+
+    Each decoded event gets a fingerprint, a hash of the protocol and the decoded items,
+    and is held for a window. The receivers announce the fingerprint and the RSSI of their
+    events to the group. Only the copy with the best RSSI is output, the lowest node id
+    wins a tie. An event is output when the window ends without a better copy.
+
+    The fingerprint is taken before the time, tags, and meta data are added,
+    receivers with different options still agree on the same message.
+    Repeats of a message within the window are fused on a single receiver, too.
+*/
+typedef struct event_fusion event_fusion_t;
+
+/// Outputs an event that won the fusion, takes ownership of the data.
+typedef void (*event_fusion_output_fn)(void *ctx, struct data *data);
+
+/** Join the multicast group and start exchanging fingerprints.
+
+    @param mgr the event loop to receive the announcements on
+    @param host the multicast group, e.g. 239.255.43.3
+    @param port the UDP port of the group
+    @param window_ms how long to hold an event for the announcements of the other receivers
+    @param ttl the multicast TTL, 1 to stay on the local network
+    @param output_fn called on the event loop for each event to output
+    @param ctx passed to the output callback
+    @return the fusion, NULL on error
+*/
+event_fusion_t *event_fusion_create(struct mg_mgr *mgr, char const *host, char const *port, unsigned window_ms, int ttl,
+        event_fusion_output_fn output_fn, void *ctx);
+
+/// Output the events still held and leave the group, the fusion may be NULL.
+void event_fusion_free(event_fusion_t *fusion);
+
+/** Mark a decoded event for the fusion, the mark travels with the event to the event loop.
+
+    @param data the event, the mark is prepended
+    @param hash the fingerprint of the message
+    @param rssi_db the signal level of the package
+    @return the marked event
+*/
+struct data *event_fusion_mark(struct data *data, uint64_t hash, float rssi_db);
+
+/** Take a marked event on the event loop.
+
+    The mark is removed, the event is held or dropped, and output later through the callback.
+
+    @param fusion the fusion
+    @param data the event
+    @return 1 if the event was taken, 0 if it is not marked and should be output now
+*/
+int event_fusion_hold(event_fusion_t *fusion, struct data *data);
+
+/// Number of events dropped because another copy was better.
+unsigned event_fusion_dropped(event_fusion_t const *fusion);
+
+#endif /* INCLUDE_EVENT_FUSION_H_ */
@@ -0,0 +1,78 @@
+/** @file
+    Merges the events of several inputs into the order of their sample time.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_MERGE_H_
+#define INCLUDE_EVENT_MERGE_H_
+
+#include <stdint.h>
+
+struct data;
+
+/// Most events held, beyond that the earliest is output early.
+#define EVENT_MERGE_MAX_HELD 4096
+
+/** Receivers, channels, and input files each deliver their events in order, but the
+    events of the different sources are interleaved by the thread timing or delivered in
+    source order after each buffer. The merge holds the events of each source in a queue
+    and outputs them by a k-way merge on a heap of the sources, earliest event first.
+
+    Each source also reports its progress, the time before which it has no more events.
+    An event is output once every source progressed past its time, the order is then
+    exact and the same on each run of a file input. A source lagging more than the window
+    behind the latest progress of any source does not hold back the others, its events
+    are then output as they come, and counted as late if they are before an event output.
+    All times are in us of the sample positions, not of the wall time.
+
+    The mark with the source and the time travels with the event to the output thread.
+    Only the output thread holds and outputs the events.
+*/
+typedef struct event_merge event_merge_t;
+
+/// Outputs an event in merged order, takes ownership of the data.
+typedef void (*event_merge_output_fn)(void *ctx, struct data *data);
+
+/** Create a merge.
+
+    @param window_ms how far a source may lag behind the others before its events are not waited for
+    @param output_fn called for each event in merged order
+    @param ctx passed to the output callback
+    @return the merge, NULL on failure
+*/
+event_merge_t *event_merge_create(unsigned window_ms, event_merge_output_fn output_fn, void *ctx);
+
+/// Output the events still held and free the merge, the merge may be NULL.
+void event_merge_free(event_merge_t *merge);
+
+/** Mark an event with its source and time, the mark is prepended.
+
+    Without an event, i.e. @p data NULL, the mark only reports the progress of the source.
+
+    @param data the event, or NULL for the progress only
+    @param source the source, e.g. the config of the input
+    @param time_us the time of the event, or the progress of the source
+    @return the marked event
+*/
+struct data *event_merge_mark(struct data *data, void const *source, int64_t time_us);
+
+/** Take a marked event on the output thread.
+
+    The mark is removed, the event is held, and output later through the callback.
+
+    @param merge the merge
+    @param data the event
+    @return 1 if the event was taken, 0 if it is not marked and should be output now
+*/
+int event_merge_hold(event_merge_t *merge, struct data *data);
+
+/// Number of events output after a later event of another source.
+unsigned event_merge_late(event_merge_t const *merge);
+
+#endif /* INCLUDE_EVENT_MERGE_H_ */
@@ -0,0 +1,103 @@
+/** @file
+    Append-only store of events in memory-mapped segment files.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_STORE_H_
+#define INCLUDE_EVENT_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct data;
+
+#define EVENT_STORE_VERSION 1
+/// Bytes of the segment header.
+#define EVENT_STORE_HEADER_SIZE 16
+/// Bytes of the record header, the JSON text follows.
+#define EVENT_STORE_RECORD_SIZE 20
+/// Records between the marks of the sparse time index.
+#define EVENT_STORE_INDEX_STRIDE 64
+/// Default bytes of a segment file.
+#define EVENT_STORE_SEGMENT_SIZE (16 * 1024 * 1024)
+/// Default segment files kept, the oldest is deleted for a new one.
+#define EVENT_STORE_SEGMENTS 16
+
+/*
+    The store is a directory of segment files "events-<seq>.store", a new segment is started
+    once the next record does not fit. All values are little endian.
+
+    Segment header:
+    - 0: magic "RES", version
+    - 4: u32 header size
+    - 8: i64 creation time in us since the epoch
+
+    Each record:
+    - 0: u32 length of the text, 0 ends the segment
+    - 4: u32 hash of the model
+    - 8: u32 hash of the model and id
+    - 12: i64 store time in us since the epoch
+    - 20: the JSON text of the event
+
+    The segment being written is sized up front and mapped, the unwritten rest is zero.
+    The time index and the index of the sensors are kept in memory and built from the records on open.
+*/
+
+typedef struct event_store event_store_t;
+
+/** Open the store in a directory, created if needed, the segments found are indexed and a new one is started.
+
+    @param dir the directory of the segment files
+    @param segment_size bytes of a segment file, 0 for the default
+    @param segments segment files kept, 0 for the default
+    @return the store, NULL on failure
+*/
+event_store_t *event_store_open(char const *dir, size_t segment_size, unsigned segments);
+
+/// Close the store, the segment being written is truncated to its records.
+void event_store_close(event_store_t *store);
+
+/** Append the JSON text of an event, events without a model are not stored.
+
+    @param store the store
+    @param data the event, for the model and id
+    @param text the JSON text of the event
+    @param len the length of the text
+    @param time_us the store time in us since the epoch
+    @return 0 on success, -1 if the event was not stored
+*/
+int event_store_append(event_store_t *store, struct data *data, char const *text, size_t len, int64_t time_us);
+
+/// A selection of stored events.
+typedef struct event_query {
+    int64_t from_us;   ///< the earliest store time
+    int64_t to_us;     ///< the latest store time
+    char const *model; ///< only events of this model, NULL for all
+    char const *id;    ///< only events of this id, with a model, NULL for all
+    unsigned limit;    ///< most events returned, 0 for no limit
+} event_query_t;
+
+/// Called with each event of a query, oldest first.
+typedef void (*event_store_fn)(void *ctx, int64_t time_us, char const *text, size_t len);
+
+/** Find the events of a query, assumes ascending store times as from the wall clock.
+
+    @param store the store
+    @param query the selection
+    @param fn called with each event
+    @param ctx passed to @p fn
+    @param[out] next_us the store time of the first event past the limit, 0 if there is none
+    @return the number of events
+*/
+unsigned event_store_query(event_store_t const *store, event_query_t const *query, event_store_fn fn, void *ctx, int64_t *next_us);
+
+/// Number of events in the store.
+unsigned event_store_count(event_store_t const *store);
+
+#endif /* INCLUDE_EVENT_STORE_H_ */
@@ -0,0 +1,69 @@
+/** @file
+    Per sensor rate limit of the events, with the numeric values aggregated.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_THROTTLE_H_
+#define INCLUDE_EVENT_THROTTLE_H_
+
+#include <stdint.h>
+
+struct data;
+
+/// The numeric values of an event output by the throttle.
+typedef enum throttle_mode {
+    THROTTLE_LATEST, ///< the values of the event output
+    THROTTLE_AVG,    ///< the average of each value over the events since the last output
+    THROTTLE_MIN,    ///< the minimum of each value over the events since the last output
+    THROTTLE_MAX,    ///< the maximum of each value over the events since the last output
+} throttle_mode_t;
+
+/** Outputs each sensor at most once per interval.
+
+    E.g. energy monitors and TPMS send every few seconds, a time series only needs one sample a minute.
+    The first event of a sensor (by model, id, and channel) is output and starts an interval.
+    The events within the interval are dropped, before any conversion or formatting, only their
+    numeric values are kept. The first event after the interval is output and starts the next one,
+    its numeric values are the average, minimum, or maximum over the events since the last output
+    if selected. The id and channel are never aggregated, integer values stay integers.
+    The events dropped at the end of the input are not output.
+
+    The sensors are kept in a hash table, a sensor not heard for two intervals is forgotten
+    when the table grows. All times are in ms of the input, e.g. sample positions, and don't
+    depend on the wall time. Events may be fed from different threads.
+*/
+typedef struct event_throttle event_throttle_t;
+
+/** Create a throttle.
+
+    @param interval_ms the shortest time between two events of a sensor output
+    @param mode the numeric values of an event output
+    @return the throttle, NULL on failure
+*/
+event_throttle_t *event_throttle_create(uint64_t interval_ms, throttle_mode_t mode);
+
+void event_throttle_free(event_throttle_t *throttle);
+
+/** Check an event of a sensor.
+
+    @param throttle the throttle
+    @param key the sensor, e.g. model, id, and channel
+    @param data the event, the numeric values are replaced if the event is output and aggregated
+    @param time_ms the time of the event
+    @return 1 to output the event, 0 to drop it
+*/
+int event_throttle_pass(event_throttle_t *throttle, char const *key, struct data *data, uint64_t time_ms);
+
+/// The number of events dropped.
+unsigned event_throttle_dropped(event_throttle_t *throttle);
+
+/// The number of sensors tracked.
+unsigned event_throttle_sensors(event_throttle_t *throttle);
+
+#endif /* INCLUDE_EVENT_THROTTLE_H_ */
@@ -0,0 +1,50 @@
+/** @file
+    Sample file writer, writes the buffers of a dumper on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_FILE_WRITER_H_
+#define INCLUDE_FILE_WRITER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+/// Megabytes of samples queued for the writer of a dumper before the caller waits.
+#define FILE_WRITER_BUFFER_MB 16
+/// Buffers in the ring of a writer, each holds the samples of one frame.
+#define FILE_WRITER_BUFFERS 64
+
+typedef struct file_writer file_writer_t;
+
+/** Open a writer for a file, the buffers are written on a thread.
+
+    Without threads each buffer is written when it is committed.
+
+    @param file the file to write, not closed by the writer
+    @param zstd compress the samples with zstd
+    @param buffer_mb megabytes of samples queued before the caller waits
+    @return the writer, NULL if it can't be created
+*/
+file_writer_t *file_writer_open(FILE *file, int zstd, unsigned buffer_mb);
+
+/** Get the next buffer of the ring to fill with samples, waits if the ring is full.
+
+    @param writer the writer
+    @param len the bytes needed
+    @return the buffer, NULL if out of memory
+*/
+void *file_writer_reserve(file_writer_t *writer, size_t len);
+
+/// Queue the reserved buffer with len bytes of samples, returns -1 if writing the file failed.
+int file_writer_commit(file_writer_t *writer, size_t len);
+
+/// Write the queued buffers, end a compressed stream, and free the writer, returns -1 if anything failed.
+int file_writer_close(file_writer_t *writer);
+
+#endif /* INCLUDE_FILE_WRITER_H_ */
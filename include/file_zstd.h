@@ -0,0 +1,60 @@
+/** @file
+    Streaming zstd compressed sample files, with the decompression on a thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_FILE_ZSTD_H_
+#define INCLUDE_FILE_ZSTD_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+/// Bytes of samples in a block decompressed ahead.
+#define ZSTD_FILE_BLOCK_SIZE (1 << 18)
+/// Blocks decompressed ahead.
+#define ZSTD_FILE_BLOCKS 4
+/// Compression level of written files, fast enough for the sample rate of a live receiver.
+#define ZSTD_FILE_LEVEL 1
+
+typedef struct zstd_reader zstd_reader_t;
+
+/** Open a reader decompressing a file ahead on a thread.
+
+    Without threads the blocks are decompressed as they are read.
+
+    @param file the compressed file, not closed by the reader
+    @return the reader, NULL if zstd is not available
+*/
+zstd_reader_t *zstd_reader_open(FILE *file);
+
+/// Read up to len bytes of samples, returns the number of bytes read, less only at the end or on errors.
+size_t zstd_reader_read(zstd_reader_t *reader, void *dst, size_t len);
+
+/// Stop the thread and free the reader.
+void zstd_reader_close(zstd_reader_t *reader);
+
+typedef struct zstd_encoder zstd_encoder_t;
+
+/// Create an encoder for one compressed stream, NULL if zstd is not available.
+zstd_encoder_t *zstd_encoder_create(void);
+
+/** Compress samples and write the output to a file.
+
+    @param encoder the encoder
+    @param file the file to write
+    @param src the samples
+    @param len the length of the samples in bytes
+    @param end flush and end the frame after these samples
+    @return 0 on success, -1 if the compression or the file failed
+*/
+int zstd_encoder_write(zstd_encoder_t *encoder, FILE *file, void const *src, size_t len, int end);
+
+void zstd_encoder_free(zstd_encoder_t *encoder);
+
+#endif /* INCLUDE_FILE_ZSTD_H_ */
@@ -41,6 +41,8 @@ enum file_type {
     F_LOGIC    = 5 << 16,
     F_VCD      = 6 << 16,
     F_OOK      = 7 << 16,
+    F_PULSES   = 8 << 16,
+    F_RLE      = 9 << 16,
     // format types
     F_U8       = F_1CH | F_UNSIGNED | F_INT | F_W8,
     F_S8       = F_1CH | F_SIGNED   | F_INT | F_W8,
@@ -70,6 +72,8 @@ enum file_type {
     U8_LOGIC   = F_LOGIC | F_U8,
     VCD_LOGIC  = F_VCD,
     PULSE_OOK  = F_OOK,
+    PULSE_ARCHIVE = F_PULSES,
+    RLE_LOGIC  = F_RLE,
 };
 
 typedef struct {
@@ -80,6 +84,11 @@ typedef struct {
     char const *spec;
     char const *path;
     FILE *file;
+    int zstd;                   ///< the samples are zstd compressed, from a "zst" tag
+    int sigmf;                  ///< a SigMF recording, from a "sigmf" tag
+    struct file_writer *writer; ///< writes the samples to file on a thread
+    struct pulse_archive_writer *archive; ///< writes the packages to a pulse archive
+    uint64_t rle_pos;           ///< the samples written to a run-length logic dump
 } file_info_t;
 
 /// Clear all file info.
@@ -100,7 +109,11 @@ void file_info_clear(file_info_t *info);
 /// - 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 /// - 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 /// - text formats: "vcd", "ook"
+/// - pulse archive: "rpa"
+/// - run-length logic: "rle"
+/// - SigMF recording: "sigmf", e.g. path/filename.sigmf-data
 /// - content types: "iq", "i", "q", "am", "fm", "logic"
+/// - compression: "zst", e.g. path/filename.cu8.zst
 ///
 /// Parses left to right, with the exception of a prefix up to the last colon ":"
 /// This prefix is the forced override, parsed last and removed from the filename.
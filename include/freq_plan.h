@@ -0,0 +1,67 @@
+/** @file
+    Multi-device frequency coverage planner.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_FREQ_PLAN_H_
+#define INCLUDE_FREQ_PLAN_H_
+
+#include <stdint.h>
+
+/// Maximum number of wanted frequencies, and of center frequencies of a device.
+#define FREQ_PLAN_MAX_FREQS 32
+/// Maximum number of devices.
+#define FREQ_PLAN_MAX_DEVICES 32
+
+/** Places the center frequencies of several devices so each wanted frequency is in a passband.
+
+    The usable passband of a device is 80% of its sample rate, less a guard around the
+    DC spike in the middle. The widest devices are tuned statically to the centers covering
+    the most wanted frequencies, the last device hops over the centers for the frequencies
+    left, if any. Devices not needed for the coverage double the first device.
+*/
+typedef struct freq_plan freq_plan_t;
+
+/** Create a plan.
+
+    @param wanted the wanted frequencies in Hz
+    @param wanted_count the number of wanted frequencies
+    @param samp_rate the sample rate of each device
+    @param devices the number of devices
+    @return the plan, NULL on invalid counts or alloc failure
+*/
+freq_plan_t *freq_plan_create(uint32_t const *wanted, unsigned wanted_count, uint32_t const *samp_rate, unsigned devices);
+
+void freq_plan_free(freq_plan_t *plan);
+
+/// Return the number of center frequencies of a device, it hops if there is more than one.
+unsigned freq_plan_centers(freq_plan_t const *plan, unsigned device);
+
+/// Return a center frequency of a device.
+uint32_t freq_plan_center(freq_plan_t const *plan, unsigned device, unsigned index);
+
+/// Return the number of wanted frequencies.
+unsigned freq_plan_wanted_count(freq_plan_t const *plan);
+
+/// Return a wanted frequency.
+uint32_t freq_plan_wanted(freq_plan_t const *plan, unsigned wanted);
+
+/** Return the device covering a wanted frequency.
+
+    @param plan the plan
+    @param wanted the index of the wanted frequency
+    @param[out] center the index of the center frequency of the device covering it
+    @return the device index
+*/
+unsigned freq_plan_device(freq_plan_t const *plan, unsigned wanted, unsigned *center);
+
+/// Check if a center frequency covers a frequency for a sample rate.
+int freq_plan_covers(uint32_t center, uint32_t frequency, uint32_t samp_rate);
+
+#endif /* INCLUDE_FREQ_PLAN_H_ */
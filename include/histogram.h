@@ -0,0 +1,65 @@
+/** @file
+    Histogram of pulse and gap widths.
+
+    Copyright (C) 2015 Tommy Vestermark
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_HISTOGRAM_H_
+#define INCLUDE_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#define MAX_HIST_BINS 16
+
+/// Histogram data for single bin
+typedef struct {
+    unsigned count;
+    int sum;
+    int mean;
+    int min;
+    int max;
+} hist_bin_t;
+
+/// Histogram data for all bins
+typedef struct {
+    unsigned bins_count;
+    hist_bin_t bins[MAX_HIST_BINS];
+} histogram_t;
+
+/// Generate a histogram (unsorted), returns the number of values that did not fit the bins.
+unsigned histogram_sum(histogram_t *hist, int const *data, unsigned len, float tolerance);
+
+/** Generate a histogram of clusters of the sorted data, in O(n log n).
+
+    The bins are sorted by mean and don't overlap, each value is in the bin of its range.
+    No value is dropped, beyond MAX_HIST_BINS clusters the closest neighbour bins are merged.
+*/
+void histogram_cluster(histogram_t *hist, int const *data, unsigned len, float tolerance);
+
+/// Delete bin from histogram
+void histogram_delete_bin(histogram_t *hist, unsigned index);
+
+/// Swap two bins in histogram
+void histogram_swap_bins(histogram_t *hist, unsigned index1, unsigned index2);
+
+/// Sort histogram with mean value (order lowest to highest)
+void histogram_sort_mean(histogram_t *hist);
+
+/// Sort histogram with count value (order lowest to highest)
+void histogram_sort_count(histogram_t *hist);
+
+/// Fuse histogram bins with means within tolerance
+void histogram_fuse_bins(histogram_t *hist, float tolerance);
+
+/// Find bin index
+int histogram_find_bin_index(histogram_t const *hist, int width);
+
+/// Print a histogram
+void histogram_print(histogram_t const *hist, uint32_t samp_rate);
+
+#endif /* INCLUDE_HISTOGRAM_H_ */
@@ -0,0 +1,69 @@
+/** @file
+    Activity-adaptive frequency hop scheduler.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_HOP_SCHEDULER_H_
+#define INCLUDE_HOP_SCHEDULER_H_
+
+#include <stdint.h>
+
+/** Hops the frequencies round-robin with a dwell time weighed by the activity of each frequency.
+
+    The base dwell times (-H) of all frequencies are one cycle, the cycle is shared out
+    by the rate of events and packages seen on each frequency, a quiet frequency keeps
+    a quarter of its base dwell time.
+
+    Events are tracked for periodic transmitters, e.g. sensors sending every 30 to 60 seconds,
+    a frequency expecting a transmission pre-empts the current dwell shortly before it is due.
+
+    All times are sample positions of the input, dwell times are exact to a frame
+    and don't depend on the wall time.
+*/
+typedef struct hop_scheduler hop_scheduler_t;
+
+/** Create a scheduler.
+
+    @param frequencies the number of frequencies, at least 2
+    @param hop_time the base dwell time in seconds of each frequency, the last one repeats
+    @param hop_times the number of base dwell times
+    @param sample_rate the sample rate of the positions
+    @param index the current frequency
+    @param pos the sample position the current dwell started
+    @return the scheduler, NULL on failure
+*/
+hop_scheduler_t *hop_scheduler_create(unsigned frequencies, int const *hop_time, unsigned hop_times, uint32_t sample_rate, unsigned index, uint64_t pos);
+
+void hop_scheduler_free(hop_scheduler_t *sched);
+
+/** Account a frame of the current frequency.
+
+    @param sched the scheduler
+    @param pos the sample position at the end of the frame
+    @param packages the number of packages detected in the frame
+    @param events the number of decoder events in the frame
+    @return 1 if it's time to hop, 0 otherwise
+*/
+int hop_scheduler_frame(hop_scheduler_t *sched, uint64_t pos, unsigned packages, unsigned events);
+
+/** End the dwell of the current frequency and choose the next one.
+
+    @param sched the scheduler
+    @param pos the sample position of the hop
+    @return the index of the next frequency
+*/
+unsigned hop_scheduler_next(hop_scheduler_t *sched, uint64_t pos);
+
+/// The dwell time in ms a frequency currently gets in a cycle.
+unsigned hop_scheduler_dwell_ms(hop_scheduler_t const *sched, unsigned index);
+
+/// The number of periodic transmitters currently expected on a frequency.
+unsigned hop_scheduler_periodic(hop_scheduler_t const *sched, unsigned index);
+
+#endif /* INCLUDE_HOP_SCHEDULER_H_ */
@@ -14,9 +14,21 @@
 
 #include "data.h"
 
+#include <stddef.h>
+
 struct mg_mgr;
 struct r_cfg;
+struct event_store;
+
+/** Construct the HTTP-API server output.
+
+    @param client_bytes bytes of events queued for a slow client before the oldest are dropped, 0 for the default
+    @param history_bytes bytes of events kept to replay to new and resuming clients, 0 for the default
+    @param store the events on disk for "/history", owned by the output, NULL for none
+*/
+/// Return the bytes of history and one client queue a server with these options holds at most.
+size_t http_server_bytes(unsigned client_bytes, unsigned history_bytes);
 
-struct data_output *data_output_http_create(struct mg_mgr *mgr, const char *host, const char *port, struct r_cfg *cfg);
+struct data_output *data_output_http_create(struct mg_mgr *mgr, const char *host, const char *port, struct r_cfg *cfg, unsigned client_bytes, unsigned history_bytes, struct event_store *store);
 
 #endif /* INCLUDE_HTTP_SERVER_H_ */
@@ -0,0 +1,49 @@
+/** @file
+    Log scale histogram of delays.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_LATENCY_HIST_H_
+#define INCLUDE_LATENCY_HIST_H_
+
+#include <stdint.h>
+
+/// Number of bins, the last bin counts the delays over the largest bound.
+#define LATENCY_HIST_US_BINS 16
+
+/// Upper bounds of the bins in us, 1-2-5 steps from 10 us to 500 ms.
+extern unsigned const latency_hist_bounds_us[LATENCY_HIST_US_BINS - 1];
+
+/** Counts of delays in bins with a constant relative width, like an HDR histogram with a coarse precision.
+
+    A zero initialized histogram is empty.
+*/
+typedef struct latency_hist {
+    unsigned counts[LATENCY_HIST_US_BINS];
+    unsigned max_us;
+} latency_hist_t;
+
+/// Count a delay in us, negative delays count as 0.
+void latency_hist_add(latency_hist_t *hist, int64_t delay_us);
+
+/// Add the counts of another histogram.
+void latency_hist_merge(latency_hist_t *hist, latency_hist_t const *other);
+
+/// Return the number of delays counted.
+unsigned latency_hist_count(latency_hist_t const *hist);
+
+/** Estimate a percentile of the delays.
+
+    @param hist the histogram
+    @param pct the percentile, 0 to 100
+    @return the upper bound of the bin holding the percentile in us, at most the largest delay, 0 if empty
+*/
+unsigned latency_hist_percentile(latency_hist_t const *hist, unsigned pct);
+
+#endif /* INCLUDE_LATENCY_HIST_H_ */
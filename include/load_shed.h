@@ -0,0 +1,72 @@
+/** @file
+    Load shedding of an input that can't keep up with its samples.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_LOAD_SHED_H_
+#define INCLUDE_LOAD_SHED_H_
+
+#include <stdint.h>
+
+/// The steps of the load shedding, each step keeps the ones before.
+typedef enum load_shed_step {
+    LOAD_SHED_OFF,      ///< all stages run
+    LOAD_SHED_FM,       ///< no FM demod on the frequencies without FSK decoders
+    LOAD_SHED_PRIORITY, ///< only the decoders of priority 0 run
+    LOAD_SHED_SQUELCH,  ///< the noise only frames are skipped, the channels are only demodulated with activity
+    LOAD_SHED_STEPS,
+} load_shed_step_t;
+
+/** Steps the load shedding by the realtime load of an input.
+
+    The realtime load is the time spent on a buffer against the signal time of the buffer,
+    over 1 the input falls behind and the SDR drops samples. The load is smoothed over
+    about a second of signal time. Over the high load the next step is taken, under the
+    low load the last step is undone. A step is held a few seconds before the next one,
+    and longer before it is undone, the load is measured with the step in effect.
+
+    All times are of the signal, e.g. sample positions, the buffers are fed from one thread.
+*/
+typedef struct load_shed load_shed_t;
+
+/** Create a load shedding policy.
+
+    @param high the load to shed at, e.g. 0.9
+    @param low the load to restore at, below @p high, e.g. 0.6
+    @return the policy, NULL on failure
+*/
+load_shed_t *load_shed_create(float high, float low);
+
+void load_shed_free(load_shed_t *shed);
+
+/** Account the processing time of a buffer.
+
+    @param shed the policy
+    @param busy_ns the time spent on the buffer
+    @param duration_ns the signal time of the buffer
+    @return the step to apply from the next buffer on
+*/
+load_shed_step_t load_shed_buffer(load_shed_t *shed, uint64_t busy_ns, uint64_t duration_ns);
+
+/// The current step.
+load_shed_step_t load_shed_step(load_shed_t const *shed);
+
+/// The smoothed load.
+float load_shed_load(load_shed_t const *shed);
+
+/// The number of times a step was taken, 0 for LOAD_SHED_OFF.
+unsigned load_shed_raised(load_shed_t const *shed, load_shed_step_t step);
+
+/// The number of times a step was undone, 0 for LOAD_SHED_OFF.
+unsigned load_shed_lowered(load_shed_t const *shed, load_shed_step_t step);
+
+/// The signal time spent at a step in ms.
+uint64_t load_shed_step_ms(load_shed_t const *shed, load_shed_step_t step);
+
+#endif /* INCLUDE_LOAD_SHED_H_ */
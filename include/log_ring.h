@@ -0,0 +1,49 @@
+/** @file
+    Lock-free ring of log messages, queued by the worker threads for the event loop.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_LOG_RING_H_
+#define INCLUDE_LOG_RING_H_
+
+#include "logger.h"
+
+/// Number of messages the ring holds, a power of two.
+#define LOG_RING_SIZE 64
+
+/// Deliver a queued message, called on the thread draining the ring.
+typedef void (*log_ring_handler_fn)(log_level_t level, char const *src, char const *msg, void *ctx);
+
+/** Start queueing the messages of other threads, the caller drains the ring.
+
+    A no-op without threads.
+*/
+void log_ring_start(void);
+
+/// Stop queueing messages, drain the ring with log_ring_drain() afterwards.
+void log_ring_stop(void);
+
+/// Check if the caller should queue its messages, i.e. the ring is started and the caller is not draining it.
+int log_ring_defer(void);
+
+/** Queue a message, never blocks.
+
+    The source and the message are copied, a long message is truncated.
+
+    @return 0 if queued, -1 and counts the message as dropped if the ring is full
+*/
+int log_ring_push(log_level_t level, char const *src, char const *msg);
+
+/// Deliver all queued messages in order, returns the number of messages.
+unsigned log_ring_drain(log_ring_handler_fn handler, void *ctx);
+
+/// Get the number of messages dropped because the ring was full.
+unsigned log_ring_dropped(void);
+
+#endif /* INCLUDE_LOG_RING_H_ */
@@ -62,4 +62,43 @@ void print_logf(log_level_t level, char const *src, _Printf_format_string_ char
 #endif
         ;
 
+/// Messages a rate limited call site logs in each interval, see print_logf_limited().
+#define LOG_LIMIT_BURST 3
+/// Seconds of the interval of a rate limited call site.
+#define LOG_LIMIT_SECS 10
+
+/// The state of a rate limited call site.
+typedef struct log_limit {
+    long window;         ///< the current interval, in LOG_LIMIT_SECS since the epoch
+    unsigned count;      ///< the calls in the current interval
+    unsigned suppressed; ///< the calls suppressed since the last message logged
+} log_limit_t;
+
+/** Log a message format string, at most LOG_LIMIT_BURST times in LOG_LIMIT_SECS.
+
+    Suppressed calls are counted and not formatted,
+    the next message logged tells how many similar messages were suppressed.
+    Use print_logf_limited() which keeps a limit for each call site.
+
+    @param limit the state of the call site, zero initialized
+    @param level a log level
+    @param src the log source, typically the function name ("__func__") or a module ("SoapySDR")
+    @param fmt a log message format string
+*/
+void print_logf_limit(log_limit_t *limit, log_level_t level, char const *src, _Printf_format_string_ char const *fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 4, 5)))
+#endif
+        ;
+
+/// Log a message format string with a rate limit for the call site, for warnings on a hot path.
+#define print_logf_limited(level, src, ...) \
+    do { \
+        static log_limit_t print_log_limit_; \
+        print_logf_limit(&print_log_limit_, (level), (src), __VA_ARGS__); \
+    } while (0)
+
+/// Get the number of messages suppressed by the rate limits so far.
+unsigned print_log_suppressed(void);
+
 #endif /* INCLUDE_LOGGER_H_ */
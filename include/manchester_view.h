@@ -0,0 +1,56 @@
+/** @file
+    Manchester decoded rows shared by the decoders of one slice group.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_MANCHESTER_VIEW_H_
+#define INCLUDE_MANCHESTER_VIEW_H_
+
+#include <stdint.h>
+
+struct bitbuffer;
+
+/// Returned by manchester_view_decode() if the caller needs to decode the row itself.
+#define MANCHESTER_VIEW_UNKNOWN (~0U)
+
+/** The Manchester decoding of every row of one bitbuffer, the decoding runs on the first query.
+
+    Decoding from an offset only depends on the parity of the offset: each row is decoded once
+    for the pairs starting at even and at odd bits. A query at any offset then copies the decoded
+    bits up to the first invalid pair, for the bits unchanged or inverted in full.
+    E.g. the FSK TPMS decoders with the same slicer each find their own sync word and then
+    decode the same rows at offsets of the same two phases.
+*/
+typedef struct manchester_view {
+    struct bitbuffer const *source; ///< the bits decoded
+    struct bitbuffer const *bits;   ///< the copy of the bits the decoder being run got, queries on other bits are not answered
+    int done;                       ///< the decoding has run on the source
+    unsigned rows_size;             ///< capacity of the offsets
+    unsigned *offsets;              ///< byte offset of the decoded bits of each row and phase, and one past the last
+    unsigned size;                  ///< capacity in bytes of the decoded and the invalid bits
+    uint8_t *decoded;               ///< the second bit of each pair
+    uint8_t *invalid;               ///< set for each pair of equal bits
+} manchester_view_t;
+
+/** Manchester decode a row as bitbuffer_manchester_decode() does, from the decoded rows.
+
+    @param view the view of the bits given to the decoder
+    @param inbuf the bits given to the decoder, unchanged or inverted in full
+    @param row the row to decode
+    @param start the offset of the first pair
+    @param outbuf the decoded bits are appended to the last row
+    @param max the maximum number of bits to decode, 0 for all
+    @return the offset after the last pair, or MANCHESTER_VIEW_UNKNOWN if the caller needs to decode the row itself
+*/
+unsigned manchester_view_decode(manchester_view_t *view, struct bitbuffer *inbuf, unsigned row, unsigned start,
+        struct bitbuffer *outbuf, unsigned max);
+
+void manchester_view_free(manchester_view_t *view);
+
+#endif /* INCLUDE_MANCHESTER_VIEW_H_ */
@@ -0,0 +1,76 @@
+/** @file
+    Memory accounting of the subsystems that grow at runtime.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_MEM_ACCT_H_
+#define INCLUDE_MEM_ACCT_H_
+
+#include <stddef.h>
+
+struct data_array;
+
+/// The subsystems accounted, a network buffer is accounted to a subsystem by setting its tag.
+typedef enum mem_tag {
+    MEM_TAG_NETWORK,  ///< the send and receive buffers of the connections, the default of a buffer
+    MEM_TAG_HTTP,     ///< the event history and the events queued for the HTTP clients
+    MEM_TAG_INFLUX,   ///< the lines and the batches of the InfluxDB outputs
+    MEM_TAG_MQTT,     ///< the messages held back by the MQTT outputs
+    MEM_TAG_DECODERS, ///< the decoders and their state
+    MEM_TAGS,
+} mem_tag_t;
+
+/// Current and peak bytes of a subsystem.
+typedef struct mem_acct_stats {
+    char const *name;
+    size_t bytes;     ///< bytes allocated now
+    size_t max_bytes; ///< most bytes allocated
+    size_t limit;     ///< the soft limit, 0 if none
+    unsigned shed;    ///< times memory was shed to get below the limit
+} mem_acct_stats_t;
+
+/// Hook the accounting into the network buffers, call before any connection is made.
+void mem_acct_init(void);
+
+/// Allocate like malloc(), the bytes are accounted to the subsystem, free with mem_put().
+void *mem_get(mem_tag_t tag, size_t size);
+
+/// Allocate like calloc(), the bytes are accounted to the subsystem, free with mem_put().
+void *mem_get_zero(mem_tag_t tag, size_t nmemb, size_t size);
+
+/// Duplicate like strdup(), the bytes are accounted to the subsystem, free with mem_put().
+char *mem_dup(mem_tag_t tag, char const *str);
+
+/// Free memory allocated with mem_get(), mem_get_zero(), or mem_dup() of the same subsystem.
+void mem_put(mem_tag_t tag, void *ptr);
+
+/// Account a change in bytes not allocated with mem_get(), e.g. of an instance copied in place.
+void mem_acct_add(mem_tag_t tag, long delta);
+
+/** Set a soft limit for a subsystem, set the limits before the threads are started.
+
+    @param name the subsystem, e.g. "network", "http", "influx", "mqtt", "decoders"
+    @param limit the limit in bytes, 0 for none
+    @return 0 on success, -1 on an unknown subsystem
+*/
+int mem_acct_set_limit(char const *name, size_t limit);
+
+/// Returns non-zero if the subsystem is over its soft limit and should shed memory.
+int mem_acct_over(mem_tag_t tag);
+
+/// Count memory shed by a subsystem to get below its limit.
+void mem_acct_shed(mem_tag_t tag);
+
+/// Get the current and peak bytes of a subsystem, the peak is kept since the start.
+void mem_acct_get(mem_tag_t tag, mem_acct_stats_t *stats);
+
+/// The current and peak bytes of each subsystem.
+struct data_array *mem_acct_data(void);
+
+#endif /* INCLUDE_MEM_ACCT_H_ */
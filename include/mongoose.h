@@ -2427,8 +2427,15 @@ struct mbuf {
   char *buf;   /* Buffer pointer */
   size_t len;  /* Data length. Data is located between offset 0 and len. */
   size_t size; /* Buffer size allocated by realloc(1). Must be >= len */
+  int tag;     /* Accounting tag, kept over mbuf_free() (rtl_433 addition) */
 };
 
+/*
+ * Called with the change of the allocated size of each mbuf, if set
+ * (rtl_433 addition). Set it once before any mbuf is allocated.
+ */
+extern void (*mbuf_size_cb)(struct mbuf *, long delta);
+
 /*
  * Initialises an Mbuf.
  * `initial_capacity` specifies the initial capacity of the mbuf.
@@ -3876,6 +3883,19 @@ enum mg_ssl_if_result mg_ssl_if_handshake(struct mg_connection *nc);
 int mg_ssl_if_read(struct mg_connection *nc, void *buf, size_t buf_size);
 int mg_ssl_if_write(struct mg_connection *nc, const void *data, size_t len);
 
+#if MG_SSL_IF == MG_SSL_IF_OPENSSL
+/*
+ * Client session resumption (rtl_433 addition).
+ * The sessions are opaque SSL_SESSION pointers, set one before the handshake.
+ */
+void *mg_ssl_if_get1_session(struct mg_connection *nc);
+int mg_ssl_if_set_session(struct mg_connection *nc, void *session);
+int mg_ssl_if_session_reused(struct mg_connection *nc);
+void mg_ssl_if_session_free(void *session);
+/* The time the handshake started, 0 if not started. */
+double mg_ssl_if_handshake_start(struct mg_connection *nc);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -5095,6 +5115,23 @@ void mg_printf_websocket_frame(struct mg_connection *nc, int op_and_flags,
  */
 #define WEBSOCKET_DONT_FIN 0x100
 
+/*
+ * If set causes the RSV1 flag to be set on outbound frames, marking
+ * the payload as compressed by "permessage-deflate" (rtl_433 addition).
+ * The flags of incoming messages keep RSV1 as received.
+ */
+#define WEBSOCKET_COMPRESSED 0x40
+
+/*
+ * Send the reply to a WebSocket handshake with extra headers, e.g. the
+ * accepted "Sec-WebSocket-Extensions" (rtl_433 addition). Call it on
+ * MG_EV_WEBSOCKET_HANDSHAKE_REQUEST, the default reply is then skipped.
+ * The extra headers are each terminated with CRLF.
+ */
+void mg_send_websocket_handshake_reply(struct mg_connection *nc,
+                                       struct http_message *hm,
+                                       const char *extra_headers);
+
 #endif /* MG_ENABLE_HTTP_WEBSOCKET */
 
 /*
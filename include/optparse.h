@@ -109,6 +109,16 @@ uint32_t atouint32_metric(char const *str, char const *error_hint);
 /// @return parsed number value in seconds
 int atoi_time(char const *str, char const *error_hint);
 
+/// Convert a string to milliseconds, uses strtod() and accepts
+/// time suffixes of 'ms' and 's' (also 'MS' and 'S'), a plain number is milliseconds.
+///
+/// Parse errors will fprintf(stderr, ...) and exit(1).
+///
+/// @param str character string to parse
+/// @param error_hint prepended to error output
+/// @return parsed number value in milliseconds
+unsigned atoi_ms(char const *str, char const *error_hint);
+
 /// Similar to strsep.
 ///
 /// @param[in,out] stringp String to parse inplace
@@ -0,0 +1,41 @@
+/** @file
+    Arrow IPC file output for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_ARROW_H_
+#define INCLUDE_OUTPUT_ARROW_H_
+
+#include "data.h"
+#include <stdio.h>
+
+/// Number of events buffered into one record batch.
+#define ARROW_BATCH_ROWS 1024
+
+/** Construct data output for an Arrow IPC file.
+
+    The columns are the fields given on start, as with CSV, all are nullable.
+    A column has the Null type until it has values, then the type of the values of the first batch:
+    Utf8 if any value is a string, an array, or nested data (written as JSON text),
+    else Float64 if any value is a double, else Int32. Later numbers in Utf8 columns are written as text.
+
+    An Arrow file has one schema, a value that does not fit the type of its column
+    closes the file and the events continue in the next file with wider types,
+    e.g. "events.1.arrow" after "events.arrow". Without a path the value is written as null.
+
+    The footer is written when the file is closed, a file cut short
+    can still be read as an Arrow IPC stream after the first 8 bytes.
+
+    @param log_level the highest log level to process
+    @param file the output stream, opened for writing from the start
+    @param path the path of the file, NULL if it can not be rolled over
+*/
+struct data_output *data_output_arrow_create(int log_level, FILE *file, char const *path);
+
+#endif /* INCLUDE_OUTPUT_ARROW_H_ */
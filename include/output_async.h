@@ -0,0 +1,54 @@
+/** @file
+    Asynchronous output stage, prints the events of an output on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_ASYNC_H_
+#define INCLUDE_OUTPUT_ASYNC_H_
+
+#include "data.h"
+#include "latency_hist.h"
+
+/// Default number of events queued for an asynchronous output.
+#define OUTPUT_QUEUE_DEPTH 256
+
+/// What to do with an event if the queue of an output is full.
+typedef enum output_queue_policy {
+    OUTPUT_QUEUE_BLOCK,       ///< wait for the output thread to make room
+    OUTPUT_QUEUE_DROP_OLDEST, ///< drop the oldest queued event
+    OUTPUT_QUEUE_DROP_NEWEST, ///< drop the new event
+} output_queue_policy_t;
+
+/// Queue statistics of an asynchronous output.
+typedef struct output_queue_stats {
+    unsigned depth;     ///< events queued now
+    unsigned max_depth; ///< most events queued at once
+    unsigned dropped;   ///< events dropped because the queue was full
+    unsigned blocked;   ///< events that waited for room in the queue
+    latency_hist_t send; ///< delay from queueing an event to the end of its print
+} output_queue_stats_t;
+
+/** Construct an output that queues retained events and prints them on a thread.
+
+    The wrapped output is only used on that thread, it must not depend on the event loop.
+    Without threads the wrapped output is returned.
+
+    @param output the output to wrap, freed with the returned output
+    @param policy what to do with an event if the queue is full
+    @param depth the number of events the queue holds
+*/
+struct data_output *data_output_async_create(struct data_output *output, output_queue_policy_t policy, unsigned depth);
+
+/// Get the queue statistics, returns 0 if the output is not asynchronous. A reset clears the counts and delays but not the depth.
+int data_output_async_stats(struct data_output *output, output_queue_stats_t *stats, int reset);
+
+/// Returns 1 if the caller is the thread of the asynchronous output, e.g. logging while printing.
+int data_output_async_is_current(struct data_output *output);
+
+#endif /* INCLUDE_OUTPUT_ASYNC_H_ */
@@ -0,0 +1,40 @@
+/** @file
+    Binary (CBOR and MessagePack) outputs for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_BINARY_H_
+#define INCLUDE_OUTPUT_BINARY_H_
+
+#include "data.h"
+#include <stdio.h>
+#include <stdint.h>
+
+/// The binary encodings of an event.
+typedef enum binary_format {
+    BINARY_CBOR,    ///< CBOR (RFC 8949), one map per event
+    BINARY_MSGPACK, ///< MessagePack, one map per event
+} binary_format_t;
+
+/** Construct data output for a binary file.
+
+    CBOR files are a sequence (RFC 8742) of arrays of up to BINARY_CBOR_CHUNK events,
+    each array is a stringref namespace (tag 256) so keys and repeated strings are sent only once.
+    MessagePack files are a plain sequence of maps.
+
+    @param format the encoding
+    @param log_level the highest log level to process
+    @param file the output stream
+*/
+struct data_output *data_output_binary_create(binary_format_t format, int log_level, FILE *file);
+
+/// Encode one event as a standalone map, returns the length, 0 if it does not fit the buffer.
+size_t data_encode_binary(binary_format_t format, data_t *data, uint8_t *dst, size_t size);
+
+#endif /* INCLUDE_OUTPUT_BINARY_H_ */
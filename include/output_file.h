@@ -15,16 +15,32 @@
 #include "data.h"
 #include <stdio.h>
 
+/// Buffer size of a file output that is not flushed on each event, if none is given.
+#define FILE_FLUSH_BUFFER (64 * 1024)
+
+/** When a file output writes buffered events, flushes on each event if all are zero.
+
+    With an interval the events are written at most that often, by the next event or the timer.
+    With only a buffer size the events are written when the buffer is full.
+    Buffered events are written when the output is freed.
+*/
+typedef struct file_flush {
+    unsigned interval_ms; ///< write at most every this many milliseconds, 0 if not timed
+    unsigned buffer_size; ///< size of the stdio buffer, 0 for the default
+    int sync;             ///< also sync the file to the device on each write
+} file_flush_t;
+
 /** Construct data output for CSV printer.
 
     @param log_level the highest log level to process
     @param file the output stream
+    @param flush when to write the events, NULL to flush on each event
     @return The auxiliary data to pass along with data_csv_printer to data_print.
             You must release this object with data_output_free once you're done with it.
 */
-struct data_output *data_output_csv_create(int log_level, FILE *file);
+struct data_output *data_output_csv_create(int log_level, FILE *file, file_flush_t const *flush);
 
-struct data_output *data_output_json_create(int log_level, FILE *file);
+struct data_output *data_output_json_create(int log_level, FILE *file, file_flush_t const *flush);
 
 struct data_output *data_output_kv_create(int log_level, FILE *file);
 
@@ -0,0 +1,47 @@
+/** @file
+    Filter expressions of the outputs, evaluated on the events before formatting.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_FILTER_H_
+#define INCLUDE_OUTPUT_FILTER_H_
+
+#include <stddef.h>
+
+struct data;
+
+/** A compiled filter expression, e.g. `model~"Acurite.*" && id==1234 || rssi>-10`.
+
+    A comparison is a key, an operator, and a number or a quoted string:
+    `==`, `!=`, `<`, `<=`, `>`, `>=` compare numbers or strings, `~` and `!~` match a
+    regular expression with `.`, `*`, `+`, `?`, `^`, and `$`. A key alone checks that
+    the event has it. Comparisons are combined with `!`, `&&`, `||`, and parentheses.
+    A comparison of a key the event does not have, or of a string with a number, is false.
+
+    The expression is compiled once into a tree of nodes, the well-known keys are
+    matched without a string compare. The events an output filters are dropped before
+    any formatting, e.g. the JSON text is not made for them.
+*/
+typedef struct output_filter output_filter_t;
+
+/** Compile a filter expression.
+
+    @param expr the expression
+    @param err the message of a syntax error
+    @param err_size the size of @p err
+    @return the filter, NULL on a syntax error or failure
+*/
+output_filter_t *output_filter_create(char const *expr, char *err, size_t err_size);
+
+void output_filter_free(output_filter_t *filter);
+
+/// Check an event, returns 1 if it passes the filter.
+int output_filter_match(output_filter_t const *filter, struct data const *data);
+
+#endif /* INCLUDE_OUTPUT_FILTER_H_ */
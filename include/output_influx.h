@@ -1,5 +1,5 @@
 /** @file
-    InfluxDB output for rtl_433 events
+    InfluxDB and HTTP webhook outputs for rtl_433 events
 
     Copyright (C) 2019 Daniel Krueger
     based on output_mqtt.c
@@ -15,9 +15,43 @@
 #define INCLUDE_OUTPUT_INFLUX_H_
 
 #include "data.h"
+#include "tls_session.h"
 
 struct mg_mgr;
 
+/// Default most lines written in one request.
+#define INFLUX_BATCH_LINES 5000
+/// Default most bytes written in one request.
+#define INFLUX_BATCH_SIZE (1024 * 1024)
+/// Default most bytes of lines waiting to be written.
+#define INFLUX_BUFFER_SIZE (16 * 1024 * 1024)
+/// Default most events posted to a webhook in one request.
+#define WEBHOOK_BATCH_EVENTS 100
+/// Default most bytes posted to a webhook in one request.
+#define WEBHOOK_BATCH_SIZE (256 * 1024)
+
+/// Write statistics of an InfluxDB or webhook output.
+typedef struct influx_stats {
+    unsigned batches;      ///< requests written
+    unsigned lines;        ///< lines written
+    unsigned max_lines;    ///< most lines in a request
+    unsigned max_bytes;    ///< largest request, before compression
+    unsigned write_ms;     ///< total time waiting for replies
+    unsigned max_write_ms; ///< longest time waiting for a reply
+    unsigned latency_ms;     ///< total time from the oldest line of a request queued to the reply
+    unsigned max_latency_ms; ///< longest time from the oldest line of a request queued to the reply
+    unsigned retries;      ///< requests that had to be sent again
+    unsigned dropped;      ///< lines dropped for a full buffer or rejected by the server
+    unsigned queued;       ///< lines waiting to be written now
+    tls_stats_t tls;       ///< handshakes of the connections, with TLS only
+} influx_stats_t;
+
 struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts);
 
+/// Post events as batched JSON arrays or NDJSON to "http_post://host/path" or "https_post://host/path".
+struct data_output *data_output_webhook_create(struct mg_mgr *mgr, char *opts);
+
+/// Get the write statistics, returns 0 if the output is not InfluxDB or a webhook. A reset clears the counts.
+int data_output_influx_stats(struct data_output *output, influx_stats_t *stats, int reset);
+
 #endif /* INCLUDE_OUTPUT_INFLUX_H_ */
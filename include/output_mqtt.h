@@ -1,5 +1,5 @@
 /** @file
-    MQTT output for rtl_433 events
+    MQTT and MQTT-SN output for rtl_433 events
 
     Copyright (C) 2019 Christian Zuckschwerdt
 
@@ -13,9 +13,14 @@
 #define INCLUDE_OUTPUT_MQTT_H_
 
 #include "data.h"
+#include "tls_session.h"
 
 struct mg_mgr;
 
+/// Construct an MQTT output, or an MQTT-SN output over UDP for an "mqttsn" scheme.
 struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, char const *dev_hint);
 
+/// Get the TLS handshake statistics, returns 0 if the output is not MQTT or does not use TLS. A reset clears the counts.
+int data_output_mqtt_stats(struct data_output *output, tls_stats_t *stats, int reset);
+
 #endif /* INCLUDE_OUTPUT_MQTT_H_ */
@@ -22,7 +22,8 @@ struct r_cfg;
 
     @param host the server host to bind
     @param port the server port to bind
-    @param opts additional options, currently "control" enables write access
+    @param opts additional options, "control" enables write access, "depth=<frames>" sets the frames queued per client,
+                "squelch[=<pre>:<post>]" only sends frames around activity
     @param cfg the r_api config to use
     @return The initialized rtltcp output instance.
             You must release this object with raw_output_free once you're done with it.
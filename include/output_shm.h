@@ -0,0 +1,75 @@
+/** @file
+    Shared memory ring output for rtl_433 raw data.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_SHM_H_
+#define INCLUDE_OUTPUT_SHM_H_
+
+#include "raw_output.h"
+
+#include <stdint.h>
+
+struct r_cfg;
+
+/// Default name of the shared memory object, i.e. "/dev/shm/rtl_433" on Linux.
+#define SHM_DEFAULT_NAME "/rtl_433"
+/// Default bytes in the ring, about 8 seconds of CU8 at 1 MS/s.
+#define SHM_RING_SIZE (16 * 1024 * 1024)
+/// Number of frames described in the header.
+#define SHM_FRAME_SLOTS 64
+
+#define SHM_MAGIC "rtl_433"
+#define SHM_VERSION 2
+
+/// A frame in the ring, the data is never split at the end of the ring.
+typedef struct shm_frame {
+    uint64_t seq;              ///< frame number, from 1
+    uint64_t pos;              ///< total bytes written before this frame, including skipped ring ends
+    uint32_t offset;           ///< offset of the data in the ring
+    uint32_t len;              ///< bytes of I/Q samples
+    uint32_t center_frequency; ///< center frequency in Hz
+    uint32_t sample_rate;      ///< sample rate in Hz
+    uint64_t sample_offset;    ///< offset of the first sample from the start of the input, frames might be skipped with squelch
+} shm_frame_t;
+
+/** Header at the start of the shared memory, the ring follows at header_size.
+
+    The writer never waits for readers. To read, a reader:
+    - waits for frame_seq to pass the last frame it read, e.g. by polling,
+    - takes frames[seq % SHM_FRAME_SLOTS] for the next seq and checks the seq matches,
+    - uses the data in place at the offset in the ring,
+    - afterwards checks that write_begin - pos <= ring_size, otherwise the data was overwritten.
+
+    The magic is written last, a reader should wait until it matches.
+*/
+typedef struct shm_header {
+    char magic[8];           ///< SHM_MAGIC
+    uint32_t version;        ///< SHM_VERSION
+    uint32_t header_size;    ///< offset of the ring from the start of the shared memory
+    uint32_t ring_size;      ///< bytes in the ring
+    uint32_t frame_slots;    ///< SHM_FRAME_SLOTS
+    uint32_t sample_size;    ///< bytes per I/Q sample, 2 for CU8, 4 for CS16
+    uint32_t pid;            ///< process id of the writer
+    uint64_t write_begin;    ///< total bytes reserved by the writer, updated before the data is written
+    uint64_t frame_seq;      ///< seq of the latest complete frame, updated after the data is written
+    shm_frame_t frames[SHM_FRAME_SLOTS];
+} shm_header_t;
+
+/** Construct shared memory ring output.
+
+    @param name the name of the shared memory object, NULL for the default
+    @param ring_size the bytes in the ring, 0 for the default
+    @param cfg the r_api config to use
+    @return The initialized shm output instance.
+            You must release this object with raw_output_free once you're done with it.
+*/
+struct raw_output *raw_output_shm_create(char const *name, unsigned ring_size, struct r_cfg *cfg);
+
+#endif /* INCLUDE_OUTPUT_SHM_H_ */
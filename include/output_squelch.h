@@ -0,0 +1,37 @@
+/** @file
+    Squelch for raw outputs, only passes frames around activity.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_SQUELCH_H_
+#define INCLUDE_OUTPUT_SQUELCH_H_
+
+#include "raw_output.h"
+
+struct r_cfg;
+
+/// Default frames passed before activity.
+#define SQUELCH_PRE_FRAMES 1
+/// Default frames passed after activity.
+#define SQUELCH_POST_FRAMES 1
+
+/** Wrap a raw output to only pass frames with activity, and some frames before and after.
+
+    A frame is active unless the level estimate is clearly below the squelch level,
+    the same rule as the squelch prefilter. Frames keep their sample offset.
+
+    @param output the raw output to wrap, owned by the squelch
+    @param padding "<pre>:<post>" frames to pass around activity, NULL for the defaults
+    @param cfg the r_api config to use
+    @return The initialized squelch instance, or the output on failure.
+            You must release this object with raw_output_free once you're done with it.
+*/
+struct raw_output *raw_output_squelch_create(struct raw_output *output, char const *padding, struct r_cfg *cfg);
+
+#endif /* INCLUDE_OUTPUT_SQUELCH_H_ */
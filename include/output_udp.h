@@ -13,7 +13,23 @@
 #define INCLUDE_OUTPUT_UDP_H_
 
 #include "data.h"
+#include "output_binary.h"
 
-struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port);
+/// Most messages sent in one batch.
+#define DATAGRAM_BATCH_MAX 64
+/// Largest message that is queued, larger messages are sent at once.
+#define DATAGRAM_MESSAGE_MAX 1472
+
+/// Batching of datagrams.
+typedef struct datagram_batch {
+    unsigned messages;    ///< messages in a batch, 0 or 1 sends each message at once
+    unsigned interval_ms; ///< how long the oldest message waits for a batch to fill up, 0 waits for the timer
+} datagram_batch_t;
+
+/// Construct data output sending each event as a syslog datagram, or only the JSON if raw, batch might be NULL.
+struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port, int raw, datagram_batch_t const *batch);
+
+/// Construct data output sending each event as a CBOR or MessagePack datagram.
+struct data_output *data_output_binary_udp_create(binary_format_t format, int log_level, const char *host, const char *port);
 
 #endif /* INCLUDE_OUTPUT_UDP_H_ */
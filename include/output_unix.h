@@ -0,0 +1,36 @@
+/** @file
+    Unix domain socket output for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_UNIX_H_
+#define INCLUDE_OUTPUT_UNIX_H_
+
+#include "data.h"
+
+/// Default path of the socket.
+#define UNIX_DEFAULT_PATH "/tmp/rtl_433.sock"
+/// Default most subscribers.
+#define UNIX_DEFAULT_CLIENTS 16
+
+/** Construct data output sending each event as the JSON in one message to each subscriber.
+
+    With seqpacket the subscribers connect to the socket, with dgram the subscribers bind a socket
+    of their own and send any datagram to the socket to subscribe.
+    The sends never wait, a subscriber that does not keep up has the events dropped.
+
+    @param log_level the maximum log level
+    @param path the path of the socket, an existing socket is replaced, NULL for the default
+    @param dgram use datagrams instead of sequenced packets
+    @param max_clients the most subscribers, 0 for the default
+    @return The initialized output instance, NULL on failure.
+*/
+struct data_output *data_output_unix_create(int log_level, char const *path, int dgram, unsigned max_clients);
+
+#endif /* INCLUDE_OUTPUT_UNIX_H_ */
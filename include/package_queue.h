@@ -0,0 +1,107 @@
+/** @file
+    Pipelined queue of the detected packages to decode.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PACKAGE_QUEUE_H_
+#define INCLUDE_PACKAGE_QUEUE_H_
+
+#include <stdint.h>
+#include "pulse_data.h"
+#include "compat_time.h"
+
+struct data;
+
+/// The state of the input a package was detected in, the events of its decoders are stamped with it.
+typedef struct package_meta {
+    pulse_data_t const *pulse_data;     ///< the OOK pulses, only the levels if the package is FSK
+    pulse_data_t const *fsk_pulse_data; ///< the FSK pulses, only the levels if the package is OOK
+    struct timeval now;                 ///< wall time of the end of the input buffer
+    float sample_file_pos;              ///< position of the end of the input buffer in the file
+    int64_t publish_ns;                 ///< wall time the input buffer was handed over by the SDR, 0 for file input
+    int64_t demod_start_ns;             ///< wall time the demod of the input buffer started
+    int64_t detect_ns;                  ///< wall time the package was detected, only with the stage latency
+    int64_t package_end_ns;             ///< estimated wall time of the end of the package, 0 for file input
+} package_meta_t;
+
+typedef struct package_output package_output_t;
+
+/// A detected package in a slot of the queue.
+typedef struct package {
+    unsigned seq;            ///< sequence number in the order of detection
+    int type;                ///< PULSE_DATA_OOK or PULSE_DATA_FSK
+    pulse_data_t pulses;     ///< the pulses of the package, the store is kept for the next package in the slot
+    pulse_data_t other;      ///< the other modulation when the package was detected, without its pulses
+    package_meta_t meta;     ///< points to the pulses and the other modulation of the slot
+    int events;              ///< events of the decoders, once decoded
+    uint64_t decode_ns;      ///< time the decoders took
+    unsigned budget_skipped; ///< decoder runs skipped past the decode budget
+    package_output_t *output;      ///< the output of the decoders in order, replayed when retired
+    package_output_t *output_tail;
+} package_t;
+
+/** Decodes the detected packages on a thread of its own while the detection goes on.
+
+    The demod reserves a slot, copies the package into it, and pushes it. The decode
+    thread runs the decoders on the packages in the order pushed and keeps their output.
+    The demod retires the decoded packages in the same order, the kept output is
+    delivered and the package finished, e.g. counted and dumped, on the demod.
+    The events and the frame tracking are therefore the same as if each package was
+    decoded as it is detected, only later.
+
+    While a package is decoded or retired package_queue_current() returns it, the
+    events are stamped with its state instead of the live state of the demod.
+*/
+typedef struct package_queue package_queue_t;
+
+/// Run the decoders on a package, called on the decode thread.
+typedef void (*package_decode_fn)(package_t *package, void *ctx);
+
+/// Deliver the kept output of a package, called on the thread retiring it.
+typedef void (*package_deliver_fn)(struct data *data, int level, void *ctx);
+
+/// Finish a decoded package after its output is delivered, called on the thread retiring it.
+typedef void (*package_retire_fn)(package_t *package, void *ctx);
+
+/** Create the queue and start the decode thread.
+
+    @param size the number of packages pushed and not yet retired at most
+    @param decode runs the decoders on a package
+    @param deliver delivers the output kept for a package
+    @param retire finishes a package
+    @param ctx the context passed to the callbacks
+    @return the queue, NULL if threads are not available or on failure
+*/
+package_queue_t *package_queue_create(unsigned size, package_decode_fn decode, package_deliver_fn deliver, package_retire_fn retire, void *ctx);
+
+/// Stop the decode thread and free the queue, the pending packages and their output are discarded.
+void package_queue_free(package_queue_t *queue);
+
+/// Get a free slot, retires the decoded packages first and waits for the oldest one if all slots are in use.
+package_t *package_queue_reserve(package_queue_t *queue);
+
+/// Push the package in the reserved slot to the decode thread, the sequence number is set.
+void package_queue_push(package_queue_t *queue, package_t *package);
+
+/// Retire the decoded packages in order, with @p wait all pending packages are decoded and retired.
+void package_queue_retire(package_queue_t *queue, int wait);
+
+/// The package the caller decodes or retires, NULL if none or if @p queue is NULL.
+package_t const *package_queue_current(package_queue_t *queue);
+
+/// The oldest package pushed and not retired, its events are not output yet, NULL if none or if @p queue is NULL.
+package_t const *package_queue_oldest(package_queue_t *queue);
+
+/// The package on the decode thread for any caller, e.g. the decoder pool it runs the decoders on, NULL if none.
+package_t const *package_queue_decoding(package_queue_t *queue);
+
+/// Keep the output of a decoder on the decode thread for the package, returns 1 if the data was taken.
+int package_queue_keep_output(package_queue_t *queue, struct data *data, int level);
+
+#endif /* INCLUDE_PACKAGE_QUEUE_H_ */
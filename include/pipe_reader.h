@@ -0,0 +1,51 @@
+/** @file
+    Sample pipe reader, reads stdin or a pipe ahead on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PIPE_READER_H_
+#define INCLUDE_PIPE_READER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+/// Bytes of samples in a block read ahead.
+#define PIPE_READER_BLOCK_SIZE (1 << 18)
+/// Blocks read ahead, 8 MB or 1.7 s of CU8 at 2.4 MS/s.
+#define PIPE_READER_BLOCKS 32
+/// Bytes a pipe buffer is enlarged to, where the system allows it.
+#define PIPE_READER_PIPE_SIZE (1 << 20)
+
+typedef struct pipe_reader pipe_reader_t;
+
+/// Returns 1 if the file is not a regular file, e.g. stdin, a pipe, or a FIFO, which is worth reading ahead.
+int pipe_reader_is_pipe(FILE *file);
+
+/** Open a reader for a pipe, the blocks are read on a thread.
+
+    The pipe buffer is enlarged to PIPE_READER_PIPE_SIZE on Linux.
+    Without threads the blocks are read as they are needed.
+
+    A stall is the ring running full, the source then waits on the pipe and a live source may drop samples.
+    An underrun is the caller waiting on an empty ring, usual with a live source that is slower than the demodulation.
+    Both are logged as they happen and counted in a summary on close.
+
+    @param file the pipe to read, not closed by the reader
+    @param name the name of the input for the log
+    @return the reader, NULL if it can't be created
+*/
+pipe_reader_t *pipe_reader_open(FILE *file, char const *name);
+
+/// Read up to len bytes of samples, returns the number of bytes read, less only at the end or on errors.
+size_t pipe_reader_read(pipe_reader_t *reader, void *dst, size_t len);
+
+/// Stop reading ahead and free the reader, a thread blocked on the pipe frees it once the read returns.
+void pipe_reader_close(pipe_reader_t *reader);
+
+#endif /* INCLUDE_PIPE_READER_H_ */
@@ -0,0 +1,66 @@
+/** @file
+    Shared search of the fixed preambles of a slice group.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PREAMBLE_MATCHER_H_
+#define INCLUDE_PREAMBLE_MATCHER_H_
+
+#include <stdint.h>
+
+struct bitbuffer;
+
+/// Maximum number of distinct patterns of one matcher.
+#define PREAMBLE_MATCHER_MAX_PATTERNS 64
+
+/// Number of offsets kept for each row and pattern, later offsets are searched again.
+#define PREAMBLE_SCAN_HITS 8
+
+/// Returned by preamble_scan_find() if the offset is not known from the scan.
+#define PREAMBLE_SCAN_UNKNOWN (~0U)
+
+/** The fixed patterns of the decoders of one slice group, compiled into one automaton.
+
+    The bits are matched one at a time on an Aho-Corasick automaton of all patterns,
+    a single pass over each row finds the offsets of every pattern.
+    Equal patterns of several decoders share one slot.
+*/
+typedef struct preamble_matcher preamble_matcher_t;
+
+/// The offsets of the patterns in one bitbuffer, the scan runs on the first query.
+typedef struct preamble_scan {
+    preamble_matcher_t const *matcher;
+    struct bitbuffer const *source; ///< the bits scanned, the offsets are for these bits
+    struct bitbuffer const *bits;   ///< the copy of the bits the decoder being run got, queries on other bits are not answered
+    int done;                       ///< the scan has run on the source
+    unsigned size;                  ///< capacity of the counts in rows of all patterns
+    uint8_t *counts;                ///< offsets found for each row and pattern, one more than PREAMBLE_SCAN_HITS if some were dropped
+    uint16_t *offsets;              ///< PREAMBLE_SCAN_HITS offsets for each row and pattern, ascending
+} preamble_scan_t;
+
+preamble_matcher_t *preamble_matcher_create(void);
+
+void preamble_matcher_free(preamble_matcher_t *matcher);
+
+/// Add a pattern of @p bits bits, MSB first, as found in the bits or in the inverted bits.
+///
+/// @return the slot of the pattern starting at 1, the slot of an equal pattern if there is one,
+///         0 if the pattern can not be added
+unsigned preamble_matcher_add(preamble_matcher_t *matcher, uint8_t const *pattern, unsigned bits, int inverted);
+
+/// Get the offset of the first match of the pattern in @p slot at or after @p start,
+/// runs the scan on the first query.
+///
+/// @return the offset, the row length if there is no match,
+///         or PREAMBLE_SCAN_UNKNOWN if the caller needs to search the row itself
+unsigned preamble_scan_find(preamble_scan_t *scan, unsigned slot, unsigned row, unsigned start);
+
+void preamble_scan_free(preamble_scan_t *scan);
+
+#endif /* INCLUDE_PREAMBLE_MATCHER_H_ */
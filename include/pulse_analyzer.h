@@ -19,4 +19,22 @@ struct r_device;
 /// Analyze and print result.
 void pulse_analyzer(pulse_data_t *data, int package_type, struct r_device *device);
 
+/// Statistics of the guessed modulations of many packages, for bulk analysis runs (-A batch).
+typedef struct pulse_analyzer_batch pulse_analyzer_batch_t;
+
+/// Create empty batch statistics, returns NULL on alloc failure.
+pulse_analyzer_batch_t *pulse_analyzer_batch_create(void);
+
+/// Free batch statistics, the batch may be NULL.
+void pulse_analyzer_batch_free(pulse_analyzer_batch_t *batch);
+
+/// Guess the modulation of a package and count it with the packages of the same guess and widths.
+void pulse_analyzer_batch_add(pulse_analyzer_batch_t *batch, pulse_data_t const *data, int package_type);
+
+/// Add the packages of other batch statistics, e.g. of the channels.
+void pulse_analyzer_batch_merge(pulse_analyzer_batch_t *batch, pulse_analyzer_batch_t const *other);
+
+/// Print the groups of packages, most frequent first, with a flex decoder for each guessed modulation.
+void pulse_analyzer_batch_print(pulse_analyzer_batch_t *batch);
+
 #endif /* INCLUDE_PULSE_ANALYZER_H_ */
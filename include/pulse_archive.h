@@ -0,0 +1,113 @@
+/** @file
+    Binary indexed archive of pulse data packages.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PULSE_ARCHIVE_H_
+#define INCLUDE_PULSE_ARCHIVE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct pulse_data;
+
+#define PULSE_ARCHIVE_VERSION 1
+/// Bytes of the file header.
+#define PULSE_ARCHIVE_HEADER_SIZE 40
+/// Bytes of the record header, the encoded package follows.
+#define PULSE_ARCHIVE_RECORD_SIZE 12
+/// Bytes of an index entry.
+#define PULSE_ARCHIVE_INDEX_SIZE 16
+
+/*
+    All values are little endian.
+
+    File header:
+    - 0: magic "RPA", version
+    - 4: u32 header size
+    - 8: u32 sample rate, u32 sample depth bits, of the first package
+    - 16: u64 number of packages
+    - 24: u64 offset of the index, 0 if the index was not written
+    - 32: i64 creation time in us since the epoch
+
+    Each record:
+    - 0: u32 length of the package
+    - 4: i64 receive time in us since the epoch
+    - 12: the package as encoded by pulse_net_encode(), the sequence number is the record number
+
+    The index, one entry for each record:
+    - 0: u64 offset of the record
+    - 8: i64 receive time in us since the epoch
+
+    An archive written to a pipe has no index, the reader then scans the records.
+*/
+
+typedef struct pulse_archive_writer pulse_archive_writer_t;
+
+/** Start an archive on an open file, the header is written.
+
+    @param file the file to write to, closing it is up to the caller
+    @param sample_rate the sample rate if no package is written
+    @return the writer, NULL on failure
+*/
+pulse_archive_writer_t *pulse_archive_writer_open(FILE *file, uint32_t sample_rate);
+
+/** Append a package with its receive time, the current time if the package has none.
+
+    @param writer the writer
+    @param data the package
+    @param package_type PULSE_DATA_OOK or PULSE_DATA_FSK
+    @return 0 on success, -1 on failure
+*/
+int pulse_archive_write(pulse_archive_writer_t *writer, struct pulse_data const *data, int package_type);
+
+/** Write the index, finish the header if the file is seekable, and free the writer.
+
+    @return 0 on success, -1 if the archive is incomplete
+*/
+int pulse_archive_writer_close(pulse_archive_writer_t *writer);
+
+typedef struct pulse_archive pulse_archive_t;
+
+/** Open an archive for reading, regular files are mapped, other files are read into memory.
+
+    @param file the file to read from, can be closed after opening
+    @return the archive, NULL if it can't be read or is not an archive
+*/
+pulse_archive_t *pulse_archive_open(FILE *file);
+
+void pulse_archive_close(pulse_archive_t *archive);
+
+/// Number of packages in the archive.
+unsigned pulse_archive_count(pulse_archive_t const *archive);
+
+/// Sample rate of the first package of the archive.
+uint32_t pulse_archive_sample_rate(pulse_archive_t const *archive);
+
+/// Receive time of package number @p idx in us since the epoch.
+int64_t pulse_archive_time(pulse_archive_t const *archive, unsigned idx);
+
+/** Find the first package received at or after a time, assumes ascending receive times as from a receiver or a replay.
+
+    @param archive the archive
+    @param time_us the time in us since the epoch
+    @return the number of the package, the number of packages if there is none
+*/
+unsigned pulse_archive_seek(pulse_archive_t const *archive, int64_t time_us);
+
+/** Read package number @p idx.
+
+    @param archive the archive
+    @param idx the number of the package
+    @param data the package to fill, the receive time is set
+    @return PULSE_DATA_OOK or PULSE_DATA_FSK, 0 if there is no such package or it is invalid
+*/
+int pulse_archive_read(pulse_archive_t const *archive, unsigned idx, struct pulse_data *data);
+
+#endif /* INCLUDE_PULSE_ARCHIVE_H_ */
@@ -17,7 +17,12 @@
 #include <stdio.h>
 #include "data.h"
 
-#define PD_MAX_PULSES        1200 // Maximum number of pulses before forcing End Of Package
+#if defined(RTL_433_MEMORY_BUDGET_MB) && RTL_433_MEMORY_BUDGET_MB < 16
+#define PD_MAX_PULSES        800  // Default maximum number of pulses before forcing End Of Package, for a small memory budget
+#else
+#define PD_MAX_PULSES        1200 // Default maximum number of pulses before forcing End Of Package
+#endif
+#define PD_MAX_PULSES_LIMIT  65536 // Upper bound for a maximum number of pulses set by the user
 #define PD_MIN_PULSES        16   // Minimum number of pulses before declaring a proper package
 #define PD_MIN_PULSE_SAMPLES 10   // Minimum number of samples in a pulse for proper detection
 #define PD_MIN_GAP_MS        10   // Minimum gap size in milliseconds to exceed to declare End Of Package
@@ -25,7 +30,13 @@
 #define PD_MAX_GAP_RATIO     10   // Ratio gap/pulse width to exceed to declare End Of Package (heuristic)
 #define PD_MAX_PULSE_MS      100  // Pulse width in ms to exceed to declare End Of Package (e.g. for non OOK packages)
 
-/// Data for a compact representation of generic pulse train.
+/** Data for a compact representation of generic pulse train.
+
+    The pulse and gap widths are kept in one growing store, the store and the maximum are kept
+    when the data is cleared, so a demod reuses the same memory for every package.
+    Index pulse[] and gap[] directly, entries below num_pulses are valid and the entry at
+    num_pulses reads as zero until stored.
+*/
 typedef struct pulse_data {
     uint64_t offset;      ///< Offset to first pulse in number of samples from start of stream.
     uint32_t sample_rate; ///< Sample rate the pulses are recorded with.
@@ -33,8 +44,18 @@ typedef struct pulse_data {
     unsigned start_ago;   ///< Start of first pulse in number of samples ago.
     unsigned end_ago;     ///< End of last pulse in number of samples ago.
     unsigned int num_pulses;
-    int pulse[PD_MAX_PULSES]; ///< Width of pulses (high) in number of samples.
-    int gap[PD_MAX_PULSES];   ///< Width of gaps between pulses (low) in number of samples.
+    unsigned int max_pulses;  ///< Number of pulses before forcing End Of Package, 0 for PD_MAX_PULSES.
+    unsigned int capacity;    ///< Number of pulses the store has room for.
+    int *pulse;               ///< Width of pulses (high) in number of samples.
+    int *gap;                 ///< Width of gaps between pulses (low) in number of samples.
+    int *start;               ///< Start of each pulse in samples from the first pulse, the prefix sums of the periods, see pulse_data_index().
+    unsigned int indexed;     ///< Number of pulses covered by the index, 0 if not indexed.
+    int pulse_min;            ///< Shortest pulse, valid if indexed.
+    int pulse_max;            ///< Longest pulse, valid if indexed.
+    int gap_min;              ///< Shortest gap, including the last gap, valid if indexed.
+    int gap_max;              ///< Longest gap, including the last gap, valid if indexed.
+    int period_min;           ///< Shortest pulse plus gap, valid if indexed.
+    int period_max;           ///< Longest pulse plus gap, valid if indexed.
     int ook_low_estimate;     ///< Estimate for the OOK low level (base noise level) at beginning of package.
     int ook_high_estimate;    ///< Estimate for the OOK high level at end of package.
     int fsk_f1_est;           ///< Estimate for the F1 frequency for FSK.
@@ -46,14 +67,90 @@ typedef struct pulse_data {
     float rssi_db;
     float snr_db;
     float noise_db;
+    int64_t received_us;      ///< Receive time in us since the epoch, 0 if the package is current.
 } pulse_data_t;
 
-/// Clear the content of a pulse_data_t structure.
+/// Clear the content of a pulse_data_t structure, keeps the store and the maximum number of pulses.
 void pulse_data_clear(pulse_data_t *data);
 
+/// Release the store of a pulse_data_t structure and clear it.
+void pulse_data_free(pulse_data_t *data);
+
+/// Grow the store to have room for at least @p num_pulses pulses, use pulse_data_reserve().
+void pulse_data_grow(pulse_data_t *data, unsigned num_pulses);
+
+/// Make sure the store has room for at least @p num_pulses pulses.
+static inline void pulse_data_reserve(pulse_data_t *data, unsigned num_pulses)
+{
+    if (num_pulses > data->capacity)
+        pulse_data_grow(data, num_pulses);
+}
+
+/// Make room for the pulse at num_pulses and clear it, call after advancing num_pulses.
+static inline void pulse_data_start_pulse(pulse_data_t *data)
+{
+    pulse_data_reserve(data, data->num_pulses + 1);
+    data->pulse[data->num_pulses] = 0;
+    data->gap[data->num_pulses]   = 0;
+}
+
+/// Return the number of pulses before forcing End Of Package.
+static inline unsigned pulse_data_max_pulses(pulse_data_t const *data)
+{
+    return data->max_pulses ? data->max_pulses : PD_MAX_PULSES;
+}
+
+/// Copy a package into @p dst, keeps the store and the maximum number of pulses of @p dst, the index is not copied.
+void pulse_data_copy(pulse_data_t *dst, pulse_data_t const *src);
+
 /// Shift out part of the data to make room for more.
 void pulse_data_shift(pulse_data_t *data);
 
+/** Index a complete package, once before the slicers run.
+
+    Computes the start of each pulse as prefix sums of the periods, and the
+    shortest and longest pulse, gap, and period. The slicers then get the duration
+    of any range of pulses and rule out width ranges without a scan.
+    The index is dropped when the data is cleared or shifted.
+*/
+void pulse_data_index(pulse_data_t *data);
+
+/// Check if the index covers the current pulses.
+static inline int pulse_data_is_indexed(pulse_data_t const *data)
+{
+    return data->indexed && data->indexed == data->num_pulses;
+}
+
+/// Duration in samples from the start of pulse @p from to the start of pulse @p to, at most num_pulses.
+static inline int pulse_data_span(pulse_data_t const *data, unsigned from, unsigned to)
+{
+    if (pulse_data_is_indexed(data))
+        return data->start[to] - data->start[from];
+    int span = 0;
+    for (unsigned n = from; n < to; ++n) {
+        span += data->pulse[n] + data->gap[n];
+    }
+    return span;
+}
+
+/// Check if any pulse may be within the inclusive bounds, always true if not indexed.
+static inline int pulse_data_may_have_pulse(pulse_data_t const *data, int lower, int upper)
+{
+    return !pulse_data_is_indexed(data) || (data->pulse_max >= lower && data->pulse_min <= upper);
+}
+
+/// Check if any gap may be within the inclusive bounds, always true if not indexed.
+static inline int pulse_data_may_have_gap(pulse_data_t const *data, int lower, int upper)
+{
+    return !pulse_data_is_indexed(data) || (data->gap_max >= lower && data->gap_min <= upper);
+}
+
+/// Check if any period, a pulse plus the following gap, may be within the inclusive bounds, always true if not indexed.
+static inline int pulse_data_may_have_period(pulse_data_t const *data, int lower, int upper)
+{
+    return !pulse_data_is_indexed(data) || (data->period_max >= lower && data->period_min <= upper);
+}
+
 /// Print the content of a pulse_data_t structure (for debug).
 void pulse_data_print(pulse_data_t const *data);
 
@@ -66,6 +163,25 @@ void pulse_data_print_vcd_header(FILE *file, uint32_t sample_rate);
 /// Print the content of a pulse_data_t structure in VCD format.
 void pulse_data_print_vcd(FILE *file, pulse_data_t const *data, int ch_id);
 
+/// Print a header for the run-length logic format, the magic "RLE433", a version byte, and the sample rate.
+void pulse_data_print_rle_header(FILE *file, uint32_t sample_rate);
+
+/** Print the content of a pulse_data_t structure as runs of logic states.
+
+    Each run is a state byte, as with pulse_data_dump_raw(), and the number of samples as unsigned LEB128.
+    The samples before the package are idle (state 0), samples before @p pos are already written and skipped.
+
+    @param file the run-length logic dump
+    @param pos the samples written so far
+    @param data the package
+    @param bits the state bits of the pulses, 0x02 for OOK or 0x04 for FSK
+    @return the samples written
+*/
+uint64_t pulse_data_dump_rle(FILE *file, uint64_t pos, pulse_data_t const *data, uint8_t bits);
+
+/// Print the idle samples from @p pos up to the end of the input in the run-length logic format.
+void pulse_data_print_rle_end(FILE *file, uint64_t pos, uint64_t end);
+
 /// Read the next pulse_data_t structure from OOK text.
 void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate);
 
@@ -75,7 +191,7 @@ void pulse_data_print_pulse_header(FILE *file);
 /// Print the content of a pulse_data_t structure as OOK text.
 void pulse_data_dump(FILE *file, pulse_data_t const *data);
 
-/// Print the content of a pulse_data_t structure as OOK json.
-data_t *pulse_data_print_data(pulse_data_t const *data);
+/// Print the content of a pulse_data_t structure as OOK json, the widths as an RfRaw code with @p rfraw, see rfraw_encode().
+data_t *pulse_data_print_data(pulse_data_t const *data, int rfraw);
 
 #endif /* INCLUDE_PULSE_DATA_H_ */
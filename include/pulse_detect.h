@@ -34,6 +34,13 @@ enum {
 
 typedef struct pulse_detect pulse_detect_t;
 
+/// Level estimates of a pulse detector, e.g. kept for each frequency when hopping.
+typedef struct pulse_detect_levels {
+    int ook_low_estimate;  ///< Estimate for the OOK low level (base noise level)
+    int ook_high_estimate; ///< Estimate for the OOK high level
+    int lead_in_counter;   ///< Settling of the low level estimate
+} pulse_detect_levels_t;
+
 pulse_detect_t *pulse_detect_create(void);
 
 void pulse_detect_free(pulse_detect_t *pulse_detect);
@@ -41,6 +48,22 @@ void pulse_detect_free(pulse_detect_t *pulse_detect);
 /// Reset pulse detector to initial values.
 void pulse_detect_reset(pulse_detect_t *pulse_detect);
 
+/// Get the current level estimates.
+void pulse_detect_get_levels(pulse_detect_t const *pulse_detect, pulse_detect_levels_t *levels);
+
+/// The lowest envelope level of a pulse sample, the FM samples below it are only read in the short gaps after a pulse.
+int pulse_detect_carrier_level(pulse_detect_t const *pulse_detect);
+
+/// Fill in the level estimates of an unfinished OOK package, e.g. to decode it early.
+///
+/// @return the pulses of the package so far, 0 if no OOK package is in progress
+unsigned pulse_detect_ook_pending(pulse_detect_t const *pulse_detect, pulse_data_t *pulses);
+
+/// Abort a package in progress and continue with previous level estimates, e.g. after a retune.
+///
+/// Zeroed levels start over like a reset.
+void pulse_detect_restore_levels(pulse_detect_t *pulse_detect, pulse_detect_levels_t const *levels);
+
 /// Set pulse detector level values.
 ///
 /// @param pulse_detect The pulse_detect instance
@@ -51,6 +74,14 @@ void pulse_detect_reset(pulse_detect_t *pulse_detect);
 /// @param verbosity Debug output verbosity, 0=None, 1=Levels, 2=Histograms
 void pulse_detect_set_levels(pulse_detect_t *pulse_detect, int use_mag_est, float fixed_high_level, float min_high_level, float high_low_ratio, int verbosity);
 
+/// Set the gap to exceed to end an OOK package, e.g. the longest reset limit of the decoders.
+///
+/// The gap/pulse ratio heuristic then also ends a package at this gap at most.
+///
+/// @param pulse_detect The pulse_detect instance
+/// @param max_gap_us Maximum gap in us, 0 for the default of PD_MAX_GAP_MS
+void pulse_detect_set_max_gap(pulse_detect_t *pulse_detect, unsigned max_gap_us);
+
 /// Demodulate On/Off Keying (OOK) and Frequency Shift Keying (FSK) from an envelope signal.
 ///
 /// Function is stateful and can be called with chunks of input data.
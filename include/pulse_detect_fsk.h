@@ -60,6 +60,15 @@ void pulse_detect_fsk_init(pulse_detect_fsk_t *s);
 /// @param fsk_pulses Will return a pulse_data_t structure for FSK demodulated data
 void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses);
 
+/// Demodulate Frequency Shift Keying (FSK) over a span of samples.
+///
+/// Same as calling pulse_detect_fsk_classic() for each sample, without the per sample call.
+/// @param s Internal state
+/// @param fm_data Span of FM data
+/// @param len Number of samples in the span
+/// @param fsk_pulses Will return a pulse_data_t structure for FSK demodulated data
+void pulse_detect_fsk_classic_block(pulse_detect_fsk_t *s, int16_t const *fm_data, int len, pulse_data_t *fsk_pulses);
+
 /// Wrap up FSK modulation and store last data at End Of Package.
 ///
 /// @param s Internal state
@@ -74,4 +83,13 @@ void pulse_detect_fsk_wrap_up(pulse_detect_fsk_t *s, pulse_data_t *fsk_pulses);
 /// @param fsk_pulses Will return a pulse_data_t structure for FSK demodulated data
 void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses);
 
+/// Demodulate Frequency Shift Keying (FSK) over a span of samples.
+///
+/// Same as calling pulse_detect_fsk_minmax() for each sample, without the per sample call.
+/// @param s Internal state
+/// @param fm_data Span of FM data
+/// @param len Number of samples in the span
+/// @param fsk_pulses Will return a pulse_data_t structure for FSK demodulated data
+void pulse_detect_fsk_minmax_block(pulse_detect_fsk_t *s, int16_t const *fm_data, int len, pulse_data_t *fsk_pulses);
+
 #endif /* INCLUDE_PULSE_DETECT_FSK_H_ */
@@ -0,0 +1,88 @@
+/** @file
+    Binary pulse data transport between remote receivers and a central decoder.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PULSE_NET_H_
+#define INCLUDE_PULSE_NET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct pulse_data;
+
+#define PULSE_NET_MAGIC0 'R'
+#define PULSE_NET_MAGIC1 'P'
+#define PULSE_NET_VERSION 1
+/// Bytes of the fixed header, the pulse and gap widths follow.
+#define PULSE_NET_HEADER_SIZE 72
+/// Largest UDP payload, a larger package is not sent.
+#define PULSE_NET_DATAGRAM_MAX 65507
+
+/** Encode one package as a datagram.
+
+    All values are little endian:
+    - 0: magic "RP", version, package type (1 OOK, 2 FSK)
+    - 4: u32 sequence number, to count lost datagrams
+    - 8: u64 offset of the first pulse in samples from the start of the input
+    - 16: u32 sample rate, u32 number of pulses
+    - 24: i32 OOK low and high estimate, i32 FSK F1 and F2 estimate
+    - 40: f32 center frequency, freq1, freq2, RSSI, SNR, noise, range
+    - 68: u8 sample depth bits, 3 bytes reserved
+    - 72: for each pulse the pulse and gap width in samples as unsigned LEB128
+
+    @param data the package
+    @param package_type PULSE_DATA_OOK or PULSE_DATA_FSK
+    @param seq the sequence number of the datagram
+    @param dst the output buffer
+    @param size the size of the output buffer
+    @return the length of the datagram, 0 if it does not fit the buffer
+*/
+size_t pulse_net_encode(struct pulse_data const *data, int package_type, uint32_t seq, uint8_t *dst, size_t size);
+
+/** Decode a datagram into pulse data.
+
+    @param src the datagram
+    @param len the length of the datagram
+    @param data the package to fill, the store is grown as needed
+    @param seq the sequence number of the datagram, might be NULL
+    @return PULSE_DATA_OOK or PULSE_DATA_FSK, 0 if the datagram is invalid
+*/
+int pulse_net_decode(uint8_t const *src, size_t len, struct pulse_data *data, uint32_t *seq);
+
+typedef struct pulse_output pulse_output_t;
+
+/// Create an output sending each package as a datagram to host and port.
+pulse_output_t *pulse_output_udp_create(char const *host, char const *port);
+
+/// Send a package, safe to call from the demod of any channel or receiver.
+void pulse_output_send(pulse_output_t *output, struct pulse_data const *data, int package_type);
+
+void pulse_output_free(pulse_output_t *output);
+
+typedef struct pulse_input pulse_input_t;
+
+/// Open an input receiving datagrams on host and port, NULL on failure.
+pulse_input_t *pulse_input_udp_open(char const *host, char const *port);
+
+/** Receive the next package.
+
+    @param input the input
+    @param data the package to fill
+    @param timeout_ms the longest time to wait for a datagram
+    @return PULSE_DATA_OOK or PULSE_DATA_FSK, 0 on timeout, -1 on error
+*/
+int pulse_input_recv(pulse_input_t *input, struct pulse_data *data, int timeout_ms);
+
+/// Number of datagrams lost or invalid so far, from gaps in the sequence numbers.
+unsigned pulse_input_lost(pulse_input_t const *input);
+
+void pulse_input_close(pulse_input_t *input);
+
+#endif /* INCLUDE_PULSE_NET_H_ */
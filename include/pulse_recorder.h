@@ -0,0 +1,77 @@
+/** @file
+    Bounded ring of the latest pulse data packages, to dump or re-decode on request.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PULSE_RECORDER_H_
+#define INCLUDE_PULSE_RECORDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct pulse_data;
+
+/** The latest packages of all inputs, decoded or not, as encoded by pulse_net_encode().
+
+    E.g. a package takes about 100 to 500 bytes, a few MB keep the traffic of hours at a busy site,
+    where the IQ grabs of a signal grabber keep a few seconds.
+    The packages older than the time kept or not fitting the size are dropped, the oldest first.
+    The receivers add from their own threads, the ring is locked, the packages of a range
+    are copied out before they are replayed.
+*/
+typedef struct pulse_recorder pulse_recorder_t;
+
+/** Create a ring.
+
+    @param secs the time to keep the packages for, 0 to only limit the size
+    @param size the bytes of the ring
+    @return the ring, NULL on failure
+*/
+pulse_recorder_t *pulse_recorder_create(unsigned secs, size_t size);
+
+void pulse_recorder_free(pulse_recorder_t *rec);
+
+/** Add a package with its receive time, the current time if the package has none.
+
+    @param rec the ring
+    @param data the package
+    @param package_type PULSE_DATA_OOK or PULSE_DATA_FSK
+    @return 0 on success, -1 if the package is larger than the ring or on failure
+*/
+int pulse_recorder_add(pulse_recorder_t *rec, struct pulse_data const *data, int package_type);
+
+/// The number of packages and the bytes kept, and the packages not kept for their size.
+void pulse_recorder_stats(pulse_recorder_t *rec, unsigned *count, size_t *used, unsigned *dropped);
+
+/// Called with each package replayed, the package is only valid during the call.
+typedef void (*pulse_recorder_fn)(void *ctx, struct pulse_data *data, int package_type);
+
+/** Replay the packages received in a time range, oldest first.
+
+    @param rec the ring
+    @param from_us the first receive time in us since the epoch
+    @param to_us the receive time in us since the epoch the range ends before
+    @param fn called with each package, the receive time is set
+    @param ctx the context of the callback
+    @return the number of packages replayed, -1 on failure
+*/
+int pulse_recorder_replay(pulse_recorder_t *rec, int64_t from_us, int64_t to_us, pulse_recorder_fn fn, void *ctx);
+
+/** Write the packages received in a time range as a pulse archive, see pulse_archive.h.
+
+    @param rec the ring
+    @param file the file to write to
+    @param from_us the first receive time in us since the epoch
+    @param to_us the receive time in us since the epoch the range ends before
+    @return the number of packages written, -1 on failure
+*/
+int pulse_recorder_write(pulse_recorder_t *rec, FILE *file, int64_t from_us, int64_t to_us);
+
+#endif /* INCLUDE_PULSE_RECORDER_H_ */
@@ -16,6 +16,10 @@
 
 #include "pulse_detect.h"
 #include "r_device.h"
+#include "bitbuffer.h"
+#include "histogram.h"
+#include "preamble_matcher.h"
+#include "manchester_view.h"
 
 /// Demodulate a Pulse Code Modulation signal.
 ///
@@ -34,8 +38,9 @@
 /// - gap_limit:   Maximum gap size before new row of bits (optional) [us]
 /// - reset_limit: Maximum gap size before End Of Message [us].
 /// - tolerance:   Maximum deviation from nominal widths (optional, default 25%) [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a Pulse Position Modulation signal.
 ///
@@ -52,8 +57,9 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device);
 /// - reset_limit: Maximum gap size before End Of Message [us].
 /// - gap_limit:   Maximum gap size before new row of bits [us]
 /// - tolerance:   Maximum deviation from nominal widths (optional, raw if 0) [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a Pulse Width Modulation signal.
 ///
@@ -71,8 +77,9 @@ int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device);
 /// - gap_limit:   Maximum gap size before new row of bits [us]
 /// - sync_width:  Nominal width of sync pulse (optional) [us]
 /// - tolerance:   Maximum deviation from nominal widths (optional, raw if 0) [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a Manchester encoded signal with a hardcoded zerobit in front.
 ///
@@ -89,8 +96,9 @@ int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device);
 /// - short_width: Nominal width of clock half period [us]
 /// - long_width:  Not used
 /// - reset_limit: Maximum gap size before End Of Message [us].
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a Differential Manchester Coded signal.
 ///
@@ -112,8 +120,9 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
 /// - long_width:  Width in samples of '0' [us]
 /// - reset_limit: Maximum gap size before End Of Message [us].
 /// - tolerance:   Maximum deviation from nominal widths [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a raw Pulse Interval and Width Modulation signal.
 ///
@@ -126,8 +135,9 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device);
 /// - long_width:  Maximum width of a run of bits [us]
 /// - reset_limit: Maximum gap size before End Of Message [us].
 /// - tolerance:   Maximum deviation from nominal widths [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Demodulate a differential Pulse Interval and Width Modulation signal.
 ///
@@ -140,12 +150,13 @@ int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device);
 /// - long_width:  Nominal width of '0' [us]
 /// - reset_limit: Maximum gap size before End Of Message [us].
 /// - tolerance:   Maximum deviation from nominal widths [us]
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
 /// @return number of events processed
-int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
-int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
-int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device);
+int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
 
 /// Simulate demodulation using a given signal code string.
 ///
@@ -158,4 +169,87 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device);
 /// @return number of events processed
 int pulse_slicer_string(const char *code, r_device *device);
 
+/// Simulate demodulation of a signal code string already parsed with bitbuffer_parse().
+///
+/// Used to run a code through many decoders without parsing it for each,
+/// the decoder may change the bits, pass a copy.
+///
+/// @param bits The parsed code, changed by the decoder
+/// @param device Device params are disregarded.
+/// @return number of events processed
+int pulse_slicer_bits(bitbuffer_t *bits, r_device *device);
+
+/// The bits of one message in the transforms the decoders of a group ask for, see r_device.transform.
+typedef struct slicer_transforms {
+    unsigned done;  ///< bit mask of the transforms computed for the current message
+    unsigned size;  ///< capacity of each transform in bytes
+    uint8_t *bytes; ///< the used bytes of the bits in each transform, BITBUFFER_AS_IS excluded
+} slicer_transforms_t;
+
+/// The bits sliced from the current package for one group of decoders.
+typedef struct slicer_cache_entry {
+    unsigned generation;   ///< the bits are valid if this matches the cache generation
+    unsigned count;        ///< number of messages sliced
+    unsigned size;         ///< capacity of the bits, bytes and scans arrays
+    struct bitbuffer *bits;
+    unsigned *bytes;       ///< used bytes of the bit array of each bitbuffer, the rest is not copied
+    preamble_scan_t *scans; ///< offsets of the preambles in each bitbuffer
+    manchester_view_t *views; ///< Manchester decoded rows of each bitbuffer
+    slicer_transforms_t *transforms; ///< the transformed bits of each bitbuffer, computed on first use
+    preamble_matcher_t *matcher; ///< the preambles of the group, kept across packages, NULL if none
+} slicer_cache_entry_t;
+
+/// Sliced bits shared by the decoders with the same slicer parameters, one entry per slice group.
+typedef struct slicer_cache {
+    unsigned generation;   ///< incremented for each new package
+    unsigned size;         ///< number of entries
+    slicer_cache_entry_t *entries;
+} slicer_cache_t;
+
+/// Drop all cached bits, call before the decoders are run on a new package.
+void slicer_cache_reset(slicer_cache_t *cache);
+
+void slicer_cache_free(slicer_cache_t *cache);
+
+/// Make room for the entries of @p groups slice groups, entries do not move while decoders run in parallel.
+void slicer_cache_reserve(slicer_cache_t *cache, unsigned groups);
+
+/// Demodulate the pulses for a decoder of a slice group.
+///
+/// The first decoder of a group slices the pulses once, every decoder of the group
+/// then gets a copy of the same bits, as if it had run its own slicer.
+/// The decoder must not be verbose, verbose slicers log with the decoder name.
+///
+/// @param pulses The pulse sequence to demodulate
+/// @param device A decoder with a non-zero slice_group
+/// @param bits Scratch bits, zero initialized once and reused, see bitbuffer_clear()
+/// @param cache The cache for the current package
+/// @return number of events processed
+int pulse_slicer_cached(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits, slicer_cache_t *cache);
+
+/// Pulse and gap width clusters of a package, to rule out decoders before slicing.
+typedef struct pulse_signature {
+    uint32_t sample_rate;
+    int complete;          ///< all widths fit the bins, otherwise no decoder is ruled out
+    histogram_t pulses;
+    histogram_t gaps;
+} pulse_signature_t;
+
+/// Collect the pulse and gap width clusters of a package.
+void pulse_signature_make(pulse_signature_t *sig, pulse_data_t const *pulses);
+
+/// Check if the slicer of a decoder could produce any bits from a package.
+///
+/// The PWM and PPM slicers only produce bits from widths in the symbol bounds,
+/// the RZ PCM slicer only from pulses in tolerance of the short width,
+/// a decoder is ruled out if none of the clusters overlaps these bounds.
+/// Such a decoder would only see empty rows.
+/// Verbose decoders and decoders which may report empty rows, e.g. flex decoders
+/// without a bits limit, are never ruled out.
+///
+/// @param sig The signature of the package
+/// @param device The decoder
+/// @return 0 if the decoder can not match the package, 1 otherwise
+int pulse_slicer_may_match(pulse_signature_t const *sig, r_device const *device);
+
 #endif /* INCLUDE_PULSE_SLICER_H_ */
@@ -16,10 +16,15 @@
 
 struct r_cfg;
 struct r_device;
+struct tenant;
 struct data;
 struct pulse_data;
 struct list;
+struct slicer_cache;
+struct decoder_pool;
+struct trace_event;
 struct mg_mgr;
+struct decoder_usage;
 
 /* general */
 
@@ -31,34 +36,178 @@ void r_init_cfg(struct r_cfg *cfg);
 
 void r_free_cfg(struct r_cfg *cfg);
 
+/// Create an additional receiver for another input device, sharing the outputs of @p cfg.
+struct r_cfg *r_create_receiver(struct r_cfg *cfg, char *dev_query);
+
+/// Copy the shared settings, outputs, and tags from the primary config, call once all options are parsed.
+void r_setup_receiver(struct r_cfg *rcv);
+
+/// Create a config demodulating one channel of the input of @p cfg, sharing its outputs.
+struct r_cfg *r_create_channel(struct r_cfg *cfg);
+
+/// Grow the demod sample buffers to hold at least @p n_samples samples.
+void r_reserve_demod_buffers(struct r_cfg *cfg, unsigned long n_samples);
+
 /* device decoder protocols */
 
-void register_protocol(struct r_cfg *cfg, struct r_device *r_dev, char *arg);
+/// Register an instance of the protocol @p r_dev from the config devices, the arg can set the verbosity and parameters.
+void register_protocol(struct r_cfg *cfg, struct r_device const *r_dev, char *arg);
+
+/// Register a decoder instance without a copy, e.g. from flex_create_device(), the config takes ownership.
+void register_decoder(struct r_cfg *cfg, struct r_device *r_dev);
 
 void free_protocol(struct r_device *r_dev);
 
-void unregister_protocol(struct r_cfg *cfg, struct r_device *r_dev);
+/// Free a tenant pipeline of r_cfg::tenants.
+void free_tenant(struct tenant *tenant);
+
+void unregister_protocol(struct r_cfg *cfg, struct r_device const *r_dev);
+
+/// Unregister and free all device decoders.
+void unregister_all_protocols(struct r_cfg *cfg);
 
 void register_all_protocols(struct r_cfg *cfg, unsigned disabled);
 
+/** Move the registered decoders and their user data into one block, in the order they are dispatched.
+
+    The demod then walks the decoders linearly, call this once the decoders of a config are registered
+    and before the config demodulates. Decoders registered later are allocated on their own.
+*/
+void r_pack_decoders(struct r_cfg *cfg);
+
+/// Called with each event of a re-decode, the event is freed after the call.
+typedef void (*r_redecode_fn)(void *ctx, struct data *data);
+
+/** Run the packages recorded in a time range through copies of the current decoders, see pulse_recorder.h.
+
+    The copies are of the decoders of the primary, without the tenant pipelines, e.g. a decoder
+    enabled or fixed by a reload is validated against the recent traffic. The events are not output,
+    each is given to @p event_fn with the time and the meta data of its package, and the options
+    of the primary, e.g. the unit conversion, applied. Runs on the calling thread.
+
+    @param cfg the config, its primary has the recorder
+    @param from_us the first receive time in us since the epoch
+    @param to_us the receive time in us since the epoch the range ends before
+    @param event_fn called with each event
+    @param ctx the context of the callback
+    @return the number of packages decoded, -1 if no packages are recorded or on failure
+*/
+int r_redecode_recorded(struct r_cfg *cfg, int64_t from_us, int64_t to_us, r_redecode_fn event_fn, void *ctx);
+
+/** Keep only the decoders of one shard, e.g. for one of several processes decoding the same pulses.
+
+    The OOK and the FSK decoders are each split into `decoder_shards` disjoint shards of about equal
+    estimated cost, the decoders of a slice group stay together. The costs are read from the
+    `shard_costs` file, lines of a protocol number and a cost, e.g. the sum of the "slice_us" and
+    "decode_us" of the decoder in the stats with `-M stats:3`. Decoders without a cost count as the
+    average cost. Processes with the same decoders registered in the same order get the same split.
+    Does nothing if `decoder_shard` is 0. Call once the decoders are registered and before r_pack_decoders().
+*/
+void r_shard_decoders(struct r_cfg *cfg);
+
+/** Select the decoders run on a frequency, e.g. on a retune when hopping.
+
+    The decoders of the protocols in a list run, otherwise the decoders used on the band of the
+    frequency. Decoders without a protocol number, e.g. flex decoders, always run.
+    The selection is kept up to date when protocols are registered or unregistered.
+
+    @param cfg the config
+    @param frequency the center frequency, 0 to run all decoders
+    @param protocols protocol numbers, zero terminated, NULL to select by the band
+*/
+void r_select_decoders(struct r_cfg *cfg, uint32_t frequency, unsigned const *protocols);
+
+/** Set the gap that ends an OOK package of the pulse detector.
+
+    With the decoders selected by -R the gap is the longest reset limit of the OOK decoders that run,
+    at most PD_MAX_GAP_MS, a longer gap ends the messages of all of them. The gap of -Y maxgap is
+    used instead if set, and the default of PD_MAX_GAP_MS for the default decoders and the pulse analyzer. The gap is kept up to date when
+    protocols are registered or unregistered and when the decoders of a frequency are selected,
+    call this when the options change.
+
+    @param cfg the config
+*/
+void r_update_max_gap(struct r_cfg *cfg);
+
+/** Hand over the decoders registered on a staging config, e.g. for a reload of the options.
+
+    The demod swaps the decoders in before its next buffer, see r_apply_staged_decoders(),
+    the pulse detector and the rest of the demod state are kept. The staging config then holds the
+    decoders swapped out until r_free_retired_decoders() frees them. Only one set is staged at a time.
+
+    @param cfg the config demodulating the input or a channel
+    @param stage a config with the new decoders, its primary must be set, ownership is taken
+*/
+void r_stage_decoders(struct r_cfg *cfg, struct r_cfg *stage);
+
+/// Swap in the staged decoders, if any, called by the demod between two buffers.
+void r_apply_staged_decoders(struct r_cfg *cfg);
+
+/// Free the decoders swapped out, the events they output must be delivered. Returns 1 while a set is staged or not yet freed.
+int r_free_retired_decoders(struct r_cfg *cfg);
+
 /* output helper */
 
 void calc_rssi_snr(struct r_cfg *cfg, struct pulse_data *pulse_data);
 
 char *time_pos_str(struct r_cfg *cfg, unsigned samples_ago, char *buf);
 
+/// Count the delay from the end of a package @p end_ago samples before the buffer end until now.
+void record_latency(struct r_cfg *cfg, unsigned end_ago);
+
+/// Count the stage delays of the current package, with the stage latency report only.
+void record_stage_latency(struct r_cfg *cfg);
+
 char const **well_known_output_fields(struct r_cfg *cfg);
 
 char const **determine_csv_fields(struct r_cfg *cfg, char const *const *well_known, int *num_fields);
 
-int run_ook_demods(struct list *r_devs, struct pulse_data *pulse_data);
+/** Run the OOK decoders of a list sorted by priority, e.g. `demod->ook_devs`.
 
-int run_fsk_demods(struct list *r_devs, struct pulse_data *fsk_pulse_data);
+    All decoders of a priority are run, lower priorities are skipped once an event is produced.
+    With a @p cache the decoders of a slice group share the sliced bits, NULL slices for each decoder.
+    With a @p pool the decoders of a priority run in parallel, the output stays in the order of the list.
+*/
+int run_ook_demods(struct list *r_devs, struct pulse_data *pulse_data, struct slicer_cache *cache, struct decoder_pool *pool);
+
+/// Run the FSK decoders of a list sorted by priority, e.g. `demod->fsk_devs`, see run_ook_demods().
+int run_fsk_demods(struct list *r_devs, struct pulse_data *fsk_pulse_data, struct slicer_cache *cache, struct decoder_pool *pool);
+
+/** Run the OOK decoders like run_ook_demods(), with a span on thread @p tid of a @p trace for each priority.
+
+    With a @p budget_ns the decoders of the package have that much time, after that the cold decoders,
+    i.e. without events on the recent packages, are skipped and counted in @p skipped.
+    A decoder run taking longer than the whole budget is counted in its `budget_overruns`.
+    Only the decoders up to @p max_priority run, e.g. 0 to shed the fallback decoders under load.
+*/
+int run_ook_demods_traced(struct list *r_devs, struct pulse_data *pulse_data, struct slicer_cache *cache, struct decoder_pool *pool, struct trace_event *trace, unsigned tid,
+        uint64_t budget_ns, unsigned max_priority, unsigned *skipped);
+
+/// Run the FSK decoders like run_fsk_demods(), see run_ook_demods_traced().
+int run_fsk_demods_traced(struct list *r_devs, struct pulse_data *fsk_pulse_data, struct slicer_cache *cache, struct decoder_pool *pool, struct trace_event *trace, unsigned tid,
+        uint64_t budget_ns, unsigned max_priority, unsigned *skipped);
 
 /* handlers */
 
 void r_redirect_logging(struct r_cfg *cfg);
 
+/// Deliver the log messages other threads queued while the event loop runs, call on the event loop.
+void r_drain_logging(struct r_cfg *cfg);
+
+/// The output_data() level of the events of a tenant pipeline, see r_device::tenant.
+#define OUTPUT_TENANT_LEVEL(tenant) (-(int)(tenant))
+
+/** Pass the data structure to all output handlers with a log level of at least @p level, 0 for all.
+    Events, a level of 0 or OUTPUT_TENANT_LEVEL(), only go to the outputs of their tenant pipeline.
+    Defers to the event loop if called on the demod thread. Frees data afterwards. */
+void output_data(struct r_cfg *cfg, struct data *data, int level);
+
+/// Report to the merge of the events that the input of a config has no more events before its position.
+void r_merge_progress(struct r_cfg *cfg);
+
+/// Pass the output a channel kept while it was demodulated on the worker pool to output_data().
+void r_flush_channel_output(struct r_cfg *ch);
+
 void event_occurred_handler(struct r_cfg *cfg, struct data *data);
 
 void log_device_handler(struct r_device *r_dev, int level, struct data *data);
@@ -67,14 +216,29 @@ void data_acquired_handler(struct r_device *r_dev, struct data *data);
 
 struct data *create_report_data(struct r_cfg *cfg, int level);
 
+/// The level, noise floor, and occupancy of each spectrum bin from the lowest frequency up, NULL without a spectrum monitor.
+struct data *create_spectrum_data(struct r_cfg *cfg);
+
 void flush_report_data(struct r_cfg *cfg);
 
+/// Set the statistics report level of the decoders registered so far and later, level 3 also accounts the decoder cost.
+void set_report_stats(struct r_cfg *cfg, int level);
+
+/// Add the decodes and the time of the decoders of a config since the last stats report to a usage table.
+void r_add_decoder_usage(struct r_cfg *cfg, struct decoder_usage *usage);
+
 /* setup */
 
 void add_json_output(struct r_cfg *cfg, char *param);
 
 void add_csv_output(struct r_cfg *cfg, char *param);
 
+void add_cbor_output(struct r_cfg *cfg, char *param);
+
+void add_msgpack_output(struct r_cfg *cfg, char *param);
+
+void add_arrow_output(struct r_cfg *cfg, char *param);
+
 void add_log_output(struct r_cfg *cfg, char *param);
 
 void add_kv_output(struct r_cfg *cfg, char *param);
@@ -83,8 +247,12 @@ void add_mqtt_output(struct r_cfg *cfg, char *param);
 
 void add_influx_output(struct r_cfg *cfg, char *param);
 
+void add_webhook_output(struct r_cfg *cfg, char *param);
+
 void add_syslog_output(struct r_cfg *cfg, char *param);
 
+void add_unix_output(struct r_cfg *cfg, char *param);
+
 void add_http_output(struct r_cfg *cfg, char *param);
 
 void add_trigger_output(struct r_cfg *cfg, char *param);
@@ -93,6 +261,12 @@ void add_null_output(struct r_cfg *cfg, char *param);
 
 void add_rtltcp_output(struct r_cfg *cfg, char *param);
 
+void add_shm_output(struct r_cfg *cfg, char *param);
+
+void add_pulses_output(struct r_cfg *cfg, char *param);
+
+void add_fusion_output(struct r_cfg *cfg, char *param);
+
 void start_outputs(struct r_cfg *cfg, char const *const *well_known);
 
 void add_sr_dumper(struct r_cfg *cfg, char const *spec, int overwrite);
@@ -119,4 +293,16 @@ void set_sample_rate(struct r_cfg *cfg, uint32_t sample_rate);
 
 void set_gain_str(struct r_cfg *cfg, char const *gain_str);
 
+/** Start a trace of the demod, the decoders, and the outputs of the primary and its channels.
+
+    @param cfg the primary config
+    @param path the Chrome trace event JSON file to write
+    @param secs the duration of the trace, 0 to trace until stopped
+    @return 0 on success, -1 on error
+*/
+int start_trace(struct r_cfg *cfg, char const *path, unsigned secs);
+
+/// Stop a running trace and close its file.
+void stop_trace(struct r_cfg *cfg);
+
 #endif /* INCLUDE_R_API_H_ */
@@ -5,6 +5,8 @@
 #ifndef INCLUDE_R_DEVICE_H_
 #define INCLUDE_R_DEVICE_H_
 
+#include <stdint.h>
+
 /**
     Supported Modulation and Coding types.
 
@@ -38,6 +40,14 @@ enum modulation_types {
     FSK_PULSE_MANCHESTER_ZEROBIT = 18, ///< FSK Modulation, Manchester coding.
 };
 
+/** Frequency bands a protocol is used on, a decoder without bands runs on all frequencies. */
+enum frequency_bands {
+    FREQ_BAND_315 = 1 << 0, ///< 300 to 350 MHz, e.g. 315 MHz in North America
+    FREQ_BAND_433 = 1 << 1, ///< 420 to 450 MHz, e.g. 433.92 MHz ISM
+    FREQ_BAND_868 = 1 << 2, ///< 850 to 890 MHz, e.g. 868 MHz SRD in Europe
+    FREQ_BAND_915 = 1 << 3, ///< 900 to 930 MHz, e.g. 915 MHz ISM in North America
+};
+
 /** Decoders should return n>0 for n packets successfully decoded,
     an ABORT code if the bitbuffer is no applicable,
     or a FAIL code if the message is malformed. */
@@ -53,6 +63,38 @@ enum decode_return_codes {
 
 struct bitbuffer;
 struct data;
+struct preamble_scan;
+struct manchester_view;
+
+/** Timing of a decoder in samples, converted from the widths in us for one sample rate. */
+typedef struct slicer_timing {
+    unsigned sample_rate; ///< sample rate of the conversion, only valid if converted
+    int converted;
+    int too_low;          ///< a width rounds to zero at this sample rate
+    int s_short;
+    int s_long;
+    int s_reset;
+    int s_gap;
+    int s_sync;
+    int s_tolerance;
+    int q_short;          ///< precise short width in 1/256 samples, for integer rounding to bit periods
+    int q_long;           ///< precise long width in 1/256 samples, for integer rounding to bit periods
+} slicer_timing_t;
+
+/** A fixed pattern a decoder searches for, the decoders of one slice group search all patterns at once. */
+typedef struct decoder_preamble {
+    uint8_t const *pattern;
+    unsigned bits;     ///< length of the pattern in bits, 0 if none
+    unsigned inverted; ///< the pattern is searched after bitbuffer_invert()
+} decoder_preamble_t;
+
+/// Row lengths and counts a decoder accepts, bits outside are accounted as DECODE_ABORT_LENGTH without calling decode_fn.
+typedef struct decoder_rows {
+    unsigned min_bits; ///< shortest first row, 0 for any
+    unsigned max_bits; ///< longest first row, 0 for any
+    unsigned min_rows; ///< fewest rows, 0 for any
+    unsigned max_rows; ///< most rows, 0 for any
+} decoder_rows_t;
 
 /** Device protocol decoder struct. */
 typedef struct r_device {
@@ -61,6 +103,7 @@ typedef struct r_device {
     /* information provided by each decoder */
     char const *name;
     unsigned modulation;
+    unsigned bands; ///< frequency bands the protocol is used on, FREQ_BAND_* flags, 0 for any
     float short_width;
     float long_width;
     float reset_limit;
@@ -72,6 +115,11 @@ typedef struct r_device {
     unsigned priority; ///< Run later and only if no previous events were produced
     unsigned disabled; ///< 0: default enabled, 1: default disabled, 2: disabled, 3: disabled and hidden
     char const *const *fields; ///< List of fields this decoder produces; required for CSV output. NULL-terminated.
+    unsigned reports_empty; ///< The decoder may report bitbuffers without any bits, it is never skipped by the prefilter
+    decoder_preamble_t preamble; ///< A fixed pattern the decoder searches with decoder_search_preamble(), optional
+    decoder_rows_t rows; ///< The decoder returns DECODE_ABORT_LENGTH first thing for bits outside these, optional
+    unsigned transform; ///< The decoder is given the bits after this bitbuffer_transform(), the slice group shares the transformed bits
+    unsigned early_pulses; ///< Decode an unfinished package once it has this many pulses, with early decoding, 0 for whole packages only
 
     /* public for each decoder */
     int verbose;
@@ -84,10 +132,32 @@ typedef struct r_device {
     unsigned decode_ok;
     unsigned decode_messages;
     unsigned decode_fails[5];
+    unsigned slice_calls;  ///< slicer runs, including the copies from the slicer cache, only with report_cost
+    uint64_t slice_ns;     ///< time spent in the slicer, without the time in decode_fn
+    unsigned decode_calls; ///< decode_fn calls, only with report_cost
+    uint64_t decode_ns;    ///< time spent in decode_fn
+    unsigned decode_duplicates; ///< repeated messages dropped, only with dedup_ms or early decoding
+    unsigned budget_overruns; ///< runs that alone took longer than the decode budget of a package, only with decode_budget_us
 
     /* private for flex decoder and output callback */
     void *decode_ctx;
+    unsigned decode_ctx_size; ///< bytes of the decode_ctx allocated by decoder_create(), 0 if not sized
     void *output_ctx;
+    struct decoder_dedup *dedup; ///< recent messages to drop the repeats of, NULL until the first output with dedup_ms
+    uint64_t early_offset; ///< offset + 1 of the package an early event was output for, its whole package is dropped, 0 for none
+    struct conversion_plan *conversions; ///< unit conversions of the fields, NULL if no field has a convertible unit
+    unsigned tenant;     ///< the tenant pipeline the events are output to, 0 for the default pipeline
+    int conversion_mode; ///< the conversion_mode_t of the tenant pipeline, the config sets it for the default pipeline
+
+    /* private for the dispatcher */
+    unsigned slice_group; ///< decoders with the same non-zero group share the sliced bits
+    slicer_timing_t timing; ///< timing of the slicer, converted when the sample rate changes
+    unsigned report_cost;   ///< account the time spent in the slicer and in decode_fn, see set_report_stats()
+    unsigned hit_rate;      ///< decayed rate of the runs with events, the decoder pool starts the hot decoders first
+    unsigned preamble_slot; ///< slot of the preamble in the matcher of the slice group, 0 if none
+    struct preamble_scan *preamble_scan; ///< offsets of the preambles in the bits of the current decode_fn call, NULL if none
+    struct manchester_view *manchester_view; ///< Manchester decoded rows of the bits of the current decode_fn call, NULL if none
+    unsigned packed;        ///< the decoder and its sized decode_ctx live in the packed decoders of the demod, see r_pack_decoders()
 } r_device;
 
 #endif /* INCLUDE_R_DEVICE_H_ */
@@ -0,0 +1,114 @@
+/** @file
+    Embeddable decoding API, events are passed to a callback.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_R_LIB_H_
+#define INCLUDE_R_LIB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "baseband.h"
+
+struct r_cfg;
+struct data;
+struct pulse_data;
+
+/** A decoder instance embedded in an application.
+
+    Link the `r_433` library and use this instead of the rtl_433 program:
+
+        static void on_event(struct data const *event, void *ctx)
+        {
+            struct data const *model = r_lib_event_find(event, "model");
+            ...
+        }
+
+        r_lib_t *lib = r_lib_create(250000, on_event, ctx);
+        r_lib_register_all(lib);
+        while (...)
+            r_lib_push_iq(lib, buf, n_samples, BASEBAND_CU8);
+        r_lib_free(lib);
+
+    There is no event loop, network manager, or global config, nothing is printed to stdout.
+    The events are delivered on the thread pushing the samples, before the push returns.
+    Log messages go to stderr unless a handler is set with r_logger_set_log_handler().
+    An instance must only be used by one thread at a time, separate instances are independent.
+*/
+typedef struct r_lib r_lib_t;
+
+/** Receives a decoded event.
+
+    The event is a list of items, see `struct data` in data.h, e.g. "model", "id", and the
+    fields of the decoder. It is borrowed and read-only, and only valid during the call.
+*/
+typedef void (*r_lib_event_fn)(struct data const *event, void *ctx);
+
+/** Create a decoder instance without any decoders.
+
+    @param sample_rate the sample rate of the samples pushed, in Hz
+    @param event_fn the callback for the decoded events
+    @param ctx passed to the callback
+    @return the instance, NULL on alloc failure
+*/
+r_lib_t *r_lib_create(uint32_t sample_rate, r_lib_event_fn event_fn, void *ctx);
+
+/// Free a decoder instance and its decoders, the instance may be NULL.
+void r_lib_free(r_lib_t *lib);
+
+/** Get the config of an instance, to set options with the functions of r_api.h.
+
+    E.g. `report_meta` adds the modulation, frequency, and signal levels to the events,
+    `report_time` selects the format of the "time" item.
+*/
+struct r_cfg *r_lib_cfg(r_lib_t *lib);
+
+/// Register the decoders enabled by default, i.e. what rtl_433 runs without -R.
+void r_lib_register_all(r_lib_t *lib);
+
+/** Register a decoder by its protocol number, as listed by `rtl_433 -R help`.
+
+    @param lib the instance
+    @param protocol_num the protocol number
+    @param arg decoder arguments like with `-R <n>:<arg>`, NULL for none
+    @return 0 on success, -1 if the protocol number is unknown
+*/
+int r_lib_register_protocol(r_lib_t *lib, unsigned protocol_num, char *arg);
+
+/// Set the center frequency of the samples in Hz, selects the FSK pulse detector and sets the reported frequency.
+void r_lib_set_frequency(r_lib_t *lib, uint32_t frequency);
+
+/** Demodulate and decode a buffer of IQ samples.
+
+    Pulses spanning buffers are detected across pushes, keep the buffers contiguous.
+
+    @param lib the instance
+    @param iq_buf interleaved I and Q samples in the given format
+    @param n_samples the number of samples, i.e. I/Q pairs
+    @param format the sample format, BASEBAND_CU8, BASEBAND_CS8, BASEBAND_CS16, or BASEBAND_CF32
+    @return the number of events decoded
+*/
+int r_lib_push_iq(r_lib_t *lib, void const *iq_buf, size_t n_samples, baseband_format_t format);
+
+/** Decode a package of pulses, e.g. from an own pulse detector or a pulse archive.
+
+    The pulse and gap widths count samples at the sample rate of the pulses, `sample_rate` must be set.
+
+    @param lib the instance
+    @param pulses the pulses of one package
+    @param fsk 1 to run the FSK decoders, 0 for the OOK decoders
+    @return the number of events decoded
+*/
+int r_lib_push_pulses(r_lib_t *lib, struct pulse_data *pulses, int fsk);
+
+/// Find the item of an event with the given key, NULL if there is none.
+struct data const *r_lib_event_find(struct data const *event, char const *key);
+
+#endif /* INCLUDE_R_LIB_H_ */
@@ -10,12 +10,21 @@
 #include "list.h"
 #include "baseband.h"
 #include "pulse_detect.h"
+#include "pulse_slicer.h"
 #include "fileformat.h"
 #include "samp_grab.h"
 #include "am_analyze.h"
 #include "rtl_433.h"
 #include "compat_time.h"
 
+/// Detector state of a frequency, kept while hopping to the other frequencies.
+typedef struct detect_state {
+    uint32_t frequency; ///< the center frequency, 0 if the entry is unused
+    float noise_level;
+    float min_level_auto;
+    pulse_detect_levels_t levels;
+} detect_state_t;
+
 struct dm_state {
     float auto_level;
     float squelch_offset;
@@ -28,36 +37,68 @@ struct dm_state {
     int use_mag_est;
     int detect_verbosity;
 
-    int16_t am_buf[MAXIMAL_BUF_LENGTH];  // AM demodulated signal (for OOK decoding)
+    // Sample buffers are allocated to the block size, 64 byte aligned for SIMD loads
+    int16_t *am_buf;  // AM demodulated signal (for OOK decoding)
     union {
         // These buffers aren't used at the same time, so let's use a union to save some memory
-        int16_t fm[MAXIMAL_BUF_LENGTH];  // FM demodulated signal (for FSK decoding)
-        uint16_t temp[MAXIMAL_BUF_LENGTH];  // Temporary buffer (to be optimized out..)
+        int16_t *fm;  // FM demodulated signal (for FSK decoding)
+        uint16_t *temp;  // Temporary buffer (to be optimized out..)
     } buf;
-    uint8_t u8_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
-    float f32_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
-    int sample_size; // CU8: 2, CS16: 4
+    uint8_t *u8_buf; // logic dump buffer, only allocated for a U8_LOGIC dumper
+    unsigned long buf_samples; // capacity of the sample buffers
+    int sample_size; // CU8: 2, CS16: 4, CS8: 2, CF32: 8
+    baseband_format_t sample_format; // CS8 and CF32 only for file input demodulated natively
     pulse_detect_t *pulse_detect;
     filter_state_t lowpass_filter_state;
     demodfm_state_t demod_FM_state;
+    demodtones_state_t demod_tones_state;
     int enable_FM_demod;
     unsigned fsk_pulse_detect_mode;
+    unsigned shed_step; ///< the load shedding step of the input, see load_shed_step_t, read by the decode thread too
     unsigned frequency;
+    uint32_t detect_frequency; ///< the center frequency of the current detector state, 0 if none yet
+    detect_state_t detect_states[MAX_FREQS]; ///< the detector states of the other frequencies
     samp_grab_t *samp_grab;
     am_analyze_t *am_analyze;
-    int analyze_pulses;
+    int analyze_pulses; ///< 1: print the analysis of each package (-A), 2: aggregate the packages (-A batch)
+    int max_gap_ms; ///< the gap that ends an OOK package, 0 for the default or the longest reset limit of the selected OOK decoders
+    int default_devices; ///< all default decoders run, the gap that ends an OOK package stays at PD_MAX_GAP_MS
+    struct pulse_analyzer_batch *analyzer_batch; ///< the packages aggregated with -A batch, NULL until the first package
     file_info_t load_info;
+    char *load_spec; ///< the input spec of load_info without a time range, owned
     list_t dumper;
 
     /* Protocol states */
     list_t r_devs;
+    list_t ook_devs; ///< the OOK decoders of r_devs sorted by priority, not owned
+    list_t fsk_devs; ///< the FSK decoders of r_devs sorted by priority, not owned
+    list_t band_ook_devs; ///< the OOK decoders run on the current frequency, not owned
+    list_t band_fsk_devs; ///< the FSK decoders run on the current frequency, not owned
+    uint32_t band_frequency; ///< the frequency the band lists are selected for, 0 to run all decoders
+    unsigned const *band_protocols; ///< the protocols selected for the frequency, NULL for the decoders of its band
+    unsigned slice_groups; ///< number of slice groups given out to the decoders
+    slicer_cache_t slicer_cache;
+    struct decoder_pool *decoder_pool; ///< runs the decoders of a priority in parallel, owned by the config, NULL if not used
+    void *packed_devs; ///< the decoders of r_devs and their user data laid out in dispatch order, NULL if not packed
 
     pulse_data_t    pulse_data;
     pulse_data_t    fsk_pulse_data;
     unsigned frame_event_count;
+    list_t early_devs; ///< the decoders run on the unfinished package, not owned
+    uint64_t early_offset; ///< offset + 1 of the unfinished package decoded early, 0 for none
+    unsigned early_pulses; ///< the pulses of the unfinished package when last decoded
+    int early_done; ///< the unfinished package had events, it is not decoded again
+    int early_decoding; ///< the decoders run on the unfinished package, their events mark it
     unsigned frame_start_ago;
     unsigned frame_end_ago;
     struct timeval now;
+    int64_t sample_time_ns; ///< hardware time of the first sample in the current buffer, 0 if not available
+    int64_t publish_ns; ///< wall time the current buffer was handed over by the SDR, 0 for file input
+    int64_t demod_start_ns; ///< wall time the demod of the current buffer started, only with the stage latency
+    uint64_t callback_start_ns; ///< monotonic time the current buffer entered the sample callback
+    uint64_t callback_end_ns; ///< monotonic time the last buffer left the sample callback
+    int64_t detect_ns;      ///< wall time the current package was detected, only with the stage latency
+    int64_t package_end_ns; ///< estimated wall time of the end of the current package, 0 for file input
     float sample_file_pos;
 };
 
@@ -0,0 +1,51 @@
+/** @file
+    Static tracepoints (USDT) in the demod and decode pipeline.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_R_TRACE_H_
+#define INCLUDE_R_TRACE_H_
+
+/*
+    With USDT defined (sys/sdt.h from SystemTap found) each R_TRACEn() is a single nop
+    in the code and a note in the binary, e.g. list the probes with
+    `bpftrace -l 'usdt:./rtl_433:*'` and attach with
+    `bpftrace -e 'usdt:./rtl_433:rtl_433:decode { @[arg0, arg1] = count(); }'`.
+    Without USDT the probes compile to nothing, the arguments are not evaluated.
+
+    Probes of the provider "rtl_433":
+    - callback_entry(len, input_pos): a sample buffer enters the sample callback
+    - callback_exit(n_samples, events, busy_ns): the buffer is processed
+    - package(type, num_pulses, duration, pulse, gap, sample_rate): the pulse detector found a package,
+      type is 1 for OOK and 2 for FSK, the duration in samples, pulse and gap point to the widths in samples
+    - slice(protocol, modulation, num_pulses, events): a decoder's slicer ran on a package
+    - decode(protocol, ret, num_rows): a decode_fn returned, ret as returned by the decoder
+    - output_entry(index, level), output_exit(index): an event is printed to an output
+*/
+
+#ifdef USDT
+#include <sys/sdt.h>
+
+#define R_TRACE1(name, a1)                          DTRACE_PROBE1(rtl_433, name, a1)
+#define R_TRACE2(name, a1, a2)                      DTRACE_PROBE2(rtl_433, name, a1, a2)
+#define R_TRACE3(name, a1, a2, a3)                  DTRACE_PROBE3(rtl_433, name, a1, a2, a3)
+#define R_TRACE4(name, a1, a2, a3, a4)              DTRACE_PROBE4(rtl_433, name, a1, a2, a3, a4)
+#define R_TRACE6(name, a1, a2, a3, a4, a5, a6)      DTRACE_PROBE6(rtl_433, name, a1, a2, a3, a4, a5, a6)
+
+#else
+
+#define R_TRACE1(name, a1)                          do { } while (0)
+#define R_TRACE2(name, a1, a2)                      do { } while (0)
+#define R_TRACE3(name, a1, a2, a3)                  do { } while (0)
+#define R_TRACE4(name, a1, a2, a3, a4)              do { } while (0)
+#define R_TRACE6(name, a1, a2, a3, a4, a5, a6)      do { } while (0)
+
+#endif
+
+#endif /* INCLUDE_R_TRACE_H_ */
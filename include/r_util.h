@@ -41,6 +41,12 @@
 */
 void get_time_now(struct timeval *tv);
 
+/** Get current time in ns since the epoch, with usec precision.
+
+    @return the wall time of get_time_now() in ns
+*/
+int64_t get_time_now_ns(void);
+
 /** Printable timestamp in local time.
 
     @param[out] buf output buffer, long enough for "YYYY-MM-DD HH:MM:SS+0000"
@@ -61,6 +67,33 @@ char *format_time_str(char *buf, char const *format, int with_tz, time_t time_se
 */
 char *usecs_time_str(char *buf, char const *format, int with_tz, struct timeval *tv);
 
+/// The date and time of a second, reused for the timestamps of that second.
+typedef struct time_str_cache {
+    unsigned busy;       ///< set while a caller uses the cache, others then format uncached
+    int valid;           ///< a second is rendered
+    time_t secs;         ///< the second rendered
+    char const *format;  ///< the format rendered, compared by pointer
+    int with_tz;         ///< the offset is rendered
+    char date[LOCAL_TIME_BUFLEN]; ///< the date and time, without usec
+    char tz[8];          ///< the offset, e.g. "+0100" or "Z", empty without
+} time_str_cache_t;
+
+/** Printable timestamp in local time, with the date and time rendered once per second.
+
+    Gives the same text as format_time_str() or usecs_time_str(),
+    localtime and strftime only run when the second, format, or time zone mode changes.
+    Safe to share between threads, a caller finding the cache busy formats uncached.
+
+    @param cache the cache, zero initialized
+    @param[out] buf output buffer, long enough for "YYYY-MM-DD HH:MM:SS.uuuuuu+0000"
+    @param format time format string without usec, uses "%Y-%m-%d %H:%M:%S" if NULL
+    @param with_tz 1 to add a time offset, 0 otherwise
+    @param tv seconds and microseconds since the epoch
+    @param with_usecs 1 to add the microseconds, 0 otherwise
+    @return buf pointer (for short hand use as operator)
+*/
+char *cached_time_str(time_str_cache_t *cache, char *buf, char const *format, int with_tz, struct timeval const *tv, int with_usecs);
+
 /** Printable sample position.
 
     @param sample_file_pos sample position
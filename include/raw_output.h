@@ -17,11 +17,18 @@
 struct raw_output;
 
 typedef struct raw_output {
-    void (*output_frame)(struct raw_output *output, uint8_t const *data, uint32_t len);
+    void (*output_frame)(struct raw_output *output, uint8_t const *data, uint32_t len, uint64_t offset);
     void (*output_free)(struct raw_output *output);
 } raw_output_t;
 
-void raw_output_frame(struct raw_output *output, uint8_t const *data, uint32_t len);
+/** Output a frame of I/Q samples.
+
+    @param output the raw output to use
+    @param data the samples
+    @param len the length of the samples in bytes
+    @param offset the sample offset of the frame from the start of the input
+*/
+void raw_output_frame(struct raw_output *output, uint8_t const *data, uint32_t len, uint64_t offset);
 
 void raw_output_free(struct raw_output *output);
 
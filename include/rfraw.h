@@ -19,6 +19,16 @@
 bool rfraw_check(char const *p);
 
 /// Decode RfRaw string to pulse data.
+///
+/// The pulses are appended to @p data, the store is reused and nothing is allocated
+/// once it has room for the pulses, clear it with pulse_data_clear() between codes.
 bool rfraw_parse(pulse_data_t *data, char const *p);
 
+/// Encode pulse data as one RfRaw B1 code, the inverse of rfraw_parse().
+///
+/// The pulse and gap widths are clustered in up to 8 bins, a package with more widths
+/// has its closest bins merged, widths are in us and clipped to 65535 us.
+/// Returns the hex string to be freed, NULL if there are no pulses or on alloc failure.
+char *rfraw_encode(pulse_data_t const *data);
+
 #endif /* INCLUDE_RFRAW_H_ */
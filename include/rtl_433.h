@@ -7,26 +7,62 @@
 
 #include <stdint.h>
 #include "list.h"
+#include "latency_hist.h"
 #include <time.h>
 #include <signal.h>
 
 #define DEFAULT_SAMPLE_RATE     250000
 #define DEFAULT_FREQUENCY       433920000
 #define DEFAULT_HOP_TIME        (60*10)
+#ifdef RTL_433_MEMORY_BUDGET_MB
+// the embedded build profile scales the sample buffers to the memory budget
+#define MEMORY_BUDGET           ((size_t)RTL_433_MEMORY_BUDGET_MB * 1024 * 1024) ///< bytes the buffers may use
+#define DEFAULT_ASYNC_BUF_NUMBER    8
+#define DEFAULT_BUF_LENGTH      (RTL_433_MEMORY_BUDGET_MB >= 64 ? 16 * 32 * 512 : RTL_433_MEMORY_BUDGET_MB * 8 * 512) // 1/256 of the budget
+#else
+#define MEMORY_BUDGET           0 // no budget
 #define DEFAULT_ASYNC_BUF_NUMBER    0 // Force use of default value (librtlsdr default: 15)
 #define DEFAULT_BUF_LENGTH      (16 * 32 * 512) // librtlsdr default
+#endif
 #define FSK_PULSE_DETECTOR_LIMIT 800000000
 
 #define MINIMAL_BUF_LENGTH      512
 #define MAXIMAL_BUF_LENGTH      (256 * 16384)
 #define SIGNAL_GRABBER_BUFFER   (12 * DEFAULT_BUF_LENGTH)
+#define LOW_LATENCY_BUF_LENGTH  (16 * 1024) // about 8 ms at 1 MS/s CU8
+#define LOW_LATENCY_BUF_NUMBER  128 // keep about as much data in flight as the default
+#define LATENCY_HIST_BINS       11
+#define LATENCY_HIST_BOUNDS_MS  {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000} // upper bounds of the bins, the last bin counts the rest
 #define MAX_FREQS               32
+#define SQUELCH_PREFILTER_STRIDE 16 // use every n-th sample for the squelch level estimate
+#define SQUELCH_PREFILTER_MARGIN 1.5f // the estimate needs to be this much below the squelch level (in dB) to skip a frame
+#define SQUELCH_SUBBLOCK_MS      4 // length of the sub-blocks with a level estimate each, only active sub-blocks are demodulated
+#define SQUELCH_SUBBLOCKS_MAX    256 // longer sub-blocks for very long frames
 
 #define INPUT_LINE_MAX 8192 /**< enough for a complete textual bitbuffer (25*256) */
 
 struct sdr_dev;
+struct sdr_opener;
 struct r_device;
 struct mg_mgr;
+struct demod_thread;
+struct channelizer;
+struct decimator;
+struct spectrum;
+struct worker_pool;
+struct decoder_pool;
+struct package_queue;
+struct hop_scheduler;
+struct freq_plan;
+struct trace_event;
+struct event_fusion;
+struct event_merge;
+struct decoder_usage;
+struct pulse_recorder;
+struct event_throttle;
+struct sensor_state;
+struct load_shed;
+struct buf_tune;
 
 typedef enum {
     CONVERT_NATIVE,
@@ -34,6 +70,21 @@ typedef enum {
     CONVERT_CUSTOMARY,
 } conversion_mode_t;
 
+/// A tenant pipeline, its own decoders and outputs on the shared input, see r_cfg::tenants.
+typedef struct tenant {
+    char *name;
+    conversion_mode_t conversion_mode;
+} tenant_t;
+
+/// Stages of the delay from the end of a package to its events, reported with "-M latency".
+typedef enum {
+    LATENCY_BUFFER, ///< the end of the package to the SDR handing over the buffer
+    LATENCY_QUEUE,  ///< the buffer handed over to the start of its demodulation
+    LATENCY_DSP,    ///< the start of the demodulation to the package detected
+    LATENCY_DECODE, ///< the package detected to the decoders done
+    LATENCY_STAGES,
+} latency_stage_t;
+
 typedef enum {
     REPORT_TIME_DEFAULT,
     REPORT_TIME_DATE,
@@ -66,21 +117,41 @@ typedef struct r_cfg {
     char *settings_str;
     int ppm_error;
     uint32_t out_block_size;
+    uint32_t buf_num; ///< number of SDR transfers, 0 for the default of the mode
+    int low_latency; ///< use small SDR transfers, merged into larger blocks while the demod is behind
+    int buf_tune_s;  ///< tune the SDR transfers over this many seconds of the first input, 0 for off
+    struct buf_tune *buf_tune; ///< measures the SDR transfers of an input, NULL if not used
+    int buf_tune_restart; ///< the tuned transfers wait for a restart of the input
+    int cs8_to_cu8;  ///< the SDR delivers CS8, flipped to CU8 for the raw sample consumers
     char const *test_data;
     list_t in_files;
     char const *in_filename;
-    int in_replay;
+    int in_replay; ///< replay file inputs at N-times realtime, -1 for as fast as possible with a simulated sample clock
+    int64_t replay_clock_ns; ///< simulated time of the next replayed sample, 0 to start each file at its modification time minus its length
+    uint64_t replay_samples; ///< samples replayed as fast as possible, for the throughput at exit
+    double replay_seconds;   ///< length of the samples replayed as fast as possible
+    int bench_repeats;       ///< decode the file inputs this many times and report the throughput of each stage, 0 for off
+    int startup_profile;     ///< log the time of each startup phase until the first sample, cleared then
+    uint64_t startup_ns;     ///< monotonic time of the start
+    uint64_t startup_last_ns; ///< monotonic time the last startup phase ended
     volatile sig_atomic_t hop_now;
     volatile sig_atomic_t exit_async;
     volatile sig_atomic_t exit_code; ///< 0=no err, 1=params or cmd line err, 2=sdr device read error, 3=usb init error, 5=USB error (reset), other=other error
     int frequencies;
     int frequency_index;
     uint32_t frequency[MAX_FREQS];
+    unsigned *frequency_protocols[MAX_FREQS]; ///< protocols run on each frequency, zero terminated, NULL for the decoders of its band, owned
     uint32_t center_frequency;
     int fsk_pulse_detect_mode;
+    int fsk_tones; ///< settings of the two-tone FSK detector, on the primary
+    uint32_t fsk_tones_deviation[MAX_FREQS]; ///< the tone deviation of each setting
+    uint32_t fsk_tones_frequency[MAX_FREQS]; ///< the frequency of each setting, 0 for all frequencies
     int hop_times;
     int hop_time[MAX_FREQS];
     time_t hop_start_time;
+    int hop_adaptive; ///< weigh the hop times by the activity of the frequencies
+    struct hop_scheduler *hop_scheduler; ///< the adaptive hop scheduler, NULL for fixed hop times
+    unsigned hop_packages; ///< packages counted up to the last frame, for the hop scheduler
     int duration;
     time_t stop_time;
     int after_successful_events_flag;
@@ -88,13 +159,16 @@ typedef struct r_cfg {
     uint64_t input_pos;
     uint32_t bytes_to_read;
     struct sdr_dev *dev;
+    struct sdr_opener *sdr_opener; ///< the device opened in the background during startup, NULL once started
     int grab_mode; ///< Signal grabber mode: 0=off, 1=all, 2=unknown, 3=known
     int raw_mode; ///< Raw pulses printing mode: 0=off, 1=all, 2=unknown, 3=known
+    int raw_rfraw; ///< print the raw pulses as an RfRaw code instead of an array of the widths
     int verbosity; ///< 0=normal, 1=verbose, 2=verbose decoders, 3=debug decoders, 4=trace decoding.
     int verbose_bits;
     conversion_mode_t conversion_mode;
     int report_meta;
     int report_noise;
+    int report_latency; ///< add the stage delays to each event and the stats report
     int report_protocol;
     time_mode_t report_time;
     int report_time_hires;
@@ -104,14 +178,20 @@ typedef struct r_cfg {
     int report_stats;
     int stats_interval;
     volatile sig_atomic_t stats_now;
+    volatile sig_atomic_t reload_now; ///< reload the decoders and outputs from the options and config files
+    int parse_reload; ///< only the decoder and output options are parsed, for a reload
     time_t stats_time;
     int no_default_devices;
-    struct r_device *devices;
+    unsigned tenant; ///< the tenant pipeline the decoder and output options apply to while parsing, 0 for the default pipeline
+    list_t tenants; ///< the tenant pipelines, tenant n is element n - 1, on the primary
+    struct r_device const *devices; ///< the protocols in protocol number order, shared by all configs
     uint16_t num_r_devices;
     list_t data_tags;
     list_t output_handler;
     list_t raw_handler;
+    list_t pulse_handler; ///< pulse outputs, each package of this config and its channels and receivers is sent
     int has_logout;
+    size_t http_bytes; ///< the history and one client queue of the HTTP servers, for the memory budget
     struct dm_state *demod;
     char const *sr_filename;
     int sr_execopen;
@@ -123,6 +203,9 @@ typedef struct r_cfg {
     unsigned total_frames_ook;      ///< total frames with ook demod statistic
     unsigned total_frames_fsk;      ///< total frames with fsk demod statistic
     unsigned total_frames_events;   ///< total frames with decoder events statistic
+    unsigned total_frames_dropped;  ///< total frames dropped by a slow consumer statistic
+    unsigned total_frames_overflow; ///< total input overflows statistic
+    unsigned total_frames_prefilter; ///< total frames squelched on the level estimate alone statistic
     /* sdr stats */
     time_t sdr_since; ///< time of last SDR connect statistic
     /* per report interval stats */
@@ -130,7 +213,98 @@ typedef struct r_cfg {
     unsigned frames_ook;    ///< counter of ook demods for report interval statistic
     unsigned frames_fsk;    ///< counter of fsk demods for report interval statistic
     unsigned frames_events; ///< counter of decoder events for report interval statistic
+    unsigned frames_dropped; ///< counter of dropped frames for report interval statistic
+    unsigned frames_overflow; ///< counter of input overflows for report interval statistic
+    unsigned frames_prefilter_hit; ///< counter of frames squelched on the level estimate for report interval statistic
+    unsigned frames_prefilter_miss; ///< counter of frames needing the full level for report interval statistic
+    unsigned frames_subblock; ///< counter of frames demodulated in the active sub-blocks only for report interval statistic
+    uint64_t frames_fm_samples; ///< counter of samples FM demodulated around a carrier for report interval statistic
+    uint64_t frames_fm_total; ///< counter of samples checked for a carrier to FM demodulate for report interval statistic
+    unsigned long frames_baseband_us; ///< time spent in the AM, low pass, and FM demod for report interval statistic
+    uint64_t frames_detect_ns; ///< time spent in the pulse detector for report interval statistic
+    uint64_t frames_decode_ns; ///< time spent in the slicers and decoders for report interval statistic
+    unsigned frames_latency[LATENCY_HIST_BINS]; ///< histogram of the delay from package end to output for report interval statistic
+    unsigned frames_latency_max_ms; ///< largest delay from package end to output for report interval statistic
+    latency_hist_t frames_stage_latency[LATENCY_STAGES]; ///< histograms of the stage delays for report interval statistic
+    unsigned frames_duplicates; ///< counter of repeated messages the channels dropped for report interval statistic
+    unsigned frames_early; ///< counter of packages decoded before their end for report interval statistic
+    unsigned frames_over_budget; ///< counter of packages that used up the decode budget for report interval statistic
+    unsigned frames_budget_skipped; ///< counter of decoder runs skipped past the decode budget for report interval statistic
+    unsigned frames_gated; ///< counter of channel frames skipped by the spectrum gate for report interval statistic
+    unsigned frames_dozed; ///< counter of frames skipped by the duty cycle for report interval statistic
+    unsigned frames_buffers; ///< counter of sample buffers processed for report interval statistic
+    unsigned frames_squelch; ///< counter of sample buffers with noise only for report interval statistic
+    uint64_t frames_bytes; ///< sample bytes processed for report interval statistic
+    uint64_t frames_busy_ns; ///< time spent in the sample callback for report interval statistic
+    uint64_t frames_duration_ns; ///< signal duration of the processed samples for report interval statistic
+    latency_hist_t frames_callback; ///< histogram of the time spent in the sample callback per buffer for report interval statistic
+    unsigned frames_allocs_since; ///< count of data allocations at the start of the report interval statistic
     struct mg_mgr *mgr;
+    struct demod_thread *demod_thread; ///< demodulation worker, NULL if demodulating on the event loop
+    list_t receivers; ///< additional receivers, one per repeated input device option
+    struct r_cfg *primary; ///< the config owning the shared outputs, NULL if this is the primary
+    int tag_input; ///< tag events with the input device, used with multiple receivers
+    int plan_frequencies; ///< tune the receivers to cover the frequencies, hop only where needed
+    struct freq_plan *freq_plan; ///< the receivers covering each frequency, on the primary, NULL if not planned
+    list_t plan_receivers; ///< the receivers in the order of the devices of the frequency plan, not owned
+    int channel_count; ///< number of channels to split the input into, 0 to demodulate the input as is
+    struct channelizer *channelizer; ///< splits the input into the channels, NULL if not used
+    int channel_gpu; ///< run the channelizer on a GPU with OpenCL if there is one
+    list_t channels; ///< configs demodulating the channels, fed from this config
+    float spectrum_gate; ///< only demodulate a channel with bins this many dB over the noise floor, 0 to demodulate all channels
+    struct spectrum *spectrum; ///< monitors the spectrum occupancy of the channelized input, NULL if not used
+    int duty_survey; ///< seconds of each full listen window of the duty cycle, 0 to demodulate all frames
+    int duty_every; ///< seconds from one full listen window of the duty cycle to the next
+    struct duty_cycle *duty_cycle; ///< skips the frames between the expected transmissions of an input, NULL if not used
+    float load_shed_high; ///< shed load over this realtime load of an input, 0 to never shed load
+    float load_shed_low;  ///< restore the shed stages under this realtime load of an input
+    struct load_shed *load_shed; ///< steps the load shedding of an input by its realtime load, NULL if not used
+    int decimation; ///< factor to decimate the input by, 0 to demodulate the input as is
+    int decimation_shift; ///< frequency offset in Hz of the decimated band from the center frequency
+    struct decimator *decimator; ///< shifts and decimates the input into the single channel, NULL if not used
+    int worker_threads; ///< number of threads to demodulate the channels on, 0 or 1 to use the demod thread only
+    struct worker_pool *worker_pool; ///< runs the channels in parallel, NULL if not used
+    list_t pending_output; ///< output of a channel demodulated on the worker pool, replayed in order afterwards
+    list_t in_file_cfgs; ///< configs demodulating the input files of a batch on the worker pool, one per task
+    char const *batch_listen; ///< hands the input files to remote workers on this "tcp://[bind]:port", NULL if not used
+    uint64_t package_begin; ///< sample offset of the first package to decode, packages before are dropped
+    uint64_t package_end; ///< sample offset after the last package to decode, 0 for no limit
+    int decoder_threads; ///< number of threads to run the decoders of a priority on, 0 or 1 to run them in turn
+    struct decoder_pool *decoder_pool; ///< runs the decoders of this config and its channels, NULL if not used
+    int pipeline_packages; ///< packages queued between the pulse detection and the decoders, 0 to decode each package as it is detected
+    struct package_queue *package_queue; ///< decodes the packages on a thread of its own while the detection goes on, NULL if not used
+    unsigned decoder_shard; ///< keep only this shard of the decoders, from 1, 0 to keep all, see r_shard_decoders()
+    unsigned decoder_shards; ///< number of shards the decoders are split into
+    char *shard_costs; ///< file of the decoder costs to balance the shards by, NULL to count the decoders
+    struct r_cfg *staged_decoders; ///< a config with the decoders to swap in before the next buffer, NULL if none
+    struct r_cfg *retired_decoders; ///< the staging config with the decoders swapped out, freed on the event loop, NULL if none
+    int dedup_ms; ///< drop a message a decoder already output within this many ms of the package, 0 to output all
+    int early_decode; ///< decode the unfinished OOK packages with the decoders that set early_pulses
+    int decode_budget_us; ///< time for the decoders of a package, past it the cold decoders are skipped, 0 for no limit
+    struct event_fusion *fusion; ///< fuses the events with the other receivers in the group, on the primary, NULL if not used
+    unsigned merge_window_ms; ///< output the events of the inputs in the order of their sample time, 0 if not merged
+    struct event_merge *merge; ///< merges the events of the receivers, channels, and input files, on the primary, NULL if not used
+    int throttle_secs; ///< output each sensor at most once in this many seconds, 0 to output all
+    int throttle_mode; ///< the numeric values of the events output by the throttle, see throttle_mode_t
+    struct event_throttle *throttle; ///< drops the events of a sensor within the throttle interval, on the primary, NULL if not used
+    unsigned max_sensors; ///< keep the last-known state of up to this many sensors, 0 for none
+    struct sensor_state *sensor_state; ///< the last-known state of each sensor, on the primary, NULL if not used
+    unsigned recorder_secs; ///< keep the packages of the inputs for this many seconds, 0 if not recorded
+    uint32_t recorder_size; ///< the bytes of the packages kept
+    struct pulse_recorder *pulse_recorder; ///< the latest packages of all inputs, on the primary, NULL if not used
+    char *warm_start_path; ///< keep the detector levels in this file across restarts, NULL if not used
+    struct warm_start *warm_start; ///< the detector levels of each receiver and frequency, on the primary, NULL if not used
+    char warm_start_key[192]; ///< the receiver the detector levels of this input or channel are kept as, empty until started
+    uint64_t warm_start_ns; ///< the time the detector levels were last kept
+    char *trace_path; ///< write a trace to this file once the inputs are set up, NULL for no trace
+    int decoder_usage_report; ///< record the usage of each decoder and write a config of the protocols seen
+    char *decoder_usage_path; ///< write the config of the protocols seen to this file, NULL for stderr
+    struct decoder_usage *decoder_usage; ///< the usage of each decoder flushed with the stats, on the primary, NULL if not used
+    int kernel_autotune; ///< time the baseband kernel variants at startup and use the fastest of each
+    char *kernel_cache_path; ///< keep the choice of the kernels in this file, NULL to time on each start
+    unsigned trace_secs; ///< duration of the trace at startup, 0 to trace until exit
+    struct trace_event *trace; ///< the trace of the primary, copied to its channels for each buffer, NULL until a trace is started
+    unsigned trace_tid; ///< thread of the demod in the trace, 0 is the outputs, 1 the primary input, 2 and up its channels
 } r_cfg_t;
 
 #endif /* INCLUDE_RTL_433_H_ */
@@ -0,0 +1,103 @@
+/** @file
+    Compressed transport extension of the rtl_tcp protocol.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_RTLTCP_CODEC_H_
+#define INCLUDE_RTLTCP_CODEC_H_
+
+#include <stdint.h>
+
+/** Opt-in compression of the rtl_tcp sample stream.
+
+    After the "RTL0" header a client sends the command SET_COMPRESSION with the methods it
+    accepts. A server with the extension answers with an ack, a "RTLZ" magic, the chosen
+    method (0 for none) and a zero word, before any sample data. Every frame then is a block
+    with a 12 byte header: the block type, a parameter, two zero bytes, the raw length and
+    the payload length, both big endian, followed by the payload.
+
+    A stock server ignores the command and streams raw samples right away, the client keeps
+    the bytes read while looking for the ack as samples. A stock client never sends the
+    command and is served raw samples.
+
+    Blocks are either raw, zstd compressed (lossless), or 4 bit requantized noise: a frame
+    whose samples all stay within a small swing around the center is sent with 4 bits per
+    sample and a shift, lossless for a swing of +-8 and within half a step otherwise.
+*/
+typedef struct rtltcp_codec rtltcp_codec_t;
+
+/// The command to request the compressed transport, the parameter is a mask of methods.
+#define RTLTCP_SET_COMPRESSION 0x40
+
+#define RTLTCP_COMPRESS_ZSTD   0x01 ///< zstd compressed blocks
+#define RTLTCP_COMPRESS_NIBBLE 0x02 ///< 4 bit requantized noise blocks
+
+/// The length of the ack and of a block header.
+#define RTLTCP_CODEC_HEADER 12
+
+/// Largest raw length of a block accepted by the decoder.
+#define RTLTCP_CODEC_MAX_BLOCK (16 * 1024 * 1024)
+
+/// The methods supported by this build.
+unsigned rtltcp_codec_methods(void);
+
+/// Parse a list of methods, e.g. "zstd", "4bit", or NULL or empty for all supported, 0 if invalid.
+unsigned rtltcp_codec_parse(char const *arg);
+
+/// The name of a method, e.g. for the log.
+char const *rtltcp_codec_name(unsigned method);
+
+/// Pick the method to use from the offered ones, zstd is preferred, 0 if none.
+unsigned rtltcp_codec_choose(unsigned offered);
+
+/// Write the ack for a chosen method.
+void rtltcp_codec_ack(uint8_t ack[RTLTCP_CODEC_HEADER], unsigned method);
+
+/// Check for an ack, returns the chosen method, or -1 if this is not an ack.
+int rtltcp_codec_parse_ack(uint8_t const ack[RTLTCP_CODEC_HEADER], unsigned requested);
+
+/** Create an encoder or decoder.
+
+    @param method one of the methods, e.g. RTLTCP_COMPRESS_ZSTD
+    @return the codec, NULL if the method is not supported or on failure
+*/
+rtltcp_codec_t *rtltcp_codec_create(unsigned method);
+
+void rtltcp_codec_free(rtltcp_codec_t *codec);
+
+/** Encode a frame of CU8 samples to a block.
+
+    @param codec the codec
+    @param data the raw samples
+    @param len the length of @p data
+    @param[out] block_len the length of the block including the header
+    @return the block owned by the codec and valid until the next call, NULL on failure
+*/
+uint8_t const *rtltcp_codec_encode(rtltcp_codec_t *codec, uint8_t const *data, uint32_t len, uint32_t *block_len);
+
+/** Parse a block header.
+
+    @param header the block header
+    @param[out] raw_len the length of the decoded samples
+    @param[out] payload_len the length of the payload following the header
+    @return 0 on success, -1 if the header is invalid
+*/
+int rtltcp_codec_header(uint8_t const header[RTLTCP_CODEC_HEADER], uint32_t *raw_len, uint32_t *payload_len);
+
+/** Decode the payload of a block.
+
+    @param codec the codec
+    @param header the block header
+    @param payload the payload
+    @param out the samples, the raw length of the block
+    @return 0 on success, -1 on failure
+*/
+int rtltcp_codec_decode(rtltcp_codec_t *codec, uint8_t const header[RTLTCP_CODEC_HEADER], uint8_t const *payload, uint8_t *out);
+
+#endif /* INCLUDE_RTLTCP_CODEC_H_ */
@@ -14,27 +14,49 @@
 
 #include <stdint.h>
 
-typedef struct samp_grab {
-    uint32_t *frequency;
-    uint32_t *samp_rate;
-    int *sample_size;
-
-    unsigned sg_counter;
-    char *sg_buf;
-    unsigned sg_size;
-    unsigned sg_index;
-    unsigned sg_len;
-} samp_grab_t;
+/// Grabs waiting to be written, more signals are not saved.
+#define SAMP_GRAB_JOBS 16
 
+typedef struct samp_grab samp_grab_t;
+
+/** Create a grabber keeping the last @p size bytes of samples, grabs are written on a thread.
+
+    Without threads each grab is written as soon as its samples are pushed.
+
+    @param size the bytes of samples to keep
+    @return the grabber, NULL if it can't be created
+*/
 samp_grab_t *samp_grab_create(unsigned size);
 
+/// Write the pending grabs with the samples pushed so far and free the grabber.
 void samp_grab_free(samp_grab_t *g);
 
+/// Set the input the file names and the sample size are taken from, read when a grab is queued.
+void samp_grab_set_input(samp_grab_t *g, uint32_t *frequency, uint32_t *samp_rate, int *sample_size);
+
+/// Set the samples saved before and after a frame in ms, -1 for an eighth of a buffer.
+void samp_grab_set_padding(samp_grab_t *g, int pre_ms, int post_ms);
+
+/// Push samples, waits if the oldest samples of a pending grab are not written yet.
 void samp_grab_push(samp_grab_t *g, unsigned char *iq_buf, uint32_t len);
 
 void samp_grab_reset(samp_grab_t *g);
 
-/// grab_end is counted in samples from end of buf.
-void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end);
+/** Queue a grab, the file is written once the samples up to the end are pushed.
+
+    @param g the grabber
+    @param grab_len length of the grab in samples
+    @param grab_end end of the grab in samples from the end of the last pushed buf, negative to grab samples still to come
+*/
+void samp_grab_write(samp_grab_t *g, unsigned grab_len, int grab_end);
+
+/** Queue a grab of a frame with the padding before and after it.
+
+    @param g the grabber
+    @param frame_start_ago start of the frame in samples from the end of the last pushed buf
+    @param frame_end_ago end of the frame in samples from the end of the last pushed buf
+    @param n_samples the samples in a buf, for the default padding
+*/
+void samp_grab_write_frame(samp_grab_t *g, unsigned frame_start_ago, unsigned frame_end_ago, unsigned n_samples);
 
 #endif /* INCLUDE_SAMP_GRAB_H_ */
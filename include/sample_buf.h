@@ -0,0 +1,50 @@
+/** @file
+    Large sample buffers, backed by huge pages where available.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SAMPLE_BUF_H_
+#define INCLUDE_SAMPLE_BUF_H_
+
+#include <stddef.h>
+
+/// Alignment of the sample buffers, a cache line and enough for any SIMD load.
+#define SAMPLE_BUF_ALIGN 64
+
+/// The memory backing a sample buffer.
+typedef enum sample_buf_backing {
+    SAMPLE_BUF_HEAP,    ///< plain heap memory
+    SAMPLE_BUF_THP,     ///< heap memory advised for transparent huge pages
+    SAMPLE_BUF_HUGETLB, ///< a mapping of explicit huge pages (MAP_HUGETLB)
+    SAMPLE_BUF_BACKINGS,
+} sample_buf_backing_t;
+
+/** Allocate a sample buffer aligned to SAMPLE_BUF_ALIGN.
+
+    Buffers of at least a huge page try explicit huge pages first, then transparent huge pages,
+    smaller buffers and systems without huge pages fall back to the heap.
+
+    @param size the bytes of the buffer
+    @return the buffer, not cleared, NULL on alloc failure
+*/
+void *sample_buf_create(size_t size);
+
+/// Free a buffer from sample_buf_create(), the buffer may be NULL.
+void sample_buf_free(void *buf);
+
+/// Get the backing of a buffer from sample_buf_create().
+sample_buf_backing_t sample_buf_backing(void const *buf);
+
+/// Get the name of a backing, e.g. "hugetlb".
+char const *sample_buf_backing_name(sample_buf_backing_t backing);
+
+/// Get the bytes of the sample buffers currently allocated with a backing.
+size_t sample_buf_bytes(sample_buf_backing_t backing);
+
+#endif /* INCLUDE_SAMPLE_BUF_H_ */
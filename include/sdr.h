@@ -16,6 +16,8 @@
 
 #define SDR_DEFAULT_BUF_NUMBER 15
 #define SDR_DEFAULT_BUF_LENGTH 0x40000
+/// Time for the tuner PLL to lock after a retune, the samples until then are stamped as settling.
+#define SDR_RETUNE_SETTLE_MS 5
 
 typedef struct sdr_dev sdr_dev_t;
 
@@ -36,8 +38,26 @@ typedef struct sdr_event {
     char const *gain_str;
     void *buf;
     int len;
+    unsigned dropped; ///< number of data buffers dropped before this one
+    unsigned overflows; ///< number of stream overflows or abrupt stream ends before this buffer
+    int64_t time_ns; ///< time of the first sample in ns since the epoch from hardware timestamps, 0 if not available
+    int64_t publish_ns; ///< wall time in ns since the epoch when the buffer was handed to the consumer
+    unsigned merged; ///< number of following data buffers merged into this one, each still holds a ring slot
+    unsigned settle; ///< number of leading samples received before the tuner settled on the center frequency
+    uint64_t lost; ///< number of samples lost in a gap of the input before this buffer, e.g. while reconnecting
+    int leased; ///< the buffer is a leased transfer buffer, get the data with sdr_lease_begin()
 } sdr_event_t;
 
+/// Statistics of the link to a network input.
+typedef struct sdr_link_stats {
+    int reconnecting; ///< the connection was lost and is being established again
+    unsigned reconnects; ///< number of reconnects in place
+    uint64_t samples_lost; ///< number of samples lost while reconnecting
+    int rcvbuf; ///< effective socket receive buffer in bytes
+    unsigned retransmits; ///< number of TCP segments retransmitted, 0 if not available
+    unsigned rtt_us; ///< receiver side estimate of the round trip time in us, 0 if not available
+} sdr_link_stats_t;
+
 typedef void (*sdr_event_cb_t)(sdr_event_t *ev, void *ctx);
 
 /** Find the closest matching device, optionally report status.
@@ -49,6 +69,31 @@ typedef void (*sdr_event_cb_t)(sdr_event_t *ev, void *ctx);
 */
 int sdr_open(sdr_dev_t **out_dev, char const *dev_query, int verbose);
 
+/// A device being opened in the background, see sdr_open_start().
+typedef struct sdr_opener sdr_opener_t;
+
+/** Start to open a device on a thread, e.g. while the decoders are set up.
+
+    Without threads the device is opened by sdr_open_finish().
+
+    @param out_opener the opener output returned, set before the thread runs
+    @param dev_query a string to be parsed as device spec, must stay valid until finished
+    @param verbose the verbosity level for reports to stderr
+    @return 0 on success, -1 on alloc failure
+*/
+int sdr_open_start(sdr_opener_t **out_opener, char const *dev_query, int verbose);
+
+/// Return 1 if the caller is the thread opening the device, its messages should not go to the outputs.
+int sdr_open_is_current(sdr_opener_t *opener);
+
+/** Wait for the device to open and free the opener, see sdr_open().
+
+    @param opener the opener from sdr_open_start()
+    @param out_dev device output returned
+    @return dev 0 if successful
+*/
+int sdr_open_finish(sdr_opener_t *opener, sdr_dev_t **out_dev);
+
 /** Close the device.
 
     @note
@@ -60,6 +105,33 @@ int sdr_open(sdr_dev_t **out_dev, char const *dev_query, int verbose);
 */
 int sdr_close(sdr_dev_t *dev);
 
+/** Release the oldest SDR_EV_DATA buffer, the acquire thread can then reuse the slot.
+
+    Each data event holds one of the @p buf_num ring slots, buffers must be released in order.
+    If the consumer holds all slots new data is dropped and counted.
+
+    @param dev the device handle
+*/
+void sdr_release(sdr_dev_t *dev);
+
+/** Get the data of the oldest SDR_EV_DATA buffer, a leased transfer buffer is used until released.
+
+    A leased transfer buffer that the consumer did not start to use in time was copied to its ring slot,
+    the data is then in the ring slot. A transfer buffer refilled while in use is counted as dropped.
+
+    @param dev the device handle
+    @param ev the data event of the oldest buffer held
+    @return the data of the buffer, valid until sdr_release()
+*/
+uint8_t *sdr_lease_begin(sdr_dev_t *dev, sdr_event_t const *ev);
+
+/** Get the number of data buffers dropped because no ring slot was free.
+
+    @param dev the device handle
+    @return the number of dropped buffers since the device was opened
+*/
+unsigned sdr_get_dropped(sdr_dev_t *dev);
+
 /** Get device info.
 
     @param dev the device handle
@@ -83,6 +155,9 @@ int sdr_get_sample_signed(sdr_dev_t *dev);
 
 /** Set device frequency, optionally report status.
 
+    The acquisition keeps running while tuning, the data events of samples received
+    before the tuner settled on the new frequency are stamped with a settle count.
+
     @param dev the device handle
     @param freq in Hz
     @param verbose the verbosity level for reports to stderr
@@ -206,6 +281,14 @@ int sdr_start_sync(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_nu
 int sdr_stop(sdr_dev_t *dev);
 int sdr_stop_sync(sdr_dev_t *dev);
 
+/** Get the statistics of the link to a network input.
+
+    @param dev the device handle
+    @param[out] stats the link statistics
+    @return 0 on success, -1 if the device is not a network input
+*/
+int sdr_get_link_stats(sdr_dev_t *dev, sdr_link_stats_t *stats);
+
 /** Redirect SoapySDR library logging.
 */
 void sdr_redirect_logging(void);
@@ -0,0 +1,63 @@
+/** @file
+    Synthetic input: the bursts of simulated sensors in noise, for load tests.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SDR_SYNTH_H_
+#define INCLUDE_SDR_SYNTH_H_
+
+#include <stdint.h>
+
+/** A signal generator of simulated sensors, e.g. to measure the drops, the latency, and the load at scale.
+
+    Each sensor is one of the templates, sends every few seconds in sample time, and has
+    an id, a level, and a carrier offset of its own. A message is built into a pulse train,
+    with the timings the decoders of the template expect, and rendered as CU8 I/Q samples
+    on the noise floor. The bursts of different sensors overlap as on the air.
+
+    The templates are `nexus` (OOK PPM), `acurite` (Acurite 606TX, OOK PPM),
+    and `tpms` (Ford TPMS, FSK Manchester), the messages decode as the real sensors.
+*/
+typedef struct sdr_synth sdr_synth_t;
+
+/// The options of the signal generator, zero for the defaults.
+typedef struct sdr_synth_opts {
+    unsigned sensors;  ///< the number of sensors, default 100
+    char const *mix;   ///< the templates of the sensors, separated by `,` or `+`, NULL for all
+    unsigned every_ms; ///< each sensor sends this often, default 30 s, each interval varies by 10%
+    float noise_db;    ///< the noise floor in dB full scale, default -40 dB
+    float level_db;    ///< the level of the strongest sensors in dB full scale, default -6 dB, the others down to 12 dB less
+    uint32_t seed;     ///< the seed of the sensors and the noise, default 1
+} sdr_synth_opts_t;
+
+/** Create a signal generator.
+
+    @param opts the options, NULL for the defaults
+    @return the generator, NULL on an unknown template or failure
+*/
+sdr_synth_t *sdr_synth_create(sdr_synth_opts_t const *opts);
+
+void sdr_synth_free(sdr_synth_t *synth);
+
+/** Generate the next samples.
+
+    @param synth the generator
+    @param buf the CU8 samples to fill, 2 bytes a sample
+    @param n_samples the number of samples
+    @param sample_rate the sample rate, the sensors send at the intervals of the sample time
+*/
+void sdr_synth_fill(sdr_synth_t *synth, uint8_t *buf, unsigned n_samples, uint32_t sample_rate);
+
+/// The number of messages sent so far.
+unsigned sdr_synth_sent(sdr_synth_t const *synth);
+
+/// The number of messages not sent because too many bursts overlapped.
+unsigned sdr_synth_skipped(sdr_synth_t const *synth);
+
+#endif /* INCLUDE_SDR_SYNTH_H_ */
@@ -0,0 +1,58 @@
+/** @file
+    Last-known state of each sensor, the latest event kept for queries.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SENSOR_STATE_H_
+#define INCLUDE_SENSOR_STATE_H_
+
+struct data;
+
+/** Keeps the latest event of each sensor.
+
+    E.g. a dashboard polling "/devices" gets the current readings of all sensors in one response
+    instead of following the event stream. Each sensor (by model, id, and channel) keeps its latest
+    event as output, the time and the RSSI and SNR of its package, and the number of its events.
+    The events are retained, not copied.
+
+    The table is bounded, a new sensor over the limit evicts the sensor not heard the longest.
+    Events may be fed from different threads.
+*/
+typedef struct sensor_state sensor_state_t;
+
+/** Create a table.
+
+    @param max_sensors the most sensors kept
+    @return the table, NULL on failure
+*/
+sensor_state_t *sensor_state_create(unsigned max_sensors);
+
+void sensor_state_free(sensor_state_t *state);
+
+/** Keep the event of a sensor.
+
+    @param state the table
+    @param key the sensor, e.g. model, id, and channel
+    @param data the event, retained
+    @param time_str the time of the event
+    @param rssi_db the RSSI of the package
+    @param snr_db the SNR of the package
+*/
+void sensor_state_update(sensor_state_t *state, char const *key, struct data *data, char const *time_str, float rssi_db, float snr_db);
+
+/// A snapshot of all sensors kept, the most recently heard first.
+struct data *sensor_state_data(sensor_state_t *state);
+
+/// The number of sensors kept.
+unsigned sensor_state_sensors(sensor_state_t *state);
+
+/// The number of sensors evicted.
+unsigned sensor_state_evicted(sensor_state_t *state);
+
+#endif /* INCLUDE_SENSOR_STATE_H_ */
@@ -0,0 +1,42 @@
+/** @file
+    SigMF recording meta data.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SIGMF_H_
+#define INCLUDE_SIGMF_H_
+
+#include <stdint.h>
+#include "fileformat.h"
+
+/// Replace a trailing ".sigmf-meta" with ".sigmf-data" in place, the samples are read from the data file.
+void sigmf_data_path(char *path);
+
+/** Read the meta data of a SigMF recording, sets the format, sample rate, and center frequency.
+
+    The meta data is read from the ".sigmf-meta" file next to the ".sigmf-data" file of info->path.
+
+    @param info the file info of the data file
+    @return 0 on success, -1 if the meta data can't be read or the datatype is not supported
+*/
+int sigmf_read_meta(file_info_t *info);
+
+/** Write the meta data of a SigMF recording.
+
+    @param info the file info of the data file, an IQ format
+    @param sample_rate the sample rate of the recording
+    @param center_frequency the center frequency of the recording
+    @return 0 on success, -1 on failure
+*/
+int sigmf_write_meta(file_info_t const *info, uint32_t sample_rate, uint32_t center_frequency);
+
+/// Return the SigMF datatype of a file format, NULL if the format can't be stored in SigMF.
+char const *sigmf_datatype(uint32_t format);
+
+#endif /* INCLUDE_SIGMF_H_ */
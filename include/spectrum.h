@@ -0,0 +1,78 @@
+/** @file
+    FFT spectrum occupancy monitor.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SPECTRUM_H_
+#define INCLUDE_SPECTRUM_H_
+
+#include <stdint.h>
+
+/// Default level over the noise floor of an occupied bin, noise alone rarely gets there.
+#define SPECTRUM_THRESHOLD_DB 10.0f
+
+/// Number of FFT bins, bin k is at k * rate / SPECTRUM_BINS (bins above half wrap to negative offsets).
+#define SPECTRUM_BINS 256
+
+/** Tracks the level, the noise floor, and the occupancy of each bin of a short FFT of the input.
+
+    The power of each bin is smoothed over a few adjacent bins, a bin is occupied
+    if it is a threshold above its noise floor. The noise floor follows the levels
+    of the unoccupied frames.
+*/
+typedef struct spectrum spectrum_t;
+
+/** Create a spectrum monitor.
+
+    @param stride the input samples from one FFT to the next, 0 for one FFT per buffer
+    @param threshold_db the level over the noise floor of an occupied bin
+    @return the monitor, NULL on alloc failure
+*/
+spectrum_t *spectrum_create(unsigned stride, float threshold_db);
+
+void spectrum_free(spectrum_t *sp);
+
+/// Clear the levels and the noise floor, e.g. on a retune.
+void spectrum_reset(spectrum_t *sp);
+
+/** Run the FFTs over a buffer of input samples.
+
+    @param sp the monitor
+    @param iq_buf input samples, interleaved CU8 or CS16
+    @param sample_size 2 for CU8, 4 for CS16
+    @param len number of input samples
+*/
+void spectrum_process(spectrum_t *sp, void const *iq_buf, int sample_size, uint32_t len);
+
+/// Return the bin of a frequency offset from the center frequency.
+unsigned spectrum_bin(int offset, uint32_t samp_rate);
+
+/** Check for occupied bins around a center bin.
+
+    @param sp the monitor
+    @param bin the center bin
+    @param half_width the bins to check on each side of the center bin
+    @param hold the input samples an occupied bin is held active
+    @return 1 if a bin was occupied in the last buffer or within the hold time, 0 otherwise
+*/
+int spectrum_active(spectrum_t const *sp, unsigned bin, unsigned half_width, uint64_t hold);
+
+/// Return the smoothed level of a bin in dB full scale.
+float spectrum_level_db(spectrum_t const *sp, unsigned bin);
+
+/// Return the noise floor of a bin in dB full scale.
+float spectrum_noise_db(spectrum_t const *sp, unsigned bin);
+
+/// Return the share of FFTs with the bin occupied since the last flush in percent.
+float spectrum_occupancy(spectrum_t const *sp, unsigned bin);
+
+/// Restart the occupancy counts, e.g. with each stats report.
+void spectrum_flush(spectrum_t *sp);
+
+#endif /* INCLUDE_SPECTRUM_H_ */
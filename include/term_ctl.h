@@ -57,6 +57,25 @@ void term_set_fg(void *ctx, term_color_t color);
  */
 void term_set_bg(void *ctx, term_color_t bg, term_color_t fg);
 
+/**
+ * Writes the escape sequence 'term_set_fg()' would print to a buffer.
+ * Returns the length like snprintf().
+ */
+int term_fg_sequence(term_color_t color, char *buf, size_t size);
+
+/**
+ * Writes the escape sequence 'term_set_bg()' would print to a buffer.
+ * Returns the length like snprintf(), 0 and an empty string if both colors are omitted.
+ */
+int term_bg_sequence(term_color_t bg, term_color_t fg, char *buf, size_t size);
+
+/**
+ * Writes a buffer with inline escape sequences from above in one go.
+ * On consoles without ANSI support the sequences are turned into console calls.
+ * Returns 0 on success, -1 on a write error.
+ */
+int term_write(void *ctx, char const *buf, size_t len);
+
 /*
  * Defined in newer <sal.h> for MSVC.
  */
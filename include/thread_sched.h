@@ -0,0 +1,51 @@
+/** @file
+    CPU affinity and scheduling policy of the acquire, demod, output, HTTP, and worker threads.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_THREAD_SCHED_H_
+#define INCLUDE_THREAD_SCHED_H_
+
+struct data_array;
+
+/// The kinds of threads, each kind has one setting for all its threads.
+typedef enum thread_role {
+    THREAD_ROLE_ACQUIRE, ///< the SDR acquire thread
+    THREAD_ROLE_DEMOD,   ///< the demod thread of a receiver
+    THREAD_ROLE_OUTPUT,  ///< the thread of each queued output
+    THREAD_ROLE_HTTP,    ///< the HTTP server thread
+    THREAD_ROLE_WORKER,  ///< the threads of the channel and file worker pool
+    THREAD_ROLES,
+} thread_role_t;
+
+/** Set the CPUs and the scheduling policy of a kind of thread.
+
+    The settings are process wide, set them before the threads are started.
+
+    @param role the kind of thread, e.g. "acquire", "demod", "output", "http", "worker"
+    @param spec the CPUs, e.g. "1", "2-3", or "0+2", or "any",
+                optionally followed by "/fifo" or "/rr" and a priority, e.g. "1/fifo/50"
+    @return 0 on success, -1 on an unknown role or an invalid spec
+*/
+int thread_sched_set(char const *role, char const *spec);
+
+/** Apply the setting of a kind of thread to the calling thread.
+
+    A warning is logged if the setting is not permitted or not supported,
+    the thread then keeps running with the default setting.
+    The effective setting is kept for thread_sched_data().
+
+    @param role the kind of the calling thread
+*/
+void thread_sched_apply(thread_role_t role);
+
+/// The setting and the effective setting of each kind of thread set, NULL if none are set.
+struct data_array *thread_sched_data(void);
+
+#endif /* INCLUDE_THREAD_SCHED_H_ */
@@ -0,0 +1,51 @@
+/** @file
+    TLS session resumption for the network outputs.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_TLS_SESSION_H_
+#define INCLUDE_TLS_SESSION_H_
+
+#include "optparse.h"
+
+struct mg_connection;
+
+/// TLS handshake statistics of an output.
+typedef struct tls_stats {
+    unsigned handshakes;       ///< handshakes completed
+    unsigned resumed;          ///< handshakes that resumed a session, no certificate exchange and key agreement
+    unsigned failed;           ///< handshakes that failed
+    unsigned handshake_ms;     ///< total time of the completed handshakes
+    unsigned max_handshake_ms; ///< longest completed handshake
+} tls_stats_t;
+
+/** The session of a server, shared by the outputs connecting with the same TLS settings.
+
+    A full handshake costs a certificate check and a key agreement, a resumed one is a
+    single round trip with symmetric crypto only. The last session a server issued is
+    kept and offered on each new connection to that server, e.g. on a reconnect.
+*/
+typedef struct tls_session tls_session_t;
+
+/// Get the shared session of a server, e.g. "tcp://host:443", NULL without TLS support.
+tls_session_t *tls_session_get(char const *address, tls_opts_t const *tls_opts);
+
+/// Release a session got with tls_session_get(), the session may be NULL.
+void tls_session_put(tls_session_t *session);
+
+/// Offer the kept session on a new connection, call right after mg_connect_opt().
+void tls_session_resume(tls_session_t *session, struct mg_connection *nc);
+
+/// Account the handshake in MG_EV_CONNECT with its status, and keep the session of the server.
+void tls_session_connected(tls_session_t *session, struct mg_connection *nc, int status, tls_stats_t *stats);
+
+/// Keep the latest session of the server, TLS 1.3 sends the tickets after the handshake, call on the first MG_EV_RECV and on MG_EV_CLOSE.
+void tls_session_save(tls_session_t *session, struct mg_connection *nc);
+
+#endif /* INCLUDE_TLS_SESSION_H_ */
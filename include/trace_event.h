@@ -0,0 +1,55 @@
+/** @file
+    Trace of spans and counters in the Chrome trace event format.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_TRACE_EVENT_H_
+#define INCLUDE_TRACE_EVENT_H_
+
+#include <stdint.h>
+
+/** A trace file in the JSON array format of Chrome trace events, view it with Perfetto or chrome://tracing.
+
+    A trace is created idle, each start writes a new file until stopped or its duration is over.
+    The timestamps are monotonic ns, i.e. from time_monotonic_ns(), written as us since the start.
+    All calls are thread-safe, names and categories are written as is and must not need JSON escaping.
+*/
+typedef struct trace_event trace_event_t;
+
+/// Create an idle trace, returns NULL on alloc failure.
+trace_event_t *trace_event_create(void);
+
+/** Start writing a trace file, a trace already running is stopped first.
+
+    @param trace the trace
+    @param path the file to write
+    @param secs the duration of the trace, 0 to trace until stopped
+    @return 0 on success, -1 if the file can't be opened
+*/
+int trace_event_start(trace_event_t *trace, char const *path, unsigned secs);
+
+/// Stop the trace and close the file, returns the number of events written.
+unsigned trace_event_stop(trace_event_t *trace);
+
+/// Return 1 if the trace writes events, the trace may be NULL.
+int trace_event_active(trace_event_t *trace);
+
+/// Name a thread of the trace.
+void trace_event_thread_name(trace_event_t *trace, unsigned tid, char const *name);
+
+/// Write a span from start_ns to end_ns on a thread.
+void trace_event_span(trace_event_t *trace, char const *name, char const *cat, unsigned tid, uint64_t start_ns, uint64_t end_ns);
+
+/// Write a value of a counter at ts_ns.
+void trace_event_counter(trace_event_t *trace, char const *name, uint64_t ts_ns, double value);
+
+/// Stop the trace and free it, the trace may be NULL.
+void trace_event_free(trace_event_t *trace);
+
+#endif /* INCLUDE_TRACE_EVENT_H_ */
@@ -0,0 +1,61 @@
+/** @file
+    Level estimates of each receiver and frequency saved for a warm start.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_WARM_START_H_
+#define INCLUDE_WARM_START_H_
+
+struct detect_state;
+
+/** Keeps the noise floor and pulse detector levels in a state file across restarts.
+
+    E.g. the noise level, the auto level, and the OOK low and high estimates otherwise
+    start over on each start and take seconds to settle, the packages of that time are
+    detected with wrong levels. The states are kept by receiver, e.g. the device serial,
+    the gain, and the level scale, and by frequency. They are restored when the input
+    starts and on each hop, and saved periodically and on exit.
+
+    The file is text, one state a line, and replaced as a whole. The most recently kept
+    states are saved, a bounded number. States may be kept from different threads.
+*/
+typedef struct warm_start warm_start_t;
+
+/** Create the table and read the states saved in the file, a missing file is not an error.
+
+    @param path the state file
+    @return the table, NULL on failure
+*/
+warm_start_t *warm_start_create(char const *path);
+
+void warm_start_free(warm_start_t *warm);
+
+/** Get the saved states of a receiver.
+
+    @param warm the table
+    @param receiver the receiver, e.g. the device, the gain, and the level scale
+    @param states the states to fill, the unused ones are zeroed
+    @param num_states the size of @p states
+    @return the number of states restored
+*/
+unsigned warm_start_restore(warm_start_t *warm, char const *receiver, struct detect_state *states, unsigned num_states);
+
+/** Keep the states of a receiver, the entries with a zero frequency are skipped.
+
+    @param warm the table
+    @param receiver the receiver
+    @param states the states to keep
+    @param num_states the size of @p states
+*/
+void warm_start_keep(warm_start_t *warm, char const *receiver, struct detect_state const *states, unsigned num_states);
+
+/// Write the file if a state changed, returns 0 on success.
+int warm_start_save(warm_start_t *warm);
+
+#endif /* INCLUDE_WARM_START_H_ */
@@ -0,0 +1,43 @@
+/** @file
+    Fixed size worker pool with work stealing.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_WORKER_POOL_H_
+#define INCLUDE_WORKER_POOL_H_
+
+#define WORKER_POOL_MAX_THREADS 16
+
+/** A fixed set of worker threads running batches of independent tasks.
+
+    Each worker has its own deque of tasks, a worker takes the newest task from its
+    own deque and steals the oldest task from the other deques when it runs out.
+    The thread calling worker_pool_run() works as one of the workers.
+*/
+typedef struct worker_pool worker_pool_t;
+
+/// A task, called on any of the workers.
+typedef void (*worker_task_fn)(void *arg);
+
+/// Create a pool of @p threads workers including the caller, returns NULL if threads are not available.
+worker_pool_t *worker_pool_create(unsigned threads);
+
+/// Stop and join the workers.
+void worker_pool_free(worker_pool_t *pool);
+
+/// Run @p fn once for each of the @p count args, returns when all tasks are done.
+void worker_pool_run(worker_pool_t *pool, worker_task_fn fn, void **args, unsigned count);
+
+/// Return the index into the args of the task the caller runs, -1 if the caller runs no task of the pool.
+int worker_pool_current_task(worker_pool_t *pool);
+
+/// Return the index of the worker the caller is, from 0 to one less than the threads, -1 if the caller is no worker of a running batch.
+int worker_pool_current_worker(worker_pool_t *pool);
+
+#endif /* INCLUDE_WORKER_POOL_H_ */
@@ -11,8 +11,11 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 
 #include "abuf.h"
 
@@ -67,3 +70,242 @@ int abuf_printf(abuf_t *buf, _Printf_format_string_ char const *restrict format,
     va_end(ap);
     return n;
 }
+
+// append a string, truncated like abuf_printf() would
+static void abuf_put(abuf_t *buf, char const *str, size_t len)
+{
+    if (!buf->left)
+        return;
+    size_t copy = len < buf->left - 1 ? len : buf->left - 1;
+    memcpy(buf->tail, str, copy);
+    buf->tail[copy] = '\0';
+    size_t n = len < buf->left ? len : buf->left;
+    buf->tail += n;
+    buf->left -= n;
+}
+
+// append literal text of a format, "%%" is a percent sign
+static void abuf_put_text(abuf_t *buf, char const *text, size_t len)
+{
+    while (len) {
+        char const *pct = memchr(text, '%', len);
+        size_t n = pct ? (size_t)(pct - text) + 1 : len;
+        abuf_put(buf, text, n);
+        n += pct ? 1 : 0;
+        text += n;
+        len -= n;
+    }
+}
+
+// write the decimal digits of a value, at least min_digits, backwards from the end, returns the first digit
+static char *fmt_digits(char *end, uint64_t val, int min_digits)
+{
+    int n = 0;
+    do {
+        *--end = (char)('0' + val % 10);
+        val /= 10;
+        ++n;
+    } while (val || n < min_digits);
+    return end;
+}
+
+// write a double like "%.*f" backwards from the end, returns the start or NULL if printf is needed
+static char *fmt_fixed(char *end, double val, int prec)
+{
+    static double const scales[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    if (prec < 0 || prec > 9)
+        return NULL;
+    double y = (signbit(val) ? -val : val) * scales[prec];
+    if (!(y < 4503599627370496.0)) // 2^52, this also rejects NaN and infinity
+        return NULL;
+    uint64_t n  = (uint64_t)y;
+    double frac = y - (double)n;
+    // the product is off by half an ulp at most, a fraction this close to one half might round either way
+    double margin = y * (1.0 / 1125899906842624.0); // 2^-50
+    if (frac - 0.5 <= margin && 0.5 - frac <= margin)
+        return NULL;
+    if (frac > 0.5)
+        n += 1;
+    uint64_t scale = (uint64_t)scales[prec];
+    char *p = end;
+    if (prec > 0) {
+        p    = fmt_digits(p, n % scale, prec);
+        *--p = '.';
+    }
+    p = fmt_digits(p, n / scale, 1);
+    if (signbit(val))
+        *--p = '-';
+    return p;
+}
+
+// split a format of one conversion into the text before, the conversion, and the text after,
+// returns the conversion "d", "u", or "f", 0 if the format needs printf
+static char fmt_parse(char const *format, size_t *before, int *prec, char const **after)
+{
+    char const *p = strchr(format, '%');
+    if (!p)
+        return 0;
+    *before = (size_t)(p - format);
+    *prec   = -1;
+    p += 1;
+    if (*p == '.') {
+        if (p[1] < '0' || p[1] > '9')
+            return 0;
+        *prec = p[1] - '0';
+        p += 2;
+    }
+    char conv = *p;
+    if (conv != 'f' && (*prec >= 0 || (conv != 'd' && conv != 'u')))
+        return 0;
+    *after = ++p;
+    for (; *p; ++p) {
+        if (*p == '%' && *++p != '%')
+            return 0;
+    }
+    return conv;
+}
+
+void abuf_print_fixed(abuf_t *buf, double val, int prec)
+{
+    char str[32];
+    char *end = str + sizeof(str);
+    char *p   = fmt_fixed(end, val, prec);
+    if (!p) {
+        abuf_printf(buf, "%.*f", prec, val);
+        return;
+    }
+    abuf_put(buf, p, (size_t)(end - p));
+}
+
+void abuf_print_double(abuf_t *buf, char const *format, double val)
+{
+    size_t before;
+    int prec;
+    char const *after;
+    char str[32];
+    char *end = str + sizeof(str);
+    char *p   = NULL;
+    if (fmt_parse(format, &before, &prec, &after) == 'f')
+        p = fmt_fixed(end, val, prec < 0 ? 6 : prec);
+    if (!p) {
+        abuf_printf(buf, format, val);
+        return;
+    }
+    abuf_put(buf, format, before);
+    abuf_put(buf, p, (size_t)(end - p));
+    abuf_put_text(buf, after, strlen(after));
+}
+
+void abuf_print_int(abuf_t *buf, char const *format, int val)
+{
+    size_t before;
+    int prec;
+    char const *after;
+    char const conv = fmt_parse(format, &before, &prec, &after);
+    if (conv != 'd' && conv != 'u') {
+        abuf_printf(buf, format, val);
+        return;
+    }
+    char str[16];
+    char *end = str + sizeof(str);
+    int neg   = conv == 'd' && val < 0;
+    char *p   = fmt_digits(end, neg ? 0U - (unsigned)val : (unsigned)val, 1);
+    if (neg)
+        *--p = '-';
+    abuf_put(buf, format, before);
+    abuf_put(buf, p, (size_t)(end - p));
+    abuf_put_text(buf, after, strlen(after));
+}
+
+// make room for len more chars and the terminator, returns the free size, 0 on alloc failure
+static size_t gbuf_reserve(gbuf_t *buf, size_t len)
+{
+    if (buf->len + len + 1 > buf->size) {
+        size_t size = buf->size ? buf->size : 256;
+        while (size < buf->len + len + 1)
+            size *= 2;
+        char *data = realloc(buf->data, size);
+        if (!data) {
+            buf->error = 1;
+            return 0;
+        }
+        buf->data = data;
+        buf->size = size;
+    }
+    return buf->size - buf->len;
+}
+
+void gbuf_free(gbuf_t *buf)
+{
+    free(buf->data);
+    buf->data  = NULL;
+    buf->len   = 0;
+    buf->size  = 0;
+    buf->error = 0;
+}
+
+void gbuf_clear(gbuf_t *buf)
+{
+    buf->len   = 0;
+    buf->error = 0;
+    if (buf->data)
+        buf->data[0] = '\0';
+}
+
+void gbuf_put(gbuf_t *buf, char const *str, size_t len)
+{
+    if (!gbuf_reserve(buf, len))
+        return;
+    memcpy(buf->data + buf->len, str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+void gbuf_cat(gbuf_t *buf, char const *str)
+{
+    gbuf_put(buf, str, strlen(str));
+}
+
+int gbuf_printf(gbuf_t *buf, _Printf_format_string_ char const *restrict format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    size_t left = gbuf_reserve(buf, 0);
+    va_list again;
+    va_copy(again, ap);
+    int n = left ? vsnprintf(buf->data + buf->len, left, format, ap) : -1;
+    if (n >= 0 && (size_t)n >= left) {
+        // did not fit, grow and print again
+        left = gbuf_reserve(buf, (size_t)n);
+        n    = left ? vsnprintf(buf->data + buf->len, left, format, again) : -1;
+    }
+    if (n > 0)
+        buf->len += (size_t)n;
+    va_end(again);
+    va_end(ap);
+    return n;
+}
+
+void gbuf_print_double(gbuf_t *buf, char const *format, double val)
+{
+    char str[64];
+    abuf_t tmp;
+    abuf_init(&tmp, str, sizeof(str));
+    abuf_print_double(&tmp, format, val);
+    if (!tmp.left) // truncated
+        gbuf_printf(buf, format, val);
+    else
+        gbuf_put(buf, str, (size_t)(tmp.tail - str));
+}
+
+void gbuf_print_int(gbuf_t *buf, char const *format, int val)
+{
+    char str[64];
+    abuf_t tmp;
+    abuf_init(&tmp, str, sizeof(str));
+    abuf_print_int(&tmp, format, val);
+    if (!tmp.left) // truncated
+        gbuf_printf(buf, format, val);
+    else
+        gbuf_put(buf, str, (size_t)(tmp.tail - str));
+}
@@ -18,36 +18,105 @@
 
 #include "logger.h"
 #include "r_util.h"
+#include "compat_atomic.h"
+#include "compat_time.h"
+#include "fatal.h"
 
-static uint16_t scaled_squares[256];
+/// Lookup table for envelope detection, the square of each sample minus the bias.
+#define SQ(i) (uint16_t)((127 - (i)) * (127 - (i)))
+#define SQ4(i) SQ(i), SQ(i + 1), SQ(i + 2), SQ(i + 3)
+#define SQ16(i) SQ4(i), SQ4(i + 4), SQ4(i + 8), SQ4(i + 12)
+#define SQ64(i) SQ16(i), SQ16(i + 16), SQ16(i + 32), SQ16(i + 48)
+static uint16_t const scaled_squares[256] = {SQ64(0), SQ64(64), SQ64(128), SQ64(192)};
+#undef SQ64
+#undef SQ16
+#undef SQ4
+#undef SQ
 
-/// precalculate lookup table for envelope detection.
-static void calc_squares(void)
+/// log2(1 + i / 256) in Q16, the mantissa steps of ratio_to_db_q16().
+static int32_t const log2_mantissa[257] = {
+        0, 369, 736, 1102, 1466, 1829, 2190, 2551,
+        2909, 3267, 3623, 3978, 4331, 4683, 5034, 5384,
+        5732, 6079, 6425, 6769, 7112, 7454, 7795, 8134,
+        8473, 8810, 9146, 9480, 9814, 10146, 10477, 10807,
+        11136, 11464, 11791, 12116, 12440, 12764, 13086, 13407,
+        13727, 14046, 14363, 14680, 14996, 15310, 15624, 15937,
+        16248, 16559, 16868, 17177, 17484, 17791, 18096, 18401,
+        18704, 19007, 19308, 19609, 19909, 20207, 20505, 20802,
+        21098, 21393, 21687, 21980, 22272, 22564, 22854, 23144,
+        23433, 23720, 24007, 24293, 24579, 24863, 25146, 25429,
+        25711, 25992, 26272, 26551, 26830, 27108, 27384, 27660,
+        27936, 28210, 28484, 28757, 29029, 29300, 29571, 29840,
+        30109, 30378, 30645, 30912, 31178, 31443, 31707, 31971,
+        32234, 32496, 32758, 33019, 33279, 33538, 33797, 34055,
+        34312, 34569, 34825, 35080, 35334, 35588, 35841, 36094,
+        36346, 36597, 36847, 37097, 37346, 37595, 37842, 38090,
+        38336, 38582, 38827, 39072, 39316, 39559, 39802, 40044,
+        40286, 40527, 40767, 41006, 41246, 41484, 41722, 41959,
+        42196, 42432, 42667, 42902, 43137, 43370, 43603, 43836,
+        44068, 44300, 44530, 44761, 44990, 45220, 45448, 45676,
+        45904, 46131, 46357, 46583, 46809, 47034, 47258, 47482,
+        47705, 47928, 48150, 48372, 48593, 48813, 49034, 49253,
+        49472, 49691, 49909, 50127, 50344, 50560, 50776, 50992,
+        51207, 51422, 51636, 51850, 52063, 52276, 52488, 52700,
+        52911, 53122, 53332, 53542, 53751, 53960, 54169, 54377,
+        54584, 54791, 54998, 55204, 55410, 55615, 55820, 56025,
+        56229, 56432, 56635, 56838, 57040, 57242, 57443, 57644,
+        57845, 58045, 58245, 58444, 58643, 58841, 59039, 59237,
+        59434, 59631, 59827, 60023, 60219, 60414, 60609, 60803,
+        60997, 61190, 61384, 61576, 61769, 61961, 62152, 62343,
+        62534, 62725, 62915, 63104, 63294, 63483, 63671, 63859,
+        64047, 64234, 64421, 64608, 64794, 64980, 65166, 65351,
+        65536,
+};
+
+// log2(x) in Q16, x > 0
+static int32_t log2_q16(uint64_t x)
+{
+    int e = 0;
+    for (unsigned step = 32; step > 0; step /= 2) {
+        if (x >> (e + step))
+            e += step;
+    }
+    // the 16 bits below the leading one select and interpolate a step
+    uint32_t m = e >= 16 ? (uint32_t)(x >> (e - 16)) : (uint32_t)(x << (16 - e));
+    unsigned i = (m >> 8) & 0xff;
+    unsigned f = m & 0xff;
+    return (e << 16) + log2_mantissa[i] + (((log2_mantissa[i + 1] - log2_mantissa[i]) * (int32_t)f) >> 8);
+}
+
+int ratio_to_db_q16(uint64_t num, uint64_t den)
 {
-    if (scaled_squares[0])
-        return; // already initialized
-    int i;
-    for (i = 0; i < 256; i++)
-        scaled_squares[i] = (127 - i) * (127 - i);
+    if (!num || !den)
+        return 0;
+    // 10*log10(2) in Q16 is 197283, the product of Q16 and Q16 rounded to Q16
+    int64_t l2 = (int64_t)log2_q16(num) - log2_q16(den);
+    int64_t db = l2 * 197283;
+    return (int)(db >= 0 ? (db + (1 << 15)) >> 16 : -((-db + (1 << 15)) >> 16));
 }
 
 // This will give a noisy envelope of OOK/ASK signals.
 // Subtract the bias (-128) and get an envelope estimation.
-float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+// Processes samples from i to len, returns the sum of the envelope.
+static uint32_t envelope_detect_tail(uint8_t const *iq_buf, uint16_t *y_buf, unsigned long i, uint32_t len)
 {
-    unsigned long i;
     uint32_t sum = 0;
-    for (i = 0; i < len; i++) {
+    for (; i < len; i++) {
         y_buf[i] = scaled_squares[iq_buf[2 * i ]] + scaled_squares[iq_buf[2 * i + 1]];
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? AMP_TO_DB((float)sum / len) : AMP_TO_DB(1);
+    return sum;
+}
+
+static uint32_t envelope_detect_scalar(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    return envelope_detect_tail(iq_buf, y_buf, 0, len);
 }
 
 /// This will give a noisy envelope of OOK/ASK signals.
 /// Subtracts the bias (-128) and calculates the norm (scaled by 16384).
-/// Using a LUT is slower for O1 and above.
-float envelope_detect_nolut(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+/// Using a LUT is slower for O1 and above, baseband_autotune() times both.
+static uint32_t envelope_detect_nolut_sum(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
 {
     unsigned long i;
     uint32_t sum = 0;
@@ -57,16 +126,21 @@ float envelope_detect_nolut(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len
         y_buf[i]  = x * x + y * y; // max 32768, fs 16384
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? AMP_TO_DB((float)sum / len) : AMP_TO_DB(1);
+    return sum;
+}
+
+float envelope_detect_nolut(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    return AMP_AVG_TO_DB(envelope_detect_nolut_sum(iq_buf, y_buf, len), len);
 }
 
 /// 122/128, 51/128 Magnitude Estimator for CU8 (SIMD has min/max).
 /// Note that magnitude emphasizes quiet signals / deemphasizes loud signals.
-float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+/// Processes samples from i to len, returns the sum of the magnitudes.
+static uint32_t magnitude_est_cu8_tail(uint8_t const *iq_buf, uint16_t *y_buf, unsigned long i, uint32_t len)
 {
-    unsigned long i;
     uint32_t sum = 0;
-    for (i = 0; i < len; i++) {
+    for (; i < len; i++) {
         uint16_t x = abs(iq_buf[2 * i] - 128);
         uint16_t y = abs(iq_buf[2 * i + 1] - 128);
         uint16_t mi = x < y ? x : y;
@@ -75,7 +149,12 @@ float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
         y_buf[i] = mag_est; // max 22144, fs 16384
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
+    return sum;
+}
+
+static uint32_t magnitude_est_cu8_scalar(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    return magnitude_est_cu8_tail(iq_buf, y_buf, 0, len);
 }
 
 /// True Magnitude for CU8 (sqrt can SIMD but float is slow).
@@ -89,15 +168,15 @@ float magnitude_true_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
         y_buf[i]  = (uint16_t)(sqrt(x * x + y * y) * 128.0); // max 181, scaled 23170, fs 16384
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
+    return MAG_AVG_TO_DB(sum, len);
 }
 
 /// 122/128, 51/128 Magnitude Estimator for CS16 (SIMD has min/max).
-float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+/// Processes samples from i to len, returns the sum of the magnitudes.
+static uint32_t magnitude_est_cs16_tail(int16_t const *iq_buf, uint16_t *y_buf, unsigned long i, uint32_t len)
 {
-    unsigned long i;
     uint32_t sum = 0;
-    for (i = 0; i < len; i++) {
+    for (; i < len; i++) {
         uint32_t x = abs(iq_buf[2 * i]);
         uint32_t y = abs(iq_buf[2 * i + 1]);
         uint32_t mi = x < y ? x : y;
@@ -106,7 +185,12 @@ float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
         y_buf[i] = mag_est >> 8; // max 5668864, scaled 22144, fs 16384
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
+    return sum;
+}
+
+static uint32_t magnitude_est_cs16_scalar(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    return magnitude_est_cs16_tail(iq_buf, y_buf, 0, len);
 }
 
 /// True Magnitude for CS16 (sqrt can SIMD but float is slow).
@@ -120,14 +204,1053 @@ float magnitude_true_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
         y_buf[i]  = (int)sqrt(x * x + y * y) >> 1; // max 46341, scaled 23170, fs 16384
         sum += y_buf[i];
     }
-    return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
+    return MAG_AVG_TO_DB(sum, len);
+}
+
+/** Integer implementation of atan2() with int16_t normalized output.
+
+    Returns arc tangent of y/x across all quadrants in radians.
+    Error max 0.07 radians.
+    Reference: http://dspguru.com/dsp/tricks/fixed-point-atan2-with-self-normalization
+    @param y Numerator (imaginary value of complex vector)
+    @param x Denominator (real value of complex vector)
+    @return angle in radians (Pi equals INT16_MAX)
+*/
+static int16_t atan2_int16(int32_t y, int32_t x)
+{
+    static int32_t const I_PI_4 = INT16_MAX/4;      // M_PI/4
+    static int32_t const I_3_PI_4 = 3*INT16_MAX/4;  // 3*M_PI/4
+
+    int32_t const abs_y = abs(y);
+    int32_t angle;
+
+    if (!x && !y) return 0; // We would get 8191 with the code below
+
+    if (x >= 0) {    // Quadrant I and IV
+        int32_t denom = (abs_y + x);
+        if (denom == 0) denom = 1;  // Prevent divide by zero
+        angle = I_PI_4 - I_PI_4 * (x - abs_y) / denom;
+    } else {        // Quadrant II and III
+        int32_t denom = (abs_y - x);
+        if (denom == 0) denom = 1;  // Prevent divide by zero
+        angle = I_3_PI_4 - I_PI_4 * (x + abs_y) / denom;
+    }
+    if (y < 0) angle = -angle;    // Negate if in III or IV
+    return angle;
+}
+
+// Instantaneous frequency of x[n] * conj(x[n-1]) for CU8 samples from i to len, i must be at least 1.
+static void demod_fm_phase_cu8_tail(uint8_t const *iq_buf, int16_t *f_buf, unsigned long i, uint32_t len)
+{
+    for (; i < len; i++) {
+        int32_t x0r = iq_buf[2 * i] - 128;
+        int32_t x0i = iq_buf[2 * i + 1] - 128;
+        int32_t x1r = iq_buf[2 * i - 2] - 128;
+        int32_t x1i = iq_buf[2 * i - 1] - 128;
+        int32_t pr  = x0r * x1r + x0i * x1i; // May exactly overflow an int16_t (-128*-128 + -128*-128)
+        int32_t pi  = x0i * x1r - x0r * x1i;
+        f_buf[i]    = atan2_int16(pi, pr);
+    }
+}
+
+static void demod_fm_phase_cu8_scalar(uint8_t const *iq_buf, int16_t *f_buf, uint32_t len)
+{
+    demod_fm_phase_cu8_tail(iq_buf, f_buf, 1, len);
+}
+
+static void classify_widths_tail(int const *widths, uint8_t *symbols, unsigned long i, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS])
+{
+    for (; i < len; i++) {
+        int w = widths[i];
+        unsigned k = 0;
+        while (k < BASEBAND_WINDOWS && (w <= lower[k] || w >= upper[k]))
+            k++;
+        symbols[i] = (uint8_t)k;
+    }
+}
+
+static void classify_widths_scalar(int const *widths, uint8_t *symbols, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS])
+{
+    classify_widths_tail(widths, symbols, 0, len, lower, upper);
+}
+
+/* SIMD kernels, bit-exact with the scalar reference */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BASEBAND_X86
+#include <immintrin.h>
+
+__attribute__((target("sse2")))
+static uint32_t envelope_detect_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi16(127);
+    __m128i const half = _mm_set1_epi32(0x8000);
+    __m128i const flip = _mm_set1_epi16((short)0x8000);
+    __m128i acc = zero;
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i v  = _mm_loadu_si128((__m128i const *)&iq_buf[2 * i]);
+        __m128i lo = _mm_sub_epi16(bias, _mm_unpacklo_epi8(v, zero));
+        __m128i hi = _mm_sub_epi16(bias, _mm_unpackhi_epi8(v, zero));
+        // I*I + Q*Q per sample, max 32768
+        __m128i plo = _mm_madd_epi16(lo, lo);
+        __m128i phi = _mm_madd_epi16(hi, hi);
+        acc = _mm_add_epi32(acc, _mm_add_epi32(plo, phi));
+        // offset to the signed range for the saturating pack, then back
+        __m128i y = _mm_packs_epi32(_mm_sub_epi32(plo, half), _mm_sub_epi32(phi, half));
+        _mm_storeu_si128((__m128i *)&y_buf[i], _mm_xor_si128(y, flip));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    uint32_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    sum += envelope_detect_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static uint32_t magnitude_est_cu8_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi16(128);
+    __m128i const mask = _mm_set1_epi32(0xffff);
+    __m128i const k122 = _mm_set1_epi16(122);
+    __m128i const k51  = _mm_set1_epi16(51);
+    __m128i acc = zero;
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&iq_buf[2 * i]);
+        __m128i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i d = _mm_sub_epi16(h ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero), bias);
+            __m128i a = _mm_max_epi16(d, _mm_sub_epi16(zero, d)); // abs
+            __m128i b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, 0xb1), 0xb1); // swap I and Q
+            __m128i mx = _mm_max_epi16(a, b);
+            __m128i mi = _mm_min_epi16(a, b);
+            __m128i m  = _mm_add_epi16(_mm_mullo_epi16(mx, k122), _mm_mullo_epi16(mi, k51));
+            r[h] = _mm_and_si128(m, mask); // both halves are equal, max 22144
+        }
+        acc = _mm_add_epi32(acc, _mm_add_epi32(r[0], r[1]));
+        _mm_storeu_si128((__m128i *)&y_buf[i], _mm_packs_epi32(r[0], r[1]));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    uint32_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    sum += magnitude_est_cu8_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static uint32_t magnitude_est_cs16_sse2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i acc = _mm_setzero_si128();
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i v = _mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 8 * h]);
+            // deinterleave and sign extend to 32 bit
+            __m128i x = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+            __m128i y = _mm_srai_epi32(v, 16);
+            // abs, max 32768
+            __m128i sx = _mm_srai_epi32(x, 31);
+            __m128i sy = _mm_srai_epi32(y, 31);
+            x = _mm_sub_epi32(_mm_xor_si128(x, sx), sx);
+            y = _mm_sub_epi32(_mm_xor_si128(y, sy), sy);
+            __m128i gt = _mm_cmpgt_epi32(x, y);
+            __m128i mx = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, y));
+            __m128i mi = _mm_or_si128(_mm_and_si128(gt, y), _mm_andnot_si128(gt, x));
+            // 122 * mx + 51 * mi, there is no 32 bit multiply in SSE2
+            __m128i m = _mm_sub_epi32(_mm_slli_epi32(mx, 7), _mm_add_epi32(_mm_slli_epi32(mx, 2), _mm_slli_epi32(mx, 1)));
+            m = _mm_add_epi32(m, _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(mi, 5), _mm_slli_epi32(mi, 4)), _mm_add_epi32(_mm_slli_epi32(mi, 1), mi)));
+            r[h] = _mm_srli_epi32(m, 8); // max 22144
+        }
+        acc = _mm_add_epi32(acc, _mm_add_epi32(r[0], r[1]));
+        _mm_storeu_si128((__m128i *)&y_buf[i], _mm_packs_epi32(r[0], r[1]));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    uint32_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    sum += magnitude_est_cs16_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+/// atan2_int16() on four lanes, the integer division is exact in double precision for these ranges.
+__attribute__((target("sse2")))
+static __m128i atan2_int16_sse2(__m128i y, __m128i x)
+{
+    __m128i const zero   = _mm_setzero_si128();
+    __m128i const pi_4   = _mm_set1_epi32(INT16_MAX / 4);
+    __m128i const pi_3_4 = _mm_set1_epi32(3 * INT16_MAX / 4);
+    __m128d const k_pi_4 = _mm_set1_pd(INT16_MAX / 4);
+
+    __m128i sy    = _mm_srai_epi32(y, 31);
+    __m128i sx    = _mm_srai_epi32(x, 31);
+    __m128i abs_y = _mm_sub_epi32(_mm_xor_si128(y, sy), sy);
+    __m128i abs_x = _mm_sub_epi32(_mm_xor_si128(x, sx), sx);
+    // x >= 0: (x - abs_y) / (abs_y + x), x < 0: (x + abs_y) / (abs_y - x)
+    __m128i denom = _mm_add_epi32(abs_y, abs_x);
+    __m128i num   = _mm_sub_epi32(x, _mm_sub_epi32(_mm_xor_si128(abs_y, sx), sx));
+    __m128i base  = _mm_or_si128(_mm_and_si128(sx, pi_3_4), _mm_andnot_si128(sx, pi_4));
+    __m128i is0   = _mm_cmpeq_epi32(denom, zero);
+    denom = _mm_sub_epi32(denom, is0); // Prevent divide by zero
+    __m128d qlo = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(num), k_pi_4), _mm_cvtepi32_pd(denom));
+    __m128d qhi = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(num, 0xee)), k_pi_4),
+            _mm_cvtepi32_pd(_mm_shuffle_epi32(denom, 0xee)));
+    __m128i q     = _mm_unpacklo_epi64(_mm_cvttpd_epi32(qlo), _mm_cvttpd_epi32(qhi));
+    __m128i angle = _mm_andnot_si128(is0, _mm_sub_epi32(base, q)); // x and y both 0 gives 0
+    return _mm_sub_epi32(_mm_xor_si128(angle, sy), sy); // Negate if in III or IV
+}
+
+__attribute__((target("sse2")))
+static void demod_fm_phase_cu8_sse2(uint8_t const *iq_buf, int16_t *f_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi16(128);
+    __m128i const even = _mm_set1_epi32(0xffff);
+    unsigned long i = 1;
+    for (; i + 4 <= len; i += 4) {
+        __m128i x0 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *)&iq_buf[2 * i]), zero), bias);
+        __m128i x1 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i const *)&iq_buf[2 * i - 2]), zero), bias);
+        __m128i sw = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x0, 0xb1), 0xb1); // swap I and Q
+        __m128i pr = _mm_madd_epi16(x0, x1);
+        __m128i pi = _mm_sub_epi32(_mm_madd_epi16(sw, _mm_and_si128(x1, even)), _mm_madd_epi16(sw, _mm_andnot_si128(even, x1)));
+        __m128i f  = atan2_int16_sse2(pi, pr);
+        _mm_storel_epi64((__m128i *)&f_buf[i], _mm_packs_epi32(f, f));
+    }
+    demod_fm_phase_cu8_tail(iq_buf, f_buf, i, len);
+}
+
+/// classify_widths() on four lanes, the windows are tested last to first so the first one wins.
+__attribute__((target("sse2")))
+static __m128i classify_widths4_sse2(__m128i w, __m128i const *lo, __m128i const *up)
+{
+    __m128i s = _mm_set1_epi32(BASEBAND_SYMBOL_OTHER);
+    for (int k = BASEBAND_WINDOWS - 1; k >= 0; --k) {
+        __m128i in = _mm_and_si128(_mm_cmpgt_epi32(w, lo[k]), _mm_cmpgt_epi32(up[k], w));
+        s = _mm_or_si128(_mm_and_si128(in, _mm_set1_epi32(k)), _mm_andnot_si128(in, s));
+    }
+    return s;
+}
+
+__attribute__((target("sse2")))
+static void classify_widths_sse2(int const *widths, uint8_t *symbols, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS])
+{
+    __m128i lo[BASEBAND_WINDOWS];
+    __m128i up[BASEBAND_WINDOWS];
+    for (int k = 0; k < BASEBAND_WINDOWS; ++k) {
+        lo[k] = _mm_set1_epi32(lower[k]);
+        up[k] = _mm_set1_epi32(upper[k]);
+    }
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i s0 = classify_widths4_sse2(_mm_loadu_si128((__m128i const *)&widths[i]), lo, up);
+        __m128i s1 = classify_widths4_sse2(_mm_loadu_si128((__m128i const *)&widths[i + 4]), lo, up);
+        __m128i s2 = classify_widths4_sse2(_mm_loadu_si128((__m128i const *)&widths[i + 8]), lo, up);
+        __m128i s3 = classify_widths4_sse2(_mm_loadu_si128((__m128i const *)&widths[i + 12]), lo, up);
+        __m128i s  = _mm_packus_epi16(_mm_packs_epi32(s0, s1), _mm_packs_epi32(s2, s3));
+        _mm_storeu_si128((__m128i *)&symbols[i], s);
+    }
+    for (; i + 4 <= len; i += 4) {
+        __m128i s = classify_widths4_sse2(_mm_loadu_si128((__m128i const *)&widths[i]), lo, up);
+        s = _mm_packus_epi16(_mm_packs_epi32(s, s), s);
+        int32_t v = _mm_cvtsi128_si32(s);
+        memcpy(&symbols[i], &v, sizeof(v));
+    }
+    classify_widths_tail(widths, symbols, i, len, lower, upper);
+}
+
+__attribute__((target("avx2")))
+static uint32_t sum_epi32_avx2(__m256i acc)
+{
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    uint32_t sum = 0;
+    for (int k = 0; k < 8; ++k)
+        sum += lanes[k];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static uint32_t envelope_detect_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i const bias = _mm256_set1_epi16(127);
+    __m256i const half = _mm256_set1_epi32(0x8000);
+    __m256i const flip = _mm256_set1_epi16((short)0x8000);
+    __m256i acc = _mm256_setzero_si256();
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i lo = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i]));
+        __m256i hi = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 16]));
+        lo = _mm256_sub_epi16(bias, lo);
+        hi = _mm256_sub_epi16(bias, hi);
+        __m256i plo = _mm256_madd_epi16(lo, lo);
+        __m256i phi = _mm256_madd_epi16(hi, hi);
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(plo, phi));
+        __m256i y = _mm256_packs_epi32(_mm256_sub_epi32(plo, half), _mm256_sub_epi32(phi, half));
+        y = _mm256_permute4x64_epi64(y, 0xd8); // the pack works per 128 bit lane
+        _mm256_storeu_si256((__m256i *)&y_buf[i], _mm256_xor_si256(y, flip));
+    }
+    uint32_t sum = sum_epi32_avx2(acc);
+    sum += envelope_detect_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static uint32_t magnitude_est_cu8_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i const bias = _mm256_set1_epi16(128);
+    __m256i const mask = _mm256_set1_epi32(0xffff);
+    __m256i const k122 = _mm256_set1_epi16(122);
+    __m256i const k51  = _mm256_set1_epi16(51);
+    __m256i acc = _mm256_setzero_si256();
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m256i d  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 16 * h]));
+            __m256i a  = _mm256_abs_epi16(_mm256_sub_epi16(d, bias));
+            __m256i b  = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a, 0xb1), 0xb1); // swap I and Q
+            __m256i mx = _mm256_max_epi16(a, b);
+            __m256i mi = _mm256_min_epi16(a, b);
+            __m256i m  = _mm256_add_epi16(_mm256_mullo_epi16(mx, k122), _mm256_mullo_epi16(mi, k51));
+            r[h] = _mm256_and_si256(m, mask);
+        }
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(r[0], r[1]));
+        __m256i y = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xd8);
+        _mm256_storeu_si256((__m256i *)&y_buf[i], y);
+    }
+    uint32_t sum = sum_epi32_avx2(acc);
+    sum += magnitude_est_cu8_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static uint32_t magnitude_est_cs16_avx2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i const k122 = _mm256_set1_epi32(122);
+    __m256i const k51  = _mm256_set1_epi32(51);
+    __m256i acc = _mm256_setzero_si256();
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m256i v  = _mm256_loadu_si256((__m256i const *)&iq_buf[2 * i + 16 * h]);
+            // deinterleave and sign extend to 32 bit, abs is max 32768
+            __m256i x  = _mm256_abs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16));
+            __m256i y  = _mm256_abs_epi32(_mm256_srai_epi32(v, 16));
+            __m256i mx = _mm256_max_epi32(x, y);
+            __m256i mi = _mm256_min_epi32(x, y);
+            __m256i m  = _mm256_add_epi32(_mm256_mullo_epi32(mx, k122), _mm256_mullo_epi32(mi, k51));
+            r[h] = _mm256_srli_epi32(m, 8); // max 22144
+        }
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(r[0], r[1]));
+        __m256i y = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xd8); // the pack works per 128 bit lane
+        _mm256_storeu_si256((__m256i *)&y_buf[i], y);
+    }
+    uint32_t sum = sum_epi32_avx2(acc);
+    sum += magnitude_est_cs16_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+/// atan2_int16() on eight lanes, the integer division is exact in double precision for these ranges.
+__attribute__((target("avx2")))
+static __m256i atan2_int16_avx2(__m256i y, __m256i x)
+{
+    __m256i const zero   = _mm256_setzero_si256();
+    __m256i const pi_4   = _mm256_set1_epi32(INT16_MAX / 4);
+    __m256i const pi_3_4 = _mm256_set1_epi32(3 * INT16_MAX / 4);
+    __m256d const k_pi_4 = _mm256_set1_pd(INT16_MAX / 4);
+
+    __m256i sx    = _mm256_cmpgt_epi32(zero, x);
+    __m256i abs_y = _mm256_abs_epi32(y);
+    // x >= 0: (x - abs_y) / (abs_y + x), x < 0: (x + abs_y) / (abs_y - x)
+    __m256i denom = _mm256_add_epi32(abs_y, _mm256_abs_epi32(x));
+    __m256i num   = _mm256_sub_epi32(x, _mm256_sub_epi32(_mm256_xor_si256(abs_y, sx), sx));
+    __m256i base  = _mm256_blendv_epi8(pi_4, pi_3_4, sx);
+    __m256i is0   = _mm256_cmpeq_epi32(denom, zero);
+    denom = _mm256_sub_epi32(denom, is0); // Prevent divide by zero
+    __m256d qlo = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(num)), k_pi_4),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(denom)));
+    __m256d qhi = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(num, 1)), k_pi_4),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(denom, 1)));
+    __m256i q     = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(qlo)), _mm256_cvttpd_epi32(qhi), 1);
+    __m256i angle = _mm256_andnot_si256(is0, _mm256_sub_epi32(base, q)); // x and y both 0 gives 0
+    __m256i sy    = _mm256_srai_epi32(y, 31);
+    return _mm256_sub_epi32(_mm256_xor_si256(angle, sy), sy); // Negate if in III or IV
+}
+
+__attribute__((target("avx2")))
+static void demod_fm_phase_cu8_avx2(uint8_t const *iq_buf, int16_t *f_buf, uint32_t len)
+{
+    __m256i const bias = _mm256_set1_epi16(128);
+    __m256i const even = _mm256_set1_epi32(0xffff);
+    unsigned long i = 1;
+    for (; i + 8 <= len; i += 8) {
+        __m256i x0 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i])), bias);
+        __m256i x1 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i - 2])), bias);
+        __m256i sw = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x0, 0xb1), 0xb1); // swap I and Q
+        __m256i pr = _mm256_madd_epi16(x0, x1);
+        __m256i pi = _mm256_sub_epi32(_mm256_madd_epi16(sw, _mm256_and_si256(x1, even)), _mm256_madd_epi16(sw, _mm256_andnot_si256(even, x1)));
+        __m256i f  = atan2_int16_avx2(pi, pr);
+        f = _mm256_permute4x64_epi64(_mm256_packs_epi32(f, f), 0x08);
+        _mm_storeu_si128((__m128i *)&f_buf[i], _mm256_castsi256_si128(f));
+    }
+    demod_fm_phase_cu8_tail(iq_buf, f_buf, i, len);
+}
+
+/// classify_widths_sse2() on eight lanes.
+__attribute__((target("avx2")))
+static __m256i classify_widths8_avx2(__m256i w, __m256i const *lo, __m256i const *up)
+{
+    __m256i s = _mm256_set1_epi32(BASEBAND_SYMBOL_OTHER);
+    for (int k = BASEBAND_WINDOWS - 1; k >= 0; --k) {
+        __m256i in = _mm256_and_si256(_mm256_cmpgt_epi32(w, lo[k]), _mm256_cmpgt_epi32(up[k], w));
+        s = _mm256_blendv_epi8(s, _mm256_set1_epi32(k), in);
+    }
+    return s;
+}
+
+__attribute__((target("avx2")))
+static void classify_widths_avx2(int const *widths, uint8_t *symbols, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS])
+{
+    __m256i const order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256i lo[BASEBAND_WINDOWS];
+    __m256i up[BASEBAND_WINDOWS];
+    for (int k = 0; k < BASEBAND_WINDOWS; ++k) {
+        lo[k] = _mm256_set1_epi32(lower[k]);
+        up[k] = _mm256_set1_epi32(upper[k]);
+    }
+    unsigned long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i s0 = classify_widths8_avx2(_mm256_loadu_si256((__m256i const *)&widths[i]), lo, up);
+        __m256i s1 = classify_widths8_avx2(_mm256_loadu_si256((__m256i const *)&widths[i + 8]), lo, up);
+        __m256i s2 = classify_widths8_avx2(_mm256_loadu_si256((__m256i const *)&widths[i + 16]), lo, up);
+        __m256i s3 = classify_widths8_avx2(_mm256_loadu_si256((__m256i const *)&widths[i + 24]), lo, up);
+        // the packs work per 128 bit lane, the dwords of the result are restored to order
+        __m256i s = _mm256_packus_epi16(_mm256_packs_epi32(s0, s1), _mm256_packs_epi32(s2, s3));
+        _mm256_storeu_si256((__m256i *)&symbols[i], _mm256_permutevar8x32_epi32(s, order));
+    }
+    for (; i + 8 <= len; i += 8) {
+        __m256i s = classify_widths8_avx2(_mm256_loadu_si256((__m256i const *)&widths[i]), lo, up);
+        __m128i p = _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        _mm_storel_epi64((__m128i *)&symbols[i], _mm_packus_epi16(p, p));
+    }
+    classify_widths_tail(widths, symbols, i, len, lower, upper);
+}
+
+#endif /* BASEBAND_X86 */
+
+#if defined(__ARM_NEON)
+#define BASEBAND_NEON
+#include <arm_neon.h>
+
+static uint32_t sum_u32_neon(uint32x4_t acc)
+{
+    return vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+}
+
+static uint32_t envelope_detect_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    int16x8_t const bias = vdupq_n_s16(127);
+    uint32x4_t acc = vdupq_n_u32(0);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint8x8x2_t v = vld2_u8(&iq_buf[2 * i]); // deinterleave I and Q
+        int16x8_t x = vsubq_s16(bias, vreinterpretq_s16_u16(vmovl_u8(v.val[0])));
+        int16x8_t y = vsubq_s16(bias, vreinterpretq_s16_u16(vmovl_u8(v.val[1])));
+        // each square is max 16384, the sum max 32768
+        uint16x8_t e = vaddq_u16(vreinterpretq_u16_s16(vmulq_s16(x, x)), vreinterpretq_u16_s16(vmulq_s16(y, y)));
+        vst1q_u16(&y_buf[i], e);
+        acc = vpadalq_u16(acc, e);
+    }
+    uint32_t sum = sum_u32_neon(acc);
+    sum += envelope_detect_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+static uint32_t magnitude_est_cu8_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint8x8_t const bias = vdup_n_u8(128);
+    uint32x4_t acc = vdupq_n_u32(0);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint8x8x2_t v = vld2_u8(&iq_buf[2 * i]); // deinterleave I and Q
+        uint16x8_t x  = vabdl_u8(v.val[0], bias);
+        uint16x8_t y  = vabdl_u8(v.val[1], bias);
+        uint16x8_t mx = vmaxq_u16(x, y);
+        uint16x8_t mi = vminq_u16(x, y);
+        uint16x8_t m  = vmlaq_n_u16(vmulq_n_u16(mx, 122), mi, 51); // max 22144
+        vst1q_u16(&y_buf[i], m);
+        acc = vpadalq_u16(acc, m);
+    }
+    uint32_t sum = sum_u32_neon(acc);
+    sum += magnitude_est_cu8_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+static uint32_t magnitude_est_cs16_neon(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32x4_t acc = vdupq_n_u32(0);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        int16x8x2_t v = vld2q_s16(&iq_buf[2 * i]); // deinterleave I and Q
+        uint16x4_t m[2];
+        for (int h = 0; h < 2; ++h) {
+            int16x4_t vi = h ? vget_high_s16(v.val[0]) : vget_low_s16(v.val[0]);
+            int16x4_t vq = h ? vget_high_s16(v.val[1]) : vget_low_s16(v.val[1]);
+            // abs in 32 bit, max 32768
+            uint32x4_t x  = vreinterpretq_u32_s32(vabsq_s32(vmovl_s16(vi)));
+            uint32x4_t y  = vreinterpretq_u32_s32(vabsq_s32(vmovl_s16(vq)));
+            uint32x4_t mx = vmaxq_u32(x, y);
+            uint32x4_t mi = vminq_u32(x, y);
+            uint32x4_t r  = vshrq_n_u32(vmlaq_n_u32(vmulq_n_u32(mx, 122), mi, 51), 8); // max 22144
+            acc  = vaddq_u32(acc, r);
+            m[h] = vmovn_u32(r);
+        }
+        vst1q_u16(&y_buf[i], vcombine_u16(m[0], m[1]));
+    }
+    uint32_t sum = sum_u32_neon(acc);
+    sum += magnitude_est_cs16_tail(iq_buf, y_buf, i, len);
+    return sum;
+}
+
+static void classify_widths_neon(int const *widths, uint8_t *symbols, uint32_t len, int const lower[BASEBAND_WINDOWS], int const upper[BASEBAND_WINDOWS])
+{
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint16x4_t s[2];
+        for (int h = 0; h < 2; ++h) {
+            int32x4_t w  = vld1q_s32(&widths[i + 4 * h]);
+            uint32x4_t c = vdupq_n_u32(BASEBAND_SYMBOL_OTHER);
+            // tested last to first so the first window wins
+            for (int k = BASEBAND_WINDOWS - 1; k >= 0; --k) {
+                uint32x4_t in = vandq_u32(vcgtq_s32(w, vdupq_n_s32(lower[k])), vcltq_s32(w, vdupq_n_s32(upper[k])));
+                c = vbslq_u32(in, vdupq_n_u32(k), c);
+            }
+            s[h] = vmovn_u32(c);
+        }
+        vst1_u8(&symbols[i], vmovn_u16(vcombine_u16(s[0], s[1])));
+    }
+    classify_widths_tail(widths, symbols, i, len, lower, upper);
+}
+
+#endif /* BASEBAND_NEON */
+
+/* kernel dispatch */
+
+static int cpu_has_none(void)
+{
+    return 1;
+}
+
+#ifdef BASEBAND_X86
+static int cpu_has_sse2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static int cpu_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/// All kernel variants in order of preference, the last supported one is used.
+static struct {
+    int (*supported)(void);
+    baseband_kernels_t kernels;
+} const baseband_variants[] = {
+        {cpu_has_none, {"scalar", envelope_detect_scalar, magnitude_est_cu8_scalar, magnitude_est_cs16_scalar, demod_fm_phase_cu8_scalar, classify_widths_scalar}},
+#ifdef BASEBAND_X86
+        {cpu_has_sse2, {"sse2", envelope_detect_sse2, magnitude_est_cu8_sse2, magnitude_est_cs16_sse2, demod_fm_phase_cu8_sse2, classify_widths_sse2}},
+        {cpu_has_avx2, {"avx2", envelope_detect_avx2, magnitude_est_cu8_avx2, magnitude_est_cs16_avx2, demod_fm_phase_cu8_avx2, classify_widths_avx2}},
+#endif
+#ifdef BASEBAND_NEON
+        {cpu_has_none, {"neon", envelope_detect_neon, magnitude_est_cu8_neon, magnitude_est_cs16_neon, demod_fm_phase_cu8_scalar, classify_widths_neon}},
+#endif
+};
+
+/// Published once by baseband_init(), any config on any thread may select again.
+static baseband_kernels_t const *baseband_selected = &baseband_variants[0].kernels;
+/// A variant chosen with baseband_select() (1) or baseband_autotune() (2) is kept, set before any threads.
+static int baseband_forced;
+
+baseband_kernels_t const *baseband_kernels_variant(unsigned idx)
+{
+    unsigned num = sizeof(baseband_variants) / sizeof(*baseband_variants);
+    for (unsigned n = 0; n < num; ++n) {
+        if (!baseband_variants[n].supported())
+            continue;
+        if (idx-- == 0)
+            return &baseband_variants[n].kernels;
+    }
+    return NULL;
+}
+
+baseband_kernels_t const *baseband_kernels(void)
+{
+    return atomic_load_acquire(&baseband_selected);
+}
+
+static void select_kernels(void)
+{
+    if (baseband_forced)
+        return;
+    baseband_kernels_t const *best = NULL;
+    baseband_kernels_t const *kernels;
+    for (unsigned idx = 0; (kernels = baseband_kernels_variant(idx)); ++idx) {
+        best = kernels;
+    }
+    atomic_store_release(&baseband_selected, best);
+}
+
+int baseband_select(char const *name)
+{
+    baseband_kernels_t const *kernels;
+    for (unsigned idx = 0; (kernels = baseband_kernels_variant(idx)); ++idx) {
+        if (!strcmp(kernels->name, name)) {
+            baseband_forced = 1;
+            atomic_store_release(&baseband_selected, kernels);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* kernel autotune */
+
+/// The kernels of baseband_kernels_t that are timed, in the order of the struct.
+enum tune_slot {
+    TUNE_ENVELOPE,
+    TUNE_MAG_CU8,
+    TUNE_MAG_CS16,
+    TUNE_FM_PHASE,
+    TUNE_CLASSIFY,
+    TUNE_SLOTS,
+};
+
+static char const *const tune_slot_names[TUNE_SLOTS] = {
+        "envelope_detect", "magnitude_est_cu8", "magnitude_est_cs16", "demod_fm_phase_cu8", "classify_widths"};
+
+/// The envelope without a LUT, a candidate for the envelope only.
+static baseband_kernels_t const baseband_nolut = {"nolut", envelope_detect_nolut_sum, NULL, NULL, NULL, NULL};
+
+/// The fastest of each kernel, published by baseband_autotune() before any threads.
+static baseband_kernels_t baseband_tuned = {"tuned", NULL, NULL, NULL, NULL, NULL};
+/// The variant name of each kernel in baseband_tuned.
+static char const *baseband_tuned_names[TUNE_SLOTS];
+
+/// Samples of the synthetic buffer, small enough to stay in L1 cache like a tile of the fused demod.
+#define TUNE_SAMPLES 4096
+/// Time of one round of calls of a candidate, the best of TUNE_ROUNDS rounds is taken.
+#define TUNE_ROUND_NS 250000
+#define TUNE_ROUNDS 4
+
+typedef struct tune_bufs {
+    uint8_t cu8[2 * TUNE_SAMPLES];
+    int16_t cs16[2 * TUNE_SAMPLES];
+    uint16_t y16[TUNE_SAMPLES];
+    int widths[TUNE_SAMPLES];
+    uint8_t symbols[TUNE_SAMPLES];
+    uint32_t sink; ///< the sums are kept so the calls are not dropped
+} tune_bufs_t;
+
+static int tune_has(baseband_kernels_t const *k, unsigned slot)
+{
+    switch (slot) {
+    case TUNE_ENVELOPE: return k->envelope_detect != NULL;
+    case TUNE_MAG_CU8: return k->magnitude_est_cu8 != NULL;
+    case TUNE_MAG_CS16: return k->magnitude_est_cs16 != NULL;
+    case TUNE_FM_PHASE: return k->demod_fm_phase_cu8 != NULL;
+    default: return k->classify_widths != NULL;
+    }
+}
+
+static void tune_set(baseband_kernels_t *dst, unsigned slot, baseband_kernels_t const *src)
+{
+    switch (slot) {
+    case TUNE_ENVELOPE: dst->envelope_detect = src->envelope_detect; break;
+    case TUNE_MAG_CU8: dst->magnitude_est_cu8 = src->magnitude_est_cu8; break;
+    case TUNE_MAG_CS16: dst->magnitude_est_cs16 = src->magnitude_est_cs16; break;
+    case TUNE_FM_PHASE: dst->demod_fm_phase_cu8 = src->demod_fm_phase_cu8; break;
+    default: dst->classify_widths = src->classify_widths; break;
+    }
+    baseband_tuned_names[slot] = src->name;
+}
+
+static void tune_call(baseband_kernels_t const *k, unsigned slot, tune_bufs_t *b)
+{
+    static int const lower[BASEBAND_WINDOWS] = {200, 300, 0};
+    static int const upper[BASEBAND_WINDOWS] = {400, 900, 0};
+    switch (slot) {
+    case TUNE_ENVELOPE: b->sink += k->envelope_detect(b->cu8, b->y16, TUNE_SAMPLES); break;
+    case TUNE_MAG_CU8: b->sink += k->magnitude_est_cu8(b->cu8, b->y16, TUNE_SAMPLES); break;
+    case TUNE_MAG_CS16: b->sink += k->magnitude_est_cs16(b->cs16, b->y16, TUNE_SAMPLES); break;
+    case TUNE_FM_PHASE: k->demod_fm_phase_cu8(b->cu8, (int16_t *)b->y16, TUNE_SAMPLES); b->sink += b->y16[1]; break;
+    default: k->classify_widths(b->widths, b->symbols, TUNE_SAMPLES, lower, upper); b->sink += b->symbols[0]; break;
+    }
+}
+
+// best time of a call in ns over the rounds
+static uint64_t tune_time(baseband_kernels_t const *k, unsigned slot, tune_bufs_t *b)
+{
+    uint64_t best = UINT64_MAX;
+    tune_call(k, slot, b); // warm up the caches
+    for (unsigned round = 0; round < TUNE_ROUNDS; ++round) {
+        uint64_t start_ns = time_monotonic_ns();
+        uint64_t elapsed  = 0;
+        unsigned calls    = 0;
+        do {
+            tune_call(k, slot, b);
+            calls += 1;
+            elapsed = time_monotonic_ns() - start_ns;
+        } while (elapsed < TUNE_ROUND_NS);
+        if (elapsed / calls < best)
+            best = elapsed / calls;
+    }
+    return best;
+}
+
+// the candidate of this name for the slot
+static baseband_kernels_t const *tune_candidate(char const *name, size_t len, unsigned slot)
+{
+    baseband_kernels_t const *kernels;
+    for (unsigned idx = 0; (kernels = baseband_kernels_variant(idx)); ++idx) {
+        if (strlen(kernels->name) == len && !strncmp(kernels->name, name, len))
+            return kernels;
+    }
+    if (slot == TUNE_ENVELOPE && strlen(baseband_nolut.name) == len && !strncmp(baseband_nolut.name, name, len))
+        return &baseband_nolut;
+    return NULL;
+}
+
+// the cache is only valid for the same variants and compiler
+static void tune_cache_key(char *key, size_t size)
+{
+    baseband_kernels_t const *kernels;
+    size_t len = 0;
+    for (unsigned idx = 0; (kernels = baseband_kernels_variant(idx)) && len < size; ++idx) {
+        len += snprintf(key + len, size - len, "%s%s", idx ? "," : "", kernels->name);
+    }
+#ifdef __VERSION__
+    if (len < size)
+        snprintf(key + len, size - len, " %s", __VERSION__);
+#endif
+}
+
+// read the choice of each kernel, returns 0 if all are valid for this build
+static int tune_read_cache(char const *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+    char line[512];
+    char key[256];
+    tune_cache_key(key, sizeof(key));
+    int ret = -1;
+    if (fgets(line, sizeof(line), fp) && !strncmp(line, key, strlen(key)) && line[strlen(key)] == '\t') {
+        ret        = 0;
+        char *name = line + strlen(key) + 1;
+        for (unsigned slot = 0; slot < TUNE_SLOTS && ret == 0; ++slot) {
+            // e.g. "envelope_detect=avx2 magnitude_est_cu8=sse2 ..."
+            size_t slot_len = strlen(tune_slot_names[slot]);
+            if (strncmp(name, tune_slot_names[slot], slot_len) || name[slot_len] != '=') {
+                ret = -1;
+                break;
+            }
+            name += slot_len + 1;
+            size_t len                           = strcspn(name, " \r\n");
+            baseband_kernels_t const *candidate = tune_candidate(name, len, slot);
+            if (!candidate || !tune_has(candidate, slot))
+                ret = -1;
+            else
+                tune_set(&baseband_tuned, slot, candidate);
+            name += len;
+            name += strspn(name, " ");
+        }
+    }
+    fclose(fp);
+    return ret;
+}
+
+static void tune_write_cache(char const *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        print_logf(LOG_WARNING, "Baseband", "Failed to write the kernel choice to \"%s\"", path);
+        return;
+    }
+    char key[256];
+    tune_cache_key(key, sizeof(key));
+    char names[256];
+    baseband_kernel_names(names, sizeof(names));
+    fprintf(fp, "%s\t%s\n", key, names);
+    fclose(fp);
+}
+
+int baseband_autotune(char const *cache_path)
+{
+    if (baseband_forced == 1)
+        return -1;
+
+    if (cache_path && tune_read_cache(cache_path) == 0) {
+        baseband_forced = 2;
+        atomic_store_release(&baseband_selected, &baseband_tuned);
+        return 1;
+    }
+
+    tune_bufs_t *b = malloc(sizeof(*b));
+    if (!b) {
+        WARN_MALLOC("baseband_autotune()");
+        return -1;
+    }
+    // a noisy carrier with a slow tone, and widths around the windows
+    uint32_t seed = 1;
+    for (unsigned i = 0; i < TUNE_SAMPLES; ++i) {
+        seed               = seed * 1103515245 + 12345;
+        int noise          = (int)(seed >> 27) - 16;
+        int carrier        = (i / 512) % 2 ? 90 : 0;
+        b->cu8[2 * i]      = (uint8_t)(128 + (i % 32 < 16 ? carrier : -carrier) + noise);
+        b->cu8[2 * i + 1]  = (uint8_t)(128 + ((i + 8) % 32 < 16 ? carrier : -carrier) - noise);
+        b->cs16[2 * i]     = (int16_t)(b->cu8[2 * i] * 128 - 16320);
+        b->cs16[2 * i + 1] = (int16_t)(b->cu8[2 * i + 1] * 128 - 16320);
+        b->widths[i]       = (int)(seed >> 22);
+    }
+
+    // the variants, and the envelope without a LUT
+    baseband_kernels_t const *candidates[8];
+    baseband_kernels_t const *kernels;
+    unsigned num = 0;
+    for (unsigned idx = 0; num < 7 && (kernels = baseband_kernels_variant(idx)); ++idx) {
+        candidates[num++] = kernels;
+    }
+    candidates[num++] = &baseband_nolut;
+
+    for (unsigned slot = 0; slot < TUNE_SLOTS; ++slot) {
+        baseband_kernels_t const *best = candidates[0];
+        uint64_t best_ns               = UINT64_MAX;
+        for (unsigned i = 0; i < num; ++i) {
+            if (!tune_has(candidates[i], slot))
+                continue;
+            uint64_t ns = tune_time(candidates[i], slot, b);
+            // on a tie the later variant, the wider instruction set
+            if (ns <= best_ns) {
+                best    = candidates[i];
+                best_ns = ns;
+            }
+        }
+        tune_set(&baseband_tuned, slot, best);
+    }
+    free(b);
+
+    baseband_forced = 2;
+    atomic_store_release(&baseband_selected, &baseband_tuned);
+    if (cache_path)
+        tune_write_cache(cache_path);
+    return 0;
+}
+
+void baseband_kernel_names(char *buf, size_t size)
+{
+    baseband_kernels_t const *selected = baseband_kernels();
+    size_t len                         = 0;
+    for (unsigned slot = 0; slot < TUNE_SLOTS && len < size; ++slot) {
+        char const *name = selected == &baseband_tuned ? baseband_tuned_names[slot] : selected->name;
+        len += snprintf(buf + len, size - len, "%s%s=%s", slot ? " " : "", tune_slot_names[slot], name);
+    }
+}
+
+float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = baseband_kernels()->envelope_detect(iq_buf, y_buf, len);
+    return AMP_AVG_TO_DB(sum, len);
+}
+
+float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = baseband_kernels()->magnitude_est_cu8(iq_buf, y_buf, len);
+    return MAG_AVG_TO_DB(sum, len);
+}
+
+float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = baseband_kernels()->magnitude_est_cs16(iq_buf, y_buf, len);
+    return MAG_AVG_TO_DB(sum, len);
+}
+
+/// Strided envelope level of 8 bit samples, a bias of 0x80 flips CS8 to CU8.
+static inline float envelope_level_strided_u8(uint8_t const *iq_buf, uint32_t len, unsigned stride, uint8_t bias)
+{
+    unsigned long i;
+    uint32_t sum = 0;
+    uint32_t n   = 0;
+    for (i = 0; i < len; i += stride) {
+        sum += scaled_squares[iq_buf[2 * i] ^ bias] + scaled_squares[iq_buf[2 * i + 1] ^ bias];
+        n++;
+    }
+    return AMP_AVG_TO_DB(sum, n);
+}
+
+/// Strided magnitude level of 8 bit samples, a bias of 0x80 flips CS8 to CU8.
+static inline float magnitude_level_strided_u8(uint8_t const *iq_buf, uint32_t len, unsigned stride, uint8_t bias)
+{
+    unsigned long i;
+    uint32_t sum = 0;
+    uint32_t n   = 0;
+    for (i = 0; i < len; i += stride) {
+        uint16_t x = abs((iq_buf[2 * i] ^ bias) - 128);
+        uint16_t y = abs((iq_buf[2 * i + 1] ^ bias) - 128);
+        uint16_t mi = x < y ? x : y;
+        uint16_t mx = x > y ? x : y;
+        sum += 122 * mx + 51 * mi;
+        n++;
+    }
+    return MAG_AVG_TO_DB(sum, n);
+}
+
+/// Strided level estimate on the same scale as envelope_detect(), no output.
+float envelope_level_strided(uint8_t const *iq_buf, uint32_t len, unsigned stride)
+{
+    return envelope_level_strided_u8(iq_buf, len, stride, 0);
+}
+
+/// Strided level estimate on the same scale as envelope_detect_cs8(), no output.
+float envelope_level_strided_cs8(int8_t const *iq_buf, uint32_t len, unsigned stride)
+{
+    return envelope_level_strided_u8((uint8_t const *)iq_buf, len, stride, 0x80);
+}
+
+/// Strided level estimate on the same scale as magnitude_est_cu8(), no output.
+float magnitude_level_strided_cu8(uint8_t const *iq_buf, uint32_t len, unsigned stride)
+{
+    return magnitude_level_strided_u8(iq_buf, len, stride, 0);
+}
+
+/// Strided level estimate on the same scale as magnitude_est_cs8(), no output.
+float magnitude_level_strided_cs8(int8_t const *iq_buf, uint32_t len, unsigned stride)
+{
+    return magnitude_level_strided_u8((uint8_t const *)iq_buf, len, stride, 0x80);
+}
+
+/// Strided level estimate on the same scale as magnitude_est_cs16(), no output.
+float magnitude_level_strided_cs16(int16_t const *iq_buf, uint32_t len, unsigned stride)
+{
+    unsigned long i;
+    uint32_t sum = 0;
+    uint32_t n   = 0;
+    for (i = 0; i < len; i += stride) {
+        uint32_t x = abs(iq_buf[2 * i]);
+        uint32_t y = abs(iq_buf[2 * i + 1]);
+        uint32_t mi = x < y ? x : y;
+        uint32_t mx = x > y ? x : y;
+        sum += (122 * mx + 51 * mi) >> 8;
+        n++;
+    }
+    return MAG_AVG_TO_DB(sum, n);
 }
 
 void baseband_low_pass_filter_reset(filter_state_t *lowpass_filter)
 {
+    memset(lowpass_filter->y, 0, sizeof(lowpass_filter->y));
+    memset(lowpass_filter->x, 0, sizeof(lowpass_filter->x));
+    memset(lowpass_filter->z, 0, sizeof(lowpass_filter->z));
+}
+
+/// Cutoff of the AM low pass filters relative to the Nyquist rate.
+#define LOW_PASS_CUTOFF 0.05
+/// Fraction bits of the biquad coefficients in the fixed point build, the coefficients are below 2.
+#define BIQUAD_COEFF_FRAC 28
+#define BIQUAD_COEFF_ONE  (1 << BIQUAD_COEFF_FRAC)
+/// Fraction bits of the samples between the biquads in the fixed point build.
+#define BIQUAD_SAMPLE_FRAC 12
+
+int baseband_low_pass_filter_init(filter_state_t *lowpass_filter, unsigned order)
+{
+    if (order > FILTER_MAX_ORDER || (order > 1 && order % 2)) {
+        return -1;
+    }
     *lowpass_filter = (filter_state_t){0};
+    lowpass_filter->order = order;
+
+    // Butterworth biquads by bilinear transform, the pole pairs have Q = 1 / (2 sin((2k+1) pi / 2n))
+    double k = tan(M_PI_2 * LOW_PASS_CUTOFF);
+    for (unsigned i = 0; order > 1 && i < order / 2; ++i) {
+        double q    = 1.0 / (2.0 * sin((2 * i + 1) * M_PI / (2 * order)));
+        double norm = 1.0 / (1.0 + k / q + k * k);
+#ifdef FIXED_POINT
+        int32_t *c = lowpass_filter->coeffs[i];
+        c[0] = (int32_t)lrint(k * k * norm * BIQUAD_COEFF_ONE);
+        c[1] = 2 * c[0];
+        c[2] = c[0];
+        c[3] = (int32_t)lrint(2.0 * (k * k - 1.0) * norm * BIQUAD_COEFF_ONE);
+        c[4] = (int32_t)lrint((1.0 - k / q + k * k) * norm * BIQUAD_COEFF_ONE);
+#else
+        float *c = lowpass_filter->coeffs[i];
+        c[0] = (float)(k * k * norm);
+        c[1] = 2.0f * c[0];
+        c[2] = c[0];
+        c[3] = (float)(2.0 * (k * k - 1.0) * norm);
+        c[4] = (float)((1.0 - k / q + k * k) * norm);
+#endif
+    }
+    return 0;
 }
 
+#ifdef FIXED_POINT
+/// Higher order low pass filter as a cascade of biquads, in integer arithmetic only.
+/// The coefficients are Q2.28, the samples between the stages and the state keep 12 fraction bits.
+static void low_pass_filter_biquads(filter_state_t *state, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    unsigned const stages = state->order / 2;
+    int32_t c[FILTER_MAX_ORDER / 2][5];
+    int32_t z[FILTER_MAX_ORDER / 2][2];
+    memcpy(c, state->coeffs, sizeof(c));
+    memcpy(z, state->z, sizeof(z));
+
+    for (uint32_t i = 0; i < len; ++i) {
+        int32_t x = (int32_t)x_buf[i] << BIQUAD_SAMPLE_FRAC;
+        for (unsigned st = 0; st < stages; ++st) {
+            int32_t y = (int32_t)(((int64_t)c[st][0] * x) >> BIQUAD_COEFF_FRAC) + z[st][0];
+            z[st][0]  = (int32_t)(((int64_t)c[st][1] * x - (int64_t)c[st][3] * y) >> BIQUAD_COEFF_FRAC) + z[st][1];
+            z[st][1]  = (int32_t)(((int64_t)c[st][2] * x - (int64_t)c[st][4] * y) >> BIQUAD_COEFF_FRAC);
+            x         = y;
+        }
+        x = (x + (1 << (BIQUAD_SAMPLE_FRAC - 1))) >> BIQUAD_SAMPLE_FRAC;
+        y_buf[i] = x > INT16_MAX ? INT16_MAX : x < -INT16_MAX ? -INT16_MAX : (int16_t)x;
+    }
+
+    memcpy(state->z, z, sizeof(z));
+}
+#else
+
+/// Higher order low pass filter as a cascade of biquads.
+/// All stages run per sample, the recurrences of the stages are independent and overlap in the pipeline.
+static void low_pass_filter_biquads(filter_state_t *state, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    unsigned const stages = state->order / 2;
+    float c[FILTER_MAX_ORDER / 2][5];
+    float z[FILTER_MAX_ORDER / 2][2];
+    memcpy(c, state->coeffs, sizeof(c));
+    memcpy(z, state->z, sizeof(z));
+
+    for (uint32_t i = 0; i < len; ++i) {
+        float x = x_buf[i];
+        for (unsigned st = 0; st < stages; ++st) {
+            float y  = c[st][0] * x + z[st][0];
+            z[st][0] = c[st][1] * x - c[st][3] * y + z[st][1];
+            z[st][1] = c[st][2] * x - c[st][4] * y;
+            x        = y;
+        }
+        y_buf[i] = x > INT16_MAX ? INT16_MAX : x < -INT16_MAX ? -INT16_MAX : (int16_t)x;
+    }
+
+    memcpy(state->z, z, sizeof(z));
+}
+#endif
+
 // Fixed-point arithmetic on Q0.15
 #define F_SCALE 15
 #define S_CONST (1 << F_SCALE)
@@ -152,6 +1275,11 @@ void baseband_low_pass_filter(filter_state_t *state, uint16_t const *x_buf, int1
     static int const b[FILTER_ORDER + 1] = {FIX(0.07296) >> 1, FIX(0.07296) >> 1};
     // note that coeffs are prescaled by div 2
 
+    if (state->order > 1) {
+        low_pass_filter_biquads(state, x_buf, y_buf, len);
+        return;
+    }
+
     // Prevent out of bounds access
     if (len < FILTER_ORDER) {
         return;
@@ -164,49 +1292,19 @@ void baseband_low_pass_filter(filter_state_t *state, uint16_t const *x_buf, int1
     }
 
     // Save last samples
-    memcpy(state->x, &x_buf[len - FILTER_ORDER], FILTER_ORDER * sizeof (int16_t));
+    memcpy(state->x, &x_buf[len - FILTER_ORDER], FILTER_ORDER * sizeof (uint16_t));
     memcpy(state->y, &y_buf[len - FILTER_ORDER], FILTER_ORDER * sizeof (int16_t));
 }
 
-
-/** Integer implementation of atan2() with int16_t normalized output.
-
-    Returns arc tangent of y/x across all quadrants in radians.
-    Error max 0.07 radians.
-    Reference: http://dspguru.com/dsp/tricks/fixed-point-atan2-with-self-normalization
-    @param y Numerator (imaginary value of complex vector)
-    @param x Denominator (real value of complex vector)
-    @return angle in radians (Pi equals INT16_MAX)
-*/
-static int16_t atan2_int16(int32_t y, int32_t x)
-{
-    static int32_t const I_PI_4 = INT16_MAX/4;      // M_PI/4
-    static int32_t const I_3_PI_4 = 3*INT16_MAX/4;  // 3*M_PI/4
-
-    int32_t const abs_y = abs(y);
-    int32_t angle;
-
-    if (!x && !y) return 0; // We would get 8191 with the code below
-
-    if (x >= 0) {    // Quadrant I and IV
-        int32_t denom = (abs_y + x);
-        if (denom == 0) denom = 1;  // Prevent divide by zero
-        angle = I_PI_4 - I_PI_4 * (x - abs_y) / denom;
-    } else {        // Quadrant II and III
-        int32_t denom = (abs_y - x);
-        if (denom == 0) denom = 1;  // Prevent divide by zero
-        angle = I_3_PI_4 - I_PI_4 * (x + abs_y) / denom;
-    }
-    if (y < 0) angle = -angle;    // Negate if in III or IV
-    return angle;
-}
-
 void baseband_demod_FM_reset(demodfm_state_t *demod_fm)
 {
     *demod_fm = (demodfm_state_t){0};
 }
 
 /// Fast Instantaneous frequency and Low Pass filter, CU8 samples
+/// Samples per block for the instantaneous frequency.
+#define FM_PHASE_TILE_LEN 1024
+
 void baseband_demod_FM(demodfm_state_t *state, uint8_t const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass)
 {
     // Select filter coeffs, [b,a] = butter(1, cutoff)
@@ -234,39 +1332,38 @@ void baseband_demod_FM(demodfm_state_t *state, uint8_t const *x_buf, int16_t *y_
     int32_t const *blp = state->blp_16;
 
     // Pre-feed old sample
-    int16_t x0r = state->xr; // IQ sample: x[n], real
-    int16_t x0i = state->xi; // IQ sample: x[n], imag
     int16_t x0f = state->xf; // Instantaneous frequency
     int16_t y0f = state->yf; // Instantaneous frequency, low pass filtered
 
-    for (unsigned n = 0; n < num_samples; n++) {
-        int16_t x1r, x1i; // Old IQ sample: x[n-1]
-        int16_t x1f, y1f; // Instantaneous frequency, old sample
-        int32_t pr, pi;   // Phase difference vector
+    // The phase of x[n] * conj(x[n-1]) is computed in blocks with the SIMD kernels, only the filter is sequential
+    int16_t f_buf[FM_PHASE_TILE_LEN];
+    for (unsigned long pos = 0; pos < num_samples; pos += FM_PHASE_TILE_LEN) {
+        unsigned long n_tile = num_samples - pos < FM_PHASE_TILE_LEN ? num_samples - pos : FM_PHASE_TILE_LEN;
+        uint8_t const *tile = &x_buf[2 * pos];
+        baseband_kernels()->demod_fm_phase_cu8(tile, f_buf, n_tile);
+        // the first sample pairs with the last sample of the previous tile or run
+        int32_t x0r = tile[0] - 128;
+        int32_t x0i = tile[1] - 128;
+        int32_t x1r = pos ? tile[-2] - 128 : state->xr;
+        int32_t x1i = pos ? tile[-1] - 128 : state->xi;
+        f_buf[0] = atan2_int16(x0i * x1r - x0r * x1i, x0r * x1r + x0i * x1i);
 
-        // delay old sample
-        x1r = x0r;
-        x1i = x0i;
-        y1f = y0f;
-        x1f = x0f;
-        // get new sample
-        x0r = *x_buf++ - 128;
-        x0i = *x_buf++ - 128;
-        // Calculate phase difference vector: x[n] * conj(x[n-1])
-        pr = x0r * x1r + x0i * x1i; // May exactly overflow an int16_t (-128*-128 + -128*-128)
-        pi = x0i * x1r - x0r * x1i;
-        // xlp = (int16_t)((atan2f(pi, pr) / M_PI) * INT16_MAX); // Floating point implementation
-        x0f = atan2_int16(pi, pr); // Integer implementation
-        // xlp = pi; // Cheat and use only imaginary part (works OK, but is amplitude sensitive)
-        // Low pass filter
-        // y0f      = ((alp[1] * y1f >> 1) + (blp[0] * x0f >> 1) + (blp[1] * x1f >> 1)) >> (F_SCALE - 1);
-        y0f      = (alp[1] * y1f + blp[0] * (x0f + x1f)) >> (F_SCALE - 1); // note: prescaled, blp[0]==blp[1]
-        *y_buf++ = y0f;
+        for (unsigned long n = 0; n < n_tile; n++) {
+            int16_t x1f = x0f; // Instantaneous frequency, old sample
+            int16_t y1f = y0f;
+            x0f = f_buf[n];
+            // Low pass filter
+            // y0f      = ((alp[1] * y1f >> 1) + (blp[0] * x0f >> 1) + (blp[1] * x1f >> 1)) >> (F_SCALE - 1);
+            y0f      = (alp[1] * y1f + blp[0] * (x0f + x1f)) >> (F_SCALE - 1); // note: prescaled, blp[0]==blp[1]
+            *y_buf++ = y0f;
+        }
     }
 
     // Store newest sample for next run
-    state->xr = x0r;
-    state->xi = x0i;
+    if (num_samples) {
+        state->xr = x_buf[2 * num_samples - 2] - 128;
+        state->xi = x_buf[2 * num_samples - 1] - 128;
+    }
     state->xf = x0f;
     state->yf = y0f;
 }
@@ -365,7 +1462,376 @@ void baseband_demod_FM_cs16(demodfm_state_t *state, int16_t const *x_buf, int16_
     state->yf = y0f;
 }
 
+/// Samples per tile, the IQ, envelope, AM, and FM tiles together should fit the L1 data cache.
+#define FUSED_TILE_LEN 2048
+
+static inline uint8_t cs8_to_cu8(int8_t x)
+{
+    return (uint8_t)(x + 128);
+}
+
+static inline int16_t cf32_to_cs16(float x)
+{
+    // clamp float to [-1,1] and scale to Q0.15
+    int s = (int)(x * INT16_MAX);
+    return s < -INT16_MAX ? -INT16_MAX : s > INT16_MAX ? INT16_MAX : (int16_t)s;
+}
+
+/// Define a loader converting a tile of @p type samples to @p base_type samples in the L1 data cache.
+#define DEFINE_TILE_LOADER(name, type, base_type, convert) \
+    static void load_tile_##name(type const *iq_buf, base_type *tile, uint32_t len) \
+    { \
+        for (uint32_t i = 0; i < 2 * len; ++i) \
+            tile[i] = convert(iq_buf[i]); \
+    }
+
+/// Define a native level kernel for @p type running the selected @p kernel on @p base_type tiles, returns the sum.
+#define DEFINE_NATIVE_LEVEL(func, name, type, base_type, kernel) \
+    static uint32_t func##_sum(type const *iq_buf, uint16_t *y_buf, uint32_t len) \
+    { \
+        base_type tile[2 * FUSED_TILE_LEN]; \
+        uint32_t sum = 0; \
+        for (uint32_t pos = 0; pos < len; pos += FUSED_TILE_LEN) { \
+            uint32_t n = len - pos < FUSED_TILE_LEN ? len - pos : FUSED_TILE_LEN; \
+            load_tile_##name(&iq_buf[2 * pos], tile, n); \
+            sum += baseband_kernels()->kernel(tile, &y_buf[pos], n); \
+        } \
+        return sum; \
+    }
+
+/// Define a native FM demod for @p type running @p demod on @p base_type tiles.
+#define DEFINE_NATIVE_FM(name, type, base_type, demod) \
+    void baseband_demod_FM_##name(demodfm_state_t *state, type const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass) \
+    { \
+        base_type tile[2 * FUSED_TILE_LEN]; \
+        for (unsigned long pos = 0; pos < num_samples; pos += FUSED_TILE_LEN) { \
+            uint32_t n = num_samples - pos < FUSED_TILE_LEN ? num_samples - pos : FUSED_TILE_LEN; \
+            load_tile_##name(&x_buf[2 * pos], tile, n); \
+            demod(state, tile, &y_buf[pos], n, samp_rate, low_pass); \
+        } \
+    }
+
+DEFINE_TILE_LOADER(cs8, int8_t, uint8_t, cs8_to_cu8)
+DEFINE_TILE_LOADER(cf32, float, int16_t, cf32_to_cs16)
+
+DEFINE_NATIVE_LEVEL(envelope_detect_cs8, cs8, int8_t, uint8_t, envelope_detect)
+DEFINE_NATIVE_LEVEL(magnitude_est_cs8, cs8, int8_t, uint8_t, magnitude_est_cu8)
+DEFINE_NATIVE_LEVEL(magnitude_est_cf32, cf32, float, int16_t, magnitude_est_cs16)
+
+DEFINE_NATIVE_FM(cs8, int8_t, uint8_t, baseband_demod_FM)
+DEFINE_NATIVE_FM(cf32, float, int16_t, baseband_demod_FM_cs16)
+
+float envelope_detect_cs8(int8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = envelope_detect_cs8_sum(iq_buf, y_buf, len);
+    return AMP_AVG_TO_DB(sum, len);
+}
+
+float magnitude_est_cs8(int8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = magnitude_est_cs8_sum(iq_buf, y_buf, len);
+    return MAG_AVG_TO_DB(sum, len);
+}
+
+float magnitude_est_cf32(float const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = magnitude_est_cf32_sum(iq_buf, y_buf, len);
+    return MAG_AVG_TO_DB(sum, len);
+}
+
+float baseband_demod_fused(filter_state_t *lp_state, demodfm_state_t *fm_state, void const *iq_buf, baseband_format_t format, int use_mag_est,
+        int16_t *am_buf, int16_t *fm_buf, uint32_t len, uint32_t samp_rate, float low_pass)
+{
+    uint16_t env_buf[FUSED_TILE_LEN];
+    uint8_t cu8_tile[2 * FUSED_TILE_LEN];
+    int16_t cs16_tile[2 * FUSED_TILE_LEN];
+    uint32_t sum = 0;
+
+    for (uint32_t pos = 0; pos < len; pos += FUSED_TILE_LEN) {
+        uint32_t n = len - pos < FUSED_TILE_LEN ? len - pos : FUSED_TILE_LEN;
+        uint8_t const *cu8_buf  = NULL;
+        int16_t const *cs16_buf = NULL;
+        if (format == BASEBAND_CU8) {
+            cu8_buf = (uint8_t const *)iq_buf + 2 * pos;
+        }
+        else if (format == BASEBAND_CS8) {
+            load_tile_cs8((int8_t const *)iq_buf + 2 * pos, cu8_tile, n);
+            cu8_buf = cu8_tile;
+        }
+        else if (format == BASEBAND_CF32) {
+            load_tile_cf32((float const *)iq_buf + 2 * pos, cs16_tile, n);
+            cs16_buf = cs16_tile;
+        }
+        else {
+            cs16_buf = (int16_t const *)iq_buf + 2 * pos;
+        }
+
+        if (cu8_buf) {
+            if (use_mag_est)
+                sum += baseband_kernels()->magnitude_est_cu8(cu8_buf, env_buf, n);
+            else
+                sum += baseband_kernels()->envelope_detect(cu8_buf, env_buf, n);
+            baseband_low_pass_filter(lp_state, env_buf, &am_buf[pos], n);
+            if (fm_buf)
+                baseband_demod_FM(fm_state, cu8_buf, &fm_buf[pos], n, samp_rate, low_pass);
+        }
+        else {
+            sum += baseband_kernels()->magnitude_est_cs16(cs16_buf, env_buf, n);
+            baseband_low_pass_filter(lp_state, env_buf, &am_buf[pos], n);
+            if (fm_buf)
+                baseband_demod_FM_cs16(fm_state, cs16_buf, &fm_buf[pos], n, samp_rate, low_pass);
+        }
+    }
+
+    if ((format == BASEBAND_CU8 || format == BASEBAND_CS8) && !use_mag_est)
+        return AMP_AVG_TO_DB(sum, len);
+    else
+        return MAG_AVG_TO_DB(sum, len);
+}
+
+/// Samples per tile of the carrier check, a tile of guard covers the FM filter settling and the short gaps of a pulse.
+#define FM_CARRIER_TILE_LEN 256
+
+static int has_carrier(int16_t const *am_buf, uint32_t len, int carrier_level)
+{
+    if (carrier_level <= 0)
+        return 1;
+    for (uint32_t i = 0; i < len; ++i) {
+        if (am_buf[i] >= carrier_level)
+            return 1;
+    }
+    return 0;
+}
+
+static void demod_FM_format(demodfm_state_t *state, void const *iq_buf, baseband_format_t format, int16_t *y_buf, uint32_t len, uint32_t samp_rate, float low_pass)
+{
+    if (format == BASEBAND_CU8)
+        baseband_demod_FM(state, iq_buf, y_buf, len, samp_rate, low_pass);
+    else if (format == BASEBAND_CS8)
+        baseband_demod_FM_cs8(state, iq_buf, y_buf, len, samp_rate, low_pass);
+    else if (format == BASEBAND_CF32)
+        baseband_demod_FM_cf32(state, iq_buf, y_buf, len, samp_rate, low_pass);
+    else
+        baseband_demod_FM_cs16(state, iq_buf, y_buf, len, samp_rate, low_pass);
+}
+
+uint32_t baseband_demod_FM_carrier(demodfm_state_t *state, void const *iq_buf, baseband_format_t format, int16_t const *am_buf, int carrier_level,
+        int16_t *y_buf, uint32_t len, uint32_t samp_rate, float low_pass)
+{
+    size_t sample_size = format == BASEBAND_CF32 ? 8 : format == BASEBAND_CS16 ? 4 : 2;
+    uint8_t const *iq  = iq_buf;
+    uint32_t tiles     = (len + FM_CARRIER_TILE_LEN - 1) / FM_CARRIER_TILE_LEN;
+    uint32_t done      = 0;
+
+    // a pulse of the previous buffer may end in the first tile
+    int prev = !state->skipped;
+    int cur  = tiles && has_carrier(am_buf, len < FM_CARRIER_TILE_LEN ? len : FM_CARRIER_TILE_LEN, carrier_level);
+    for (uint32_t t = 0; t < tiles; ++t) {
+        uint32_t pos      = t * FM_CARRIER_TILE_LEN;
+        uint32_t n        = len - pos < FM_CARRIER_TILE_LEN ? len - pos : FM_CARRIER_TILE_LEN;
+        uint32_t next_pos = pos + n;
+        uint32_t next_n   = len - next_pos < FM_CARRIER_TILE_LEN ? len - next_pos : FM_CARRIER_TILE_LEN;
+        int next          = next_pos < len && has_carrier(&am_buf[next_pos], next_n, carrier_level);
+        if (prev || cur || next) {
+            // restart from silence, the filter coeffs are kept
+            if (state->skipped) {
+                state->xr      = 0;
+                state->xi      = 0;
+                state->xf      = 0;
+                state->yf      = 0;
+                state->skipped = 0;
+            }
+            demod_FM_format(state, &iq[pos * sample_size], format, &y_buf[pos], n, samp_rate, low_pass);
+            done += n;
+        }
+        else {
+            memset(&y_buf[pos], 0, n * sizeof(*y_buf));
+            state->skipped = 1;
+        }
+        prev = cur;
+        cur  = next;
+    }
+    return done;
+}
+
+void baseband_demod_tones_reset(demodtones_state_t *state)
+{
+    *state = (demodtones_state_t){0};
+}
+
+// the tones over a half window, the half window is about a quarter of a period of the deviation
+static void demod_tones_setup(demodtones_state_t *state, uint32_t samp_rate, uint32_t deviation)
+{
+    unsigned decim = samp_rate / 8 / deviation;
+    decim          = decim < 1 ? 1 : decim;
+    unsigned half  = (unsigned)(((uint64_t)samp_rate + 2 * deviation * decim) / (4 * (uint64_t)deviation * decim));
+    half           = half < 2 ? 2 : half > TONES_MAX_HALF ? TONES_MAX_HALF : half;
+    double w       = 2.0 * M_PI * deviation / samp_rate;
+    for (unsigned k = 0; k < half; ++k) {
+        // the tone at the middle of a decimated sample
+        double phase      = w * (k * decim + (decim - 1) * 0.5);
+        state->cos_q12[k] = (int16_t)lround(4096.0 * cos(phase));
+        state->sin_q12[k] = (int16_t)lround(4096.0 * sin(phase));
+    }
+    double scale = (double)deviation * 65534.0 / samp_rate;
+    print_logf(LOG_NOTICE, "Baseband", "two-tone FSK detector for %u Hz at +/-%u Hz, window of %u samples",
+            samp_rate, deviation, 2 * half * decim);
+    state->rot_r     = (float)cos(w * half * decim);
+    state->rot_i     = (float)sin(w * half * decim);
+    state->scale     = (float)(scale < INT16_MAX ? scale : INT16_MAX);
+    state->decim     = decim;
+    state->half      = half;
+    state->rate      = samp_rate;
+    state->deviation = deviation;
+    state->skipped   = 1;
+}
+
+// the output of a completed half window, the window is it and the previous half window
+static inline int16_t demod_tones_half(demodtones_state_t *state, int64_t ac, int64_t bs, int64_t bc, int64_t as)
+{
+    // the samples times the conjugate mark tone and times the space tone
+    float mr = (float)(ac + bs);
+    float mi = (float)(bc - as);
+    float sr = (float)(ac - bs);
+    float si = (float)(bc + as);
+    // the half window restarts the tones, turn it to the phase of the previous half window
+    float wmr = state->prev_mark[0] + mr * state->rot_r + mi * state->rot_i;
+    float wmi = state->prev_mark[1] + mi * state->rot_r - mr * state->rot_i;
+    float wsr = state->prev_space[0] + sr * state->rot_r - si * state->rot_i;
+    float wsi = state->prev_space[1] + si * state->rot_r + sr * state->rot_i;
+    float pm  = wmr * wmr + wmi * wmi;
+    float ps  = wsr * wsr + wsi * wsi;
+
+    state->prev_mark[0]  = mr;
+    state->prev_mark[1]  = mi;
+    state->prev_space[0] = sr;
+    state->prev_space[1] = si;
+    return pm + ps > 0.0f ? (int16_t)(state->scale * (pm - ps) / (pm + ps)) : 0;
+}
+
+/// Define a two-tone FSK detector for @p type samples, @p convert gives signed samples of at most 16 bit.
+/// The samples of a half window get its output once it is complete, until then the last output.
+#define DEFINE_TONES(name, type, convert) \
+    static void demod_tones_##name(demodtones_state_t *state, type const *x_buf, int16_t *y_buf, uint32_t len) \
+    { \
+        int16_t const *cos_q12 = state->cos_q12; \
+        int16_t const *sin_q12 = state->sin_q12; \
+        unsigned decim         = state->decim; \
+        unsigned half          = state->half; \
+        unsigned decim_count   = state->decim_count; \
+        int32_t a              = state->decim_sums[0]; \
+        int32_t b              = state->decim_sums[1]; \
+        unsigned count         = state->count; \
+        int64_t ac             = state->sums[0]; \
+        int64_t bs             = state->sums[1]; \
+        int64_t bc             = state->sums[2]; \
+        int64_t as             = state->sums[3]; \
+        int16_t y              = state->y; \
+        uint32_t start         = 0; \
+        for (uint32_t i = 0; i < len; ++i) { \
+            a += convert(x_buf[2 * i]); \
+            b += convert(x_buf[2 * i + 1]); \
+            if (++decim_count < decim) \
+                continue; \
+            int32_t c = cos_q12[count]; \
+            int32_t s = sin_q12[count]; \
+            ac += (int64_t)a * c; \
+            bs += (int64_t)b * s; \
+            bc += (int64_t)b * c; \
+            as += (int64_t)a * s; \
+            decim_count = 0; \
+            a           = 0; \
+            b           = 0; \
+            if (++count == half) { \
+                y = demod_tones_half(state, ac, bs, bc, as); \
+                for (; start <= i; ++start) \
+                    y_buf[start] = y; \
+                count = 0; \
+                ac    = 0; \
+                bs    = 0; \
+                bc    = 0; \
+                as    = 0; \
+            } \
+        } \
+        for (; start < len; ++start) \
+            y_buf[start] = y; \
+        state->decim_count   = decim_count; \
+        state->decim_sums[0] = a; \
+        state->decim_sums[1] = b; \
+        state->count         = count; \
+        state->sums[0]       = ac; \
+        state->sums[1]       = bs; \
+        state->sums[2]       = bc; \
+        state->sums[3]       = as; \
+        state->y             = y; \
+    }
+
+#define TONES_CU8(x) ((int32_t)(x) - 128)
+#define TONES_CS8(x) ((int32_t)(x))
+#define TONES_CS16(x) ((int32_t)(x))
+#define TONES_CF32(x) ((int32_t)cf32_to_cs16(x))
+
+DEFINE_TONES(cu8, uint8_t, TONES_CU8)
+DEFINE_TONES(cs8, int8_t, TONES_CS8)
+DEFINE_TONES(cs16, int16_t, TONES_CS16)
+DEFINE_TONES(cf32, float, TONES_CF32)
+
+uint32_t baseband_demod_tones(demodtones_state_t *state, void const *iq_buf, baseband_format_t format, int16_t const *am_buf, int carrier_level,
+        int16_t *y_buf, uint32_t len, uint32_t samp_rate, uint32_t deviation)
+{
+    if (!deviation || !samp_rate) {
+        memset(y_buf, 0, len * sizeof(*y_buf));
+        return 0;
+    }
+    if (state->rate != samp_rate || state->deviation != deviation) {
+        demod_tones_setup(state, samp_rate, deviation);
+    }
+
+    uint32_t tiles = (len + FM_CARRIER_TILE_LEN - 1) / FM_CARRIER_TILE_LEN;
+    uint32_t done  = 0;
+
+    // a pulse of the previous buffer may end in the first tile
+    int prev = !state->skipped;
+    int cur  = tiles && has_carrier(am_buf, len < FM_CARRIER_TILE_LEN ? len : FM_CARRIER_TILE_LEN, carrier_level);
+    for (uint32_t t = 0; t < tiles; ++t) {
+        uint32_t pos      = t * FM_CARRIER_TILE_LEN;
+        uint32_t n        = len - pos < FM_CARRIER_TILE_LEN ? len - pos : FM_CARRIER_TILE_LEN;
+        uint32_t next_pos = pos + n;
+        uint32_t next_n   = len - next_pos < FM_CARRIER_TILE_LEN ? len - next_pos : FM_CARRIER_TILE_LEN;
+        int next          = next_pos < len && has_carrier(&am_buf[next_pos], next_n, carrier_level);
+        if (prev || cur || next) {
+            // restart from silence, the tones are kept
+            if (state->skipped) {
+                memset(state->sums, 0, sizeof(state->sums));
+                memset(state->decim_sums, 0, sizeof(state->decim_sums));
+                memset(state->prev_mark, 0, sizeof(state->prev_mark));
+                memset(state->prev_space, 0, sizeof(state->prev_space));
+                state->decim_count = 0;
+                state->count       = 0;
+                state->y           = 0;
+                state->skipped     = 0;
+            }
+            if (format == BASEBAND_CU8)
+                demod_tones_cu8(state, (uint8_t const *)iq_buf + 2 * pos, &y_buf[pos], n);
+            else if (format == BASEBAND_CS8)
+                demod_tones_cs8(state, (int8_t const *)iq_buf + 2 * pos, &y_buf[pos], n);
+            else if (format == BASEBAND_CF32)
+                demod_tones_cf32(state, (float const *)iq_buf + 2 * pos, &y_buf[pos], n);
+            else
+                demod_tones_cs16(state, (int16_t const *)iq_buf + 2 * pos, &y_buf[pos], n);
+            done += n;
+        }
+        else {
+            memset(&y_buf[pos], 0, n * sizeof(*y_buf));
+            state->skipped = 1;
+        }
+        prev = cur;
+        cur  = next;
+    }
+    return done;
+}
+
 void baseband_init(void)
 {
-    calc_squares();
+    select_kernels();
 }
@@ -0,0 +1,992 @@
+/** @file
+    Distributed batch decoding, a coordinator hands input files to worker instances and merges their events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "batch_net.h"
+
+#include "mongoose.h"
+#include "data.h"
+#include "list.h"
+#include "jsmn.h"
+#include "logger.h"
+#include "c_util.h"
+#include "fatal.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Greeting of a worker, the version changes with the exchange.
+#define BATCH_HELLO "HELLO rtl_433-batch 1"
+/// A line longer than this is an error, an event is a few hundred bytes.
+#define BATCH_LINE_MAX (1024 * 1024)
+/// Most files a worker may ask for at once.
+#define BATCH_WANT_MAX 64
+/// Seconds between the attempts to connect to the coordinator.
+#define BATCH_RETRY_S 1.0
+
+// split the complete lines off a receive buffer, returns -1 if a line is too long
+static int read_lines(struct mbuf *io, void (*line_fn)(void *ctx, char *line), void *ctx)
+{
+    char *eol;
+    while ((eol = memchr(io->buf, '\n', io->len))) {
+        size_t len = eol - io->buf + 1;
+        // strip [\r]\n
+        io->buf[len - 1] = '\0';
+        if (len >= 2 && io->buf[len - 2] == '\r') {
+            io->buf[len - 2] = '\0';
+        }
+        line_fn(ctx, io->buf);
+        mbuf_remove(io, len);
+    }
+    return io->len > BATCH_LINE_MAX ? -1 : 0;
+}
+
+/* JSON events */
+
+// the decoded text of a string token, NULL on alloc failure or an invalid escape
+static char *json_string(char const *json, jsmntok_t const *tok)
+{
+    char const *p   = json + tok->start;
+    char const *end = json + tok->end;
+    // an escape never decodes to more bytes than its text
+    char *str = malloc(end - p + 1);
+    if (!str) {
+        WARN_MALLOC("json_string()");
+        return NULL;
+    }
+    char *d = str;
+    while (p < end) {
+        if (*p != '\\') {
+            *d++ = *p++;
+            continue;
+        }
+        if (end - p < 2) {
+            free(str);
+            return NULL;
+        }
+        char c = p[1];
+        p += 2;
+        if (c == 'b')
+            *d++ = '\b';
+        else if (c == 'f')
+            *d++ = '\f';
+        else if (c == 'n')
+            *d++ = '\n';
+        else if (c == 'r')
+            *d++ = '\r';
+        else if (c == 't')
+            *d++ = '\t';
+        else if (c == '"' || c == '\\' || c == '/')
+            *d++ = c;
+        else if (c == 'u' && end - p >= 4) {
+            char hex[5] = {p[0], p[1], p[2], p[3], '\0'};
+            unsigned long u = strtoul(hex, NULL, 16);
+            p += 4;
+            // a surrogate pair encodes a code point above the basic plane
+            if (u >= 0xd800 && u < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                char low[5] = {p[2], p[3], p[4], p[5], '\0'};
+                unsigned long l = strtoul(low, NULL, 16);
+                if (l >= 0xdc00 && l < 0xe000) {
+                    u = 0x10000 + ((u - 0xd800) << 10) + (l - 0xdc00);
+                    p += 6;
+                }
+            }
+            if (u == 0) {
+                continue; // the strings are NUL terminated
+            }
+            else if (u < 0x80) {
+                *d++ = (char)u;
+            }
+            else if (u < 0x800) {
+                *d++ = (char)(0xc0 | (u >> 6));
+                *d++ = (char)(0x80 | (u & 0x3f));
+            }
+            else if (u < 0x10000) {
+                *d++ = (char)(0xe0 | (u >> 12));
+                *d++ = (char)(0x80 | ((u >> 6) & 0x3f));
+                *d++ = (char)(0x80 | (u & 0x3f));
+            }
+            else {
+                *d++ = (char)(0xf0 | (u >> 18));
+                *d++ = (char)(0x80 | ((u >> 12) & 0x3f));
+                *d++ = (char)(0x80 | ((u >> 6) & 0x3f));
+                *d++ = (char)(0x80 | (u & 0x3f));
+            }
+        }
+        else {
+            free(str);
+            return NULL;
+        }
+    }
+    *d = '\0';
+    return str;
+}
+
+// parse a number token, returns 1 for a double, 0 for an int, -1 if it is no number
+static int json_number(char const *json, jsmntok_t const *tok, int *ival, double *dval)
+{
+    char buf[64];
+    int len = tok->end - tok->start;
+    if (len <= 0 || len >= (int)sizeof(buf))
+        return -1;
+    memcpy(buf, json + tok->start, len);
+    buf[len] = '\0';
+
+    char *end;
+    if (strpbrk(buf, ".eE")) {
+        *dval = strtod(buf, &end);
+        return *end ? -1 : 1;
+    }
+    errno = 0;
+    long v = strtol(buf, &end, 10);
+    if (*end)
+        return -1;
+    if (errno == ERANGE || v < INT_MIN || v > INT_MAX) {
+        *dval = strtod(buf, NULL);
+        return 1;
+    }
+    *ival = (int)v;
+    return 0;
+}
+
+static int parse_object(char const *json, jsmntok_t const *tok, int toks, int i, data_t **out);
+static int parse_array(char const *json, jsmntok_t const *tok, int toks, int i, data_array_t **out);
+
+// append the value at i to the items, returns the index after the value, -1 on error
+static int parse_item(char const *json, jsmntok_t const *tok, int toks, int i, data_t **data, char const *key)
+{
+    if (i >= toks)
+        return -1;
+    jsmntok_t const *t = &tok[i];
+
+    if (t->type == JSMN_STRING) {
+        char *str = json_string(json, t);
+        if (!str)
+            return -1;
+        *data = data_str(*data, key, NULL, NULL, str);
+        free(str);
+        return *data ? i + 1 : -1;
+    }
+    if (t->type == JSMN_OBJECT) {
+        data_t *sub = NULL;
+        int next    = parse_object(json, tok, toks, i, &sub);
+        if (next < 0)
+            return -1;
+        if (sub)
+            *data = data_dat(*data, key, NULL, NULL, sub);
+        return !sub || *data ? next : -1;
+    }
+    if (t->type == JSMN_ARRAY) {
+        data_array_t *array = NULL;
+        int next            = parse_array(json, tok, toks, i, &array);
+        if (next < 0)
+            return -1;
+        *data = data_ary(*data, key, NULL, NULL, array);
+        return *data ? next : -1;
+    }
+    if (t->type != JSMN_PRIMITIVE)
+        return -1;
+
+    char c = json[t->start];
+    if (c == 'n')
+        return i + 1; // a null has no value to keep
+    if (c == 't' || c == 'f') {
+        *data = data_int(*data, key, NULL, NULL, c == 't');
+        return *data ? i + 1 : -1;
+    }
+    int ival    = 0;
+    double dval = 0.0;
+    int type    = json_number(json, t, &ival, &dval);
+    if (type < 0)
+        return -1;
+    if (type)
+        *data = data_dbl(*data, key, NULL, NULL, dval);
+    else
+        *data = data_int(*data, key, NULL, NULL, ival);
+    return *data ? i + 1 : -1;
+}
+
+// parse the object at i, the items are NULL for an empty object, returns the index after the object, -1 on error
+static int parse_object(char const *json, jsmntok_t const *tok, int toks, int i, data_t **out)
+{
+    int keys     = tok[i].size;
+    data_t *data = NULL;
+    i += 1;
+    for (int k = 0; k < keys; ++k) {
+        if (i >= toks || tok[i].type != JSMN_STRING) {
+            data_free(data);
+            return -1;
+        }
+        char *key = json_string(json, &tok[i]);
+        if (!key) {
+            data_free(data);
+            return -1;
+        }
+        data_t *prev = data;
+        i            = parse_item(json, tok, toks, i + 1, &data, key);
+        free(key);
+        if (i < 0) {
+            // a failed append already freed the items
+            if (data == prev)
+                data_free(data);
+            return -1;
+        }
+    }
+    *out = data;
+    return i;
+}
+
+static void free_array_values(data_type_t type, void **ptrs, int count)
+{
+    for (int k = 0; k < count; ++k) {
+        if (type == DATA_DATA)
+            data_free(ptrs[k]);
+        else if (type == DATA_ARRAY)
+            data_array_free(ptrs[k]);
+        else
+            free(ptrs[k]);
+    }
+}
+
+// parse the array at i, all values must be of one type, returns the index after the array, -1 on error
+static int parse_array(char const *json, jsmntok_t const *tok, int toks, int i, data_array_t **out)
+{
+    int n = tok[i].size;
+    i += 1;
+    double *nums = calloc(n > 0 ? n : 1, sizeof(*nums));
+    if (!nums) {
+        WARN_CALLOC("parse_array()");
+        return -1;
+    }
+    void **ptrs = calloc(n > 0 ? n : 1, sizeof(*ptrs));
+    if (!ptrs) {
+        WARN_CALLOC("parse_array()");
+        free(nums);
+        return -1;
+    }
+
+    data_type_t type = DATA_INT;
+    int doubles      = 0;
+    int count        = 0;
+    for (; count < n; ++count) {
+        if (i >= toks)
+            break;
+        jsmntok_t const *t = &tok[i];
+        char c             = json[t->start];
+        data_type_t t_type = t->type == JSMN_STRING ? DATA_STRING
+                : t->type == JSMN_OBJECT            ? DATA_DATA
+                : t->type == JSMN_ARRAY             ? DATA_ARRAY
+                : c == 'n'                          ? DATA_COUNT // no value
+                                                    : DATA_INT;
+        if (t_type == DATA_COUNT || (count > 0 && t_type != type))
+            break;
+        type = t_type;
+
+        if (type == DATA_STRING) {
+            ptrs[count] = json_string(json, t);
+            if (!ptrs[count])
+                break;
+            i += 1;
+        }
+        else if (type == DATA_DATA) {
+            data_t *sub = NULL;
+            int next    = parse_object(json, tok, toks, i, &sub);
+            if (next < 0 || !sub)
+                break;
+            ptrs[count] = sub;
+            i           = next;
+        }
+        else if (type == DATA_ARRAY) {
+            data_array_t *sub = NULL;
+            int next          = parse_array(json, tok, toks, i, &sub);
+            if (next < 0)
+                break;
+            ptrs[count] = sub;
+            i           = next;
+        }
+        else if (c == 't' || c == 'f') {
+            nums[count] = c == 't';
+            i += 1;
+        }
+        else {
+            int ival    = 0;
+            double dval = 0.0;
+            int is_dbl  = json_number(json, t, &ival, &dval);
+            if (is_dbl < 0)
+                break;
+            nums[count] = is_dbl ? dval : ival;
+            doubles |= is_dbl;
+            i += 1;
+        }
+    }
+    if (count < n) {
+        if (type != DATA_INT)
+            free_array_values(type, ptrs, count);
+        free(ptrs);
+        free(nums);
+        return -1;
+    }
+
+    data_array_t *array = NULL;
+    if (type == DATA_INT && doubles) {
+        array = data_array(n, DATA_DOUBLE, nums);
+    }
+    else if (type == DATA_INT) {
+        int *ints = calloc(n > 0 ? n : 1, sizeof(*ints));
+        if (!ints) {
+            WARN_CALLOC("parse_array()");
+        }
+        else {
+            for (int k = 0; k < n; ++k) {
+                ints[k] = (int)nums[k];
+            }
+            array = data_array(n, DATA_INT, ints);
+            free(ints);
+        }
+    }
+    else {
+        // the strings are copied, objects and arrays are taken
+        array = data_array(n, type, ptrs);
+        if (type == DATA_STRING || !array)
+            free_array_values(type, ptrs, n);
+    }
+    free(ptrs);
+    free(nums);
+    if (!array)
+        return -1;
+    *out = array;
+    return i;
+}
+
+data_t *batch_parse_event(char const *json, size_t len)
+{
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    // count the tokens first, the events have no fixed size
+    int toks = jsmn_parse(&parser, json, len, NULL, 0);
+    if (toks < 1)
+        return NULL;
+    jsmntok_t *tok = calloc(toks, sizeof(*tok));
+    if (!tok) {
+        WARN_CALLOC("batch_parse_event()");
+        return NULL;
+    }
+    jsmn_init(&parser);
+    toks = jsmn_parse(&parser, json, len, tok, toks);
+
+    data_t *data = NULL;
+    if (toks < 1 || tok[0].type != JSMN_OBJECT || parse_object(json, tok, toks, 0, &data) < 0) {
+        data = NULL;
+    }
+    free(tok);
+    return data;
+}
+
+/* Coordinator */
+
+enum batch_state {
+    BATCH_PENDING,
+    BATCH_ASSIGNED,
+    BATCH_DONE,
+    BATCH_FAILED,
+};
+
+typedef struct batch_peer batch_peer_t;
+
+typedef struct batch_file {
+    char *path;
+    enum batch_state state;
+    batch_peer_t *peer; ///< the worker reading the file while assigned
+    list_t events;      ///< data_t of the file, held until output
+} batch_file_t;
+
+struct batch_peer {
+    batch_coordinator_t *coord;
+    struct mg_connection *conn;
+    int hello;     ///< the worker greeted
+    unsigned want; ///< files asked for and not yet assigned
+};
+
+struct batch_coordinator {
+    struct mg_connection *listener;
+    batch_file_t *files;
+    size_t count;
+    size_t next_output; ///< the first file not output
+    batch_output_fn output_fn;
+    void *ctx;
+    list_t peers; ///< batch_peer_t of the connected workers
+    int ended;    ///< all files are output, the workers are told to end
+    unsigned workers;
+    unsigned failed;
+    unsigned reassigned;
+};
+
+// output the events of the files done in input order, and end the workers after the last file
+static void output_done(batch_coordinator_t *coord)
+{
+    while (coord->next_output < coord->count) {
+        batch_file_t *file = &coord->files[coord->next_output];
+        if (file->state != BATCH_DONE && file->state != BATCH_FAILED)
+            break;
+        for (size_t i = 0; i < file->events.len; ++i) {
+            coord->output_fn(coord->ctx, file->events.elems[i]);
+        }
+        list_clear(&file->events, NULL);
+        coord->next_output += 1;
+    }
+    if (coord->next_output < coord->count || coord->ended)
+        return;
+
+    coord->ended = 1;
+    for (size_t i = 0; i < coord->peers.len; ++i) {
+        batch_peer_t *peer = coord->peers.elems[i];
+        if (peer->hello) {
+            mg_printf(peer->conn, "END\n");
+        }
+    }
+}
+
+// hand the pending files to the workers asking for files, the earliest files first
+static void assign_files(batch_coordinator_t *coord)
+{
+    size_t next = coord->next_output;
+    for (size_t i = 0; i < coord->peers.len; ++i) {
+        batch_peer_t *peer = coord->peers.elems[i];
+        if (coord->ended && peer->want) {
+            mg_printf(peer->conn, "END\n");
+            peer->want = 0;
+            continue;
+        }
+        unsigned sent = 0;
+        for (; peer->want && next < coord->count; ++next) {
+            batch_file_t *file = &coord->files[next];
+            if (file->state != BATCH_PENDING)
+                continue;
+            file->state = BATCH_ASSIGNED;
+            file->peer  = peer;
+            mg_printf(peer->conn, "FILE %zu %s\n", next, file->path);
+            peer->want -= 1;
+            sent += 1;
+        }
+        if (sent) {
+            // the rest of the request waits for files handed back by other workers
+            mg_printf(peer->conn, "GO\n");
+            peer->want = 0;
+        }
+    }
+}
+
+// the file of an event or a report, NULL if the worker was not given it
+static batch_file_t *peer_file(batch_peer_t *peer, char const *seq, char **rest)
+{
+    batch_coordinator_t *coord = peer->coord;
+    char *end;
+    unsigned long long i = strtoull(seq, &end, 10);
+    if (end == seq || (*end && *end != ' ') || i >= coord->count)
+        return NULL;
+    batch_file_t *file = &coord->files[i];
+    if (file->state != BATCH_ASSIGNED || file->peer != peer)
+        return NULL;
+    *rest = *end ? end + 1 : end;
+    return file;
+}
+
+static void peer_line(void *ctx, char *line)
+{
+    batch_peer_t *peer         = ctx;
+    batch_coordinator_t *coord = peer->coord;
+    char *rest;
+
+    if (!peer->hello) {
+        if (strcmp(line, BATCH_HELLO) != 0) {
+            print_logf(LOG_WARNING, "Batch", "Unknown greeting from a worker \"%.40s\"", line);
+            peer->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return;
+        }
+        peer->hello = 1;
+        coord->workers += 1;
+        char addr[64];
+        mg_sock_addr_to_str(&peer->conn->sa, addr, sizeof(addr), MG_SOCK_STRINGIFY_IP | MG_SOCK_STRINGIFY_PORT);
+        print_logf(LOG_NOTICE, "Batch", "Worker %s connected", addr);
+    }
+    else if (strncmp(line, "NEXT ", 5) == 0) {
+        unsigned want = (unsigned)strtoul(line + 5, NULL, 10);
+        peer->want    = MIN(want, BATCH_WANT_MAX);
+        assign_files(coord);
+    }
+    else if (strncmp(line, "EVENT ", 6) == 0) {
+        batch_file_t *file = peer_file(peer, line + 6, &rest);
+        if (!file)
+            return; // a late event of a file handed back
+        data_t *data = batch_parse_event(rest, strlen(rest));
+        if (!data) {
+            print_logf(LOG_WARNING, "Batch", "Invalid event for \"%s\"", file->path);
+            return;
+        }
+        list_push(&file->events, data);
+    }
+    else if (strncmp(line, "DONE ", 5) == 0) {
+        batch_file_t *file = peer_file(peer, line + 5, &rest);
+        if (!file)
+            return;
+        file->peer = NULL;
+        if (strcmp(rest, "ok") == 0) {
+            file->state = BATCH_DONE;
+        }
+        else {
+            file->state = BATCH_FAILED;
+            coord->failed += 1;
+            print_logf(LOG_WARNING, "Batch", "A worker failed to read \"%s\"", file->path);
+        }
+        output_done(coord);
+    }
+}
+
+// a worker is gone, its files are handed out again without the events so far
+static void peer_close(batch_peer_t *peer)
+{
+    batch_coordinator_t *coord = peer->coord;
+    for (size_t i = coord->next_output; i < coord->count; ++i) {
+        batch_file_t *file = &coord->files[i];
+        if (file->state == BATCH_ASSIGNED && file->peer == peer) {
+            list_clear(&file->events, (list_elem_free_fn)data_free);
+            file->state = BATCH_PENDING;
+            file->peer  = NULL;
+            coord->reassigned += 1;
+            print_logf(LOG_WARNING, "Batch", "Worker gone, handing out \"%s\" again", file->path);
+        }
+    }
+    for (size_t i = 0; i < coord->peers.len; ++i) {
+        if (coord->peers.elems[i] == peer) {
+            list_remove(&coord->peers, i, free);
+            break;
+        }
+    }
+    assign_files(coord);
+}
+
+static void coordinator_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    (void)ev_data;
+
+    if (ev == MG_EV_ACCEPT) {
+        batch_coordinator_t *coord = nc->user_data;
+        nc->user_data              = NULL;
+        if (!coord) {
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return; // the coordinator is freed
+        }
+        batch_peer_t *peer = calloc(1, sizeof(*peer));
+        if (!peer) {
+            WARN_CALLOC("coordinator_handler()");
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return;
+        }
+        peer->coord   = coord;
+        peer->conn    = nc;
+        nc->user_data = peer;
+        list_push(&coord->peers, peer);
+        return;
+    }
+    if (!nc->listener || !nc->user_data) {
+        return; // the listener, or the coordinator is freed and the connections are closing
+    }
+    batch_peer_t *peer = nc->user_data;
+
+    if (ev == MG_EV_RECV) {
+        if (read_lines(&nc->recv_mbuf, peer_line, peer) < 0) {
+            print_log(LOG_WARNING, "Batch", "Line too long from a worker");
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        }
+    }
+    else if (ev == MG_EV_CLOSE) {
+        nc->user_data = NULL;
+        peer_close(peer);
+    }
+}
+
+batch_coordinator_t *batch_coordinator_create(struct mg_mgr *mgr, char const *host, char const *port,
+        char const *const *files, size_t count, batch_output_fn output_fn, void *ctx)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(files[i], "-") == 0 || strpbrk(files[i], "\r\n")) {
+            print_logf(LOG_ERROR, "Batch", "Can't hand out the input \"%s\"", files[i]);
+            return NULL;
+        }
+    }
+
+    batch_coordinator_t *coord = calloc(1, sizeof(*coord));
+    if (!coord) {
+        WARN_CALLOC("batch_coordinator_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    coord->files = calloc(count ? count : 1, sizeof(*coord->files));
+    if (!coord->files) {
+        WARN_CALLOC("batch_coordinator_create()");
+        free(coord);
+        return NULL;
+    }
+    coord->count = count;
+    for (size_t i = 0; i < count; ++i) {
+        coord->files[i].path = strdup(files[i]);
+        if (!coord->files[i].path) {
+            WARN_STRDUP("batch_coordinator_create()");
+            batch_coordinator_free(coord);
+            return NULL;
+        }
+    }
+    coord->output_fn = output_fn;
+    coord->ctx       = ctx;
+
+    char address[300];
+    // if the host is an IPv6 address it needs quoting
+    if (host && strchr(host, ':'))
+        snprintf(address, sizeof(address), "tcp://[%s]:%s", host, port);
+    else
+        snprintf(address, sizeof(address), "tcp://%s:%s", host ? host : "", port);
+    coord->listener = mg_bind(mgr, address, coordinator_handler);
+    if (!coord->listener) {
+        print_logf(LOG_ERROR, "Batch", "Binding %s port %s failed", host ? host : "*", port);
+        batch_coordinator_free(coord);
+        return NULL;
+    }
+    coord->listener->user_data = coord;
+
+    // nothing to hand out
+    output_done(coord);
+    return coord;
+}
+
+void batch_coordinator_free(batch_coordinator_t *coord)
+{
+    if (!coord) {
+        return;
+    }
+    // the connections are freed with the event loop, the workers are told to end first
+    for (size_t i = 0; i < coord->peers.len; ++i) {
+        batch_peer_t *peer    = coord->peers.elems[i];
+        peer->conn->user_data = NULL;
+        peer->conn->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    list_free_elems(&coord->peers, free);
+    if (coord->listener) {
+        coord->listener->user_data = NULL;
+        coord->listener->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+    for (size_t i = 0; i < coord->count; ++i) {
+        list_free_elems(&coord->files[i].events, (list_elem_free_fn)data_free);
+        free(coord->files[i].path);
+    }
+    free(coord->files);
+    free(coord);
+}
+
+int batch_coordinator_done(batch_coordinator_t const *coord)
+{
+    return coord->next_output >= coord->count;
+}
+
+unsigned batch_coordinator_workers(batch_coordinator_t const *coord)
+{
+    return coord->workers;
+}
+
+unsigned batch_coordinator_failed(batch_coordinator_t const *coord)
+{
+    return coord->failed;
+}
+
+unsigned batch_coordinator_reassigned(batch_coordinator_t const *coord)
+{
+    return coord->reassigned;
+}
+
+/* Worker */
+
+typedef struct batch_task {
+    unsigned long long seq;
+    char *path;
+} batch_task_t;
+
+typedef struct batch_worker_output batch_worker_output_t;
+
+struct batch_worker {
+    struct mg_mgr *mgr;
+    struct mg_connection *conn;
+    char address[300];
+    unsigned max_files;
+    int connected;    ///< the coordinator answered, a close now ends the work
+    int connect_err;  ///< the last error connecting, reported once
+    int gone;         ///< the coordinator ended the work or closed the connection
+    int asked;        ///< files are asked for
+    int ready;        ///< the assignment is complete
+    double retry_time;
+    list_t tasks;     ///< batch_task_t of the assignment
+    batch_worker_output_t *output;
+};
+
+struct batch_worker_output {
+    data_output_t output;
+    batch_worker_t *worker;
+    char const *const *current_file;
+};
+
+static void batch_task_free(batch_task_t *task)
+{
+    free(task->path);
+    free(task);
+}
+
+static void worker_line(void *ctx, char *line)
+{
+    batch_worker_t *worker = ctx;
+
+    if (strncmp(line, "FILE ", 5) == 0) {
+        char *end;
+        unsigned long long seq = strtoull(line + 5, &end, 10);
+        if (*end != ' ')
+            return;
+        batch_task_t *task = calloc(1, sizeof(*task));
+        if (!task) {
+            WARN_CALLOC("worker_line()");
+            return;
+        }
+        task->seq  = seq;
+        task->path = strdup(end + 1);
+        if (!task->path) {
+            WARN_STRDUP("worker_line()");
+            free(task);
+            return;
+        }
+        list_push(&worker->tasks, task);
+    }
+    else if (strcmp(line, "GO") == 0) {
+        worker->ready = 1;
+        worker->asked = 0;
+    }
+    else if (strcmp(line, "END") == 0) {
+        worker->gone = 1;
+    }
+}
+
+static void worker_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    // note that while shutting down the worker is NULL
+    batch_worker_t *worker = nc->user_data;
+    if (!worker) {
+        return;
+    }
+
+    if (ev == MG_EV_CONNECT) {
+        int status = *(int *)ev_data;
+        if (status == 0) {
+            worker->connected = 1;
+            print_logf(LOG_NOTICE, "Batch", "Connected to the coordinator %s", worker->address);
+            mg_printf(nc, "%s\n", BATCH_HELLO);
+        }
+        else if (worker->connect_err != status) {
+            // print only once
+            print_logf(LOG_WARNING, "Batch", "Connecting to the coordinator %s failed: %s, retrying", worker->address, strerror(status));
+        }
+        worker->connect_err = status;
+    }
+    else if (ev == MG_EV_RECV) {
+        if (read_lines(&nc->recv_mbuf, worker_line, worker) < 0) {
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        }
+    }
+    else if (ev == MG_EV_CLOSE) {
+        worker->conn = NULL;
+        if (worker->connected) {
+            if (!worker->gone)
+                print_log(LOG_WARNING, "Batch", "The coordinator closed the connection");
+            worker->gone = 1;
+        }
+        else {
+            worker->retry_time = mg_time() + BATCH_RETRY_S;
+        }
+    }
+}
+
+static void worker_connect(batch_worker_t *worker)
+{
+    struct mg_connect_opts opts = {0};
+    char const *error_string    = NULL;
+    opts.user_data              = worker;
+    opts.error_string           = &error_string;
+    worker->conn                = mg_connect_opt(worker->mgr, worker->address, worker_handler, opts);
+    if (!worker->conn) {
+        print_logf(LOG_WARNING, "Batch", "Connecting to the coordinator %s failed%s%s", worker->address,
+                error_string ? ": " : "", error_string ? error_string : "");
+        worker->retry_time = mg_time() + BATCH_RETRY_S;
+    }
+}
+
+batch_worker_t *batch_worker_create(struct mg_mgr *mgr, char const *host, char const *port, unsigned max_files)
+{
+    batch_worker_t *worker = calloc(1, sizeof(*worker));
+    if (!worker) {
+        WARN_CALLOC("batch_worker_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    worker->mgr       = mgr;
+    worker->max_files = max_files ? MIN(max_files, BATCH_WANT_MAX) : 1;
+    // if the host is an IPv6 address it needs quoting
+    if (strchr(host, ':'))
+        snprintf(worker->address, sizeof(worker->address), "tcp://[%s]:%s", host, port);
+    else
+        snprintf(worker->address, sizeof(worker->address), "tcp://%s:%s", host, port);
+    worker_connect(worker);
+    return worker;
+}
+
+void batch_worker_free(batch_worker_t *worker)
+{
+    if (!worker) {
+        return;
+    }
+    if (worker->output) {
+        worker->output->worker = NULL;
+    }
+    if (worker->conn) {
+        // let the reports go out before closing
+        for (int i = 0; i < 50 && worker->conn && worker->conn->send_mbuf.len; ++i) {
+            mg_mgr_poll(worker->mgr, 100);
+        }
+    }
+    if (worker->conn) {
+        worker->conn->user_data = NULL;
+        worker->conn->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    list_free_elems(&worker->tasks, (list_elem_free_fn)batch_task_free);
+    free(worker);
+}
+
+int batch_worker_poll(batch_worker_t *worker, int timeout_ms)
+{
+    // the files of the last assignment are done
+    if (worker->ready) {
+        list_clear(&worker->tasks, (list_elem_free_fn)batch_task_free);
+        worker->ready = 0;
+    }
+
+    double deadline = mg_time() + timeout_ms / 1000.0;
+    for (;;) {
+        if (worker->ready && worker->tasks.len)
+            return (int)worker->tasks.len;
+        if (worker->gone)
+            return -1;
+        if (!worker->conn && mg_time() >= worker->retry_time)
+            worker_connect(worker);
+        if (worker->conn && worker->connected && !worker->asked) {
+            mg_printf(worker->conn, "NEXT %u\n", worker->max_files);
+            worker->asked = 1;
+        }
+        double left = deadline - mg_time();
+        if (left <= 0.0)
+            return 0;
+        mg_mgr_poll(worker->mgr, MIN(100, (int)(left * 1000) + 1));
+    }
+}
+
+char const *batch_worker_file(batch_worker_t const *worker, int i)
+{
+    batch_task_t const *task = worker->tasks.elems[i];
+    return task->path;
+}
+
+void batch_worker_done(batch_worker_t *worker, int i, int ok)
+{
+    batch_task_t const *task = worker->tasks.elems[i];
+    if (worker->conn) {
+        mg_printf(worker->conn, "DONE %llu %s\n", task->seq, ok ? "ok" : "failed");
+    }
+}
+
+// the JSON of an event with the doubles kept apart from the integers, NULL if it does not fit a line
+static char *batch_event_json(data_t *data, size_t *len)
+{
+    for (size_t size = 2048; size <= BATCH_LINE_MAX; size *= 4) {
+        char *json = malloc(size);
+        if (!json) {
+            WARN_MALLOC("batch_event_json()");
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+        *len = data_print_jsons_typed(data, json, size);
+        if (*len + 1 < size) {
+            return json;
+        }
+        free(json);
+    }
+    print_log(LOG_WARNING, "Batch", "An event is too large to send, dropped");
+    return NULL;
+}
+
+static void R_API_CALLCONV batch_output_print(data_output_t *output, data_t *data)
+{
+    batch_worker_output_t *out = (batch_worker_output_t *)output;
+    batch_worker_t *worker     = out->worker;
+    if (!worker || !worker->conn || !*out->current_file) {
+        return;
+    }
+    // the file is the assigned path being read
+    batch_task_t const *task = NULL;
+    for (size_t i = 0; i < worker->tasks.len; ++i) {
+        batch_task_t const *t = worker->tasks.elems[i];
+        if (t->path == *out->current_file) {
+            task = t;
+            break;
+        }
+    }
+    if (!task) {
+        return;
+    }
+    // not the shared text of the outputs, that prints e.g. -8.0 as "-8" which reads back as an integer
+    size_t len;
+    char *json = batch_event_json(data, &len);
+    if (!json) {
+        return;
+    }
+    char prefix[32];
+    int prefix_len = snprintf(prefix, sizeof(prefix), "EVENT %llu ", task->seq);
+    mg_send(worker->conn, prefix, prefix_len);
+    mg_send(worker->conn, json, (int)len);
+    mg_send(worker->conn, "\n", 1);
+    free(json);
+}
+
+static void R_API_CALLCONV batch_output_free(data_output_t *output)
+{
+    batch_worker_output_t *out = (batch_worker_output_t *)output;
+    if (out->worker) {
+        out->worker->output = NULL;
+    }
+    free(out);
+}
+
+struct data_output *batch_worker_output(batch_worker_t *worker, char const *const *current_file)
+{
+    batch_worker_output_t *out = calloc(1, sizeof(*out));
+    if (!out) {
+        WARN_CALLOC("batch_worker_output()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    // only the events are sent, the log messages stay with the worker
+    out->output.log_level    = 0;
+    out->output.output_print = batch_output_print;
+    out->output.output_free  = batch_output_free;
+    out->worker              = worker;
+    out->current_file        = current_file;
+    worker->output           = out;
+    return &out->output;
+}
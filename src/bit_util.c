@@ -10,6 +10,7 @@
 */
 
 #include "bit_util.h"
+#include "compat_atomic.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -52,19 +53,43 @@ void reflect_nibbles(uint8_t message[], unsigned num_bytes)
     }
 }
 
+/// Load the 64 bits at bit @p pos MSB first, the bits past byte @p nbytes read as zero.
+/// At least 57 bits are valid, the last @p pos % 8 bits are always zero.
+static inline uint64_t load_bits64(uint8_t const *message, unsigned pos, unsigned nbytes)
+{
+    uint8_t const *p = &message[pos / 8];
+    unsigned k = pos / 8;
+    uint64_t word = 0;
+    if (k + 8 <= nbytes) {
+        for (unsigned i = 0; i < 8; ++i) {
+            word = word << 8 | p[i];
+        }
+    }
+    else {
+        for (unsigned i = 0; i < 8; ++i) {
+            word = word << 8 | (k + i < nbytes ? p[i] : 0);
+        }
+    }
+    return word << (pos % 8);
+}
+
 unsigned extract_nibbles_4b1s(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
 {
-    unsigned ret = 0;
+    unsigned nbytes = (offset_bits + num_bits + 7) / 8;
+    unsigned ret    = 0;
 
     while (num_bits >= 5) {
-        uint16_t bits = (message[offset_bits / 8] << 8) | message[(offset_bits / 8) + 1];
-        bits >>= 11 - (offset_bits % 8); // align 5 bits to LSB
-        if ((bits & 1) != 1)
-            break; // stuff-bit error
-        *dst++ = (bits >> 1) & 0xf;
-        ret += 1;
-        offset_bits += 5;
-        num_bits -= 5;
+        // 11 symbols of 5 bits from each load
+        uint64_t word = load_bits64(message, offset_bits, nbytes);
+        for (unsigned i = 0; i < 11 && num_bits >= 5; ++i) {
+            unsigned bits = (unsigned)(word >> (59 - 5 * i)) & 0x1f;
+            if ((bits & 1) != 1)
+                return ret; // stuff-bit error
+            *dst++ = (bits >> 1) & 0xf;
+            ret += 1;
+            offset_bits += 5;
+            num_bits -= 5;
+        }
     }
 
     return ret;
@@ -72,26 +97,23 @@ unsigned extract_nibbles_4b1s(uint8_t const *message, unsigned offset_bits, unsi
 
 unsigned extract_bytes_uart(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
 {
-    unsigned ret = 0;
+    unsigned nbytes = (offset_bits + num_bits + 7) / 8;
+    unsigned ret    = 0;
 
     while (num_bits >= 10) {
-        int startb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
-        offset_bits += 1;
-        int datab = message[offset_bits / 8];
-        if (offset_bits % 8) {
-            datab = (message[offset_bits / 8] << 8) | message[offset_bits / 8 + 1];
-            datab >>= 8 - (offset_bits % 8);
+        // 5 frames of start bit, 8 data bits LSB first, stop bit from each load
+        uint64_t word = load_bits64(message, offset_bits, nbytes);
+        for (unsigned i = 0; i < 5 && num_bits >= 10; ++i) {
+            unsigned frame = (unsigned)(word >> (54 - 10 * i)) & 0x3ff;
+            if ((frame >> 9) != 0)
+                return ret; // start-bit error
+            if ((frame & 1) != 1)
+                return ret; // stop-bit error
+            *dst++ = reverse8((frame >> 1) & 0xff);
+            ret += 1;
+            offset_bits += 10;
+            num_bits -= 10;
         }
-        offset_bits += 8;
-        int stopb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
-        offset_bits += 1;
-        if ((startb & 1) != 0)
-            break; // start-bit error
-        if ((stopb & 1) != 1)
-            break; // stop-bit error
-        *dst++ = reverse8(datab & 0xff);
-        ret += 1;
-        num_bits -= 10;
     }
 
     return ret;
@@ -99,53 +121,43 @@ unsigned extract_bytes_uart(uint8_t const *message, unsigned offset_bits, unsign
 
 unsigned extract_bytes_uart_parity(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
 {
-    unsigned ret = 0;
+    unsigned nbytes = (offset_bits + num_bits + 7) / 8;
+    unsigned ret    = 0;
 
     while (num_bits >= 11) {
-        int startb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
-        offset_bits += 1;
-        int datab = message[offset_bits / 8];
-        if (offset_bits % 8) {
-            datab = (message[offset_bits / 8] << 8) | message[offset_bits / 8 + 1];
-            datab >>= 8 - (offset_bits % 8);
+        // 5 frames of start bit, 8 data bits, parity bit, stop bit from each load
+        uint64_t word = load_bits64(message, offset_bits, nbytes);
+        for (unsigned i = 0; i < 5 && num_bits >= 11; ++i) {
+            unsigned frame = (unsigned)(word >> (53 - 11 * i)) & 0x7ff;
+            unsigned datab = (frame >> 2) & 0xff;
+            if ((frame >> 10) != 1)
+                return ret; // start-bit error
+            if (((frame >> 1) & 1) != (unsigned)parity8((uint8_t)datab))
+                return ret; // parity-bit error
+            if ((frame & 1) != 0)
+                return ret; // stop-bit error
+            *dst++ = (uint8_t)datab;
+            ret += 1;
+            offset_bits += 11;
+            num_bits -= 11;
         }
-        offset_bits += 8;
-        int parityb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
-        offset_bits += 1;
-        int stopb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
-        offset_bits += 1;
-        int data_parity = parity8(datab);
-        if ((startb & 1) != 1)
-            break; // start-bit error
-        if ((parityb & 1) != data_parity)
-            break; // parity-bit error
-        if ((stopb & 1) != 0)
-            break; // stop-bit error
-        *dst++ = (datab & 0xff);
-        ret += 1;
-        num_bits -= 11;
     }
 
     return ret;
 }
 
-static unsigned symbol_match(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint32_t symbol)
+// match the symbol on the bits loaded at the offset, the symbol is at most 31 bits
+static unsigned symbol_match(uint64_t word, unsigned num_bits, uint32_t symbol)
 {
     unsigned symbol_len = symbol & 0x1f;
 
     // check required len
-    if (num_bits < symbol_len) {
+    if (symbol_len == 0 || num_bits < symbol_len) {
         return 0;
     }
 
-    // match each bit otherwise abort
-    for (unsigned pos = 0; pos < symbol_len; ++pos) {
-        unsigned m_pos = offset_bits + pos;
-        unsigned m_bit = message[m_pos / 8] >> (7 - (m_pos % 8));
-        unsigned s_bit = symbol >> (31 - pos);
-        if ((m_bit & 1) != (s_bit & 1)) {
-            return 0;
-        }
+    if ((word ^ (uint64_t)symbol << 32) >> (64 - symbol_len)) {
+        return 0;
     }
 
     return symbol_len;
@@ -156,23 +168,25 @@ unsigned extract_bits_symbols(uint8_t const *message, unsigned offset_bits, unsi
     unsigned zero_len = zero & 0x1f;
     unsigned one_len  = one & 0x1f;
     unsigned sync_len = sync & 0x1f;
+    unsigned nbytes   = (offset_bits + num_bits + 7) / 8;
 
     unsigned dst_len = 0;
 
     while (num_bits >= 1) {
+        uint64_t word = load_bits64(message, offset_bits, nbytes);
         // TODO: match the longest symbol first
-        if (symbol_match(message, offset_bits, num_bits, sync)) {
+        if (symbol_match(word, num_bits, sync)) {
             offset_bits += sync_len;
             num_bits -= sync_len;
             // just skip
         }
-        else if (symbol_match(message, offset_bits, num_bits, zero)) {
+        else if (symbol_match(word, num_bits, zero)) {
             offset_bits += zero_len;
             num_bits -= zero_len;
             // no need to set a zero
             dst_len += 1;
         }
-        else if (symbol_match(message, offset_bits, num_bits, one)) {
+        else if (symbol_match(word, num_bits, one)) {
             offset_bits += one_len;
             num_bits -= one_len;
             dst[dst_len / 8] |= 0x80 >> (dst_len % 8);
@@ -187,45 +201,72 @@ unsigned extract_bits_symbols(uint8_t const *message, unsigned offset_bits, unsi
     return dst_len;
 }
 
-uint8_t crc4(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
-{
-    unsigned remainder = init << 4; // LSBs are unused
-    unsigned poly = polynomial << 4;
-    unsigned bit;
+/* Shared tables.
 
-    while (nBytes--) {
-        remainder ^= *message++;
-        for (bit = 0; bit < 8; bit++) {
-            if (remainder & 0x80) {
-                remainder = (remainder << 1) ^ poly;
-            } else {
-                remainder = (remainder << 1);
-            }
-        }
-    }
-    return remainder >> 4 & 0x0f; // discard the LSBs
-}
+   The CRC and LFSR tables of a polynomial are built on first use and kept for the life of the
+   process. The tables are published with a compare-and-swap into a small open addressed cache,
+   decoders on any thread can share them without a lock.
+*/
 
-uint8_t crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
-{
-    unsigned remainder = init << 1; // LSB is unused
-    unsigned poly = polynomial << 1;
-    unsigned byte, bit;
+typedef struct shared_table {
+    uint64_t key; ///< kind and parameters of the table
+} shared_table_t;
 
-    for (byte = 0; byte < nBytes; ++byte) {
-        remainder ^= message[byte];
-        for (bit = 0; bit < 8; ++bit) {
-            if (remainder & 0x80) {
-                remainder = (remainder << 1) ^ poly;
-            } else {
-                remainder = (remainder << 1);
+/// Build the table of a key, NULL if out of memory.
+typedef shared_table_t *(*shared_table_build_fn)(uint64_t key);
+
+#define SHARED_TABLES 128 // power of two, more than the distinct tables of all decoders
+
+static shared_table_t *shared_tables[SHARED_TABLES];
+
+/// Find or build the table of a key, NULL if the cache is full or out of memory.
+static shared_table_t const *shared_table(uint64_t key, shared_table_build_fn build)
+{
+    unsigned slot = (unsigned)((key * 0x9e3779b97f4a7c15ULL) >> 57); // Fibonacci hash to 7 bits
+    shared_table_t *table = NULL;
+    for (unsigned probe = 0; probe < SHARED_TABLES; ++probe) {
+        shared_table_t **entry = &shared_tables[(slot + probe) & (SHARED_TABLES - 1)];
+        shared_table_t *found  = atomic_load_acquire(entry);
+        if (!found) {
+            if (!table) {
+                table = build(key);
+                if (!table) {
+                    return NULL;
+                }
+            }
+            if (atomic_cas_ptr((void **)entry, NULL, table)) {
+                return table;
             }
+            found = atomic_load_acquire(entry); // lost the race, the slot is now taken
+        }
+        if (found->key == key) {
+            free(table); // unused if an other thread published the same table
+            return found;
         }
     }
-    return remainder >> 1 & 0x7f; // discard the LSB
+    free(table);
+    return NULL;
 }
 
-uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+/* CRC tables.
+
+   A table holds the remainder of each byte value for one polynomial.
+   crc4() and crc7() run on the CRC-8 table of the polynomial aligned to the MSB.
+*/
+
+enum crc_kind {
+    CRC8_MSB = 1,
+    CRC8_LSB,
+    CRC16_MSB,
+    CRC16_LSB,
+};
+
+typedef struct crc_table {
+    shared_table_t head;
+    uint16_t rem[256];
+} crc_table_t;
+
+static uint8_t crc8_bits(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
     uint8_t remainder = init;
     unsigned byte, bit;
@@ -243,11 +284,10 @@ uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8
     return remainder;
 }
 
-uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+static uint8_t crc8le_bits(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
-    uint8_t remainder = reverse8(init);
+    uint8_t remainder = init;
     unsigned byte, bit;
-    polynomial = reverse8(polynomial);
 
     for (byte = 0; byte < nBytes; ++byte) {
         remainder ^= message[byte];
@@ -262,7 +302,7 @@ uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uin
     return remainder;
 }
 
-uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+static uint16_t crc16lsb_bits(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
 {
     uint16_t remainder = init;
     unsigned byte, bit;
@@ -281,7 +321,7 @@ uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial,
     return remainder;
 }
 
-uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+static uint16_t crc16_bits(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
 {
     uint16_t remainder = init;
     unsigned byte, bit;
@@ -300,7 +340,107 @@ uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, ui
     return remainder;
 }
 
-uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
+static shared_table_t *crc_table_build(uint64_t key)
+{
+    unsigned kind       = (unsigned)(key >> 32);
+    unsigned polynomial = (unsigned)(key & 0xffff);
+    crc_table_t *table = malloc(sizeof(*table));
+    if (!table) {
+        return NULL;
+    }
+    table->head.key = key;
+    for (unsigned i = 0; i < 256; ++i) {
+        uint8_t byte = (uint8_t)i;
+        switch (kind) {
+        case CRC8_MSB:
+            table->rem[i] = crc8_bits(&byte, 1, (uint8_t)polynomial, 0);
+            break;
+        case CRC8_LSB:
+            table->rem[i] = crc8le_bits(&byte, 1, (uint8_t)polynomial, 0);
+            break;
+        case CRC16_MSB:
+            table->rem[i] = crc16_bits(&byte, 1, (uint16_t)polynomial, 0);
+            break;
+        default:
+            table->rem[i] = crc16lsb_bits(&byte, 1, (uint16_t)polynomial, 0);
+            break;
+        }
+    }
+    return &table->head;
+}
+
+/// Find or build the table of a polynomial, NULL if the cache is full or out of memory.
+static uint16_t const *crc_table(unsigned kind, unsigned polynomial)
+{
+    crc_table_t const *table = (crc_table_t const *)shared_table((uint64_t)kind << 32 | polynomial, crc_table_build);
+    return table ? table->rem : NULL;
+}
+
+uint8_t crc4(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    return crc8(message, nBytes, (uint8_t)(polynomial << 4), (uint8_t)(init << 4)) >> 4 & 0x0f; // discard the LSBs
+}
+
+uint8_t crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    return crc8(message, nBytes, (uint8_t)(polynomial << 1), (uint8_t)(init << 1)) >> 1 & 0x7f; // discard the LSB
+}
+
+uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    uint16_t const *rem = crc_table(CRC8_MSB, polynomial);
+    if (!rem) {
+        return crc8_bits(message, nBytes, polynomial, init);
+    }
+    uint8_t remainder = init;
+    for (unsigned byte = 0; byte < nBytes; ++byte) {
+        remainder = (uint8_t)rem[remainder ^ message[byte]];
+    }
+    return remainder;
+}
+
+uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    polynomial = reverse8(polynomial);
+    init       = reverse8(init);
+    uint16_t const *rem = crc_table(CRC8_LSB, polynomial);
+    if (!rem) {
+        return crc8le_bits(message, nBytes, polynomial, init);
+    }
+    uint8_t remainder = init;
+    for (unsigned byte = 0; byte < nBytes; ++byte) {
+        remainder = (uint8_t)rem[remainder ^ message[byte]];
+    }
+    return remainder;
+}
+
+uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+{
+    uint16_t const *rem = crc_table(CRC16_LSB, polynomial);
+    if (!rem) {
+        return crc16lsb_bits(message, nBytes, polynomial, init);
+    }
+    uint16_t remainder = init;
+    for (unsigned byte = 0; byte < nBytes; ++byte) {
+        remainder = (remainder >> 8) ^ rem[(remainder ^ message[byte]) & 0xff];
+    }
+    return remainder;
+}
+
+uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+{
+    uint16_t const *rem = crc_table(CRC16_MSB, polynomial);
+    if (!rem) {
+        return crc16_bits(message, nBytes, polynomial, init);
+    }
+    uint16_t remainder = init;
+    for (unsigned byte = 0; byte < nBytes; ++byte) {
+        remainder = (uint16_t)(remainder << 8) ^ rem[(remainder >> 8) ^ message[byte]];
+    }
+    return remainder;
+}
+
+static uint8_t lfsr_digest8_bits(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from first byte to last byte
@@ -324,7 +464,7 @@ uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8
     return sum;
 }
 
-uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
+static uint8_t lfsr_digest8_reverse_bits(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from last byte to first byte (reflected)
@@ -349,7 +489,7 @@ uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uin
     return sum;
 }
 
-uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
+static uint8_t lfsr_digest8_reflect_bits(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from last byte to first byte (reflected)
@@ -374,7 +514,7 @@ uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, ui
     return sum;
 }
 
-uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+static uint16_t lfsr_digest16_bits(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
 {
     uint16_t sum = 0;
     for (unsigned k = 0; k < bytes; ++k) {
@@ -396,30 +536,219 @@ uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, ui
     return sum;
 }
 
-// The CCITT data whitening process is built around a 9-bit Linear Feedback Shift Register (LFSR).
-// The LFSR polynomial is the same polynomial as for IBM data whitening (x9 + x5 + 1).
-// The initial value of the data whitening key is set to all ones, 0x1FF.
-// s.a. https://www.nxp.com/docs/en/application-note/AN5070.pdf s.5.2
-void ccitt_whitening(uint8_t *buffer, unsigned buffer_size)
+/* LFSR tables.
+
+   The digest is linear in the message bits, and each bit position has a fixed key for one
+   gen and start key. A table holds the digest of each nibble value at each byte position,
+   longer messages are digested bit by bit.
+*/
+
+// the kinds follow the CRC kinds, the keys of all shared tables differ
+enum lfsr_kind {
+    LFSR8_RIGHT = CRC16_LSB + 1, ///< 8 bit key rolled right, bits MSB to LSB
+    LFSR8_LEFT,                  ///< 8 bit key rolled left, bits LSB to MSB
+    LFSR16_RIGHT,                ///< 16 bit key rolled right, bits MSB to LSB
+};
+
+#define LFSR_TABLE_BYTES 32
+
+typedef struct lfsr_table {
+    shared_table_t head;
+    uint16_t nibble[LFSR_TABLE_BYTES][2][16]; ///< digest of the high and the low nibble at each byte
+} lfsr_table_t;
+
+static shared_table_t *lfsr_table_build(uint64_t key)
 {
-    uint8_t key_msb = 0x01;
-    uint8_t key_lsb = 0xff;
+    unsigned kind = (unsigned)(key >> 32);
+    unsigned gen  = (unsigned)(key >> 16 & 0xffff);
+    unsigned k    = (unsigned)(key & 0xffff);
+    lfsr_table_t *table = malloc(sizeof(*table));
+    if (!table) {
+        return NULL;
+    }
+    table->head.key = key;
+    for (unsigned pos = 0; pos < LFSR_TABLE_BYTES; ++pos) {
+        uint16_t bit_key[8]; // key of each data bit, indexed by the bit value
+        for (unsigned i = 0; i < 8; ++i) {
+            bit_key[kind == LFSR8_LEFT ? i : 7 - i] = (uint16_t)k;
+            if (kind == LFSR8_LEFT)
+                k = (k & 0x80 ? (k << 1) ^ gen : k << 1) & 0xff;
+            else
+                k = k & 1 ? (k >> 1) ^ gen : k >> 1;
+        }
+        for (unsigned x = 0; x < 16; ++x) {
+            uint16_t hi = 0;
+            uint16_t lo = 0;
+            for (unsigned i = 0; i < 4; ++i) {
+                if (x >> i & 1) {
+                    hi ^= bit_key[i + 4];
+                    lo ^= bit_key[i];
+                }
+            }
+            table->nibble[pos][0][x] = hi;
+            table->nibble[pos][1][x] = lo;
+        }
+    }
+    return &table->head;
+}
 
-    for (unsigned buffer_pos = 0; buffer_pos < buffer_size; buffer_pos++) {
-        uint8_t reflected_key_lsb;
-        reflected_key_lsb = (key_lsb & 0xf0) >> 4 | (key_lsb & 0x0f) << 4;
-        reflected_key_lsb = (reflected_key_lsb & 0xcc) >> 2 | (reflected_key_lsb & 0x33) << 2;
-        reflected_key_lsb = (reflected_key_lsb & 0xaa) >> 1 | (reflected_key_lsb & 0x55) << 1;
+/// Find or build the table of a gen and key, NULL if the cache is full or out of memory.
+static lfsr_table_t const *lfsr_table(unsigned kind, unsigned gen, unsigned key)
+{
+    return (lfsr_table_t const *)shared_table((uint64_t)kind << 32 | gen << 16 | key, lfsr_table_build);
+}
 
-        buffer[buffer_pos] ^= reflected_key_lsb;
+uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
+{
+    lfsr_table_t const *table = bytes <= LFSR_TABLE_BYTES ? lfsr_table(LFSR8_RIGHT, gen, key) : NULL;
+    if (!table) {
+        return lfsr_digest8_bits(message, bytes, gen, key);
+    }
+    unsigned sum = 0;
+    for (unsigned k = 0; k < bytes; ++k) {
+        sum ^= table->nibble[k][0][message[k] >> 4] ^ table->nibble[k][1][message[k] & 0xf];
+    }
+    return (uint8_t)sum;
+}
 
-        for (uint8_t rol_counter = 0; rol_counter < 8; rol_counter++) {
-            uint8_t key_msb_previous;
-            key_msb_previous = key_msb;
-            key_msb          = (key_lsb & 0x01) ^ ((key_lsb >> 5) & 0x01);
-            key_lsb          = ((key_msb_previous << 7) & 0x80) | ((key_lsb >> 1) & 0xff);
+uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
+{
+    lfsr_table_t const *table = bytes <= LFSR_TABLE_BYTES ? lfsr_table(LFSR8_RIGHT, gen, key) : NULL;
+    if (!table) {
+        return lfsr_digest8_reverse_bits(message, bytes, gen, key);
+    }
+    unsigned sum = 0;
+    for (int k = 0; k < bytes; ++k) {
+        uint8_t data = message[bytes - 1 - k];
+        sum ^= table->nibble[k][0][data >> 4] ^ table->nibble[k][1][data & 0xf];
+    }
+    return (uint8_t)sum;
+}
+
+uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
+{
+    lfsr_table_t const *table = bytes <= LFSR_TABLE_BYTES ? lfsr_table(LFSR8_LEFT, gen, key) : NULL;
+    if (!table) {
+        return lfsr_digest8_reflect_bits(message, bytes, gen, key);
+    }
+    unsigned sum = 0;
+    for (int k = 0; k < bytes; ++k) {
+        uint8_t data = message[bytes - 1 - k];
+        sum ^= table->nibble[k][0][data >> 4] ^ table->nibble[k][1][data & 0xf];
+    }
+    return (uint8_t)sum;
+}
+
+uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+{
+    lfsr_table_t const *table = bytes <= LFSR_TABLE_BYTES ? lfsr_table(LFSR16_RIGHT, gen, key) : NULL;
+    if (!table) {
+        return lfsr_digest16_bits(message, bytes, gen, key);
+    }
+    unsigned sum = 0;
+    for (unsigned k = 0; k < bytes; ++k) {
+        sum ^= table->nibble[k][0][message[k] >> 4] ^ table->nibble[k][1][message[k] & 0xf];
+    }
+    return (uint16_t)sum;
+}
+
+/* Whitening keystreams.
+
+   Whitening XORs the data with the output of an LFSR, the keystream depends only on the
+   taps, degree, and seed. A table holds the keystream up to WHITENING_KEYSTREAM_BYTES,
+   longer buffers are whitened bit by bit past the table.
+*/
+
+// the kinds follow the LFSR kinds, the keys of all shared tables differ
+#define WHITENING_KIND (LFSR16_RIGHT + 1)
+
+typedef struct whitening_table {
+    shared_table_t head;
+    uint8_t key[WHITENING_KEYSTREAM_BYTES];
+} whitening_table_t;
+
+/// Step the LFSR for a byte of keystream, the bits MSB first from the LSB of the state.
+static uint8_t whitening_byte(unsigned *state, uint16_t taps, unsigned degree)
+{
+    unsigned s    = *state;
+    unsigned byte = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        byte = byte << 1 | (s & 1);
+        s    = s >> 1 | (unsigned)parity8((uint8_t)(s & taps) ^ (uint8_t)((s & taps) >> 8)) << (degree - 1);
+    }
+    *state = s;
+    return (uint8_t)byte;
+}
+
+static shared_table_t *whitening_table_build(uint64_t key)
+{
+    unsigned degree = (unsigned)(key >> 32 & 0xff);
+    uint16_t taps   = (uint16_t)(key >> 16 & 0xffff);
+    unsigned state  = (unsigned)(key & 0xffff);
+    whitening_table_t *table = malloc(sizeof(*table));
+    if (!table) {
+        return NULL;
+    }
+    table->head.key = key;
+    for (unsigned pos = 0; pos < WHITENING_KEYSTREAM_BYTES; ++pos) {
+        table->key[pos] = whitening_byte(&state, taps, degree);
+    }
+    return &table->head;
+}
+
+uint8_t const *whitening_keystream(uint16_t taps, unsigned degree, uint16_t seed)
+{
+    if (degree < 2 || degree > 16) {
+        return NULL;
+    }
+    uint64_t key = (uint64_t)WHITENING_KIND << 40 | (uint64_t)degree << 32 | (uint64_t)taps << 16 | seed;
+    whitening_table_t const *table = (whitening_table_t const *)shared_table(key, whitening_table_build);
+    return table ? table->key : NULL;
+}
+
+void xor_keystream(uint8_t *buffer, uint8_t const *key, unsigned len)
+{
+    unsigned i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t b, k;
+        memcpy(&b, &buffer[i], sizeof(b));
+        memcpy(&k, &key[i], sizeof(k));
+        b ^= k;
+        memcpy(&buffer[i], &b, sizeof(b));
+    }
+    for (; i < len; ++i) {
+        buffer[i] ^= key[i];
+    }
+}
+
+void lfsr_whitening(uint8_t *buffer, unsigned len, uint16_t taps, unsigned degree, uint16_t seed)
+{
+    unsigned state = seed;
+    unsigned pos   = 0;
+    uint8_t const *key = whitening_keystream(taps, degree, seed);
+    if (key) {
+        unsigned n = len < WHITENING_KEYSTREAM_BYTES ? len : WHITENING_KEYSTREAM_BYTES;
+        xor_keystream(buffer, key, n);
+        if (n == len) {
+            return;
+        }
+        // advance the LFSR over the table
+        for (; pos < n; ++pos) {
+            whitening_byte(&state, taps, degree);
         }
     }
+    for (; pos < len; ++pos) {
+        buffer[pos] ^= whitening_byte(&state, taps, degree);
+    }
+}
+
+// The CCITT data whitening process is built around a 9-bit Linear Feedback Shift Register (LFSR).
+// The LFSR polynomial is the same polynomial as for IBM data whitening (x9 + x5 + 1).
+// The initial value of the data whitening key is set to all ones, 0x1FF.
+// s.a. https://www.nxp.com/docs/en/application-note/AN5070.pdf s.5.2
+void ccitt_whitening(uint8_t *buffer, unsigned buffer_size)
+{
+    lfsr_whitening(buffer, buffer_size, 0x021, 9, 0x1ff);
 }
 
 /*
@@ -525,6 +854,203 @@ int add_nibbles(uint8_t const message[], unsigned num_bytes)
         } \
     } while (0)
 
+// the CCITT whitening the keystream tables are checked against
+static void ccitt_whitening_bits(uint8_t *buffer, unsigned buffer_size)
+{
+    uint8_t key_msb = 0x01;
+    uint8_t key_lsb = 0xff;
+
+    for (unsigned buffer_pos = 0; buffer_pos < buffer_size; buffer_pos++) {
+        uint8_t reflected_key_lsb;
+        reflected_key_lsb = (key_lsb & 0xf0) >> 4 | (key_lsb & 0x0f) << 4;
+        reflected_key_lsb = (reflected_key_lsb & 0xcc) >> 2 | (reflected_key_lsb & 0x33) << 2;
+        reflected_key_lsb = (reflected_key_lsb & 0xaa) >> 1 | (reflected_key_lsb & 0x55) << 1;
+
+        buffer[buffer_pos] ^= reflected_key_lsb;
+
+        for (uint8_t rol_counter = 0; rol_counter < 8; rol_counter++) {
+            uint8_t key_msb_previous;
+            key_msb_previous = key_msb;
+            key_msb          = (key_lsb & 0x01) ^ ((key_lsb >> 5) & 0x01);
+            key_lsb          = ((key_msb_previous << 7) & 0x80) | ((key_lsb >> 1) & 0xff);
+        }
+    }
+}
+
+// the bit by bit CRC-4 and CRC-7 the tables are checked against
+static uint8_t crc4_bits(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    unsigned remainder = init << 4; // LSBs are unused
+    unsigned poly = polynomial << 4;
+    unsigned bit;
+
+    while (nBytes--) {
+        remainder ^= *message++;
+        for (bit = 0; bit < 8; bit++) {
+            if (remainder & 0x80) {
+                remainder = (remainder << 1) ^ poly;
+            } else {
+                remainder = (remainder << 1);
+            }
+        }
+    }
+    return remainder >> 4 & 0x0f; // discard the LSBs
+}
+
+static uint8_t crc7_bits(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    unsigned remainder = init << 1; // LSB is unused
+    unsigned poly = polynomial << 1;
+    unsigned byte, bit;
+
+    for (byte = 0; byte < nBytes; ++byte) {
+        remainder ^= message[byte];
+        for (bit = 0; bit < 8; ++bit) {
+            if (remainder & 0x80) {
+                remainder = (remainder << 1) ^ poly;
+            } else {
+                remainder = (remainder << 1);
+            }
+        }
+    }
+    return remainder >> 1 & 0x7f; // discard the LSB
+}
+
+// the bit by bit extraction the word loads are checked against
+static unsigned extract_nibbles_4b1s_bits(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
+{
+    unsigned ret = 0;
+
+    while (num_bits >= 5) {
+        uint16_t bits = (message[offset_bits / 8] << 8) | message[(offset_bits / 8) + 1];
+        bits >>= 11 - (offset_bits % 8); // align 5 bits to LSB
+        if ((bits & 1) != 1)
+            break; // stuff-bit error
+        *dst++ = (bits >> 1) & 0xf;
+        ret += 1;
+        offset_bits += 5;
+        num_bits -= 5;
+    }
+
+    return ret;
+}
+
+static unsigned extract_bytes_uart_bits(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
+{
+    unsigned ret = 0;
+
+    while (num_bits >= 10) {
+        int startb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
+        offset_bits += 1;
+        int datab = message[offset_bits / 8];
+        if (offset_bits % 8) {
+            datab = (message[offset_bits / 8] << 8) | message[offset_bits / 8 + 1];
+            datab >>= 8 - (offset_bits % 8);
+        }
+        offset_bits += 8;
+        int stopb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
+        offset_bits += 1;
+        if ((startb & 1) != 0)
+            break; // start-bit error
+        if ((stopb & 1) != 1)
+            break; // stop-bit error
+        *dst++ = reverse8(datab & 0xff);
+        ret += 1;
+        num_bits -= 10;
+    }
+
+    return ret;
+}
+
+static unsigned extract_bytes_uart_parity_bits(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint8_t *dst)
+{
+    unsigned ret = 0;
+
+    while (num_bits >= 11) {
+        int startb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
+        offset_bits += 1;
+        int datab = message[offset_bits / 8];
+        if (offset_bits % 8) {
+            datab = (message[offset_bits / 8] << 8) | message[offset_bits / 8 + 1];
+            datab >>= 8 - (offset_bits % 8);
+        }
+        offset_bits += 8;
+        int parityb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
+        offset_bits += 1;
+        int stopb = message[offset_bits / 8] >> (7 - (offset_bits % 8));
+        offset_bits += 1;
+        int data_parity = parity8(datab);
+        if ((startb & 1) != 1)
+            break; // start-bit error
+        if ((parityb & 1) != data_parity)
+            break; // parity-bit error
+        if ((stopb & 1) != 0)
+            break; // stop-bit error
+        *dst++ = (datab & 0xff);
+        ret += 1;
+        num_bits -= 11;
+    }
+
+    return ret;
+}
+
+static unsigned symbol_match_bits(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint32_t symbol)
+{
+    unsigned symbol_len = symbol & 0x1f;
+
+    // check required len
+    if (num_bits < symbol_len) {
+        return 0;
+    }
+
+    // match each bit otherwise abort
+    for (unsigned pos = 0; pos < symbol_len; ++pos) {
+        unsigned m_pos = offset_bits + pos;
+        unsigned m_bit = message[m_pos / 8] >> (7 - (m_pos % 8));
+        unsigned s_bit = symbol >> (31 - pos);
+        if ((m_bit & 1) != (s_bit & 1)) {
+            return 0;
+        }
+    }
+
+    return symbol_len;
+}
+
+static unsigned extract_bits_symbols_bits(uint8_t const *message, unsigned offset_bits, unsigned num_bits, uint32_t zero, uint32_t one, uint32_t sync, uint8_t *dst)
+{
+    unsigned zero_len = zero & 0x1f;
+    unsigned one_len  = one & 0x1f;
+    unsigned sync_len = sync & 0x1f;
+
+    unsigned dst_len = 0;
+
+    while (num_bits >= 1) {
+        // TODO: match the longest symbol first
+        if (symbol_match_bits(message, offset_bits, num_bits, sync)) {
+            offset_bits += sync_len;
+            num_bits -= sync_len;
+            // just skip
+        }
+        else if (symbol_match_bits(message, offset_bits, num_bits, zero)) {
+            offset_bits += zero_len;
+            num_bits -= zero_len;
+            // no need to set a zero
+            dst_len += 1;
+        }
+        else if (symbol_match_bits(message, offset_bits, num_bits, one)) {
+            offset_bits += one_len;
+            num_bits -= one_len;
+            dst[dst_len / 8] |= 0x80 >> (dst_len % 8);
+            dst_len += 1;
+        }
+        else {
+            break;
+        }
+    }
+
+    return dst_len;
+}
+
 int main(void) {
     unsigned passed = 0;
     unsigned failed = 0;
@@ -539,6 +1065,56 @@ int main(void) {
     fprintf(stderr, "util::crc8(): even parity\n");
     ASSERT_EQUALS(crc8(msg, 4, 0x80, 0x00), 0x00);
 
+    fprintf(stderr, "util::crc*(): tables as bit by bit\n");
+    srand(433);
+    unsigned mismatch = 0;
+    for (unsigned i = 0; i < 20000; ++i) {
+        uint8_t data[64];
+        unsigned len = (unsigned)rand() % sizeof(data);
+        for (unsigned k = 0; k < len; ++k) {
+            data[k] = (uint8_t)rand();
+        }
+        uint16_t poly = (uint16_t)rand();
+        uint16_t init = (uint16_t)rand();
+        // few polynomials, the cache is kept, and a few random ones, the cache overflows
+        if (i % 4) {
+            poly = (uint16_t[]){0x1021, 0x8005, 0x3d65, 0x31, 0x07, 0x13, 0x09}[i % 7];
+        }
+        mismatch += crc4(data, len, (uint8_t)poly, (uint8_t)init) != crc4_bits(data, len, (uint8_t)poly, (uint8_t)init);
+        mismatch += crc7(data, len, (uint8_t)poly, (uint8_t)init) != crc7_bits(data, len, (uint8_t)poly, (uint8_t)init);
+        mismatch += crc8(data, len, (uint8_t)poly, (uint8_t)init) != crc8_bits(data, len, (uint8_t)poly, (uint8_t)init);
+        mismatch += crc8le(data, len, (uint8_t)poly, (uint8_t)init) != crc8le_bits(data, len, reverse8((uint8_t)poly), reverse8((uint8_t)init));
+        mismatch += crc16(data, len, poly, init) != crc16_bits(data, len, poly, init);
+        mismatch += crc16lsb(data, len, poly, init) != crc16lsb_bits(data, len, poly, init);
+    }
+    ASSERT_EQUALS(mismatch, 0);
+
+    fprintf(stderr, "util::lfsr_digest*(): tables as bit by bit\n");
+    mismatch = 0;
+    for (unsigned i = 0; i < 20000; ++i) {
+        uint8_t data[40];
+        unsigned len = (unsigned)rand() % sizeof(data); // up to past the table
+        for (unsigned k = 0; k < len; ++k) {
+            data[k] = (uint8_t)rand();
+        }
+        uint16_t gen = (uint16_t)rand();
+        uint16_t key = (uint16_t)rand();
+        if (i % 4) {
+            gen = (uint16_t[]){0x8810, 0x98, 0x31, 0x51}[i % 4];
+            key = (uint16_t[]){0xba95, 0x3e, 0xf4, 0x04, 0x5412}[i % 5];
+        }
+        mismatch += lfsr_digest8(data, len, (uint8_t)gen, (uint8_t)key) != lfsr_digest8_bits(data, len, (uint8_t)gen, (uint8_t)key);
+        mismatch += lfsr_digest8_reverse(data, (int)len, (uint8_t)gen, (uint8_t)key) != lfsr_digest8_reverse_bits(data, (int)len, (uint8_t)gen, (uint8_t)key);
+        mismatch += lfsr_digest8_reflect(data, (int)len, (uint8_t)gen, (uint8_t)key) != lfsr_digest8_reflect_bits(data, (int)len, (uint8_t)gen, (uint8_t)key);
+        mismatch += lfsr_digest16(data, len, gen, key) != lfsr_digest16_bits(data, len, gen, key);
+    }
+    ASSERT_EQUALS(mismatch, 0);
+
+    fprintf(stderr, "util::crc16(): CRC-16/CCITT-FALSE check value\n");
+    uint8_t check[] = "123456789";
+    ASSERT_EQUALS(crc16(check, 9, 0x1021, 0xffff), 0x29b1);
+    ASSERT_EQUALS(crc16lsb(check, 9, 0xa001, 0x0000), 0xbb3d); // CRC-16/ARC
+
     // sync-word 0b0 0xff 0b1 0b0 0x33 0b1 (i.e. 0x7fd99, note that 0x33 is 0xcc "on the wire")
     uint8_t uart[]   = {0x7f, 0xd9, 0x90};
     uint8_t bytes[6] = {0};
@@ -558,6 +1134,34 @@ int main(void) {
     ASSERT_EQUALS(bytes[3], 0x02);
     ASSERT_EQUALS(bytes[4], 0x03);
 
+    fprintf(stderr, "util::extract_*(): word loads as bit by bit\n");
+    mismatch = 0;
+    for (unsigned i = 0; i < 20000; ++i) {
+        uint8_t data[48] = {0};
+        unsigned len = (unsigned)rand() % 40; // the bit by bit versions read a byte past the bits
+        for (unsigned k = 0; k < len; ++k) {
+            // mostly valid frames and symbols
+            data[k] = i % 2 ? (uint8_t)rand() : (uint8_t[]){0x7f, 0xd9, 0x90, 0xaa, 0x55, 0xcc, 0x33, 0xff}[rand() % 8];
+        }
+        unsigned offset = len ? (unsigned)rand() % (len * 8) : 0;
+        unsigned bits   = len * 8 - offset;
+        uint8_t out[48]      = {0};
+        uint8_t out_bits[48] = {0};
+        mismatch += extract_nibbles_4b1s(data, offset, bits, out) != extract_nibbles_4b1s_bits(data, offset, bits, out_bits);
+        mismatch += extract_bytes_uart(data, offset, bits, out) != extract_bytes_uart_bits(data, offset, bits, out_bits);
+        mismatch += memcmp(out, out_bits, sizeof(out)) != 0;
+        mismatch += extract_bytes_uart_parity(data, offset, bits, out) != extract_bytes_uart_parity_bits(data, offset, bits, out_bits);
+        mismatch += memcmp(out, out_bits, sizeof(out)) != 0;
+        uint32_t zero = (uint32_t)rand() << 16 | (1 + (unsigned)rand() % 6);
+        uint32_t one  = (uint32_t)rand() << 16 | (1 + (unsigned)rand() % 6);
+        uint32_t sync = i % 3 ? (uint32_t)rand() << 16 | (unsigned)rand() % 32 : 0;
+        memset(out, 0, sizeof(out));
+        memset(out_bits, 0, sizeof(out_bits));
+        mismatch += extract_bits_symbols(data, offset, bits, zero, one, sync, out) != extract_bits_symbols_bits(data, offset, bits, zero, one, sync, out_bits);
+        mismatch += memcmp(out, out_bits, sizeof(out)) != 0;
+    }
+    ASSERT_EQUALS(mismatch, 0);
+
     fprintf(stderr, "util:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
 
     fprintf(stderr, "util::ccitt_whitening():\n");
@@ -566,6 +1170,21 @@ int main(void) {
     ccitt_whitening(buf, sizeof(buf)) ;
     ASSERT_MATCH(buf, chk, sizeof(buf));
 
+    fprintf(stderr, "util::lfsr_whitening(): against the bit by bit CCITT whitening, past the keystream table\n");
+    uint8_t long_buf[WHITENING_KEYSTREAM_BYTES + 45];
+    uint8_t long_chk[sizeof(long_buf)];
+    for (unsigned k = 0; k < sizeof(long_buf); ++k) {
+        long_buf[k] = long_chk[k] = (uint8_t)rand();
+    }
+    for (unsigned len = 0; len <= sizeof(long_buf); len += 43) {
+        ccitt_whitening(long_buf, len);
+        ccitt_whitening_bits(long_chk, len);
+        ASSERT_MATCH(long_buf, long_chk, sizeof(long_buf));
+    }
+    ccitt_whitening(long_buf, sizeof(long_buf));
+    ccitt_whitening_bits(long_chk, sizeof(long_chk));
+    ASSERT_MATCH(long_buf, long_chk, sizeof(long_buf));
+
     return failed;
 }
 #endif /* _TEST */
@@ -13,10 +13,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 void bitbuffer_clear(bitbuffer_t *bits)
 {
-    memset(bits, 0, sizeof(*bits));
+    // bits are only ever added below the free row, the rows past it are still clear
+    unsigned rows = bits->free_row > bits->num_rows ? bits->free_row : bits->num_rows;
+    if (rows > BITBUF_ROWS)
+        rows = BITBUF_ROWS;
+    memset(bits->bb, 0, rows * sizeof(bits->bb[0]));
+    memset(bits, 0, offsetof(bitbuffer_t, bb));
+}
+
+void bitbuffer_copy(bitbuffer_t *dst, bitbuffer_t const *src)
+{
+    bitbuffer_clear(dst);
+    unsigned rows = src->free_row > src->num_rows ? src->free_row : src->num_rows;
+    if (rows > BITBUF_ROWS)
+        rows = BITBUF_ROWS;
+    memcpy(dst, src, offsetof(bitbuffer_t, bb));
+    memcpy(dst->bb, src->bb, rows * sizeof(src->bb[0]));
 }
 
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit)
@@ -128,44 +144,59 @@ void bitbuffer_add_sync(bitbuffer_t *bits)
     bits->syncs_before_row[bits->num_rows - 1]++;
 }
 
-void bitbuffer_invert(bitbuffer_t *bits)
+static inline uint64_t load_be64(uint8_t const *p)
 {
-    for (unsigned row = 0; row < bits->num_rows; ++row) {
-        if (bits->bits_per_row[row] > 0) {
-            uint8_t *b = bits->bb[row];
-
-            const unsigned last_col  = (bits->bits_per_row[row] - 1) / 8;
-            const unsigned last_bits = ((bits->bits_per_row[row] - 1) % 8) + 1;
-            for (unsigned col = 0; col <= last_col; ++col) {
-                b[col] = ~b[col]; // Invert
-            }
-            b[last_col] ^= 0xFF >> last_bits; // Re-invert unused bits in last byte
-        }
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        v = v << 8 | p[i];
     }
+    return v;
 }
 
-void bitbuffer_nrzs_decode(bitbuffer_t *bits)
+static inline void store_be64(uint8_t *p, uint64_t v)
 {
-    for (unsigned row = 0; row < bits->num_rows; ++row) {
-        if (bits->bits_per_row[row] > 0) {
-            uint8_t *b = bits->bb[row];
+    for (unsigned i = 0; i < 8; ++i) {
+        p[i] = (uint8_t)(v >> (56 - i * 8));
+    }
+}
 
-            const unsigned last_col  = (bits->bits_per_row[row] - 1) / 8;
-            const unsigned last_bits = ((bits->bits_per_row[row] - 1) % 8) + 1;
+// reflect the bits of each nibble
+static inline uint64_t reflect_nibble_bits(uint64_t v)
+{
+    v = (v & 0xcccccccccccccccc) >> 2 | (v & 0x3333333333333333) << 2;
+    v = (v & 0xaaaaaaaaaaaaaaaa) >> 1 | (v & 0x5555555555555555) << 1;
+    return v;
+}
 
-            int prev = 0;
-            for (unsigned col = 0; col <= last_col; ++col) {
-                int mask = (prev << 7) | b[col] >> 1;
-                prev     = b[col];
-                b[col]   = b[col] ^ ~mask;
-            }
-            b[last_col] &= 0xFF << (8 - last_bits); // Clear unused bits in last byte
-        }
+// transform 8 bytes, the first byte in the top bits, @p prev holds the last bit of the previous word
+static inline uint64_t transform_word(uint64_t v, uint64_t *prev, unsigned transform)
+{
+    uint64_t mask;
+    switch (transform) {
+    case BITBUFFER_INVERTED:
+        return ~v;
+    case BITBUFFER_NRZS:
+        mask  = *prev << 63 | v >> 1;
+        *prev = v & 1;
+        return v ^ ~mask;
+    case BITBUFFER_NRZM:
+        mask  = *prev << 63 | v >> 1;
+        *prev = v & 1;
+        return v ^ mask;
+    case BITBUFFER_REFLECTED:
+        return reflect_nibble_bits((v & 0xf0f0f0f0f0f0f0f0) >> 4 | (v & 0x0f0f0f0f0f0f0f0f) << 4);
+    case BITBUFFER_NIBBLES_REFLECTED:
+        return reflect_nibble_bits(v);
+    default:
+        return v;
     }
 }
 
-void bitbuffer_nrzm_decode(bitbuffer_t *bits)
+void bitbuffer_transform(bitbuffer_t *bits, unsigned transform)
 {
+    if (transform == BITBUFFER_AS_IS || transform >= BITBUFFER_TRANSFORMS)
+        return;
+
     for (unsigned row = 0; row < bits->num_rows; ++row) {
         if (bits->bits_per_row[row] > 0) {
             uint8_t *b = bits->bb[row];
@@ -173,17 +204,42 @@ void bitbuffer_nrzm_decode(bitbuffer_t *bits)
             const unsigned last_col  = (bits->bits_per_row[row] - 1) / 8;
             const unsigned last_bits = ((bits->bits_per_row[row] - 1) % 8) + 1;
 
-            int prev = 0;
-            for (unsigned col = 0; col <= last_col; ++col) {
-                int mask = (prev << 7) | b[col] >> 1;
-                prev     = b[col];
-                b[col]   = b[col] ^ mask;
+            uint64_t prev = 0;
+            unsigned col  = 0;
+            for (; col + 8 <= last_col + 1; col += 8) {
+                store_be64(&b[col], transform_word(load_be64(&b[col]), &prev, transform));
             }
-            b[last_col] &= 0xFF << (8 - last_bits); // Clear unused bits in last byte
+            if (col <= last_col) {
+                // the tail as a word padded with zero bytes, the transforms carry towards the end only
+                uint8_t tail[8] = {0};
+                memcpy(tail, &b[col], last_col + 1 - col);
+                store_be64(tail, transform_word(load_be64(tail), &prev, transform));
+                memcpy(&b[col], tail, last_col + 1 - col);
+            }
+
+            if (transform == BITBUFFER_INVERTED)
+                b[last_col] ^= 0xFF >> last_bits; // Re-invert unused bits in last byte
+            else if (transform == BITBUFFER_NRZS || transform == BITBUFFER_NRZM)
+                b[last_col] &= 0xFF << (8 - last_bits); // Clear unused bits in last byte
         }
     }
 }
 
+void bitbuffer_invert(bitbuffer_t *bits)
+{
+    bitbuffer_transform(bits, BITBUFFER_INVERTED);
+}
+
+void bitbuffer_nrzs_decode(bitbuffer_t *bits)
+{
+    bitbuffer_transform(bits, BITBUFFER_NRZS);
+}
+
+void bitbuffer_nrzm_decode(bitbuffer_t *bits)
+{
+    bitbuffer_transform(bits, BITBUFFER_NRZM);
+}
+
 void bitbuffer_extract_bytes(bitbuffer_t *bitbuffer, unsigned row,
         unsigned pos, uint8_t *out, unsigned len)
 {
@@ -191,21 +247,34 @@ void bitbuffer_extract_bytes(bitbuffer_t *bitbuffer, unsigned row,
     if (len == 0)
         return;
     if ((pos & 7) == 0) {
-        memcpy(out, bits + (pos / 8), (len + 7) / 8);
+        memmove(out, bits + (pos / 8), (len + 7) / 8); // out may be the row itself
     }
     else {
-        unsigned shift = 8 - (pos & 7);
+        unsigned shift = pos & 7;
         unsigned bytes = (len + 7) >> 3;
         uint8_t *p = out;
-        uint16_t word;
-        pos = pos >> 3; // Convert to bytes
+        uint8_t const *src = bits + (pos >> 3);
 
-        word = bits[pos];
+        // 7 bytes from each load of 8 bytes, all loads are read before the writes if out is the row
+        while (bytes >= 7) {
+            uint64_t word = 0;
+            for (unsigned i = 0; i < 8; ++i) {
+                word = word << 8 | src[i];
+            }
+            word <<= shift;
+            for (unsigned i = 0; i < 7; ++i) {
+                p[i] = (uint8_t)(word >> (56 - 8 * i));
+            }
+            src += 7;
+            p += 7;
+            bytes -= 7;
+        }
 
+        uint16_t word = *src;
         while (bytes--) {
             word <<= 8;
-            word |= bits[++pos];
-            *(p++) = word >> shift;
+            word |= *++src;
+            *(p++) = word >> (8 - shift);
         }
     }
     if (len & 7)
@@ -219,11 +288,16 @@ static inline uint8_t bit_at(const uint8_t *bytes, unsigned bit)
     return (uint8_t)(bytes[bit >> 3] >> (7 - (bit & 7)) & 1);
 }
 
-unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+// the byte at @p k of a row of @p nbytes, zero past the end
+static inline uint64_t byte_or_zero(const uint8_t *bytes, unsigned k, unsigned nbytes)
+{
+    return k < nbytes ? bytes[k] : 0;
+}
+
+// bit by bit with backtracking, for patterns longer than the window
+static unsigned bitbuffer_search_bits(const uint8_t *bits, unsigned len, unsigned start,
         const uint8_t *pattern, unsigned pattern_bits_len)
 {
-    uint8_t *bits = bitbuffer->bb[row];
-    unsigned len  = bitbuffer->bits_per_row[row];
     unsigned ipos = start;
     unsigned ppos = 0; // cursor on init pattern
 
@@ -245,16 +319,198 @@ unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
     return len;
 }
 
-unsigned bitbuffer_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned start,
-        bitbuffer_t *outbuf, unsigned max)
+unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        const uint8_t *pattern, unsigned pattern_bits_len)
 {
-    uint8_t *bits     = inbuf->bb[row];
-    unsigned int len  = inbuf->bits_per_row[row];
-    unsigned int ipos = start;
+    uint8_t *bits = bitbuffer->bb[row];
+    unsigned len  = bitbuffer->bits_per_row[row];
 
-    if (max && len > start + (max * 2))
-        len = start + (max * 2);
+    if (pattern_bits_len == 0 || pattern_bits_len > 64)
+        return bitbuffer_search_bits(bits, len, start, pattern, pattern_bits_len);
+    if (start >= len || len - start < pattern_bits_len)
+        return len; // Not found
+
+    // the pattern and its mask, MSB first in a 64 bit window
+    unsigned pattern_bytes = (pattern_bits_len + 7) / 8;
+    uint64_t mask = ~0ULL << (64 - pattern_bits_len);
+    uint64_t pat  = 0;
+    for (unsigned k = 0; k < pattern_bytes; ++k) {
+        pat |= (uint64_t)pattern[k] << (56 - 8 * k);
+    }
+    pat &= mask;
+
+    unsigned nbytes = (len + 7) / 8;
+    unsigned last   = len - pattern_bits_len; // last position where the pattern fits
+
+    if (pattern_bits_len > 57) {
+        // slide the window one bit at a time, a shifted pattern does not fit
+        unsigned k = start / 8;
+        unsigned s = start % 8;
+        uint64_t win = 0;
+        for (unsigned i = 0; i < 8; ++i) {
+            win = win << 8 | byte_or_zero(bits, k + i, nbytes);
+        }
+        win = win << s | byte_or_zero(bits, k + 8, nbytes) >> (8 - s);
+        for (unsigned ipos = start; ipos <= last; ++ipos) {
+            if ((win & mask) == pat)
+                return ipos;
+            unsigned next = ipos + 64;
+            win = win << 1 | (next < len ? bit_at(bits, next) : 0);
+        }
+        return len; // Not found
+    }
+
+    // the pattern at each of the 8 bit offsets in a window of 8 whole bytes
+    uint64_t masks[8];
+    uint64_t pats[8];
+    for (unsigned s = 0; s < 8; ++s) {
+        masks[s] = mask >> s;
+        pats[s]  = pat >> s;
+    }
+
+    unsigned k = start / 8;
+    uint64_t win = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        win = win << 8 | byte_or_zero(bits, k + i, nbytes);
+    }
+    for (unsigned s = start % 8; k * 8 <= last; ++k, s = 0) {
+        for (; s < 8; ++s) {
+            if ((win & masks[s]) == pats[s]) {
+                unsigned ipos = k * 8 + s;
+                return ipos <= last ? ipos : len;
+            }
+        }
+        win = win << 8 | byte_or_zero(bits, k + 8, nbytes);
+    }
+
+    // Not found
+    return len;
+}
+
+void bitbuffer_add_bits(bitbuffer_t *bits, unsigned value, unsigned n)
+{
+    unsigned r = bits->num_rows ? bits->bits_per_row[bits->num_rows - 1] : 0;
+    unsigned in_row = r % (BITBUF_COLS * 8);
+    // leave the first row, the spill into the next row, and the length limit to bitbuffer_add_bit()
+    if (r == 0 || in_row == 0 || in_row + n > BITBUF_COLS * 8 || r + n >= UINT16_MAX - 1) {
+        for (unsigned i = 0; i < n; ++i) {
+            bitbuffer_add_bit(bits, value >> (7 - i) & 1);
+        }
+        return;
+    }
+    uint8_t *b = bits->bb[bits->num_rows - 1];
+    unsigned w = (value & (0xff00 >> n) & 0xff) << (8 - r % 8);
+    b[r / 8] |= w >> 8;
+    if (r % 8 + n > 8)
+        b[r / 8 + 1] |= w & 0xff;
+    bits->bits_per_row[bits->num_rows - 1] += n;
+}
 
+void bitbuffer_add_bits_run(bitbuffer_t *bits, int bit, unsigned count)
+{
+    if (!count)
+        return;
+    if (bits->num_rows == 0)
+        bits->free_row = bits->num_rows = 1; // Add first row automatically
+
+    unsigned r   = bits->bits_per_row[bits->num_rows - 1];
+    unsigned end = r + count;
+    // the bits past a multiple of the row size spill into the next rows
+    unsigned spills = (end - 1) / (BITBUF_COLS * 8) - (r ? (r - 1) / (BITBUF_COLS * 8) : 0);
+    // leave the warnings and the limits of the length and the rows to bitbuffer_add_bit()
+    if (end >= UINT16_MAX - 1 || bits->free_row + spills >= BITBUF_ROWS - 1) {
+        for (unsigned i = 0; i < count; ++i) {
+            bitbuffer_add_bit(bits, bit);
+        }
+        return;
+    }
+    // the bits past the end are clear, a run of zeros only extends the row
+    if (bit) {
+        uint8_t *b     = bits->bb[bits->num_rows - 1];
+        unsigned first = r / 8;
+        unsigned last  = (end - 1) / 8;
+        uint8_t head   = 0xff >> (r % 8);
+        uint8_t tail   = (uint8_t)(0xff << (7 - (end - 1) % 8));
+        if (first == last) {
+            b[first] |= head & tail;
+        }
+        else {
+            b[first] |= head;
+            memset(&b[first + 1], 0xff, last - first - 1);
+            b[last] |= tail;
+        }
+    }
+    bits->bits_per_row[bits->num_rows - 1] = (uint16_t)end;
+    bits->free_row += spills;
+}
+
+// the 8 bits of a row from @p bit on, the bits need to be in the row
+static inline unsigned byte_at(const uint8_t *bytes, unsigned bit)
+{
+    if (bit & 7)
+        return (unsigned)(bytes[bit >> 3] << (bit & 7) | bytes[(bit >> 3) + 1] >> (8 - (bit & 7))) & 0xff;
+    return bytes[bit >> 3];
+}
+
+// count of valid symbols in the high and data bits in the low nibble of each 8 input bits
+static uint8_t const manchester_lut[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x2c, 0x2c, 0x2c, 0x2c, 0x3e, 0x4f, 0x4e, 0x3e, 0x3c, 0x4d, 0x4c, 0x3c, 0x2c, 0x2c, 0x2c, 0x2c,
+    0x28, 0x28, 0x28, 0x28, 0x3a, 0x4b, 0x4a, 0x3a, 0x38, 0x49, 0x48, 0x38, 0x28, 0x28, 0x28, 0x28,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x24, 0x24, 0x24, 0x24, 0x36, 0x47, 0x46, 0x36, 0x34, 0x45, 0x44, 0x34, 0x24, 0x24, 0x24, 0x24,
+    0x20, 0x20, 0x20, 0x20, 0x32, 0x43, 0x42, 0x32, 0x30, 0x41, 0x40, 0x30, 0x20, 0x20, 0x20, 0x20,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// as manchester_lut, indexed by the last bit before and the 8 input bits
+static uint8_t const differential_manchester_lut[512] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x30, 0x30, 0x40, 0x41, 0x43, 0x42, 0x32, 0x32,
+    0x36, 0x36, 0x46, 0x47, 0x45, 0x44, 0x34, 0x34, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24,
+    0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x3c, 0x3c, 0x4c, 0x4d, 0x4f, 0x4e, 0x3e, 0x3e,
+    0x3a, 0x3a, 0x4a, 0x4b, 0x49, 0x48, 0x38, 0x38, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x38, 0x38, 0x48, 0x49, 0x4b, 0x4a, 0x3a, 0x3a,
+    0x3e, 0x3e, 0x4e, 0x4f, 0x4d, 0x4c, 0x3c, 0x3c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c, 0x2c,
+    0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x34, 0x34, 0x44, 0x45, 0x47, 0x46, 0x36, 0x36,
+    0x32, 0x32, 0x42, 0x43, 0x41, 0x40, 0x30, 0x30, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// the plain decoding, one symbol at a time
+static unsigned manchester_decode_bits(uint8_t *bits, unsigned len, unsigned ipos, bitbuffer_t *outbuf)
+{
     while (ipos < len) {
         uint8_t bit1, bit2;
 
@@ -270,18 +526,53 @@ unsigned bitbuffer_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned
     return ipos;
 }
 
-unsigned bitbuffer_differential_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned start,
+unsigned bitbuffer_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned start,
         bitbuffer_t *outbuf, unsigned max)
 {
     uint8_t *bits     = inbuf->bb[row];
     unsigned int len  = inbuf->bits_per_row[row];
     unsigned int ipos = start;
-    uint8_t bit1, bit2 = 0;
 
     if (max && len > start + (max * 2))
         len = start + (max * 2);
 
-    // the first long pulse will determine the clock
+    // four symbols at a time
+    while (ipos + 8 <= len) {
+        unsigned sym   = manchester_lut[byte_at(bits, ipos)];
+        unsigned valid = sym >> 4;
+        bitbuffer_add_bits(outbuf, sym << 4, valid);
+        if (valid < 4)
+            return ipos + valid * 2 + 2; // the invalid symbol is taken
+        ipos += 8;
+    }
+
+    return manchester_decode_bits(bits, len, ipos, outbuf);
+}
+
+// the plain decoding after the clock is found, one symbol at a time
+static unsigned differential_manchester_decode_bits(uint8_t *bits, unsigned len, unsigned ipos, uint8_t bit2, bitbuffer_t *outbuf)
+{
+    while (ipos < len) {
+        uint8_t bit1 = bit_at(bits, ipos++);
+        if (bit1 == bit2)
+            break; // clock missing, abort
+        bit2 = bit_at(bits, ipos++);
+
+        if (bit1 == bit2)
+            bitbuffer_add_bit(outbuf, 1);
+        else
+            bitbuffer_add_bit(outbuf, 0);
+    }
+
+    return ipos;
+}
+
+// the first long pulse will determine the clock, returns the last bit before the next symbol
+static uint8_t differential_manchester_clock(uint8_t *bits, unsigned len, unsigned *pos, bitbuffer_t *outbuf)
+{
+    unsigned ipos = *pos;
+    uint8_t bit1, bit2 = 0;
+
     // if needed skip one short pulse to get in synch
     while (ipos < len) {
         bit1 = bit_at(bits, ipos++);
@@ -305,19 +596,35 @@ unsigned bitbuffer_differential_manchester_decode(bitbuffer_t *inbuf, unsigned r
         }
     }
 
-    while (ipos < len) {
-        bit1 = bit_at(bits, ipos++);
-        if (bit1 == bit2)
-            break; // clock missing, abort
-        bit2 = bit_at(bits, ipos++);
+    *pos = ipos;
+    return bit2;
+}
 
-        if (bit1 == bit2)
-            bitbuffer_add_bit(outbuf, 1);
-        else
-            bitbuffer_add_bit(outbuf, 0);
+unsigned bitbuffer_differential_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned start,
+        bitbuffer_t *outbuf, unsigned max)
+{
+    uint8_t *bits     = inbuf->bb[row];
+    unsigned int len  = inbuf->bits_per_row[row];
+    unsigned int ipos = start;
+
+    if (max && len > start + (max * 2))
+        len = start + (max * 2);
+
+    uint8_t bit2 = differential_manchester_clock(bits, len, &ipos, outbuf);
+
+    // four symbols at a time
+    while (ipos + 8 <= len) {
+        unsigned byte  = byte_at(bits, ipos);
+        unsigned sym   = differential_manchester_lut[(unsigned)bit2 << 8 | byte];
+        unsigned valid = sym >> 4;
+        bitbuffer_add_bits(outbuf, sym << 4, valid);
+        if (valid < 4)
+            return ipos + valid * 2 + 1; // the first bit of the invalid symbol is taken
+        ipos += 8;
+        bit2 = byte & 1;
     }
 
-    return ipos;
+    return differential_manchester_decode_bits(bits, len, ipos, bit2, outbuf);
 }
 
 static void print_bitrow(uint8_t const *bitrow, unsigned bit_len, unsigned highest_indent, int always_binary)
@@ -493,31 +800,71 @@ unsigned bitbuffer_count_repeats(bitbuffer_t *bits, unsigned row, unsigned max_b
     return cnt;
 }
 
-int bitbuffer_find_repeated_row(bitbuffer_t *bits, unsigned min_repeats, unsigned min_bits)
+// hash of the bytes bitbuffer_compare_rows() compares, with the length on a full compare
+static uint32_t row_hash(uint8_t const *row, unsigned row_bits, unsigned max_bits)
 {
-    for (int i = 0; i < bits->num_rows; ++i) {
-        if (bits->bits_per_row[i] >= min_bits &&
-                bitbuffer_count_repeats(bits, i, 0) >= min_repeats) {
-            return i;
-        }
+    uint32_t hash = 2166136261u; // FNV-1a
+    unsigned bytes;
+    uint8_t last = 0;
+    if (max_bits == 0) {
+        bytes = (row_bits + 7) / 8;
+        hash  = (hash ^ row_bits) * 16777619u;
     }
-    return -1;
+    else {
+        bytes = max_bits / 8;
+        if (max_bits & 7)
+            last = row[bytes] & (0xff00 >> (max_bits & 7));
+    }
+    for (unsigned i = 0; i < bytes; ++i) {
+        hash = (hash ^ row[i]) * 16777619u;
+    }
+    return (hash ^ last) * 16777619u;
 }
 
-int bitbuffer_find_repeated_prefix(bitbuffer_t *bits, unsigned min_repeats, unsigned min_bits)
+// rows are repeats if they are equal in full, or in the first max_bits
+static int find_repeated(bitbuffer_t *bits, unsigned min_repeats, unsigned min_bits, unsigned max_bits)
 {
-    for (int i = 0; i < bits->num_rows; ++i) {
-        if (bits->bits_per_row[i] >= min_bits &&
-                bitbuffer_count_repeats(bits, i, min_bits) >= min_repeats) {
-            return i;
+    uint32_t hash[BITBUF_ROWS];
+    uint8_t skip[BITBUF_ROWS]; // too short, or equal to a checked row
+    unsigned rows = bits->num_rows < BITBUF_ROWS ? bits->num_rows : BITBUF_ROWS;
+    for (unsigned i = 0; i < rows; ++i) {
+        skip[i] = bits->bits_per_row[i] < min_bits;
+        if (!skip[i])
+            hash[i] = row_hash(bits->bb[i], bits->bits_per_row[i], max_bits);
+    }
+
+    // a shorter row never equals a row of at least min_bits, and equal rows have the same count
+    for (unsigned i = 0; i < rows; ++i) {
+        if (skip[i])
+            continue;
+        unsigned cnt = 1;
+        for (unsigned j = i + 1; j < rows; ++j) {
+            if (!skip[j] && hash[j] == hash[i] && bitbuffer_compare_rows(bits, i, j, max_bits)) {
+                skip[j] = 1;
+                ++cnt;
+            }
         }
+        if (cnt >= min_repeats)
+            return (int)i;
     }
     return -1;
 }
 
+int bitbuffer_find_repeated_row(bitbuffer_t *bits, unsigned min_repeats, unsigned min_bits)
+{
+    return find_repeated(bits, min_repeats, min_bits, 0);
+}
+
+int bitbuffer_find_repeated_prefix(bitbuffer_t *bits, unsigned min_repeats, unsigned min_bits)
+{
+    return find_repeated(bits, min_repeats, min_bits, min_bits);
+}
+
 // Unit testing
 #ifdef _TEST
 
+#include <time.h>
+
 #define ASSERT(expr) \
     do { \
         if (expr) { \
@@ -592,6 +939,313 @@ int main(void)
     bitbuffer_add_bit(&bits, 1);
     bitbuffer_print(&bits);
 
+    fprintf(stderr, "TEST: bitbuffer:: Clear a spilled row\n");
+    bitbuffer_clear(&bits);
+    bitbuffer_add_row(&bits);
+    for (int i = 0; i < BITBUF_COLS * 8 * 2 + 3; ++i) {
+        bitbuffer_add_bit(&bits, 1);
+    }
+    bitbuffer_clear(&bits);
+    int dirty = 0;
+    for (unsigned i = 0; i < sizeof(bits.bb); ++i) {
+        dirty |= ((uint8_t *)bits.bb)[i];
+    }
+    ASSERT(dirty == 0);
+    ASSERT(bits.free_row == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Clear speed\n");
+    unsigned const loops = 100000;
+    clock_t start = clock();
+    for (unsigned n = 0; n < loops; ++n) {
+        memset(&bits, 0, sizeof(bits));
+        bitbuffer_add_bit(&bits, n & 1);
+    }
+    clock_t mid = clock();
+    for (unsigned n = 0; n < loops; ++n) {
+        bitbuffer_clear(&bits);
+        bitbuffer_add_bit(&bits, n & 1);
+    }
+    clock_t stop = clock();
+    fprintf(stderr, "bitbuffer:: full clear %.1f ns, clear of one row %.1f ns\n",
+            (double)(mid - start) * 1e9 / CLOCKS_PER_SEC / loops,
+            (double)(stop - mid) * 1e9 / CLOCKS_PER_SEC / loops);
+    ASSERT(bits.num_rows == 1);
+
+    fprintf(stderr, "TEST: bitbuffer:: Search as bit by bit\n");
+    srand(1);
+    unsigned mismatch = 0;
+    for (unsigned n = 0; n < 20000; ++n) {
+        bitbuffer_clear(&bits);
+        unsigned len = rand() % 400;
+        for (unsigned i = 0; i < len; ++i) {
+            bitbuffer_add_bit(&bits, (rand() % 5) != 0); // mostly ones, many close matches
+        }
+        uint8_t pattern[10];
+        unsigned pattern_len = 1 + rand() % 80;
+        for (unsigned k = 0; k < sizeof(pattern); ++k) {
+            pattern[k] = (uint8_t)(rand() % 5 ? 0xff : rand());
+        }
+        if (len && n % 2) {
+            // plant the pattern
+            unsigned pos = rand() % len;
+            for (unsigned i = 0; i < pattern_len && pos + i < BITBUF_COLS * 8; ++i) {
+                unsigned bit = pos + i;
+                bits.bb[0][bit / 8] &= ~(0x80 >> (bit % 8));
+                bits.bb[0][bit / 8] |= bit_at(pattern, i) << (7 - bit % 8);
+            }
+        }
+        unsigned from = len ? rand() % (len + 2) : 0;
+        if (bitbuffer_search(&bits, 0, from, pattern, pattern_len)
+                != bitbuffer_search_bits(bits.bb[0], bits.bits_per_row[0], from, pattern, pattern_len)) {
+            mismatch++;
+        }
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Search speed\n");
+    bitbuffer_clear(&bits);
+    for (int i = 0; i < BITBUF_COLS * 8; ++i) {
+        bitbuffer_add_bit(&bits, (i % 23) != 0);
+    }
+    uint8_t const preamble[] = {0xff, 0xff, 0xfe}; // close matches all along the row
+    unsigned const searches = 1000;
+    unsigned found_bits = 0;
+    unsigned found_words = 0;
+    start = clock();
+    for (unsigned n = 0; n < searches; ++n) {
+        found_bits += bitbuffer_search_bits(bits.bb[0], bits.bits_per_row[0], n % 8, preamble, 24);
+    }
+    mid = clock();
+    for (unsigned n = 0; n < searches; ++n) {
+        found_words += bitbuffer_search(&bits, 0, n % 8, preamble, 24);
+    }
+    stop = clock();
+    fprintf(stderr, "bitbuffer:: search %u bits bit by bit %.1f us, by words %.1f us\n", bits.bits_per_row[0],
+            (double)(mid - start) * 1e6 / CLOCKS_PER_SEC / searches,
+            (double)(stop - mid) * 1e6 / CLOCKS_PER_SEC / searches);
+    ASSERT(found_bits == found_words);
+
+    fprintf(stderr, "TEST: bitbuffer:: Manchester decode as bit by bit\n");
+    bitbuffer_t out_lut = {0};
+    bitbuffer_t out_bits = {0};
+    mismatch = 0;
+    for (unsigned n = 0; n < 20000; ++n) {
+        bitbuffer_clear(&bits);
+        unsigned len = rand() % 600;
+        for (unsigned i = 0; i < len / 2; ++i) {
+            int bit = rand() & 1;
+            int err = rand() % 200 == 0; // a few invalid symbols
+            bitbuffer_add_bit(&bits, bit);
+            bitbuffer_add_bit(&bits, err ? bit : !bit);
+        }
+        // the output might not start empty, or byte aligned, or spill into the next row
+        bitbuffer_clear(&out_lut);
+        bitbuffer_clear(&out_bits);
+        for (unsigned i = n % 16 ? rand() % 12 : BITBUF_COLS * 8 - rand() % 20; i > 0; --i) {
+            bitbuffer_add_bit(&out_lut, 1);
+            bitbuffer_add_bit(&out_bits, 1);
+        }
+        unsigned from = len ? rand() % (len + 1) : 0;
+        unsigned max  = rand() % 3 ? 0 : rand() % 300;
+        unsigned row_len = bits.bits_per_row[0];
+        if (max && row_len > from + max * 2)
+            row_len = from + max * 2;
+        unsigned end_lut, end_bits;
+        if (n % 2) {
+            end_lut  = bitbuffer_manchester_decode(&bits, 0, from, &out_lut, max);
+            end_bits = manchester_decode_bits(bits.bb[0], row_len, from, &out_bits);
+        }
+        else {
+            end_lut  = bitbuffer_differential_manchester_decode(&bits, 0, from, &out_lut, max);
+            end_bits = from;
+            uint8_t last = differential_manchester_clock(bits.bb[0], row_len, &end_bits, &out_bits);
+            end_bits = differential_manchester_decode_bits(bits.bb[0], row_len, end_bits, last, &out_bits);
+        }
+        if (end_lut != end_bits
+                || out_lut.num_rows != out_bits.num_rows
+                || out_lut.bits_per_row[0] != out_bits.bits_per_row[0]
+                || memcmp(out_lut.bb[0], out_bits.bb[0], (out_bits.bits_per_row[0] + 7) / 8)) {
+            mismatch++;
+        }
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Manchester decode speed\n");
+    bitbuffer_clear(&bits);
+    for (int i = 0; i < BITBUF_COLS * 8 / 2; ++i) {
+        int bit = (i % 7) & 1;
+        bitbuffer_add_bit(&bits, bit);
+        bitbuffer_add_bit(&bits, !bit);
+    }
+    unsigned const decodes = 1000;
+    start = clock();
+    for (unsigned n = 0; n < decodes; ++n) {
+        bitbuffer_clear(&out_bits);
+        found_bits = manchester_decode_bits(bits.bb[0], bits.bits_per_row[0], n % 8, &out_bits);
+    }
+    mid = clock();
+    for (unsigned n = 0; n < decodes; ++n) {
+        bitbuffer_clear(&out_lut);
+        found_words = bitbuffer_manchester_decode(&bits, 0, n % 8, &out_lut, 0);
+    }
+    stop = clock();
+    fprintf(stderr, "bitbuffer:: decode %u bits bit by bit %.1f us, by bytes %.1f us\n", bits.bits_per_row[0],
+            (double)(mid - start) * 1e6 / CLOCKS_PER_SEC / decodes,
+            (double)(stop - mid) * 1e6 / CLOCKS_PER_SEC / decodes);
+    ASSERT(found_bits == found_words);
+    ASSERT(out_lut.bits_per_row[0] == out_bits.bits_per_row[0]);
+
+    fprintf(stderr, "TEST: bitbuffer:: Find repeats as by counting\n");
+    mismatch = 0;
+    for (unsigned n = 0; n < 20000; ++n) {
+        bitbuffer_clear(&bits);
+        unsigned rows = 1 + rand() % BITBUF_ROWS;
+        uint8_t kinds[4][8];
+        for (unsigned k = 0; k < sizeof(kinds); ++k) {
+            ((uint8_t *)kinds)[k] = (uint8_t)(rand() % 4 ? 0xa5 : rand()); // rows that differ late
+        }
+        for (unsigned r = 0; r < rows; ++r) {
+            if (r)
+                bitbuffer_add_row(&bits);
+            unsigned kind = rand() % 4;
+            unsigned len  = 40 + rand() % 4 * 8 + (rand() % 8 ? 0 : rand() % 8);
+            for (unsigned i = 0; i < len; ++i) {
+                bitbuffer_add_bit(&bits, i < 64 ? bit_at(kinds[kind], i) : 1);
+            }
+        }
+        unsigned min_repeats = rand() % 8;
+        unsigned min_bits    = rand() % 70;
+        int row_count = -1;
+        int prefix_count = -1;
+        for (int i = bits.num_rows - 1; i >= 0; --i) {
+            if (bits.bits_per_row[i] >= min_bits && bitbuffer_count_repeats(&bits, i, 0) >= min_repeats)
+                row_count = i;
+            if (bits.bits_per_row[i] >= min_bits && bitbuffer_count_repeats(&bits, i, min_bits) >= min_repeats)
+                prefix_count = i;
+        }
+        if (bitbuffer_find_repeated_row(&bits, min_repeats, min_bits) != row_count
+                || bitbuffer_find_repeated_prefix(&bits, min_repeats, min_bits) != prefix_count) {
+            mismatch++;
+        }
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Extract bytes as bit by bit\n");
+    mismatch = 0;
+    for (unsigned n = 0; n < 20000; ++n) {
+        bitbuffer_clear(&bits);
+        unsigned len = rand() % 400;
+        for (unsigned i = 0; i < len; ++i) {
+            bitbuffer_add_bit(&bits, rand() % 2);
+        }
+        unsigned pos  = len ? rand() % len : 0;
+        unsigned size = len - pos;
+        uint8_t want[BITBUF_COLS] = {0};
+        for (unsigned i = 0; i < size; ++i) {
+            want[i / 8] |= bit_at(bits.bb[0], pos + i) << (7 - i % 8);
+        }
+        uint8_t out[BITBUF_COLS] = {0};
+        bitbuffer_extract_bytes(&bits, 0, pos, out, size);
+        mismatch += memcmp(out, want, (size + 7) / 8) != 0;
+        // the row itself as the output
+        bitbuffer_extract_bytes(&bits, 0, pos, bits.bb[0], size);
+        mismatch += memcmp(bits.bb[0], want, (size + 7) / 8) != 0;
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Transform words as bytes\n");
+    mismatch = 0;
+    for (unsigned n = 0; n < 5000; ++n) {
+        bitbuffer_clear(&bits);
+        unsigned rows = 1 + rand() % 4;
+        for (unsigned r = 0; r < rows; ++r) {
+            if (r)
+                bitbuffer_add_row(&bits);
+            unsigned len = rand() % 300;
+            for (unsigned i = 0; i < len; ++i) {
+                bitbuffer_add_bit(&bits, rand() % 2);
+            }
+        }
+        unsigned transform = 1 + n % (BITBUFFER_TRANSFORMS - 1);
+        bitbuffer_t want = bits;
+        for (unsigned r = 0; r < want.num_rows; ++r) {
+            unsigned len = want.bits_per_row[r];
+            if (!len)
+                continue;
+            uint8_t *b      = want.bb[r];
+            unsigned last   = (len - 1) / 8;
+            unsigned unused = 7 - (len - 1) % 8;
+            int prev        = 0;
+            for (unsigned col = 0; col <= last; ++col) {
+                int mask = (prev << 7) | b[col] >> 1;
+                prev     = b[col];
+                uint8_t reflected = 0;
+                for (unsigned k = 0; k < 8; ++k) {
+                    unsigned to = transform == BITBUFFER_REFLECTED ? 7 - k : (k & 4) | (3 - (k & 3));
+                    reflected |= (b[col] >> k & 1) << to;
+                }
+                b[col] = transform == BITBUFFER_INVERTED ? ~b[col]
+                        : transform == BITBUFFER_NRZS    ? b[col] ^ ~mask
+                        : transform == BITBUFFER_NRZM    ? b[col] ^ mask
+                                                         : reflected;
+            }
+            if (transform == BITBUFFER_INVERTED)
+                b[last] ^= (1 << unused) - 1;
+            else if (transform == BITBUFFER_NRZS || transform == BITBUFFER_NRZM)
+                b[last] &= 0xFF << unused;
+        }
+        bitbuffer_transform(&bits, transform);
+        mismatch += memcmp(&bits, &want, sizeof(bits)) != 0;
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Add runs as bit by bit\n");
+    mismatch = 0;
+    static bitbuffer_t runs;
+    for (unsigned n = 0; n < 2000; ++n) {
+        bitbuffer_clear(&bits);
+        bitbuffer_clear(&runs);
+        // runs spill into the next rows, a few long ones reach the limits
+        unsigned max_run = n % 100 == 0 ? 3000 : n % 2 ? 40 : 300;
+        for (unsigned k = 0; k < 200; ++k) {
+            if (rand() % 50 == 0) {
+                bitbuffer_add_row(&bits);
+                bitbuffer_add_row(&runs);
+            }
+            int bit      = rand() % 2;
+            unsigned len = rand() % max_run;
+            for (unsigned i = 0; i < len; ++i) {
+                bitbuffer_add_bit(&bits, bit);
+            }
+            bitbuffer_add_bits_run(&runs, bit, len);
+        }
+        mismatch += memcmp(&runs, &bits, sizeof(bits)) != 0;
+    }
+    ASSERT(mismatch == 0);
+
+    fprintf(stderr, "TEST: bitbuffer:: Add runs speed\n");
+    start = clock();
+    for (unsigned n = 0; n < 2000; ++n) {
+        bitbuffer_clear(&bits);
+        for (unsigned i = 0; i < 400; ++i) {
+            for (unsigned k = 0; k < 1 + i % 3; ++k) {
+                bitbuffer_add_bit(&bits, i & 1);
+            }
+        }
+    }
+    double bit_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / 2000;
+    start = clock();
+    for (unsigned n = 0; n < 2000; ++n) {
+        bitbuffer_clear(&runs);
+        for (unsigned i = 0; i < 400; ++i) {
+            bitbuffer_add_bits_run(&runs, i & 1, 1 + i % 3);
+        }
+    }
+    double run_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / 2000;
+    fprintf(stderr, "bitbuffer:: add %u bits in 400 runs bit by bit %.1f ns, by runs %.1f ns\n", bits.bits_per_row[0],
+            bit_ns, run_ns);
+    ASSERT(memcmp(&runs, &bits, sizeof(bits)) == 0);
+
     fprintf(stderr, "bitbuffer:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
 
     return failed > 0 ? 1 : 0;
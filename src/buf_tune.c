@@ -0,0 +1,156 @@
+/** @file
+    Tuning of the SDR transfer count and size from the measured callback timing.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "buf_tune.h"
+
+#include "latency_hist.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+
+/// Shortest transfer in us, the per transfer overhead dominates below.
+#define BUF_TUNE_MIN_US 4000
+/// Fewest transfers, the driver needs some queued while one is handed over.
+#define BUF_TUNE_MIN_NUM 4
+/// Shortest ring of transfers in us, more transfers add no latency, only memory.
+#define BUF_TUNE_MIN_RING_US 250000
+/// Over this mean load the transfers are not shortened, the overhead would add to it.
+#define BUF_TUNE_LOAD_HIGH 0.5
+
+struct buf_tune {
+    uint64_t window_ns;
+    uint64_t measured_ns; ///< signal time measured so far
+    uint64_t busy_ns;     ///< processing time so far
+    int64_t last_publish_ns;
+    int done;
+    unsigned lost;
+    latency_hist_t jitter;
+    latency_hist_t busy;
+    latency_hist_t wait;
+    uint32_t buf_num;
+    uint32_t buf_len;
+};
+
+buf_tune_t *buf_tune_create(uint64_t window_ns)
+{
+    buf_tune_t *tune = calloc(1, sizeof(*tune));
+    if (!tune) {
+        WARN_CALLOC("buf_tune_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    tune->window_ns = window_ns;
+    return tune;
+}
+
+void buf_tune_free(buf_tune_t *tune)
+{
+    free(tune);
+}
+
+int buf_tune_buffer(buf_tune_t *tune, int64_t publish_ns, uint64_t wait_ns, uint64_t busy_ns, uint64_t duration_ns, unsigned lost)
+{
+    if (tune->done)
+        return 0;
+
+    // a handover later than the signal time of the buffer since the last one is jitter
+    if (publish_ns && tune->last_publish_ns && !lost)
+        latency_hist_add(&tune->jitter, (publish_ns - tune->last_publish_ns - (int64_t)duration_ns) / 1000);
+    tune->last_publish_ns = publish_ns;
+    if (publish_ns)
+        latency_hist_add(&tune->wait, (int64_t)(wait_ns / 1000));
+    latency_hist_add(&tune->busy, (int64_t)(busy_ns / 1000));
+    tune->lost += lost;
+    tune->busy_ns += busy_ns;
+    tune->measured_ns += duration_ns;
+
+    if (tune->measured_ns < tune->window_ns)
+        return 0;
+    tune->done = 1;
+    return 1;
+}
+
+int buf_tune_choose(buf_tune_t *tune, uint32_t bytes_per_s, uint32_t buf_len, uint64_t max_bytes, uint32_t max_num)
+{
+    if (!tune->measured_ns || !bytes_per_s)
+        return -1;
+
+    // the shortest transfer over twice the jitter
+    uint64_t cur_us  = (uint64_t)buf_len * 1000000 / bytes_per_s;
+    uint64_t want_us = 2 * (uint64_t)latency_hist_percentile(&tune->jitter, 99);
+    if (want_us < BUF_TUNE_MIN_US)
+        want_us = BUF_TUNE_MIN_US;
+    if ((double)tune->busy_ns / tune->measured_ns > BUF_TUNE_LOAD_HIGH && want_us < cur_us)
+        want_us = cur_us;
+    if (tune->lost && want_us < 2 * cur_us)
+        want_us = 2 * cur_us;
+
+    uint64_t len     = (want_us * bytes_per_s / 1000000 + BUF_TUNE_LEN_STEP - 1) / BUF_TUNE_LEN_STEP * BUF_TUNE_LEN_STEP;
+    uint64_t max_len = max_bytes / BUF_TUNE_MIN_NUM / BUF_TUNE_LEN_STEP * BUF_TUNE_LEN_STEP;
+    if (len > max_len)
+        len = max_len;
+    if (len < BUF_TUNE_LEN_STEP)
+        len = BUF_TUNE_LEN_STEP;
+    uint64_t len_us = len * 1000000 / bytes_per_s;
+    if (!len_us)
+        len_us = 1;
+
+    // enough transfers to bridge twice the longest stall, and the one being handed over
+    uint64_t stall_us = tune->jitter.max_us;
+    if (tune->busy.max_us > stall_us)
+        stall_us = tune->busy.max_us;
+    if (tune->wait.max_us > stall_us)
+        stall_us = tune->wait.max_us;
+    if (2 * stall_us < BUF_TUNE_MIN_RING_US)
+        stall_us = BUF_TUNE_MIN_RING_US / 2;
+    uint64_t num = (2 * stall_us + len_us - 1) / len_us + 2;
+    if (num < BUF_TUNE_MIN_NUM)
+        num = BUF_TUNE_MIN_NUM;
+    if (num > max_bytes / len)
+        num = max_bytes / len;
+    if (num > max_num)
+        num = max_num;
+    if (!num)
+        num = 1;
+
+    tune->buf_len = (uint32_t)len;
+    tune->buf_num = (uint32_t)num;
+    return 0;
+}
+
+uint32_t buf_tune_buf_num(buf_tune_t const *tune)
+{
+    return tune->buf_num;
+}
+
+uint32_t buf_tune_buf_len(buf_tune_t const *tune)
+{
+    return tune->buf_len;
+}
+
+unsigned buf_tune_jitter_us(buf_tune_t const *tune, unsigned pct)
+{
+    return latency_hist_percentile(&tune->jitter, pct);
+}
+
+unsigned buf_tune_busy_us(buf_tune_t const *tune, unsigned pct)
+{
+    return latency_hist_percentile(&tune->busy, pct);
+}
+
+unsigned buf_tune_wait_us(buf_tune_t const *tune, unsigned pct)
+{
+    return latency_hist_percentile(&tune->wait, pct);
+}
+
+unsigned buf_tune_lost(buf_tune_t const *tune)
+{
+    return tune->lost;
+}
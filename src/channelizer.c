@@ -0,0 +1,325 @@
+/** @file
+    Polyphase channelizer, splits a wide capture into decimated sub-channels.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "channelizer.h"
+
+#include "channelizer_cl.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// Prototype filter taps per polyphase branch, the transition band is about 0.3 channel spacings.
+#define CHANNELIZER_TAPS_PER_BRANCH 12
+
+struct channelizer {
+    unsigned channels;   ///< number of channels N
+    unsigned decimation; ///< input samples per output sample, N/2
+    unsigned taps;       ///< prototype filter length, a multiple of N
+    float *coeffs;       ///< prototype low pass filter
+    float *twiddle;      ///< e^(j 2 pi i / N), interleaved I/Q
+    float *hist;         ///< input history written twice so the filter window is contiguous, interleaved I/Q
+    unsigned hist_pos;   ///< next write position in the history
+    unsigned phase;      ///< input samples since the last output sample
+    unsigned out_parity; ///< parity of the output sample index, for the (-1)^(k m) mixing term
+    uint32_t out_size;   ///< capacity of each output buffer in samples
+    int16_t *out[CHANNELIZER_MAX_CHANNELS];
+    channelizer_cl_t *cl; ///< the GPU backend, NULL to channelize on the CPU
+    uint8_t *ext;         ///< raw input of the GPU, the last taps - 1 samples followed by the new samples
+    size_t ext_size;      ///< capacity of the raw input in bytes
+    int ext_sample_size;  ///< sample size of the raw input, 0 to clear the history
+    uint32_t ext_valid;   ///< index of the first sample in the raw input, the history before it is zero
+    int16_t *gpu_out;      ///< the outputs of the GPU, channel after channel
+    uint32_t gpu_out_len;  ///< samples of each channel in the GPU outputs
+    uint32_t gpu_out_size; ///< capacity of the GPU outputs in samples of each channel
+};
+
+channelizer_t *channelizer_create(unsigned channels)
+{
+    if (channels < 2 || channels > CHANNELIZER_MAX_CHANNELS || channels % 2) {
+        return NULL;
+    }
+
+    channelizer_t *ch = calloc(1, sizeof(*ch));
+    if (!ch) {
+        WARN_CALLOC("channelizer_create()");
+        return NULL;
+    }
+    ch->channels   = channels;
+    ch->decimation = channels / 2;
+    ch->taps       = channels * CHANNELIZER_TAPS_PER_BRANCH;
+
+    ch->coeffs = calloc(ch->taps, sizeof(*ch->coeffs));
+    if (!ch->coeffs) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(ch);
+        return NULL;
+    }
+    ch->twiddle = calloc(2 * channels, sizeof(*ch->twiddle));
+    if (!ch->twiddle) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(ch);
+        return NULL;
+    }
+    ch->hist = calloc(4 * ch->taps, sizeof(*ch->hist));
+    if (!ch->hist) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(ch);
+        return NULL;
+    }
+
+    // Hamming windowed sinc, cutoff at half the channel spacing, unity gain
+    double sum = 0.0;
+    for (unsigned t = 0; t < ch->taps; ++t) {
+        double x = t - (ch->taps - 1) / 2.0;
+        double sinc = x == 0.0 ? 1.0 : sin(M_PI * x / channels) / (M_PI * x / channels);
+        double window = 0.54 - 0.46 * cos(2.0 * M_PI * t / (ch->taps - 1));
+        ch->coeffs[t] = (float)(sinc * window);
+        sum += ch->coeffs[t];
+    }
+    for (unsigned t = 0; t < ch->taps; ++t) {
+        ch->coeffs[t] = (float)(ch->coeffs[t] / sum);
+    }
+
+    for (unsigned i = 0; i < channels; ++i) {
+        ch->twiddle[2 * i]     = (float)cos(2.0 * M_PI * i / channels);
+        ch->twiddle[2 * i + 1] = (float)sin(2.0 * M_PI * i / channels);
+    }
+
+    return ch;
+}
+
+void channelizer_free(channelizer_t *ch)
+{
+    if (!ch)
+        return;
+
+    for (unsigned k = 0; k < ch->channels; ++k) {
+        free(ch->out[k]);
+    }
+    channelizer_cl_free(ch->cl);
+    free(ch->ext);
+    free(ch->gpu_out);
+    free(ch->coeffs);
+    free(ch->twiddle);
+    free(ch->hist);
+    free(ch);
+}
+
+void channelizer_reset(channelizer_t *ch)
+{
+    memset(ch->hist, 0, 4 * ch->taps * sizeof(*ch->hist));
+    ch->hist_pos        = 0;
+    ch->phase           = 0;
+    ch->out_parity      = 0;
+    ch->ext_sample_size = 0;
+}
+
+int channelizer_use_gpu(channelizer_t *ch)
+{
+    if (!ch->cl)
+        ch->cl = channelizer_cl_create(ch->channels, ch->taps, ch->coeffs);
+    if (!ch->cl)
+        return -1;
+    print_logf(LOG_NOTICE, "Input", "Channelizing on the GPU \"%s\".", channelizer_cl_device(ch->cl));
+    return 0;
+}
+
+int channelizer_offset(channelizer_t const *ch, unsigned channel, uint32_t samp_rate)
+{
+    int k = channel < ch->channels / 2 ? (int)channel : (int)channel - (int)ch->channels;
+    return (int)((int64_t)k * samp_rate / ch->channels);
+}
+
+uint32_t channelizer_rate(channelizer_t const *ch, uint32_t samp_rate)
+{
+    return samp_rate / ch->decimation;
+}
+
+int16_t *channelizer_output(channelizer_t *ch, unsigned channel)
+{
+    if (ch->cl)
+        return ch->gpu_out + (size_t)2 * ch->gpu_out_len * channel;
+    return ch->out[channel];
+}
+
+static int16_t clamp_s16(float v)
+{
+    if (v > INT16_MAX)
+        return INT16_MAX;
+    if (v < -INT16_MAX)
+        return -INT16_MAX;
+    return (int16_t)lrintf(v);
+}
+
+// Compute one output sample for all channels, x points to the newest input sample
+static void channelizer_output_sample(channelizer_t *ch, float const *x, unsigned idx)
+{
+    unsigned const n = ch->channels;
+    float v[2 * CHANNELIZER_MAX_CHANNELS] = {0};
+
+    // polyphase branches: v[r] = sum_p h[r + p N] x[-(r + p N)]
+    for (unsigned t = 0; t < ch->taps; t += n) {
+        float const *h  = &ch->coeffs[t];
+        float const *xt = x - 2 * t;
+        for (unsigned r = 0; r < n; ++r) {
+            v[2 * r]     += h[r] * xt[-2 * (int)r];
+            v[2 * r + 1] += h[r] * xt[-2 * (int)r + 1];
+        }
+    }
+
+    // inverse DFT over the branches mixes each channel down to baseband
+    for (unsigned k = 0; k < n; ++k) {
+        float yr = 0.0f;
+        float yi = 0.0f;
+        for (unsigned r = 0; r < n; ++r) {
+            float const *w = &ch->twiddle[2 * ((k * r) % n)];
+            yr += v[2 * r] * w[0] - v[2 * r + 1] * w[1];
+            yi += v[2 * r] * w[1] + v[2 * r + 1] * w[0];
+        }
+        // decimating by N/2 leaves a mixing term of (-1)^(k m)
+        if (k & ch->out_parity) {
+            yr = -yr;
+            yi = -yi;
+        }
+        ch->out[k][2 * idx]     = clamp_s16(yr);
+        ch->out[k][2 * idx + 1] = clamp_s16(yi);
+    }
+    ch->out_parity ^= 1;
+}
+
+static void hist_push(channelizer_t *ch, float si, float sq)
+{
+    unsigned const taps = ch->taps;
+    unsigned pos = ch->hist_pos;
+    ch->hist[2 * pos]              = si;
+    ch->hist[2 * pos + 1]          = sq;
+    ch->hist[2 * (pos + taps)]     = si;
+    ch->hist[2 * (pos + taps) + 1] = sq;
+    ch->hist_pos = pos + 1 < taps ? pos + 1 : 0;
+}
+
+// the GPU failed, continue on the CPU with the history of the raw input
+static void gpu_fallback(channelizer_t *ch)
+{
+    print_log(LOG_WARNING, "Input", "Channelizing on the CPU from now on.");
+    channelizer_cl_free(ch->cl);
+    ch->cl = NULL;
+
+    memset(ch->hist, 0, 4 * ch->taps * sizeof(*ch->hist));
+    ch->hist_pos = 0;
+    uint8_t const *cu8_buf  = ch->ext;
+    int16_t const *cs16_buf = (int16_t const *)ch->ext;
+    for (unsigned i = 0; ch->ext_sample_size && i < ch->taps - 1; ++i) {
+        if (i < ch->ext_valid)
+            hist_push(ch, 0.0f, 0.0f);
+        else if (ch->ext_sample_size == 2)
+            hist_push(ch, (cu8_buf[2 * i] - 127.5f) * 256.0f, (cu8_buf[2 * i + 1] - 127.5f) * 256.0f);
+        else
+            hist_push(ch, cs16_buf[2 * i], cs16_buf[2 * i + 1]);
+    }
+}
+
+// a whole buffer is one batch on the GPU, returns the number of output samples or -1 on failure
+static int channelizer_process_gpu(channelizer_t *ch, void const *iq_buf, int sample_size, uint32_t len)
+{
+    unsigned const hist_len = ch->taps - 1;
+    size_t need = ((size_t)hist_len + len) * sample_size;
+    if (need > ch->ext_size) {
+        uint8_t *ext = realloc(ch->ext, need);
+        if (!ext) {
+            WARN_REALLOC("channelizer_process()");
+            return -1;
+        }
+        ch->ext      = ext;
+        ch->ext_size = need;
+    }
+    if (ch->ext_sample_size != sample_size) {
+        ch->ext_sample_size = sample_size;
+        ch->ext_valid       = hist_len;
+    }
+    memcpy(ch->ext + (size_t)hist_len * sample_size, iq_buf, (size_t)len * sample_size);
+
+    uint32_t n_out = (ch->phase + len) / ch->decimation;
+    if (n_out > ch->gpu_out_size) {
+        int16_t *out = realloc(ch->gpu_out, (size_t)n_out * ch->channels * 2 * sizeof(*out));
+        if (!out) {
+            WARN_REALLOC("channelizer_process()");
+            return -1;
+        }
+        ch->gpu_out      = out;
+        ch->gpu_out_size = n_out;
+    }
+    // the newest input sample of the first output sample
+    uint32_t first = hist_len + ch->decimation - ch->phase - 1;
+    if (channelizer_cl_process(ch->cl, ch->ext, hist_len + len, sample_size, ch->ext_valid, first, ch->decimation, n_out, ch->out_parity, ch->gpu_out) < 0)
+        return -1;
+    ch->ext_valid   = ch->ext_valid > len ? ch->ext_valid - len : 0;
+    ch->gpu_out_len = n_out;
+    ch->phase       = (ch->phase + len) % ch->decimation;
+    ch->out_parity ^= n_out & 1;
+    memmove(ch->ext, ch->ext + (size_t)len * sample_size, (size_t)hist_len * sample_size);
+    return (int)n_out;
+}
+
+int channelizer_process(channelizer_t *ch, void const *iq_buf, int sample_size, uint32_t len)
+{
+    if (ch->cl) {
+        int n_out = channelizer_process_gpu(ch, iq_buf, sample_size, len);
+        if (n_out >= 0)
+            return n_out;
+        gpu_fallback(ch);
+    }
+
+    uint32_t need = (ch->phase + len) / ch->decimation;
+    if (need > ch->out_size) {
+        for (unsigned k = 0; k < ch->channels; ++k) {
+            int16_t *out = realloc(ch->out[k], need * 2 * sizeof(*out));
+            if (!out) {
+                WARN_REALLOC("channelizer_process()");
+                return -1;
+            }
+            ch->out[k] = out;
+        }
+        ch->out_size = need;
+    }
+
+    unsigned const taps = ch->taps;
+    uint8_t const *cu8_buf  = iq_buf;
+    int16_t const *cs16_buf = iq_buf;
+    unsigned n_out = 0;
+    for (uint32_t i = 0; i < len; ++i) {
+        float si, sq;
+        if (sample_size == 2) {
+            si = (cu8_buf[2 * i] - 127.5f) * 256.0f; // scale Q0.7 to Q0.15
+            sq = (cu8_buf[2 * i + 1] - 127.5f) * 256.0f;
+        }
+        else {
+            si = cs16_buf[2 * i];
+            sq = cs16_buf[2 * i + 1];
+        }
+        unsigned pos = ch->hist_pos;
+        hist_push(ch, si, sq);
+
+        if (++ch->phase == ch->decimation) {
+            ch->phase = 0;
+            channelizer_output_sample(ch, &ch->hist[2 * (pos + taps)], n_out++);
+        }
+    }
+
+    return n_out;
+}
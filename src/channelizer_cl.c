@@ -0,0 +1,323 @@
+/** @file
+    OpenCL backend of the polyphase channelizer.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "channelizer_cl.h"
+
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#ifdef OPENCL
+
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// the same math as the CPU channelizer, the outputs match up to the rounding of the sums
+static char const *const kernel_source =
+        "float2 load_sample(__global const uchar *raw, int sample_size, uint valid, uint i)\n"
+        "{\n"
+        "    if (i < valid)\n"
+        "        return (float2)(0.0f, 0.0f);\n"
+        "    if (sample_size == 2)\n"
+        "        return (float2)((raw[2 * i] - 127.5f) * 256.0f, (raw[2 * i + 1] - 127.5f) * 256.0f);\n"
+        "    __global const short *s = (__global const short *)raw;\n"
+        "    return (float2)(s[2 * i], s[2 * i + 1]);\n"
+        "}\n"
+        "\n"
+        "// v[m][r] = sum_p h[r + p N] x[newest - (r + p N)]\n"
+        "__kernel void polyphase(__global const uchar *raw, int sample_size, uint valid, uint first, uint decimation,\n"
+        "        uint channels, uint taps, __constant float *coeffs, __global float2 *branches)\n"
+        "{\n"
+        "    uint m = get_global_id(0);\n"
+        "    uint r = get_global_id(1);\n"
+        "    uint newest = first + m * decimation;\n"
+        "    float2 acc = (float2)(0.0f, 0.0f);\n"
+        "    for (uint t = 0; t < taps; t += channels)\n"
+        "        acc += coeffs[t + r] * load_sample(raw, sample_size, valid, newest - (t + r));\n"
+        "    branches[m * channels + r] = acc;\n"
+        "}\n"
+        "\n"
+        "// y[m][k] = sum_r v[m][r] e^(j 2 pi k r / N), with the (-1)^(k m) mixing term of the decimation\n"
+        "__kernel void idft(__global const float2 *branches, uint channels, uint parity, uint n_out,\n"
+        "        __constant float2 *twiddle, __global short2 *out)\n"
+        "{\n"
+        "    uint m = get_global_id(0);\n"
+        "    uint k = get_global_id(1);\n"
+        "    float2 y = (float2)(0.0f, 0.0f);\n"
+        "    for (uint r = 0; r < channels; ++r) {\n"
+        "        float2 v = branches[m * channels + r];\n"
+        "        float2 w = twiddle[(k * r) % channels];\n"
+        "        y += (float2)(v.x * w.x - v.y * w.y, v.x * w.y + v.y * w.x);\n"
+        "    }\n"
+        "    if (k & (parity + m) & 1)\n"
+        "        y = -y;\n"
+        "    out[k * n_out + m] = convert_short2_rte(clamp(y, -32767.0f, 32767.0f));\n"
+        "}\n";
+
+struct channelizer_cl {
+    unsigned channels;
+    unsigned taps;
+    char device_name[128];
+    cl_context context;
+    cl_command_queue queue;
+    cl_program program;
+    cl_kernel polyphase;
+    cl_kernel idft;
+    cl_mem coeffs;
+    cl_mem twiddle;
+    cl_mem raw;      ///< input samples, grown as needed
+    size_t raw_size;
+    cl_mem branches; ///< polyphase branch outputs
+    size_t branches_size;
+    cl_mem out;      ///< channel outputs
+    size_t out_size;
+};
+
+// the first GPU of any platform, a CPU device is no faster than the CPU channelizer
+static cl_device_id find_gpu(void)
+{
+    cl_platform_id platforms[8];
+    cl_uint num_platforms = 0;
+    if (clGetPlatformIDs(8, platforms, &num_platforms) != CL_SUCCESS)
+        return NULL;
+    for (cl_uint i = 0; i < num_platforms && i < 8; ++i) {
+        cl_device_id device;
+        cl_uint num_devices = 0;
+        if (clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_GPU, 1, &device, &num_devices) == CL_SUCCESS && num_devices)
+            return device;
+    }
+    return NULL;
+}
+
+// grow a device buffer, the contents are not kept
+static int ensure_buffer(channelizer_cl_t *cl, cl_mem *mem, size_t *size, size_t need, cl_mem_flags flags)
+{
+    if (*size >= need)
+        return 0;
+    if (*mem)
+        clReleaseMemObject(*mem);
+    cl_int err;
+    *mem = clCreateBuffer(cl->context, flags, need, NULL, &err);
+    if (err != CL_SUCCESS) {
+        *mem  = NULL;
+        *size = 0;
+        print_logf(LOG_WARNING, "OpenCL", "Failed to allocate %zu bytes on the device (%d)", need, err);
+        return -1;
+    }
+    *size = need;
+    return 0;
+}
+
+channelizer_cl_t *channelizer_cl_create(unsigned channels, unsigned taps, float const *coeffs)
+{
+    cl_device_id device = find_gpu();
+    if (!device)
+        return NULL;
+
+    channelizer_cl_t *cl = calloc(1, sizeof(*cl));
+    if (!cl) {
+        WARN_CALLOC("channelizer_cl_create()");
+        return NULL; // NOTE: falls back to the CPU on alloc failure.
+    }
+    cl->channels = channels;
+    cl->taps     = taps;
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(cl->device_name) - 1, cl->device_name, NULL);
+
+    cl_int err;
+    cl->context = clCreateContext(NULL, 1, &device, NULL, NULL, &err);
+    if (err != CL_SUCCESS) {
+        cl->context = NULL;
+        goto fail;
+    }
+    cl->queue = clCreateCommandQueue(cl->context, device, 0, &err);
+    if (err != CL_SUCCESS) {
+        cl->queue = NULL;
+        goto fail;
+    }
+    char const *source = kernel_source;
+    cl->program = clCreateProgramWithSource(cl->context, 1, &source, NULL, &err);
+    if (err != CL_SUCCESS) {
+        cl->program = NULL;
+        goto fail;
+    }
+    err = clBuildProgram(cl->program, 1, &device, "-cl-denorms-are-zero", NULL, NULL);
+    if (err != CL_SUCCESS) {
+        char build_log[1024] = {0};
+        clGetProgramBuildInfo(cl->program, device, CL_PROGRAM_BUILD_LOG, sizeof(build_log) - 1, build_log, NULL);
+        print_logf(LOG_WARNING, "OpenCL", "Failed to build the channelizer kernels: %s", build_log);
+        goto fail;
+    }
+    cl->polyphase = clCreateKernel(cl->program, "polyphase", &err);
+    if (err != CL_SUCCESS) {
+        cl->polyphase = NULL;
+        goto fail;
+    }
+    cl->idft = clCreateKernel(cl->program, "idft", &err);
+    if (err != CL_SUCCESS) {
+        cl->idft = NULL;
+        goto fail;
+    }
+
+    cl->coeffs = clCreateBuffer(cl->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, taps * sizeof(float), (void *)coeffs, &err);
+    if (err != CL_SUCCESS) {
+        cl->coeffs = NULL;
+        goto fail;
+    }
+    float *twiddle = malloc(2 * channels * sizeof(*twiddle));
+    if (!twiddle) {
+        WARN_MALLOC("channelizer_cl_create()");
+        goto fail;
+    }
+    for (unsigned i = 0; i < channels; ++i) {
+        twiddle[2 * i]     = (float)cos(2.0 * M_PI * i / channels);
+        twiddle[2 * i + 1] = (float)sin(2.0 * M_PI * i / channels);
+    }
+    cl->twiddle = clCreateBuffer(cl->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, 2 * channels * sizeof(*twiddle), twiddle, &err);
+    free(twiddle);
+    if (err != CL_SUCCESS) {
+        cl->twiddle = NULL;
+        goto fail;
+    }
+    return cl;
+
+fail:
+    print_logf(LOG_WARNING, "OpenCL", "Failed to set up the channelizer on \"%s\"", cl->device_name);
+    channelizer_cl_free(cl);
+    return NULL;
+}
+
+void channelizer_cl_free(channelizer_cl_t *cl)
+{
+    if (!cl)
+        return;
+
+    cl_mem mems[] = {cl->coeffs, cl->twiddle, cl->raw, cl->branches, cl->out};
+    for (size_t i = 0; i < sizeof(mems) / sizeof(*mems); ++i) {
+        if (mems[i])
+            clReleaseMemObject(mems[i]);
+    }
+    if (cl->polyphase)
+        clReleaseKernel(cl->polyphase);
+    if (cl->idft)
+        clReleaseKernel(cl->idft);
+    if (cl->program)
+        clReleaseProgram(cl->program);
+    if (cl->queue)
+        clReleaseCommandQueue(cl->queue);
+    if (cl->context)
+        clReleaseContext(cl->context);
+    free(cl);
+}
+
+char const *channelizer_cl_device(channelizer_cl_t const *cl)
+{
+    return cl->device_name;
+}
+
+int channelizer_cl_process(channelizer_cl_t *cl, void const *ext, uint32_t ext_len, int sample_size, uint32_t valid,
+        uint32_t first, unsigned decimation, uint32_t n_out, unsigned parity, int16_t *out)
+{
+    if (!n_out)
+        return 0;
+
+    size_t raw_bytes = (size_t)ext_len * sample_size;
+    size_t out_bytes = (size_t)n_out * cl->channels * 2 * sizeof(*out);
+    if (ensure_buffer(cl, &cl->raw, &cl->raw_size, raw_bytes, CL_MEM_READ_ONLY)
+            || ensure_buffer(cl, &cl->branches, &cl->branches_size, (size_t)n_out * cl->channels * 2 * sizeof(float), CL_MEM_READ_WRITE)
+            || ensure_buffer(cl, &cl->out, &cl->out_size, out_bytes, CL_MEM_WRITE_ONLY))
+        return -1;
+
+    cl_int err = clEnqueueWriteBuffer(cl->queue, cl->raw, CL_FALSE, 0, raw_bytes, ext, 0, NULL, NULL);
+
+    cl_int ss      = sample_size;
+    cl_uint valid_ = valid;
+    cl_uint first_ = first;
+    cl_uint dec    = decimation;
+    cl_uint chans  = cl->channels;
+    cl_uint taps   = cl->taps;
+    cl_uint par    = parity;
+    cl_uint count  = n_out;
+    err |= clSetKernelArg(cl->polyphase, 0, sizeof(cl_mem), &cl->raw);
+    err |= clSetKernelArg(cl->polyphase, 1, sizeof(ss), &ss);
+    err |= clSetKernelArg(cl->polyphase, 2, sizeof(valid_), &valid_);
+    err |= clSetKernelArg(cl->polyphase, 3, sizeof(first_), &first_);
+    err |= clSetKernelArg(cl->polyphase, 4, sizeof(dec), &dec);
+    err |= clSetKernelArg(cl->polyphase, 5, sizeof(chans), &chans);
+    err |= clSetKernelArg(cl->polyphase, 6, sizeof(taps), &taps);
+    err |= clSetKernelArg(cl->polyphase, 7, sizeof(cl_mem), &cl->coeffs);
+    err |= clSetKernelArg(cl->polyphase, 8, sizeof(cl_mem), &cl->branches);
+    err |= clSetKernelArg(cl->idft, 0, sizeof(cl_mem), &cl->branches);
+    err |= clSetKernelArg(cl->idft, 1, sizeof(chans), &chans);
+    err |= clSetKernelArg(cl->idft, 2, sizeof(par), &par);
+    err |= clSetKernelArg(cl->idft, 3, sizeof(count), &count);
+    err |= clSetKernelArg(cl->idft, 4, sizeof(cl_mem), &cl->twiddle);
+    err |= clSetKernelArg(cl->idft, 5, sizeof(cl_mem), &cl->out);
+
+    size_t global[2] = {n_out, cl->channels};
+    err |= clEnqueueNDRangeKernel(cl->queue, cl->polyphase, 2, NULL, global, NULL, 0, NULL, NULL);
+    err |= clEnqueueNDRangeKernel(cl->queue, cl->idft, 2, NULL, global, NULL, 0, NULL, NULL);
+    err |= clEnqueueReadBuffer(cl->queue, cl->out, CL_TRUE, 0, out_bytes, out, 0, NULL, NULL);
+    if (err != CL_SUCCESS) {
+        print_logf(LOG_WARNING, "OpenCL", "The channelizer failed on \"%s\"", cl->device_name);
+        return -1;
+    }
+    return 0;
+}
+
+#else /* no OpenCL support */
+
+channelizer_cl_t *channelizer_cl_create(unsigned channels, unsigned taps, float const *coeffs)
+{
+    (void)channels;
+    (void)taps;
+    (void)coeffs;
+    return NULL;
+}
+
+void channelizer_cl_free(channelizer_cl_t *cl)
+{
+    (void)cl;
+}
+
+char const *channelizer_cl_device(channelizer_cl_t const *cl)
+{
+    (void)cl;
+    return "";
+}
+
+int channelizer_cl_process(channelizer_cl_t *cl, void const *ext, uint32_t ext_len, int sample_size, uint32_t valid,
+        uint32_t first, unsigned decimation, uint32_t n_out, unsigned parity, int16_t *out)
+{
+    (void)cl;
+    (void)ext;
+    (void)ext_len;
+    (void)sample_size;
+    (void)valid;
+    (void)first;
+    (void)decimation;
+    (void)n_out;
+    (void)parity;
+    (void)out;
+    return -1;
+}
+
+#endif
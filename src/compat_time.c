@@ -33,6 +33,31 @@ int gettimeofday(struct timeval *tv, void *tz)
     return 0;
 }
 
+uint64_t time_monotonic_ns(void)
+{
+    static LARGE_INTEGER freq;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    // split to avoid the overflow of count * 1e9
+    uint64_t secs = count.QuadPart / freq.QuadPart;
+    uint64_t rest = count.QuadPart % freq.QuadPart;
+    return secs * 1000000000ULL + rest * 1000000000ULL / freq.QuadPart;
+}
+
+#else // _WIN32
+
+#include <time.h>
+
+uint64_t time_monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 #endif // _WIN32
 
 int timeval_subtract(struct timeval *result, struct timeval const *x, struct timeval const *y)
@@ -0,0 +1,615 @@
+/** @file
+    Sample format conversion kernels for the dumpers and the file reader.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "convert.h"
+
+#include "compat_atomic.h"
+
+#include <string.h>
+
+/* Scalar reference kernels, the tails convert from value i on */
+
+static void cu8_to_cs16_tail(uint8_t const *src, int16_t *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = (src[i] * 256) - 32768;
+    }
+}
+
+static void cu8_to_cs16_scalar(uint8_t const *src, int16_t *dst, unsigned long len)
+{
+    cu8_to_cs16_tail(src, dst, 0, len);
+}
+
+static void cs16_to_cu8_tail(int16_t const *src, uint8_t *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = (src[i] / 256) + 128;
+    }
+}
+
+static void cs16_to_cu8_scalar(int16_t const *src, uint8_t *dst, unsigned long len)
+{
+    cs16_to_cu8_tail(src, dst, 0, len);
+}
+
+static void cu8_cs8_tail(uint8_t const *src, uint8_t *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = src[i] ^ 0x80;
+    }
+}
+
+static void cu8_cs8_scalar(uint8_t const *src, uint8_t *dst, unsigned long len)
+{
+    cu8_cs8_tail(src, dst, 0, len);
+}
+
+static void cs16_to_cs8_tail(int16_t const *src, int8_t *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = src[i] >> 8;
+    }
+}
+
+static void cs16_to_cs8_scalar(int16_t const *src, int8_t *dst, unsigned long len)
+{
+    cs16_to_cs8_tail(src, dst, 0, len);
+}
+
+static void u8_to_f32_tail(uint8_t const *src, float *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = (src[i] - 128) * (1.0f / 0x80);
+    }
+}
+
+static void u8_to_f32_scalar(uint8_t const *src, float *dst, unsigned long len)
+{
+    u8_to_f32_tail(src, dst, 0, len);
+}
+
+static void s16_to_f32_tail(int16_t const *src, float *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = src[i] * (1.0f / 0x8000);
+    }
+}
+
+static void s16_to_f32_scalar(int16_t const *src, float *dst, unsigned long len)
+{
+    s16_to_f32_tail(src, dst, 0, len);
+}
+
+static void u8_channel_to_f32_tail(uint8_t const *src, float *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = (src[2 * i] - 128) * (1.0f / 0x80);
+    }
+}
+
+static void u8_channel_to_f32_scalar(uint8_t const *src, float *dst, unsigned long len)
+{
+    u8_channel_to_f32_tail(src, dst, 0, len);
+}
+
+static void s16_channel_to_f32_tail(int16_t const *src, float *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        dst[i] = src[2 * i] * (1.0f / 0x8000);
+    }
+}
+
+static void s16_channel_to_f32_scalar(int16_t const *src, float *dst, unsigned long len)
+{
+    s16_channel_to_f32_tail(src, dst, 0, len);
+}
+
+static void f32_to_s16_tail(float const *src, int16_t *dst, unsigned long i, unsigned long len)
+{
+    for (; i < len; ++i) {
+        int s = src[i] * INT16_MAX;
+        if (s < -INT16_MAX)
+            s = -INT16_MAX;
+        else if (s > INT16_MAX)
+            s = INT16_MAX;
+        dst[i] = s;
+    }
+}
+
+static void f32_to_s16_scalar(float const *src, int16_t *dst, unsigned long len)
+{
+    f32_to_s16_tail(src, dst, 0, len);
+}
+
+/* SIMD kernels, bit-exact with the scalar reference */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONVERT_X86
+#include <immintrin.h>
+
+__attribute__((target("sse2")))
+static void cu8_to_cs16_sse2(uint8_t const *src, int16_t *dst, unsigned long len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const flip = _mm_set1_epi8((char)0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((__m128i const *)&src[i]), flip);
+        // the signed byte goes to the high byte
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_unpacklo_epi8(zero, v));
+        _mm_storeu_si128((__m128i *)&dst[i + 8], _mm_unpackhi_epi8(zero, v));
+    }
+    cu8_to_cs16_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void cs16_to_cu8_sse2(int16_t const *src, uint8_t *dst, unsigned long len)
+{
+    __m128i const round = _mm_set1_epi16(0xff);
+    __m128i const bias  = _mm_set1_epi16(128);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m128i x = _mm_loadu_si128((__m128i const *)&src[i + 8 * h]);
+            // add 255 to negative values to divide rounding toward zero
+            x    = _mm_add_epi16(x, _mm_and_si128(_mm_srai_epi16(x, 15), round));
+            r[h] = _mm_add_epi16(_mm_srai_epi16(x, 8), bias);
+        }
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(r[0], r[1]));
+    }
+    cs16_to_cu8_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void cu8_cs8_sse2(uint8_t const *src, uint8_t *dst, unsigned long len)
+{
+    __m128i const flip = _mm_set1_epi8((char)0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_xor_si128(v, flip));
+    }
+    cu8_cs8_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void cs16_to_cs8_sse2(int16_t const *src, int8_t *dst, unsigned long len)
+{
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i lo = _mm_srai_epi16(_mm_loadu_si128((__m128i const *)&src[i]), 8);
+        __m128i hi = _mm_srai_epi16(_mm_loadu_si128((__m128i const *)&src[i + 8]), 8);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packs_epi16(lo, hi));
+    }
+    cs16_to_cs8_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void u8_to_f32_sse2(uint8_t const *src, float *dst, unsigned long len)
+{
+    __m128i const flip  = _mm_set1_epi8((char)0x80);
+    __m128 const scale = _mm_set1_ps(1.0f / 0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((__m128i const *)&src[i]), flip);
+        // sign extend by unpacking to the high bytes and shifting down
+        __m128i w[2] = {_mm_unpacklo_epi8(v, v), _mm_unpackhi_epi8(v, v)};
+        for (int h = 0; h < 2; ++h) {
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w[h], w[h]), 24);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(w[h], w[h]), 24);
+            _mm_storeu_ps(&dst[i + 8 * h], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(&dst[i + 8 * h + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+    u8_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void s16_to_f32_sse2(int16_t const *src, float *dst, unsigned long len)
+{
+    __m128 const scale = _mm_set1_ps(1.0f / 0x8000);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128i v  = _mm_loadu_si128((__m128i const *)&src[i]);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    s16_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void u8_channel_to_f32_sse2(uint8_t const *src, float *dst, unsigned long len)
+{
+    __m128i const mask = _mm_set1_epi16(0xff);
+    __m128i const bias = _mm_set1_epi16(128);
+    __m128 const scale = _mm_set1_ps(1.0f / 0x80);
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 8 < len; i += 8) {
+        __m128i v  = _mm_loadu_si128((__m128i const *)&src[2 * i]);
+        __m128i x  = _mm_sub_epi16(_mm_and_si128(v, mask), bias);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    u8_channel_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void s16_channel_to_f32_sse2(int16_t const *src, float *dst, unsigned long len)
+{
+    __m128 const scale = _mm_set1_ps(1.0f / 0x8000);
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 4 < len; i += 4) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&src[2 * i]);
+        // sign extend the low half of each 32 bit lane
+        __m128i x = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+    }
+    s16_channel_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("sse2")))
+static void f32_to_s16_sse2(float const *src, int16_t *dst, unsigned long len)
+{
+    __m128 const scale = _mm_set1_ps(INT16_MAX);
+    __m128 const lower = _mm_set1_ps(-INT16_MAX);
+    __m128 const upper = _mm_set1_ps(INT16_MAX);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m128 lo = _mm_mul_ps(_mm_loadu_ps(&src[i]), scale);
+        __m128 hi = _mm_mul_ps(_mm_loadu_ps(&src[i + 4]), scale);
+        // clamp before the truncation, the integer range is reached there
+        lo = _mm_min_ps(_mm_max_ps(lo, lower), upper);
+        hi = _mm_min_ps(_mm_max_ps(hi, lower), upper);
+        __m128i x = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+        _mm_storeu_si128((__m128i *)&dst[i], x);
+    }
+    f32_to_s16_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void cu8_to_cs16_avx2(uint8_t const *src, int16_t *dst, unsigned long len)
+{
+    __m128i const flip = _mm_set1_epi8((char)0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((__m128i const *)&src[i]), flip);
+        __m256i x = _mm256_slli_epi16(_mm256_cvtepi8_epi16(v), 8);
+        _mm256_storeu_si256((__m256i *)&dst[i], x);
+    }
+    cu8_to_cs16_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void cs16_to_cu8_avx2(int16_t const *src, uint8_t *dst, unsigned long len)
+{
+    __m256i const round = _mm256_set1_epi16(0xff);
+    __m256i const bias  = _mm256_set1_epi16(128);
+    unsigned long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i r[2];
+        for (int h = 0; h < 2; ++h) {
+            __m256i x = _mm256_loadu_si256((__m256i const *)&src[i + 16 * h]);
+            x    = _mm256_add_epi16(x, _mm256_and_si256(_mm256_srai_epi16(x, 15), round));
+            r[h] = _mm256_add_epi16(_mm256_srai_epi16(x, 8), bias);
+        }
+        __m256i y = _mm256_permute4x64_epi64(_mm256_packus_epi16(r[0], r[1]), 0xd8); // the pack works per 128 bit lane
+        _mm256_storeu_si256((__m256i *)&dst[i], y);
+    }
+    cs16_to_cu8_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void cu8_cs8_avx2(uint8_t const *src, uint8_t *dst, unsigned long len)
+{
+    __m256i const flip = _mm256_set1_epi8((char)0x80);
+    unsigned long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((__m256i const *)&src[i]);
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm256_xor_si256(v, flip));
+    }
+    cu8_cs8_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void cs16_to_cs8_avx2(int16_t const *src, int8_t *dst, unsigned long len)
+{
+    unsigned long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i lo = _mm256_srai_epi16(_mm256_loadu_si256((__m256i const *)&src[i]), 8);
+        __m256i hi = _mm256_srai_epi16(_mm256_loadu_si256((__m256i const *)&src[i + 16]), 8);
+        __m256i y  = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xd8); // the pack works per 128 bit lane
+        _mm256_storeu_si256((__m256i *)&dst[i], y);
+    }
+    cs16_to_cs8_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void u8_to_f32_avx2(uint8_t const *src, float *dst, unsigned long len)
+{
+    __m128i const flip  = _mm_set1_epi8((char)0x80);
+    __m256 const scale = _mm256_set1_ps(1.0f / 0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v  = _mm_xor_si128(_mm_loadu_si128((__m128i const *)&src[i]), flip);
+        __m256i lo = _mm256_cvtepi8_epi32(v);
+        __m256i hi = _mm256_cvtepi8_epi32(_mm_srli_si128(v, 8));
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(&dst[i + 8], _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    u8_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void s16_to_f32_avx2(int16_t const *src, float *dst, unsigned long len)
+{
+    __m256 const scale = _mm256_set1_ps(1.0f / 0x8000);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *)&src[i]));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *)&src[i + 8]));
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(&dst[i + 8], _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    s16_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void u8_channel_to_f32_avx2(uint8_t const *src, float *dst, unsigned long len)
+{
+    __m256i const mask = _mm256_set1_epi16(0xff);
+    __m256i const bias = _mm256_set1_epi16(128);
+    __m256 const scale = _mm256_set1_ps(1.0f / 0x80);
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 16 < len; i += 16) {
+        __m256i v  = _mm256_loadu_si256((__m256i const *)&src[2 * i]);
+        __m256i x  = _mm256_sub_epi16(_mm256_and_si256(v, mask), bias);
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(&dst[i + 8], _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    u8_channel_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void s16_channel_to_f32_avx2(int16_t const *src, float *dst, unsigned long len)
+{
+    __m256 const scale = _mm256_set1_ps(1.0f / 0x8000);
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 8 < len; i += 8) {
+        __m256i v = _mm256_loadu_si256((__m256i const *)&src[2 * i]);
+        __m256i x = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    s16_channel_to_f32_tail(src, dst, i, len);
+}
+
+__attribute__((target("avx2")))
+static void f32_to_s16_avx2(float const *src, int16_t *dst, unsigned long len)
+{
+    __m256 const scale = _mm256_set1_ps(INT16_MAX);
+    __m256 const lower = _mm256_set1_ps(-INT16_MAX);
+    __m256 const upper = _mm256_set1_ps(INT16_MAX);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m256 lo = _mm256_mul_ps(_mm256_loadu_ps(&src[i]), scale);
+        __m256 hi = _mm256_mul_ps(_mm256_loadu_ps(&src[i + 8]), scale);
+        lo = _mm256_min_ps(_mm256_max_ps(lo, lower), upper);
+        hi = _mm256_min_ps(_mm256_max_ps(hi, lower), upper);
+        __m256i x = _mm256_packs_epi32(_mm256_cvttps_epi32(lo), _mm256_cvttps_epi32(hi));
+        x = _mm256_permute4x64_epi64(x, 0xd8); // the pack works per 128 bit lane
+        _mm256_storeu_si256((__m256i *)&dst[i], x);
+    }
+    f32_to_s16_tail(src, dst, i, len);
+}
+
+#endif /* CONVERT_X86 */
+
+#if defined(__ARM_NEON)
+#define CONVERT_NEON
+#include <arm_neon.h>
+
+static void cu8_to_cs16_neon(uint8_t const *src, int16_t *dst, unsigned long len)
+{
+    uint8x8_t const flip = vdup_n_u8(0x80);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        int8x8_t v = vreinterpret_s8_u8(veor_u8(vld1_u8(&src[i]), flip));
+        vst1q_s16(&dst[i], vshll_n_s8(v, 8));
+    }
+    cu8_to_cs16_tail(src, dst, i, len);
+}
+
+static void cs16_to_cu8_neon(int16_t const *src, uint8_t *dst, unsigned long len)
+{
+    int16x8_t const round = vdupq_n_s16(0xff);
+    uint8x8_t const flip  = vdup_n_u8(0x80);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        int16x8_t x = vld1q_s16(&src[i]);
+        x = vaddq_s16(x, vandq_s16(vshrq_n_s16(x, 15), round));
+        vst1_u8(&dst[i], veor_u8(vreinterpret_u8_s8(vshrn_n_s16(x, 8)), flip));
+    }
+    cs16_to_cu8_tail(src, dst, i, len);
+}
+
+static void cu8_cs8_neon(uint8_t const *src, uint8_t *dst, unsigned long len)
+{
+    uint8x16_t const flip = vdupq_n_u8(0x80);
+    unsigned long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        vst1q_u8(&dst[i], veorq_u8(vld1q_u8(&src[i]), flip));
+    }
+    cu8_cs8_tail(src, dst, i, len);
+}
+
+static void cs16_to_cs8_neon(int16_t const *src, int8_t *dst, unsigned long len)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        vst1_s8(&dst[i], vshrn_n_s16(vld1q_s16(&src[i]), 8));
+    }
+    cs16_to_cs8_tail(src, dst, i, len);
+}
+
+static void u8_to_f32_neon(uint8_t const *src, float *dst, unsigned long len)
+{
+    uint8x8_t const flip = vdup_n_u8(0x80);
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        int16x8_t x = vmovl_s8(vreinterpret_s8_u8(veor_u8(vld1_u8(&src[i]), flip)));
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / 0x80));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / 0x80));
+    }
+    u8_to_f32_tail(src, dst, i, len);
+}
+
+static void s16_to_f32_neon(int16_t const *src, float *dst, unsigned long len)
+{
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8) {
+        int16x8_t x = vld1q_s16(&src[i]);
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / 0x8000));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / 0x8000));
+    }
+    s16_to_f32_tail(src, dst, i, len);
+}
+
+static void u8_channel_to_f32_neon(uint8_t const *src, float *dst, unsigned long len)
+{
+    uint8x8_t const flip = vdup_n_u8(0x80);
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 8 < len; i += 8) {
+        uint8x8x2_t v = vld2_u8(&src[2 * i]); // deinterleave I and Q
+        int16x8_t x   = vmovl_s8(vreinterpret_s8_u8(veor_u8(v.val[0], flip)));
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / 0x80));
+        vst1q_f32(&dst[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / 0x80));
+    }
+    u8_channel_to_f32_tail(src, dst, i, len);
+}
+
+static void s16_channel_to_f32_neon(int16_t const *src, float *dst, unsigned long len)
+{
+    unsigned long i = 0;
+    // whole pairs are loaded, the Q channel would read past the last pair
+    for (; i + 4 < len; i += 4) {
+        int16x4x2_t v = vld2_s16(&src[2 * i]); // deinterleave I and Q
+        vst1q_f32(&dst[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(v.val[0])), 1.0f / 0x8000));
+    }
+    s16_channel_to_f32_tail(src, dst, i, len);
+}
+
+static void f32_to_s16_neon(float const *src, int16_t *dst, unsigned long len)
+{
+    float32x4_t const lower = vdupq_n_f32(-INT16_MAX);
+    float32x4_t const upper = vdupq_n_f32(INT16_MAX);
+    unsigned long i = 0;
+    for (; i + 4 <= len; i += 4) {
+        float32x4_t x = vmulq_n_f32(vld1q_f32(&src[i]), INT16_MAX);
+        x = vminq_f32(vmaxq_f32(x, lower), upper);
+        vst1_s16(&dst[i], vmovn_s32(vcvtq_s32_f32(x)));
+    }
+    f32_to_s16_tail(src, dst, i, len);
+}
+
+#endif /* CONVERT_NEON */
+
+static int cpu_has_none(void)
+{
+    return 1;
+}
+
+#ifdef CONVERT_X86
+static int cpu_has_sse2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static int cpu_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/// All kernel variants in order of preference, the last supported one is used.
+static struct {
+    int (*supported)(void);
+    convert_kernels_t kernels;
+} const convert_variants[] = {
+        {cpu_has_none, {"scalar", cu8_to_cs16_scalar, cs16_to_cu8_scalar, cu8_cs8_scalar, cs16_to_cs8_scalar, u8_to_f32_scalar, s16_to_f32_scalar, u8_channel_to_f32_scalar, s16_channel_to_f32_scalar, f32_to_s16_scalar}},
+#ifdef CONVERT_X86
+        {cpu_has_sse2, {"sse2", cu8_to_cs16_sse2, cs16_to_cu8_sse2, cu8_cs8_sse2, cs16_to_cs8_sse2, u8_to_f32_sse2, s16_to_f32_sse2, u8_channel_to_f32_sse2, s16_channel_to_f32_sse2, f32_to_s16_sse2}},
+        {cpu_has_avx2, {"avx2", cu8_to_cs16_avx2, cs16_to_cu8_avx2, cu8_cs8_avx2, cs16_to_cs8_avx2, u8_to_f32_avx2, s16_to_f32_avx2, u8_channel_to_f32_avx2, s16_channel_to_f32_avx2, f32_to_s16_avx2}},
+#endif
+#ifdef CONVERT_NEON
+        {cpu_has_none, {"neon", cu8_to_cs16_neon, cs16_to_cu8_neon, cu8_cs8_neon, cs16_to_cs8_neon, u8_to_f32_neon, s16_to_f32_neon, u8_channel_to_f32_neon, s16_channel_to_f32_neon, f32_to_s16_neon}},
+#endif
+};
+
+/// Published once by convert_init(), any config on any thread may select again.
+static convert_kernels_t const *convert_selected = &convert_variants[0].kernels;
+/// A variant chosen with convert_select() is kept, set while parsing the options before any threads.
+static int convert_forced;
+
+convert_kernels_t const *convert_kernels_variant(unsigned idx)
+{
+    unsigned num = sizeof(convert_variants) / sizeof(*convert_variants);
+    for (unsigned n = 0; n < num; ++n) {
+        if (!convert_variants[n].supported())
+            continue;
+        if (idx-- == 0)
+            return &convert_variants[n].kernels;
+    }
+    return NULL;
+}
+
+convert_kernels_t const *convert_kernels(void)
+{
+    return atomic_load_acquire(&convert_selected);
+}
+
+void convert_init(void)
+{
+    if (convert_forced)
+        return;
+    convert_kernels_t const *best = NULL;
+    convert_kernels_t const *kernels;
+    for (unsigned idx = 0; (kernels = convert_kernels_variant(idx)); ++idx) {
+        best = kernels;
+    }
+    atomic_store_release(&convert_selected, best);
+}
+
+int convert_select(char const *name)
+{
+    convert_kernels_t const *kernels;
+    for (unsigned idx = 0; (kernels = convert_kernels_variant(idx)); ++idx) {
+        if (!strcmp(kernels->name, name)) {
+            convert_forced = 1;
+            atomic_store_release(&convert_selected, kernels);
+            return 0;
+        }
+    }
+    return -1;
+}
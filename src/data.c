@@ -14,6 +14,8 @@
 
 #include "abuf.h"
 #include "fatal.h"
+#include "output_filter.h"
+#include "compat_atomic.h"
 
 #include <stdarg.h>
 #include <assert.h>
@@ -21,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 
 // Macro to prevent unused variables (passed into a function)
 // from generating a warning.
@@ -54,7 +57,7 @@ typedef struct {
     value_release_fn value_release;
 } data_meta_type_t;
 
-static data_meta_type_t dmt[DATA_COUNT] = {
+static data_meta_type_t const dmt[DATA_COUNT] = {
     //  DATA_DATA
     { .array_element_size       = sizeof(data_t*),
       .array_is_boxed           = true,
@@ -81,7 +84,7 @@ static data_meta_type_t dmt[DATA_COUNT] = {
       .array_is_boxed           = true,
       .array_elementwise_import = (array_elementwise_import_fn) strdup,
       .array_element_release    = (array_element_release_fn) free,
-      .value_release            = (value_release_fn) free },
+      .value_release            = NULL }, // the string is in the item block
 
     //  DATA_ARRAY
     { .array_element_size       = sizeof(data_array_t*),
@@ -117,6 +120,14 @@ static bool import_values(void *dst, void const *src, int num_values, data_type_
 
 /* data */
 
+// allocations of data items, arrays, and JSON texts, shared by all threads
+static unsigned data_allocs;
+
+R_API unsigned data_alloc_count(void)
+{
+    return atomic_load_acquire(&data_allocs);
+}
+
 R_API data_array_t *data_array(int num_values, data_type_t type, void const *values)
 {
     if (num_values < 0) {
@@ -127,6 +138,7 @@ R_API data_array_t *data_array(int num_values, data_type_t type, void const *val
         WARN_CALLOC("data_array()");
         return NULL; // NOTE: returns NULL on alloc failure.
     }
+    atomic_fetch_add_unsigned(&data_allocs, 1);
 
     int element_size = dmt[type].array_element_size;
     if (num_values > 0) { // don't alloc empty arrays
@@ -135,6 +147,7 @@ R_API data_array_t *data_array(int num_values, data_type_t type, void const *val
             WARN_CALLOC("data_array()");
             goto alloc_error;
         }
+        atomic_fetch_add_unsigned(&data_allocs, 1);
         if (!import_values(array->values, values, num_values, type))
             goto alloc_error;
     }
@@ -156,18 +169,75 @@ alloc_error:
 #pragma GCC diagnostic ignored "-Wunknown-warning-option"
 #pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
 
-static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key, va_list ap)
+/// What vdata_walk() does with the items of a vdata_make() call.
+enum vdata_mode {
+    VDATA_MEASURE, ///< count the items and the size of their strings
+    VDATA_MAKE,    ///< make the items, release the values of skipped items
+    VDATA_RELEASE, ///< release all values, the items could not be made
+};
+
+// the interned well-known keys, indexed by enum data_key
+static char const *const data_keys[DATA_KEY_COUNT] = {
+        [DATA_KEY_TIME]     = "time",
+        [DATA_KEY_TAG]      = "tag",
+        [DATA_KEY_MODEL]    = "model",
+        [DATA_KEY_TYPE]     = "type",
+        [DATA_KEY_SUBTYPE]  = "subtype",
+        [DATA_KEY_ID]       = "id",
+        [DATA_KEY_CHANNEL]  = "channel",
+        [DATA_KEY_MIC]      = "mic",
+        [DATA_KEY_PROTOCOL] = "protocol",
+        [DATA_KEY_MOD]      = "mod",
+        [DATA_KEY_FREQ]     = "freq",
+        [DATA_KEY_FREQ1]    = "freq1",
+        [DATA_KEY_FREQ2]    = "freq2",
+        [DATA_KEY_RSSI]     = "rssi",
+        [DATA_KEY_SNR]      = "snr",
+        [DATA_KEY_NOISE]    = "noise",
+        [DATA_KEY_CODES]    = "codes",
+        [DATA_KEY_SRC]      = "src",
+        [DATA_KEY_LVL]      = "lvl",
+        [DATA_KEY_MSG]      = "msg",
+        [DATA_KEY_NUM_ROWS] = "num_rows",
+};
+
+// the well-known key equal to a key, DATA_KEY_OTHER if there is none
+static unsigned data_key_lookup(char const *key)
+{
+    for (unsigned k = DATA_KEY_OTHER + 1; k < DATA_KEY_COUNT; ++k) {
+        if (data_keys[k][0] == key[0] && !strcmp(data_keys[k] + 1, key + 1))
+            return k;
+    }
+    return DATA_KEY_OTHER;
+}
+
+R_API char const *data_key_name(enum data_key key)
+{
+    return key > DATA_KEY_OTHER && key < DATA_KEY_COUNT ? data_keys[key] : NULL;
+}
+
+// copy a string to the text of an item block
+static char *vdata_text(char **text, char const *str)
+{
+    size_t len = strlen(str) + 1;
+    char *copy = memcpy(*text, str, len);
+    *text += len;
+    return copy;
+}
+
+// walk the items of a vdata_make() call, returns 0 on a bad item list
+static int vdata_walk(enum vdata_mode mode, data_t *items, char *text, const char *key, const char *pretty_key, va_list ap, unsigned *count, size_t *text_size)
 {
     data_type_t type;
-    data_t *prev = first;
-    while (prev && prev->next)
-        prev = prev->next;
-    char *format = NULL;
+    unsigned n = 0;
+    size_t size = 0;
+    char const *format = NULL;
+    int has_format = 0;
     int skip = 0; // skip the data item if this is set
     type = va_arg(ap, data_type_t);
     do {
-        data_t *current;
         data_value_t value = {0};
+        char const *str = NULL;
         // store explicit release function, CSA checker gets confused without this
         value_release_fn value_release = NULL; // appease CSA checker
 
@@ -177,18 +247,12 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             type = va_arg(ap, data_type_t);
             continue;
         case DATA_FORMAT:
-            if (format) {
+            if (has_format) {
                 fprintf(stderr, "vdata_make() format type used twice\n");
-                goto alloc_error;
-            }
-            format = va_arg(ap, char *);
-            if (format) {
-                format = strdup(format);
-                if (!format) {
-                    WARN_STRDUP("vdata_make()");
-                    goto alloc_error;
-                }
+                return 0;
             }
+            format     = va_arg(ap, char const *);
+            has_format = 1;
             type = va_arg(ap, data_type_t);
             continue;
         case DATA_COUNT:
@@ -205,10 +269,7 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             value.v_dbl = va_arg(ap, double);
             break;
         case DATA_STRING:
-            value_release = (value_release_fn)free; // appease CSA checker
-            value.v_ptr = strdup(va_arg(ap, char const *));
-            if (!value.v_ptr)
-                WARN_STRDUP("vdata_make()");
+            str = va_arg(ap, char const *);
             break;
         case DATA_ARRAY:
             value_release = (value_release_fn)data_array_free; // appease CSA checker
@@ -216,47 +277,44 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             break;
         default:
             fprintf(stderr, "vdata_make() bad data type (%d)\n", type);
-            goto alloc_error;
+            return 0;
         }
 
-        if (skip) {
+        if (mode == VDATA_RELEASE || (skip && mode == VDATA_MAKE)) {
             if (value_release) // could use dmt[type].value_release
                 value_release(value.v_ptr);
-            free(format);
-            format = NULL;
-            skip = 0;
+        }
+        else if (skip) {
+            // nothing to measure
+        }
+        else if (mode == VDATA_MEASURE) {
+            size += data_key_lookup(key) ? 0 : strlen(key) + 1;
+            size += pretty_key && *pretty_key ? strlen(pretty_key) + 1 : 0;
+            size += format ? strlen(format) + 1 : 0;
+            size += str ? strlen(str) + 1 : 0;
+            n += 1;
         }
         else {
-            current = calloc(1, sizeof(*current));
-            if (!current) {
-                WARN_CALLOC("vdata_make()");
-                if (value_release) // could use dmt[type].value_release
-                    value_release(value.v_ptr);
-                goto alloc_error;
-            }
-            current->type   = type;
-            current->format = format;
-            format          = NULL; // consumed
-            current->value  = value;
-            current->next   = NULL;
-
-            if (prev)
-                prev->next = current;
-            prev = current;
-            if (!first)
-                first = current;
-
-            current->key = strdup(key);
-            if (!current->key) {
-                WARN_STRDUP("vdata_make()");
-                goto alloc_error;
-            }
-            current->pretty_key = strdup(pretty_key ? pretty_key : key);
-            if (!current->pretty_key) {
-                WARN_STRDUP("vdata_make()");
-                goto alloc_error;
-            }
+            // well-known keys and empty pretty keys are not copied
+            unsigned known      = data_key_lookup(key);
+            data_t *current     = &items[n];
+            current->next       = NULL;
+            current->key        = known ? (char *)data_keys[known] : vdata_text(&text, key);
+            current->pretty_key = !pretty_key ? current->key : *pretty_key ? vdata_text(&text, pretty_key) : (char *)"";
+            current->format     = format ? vdata_text(&text, format) : NULL;
+            current->type       = type;
+            current->value      = value;
+            if (str)
+                current->value.v_ptr = vdata_text(&text, str);
+            current->retain  = 0;
+            current->storage = (n == 0 ? DATA_BLOCK_START : 0) | known << DATA_KEY_SHIFT;
+            if (n > 0)
+                items[n - 1].next = current;
+            n += 1;
         }
+        format     = NULL;
+        has_format = 0;
+        skip       = 0;
 
         // next args
         key = va_arg(ap, const char *);
@@ -265,17 +323,50 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             type = va_arg(ap, data_type_t);
         }
     } while (key);
-    if (format) {
+    if (has_format) {
         fprintf(stderr, "vdata_make() format type without data\n");
-        goto alloc_error;
+        return 0;
     }
 
-    return first;
+    *count     = n;
+    *text_size = size;
+    return 1;
+}
 
-alloc_error:
-    free(format); // if not consumed
-    data_free(first);
-    return NULL;
+// the items of one call are made in one allocation with their keys, formats, and strings
+static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key, va_list ap)
+{
+    unsigned count;
+    size_t text_size;
+    va_list aq;
+    va_copy(aq, ap);
+    int ok = vdata_walk(VDATA_MEASURE, NULL, NULL, key, pretty_key, aq, &count, &text_size);
+    va_end(aq);
+    if (!ok) {
+        data_free(first);
+        return NULL;
+    }
+
+    data_t *items = NULL;
+    if (count) {
+        items = malloc(count * sizeof(*items) + text_size);
+        if (!items) {
+            WARN_MALLOC("vdata_make()");
+            vdata_walk(VDATA_RELEASE, NULL, NULL, key, pretty_key, ap, &count, &text_size);
+            data_free(first);
+            return NULL;
+        }
+        atomic_fetch_add_unsigned(&data_allocs, 1);
+    }
+    vdata_walk(VDATA_MAKE, items, items ? (char *)(items + count) : NULL, key, pretty_key, ap, &count, &text_size);
+
+    if (!first)
+        return items;
+    data_t *prev = first;
+    while (prev->next)
+        prev = prev->next;
+    prev->next = items;
+    return first;
 }
 
 R_API data_t *data_make(const char *key, const char *pretty_key, ...)
@@ -349,6 +440,8 @@ R_API data_t *data_hex(data_t *first, char const *key, char const *pretty_key, c
 
 R_API void data_array_free(data_array_t *array)
 {
+    if (!array)
+        return; // a skipped conditional array
     array_element_release_fn release = dmt[array->type].array_element_release;
     if (release) {
         int element_size = dmt[array->type].array_element_size;
@@ -359,10 +452,11 @@ R_API void data_array_free(data_array_t *array)
     free(array);
 }
 
+// the retain count is atomic, outputs on their own threads release the data they were given
 R_API data_t *data_retain(data_t *data)
 {
     if (data)
-        ++data->retain;
+        atomic_fetch_add_unsigned(&data->retain, 1);
     return data;
 }
 
@@ -372,20 +466,61 @@ R_API data_t *data_retain(data_t *data)
 #endif
 R_API void data_free(data_t *data)
 {
-    if (data && data->retain) {
-        --data->retain;
+    // a retain count still above zero before the decrement means another holder
+    if (data && atomic_load_acquire(&data->retain) && atomic_fetch_sub_unsigned(&data->retain, 1) != 0) {
         return;
     }
+    // the items of a block follow each other, a block is freed when the next one starts
+    data_t *block = NULL;
     while (data) {
-        data_t *prev_data = data;
+        data_t *next = data->next;
         if (dmt[data->type].value_release)
             dmt[data->type].value_release(data->value.v_ptr);
+        if (data->storage & DATA_OWN_FORMAT)
+            free(data->format);
+        if (data->storage & DATA_OWN_KEY)
+            free(data->key);
+        if (data->storage & DATA_BLOCK_START) {
+            free(block);
+            block = data;
+        }
+        data = next;
+    }
+    free(block);
+}
+
+R_API void data_replace_key(data_t *data, char *key)
+{
+    if (data->storage & DATA_OWN_KEY)
+        free(data->key);
+    data->key = key;
+    data->storage &= (1U << DATA_KEY_SHIFT) - 1;
+    data->storage |= DATA_OWN_KEY | data_key_lookup(key) << DATA_KEY_SHIFT;
+}
+
+R_API void data_replace_format(data_t *data, char *format)
+{
+    if (data->storage & DATA_OWN_FORMAT)
         free(data->format);
-        free(data->pretty_key);
+    data->format = format;
+    data->storage |= DATA_OWN_FORMAT;
+}
+
+R_API void data_borrow_key(data_t *data, char const *key)
+{
+    if (data->storage & DATA_OWN_KEY)
         free(data->key);
-        data = data->next;
-        free(prev_data);
-    }
+    data->key = (char *)key;
+    data->storage &= ((1U << DATA_KEY_SHIFT) - 1) & ~(unsigned)DATA_OWN_KEY;
+    data->storage |= data_key_lookup(key) << DATA_KEY_SHIFT;
+}
+
+R_API void data_borrow_format(data_t *data, char const *format)
+{
+    if (data->storage & DATA_OWN_FORMAT)
+        free(data->format);
+    data->format = (char *)format;
+    data->storage &= ~(unsigned)DATA_OWN_FORMAT;
 }
 
 #pragma GCC diagnostic pop
@@ -394,14 +529,52 @@ R_API void data_free(data_t *data)
 
 R_API void data_output_print(data_output_t *output, data_t *data)
 {
-    if (!output)
+    data_json_t json = {.data = data};
+    data_output_print_shared(output, data, &json);
+    free(json.text);
+}
+
+R_API void data_output_print_shared(data_output_t *output, data_t *data, data_json_t *json)
+{
+    if (!output || !output_filter_match(output->filter, data))
         return;
+    output->json = json;
     if (output->output_print) {
         output->output_print(output, data);
     }
     else {
         output->print_data(output, data, NULL);
     }
+    output->json = NULL;
+}
+
+/// Largest JSON text of an event, longer texts are truncated.
+#define DATA_JSON_MAX_SIZE (1 << 20)
+
+R_API char const *data_output_jsons(data_output_t *output, data_t *data, size_t *len)
+{
+    data_json_t *json = output->json;
+    if (!json || json->data != data) {
+        return NULL;
+    }
+    // most events fit the first buffer, a text filling the buffer might be truncated
+    for (size_t size = 2048; !json->text; size *= 4) {
+        char *text = malloc(size);
+        if (!text) {
+            WARN_MALLOC("data_output_jsons()");
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+        atomic_fetch_add_unsigned(&data_allocs, 1);
+        json->len = data_print_jsons(data, text, size);
+        if (json->len + 1 < size || size >= DATA_JSON_MAX_SIZE) {
+            json->text = text;
+        }
+        else {
+            free(text);
+        }
+    }
+    *len = json->len;
+    return json->text;
 }
 
 R_API void data_output_start(struct data_output *output, char const *const *fields, int num_fields)
@@ -411,10 +584,25 @@ R_API void data_output_start(struct data_output *output, char const *const *fiel
     output->output_start(output, fields, num_fields);
 }
 
+R_API void data_output_flush(data_output_t *output)
+{
+    if (!output || !output->output_flush)
+        return;
+    output->output_flush(output);
+}
+
+R_API void data_output_poll(data_output_t *output)
+{
+    if (!output || !output->output_poll)
+        return;
+    output->output_poll(output);
+}
+
 R_API void data_output_free(data_output_t *output)
 {
     if (!output)
         return;
+    output_filter_free(output->filter);
     output->output_free(output);
 }
 
@@ -466,6 +654,7 @@ R_API void print_array_value(data_output_t *output, data_array_t *array, char co
 typedef struct {
     struct data_output output;
     abuf_t msg;
+    bool typed; ///< doubles always read back as doubles
 } data_print_jsons_t;
 
 static void R_API_CALLCONV format_jsons_array(data_output_t *output, data_array_t *array, char const *format)
@@ -565,11 +754,17 @@ static void R_API_CALLCONV format_jsons_double(data_output_t *output, double dat
     UNUSED(format);
     data_print_jsons_t *jsons = (data_print_jsons_t *)output;
     // use scientific notation for very big/small values
-    if (data > 1e7 || data < 1e-4) {
+    bool sci = data > 1e7 || data < 1e-4;
+    if (jsons->typed) {
+        // negatives and zero in fixed point, with a decimal point they don't read back as integers
+        double mag = fabs(data);
+        sci        = mag > 1e7 || (mag < 1e-4 && mag > 0.0);
+    }
+    if (sci) {
         abuf_printf(&jsons->msg, "%g", data);
     }
     else {
-        abuf_printf(&jsons->msg, "%.5f", data);
+        abuf_print_fixed(&jsons->msg, data, 5);
         // remove trailing zeros, always keep one digit after the decimal point
         while (jsons->msg.left > 0 && *(jsons->msg.tail - 1) == '0' && *(jsons->msg.tail - 2) != '.') {
             jsons->msg.tail--;
@@ -583,10 +778,10 @@ static void R_API_CALLCONV format_jsons_int(data_output_t *output, int data, cha
 {
     UNUSED(format);
     data_print_jsons_t *jsons = (data_print_jsons_t *)output;
-    abuf_printf(&jsons->msg, "%d", data);
+    abuf_print_int(&jsons->msg, "%d", data);
 }
 
-R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
+static size_t print_jsons(data_t *data, char *dst, size_t len, bool typed)
 {
     data_print_jsons_t jsons = {
             .output = {
@@ -596,6 +791,7 @@ R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
                     .print_double = format_jsons_double,
                     .print_int    = format_jsons_int,
             },
+            .typed = typed,
     };
 
     abuf_init(&jsons.msg, dst, len);
@@ -604,3 +800,13 @@ R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
 
     return len - jsons.msg.left;
 }
+
+R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
+{
+    return print_jsons(data, dst, len, false);
+}
+
+R_API size_t data_print_jsons_typed(data_t *data, char *dst, size_t len)
+{
+    return print_jsons(data, dst, len, true);
+}
@@ -22,6 +22,7 @@
 #include "c_util.h" // for MIN()
 #include "fileformat.h"
 #include "fatal.h"
+#include "compat_pthread.h"
 
 typedef struct gpsd_client {
     struct mg_connect_opts connect_opts;
@@ -30,9 +31,32 @@ typedef struct gpsd_client {
     char address[253 + 6 + 1]; // dns max + port
     char const *init_str;
     char const *filter_str;
+    char const **includes; ///< the keys to filter from the JSON, NULL to tag the whole message
     char msg[1024]; // GPSd TPV should about 600 bytes
+    data_t *tags; ///< the includes filtered from the last message, retained by the events
+#ifdef THREADS
+    pthread_mutex_t lock; ///< guards msg and tags, the events are made on the demod threads
+#endif
 } gpsd_client_t;
 
+static void gpsd_client_lock(gpsd_client_t *ctx)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&ctx->lock);
+#else
+    (void)ctx;
+#endif
+}
+
+static void gpsd_client_unlock(gpsd_client_t *ctx)
+{
+#ifdef THREADS
+    pthread_mutex_unlock(&ctx->lock);
+#else
+    (void)ctx;
+#endif
+}
+
 // GPSd JSON mode
 char const watch_json[] = "?WATCH={\"enable\":true,\"json\":true}\n";
 char const filter_json[] = "{\"class\":\"TPV\",";
@@ -40,10 +64,66 @@ char const filter_json[] = "{\"class\":\"TPV\",";
 char const watch_nmea[] = "?WATCH={\"enable\":true,\"nmea\":true}\n";
 char const filter_nmea[] = "$GPGGA,";
 
+static char const *find_list_strncmp(char const **list, char const *key, size_t len)
+{
+    for (; list && *list; ++list) {
+        char const *elem = *list;
+        if (elem && strncmp(elem, key, len) == 0) {
+            return elem;
+        }
+    }
+    return NULL;
+}
+
+#define MAX_JSON_TOKENS 128
+
+static data_t *append_filtered_json(data_t *data, char const *json, char const **includes)
+{
+    jsmn_parser parser = {0};
+    jsmn_init(&parser);
+    jsmntok_t tok[MAX_JSON_TOKENS] = {{0}}; // make the compiler happy, should be {0}
+
+    int toks = jsmn_parse(&parser, json, strlen(json), tok, MAX_JSON_TOKENS);
+    if (toks < 1 || tok[0].type != JSMN_OBJECT) {
+        fprintf(stderr, "invalid json (%d): %s\n", toks, json);
+        return data; // invalid json
+    }
+
+    // check all tokens
+    for (int i = 1; i < toks - 1; ++i) {
+        jsmntok_t *k = tok + i;
+        jsmntok_t *v = tok + i + 1;
+        i += k->size + v->size;
+        //fprintf(stderr, "TOK (%d %d) %.*s : (%d %d) %.*s\n",
+        //        k->type, k->size, k->end - k->start, json + k->start,
+        //        v->type, v->size, v->end - v->start, json + v->start);
+
+        // check all includes
+        char const *key = find_list_strncmp(includes, json + k->start, k->end - k->start);
+        if (key) {
+            // append json tag
+            char buf[1024];
+            int len = MIN(v->end - v->start, (int)sizeof(buf) - 1);
+            memcpy(buf, json + v->start, len);
+            buf[len] = '\0';
+            data = data_str(data, key, "", NULL, buf);
+        }
+    }
+
+    return data;
+}
+
 static void gpsd_client_line(gpsd_client_t *ctx, char *line)
 {
     if (!ctx->filter_str || strncmp(line, ctx->filter_str, strlen(ctx->filter_str)) == 0) {
+        // parse once for each message, the events get the tags by reference
+        data_t *tags = ctx->includes ? append_filtered_json(NULL, line, ctx->includes) : NULL;
+        gpsd_client_lock(ctx);
         snprintf(ctx->msg, sizeof(ctx->msg), "%s", line);
+        data_t *prev = ctx->tags;
+        ctx->tags    = tags;
+        gpsd_client_unlock(ctx);
+        data_free(prev);
     }
 }
 
@@ -117,7 +197,7 @@ static struct mg_connection *gpsd_client_connect(gpsd_client_t *ctx, struct mg_m
     return ctx->conn;
 }
 
-static gpsd_client_t *gpsd_client_init(char const *host, char const *port, char const *init_str, char const *filter_str, struct mg_mgr *mgr)
+static gpsd_client_t *gpsd_client_init(char const *host, char const *port, char const *init_str, char const *filter_str, char const **includes, struct mg_mgr *mgr)
 {
     gpsd_client_t *ctx;
     ctx = calloc(1, sizeof(gpsd_client_t));
@@ -134,6 +214,10 @@ static gpsd_client_t *gpsd_client_init(char const *host, char const *port, char
 
     ctx->init_str = init_str;
     ctx->filter_str = filter_str;
+    ctx->includes = includes;
+#ifdef THREADS
+    pthread_mutex_init(&ctx->lock, NULL);
+#endif
     ctx->connect_opts.user_data = ctx;
 
     if (!gpsd_client_connect(ctx, mgr)) {
@@ -149,6 +233,12 @@ static void gpsd_client_free(gpsd_client_t *ctx)
         ctx->conn->user_data = NULL;
         ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (ctx) {
+        data_free(ctx->tags);
+#ifdef THREADS
+        pthread_mutex_destroy(&ctx->lock);
+#endif
+    }
     free(ctx);
 }
 
@@ -220,7 +310,7 @@ data_tag_t *data_tag_create(char *param, struct mg_mgr *mgr)
 
         fprintf(stderr, "Getting %s data from %s port %s\n", mode, host, port);
 
-        tag->gpsd_client = gpsd_client_init(host, port, init_str, filter_str, mgr);
+        tag->gpsd_client = gpsd_client_init(host, port, init_str, filter_str, tag->includes, mgr);
     }
     else {
         if (!tag->key)
@@ -238,76 +328,29 @@ void data_tag_free(data_tag_t *tag)
     free(tag);
 }
 
-static char const *find_list_strncmp(char const **list, char const *key, size_t len)
-{
-    for (; list && *list; ++list) {
-        char const *elem = *list;
-        if (elem && strncmp(elem, key, len) == 0) {
-            return elem;
-        }
-    }
-    return NULL;
-}
-
-#define MAX_JSON_TOKENS 128
-
-static data_t *append_filtered_json(data_t *data, char const *json, char const **includes)
-{
-    jsmn_parser parser = {0};
-    jsmn_init(&parser);
-    jsmntok_t tok[MAX_JSON_TOKENS] = {{0}}; // make the compiler happy, should be {0}
-
-    int toks = jsmn_parse(&parser, json, strlen(json), tok, MAX_JSON_TOKENS);
-    if (toks < 1 || tok[0].type != JSMN_OBJECT) {
-        fprintf(stderr, "invalid json (%d): %s\n", toks, json);
-        return data; // invalid json
-    }
-
-    // check all tokens
-    for (int i = 1; i < toks - 1; ++i) {
-        jsmntok_t *k = tok + i;
-        jsmntok_t *v = tok + i + 1;
-        i += k->size + v->size;
-        //fprintf(stderr, "TOK (%d %d) %.*s : (%d %d) %.*s\n",
-        //        k->type, k->size, k->end - k->start, json + k->start,
-        //        v->type, v->size, v->end - v->start, json + v->start);
-
-        // check all includes
-        char const *key = find_list_strncmp(includes, json + k->start, k->end - k->start);
-        if (key) {
-            // append json tag
-            char buf[1024];
-            int len = MIN(v->end - v->start, (int)sizeof(buf) - 1);
-            memcpy(buf, json + v->start, len);
-            buf[len] = '\0';
-            data = data_str(data, key, "", NULL, buf);
-        }
-    }
-
-    return data;
-}
-
 data_t *data_tag_apply(data_tag_t *tag, data_t *data, char const *filename)
 {
     char const *val = tag->val;
     if (tag->gpsd_client) {
-        val = tag->gpsd_client->msg;
+        gpsd_client_t *ctx = tag->gpsd_client;
+        gpsd_client_lock(ctx);
         if (tag->includes) {
             if (tag->key) {
-                // wrap tag includes
-                data_t *obj = append_filtered_json(NULL, val, tag->includes);
-                // append tag wrapper
-                data = data_dat(data, tag->key, "", NULL, obj);
+                // append tag wrapper, the tags of the message are shared by reference
+                data = data_dat(data, tag->key, "", NULL, data_retain(ctx->tags));
             }
             else {
                 // append tag includes
-                data = append_filtered_json(data, val, tag->includes);
+                for (data_t *d = ctx->tags; d; d = d->next) {
+                    data = data_str(data, d->key, "", NULL, d->value.v_ptr);
+                }
             }
         }
         else {
             // append tag string
-            data = data_str(data, tag->key, "", NULL, val);
+            data = data_str(data, tag->key, "", NULL, ctx->msg);
         }
+        gpsd_client_unlock(ctx);
         return data;
     }
     else if (filename && !strcmp("PATH", tag->val)) {
@@ -0,0 +1,274 @@
+/** @file
+    Decimating front-end, shifts and reduces a wide capture to a lower sample rate.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "decimator.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// CIC filter order, the droop at the edge of the usable band is below 1 dB.
+#define CIC_ORDER 4
+/// Half-band filter length, every other tap but the center is zero.
+#define HB_TAPS 31
+/// NCO table size, as a power of two the spurs are about 72 dB down.
+#define NCO_BITS 12
+#define NCO_SIZE (1 << NCO_BITS)
+/// Input samples converted and mixed per pass.
+#define DECIMATOR_TILE_LEN 1024
+
+struct decimator {
+    unsigned factor;    ///< overall decimation
+    unsigned cic_rate;  ///< CIC decimation, factor / 2
+    double cic_gain;    ///< CIC gain, cic_rate ^ CIC_ORDER
+    int shift;          ///< NCO frequency in Hz
+    uint32_t nco_rate;  ///< sample rate the NCO step was computed for
+    uint32_t nco_step;  ///< NCO phase increment per sample
+    uint32_t nco_phase; ///< NCO phase accumulator
+    int16_t nco_table[NCO_SIZE]; ///< cosine in Q1.14
+    uint64_t integ[CIC_ORDER][2]; ///< CIC integrators, wrap around by design
+    uint64_t comb[CIC_ORDER][2];  ///< CIC comb delays
+    unsigned cic_phase; ///< input samples since the last CIC output
+    float hb_coeffs[HB_TAPS];
+    float hb_hist[4 * HB_TAPS]; ///< written twice so the filter window is contiguous, interleaved I/Q
+    unsigned hb_pos;    ///< next write position in the half-band history
+    unsigned hb_phase;  ///< CIC outputs since the last half-band output
+    uint32_t out_size;  ///< capacity of the output buffer in samples
+    int16_t *out;
+};
+
+decimator_t *decimator_create(unsigned factor, int shift)
+{
+    if (factor < 2 || factor > DECIMATOR_MAX_FACTOR || (factor & (factor - 1))) {
+        return NULL;
+    }
+
+    decimator_t *dec = calloc(1, sizeof(*dec));
+    if (!dec) {
+        WARN_CALLOC("decimator_create()");
+        return NULL;
+    }
+    dec->factor   = factor;
+    dec->cic_rate = factor / 2;
+    dec->cic_gain = pow(dec->cic_rate, CIC_ORDER);
+    dec->shift    = shift;
+
+    for (unsigned i = 0; i < NCO_SIZE; ++i) {
+        dec->nco_table[i] = (int16_t)lrint(16384.0 * cos(2.0 * M_PI * i / NCO_SIZE));
+    }
+
+    // Blackman windowed sinc, cutoff at a quarter of the rate, unity gain
+    double sum = 0.0;
+    for (unsigned t = 0; t < HB_TAPS; ++t) {
+        int n = (int)t - (HB_TAPS - 1) / 2;
+        double sinc = n == 0 ? 1.0 : n % 2 ? sin(M_PI * n / 2) / (M_PI * n / 2) : 0.0;
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * t / (HB_TAPS - 1)) + 0.08 * cos(4.0 * M_PI * t / (HB_TAPS - 1));
+        dec->hb_coeffs[t] = (float)(sinc * window);
+        sum += dec->hb_coeffs[t];
+    }
+    for (unsigned t = 0; t < HB_TAPS; ++t) {
+        dec->hb_coeffs[t] = (float)(dec->hb_coeffs[t] / sum);
+    }
+
+    return dec;
+}
+
+void decimator_free(decimator_t *dec)
+{
+    if (!dec)
+        return;
+
+    free(dec->out);
+    free(dec);
+}
+
+void decimator_reset(decimator_t *dec)
+{
+    dec->nco_phase = 0;
+    memset(dec->integ, 0, sizeof(dec->integ));
+    memset(dec->comb, 0, sizeof(dec->comb));
+    dec->cic_phase = 0;
+    memset(dec->hb_hist, 0, sizeof(dec->hb_hist));
+    dec->hb_pos   = 0;
+    dec->hb_phase = 0;
+}
+
+int decimator_shift(decimator_t const *dec)
+{
+    return dec->shift;
+}
+
+uint32_t decimator_rate(decimator_t const *dec, uint32_t samp_rate)
+{
+    return samp_rate / dec->factor;
+}
+
+int16_t *decimator_output(decimator_t *dec)
+{
+    return dec->out;
+}
+
+static int16_t clamp_s16(float v)
+{
+    if (v > INT16_MAX)
+        return INT16_MAX;
+    if (v < -INT16_MAX)
+        return -INT16_MAX;
+    return (int16_t)lrintf(v);
+}
+
+// Push one CIC output into the half-band filter, returns 1 if an output sample was written
+static int halfband_push(decimator_t *dec, float si, float sq, float scale, int16_t *out)
+{
+    unsigned pos = dec->hb_pos;
+    dec->hb_hist[2 * pos]                 = si;
+    dec->hb_hist[2 * pos + 1]             = sq;
+    dec->hb_hist[2 * (pos + HB_TAPS)]     = si;
+    dec->hb_hist[2 * (pos + HB_TAPS) + 1] = sq;
+    dec->hb_pos = pos + 1 < HB_TAPS ? pos + 1 : 0;
+
+    if (++dec->hb_phase < 2) {
+        return 0;
+    }
+    dec->hb_phase = 0;
+
+    // the oldest sample in the window is at the next write position
+    float const *x = &dec->hb_hist[2 * (pos + 1)];
+    float const *h = dec->hb_coeffs;
+    float yr = h[(HB_TAPS - 1) / 2] * x[HB_TAPS - 1];
+    float yi = h[(HB_TAPS - 1) / 2] * x[HB_TAPS];
+    for (unsigned t = 0; t < HB_TAPS; t += 2) {
+        yr += h[t] * x[2 * t];
+        yi += h[t] * x[2 * t + 1];
+    }
+    out[0] = clamp_s16(yr * scale);
+    out[1] = clamp_s16(yi * scale);
+    return 1;
+}
+
+// Convert a tile of input samples to I/Q integers and mix them down by the NCO
+static void load_tile(decimator_t *dec, void const *iq_buf, int sample_size, uint32_t pos, unsigned len, int32_t *tile)
+{
+    if (sample_size == 2) {
+        uint8_t const *cu8_buf = (uint8_t const *)iq_buf + 2 * pos;
+        for (unsigned i = 0; i < 2 * len; ++i) {
+            tile[i] = 2 * cu8_buf[i] - 255;
+        }
+    }
+    else {
+        int16_t const *cs16_buf = (int16_t const *)iq_buf + 2 * pos;
+        for (unsigned i = 0; i < 2 * len; ++i) {
+            tile[i] = cs16_buf[i];
+        }
+    }
+
+    if (!dec->shift) {
+        return;
+    }
+    // mix down by e^(-j phase), sin(phase) is cos(phase - pi/2)
+    uint32_t phase = dec->nco_phase;
+    uint32_t step  = dec->nco_step;
+    for (unsigned i = 0; i < len; ++i) {
+        unsigned idx = phase >> (32 - NCO_BITS);
+        int32_t c  = dec->nco_table[idx];
+        int32_t s  = dec->nco_table[(idx - NCO_SIZE / 4) & (NCO_SIZE - 1)];
+        int32_t xr = tile[2 * i];
+        int32_t xi = tile[2 * i + 1];
+        tile[2 * i]     = xr * c + xi * s;
+        tile[2 * i + 1] = xi * c - xr * s;
+        phase += step;
+    }
+    dec->nco_phase = phase;
+}
+
+// Run a tile through the CIC filter into the half-band filter, returns the number of output samples
+static unsigned cic_tile(decimator_t *dec, int32_t const *tile, unsigned len, float scale, int16_t *out)
+{
+    unsigned n_out = 0;
+    unsigned phase = dec->cic_phase;
+    // keep the integrators in locals, CIC_ORDER is 4
+    uint64_t i0r = dec->integ[0][0], i1r = dec->integ[1][0], i2r = dec->integ[2][0], i3r = dec->integ[3][0];
+    uint64_t i0i = dec->integ[0][1], i1i = dec->integ[1][1], i2i = dec->integ[2][1], i3i = dec->integ[3][1];
+    for (unsigned i = 0; i < len; ++i) {
+        i0r += (uint64_t)(int64_t)tile[2 * i];
+        i0i += (uint64_t)(int64_t)tile[2 * i + 1];
+        i1r += i0r;
+        i1i += i0i;
+        i2r += i1r;
+        i2i += i1i;
+        i3r += i2r;
+        i3i += i2i;
+        if (++phase < dec->cic_rate) {
+            continue;
+        }
+        phase = 0;
+        uint64_t vr = i3r;
+        uint64_t vi = i3i;
+        for (unsigned s = 0; s < CIC_ORDER; ++s) {
+            uint64_t dr = vr - dec->comb[s][0];
+            uint64_t di = vi - dec->comb[s][1];
+            dec->comb[s][0] = vr;
+            dec->comb[s][1] = vi;
+            vr = dr;
+            vi = di;
+        }
+        n_out += halfband_push(dec, (float)(int64_t)vr, (float)(int64_t)vi, scale, &out[2 * n_out]);
+    }
+    dec->integ[0][0] = i0r, dec->integ[1][0] = i1r, dec->integ[2][0] = i2r, dec->integ[3][0] = i3r;
+    dec->integ[0][1] = i0i, dec->integ[1][1] = i1i, dec->integ[2][1] = i2i, dec->integ[3][1] = i3i;
+    dec->cic_phase = phase;
+    return n_out;
+}
+
+int decimator_process(decimator_t *dec, void const *iq_buf, int sample_size, uint32_t len, uint32_t samp_rate)
+{
+    uint32_t need = (dec->cic_phase + dec->hb_phase * dec->cic_rate + len) / dec->factor;
+    if (need > dec->out_size) {
+        int16_t *out = realloc(dec->out, need * 2 * sizeof(*out));
+        if (!out) {
+            WARN_REALLOC("decimator_process()");
+            return -1;
+        }
+        dec->out      = out;
+        dec->out_size = need;
+    }
+
+    if (dec->nco_rate != samp_rate) {
+        dec->nco_rate = samp_rate;
+        dec->nco_step = samp_rate ? (uint32_t)(int64_t)(4294967296.0 * dec->shift / samp_rate) : 0;
+    }
+
+    // CU8 is read as 2x - 255, scale that to Q0.15 and undo the NCO and CIC gains
+    float scale = (float)((sample_size == 2 ? 128.0 : 1.0) / (dec->cic_gain * (dec->shift ? 16384.0 : 1.0)));
+
+    unsigned n_out = 0;
+    int32_t tile[2 * DECIMATOR_TILE_LEN];
+    for (uint32_t pos = 0; pos < len; pos += DECIMATOR_TILE_LEN) {
+        unsigned tile_len = len - pos < DECIMATOR_TILE_LEN ? len - pos : DECIMATOR_TILE_LEN;
+        load_tile(dec, iq_buf, sample_size, pos, tile_len, tile);
+        if (dec->cic_rate == 1) {
+            for (unsigned i = 0; i < tile_len; ++i) {
+                n_out += halfband_push(dec, (float)tile[2 * i], (float)tile[2 * i + 1], scale, &dec->out[2 * n_out]);
+            }
+        }
+        else {
+            n_out += cic_tile(dec, tile, tile_len, scale, &dec->out[2 * n_out]);
+        }
+    }
+
+    return n_out;
+}
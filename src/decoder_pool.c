@@ -0,0 +1,241 @@
+/** @file
+    Runs the decoders of a priority on a worker pool.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "decoder_pool.h"
+
+#include "worker_pool.h"
+#include "r_device.h"
+#include "bitbuffer.h"
+#include "r_api.h"
+#include "data.h"
+#include "list.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct decoder_output {
+    struct r_cfg *cfg;
+    data_t *data;
+    int level;
+} decoder_output_t;
+
+typedef struct decoder_job {
+    decoder_pool_t *pool;
+    r_device *decoder;
+    unsigned next;    ///< index of the next job of the same slice group, 0 if none
+    unsigned current; ///< index of the job of this chain being run, only used on the first job
+    unsigned hits;    ///< sum of the hit rates of the chain, only used on the first job
+    int events;
+    list_t output;    ///< output kept while the decoder runs, replayed after the batch
+} decoder_job_t;
+
+struct decoder_pool {
+    worker_pool_t *workers;
+    unsigned threads;
+    bitbuffer_t *scratch; ///< scratch bits for each worker
+    decoder_pool_fn fn;
+    void *ctx;
+    unsigned size;        ///< capacity of the jobs and chains
+    decoder_job_t *jobs;  ///< one job for each decoder of the batch, in order
+    void **chains;        ///< the first job of each chain, the args of the tasks
+    unsigned tails_size;  ///< capacity of the tails and heads
+    unsigned *tails;      ///< index plus one of the last job of each slice group, 0 if none yet
+    unsigned *heads;      ///< index into the chains of each slice group, only valid with a tail
+};
+
+decoder_pool_t *decoder_pool_create(unsigned threads)
+{
+    worker_pool_t *workers = worker_pool_create(threads);
+    if (!workers) {
+        return NULL;
+    }
+
+    decoder_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        WARN_CALLOC("decoder_pool_create()");
+        worker_pool_free(workers);
+        return NULL;
+    }
+    pool->workers = workers;
+    pool->threads = threads;
+    pool->scratch = calloc(threads, sizeof(*pool->scratch));
+    if (!pool->scratch) {
+        WARN_CALLOC("decoder_pool_create()");
+        decoder_pool_free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void decoder_pool_free(decoder_pool_t *pool)
+{
+    if (!pool)
+        return;
+
+    worker_pool_free(pool->workers);
+    for (unsigned i = 0; i < pool->size; ++i) {
+        list_free_elems(&pool->jobs[i].output, NULL);
+    }
+    free(pool->jobs);
+    free(pool->chains);
+    free(pool->tails);
+    free(pool->heads);
+    free(pool->scratch);
+    free(pool);
+}
+
+static void decoder_pool_reserve(decoder_pool_t *pool, unsigned count, unsigned groups)
+{
+    if (count > pool->size) {
+        decoder_job_t *jobs = realloc(pool->jobs, count * sizeof(*jobs));
+        if (!jobs) {
+            FATAL_REALLOC("decoder_pool_run()");
+        }
+        memset(&jobs[pool->size], 0, (count - pool->size) * sizeof(*jobs));
+        pool->jobs = jobs;
+        void **chains = realloc(pool->chains, count * sizeof(*chains));
+        if (!chains) {
+            FATAL_REALLOC("decoder_pool_run()");
+        }
+        pool->chains = chains;
+        pool->size   = count;
+    }
+    if (groups > pool->tails_size) {
+        unsigned *tails = realloc(pool->tails, groups * sizeof(*tails));
+        if (!tails) {
+            FATAL_REALLOC("decoder_pool_run()");
+        }
+        pool->tails = tails;
+        unsigned *heads = realloc(pool->heads, groups * sizeof(*heads));
+        if (!heads) {
+            FATAL_REALLOC("decoder_pool_run()");
+        }
+        pool->heads      = heads;
+        pool->tails_size = groups;
+    }
+}
+
+// order the chains by hit rate, then by position, both ascending
+static int decoder_chain_cmp(void const *a, void const *b)
+{
+    decoder_job_t const *x = *(decoder_job_t *const *)a;
+    decoder_job_t const *y = *(decoder_job_t *const *)b;
+    if (x->hits != y->hits)
+        return x->hits < y->hits ? -1 : 1;
+    return x < y ? -1 : x > y;
+}
+
+static void decoder_chain_task(void *arg)
+{
+    decoder_job_t *first = arg;
+    decoder_pool_t *pool = first->pool;
+    bitbuffer_t *bits = &pool->scratch[worker_pool_current_worker(pool->workers)];
+    unsigned i = (unsigned)(first - pool->jobs);
+    do {
+        decoder_job_t *job = &pool->jobs[i];
+        first->current = i;
+        job->events    = pool->fn(job->decoder, bits, pool->ctx);
+        i = job->next;
+    } while (i);
+}
+
+int decoder_pool_run(decoder_pool_t *pool, void **decoders, unsigned count, decoder_pool_fn fn, void *ctx)
+{
+    unsigned groups = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        r_device *r_dev = decoders[i];
+        if (r_dev->slice_group >= groups)
+            groups = r_dev->slice_group + 1;
+    }
+    decoder_pool_reserve(pool, count, groups);
+    for (unsigned i = 0; i < count; ++i) {
+        r_device *r_dev = decoders[i];
+        pool->tails[r_dev->slice_group] = 0;
+    }
+
+    // chain the decoders of each slice group, they share the cached bits
+    unsigned chains = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        decoder_job_t *job = &pool->jobs[i];
+        job->pool    = pool;
+        job->decoder = decoders[i];
+        job->next    = 0;
+        job->hits    = job->decoder->hit_rate;
+        job->events  = 0;
+        unsigned group = job->decoder->slice_group;
+        if (group && pool->tails[group]) {
+            pool->jobs[pool->tails[group] - 1].next = i;
+            decoder_job_t *first = pool->chains[pool->heads[group]];
+            first->hits += job->hits;
+        }
+        else {
+            if (group)
+                pool->heads[group] = chains;
+            pool->chains[chains++] = job;
+        }
+        if (group) {
+            pool->tails[group] = i + 1;
+        }
+    }
+
+    // a worker runs its own tasks from the end, the hot chains are started first and the cold ones are left to steal
+    qsort(pool->chains, chains, sizeof(*pool->chains), decoder_chain_cmp);
+
+    pool->fn  = fn;
+    pool->ctx = ctx;
+    worker_pool_run(pool->workers, decoder_chain_task, pool->chains, chains);
+
+    // replay the output in the order of the decoders
+    int events = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        decoder_job_t *job = &pool->jobs[i];
+        events += job->events;
+        for (size_t k = 0; k < job->output.len; ++k) {
+            decoder_output_t *out = job->output.elems[k];
+            output_data(out->cfg, out->data, out->level);
+            free(out);
+        }
+        list_clear(&job->output, NULL);
+    }
+    return events;
+}
+
+int decoder_pool_is_current(decoder_pool_t *pool)
+{
+    return pool && worker_pool_current_task(pool->workers) >= 0;
+}
+
+int decoder_pool_keep_output(decoder_pool_t *pool, struct r_cfg *cfg, data_t *data, int level)
+{
+    if (!pool)
+        return 0;
+
+    int k = worker_pool_current_task(pool->workers);
+    if (k < 0) {
+        return 0;
+    }
+    decoder_job_t *first = pool->chains[k];
+    decoder_job_t *job   = &pool->jobs[first->current];
+
+    decoder_output_t *out = malloc(sizeof(*out));
+    if (!out) {
+        WARN_MALLOC("decoder_pool_keep_output()");
+        data_free(data);
+        return 1;
+    }
+    out->cfg   = cfg;
+    out->data  = data;
+    out->level = level;
+    list_push(&job->output, out);
+    return 1;
+}
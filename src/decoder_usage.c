@@ -0,0 +1,198 @@
+/** @file
+    Usage of each decoder, for a config of the protocols seen at a site.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "decoder_usage.h"
+
+#include "compat_pthread.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct usage_entry {
+    unsigned protocol_num; ///< 0 if kept by name
+    char *name;
+    uint64_t ok;
+    uint64_t aborts;
+    uint64_t cpu_ns;
+} usage_entry_t;
+
+struct decoder_usage {
+    usage_entry_t *entries;
+    unsigned num_entries;
+    unsigned size;
+#ifdef THREADS
+    pthread_mutex_t lock; ///< the receivers flush their stats from their own threads
+#endif
+};
+
+decoder_usage_t *decoder_usage_create(void)
+{
+    decoder_usage_t *usage = calloc(1, sizeof(*usage));
+    if (!usage) {
+        WARN_CALLOC("decoder_usage_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+#ifdef THREADS
+    pthread_mutex_init(&usage->lock, NULL);
+#endif
+    return usage;
+}
+
+void decoder_usage_free(decoder_usage_t *usage)
+{
+    if (!usage)
+        return;
+
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        free(usage->entries[i].name);
+    }
+    free(usage->entries);
+#ifdef THREADS
+    pthread_mutex_destroy(&usage->lock);
+#endif
+    free(usage);
+}
+
+static usage_entry_t *find_entry(decoder_usage_t *usage, unsigned protocol_num, char const *name)
+{
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        usage_entry_t *e = &usage->entries[i];
+        if (protocol_num ? e->protocol_num == protocol_num : !e->protocol_num && !strcmp(e->name, name))
+            return e;
+    }
+
+    if (usage->num_entries == usage->size) {
+        unsigned size           = usage->size ? usage->size * 2 : 64;
+        usage_entry_t *entries = realloc(usage->entries, size * sizeof(*entries));
+        if (!entries) {
+            WARN_REALLOC("decoder_usage_add()");
+            return NULL;
+        }
+        usage->entries = entries;
+        usage->size    = size;
+    }
+    char *dup = strdup(name);
+    if (!dup) {
+        WARN_STRDUP("decoder_usage_add()");
+        return NULL;
+    }
+    usage_entry_t *e = &usage->entries[usage->num_entries++];
+    *e               = (usage_entry_t){.protocol_num = protocol_num, .name = dup};
+    return e;
+}
+
+decoder_usage_t *decoder_usage_clone(decoder_usage_t *usage)
+{
+    decoder_usage_t *clone = decoder_usage_create();
+    if (!clone)
+        return NULL;
+#ifdef THREADS
+    pthread_mutex_lock(&usage->lock);
+#endif
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        usage_entry_t const *e = &usage->entries[i];
+        usage_entry_t *c       = find_entry(clone, e->protocol_num, e->name);
+        if (!c) {
+            decoder_usage_free(clone);
+            clone = NULL;
+            break;
+        }
+        c->ok     = e->ok;
+        c->aborts = e->aborts;
+        c->cpu_ns = e->cpu_ns;
+    }
+#ifdef THREADS
+    pthread_mutex_unlock(&usage->lock);
+#endif
+    return clone;
+}
+
+void decoder_usage_add(decoder_usage_t *usage, unsigned protocol_num, char const *name, unsigned ok, unsigned aborts, uint64_t cpu_ns)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&usage->lock);
+#endif
+    usage_entry_t *e = find_entry(usage, protocol_num, name ? name : "");
+    if (e) {
+        e->ok += ok;
+        e->aborts += aborts;
+        e->cpu_ns += cpu_ns;
+    }
+#ifdef THREADS
+    pthread_mutex_unlock(&usage->lock);
+#endif
+}
+
+unsigned decoder_usage_seen(decoder_usage_t const *usage)
+{
+    unsigned seen = 0;
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        seen += usage->entries[i].ok > 0;
+    }
+    return seen;
+}
+
+// the decoders seen first by protocol number, the flex decoders last, then the others by time spent
+static int entry_cmp(void const *a, void const *b)
+{
+    usage_entry_t const *ea = *(usage_entry_t const *const *)a;
+    usage_entry_t const *eb = *(usage_entry_t const *const *)b;
+    if ((ea->ok > 0) != (eb->ok > 0))
+        return ea->ok > 0 ? -1 : 1;
+    if (!ea->ok && ea->cpu_ns != eb->cpu_ns)
+        return ea->cpu_ns > eb->cpu_ns ? -1 : 1;
+    if (!ea->protocol_num != !eb->protocol_num)
+        return ea->protocol_num ? -1 : 1;
+    if (ea->protocol_num != eb->protocol_num)
+        return ea->protocol_num < eb->protocol_num ? -1 : 1;
+    return strcmp(ea->name, eb->name);
+}
+
+int decoder_usage_write(decoder_usage_t const *usage, FILE *fp, double seconds)
+{
+    usage_entry_t const **sorted = malloc((usage->num_entries + 1) * sizeof(*sorted));
+    if (!sorted) {
+        WARN_MALLOC("decoder_usage_write()");
+        return -1;
+    }
+    uint64_t total_ns = 0;
+    uint64_t saved_ns = 0;
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        sorted[i] = &usage->entries[i];
+        total_ns += usage->entries[i].cpu_ns;
+        saved_ns += usage->entries[i].ok ? 0 : usage->entries[i].cpu_ns;
+    }
+    qsort(sorted, usage->num_entries, sizeof(*sorted), entry_cmp);
+
+    unsigned seen = decoder_usage_seen(usage);
+    fprintf(fp, "# The protocols decoded in %.0f s, written by rtl_433 -M usage.\n", seconds);
+    fprintf(fp, "# %u of %u decoders decoded a message, the others used %.1f%% of the decoder time,\n",
+            seen, usage->num_entries, total_ns ? 100.0 * saved_ns / total_ns : 0.0);
+    fprintf(fp, "# %.1f s or %.2f%% of a CPU core, this is saved with the protocols below.\n\n",
+            saved_ns / 1e9, seconds > 0.0 ? 100.0 * saved_ns / 1e9 / seconds : 0.0);
+
+    for (unsigned i = 0; i < usage->num_entries; ++i) {
+        usage_entry_t const *e = sorted[i];
+        if (i == seen)
+            fprintf(fp, "\n# Not decoded, by the time spent:\n");
+        // a flex decoder needs its spec, it is only named
+        char const *prefix = e->ok ? "" : "# ";
+        if (e->protocol_num)
+            fprintf(fp, "%sprotocol %u # %s", prefix, e->protocol_num, e->name);
+        else
+            fprintf(fp, "# %s the decoder \"%s\"", e->ok ? "keep" : "drop", e->name);
+        fprintf(fp, ", %llu decoded, %llu aborted, %.3f s\n",
+                (unsigned long long)e->ok, (unsigned long long)e->aborts, e->cpu_ns / 1e9);
+    }
+    free(sorted);
+    return ferror(fp) ? -1 : 0;
+}
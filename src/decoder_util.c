@@ -12,6 +12,8 @@
 #include "decoder_util.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include "preamble_matcher.h"
+#include "manchester_view.h"
 #include "fatal.h"
 
 // create decoder functions
@@ -33,6 +35,7 @@ r_device *decoder_create(r_device const *dev_template, unsigned user_data_size)
             free(r_dev);
             return NULL; // NOTE: returns NULL on alloc failure.
         }
+        r_dev->decode_ctx_size = user_data_size;
     }
 
     return r_dev;
@@ -43,6 +46,29 @@ void *decoder_user_data(r_device *decoder)
     return decoder->decode_ctx;
 }
 
+unsigned decoder_search_preamble(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned start)
+{
+    preamble_scan_t *scan = decoder->preamble_scan;
+    if (scan && scan->bits == bitbuffer) {
+        unsigned pos = preamble_scan_find(scan, decoder->preamble_slot, row, start);
+        if (pos != PREAMBLE_SCAN_UNKNOWN)
+            return pos;
+    }
+    return bitbuffer_search(bitbuffer, row, start, decoder->preamble.pattern, decoder->preamble.bits);
+}
+
+unsigned decoder_manchester_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        bitbuffer_t *outbuf, unsigned max)
+{
+    manchester_view_t *view = decoder->manchester_view;
+    if (view) {
+        unsigned pos = manchester_view_decode(view, bitbuffer, row, start, outbuf, max);
+        if (pos != MANCHESTER_VIEW_UNKNOWN)
+            return pos;
+    }
+    return bitbuffer_manchester_decode(bitbuffer, row, start, outbuf, max);
+}
+
 // output functions
 
 void decoder_output_log(r_device *decoder, int level, data_t *data)
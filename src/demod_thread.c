@@ -0,0 +1,366 @@
+/** @file
+    Demodulation worker thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "demod_thread.h"
+
+#include "data.h"
+#include "logger.h"
+#include "fatal.h"
+#include "mongoose.h"
+#include "compat_pthread.h"
+#include "thread_sched.h"
+
+#include <stdlib.h>
+#include <signal.h>
+
+#ifdef THREADS
+
+/// Room for the control events next to the data events, a data event holds a ring slot and is never dropped.
+#define DEMOD_CONTROL_EVENTS 16
+
+typedef struct demod_output {
+    struct demod_output *next;
+    data_t *data;
+    int level;
+} demod_output_t;
+
+struct demod_thread {
+    struct mg_mgr *mgr;
+    struct mg_connection *wake_nc; ///< dummy connection to receive our wake up broadcasts
+    demod_process_fn process;
+    demod_deliver_fn deliver;
+    void *ctx;
+
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the event queue and the output queue
+    pthread_cond_t cond;  ///< signals queued events and state changes
+
+    sdr_event_t *events;  ///< event queue ring buffer
+    unsigned queue_size;  ///< event queue capacity
+    unsigned queue_head;  ///< next event to process
+    unsigned queue_len;   ///< number of queued events
+    unsigned queue_data;  ///< number of queued data events
+    unsigned dropped;     ///< control events dropped because their room was full
+    unsigned reported;    ///< dropped count already reported
+    unsigned merge_len;   ///< merge adjacent data buffers up to this many bytes, 0 to disable
+    int busy;             ///< an event is being processed
+    int exit_thread;      ///< request the thread to exit
+
+    demod_output_t *output_head; ///< output data waiting for the event loop
+    demod_output_t *output_tail;
+};
+
+// the dummy nc only receives polls and broadcasts, all handled in output_handler()
+static void wake_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    (void)nc;
+    (void)ev_type;
+    (void)ev_data;
+}
+
+// called by mg_mgr_poll() for each connection.
+static void output_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    (void)ev_data;
+    // only process a broadcast on our wake up nc, the user_data is cleared on stop
+    if (ev_type != MG_EV_POLL || nc->handler != wake_handler || !nc->user_data) {
+        return;
+    }
+    demod_thread_flush(nc->user_data);
+}
+
+// merge queued data buffers that follow the event in the ring, the lock must be held
+static void merge_queued_data(demod_thread_t *dt, sdr_event_t *ev)
+{
+    while (dt->queue_len > 0) {
+        sdr_event_t const *next = &dt->events[dt->queue_head];
+        if (next->ev != SDR_EV_DATA
+                || next->buf != (uint8_t *)ev->buf + ev->len
+                || next->dropped || next->overflows || next->settle || next->lost
+                || ev->leased || next->leased
+                || next->sample_rate != ev->sample_rate
+                || next->center_frequency != ev->center_frequency
+                || (unsigned)(ev->len + next->len) > dt->merge_len) {
+            return;
+        }
+        ev->len       += next->len;
+        ev->merged    += 1 + next->merged;
+        ev->publish_ns = next->publish_ns;
+        dt->queue_head = (dt->queue_head + 1) % dt->queue_size;
+        dt->queue_len -= 1;
+        dt->queue_data -= 1;
+    }
+}
+
+static THREAD_RETURN THREAD_CALL demod_thread_run(void *arg)
+{
+    demod_thread_t *dt = arg;
+    thread_sched_apply(THREAD_ROLE_DEMOD);
+
+    pthread_mutex_lock(&dt->lock);
+    while (!dt->exit_thread) {
+        if (dt->queue_len == 0) {
+            pthread_cond_wait(&dt->cond, &dt->lock);
+            continue;
+        }
+        sdr_event_t ev = dt->events[dt->queue_head];
+        dt->queue_head = (dt->queue_head + 1) % dt->queue_size;
+        dt->queue_len -= 1;
+        if (ev.ev & SDR_EV_DATA) {
+            dt->queue_data -= 1;
+        }
+        if (dt->merge_len && ev.ev == SDR_EV_DATA) {
+            merge_queued_data(dt, &ev);
+        }
+        unsigned dropped = dt->dropped;
+        dt->busy = 1;
+        pthread_mutex_unlock(&dt->lock);
+
+        if (dropped != dt->reported) {
+            print_logf(LOG_WARNING, "Input", "Demodulation too slow, dropped %u SDR control events.", dropped - dt->reported);
+            dt->reported = dropped;
+        }
+        dt->process(&ev, dt->ctx);
+
+        pthread_mutex_lock(&dt->lock);
+        dt->busy = 0;
+        pthread_cond_broadcast(&dt->cond);
+    }
+    pthread_mutex_unlock(&dt->lock);
+
+    return (THREAD_RETURN)(0);
+}
+
+demod_thread_t *demod_thread_start(struct mg_mgr *mgr, unsigned queue_size, demod_process_fn process, demod_deliver_fn deliver, void *ctx)
+{
+    demod_thread_t *dt = calloc(1, sizeof(*dt));
+    if (!dt) {
+        WARN_CALLOC("demod_thread_start()");
+        return NULL;
+    }
+    queue_size += DEMOD_CONTROL_EVENTS;
+    dt->events = calloc(queue_size, sizeof(*dt->events));
+    if (!dt->events) {
+        WARN_CALLOC("demod_thread_start()");
+        free(dt);
+        return NULL;
+    }
+    dt->mgr        = mgr;
+    dt->queue_size = queue_size;
+    dt->process    = process;
+    dt->deliver    = deliver;
+    dt->ctx        = ctx;
+
+    struct mg_add_sock_opts opts = {.user_data = dt};
+    dt->wake_nc = mg_add_sock_opt(mgr, INVALID_SOCKET, wake_handler, opts);
+    if (!dt->wake_nc) {
+        print_log(LOG_ERROR, __func__, "failed to add the wake up connection");
+        free(dt->events);
+        free(dt);
+        return NULL;
+    }
+
+    pthread_mutex_init(&dt->lock, NULL);
+    pthread_cond_init(&dt->cond, NULL);
+
+#ifndef _WIN32
+    // Block all signals from the worker thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&dt->thread, NULL, demod_thread_run, dt);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+        pthread_mutex_destroy(&dt->lock);
+        pthread_cond_destroy(&dt->cond);
+        dt->wake_nc->user_data = NULL;
+        dt->wake_nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        free(dt->events);
+        free(dt);
+        return NULL;
+    }
+
+    return dt;
+}
+
+void demod_thread_stop(demod_thread_t *dt)
+{
+    if (!dt)
+        return;
+
+    pthread_mutex_lock(&dt->lock);
+    dt->exit_thread = 1;
+    dt->queue_len   = 0;
+    dt->queue_data  = 0;
+    pthread_cond_broadcast(&dt->cond);
+    pthread_mutex_unlock(&dt->lock);
+
+    pthread_join(dt->thread, NULL);
+
+    // deliver what the thread produced last
+    demod_thread_flush(dt);
+
+    // wake up broadcasts might still be pending
+    dt->wake_nc->user_data = NULL;
+    dt->wake_nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+
+    pthread_mutex_destroy(&dt->lock);
+    pthread_cond_destroy(&dt->cond);
+    free(dt->events);
+    free(dt);
+}
+
+int demod_thread_push(demod_thread_t *dt, sdr_event_t const *ev)
+{
+    int r    = 0;
+    int data = ev->ev & SDR_EV_DATA;
+    pthread_mutex_lock(&dt->lock);
+    // the control events have room of their own, the data events can not outnumber the ring slots
+    if (dt->queue_len >= dt->queue_size || (!data && dt->queue_len - dt->queue_data >= DEMOD_CONTROL_EVENTS)) {
+        dt->dropped += 1;
+        r = -1;
+    }
+    else {
+        dt->events[(dt->queue_head + dt->queue_len) % dt->queue_size] = *ev;
+        dt->queue_len += 1;
+        dt->queue_data += data ? 1 : 0;
+        pthread_cond_broadcast(&dt->cond);
+    }
+    pthread_mutex_unlock(&dt->lock);
+    return r;
+}
+
+void demod_thread_set_merge(demod_thread_t *dt, unsigned merge_len)
+{
+    pthread_mutex_lock(&dt->lock);
+    dt->merge_len = merge_len;
+    pthread_mutex_unlock(&dt->lock);
+}
+
+void demod_thread_drain(demod_thread_t *dt)
+{
+    if (!dt)
+        return;
+
+    pthread_mutex_lock(&dt->lock);
+    dt->queue_len  = 0;
+    dt->queue_data = 0;
+    while (dt->busy)
+        pthread_cond_wait(&dt->cond, &dt->lock);
+    pthread_mutex_unlock(&dt->lock);
+}
+
+int demod_thread_is_current(demod_thread_t *dt)
+{
+    return dt && pthread_equal(dt->thread, pthread_self());
+}
+
+void demod_thread_post(demod_thread_t *dt, data_t *data, int level)
+{
+    demod_output_t *out = malloc(sizeof(*out));
+    if (!out) {
+        WARN_MALLOC("demod_thread_post()");
+        data_free(data);
+        return;
+    }
+    out->next  = NULL;
+    out->data  = data;
+    out->level = level;
+
+    pthread_mutex_lock(&dt->lock);
+    int was_empty = !dt->output_head;
+    if (dt->output_tail)
+        dt->output_tail->next = out;
+    else
+        dt->output_head = out;
+    dt->output_tail = out;
+    pthread_mutex_unlock(&dt->lock);
+
+    // only wake the event loop if it has not been signalled already
+    if (was_empty)
+        mg_broadcast(dt->mgr, output_handler, NULL, 0);
+}
+
+void demod_thread_flush(demod_thread_t *dt)
+{
+    pthread_mutex_lock(&dt->lock);
+    demod_output_t *out = dt->output_head;
+    dt->output_head = NULL;
+    dt->output_tail = NULL;
+    pthread_mutex_unlock(&dt->lock);
+
+    while (out) {
+        demod_output_t *next = out->next;
+        dt->deliver(out->data, out->level, dt->ctx);
+        free(out);
+        out = next;
+    }
+}
+
+#else
+
+demod_thread_t *demod_thread_start(struct mg_mgr *mgr, unsigned queue_size, demod_process_fn process, demod_deliver_fn deliver, void *ctx)
+{
+    (void)mgr;
+    (void)queue_size;
+    (void)process;
+    (void)deliver;
+    (void)ctx;
+    return NULL;
+}
+
+void demod_thread_stop(demod_thread_t *dt)
+{
+    (void)dt;
+}
+
+int demod_thread_push(demod_thread_t *dt, sdr_event_t const *ev)
+{
+    (void)dt;
+    (void)ev;
+    return -1;
+}
+
+void demod_thread_set_merge(demod_thread_t *dt, unsigned merge_len)
+{
+    (void)dt;
+    (void)merge_len;
+}
+
+void demod_thread_drain(demod_thread_t *dt)
+{
+    (void)dt;
+}
+
+int demod_thread_is_current(demod_thread_t *dt)
+{
+    (void)dt;
+    return 0;
+}
+
+void demod_thread_post(demod_thread_t *dt, data_t *data, int level)
+{
+    (void)dt;
+    (void)level;
+    data_free(data);
+}
+
+void demod_thread_flush(demod_thread_t *dt)
+{
+    (void)dt;
+}
+
+#endif
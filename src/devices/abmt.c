@@ -39,7 +39,6 @@ static int abmt_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     int row;
     float temp_c;
-    bitbuffer_t packet_bits = {0};
     unsigned int id;
     unsigned bitpos = 0;
     uint8_t *b;
@@ -61,6 +60,7 @@ static int abmt_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_FAIL_SANITY;
 
     // sync bitstream
+    bitbuffer_t packet_bits = {0};
     bitbuffer_manchester_decode(bitbuffer, row, bitpos - SYNC_PATTERN_START_OFF, &packet_bits, 48);
     bitbuffer_invert(&packet_bits);
 
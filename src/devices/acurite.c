@@ -1144,6 +1144,55 @@ static int acurite_515_decode(r_device *decoder, bitbuffer_t *bitbuffer, uint8_t
     return 1;
 }
 
+/// Sub-decoders of the TXR family.
+enum acurite_txr_kind {
+    ACURITE_TXR_TOWER = 1,
+    ACURITE_TXR_1190,
+    ACURITE_TXR_6045,
+    ACURITE_TXR_515,
+    ACURITE_TXR_5N1,
+    ACURITE_TXR_3N1,
+    ACURITE_TXR_899,
+    ACURITE_TXR_ATLAS,
+};
+
+/// Route of a TXR message type to its checks and its sub-decoder.
+typedef struct {
+    uint8_t bytelen; ///< expected bytes including the checksum, 0 for unknown message types
+    uint8_t parity;  ///< parity and channel are checked besides the checksum
+    uint8_t kind;    ///< the sub-decoder, an acurite_txr_kind
+} acurite_txr_route_t;
+
+/// Routes indexed by the message type in the lower 6 bits of the 3rd byte.
+static acurite_txr_route_t const acurite_txr_routes[64] = {
+        [ACURITE_MSGTYPE_1190_DETECTOR]                  = {ACURITE_1190_BYTELEN, 1, ACURITE_TXR_1190},
+        [ACURITE_MSGTYPE_TOWER_SENSOR]                   = {ACURITE_TXR_BYTELEN, 1, ACURITE_TXR_TOWER},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM]          = {ACURITE_ATLAS_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN]              = {ACURITE_ATLAS_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX]            = {ACURITE_ATLAS_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_515_REFRIGERATOR]               = {ACURITE_515_BYTELEN, 1, ACURITE_TXR_515},
+        [ACURITE_MSGTYPE_515_FREEZER]                    = {ACURITE_515_BYTELEN, 1, ACURITE_TXR_515},
+        /*
+          @todo - does 3n1 use parity checking?
+          3n1 g001 in rtl_433_test has odd parity the 2nd to last byte in both copies
+          but g002 passes parity check
+        */
+        [ACURITE_MSGTYPE_3N1_WINDSPEED_TEMP_HUMIDITY]    = {ACURITE_3N1_BYTELEN, 0, ACURITE_TXR_3N1},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM_LTNG]     = {ACURITE_ATLAS_LTNG_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN_LTNG]         = {ACURITE_ATLAS_LTNG_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX_LTNG]       = {ACURITE_ATLAS_LTNG_BYTELEN, 1, ACURITE_TXR_ATLAS},
+        [ACURITE_MSGTYPE_6045M]                          = {ACURITE_6045_BYTELEN, 1, ACURITE_TXR_6045},
+        /*
+          @todo - does the 899 use parity checking?
+          The available sample shows a parity bit in the message byte
+          but there isn't enough accumulated rain in the data bytes
+          to see if parity is used
+        */
+        [ACURITE_MSGTYPE_899_RAINFALL]                   = {ACURITE_899_BYTELEN, 1, ACURITE_TXR_899},
+        [ACURITE_MSGTYPE_5N1_WINDSPEED_WINDDIR_RAINFALL] = {ACURITE_5N1_BYTELEN, 1, ACURITE_TXR_5N1},
+        [ACURITE_MSGTYPE_5N1_WINDSPEED_TEMP_HUMIDITY]    = {ACURITE_5N1_BYTELEN, 1, ACURITE_TXR_5N1},
+};
+
 /**
 Check Acurite TXR message integrity (length, checksum, parity)
 
@@ -1155,8 +1204,10 @@ Return 0 for valid roe or DECODE_ABORT_LENGHT, DECODE_FAIL_MIC, DECODE_FAIL_SANI
 Long rows with extra bits/bytes (from demod/bit slicing)
 will be accepted as long the bytes up to the expected length
 pass checksum and parity tests.
+
+Without parity only the length and the checksum are checked.
 */
-static int acurite_txr_check(r_device *decoder, uint8_t const bb[], unsigned browlen, unsigned explen)
+static int acurite_txr_check(r_device *decoder, uint8_t const bb[], unsigned browlen, unsigned explen, int parity_check)
 {
 
     // Currently shortest Acurite "TXR" message is 6 bytes
@@ -1178,6 +1229,9 @@ static int acurite_txr_check(r_device *decoder, uint8_t const bb[], unsigned bro
         return DECODE_FAIL_MIC;
     }
 
+    if (!parity_check)
+        return 0;
+
     // Verify parity bits
     // Bytes 2 ... n-1 should all have even parity
     // (ID bytes and checksum byte are all 8 bit, so no parity check)
@@ -1237,8 +1291,6 @@ static int acurite_txr_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint8_t *bb;
     uint8_t message_type;
 
-    bitbuffer_invert(bitbuffer);
-
     for (uint16_t brow = 0; brow < bitbuffer->num_rows; ++brow) {
         int row_bit_cnt = bitbuffer->bits_per_row[brow];
         int browlen = row_bit_cnt / 8;  // assumption: safe to round down, extra bits are spurious
@@ -1275,178 +1327,39 @@ static int acurite_txr_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         // M = Message type
         message_type = bb[2] & 0x3f;
 
-        // Check so that unknown message type can be flagged
-        // and dispatching to decoders can be easier to maintain
-        switch(message_type) {
-            case ACURITE_MSGTYPE_1190_DETECTOR:
-            case ACURITE_MSGTYPE_TOWER_SENSOR:
-            case ACURITE_MSGTYPE_6045M:
-            case ACURITE_MSGTYPE_5N1_WINDSPEED_WINDDIR_RAINFALL:
-            case ACURITE_MSGTYPE_5N1_WINDSPEED_TEMP_HUMIDITY:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM_LTNG:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN_LTNG:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX_LTNG:
-            case ACURITE_MSGTYPE_515_REFRIGERATOR:
-            case ACURITE_MSGTYPE_515_FREEZER:
-            case ACURITE_MSGTYPE_3N1_WINDSPEED_TEMP_HUMIDITY:
-            case ACURITE_MSGTYPE_899_RAINFALL:
-                break;
-
-            default:
-                decoder_log_bitrow(decoder, 1, __func__, bb, row_bit_cnt,
-                                   "Unknown message type");
-                error_ret = DECODE_FAIL_SANITY;
-                continue;
-                break;
+        // Flag unknown message types, the routes keep dispatching easy to maintain
+        acurite_txr_route_t const *route = &acurite_txr_routes[message_type];
+        if (!route->bytelen) {
+            decoder_log_bitrow(decoder, 1, __func__, bb, row_bit_cnt,
+                               "Unknown message type");
+            error_ret = DECODE_FAIL_SANITY;
+            continue;
         }
 
-        // Check message type and dispatch to appropriate decoders
+        // Check the row once, then dispatch to the one decoder of the message type
         // NOTE: since we are processing each row, do not return
         // until all rows have been processed
-        if (message_type == ACURITE_MSGTYPE_TOWER_SENSOR) {
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_TXR_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                    if ((ret = acurite_tower_decode(decoder, bitbuffer, bb)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
-            }
-        }
-
-        if (message_type == ACURITE_MSGTYPE_1190_DETECTOR) {
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_1190_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                if ((ret = acurite_1190_decode(decoder, bitbuffer, bb)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
-            }
-        }
-
-        if (message_type == ACURITE_MSGTYPE_6045M) {
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_6045_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                if ((ret = acurite_6045_decode(decoder, bitbuffer, brow)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
-            }
-        }
-
-        if (message_type == ACURITE_MSGTYPE_515_REFRIGERATOR ||
-            message_type == ACURITE_MSGTYPE_515_FREEZER) {
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_515_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                if ((ret = acurite_515_decode(decoder, bitbuffer, bb)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
-            }
-        }
-
-        if (message_type == ACURITE_MSGTYPE_5N1_WINDSPEED_TEMP_HUMIDITY ||
-            message_type == ACURITE_MSGTYPE_5N1_WINDSPEED_WINDDIR_RAINFALL) {
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_5N1_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                if ((ret = acurite_5n1_decode(decoder, bitbuffer, bb)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
+        if ((ret = acurite_txr_check(decoder, bb, browlen, route->bytelen, route->parity)) != 0) {
+            error_ret = ret;
+        } else {
+            switch (route->kind) {
+                case ACURITE_TXR_TOWER: ret = acurite_tower_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_1190:  ret = acurite_1190_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_6045:  ret = acurite_6045_decode(decoder, bitbuffer, brow); break;
+                case ACURITE_TXR_515:   ret = acurite_515_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_5N1:   ret = acurite_5n1_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_3N1:   ret = acurite_3n1_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_899:   ret = acurite_899_decode(decoder, bitbuffer, bb); break;
+                case ACURITE_TXR_ATLAS: ret = acurite_atlas_decode(decoder, bitbuffer, brow); break;
+                default:                ret = 0; break;
             }
-        }
-
-        if (message_type == ACURITE_MSGTYPE_3N1_WINDSPEED_TEMP_HUMIDITY) {
-            /*
-              @todo - does 3n1 use parity checking?
-              3n1 g001 in rtl_433_test has odd parity the 2nd to last byte in both copies
-              but g002 passes parity check
-            */
-
-            if (browlen < ACURITE_3N1_BYTELEN) {
-                decoder_log_bitrow(decoder, 1, __func__, bb, browlen * 8, "3n1 wrong length");
-                error_ret = DECODE_ABORT_LENGTH;
-                continue;
-            }
-
-            if ((add_bytes(bb, ACURITE_3N1_BYTELEN - 1) & 0xff) !=
-                bb[ACURITE_3N1_BYTELEN - 1]) {
-                decoder_log_bitrow(decoder, 1, __func__, bb, browlen * 8, "bad checksum");
-                error_ret = DECODE_FAIL_MIC;
-                continue;
-            }
-
-            if ((ret = acurite_3n1_decode(decoder, bitbuffer, bb)) > 0) {
+            if (ret > 0) {
                 decoded += ret;
             } else if (ret < 0) {
                 error_ret = ret;
             }
         }
 
-        if (message_type == ACURITE_MSGTYPE_899_RAINFALL) {
-            /*
-              @todo - does the 899 use parity checking?
-              The available sample shows a parity bit in the message byte
-              but there isn't enough accumulated rain in the data bytes
-              to see if parity is used
-            */
-            if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_899_BYTELEN)) != 0) {
-                error_ret = ret;
-            } else {
-                if ((ret = acurite_899_decode(decoder, bitbuffer, bb)) > 0) {
-                    decoded += ret;
-                } else if (ret < 0) {
-                    error_ret = ret;
-                }
-            }
-        }
-
-        // process Atlas
-        switch(message_type) {
-            // Atlas messages without lightning sensor installed - 8 bytes
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX:
-                if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_ATLAS_BYTELEN)) != 0) {
-                    error_ret = ret;
-                } else {
-                    if ((ret = acurite_atlas_decode(decoder, bitbuffer, brow)) > 0) {
-                        decoded += ret;
-                    } else if (ret < 0) {
-                        error_ret = ret;
-                    }
-                }
-                break;
-
-            // Atlas messages with lightning sensor installed - 10 bytes
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_TEMP_HUM_LTNG:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_RAIN_LTNG:
-            case ACURITE_MSGTYPE_ATLAS_WNDSPD_UV_LUX_LTNG:
-                if ((ret = acurite_txr_check(decoder, bb, browlen, ACURITE_ATLAS_LTNG_BYTELEN)) != 0) {
-                    error_ret = ret;
-                } else {
-                    if ((ret = acurite_atlas_decode(decoder, bitbuffer, brow)) > 0) {
-                        decoded += ret;
-                    } else if (ret < 0) {
-                        error_ret = ret;
-                    }
-                }
-                break;
-
-        }
-
         decoder_logf(decoder, 2, __func__,
                      "stats: row %u, msg type 0x%02x, bytes %d, decoded %d, error %d",
                      brow, message_type, browlen, decoded, error_ret);
@@ -1754,7 +1667,6 @@ Acurite 00275rm Room Monitor sensors
 static int acurite_00275rm_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     int result = 0;
-    bitbuffer_invert(bitbuffer);
 
     // This sensor repeats a signal three times. Combine as fallback.
     uint8_t *b_rows[3] = {0};
@@ -1850,6 +1762,7 @@ r_device const acurite_rain_896 = {
         .gap_limit   = 3500,
         .reset_limit = 5000,
         .decode_fn   = &acurite_rain_896_decode,
+        .rows        = {.min_bits = 24},
         .priority    = 10, // Eliminate false positives by letting oregon scientific v1 protocol go earlier
         .fields      = acurite_rain_gauge_output_fields,
 };
@@ -1918,6 +1831,7 @@ r_device const acurite_txr = {
         .gap_limit   = 500,  // longest data gap is 392 us, sync gap is 596 us
         .reset_limit = 4000, // packet gap is 2192 us
         .decode_fn   = &acurite_txr_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = acurite_txr_output_fields,
 };
 
@@ -2022,6 +1936,7 @@ r_device const acurite_00275rm = {
         .reset_limit = 708, // no packet gap, sync gap is 592 us
         .sync_width  = 632, // sync pulse is 632 us
         .decode_fn   = &acurite_00275rm_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = acurite_00275rm_output_fields,
 };
 
@@ -54,7 +54,6 @@ Data layout:
 static int acurite_01185m_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     int result = 0;
-    bitbuffer_invert(bitbuffer);
 
     // Output the first valid row
     for (int row = 0; row < bitbuffer->num_rows; ++row) {
@@ -134,5 +133,6 @@ r_device const acurite_01185m = {
         .gap_limit   = 3000, // long gap is 2028 us, sync gap is 4080 us
         .reset_limit = 6000, // no packet gap, sync gap is 4080 us
         .decode_fn   = &acurite_01185m_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = acurite_01185m_output_fields,
 };
@@ -78,6 +78,7 @@ r_device const akhan_100F14 = {
         .sync_width  = 0,
         .tolerance   = 80, // us
         .decode_fn   = &akhan_rke_callback,
+        .rows        = {.min_bits = 25, .max_bits = 25},
         .fields      = output_fields,
         .disabled    = 1, // false positives with generic EV1527 devices
 };
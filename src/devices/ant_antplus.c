@@ -160,6 +160,7 @@ r_device const ant_antplus = {
         .gap_limit   = 500,
         .reset_limit = 500,
         .decode_fn   = &ant_antplus_decode,
+        .rows        = {.min_bits = 120, .max_bits = 200},
         .fields      = output_fields,
         .disabled    = 1, // disabled by default, because of higher than default sampling requirements (s = 4M)
 };
@@ -73,8 +73,6 @@ static int apator_metra_erm30_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY;
     }
 
-    bitbuffer_invert(bitbuffer);
-
     int row = 0;
     unsigned start_pos = bitbuffer_search(bitbuffer, row, 0, preamble, 8 * sizeof(preamble));
 
@@ -142,6 +140,7 @@ r_device const apator_metra_erm30 = {
     .long_width  = 25,
     .reset_limit = 5000,
     .decode_fn   = &apator_metra_erm30_decode,
+    .transform   = BITBUFFER_INVERTED,
     .fields      = output_fields,
 };
 
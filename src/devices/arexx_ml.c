@@ -74,7 +74,6 @@ static int arexx_ml_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->bits_per_row[0] < 64 || bitbuffer->bits_per_row[1] > 130) {
         return DECODE_ABORT_EARLY; // we expect around 88 to 104 bits
     }
-    bitbuffer_invert(bitbuffer);
 
     int msg_len = -1;
     uint8_t b[9]; // allow up to 9 byte messages
@@ -172,5 +171,6 @@ r_device const arexx_ml = {
         .long_width  = 208, // not used
         .reset_limit = 450,
         .decode_fn   = &arexx_ml_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = arexx_ml_output_fields,
 };
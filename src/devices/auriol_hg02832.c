@@ -50,8 +50,6 @@ static int auriol_hg02832_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->bits_per_row[0] != 1 || bitbuffer->bits_per_row[1] != 40)
         return DECODE_ABORT_LENGTH;
 
-    bitbuffer_invert(bitbuffer);
-
     b = bitbuffer->bb[1];
 
     // They tried to implement CRC-8 poly 0x31, but (accidentally?) reset the key every new byte.
@@ -110,5 +108,6 @@ r_device const auriol_hg02832 = {
         .gap_limit   = 750,
         .reset_limit = 62990, // 61ms packet gap
         .decode_fn   = &auriol_hg02832_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -248,9 +248,6 @@ static int blueline_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint16_t offset_payload_u16 = 0;
     uint8_t offset_payload_u8[BLUELINE_CRC_BYTELEN] = {0};
 
-    // Blueline uses inverted 0/1
-    bitbuffer_invert(bitbuffer);
-
     // Look at each row we just received independently
     for (row_index = 0; row_index < bitbuffer->num_rows; row_index++) {
         current_row = bitbuffer->bb[row_index];
@@ -429,6 +426,7 @@ r_device const blueline = {
         .gap_limit   = 2000,
         .reset_limit = 8000,
         .decode_fn   = &blueline_decode,
+        .transform   = BITBUFFER_INVERTED,
         .create_fn   = &blueline_create,
         .fields      = output_fields,
 };
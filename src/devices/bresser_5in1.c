@@ -64,10 +64,10 @@ Packet payload without preamble (203 bits):
 - B = battery, 0=Ok, 8=Low
 */
 
+static uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0xaa, 0x2d, 0xd4};
+
 static int bresser_5in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0xaa, 0x2d, 0xd4};
-
     data_t *data;
     uint8_t msg[26];
     uint16_t sensor_id;
@@ -80,8 +80,7 @@ static int bresser_5in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY; // Unrecognized data
     }
 
-    unsigned start_pos = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof (preamble_pattern) * 8);
+    unsigned start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (start_pos == bitbuffer->bits_per_row[0]) {
         return DECODE_ABORT_LENGTH;
@@ -190,5 +189,6 @@ r_device const bresser_5in1 = {
         .long_width  = 124,
         .reset_limit = 25000,
         .decode_fn   = &bresser_5in1_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 40},
         .fields      = output_fields,
 };
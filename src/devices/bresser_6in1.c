@@ -93,10 +93,10 @@ Notes on different sensors:
 - 18b0 0887 18 : npkap
 */
 
+static uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
+
 static int bresser_6in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
-
     int const moisture_map[] = {0, 7, 13, 20, 27, 33, 40, 47, 53, 60, 67, 73, 80, 87, 93, 99}; // scale is 20/3
 
     uint8_t msg[18];
@@ -108,8 +108,7 @@ static int bresser_6in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY; // Unrecognized data
     }
 
-    unsigned const start_pos = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof (preamble_pattern) * 8)
+    unsigned const start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0)
             + sizeof (preamble_pattern) * 8;
 
     if (start_pos >= bitbuffer->bits_per_row[0]) {
@@ -257,5 +256,6 @@ r_device const bresser_6in1 = {
         .long_width  = 124,
         .reset_limit = 25000,
         .decode_fn   = &bresser_6in1_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
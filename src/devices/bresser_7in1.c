@@ -130,10 +130,10 @@ Data layout de-whitened :
 First two bytes are an LFSR-16 digest, generator 0x8810 key 0xba95 with a final xor 0x6df1, which likely means we got that wrong.
 */
 
+static uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0xaa, 0x2d, 0xd4};
+
 static int bresser_7in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0xaa, 0x2d, 0xd4};
-
     data_t *data;
     uint8_t msg[25];
 
@@ -142,8 +142,7 @@ static int bresser_7in1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_LENGTH; // unrecognized
     }
 
-    unsigned start_pos = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof(preamble_pattern) * 8);
+    unsigned start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0);
     start_pos += sizeof(preamble_pattern) * 8;
 
     if (start_pos >= bitbuffer->bits_per_row[0]) {
@@ -343,5 +342,6 @@ r_device const bresser_7in1 = {
         .long_width  = 124,
         .reset_limit = 25000,
         .decode_fn   = &bresser_7in1_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 40},
         .fields      = output_fields,
 };
@@ -68,9 +68,10 @@ Examples:
 
  */
 
+static uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
+
 static int bresser_leakage_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
     uint8_t msg[18];
 
     if (bitbuffer->num_rows != 1
@@ -80,8 +81,7 @@ static int bresser_leakage_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY; // Unrecognized data
     }
 
-    unsigned start_pos = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof (preamble_pattern) * 8);
+    unsigned start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (start_pos >= bitbuffer->bits_per_row[0]) {
         return DECODE_ABORT_LENGTH;
@@ -154,5 +154,6 @@ r_device const bresser_leakage = {
         .long_width  = 124,
         .reset_limit = 25000,
         .decode_fn   = &bresser_leakage_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
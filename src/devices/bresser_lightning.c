@@ -33,9 +33,10 @@ CH is always 0.
 First two bytes are an LFSR-16 digest, generator 0x8810 key 0xabf9 with a final xor 0x899e
 */
 
+static uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
+
 static int bresser_lightning_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xaa, 0xaa, 0x2d, 0xd4};
     uint8_t msg[10];  // not 25
 
     /* clang-format off */
@@ -47,8 +48,7 @@ static int bresser_lightning_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     }
     /* clang-format on */
 
-    unsigned start_pos = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof(preamble_pattern) * 8);
+    unsigned start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (start_pos >= bitbuffer->bits_per_row[0]) {
         return DECODE_ABORT_LENGTH;
@@ -133,5 +133,6 @@ r_device const bresser_lightning = {
         .long_width  = 124,
         .reset_limit = 25000,
         .decode_fn   = &bresser_lightning_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
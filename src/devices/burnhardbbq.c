@@ -36,8 +36,6 @@ static int burnhardbbq_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint8_t *b;
     data_t *data;
 
-    bitbuffer_invert(bitbuffer);
-
     // All three rows contain the same information. Return on first decoded row.
     int ret = 0;
     for (int i = 0; i < bitbuffer->num_rows; ++i) {
@@ -142,5 +140,6 @@ r_device const burnhardbbq = {
         .sync_width  = 840,
         .reset_limit = 848,
         .decode_fn   = &burnhardbbq_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
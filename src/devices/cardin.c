@@ -145,5 +145,6 @@ r_device const cardin = {
         .gap_limit   = 1600,
         .reset_limit = 32000,
         .decode_fn   = &cardin_decode,
+        .rows        = {.min_bits = 24, .max_bits = 24},
         .fields      = output_fields,
 };
@@ -105,5 +105,6 @@ r_device const chuango = {
         .sync_width  = 0,    // No sync bit used
         .tolerance   = 160,  // us
         .decode_fn   = &chuango_callback,
+        .rows        = {.min_bits = 25, .max_bits = 25},
         .fields      = output_fields,
 };
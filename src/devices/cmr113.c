@@ -50,7 +50,6 @@ static int cmr113_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     int start, bit;
     uint8_t buf[4];
     uint8_t b1[COMPARE_BYTES], b2[COMPARE_BYTES];
-    bitbuffer_t b = {0};
     double current[3];
     data_t *data;
 
@@ -63,7 +62,7 @@ static int cmr113_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 
     start = 0;
     bit = 0;
-    bitbuffer_clear(&b);
+    bitbuffer_t b = {0};
     while ((start + 3) < bitbuffer->bits_per_row[0]) {
         bitbuffer_extract_bytes(bitbuffer, 0, start, buf, 3);
         if ((buf[0] >> 6) == 0x00) { // top two bits are 0b00 = no toggle
@@ -127,5 +126,6 @@ r_device const cmr113 = {
         .reset_limit = 2069,
         .tolerance   = 200,
         .decode_fn   = &cmr113_decode,
+        .rows        = {.min_bits = 350, .max_bits = 450},
         .fields      = output_fields,
 };
@@ -20,13 +20,10 @@ CurrentCost TX, CurrentCost EnviR current sensors.
 static int current_cost_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     data_t *data;
-    bitbuffer_t packet = {0};
     uint8_t *b;
     int is_envir = 0;
     unsigned int start_pos;
 
-    bitbuffer_invert(bitbuffer);
-
     uint8_t init_pattern_classic[] = {0xcc, 0xcc, 0xcc, 0xce, 0x91, 0x5d}; // 45 bits (! last 3 bits is not init)
 
     // The EnviR transmits 0x55 0x55 0x55 0x55 0x2D 0xD4
@@ -55,6 +52,7 @@ static int current_cost_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         start_pos += 45;
     }
 
+    bitbuffer_t packet = {0};
     bitbuffer_manchester_decode(bitbuffer, 0, start_pos, &packet, 0);
 
     if (packet.bits_per_row[0] < 64) {
@@ -132,5 +130,6 @@ r_device const current_cost = {
         .long_width  = 250, // NRZ
         .reset_limit = 8000,
         .decode_fn   = &current_cost_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
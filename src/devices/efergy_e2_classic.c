@@ -130,5 +130,6 @@ r_device const efergy_e2_classic = {
         .gap_limit   = 200,
         .reset_limit = 400,
         .decode_fn   = &efergy_e2_classic_callback,
+        .rows        = {.min_bits = 64, .max_bits = 80},
         .fields      = output_fields,
 };
@@ -132,5 +132,6 @@ r_device const efergy_optical = {
         .sync_width  = 500,
         .reset_limit = 400,
         .decode_fn   = &efergy_optical_callback,
+        .rows        = {.min_bits = 96, .max_bits = 100},
         .fields      = output_fields,
 };
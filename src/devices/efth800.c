@@ -45,8 +45,6 @@ The sensor sends messages at intervals of about 57-58 seconds.
 
 static int eurochron_efth800_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    bitbuffer_invert(bitbuffer);
-
     /* Look for clock packet */
     char dcf77_str[20] = {0}; // "2064-16-32T32:64:64"
     int row = bitbuffer_find_repeated_row(bitbuffer, 2, 65);
@@ -143,5 +141,6 @@ r_device const eurochron_efth800 = {
         .gap_limit   = 900,
         .reset_limit = 5500,
         .decode_fn   = &eurochron_efth800_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
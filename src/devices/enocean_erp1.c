@@ -50,8 +50,6 @@ static int enocean_erp1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->num_rows != 1)
         return DECODE_ABORT_EARLY;
 
-    bitbuffer_invert(bitbuffer);
-
     uint8_t preamble[2] = {0x55, 0x20};
     unsigned start      = bitbuffer_search(bitbuffer, 0, 0, preamble, 11);
     if (start >= bitbuffer->bits_per_row[0])
@@ -106,6 +104,7 @@ r_device const enocean_erp1 = {
         .tolerance   = 1,
         .reset_limit = 800,
         .decode_fn   = &enocean_erp1_decode,
+        .transform   = BITBUFFER_INVERTED,
         .disabled    = 1, // default disabled because a high sample rate is needed
         .fields      = output_fields,
 };
@@ -32,6 +32,9 @@ http://www.gridinsight.com/community/documentation/itron-ert-technology/
 
 #define IDM_PACKET_BYTES 92
 #define IDM_PACKET_BITLEN 720
+
+// the IDM and NetIDM decoders share the slicer and the frame sync, the bits are scanned once for both
+static uint8_t const idm_frame_sync[] = {0x16, 0xA3, 0x1C};
 // 92 * 8
 
 // Least significant nibble of endpoint_type is equivalent to SCM's endpoint type field
@@ -90,7 +93,6 @@ static int ert_idm_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint8_t b[IDM_PACKET_BYTES];
     data_t *data;
     unsigned sync_index;
-    const uint8_t idm_frame_sync[] = {0x16, 0xA3, 0x1C};
 
     uint8_t PacketTypeID;
     char PacketTypeID_str[5];
@@ -128,7 +130,7 @@ static int ert_idm_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return (DECODE_ABORT_LENGTH);
     }
 
-    sync_index = bitbuffer_search(bitbuffer, 0, 0, idm_frame_sync, 24);
+    sync_index = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     decoder_logf(decoder, 1, __func__, "sync_index=%u", sync_index);
 
@@ -330,7 +332,6 @@ static int ert_netidm_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint8_t b[IDM_PACKET_BYTES];
     data_t *data;
     unsigned sync_index;
-    const uint8_t idm_frame_sync[] = {0x16, 0xA3, 0x1C};
 
     uint8_t PacketTypeID;
     char PacketTypeID_str[5];
@@ -382,7 +383,7 @@ static int ert_netidm_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return (DECODE_ABORT_LENGTH);
     }
 
-    sync_index = bitbuffer_search(bitbuffer, 0, 0, idm_frame_sync, 24);
+    sync_index = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     decoder_logf(decoder, 1, __func__, "sync_index=%u", sync_index);
 
@@ -636,6 +637,7 @@ r_device const ert_idm = {
         // .gap_limit   = 2500,
         // .reset_limit = 4000,
         .decode_fn = &ert_idm_decode,
+        .preamble  = {.pattern = idm_frame_sync, .bits = 24},
         .fields    = output_fields,
 };
 
@@ -649,5 +651,6 @@ r_device const ert_netidm = {
         // .gap_limit   = 2500,
         // .reset_limit = 4000,
         .decode_fn = &ert_netidm_decode,
+        .preamble  = {.pattern = idm_frame_sync, .bits = 24},
         .fields    = output_fields,
 };
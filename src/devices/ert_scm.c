@@ -114,5 +114,6 @@ r_device const ert_scm = {
         .gap_limit   = 0,
         .reset_limit = 64,
         .decode_fn   = &ert_scm_decode,
+        .rows        = {.min_bits = 96, .max_bits = 96},
         .fields      = output_fields,
 };
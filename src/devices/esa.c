@@ -108,6 +108,7 @@ r_device const esa_energy = {
         .long_width  = 0,
         .reset_limit = 3000,
         .decode_fn   = &esa_cost_callback,
+        .rows        = {.min_bits = 160, .max_bits = 160, .min_rows = 1, .max_rows = 1},
         .disabled    = 1,
         .fields      = output_fields,
 };
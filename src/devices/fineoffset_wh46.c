@@ -57,13 +57,14 @@ Technical documents for the SCD30 are here:
 https://sensirion.com/products/catalog/SCD30/
 */
 
+static uint8_t const preamble[] = {0xaa, 0x2d, 0xd4}; // 24 bit, part of preamble and sync word
+
 static int fineoffset_wh46_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble[] = {0xaa, 0x2d, 0xd4}; // 24 bit, part of preamble and sync word
     uint8_t b[21];
 
     // Find a data package and extract data buffer
-    unsigned bit_offset = bitbuffer_search(bitbuffer, 0, 0, preamble, sizeof(preamble) * 8) + sizeof(preamble) * 8;
+    unsigned bit_offset = decoder_search_preamble(decoder, bitbuffer, 0, 0) + sizeof(preamble) * 8;
 
     if (bit_offset + sizeof(b) * 8 > bitbuffer->bits_per_row[0]) { // Did not find a big enough package
         decoder_logf_bitbuffer(decoder, 2, __func__, bitbuffer, "short package at %u", bit_offset);
@@ -152,5 +153,6 @@ r_device const fineoffset_wh46 = {
         .long_width  = 58,
         .reset_limit = 2500,
         .decode_fn   = &fineoffset_wh46_decode,
+        .preamble    = {.pattern = preamble, .bits = 24},
         .fields      = output_fields,
 };
@@ -138,5 +138,6 @@ r_device const fineoffset_ws80 = {
         .long_width  = 58,
         .reset_limit = 1500,
         .decode_fn   = &fineoffset_ws80_decode,
+        .rows        = {.min_bits = 168, .max_bits = 240},
         .fields      = output_fields,
 };
@@ -12,31 +12,9 @@
 #include "decoder.h"
 #include "optparse.h"
 #include "fatal.h"
+#include "compat_atomic.h"
 #include <stdlib.h>
 
-static inline int bit(const uint8_t *bytes, unsigned b)
-{
-    return bytes[b >> 3] >> (7 - (b & 7)) & 1;
-}
-
-/// extract all mask bits skipping unmasked bits of a number up to 32/64 bits
-static unsigned long compact_number(uint8_t *data, unsigned bit_offset, unsigned long mask)
-{
-    // clz (fls) is not worth the trouble
-    int top_bit = 0;
-    while (mask >> top_bit)
-        top_bit++;
-    unsigned long val = 0;
-    for (int b = top_bit - 1; b >= 0; --b) {
-        if (mask & (1 << b)) {
-            val <<= 1;
-            val |= bit(data, bit_offset);
-        }
-        bit_offset++;
-    }
-    return val;
-}
-
 /// extract a number up to 32/64 bits from given offset with given bit length
 static unsigned long extract_number(uint8_t *data, unsigned bit_offset, unsigned bit_count)
 {
@@ -63,12 +41,20 @@ struct flex_map {
     const char *val;
 };
 
+/// a run of set mask bits, at an offset from the getter bit offset
+struct flex_run {
+    unsigned offset;
+    unsigned count;
+};
+
 #define GETTER_MAP_SLOTS 16
 
 struct flex_get {
     unsigned bit_offset;
     unsigned bit_count;
     unsigned long mask;
+    unsigned runs;                          ///< number of runs of the mask
+    struct flex_run run[sizeof(long) * 4];  ///< the mask compiled to runs of set bits, MSB first
     const char *name;
     struct flex_map map[GETTER_MAP_SLOTS];
     const char *format;
@@ -112,6 +98,39 @@ static void print_row_bytes(char *row_bytes, uint8_t *bits, int num_bits)
     row_bytes[2 * (num_bits + 3) / 8] = '\0';
 }
 
+/// extract all mask bits skipping unmasked bits, a run of set mask bits at a time
+static unsigned long compact_number(uint8_t *data, struct flex_get const *getter)
+{
+    unsigned long val = 0;
+    for (unsigned r = 0; r < getter->runs; ++r) {
+        struct flex_run const *run = &getter->run[r];
+        val = run->count < sizeof(val) * 8 ? val << run->count : 0;
+        val |= extract_number(data, getter->bit_offset + run->offset, run->count);
+    }
+    return val;
+}
+
+/// compile the mask to runs of set bits, from the top set bit down
+static void compile_mask(struct flex_get *getter)
+{
+    int top_bit = 0;
+    while (top_bit < (int)sizeof(long) * 8 && getter->mask >> top_bit)
+        top_bit++;
+    getter->runs = 0;
+    for (int b = top_bit - 1; b >= 0; --b) {
+        if (!(getter->mask >> b & 1))
+            continue;
+        struct flex_run *run = &getter->run[getter->runs];
+        if (getter->runs && run[-1].offset + run[-1].count == (unsigned)(top_bit - 1 - b)) {
+            run[-1].count++;
+            continue;
+        }
+        run->offset = top_bit - 1 - b;
+        run->count  = 1;
+        getter->runs++;
+    }
+}
+
 static void render_getters(data_t *data, uint8_t *bits, struct flex_params *params)
 {
     // add a data line for each getter
@@ -119,7 +138,7 @@ static void render_getters(data_t *data, uint8_t *bits, struct flex_params *para
         struct flex_get *getter = &params->getter[g];
         unsigned long val;
         if (getter->mask)
-            val = compact_number(bits, getter->bit_offset, getter->mask);
+            val = compact_number(bits, getter);
         else
             val = extract_number(bits, getter->bit_offset, getter->bit_count);
         int m;
@@ -185,7 +204,10 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         r = -1;
         match_count = 0;
         for (i = 0; i < bitbuffer->num_rows; i++) {
-            if (bitbuffer_search(bitbuffer, i, 0, params->match_bits, params->match_len) < bitbuffer->bits_per_row[i]) {
+            unsigned pos = decoder->preamble.pattern == params->match_bits
+                    ? decoder_search_preamble(decoder, bitbuffer, i, 0)
+                    : bitbuffer_search(bitbuffer, i, 0, params->match_bits, params->match_len);
+            if (pos < bitbuffer->bits_per_row[i]) {
                 if (r < 0)
                     r = i;
                 match_count++;
@@ -200,7 +222,9 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         r = -1;
         match_count = 0;
         for (i = 0; i < bitbuffer->num_rows; i++) {
-            unsigned pos = bitbuffer_search(bitbuffer, i, 0, params->preamble_bits, params->preamble_len);
+            unsigned pos = decoder->preamble.pattern == params->preamble_bits
+                    ? decoder_search_preamble(decoder, bitbuffer, i, 0)
+                    : bitbuffer_search(bitbuffer, i, 0, params->preamble_bits, params->preamble_len);
             if (pos < bitbuffer->bits_per_row[i]) {
                 if (r < 0)
                     r = i;
@@ -208,9 +232,7 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
                 pos += params->preamble_len;
                 // TODO: refactor to bitbuffer_shift_row()
                 unsigned len = bitbuffer->bits_per_row[i] - pos;
-                bitbuffer_t tmp = {0};
-                bitbuffer_extract_bytes(bitbuffer, i, pos, tmp.bb[0], len);
-                memcpy(bitbuffer->bb[i], tmp.bb[0], (len + 7) / 8);
+                bitbuffer_extract_bytes(bitbuffer, i, pos, bitbuffer->bb[i], len); // safe to write over: the bits move up
                 bitbuffer->bits_per_row[i] = len;
             }
         }
@@ -218,6 +240,12 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
             return DECODE_FAIL_SANITY;
     }
 
+    // scratch bits for the row decoders, zeroed once and cleared after each use
+    bitbuffer_t tmp;
+    if (params->symbol_zero || params->decode_dm) {
+        memset(&tmp, 0, sizeof(tmp));
+    }
+
     if (params->symbol_zero) {
         uint32_t zero = params->symbol_zero;
         uint32_t one  = params->symbol_one;
@@ -225,10 +253,12 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 
         for (i = 0; i < bitbuffer->num_rows; i++) {
             // TODO: refactor to bitbuffer_decode_symbol_row()
-            unsigned len    = bitbuffer->bits_per_row[i];
-            bitbuffer_t tmp = {0};
-            len             = extract_bits_symbols(bitbuffer->bb[i], 0, len, zero, one, sync, tmp.bb[0]);
-            memcpy(bitbuffer->bb[i], tmp.bb[0], len); // safe to write over: can only be shorter
+            unsigned len   = bitbuffer->bits_per_row[i];
+            unsigned bytes = (len + 7) / 8;
+            len            = extract_bits_symbols(bitbuffer->bb[i], 0, len, zero, one, sync, tmp.bb[0]);
+            // safe to write over: can only be shorter, the old bits past the new length are cleared
+            memcpy(bitbuffer->bb[i], tmp.bb[0], bytes);
+            memset(tmp.bb[0], 0, bytes);
             bitbuffer->bits_per_row[i] = len;
         }
         // TODO: apply min_bits, max_bits check
@@ -238,9 +268,7 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         for (i = 0; i < bitbuffer->num_rows; i++) {
             // TODO: refactor to bitbuffer_decode_uart_row()
             unsigned len = bitbuffer->bits_per_row[i];
-            bitbuffer_t tmp = {0};
-            len = extract_bytes_uart(bitbuffer->bb[i], 0, len, tmp.bb[0]);
-            memcpy(bitbuffer->bb[i], tmp.bb[0], len); // safe to write over: can only be shorter
+            len = extract_bytes_uart(bitbuffer->bb[i], 0, len, bitbuffer->bb[i]); // safe to write over: each byte is read before it is written
             bitbuffer->bits_per_row[i] = len * 8;
         }
     }
@@ -249,11 +277,11 @@ static int flex_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         for (i = 0; i < bitbuffer->num_rows; i++) {
             // TODO: refactor to bitbuffer_decode_dm_row()
             unsigned len = bitbuffer->bits_per_row[i];
-            bitbuffer_t tmp = {0};
             bitbuffer_differential_manchester_decode(bitbuffer, i, 0, &tmp, len);
             len = tmp.bits_per_row[0];
             memcpy(bitbuffer->bb[i], tmp.bb[0], (len + 7) / 8); // safe to write over: can only be shorter
             bitbuffer->bits_per_row[i] = len;
+            bitbuffer_clear(&tmp);
         }
     }
 
@@ -370,6 +398,7 @@ static void help(void)
             "\tgap=<gap> (or: g=<gap>)\n"
             "\ttolerance=<tolerance> (or: t=<tolerance>)\n"
             "\tpriority=<n> : run decoder only as fallback\n"
+            "\tearly=<n> : decode an unfinished package once it has <n> pulses, with -Y early\n"
             "where:\n"
             "<name> can be any descriptive name tag you need in the output\n"
             "<modulation> is one of:\n"
@@ -592,6 +621,7 @@ static void parse_getter(const char *arg, struct flex_get *getter)
         else if (*arg == '{' || (*arg >= '0' && *arg <= '9')) {
             getter->bit_count = parse_bits(arg, bitrow);
             getter->mask = extract_number(bitrow, 0, getter->bit_count);
+            compile_mask(getter);
         }
         else if (*arg == '%') {
             getter->format = strdup(arg);
@@ -615,6 +645,69 @@ static void parse_getter(const char *arg, struct flex_get *getter)
     */
 }
 
+/// Most parsed specs kept, each receiver, channel, and file task registers the same specs again.
+#define FLEX_SPEC_CACHE 32
+
+static struct flex_spec_cache {
+    char *spec;
+    r_device *dev; ///< a copy of the parsed decoder, never registered
+} spec_cache[FLEX_SPEC_CACHE];
+static unsigned spec_cache_len;
+/// Guards the cache, decoders may be created on any thread.
+static unsigned spec_cache_lock;
+
+// copy a decoder, the pattern and fields pointing into the params point into the copied params
+static r_device *flex_copy_device(r_device const *src)
+{
+    r_device *dev = decoder_create(src, sizeof(struct flex_params));
+    if (!dev) {
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    struct flex_params const *src_params = src->decode_ctx;
+    struct flex_params *params           = decoder_user_data(dev);
+    *params = *src_params; // the strings are shared, decoders never free them
+    if (src->preamble.pattern == src_params->preamble_bits)
+        dev->preamble.pattern = params->preamble_bits;
+    else if (src->preamble.pattern == src_params->match_bits)
+        dev->preamble.pattern = params->match_bits;
+    if (src->fields == src_params->fields)
+        dev->fields = params->fields;
+    return dev;
+}
+
+// keep a copy of a parsed decoder for the next decoder of the same spec
+static void flex_cache_spec(char const *spec, r_device const *dev)
+{
+    if (atomic_load_acquire(&spec_cache_len) == FLEX_SPEC_CACHE) {
+        return; // parse any other specs each time
+    }
+    char *key = strdup(spec);
+    if (!key) {
+        WARN_STRDUP("flex_cache_spec()");
+        return; // NOTE: not cached on alloc failure.
+    }
+    r_device *copy = flex_copy_device(dev);
+    if (!copy) {
+        free(key);
+        return; // NOTE: not cached on alloc failure.
+    }
+    atomic_spin_lock(&spec_cache_lock);
+    if (spec_cache_len < FLEX_SPEC_CACHE) {
+        spec_cache[spec_cache_len].spec = key;
+        spec_cache[spec_cache_len].dev  = copy;
+        atomic_store_release(&spec_cache_len, spec_cache_len + 1);
+        key  = NULL;
+        copy = NULL;
+    }
+    atomic_spin_unlock(&spec_cache_lock);
+    // filled by another thread meanwhile
+    free(key);
+    if (copy) {
+        free(copy->decode_ctx);
+        free(copy);
+    }
+}
+
 // NOTE: this is declared in rtl_433.c also.
 r_device *flex_create_device(char *spec);
 
@@ -624,6 +717,21 @@ r_device *flex_create_device(char *spec)
         help();
     }
 
+    r_device const *cached = NULL;
+    atomic_spin_lock(&spec_cache_lock);
+    for (unsigned i = 0; i < spec_cache_len; ++i) {
+        if (!strcmp(spec_cache[i].spec, spec)) {
+            cached = spec_cache[i].dev;
+            break;
+        }
+    }
+    atomic_spin_unlock(&spec_cache_lock);
+    if (cached) {
+        // cached decoders are never changed or freed
+        return flex_copy_device(cached);
+    }
+    char const *spec_arg = spec;
+
     r_device *dev = decoder_create(NULL, sizeof(struct flex_params));
     if (!dev) {
         return NULL; // NOTE: returns NULL on alloc failure.
@@ -673,6 +781,8 @@ r_device *flex_create_device(char *spec)
             dev->tolerance = parse_float(val, "tolerance: ");
         else if (!strcasecmp(key, "prio") || !strcasecmp(key, "priority"))
             dev->priority = parse_atoiv(val, 0, "priority: ");
+        else if (!strcasecmp(key, "early"))
+            dev->early_pulses = parse_atoiv(val, 0, "early: ");
 
         else if (!strcasecmp(key, "bits>"))
             params->min_bits = parse_atoiv(val, 0, "bits: ");
@@ -744,6 +854,16 @@ r_device *flex_create_device(char *spec)
     if (params->min_bits > 0 && params->min_repeats < 1)
         params->min_repeats = 1;
 
+    // without a bits limit even rows without bits are reported
+    dev->reports_empty = !params->min_bits;
+
+    // the first pattern searched on the bits as given, the slice group may search it with other decoders
+    if (!params->reflect && (params->preamble_len || params->match_len)) {
+        dev->preamble.pattern  = params->preamble_len ? params->preamble_bits : params->match_bits;
+        dev->preamble.bits     = params->preamble_len ? params->preamble_len : params->match_len;
+        dev->preamble.inverted = params->invert;
+    }
+
     // add getter fields if unique requested
     if (params->unique) {
         int i = 0;
@@ -815,5 +935,6 @@ r_device *flex_create_device(char *spec)
     */
 
     free(spec);
+    flex_cache_spec(spec_arg, dev);
     return dev;
 }
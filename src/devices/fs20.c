@@ -154,8 +154,6 @@ static int fs20_decode(r_device *decoder, bitbuffer_t *bitbuffer)
             "Repeat | Extended | BS?",
     };
 
-    bitbuffer_invert(bitbuffer);
-
     uint8_t *bits = bitbuffer->bb[0];
     uint8_t cmd;
     uint16_t hc;
@@ -282,5 +280,6 @@ r_device const fs20 = {
         .long_width  = 600,
         .reset_limit = 9000,
         .decode_fn   = &fs20_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -79,5 +79,6 @@ r_device const ft004b = {
         .gap_limit   = 4000,
         .reset_limit = 4000,
         .decode_fn   = &ft004b_callback,
+        .rows        = {.min_bits = 137, .max_bits = 138},
         .fields      = output_fields,
 };
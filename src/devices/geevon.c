@@ -51,9 +51,6 @@ Example packets:
 
 static int geevon_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // invert all the bits
-    bitbuffer_invert(bitbuffer);
-
     // find the most common row, nominal we expect 5 packets
     int r = bitbuffer_find_repeated_prefix(bitbuffer, bitbuffer->num_rows > 5 ? 5 : 3, 72);
     if (r < 0) {
@@ -122,5 +119,6 @@ r_device const geevon = {
         .gap_limit   = 625,  // long gap (with short pulse) is ~472 us, sync gap is ~728 us
         .reset_limit = 1700, // maximum gap is 1250 us (long gap + longer sync gap on last repeat)
         .decode_fn   = &geevon_callback,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -80,13 +80,14 @@ static char const *const output_fields[] = {
 };
 
 r_device const generic_remote = {
-        .name        = "Generic Remote SC226x EV1527",
-        .modulation  = OOK_PULSE_PWM,
-        .short_width = 464,
-        .long_width  = 1404,
-        .reset_limit = 1800,
-        .sync_width  = 0,   // No sync bit used
-        .tolerance   = 200, // us
-        .decode_fn   = &generic_remote_callback,
-        .fields      = output_fields,
+        .name         = "Generic Remote SC226x EV1527",
+        .modulation   = OOK_PULSE_PWM,
+        .short_width  = 464,
+        .long_width   = 1404,
+        .reset_limit  = 1800,
+        .sync_width   = 0,   // No sync bit used
+        .tolerance    = 200, // us
+        .decode_fn    = &generic_remote_callback,
+        .early_pulses = 25, // a single code
+        .fields       = output_fields,
 };
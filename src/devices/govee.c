@@ -338,8 +338,6 @@ static int govee_h5054_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_LENGTH;
     }
 
-    bitbuffer_invert(bitbuffer);
-
     uint8_t *b = bitbuffer->bb[r];
 
     char code_str[13];
@@ -422,5 +420,6 @@ r_device const govee_h5054 = {
         .gap_limit   = 900,  // Maximum gap size before new row of bits [us]
         .reset_limit = 9000, // Maximum gap size before End Of Message [us]
         .decode_fn   = &govee_h5054_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -102,7 +102,6 @@ static int gt_wt_03_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     if (41 != bitbuffer->bits_per_row[row])
         return DECODE_ABORT_LENGTH;
 
-    bitbuffer_invert(bitbuffer);
     b = bitbuffer->bb[row];
 
     if (!(b[0] || b[1] || b[2] || b[3] || b[4])) /* exclude all zeros */
@@ -167,5 +166,6 @@ r_device const gt_wt_03 = {
         .gap_limit   = 1000,
         .reset_limit = 61000,
         .decode_fn   = &gt_wt_03_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -64,8 +64,6 @@ static int honeywell_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->num_rows != 1 || bitbuffer->bits_per_row[row] < 60)
         return DECODE_ABORT_LENGTH;
 
-    bitbuffer_invert(bitbuffer);
-
     pos = bitbuffer_search(bitbuffer, row, 0, preamble_pattern, 12) + 12;
     len = bitbuffer->bits_per_row[row] - pos;
     if (len < 48)
@@ -146,5 +144,6 @@ r_device const honeywell = {
         .long_width  = 0,
         .reset_limit = 292,
         .decode_fn   = &honeywell_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
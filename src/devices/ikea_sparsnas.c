@@ -87,7 +87,6 @@ detail. Many thanks to kodarn!
 #define IKEA_SPARSNAS_ID_KEY_SUB 0x5D38E8CB
 
 static uint16_t const ikea_sparsnas_pulses_per_kwh = 1000;
-static uint32_t ikea_sparsnas_sensor_id = 0;
 
 static uint32_t ikea_sparsnas_brute_force_encryption(uint8_t buffer[18])
 {
@@ -136,6 +135,8 @@ static uint32_t ikea_sparsnas_brute_force_encryption(uint8_t buffer[18])
 
 static int ikea_sparsnas_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
+    // the sensor id found by brute force, kept for each decoder instance
+    uint32_t *sensor_id = decoder_user_data(decoder);
     uint8_t const preamble_pattern[4] = {0xAA, 0xAA, 0xD2, 0x01};
 
     if ((bitbuffer->bits_per_row[0] < IKEA_SPARSNAS_MESSAGE_BITLEN) || (bitbuffer->bits_per_row[0] > IKEA_SPARSNAS_MESSAGE_BITLEN_MAX)) {
@@ -168,11 +169,11 @@ static int ikea_sparsnas_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     }
 
     //Decryption
-    if (!ikea_sparsnas_sensor_id) {
+    if (!*sensor_id) {
         decoder_log(decoder, 2, __func__, "No sensor ID configured. Brute forcing encryption.");
-        ikea_sparsnas_sensor_id = ikea_sparsnas_brute_force_encryption(buffer);
-        if (ikea_sparsnas_sensor_id) {
-            decoder_logf(decoder, 2, __func__, "Found valid sensor ID %06u. If reported values does not make sense, this might be incorrect.", ikea_sparsnas_sensor_id);
+        *sensor_id = ikea_sparsnas_brute_force_encryption(buffer);
+        if (*sensor_id) {
+            decoder_logf(decoder, 2, __func__, "Found valid sensor ID %06u. If reported values does not make sense, this might be incorrect.", *sensor_id);
         } else {
             decoder_log(decoder, 2, __func__, "No valid sensor ID found.");
         }
@@ -182,7 +183,7 @@ static int ikea_sparsnas_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     uint8_t decrypted[18];
 
     uint8_t key[5];
-    uint32_t const sensor_id_sub = ikea_sparsnas_sensor_id - IKEA_SPARSNAS_ID_KEY_SUB;
+    uint32_t const sensor_id_sub = *sensor_id - IKEA_SPARSNAS_ID_KEY_SUB;
 
     key[0] = (uint8_t)(sensor_id_sub >> 24);
     key[1] = (uint8_t)(sensor_id_sub);
@@ -204,16 +205,16 @@ static int ikea_sparsnas_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     decoder_log_bitrow(decoder, 2, __func__, decrypted, 18 * 8, "Decrypted");
     decoder_logf(decoder, 2, __func__, "Received sensor id: %06u", rcv_sensor_id);
 
-    if (rcv_sensor_id != ikea_sparsnas_sensor_id) {
-        decoder_logf(decoder, 2, __func__, "Malformed package, or wrong sensor id. Received sensor id (%06u) not the same as sender (%d)", rcv_sensor_id, ikea_sparsnas_sensor_id);
+    if (rcv_sensor_id != *sensor_id) {
+        decoder_logf(decoder, 2, __func__, "Malformed package, or wrong sensor id. Received sensor id (%06u) not the same as sender (%d)", rcv_sensor_id, *sensor_id);
     }
 
-    if ((!ikea_sparsnas_sensor_id) || (rcv_sensor_id != ikea_sparsnas_sensor_id)) {
+    if ((!*sensor_id) || (rcv_sensor_id != *sensor_id)) {
 
         /* clang-format off */
         data_t *data = data_make(
                 "model",         "Model",               DATA_STRING, "Ikea-Sparsnas",
-                "id",            "Sensor ID",           DATA_INT, ikea_sparsnas_sensor_id,
+                "id",            "Sensor ID",           DATA_INT, *sensor_id,
                 "mic",           "Integrity",           DATA_STRING,    "CRC",
                 NULL);
         /* clang-format on */
@@ -281,6 +282,14 @@ static char const *const output_fields[] = {
         NULL,
 };
 
+r_device const ikea_sparsnas;
+
+static r_device *ikea_sparsnas_create(char *arg)
+{
+    (void)arg;
+    return decoder_create(&ikea_sparsnas, sizeof(uint32_t)); // NOTE: returns NULL on alloc failure.
+}
+
 r_device const ikea_sparsnas = {
         .name        = "IKEA Sparsnas Energy Meter Monitor",
         .modulation  = FSK_PULSE_PCM,
@@ -289,5 +298,6 @@ r_device const ikea_sparsnas = {
         .gap_limit   = 1000,
         .reset_limit = 3000,
         .decode_fn   = &ikea_sparsnas_decode,
+        .create_fn   = &ikea_sparsnas_create,
         .fields      = output_fields,
 };
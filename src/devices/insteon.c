@@ -387,8 +387,6 @@ static int insteon_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 
     decoder_logf(decoder, 2, __func__, "new buffer %hu rows", bitbuffer->num_rows);
 
-    bitbuffer_invert(bitbuffer);
-
     /*
      * loop over all rows and look for preamble
     */
@@ -491,5 +489,6 @@ r_device const insteon = {
         .tolerance   = 15,
         .reset_limit = 1000, // a bit longer than packet gap
         .decode_fn   = &insteon_callback,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -59,6 +59,7 @@ static char const *const output_fields[] = {
 r_device const intertechno = {
         .name        = "Intertechno 433",
         .modulation  = OOK_PULSE_PPM,
+        .bands       = FREQ_BAND_433,
         .short_width = 330,
         .long_width  = 1400,
         .gap_limit   = 1700,
@@ -118,6 +118,7 @@ r_device const klimalogg = {
         .gap_limit   = 0,
         .reset_limit = 1000,
         .decode_fn   = &klimalogg_decode,
+        .rows        = {.min_bits = 11 * 8},
         .disabled    = 1,
         .fields      = output_fields,
 };
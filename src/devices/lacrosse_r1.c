@@ -99,12 +99,12 @@ Full preamble is `aaaaaaaaaaaaaa d2aa2dd4`.
     d2aa2dd4 0fb220 8a aaaaaa 000 aaa 4e 00000000000000 [weak]
 */
 
+// full preamble (LTV-R1) is `fff00000 aaaaaaaa d2aa2dd4`
+// full preamble (LTV-R3, LTV-W1) is `aaaaaaaaaaaaaa d2aa2dd4`
+static uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
+
 static int lacrosse_r1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble (LTV-R1) is `fff00000 aaaaaaaa d2aa2dd4`
-    // full preamble (LTV-R3, LTV-W1) is `aaaaaaaaaaaaaa d2aa2dd4`
-    uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
-
     uint8_t b[20];
 
     if (bitbuffer->num_rows > 1) {
@@ -122,8 +122,7 @@ static int lacrosse_r1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         decoder_logf(decoder, 1, __func__, "packet length: %d", msg_len);
     }
 
-    int offset = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof(preamble_pattern) * 8);
+    int offset = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (offset >= msg_len) {
         decoder_log(decoder, 1, __func__, "Sync word not found");
@@ -213,5 +212,6 @@ r_device const lacrosse_r1 = {
         .long_width  = 104,
         .reset_limit = 9600,
         .decode_fn   = &lacrosse_r1_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
@@ -63,10 +63,10 @@ Sequence# 0,1,3,4,5 & 7
 
 #include "decoder.h"
 
+static uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
+
 static int lacrosse_th_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
-
     data_t *data;
     uint8_t b[11];
     uint32_t id;
@@ -89,8 +89,7 @@ static int lacrosse_th_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         model_num = (bitbuffer->bits_per_row[0] < 280) ? 3 : 2;
     }
 
-    offset = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof(preamble_pattern) * 8);
+    offset = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (offset >= bitbuffer->bits_per_row[0]) {
         decoder_log(decoder, 1, __func__, "Sync word not found");
@@ -158,5 +157,6 @@ r_device const lacrosse_th3 = {
         .long_width  = 104,
         .reset_limit = 9600,
         .decode_fn   = &lacrosse_th_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
@@ -142,7 +142,6 @@ static int lacrosse_tx141x_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         device = LACROSSE_TX141BV3;
     }
 
-    bitbuffer_invert(bitbuffer);
     b = bitbuffer->bb[r];
 
     if (device == LACROSSE_TX141W) {
@@ -313,5 +312,6 @@ r_device const lacrosse_tx141x = {
         .gap_limit   = 625,  // long gap (with short pulse) is ~417 us, sync gap is ~833 us
         .reset_limit = 1700, // maximum gap is 1250 us (long gap + longer sync gap on last repeat)
         .decode_fn   = &lacrosse_tx141x_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -50,10 +50,10 @@ LTV-WR1
 
 #include "decoder.h"
 
+static uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
+
 static int lacrosse_wr1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    uint8_t const preamble_pattern[] = {0xd2, 0xaa, 0x2d, 0xd4};
-
     data_t *data;
     uint8_t b[11];
     uint32_t id;
@@ -72,8 +72,7 @@ static int lacrosse_wr1_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         decoder_logf(decoder, 1, __func__, "packet length: %d", bitbuffer->bits_per_row[0]);
     }
 
-    offset = bitbuffer_search(bitbuffer, 0, 0,
-            preamble_pattern, sizeof(preamble_pattern) * 8);
+    offset = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (offset >= bitbuffer->bits_per_row[0]) {
         decoder_log(decoder, 1, __func__, "Sync word not found");
@@ -143,5 +142,6 @@ r_device const lacrosse_wr1 = {
         .long_width  = 104,
         .reset_limit = 9600,
         .decode_fn   = &lacrosse_wr1_decode,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32},
         .fields      = output_fields,
 };
@@ -59,9 +59,6 @@ static int lightwave_rf_callback(r_device *decoder, bitbuffer_t *bitbuffer)
             || bitbuffer->num_rows != 1) // There should be only one message (and we use the rest...)
         return DECODE_ABORT_LENGTH;
 
-    // Polarity is inverted
-    bitbuffer_invert(bitbuffer);
-
     // Expand all "0" to "10" (bit stuffing)
     // row_in = 0, row_out = 1
     bitbuffer_add_row(bitbuffer);
@@ -152,6 +149,7 @@ r_device const lightwave_rf = {
         .long_width  = 1250, //
         .reset_limit = 1500, // Gap between messages is unknown so let us get them individually
         .decode_fn   = &lightwave_rf_callback,
+        .transform   = BITBUFFER_INVERTED,
         .disabled    = 1,
         .fields      = output_fields,
 };
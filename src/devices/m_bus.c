@@ -28,32 +28,17 @@ static unsigned bcd2int(uint8_t bcd)
     return 10*(bcd>>4) + (bcd & 0xF);
 }
 
-// Mapping from 6 bits to 4 bits. "3of6" coding used for Mode T
-static uint8_t m_bus_decode_3of6(uint8_t byte)
-{
-    uint8_t out = 0xF0; // Error
-    //fprintf(stderr,"Decode %0d\n", byte);
-    switch(byte) {
-        case 22:    out = 0x00;  break;  // 0x16
-        case 13:    out = 0x01;  break;  // 0x0D
-        case 14:    out = 0x02;  break;  // 0x0E
-        case 11:    out = 0x03;  break;  // 0x0B
-        case 28:    out = 0x04;  break;  // 0x1C
-        case 25:    out = 0x05;  break;  // 0x19
-        case 26:    out = 0x06;  break;  // 0x1A
-        case 19:    out = 0x07;  break;  // 0x13
-        case 44:    out = 0x08;  break;  // 0x2C
-        case 37:    out = 0x09;  break;  // 0x25
-        case 38:    out = 0x0A;  break;  // 0x26
-        case 35:    out = 0x0B;  break;  // 0x23
-        case 52:    out = 0x0C;  break;  // 0x34
-        case 49:    out = 0x0D;  break;  // 0x31
-        case 50:    out = 0x0E;  break;  // 0x32
-        case 41:    out = 0x0F;  break;  // 0x29
-        default:    break;  // Error
-    }
-    return out;
-}
+// Mapping from 6 bits to 4 bits. "3of6" coding used for Mode T, 0xF0 marks an invalid code
+static uint8_t const m_bus_3of6[64] = {
+        0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, // 0x00
+        0xF0, 0xF0, 0xF0, 0x03, 0xF0, 0x01, 0x02, 0xF0, // 0x08
+        0xF0, 0xF0, 0xF0, 0x07, 0xF0, 0xF0, 0x00, 0xF0, // 0x10
+        0xF0, 0x05, 0x06, 0xF0, 0x04, 0xF0, 0xF0, 0xF0, // 0x18
+        0xF0, 0xF0, 0xF0, 0x0B, 0xF0, 0x09, 0x0A, 0xF0, // 0x20
+        0xF0, 0x0F, 0xF0, 0xF0, 0x08, 0xF0, 0xF0, 0xF0, // 0x28
+        0xF0, 0x0D, 0x0E, 0xF0, 0x0C, 0xF0, 0xF0, 0xF0, // 0x30
+        0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, // 0x38
+};
 
 // Decode input 6 bit nibbles to output 4 bit nibbles (packed in bytes). "3of6" coding used for Mode T
 // Bad data must be handled with second layer CRC
@@ -61,8 +46,12 @@ static int m_bus_decode_3of6_buffer(uint8_t const *bits, unsigned bit_offset, ui
 {
     int successful_contiguous_bytes = -1;
     for (unsigned n=0; n<num_bytes; ++n) {
-        uint8_t nibble_h = m_bus_decode_3of6(bitrow_get_byte(bits, n*12+bit_offset) >> 2);
-        uint8_t nibble_l = m_bus_decode_3of6(bitrow_get_byte(bits, n*12+bit_offset+6) >> 2);
+        // the 12 bits of a byte span at most three input bytes
+        unsigned pos = n*12+bit_offset;
+        uint8_t const *p = &bits[pos >> 3];
+        unsigned code = (((unsigned)p[0] << 16 | p[1] << 8 | p[2]) >> (12 - (pos & 7))) & 0xFFF;
+        uint8_t nibble_h = m_bus_3of6[code >> 6];
+        uint8_t nibble_l = m_bus_3of6[code & 0x3F];
         if (nibble_h > 0xf || nibble_l > 0xf) {
             // return -1;  // fail at first 3of6 decoding error
             nibble_l &= 0x0F;  // assume logical 0 nibble if 3of6 decoding error, let CRC fail decoding if necessary
@@ -864,9 +853,14 @@ static int m_bus_output_data(r_device *decoder, bitbuffer_t *bitbuffer, const m_
     data_t  *data;
 
     // Make data string
-    char str_buf[1024];
-    sprintf(str_buf, "%02x", out->data[0]);  // Adjust telegram length
-    for (unsigned n=1; n<out->length; n++) { sprintf(str_buf+n*2, "%02x", out->data[n]); }
+    static char const hex[] = "0123456789abcdef";
+    char str_buf[1024 + 1];
+    unsigned str_len = MAX(out->length, 1); // the first byte is always printed
+    for (unsigned n=0; n<str_len; n++) {
+        str_buf[n*2]   = hex[out->data[n] >> 4];
+        str_buf[n*2+1] = hex[out->data[n] & 0xF];
+    }
+    str_buf[str_len*2] = '\0';
 
     // Output data
     if (block1->knx_mode) {
@@ -936,9 +930,6 @@ static int m_bus_mode_c_t_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 //  static const uint8_t PREAMBLE_CA[] = {0x55, 0x54, 0x3D, 0x54, 0xCD};  // Mode C, format A Preamble
 //  static const uint8_t PREAMBLE_CB[] = {0x55, 0x54, 0x3D, 0x54, 0x3D};  // Mode C, format B Preamble
 
-    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
-    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
-    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
     char const *mode;
 
     // Validate package length
@@ -952,6 +943,10 @@ static int m_bus_mode_c_t_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY;
     }
 
+    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
+    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
+    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
+
     decoder_logf_bitbuffer(decoder, 1, __func__, bitbuffer, "PREAMBLE_T: found at: %u", bit_offset);
     bit_offset += sizeof(PREAMBLE_T)*8;     // skip preamble
 
@@ -1022,10 +1017,6 @@ static int m_bus_mode_r_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     static const uint8_t PREAMBLE_RA[]  = {0x55, 0x54, 0x76, 0x96};      // Mode R, format A (B not supported)
 
-    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
-    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
-    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
-
     // Validate package length
     if (bitbuffer->bits_per_row[0] < (32+13*8) || bitbuffer->bits_per_row[0] > (64+256*8)) {  // Min/Max (Preamble + payload)
         return 0;
@@ -1038,6 +1029,10 @@ static int m_bus_mode_r_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     }
     bit_offset += sizeof(PREAMBLE_RA)*8;     // skip preamble
 
+    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
+    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
+    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
+
     decoder_log(decoder, 1, __func__, "M-Bus: Mode R, Format A");
     decoder_log(decoder, 1, __func__, "Experimental - Not tested");
     // Extract data
@@ -1110,10 +1105,6 @@ static int m_bus_mode_s_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     static const uint8_t PREAMBLE_S[]  = {0x54, 0x76, 0x96};  // Mode S Preamble
     static const uint8_t PREAMBLE_T_DN[] = {0xaa, 0xab, 0x32};  // Mode T Downlink Preamble
-    bitbuffer_t packet_bits = {0};
-    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
-    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
-    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
 
     // Validate package length
     if (bitbuffer->bits_per_row[0] < (32+13*8) || bitbuffer->bits_per_row[0] > (64+256*8)) {
@@ -1135,6 +1126,10 @@ static int m_bus_mode_s_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bit_offset >= bitbuffer->bits_per_row[0]) { // Did not find a big enough package
         return DECODE_ABORT_EARLY;
     }
+    m_bus_data_t    data_in     = {0};  // Data from Physical layer decoded to bytes
+    m_bus_data_t    data_out    = {0};  // Data from Data Link layer
+    m_bus_block1_t  block1      = {0};  // Block1 fields from Data Link layer
+    bitbuffer_t packet_bits = {0};
     bitbuffer_manchester_decode(bitbuffer, 0, bit_offset, &packet_bits, 800);
     data_in.length = (bitbuffer->bits_per_row[0]);
     bitbuffer_extract_bytes(&packet_bits, 0, 0, data_in.data, data_in.length);
@@ -1196,6 +1191,7 @@ static char const *const output_fields[] = {
 r_device const m_bus_mode_c_t = {
         .name        = "Wireless M-Bus, Mode C&T, 100kbps (-f 868.95M -s 1200k)", // Minimum samplerate = 1.2 MHz (12 samples of 100kb/s)
         .modulation  = FSK_PULSE_PCM,
+        .bands       = FREQ_BAND_868,
         .short_width = 10,  // Bit rate: 100 kb/s
         .long_width  = 10,  // NRZ encoding (bit width = pulse width)
         .reset_limit = 500, //
@@ -1207,6 +1203,7 @@ r_device const m_bus_mode_c_t = {
 r_device const m_bus_mode_c_t_downlink = {
         .name        = "Wireless M-Bus, Mode T, 32.768kbps (-f 868.3M -s 1000k)", // Minimum samplerate = 1 MHz (15 samples of 32kb/s manchester coded)
         .modulation  = FSK_PULSE_PCM,
+        .bands       = FREQ_BAND_868,
         .short_width = (1000.0 / 32.768), // ~31 us per bit
         .long_width  = (1000.0 / 32.768),
         .reset_limit = ((1000.0 / 32.768) * 9), // 9 bit periods
@@ -1219,6 +1216,7 @@ r_device const m_bus_mode_c_t_downlink = {
 r_device const m_bus_mode_s = {
         .name        = "Wireless M-Bus, Mode S, 32.768kbps (-f 868.3M -s 1000k)", // Minimum samplerate = 1 MHz (15 samples of 32kb/s manchester coded)
         .modulation  = FSK_PULSE_PCM,
+        .bands       = FREQ_BAND_868,
         .short_width = (1000.0 / 32.768), // ~31 us per bit
         .long_width  = (1000.0 / 32.768),
         .reset_limit = ((1000.0 / 32.768) * 9), // 9 bit periods
@@ -1237,6 +1235,7 @@ r_device const m_bus_mode_s = {
 r_device const m_bus_mode_r = {
         .name        = "Wireless M-Bus, Mode R, 4.8kbps (-f 868.33M)",
         .modulation  = FSK_PULSE_MANCHESTER_ZEROBIT,
+        .bands       = FREQ_BAND_868,
         .short_width = (1000.0f / 4.8f / 2),    // ~208 us per bit -> clock half period ~104 us
         .long_width  = 0,                       // Unused
         .reset_limit = (1000.0f / 4.8f * 1.5f), // 3 clock half periods
@@ -1261,6 +1260,7 @@ r_device const m_bus_mode_r = {
 r_device const m_bus_mode_f = {
         .name        = "Wireless M-Bus, Mode F, 2.4kbps",
         .modulation  = FSK_PULSE_PCM,
+        .bands       = FREQ_BAND_433,
         .short_width = 1000.0f / 2.4f, // ~417 us
         .long_width  = 1000.0f / 2.4f, // NRZ encoding (bit width = pulse width)
         .reset_limit = 5000,           // ??
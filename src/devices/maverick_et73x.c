@@ -43,7 +43,6 @@ note that the mentioned quaternary conversion is actually manchester code.
 static int maverick_et73x_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     data_t *data;
-    bitbuffer_t mc = {0};
 
     if (bitbuffer->num_rows != 1)
         return DECODE_ABORT_EARLY;
@@ -57,6 +56,7 @@ static int maverick_et73x_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY; // preamble missing
 
     // decode the inner manchester encoding
+    bitbuffer_t mc = {0};
     bitbuffer_manchester_decode(bitbuffer, 0, 0, &mc, 104);
 
     // we require 7 bytes 13 nibble rounded up (b[6] highest reference below)
@@ -82,6 +82,7 @@ static char const *const output_fields[] = {
 r_device const mebus433 = {
         .name        = "Mebus 433",
         .modulation  = OOK_PULSE_PPM,
+        .bands       = FREQ_BAND_433,
         .short_width = 800,  // guessed, no samples available
         .long_width  = 1600, // guessed, no samples available
         .gap_limit   = 2400,
@@ -78,10 +78,11 @@ static void decode_5to8(bitbuffer_t *bytes, uint8_t *base6_dec)
     }
 }
 
+// partial preamble and sync word shifted by 1 bit
+static uint8_t const preamble[] = {0x55, 0x55, 0x55, 0xa9, 0x66, 0x69, 0x65};
+
 static int neptune_r900_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // partial preamble and sync word shifted by 1 bit
-    uint8_t const preamble[] = {0x55, 0x55, 0x55, 0xa9, 0x66, 0x69, 0x65};
     int const preamble_length = sizeof(preamble) * 8;
 
     if (bitbuffer->num_rows != 1) {
@@ -89,7 +90,7 @@ static int neptune_r900_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     }
 
     // Search for preamble and sync-word
-    unsigned start_pos = bitbuffer_search(bitbuffer, 0, 0, preamble, preamble_length);
+    unsigned start_pos = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     // check that (bitbuffer->bits_per_row[0]) greater than (start_pos+sizeof(preamble)*8+168)
     if (start_pos + preamble_length + 168 > bitbuffer->bits_per_row[0])
@@ -106,7 +107,6 @@ static int neptune_r900_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     bitbuffer_extract_bytes(bitbuffer, 0, start_pos + preamble_length, bits, 21 * 8);
 
     uint8_t *bb = bitbuffer->bb[0];
-    bitbuffer_t bytes = {0};
     uint8_t base6_dec[21] = {0};
     int count = 0;
 
@@ -136,6 +136,7 @@ static int neptune_r900_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     // convert the base6 integers above into binary bits for decoding data
     // this reduces the 168 bits to 105 bits (104 bits??)
     // the first 80 bits are used in this decoder, the last 24 bits are decoded as extra
+    bitbuffer_t bytes = {0};
     decode_5to8(&bytes, base6_dec);
     uint8_t b[13]; // 104 bits
     bitbuffer_extract_bytes(&bytes, 0, 0, b, sizeof(b)*8);
@@ -240,5 +241,6 @@ r_device const neptune_r900 = {
         .long_width  = 30,
         .reset_limit = 320, // a bit longer than packet gap
         .decode_fn   = &neptune_r900_decode,
+        .preamble    = {.pattern = preamble, .bits = 56},
         .fields      = output_fields,
 };
@@ -71,11 +71,11 @@ static int new_template_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 
     /*
      * If you expect the bits flipped with respect to the demod
-     * invert the whole bit buffer.
+     * the whole bit buffer is inverted with `.transform = BITBUFFER_INVERTED`
+     * in the r_device below, the decoders sharing a slicer then share the
+     * inverted bits.
      */
 
-    bitbuffer_invert(bitbuffer);
-
     /*
      * The bit buffer will contain multiple rows.
      * Typically a complete message will be contained in a single
@@ -277,6 +277,7 @@ r_device const new_template = {
         .gap_limit   = 300,  // some distance above long
         .reset_limit = 1000, // a bit longer than packet gap
         .decode_fn   = &new_template_decode,
+        .transform   = BITBUFFER_INVERTED,
         .disabled    = 3, // disabled and hidden, use 0 if there is a MIC, 1 otherwise
         .fields      = output_fields,
 };
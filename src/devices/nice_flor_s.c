@@ -37,7 +37,6 @@ static int nice_flor_s_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_LENGTH;
     }
 
-    bitbuffer_invert(bitbuffer);
     uint8_t *b = bitbuffer->bb[0];
 
     uint8_t button_id = b[0] >> 4;
@@ -88,6 +87,7 @@ r_device const nice_flor_s = {
         .reset_limit = 5000,
         .tolerance   = 100,
         .decode_fn   = &nice_flor_s_decode,
+        .transform   = BITBUFFER_INVERTED,
         .disabled    = 1,
         .fields      = output_fields,
 };
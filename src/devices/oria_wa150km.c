@@ -53,15 +53,14 @@ typedef struct {
     int initialized;  // 0 = not initialized, 1 = has valid previous reading
 } device_state_t;
 
-// Static array to track device states
-static device_state_t device_states[MAX_DEVICES];
-static int device_states_initialized = 0;
 
 static int oria_wa150km_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     data_t *data;
     int r;
     uint8_t *b;
+    // the states are zeroed with the decoder instance
+    device_state_t *device_states = decoder_user_data(decoder);
 
     // Find a valid row (skipping short preamble rows)
     for (r = 0; r < bitbuffer->num_rows; r++) {
@@ -155,14 +154,6 @@ static int oria_wa150km_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         // If you want to reject these, change to level 1 and return DECODE_FAIL_SANITY
     }
 
-    // Initialize device states array if not already done
-    if (!device_states_initialized) {
-        for (int i = 0; i < MAX_DEVICES; i++) {
-            device_states[i].initialized = 0;
-        }
-        device_states_initialized = 1;
-    }
-
     // Find existing device state or an empty slot
     int device_index = -1;
     for (int i = 0; i < MAX_DEVICES; i++) {
@@ -233,6 +224,14 @@ static char const *const output_fields[] = {
         NULL,
 };
 
+r_device const oria_wa150km;
+
+static r_device *oria_wa150km_create(char *arg)
+{
+    (void)arg;
+    return decoder_create(&oria_wa150km, MAX_DEVICES * sizeof(device_state_t)); // NOTE: returns NULL on alloc failure.
+}
+
 /*
  * r_device - registers device/callback. see rtl_433_devices.h
  */
@@ -244,6 +243,7 @@ r_device const oria_wa150km = {
         .gap_limit   = 1500,
         .reset_limit = 4000,
         .decode_fn   = &oria_wa150km_decode,
+        .create_fn   = &oria_wa150km_create,
         .disabled    = 0,
         .fields      = output_fields,
 };
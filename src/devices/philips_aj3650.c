@@ -63,9 +63,6 @@ static int philips_aj3650_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     float temperature;
     data_t *data;
 
-    /* Invert the data bits */
-    bitbuffer_invert(bitbuffer);
-
     /* Correct number of rows? */
     if (bitbuffer->num_rows != 1) {
         decoder_logf(decoder, 2, __func__, "wrong number of rows (%d)", bitbuffer->num_rows);
@@ -150,5 +147,6 @@ r_device const philips_aj3650 = {
 //        .gap_limit   = 8000,
         .reset_limit = 30000,
         .decode_fn   = &philips_aj3650_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
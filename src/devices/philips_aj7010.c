@@ -40,8 +40,6 @@ Data format is:
 
 static int philips_aj7010_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    bitbuffer_invert(bitbuffer);
-
     // Correct number of rows?
     if (bitbuffer->num_rows != 1) {
         decoder_logf(decoder, 1, __func__, "wrong number of rows (%d)", bitbuffer->num_rows);
@@ -129,5 +127,6 @@ r_device const philips_aj7010 = {
         .sync_width  = 1000,
         .reset_limit = 30000,
         .decode_fn   = &philips_aj7010_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -117,6 +117,7 @@ r_device const quinetic = {
         .reset_limit = 120,
         .tolerance   = 1,
         .decode_fn   = &quinetic_switch_decode,
+        .rows        = {.min_bits = 110, .max_bits = 140},
         .fields      = output_fields,
         .disabled    = 1, // disabled by default, due to required settings: frequency 433.4, sample_rate 1024k
 };
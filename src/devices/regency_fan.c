@@ -89,8 +89,6 @@ static int regency_fan_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 
     int return_code = 0;
 
-    bitbuffer_invert(bitbuffer);
-
     for (int row = 0; row < bitbuffer->num_rows; row++) {
         int num_bits = bitbuffer->bits_per_row[row];
 
@@ -178,5 +176,6 @@ r_device const regency_fan = {
         .gap_limit   = 8000,
         .reset_limit = 14000,
         .decode_fn   = &regency_fan_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
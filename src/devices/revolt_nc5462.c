@@ -53,8 +53,6 @@ Pulses
 
 static int revolt_nc5462_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    bitbuffer_invert(bitbuffer);
-
     if (bitbuffer->num_rows != 1) {
         return DECODE_ABORT_EARLY;
     }
@@ -123,5 +121,6 @@ r_device const revolt_nc5462 = {
         .sync_width  = 10024,
         .reset_limit = 272,
         .decode_fn   = &revolt_nc5462_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -321,6 +321,7 @@ r_device const schraeder = {
         .long_width  = 0,
         .reset_limit = 480,
         .decode_fn   = &schraeder_decode,
+        .rows        = {.min_bits = 68, .max_bits = 68},
         .fields      = output_fields,
 };
 
@@ -25,18 +25,19 @@ Units: "Some meter types transmit consumption in 1 kWh units, while others use m
 
 */
 
+static uint8_t const scmplus_frame_sync[] = {0x16, 0xA3, 0x1E};
+
 static int scmplus_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     uint8_t b[16];
     data_t *data;
     unsigned sync_index;
-    const uint8_t scmplus_frame_sync[] = {0x16, 0xA3, 0x1E};
 
     if (bitbuffer->bits_per_row[0] < 128) {
         return (DECODE_ABORT_LENGTH);
     }
 
-    sync_index = bitbuffer_search(bitbuffer, 0, 0, scmplus_frame_sync, 24);
+    sync_index = decoder_search_preamble(decoder, bitbuffer, 0, 0);
 
     if (sync_index >= bitbuffer->bits_per_row[0]) {
         return DECODE_ABORT_EARLY;
@@ -181,5 +182,7 @@ r_device const scmplus = {
         .gap_limit   = 0,
         .reset_limit = 64,
         .decode_fn   = &scmplus_decode,
+        .rows        = {.min_bits = 128},
+        .preamble    = {.pattern = scmplus_frame_sync, .bits = 24},
         .fields      = output_fields,
 };
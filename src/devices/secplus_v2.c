@@ -244,6 +244,16 @@ Security+ 2.0 rolling code.
 static int secplus_v2_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     unsigned search_index = 0;
+
+    // each half comes in a row of its own, check before the bitbuffers are set up
+    unsigned long_rows = 0;
+    for (uint16_t row = 0; row < bitbuffer->num_rows; ++row) {
+        long_rows += bitbuffer->bits_per_row[row] >= 110;
+    }
+    if (long_rows < 2) {
+        return DECODE_FAIL_SANITY;
+    }
+
     bitbuffer_t bits = {0};
     // int i            = 0;
 
@@ -42,9 +42,6 @@ static int sharp_spc775_decode(r_device *decoder, bitbuffer_t *bitbuffer)
     int length_match   = 0;
     int preamble_match = 0;
 
-    // Invert data for processing
-    bitbuffer_invert(bitbuffer);
-
     for (int row = 0; row < bitbuffer->num_rows; row++) {
         if (bitbuffer->bits_per_row[row] >= 48) {
             length_match++;
@@ -107,5 +104,6 @@ r_device const sharp_spc775 = {
         .gap_limit   = 2900,
         .reset_limit = 10000,
         .decode_fn   = &sharp_spc775_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
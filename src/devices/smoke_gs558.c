@@ -58,8 +58,6 @@ static int smoke_gs558_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->num_rows < 3)
         return DECODE_ABORT_EARLY; // truncated transmission
 
-    bitbuffer_invert(bitbuffer);
-
     for (r = 0; r < bitbuffer->num_rows; ++r) {
         b = bitbuffer->bb[r];
 
@@ -133,6 +131,7 @@ r_device const smoke_gs558 = {
         .gap_limit   = 1299 * 1.5f,  // Maximum gap size before new row of bits [us]
         .reset_limit = 11764 * 1.2f, // Maximum gap size before End Of Message [us]
         .decode_fn   = &smoke_gs558_callback,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
         .disabled    = 1, // false positives with generic EV1527 devices
 };
@@ -161,6 +161,7 @@ static char const *const output_fields[] = {
 r_device const srsmith_pool_srs_2c_tx = {
         .name        = "SRSmith Pool Light Remote Control SRS-2C-TX (-f 915M)",
         .modulation  = FSK_PULSE_PCM,
+        .bands       = FREQ_BAND_915,
         .short_width = 100,
         .long_width  = 100,
         .reset_limit = 4096,
@@ -54,7 +54,6 @@ static int tfa_303196_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     int row;
     data_t *data;
     uint8_t *b;
-    bitbuffer_t databits = {0};
 
     row = bitbuffer_find_repeated_row(bitbuffer, 2, 48 * 2 + 12); // expected are 4 rows, require 2
     if (row < 0)
@@ -66,6 +65,7 @@ static int tfa_303196_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->bits_per_row[row] - start_pos < 48 * 2)
         return DECODE_ABORT_LENGTH; // short buffer or preamble not found
 
+    bitbuffer_t databits = {0};
     bitbuffer_manchester_decode(bitbuffer, row, start_pos, &databits, 48);
 
     if (databits.bits_per_row[0] < 48)
@@ -51,7 +51,6 @@ static int tfa_303221_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     if (bitbuffer->bits_per_row[row] > 41)
         return DECODE_ABORT_LENGTH;
 
-    bitbuffer_invert(bitbuffer);
     b = bitbuffer->bb[row];
 
     device = b[0];
@@ -111,6 +110,7 @@ r_device const tfa_30_3221 = {
         .reset_limit = 850,
         .sync_width  = 836,
         .decode_fn   = &tfa_303221_callback,
+        .transform   = BITBUFFER_INVERTED,
         .priority    = 10, // This is the same as LaCrosse-TX141THBv2
         .fields      = output_fields,
 };
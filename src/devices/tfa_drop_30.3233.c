@@ -119,8 +119,6 @@ Afterwards, messages are sent every 45s.
 
 static int tfa_drop_303233_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    bitbuffer_invert(bitbuffer);
-
     int row_index = bitbuffer_find_repeated_row(bitbuffer, TFA_DROP_MINREPEATS,
             TFA_DROP_BITLEN);
     if (row_index < 0 || bitbuffer->bits_per_row[row_index] > TFA_DROP_BITLEN + 16) {
@@ -194,5 +192,6 @@ r_device const tfa_drop_303233 = {
         .reset_limit = 2500,
         .sync_width  = 750,
         .decode_fn   = &tfa_drop_303233_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -39,7 +39,7 @@ Data layout (nibbles):
 static int tpms_abarth124_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned bitpos)
 {
     bitbuffer_t packet_bits = {0};
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 72);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 72);
 
     // make sure we decoded the expected number of bits
     if (packet_bits.bits_per_row[0] < 72) {
@@ -82,18 +82,17 @@ static int tpms_abarth124_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsi
     return 1;
 }
 
+// preamble
+static uint8_t const preamble_pattern[3] = {0xaa, 0xaa, 0xa9}; // after invert
+
 /** @sa tpms_abarth124_decode() */
 static int tpms_abarth124_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // preamble
-    uint8_t const preamble_pattern[3] = {0xaa, 0xaa, 0xa9}; // after invert
-
     unsigned bitpos = 0;
     int events      = 0;
 
-    bitbuffer_invert(bitbuffer);
     // Find a preamble with enough bits after it that it could be a complete packet
-    while ((bitpos = bitbuffer_search(bitbuffer, 0, bitpos, preamble_pattern, 24)) + 80 <=
+    while ((bitpos = decoder_search_preamble(decoder, bitbuffer, 0, bitpos)) + 80 <=
             bitbuffer->bits_per_row[0]) {
         events += tpms_abarth124_decode(decoder, bitbuffer, 0, bitpos + 24);
         bitpos += 2;
@@ -122,5 +121,7 @@ r_device const tpms_abarth124 = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_abarth124_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 24, .inverted = 1},
         .fields      = output_fields,
 };
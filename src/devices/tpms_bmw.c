@@ -105,7 +105,7 @@ static int tpms_bmw_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 
     decoder_log_bitrow(decoder, 2, __func__, bitbuffer->bb[0], bitbuffer->bits_per_row[0], "MSG");
 
-    bitbuffer_manchester_decode(bitbuffer, 0, pos + sizeof(preamble_pattern) * 8, &decoded, len_msg * 8);
+    decoder_manchester_decode(decoder, bitbuffer, 0, pos + sizeof(preamble_pattern) * 8, &decoded, len_msg * 8);
 
     decoder_log_bitrow(decoder, 2, __func__, decoded.bb[0], decoded.bits_per_row[0], "MC");
 
@@ -42,7 +42,7 @@ static int tpms_citroen_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsign
     int maybe_battery;
     int crc;
 
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 88);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 88);
 
     // decoder_logf(decoder, 3, __func__, "bits %d", packet_bits.bits_per_row[0]);
     if (packet_bits.bits_per_row[0] < 80) {
@@ -92,21 +92,20 @@ static int tpms_citroen_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsign
     return 1;
 }
 
+// full preamble is 55 55 55 56 (inverted: aa aa aa a9)
+static uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
+
 /** @sa tpms_citroen_decode() */
 static int tpms_citroen_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble is 55 55 55 56 (inverted: aa aa aa a9)
-    uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
     // full trailer is 01111110
 
     unsigned bitpos = 0;
     int ret         = 0;
     int events      = 0;
 
-    bitbuffer_invert(bitbuffer);
-
     // Find a preamble with enough bits after it that it could be a complete packet
-    while ((bitpos = bitbuffer_search(bitbuffer, 0, bitpos, preamble_pattern, 16)) + 178 <=
+    while ((bitpos = decoder_search_preamble(decoder, bitbuffer, 0, bitpos)) + 178 <=
             bitbuffer->bits_per_row[0]) {
         ret = tpms_citroen_decode(decoder, bitbuffer, 0, bitpos + 16);
         if (ret > 0)
@@ -139,5 +138,7 @@ r_device const tpms_citroen = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_citroen_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 16, .inverted = 1},
         .fields      = output_fields,
 };
@@ -79,7 +79,6 @@ static int tpms_eezrv_decode(r_device *decoder, bitbuffer_t *bitbuffer)
         return DECODE_ABORT_EARLY;
     }
     int pos = 0;
-    bitbuffer_invert(bitbuffer);
     pos = bitbuffer_search(bitbuffer, 0, pos, preamble_pattern, sizeof(preamble_pattern) * 8);
     if (pos >= bitbuffer->bits_per_row[0]) {
         decoder_log(decoder, 3, __func__, "Preamble not found");
@@ -166,5 +165,6 @@ r_device const tpms_eezrv = {
         .long_width  = 50,
         .reset_limit = 120,
         .decode_fn   = &tpms_eezrv_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -67,7 +67,7 @@ static int tpms_ford_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned
     int unknown;
     int unknown_3;
 
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 160);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 160);
 
     // require 64 data bits
     if (packet_bits.bits_per_row[0] < 64) {
@@ -181,24 +181,21 @@ static int tpms_ford_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned
     return 1;
 }
 
+// full preamble is 55 55 55 56 (inverted: aa aa aa a9)
+static uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
+
 /** @sa tpms_ford_decode() */
 static int tpms_ford_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble is 55 55 55 56 (inverted: aa aa aa a9)
-    uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
-
     int row;
     unsigned bitpos;
     int ret    = 0;
     int events = 0;
 
-    bitbuffer_invert(bitbuffer);
-
     for (row = 0; row < bitbuffer->num_rows; ++row) {
         bitpos = 0;
         // Find a preamble with enough bits after it that it could be a complete packet
-        while ((bitpos = bitbuffer_search(bitbuffer, row, bitpos,
-                preamble_pattern, 16)) + 144 <=
+        while ((bitpos = decoder_search_preamble(decoder, bitbuffer, row, bitpos)) + 144 <=
                 bitbuffer->bits_per_row[row]) {
             ret = tpms_ford_decode(decoder, bitbuffer, row, bitpos + 16);
             if (ret > 0)
@@ -233,5 +230,7 @@ r_device const tpms_ford = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_ford_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 16, .inverted = 1},
         .fields      = output_fields,
 };
@@ -53,7 +53,7 @@ static int tpms_hyundai_vdo_decode(r_device *decoder, bitbuffer_t *bitbuffer, un
     int maybe_battery;
     int crc;
 
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 80);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 80);
 
     if (packet_bits.bits_per_row[0] < 80) {
         return DECODE_FAIL_SANITY; // too short to be a whole packet
@@ -100,23 +100,21 @@ static int tpms_hyundai_vdo_decode(r_device *decoder, bitbuffer_t *bitbuffer, un
     return 1;
 }
 
+// full preamble is 55 55 55 56 (inverted: aa aa aa a9)
+static uint8_t const preamble_pattern[4] = {0xaa, 0xaa, 0xaa, 0xa9};
+
 /**
 Wrapper for the Hyundai-VDO tpms.
 @sa tpms_hyundai_vdo_decode()
 */
 static int tpms_hyundai_vdo_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble is 55 55 55 56 (inverted: aa aa aa a9)
-    uint8_t const preamble_pattern[4] = {0xaa, 0xaa, 0xaa, 0xa9};
-
     unsigned bitpos = 0;
     int ret         = 0;
     int events      = 0;
 
-    bitbuffer_invert(bitbuffer);
-
     // Find a preamble with enough bits after it that it could be a complete packet
-    while ((bitpos = bitbuffer_search(bitbuffer, 0, bitpos, preamble_pattern, 32)) + 80 <=
+    while ((bitpos = decoder_search_preamble(decoder, bitbuffer, 0, bitpos)) + 80 <=
             bitbuffer->bits_per_row[0]) {
         ret = tpms_hyundai_vdo_decode(decoder, bitbuffer, 0, bitpos + 32);
         if (ret > 0)
@@ -148,5 +146,7 @@ r_device const tpms_hyundai_vdo = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_hyundai_vdo_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 32, .inverted = 1},
         .fields      = output_fields,
 };
@@ -50,7 +50,7 @@ static int tpms_jansite_solar_decode(r_device *decoder, bitbuffer_t *bitbuffer,
     int pressure;
     int temperature;
 
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 88);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 88);
     bitbuffer_invert(&packet_bits);
 
     if (packet_bits.bits_per_row[0] < 88) {
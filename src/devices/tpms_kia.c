@@ -55,7 +55,7 @@ static int tpms_kia_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned r
     unsigned int start_pos;
     const unsigned int preamble_length = 16;
 
-    start_pos = bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 154 - preamble_length);
+    start_pos = decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 154 - preamble_length);
     if (start_pos - bitpos < 154 - preamble_length) {
         return DECODE_ABORT_LENGTH;
     }
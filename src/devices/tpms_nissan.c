@@ -23,7 +23,7 @@ static int tpms_nissan_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigne
 {
     bitbuffer_t packet_bits = {0};
 
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 113);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 113);
     bitbuffer_invert(&packet_bits); // Manchester (G.E. Thomas) Decoded
 
     // FIXME Debug stuff
@@ -36,7 +36,7 @@ Could be that the 4th/5th bit encode a pressure alert and the 10th bit indicates
 static int tpms_renault_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned bitpos)
 {
     bitbuffer_t packet_bits = {0};
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 160);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 160);
     // require 72 data bits
     if (packet_bits.bits_per_row[0] < 72) {
         return 0; // DECODE_ABORT_LENGTH
@@ -78,24 +78,21 @@ static int tpms_renault_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsign
     return 1;
 }
 
+// full preamble is 55 55 55 56 (inverted: aa aa aa a9)
+static uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
+
 /** @sa tpms_renault_decode() */
 static int tpms_renault_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble is 55 55 55 56 (inverted: aa aa aa a9)
-    uint8_t const preamble_pattern[2] = {0xaa, 0xa9}; // 16 bits
-
     int row;
     unsigned bitpos;
     int ret    = 0;
     int events = 0;
 
-    bitbuffer_invert(bitbuffer);
-
     for (row = 0; row < bitbuffer->num_rows; ++row) {
         bitpos = 0;
         // Find a preamble with enough bits after it that it could be a complete packet
-        while ((bitpos = bitbuffer_search(bitbuffer, row, bitpos,
-                preamble_pattern, 16)) + 160 <=
+        while ((bitpos = decoder_search_preamble(decoder, bitbuffer, row, bitpos)) + 160 <=
                 bitbuffer->bits_per_row[row]) {
             ret = tpms_renault_decode(decoder, bitbuffer, row, bitpos + 16);
             if (ret > 0)
@@ -125,5 +122,7 @@ r_device const tpms_renault = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_renault_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 16, .inverted = 1},
         .fields      = output_fields,
 };
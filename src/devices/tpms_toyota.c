@@ -79,19 +79,19 @@ static int tpms_toyota_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigne
     return 1;
 }
 
+// full preamble is 0101 0101 0011 11 = 55 3c
+// could be shorter   11 0101 0011 11
+static uint8_t const preamble_pattern[2] = {0xa9, 0xe0}; // 12 bits (but pass last bit to decode)
+
 /** @sa tpms_toyota_decode() */
 static int tpms_toyota_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // full preamble is 0101 0101 0011 11 = 55 3c
-    // could be shorter   11 0101 0011 11
-    uint8_t const preamble_pattern[2] = {0xa9, 0xe0}; // 12 bits (but pass last bit to decode)
-
     unsigned bitpos = 0;
     int ret         = 0;
     int events      = 0;
 
     // Find a preamble with enough bits after it that it could be a complete packet
-    while ((bitpos = bitbuffer_search(bitbuffer, 0, bitpos, preamble_pattern, 12)) + 156 <=
+    while ((bitpos = decoder_search_preamble(decoder, bitbuffer, 0, bitpos)) + 156 <=
             bitbuffer->bits_per_row[0]) {
         ret = tpms_toyota_decode(decoder, bitbuffer, 0, bitpos + 11);
         if (ret > 0)
@@ -120,5 +120,6 @@ r_device const tpms_toyota = {
         .long_width  = 52,  // FSK
         .reset_limit = 150, // Maximum gap size before End Of Message [us].
         .decode_fn   = &tpms_toyota_callback,
+        .preamble    = {.pattern = preamble_pattern, .bits = 12},
         .fields      = output_fields,
 };
@@ -52,7 +52,7 @@ Example data:
 static int tpms_truck_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned row, unsigned bitpos)
 {
     bitbuffer_t packet_bits = {0};
-    bitbuffer_manchester_decode(bitbuffer, row, bitpos, &packet_bits, 76);
+    decoder_manchester_decode(decoder, bitbuffer, row, bitpos, &packet_bits, 76);
 
     if (packet_bits.bits_per_row[row] < 76) {
         return 0; // DECODE_FAIL_SANITY;
@@ -96,18 +96,17 @@ static int tpms_truck_decode(r_device *decoder, bitbuffer_t *bitbuffer, unsigned
     return 1;
 }
 
+// preamble
+static uint8_t const preamble_pattern[3] = {0xaa, 0xaa, 0xa9}; // after invert
+
 /** @sa tpms_truck_decode() */
 static int tpms_truck_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
-    // preamble
-    uint8_t const preamble_pattern[3] = {0xaa, 0xaa, 0xa9}; // after invert
-
     unsigned bitpos = 0;
     int events      = 0;
 
-    bitbuffer_invert(bitbuffer);
     // Find a preamble with enough bits after it that it could be a complete packet
-    while ((bitpos = bitbuffer_search(bitbuffer, 0, bitpos, preamble_pattern, 24)) + 160 <=
+    while ((bitpos = decoder_search_preamble(decoder, bitbuffer, 0, bitpos)) + 160 <=
             bitbuffer->bits_per_row[0]) {
         events += tpms_truck_decode(decoder, bitbuffer, 0, bitpos + 24);
         bitpos += 2;
@@ -136,5 +135,7 @@ r_device const tpms_truck = {
         .long_width  = 52,
         .reset_limit = 150,
         .decode_fn   = &tpms_truck_callback,
+        .transform   = BITBUFFER_INVERTED,
+        .preamble    = {.pattern = preamble_pattern, .bits = 24, .inverted = 1},
         .fields      = output_fields,
 };
@@ -155,5 +155,6 @@ r_device const vaillant_vrt340f = {
         .reset_limit = 4000,
         .tolerance   = 120, // us
         .decode_fn   = &vaillant_vrt340_callback,
+        .rows        = {.min_bits = 128},
         .fields      = output_fields,
 };
@@ -92,8 +92,6 @@ static int watts_thermostat_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     uint8_t const preamble_pattern[] = {0xa5}; // inverted, raw value is 0x5a
 
-    bitbuffer_invert(bitbuffer);
-
     // We're expecting a single row
     for (uint16_t row = 0; row < bitbuffer->num_rows; ++row) {
         uint16_t row_len = bitbuffer->bits_per_row[row];
@@ -189,5 +187,6 @@ r_device const watts_thermostat = {
         .sync_width  = 6000,
         .reset_limit = 900,
         .decode_fn   = &watts_thermostat_decode,
+        .transform   = BITBUFFER_INVERTED,
         .fields      = output_fields,
 };
@@ -98,5 +98,6 @@ r_device const waveman = {
         .sync_width  = 0,   // No sync bit used
         .tolerance   = 200, // us
         .decode_fn   = &waveman_callback,
+        .rows        = {.min_bits = 25, .max_bits = 25},
         .fields      = output_fields,
 };
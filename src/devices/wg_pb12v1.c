@@ -98,5 +98,6 @@ r_device const wg_pb12v1 = {
         .long_width  = 1476, // Maximum pulse period (long pulse + fixed gap)
         .reset_limit = 2500, // We just want 1 package
         .decode_fn   = &wg_pb12v1_decode,
+        .rows        = {.min_bits = 48},
         .fields      = output_fields,
 };
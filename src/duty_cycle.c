@@ -0,0 +1,171 @@
+/** @file
+    Duty-cycled listening for periodic transmitters.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "duty_cycle.h"
+
+#include "compat_atomic.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+
+/// Transmitters tracked.
+#define DUTY_TRACKS 64
+/// Events this close are repeats of one transmission.
+#define DUTY_BURST_MS 1500
+/// Jitter of a periodic transmission, listen this early before and late after it is due.
+#define DUTY_TOLERANCE_MS 500
+/// Keep listening this long after the window for the repeats of a transmission.
+#define DUTY_HOLD_MS 1000
+/// The clocks of a sensor and the receiver drift, widen the window by this fraction of the time since the last transmission.
+#define DUTY_DRIFT_DIV 500
+/// Shortest and longest period of a periodic transmitter.
+#define DUTY_MIN_PERIOD_MS 5000
+#define DUTY_MAX_PERIOD_MS 900000
+/// A transmitter missing this many periods is no longer expected.
+#define DUTY_STALE_PERIODS 4
+
+typedef struct {
+    uint64_t hash;   ///< the transmitter, 0 if unused
+    uint64_t last;   ///< time of the last transmission
+    uint64_t period; ///< ms between transmissions, 0 if not seen twice
+} duty_track_t;
+
+struct duty_cycle {
+    unsigned lock;
+    uint64_t survey;       ///< length of a full listen window
+    uint64_t every;        ///< time between the full listen windows
+    uint64_t survey_start; ///< start of the last full listen window
+    int started;
+    duty_track_t track[DUTY_TRACKS];
+};
+
+static uint64_t key_hash(char const *key)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (; *key; ++key) {
+        hash = (hash ^ (unsigned char)*key) * 0x100000001b3ULL;
+    }
+    return hash ? hash : 1;
+}
+
+static uint64_t track_guard(duty_track_t const *track, uint64_t time_ms)
+{
+    return DUTY_TOLERANCE_MS + (time_ms - track->last) / DUTY_DRIFT_DIV;
+}
+
+duty_cycle_t *duty_cycle_create(uint64_t survey_ms, uint64_t every_ms)
+{
+    if (!survey_ms)
+        return NULL;
+
+    duty_cycle_t *dc = calloc(1, sizeof(*dc));
+    if (!dc) {
+        WARN_CALLOC("duty_cycle_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    dc->survey = survey_ms;
+    dc->every  = every_ms > survey_ms ? every_ms : survey_ms;
+    return dc;
+}
+
+void duty_cycle_free(duty_cycle_t *dc)
+{
+    free(dc);
+}
+
+void duty_cycle_event(duty_cycle_t *dc, char const *key, uint64_t time_ms)
+{
+    uint64_t hash = key_hash(key);
+
+    atomic_spin_lock(&dc->lock);
+    duty_track_t *slot = NULL;
+    for (unsigned i = 0; i < DUTY_TRACKS; ++i) {
+        duty_track_t *track = &dc->track[i];
+        if (track->hash == hash) {
+            slot = track;
+            break;
+        }
+        // replace an unused, or the longest unseen one
+        if (!slot || (slot->hash && (!track->hash || track->last < slot->last)))
+            slot = track;
+    }
+    if (slot->hash != hash) {
+        *slot = (duty_track_t){.hash = hash, .last = time_ms};
+        atomic_spin_unlock(&dc->lock);
+        return;
+    }
+
+    // the input of a channel may be a frame behind, keep the latest
+    uint64_t since = time_ms > slot->last ? time_ms - slot->last : 0;
+    if (since < DUTY_BURST_MS) {
+        atomic_spin_unlock(&dc->lock);
+        return; // a repeat of the last transmission
+    }
+    if (slot->period) {
+        // possibly after missed transmissions
+        uint64_t periods = (since + slot->period / 2) / slot->period;
+        uint64_t due     = slot->last + periods * slot->period;
+        uint64_t guard   = track_guard(slot, time_ms);
+        if (periods && time_ms + guard >= due && time_ms <= due + guard)
+            slot->period = (slot->period * 3 + since / periods) / 4;
+        else
+            slot->period = 0;
+    }
+    // the second transmission, or the transmitter changed its period
+    if (!slot->period && since >= DUTY_MIN_PERIOD_MS && since <= DUTY_MAX_PERIOD_MS)
+        slot->period = since;
+    slot->last = time_ms;
+    atomic_spin_unlock(&dc->lock);
+}
+
+int duty_cycle_listen(duty_cycle_t *dc, uint64_t time_ms)
+{
+    atomic_spin_lock(&dc->lock);
+    if (!dc->started || time_ms >= dc->survey_start + dc->every) {
+        dc->started      = 1;
+        dc->survey_start = time_ms;
+    }
+    int listen = time_ms < dc->survey_start + dc->survey;
+
+    int periodic = 0;
+    for (unsigned i = 0; i < DUTY_TRACKS; ++i) {
+        duty_track_t *track = &dc->track[i];
+        if (!track->hash || !track->period || time_ms < track->last)
+            continue;
+        uint64_t since = time_ms - track->last;
+        uint64_t guard = track_guard(track, time_ms);
+        // the next due transmission, or the current one if within its window
+        uint64_t periods = (since + guard) / track->period;
+        if (periods > DUTY_STALE_PERIODS) {
+            track->period = 0; // until heard again
+            continue;
+        }
+        periodic = 1;
+        uint64_t due = track->last + periods * track->period;
+        if (since < DUTY_HOLD_MS || (periods && time_ms <= due + guard + DUTY_HOLD_MS))
+            listen = 1;
+    }
+    atomic_spin_unlock(&dc->lock);
+
+    return listen || !periodic;
+}
+
+unsigned duty_cycle_periodic(duty_cycle_t *dc)
+{
+    unsigned count = 0;
+    atomic_spin_lock(&dc->lock);
+    for (unsigned i = 0; i < DUTY_TRACKS; ++i) {
+        if (dc->track[i].hash && dc->track[i].period)
+            count++;
+    }
+    atomic_spin_unlock(&dc->lock);
+    return count;
+}
@@ -0,0 +1,310 @@
+/** @file
+    Cross-receiver event fusion, drops the events other receivers got with a better signal.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_fusion.h"
+
+#include "mongoose.h"
+#include "data.h"
+#include "list.h"
+#include "compat_time.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Key of the mark, never output, the mark is removed on the event loop.
+#define FUSION_KEY "_fusion"
+
+/// Number of announcements of the other receivers remembered, enough for a few windows at a high event rate.
+#define FUSION_PEERS 256
+
+/// Announcement datagram: magic and version, node id, fingerprint, RSSI in 0.1 dB, all little-endian.
+#define FUSION_MAGIC "R4F1"
+#define FUSION_MSG_LEN (4 + 4 + 8 + 2)
+
+typedef struct fusion_peer {
+    uint64_t hash;
+    uint32_t node;
+    int rssi; ///< in 0.1 dB
+    double time;
+} fusion_peer_t;
+
+/// An event held for the window.
+typedef struct fusion_event {
+    data_t *data;
+    uint64_t hash;
+    int rssi; ///< in 0.1 dB
+    double deadline;
+} fusion_event_t;
+
+struct event_fusion {
+    struct mg_connection *conn;
+    struct sockaddr_in group;
+    double window;
+    uint32_t node;
+    event_fusion_output_fn output_fn;
+    void *ctx;
+    list_t held; ///< fusion_event_t in the order of the deadlines
+    fusion_peer_t peers[FUSION_PEERS];
+    unsigned next_peer;
+    unsigned dropped;
+};
+
+// the other copy wins with a better RSSI, or the same RSSI and a lower node id
+static int peer_wins(int peer_rssi, uint32_t peer_node, int rssi, uint32_t node)
+{
+    return peer_rssi > rssi || (peer_rssi == rssi && peer_node < node);
+}
+
+static void fusion_event_free(fusion_event_t *ev)
+{
+    data_free(ev->data);
+    free(ev);
+}
+
+static void announce(event_fusion_t *fusion, uint64_t hash, int rssi)
+{
+    uint8_t msg[FUSION_MSG_LEN];
+    memcpy(msg, FUSION_MAGIC, 4);
+    for (int i = 0; i < 4; ++i) {
+        msg[4 + i] = (uint8_t)(fusion->node >> (8 * i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        msg[8 + i] = (uint8_t)(hash >> (8 * i));
+    }
+    msg[16] = (uint8_t)((unsigned)rssi & 0xff);
+    msg[17] = (uint8_t)(((unsigned)rssi >> 8) & 0xff);
+
+    if (sendto(fusion->conn->sock, (char const *)msg, sizeof(msg), 0, (struct sockaddr const *)&fusion->group, sizeof(fusion->group)) < 0) {
+        print_log(LOG_WARNING, "Fusion", "Sending the announcement failed");
+    }
+}
+
+// output the events whose window ended and set the timer for the next one
+static void release_expired(event_fusion_t *fusion, double now)
+{
+    while (fusion->held.len) {
+        fusion_event_t *ev = fusion->held.elems[0];
+        if (ev->deadline > now) {
+            break;
+        }
+        data_t *data = ev->data;
+        ev->data     = NULL;
+        list_remove(&fusion->held, 0, (list_elem_free_fn)fusion_event_free);
+        fusion->output_fn(fusion->ctx, data);
+    }
+    if (fusion->held.len) {
+        fusion_event_t *ev = fusion->held.elems[0];
+        mg_set_timer(fusion->conn, ev->deadline);
+    }
+}
+
+static void receive_announcement(event_fusion_t *fusion, uint8_t const *msg, size_t len)
+{
+    if (len != FUSION_MSG_LEN || memcmp(msg, FUSION_MAGIC, 4) != 0) {
+        return;
+    }
+    uint32_t node = 0;
+    for (int i = 0; i < 4; ++i) {
+        node |= (uint32_t)msg[4 + i] << (8 * i);
+    }
+    if (node == fusion->node) {
+        return; // our own announcement looped back
+    }
+    uint64_t hash = 0;
+    for (int i = 0; i < 8; ++i) {
+        hash |= (uint64_t)msg[8 + i] << (8 * i);
+    }
+    int rssi = (int16_t)(msg[16] | (msg[17] << 8));
+
+    fusion_peer_t *peer = &fusion->peers[fusion->next_peer];
+    peer->hash          = hash;
+    peer->node          = node;
+    peer->rssi          = rssi;
+    peer->time          = mg_time();
+    fusion->next_peer   = (fusion->next_peer + 1) % FUSION_PEERS;
+
+    for (size_t i = 0; i < fusion->held.len; ++i) {
+        fusion_event_t *ev = fusion->held.elems[i];
+        if (ev->hash == hash && peer_wins(rssi, node, ev->rssi, fusion->node)) {
+            list_remove(&fusion->held, i, (list_elem_free_fn)fusion_event_free);
+            fusion->dropped++;
+            break;
+        }
+    }
+}
+
+static void fusion_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    event_fusion_t *fusion = nc->user_data;
+    (void)ev_data;
+
+    if (!fusion) {
+        return; // the fusion is freed, the connections are closing
+    }
+    if (ev == MG_EV_RECV) {
+        receive_announcement(fusion, (uint8_t const *)nc->recv_mbuf.buf, nc->recv_mbuf.len);
+        mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
+    }
+    else if (ev == MG_EV_TIMER) {
+        release_expired(fusion, mg_time());
+    }
+}
+
+event_fusion_t *event_fusion_create(struct mg_mgr *mgr, char const *host, char const *port, unsigned window_ms, int ttl,
+        event_fusion_output_fn output_fn, void *ctx)
+{
+    struct addrinfo hints = {0};
+    hints.ai_family       = AF_INET;
+    hints.ai_socktype     = SOCK_DGRAM;
+    struct addrinfo *res  = NULL;
+    if (getaddrinfo(host, port, &hints, &res) || !res) {
+        print_logf(LOG_ERROR, "Fusion", "Unknown multicast group %s port %s", host, port);
+        return NULL;
+    }
+    struct sockaddr_in group;
+    memcpy(&group, res->ai_addr, sizeof(group));
+    freeaddrinfo(res);
+    if (!IN_MULTICAST(ntohl(group.sin_addr.s_addr))) {
+        print_logf(LOG_ERROR, "Fusion", "Not a multicast group: %s", host);
+        return NULL;
+    }
+
+    event_fusion_t *fusion = calloc(1, sizeof(*fusion));
+    if (!fusion) {
+        WARN_CALLOC("event_fusion_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    fusion->group     = group;
+    fusion->window    = window_ms / 1000.0;
+    fusion->output_fn = output_fn;
+    fusion->ctx       = ctx;
+    // distinct for the processes on a host, the tie-break only needs to be consistent
+    uint64_t seed = time_monotonic_ns() ^ (uint64_t)(uintptr_t)fusion;
+    fusion->node  = (uint32_t)(seed ^ (seed >> 32)) | 1;
+
+    char address[64];
+    snprintf(address, sizeof(address), "udp://:%s", port);
+    fusion->conn = mg_bind(mgr, address, fusion_handler);
+    if (!fusion->conn) {
+        print_logf(LOG_ERROR, "Fusion", "Binding port %s failed", port);
+        free(fusion);
+        return NULL;
+    }
+    fusion->conn->user_data = fusion;
+
+    struct ip_mreq mreq   = {0};
+    mreq.imr_multiaddr    = group.sin_addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fusion->conn->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char const *)&mreq, sizeof(mreq)) < 0) {
+        print_logf(LOG_ERROR, "Fusion", "Joining the multicast group %s failed", host);
+        fusion->conn->user_data = NULL;
+        fusion->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+        free(fusion);
+        return NULL;
+    }
+    unsigned char mttl = (unsigned char)ttl;
+    setsockopt(fusion->conn->sock, IPPROTO_IP, IP_MULTICAST_TTL, (char const *)&mttl, sizeof(mttl));
+
+    return fusion;
+}
+
+void event_fusion_free(event_fusion_t *fusion)
+{
+    if (!fusion) {
+        return;
+    }
+    // the window of the events held is cut short
+    release_expired(fusion, HUGE_VAL);
+    list_free_elems(&fusion->held, NULL);
+
+    // the connection is freed with the event loop
+    fusion->conn->user_data = NULL;
+    fusion->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+    free(fusion);
+}
+
+data_t *event_fusion_mark(data_t *data, uint64_t hash, float rssi_db)
+{
+    char mark[40];
+    snprintf(mark, sizeof(mark), "%016" PRIx64 " %d", hash, (int)lrintf(rssi_db * 10.0f));
+    return data_prepend(data, data_str(NULL, FUSION_KEY, "", NULL, mark));
+}
+
+int event_fusion_hold(event_fusion_t *fusion, data_t *data)
+{
+    if (!data || strcmp(data->key, FUSION_KEY) != 0) {
+        return 0;
+    }
+    char *end;
+    uint64_t hash = strtoull(data->value.v_ptr, &end, 16);
+    int rssi      = (int)strtol(end, NULL, 10);
+    data_t *event = data->next;
+    data->next    = NULL;
+    data_free(data);
+
+    double now = mg_time();
+    release_expired(fusion, now);
+
+    // a better copy of another receiver was announced already
+    for (unsigned i = 0; i < FUSION_PEERS; ++i) {
+        fusion_peer_t const *peer = &fusion->peers[i];
+        if (peer->hash == hash && peer->time + fusion->window >= now && peer_wins(peer->rssi, peer->node, rssi, fusion->node)) {
+            data_free(event);
+            fusion->dropped++;
+            return 1;
+        }
+    }
+
+    // a repeat of an event held, keep the better copy in its place
+    for (size_t i = 0; i < fusion->held.len; ++i) {
+        fusion_event_t *ev = fusion->held.elems[i];
+        if (ev->hash == hash) {
+            if (rssi > ev->rssi) {
+                data_free(ev->data);
+                ev->data = event;
+                ev->rssi = rssi;
+                announce(fusion, hash, rssi);
+            }
+            else {
+                data_free(event);
+            }
+            fusion->dropped++;
+            return 1;
+        }
+    }
+
+    fusion_event_t *ev = calloc(1, sizeof(*ev));
+    if (!ev) {
+        WARN_CALLOC("event_fusion_hold()");
+        fusion->output_fn(fusion->ctx, event);
+        return 1;
+    }
+    ev->data     = event;
+    ev->hash     = hash;
+    ev->rssi     = rssi;
+    ev->deadline = now + fusion->window;
+    list_push(&fusion->held, ev);
+    if (fusion->held.len == 1) {
+        mg_set_timer(fusion->conn, ev->deadline);
+    }
+    announce(fusion, hash, rssi);
+    return 1;
+}
+
+unsigned event_fusion_dropped(event_fusion_t const *fusion)
+{
+    return fusion->dropped;
+}
@@ -0,0 +1,284 @@
+/** @file
+    Merges the events of several inputs into the order of their sample time.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_merge.h"
+
+#include "data.h"
+#include "fatal.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Key of the mark, never output, the mark is removed on the output thread.
+#define MERGE_KEY "_merge"
+
+/// Position in the heap of a source without events held.
+#define NOT_IN_HEAP (~0u)
+
+typedef struct merge_event {
+    struct data *data;
+    int64_t time_us;
+} merge_event_t;
+
+typedef struct merge_source {
+    uint64_t id;         ///< the source as given to the mark
+    int64_t progress_us; ///< the source has no more events before this
+    merge_event_t *ring; ///< the events held in the order of arrival
+    unsigned size;       ///< the capacity of the ring, a power of two
+    unsigned head;       ///< the first event held
+    unsigned count;      ///< the number of events held
+    unsigned heap_pos;   ///< position in the heap, NOT_IN_HEAP if no events are held
+} merge_source_t;
+
+struct event_merge {
+    int64_t window_us;
+    event_merge_output_fn output_fn;
+    void *ctx;
+    merge_source_t *sources; ///< in the order the sources were first seen
+    unsigned num_sources;
+    unsigned *heap;          ///< the sources with events held, the earliest first event on top
+    unsigned heap_len;
+    int64_t latest_us;       ///< the latest progress of any source
+    int64_t output_us;       ///< the latest time of an event output
+    int have_output;
+    unsigned held;
+    unsigned late;
+};
+
+// earlier first event, or the same time and the source seen first
+static int source_before(event_merge_t const *merge, unsigned a, unsigned b)
+{
+    merge_source_t const *sa = &merge->sources[a];
+    merge_source_t const *sb = &merge->sources[b];
+    int64_t ta = sa->ring[sa->head].time_us;
+    int64_t tb = sb->ring[sb->head].time_us;
+    return ta < tb || (ta == tb && a < b);
+}
+
+static void heap_set(event_merge_t *merge, unsigned pos, unsigned source)
+{
+    merge->heap[pos]                = source;
+    merge->sources[source].heap_pos = pos;
+}
+
+static void sift_up(event_merge_t *merge, unsigned pos)
+{
+    unsigned source = merge->heap[pos];
+    while (pos > 0) {
+        unsigned parent = (pos - 1) / 2;
+        if (!source_before(merge, source, merge->heap[parent]))
+            break;
+        heap_set(merge, pos, merge->heap[parent]);
+        pos = parent;
+    }
+    heap_set(merge, pos, source);
+}
+
+static void sift_down(event_merge_t *merge, unsigned pos)
+{
+    unsigned source = merge->heap[pos];
+    for (;;) {
+        unsigned child = 2 * pos + 1;
+        if (child >= merge->heap_len)
+            break;
+        if (child + 1 < merge->heap_len && source_before(merge, merge->heap[child + 1], merge->heap[child]))
+            child += 1;
+        if (!source_before(merge, merge->heap[child], source))
+            break;
+        heap_set(merge, pos, merge->heap[child]);
+        pos = child;
+    }
+    heap_set(merge, pos, source);
+}
+
+// output the first event of the source on top of the heap
+static void output_top(event_merge_t *merge)
+{
+    unsigned index      = merge->heap[0];
+    merge_source_t *src = &merge->sources[index];
+    merge_event_t ev    = src->ring[src->head];
+    src->head           = (src->head + 1) & (src->size - 1);
+    src->count -= 1;
+    merge->held -= 1;
+
+    if (src->count) {
+        sift_down(merge, 0);
+    }
+    else {
+        src->heap_pos = NOT_IN_HEAP;
+        merge->heap_len -= 1;
+        if (merge->heap_len) {
+            heap_set(merge, 0, merge->heap[merge->heap_len]);
+            sift_down(merge, 0);
+        }
+    }
+
+    if (merge->have_output && ev.time_us < merge->output_us) {
+        merge->late += 1;
+    }
+    else {
+        merge->output_us   = ev.time_us;
+        merge->have_output = 1;
+    }
+    merge->output_fn(merge->ctx, ev.data);
+}
+
+// output the events no source will be earlier than, and those of a lagging source
+static void release(event_merge_t *merge)
+{
+    if (!merge->num_sources)
+        return;
+
+    int64_t limit = merge->sources[0].progress_us;
+    for (unsigned i = 1; i < merge->num_sources; ++i) {
+        if (merge->sources[i].progress_us < limit)
+            limit = merge->sources[i].progress_us;
+    }
+    if (merge->latest_us - merge->window_us > limit)
+        limit = merge->latest_us - merge->window_us;
+
+    while (merge->heap_len) {
+        merge_source_t const *src = &merge->sources[merge->heap[0]];
+        if (src->ring[src->head].time_us > limit && merge->held <= EVENT_MERGE_MAX_HELD)
+            break;
+        output_top(merge);
+    }
+}
+
+static merge_source_t *find_source(event_merge_t *merge, uint64_t id)
+{
+    for (unsigned i = 0; i < merge->num_sources; ++i) {
+        if (merge->sources[i].id == id)
+            return &merge->sources[i];
+    }
+
+    merge_source_t *sources = realloc(merge->sources, (merge->num_sources + 1) * sizeof(*sources));
+    if (!sources) {
+        WARN_REALLOC("event_merge_hold()");
+        return NULL;
+    }
+    merge->sources = sources;
+    unsigned *heap = realloc(merge->heap, (merge->num_sources + 1) * sizeof(*heap));
+    if (!heap) {
+        WARN_REALLOC("event_merge_hold()");
+        return NULL;
+    }
+    merge->heap = heap;
+
+    merge_source_t *src = &merge->sources[merge->num_sources++];
+    *src                = (merge_source_t){.id = id, .heap_pos = NOT_IN_HEAP};
+    return src;
+}
+
+static int push_event(event_merge_t *merge, merge_source_t *src, struct data *data, int64_t time_us)
+{
+    if (src->count == src->size) {
+        unsigned size       = src->size ? src->size * 2 : 16;
+        merge_event_t *ring = malloc(size * sizeof(*ring));
+        if (!ring) {
+            WARN_MALLOC("event_merge_hold()");
+            return -1;
+        }
+        for (unsigned i = 0; i < src->count; ++i) {
+            ring[i] = src->ring[(src->head + i) & (src->size - 1)];
+        }
+        free(src->ring);
+        src->ring = ring;
+        src->size = size;
+        src->head = 0;
+    }
+    src->ring[(src->head + src->count) & (src->size - 1)] = (merge_event_t){.data = data, .time_us = time_us};
+    src->count += 1;
+    merge->held += 1;
+
+    if (src->heap_pos == NOT_IN_HEAP) {
+        unsigned index = (unsigned)(src - merge->sources);
+        heap_set(merge, merge->heap_len++, index);
+        sift_up(merge, merge->heap_len - 1);
+    }
+    return 0;
+}
+
+event_merge_t *event_merge_create(unsigned window_ms, event_merge_output_fn output_fn, void *ctx)
+{
+    event_merge_t *merge = calloc(1, sizeof(*merge));
+    if (!merge) {
+        WARN_CALLOC("event_merge_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    merge->window_us = (int64_t)window_ms * 1000;
+    merge->output_fn = output_fn;
+    merge->ctx       = ctx;
+    return merge;
+}
+
+void event_merge_free(event_merge_t *merge)
+{
+    if (!merge)
+        return;
+
+    // the input ended, all events are output in order
+    while (merge->heap_len) {
+        output_top(merge);
+    }
+    for (unsigned i = 0; i < merge->num_sources; ++i) {
+        free(merge->sources[i].ring);
+    }
+    free(merge->sources);
+    free(merge->heap);
+    free(merge);
+}
+
+struct data *event_merge_mark(struct data *data, void const *source, int64_t time_us)
+{
+    char mark[48];
+    snprintf(mark, sizeof(mark), "%" PRIx64 " %" PRId64, (uint64_t)(uintptr_t)source, time_us);
+    return data_prepend(data, data_str(NULL, MERGE_KEY, "", NULL, mark));
+}
+
+int event_merge_hold(event_merge_t *merge, struct data *data)
+{
+    if (!data || strcmp(data->key, MERGE_KEY) != 0) {
+        return 0;
+    }
+    char *end;
+    uint64_t id        = strtoull(data->value.v_ptr, &end, 16);
+    int64_t time_us    = strtoll(end, NULL, 10);
+    struct data *event = data->next;
+    data->next         = NULL;
+    data_free(data);
+
+    merge_source_t *src = find_source(merge, id);
+    if (!src) {
+        if (event)
+            merge->output_fn(merge->ctx, event);
+        return 1;
+    }
+
+    // the events of a source are in order, each is also its progress
+    if (time_us > src->progress_us)
+        src->progress_us = time_us;
+    if (time_us > merge->latest_us)
+        merge->latest_us = time_us;
+
+    if (event && push_event(merge, src, event, time_us) < 0) {
+        merge->output_fn(merge->ctx, event);
+    }
+    release(merge);
+    return 1;
+}
+
+unsigned event_merge_late(event_merge_t const *merge)
+{
+    return merge->late;
+}
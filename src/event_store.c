@@ -0,0 +1,690 @@
+/** @file
+    Append-only store of events in memory-mapped segment files.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_store.h"
+
+#include "data.h"
+#include "list.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(ESP32)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Encoding */
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    p = put_u32(p, (uint32_t)v);
+    return put_u32(p, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u32(uint8_t const *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(uint8_t const *p)
+{
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+// FNV-1a, the id continues the hash of the model after a NUL
+static uint32_t hash_str(uint32_t hash, char const *str, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+#define HASH_INIT 2166136261u
+
+static uint32_t model_hash(char const *model)
+{
+    return hash_str(HASH_INIT, model, strlen(model) + 1);
+}
+
+static uint32_t key_hash(uint32_t model_hash, char const *id)
+{
+    return hash_str(model_hash, id, strlen(id));
+}
+
+/* Segments */
+
+/// A mark of the sparse time index.
+typedef struct {
+    int64_t time_us;
+    uint32_t pos;
+} store_mark_t;
+
+/// The records of a model, or of a model and id, in a segment.
+typedef struct {
+    uint32_t hash;
+    unsigned len;
+    unsigned size;
+    uint32_t *pos; ///< the offsets of the records, NULL for an empty slot
+} store_key_t;
+
+typedef struct {
+    unsigned seq;
+    int fd;          ///< open while the segment is written, -1 otherwise
+    uint8_t *map;
+    size_t map_size;
+    size_t used;     ///< bytes of the header and the records
+    unsigned count;  ///< records
+    int64_t min_us;  ///< the earliest store time of the records
+    int64_t max_us;  ///< the latest store time of the records
+    store_mark_t *marks;
+    unsigned marks_len;
+    unsigned marks_size;
+    store_key_t *keys; ///< open addressing by hash
+    unsigned keys_len;
+    unsigned keys_size;
+} store_segment_t;
+
+struct event_store {
+    char *dir;
+    size_t segment_size;
+    unsigned max_segments;
+    unsigned next_seq;
+    list_t segments;         ///< oldest first, the last one is written
+    store_segment_t *active; ///< NULL if a segment could not be started
+    int failed;              ///< a segment could not be started, logged once
+};
+
+static void segment_path(event_store_t const *store, unsigned seq, char *path, size_t size)
+{
+    snprintf(path, size, "%s/events-%08u.store", store->dir, seq);
+}
+
+// cut the unwritten rest of the segment being written
+static void segment_finish(store_segment_t *seg)
+{
+    if (ftruncate(seg->fd, (off_t)seg->used) != 0)
+        print_logf(LOG_WARNING, "Event store", "Failed to truncate segment %u: %s", seg->seq, strerror(errno));
+    close(seg->fd);
+    seg->fd = -1;
+}
+
+static void segment_free(void *p)
+{
+    store_segment_t *seg = p;
+    if (!seg)
+        return;
+    if (seg->fd >= 0) {
+        segment_finish(seg);
+    }
+    if (seg->map)
+        munmap(seg->map, seg->map_size);
+    for (unsigned i = 0; i < seg->keys_size; ++i) {
+        free(seg->keys[i].pos);
+    }
+    free(seg->keys);
+    free(seg->marks);
+    free(seg);
+}
+
+static store_key_t *segment_key(store_segment_t const *seg, uint32_t hash)
+{
+    if (!seg->keys_size)
+        return NULL;
+    unsigned mask = seg->keys_size - 1;
+    for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+        store_key_t *key = &seg->keys[i];
+        if (!key->pos || key->hash == hash)
+            return key;
+    }
+}
+
+static int segment_grow_keys(store_segment_t *seg)
+{
+    unsigned size     = seg->keys_size ? seg->keys_size * 2 : 64;
+    store_key_t *keys = calloc(size, sizeof(*keys));
+    if (!keys) {
+        WARN_CALLOC("event_store_append()");
+        return -1;
+    }
+    store_key_t *old  = seg->keys;
+    unsigned old_size = seg->keys_size;
+    seg->keys         = keys;
+    seg->keys_size    = size;
+    for (unsigned i = 0; i < old_size; ++i) {
+        if (old[i].pos)
+            *segment_key(seg, old[i].hash) = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+static int segment_add_key(store_segment_t *seg, uint32_t hash, uint32_t pos)
+{
+    if ((seg->keys_len + 1) * 4 > seg->keys_size * 3 && segment_grow_keys(seg) < 0)
+        return -1;
+    store_key_t *key = segment_key(seg, hash);
+    if (key->len == key->size) {
+        unsigned size = key->size ? key->size * 2 : 16;
+        uint32_t *tmp = realloc(key->pos, size * sizeof(*tmp));
+        if (!tmp) {
+            WARN_REALLOC("event_store_append()");
+            return -1;
+        }
+        if (!key->pos)
+            seg->keys_len += 1;
+        key->hash = hash;
+        key->pos  = tmp;
+        key->size = size;
+    }
+    key->pos[key->len++] = pos;
+    return 0;
+}
+
+// index the record at the used end of the segment
+static int segment_index(store_segment_t *seg)
+{
+    uint8_t const *record = &seg->map[seg->used];
+    uint32_t len          = get_u32(record);
+    uint32_t model        = get_u32(record + 4);
+    uint32_t key          = get_u32(record + 8);
+    int64_t time_us       = (int64_t)get_u64(record + 12);
+    uint32_t pos          = (uint32_t)seg->used;
+
+    if (seg->count % EVENT_STORE_INDEX_STRIDE == 0) {
+        if (seg->marks_len == seg->marks_size) {
+            unsigned size       = seg->marks_size ? seg->marks_size * 2 : 64;
+            store_mark_t *marks = realloc(seg->marks, size * sizeof(*marks));
+            if (!marks) {
+                WARN_REALLOC("event_store_append()");
+                return -1;
+            }
+            seg->marks      = marks;
+            seg->marks_size = size;
+        }
+        seg->marks[seg->marks_len++] = (store_mark_t){.time_us = time_us, .pos = pos};
+    }
+    if (segment_add_key(seg, model, pos) < 0
+            || (key != model && segment_add_key(seg, key, pos) < 0))
+        return -1;
+
+    if (!seg->count || time_us < seg->min_us)
+        seg->min_us = time_us;
+    if (!seg->count || time_us > seg->max_us)
+        seg->max_us = time_us;
+    seg->count += 1;
+    seg->used += EVENT_STORE_RECORD_SIZE + len;
+    return 0;
+}
+
+static store_segment_t *segment_new(unsigned seq)
+{
+    store_segment_t *seg = calloc(1, sizeof(*seg));
+    if (!seg) {
+        WARN_CALLOC("event_store_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    seg->seq = seq;
+    seg->fd  = -1;
+    return seg;
+}
+
+// map and index a segment of an earlier run, a torn last record ends the segment
+static store_segment_t *segment_load(event_store_t const *store, unsigned seq)
+{
+    char path[1024];
+    segment_path(store, seq, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < EVENT_STORE_HEADER_SIZE || (uint64_t)st.st_size > UINT32_MAX) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    store_segment_t *seg = segment_new(seq);
+    if (!seg) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    seg->map      = map;
+    seg->map_size = (size_t)st.st_size;
+    if (memcmp(seg->map, "RES", 3) != 0 || seg->map[3] != EVENT_STORE_VERSION
+            || get_u32(&seg->map[4]) != EVENT_STORE_HEADER_SIZE) {
+        print_logf(LOG_WARNING, "Event store", "Skipping \"%s\", not an event store segment", path);
+        segment_free(seg);
+        return NULL;
+    }
+    seg->used = EVENT_STORE_HEADER_SIZE;
+    while (seg->map_size - seg->used >= EVENT_STORE_RECORD_SIZE) {
+        uint32_t len = get_u32(&seg->map[seg->used]);
+        if (!len || seg->map_size - seg->used - EVENT_STORE_RECORD_SIZE < len)
+            break;
+        if (segment_index(seg) < 0) {
+            segment_free(seg);
+            return NULL;
+        }
+    }
+    return seg;
+}
+
+// size, map, and start a segment to write
+static store_segment_t *segment_create(event_store_t const *store, unsigned seq, int64_t time_us)
+{
+    char path[1024];
+    segment_path(store, seq, path, sizeof(path));
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        print_logf(LOG_ERROR, "Event store", "Failed to create \"%s\": %s", path, strerror(errno));
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)store->segment_size) < 0) {
+        print_logf(LOG_ERROR, "Event store", "Failed to size \"%s\": %s", path, strerror(errno));
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+    void *map = mmap(NULL, store->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        print_logf(LOG_ERROR, "Event store", "Failed to map \"%s\": %s", path, strerror(errno));
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+
+    store_segment_t *seg = segment_new(seq);
+    if (!seg) {
+        munmap(map, store->segment_size);
+        close(fd);
+        return NULL;
+    }
+    seg->fd       = fd;
+    seg->map      = map;
+    seg->map_size = store->segment_size;
+    seg->used     = EVENT_STORE_HEADER_SIZE;
+    uint8_t *p    = seg->map;
+    *p++          = 'R';
+    *p++          = 'E';
+    *p++          = 'S';
+    *p++          = EVENT_STORE_VERSION;
+    p             = put_u32(p, EVENT_STORE_HEADER_SIZE);
+    put_u64(p, (uint64_t)time_us);
+    return seg;
+}
+
+// finish the segment being written and start the next one, the oldest segments over the count are deleted
+static void store_rotate(event_store_t *store, int64_t time_us)
+{
+    if (store->active) {
+        segment_finish(store->active);
+        store->active = NULL;
+    }
+    while (store->segments.len && store->segments.len >= store->max_segments) {
+        store_segment_t *oldest = store->segments.elems[0];
+        char path[1024];
+        segment_path(store, oldest->seq, path, sizeof(path));
+        unlink(path);
+        list_remove(&store->segments, 0, segment_free);
+    }
+
+    store_segment_t *seg = segment_create(store, store->next_seq, time_us);
+    if (!seg) {
+        if (!store->failed)
+            print_log(LOG_ERROR, "Event store", "Events are not stored until a segment can be started");
+        store->failed = 1;
+        return;
+    }
+    store->failed = 0;
+    store->next_seq += 1;
+    store->active = seg;
+    list_push(&store->segments, seg);
+}
+
+static int compare_seq(void const *a, void const *b)
+{
+    unsigned x = *(unsigned const *)a;
+    unsigned y = *(unsigned const *)b;
+    return x < y ? -1 : x > y;
+}
+
+event_store_t *event_store_open(char const *dir, size_t segment_size, unsigned segments)
+{
+    if (!segment_size)
+        segment_size = EVENT_STORE_SEGMENT_SIZE;
+    if (!segments)
+        segments = EVENT_STORE_SEGMENTS;
+    if (segment_size < 4096 || (uint64_t)segment_size > UINT32_MAX) {
+        print_log(LOG_ERROR, "Event store", "The segment size needs to be at least 4k and less than 4G");
+        return NULL;
+    }
+
+    event_store_t *store = calloc(1, sizeof(*store));
+    if (!store) {
+        WARN_CALLOC("event_store_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    store->dir = strdup(dir);
+    if (!store->dir) {
+        WARN_STRDUP("event_store_open()");
+        free(store);
+        return NULL;
+    }
+    store->segment_size = segment_size;
+    store->max_segments = segments;
+    store->next_seq     = 1;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        print_logf(LOG_ERROR, "Event store", "Failed to create the directory \"%s\": %s", dir, strerror(errno));
+        event_store_close(store);
+        return NULL;
+    }
+    DIR *d = opendir(dir);
+    if (!d) {
+        print_logf(LOG_ERROR, "Event store", "Failed to open the directory \"%s\": %s", dir, strerror(errno));
+        event_store_close(store);
+        return NULL;
+    }
+    unsigned *seqs   = NULL;
+    size_t seqs_len  = 0;
+    size_t seqs_size = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        unsigned seq;
+        char tail[8];
+        if (sscanf(entry->d_name, "events-%u.%7s", &seq, tail) != 2 || strcmp(tail, "store") != 0)
+            continue;
+        if (seqs_len == seqs_size) {
+            seqs_size     = seqs_size ? seqs_size * 2 : 64;
+            unsigned *tmp = realloc(seqs, seqs_size * sizeof(*tmp));
+            if (!tmp) {
+                WARN_REALLOC("event_store_open()");
+                break;
+            }
+            seqs = tmp;
+        }
+        seqs[seqs_len++] = seq;
+    }
+    closedir(d);
+    if (seqs_len)
+        qsort(seqs, seqs_len, sizeof(*seqs), compare_seq);
+
+    // the new segment is one of the kept ones
+    for (size_t i = 0; i < seqs_len; ++i) {
+        store->next_seq = seqs[i] + 1;
+        if (seqs_len - i >= store->max_segments) {
+            char path[1024];
+            segment_path(store, seqs[i], path, sizeof(path));
+            unlink(path);
+            continue;
+        }
+        store_segment_t *seg = segment_load(store, seqs[i]);
+        if (seg)
+            list_push(&store->segments, seg);
+    }
+    free(seqs);
+
+    struct timeval now;
+    get_time_now(&now);
+    store_rotate(store, (int64_t)now.tv_sec * 1000000 + now.tv_usec);
+    if (!store->active) {
+        event_store_close(store);
+        return NULL;
+    }
+    print_logf(LOG_NOTICE, "Event store", "Storing events in \"%s\", %u events in %u earlier segments",
+            dir, event_store_count(store), (unsigned)store->segments.len - 1);
+    return store;
+}
+
+void event_store_close(event_store_t *store)
+{
+    if (!store)
+        return;
+
+    list_free_elems(&store->segments, segment_free);
+    free(store->dir);
+    free(store);
+}
+
+int event_store_append(event_store_t *store, data_t *data, char const *text, size_t len, int64_t time_us)
+{
+    char const *model = NULL;
+    char id[32]       = {0};
+    for (data_t *d = data; d; d = d->next) {
+        if (!model && d->type == DATA_STRING && !strcmp(d->key, "model"))
+            model = d->value.v_ptr;
+        else if (!*id && d->type == DATA_INT && !strcmp(d->key, "id"))
+            snprintf(id, sizeof(id), "%d", d->value.v_int);
+        else if (!*id && d->type == DATA_STRING && !strcmp(d->key, "id"))
+            snprintf(id, sizeof(id), "%s", (char const *)d->value.v_ptr);
+    }
+    if (!model || !len)
+        return -1;
+
+    size_t size = EVENT_STORE_RECORD_SIZE + len;
+    if (size > store->segment_size - EVENT_STORE_HEADER_SIZE)
+        return -1; // larger than a segment
+    if (!store->active || store->active->map_size - store->active->used < size) {
+        store_rotate(store, time_us);
+        if (!store->active)
+            return -1;
+    }
+
+    store_segment_t *seg = store->active;
+    uint32_t mhash       = model_hash(model);
+    uint8_t *record      = &seg->map[seg->used];
+    put_u32(record + 4, mhash);
+    put_u32(record + 8, *id ? key_hash(mhash, id) : mhash);
+    put_u64(record + 12, (uint64_t)time_us);
+    memcpy(record + EVENT_STORE_RECORD_SIZE, text, len);
+    // the length comes last, a torn record reads as the end
+    put_u32(record, (uint32_t)len);
+
+    if (segment_index(seg) < 0) {
+        put_u32(record, 0);
+        return -1;
+    }
+    return 0;
+}
+
+// the text has the key with the value, quoted or not, as printed by data_print_jsons()
+static int has_field(char const *text, size_t len, char const *key, char const *value)
+{
+    char needle[256];
+    int n = snprintf(needle, sizeof(needle), "\"%s\":", key);
+    size_t vlen = strlen(value);
+    if (n <= 0 || (size_t)n >= sizeof(needle))
+        return 0;
+    for (size_t i = 0; i + n + vlen <= len; ++i) {
+        if (text[i] != '"' || memcmp(&text[i], needle, n) != 0)
+            continue;
+        char const *v = &text[i + n];
+        size_t left   = len - i - n;
+        if (left > vlen + 1 && v[0] == '"' && memcmp(v + 1, value, vlen) == 0 && v[vlen + 1] == '"')
+            return 1;
+        if (left > vlen && memcmp(v, value, vlen) == 0 && (v[vlen] == ',' || v[vlen] == '}' || v[vlen] == ' '))
+            return 1;
+    }
+    return 0;
+}
+
+typedef struct {
+    event_query_t const *query;
+    event_store_fn fn;
+    void *ctx;
+    unsigned count;
+    int64_t next_us;
+} store_scan_t;
+
+// emit the record if it matches, returns 0 to go on, 1 past the time range or the limit
+static int scan_record(store_scan_t *scan, uint8_t const *record)
+{
+    event_query_t const *query = scan->query;
+    int64_t time_us            = (int64_t)get_u64(record + 12);
+    if (time_us < query->from_us)
+        return 0;
+    if (time_us > query->to_us)
+        return 1;
+    size_t len       = get_u32(record);
+    char const *text = (char const *)record + EVENT_STORE_RECORD_SIZE;
+    if (query->model && !has_field(text, len, "model", query->model))
+        return 0; // another model with the same hash
+    if (query->model && query->id && !has_field(text, len, "id", query->id))
+        return 0;
+    if (query->limit && scan->count == query->limit) {
+        scan->next_us = time_us;
+        return 1;
+    }
+    scan->fn(scan->ctx, time_us, text, len);
+    scan->count += 1;
+    return 0;
+}
+
+// the first record at or after the time by the marks, then by the records
+static uint32_t segment_seek(store_segment_t const *seg, int64_t time_us)
+{
+    unsigned lo = 0;
+    unsigned hi = seg->marks_len;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (seg->marks[mid].time_us < time_us)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo ? seg->marks[lo - 1].pos : EVENT_STORE_HEADER_SIZE;
+}
+
+// the first position of the key at or after the time
+static unsigned key_seek(store_segment_t const *seg, store_key_t const *key, int64_t time_us)
+{
+    unsigned lo = 0;
+    unsigned hi = key->len;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if ((int64_t)get_u64(&seg->map[key->pos[mid] + 12]) < time_us)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+unsigned event_store_query(event_store_t const *store, event_query_t const *query, event_store_fn fn, void *ctx, int64_t *next_us)
+{
+    store_scan_t scan = {.query = query, .fn = fn, .ctx = ctx};
+    uint32_t hash     = 0;
+    if (query->model)
+        hash = query->id ? key_hash(model_hash(query->model), query->id) : model_hash(query->model);
+
+    int done = 0;
+    for (size_t i = 0; !done && i < store->segments.len; ++i) {
+        store_segment_t const *seg = store->segments.elems[i];
+        if (!seg->count || seg->max_us < query->from_us || seg->min_us > query->to_us)
+            continue;
+        if (query->model) {
+            store_key_t const *key = segment_key(seg, hash);
+            if (!key || !key->pos)
+                continue;
+            for (unsigned k = key_seek(seg, key, query->from_us); !done && k < key->len; ++k) {
+                done = scan_record(&scan, &seg->map[key->pos[k]]);
+            }
+        }
+        else {
+            for (size_t pos = segment_seek(seg, query->from_us); !done && pos < seg->used;) {
+                uint8_t const *record = &seg->map[pos];
+                done = scan_record(&scan, record);
+                pos += EVENT_STORE_RECORD_SIZE + get_u32(record);
+            }
+        }
+    }
+    if (next_us)
+        *next_us = scan.next_us;
+    return scan.count;
+}
+
+unsigned event_store_count(event_store_t const *store)
+{
+    unsigned count = 0;
+    for (size_t i = 0; i < store->segments.len; ++i) {
+        store_segment_t const *seg = store->segments.elems[i];
+        count += seg->count;
+    }
+    return count;
+}
+
+#else
+
+event_store_t *event_store_open(char const *dir, size_t segment_size, unsigned segments)
+{
+    (void)dir;
+    (void)segment_size;
+    (void)segments;
+    print_log(LOG_ERROR, "Event store", "The event store is not available in this build!");
+    return NULL;
+}
+
+void event_store_close(event_store_t *store)
+{
+    (void)store;
+}
+
+int event_store_append(event_store_t *store, data_t *data, char const *text, size_t len, int64_t time_us)
+{
+    (void)store;
+    (void)data;
+    (void)text;
+    (void)len;
+    (void)time_us;
+    return -1;
+}
+
+unsigned event_store_query(event_store_t const *store, event_query_t const *query, event_store_fn fn, void *ctx, int64_t *next_us)
+{
+    (void)store;
+    (void)query;
+    (void)fn;
+    (void)ctx;
+    if (next_us)
+        *next_us = 0;
+    return 0;
+}
+
+unsigned event_store_count(event_store_t const *store)
+{
+    (void)store;
+    return 0;
+}
+
+#endif
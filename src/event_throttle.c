@@ -0,0 +1,254 @@
+/** @file
+    Per sensor rate limit of the events, with the numeric values aggregated.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_throttle.h"
+
+#include "compat_atomic.h"
+#include "data.h"
+#include "fatal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Smallest size of the hash table, a power of two.
+#define THROTTLE_MIN_SLOTS 64
+/// A sensor not heard for this many intervals is forgotten when the table grows.
+#define THROTTLE_STALE_INTERVALS 2
+
+/// The aggregate of a numeric value of a sensor.
+typedef struct {
+    uint64_t hash; ///< the key of the value
+    double min;
+    double max;
+    double sum;
+    unsigned count;
+} throttle_value_t;
+
+typedef struct {
+    uint64_t hash;  ///< the sensor, 0 if unused
+    uint64_t start; ///< start of the interval
+    uint64_t last;  ///< time of the last event
+    unsigned num_values;
+    unsigned values_size;
+    throttle_value_t *values;
+} throttle_sensor_t;
+
+struct event_throttle {
+    unsigned lock;
+    uint64_t interval;
+    throttle_mode_t mode;
+    unsigned size; ///< slots, a power of two
+    unsigned used;
+    throttle_sensor_t *slots;
+    unsigned dropped;
+};
+
+static uint64_t str_hash(char const *str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (; *str; ++str) {
+        hash = (hash ^ (unsigned char)*str) * 0x100000001b3ULL;
+    }
+    return hash ? hash : 1;
+}
+
+// the slot of a sensor, or the unused slot to add it in
+static throttle_sensor_t *find_slot(throttle_sensor_t *slots, unsigned size, uint64_t hash)
+{
+    unsigned i = (unsigned)hash & (size - 1);
+    while (slots[i].hash && slots[i].hash != hash) {
+        i = (i + 1) & (size - 1); // linear probing
+    }
+    return &slots[i];
+}
+
+// rehash into a table for twice the sensors heard recently, the stale ones are dropped
+static int rehash(event_throttle_t *throttle, uint64_t time_ms)
+{
+    uint64_t stale = throttle->interval * THROTTLE_STALE_INTERVALS;
+    unsigned live  = 0;
+    for (unsigned i = 0; i < throttle->size; ++i) {
+        throttle_sensor_t *sensor = &throttle->slots[i];
+        live += sensor->hash && sensor->last + stale >= time_ms;
+    }
+    unsigned size = THROTTLE_MIN_SLOTS;
+    while (size < (live + 1) * 2) {
+        size *= 2;
+    }
+    throttle_sensor_t *slots = calloc(size, sizeof(*slots));
+    if (!slots) {
+        WARN_CALLOC("event_throttle_pass()");
+        return -1;
+    }
+    unsigned used = 0;
+    for (unsigned i = 0; i < throttle->size; ++i) {
+        throttle_sensor_t *sensor = &throttle->slots[i];
+        if (!sensor->hash)
+            continue;
+        if (sensor->last + stale < time_ms) {
+            free(sensor->values);
+            continue;
+        }
+        *find_slot(slots, size, sensor->hash) = *sensor;
+        used++;
+    }
+    free(throttle->slots);
+    throttle->slots = slots;
+    throttle->size  = size;
+    throttle->used  = used;
+    return 0;
+}
+
+// the id and channel name the sensor, only the readings are aggregated
+static int is_reading(data_t const *d)
+{
+    return (d->type == DATA_INT || d->type == DATA_DOUBLE) && strcmp(d->key, "id") && strcmp(d->key, "channel");
+}
+
+static void accumulate(throttle_sensor_t *sensor, data_t const *data)
+{
+    for (data_t const *d = data; d; d = d->next) {
+        if (!is_reading(d))
+            continue;
+        double v      = d->type == DATA_INT ? d->value.v_int : d->value.v_dbl;
+        uint64_t hash = str_hash(d->key);
+        unsigned k    = 0;
+        while (k < sensor->num_values && sensor->values[k].hash != hash) {
+            k++;
+        }
+        if (k == sensor->num_values) {
+            if (k == sensor->values_size) {
+                unsigned values_size     = sensor->values_size ? sensor->values_size * 2 : 8;
+                throttle_value_t *values = realloc(sensor->values, values_size * sizeof(*values));
+                if (!values) {
+                    WARN_REALLOC("event_throttle_pass()");
+                    return; // the values so far are still aggregated
+                }
+                sensor->values      = values;
+                sensor->values_size = values_size;
+            }
+            sensor->values[k] = (throttle_value_t){.hash = hash, .min = v, .max = v};
+            sensor->num_values++;
+        }
+        throttle_value_t *value = &sensor->values[k];
+        value->min = v < value->min ? v : value->min;
+        value->max = v > value->max ? v : value->max;
+        value->sum += v;
+        value->count++;
+    }
+}
+
+static void replace_values(throttle_sensor_t const *sensor, throttle_mode_t mode, data_t *data)
+{
+    for (data_t *d = data; d; d = d->next) {
+        if (!is_reading(d))
+            continue;
+        uint64_t hash = str_hash(d->key);
+        for (unsigned k = 0; k < sensor->num_values; ++k) {
+            throttle_value_t const *value = &sensor->values[k];
+            if (value->hash != hash)
+                continue;
+            double v = mode == THROTTLE_MIN ? value->min : mode == THROTTLE_MAX ? value->max : value->sum / value->count;
+            if (d->type == DATA_INT)
+                d->value.v_int = (int)lrint(v);
+            else
+                d->value.v_dbl = v;
+            break;
+        }
+    }
+}
+
+event_throttle_t *event_throttle_create(uint64_t interval_ms, throttle_mode_t mode)
+{
+    if (!interval_ms)
+        return NULL;
+
+    event_throttle_t *throttle = calloc(1, sizeof(*throttle));
+    if (!throttle) {
+        WARN_CALLOC("event_throttle_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    throttle->slots = calloc(THROTTLE_MIN_SLOTS, sizeof(*throttle->slots));
+    if (!throttle->slots) {
+        WARN_CALLOC("event_throttle_create()");
+        free(throttle);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    throttle->size     = THROTTLE_MIN_SLOTS;
+    throttle->interval = interval_ms;
+    throttle->mode     = mode;
+    return throttle;
+}
+
+void event_throttle_free(event_throttle_t *throttle)
+{
+    if (!throttle)
+        return;
+    for (unsigned i = 0; i < throttle->size; ++i) {
+        free(throttle->slots[i].values);
+    }
+    free(throttle->slots);
+    free(throttle);
+}
+
+int event_throttle_pass(event_throttle_t *throttle, char const *key, data_t *data, uint64_t time_ms)
+{
+    uint64_t hash = str_hash(key);
+
+    atomic_spin_lock(&throttle->lock);
+    throttle_sensor_t *sensor = find_slot(throttle->slots, throttle->size, hash);
+    if (!sensor->hash) {
+        // keep the table at most half full
+        if ((throttle->used + 1) * 2 > throttle->size) {
+            if (rehash(throttle, time_ms) < 0) {
+                atomic_spin_unlock(&throttle->lock);
+                return 1; // output all events of a new sensor
+            }
+            sensor = find_slot(throttle->slots, throttle->size, hash);
+        }
+        *sensor = (throttle_sensor_t){.hash = hash, .start = time_ms, .last = time_ms};
+        throttle->used++;
+        atomic_spin_unlock(&throttle->lock);
+        return 1;
+    }
+
+    if (throttle->mode != THROTTLE_LATEST)
+        accumulate(sensor, data);
+    sensor->last = time_ms > sensor->last ? time_ms : sensor->last;
+    // the input of a channel may be a frame behind, the event is then within the interval
+    if (time_ms < sensor->start + throttle->interval) {
+        throttle->dropped++;
+        atomic_spin_unlock(&throttle->lock);
+        return 0;
+    }
+    replace_values(sensor, throttle->mode, data);
+    sensor->num_values = 0;
+    sensor->start      = time_ms;
+    atomic_spin_unlock(&throttle->lock);
+    return 1;
+}
+
+unsigned event_throttle_dropped(event_throttle_t *throttle)
+{
+    atomic_spin_lock(&throttle->lock);
+    unsigned dropped = throttle->dropped;
+    atomic_spin_unlock(&throttle->lock);
+    return dropped;
+}
+
+unsigned event_throttle_sensors(event_throttle_t *throttle)
+{
+    atomic_spin_lock(&throttle->lock);
+    unsigned used = throttle->used;
+    atomic_spin_unlock(&throttle->lock);
+    return used;
+}
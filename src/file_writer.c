@@ -0,0 +1,210 @@
+/** @file
+    Sample file writer, writes the buffers of a dumper on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "file_writer.h"
+
+#include "file_zstd.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct writer_buf {
+    uint8_t *data;
+    size_t size; ///< allocated bytes, grown as needed and kept for reuse
+    size_t len;  ///< bytes of samples
+} writer_buf_t;
+
+struct file_writer {
+    FILE *file;
+    zstd_encoder_t *zstd; ///< compresses the samples, NULL to write them as is
+    size_t max_queued;    ///< bytes queued before the caller waits
+
+    writer_buf_t bufs[FILE_WRITER_BUFFERS];
+    unsigned head;     ///< next buffer to write
+    unsigned count;    ///< queued buffers, the buffer after them is being filled
+    unsigned fill;     ///< the buffer being filled, never touched by the thread
+    size_t queued;     ///< bytes in the queued buffers
+    int error;         ///< the compression or the file failed
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the ring, never held while writing
+    pthread_cond_t cond;  ///< signals a queued buffer or room in the ring
+    int running;          ///< the thread was started
+    int exit_thread;      ///< request the thread to exit once the ring is empty
+#endif
+};
+
+// write one buffer to the file, returns -1 on errors
+static int writer_write_buf(file_writer_t *writer, writer_buf_t const *buf)
+{
+    if (writer->zstd) {
+        return zstd_encoder_write(writer->zstd, writer->file, buf->data, buf->len, 0);
+    }
+    if (fwrite(buf->data, 1, buf->len, writer->file) != buf->len) {
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL writer_run(void *arg)
+{
+    file_writer_t *writer = arg;
+
+    pthread_mutex_lock(&writer->lock);
+    while (!writer->exit_thread || writer->count > 0) {
+        if (writer->count == 0) {
+            pthread_cond_wait(&writer->cond, &writer->lock);
+            continue;
+        }
+        writer_buf_t const *buf = &writer->bufs[writer->head];
+        pthread_mutex_unlock(&writer->lock);
+
+        int ret = writer_write_buf(writer, buf);
+
+        pthread_mutex_lock(&writer->lock);
+        writer->queued -= buf->len;
+        writer->head = (writer->head + 1) % FILE_WRITER_BUFFERS;
+        writer->count -= 1;
+        if (ret < 0) {
+            writer->error = 1;
+        }
+        pthread_cond_broadcast(&writer->cond);
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    return (THREAD_RETURN)(intptr_t)0;
+}
+#endif
+
+file_writer_t *file_writer_open(FILE *file, int zstd, unsigned buffer_mb)
+{
+    file_writer_t *writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        WARN_CALLOC("file_writer_open()");
+        return NULL;
+    }
+    writer->file       = file;
+    writer->max_queued = (size_t)buffer_mb * 1024 * 1024;
+#ifdef THREADS
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+#endif
+
+    if (zstd) {
+        writer->zstd = zstd_encoder_create();
+        if (!writer->zstd) {
+            writer->error = 1; // nothing to flush on close
+            file_writer_close(writer);
+            return NULL;
+        }
+    }
+
+#ifdef THREADS
+    if (pthread_create(&writer->thread, NULL, writer_run, writer)) {
+        print_log(LOG_ERROR, "Dumper", "Unable to create the writer thread.");
+        writer->error = 1;
+        file_writer_close(writer);
+        return NULL;
+    }
+    writer->running = 1;
+#endif
+
+    return writer;
+}
+
+void *file_writer_reserve(file_writer_t *writer, size_t len)
+{
+#ifdef THREADS
+    // wait for a free buffer and room in the queue, a single large buffer is always accepted
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count == FILE_WRITER_BUFFERS
+            || (writer->count > 0 && writer->queued + len > writer->max_queued)) {
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+    writer->fill = (writer->head + writer->count) % FILE_WRITER_BUFFERS;
+    pthread_mutex_unlock(&writer->lock);
+#endif
+
+    writer_buf_t *buf = &writer->bufs[writer->fill];
+    if (buf->size < len) {
+        uint8_t *data = realloc(buf->data, len);
+        if (!data) {
+            WARN_REALLOC("file_writer_reserve()");
+            return NULL;
+        }
+        buf->data = data;
+        buf->size = len;
+    }
+    return buf->data;
+}
+
+int file_writer_commit(file_writer_t *writer, size_t len)
+{
+    writer_buf_t *buf = &writer->bufs[writer->fill];
+    buf->len          = len;
+
+#ifdef THREADS
+    pthread_mutex_lock(&writer->lock);
+    writer->queued += len;
+    writer->count += 1;
+    int error = writer->error;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+#else
+    if (writer_write_buf(writer, buf) < 0) {
+        writer->error = 1;
+    }
+    int error = writer->error;
+#endif
+
+    return error ? -1 : 0;
+}
+
+int file_writer_close(file_writer_t *writer)
+{
+    if (!writer)
+        return 0;
+
+#ifdef THREADS
+    // the thread writes the queued buffers before it exits
+    if (writer->running) {
+        pthread_mutex_lock(&writer->lock);
+        writer->exit_thread = 1;
+        pthread_cond_broadcast(&writer->cond);
+        pthread_mutex_unlock(&writer->lock);
+        pthread_join(writer->thread, NULL);
+    }
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->cond);
+#endif
+
+    if (writer->zstd && !writer->error) {
+        if (zstd_encoder_write(writer->zstd, writer->file, NULL, 0, 1) < 0) {
+            writer->error = 1;
+        }
+    }
+    if (!writer->error && fflush(writer->file)) {
+        writer->error = 1;
+    }
+    int ret = writer->error ? -1 : 0;
+
+    for (unsigned i = 0; i < FILE_WRITER_BUFFERS; ++i) {
+        free(writer->bufs[i].data);
+    }
+    zstd_encoder_free(writer->zstd);
+    free(writer);
+    return ret;
+}
@@ -0,0 +1,333 @@
+/** @file
+    Streaming zstd compressed sample files, with the decompression on a thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "file_zstd.h"
+
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ZSTD
+
+#include <zstd.h>
+
+/*
+    The reader thread fills a ring of blocks from the head and the caller drains them.
+*/
+
+struct zstd_reader {
+    FILE *file;
+    ZSTD_DCtx *dctx;
+    uint8_t *in_buf;
+    ZSTD_inBuffer in;
+    size_t frame_left; ///< the last result of the decompression, 0 at the end of a frame
+    int flush;         ///< the output was filled, the decoder might hold more output
+
+    uint8_t *blocks[ZSTD_FILE_BLOCKS];
+    size_t lens[ZSTD_FILE_BLOCKS];
+    unsigned head;  ///< next block to read
+    unsigned count; ///< decompressed blocks
+    size_t pos;     ///< read position in the head block
+    int eof;        ///< no more blocks follow
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the ring, never held while decompressing
+    pthread_cond_t cond;  ///< signals a block or room for a block
+    int running;          ///< the thread was started
+    int exit_thread;
+#endif
+};
+
+// decompress into a block, returns the length, sets eof at the end of the file or on errors
+static size_t reader_fill(zstd_reader_t *reader, uint8_t *dst, int *eof)
+{
+    ZSTD_outBuffer out = {dst, ZSTD_FILE_BLOCK_SIZE, 0};
+    while (out.pos < out.size) {
+        if (reader->in.pos == reader->in.size && !reader->flush) {
+            reader->in.size = fread(reader->in_buf, 1, ZSTD_DStreamInSize(), reader->file);
+            reader->in.pos  = 0;
+            if (reader->in.size == 0) {
+                if (reader->frame_left) {
+                    print_log(LOG_WARNING, "Input", "Compressed file is truncated.");
+                }
+                *eof = 1;
+                break;
+            }
+        }
+        size_t ret = ZSTD_decompressStream(reader->dctx, &out, &reader->in);
+        if (ZSTD_isError(ret)) {
+            print_logf(LOG_ERROR, "Input", "Decompressing failed: %s", ZSTD_getErrorName(ret));
+            *eof = 1;
+            break;
+        }
+        reader->frame_left = ret;
+        reader->flush      = out.pos == out.size;
+    }
+    return out.pos;
+}
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL reader_run(void *arg)
+{
+    zstd_reader_t *reader = arg;
+
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->exit_thread && !reader->eof) {
+        if (reader->count == ZSTD_FILE_BLOCKS) {
+            pthread_cond_wait(&reader->cond, &reader->lock);
+            continue;
+        }
+        unsigned slot = (reader->head + reader->count) % ZSTD_FILE_BLOCKS;
+        pthread_mutex_unlock(&reader->lock);
+
+        int eof    = 0;
+        size_t len = reader_fill(reader, reader->blocks[slot], &eof);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->lens[slot] = len;
+        if (len) {
+            reader->count += 1;
+        }
+        reader->eof = eof;
+        pthread_cond_broadcast(&reader->cond);
+    }
+    pthread_mutex_unlock(&reader->lock);
+
+    return (THREAD_RETURN)(intptr_t)0;
+}
+#endif
+
+zstd_reader_t *zstd_reader_open(FILE *file)
+{
+    zstd_reader_t *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        WARN_CALLOC("zstd_reader_open()");
+        return NULL;
+    }
+    reader->file = file;
+#ifdef THREADS
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->cond, NULL);
+#endif
+
+    reader->in_buf = malloc(ZSTD_DStreamInSize());
+    if (!reader->in_buf) {
+        WARN_MALLOC("zstd_reader_open()");
+        zstd_reader_close(reader);
+        return NULL;
+    }
+    reader->in.src = reader->in_buf;
+    for (unsigned i = 0; i < ZSTD_FILE_BLOCKS; ++i) {
+        reader->blocks[i] = malloc(ZSTD_FILE_BLOCK_SIZE);
+        if (!reader->blocks[i]) {
+            WARN_MALLOC("zstd_reader_open()");
+            zstd_reader_close(reader);
+            return NULL;
+        }
+    }
+    reader->dctx = ZSTD_createDCtx();
+    if (!reader->dctx) {
+        print_log(LOG_ERROR, "Input", "Unable to create the zstd decompression context.");
+        zstd_reader_close(reader);
+        return NULL;
+    }
+
+#ifdef THREADS
+    if (pthread_create(&reader->thread, NULL, reader_run, reader)) {
+        print_log(LOG_ERROR, "Input", "Unable to create the decompression thread.");
+        zstd_reader_close(reader);
+        return NULL;
+    }
+    reader->running = 1;
+#endif
+
+    return reader;
+}
+
+size_t zstd_reader_read(zstd_reader_t *reader, void *dst, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+#ifdef THREADS
+        pthread_mutex_lock(&reader->lock);
+        while (reader->count == 0 && !reader->eof) {
+            pthread_cond_wait(&reader->cond, &reader->lock);
+        }
+        unsigned count = reader->count;
+        pthread_mutex_unlock(&reader->lock);
+#else
+        if (reader->count == 0 && !reader->eof) {
+            reader->lens[reader->head] = reader_fill(reader, reader->blocks[reader->head], &reader->eof);
+            reader->count              = reader->lens[reader->head] ? 1 : 0;
+        }
+        unsigned count = reader->count;
+#endif
+        if (count == 0) {
+            break; // end of the file
+        }
+
+        size_t block_len = reader->lens[reader->head];
+        size_t n         = block_len - reader->pos < len - done ? block_len - reader->pos : len - done;
+        memcpy((uint8_t *)dst + done, reader->blocks[reader->head] + reader->pos, n);
+        reader->pos += n;
+        done += n;
+
+        if (reader->pos == block_len) {
+#ifdef THREADS
+            pthread_mutex_lock(&reader->lock);
+#endif
+            reader->head = (reader->head + 1) % ZSTD_FILE_BLOCKS;
+            reader->count -= 1;
+            reader->pos = 0;
+#ifdef THREADS
+            pthread_cond_broadcast(&reader->cond);
+            pthread_mutex_unlock(&reader->lock);
+#endif
+        }
+    }
+    return done;
+}
+
+void zstd_reader_close(zstd_reader_t *reader)
+{
+    if (!reader)
+        return;
+
+#ifdef THREADS
+    if (reader->running) {
+        pthread_mutex_lock(&reader->lock);
+        reader->exit_thread = 1;
+        pthread_cond_broadcast(&reader->cond);
+        pthread_mutex_unlock(&reader->lock);
+        pthread_join(reader->thread, NULL);
+    }
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->cond);
+#endif
+
+    for (unsigned i = 0; i < ZSTD_FILE_BLOCKS; ++i) {
+        free(reader->blocks[i]);
+    }
+    free(reader->in_buf);
+    ZSTD_freeDCtx(reader->dctx);
+    free(reader);
+}
+
+struct zstd_encoder {
+    ZSTD_CCtx *cctx;
+    uint8_t *out_buf;
+    size_t out_size;
+};
+
+zstd_encoder_t *zstd_encoder_create(void)
+{
+    zstd_encoder_t *encoder = calloc(1, sizeof(*encoder));
+    if (!encoder) {
+        WARN_CALLOC("zstd_encoder_create()");
+        return NULL;
+    }
+    encoder->out_size = ZSTD_CStreamOutSize();
+    encoder->out_buf  = malloc(encoder->out_size);
+    if (!encoder->out_buf) {
+        WARN_MALLOC("zstd_encoder_create()");
+        zstd_encoder_free(encoder);
+        return NULL;
+    }
+    encoder->cctx = ZSTD_createCCtx();
+    if (!encoder->cctx) {
+        print_log(LOG_ERROR, "Dumper", "Unable to create the zstd compression context.");
+        zstd_encoder_free(encoder);
+        return NULL;
+    }
+    ZSTD_CCtx_setParameter(encoder->cctx, ZSTD_c_compressionLevel, ZSTD_FILE_LEVEL);
+    return encoder;
+}
+
+int zstd_encoder_write(zstd_encoder_t *encoder, FILE *file, void const *src, size_t len, int end)
+{
+    ZSTD_EndDirective mode = end ? ZSTD_e_end : ZSTD_e_continue;
+    ZSTD_inBuffer in       = {src, len, 0};
+    int finished;
+    do {
+        ZSTD_outBuffer out = {encoder->out_buf, encoder->out_size, 0};
+        size_t remaining   = ZSTD_compressStream2(encoder->cctx, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+            print_logf(LOG_ERROR, "Dumper", "Compressing failed: %s", ZSTD_getErrorName(remaining));
+            return -1;
+        }
+        if (fwrite(encoder->out_buf, 1, out.pos, file) != out.pos) {
+            print_log(LOG_ERROR, "Dumper", "Short write of compressed samples.");
+            return -1;
+        }
+        finished = end ? remaining == 0 : in.pos == in.size;
+    } while (!finished);
+    return 0;
+}
+
+void zstd_encoder_free(zstd_encoder_t *encoder)
+{
+    if (!encoder)
+        return;
+
+    ZSTD_freeCCtx(encoder->cctx);
+    free(encoder->out_buf);
+    free(encoder);
+}
+
+#else
+
+zstd_reader_t *zstd_reader_open(FILE *file)
+{
+    (void)file;
+    print_log(LOG_ERROR, "Input", "zstd support was not compiled in.");
+    return NULL;
+}
+
+size_t zstd_reader_read(zstd_reader_t *reader, void *dst, size_t len)
+{
+    (void)reader;
+    (void)dst;
+    (void)len;
+    return 0;
+}
+
+void zstd_reader_close(zstd_reader_t *reader)
+{
+    (void)reader;
+}
+
+zstd_encoder_t *zstd_encoder_create(void)
+{
+    print_log(LOG_ERROR, "Dumper", "zstd support was not compiled in.");
+    return NULL;
+}
+
+int zstd_encoder_write(zstd_encoder_t *encoder, FILE *file, void const *src, size_t len, int end)
+{
+    (void)encoder;
+    (void)file;
+    (void)src;
+    (void)len;
+    (void)end;
+    return -1;
+}
+
+void zstd_encoder_free(zstd_encoder_t *encoder)
+{
+    (void)encoder;
+}
+
+#endif /* ZSTD */
@@ -50,7 +50,8 @@ void file_info_check_read(file_info_t *info)
             && info->format != CS16_IQ
             && info->format != CF32_IQ
             && info->format != S16_AM
-            && info->format != PULSE_OOK) {
+            && info->format != PULSE_OOK
+            && info->format != PULSE_ARCHIVE) {
         fprintf(stderr, "File type not supported as input (%s).\n", info->spec);
         exit(1);
     }
@@ -69,7 +70,8 @@ void file_info_check_write(file_info_t *info)
             && info->format != F32_I
             && info->format != F32_Q
             && info->format != U8_LOGIC
-            && info->format != VCD_LOGIC) {
+            && info->format != VCD_LOGIC
+            && info->format != RLE_LOGIC) {
         fprintf(stderr, "File type not supported as output (%s).\n", info->spec);
         exit(1);
     }
@@ -90,6 +92,8 @@ char const *file_info_string(file_info_t *info)
     case VCD_LOGIC: return "VCD logic (text)";
     case U8_LOGIC:  return "U8 logic (1ch uint8)";
     case PULSE_OOK: return "OOK pulse data (text)";
+    case PULSE_ARCHIVE: return "Pulse data archive (binary)";
+    case RLE_LOGIC: return "Run-length logic (binary)";
     default:        return "Unknown";
     }
 }
@@ -120,6 +124,8 @@ static uint32_t file_type_guess_auto_format(uint32_t type)
     else if (type == F_U8) return U8_LOGIC;
     else if (type == F_VCD) return VCD_LOGIC;
     else if (type == F_OOK) return PULSE_OOK;
+    else if (type == F_PULSES) return PULSE_ARCHIVE;
+    else if (type == F_RLE) return RLE_LOGIC;
     else if (type == F_CS16) return CS16_IQ;
     else if (type == F_CF32) return CF32_IQ;
     else return type;
@@ -189,7 +195,7 @@ static void file_type(char const *filename, file_info_t *info)
             else if (len == 2 && !strncasecmp("u8", t, 2)) file_type_set_format(&info->format, F_U8);
             else if (len == 2 && !strncasecmp("s8", t, 2)) file_type_set_format(&info->format, F_S8);
             else if (len == 3 && !strncasecmp("cu8", t, 3)) file_type_set_format(&info->format, F_CU8);
-            else if (len == 4 && !strncasecmp("data", t, 4)) file_type_set_format(&info->format, F_CU8); // compat
+            else if (len == 4 && !strncasecmp("data", t, 4) && !info->sigmf) file_type_set_format(&info->format, F_CU8); // compat
             else if (len == 3 && !strncasecmp("cs8", t, 3)) file_type_set_format(&info->format, F_CS8);
             else if (len == 3 && !strncasecmp("u16", t, 3)) file_type_set_format(&info->format, F_U16);
             else if (len == 3 && !strncasecmp("s16", t, 3)) file_type_set_format(&info->format, F_S16);
@@ -198,11 +204,15 @@ static void file_type(char const *filename, file_info_t *info)
             else if (len == 3 && !strncasecmp("f32", t, 3)) file_type_set_format(&info->format, F_F32);
             else if (len == 3 && !strncasecmp("vcd", t, 3)) file_type_set_content(&info->format, F_VCD);
             else if (len == 3 && !strncasecmp("ook", t, 3)) file_type_set_content(&info->format, F_OOK);
+            else if (len == 3 && !strncasecmp("rpa", t, 3)) file_type_set_content(&info->format, F_PULSES);
+            else if (len == 3 && !strncasecmp("rle", t, 3)) file_type_set_content(&info->format, F_RLE);
             else if (len == 4 && !strncasecmp("cs16", t, 4)) file_type_set_format(&info->format, F_CS16);
             else if (len == 4 && !strncasecmp("cs32", t, 4)) file_type_set_format(&info->format, F_CS32);
             else if (len == 4 && !strncasecmp("cf32", t, 4)) file_type_set_format(&info->format, F_CF32);
             else if (len == 5 && !strncasecmp("cfile", t, 5)) file_type_set_format(&info->format, F_CF32); // compat
             else if (len == 5 && !strncasecmp("logic", t, 5)) file_type_set_content(&info->format, F_LOGIC);
+            else if (len == 5 && !strncasecmp("sigmf", t, 5)) info->sigmf = 1;
+            else if (len == 3 && !strncasecmp("zst", t, 3)) info->zstd = 1;
             else if (len == 3 && !strncasecmp("complex16u", t, 10)) file_type_set_format(&info->format, F_CU8); // compat
             else if (len == 3 && !strncasecmp("complex16s", t, 10)) file_type_set_format(&info->format, F_CS8); // compat
             else if (len == 4 && !strncasecmp("complex", t, 7)) file_type_set_format(&info->format, F_CF32); // compat
@@ -237,7 +247,10 @@ Parse "[A-Za-z][0-9A-Za-z]+" as format or content specifier:
 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 text formats: "vcd", "ook"
+pulse archive: "rpa"
+SigMF recording: "sigmf", e.g. path/filename.sigmf-data
 content types: "iq", "i", "q", "am", "fm", "logic"
+compression: "zst"
 
 Parses left to right, with the exception of a prefix up to the last colon ":"
 This prefix is the forced override, parsed last and removed from the filename.
@@ -351,6 +364,20 @@ int main(void)
     assert_file_type(S16_FM, ".s16_fm");
     assert_file_type(S16_FM, ".s16,fm");
 
+    assert_file_type(CU8_IQ, ".cu8.zst");
+    assert_file_type(CS16_IQ, ".cs16.zst");
+    assert_file_type(CF32_IQ, "cf32:zst:");
+
+    assert_file_type(PULSE_OOK, ".ook");
+    assert_file_type(PULSE_ARCHIVE, ".rpa");
+    assert_file_type(PULSE_ARCHIVE, "rpa:");
+    assert_file_type(RLE_LOGIC, ".rle");
+    assert_file_type(RLE_LOGIC, "logic.rle");
+
+    assert_file_type(CU8_IQ, ".sigmf-data");
+    assert_file_type(CS16_IQ, ".cs16.sigmf-data");
+    assert_file_type(CF32_IQ, "cf32:.sigmf-data");
+
     fprintf(stderr, "\nDone!\n");
 }
 #endif /* _TEST */
@@ -0,0 +1,189 @@
+/** @file
+    Multi-device frequency coverage planner.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "freq_plan.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Share of the sample rate in percent that is flat enough to decode, the edges are filtered.
+#define FREQ_PLAN_USABLE_PCT 80
+/// Minimum offset in Hz from the DC spike, a signal needs some room for its own bandwidth.
+#define FREQ_PLAN_DC_GUARD 20000
+
+struct freq_plan {
+    unsigned wanted_count;
+    uint32_t wanted[FREQ_PLAN_MAX_FREQS];
+    unsigned device[FREQ_PLAN_MAX_FREQS]; ///< the device covering each wanted frequency
+    unsigned index[FREQ_PLAN_MAX_FREQS];  ///< the center of the device covering each wanted frequency
+    unsigned devices;
+    unsigned centers[FREQ_PLAN_MAX_DEVICES];
+    uint32_t center[FREQ_PLAN_MAX_DEVICES][FREQ_PLAN_MAX_FREQS];
+};
+
+static uint32_t usable_half_width(uint32_t samp_rate)
+{
+    return (uint32_t)((uint64_t)samp_rate * FREQ_PLAN_USABLE_PCT / 200);
+}
+
+static uint32_t dc_guard(uint32_t samp_rate)
+{
+    uint32_t half  = usable_half_width(samp_rate);
+    uint32_t guard = samp_rate / 50 > FREQ_PLAN_DC_GUARD ? samp_rate / 50 : FREQ_PLAN_DC_GUARD;
+    // narrow sample rates keep the outer half of the usable band
+    return guard < half ? guard : half / 2;
+}
+
+int freq_plan_covers(uint32_t center, uint32_t frequency, uint32_t samp_rate)
+{
+    uint32_t offset = frequency > center ? frequency - center : center - frequency;
+    return offset >= dc_guard(samp_rate) && offset <= usable_half_width(samp_rate);
+}
+
+// find the center covering the most uncovered frequencies, closest to the center on a tie, returns the count
+static unsigned best_center(freq_plan_t const *plan, uint8_t const *covered, uint32_t samp_rate, uint32_t *best)
+{
+    int64_t half  = usable_half_width(samp_rate);
+    int64_t guard = dc_guard(samp_rate);
+
+    unsigned best_count  = 0;
+    uint32_t best_spread = 0;
+    for (unsigned i = 0; i < plan->wanted_count; ++i) {
+        if (covered[i])
+            continue;
+        // a best center has some frequency at an edge of the passband or of the DC guard
+        int64_t f = plan->wanted[i];
+        int64_t candidates[] = {f - half, f - guard, f + guard, f + half};
+        for (unsigned k = 0; k < sizeof(candidates) / sizeof(*candidates); ++k) {
+            int64_t c = candidates[k];
+            if (c <= 0 || c > UINT32_MAX)
+                continue;
+            unsigned count  = 0;
+            uint32_t spread = 0;
+            for (unsigned j = 0; j < plan->wanted_count; ++j) {
+                if (covered[j] || !freq_plan_covers((uint32_t)c, plan->wanted[j], samp_rate))
+                    continue;
+                uint32_t offset = plan->wanted[j] > c ? plan->wanted[j] - (uint32_t)c : (uint32_t)c - plan->wanted[j];
+                count += 1;
+                spread = offset > spread ? offset : spread;
+            }
+            if (count > best_count || (count == best_count && spread < best_spread)) {
+                best_count  = count;
+                best_spread = spread;
+                *best       = (uint32_t)c;
+            }
+        }
+    }
+    return best_count;
+}
+
+// add a center to a device and mark the frequencies it covers, returns the number of frequencies left
+static unsigned add_center(freq_plan_t *plan, uint8_t *covered, unsigned device, uint32_t samp_rate, uint32_t center, unsigned left)
+{
+    unsigned index = plan->centers[device]++;
+    plan->center[device][index] = center;
+    for (unsigned j = 0; j < plan->wanted_count; ++j) {
+        if (covered[j] || !freq_plan_covers(center, plan->wanted[j], samp_rate))
+            continue;
+        covered[j]      = 1;
+        plan->device[j] = device;
+        plan->index[j]  = index;
+        left -= 1;
+    }
+    return left;
+}
+
+freq_plan_t *freq_plan_create(uint32_t const *wanted, unsigned wanted_count, uint32_t const *samp_rate, unsigned devices)
+{
+    if (!wanted_count || wanted_count > FREQ_PLAN_MAX_FREQS || !devices || devices > FREQ_PLAN_MAX_DEVICES) {
+        return NULL;
+    }
+    for (unsigned d = 0; d < devices; ++d) {
+        if (!samp_rate[d])
+            return NULL;
+    }
+
+    freq_plan_t *plan = calloc(1, sizeof(*plan));
+    if (!plan) {
+        WARN_CALLOC("freq_plan_create()");
+        return NULL;
+    }
+    plan->wanted_count = wanted_count;
+    memcpy(plan->wanted, wanted, wanted_count * sizeof(*wanted));
+    plan->devices = devices;
+
+    // the widest devices are planned first, stable for equal sample rates
+    unsigned order[FREQ_PLAN_MAX_DEVICES];
+    for (unsigned d = 0; d < devices; ++d) {
+        unsigned k = d;
+        for (; k > 0 && samp_rate[order[k - 1]] < samp_rate[d]; --k) {
+            order[k] = order[k - 1];
+        }
+        order[k] = d;
+    }
+
+    uint8_t covered[FREQ_PLAN_MAX_FREQS] = {0};
+    unsigned left = wanted_count;
+    for (unsigned k = 0; k < devices && left; ++k) {
+        unsigned d = order[k];
+        uint32_t center;
+        // each device but the last takes one center, the last hops over the rest
+        do {
+            if (!best_center(plan, covered, samp_rate[d], &center))
+                break; // unreachable, any frequency is covered by a center at the DC guard
+            left = add_center(plan, covered, d, samp_rate[d], center, left);
+        } while (left && k == devices - 1);
+    }
+
+    // devices not needed double the first one
+    for (unsigned d = 0; d < devices; ++d) {
+        if (!plan->centers[d]) {
+            plan->centers[d]   = 1;
+            plan->center[d][0] = plan->center[order[0]][0];
+        }
+    }
+
+    return plan;
+}
+
+void freq_plan_free(freq_plan_t *plan)
+{
+    free(plan);
+}
+
+unsigned freq_plan_centers(freq_plan_t const *plan, unsigned device)
+{
+    return plan->centers[device];
+}
+
+uint32_t freq_plan_center(freq_plan_t const *plan, unsigned device, unsigned index)
+{
+    return plan->center[device][index];
+}
+
+unsigned freq_plan_wanted_count(freq_plan_t const *plan)
+{
+    return plan->wanted_count;
+}
+
+uint32_t freq_plan_wanted(freq_plan_t const *plan, unsigned wanted)
+{
+    return plan->wanted[wanted];
+}
+
+unsigned freq_plan_device(freq_plan_t const *plan, unsigned wanted, unsigned *center)
+{
+    if (center)
+        *center = plan->index[wanted];
+    return plan->device[wanted];
+}
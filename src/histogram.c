@@ -0,0 +1,220 @@
+/** @file
+    Histogram of pulse and gap widths.
+
+    Copyright (C) 2015 Tommy Vestermark
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "histogram.h"
+#include "c_util.h" // for MIN(), MAX()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned histogram_sum(histogram_t *hist, int const *data, unsigned len, float tolerance)
+{
+    unsigned bin;    // Iterator will be used outside for!
+    unsigned dropped = 0;
+
+    for (unsigned n = 0; n < len; ++n) {
+        // Search for match in existing bins
+        for (bin = 0; bin < hist->bins_count; ++bin) {
+            int bn = data[n];
+            int bm = hist->bins[bin].mean;
+            if (abs(bn - bm) < (tolerance * MAX(bn, bm))) {
+                hist->bins[bin].count++;
+                hist->bins[bin].sum += data[n];
+                hist->bins[bin].mean = hist->bins[bin].sum / hist->bins[bin].count;
+                hist->bins[bin].min    = MIN(data[n], hist->bins[bin].min);
+                hist->bins[bin].max    = MAX(data[n], hist->bins[bin].max);
+                break;    // Match found! Data added to existing bin
+            }
+        }
+        // No match found? Add new bin
+        if (bin == hist->bins_count && bin < MAX_HIST_BINS) {
+            hist->bins[bin].count    = 1;
+            hist->bins[bin].sum        = data[n];
+            hist->bins[bin].mean    = data[n];
+            hist->bins[bin].min        = data[n];
+            hist->bins[bin].max        = data[n];
+            hist->bins_count++;
+        } // for bin
+        else if (bin == hist->bins_count) {
+            dropped++;
+        }
+    } // for data
+    return dropped;
+}
+
+void histogram_delete_bin(histogram_t *hist, unsigned index)
+{
+    hist_bin_t const zerobin = {0};
+    if (hist->bins_count < 1) return;    // Avoid out of bounds
+    // Move all bins afterwards one forward
+    for (unsigned n = index; n < hist->bins_count-1; ++n) {
+        hist->bins[n] = hist->bins[n+1];
+    }
+    hist->bins_count--;
+    hist->bins[hist->bins_count] = zerobin;    // Clear previously last bin
+}
+
+
+void histogram_swap_bins(histogram_t *hist, unsigned index1, unsigned index2)
+{
+    hist_bin_t    tempbin;
+    if ((index1 < hist->bins_count) && (index2 < hist->bins_count)) {        // Avoid out of bounds
+        tempbin = hist->bins[index1];
+        hist->bins[index1] = hist->bins[index2];
+        hist->bins[index2] = tempbin;
+    }
+}
+
+
+static int cmp_bin_mean(void const *a, void const *b)
+{
+    hist_bin_t const *bin_a = a;
+    hist_bin_t const *bin_b = b;
+    return (bin_a->mean > bin_b->mean) - (bin_a->mean < bin_b->mean);
+}
+
+// ties by count are kept in the order of the means
+static int cmp_bin_count(void const *a, void const *b)
+{
+    hist_bin_t const *bin_a = a;
+    hist_bin_t const *bin_b = b;
+    if (bin_a->count != bin_b->count)
+        return bin_a->count > bin_b->count ? 1 : -1;
+    return cmp_bin_mean(a, b);
+}
+
+void histogram_sort_mean(histogram_t *hist)
+{
+    qsort(hist->bins, hist->bins_count, sizeof(*hist->bins), cmp_bin_mean);
+}
+
+
+void histogram_sort_count(histogram_t *hist)
+{
+    qsort(hist->bins, hist->bins_count, sizeof(*hist->bins), cmp_bin_count);
+}
+
+// add the data of bin b to bin a
+static void merge_bin(hist_bin_t *a, hist_bin_t const *b)
+{
+    a->count += b->count;
+    a->sum   += b->sum;
+    a->mean   = a->sum / a->count;
+    a->min    = MIN(a->min, b->min);
+    a->max    = MAX(a->max, b->max);
+}
+
+static int within_tolerance(int bn, int bm, float tolerance)
+{
+    return bn == bm || abs(bn - bm) < (tolerance * MAX(bn, bm));
+}
+
+void histogram_fuse_bins(histogram_t *hist, float tolerance)
+{
+    if (hist->bins_count < 2) return;        // Avoid underflow
+    // Sorted by mean only neighbours can be within tolerance, compare each bin to the last fused bin
+    histogram_sort_mean(hist);
+    unsigned n = 0;
+    for (unsigned m = 1; m < hist->bins_count; ++m) {
+        if (within_tolerance(hist->bins[n].mean, hist->bins[m].mean, tolerance)) {
+            merge_bin(&hist->bins[n], &hist->bins[m]);
+        }
+        else {
+            hist->bins[++n] = hist->bins[m];
+        }
+    }
+    hist_bin_t const zerobin = {0};
+    for (unsigned m = n + 1; m < hist->bins_count; ++m) {
+        hist->bins[m] = zerobin;    // Clear the fused bins
+    }
+    hist->bins_count = n + 1;
+}
+
+static int cmp_int(void const *a, void const *b)
+{
+    int const ia = *(int const *)a;
+    int const ib = *(int const *)b;
+    return (ia > ib) - (ia < ib);
+}
+
+// merge the neighbour bins with the smallest relative distance of their means
+static void merge_closest_bins(histogram_t *hist)
+{
+    unsigned best = 0;
+    double best_dist = 2.0;
+    for (unsigned n = 0; n + 1 < hist->bins_count; ++n) {
+        int upper = hist->bins[n + 1].mean;
+        double dist = upper > 0 ? (double)(upper - hist->bins[n].mean) / upper : 0.0;
+        if (dist < best_dist) {
+            best_dist = dist;
+            best      = n;
+        }
+    }
+    merge_bin(&hist->bins[best], &hist->bins[best + 1]);
+    histogram_delete_bin(hist, best + 1);
+}
+
+void histogram_cluster(histogram_t *hist, int const *data, unsigned len, float tolerance)
+{
+    hist->bins_count = 0;
+    if (!len)
+        return;
+    int *sorted = malloc(len * sizeof(*sorted));
+    if (!sorted) {
+        // the unsorted clustering needs no memory
+        histogram_sum(hist, data, len, tolerance);
+        histogram_fuse_bins(hist, tolerance);
+        return;
+    }
+    memcpy(sorted, data, len * sizeof(*sorted));
+    qsort(sorted, len, sizeof(*sorted), cmp_int);
+
+    for (unsigned n = 0; n < len; ++n) {
+        int v = sorted[n];
+        if (hist->bins_count && within_tolerance(v, hist->bins[hist->bins_count - 1].mean, tolerance)) {
+            hist_bin_t value = {1, v, v, v, v};
+            merge_bin(&hist->bins[hist->bins_count - 1], &value);
+            continue;
+        }
+        if (hist->bins_count == MAX_HIST_BINS) {
+            merge_closest_bins(hist);
+        }
+        hist_bin_t *bin = &hist->bins[hist->bins_count++];
+        bin->count = 1;
+        bin->sum   = v;
+        bin->mean  = v;
+        bin->min   = v;
+        bin->max   = v;
+    }
+    free(sorted);
+}
+
+int histogram_find_bin_index(histogram_t const *hist, int width)
+{
+    for (unsigned n = 0; n < hist->bins_count; ++n) {
+        if (hist->bins[n].min <= width && width <= hist->bins[n].max) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+void histogram_print(histogram_t const *hist, uint32_t samp_rate)
+{
+    for (unsigned n = 0; n < hist->bins_count; ++n) {
+        fprintf(stderr, " [%2u] count: %4u,  width: %4.0f us [%.0f;%.0f]\t(%4i S)\n", n,
+                hist->bins[n].count,
+                hist->bins[n].mean * 1e6 / samp_rate,
+                hist->bins[n].min * 1e6 / samp_rate,
+                hist->bins[n].max * 1e6 / samp_rate,
+                hist->bins[n].mean);
+    }
+}
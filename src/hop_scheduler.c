@@ -0,0 +1,371 @@
+/** @file
+    Activity-adaptive frequency hop scheduler.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "hop_scheduler.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+
+/// Transmitters tracked per frequency.
+#define HOP_SCHED_TRACKS 8
+/// Events this close are repeats of one transmission.
+#define HOP_SCHED_BURST_MS 1500
+/// Jitter of a periodic transmission, also the time to wait for a late one.
+#define HOP_SCHED_TOLERANCE_MS 2000
+/// Shortest and longest period of a periodic transmitter.
+#define HOP_SCHED_MIN_PERIOD_MS 10000
+#define HOP_SCHED_MAX_PERIOD_MS 600000
+/// Tune to a frequency this early before a transmission is due.
+#define HOP_SCHED_LEAD_MS 1000
+/// A transmitter missing this many periods is no longer expected.
+#define HOP_SCHED_STALE_PERIODS 5
+/// Weight of the events and packages per minute, a frequency with an event every minute gets twice its base dwell.
+#define HOP_SCHED_EVENT_WEIGHT 1.0
+#define HOP_SCHED_PACKAGE_WEIGHT 0.25
+/// Smoothing of the rates over visits.
+#define HOP_SCHED_RATE_ALPHA 0.25
+/// A quiet frequency keeps this fraction of its base dwell.
+#define HOP_SCHED_MIN_SHARE 4
+
+typedef struct {
+    uint64_t last;   ///< position of the last transmission, 0 if unused
+    uint64_t period; ///< samples between transmissions, 0 if not seen twice
+    unsigned hits;
+} hop_track_t;
+
+typedef struct {
+    uint64_t base;       ///< base dwell in samples
+    double event_rate;   ///< events per second, smoothed over visits
+    double package_rate; ///< packages per second, smoothed over visits
+    int visited;
+    unsigned events;     ///< events of the current visit
+    unsigned packages;   ///< packages of the current visit
+    hop_track_t track[HOP_SCHED_TRACKS];
+} hop_freq_t;
+
+struct hop_scheduler {
+    uint32_t sample_rate;
+    unsigned count;
+    unsigned index;     ///< the current frequency
+    unsigned rr;        ///< the frequency of the round-robin
+    uint64_t rr_remain; ///< dwell left of a pre-empted round-robin visit
+    uint64_t start;     ///< position the current visit started
+    uint64_t until;     ///< position the current visit ends
+    int awaiting;       ///< the current visit waits for an expected transmission
+    int preempt;        ///< the hop is a pre-emption
+    uint64_t cycle;     ///< sum of the base dwells
+    uint64_t burst;
+    uint64_t tolerance;
+    uint64_t lead;
+    hop_freq_t *freq;
+};
+
+static uint64_t ms_to_samples(hop_scheduler_t const *sched, uint64_t ms)
+{
+    return ms * sched->sample_rate / 1000;
+}
+
+// the next due position of a transmitter at or after pos less the tolerance, 0 if none is expected
+static uint64_t track_due(hop_scheduler_t const *sched, hop_track_t const *track, uint64_t pos)
+{
+    if (!track->period)
+        return 0;
+    uint64_t due = track->last + track->period;
+    if (due + sched->tolerance < pos)
+        due += (pos - sched->tolerance - due + track->period - 1) / track->period * track->period;
+    if (due - track->last > HOP_SCHED_STALE_PERIODS * track->period)
+        return 0;
+    return due;
+}
+
+// the earliest transmission due on a frequency, 0 if none is expected
+static uint64_t freq_due(hop_scheduler_t const *sched, hop_freq_t const *f, uint64_t pos)
+{
+    uint64_t earliest = 0;
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        uint64_t due = track_due(sched, &f->track[i], pos);
+        if (due && (!earliest || due < earliest))
+            earliest = due;
+    }
+    return earliest;
+}
+
+// the other frequency with a transmission due soon, -1 if there is none
+static int find_due(hop_scheduler_t const *sched, uint64_t pos, uint64_t *due_pos)
+{
+    int found = -1;
+    uint64_t own = freq_due(sched, &sched->freq[sched->index], pos);
+    for (unsigned i = 0; i < sched->count; ++i) {
+        if (i == sched->index)
+            continue;
+        uint64_t due = freq_due(sched, &sched->freq[i], pos);
+        if (!due || due > pos + sched->lead)
+            continue;
+        // stay for a transmission due here first
+        if (own && own <= due + sched->tolerance)
+            continue;
+        if (found < 0 || due < *due_pos) {
+            found    = (int)i;
+            *due_pos = due;
+        }
+    }
+    return found;
+}
+
+// a transmitter seen at a multiple of its period can be tracked twice with the same period, the gap between the tracks is the period
+static void merge_tracks(hop_scheduler_t *sched, hop_freq_t *f, hop_track_t *track)
+{
+    uint64_t min_period = ms_to_samples(sched, HOP_SCHED_MIN_PERIOD_MS);
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *other = &f->track[i];
+        if (other == track || !other->period || other->last >= track->last
+                || other->period + sched->tolerance < track->period || other->period > track->period + sched->tolerance)
+            continue;
+        uint64_t since = track->last - other->last;
+        if (since < min_period || since + sched->tolerance >= track->period)
+            continue;
+        // the period is a multiple of the gap
+        uint64_t parts = (track->period + since / 2) / since;
+        uint64_t part  = track->period / parts;
+        if (since + sched->tolerance >= part && since <= part + sched->tolerance) {
+            track->period = since;
+            track->hits += other->hits;
+            *other = (hop_track_t){0};
+        }
+    }
+}
+
+// match an event to the tracked transmitters, returns 1 if it was expected
+static int track_event(hop_scheduler_t *sched, hop_freq_t *f, uint64_t pos)
+{
+    uint64_t min_period = ms_to_samples(sched, HOP_SCHED_MIN_PERIOD_MS);
+    uint64_t max_period = ms_to_samples(sched, HOP_SCHED_MAX_PERIOD_MS);
+
+    // a repeat of the last transmission
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *track = &f->track[i];
+        if (track->last && pos - track->last < sched->burst)
+            return 0;
+    }
+    // a transmission of a periodic transmitter, possibly after missed ones
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *track = &f->track[i];
+        uint64_t due = track_due(sched, track, pos);
+        if (due && pos + sched->tolerance >= due && pos <= due + sched->tolerance) {
+            uint64_t periods = (due - track->last) / track->period;
+            track->period    = (track->period * 3 + (pos - track->last) / periods) / 4;
+            track->last      = pos;
+            track->hits += 1;
+            merge_tracks(sched, f, track);
+            return 1;
+        }
+    }
+    // a transmission between the due ones, the period was taken across missed transmissions
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *track = &f->track[i];
+        uint64_t since = pos - track->last;
+        if (!track->period || since < min_period || since >= track->period)
+            continue;
+        uint64_t parts = (track->period + since / 2) / since;
+        uint64_t part  = track->period / parts;
+        if (parts >= 2 && since + sched->tolerance >= part && since <= part + sched->tolerance) {
+            track->period = since;
+            track->last   = pos;
+            track->hits += 1;
+            return 0;
+        }
+    }
+    // the second transmission of a transmitter
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *track = &f->track[i];
+        if (track->last && !track->period && pos - track->last >= min_period && pos - track->last <= max_period) {
+            track->period = pos - track->last;
+            track->last   = pos;
+            track->hits   = 1;
+            merge_tracks(sched, f, track);
+            return 0;
+        }
+    }
+    // a new transmitter, replacing an unused, a stale, or the longest unseen one
+    hop_track_t *slot = &f->track[0];
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        hop_track_t *track = &f->track[i];
+        if (!track->last) {
+            slot = track;
+            break;
+        }
+        int stale = track->period ? !track_due(sched, track, pos) : pos - track->last > max_period;
+        if (stale) {
+            slot = track;
+            break;
+        }
+        if (track->last < slot->last)
+            slot = track;
+    }
+    *slot = (hop_track_t){.last = pos};
+    return 0;
+}
+
+static double freq_weight(hop_freq_t const *f)
+{
+    return (double)f->base * (1.0 + 60.0 * (HOP_SCHED_EVENT_WEIGHT * f->event_rate + HOP_SCHED_PACKAGE_WEIGHT * f->package_rate));
+}
+
+static uint64_t freq_dwell(hop_scheduler_t const *sched, unsigned index)
+{
+    double total = 0.0;
+    for (unsigned i = 0; i < sched->count; ++i) {
+        total += freq_weight(&sched->freq[i]);
+    }
+    hop_freq_t const *f = &sched->freq[index];
+    uint64_t dwell = total > 0.0 ? (uint64_t)(sched->cycle * freq_weight(f) / total) : f->base;
+    uint64_t min   = f->base / HOP_SCHED_MIN_SHARE;
+    return dwell > min ? dwell : min;
+}
+
+hop_scheduler_t *hop_scheduler_create(unsigned frequencies, int const *hop_time, unsigned hop_times, uint32_t sample_rate, unsigned index, uint64_t pos)
+{
+    if (frequencies < 2 || !hop_times || !sample_rate)
+        return NULL;
+
+    hop_scheduler_t *sched = calloc(1, sizeof(*sched));
+    if (!sched) {
+        WARN_CALLOC("hop_scheduler_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    sched->freq = calloc(frequencies, sizeof(*sched->freq));
+    if (!sched->freq) {
+        WARN_CALLOC("hop_scheduler_create()");
+        free(sched);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    sched->sample_rate = sample_rate;
+    sched->count       = frequencies;
+    sched->burst       = ms_to_samples(sched, HOP_SCHED_BURST_MS);
+    sched->tolerance   = ms_to_samples(sched, HOP_SCHED_TOLERANCE_MS);
+    sched->lead        = ms_to_samples(sched, HOP_SCHED_LEAD_MS);
+    for (unsigned i = 0; i < frequencies; ++i) {
+        int secs = hop_time[i < hop_times ? i : hop_times - 1];
+        sched->freq[i].base = (uint64_t)(secs > 0 ? secs : 1) * sample_rate;
+        sched->cycle += sched->freq[i].base;
+    }
+    sched->index = index % frequencies;
+    sched->rr    = sched->index;
+    sched->start = pos;
+    sched->until = pos + sched->freq[sched->index].base;
+    return sched;
+}
+
+void hop_scheduler_free(hop_scheduler_t *sched)
+{
+    if (!sched)
+        return;
+    free(sched->freq);
+    free(sched);
+}
+
+int hop_scheduler_frame(hop_scheduler_t *sched, uint64_t pos, unsigned packages, unsigned events)
+{
+    hop_freq_t *f = &sched->freq[sched->index];
+    f->packages += packages;
+    f->events += events;
+    if (events && track_event(sched, f, pos) && sched->awaiting) {
+        // the expected transmission arrived, stay for its repeats
+        if (sched->until > pos + sched->burst)
+            sched->until = pos + sched->burst;
+    }
+
+    sched->preempt = 0;
+    if (pos >= sched->until) {
+        // don't leave just before a transmission is due
+        uint64_t own = freq_due(sched, f, pos);
+        if (!sched->awaiting && own && own <= pos + sched->lead) {
+            sched->until    = own + sched->tolerance;
+            sched->awaiting = 1;
+            return 0;
+        }
+        return 1;
+    }
+    uint64_t due;
+    if (!sched->awaiting && find_due(sched, pos, &due) >= 0) {
+        sched->preempt = 1;
+        return 1;
+    }
+    return 0;
+}
+
+unsigned hop_scheduler_next(hop_scheduler_t *sched, uint64_t pos)
+{
+    hop_freq_t *f = &sched->freq[sched->index];
+    // only the round-robin visits measure the activity, a visit for a transmission would overrate it
+    double secs = (double)(pos - sched->start) / sched->sample_rate;
+    if (!sched->awaiting && secs >= 1.0) {
+        double event_rate   = f->events / secs;
+        double package_rate = f->packages / secs;
+        if (f->visited) {
+            f->event_rate += HOP_SCHED_RATE_ALPHA * (event_rate - f->event_rate);
+            f->package_rate += HOP_SCHED_RATE_ALPHA * (package_rate - f->package_rate);
+        }
+        else {
+            f->event_rate   = event_rate;
+            f->package_rate = package_rate;
+            f->visited      = 1;
+        }
+    }
+    f->events   = 0;
+    f->packages = 0;
+
+    // a pre-empted round-robin visit continues after the transmission
+    if (!sched->awaiting)
+        sched->rr_remain = sched->preempt && pos < sched->until ? sched->until - pos : 0;
+    sched->preempt = 0;
+
+    uint64_t due;
+    int next = find_due(sched, pos, &due);
+    if (next >= 0) {
+        sched->index    = (unsigned)next;
+        sched->until    = due + sched->tolerance;
+        sched->awaiting = 1;
+    }
+    else if (sched->rr_remain) {
+        sched->index     = sched->rr;
+        sched->until     = pos + sched->rr_remain;
+        sched->rr_remain = 0;
+        sched->awaiting  = 0;
+    }
+    else {
+        sched->rr       = (sched->rr + 1) % sched->count;
+        sched->index    = sched->rr;
+        sched->until    = pos + freq_dwell(sched, sched->rr);
+        sched->awaiting = 0;
+    }
+    sched->start = pos;
+    return sched->index;
+}
+
+unsigned hop_scheduler_dwell_ms(hop_scheduler_t const *sched, unsigned index)
+{
+    if (index >= sched->count)
+        return 0;
+    return (unsigned)(freq_dwell(sched, index) * 1000 / sched->sample_rate);
+}
+
+unsigned hop_scheduler_periodic(hop_scheduler_t const *sched, unsigned index)
+{
+    if (index >= sched->count)
+        return 0;
+    unsigned periodic = 0;
+    for (unsigned i = 0; i < HOP_SCHED_TRACKS; ++i) {
+        periodic += sched->freq[index].track[i].period != 0;
+    }
+    return periodic;
+}
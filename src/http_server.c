@@ -19,6 +19,12 @@ A choice of endpoints are available:
 - "/cmd": simple JSON command API
 - "/events": HTTP (chunked) streaming API, streams JSON events
 - "/stream": HTTP (plain) streaming API, streams JSON events
+- "/metrics": Prometheus text format of the input, decoder, and output counters
+- "/spectrum": JSON of the level, noise floor, and occupancy of the spectrum bins (with -N)
+- "/devices": JSON of the latest event, time, RSSI, SNR, and event count of each sensor (with -M devices)
+- "/history": JSON array of the stored events in a time range, of a model and id (with store=)
+- "/pulses": pulse archive of the packages recorded in a time range (with -M recorder)
+- "/redecode": JSON array of the events of the packages recorded in a time range, with the current decoders (with -M recorder)
 - "/api": RESTful API (not implemented)
 - "ws:": Websocket API (similar to cmd/events API)
 
@@ -49,6 +55,47 @@ On Events and Stream endpoints a keep-alive of CRLF will be send every 60 second
 Use e.g. httpie with `http --stream --timeout=70 :8433/events`
 or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 
+Each event is serialized once and queued for all clients.
+A client that does not keep up has the oldest events dropped once it has more
+than `buffer=` bytes (default 1M) queued, and then receives e.g. `{"dropped" : 12}`.
+The "clients" in "get_meta" show the queued bytes (lag) and dropped count per client.
+
+Events are numbered from 1, the latest `history=` bytes (default 64k) of events are kept.
+A Websocket receives the kept events on connect.
+Request "/events" with `Accept: text/event-stream` to receive Server-Sent Events with ids.
+To resume send a `Last-Event-ID` header or use e.g. "/events?since=42" (also "/stream" and Websocket),
+events no longer kept are reported as dropped. The "history" in "get_meta" shows the kept ids.
+
+The history and the queued events are accounted as "http" memory, the send buffers as "network" memory.
+If either is over its limit (`-M memory:`) the client with the most bytes waiting is closed.
+
+## Event store
+
+With `store=<dir>` the events are also appended to segment files in the directory, see event_store.h.
+"/history" replies with a JSON array of the stored events, the oldest first, selected by
+`from=` and `to=` in seconds since the epoch (negative is before now), `model=`, and `id=`,
+e.g. "/history?from=-86400&model=Acurite-Tower&id=1234" for the last 24 hours of a sensor.
+At most `limit=` events (default 10000) are sent, the `X-Next-From` header then has the time to continue from.
+The time index finds the start of a range and the sensor index the events of a sensor, the texts are sent as stored.
+
+## Compression
+
+With zlib the events are compressed for clients that ask for it, e.g. `curl -N --compressed :8433/events`.
+"/events" and "/stream" use `Content-Encoding: gzip` (preferred) or `deflate` from `Accept-Encoding`,
+a Websocket uses `permessage-deflate` if offered. Each event is compressed and flushed once per framing
+on a stream shared by all clients with that framing, the events refer back to the events before.
+A new, resuming, or slow client gets the events compressed on their own until the shared stream restarts,
+which it does for the next event, then it follows the stream too. The replay and notices are compressed on their own.
+Websocket commands may be compressed, the replies are not.
+
+## Threading
+
+The server runs on its own event loop and thread, slow clients do not stall the inputs.
+Commands, "get_meta", "/metrics", "/spectrum", "/devices", "/history", "/pulses", and "/redecode"
+are queued to the core event loop,
+the replies and the events are queued back. Commands are answered while the core event loop runs,
+e.g. not while a plain file is read. Without threads the server runs on the core event loop.
+
 ## Queries
 
 - "registered_protocols"
@@ -87,9 +134,15 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 - "hop_interval":     600
 - "ppm_error":        0
 - "sample_rate":      250000
-- "report_meta":      "time"|"reltime"|"notime"|"hires"|"utc"|"protocol"|"level"
+- "report_meta":      "time"|"reltime"|"notime"|"hires"|"utc"|"protocol"|"level"|"stats"
+    "stats" with val 3 accounts the time each decoder spends, "get_stats" with val 3 reports it
 - "convert":          "native"|"si"|"customary"
 - "protocol":         1
+- "trace":            "/tmp/trace.json"
+    with val the seconds to trace (0 until stopped), without arg a running trace is stopped
+- "reload"
+    re-reads the decoder and output options (-R, -X, -F) of the command line and config files,
+    the SDR keeps running, the decoders are swapped between two sample buffers
 
 */
 
@@ -97,6 +150,9 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 #include "data.h"
 #include "rtl_433.h"
 #include "r_api.h"
+#include "sensor_state.h"
+#include "event_store.h"
+#include "pulse_recorder.h"
 #include "r_device.h" // used for protocols
 #include "r_private.h" // used for protocols
 #include "r_util.h"
@@ -107,7 +163,19 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 #include "mongoose.h"
 #include "logger.h"
 #include "fatal.h"
+#include "output_async.h"
+#include "output_influx.h"
+#include "freq_plan.h"
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+#include "thread_sched.h"
+#include "mem_acct.h"
 #include <stdbool.h>
+#include <stdarg.h>
+
+#ifdef ZLIB
+#include <zlib.h>
+#endif
 
 // embed index.html so browsers allow access as local
 #define INDEX_HTML \
@@ -130,8 +198,6 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 
 // generic ring list
 
-#define DEFAULT_HISTORY_SIZE 100
-
 typedef struct {
     unsigned size;
     void **data;
@@ -205,31 +271,376 @@ static void *ring_list_push(ring_list_t *ring, void *data)
     return NULL;
 }
 
-static void **ring_list_iter(ring_list_t *ring)
+// shared messages
+
+#ifdef ZLIB
+/// The framing of the text on a stream, the clients with the same framing share the compressed text.
+typedef enum {
+    FRAME_WEBSOCKET, ///< the text as a message
+    FRAME_LINE,      ///< the text and CRLF, on "/events" and "/stream"
+    FRAME_SSE,       ///< the text as an event with the id, on "/events" as "text/event-stream"
+    FRAMES,
+} frame_kind_t;
+
+/// Framed text compressed as raw deflate blocks ending with a sync flush.
+typedef struct {
+    size_t len;     ///< bytes compressed
+    size_t raw_len; ///< bytes of the framed text
+    uint32_t crc;   ///< CRC-32 of the framed text, for the gzip trailer
+    uint32_t adler; ///< Adler-32 of the framed text, for the zlib trailer
+    unsigned seq;   ///< sequence number on the shared stream
+    int restart;    ///< does not refer back to earlier texts, any client can take it
+    unsigned char buf[];
+} deflated_t;
+
+/** A compressor shared by the clients with the same framing.
+
+    The texts refer back to the texts before on the stream, a client follows the stream
+    as long as it gets each text in sequence. A client that missed a text, e.g. a new,
+    resuming, or slow client, gets the texts compressed on their own until the stream
+    restarts, the stream restarts for the next text as long as a client does not follow.
+*/
+typedef struct {
+    z_stream zs;
+    int ready;
+    unsigned seq; ///< sequence number of the next text
+    int restart;  ///< the next text does not refer back
+} deflate_stream_t;
+#endif
+
+/// The JSON text of an event, shared by the queues of all clients.
+typedef struct {
+    unsigned refs;
+    unsigned id; ///< the event id, 0 for notices
+    size_t len;
+#ifdef ZLIB
+    deflated_t *deflated[FRAMES]; ///< the text compressed on the shared stream of each framing
+    deflated_t *alone[FRAMES];    ///< the text compressed on its own for each framing, made on first use
+#endif
+    char text[];
+} shared_msg_t;
+
+static shared_msg_t *shared_msg_new(char const *text, size_t len)
+{
+    shared_msg_t *msg = mem_get(MEM_TAG_HTTP, sizeof(shared_msg_t) + len + 1);
+    if (!msg) {
+        WARN_MALLOC("shared_msg_new()");
+        return NULL;
+    }
+    msg->refs = 1;
+    msg->id   = 0;
+    msg->len  = len;
+#ifdef ZLIB
+    for (int i = 0; i < FRAMES; ++i) {
+        msg->deflated[i] = NULL;
+        msg->alone[i]    = NULL;
+    }
+#endif
+    if (text)
+        memcpy(msg->text, text, len);
+    msg->text[len] = '\0';
+    return msg;
+}
+
+static shared_msg_t *shared_msg_retain(shared_msg_t *msg)
 {
-    return ring->head;
+    if (msg)
+        msg->refs += 1;
+    return msg;
 }
 
-static void **ring_list_next(ring_list_t *ring, void **iter)
+static void shared_msg_release(shared_msg_t *msg)
 {
-    if (!iter)
-        return NULL;
+    if (!msg || --msg->refs > 0)
+        return;
+#ifdef ZLIB
+    for (int i = 0; i < FRAMES; ++i) {
+        mem_put(MEM_TAG_HTTP, msg->deflated[i]);
+        mem_put(MEM_TAG_HTTP, msg->alone[i]);
+    }
+#endif
+    mem_put(MEM_TAG_HTTP, msg);
+}
+
+// event history
+
+/// Default bytes of event history kept to replay.
+#ifdef RTL_433_MEMORY_BUDGET_MB
+#define DEFAULT_HISTORY_BYTES (RTL_433_MEMORY_BUDGET_MB * 1024)
+#else
+#define DEFAULT_HISTORY_BYTES (64 * 1024)
+#endif
+
+/// Header of an event in the history ring, followed by the text.
+typedef struct {
+    unsigned id;
+    unsigned len;
+} history_entry_t;
+
+/// Byte ring of the latest events, the oldest are dropped to make room.
+typedef struct {
+    char *buf;
+    size_t size;     ///< bytes in the ring
+    size_t head;     ///< offset of the oldest entry
+    size_t used;     ///< bytes of all entries
+    unsigned count;  ///< number of entries
+    unsigned last_id; ///< the id of the latest event, events are numbered from 1
+} history_t;
+
+static int history_init(history_t *hist, size_t size)
+{
+    hist->buf = mem_get(MEM_TAG_HTTP, size);
+    if (!hist->buf) {
+        WARN_MALLOC("history_init()");
+        return -1;
+    }
+    hist->size = size;
+    return 0;
+}
+
+static void history_free(history_t *hist)
+{
+    mem_put(MEM_TAG_HTTP, hist->buf);
+    hist->buf = NULL;
+}
+
+static void history_read(history_t const *hist, size_t ofs, void *dst, size_t len)
+{
+    ofs %= hist->size;
+    size_t part = hist->size - ofs < len ? hist->size - ofs : len;
+    memcpy(dst, hist->buf + ofs, part);
+    memcpy((char *)dst + part, hist->buf, len - part);
+}
 
-    ++iter;
-    if (iter >= ring->data + ring->size)
-        iter -= ring->size;
-    if (iter == ring->tail)
-        iter = NULL;
+static void history_write(history_t *hist, size_t ofs, void const *src, size_t len)
+{
+    ofs %= hist->size;
+    size_t part = hist->size - ofs < len ? hist->size - ofs : len;
+    memcpy(hist->buf + ofs, src, part);
+    memcpy(hist->buf, (char const *)src + part, len - part);
+}
+
+/// Append the text with the next id, returns the id. The text is not kept if larger than the history.
+static unsigned history_push(history_t *hist, char const *text, size_t len)
+{
+    history_entry_t entry = {.id = ++hist->last_id, .len = (unsigned)len};
+    size_t need = sizeof(entry) + len;
+    if (!hist->buf || need > hist->size)
+        return entry.id;
+
+    while (hist->used + need > hist->size) {
+        history_entry_t oldest;
+        history_read(hist, hist->head, &oldest, sizeof(oldest));
+        hist->head = (hist->head + sizeof(oldest) + oldest.len) % hist->size;
+        hist->used -= sizeof(oldest) + oldest.len;
+        hist->count -= 1;
+    }
+    size_t ofs = hist->head + hist->used;
+    history_write(hist, ofs, &entry, sizeof(entry));
+    history_write(hist, ofs + sizeof(entry), text, len);
+    hist->used += need;
+    hist->count += 1;
+    return entry.id;
+}
 
-    return iter;
+/// Returns the id of the oldest event kept, or the next id if empty.
+static unsigned history_first_id(history_t const *hist)
+{
+    if (!hist->count)
+        return hist->last_id + 1;
+    history_entry_t oldest;
+    history_read(hist, hist->head, &oldest, sizeof(oldest));
+    return oldest.id;
 }
 
+// http server
+
+#define KEEP_ALIVE 60 /* seconds */
+
+/// Shared messages queued for a client, the oldest are dropped beyond this.
+#define CLIENT_QUEUE_SIZE 1024
+/// Default bytes of shared messages queued for a client, the oldest are dropped beyond this.
+#ifdef RTL_433_MEMORY_BUDGET_MB
+#define CLIENT_QUEUE_BYTES (RTL_433_MEMORY_BUDGET_MB * 16 * 1024)
+#else
+#define CLIENT_QUEUE_BYTES (1024 * 1024)
+#endif
+/// Messages are copied to the send buffer of a client until it holds this many bytes.
+#define CLIENT_SEND_WINDOW (64 * 1024)
+
+/// Marks a connection whose user_data is a http_client_t.
+#define MG_F_HTTP_CLIENT MG_F_USER_2
+/// Marks a Websocket connection that accepted "permessage-deflate".
+#define MG_F_WS_DEFLATE MG_F_USER_3
+/// Marks a Websocket connection that accepted "permessage-deflate" without context takeover of the server.
+#define MG_F_WS_NO_TAKEOVER MG_F_USER_4
+
+typedef enum {
+    CLIENT_WEBSOCKET,
+    CLIENT_CHUNKED, ///< the "/events" stream
+    CLIENT_SSE,     ///< the "/events" stream as "text/event-stream"
+    CLIENT_PLAIN,   ///< the "/stream" stream
+} client_kind_t;
+
+typedef enum {
+    ENCODING_IDENTITY,
+    ENCODING_GZIP,    ///< "Content-Encoding: gzip" on "/events" and "/stream"
+    ENCODING_DEFLATE, ///< "Content-Encoding: deflate", a zlib stream on "/events" and "/stream"
+    ENCODING_WS,      ///< "permessage-deflate" on a Websocket
+} encoding_t;
+
+struct http_server_context;
+
+/// A connection receiving the events.
+typedef struct {
+    struct mg_connection *nc;
+    struct http_server_context *server;
+    client_kind_t kind;
+    ring_list_t *queue;      ///< shared messages waiting for room in the send buffer
+    unsigned queued;         ///< number of queued messages
+    size_t queued_bytes;     ///< bytes of queued messages
+    size_t max_queued_bytes; ///< most bytes waiting, in the queue and the send buffer
+    unsigned sent;           ///< messages copied to the send buffer
+    unsigned dropped;        ///< messages dropped because the client did not keep up
+    unsigned notify;         ///< dropped messages not yet reported to the client
+    encoding_t encoding;     ///< the compression of the stream
+#ifdef ZLIB
+    int no_takeover;         ///< each text is compressed on its own
+    int follows;             ///< the client got each text of the shared stream since it restarted
+    unsigned next_seq;       ///< the sequence number of the next text on the shared stream, if it follows
+    uint32_t crc;            ///< CRC-32 of the bytes sent compressed, for the gzip trailer
+    uint32_t adler;          ///< Adler-32 of the bytes sent compressed, for the zlib trailer
+    uint32_t isize;          ///< bytes sent compressed, modulo 2^32
+#endif
+} http_client_t;
+
+struct http_call;
+
+/** The server runs on its own event loop and thread, the config is only accessed on the core event loop.
+
+    Requests that read or change the config are queued as calls for the core event loop,
+    the replies and the events are queued back to the server thread.
+    Without threads the server runs on the core event loop and the calls are made directly.
+*/
+struct http_server_context {
+    struct mg_connection *conn;
+    struct mg_serve_http_opts server_opts;
+    r_cfg_t *cfg;
+    struct data_output *output;
+    history_t history;
+    list_t clients;          ///< the http_client_t receiving events
+    size_t client_bytes;     ///< bytes queued for a client before the oldest are dropped
+    unsigned dropped;        ///< messages dropped for all clients
+    struct mg_mgr *mgr;      ///< the event loop of the server
+    event_store_t *store;    ///< the events on disk for "/history", owned by the output, used on the core
+    list_t calls;            ///< the calls waiting for the core, only used on the server thread
+#ifdef ZLIB
+    deflate_stream_t streams[FRAMES]; ///< the shared compressor of each framing
+    deflate_stream_t alone;  ///< compresses texts on their own, reset for each text
+    z_stream inflate;        ///< decompresses the Websocket commands, reset for each message
+    int inflate_ready;
+    struct mbuf scratch;     ///< the framed or decompressed text
+#endif
+#ifdef THREADS
+    struct mg_mgr own_mgr;   ///< the event loop of the server thread
+    struct mg_mgr *core_mgr; ///< the core event loop
+    struct mg_connection *core_nc; ///< dummy connection to receive the calls on the core event loop
+    struct mg_connection *server_nc; ///< dummy connection to receive the replies and events on the server thread
+    pthread_t thread;
+    int threaded;            ///< the server thread is running
+    unsigned exit_thread;    ///< request the server thread to exit
+    pthread_mutex_t lock;    ///< lock for the queues between the threads
+    list_t core_calls;       ///< calls queued for the core event loop
+    list_t done_calls;       ///< calls done by the core, queued for the server thread
+    list_t events;           ///< shared_msg_t of the events queued for the server thread
+#endif
+};
+
 // data helpers that could go into r_api
 
-static data_t *meta_data(r_cfg_t *cfg)
+static data_array_t *clients_data(struct http_server_context *ctx)
+{
+    list_t clients = {0};
+    list_ensure_size(&clients, ctx->clients.len + 1); // account for terminating NULL
+
+    for (void **iter = ctx->clients.elems; iter && *iter; ++iter) {
+        http_client_t *client = *iter;
+        char address[64];
+        mg_sock_addr_to_str(&client->nc->sa, address, sizeof(address), MG_SOCK_STRINGIFY_IP | MG_SOCK_STRINGIFY_PORT);
+        char const *kind = client->kind == CLIENT_WEBSOCKET ? "websocket"
+                : client->kind == CLIENT_CHUNKED ? "events"
+                : client->kind == CLIENT_SSE     ? "event-stream"
+                                                 : "stream";
+        char const *encoding = client->encoding == ENCODING_GZIP ? "gzip"
+                : client->encoding == ENCODING_DEFLATE           ? "deflate"
+                : client->encoding == ENCODING_WS                ? "permessage-deflate"
+                                                                 : "identity";
+        list_push(&clients, data_make(
+                "address",          "", DATA_STRING, address,
+                "kind",             "", DATA_STRING, kind,
+                "encoding",         "", DATA_STRING, encoding,
+                "sent",             "", DATA_INT, (int)client->sent,
+                "lag",              "", DATA_INT, (int)client->queued,
+                "lag_bytes",        "", DATA_INT, (int)(client->queued_bytes + client->nc->send_mbuf.len),
+                "max_lag_bytes",    "", DATA_INT, (int)client->max_queued_bytes,
+                "dropped",          "", DATA_INT, (int)client->dropped,
+                NULL));
+    }
+
+    data_array_t *array = data_array(clients.len, DATA_DATA, clients.elems);
+    list_free_elems(&clients, NULL);
+    return array;
+}
+
+// the device and center frequency covering each planned frequency
+static data_array_t *frequency_plan_data(r_cfg_t *cfg)
+{
+    freq_plan_t const *plan = cfg->freq_plan;
+    list_t covers = {0};
+    list_ensure_size(&covers, freq_plan_wanted_count(plan) + 1); // account for terminating NULL
+
+    for (unsigned i = 0; i < freq_plan_wanted_count(plan); ++i) {
+        unsigned index;
+        unsigned device = freq_plan_device(plan, i, &index);
+        r_cfg_t *rcv    = cfg->plan_receivers.elems[device];
+        uint32_t freq   = freq_plan_wanted(plan, i);
+        uint32_t center = freq_plan_center(plan, device, index);
+        list_push(&covers, data_make(
+                "frequency",        "", DATA_INT, (int)freq,
+                "input",            "", DATA_STRING, rcv->dev_query ? rcv->dev_query : "0",
+                "center_frequency", "", DATA_INT, (int)center,
+                "offset",           "", DATA_INT, (int)freq - (int)center,
+                "hop",              "", DATA_INT, freq_plan_centers(plan, device) > 1,
+                NULL));
+    }
+
+    data_array_t *array = data_array(covers.len, DATA_DATA, covers.elems);
+    list_free_elems(&covers, NULL);
+    return array;
+}
+
+// the clients and the history, taken on the server thread
+static data_t *http_state_data(struct http_server_context *ctx)
 {
     return data_make(
+            "clients", "", DATA_ARRAY, clients_data(ctx),
+            "history", "", DATA_DATA, data_make(
+                    "first_id",     "", DATA_INT, (int)history_first_id(&ctx->history),
+                    "last_id",      "", DATA_INT, (int)ctx->history.last_id,
+                    "events",       "", DATA_INT, (int)ctx->history.count,
+                    "bytes",        "", DATA_INT, (int)ctx->history.used,
+                    "size",         "", DATA_INT, (int)ctx->history.size,
+                    NULL),
+            NULL);
+}
+
+// the settings, taken on the core event loop, followed by the state of the server
+static data_t *meta_data(r_cfg_t *cfg, data_t *http_state)
+{
+    data_array_t *threads = thread_sched_data();
+    data_t *meta = data_make(
             "frequencies", "", DATA_ARRAY, data_array(cfg->frequencies, DATA_INT, cfg->frequency),
+            "frequency_plan", "", DATA_COND, cfg->freq_plan != NULL, DATA_ARRAY, cfg->freq_plan ? frequency_plan_data(cfg) : NULL,
             "hop_times", "", DATA_ARRAY, data_array(cfg->hop_times, DATA_INT, cfg->hop_time),
             "center_frequency", "", DATA_INT, cfg->center_frequency,
             "duration", "", DATA_INT, cfg->duration,
@@ -246,7 +657,9 @@ static data_t *meta_data(r_cfg_t *cfg)
             "report_description", "", DATA_INT, cfg->report_description,
             "report_stats", "", DATA_INT, cfg->report_stats,
             "stats_interval", "", DATA_INT, cfg->stats_interval,
+            "threads", "", DATA_COND, threads != NULL, DATA_ARRAY, threads,
             NULL);
+    return data_prepend(http_state, meta);
 }
 
 static data_t *protocols_data(r_cfg_t *cfg)
@@ -256,7 +669,7 @@ static data_t *protocols_data(r_cfg_t *cfg)
 
     // list regular protocols
     for (int i = 0; i < cfg->num_r_devices; ++i) {
-        r_device *dev = &cfg->devices[i];
+        r_device const *dev = &cfg->devices[i];
 
         int enabled = 0;
         for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
@@ -338,6 +751,7 @@ struct rpc {
     uint32_t val;
     //list_t params;
     char *id;
+    data_t *http_state; ///< the clients and the history for "get_meta"
 };
 
 static int jsoneq(const char *json, jsmntok_t *tok, const char *s)
@@ -515,8 +929,108 @@ static int jsonrpc_parse(rpc_t *rpc, struct mg_str const *json)
     return 0;
 }
 
-static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
+// calls to the core event loop
+
+typedef enum {
+    CALL_RPC,      ///< run a command
+    CALL_META,     ///< send the meta data to a new Websocket client
+    CALL_METRICS,  ///< render the OpenMetrics counters
+    CALL_SPECTRUM, ///< render the spectrum bins
+    CALL_DEVICES,  ///< render the last-known state of the sensors
+    CALL_HISTORY,  ///< render the stored events of a query
+    CALL_PULSES,   ///< write the recorded packages of the query time range
+    CALL_REDECODE, ///< render the events of the recorded packages of the query time range
+} call_kind_t;
+
+/// A request that needs the config, made on the core event loop and replied to on the server thread.
+typedef struct http_call {
+    rpc_t rpc;                ///< the command with an owned method, arg, and id, the reply is captured
+    call_kind_t kind;
+    struct mg_connection *nc; ///< the requesting connection, NULL once it closed, only used on the server thread
+    rpc_response_fn response; ///< sends the reply of the command on the server thread
+    unsigned since;           ///< a new Websocket client resumes after this id
+    unsigned clients;         ///< clients receiving events, for the metrics
+    unsigned dropped;         ///< events dropped for the clients, for the metrics
+    int replied;              ///< the command replied, only the first reply is kept
+    int code;                 ///< the reply code of the command
+    int has_message;          ///< the reply has a message, in the reply buffer
+    int arg;                  ///< the reply value of the command
+    struct mbuf reply;        ///< the reply message of the command, or the rendered text
+    event_query_t query;      ///< the stored events to render, the model and id point to the buffers, or the recorded time range
+    char model[128];
+    char id[64];
+    int64_t next_us;          ///< the time of the first stored event past the limit
+} http_call_t;
+
+// keep the reply of a command made on the core event loop
+static void rpc_response_capture(rpc_t *rpc, int ret_code, char const *message, int arg)
+{
+    http_call_t *call = (http_call_t *)rpc;
+    if (call->replied)
+        return;
+    call->replied     = 1;
+    call->code        = ret_code;
+    call->has_message = message != NULL;
+    call->arg         = arg;
+    if (message)
+        mbuf_append(&call->reply, message, strlen(message) + 1);
+}
+
+static http_call_t *http_call_new(struct mg_connection *nc, call_kind_t kind)
+{
+    http_call_t *call = calloc(1, sizeof(*call));
+    if (!call) {
+        WARN_CALLOC("http_call_new()");
+        return NULL;
+    }
+    call->kind = kind;
+    call->nc   = nc;
+    mbuf_init(&call->reply, 0);
+    return call;
+}
+
+static int copy_str(char **dst, char const *src)
+{
+    if (!src)
+        return 0;
+    *dst = strdup(src);
+    if (!*dst) {
+        WARN_STRDUP("http_call_set_rpc()");
+        return -1;
+    }
+    return 0;
+}
+
+/// Take over a parsed command, the strings are copied.
+static int http_call_set_rpc(http_call_t *call, rpc_t const *rpc)
+{
+    call->response     = rpc->response;
+    call->rpc.response = rpc_response_capture;
+    call->rpc.ver      = rpc->ver;
+    call->rpc.val      = rpc->val;
+    if (copy_str(&call->rpc.method, rpc->method) < 0
+            || copy_str(&call->rpc.arg, rpc->arg) < 0
+            || copy_str(&call->rpc.id, rpc->id) < 0)
+        return -1;
+    return 0;
+}
+
+static void http_call_free(http_call_t *call)
+{
+    free(call->rpc.method);
+    free(call->rpc.arg);
+    free(call->rpc.id);
+    data_free(call->rpc.http_state);
+    mbuf_free(&call->reply);
+    free(call);
+}
+
+static void http_call_post(struct http_server_context *ctx, http_call_t *call);
+
+static void rpc_exec(rpc_t *rpc, struct http_server_context *ctx)
 {
+    r_cfg_t *cfg = ctx->cfg;
+
     if (!rpc || !rpc->method || !*rpc->method) {
         rpc->response(rpc, -1, "Method invalid", 0);
     }
@@ -559,16 +1073,18 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
         rpc->response(rpc, 2, NULL, cfg->conversion_mode);
     }
     else if (!strcmp(rpc->method, "get_stats")) {
-        char buf[20480]; // we expect the stats string to be around 15k bytes.
-        data_t *data = create_report_data(cfg, 2/*report active devices*/);
+        char buf[102400]; // we expect the stats string to be around 15k bytes, around 60k bytes with all devices.
+        // val 3 reports all devices and the decoder cost, otherwise report active devices
+        data_t *data = create_report_data(cfg, rpc->val >= 3 ? 3 : 2);
         // flush_report_data(cfg); // snapshot, do not flush
         data_print_jsons(data, buf, sizeof(buf));
         rpc->response(rpc, 1, buf, 0);
         data_free(data);
     }
     else if (!strcmp(rpc->method, "get_meta")) {
-        char buf[2048]; // we expect the meta string to be around 500 bytes.
-        data_t *data = meta_data(cfg);
+        char buf[16384]; // we expect the meta string to be around 500 bytes, and 200 bytes per client.
+        data_t *data = meta_data(cfg, rpc->http_state);
+        rpc->http_state = NULL;
         data_print_jsons(data, buf, sizeof(buf));
         rpc->response(rpc, 1, buf, 0);
         data_free(data);
@@ -607,6 +1123,8 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
             cfg->verbose_bits = rpc->val;
         else if (!strcasecmp(rpc->arg, "description"))
             cfg->report_description = rpc->val;
+        else if (!strcasecmp(rpc->arg, "stats"))
+            set_report_stats(cfg, rpc->val);
         else
             cfg->report_meta = rpc->val;
         rpc->response(rpc, 0, "Ok", 0);
@@ -664,6 +1182,20 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
         set_sample_rate(cfg, rpc->val);
         rpc->response(rpc, 0, "Ok", 0);
     }
+    else if (!strcmp(rpc->method, "reload")) {
+        cfg->reload_now = 1;
+        rpc->response(rpc, 0, "Ok", 0);
+    }
+    else if (!strcmp(rpc->method, "trace")) {
+        if (!rpc->arg) {
+            stop_trace(cfg);
+            rpc->response(rpc, 0, "Ok", 0);
+        }
+        else if (start_trace(cfg, rpc->arg, rpc->val) < 0)
+            rpc->response(rpc, -1, "Failed to start the trace", 0);
+        else
+            rpc->response(rpc, 0, "Ok", 0);
+    }
 
     // Invalid
     else {
@@ -671,156 +1203,1096 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
     }
 }
 
-// http server
-
-#define KEEP_ALIVE 60 /* seconds */
-
-struct http_server_context {
-    struct mg_connection *conn;
-    struct mg_serve_http_opts server_opts;
-    r_cfg_t *cfg;
-    struct data_output *output;
-    ring_list_t *history;
-};
-
-struct nc_context {
-    int is_chunked;
-};
+// http clients
 
-static void handle_options(struct mg_connection *nc, struct http_message *hm)
+static http_client_t *http_client_of(struct mg_connection *nc)
 {
-    UNUSED(hm);
-    mg_printf(nc,
-            "HTTP/1.1 204 No Content\r\n"
-            "Content-Length: 0\r\n"
-            "Cache-Control: max-age=0, private, must-revalidate\r\n"
-            "Access-Control-Allow-Origin: *\r\n"
-            "Access-Control-Expose-Headers:\r\n"
-            "Access-Control-Allow-Credentials: true\r\n"
-            "Access-Control-Max-Age: 1728000\r\n"
-            "Access-Control-Allow-Headers: Authorization,Content-Type,Accept,Origin,User-Agent,DNT,Cache-Control,X-Mx-ReqToken,Keep-Alive,X-Requested-With,If-Modified-Since,X-CSRF-Token\r\n"
-            "Access-Control-Allow-Methods: GET,POST,PUT,PATCH,DELETE,OPTIONS\r\n"
-            "\r\n");
+    return (nc->flags & MG_F_HTTP_CLIENT) ? nc->user_data : NULL;
 }
 
-static void handle_get(struct mg_connection *nc, struct http_message *hm, char const *buf, unsigned int len)
+static struct http_server_context *http_server_of(struct mg_connection *nc)
 {
-    UNUSED(hm);
-    //mg_send_head(nc, 200, -1, NULL);
-    mg_printf(nc,
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Length: %u\r\n"
-            "\r\n", len);
-    mg_send(nc, buf, (size_t)len);
+    http_client_t *client = http_client_of(nc);
+    return client ? client->server : nc->user_data;
 }
 
-static void handle_redirect(struct mg_connection *nc, struct http_message *hm)
+/// Make the connection a client receiving events, the user_data becomes the client.
+static http_client_t *http_client_new(struct mg_connection *nc, client_kind_t kind)
 {
-    // get the host header
-    struct mg_str host = {0};
-    for (int i = 0; i < MG_MAX_HTTP_HEADERS && hm->header_names[i].len > 0; i++) {
-        // struct mg_str hn = hm->header_names[i];
-        // struct mg_str hv = hm->header_values[i];
-        // fprintf(stderr, "Header: %.*s: %.*s\n", (int)hn.len, hn.p, (int)hv.len, hv.p);
-        if (mg_vcasecmp(&hm->header_names[i], "Host") == 0) {
-            host = hm->header_values[i];
-            break;
-        }
+    struct http_server_context *ctx = nc->user_data;
+
+    http_client_t *client = calloc(1, sizeof(*client));
+    if (!client) {
+        WARN_CALLOC("http_client_new()");
+        return NULL;
+    }
+    client->queue = ring_list_new(CLIENT_QUEUE_SIZE);
+    if (!client->queue) {
+        free(client);
+        return NULL;
     }
+    client->nc     = nc;
+    client->server = ctx;
+    client->kind   = kind;
 
-    mg_printf(nc, "%s%s%.*s%s\r\n",
-            "HTTP/1.1 307 Temporary Redirect\r\n",
-            "Location: http://triq.org/rxui/#",
-            (int)host.len, host.p,
-            "\r\n\r\n");
+    list_push(&ctx->clients, client);
+    nc->user_data = client;
+    nc->flags |= MG_F_HTTP_CLIENT;
+
+    return client;
 }
 
-static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm)
+static void http_client_free(http_client_t *client)
 {
-    if (mg_vcmp(&hm->method, "GET") != 0) {
-        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+    if (!client)
         return;
+
+    list_t *clients = &client->server->clients;
+    for (size_t i = 0; i < clients->len; ++i) {
+        if (clients->elems[i] == client) {
+            list_remove(clients, i, NULL);
+            break;
+        }
     }
+    client->nc->user_data = client->server;
+    client->nc->flags &= ~MG_F_HTTP_CLIENT;
 
-    struct http_server_context *ctx = nc->user_data;
-    r_cfg_t *cfg = ctx->cfg;
+    shared_msg_t *msg;
+    while ((msg = ring_list_shift(client->queue)))
+        shared_msg_release(msg);
+    ring_list_free(client->queue);
+    free(client);
+}
 
-    time_t now;
-    time(&now);
+#ifdef ZLIB
 
-    char buf[2000];
-    int len = snprintf(buf, sizeof(buf),
-            "# TYPE uptime_seconds counter\n"
-            "# UNIT uptime_seconds seconds\n"
-            "# HELP uptime_seconds Program uptime.\n"
-            "uptime_seconds_total %.1f\n"
-            "uptime_seconds_created %.1f\n"
-            "# TYPE decoder_enabled gauge\n"
-            "# HELP decoder_enabled Number of enabled decoders.\n"
-            "decoder_enabled %u\n"
-            "# TYPE input_uptime_seconds counter\n"
-            "# UNIT input_uptime_seconds seconds\n"
-            "# HELP input_uptime_seconds SDR Receiver uptime.\n"
-            "input_uptime_seconds_total %.1f\n"
-            "input_uptime_seconds_created %.1f\n"
-            "# TYPE input_count_frames counter\n"
-            "# UNIT input_count_frames frames\n"
-            "# HELP input_count_frames Number of SDR frames received.\n"
-            "input_count_frames_total %u\n"
-            "# TYPE input_squelch_frames counter\n"
-            "# UNIT input_squelch_frames frames\n"
-            "# HELP input_squelch_frames Number of SDR frames skipped by squelch.\n"
-            "input_squelch_frames_total %u\n"
-            "# TYPE input_ook_frames counter\n"
-            "# UNIT input_ook_frames frames\n"
-            "# HELP input_ook_frames Number of SDR frames with OOK demodulation.\n"
-            "input_ook_frames_total %u\n"
-            "# TYPE input_fsk_frames counter\n"
-            "# UNIT input_fsk_frames frames\n"
-            "# HELP input_fsk_frames Number of SDR frames with FSK demodulation.\n"
-            "input_fsk_frames_total %u\n"
-            "# TYPE input_event_frames counter\n"
-            "# UNIT input_event_frames frames\n"
-            "# HELP input_event_frames Number of SDR frames with decode events.\n"
-            "input_event_frames_total %u\n"
-            "# EOF\n",
-            (float)(now - cfg->running_since), // uptime_seconds_total,
-            (float)cfg->running_since,         // uptime_seconds_created,
-            (unsigned)cfg->demod->r_devs.len,  // decoder_enabled,
-            (float)(now - cfg->sdr_since),     // input_uptime_seconds_total,
-            (float)cfg->sdr_since,             // input_uptime_seconds_created,
-            cfg->total_frames_count,           // input_count_frames_total,
-            cfg->total_frames_squelch,         // input_squelch_frames_total,
-            cfg->total_frames_ook,             // input_ook_frames_total,
-            cfg->total_frames_fsk,             // input_fsk_frames_total,
-            cfg->total_frames_events);         // input_event_frames_total,
+static frame_kind_t http_client_frame(http_client_t const *client)
+{
+    return client->kind == CLIENT_WEBSOCKET ? FRAME_WEBSOCKET
+            : client->kind == CLIENT_SSE    ? FRAME_SSE
+                                            : FRAME_LINE;
+}
 
-    mg_printf(nc,
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Length: %u\r\n"
-            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
-            "\r\n",
-            len);
-    mg_send(nc, buf, (size_t)len);
-    nc->flags |= MG_F_SEND_AND_CLOSE;
+/// Frame the text into the scratch buffer of the server, an id of 0 is not framed.
+static void http_frame_text(struct http_server_context *ctx, frame_kind_t frame, unsigned id, char const *text, size_t len)
+{
+    struct mbuf *mb = &ctx->scratch;
+    mb->len         = 0;
+    if (frame == FRAME_SSE) {
+        char prefix[32];
+        int n = id ? snprintf(prefix, sizeof(prefix), "id: %u\ndata: ", id) : snprintf(prefix, sizeof(prefix), "data: ");
+        mbuf_append(mb, prefix, (size_t)n);
+    }
+    mbuf_append(mb, text, len);
+    if (frame == FRAME_SSE)
+        mbuf_append(mb, "\n\n", 2);
+    else if (frame == FRAME_LINE)
+        mbuf_append(mb, "\r\n", 2);
 }
 
-// reply to ws command
-static void rpc_response_ws(rpc_t *rpc, int ret_code, char const *message, int arg)
+// the compressor state is accounted as "http" memory
+static voidpf zlib_get(voidpf opaque, uInt items, uInt size)
 {
-    if (ret_code < 0) {
-        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
-                "{\"error\": {\"code\": %d, \"message\": \"%s\"}}",
-                ret_code, message);
+    (void)opaque;
+    return mem_get(MEM_TAG_HTTP, (size_t)items * size);
+}
+
+static void zlib_put(voidpf opaque, voidpf ptr)
+{
+    (void)opaque;
+    mem_put(MEM_TAG_HTTP, ptr);
+}
+
+/// Compress the bytes on the stream, with @p restart nothing refers back to earlier texts, NULL on failure.
+static deflated_t *stream_deflate(deflate_stream_t *stream, int restart, void const *raw, size_t raw_len)
+{
+    z_stream *zs = &stream->zs;
+    if (!stream->ready) {
+        zs->zalloc = zlib_get;
+        zs->zfree  = zlib_put;
+        if (deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            print_log(LOG_WARNING, __func__, "deflateInit2() failed");
+            return NULL;
+        }
+        stream->ready   = 1;
+        stream->restart = 1;
     }
-    else if (ret_code == 0 && message) {
-        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
-                "{\"result\": \"%s\"}",
-                message);
+
+    // the bound is for a finished stream, a full flush and a sync flush add an empty stored block each
+    size_t bound    = deflateBound(zs, (uLong)raw_len) + 16;
+    deflated_t *out = mem_get(MEM_TAG_HTTP, sizeof(*out) + bound);
+    if (!out) {
+        WARN_MALLOC("stream_deflate()");
+        return NULL;
     }
-    else if (ret_code == 0) {
-        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
-                "{\"result\": null}");
+    zs->next_out  = out->buf;
+    zs->avail_out = (uInt)bound;
+    int ret       = Z_OK;
+    if (restart && !stream->restart) {
+        zs->next_in  = Z_NULL;
+        zs->avail_in = 0;
+        ret          = deflate(zs, Z_FULL_FLUSH);
+    }
+    if (ret == Z_OK) {
+        zs->next_in  = (Bytef *)raw;
+        zs->avail_in = (uInt)raw_len;
+        ret          = deflate(zs, Z_SYNC_FLUSH);
+    }
+    if (ret != Z_OK || zs->avail_in || !zs->avail_out) {
+        // the stream starts over, the texts sent refer to nothing after
+        deflateReset(zs);
+        stream->restart = 1;
+        mem_put(MEM_TAG_HTTP, out);
+        return NULL;
+    }
+    out->len        = bound - zs->avail_out;
+    out->raw_len    = raw_len;
+    out->crc        = (uint32_t)crc32(0L, raw, (uInt)raw_len);
+    out->adler      = (uint32_t)adler32(1L, raw, (uInt)raw_len);
+    out->seq        = stream->seq++;
+    out->restart    = restart || stream->restart;
+    stream->restart = 0;
+    return out;
+}
+
+/// Compress the bytes on their own, the result can be appended to the stream of any client, NULL on failure.
+static deflated_t *http_deflate_alone(struct http_server_context *ctx, void const *raw, size_t raw_len)
+{
+    deflate_stream_t *stream = &ctx->alone;
+    if (stream->ready) {
+        deflateReset(&stream->zs);
+        stream->restart = 1;
+    }
+    return stream_deflate(stream, 1, raw, raw_len);
+}
+
+/// Compress the text on the shared stream of each framing the compressed clients use.
+static void http_deflate_msg(struct http_server_context *ctx, shared_msg_t *msg)
+{
+    int used[FRAMES]    = {0};
+    int restart[FRAMES] = {0};
+    for (void **iter = ctx->clients.elems; iter && *iter; ++iter) {
+        http_client_t *client = *iter;
+        if (client->encoding == ENCODING_IDENTITY || client->no_takeover)
+            continue;
+        frame_kind_t frame = http_client_frame(client);
+        used[frame]        = 1;
+        restart[frame] |= !client->follows;
+    }
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        if (!used[frame])
+            continue;
+        http_frame_text(ctx, (frame_kind_t)frame, msg->id, msg->text, msg->len);
+        msg->deflated[frame] = stream_deflate(&ctx->streams[frame], restart[frame], ctx->scratch.buf, ctx->scratch.len);
+    }
+}
+
+/// Decompress a Websocket message into the scratch buffer of the server, returns 0 on success.
+static int http_inflate(struct http_server_context *ctx, unsigned char const *data, size_t len)
+{
+    z_stream *zs = &ctx->inflate;
+    if (!ctx->inflate_ready) {
+        zs->zalloc = zlib_get;
+        zs->zfree  = zlib_put;
+        if (inflateInit2(zs, -MAX_WBITS) != Z_OK) {
+            print_log(LOG_WARNING, __func__, "inflateInit2() failed");
+            return -1;
+        }
+        ctx->inflate_ready = 1;
+    }
+
+    // "permessage-deflate" strips the empty stored block of the sync flush from each message
+    static unsigned char const tail[4] = {0x00, 0x00, 0xff, 0xff};
+    struct mbuf *mb = &ctx->scratch;
+    mb->len         = 0;
+    int ret         = Z_OK;
+    for (int pass = 0; pass < 2 && (ret == Z_OK || ret == Z_BUF_ERROR); ++pass) {
+        zs->next_in  = (Bytef *)(pass ? tail : data);
+        zs->avail_in = pass ? sizeof(tail) : (uInt)len;
+        do {
+            unsigned char buf[1024];
+            zs->next_out  = buf;
+            zs->avail_out = sizeof(buf);
+            ret           = inflate(zs, Z_SYNC_FLUSH);
+            mbuf_append(mb, buf, sizeof(buf) - zs->avail_out);
+        } while (ret == Z_OK && zs->avail_out == 0 && mb->len <= MG_MAX_HTTP_REQUEST_SIZE);
+    }
+    inflateReset(zs);
+    if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END)
+        return -1;
+    return mb->len <= MG_MAX_HTTP_REQUEST_SIZE ? 0 : -1; // commands are short
+}
+
+/// Send compressed bytes on the stream of the client.
+static void http_client_send_deflated(http_client_t *client, deflated_t const *out)
+{
+    struct mg_connection *nc = client->nc;
+
+    if (client->encoding == ENCODING_WS) {
+        // the empty stored block of the sync flush is implied
+        mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT | WEBSOCKET_COMPRESSED, out->buf, out->len - 4);
+        return;
+    }
+
+    client->crc   = (uint32_t)crc32_combine(client->crc, out->crc, (z_off_t)out->raw_len);
+    client->adler = (uint32_t)adler32_combine(client->adler, out->adler, (z_off_t)out->raw_len);
+    client->isize += (uint32_t)out->raw_len;
+    if (client->kind == CLIENT_PLAIN)
+        mg_send(nc, out->buf, out->len);
+    else
+        mg_send_http_chunk(nc, (char const *)out->buf, out->len);
+    mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+}
+
+/// Compress the bytes for the client alone and send them, e.g. a notice or a keep alive.
+static void http_client_deflate(http_client_t *client, void const *raw, size_t raw_len)
+{
+    deflated_t *out = http_deflate_alone(client->server, raw, raw_len);
+    if (!out)
+        return; // NOTE: skip output on alloc failure.
+    client->follows = 0;
+    http_client_send_deflated(client, out);
+    mem_put(MEM_TAG_HTTP, out);
+}
+
+/// Start the compressed stream of the client, the HTTP streams get the gzip or zlib header.
+static void http_client_encode(http_client_t *client, encoding_t encoding)
+{
+    client->encoding = encoding;
+    client->follows  = 0;
+    client->crc      = 0;
+    client->adler    = 1;
+    client->isize    = 0;
+    if (encoding != ENCODING_GZIP && encoding != ENCODING_DEFLATE)
+        return;
+
+    // a gzip header without name and time, from an unknown OS; a zlib header for a 32k window
+    static unsigned char const gzip_header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    static unsigned char const zlib_header[2]  = {0x78, 0x9c};
+    unsigned char const *header = encoding == ENCODING_GZIP ? gzip_header : zlib_header;
+    size_t header_len           = encoding == ENCODING_GZIP ? sizeof(gzip_header) : sizeof(zlib_header);
+    if (client->kind == CLIENT_PLAIN)
+        mg_send(client->nc, header, header_len);
+    else
+        mg_send_http_chunk(client->nc, (char const *)header, header_len);
+}
+
+/// End the compressed HTTP stream of the client with a final block and the gzip or zlib trailer.
+static void http_client_end_encoding(http_client_t *client)
+{
+    if (client->encoding != ENCODING_GZIP && client->encoding != ENCODING_DEFLATE)
+        return;
+
+    unsigned char end[10] = {0x03, 0x00}; // an empty final block with fixed codes
+    size_t len            = 2;
+    if (client->encoding == ENCODING_GZIP) {
+        for (int i = 0; i < 4; ++i)
+            end[len++] = (unsigned char)(client->crc >> (8 * i));
+        for (int i = 0; i < 4; ++i)
+            end[len++] = (unsigned char)(client->isize >> (8 * i));
+    }
+    else {
+        for (int i = 3; i >= 0; --i)
+            end[len++] = (unsigned char)(client->adler >> (8 * i));
+    }
+    if (client->kind == CLIENT_PLAIN)
+        mg_send(client->nc, end, len);
+    else
+        mg_send_http_chunk(client->nc, (char const *)end, len);
+}
+
+#endif /* ZLIB */
+
+/// Send the text framed for the client, an id of 0 is not sent.
+static void http_client_send(http_client_t *client, unsigned id, char const *text, size_t len)
+{
+    struct mg_connection *nc = client->nc;
+
+#ifdef ZLIB
+    if (client->encoding != ENCODING_IDENTITY) {
+        struct http_server_context *ctx = client->server;
+        http_frame_text(ctx, http_client_frame(client), id, text, len);
+        http_client_deflate(client, ctx->scratch.buf, ctx->scratch.len);
+        return;
+    }
+#endif
+
+    if (client->kind == CLIENT_WEBSOCKET) {
+        mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, text, len);
+    }
+    else if (client->kind == CLIENT_SSE) {
+        if (id)
+            mg_printf_http_chunk(nc, "id: %u\ndata: ", id);
+        else
+            mg_send_http_chunk(nc, "data: ", 6);
+        mg_send_http_chunk(nc, text, len);
+        mg_send_http_chunk(nc, "\n\n", 2);
+        mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+    }
+    else if (client->kind == CLIENT_CHUNKED) {
+        mg_send_http_chunk(nc, text, len);
+        mg_send_http_chunk(nc, "\r\n", 2);
+        mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+    }
+    else {
+        mg_send(nc, text, len);
+        mg_send(nc, "\r\n", 2);
+        mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+    }
+}
+
+/// Send a shared message, compressed once for all clients with the same framing and position on the stream.
+static void http_client_send_msg(http_client_t *client, shared_msg_t *msg)
+{
+#ifdef ZLIB
+    if (client->encoding != ENCODING_IDENTITY) {
+        struct http_server_context *ctx = client->server;
+        frame_kind_t frame              = http_client_frame(client);
+        deflated_t *out                 = msg->deflated[frame];
+        if (out && !client->no_takeover && (out->restart || (client->follows && out->seq == client->next_seq))) {
+            client->follows  = 1;
+            client->next_seq = out->seq + 1;
+        }
+        else {
+            if (!msg->alone[frame]) {
+                http_frame_text(ctx, frame, msg->id, msg->text, msg->len);
+                msg->alone[frame] = http_deflate_alone(ctx, ctx->scratch.buf, ctx->scratch.len);
+            }
+            out             = msg->alone[frame];
+            client->follows = 0;
+        }
+        if (out)
+            http_client_send_deflated(client, out);
+        return; // NOTE: skip output on alloc failure.
+    }
+#endif
+    http_client_send(client, msg->id, msg->text, msg->len);
+}
+
+/// Copy queued messages to the send buffer while it has room.
+static void http_client_write(http_client_t *client)
+{
+    struct mg_connection *nc = client->nc;
+
+    while (nc->send_mbuf.len < CLIENT_SEND_WINDOW) {
+        if (client->notify) {
+            // tell the client about the gap in events
+            char notice[40];
+            int len = snprintf(notice, sizeof(notice), "{\"dropped\" : %u}", client->notify);
+            client->notify = 0;
+            http_client_send(client, 0, notice, len);
+            continue;
+        }
+        shared_msg_t *msg = ring_list_shift(client->queue);
+        if (!msg)
+            break;
+        client->queued -= 1;
+        client->queued_bytes -= msg->len;
+        http_client_send_msg(client, msg);
+        shared_msg_release(msg);
+        client->sent += 1;
+    }
+}
+
+/// Queue a shared message, drops the oldest messages if the client has too many bytes queued.
+static void http_client_push(http_client_t *client, shared_msg_t *msg)
+{
+    size_t limit = client->server->client_bytes;
+    while (client->queued > 0
+            && (client->queued_bytes + msg->len > limit || client->queued >= CLIENT_QUEUE_SIZE - 1)) {
+        shared_msg_t *oldest = ring_list_shift(client->queue);
+        client->queued -= 1;
+        client->queued_bytes -= oldest->len;
+        shared_msg_release(oldest);
+        client->dropped += 1;
+        client->server->dropped += 1;
+        client->notify += 1;
+    }
+    ring_list_push(client->queue, shared_msg_retain(msg));
+    client->queued += 1;
+    client->queued_bytes += msg->len;
+
+    http_client_write(client);
+
+    size_t lag = client->queued_bytes + client->nc->send_mbuf.len;
+    if (client->max_queued_bytes < lag)
+        client->max_queued_bytes = lag;
+}
+
+/// Close the client with the most bytes waiting if the queues or the send buffers are over their memory limit.
+static void http_clients_shed(struct http_server_context *ctx)
+{
+    int http    = mem_acct_over(MEM_TAG_HTTP);
+    int network = mem_acct_over(MEM_TAG_NETWORK);
+    if (!http && !network)
+        return;
+
+    http_client_t *slowest = NULL;
+    size_t most = 0;
+    for (void **iter = ctx->clients.elems; iter && *iter; ++iter) {
+        http_client_t *client = *iter;
+        if (client->nc->flags & MG_F_CLOSE_IMMEDIATELY)
+            return; // wait for the client shed before to be closed
+        size_t lag = client->queued_bytes + client->nc->send_mbuf.len;
+        if (lag > most) {
+            most    = lag;
+            slowest = client;
+        }
+    }
+    if (!slowest)
+        return;
+
+    // the queue goes now, the send buffer once the connection is closed
+    shared_msg_t *msg;
+    while ((msg = ring_list_shift(slowest->queue)))
+        shared_msg_release(msg);
+    slowest->queued       = 0;
+    slowest->queued_bytes = 0;
+    slowest->nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+    mem_acct_shed(http ? MEM_TAG_HTTP : MEM_TAG_NETWORK);
+}
+
+/// Queue the events from the history after the since id up to the until id, missing events are reported as dropped.
+static void http_client_replay(http_client_t *client, unsigned since, unsigned until)
+{
+    history_t *hist = &client->server->history;
+    unsigned first  = history_first_id(hist);
+
+    if ((int)(since - hist->last_id) > 0) {
+        since = first - 1; // an id from before a restart, replay all
+    }
+    else if ((int)(first - 1 - since) > 0) {
+        client->notify += first - 1 - since; // some events are not kept
+    }
+
+    size_t ofs = hist->head;
+    for (unsigned i = 0; i < hist->count; ++i) {
+        history_entry_t entry;
+        history_read(hist, ofs, &entry, sizeof(entry));
+        ofs += sizeof(entry);
+        if ((int)(entry.id - until) > 0)
+            break;
+        if ((int)(entry.id - since) > 0) {
+            shared_msg_t *msg = shared_msg_new(NULL, entry.len);
+            if (!msg)
+                break; // NOTE: skip replay on alloc failure.
+            history_read(hist, ofs, msg->text, entry.len);
+            msg->text[entry.len] = '\0';
+            msg->id              = entry.id;
+            http_client_push(client, msg);
+            shared_msg_release(msg);
+        }
+        ofs += entry.len;
+    }
+}
+
+/// Get the id to resume after from a Last-Event-ID header or a "since" query variable.
+static int http_resume_id(struct http_message *hm, unsigned *id)
+{
+    char buf[20];
+    struct mg_str *hdr = mg_get_http_header(hm, "Last-Event-ID");
+    if (hdr && hdr->len > 0 && hdr->len < sizeof(buf)) {
+        memcpy(buf, hdr->p, hdr->len);
+        buf[hdr->len] = '\0';
+    }
+    else if (mg_get_http_var(&hm->query_string, "since", buf, sizeof(buf)) <= 0) {
+        return 0;
+    }
+
+    char *endptr = NULL;
+    *id = (unsigned)strtoul(buf, &endptr, 10);
+    return endptr != buf;
+}
+
+#ifdef ZLIB
+/// Split off the next item of a header list at the separator, trimmed, returns 0 at the end.
+static int header_next(struct mg_str *list, char sep, struct mg_str *item)
+{
+    while (list->len && (*list->p == sep || *list->p == ' ' || *list->p == '\t')) {
+        list->p++;
+        list->len--;
+    }
+    if (!list->len)
+        return 0;
+    char const *end = memchr(list->p, sep, list->len);
+    size_t len      = end ? (size_t)(end - list->p) : list->len;
+    item->p         = list->p;
+    item->len       = len;
+    list->p += len;
+    list->len -= len;
+    while (item->len && (item->p[item->len - 1] == ' ' || item->p[item->len - 1] == '\t'))
+        item->len--;
+    return 1;
+}
+#endif
+
+/// Choose the compression of an event stream from the Accept-Encoding header, gzip is preferred.
+static encoding_t http_accept_encoding(struct http_message *hm)
+{
+#ifdef ZLIB
+    struct mg_str *hdr = mg_get_http_header(hm, "Accept-Encoding");
+    if (!hdr)
+        return ENCODING_IDENTITY;
+
+    encoding_t encoding = ENCODING_IDENTITY;
+    struct mg_str list  = *hdr;
+    struct mg_str coding;
+    while (header_next(&list, ',', &coding)) {
+        struct mg_str name;
+        struct mg_str param;
+        if (!header_next(&coding, ';', &name))
+            continue;
+        // a quality of 0 refuses the coding
+        int refused = 0;
+        while (header_next(&coding, ';', &param)) {
+            char q[8] = {0};
+            if (param.len > 2 && param.len - 2 < sizeof(q) && !mg_ncasecmp(param.p, "q=", 2)) {
+                memcpy(q, param.p + 2, param.len - 2);
+                refused = atof(q) <= 0.0;
+            }
+        }
+        if (refused)
+            continue;
+        if (!mg_vcasecmp(&name, "gzip"))
+            encoding = ENCODING_GZIP;
+        else if (!mg_vcasecmp(&name, "deflate") && encoding == ENCODING_IDENTITY)
+            encoding = ENCODING_DEFLATE;
+    }
+    return encoding;
+#else
+    UNUSED(hm);
+    return ENCODING_IDENTITY;
+#endif
+}
+
+#ifdef ZLIB
+/** Check the Sec-WebSocket-Extensions header for an acceptable "permessage-deflate" offer.
+
+    The commands are decompressed with a full window, an offer limiting the window of the server is declined.
+
+    @return 0 if there is none, 1 to accept, 2 to accept without context takeover of the server
+*/
+static int http_accept_ws_deflate(struct http_message *hm)
+{
+    struct mg_str *hdr = mg_get_http_header(hm, "Sec-WebSocket-Extensions");
+    if (!hdr)
+        return 0;
+
+    struct mg_str list = *hdr;
+    struct mg_str offer;
+    while (header_next(&list, ',', &offer)) {
+        struct mg_str name;
+        struct mg_str param;
+        if (!header_next(&offer, ';', &name) || mg_vcasecmp(&name, "permessage-deflate"))
+            continue;
+        int ok          = 1;
+        int no_takeover = 0;
+        while (ok && header_next(&offer, ';', &param)) {
+            no_takeover |= !mg_vcasecmp(&param, "server_no_context_takeover");
+            ok = !mg_vcasecmp(&param, "server_no_context_takeover")
+                    || !mg_vcasecmp(&param, "client_no_context_takeover")
+                    || (param.len >= 22 && !mg_ncasecmp(param.p, "client_max_window_bits", 22))
+                    || !mg_vcasecmp(&param, "server_max_window_bits=15");
+        }
+        if (ok)
+            return no_takeover ? 2 : 1;
+    }
+    return 0;
+}
+#endif
+
+// http handlers
+
+static void handle_options(struct mg_connection *nc, struct http_message *hm)
+{
+    UNUSED(hm);
+    mg_printf(nc,
+            "HTTP/1.1 204 No Content\r\n"
+            "Content-Length: 0\r\n"
+            "Cache-Control: max-age=0, private, must-revalidate\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "Access-Control-Expose-Headers:\r\n"
+            "Access-Control-Allow-Credentials: true\r\n"
+            "Access-Control-Max-Age: 1728000\r\n"
+            "Access-Control-Allow-Headers: Authorization,Content-Type,Accept,Origin,User-Agent,DNT,Cache-Control,X-Mx-ReqToken,Keep-Alive,X-Requested-With,If-Modified-Since,X-CSRF-Token\r\n"
+            "Access-Control-Allow-Methods: GET,POST,PUT,PATCH,DELETE,OPTIONS\r\n"
+            "\r\n");
+}
+
+static void handle_get(struct mg_connection *nc, struct http_message *hm, char const *buf, unsigned int len)
+{
+    UNUSED(hm);
+    //mg_send_head(nc, 200, -1, NULL);
+    mg_printf(nc,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: %u\r\n"
+            "\r\n", len);
+    mg_send(nc, buf, (size_t)len);
+}
+
+static void handle_redirect(struct mg_connection *nc, struct http_message *hm)
+{
+    // get the host header
+    struct mg_str host = {0};
+    for (int i = 0; i < MG_MAX_HTTP_HEADERS && hm->header_names[i].len > 0; i++) {
+        // struct mg_str hn = hm->header_names[i];
+        // struct mg_str hv = hm->header_values[i];
+        // fprintf(stderr, "Header: %.*s: %.*s\n", (int)hn.len, hn.p, (int)hv.len, hv.p);
+        if (mg_vcasecmp(&hm->header_names[i], "Host") == 0) {
+            host = hm->header_values[i];
+            break;
+        }
+    }
+
+    mg_printf(nc, "%s%s%.*s%s\r\n",
+            "HTTP/1.1 307 Temporary Redirect\r\n",
+            "Location: http://triq.org/rxui/#",
+            (int)host.len, host.p,
+            "\r\n\r\n");
+}
+
+// openmetrics helpers
+
+static void metrics_printf(struct mbuf *mb, char const *fmt, ...)
+{
+    char mem[256];
+    char *buf = mem;
+    va_list ap;
+    va_start(ap, fmt);
+    int len = mg_avprintf(&buf, sizeof(mem), fmt, ap);
+    va_end(ap);
+    if (len > 0)
+        mbuf_append(mb, buf, (size_t)len);
+    if (buf != mem)
+        free(buf);
+}
+
+static void metrics_header(struct mbuf *mb, char const *name, char const *type, char const *unit, char const *help)
+{
+    metrics_printf(mb, "# TYPE %s %s\n", name, type);
+    if (unit)
+        metrics_printf(mb, "# UNIT %s %s\n", name, unit);
+    metrics_printf(mb, "# HELP %s %s\n", name, help);
+}
+
+/// Escape a label value, the backslash, double-quote, and line feed.
+static char const *metrics_label(char *buf, size_t size, char const *str)
+{
+    size_t n = 0;
+    for (; str && *str && n + 3 < size; ++str) {
+        if (*str == '\\' || *str == '"' || *str == '\n')
+            buf[n++] = '\\';
+        buf[n++] = *str == '\n' ? 'n' : *str;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+enum decoder_metric {
+    DECODER_EVENTS,
+    DECODER_OK,
+    DECODER_MESSAGES,
+    DECODER_DUPLICATES,
+    DECODER_SLICE_CALLS,
+    DECODER_SLICE_SECONDS,
+    DECODER_DECODE_CALLS,
+    DECODER_DECODE_SECONDS,
+};
+
+static struct {
+    char const *name;
+    char const *unit;
+    char const *help;
+} const decoder_metrics[] = {
+        {"decoder_events", NULL, "Number of decoder runs with events."},
+        {"decoder_ok", NULL, "Number of decoder runs with a successful decode."},
+        {"decoder_messages", NULL, "Number of messages decoded."},
+        {"decoder_duplicates", NULL, "Number of repeated messages dropped."},
+        {"decoder_slice_calls", NULL, "Number of slicer runs, with stats level 3."},
+        {"decoder_slice_seconds", "seconds", "Time spent in the slicer, with stats level 3."},
+        {"decoder_decode_calls", NULL, "Number of decode function calls, with stats level 3."},
+        {"decoder_decode_seconds", "seconds", "Time spent in the decode function, with stats level 3."},
+};
+
+static int const latency_bounds_ms[LATENCY_HIST_BINS - 1] = LATENCY_HIST_BOUNDS_MS;
+
+static char const *const decoder_fails[] = {
+        "fail_other",
+        "abort_length",
+        "abort_early",
+        "fail_mic",
+        "fail_sanity",
+};
+
+// Renders the counters directly from the config, the decoder, timing, and output counters restart with each stats report.
+// Called on the core event loop, the clients and dropped events are taken on the server thread.
+static void render_metrics(r_cfg_t *cfg, struct mbuf *mb, unsigned clients, unsigned dropped)
+{
+    list_t *r_devs = &cfg->demod->r_devs;
+
+    time_t now;
+    time(&now);
+    metrics_printf(mb,
+            "# TYPE uptime_seconds counter\n"
+            "# UNIT uptime_seconds seconds\n"
+            "# HELP uptime_seconds Program uptime.\n"
+            "uptime_seconds_total %.1f\n"
+            "uptime_seconds_created %.1f\n"
+            "# TYPE decoder_enabled gauge\n"
+            "# HELP decoder_enabled Number of enabled decoders.\n"
+            "decoder_enabled %u\n"
+            "# TYPE input_uptime_seconds counter\n"
+            "# UNIT input_uptime_seconds seconds\n"
+            "# HELP input_uptime_seconds SDR Receiver uptime.\n"
+            "input_uptime_seconds_total %.1f\n"
+            "input_uptime_seconds_created %.1f\n"
+            "# TYPE input_count_frames counter\n"
+            "# UNIT input_count_frames frames\n"
+            "# HELP input_count_frames Number of SDR frames received.\n"
+            "input_count_frames_total %u\n"
+            "# TYPE input_squelch_frames counter\n"
+            "# UNIT input_squelch_frames frames\n"
+            "# HELP input_squelch_frames Number of SDR frames skipped by squelch.\n"
+            "input_squelch_frames_total %u\n"
+            "# TYPE input_prefilter_frames counter\n"
+            "# UNIT input_prefilter_frames frames\n"
+            "# HELP input_prefilter_frames Number of SDR frames skipped by squelch on the level estimate alone.\n"
+            "input_prefilter_frames_total %u\n"
+            "# TYPE input_ook_frames counter\n"
+            "# UNIT input_ook_frames frames\n"
+            "# HELP input_ook_frames Number of SDR frames with OOK demodulation.\n"
+            "input_ook_frames_total %u\n"
+            "# TYPE input_fsk_frames counter\n"
+            "# UNIT input_fsk_frames frames\n"
+            "# HELP input_fsk_frames Number of SDR frames with FSK demodulation.\n"
+            "input_fsk_frames_total %u\n"
+            "# TYPE input_event_frames counter\n"
+            "# UNIT input_event_frames frames\n"
+            "# HELP input_event_frames Number of SDR frames with decode events.\n"
+            "input_event_frames_total %u\n"
+            "# TYPE input_dropped_frames counter\n"
+            "# UNIT input_dropped_frames frames\n"
+            "# HELP input_dropped_frames Number of SDR frames dropped by a slow consumer.\n"
+            "input_dropped_frames_total %u\n"
+            "# TYPE input_overflows counter\n"
+            "# HELP input_overflows Number of SDR stream overflows.\n"
+            "input_overflows_total %u\n",
+            (double)(now - cfg->running_since), // uptime_seconds_total,
+            (double)cfg->running_since,        // uptime_seconds_created,
+            (unsigned)r_devs->len,             // decoder_enabled,
+            (double)(now - cfg->sdr_since),    // input_uptime_seconds_total,
+            (double)cfg->sdr_since,            // input_uptime_seconds_created,
+            cfg->total_frames_count,           // input_count_frames_total,
+            cfg->total_frames_squelch,         // input_squelch_frames_total,
+            cfg->total_frames_prefilter,       // input_prefilter_frames_total,
+            cfg->total_frames_ook,             // input_ook_frames_total,
+            cfg->total_frames_fsk,             // input_fsk_frames_total,
+            cfg->total_frames_events,          // input_event_frames_total,
+            cfg->total_frames_dropped,         // input_dropped_frames_total,
+            cfg->total_frames_overflow);       // input_overflows_total,
+
+    // counters of the stats report interval
+    double since = (double)cfg->frames_since;
+
+    metrics_header(mb, "input_baseband_seconds", "counter", "seconds", "Time spent in the AM, low pass, and FM demod.");
+    metrics_printf(mb, "input_baseband_seconds_total %.6f\n", cfg->frames_baseband_us / 1e6);
+    metrics_printf(mb, "input_baseband_seconds_created %.1f\n", since);
+
+    metrics_header(mb, "input_detect_seconds", "counter", "seconds", "Time spent in the pulse detector.");
+    metrics_printf(mb, "input_detect_seconds_total %.6f\n", cfg->frames_detect_ns / 1e9);
+    metrics_printf(mb, "input_detect_seconds_created %.1f\n", since);
+
+    metrics_header(mb, "input_decode_seconds", "counter", "seconds", "Time spent in the slicers and decoders.");
+    metrics_printf(mb, "input_decode_seconds_total %.6f\n", cfg->frames_decode_ns / 1e9);
+    metrics_printf(mb, "input_decode_seconds_created %.1f\n", since);
+
+    metrics_header(mb, "output_latency_seconds", "histogram", "seconds", "Delay from the end of a package to the output.");
+    unsigned latency_count = 0;
+    for (unsigned i = 0; i < LATENCY_HIST_BINS; ++i) {
+        latency_count += cfg->frames_latency[i];
+        if (i < LATENCY_HIST_BINS - 1)
+            metrics_printf(mb, "output_latency_seconds_bucket{le=\"%g\"} %u\n", latency_bounds_ms[i] / 1000.0, latency_count);
+        else
+            metrics_printf(mb, "output_latency_seconds_bucket{le=\"+Inf\"} %u\n", latency_count);
+    }
+    metrics_printf(mb, "output_latency_seconds_count %u\n", latency_count);
+    metrics_printf(mb, "output_latency_seconds_created %.1f\n", since);
+
+    metrics_header(mb, "stats_since_seconds", "gauge", "seconds", "Start of the stats report interval, the decoder and output counters restart with it.");
+    metrics_printf(mb, "stats_since_seconds %.1f\n", since);
+
+    // only decoders that ran with events or were timed in this interval
+    char name[128];
+    metrics_header(mb, "decoder_info", "gauge", NULL, "Name of a decoder.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (!r_dev->decode_events && !r_dev->slice_calls)
+            continue;
+        metrics_printf(mb, "decoder_info{protocol=\"%u\",name=\"%s\"} 1\n",
+                r_dev->protocol_num, metrics_label(name, sizeof(name), r_dev->name));
+    }
+    for (size_t m = 0; m < sizeof(decoder_metrics) / sizeof(*decoder_metrics); ++m) {
+        metrics_header(mb, decoder_metrics[m].name, "counter", decoder_metrics[m].unit, decoder_metrics[m].help);
+        for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            if (!r_dev->decode_events && !r_dev->slice_calls)
+                continue;
+            if (m >= DECODER_SLICE_CALLS && !r_dev->slice_calls)
+                continue;
+            double value = m == DECODER_EVENTS       ? r_dev->decode_events
+                    : m == DECODER_OK                ? r_dev->decode_ok
+                    : m == DECODER_MESSAGES          ? r_dev->decode_messages
+                    : m == DECODER_DUPLICATES        ? r_dev->decode_duplicates
+                    : m == DECODER_SLICE_CALLS       ? r_dev->slice_calls
+                    : m == DECODER_SLICE_SECONDS     ? r_dev->slice_ns / 1e9
+                    : m == DECODER_DECODE_CALLS      ? r_dev->decode_calls
+                                                     : r_dev->decode_ns / 1e9;
+            metrics_printf(mb, "%s_total{protocol=\"%u\"} %.*f\n", decoder_metrics[m].name,
+                    r_dev->protocol_num, decoder_metrics[m].unit ? 6 : 0, value);
+        }
+    }
+    metrics_header(mb, "decoder_fails", "counter", NULL, "Number of decoder runs failed or aborted, by reason.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (!r_dev->decode_events && !r_dev->slice_calls)
+            continue;
+        for (size_t i = 0; i < sizeof(decoder_fails) / sizeof(*decoder_fails); ++i) {
+            if (r_dev->decode_fails[i])
+                metrics_printf(mb, "decoder_fails_total{protocol=\"%u\",reason=\"%s\"} %u\n",
+                        r_dev->protocol_num, decoder_fails[i], r_dev->decode_fails[i]);
+        }
+    }
+
+    // the queues of outputs printing on their own thread, and the writes of InfluxDB outputs
+    metrics_header(mb, "output_queued_events", "gauge", NULL, "Number of events waiting in an output queue.");
+    for (size_t i = 0; !cfg->primary && i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        output_queue_stats_t queue;
+        influx_stats_t influx;
+        if (data_output_async_stats(cfg->output_handler.elems[i], &queue, 0))
+            metrics_printf(mb, "output_queued_events{output=\"%u\"} %u\n", (unsigned)i, queue.depth);
+        else if (data_output_influx_stats(cfg->output_handler.elems[i], &influx, 0))
+            metrics_printf(mb, "output_queued_events{output=\"%u\"} %u\n", (unsigned)i, influx.queued);
+    }
+    metrics_header(mb, "output_dropped_events", "counter", NULL, "Number of events an output dropped because it was too slow.");
+    for (size_t i = 0; !cfg->primary && i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        output_queue_stats_t queue;
+        influx_stats_t influx;
+        if (data_output_async_stats(cfg->output_handler.elems[i], &queue, 0))
+            metrics_printf(mb, "output_dropped_events_total{output=\"%u\"} %u\n", (unsigned)i, queue.dropped);
+        else if (data_output_influx_stats(cfg->output_handler.elems[i], &influx, 0))
+            metrics_printf(mb, "output_dropped_events_total{output=\"%u\"} %u\n", (unsigned)i, influx.dropped);
+    }
+
+    // the memory of the subsystems that grow at runtime
+    mem_acct_stats_t mem[MEM_TAGS];
+    for (int i = 0; i < MEM_TAGS; ++i)
+        mem_acct_get((mem_tag_t)i, &mem[i]);
+    metrics_header(mb, "memory_bytes", "gauge", "bytes", "Memory allocated by a subsystem.");
+    for (int i = 0; i < MEM_TAGS; ++i)
+        metrics_printf(mb, "memory_bytes{subsystem=\"%s\"} %zu\n", mem[i].name, mem[i].bytes);
+    metrics_header(mb, "memory_max_bytes", "gauge", "bytes", "Most memory allocated by a subsystem since the start.");
+    for (int i = 0; i < MEM_TAGS; ++i)
+        metrics_printf(mb, "memory_max_bytes{subsystem=\"%s\"} %zu\n", mem[i].name, mem[i].max_bytes);
+    metrics_header(mb, "memory_shed", "counter", NULL, "Number of times a subsystem shed memory to get below its limit.");
+    for (int i = 0; i < MEM_TAGS; ++i)
+        metrics_printf(mb, "memory_shed_total{subsystem=\"%s\"} %u\n", mem[i].name, mem[i].shed);
+
+    metrics_printf(mb,
+            "# TYPE http_clients gauge\n"
+            "# HELP http_clients Number of HTTP clients receiving events.\n"
+            "http_clients %u\n"
+            "# TYPE http_dropped_events counter\n"
+            "# HELP http_dropped_events Number of events dropped for HTTP clients that did not keep up.\n"
+            "http_dropped_events_total %u\n"
+            "# EOF\n",
+            clients,
+            dropped);
+}
+
+// curl 'http://127.0.0.1:8433/metrics'
+static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_t *call = http_call_new(nc, CALL_METRICS);
+    if (!call) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    call->clients = (unsigned)ctx->clients.len;
+    call->dropped = ctx->dropped;
+    http_call_post(ctx, call);
+}
+
+// Renders the spectrum bins from the lowest frequency up, the occupancy restarts with each stats report.
+// curl 'http://127.0.0.1:8433/spectrum'
+static void handle_spectrum(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_t *call = http_call_new(nc, CALL_SPECTRUM);
+    if (!call) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_post(ctx, call);
+}
+
+// Renders the sensors from the most recently heard on, in one response.
+// curl 'http://127.0.0.1:8433/devices'
+static void handle_devices(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_t *call = http_call_new(nc, CALL_DEVICES);
+    if (!call) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_post(ctx, call);
+}
+
+/// Default most stored events in a reply.
+#define DEFAULT_HISTORY_LIMIT 10000
+
+// seconds since the epoch, a negative value is before now, returns -1 if not a number
+static int parse_query_time(char const *arg, int64_t *time_us)
+{
+    char *end;
+    double secs = strtod(arg, &end);
+    if (end == arg || *end)
+        return -1;
+    if (secs < 0) {
+        struct timeval now;
+        get_time_now(&now);
+        secs += now.tv_sec + now.tv_usec / 1e6;
+    }
+    *time_us = (int64_t)(secs * 1e6);
+    return 0;
+}
+
+// Renders the stored events of a time range, and of a model and id, oldest first.
+// curl 'http://127.0.0.1:8433/history?from=-86400&model=Acurite-Tower&id=1234'
+static void handle_history(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    if (!ctx->store) {
+        mg_http_send_error(nc, 404, NULL); // 404 Not Found, no events stored without store=
+        return;
+    }
+    http_call_t *call = http_call_new(nc, CALL_HISTORY);
+    if (!call) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    call->query.from_us = INT64_MIN;
+    call->query.to_us   = INT64_MAX;
+    call->query.limit   = DEFAULT_HISTORY_LIMIT;
+    char buf[32];
+    int bad = 0;
+    if (mg_get_http_var(&hm->query_string, "from", buf, sizeof(buf)) > 0)
+        bad |= parse_query_time(buf, &call->query.from_us);
+    if (mg_get_http_var(&hm->query_string, "to", buf, sizeof(buf)) > 0)
+        bad |= parse_query_time(buf, &call->query.to_us);
+    if (mg_get_http_var(&hm->query_string, "limit", buf, sizeof(buf)) > 0)
+        call->query.limit = (unsigned)strtoul(buf, NULL, 10);
+    if (mg_get_http_var(&hm->query_string, "model", call->model, sizeof(call->model)) > 0)
+        call->query.model = call->model;
+    if (mg_get_http_var(&hm->query_string, "id", call->id, sizeof(call->id)) > 0)
+        call->query.id = call->id;
+    if (bad || (call->query.id && !call->query.model)) {
+        http_call_free(call);
+        mg_http_send_error(nc, 400, NULL); // 400 Bad Request
+        return;
+    }
+    http_call_post(ctx, call);
+}
+
+// Writes the recorded packages of a time range as a pulse archive, or renders the events decoded from them.
+// curl -o pulses.rpa 'http://127.0.0.1:8433/pulses?from=-600'
+// curl 'http://127.0.0.1:8433/redecode?from=-600'
+static void handle_recorded(struct mg_connection *nc, struct http_message *hm, call_kind_t kind)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    http_call_t *call = http_call_new(nc, kind);
+    if (!call) {
+        mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+        return;
+    }
+    call->query.from_us = INT64_MIN;
+    call->query.to_us   = INT64_MAX;
+    char buf[32];
+    int bad = 0;
+    if (mg_get_http_var(&hm->query_string, "from", buf, sizeof(buf)) > 0)
+        bad |= parse_query_time(buf, &call->query.from_us);
+    if (mg_get_http_var(&hm->query_string, "to", buf, sizeof(buf)) > 0)
+        bad |= parse_query_time(buf, &call->query.to_us);
+    if (bad) {
+        http_call_free(call);
+        mg_http_send_error(nc, 400, NULL); // 400 Bad Request
+        return;
+    }
+    http_call_post(ctx, call);
+}
+
+// reply to ws command
+static void rpc_response_ws(rpc_t *rpc, int ret_code, char const *message, int arg)
+{
+    if (ret_code < 0) {
+        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
+                "{\"error\": {\"code\": %d, \"message\": \"%s\"}}",
+                ret_code, message);
+    }
+    else if (ret_code == 0 && message) {
+        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
+                "{\"result\": \"%s\"}",
+                message);
+    }
+    else if (ret_code == 0) {
+        mg_printf_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT,
+                "{\"result\": null}");
     }
     else if (ret_code == 1) {
         mg_send_websocket_frame(rpc->nc, WEBSOCKET_OP_TEXT, message, strlen(message));
@@ -912,20 +2384,37 @@ static void rpc_response_jsoncmd(rpc_t *rpc, int ret_code, char const *message,
 // {"cmd":"sample_rate","val":1024000}
 // http --stream --timeout=70 :8433/events
 //s.a. https://developer.twitter.com/en/docs/tutorials/consuming-streaming-data.html
+// curl -N -H 'Accept: text/event-stream' -H 'Last-Event-ID: 42' 'http://127.0.0.1:8433/events'
 static void handle_json_events(struct mg_connection *nc, struct http_message *hm)
 {
-    UNUSED(hm);
+    if (!http_server_of(nc) || http_client_of(nc))
+        return; // server stopped or already streaming
+
+    struct mg_str *accept = mg_get_http_header(hm, "Accept");
+    int is_sse = accept && mg_strstr(*accept, mg_mk_str("text/event-stream"));
+
+    encoding_t encoding = http_accept_encoding(hm);
+    char const *content_encoding = encoding == ENCODING_GZIP ? "Content-Encoding: gzip\r\n"
+            : encoding == ENCODING_DEFLATE                     ? "Content-Encoding: deflate\r\n"
+                                                               : "";
+
     /* Send headers */
-    mg_printf(nc, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+    if (is_sse)
+        mg_printf(nc, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n%sTransfer-Encoding: chunked\r\n\r\n", content_encoding);
+    else
+        mg_printf(nc, "HTTP/1.1 200 OK\r\n%sTransfer-Encoding: chunked\r\n\r\n", content_encoding);
 
     /* Mark connection */
-    struct nc_context *ctx = calloc(1, sizeof(*ctx));
-    if (!ctx) {
-        WARN_CALLOC("handle_json_events()");
+    http_client_t *client = http_client_new(nc, is_sse ? CLIENT_SSE : CLIENT_CHUNKED);
+    if (!client)
         return;
-    }
-    ctx->is_chunked = 1;
-    nc->user_data   = ctx;
+#ifdef ZLIB
+    http_client_encode(client, encoding);
+#endif
+
+    unsigned since;
+    if (http_resume_id(hm, &since))
+        http_client_replay(client, since, client->server->history.last_id);
 
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // set keep alive timer
 }
@@ -933,22 +2422,47 @@ static void handle_json_events(struct mg_connection *nc, struct http_message *hm
 // (echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433
 static void handle_json_stream(struct mg_connection *nc, struct http_message *hm)
 {
-    UNUSED(hm);
+    if (!http_server_of(nc) || http_client_of(nc))
+        return; // server stopped or already streaming
+
+    encoding_t encoding = http_accept_encoding(hm);
+    char const *content_encoding = encoding == ENCODING_GZIP ? "Content-Encoding: gzip\r\n"
+            : encoding == ENCODING_DEFLATE                     ? "Content-Encoding: deflate\r\n"
+                                                               : "";
+
     /* Send headers */
-    mg_printf(nc, "HTTP/1.1 200 OK\r\n\r\n");
+    mg_printf(nc, "HTTP/1.1 200 OK\r\n%s\r\n", content_encoding);
 
     /* Mark connection */
-    struct nc_context *ctx = calloc(1, sizeof(*ctx));
-    if (!ctx) {
-        WARN_CALLOC("handle_json_stream()");
+    http_client_t *client = http_client_new(nc, CLIENT_PLAIN);
+    if (!client)
         return;
-    }
-    ctx->is_chunked = 0;
-    nc->user_data   = ctx;
+#ifdef ZLIB
+    http_client_encode(client, encoding);
+#endif
+
+    unsigned since;
+    if (http_resume_id(hm, &since))
+        http_client_replay(client, since, client->server->history.last_id);
 
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // set keep alive timer
 }
 
+// run the command on the core event loop, the reply is sent once it is done
+static void post_rpc(struct http_server_context *ctx, struct mg_connection *nc, rpc_t *rpc)
+{
+    http_call_t *call = http_call_new(nc, CALL_RPC);
+    if (!call || http_call_set_rpc(call, rpc) < 0) {
+        if (call)
+            http_call_free(call);
+        rpc->response(rpc, -1, "Out of memory", 0);
+        return;
+    }
+    if (rpc->method && !strcmp(rpc->method, "get_meta"))
+        call->rpc.http_state = http_state_data(ctx);
+    http_call_post(ctx, call);
+}
+
 // Handles GET with query string and POST with form-encoded body
 // curl -D - 'http://127.0.0.1:8433/cmd?cmd=report_meta&arg=level'
 // curl -D - -d "cmd=report_meta&arg=level" -X POST 'http://127.0.0.1:8433/cmd'
@@ -959,7 +2473,9 @@ static void handle_json_stream(struct mg_connection *nc, struct http_message *hm
 // xh :8433/cmd cmd==gain arg==10
 static void handle_cmd_rpc(struct mg_connection *nc, struct http_message *hm)
 {
-    struct http_server_context *ctx = nc->user_data;
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx)
+        return; // server stopped
     char cmd[100], arg[100], val[100];
     rpc_t rpc = {
             .nc = nc,
@@ -987,14 +2503,16 @@ static void handle_cmd_rpc(struct mg_connection *nc, struct http_message *hm)
     rpc.val = strtol(val, &endptr, 10);
     fprintf(stderr, "POST Got %s, arg %s, val %s (%u)\n", cmd, arg, val, rpc.val);
 
-    rpc_exec(&rpc, ctx->cfg);
+    post_rpc(ctx, nc, &rpc);
 }
 
 // Handles POST with JSONRPC command
 // http POST :8433/jsonrpc jsonrpc=2.0 method=sample_rate params:='[1024000]'
 static void handle_json_rpc(struct mg_connection *nc, struct http_message *hm)
 {
-    struct http_server_context *ctx = nc->user_data;
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx)
+        return; // server stopped
 
     rpc_t rpc = {
             .nc       = nc,
@@ -1007,7 +2525,7 @@ static void handle_json_rpc(struct mg_connection *nc, struct http_message *hm)
     /* Parse JSON */
     int ret = jsonrpc_parse(&rpc, &hm->body);
     if (!ret) {
-        rpc_exec(&rpc, ctx->cfg);
+        post_rpc(ctx, nc, &rpc);
     }
     else {
         char *error = "{\"error\":\"Invalid command\"}";
@@ -1022,7 +2540,9 @@ static void handle_json_rpc(struct mg_connection *nc, struct http_message *hm)
 // Handles WS with JSON command
 static void handle_ws_rpc(struct mg_connection *nc, struct websocket_message *wm)
 {
-    struct http_server_context *ctx = nc->user_data;
+    struct http_server_context *ctx = http_server_of(nc);
+    if (!ctx)
+        return; // server stopped
 
     rpc_t rpc = {
             .nc       = nc,
@@ -1030,11 +2550,22 @@ static void handle_ws_rpc(struct mg_connection *nc, struct websocket_message *wm
     };
 
     struct mg_str d = {(char *)wm->data, wm->size};
+    int ret         = 0;
+    if (wm->flags & WEBSOCKET_COMPRESSED) {
+#ifdef ZLIB
+        // only with "permessage-deflate" accepted
+        ret = !(nc->flags & MG_F_WS_DEFLATE) || http_inflate(ctx, wm->data, wm->size);
+        d   = mg_mk_str_n(ctx->scratch.buf, ctx->scratch.len);
+#else
+        ret = -1;
+#endif
+    }
 
     /* Parse JSON */
-    int ret = json_parse(&rpc, &d);
+    if (!ret)
+        ret = json_parse(&rpc, &d);
     if (!ret) {
-        rpc_exec(&rpc, ctx->cfg);
+        post_rpc(ctx, nc, &rpc);
     }
     else {
         char *error = "{\"error\":\"Invalid command\"}";
@@ -1046,18 +2577,27 @@ static void handle_ws_rpc(struct mg_connection *nc, struct websocket_message *wm
     free(rpc.arg);
 }
 
-static void ev_handler(struct mg_connection *nc, int ev, void *ev_data);
-
 static void send_keep_alive(struct mg_connection *nc)
 {
-    if (nc->handler != ev_handler)
+    http_client_t *client = http_client_of(nc);
+    if (!client || client->kind == CLIENT_WEBSOCKET)
         return; // this should not happen
 
-    struct nc_context *ctx = nc->user_data;
-    if (!ctx)
-        return; // this should not happen
+#ifdef ZLIB
+    if (client->encoding != ENCODING_IDENTITY) {
+        if (client->kind == CLIENT_SSE)
+            http_client_deflate(client, ":\n\n", 3); // a comment line
+        else
+            http_client_deflate(client, "\r\n", 2);
+        mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+        return;
+    }
+#endif
 
-    if (ctx->is_chunked) {
+    if (client->kind == CLIENT_SSE) {
+        mg_send_http_chunk(nc, ":\n\n", 3); // a comment line
+    }
+    else if (client->kind == CLIENT_CHUNKED) {
         mg_send_http_chunk(nc, "\r\n", 2);
     }
     else {
@@ -1072,15 +2612,45 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
     case MG_EV_TIMER:
         send_keep_alive(nc);
         break;
+    case MG_EV_SEND: {
+        http_client_t *client = http_client_of(nc);
+        if (client)
+            http_client_write(client); // refill the send buffer
+        break;
+    }
+#ifdef ZLIB
+    case MG_EV_WEBSOCKET_HANDSHAKE_REQUEST: {
+        struct http_message *hm = (struct http_message *)ev_data;
+        int accept              = http_server_of(nc) ? http_accept_ws_deflate(hm) : 0;
+        if (!accept)
+            break; // the default handshake
+        // the commands are decompressed on their own
+        nc->flags |= MG_F_WS_DEFLATE;
+        if (accept == 2) {
+            nc->flags |= MG_F_WS_NO_TAKEOVER;
+            mg_send_websocket_handshake_reply(nc, hm,
+                    "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_no_context_takeover\r\n");
+        }
+        else {
+            mg_send_websocket_handshake_reply(nc, hm,
+                    "Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover\r\n");
+        }
+        break;
+    }
+#endif
     case MG_EV_WEBSOCKET_HANDSHAKE_DONE: {
-        struct http_server_context *ctx = nc->user_data;
-        /* New websocket connection. Send meta. */
-        data_t *meta = meta_data(ctx->cfg);
-        data_output_print(ctx->output, meta);
-        data_free(meta);
-        /* Send history */
-        for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, (char *)*iter, strlen((char *)*iter));
+        struct http_server_context *ctx = http_server_of(nc);
+        if (!ctx || http_client_of(nc))
+            break; // server stopped
+        /* New websocket connection. Send meta, then the history, see http_call_finish() */
+        http_call_t *call = http_call_new(nc, CALL_META);
+        if (!call)
+            break;
+        /* Replay all history, or resume after an id */
+        call->since = history_first_id(&ctx->history) - 1;
+        http_resume_id((struct http_message *)ev_data, &call->since);
+        call->rpc.http_state = http_state_data(ctx);
+        http_call_post(ctx, call);
         break;
     }
     case MG_EV_WEBSOCKET_FRAME: {
@@ -1117,66 +2687,466 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
         else if (mg_vcmp(&hm->uri, "/metrics") == 0) {
             handle_openmetrics(nc, hm);
         }
+        else if (mg_vcmp(&hm->uri, "/spectrum") == 0) {
+            handle_spectrum(nc, hm);
+        }
+        else if (mg_vcmp(&hm->uri, "/devices") == 0) {
+            handle_devices(nc, hm);
+        }
+        else if (mg_vcmp(&hm->uri, "/history") == 0) {
+            handle_history(nc, hm);
+        }
+        else if (mg_vcmp(&hm->uri, "/pulses") == 0) {
+            handle_recorded(nc, hm, CALL_PULSES);
+        }
+        else if (mg_vcmp(&hm->uri, "/redecode") == 0) {
+            handle_recorded(nc, hm, CALL_REDECODE);
+        }
         else if (mg_vcmp(&hm->uri, "/api") == 0) {
             //handle_api_query(nc, hm);
         }
 #ifdef SERVE_STATIC
         else {
-            struct http_server_context *ctx = nc->user_data;
-            mg_serve_http(nc, hm, ctx->server_opts); /* Serve static content */
+            struct http_server_context *ctx = http_server_of(nc);
+            if (ctx)
+                mg_serve_http(nc, hm, ctx->server_opts); /* Serve static content */
         }
 #endif
         break;
     }
-    case MG_EV_CLOSE:
+    case MG_EV_CLOSE: {
         //fprintf(stderr, "MG_EV_CLOSE %p %p %p\n", ev_data, nc, nc->user_data);
+        http_client_free(http_client_of(nc));
+        // the replies of calls still on the core are dropped
+        struct http_server_context *ctx = http_server_of(nc);
+        for (void **iter = ctx ? ctx->calls.elems : NULL; iter && *iter; ++iter) {
+            http_call_t *call = *iter;
+            if (call->nc == nc)
+                call->nc = NULL;
+        }
         break;
+    }
     default:
         break;
     }
 }
 
-static int is_websocket(const struct mg_connection *nc)
+// broadcast to all our clients, the text is copied to the history and shared by the client queues
+static void http_broadcast_send(struct http_server_context *ctx, char const *text, size_t len)
 {
-    return nc->flags & MG_F_IS_WEBSOCKET;
+    unsigned id = history_push(&ctx->history, text, len);
+    if (!ctx->clients.len)
+        return;
+
+    shared_msg_t *msg = shared_msg_new(text, len);
+    if (!msg)
+        return; // NOTE: skip output on alloc failure.
+    msg->id = id;
+#ifdef ZLIB
+    http_deflate_msg(ctx, msg);
+#endif
+
+    for (void **iter = ctx->clients.elems; iter && *iter; ++iter)
+        http_client_push(*iter, msg);
+
+    shared_msg_release(msg);
+    http_clients_shed(ctx);
 }
 
-// event handler to broadcast to all our sockets
-static void http_broadcast_send(struct http_server_context *ctx, char const *msg, size_t len)
+// join the stored events to a JSON array
+static void append_stored_event(void *ctx, int64_t time_us, char const *text, size_t len)
 {
-    struct mg_connection *nc;
-    struct mg_mgr *mgr = ctx->conn->mgr;
+    UNUSED(time_us);
+    struct mbuf *reply = ctx;
+    mbuf_append(reply, reply->len ? "," : "[", 1);
+    mbuf_append(reply, text, len);
+}
+
+// append an event decoded from the recorded packages to the reply array
+static void append_redecoded_event(void *ctx, data_t *data)
+{
+    struct mbuf *reply = ctx;
+    char buf[16384]; // we expect an event string to be around 500 bytes.
+    size_t len = data_print_jsons(data, buf, sizeof(buf));
+    mbuf_append(reply, reply->len ? "," : "[", 1);
+    mbuf_append(reply, buf, len);
+}
+
+// make a call, on the core event loop
+static void http_call_exec(struct http_server_context *ctx, http_call_t *call)
+{
+    r_cfg_t *cfg = ctx->cfg;
 
-    char *dup = strdup(msg);
-    if (!dup) {
-        WARN_STRDUP("http_broadcast_send()");
+    if (call->kind == CALL_RPC) {
+        rpc_exec(&call->rpc, ctx);
     }
-    else {
-        free(ring_list_push(ctx->history, dup));
+    else if (call->kind == CALL_META) {
+        char buf[16384]; // we expect the meta string to be around 500 bytes, and 200 bytes per client.
+        data_t *meta = meta_data(cfg, call->rpc.http_state);
+        call->rpc.http_state = NULL;
+        size_t len = data_print_jsons(meta, buf, sizeof(buf));
+        data_free(meta);
+        mbuf_append(&call->reply, buf, len);
+    }
+    else if (call->kind == CALL_METRICS) {
+        mbuf_resize(&call->reply, 4096);
+        render_metrics(cfg, &call->reply, call->clients, call->dropped);
+    }
+    else if (call->kind == CALL_SPECTRUM) {
+        data_t *data = create_spectrum_data(cfg);
+        if (data) {
+            char buf[32768]; // we expect the spectrum string to be around 4k bytes.
+            size_t len = data_print_jsons(data, buf, sizeof(buf));
+            data_free(data);
+            mbuf_append(&call->reply, buf, len);
+        }
+    }
+    else if (call->kind == CALL_DEVICES) {
+        data_t *data = cfg->sensor_state ? sensor_state_data(cfg->sensor_state) : NULL;
+        // a snapshot filling the buffer might be truncated, retry with a larger one
+        for (size_t size = 16384; data && !call->reply.len; size *= 4) {
+            mbuf_resize(&call->reply, size);
+            if (call->reply.size < size)
+                break; // NOTE: no reply on alloc failure.
+            size_t len = data_print_jsons(data, call->reply.buf, size);
+            if (len + 1 < size)
+                call->reply.len = len;
+        }
+        data_free(data);
+    }
+    else if (call->kind == CALL_HISTORY) {
+        event_store_query(ctx->store, &call->query, append_stored_event, &call->reply, &call->next_us);
+        mbuf_append(&call->reply, call->reply.len ? "]" : "[]", call->reply.len ? 1 : 2);
+    }
+    else if (call->kind == CALL_PULSES) {
+        r_cfg_t *root = cfg;
+        while (root->primary)
+            root = root->primary;
+        FILE *file = root->pulse_recorder ? tmpfile() : NULL;
+        if (file && pulse_recorder_write(root->pulse_recorder, file, call->query.from_us, call->query.to_us) >= 0) {
+            long size = ftell(file);
+            rewind(file);
+            mbuf_resize(&call->reply, size > 0 ? (size_t)size : 0);
+            if (size > 0 && call->reply.size >= (size_t)size)
+                call->reply.len = fread(call->reply.buf, 1, (size_t)size, file);
+            // NOTE: no reply on alloc failure.
+        }
+        if (file)
+            fclose(file);
     }
+    else if (call->kind == CALL_REDECODE) {
+        if (r_redecode_recorded(cfg, call->query.from_us, call->query.to_us, append_redecoded_event, &call->reply) >= 0)
+            mbuf_append(&call->reply, call->reply.len ? "]" : "[]", call->reply.len ? 1 : 2);
+    }
+}
 
-    for (nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
-        if (nc->handler != ev_handler)
-            continue;
+// send the reply of a call, on the server thread
+static void http_call_finish(struct http_server_context *ctx, http_call_t *call)
+{
+    for (size_t i = 0; i < ctx->calls.len; ++i) {
+        if (ctx->calls.elems[i] == call) {
+            list_remove(&ctx->calls, i, NULL);
+            break;
+        }
+    }
+    struct mg_connection *nc = call->nc;
+    if (!nc) {
+        http_call_free(call); // the connection closed meanwhile
+        return;
+    }
 
-        struct nc_context *cctx = nc->user_data; // might not be valid
-        if (is_websocket(nc)) {
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, msg, len);
+    if (call->kind == CALL_RPC) {
+        call->rpc.nc = nc;
+        if (call->replied)
+            call->response(&call->rpc, call->code, call->has_message ? call->reply.buf : NULL, call->arg);
+    }
+    else if (call->kind == CALL_META) {
+        http_client_t *client = http_client_new(nc, CLIENT_WEBSOCKET);
+#ifdef ZLIB
+        if (client && (nc->flags & MG_F_WS_DEFLATE)) {
+            http_client_encode(client, ENCODING_WS);
+            client->no_takeover = (nc->flags & MG_F_WS_NO_TAKEOVER) != 0;
+        }
+#endif
+        if (client) {
+            unsigned until = ctx->history.last_id;
+            if (call->reply.len)
+                http_broadcast_send(ctx, call->reply.buf, call->reply.len);
+            http_client_replay(client, call->since, until);
+        }
+    }
+    else if (call->kind == CALL_METRICS) {
+        mg_printf(nc,
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: %u\r\n"
+                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                "\r\n",
+                (unsigned)call->reply.len);
+        mg_send(nc, call->reply.buf, call->reply.len);
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    else if (call->kind == CALL_SPECTRUM) {
+        if (!call->reply.len) {
+            mg_http_send_error(nc, 404, NULL); // 404 Not Found, no spectrum without channels
+        }
+        else {
+            mg_printf(nc,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Length: %u\r\n"
+                    "Content-Type: application/json\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "\r\n",
+                    (unsigned)call->reply.len);
+            mg_send(nc, call->reply.buf, (int)call->reply.len);
+            nc->flags |= MG_F_SEND_AND_CLOSE;
         }
-        else if (cctx && cctx->is_chunked) {
-            mg_send_http_chunk(nc, msg, len);
-            mg_send_http_chunk(nc, "\r\n", 2);
-            mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+    }
+    else if (call->kind == CALL_DEVICES) {
+        if (!call->reply.len) {
+            mg_http_send_error(nc, 404, NULL); // 404 Not Found, no state kept without -M devices
+        }
+        else {
+            mg_printf(nc,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Length: %u\r\n"
+                    "Content-Type: application/json\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "\r\n",
+                    (unsigned)call->reply.len);
+            mg_send(nc, call->reply.buf, (int)call->reply.len);
+            nc->flags |= MG_F_SEND_AND_CLOSE;
+        }
+    }
+    else if (call->kind == CALL_HISTORY) {
+        char next[64] = "";
+        if (call->next_us)
+            snprintf(next, sizeof(next), "X-Next-From: %.6f\r\n", call->next_us / 1e6);
+        mg_printf(nc,
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: %u\r\n"
+                "Content-Type: application/json\r\n"
+                "Cache-Control: no-cache\r\n"
+                "%s"
+                "\r\n",
+                (unsigned)call->reply.len, next);
+        mg_send(nc, call->reply.buf, (int)call->reply.len);
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    else if (call->kind == CALL_PULSES || call->kind == CALL_REDECODE) {
+        if (!call->reply.len) {
+            mg_http_send_error(nc, 404, NULL); // 404 Not Found, no packages recorded without -M recorder
         }
-        else if (cctx && !cctx->is_chunked) {
-            mg_send(nc, msg, len);
-            mg_send(nc, "\r\n", 2);
-            mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+        else {
+            char const *type = call->kind == CALL_PULSES
+                    ? "application/octet-stream\r\nContent-Disposition: attachment; filename=\"pulses.rpa\""
+                    : "application/json";
+            mg_printf(nc,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Length: %u\r\n"
+                    "Content-Type: %s\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "\r\n",
+                    (unsigned)call->reply.len, type);
+            mg_send(nc, call->reply.buf, (int)call->reply.len);
+            nc->flags |= MG_F_SEND_AND_CLOSE;
         }
     }
+    http_call_free(call);
+}
+
+#ifdef THREADS
+
+// the dummy ncs only receive broadcasts, handled in core_call_handler() and server_queue_handler()
+static void wake_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    (void)nc;
+    (void)ev_type;
+    (void)ev_data;
+}
+
+// broadcast a message queued by the core, the id is set with the history
+static void http_broadcast_msg(struct http_server_context *ctx, shared_msg_t *msg)
+{
+    msg->id = history_push(&ctx->history, msg->text, msg->len);
+#ifdef ZLIB
+    http_deflate_msg(ctx, msg);
+#endif
+    for (void **iter = ctx->clients.elems; iter && *iter; ++iter)
+        http_client_push(*iter, msg);
+    http_clients_shed(ctx);
+}
+
+// wake the server thread if nothing is queued for it yet, the lock must be held
+static void wake_server(struct http_server_context *ctx);
+
+// make the queued calls and queue them back to the server thread
+static void run_core_calls(struct http_server_context *ctx)
+{
+    pthread_mutex_lock(&ctx->lock);
+    list_t calls    = ctx->core_calls;
+    ctx->core_calls = (list_t){0};
+    pthread_mutex_unlock(&ctx->lock);
+
+    for (void **iter = calls.elems; iter && *iter; ++iter) {
+        http_call_exec(ctx, *iter);
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    for (void **iter = calls.elems; iter && *iter; ++iter) {
+        wake_server(ctx);
+        list_push(&ctx->done_calls, *iter);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    list_free_elems(&calls, NULL);
+}
+
+// called by mg_mgr_poll() of the core event loop for each connection.
+static void core_call_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    (void)ev_data;
+    // only process a broadcast on our wake up nc, the user_data is cleared on stop
+    if (ev_type != MG_EV_POLL || nc->handler != wake_handler || !nc->user_data) {
+        return;
+    }
+    run_core_calls(nc->user_data);
+}
+
+// broadcast the queued events and send the replies of the calls done
+static void run_server_queue(struct http_server_context *ctx)
+{
+    pthread_mutex_lock(&ctx->lock);
+    list_t events   = ctx->events;
+    list_t calls    = ctx->done_calls;
+    ctx->events     = (list_t){0};
+    ctx->done_calls = (list_t){0};
+    pthread_mutex_unlock(&ctx->lock);
+
+    for (void **iter = events.elems; iter && *iter; ++iter) {
+        http_broadcast_msg(ctx, *iter);
+    }
+    list_free_elems(&events, (list_elem_free_fn)shared_msg_release);
+    for (void **iter = calls.elems; iter && *iter; ++iter) {
+        http_call_finish(ctx, *iter);
+    }
+    list_free_elems(&calls, NULL);
+}
+
+// called by mg_mgr_poll() of the server event loop for each connection.
+static void server_queue_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    (void)ev_data;
+    if (ev_type != MG_EV_POLL || nc->handler != wake_handler || !nc->user_data) {
+        return;
+    }
+    run_server_queue(nc->user_data);
+}
+
+static void wake_server(struct http_server_context *ctx)
+{
+    if (!ctx->events.len && !ctx->done_calls.len)
+        mg_broadcast(&ctx->own_mgr, server_queue_handler, NULL, 0);
+}
+
+static THREAD_RETURN THREAD_CALL http_server_run(void *arg)
+{
+    struct http_server_context *ctx = arg;
+    thread_sched_apply(THREAD_ROLE_HTTP);
+
+    while (!atomic_load_acquire(&ctx->exit_thread)) {
+        mg_mgr_poll(&ctx->own_mgr, 500);
+    }
+
+    return (THREAD_RETURN)(0);
+}
+
+static int http_server_thread_start(struct http_server_context *ctx)
+{
+    struct mg_add_sock_opts opts = {.user_data = ctx};
+    ctx->core_nc = mg_add_sock_opt(ctx->core_mgr, INVALID_SOCKET, wake_handler, opts);
+    ctx->server_nc = mg_add_sock_opt(&ctx->own_mgr, INVALID_SOCKET, wake_handler, opts);
+    if (!ctx->core_nc || !ctx->server_nc) {
+        print_log(LOG_ERROR, __func__, "failed to add the wake up connections");
+        return -1;
+    }
+
+    pthread_mutex_init(&ctx->lock, NULL);
+    ctx->threaded = 1;
+
+#ifndef _WIN32
+    // Block all signals from the server thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&ctx->thread, NULL, http_server_run, ctx);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+        ctx->threaded = 0;
+        pthread_mutex_destroy(&ctx->lock);
+        return -1;
+    }
+    return 0;
+}
+
+// join the server thread, the server then runs on the core event loop until it is freed
+static void http_server_thread_stop(struct http_server_context *ctx)
+{
+    if (!ctx->threaded)
+        return;
+
+    atomic_store_release(&ctx->exit_thread, 1);
+    mg_broadcast(&ctx->own_mgr, server_queue_handler, NULL, 0);
+    pthread_join(ctx->thread, NULL);
+    ctx->threaded = 0;
+
+    // make the calls and deliver the events still queued
+    run_core_calls(ctx);
+    run_server_queue(ctx);
+    ctx->core_nc->user_data = NULL;
+    ctx->core_nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+    ctx->server_nc->user_data = NULL;
+    pthread_mutex_destroy(&ctx->lock);
+}
+
+// queue an event for the server thread
+static void http_server_queue_event(struct http_server_context *ctx, char const *text, size_t len)
+{
+    shared_msg_t *msg = shared_msg_new(text, len);
+    if (!msg)
+        return; // NOTE: skip output on alloc failure.
+
+    pthread_mutex_lock(&ctx->lock);
+    wake_server(ctx);
+    list_push(&ctx->events, msg);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+#endif /* THREADS */
+
+static void http_call_post(struct http_server_context *ctx, http_call_t *call)
+{
+    list_push(&ctx->calls, call);
+#ifdef THREADS
+    if (ctx->threaded) {
+        pthread_mutex_lock(&ctx->lock);
+        int was_empty = !ctx->core_calls.len;
+        list_push(&ctx->core_calls, call);
+        pthread_mutex_unlock(&ctx->lock);
+        // only wake the core event loop if it has not been signalled already
+        if (was_empty)
+            mg_broadcast(ctx->core_mgr, core_call_handler, NULL, 0);
+        return;
+    }
+#endif
+    http_call_exec(ctx, call);
+    http_call_finish(ctx, call);
 }
 
-static struct http_server_context *http_server_start(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg, struct data_output *output)
+static struct http_server_context *http_server_start(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg, struct data_output *output, unsigned client_bytes, unsigned history_bytes)
 {
     struct mg_bind_opts bind_opts;
     const char *err_str;
@@ -1190,7 +3160,20 @@ static struct http_server_context *http_server_start(struct mg_mgr *mgr, char co
 
     ctx->cfg     = cfg;
     ctx->output  = output;
-    ctx->history = ring_list_new(DEFAULT_HISTORY_SIZE);
+    ctx->client_bytes = client_bytes ? client_bytes : CLIENT_QUEUE_BYTES;
+#ifdef ZLIB
+    mbuf_init(&ctx->scratch, 0);
+    ctx->scratch.tag = MEM_TAG_HTTP;
+#endif
+    history_init(&ctx->history, history_bytes ? history_bytes : DEFAULT_HISTORY_BYTES); // NOTE: no history on alloc failure.
+#ifdef THREADS
+    // the server runs its own event loop, the core event loop only makes the calls
+    mg_mgr_init(&ctx->own_mgr, NULL);
+    ctx->mgr      = &ctx->own_mgr;
+    ctx->core_mgr = mgr;
+#else
+    ctx->mgr = mgr;
+#endif
 
     char address[253 + 6 + 1]; // dns max + port
     // if the host is an IPv6 address it needs quoting
@@ -1204,19 +3187,35 @@ static struct http_server_context *http_server_start(struct mg_mgr *mgr, char co
     bind_opts.user_data = ctx;
     bind_opts.error_string = &err_str;
 
-    ctx->conn = mg_bind_opt(mgr, address, ev_handler, bind_opts);
+    ctx->conn = mg_bind_opt(ctx->mgr, address, ev_handler, bind_opts);
     if (ctx->conn == NULL) {
         print_logf(LOG_ERROR, __func__, "Error starting server on address %s: %s", address,
                 *bind_opts.error_string);
-        ring_list_free(ctx->history);
+#ifdef THREADS
+        mg_mgr_free(&ctx->own_mgr);
+#endif
+        history_free(&ctx->history);
         free(ctx);
         return NULL;
     }
 
     mg_set_protocol_http_websocket(ctx->conn);
+#ifdef RTL_433_MEMORY_BUDGET_MB
+    // accepted connections inherit the limit, a request needs to fit twice to be parsed
+    ctx->conn->recv_mbuf_limit = 2 * MG_MAX_HTTP_REQUEST_SIZE;
+#endif
     ctx->server_opts.document_root            = "."; // Serve current directory
     ctx->server_opts.enable_directory_listing = "yes";
 
+#ifdef THREADS
+    if (http_server_thread_start(ctx)) {
+        mg_mgr_free(&ctx->own_mgr);
+        history_free(&ctx->history);
+        free(ctx);
+        return NULL;
+    }
+#endif
+
     print_logf(LOG_NOTICE, "HTTP server", "Serving HTTP-API on address %s, serving %s", address,
             ctx->server_opts.document_root);
 
@@ -1230,34 +3229,76 @@ static int http_server_stop(struct http_server_context *ctx)
     if (!ctx)
         return 0;
 
-    // close the server
+#ifdef THREADS
+    http_server_thread_stop(ctx);
+#endif
+
+    // close the server, the own event loop closes it last, accepted connections use the listener
     ctx->conn->user_data = NULL;
+#ifndef THREADS
     ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+#endif
 
-    // close connections with a goodbye
-    struct mg_mgr *mgr = ctx->conn->mgr;
-    for (struct mg_connection *nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
-        if (nc->handler != ev_handler)
-            continue;
+    // close client connections with a goodbye
+    while (ctx->clients.len > 0) {
+        http_client_t *client = ctx->clients.elems[ctx->clients.len - 1];
+        struct mg_connection *nc = client->nc;
 
-        struct nc_context *cctx = nc->user_data; // might not be valid
-        if (is_websocket(nc)) {
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
+        // flush the queue, ignoring the send window
+        shared_msg_t *msg;
+        while ((msg = ring_list_shift(client->queue))) {
+            http_client_send_msg(client, msg);
+            shared_msg_release(msg);
         }
-        else if (cctx && cctx->is_chunked) {
-            mg_send_http_chunk(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
-            mg_send_http_chunk(nc, "\r\n", 2);
+        client->queued       = 0;
+        client->queued_bytes = 0;
+
+        http_client_send(client, 0, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
+#ifdef ZLIB
+        http_client_end_encoding(client);
+#endif
+        if (client->kind == CLIENT_CHUNKED || client->kind == CLIENT_SSE) {
             mg_send_http_chunk(nc, "", 0);            /* Send empty chunk, the end of response */
         }
-        else if (cctx && !cctx->is_chunked) {
-            mg_send(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
-            mg_send(nc, "\r\n", 2);
+
+        http_client_free(client);
+    }
+    list_free_elems(&ctx->clients, NULL);
+
+    // detach the remaining connections
+    struct mg_mgr *mgr = ctx->conn->mgr;
+    for (struct mg_connection *nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
+        if (nc->handler == ev_handler && nc->user_data == ctx)
+            nc->user_data = NULL;
+    }
+    list_free_elems(&ctx->calls, (list_elem_free_fn)http_call_free);
+
+#ifdef THREADS
+    // flush the goodbyes, the server event loop is not polled anymore
+    for (int i = 0; i < 10; ++i) {
+        int pending = 0;
+        for (struct mg_connection *nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
+            pending |= nc->send_mbuf.len > 0;
         }
+        if (!pending)
+            break;
+        mg_mgr_poll(mgr, 10);
     }
+    mg_mgr_free(&ctx->own_mgr);
+#endif
 
-    for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-        free((data_t *)*iter);
-    ring_list_free(ctx->history);
+    history_free(&ctx->history);
+#ifdef ZLIB
+    for (int i = 0; i < FRAMES; ++i) {
+        if (ctx->streams[i].ready)
+            deflateEnd(&ctx->streams[i].zs);
+    }
+    if (ctx->alone.ready)
+        deflateEnd(&ctx->alone.zs);
+    if (ctx->inflate_ready)
+        inflateEnd(&ctx->inflate);
+    mbuf_free(&ctx->scratch);
+#endif
 
     free(ctx);
 
@@ -1269,6 +3310,7 @@ static int http_server_stop(struct http_server_context *ctx)
 typedef struct {
     struct data_output output;
     struct http_server_context *server;
+    event_store_t *store;
 } data_output_http_t;
 
 static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data, char const *format)
@@ -1276,31 +3318,25 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
     UNUSED(format);
     data_output_http_t *http = (data_output_http_t *)output;
 
-    // collect well-known top level keys
-    data_t *data_model = NULL;
-    for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "model"))
-            data_model = d;
-    }
-
-    if (data_model) {
-        // "events"
-        char buf[2048]; // we expect the biggest strings to be around 500 bytes.
-        size_t len = data_print_jsons(data, buf, sizeof(buf));
-        http_broadcast_send(http->server, buf, len);
-    }
-    else {
-        // "states"
-        size_t buf_size = 20000; // state message need a large buffer
-        char *buf       = malloc(buf_size);
-        if (!buf) {
-            WARN_MALLOC("print_http_data()");
-            return; // NOTE: skip output on alloc failure.
-        }
-        size_t len = data_print_jsons(data, buf, buf_size);
-        http_broadcast_send(http->server, buf, len);
-        free(buf);
+    // "events" and "states" share the JSON text of the other outputs
+    size_t len;
+    char const *buf = data_output_jsons(output, data, &len);
+    if (!buf) {
+        return; // NOTE: skip output on alloc failure.
+    }
+    // the events are stored as sent, the logs have no model and are not stored
+    if (http->store) {
+        struct timeval now;
+        get_time_now(&now);
+        event_store_append(http->store, data, buf, len, (int64_t)now.tv_sec * 1000000 + now.tv_usec);
+    }
+#ifdef THREADS
+    if (http->server->threaded) {
+        http_server_queue_event(http->server, buf, len);
+        return;
     }
+#endif
+    http_broadcast_send(http->server, buf, len);
 }
 
 static void R_API_CALLCONV data_output_http_free(data_output_t *output)
@@ -1311,11 +3347,18 @@ static void R_API_CALLCONV data_output_http_free(data_output_t *output)
         return;
 
     http_server_stop(http->server);
+    event_store_close(http->store);
 
     free(http);
 }
 
-struct data_output *data_output_http_create(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg)
+size_t http_server_bytes(unsigned client_bytes, unsigned history_bytes)
+{
+    return (size_t)(client_bytes ? client_bytes : CLIENT_QUEUE_BYTES)
+            + (history_bytes ? history_bytes : DEFAULT_HISTORY_BYTES);
+}
+
+struct data_output *data_output_http_create(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg, unsigned client_bytes, unsigned history_bytes, event_store_t *store)
 {
     data_output_http_t *http = calloc(1, sizeof(data_output_http_t));
     if (!http) {
@@ -1327,10 +3370,12 @@ struct data_output *data_output_http_create(struct mg_mgr *mgr, char const *host
     http->output.print_data   = print_http_data;
     http->output.output_free  = data_output_http_free;
 
-    http->server = http_server_start(mgr, host, port, cfg, &http->output);
+    http->server = http_server_start(mgr, host, port, cfg, &http->output, client_bytes, history_bytes);
     if (!http->server) {
         exit(1);
     }
+    http->store         = store;
+    http->server->store = store;
 
     return (struct data_output *)http;
 }
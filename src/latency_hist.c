@@ -0,0 +1,68 @@
+/** @file
+    Log scale histogram of delays.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "latency_hist.h"
+
+unsigned const latency_hist_bounds_us[LATENCY_HIST_US_BINS - 1] = {
+        10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000};
+
+void latency_hist_add(latency_hist_t *hist, int64_t delay_us)
+{
+    unsigned us = delay_us <= 0 ? 0 : delay_us >= UINT32_MAX ? UINT32_MAX : (unsigned)delay_us;
+
+    unsigned bin = 0;
+    while (bin < LATENCY_HIST_US_BINS - 1 && us >= latency_hist_bounds_us[bin]) {
+        bin++;
+    }
+    hist->counts[bin] += 1;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+}
+
+void latency_hist_merge(latency_hist_t *hist, latency_hist_t const *other)
+{
+    for (unsigned i = 0; i < LATENCY_HIST_US_BINS; ++i) {
+        hist->counts[i] += other->counts[i];
+    }
+    if (other->max_us > hist->max_us) {
+        hist->max_us = other->max_us;
+    }
+}
+
+unsigned latency_hist_count(latency_hist_t const *hist)
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < LATENCY_HIST_US_BINS; ++i) {
+        count += hist->counts[i];
+    }
+    return count;
+}
+
+unsigned latency_hist_percentile(latency_hist_t const *hist, unsigned pct)
+{
+    unsigned count = latency_hist_count(hist);
+    if (!count) {
+        return 0;
+    }
+    // the rank of the percentile, at least the first delay
+    uint64_t rank = ((uint64_t)count * (pct > 100 ? 100 : pct) + 99) / 100;
+    rank = rank ? rank : 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LATENCY_HIST_US_BINS - 1; ++i) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            return latency_hist_bounds_us[i] < hist->max_us ? latency_hist_bounds_us[i] : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
@@ -0,0 +1,111 @@
+/** @file
+    Load shedding of an input that can't keep up with its samples.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "load_shed.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+
+/// Signal time the load is smoothed over.
+#define LOAD_SHED_SMOOTH_NS 1000000000ULL
+/// Signal time a step is held before the next step is taken.
+#define LOAD_SHED_RAISE_HOLD_NS 3000000000ULL
+/// Signal time a step is held before it is undone.
+#define LOAD_SHED_LOWER_HOLD_NS 10000000000ULL
+
+struct load_shed {
+    float high;
+    float low;
+    float load;
+    int measured;            ///< a buffer was accounted
+    load_shed_step_t step;
+    uint64_t held_ns;        ///< signal time since the last step
+    unsigned raised[LOAD_SHED_STEPS];
+    unsigned lowered[LOAD_SHED_STEPS];
+    uint64_t step_ns[LOAD_SHED_STEPS];
+};
+
+load_shed_t *load_shed_create(float high, float low)
+{
+    if (high <= 0.0f || low >= high)
+        return NULL;
+
+    load_shed_t *shed = calloc(1, sizeof(*shed));
+    if (!shed) {
+        WARN_CALLOC("load_shed_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    shed->high = high;
+    shed->low  = low;
+    return shed;
+}
+
+void load_shed_free(load_shed_t *shed)
+{
+    free(shed);
+}
+
+load_shed_step_t load_shed_buffer(load_shed_t *shed, uint64_t busy_ns, uint64_t duration_ns)
+{
+    if (!duration_ns)
+        return shed->step;
+
+    // an exponential average weighted by the signal time, a long buffer counts more
+    float load = (float)busy_ns / duration_ns;
+    if (!shed->measured) {
+        shed->load     = load;
+        shed->measured = 1;
+    }
+    else {
+        float weight = duration_ns >= LOAD_SHED_SMOOTH_NS ? 1.0f : (float)duration_ns / LOAD_SHED_SMOOTH_NS;
+        shed->load += (load - shed->load) * weight;
+    }
+    shed->held_ns += duration_ns;
+    shed->step_ns[shed->step] += duration_ns;
+
+    if (shed->load > shed->high && shed->step < LOAD_SHED_STEPS - 1 && shed->held_ns >= LOAD_SHED_RAISE_HOLD_NS) {
+        shed->step += 1;
+        shed->raised[shed->step] += 1;
+        shed->held_ns = 0;
+    }
+    else if (shed->load < shed->low && shed->step > LOAD_SHED_OFF && shed->held_ns >= LOAD_SHED_LOWER_HOLD_NS) {
+        shed->lowered[shed->step] += 1;
+        shed->step -= 1;
+        shed->held_ns = 0;
+    }
+    return shed->step;
+}
+
+load_shed_step_t load_shed_step(load_shed_t const *shed)
+{
+    return shed->step;
+}
+
+float load_shed_load(load_shed_t const *shed)
+{
+    return shed->load;
+}
+
+unsigned load_shed_raised(load_shed_t const *shed, load_shed_step_t step)
+{
+    return step < LOAD_SHED_STEPS ? shed->raised[step] : 0;
+}
+
+unsigned load_shed_lowered(load_shed_t const *shed, load_shed_step_t step)
+{
+    return step < LOAD_SHED_STEPS ? shed->lowered[step] : 0;
+}
+
+uint64_t load_shed_step_ms(load_shed_t const *shed, load_shed_step_t step)
+{
+    return step < LOAD_SHED_STEPS ? shed->step_ns[step] / 1000000 : 0;
+}
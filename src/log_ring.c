@@ -0,0 +1,112 @@
+/** @file
+    Lock-free ring of log messages, queued by the worker threads for the event loop.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "log_ring.h"
+
+#include "compat_atomic.h"
+#include "compat_pthread.h"
+
+#include <stdio.h>
+
+/// A slot of the ring, the sequence tells if it is free or holds a message for a position.
+typedef struct log_slot {
+    unsigned seq; ///< the position it is free for, or the position plus one once it holds a message
+    log_level_t level;
+    char src[32];
+    char msg[256];
+} log_slot_t;
+
+// a bounded multi-producer queue with one consumer, after D. Vyukov
+static log_slot_t slots[LOG_RING_SIZE];
+static unsigned head;    ///< the next position to queue at
+static unsigned tail;    ///< the next position to drain, only used by the consumer
+static unsigned dropped; ///< the messages dropped with the ring full
+static int active;
+
+#ifdef THREADS
+static pthread_t consumer;
+#endif
+
+void log_ring_start(void)
+{
+#ifdef THREADS
+    for (unsigned i = 0; i < LOG_RING_SIZE; ++i) {
+        slots[i].seq = head + i;
+    }
+    tail     = head;
+    consumer = pthread_self();
+    atomic_store_release(&active, 1);
+#endif
+}
+
+void log_ring_stop(void)
+{
+    atomic_store_release(&active, 0);
+}
+
+int log_ring_defer(void)
+{
+#ifdef THREADS
+    return atomic_load_acquire(&active) && !pthread_equal(pthread_self(), consumer);
+#else
+    return 0;
+#endif
+}
+
+int log_ring_push(log_level_t level, char const *src, char const *msg)
+{
+    unsigned pos = atomic_load_acquire(&head);
+    log_slot_t *slot;
+    for (;;) {
+        slot     = &slots[pos % LOG_RING_SIZE];
+        int diff = (int)(atomic_load_acquire(&slot->seq) - pos);
+        if (diff == 0) {
+            // the slot is free for this position, claim it
+            if (atomic_cas_unsigned(&head, pos, pos + 1))
+                break;
+            pos = atomic_load_acquire(&head);
+        }
+        else if (diff < 0) {
+            // the slot still holds the message of a lap before
+            atomic_fetch_add_unsigned(&dropped, 1);
+            return -1;
+        }
+        else {
+            // another thread claimed the position
+            pos = atomic_load_acquire(&head);
+        }
+    }
+    slot->level = level;
+    snprintf(slot->src, sizeof(slot->src), "%s", src);
+    snprintf(slot->msg, sizeof(slot->msg), "%s", msg);
+    atomic_store_release(&slot->seq, pos + 1);
+    return 0;
+}
+
+unsigned log_ring_drain(log_ring_handler_fn handler, void *ctx)
+{
+    unsigned count = 0;
+    for (;;) {
+        log_slot_t *slot = &slots[tail % LOG_RING_SIZE];
+        if (atomic_load_acquire(&slot->seq) != tail + 1)
+            break; // empty, or the message is still being written
+        handler(slot->level, slot->src, slot->msg, ctx);
+        atomic_store_release(&slot->seq, tail + LOG_RING_SIZE);
+        tail += 1;
+        count += 1;
+    }
+    return count;
+}
+
+unsigned log_ring_dropped(void)
+{
+    return atomic_load_acquire(&dropped);
+}
@@ -12,10 +12,14 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 #include <logger.h>
+#include "compat_atomic.h"
 
 static r_logger_handler logger_handler = NULL;
 static void *logger_handler_userdata   = NULL;
+/// Guards the handler and userdata pair, the handler is called outside the lock.
+static unsigned logger_lock;
 
 static void default_handler(log_level_t level, char const *src, char const *msg)
 {
@@ -25,14 +29,21 @@ static void default_handler(log_level_t level, char const *src, char const *msg)
 
 void r_logger_set_log_handler(r_logger_handler const handler, void *userdata)
 {
+    atomic_spin_lock(&logger_lock);
     logger_handler = handler;
     logger_handler_userdata = userdata;
+    atomic_spin_unlock(&logger_lock);
 }
 
 void print_log(log_level_t level, char const *src, char const *msg)
 {
-    if (logger_handler) {
-        logger_handler(level, src, msg, logger_handler_userdata);
+    atomic_spin_lock(&logger_lock);
+    r_logger_handler handler = logger_handler;
+    void *userdata           = logger_handler_userdata;
+    atomic_spin_unlock(&logger_lock);
+
+    if (handler) {
+        handler(level, src, msg, userdata);
     }
     else {
         default_handler(level, src, msg);
@@ -48,3 +59,40 @@ void print_logf(log_level_t level, char const *src, char const *fmt, ...)
     va_end(ap);
     print_log(level, src, msg);
 }
+
+/// Messages suppressed by the rate limits of all call sites.
+static unsigned suppressed_total;
+
+void print_logf_limit(log_limit_t *limit, log_level_t level, char const *src, char const *fmt, ...)
+{
+    // a race on a new interval only lets a message more or less through
+    long window = (long)(time(NULL) / LOG_LIMIT_SECS);
+    if (atomic_load_acquire(&limit->window) != window) {
+        atomic_store_release(&limit->window, window);
+        atomic_store_release(&limit->count, 0);
+    }
+    if (atomic_fetch_add_unsigned(&limit->count, 1) >= LOG_LIMIT_BURST) {
+        atomic_fetch_add_unsigned(&limit->suppressed, 1);
+        atomic_fetch_add_unsigned(&suppressed_total, 1);
+        return;
+    }
+
+    char msg[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    unsigned suppressed = atomic_load_acquire(&limit->suppressed);
+    if (suppressed) {
+        atomic_fetch_sub_unsigned(&limit->suppressed, suppressed);
+        if (len >= 0 && (size_t)len < sizeof(msg))
+            snprintf(msg + len, sizeof(msg) - len, " (%u similar messages suppressed)", suppressed);
+    }
+    print_log(level, src, msg);
+}
+
+unsigned print_log_suppressed(void)
+{
+    return atomic_load_acquire(&suppressed_total);
+}
@@ -0,0 +1,184 @@
+/** @file
+    Manchester decoded rows shared by the decoders of one slice group.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "manchester_view.h"
+
+#include "bitbuffer.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the 8 bits from @p bit on, the bits need to be in the array, an aligned read takes one byte only
+static inline unsigned byte_at(uint8_t const *bytes, unsigned bit)
+{
+    if (bit & 7)
+        return (unsigned)(bytes[bit >> 3] << (bit & 7) | bytes[(bit >> 3) + 1] >> (8 - (bit & 7))) & 0xff;
+    return bytes[bit >> 3];
+}
+
+// gather the bits 6, 4, 2, 0 into a nibble
+static inline unsigned even_bits(unsigned v)
+{
+    return (v & 1) | (v >> 1 & 2) | (v >> 2 & 4) | (v >> 3 & 8);
+}
+
+static unsigned phase_pairs(unsigned len, unsigned phase)
+{
+    return len > phase ? (len - phase) / 2 : 0;
+}
+
+static void view_reserve(manchester_view_t *view, unsigned rows, unsigned size)
+{
+    if (rows > view->rows_size) {
+        unsigned *offsets = realloc(view->offsets, rows * sizeof(*offsets));
+        if (!offsets) {
+            FATAL_REALLOC("manchester_view_run()");
+        }
+        view->offsets   = offsets;
+        view->rows_size = rows;
+    }
+    if (size > view->size) {
+        uint8_t *decoded = realloc(view->decoded, size);
+        if (!decoded) {
+            FATAL_REALLOC("manchester_view_run()");
+        }
+        view->decoded = decoded;
+        uint8_t *invalid = realloc(view->invalid, size);
+        if (!invalid) {
+            FATAL_REALLOC("manchester_view_run()");
+        }
+        view->invalid = invalid;
+        view->size    = size;
+    }
+}
+
+static void manchester_view_run(manchester_view_t *view)
+{
+    bitbuffer_t const *source = view->source;
+
+    // one padding byte for each phase, the reads of the decoded bits may take one byte past the last
+    unsigned size = 0;
+    for (unsigned row = 0; row < source->num_rows; ++row) {
+        for (unsigned phase = 0; phase < 2; ++phase) {
+            size += (phase_pairs(source->bits_per_row[row], phase) + 7) / 8 + 1;
+        }
+    }
+    view_reserve(view, source->num_rows * 2 + 1, size);
+    memset(view->decoded, 0, size);
+    memset(view->invalid, 0, size);
+
+    unsigned pos = 0;
+    for (unsigned row = 0; row < source->num_rows; ++row) {
+        // a long row spills into the following rows, the bits of each row are contiguous
+        uint8_t const *bits = source->bb[row];
+        unsigned len        = source->bits_per_row[row];
+        for (unsigned phase = 0; phase < 2; ++phase) {
+            view->offsets[row * 2 + phase] = pos;
+            uint8_t *decoded = &view->decoded[pos];
+            uint8_t *invalid = &view->invalid[pos];
+            unsigned pairs   = phase_pairs(len, phase);
+            // four pairs at a time
+            unsigned k = 0;
+            for (; k + 4 <= pairs; k += 4) {
+                unsigned v      = byte_at(bits, phase + k * 2);
+                unsigned second = v & 0x55;
+                unsigned equal  = ~(v >> 1 ^ v) & 0x55;
+                unsigned shift  = k & 4 ? 0 : 4;
+                decoded[k / 8] |= even_bits(second) << shift;
+                invalid[k / 8] |= even_bits(equal) << shift;
+            }
+            for (; k < pairs; ++k) {
+                unsigned bit1 = bitrow_get_bit(bits, phase + k * 2);
+                unsigned bit2 = bitrow_get_bit(bits, phase + k * 2 + 1);
+                decoded[k / 8] |= bit2 << (7 - k % 8);
+                invalid[k / 8] |= (bit1 == bit2) << (7 - k % 8);
+            }
+            pos += (pairs + 7) / 8 + 1;
+        }
+    }
+    view->offsets[source->num_rows * 2] = pos;
+    view->done = 1;
+}
+
+// the first set bit from @p from on, @p to if none
+static unsigned first_set(uint8_t const *bitmap, unsigned from, unsigned to)
+{
+    unsigned k = from;
+    while (k < to && k & 7) {
+        if (bitmap[k / 8] >> (7 - k % 8) & 1)
+            return k;
+        k++;
+    }
+    while (k + 8 <= to && !bitmap[k / 8])
+        k += 8;
+    for (; k < to; ++k) {
+        if (bitmap[k / 8] >> (7 - k % 8) & 1)
+            return k;
+    }
+    return to;
+}
+
+unsigned manchester_view_decode(manchester_view_t *view, bitbuffer_t *inbuf, unsigned row, unsigned start,
+        bitbuffer_t *outbuf, unsigned max)
+{
+    bitbuffer_t const *source = view->source;
+    if (inbuf != view->bits || row >= source->num_rows || inbuf->bits_per_row[row] != source->bits_per_row[row])
+        return MANCHESTER_VIEW_UNKNOWN;
+
+    unsigned len = source->bits_per_row[row];
+    if (start >= len)
+        return start;
+    // the bits need to be unchanged or inverted in full, check the bits of the row in the first byte decoded
+    uint8_t const *got  = inbuf->bb[row];
+    uint8_t const *want = source->bb[row];
+    unsigned in_byte    = len - start / 8 * 8;
+    unsigned mask       = in_byte < 8 ? 0xff00 >> in_byte & 0xff : 0xff;
+    unsigned diff       = (got[start / 8] ^ want[start / 8]) & mask;
+    if (diff && diff != mask)
+        return MANCHESTER_VIEW_UNKNOWN;
+    unsigned invert = diff ? 0xff : 0;
+
+    if (!view->done)
+        manchester_view_run(view);
+
+    unsigned end = len;
+    if (max && end > start + max * 2)
+        end = start + max * 2;
+    unsigned phase = start & 1;
+    unsigned first = start / 2;
+    unsigned pairs = (end - start) / 2;
+    unsigned pos   = view->offsets[row * 2 + phase];
+    unsigned valid = first_set(&view->invalid[pos], first, first + pairs) - first;
+
+    uint8_t const *decoded = &view->decoded[pos];
+    for (unsigned k = 0; k < valid; k += 8) {
+        unsigned n = valid - k < 8 ? valid - k : 8;
+        bitbuffer_add_bits(outbuf, byte_at(decoded, first + k) ^ invert, n);
+    }
+    if (valid < pairs)
+        return start + valid * 2 + 2; // the invalid pair is taken
+    if (start + pairs * 2 < end)
+        return bitbuffer_manchester_decode(inbuf, row, start + pairs * 2, outbuf, 0); // the last pair reads past the row
+    return end;
+}
+
+void manchester_view_free(manchester_view_t *view)
+{
+    free(view->offsets);
+    free(view->decoded);
+    free(view->invalid);
+    view->offsets   = NULL;
+    view->decoded   = NULL;
+    view->invalid   = NULL;
+    view->rows_size = 0;
+    view->size      = 0;
+}
@@ -0,0 +1,179 @@
+/** @file
+    Memory accounting of the subsystems that grow at runtime.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "mem_acct.h"
+
+#include "mongoose.h"
+#include "compat_atomic.h"
+#include "data.h"
+#include "list.h"
+#include "optparse.h"
+#include "logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The size is kept in front of each allocation, padded to keep the alignment of malloc().
+typedef union {
+    size_t size;
+    long double align_ld;
+    long long align_ll;
+    void *align_p;
+} mem_header_t;
+
+typedef struct mem_counter {
+    unsigned bytes;     ///< the counters are updated from any thread
+    unsigned max_bytes;
+    unsigned shed;
+    size_t limit;       ///< set before the threads are started
+} mem_counter_t;
+
+static char const *const tag_names[MEM_TAGS] = {"network", "http", "influx", "mqtt", "decoders"};
+
+static mem_counter_t counters[MEM_TAGS];
+
+static void mem_count_add(mem_counter_t *c, size_t size)
+{
+    unsigned bytes = atomic_fetch_add_unsigned(&c->bytes, (unsigned)size) + (unsigned)size;
+    unsigned max   = atomic_load_acquire(&c->max_bytes);
+    while (bytes > max && !atomic_cas_unsigned(&c->max_bytes, max, bytes)) {
+        max = atomic_load_acquire(&c->max_bytes);
+    }
+}
+
+static void mem_count_sub(mem_counter_t *c, size_t size)
+{
+    atomic_fetch_sub_unsigned(&c->bytes, (unsigned)size);
+}
+
+static void mbuf_size_acct(struct mbuf *mbuf, long delta)
+{
+    mem_acct_add(mbuf->tag >= 0 && mbuf->tag < MEM_TAGS ? (mem_tag_t)mbuf->tag : MEM_TAG_NETWORK, delta);
+}
+
+void mem_acct_init(void)
+{
+    mbuf_size_cb = mbuf_size_acct;
+}
+
+void *mem_get(mem_tag_t tag, size_t size)
+{
+    mem_header_t *hdr = malloc(sizeof(*hdr) + size);
+    if (!hdr) {
+        return NULL;
+    }
+    hdr->size = size;
+    mem_count_add(&counters[tag], size);
+    return hdr + 1;
+}
+
+void *mem_get_zero(mem_tag_t tag, size_t nmemb, size_t size)
+{
+    if (size && nmemb > ((size_t)-1 - sizeof(mem_header_t)) / size) {
+        return NULL;
+    }
+    mem_header_t *hdr = calloc(1, sizeof(*hdr) + nmemb * size);
+    if (!hdr) {
+        return NULL;
+    }
+    hdr->size = nmemb * size;
+    mem_count_add(&counters[tag], hdr->size);
+    return hdr + 1;
+}
+
+char *mem_dup(mem_tag_t tag, char const *str)
+{
+    size_t len = strlen(str) + 1;
+    char *dup  = mem_get(tag, len);
+    if (!dup) {
+        return NULL;
+    }
+    memcpy(dup, str, len);
+    return dup;
+}
+
+void mem_put(mem_tag_t tag, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    mem_header_t *hdr = (mem_header_t *)ptr - 1;
+    mem_count_sub(&counters[tag], hdr->size);
+    free(hdr);
+}
+
+void mem_acct_add(mem_tag_t tag, long delta)
+{
+    if (delta > 0) {
+        mem_count_add(&counters[tag], (size_t)delta);
+    }
+    else if (delta < 0) {
+        mem_count_sub(&counters[tag], (size_t)-delta);
+    }
+}
+
+int mem_acct_set_limit(char const *name, size_t limit)
+{
+    for (int i = 0; i < MEM_TAGS; ++i) {
+        if (name && !strcasecmp(name, tag_names[i])) {
+            counters[i].limit = limit;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int mem_acct_over(mem_tag_t tag)
+{
+    mem_counter_t *c = &counters[tag];
+    return c->limit && atomic_load_acquire(&c->bytes) > c->limit;
+}
+
+void mem_acct_shed(mem_tag_t tag)
+{
+    mem_counter_t *c = &counters[tag];
+    if (atomic_fetch_add_unsigned(&c->shed, 1) == 0) {
+        print_logf(LOG_WARNING, "Memory", "The %s memory is over the limit of %zu kB, shedding to get below",
+                tag_names[tag], c->limit / 1024);
+    }
+}
+
+void mem_acct_get(mem_tag_t tag, mem_acct_stats_t *stats)
+{
+    mem_counter_t *c = &counters[tag];
+    stats->name      = tag_names[tag];
+    stats->bytes     = atomic_load_acquire(&c->bytes);
+    stats->max_bytes = atomic_load_acquire(&c->max_bytes);
+    stats->limit     = c->limit;
+    stats->shed      = atomic_load_acquire(&c->shed);
+}
+
+data_array_t *mem_acct_data(void)
+{
+    list_t subsystems = {0};
+    list_ensure_size(&subsystems, MEM_TAGS + 1); // account for terminating NULL
+
+    for (int i = 0; i < MEM_TAGS; ++i) {
+        mem_acct_stats_t s;
+        mem_acct_get((mem_tag_t)i, &s);
+        list_push(&subsystems, data_make(
+                "subsystem", "", DATA_STRING, s.name,
+                "bytes",     "", DATA_INT, (int)s.bytes,
+                "max_bytes", "", DATA_INT, (int)s.max_bytes,
+                "limit",     "", DATA_COND, s.limit > 0, DATA_INT, (int)s.limit,
+                "shed",      "", DATA_COND, s.limit > 0, DATA_INT, (int)s.shed,
+                NULL));
+    }
+
+    data_array_t *array = data_array(subsystems.len, DATA_DATA, subsystems.elems);
+    list_free_elems(&subsystems, NULL);
+    return array;
+}
@@ -154,7 +154,8 @@ MG_INTERNAL void mg_ws_handler(struct mg_connection *nc, int ev,
                                void *ev_data MG_UD_ARG(void *user_data));
 MG_INTERNAL void mg_ws_handshake(struct mg_connection *nc,
                                  const struct mg_str *key,
-                                 struct http_message *);
+                                 struct http_message *,
+                                 const char *extra_headers);
 #endif
 #endif /* MG_ENABLE_HTTP */
 
@@ -1547,18 +1548,29 @@ void cs_hmac_sha1(const unsigned char *key, size_t keylen,
 #define MBUF_FREE free
 #endif
 
+void (*mbuf_size_cb)(struct mbuf *, long delta) = NULL;
+
+static void mbuf_account(struct mbuf *mbuf, size_t new_size) {
+  if (mbuf_size_cb != NULL && new_size != mbuf->size) {
+    mbuf_size_cb(mbuf, (long) new_size - (long) mbuf->size);
+  }
+}
+
 void mbuf_init(struct mbuf *mbuf, size_t initial_size) WEAK;
 void mbuf_init(struct mbuf *mbuf, size_t initial_size) {
   mbuf->len = mbuf->size = 0;
   mbuf->buf = NULL;
+  mbuf->tag = 0;
   mbuf_resize(mbuf, initial_size);
 }
 
 void mbuf_free(struct mbuf *mbuf) WEAK;
 void mbuf_free(struct mbuf *mbuf) {
   if (mbuf->buf != NULL) {
+    mbuf_account(mbuf, 0);
     MBUF_FREE(mbuf->buf);
-    mbuf_init(mbuf, 0);
+    mbuf->len = mbuf->size = 0;
+    mbuf->buf = NULL;
   }
 }
 
@@ -1572,6 +1584,7 @@ void mbuf_resize(struct mbuf *a, size_t new_size) {
      * size == 0, but that is covered too.
      */
     if (buf == NULL && new_size != 0) return;
+    mbuf_account(a, new_size);
     a->buf = buf;
     a->size = new_size;
   }
@@ -1611,6 +1624,7 @@ size_t mbuf_insert(struct mbuf *a, size_t off, const void *buf, size_t len) {
       p = (char *) MBUF_REALLOC(a->buf, new_size);
     }
     if (p != NULL) {
+      mbuf_account(a, new_size);
       a->buf = p;
       if (off != a->len) {
         memmove(a->buf + off + len, a->buf + off, a->len - off);
@@ -1637,6 +1651,7 @@ size_t mbuf_append_and_free(struct mbuf *a, void *data, size_t len) {
   /* Optimization: if the buffer is currently empty,
    * take over the user-provided buffer. */
   if (a->len == 0) {
+    mbuf_account(a, len);
     if (a->buf != NULL) free(a->buf);
     a->buf = (char *) data;
     a->len = a->size = len;
@@ -4729,6 +4744,7 @@ struct mg_ssl_if_ctx {
   SSL_CTX *ssl_ctx;
   struct mbuf psk;
   size_t identity_len;
+  double handshake_start;
 };
 
 void mg_ssl_if_init() {
@@ -4856,12 +4872,48 @@ enum mg_ssl_if_result mg_ssl_if_handshake(struct mg_connection *nc) {
   /* If descriptor is not yet set, do it now. */
   if (SSL_get_fd(ctx->ssl) < 0) {
     if (SSL_set_fd(ctx->ssl, nc->sock) != 1) return MG_SSL_ERROR;
+    ctx->handshake_start = mg_time();
   }
   res = server_side ? SSL_accept(ctx->ssl) : SSL_connect(ctx->ssl);
   if (res != 1) return mg_ssl_if_ssl_err(nc, res);
   return MG_SSL_OK;
 }
 
+void *mg_ssl_if_get1_session(struct mg_connection *nc) {
+  struct mg_ssl_if_ctx *ctx = (struct mg_ssl_if_ctx *) nc->ssl_if_data;
+  SSL_SESSION *session;
+  if (ctx == NULL || ctx->ssl == NULL) return NULL;
+  session = SSL_get1_session(ctx->ssl);
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+  if (session != NULL && !SSL_SESSION_is_resumable(session)) {
+    SSL_SESSION_free(session);
+    session = NULL;
+  }
+#endif
+  return session;
+}
+
+int mg_ssl_if_set_session(struct mg_connection *nc, void *session) {
+  struct mg_ssl_if_ctx *ctx = (struct mg_ssl_if_ctx *) nc->ssl_if_data;
+  if (ctx == NULL || ctx->ssl == NULL || session == NULL) return 0;
+  return SSL_set_session(ctx->ssl, (SSL_SESSION *) session) == 1;
+}
+
+int mg_ssl_if_session_reused(struct mg_connection *nc) {
+  struct mg_ssl_if_ctx *ctx = (struct mg_ssl_if_ctx *) nc->ssl_if_data;
+  if (ctx == NULL || ctx->ssl == NULL) return 0;
+  return SSL_session_reused(ctx->ssl);
+}
+
+void mg_ssl_if_session_free(void *session) {
+  SSL_SESSION_free((SSL_SESSION *) session);
+}
+
+double mg_ssl_if_handshake_start(struct mg_connection *nc) {
+  struct mg_ssl_if_ctx *ctx = (struct mg_ssl_if_ctx *) nc->ssl_if_data;
+  return ctx != NULL ? ctx->handshake_start : 0;
+}
+
 int mg_ssl_if_read(struct mg_connection *nc, void *buf, size_t buf_size) {
   struct mg_ssl_if_ctx *ctx = (struct mg_ssl_if_ctx *) nc->ssl_if_data;
   int n = SSL_read(ctx->ssl, buf, buf_size);
@@ -6772,7 +6824,7 @@ void mg_http_handler(struct mg_connection *nc, int ev,
               hm);
       if (!(nc->flags & (MG_F_CLOSE_IMMEDIATELY | MG_F_SEND_AND_CLOSE))) {
         if (nc->send_mbuf.len == 0) {
-          mg_ws_handshake(nc, vec, hm);
+          mg_ws_handshake(nc, vec, hm, NULL);
         }
         mg_call(nc, nc->handler, nc->user_data, MG_EV_WEBSOCKET_HANDSHAKE_DONE,
                 hm);
@@ -10251,7 +10303,8 @@ static void mg_send_ws_header(struct mg_connection *nc, int op, size_t len,
   unsigned char header[10];
 
   header[0] =
-      (op & WEBSOCKET_DONT_FIN ? 0x0 : FLAGS_MASK_FIN) | (op & FLAGS_MASK_OP);
+      (op & WEBSOCKET_DONT_FIN ? 0x0 : FLAGS_MASK_FIN) |
+      (op & WEBSOCKET_COMPRESSED) | (op & FLAGS_MASK_OP);
   if (len < 126) {
     header[1] = (unsigned char) len;
     header_len = 2;
@@ -10389,7 +10442,8 @@ extern void mg_hash_sha1_v(size_t num_msgs, const uint8_t *msgs[],
 
 MG_INTERNAL void mg_ws_handshake(struct mg_connection *nc,
                                  const struct mg_str *key,
-                                 struct http_message *hm) {
+                                 struct http_message *hm,
+                                 const char *extra_headers) {
   static const char *magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
   const uint8_t *msgs[2] = {(const uint8_t *) key->p, (const uint8_t *) magic};
   const size_t msg_lens[2] = {key->len, 36};
@@ -10408,11 +10462,23 @@ MG_INTERNAL void mg_ws_handshake(struct mg_connection *nc,
   if (s != NULL) {
     mg_printf(nc, "Sec-WebSocket-Protocol: %.*s\r\n", (int) s->len, s->p);
   }
+  if (extra_headers != NULL) {
+    mg_printf(nc, "%s", extra_headers);
+  }
   mg_printf(nc, "Sec-WebSocket-Accept: %s%s", b64_sha, "\r\n\r\n");
 
   DBG(("%p %.*s %s", nc, (int) key->len, key->p, b64_sha));
 }
 
+void mg_send_websocket_handshake_reply(struct mg_connection *nc,
+                                       struct http_message *hm,
+                                       const char *extra_headers) {
+  struct mg_str *key = mg_get_http_header(hm, "Sec-WebSocket-Key");
+  if (key != NULL) {
+    mg_ws_handshake(nc, key, hm, extra_headers);
+  }
+}
+
 void mg_send_websocket_handshake2(struct mg_connection *nc, const char *path,
                                   const char *host, const char *protocol,
                                   const char *extra_headers) {
@@ -301,6 +301,50 @@ int atoi_time(char const *str, char const *error_hint)
     return (int)val;
 }
 
+unsigned atoi_ms(char const *str, char const *error_hint)
+{
+    if (!str) {
+        fprintf(stderr, "%smissing time argument\n", error_hint);
+        exit(1);
+    }
+
+    char *endptr = NULL;
+    double val   = strtod(str, &endptr);
+
+    if (!endptr || str == endptr) {
+        fprintf(stderr, "%sinvalid time argument (%s)\n", error_hint, str);
+        exit(1);
+    }
+
+    // allow whitespace before suffix
+    while (*endptr == ' ' || *endptr == '\t')
+        ++endptr;
+
+    if ((endptr[0] == 'm' || endptr[0] == 'M') && (endptr[1] == 's' || endptr[1] == 'S')) {
+        endptr += 2;
+    }
+    else if (endptr[0] == 's' || endptr[0] == 'S') {
+        val *= 1000;
+        endptr += 1;
+    }
+
+    // chew up any remaining whitespace
+    while (*endptr == ' ' || *endptr == '\t')
+        ++endptr;
+
+    if (*endptr) {
+        fprintf(stderr, "%sunknown time suffix (%s)\n", error_hint, endptr);
+        exit(1);
+    }
+
+    if (val < 0 || val > UINT_MAX) {
+        fprintf(stderr, "%stime argument out of range (%f)\n", error_hint, val);
+        exit(1);
+    }
+
+    return (unsigned)(val + 0.5);
+}
+
 char *asepc(char **stringp, char delim)
 {
     if (!stringp || !*stringp) return NULL;
@@ -466,6 +510,14 @@ int main(void)
     ASSERT_EQUALS(atoi_time(" 2 : 3 ", ""), 2 * 60 * 60 + 3 * 60);
     ASSERT_EQUALS(atoi_time(" 2 : 3 : 4 ", ""), 2 * 60 * 60 + 3 * 60 + 4);
 
+    ASSERT_EQUALS(atoi_ms("0", ""), 0);
+    ASSERT_EQUALS(atoi_ms("250", ""), 250);
+    ASSERT_EQUALS(atoi_ms("250ms", ""), 250);
+    ASSERT_EQUALS(atoi_ms(" 250 MS ", ""), 250);
+    ASSERT_EQUALS(atoi_ms("2s", ""), 2000);
+    ASSERT_EQUALS(atoi_ms("1.5s", ""), 1500);
+    ASSERT_EQUALS(atoi_ms("0.5ms", ""), 1);
+
     fprintf(stderr, "optparse:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
 
     return failed;
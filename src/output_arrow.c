@@ -0,0 +1,892 @@
+/** @file
+    Arrow IPC file output for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_arrow.h"
+
+#include "data.h"
+#include "abuf.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Arrow columnar format, see https://arrow.apache.org/docs/format/Columnar.html */
+
+#define ARROW_METADATA_V5 4
+
+// MessageHeader union types
+#define ARROW_HEADER_SCHEMA 1
+#define ARROW_HEADER_RECORD_BATCH 3
+
+// Type union types
+#define ARROW_TYPE_NULL 1
+#define ARROW_TYPE_INT 2
+#define ARROW_TYPE_FLOATING_POINT 3
+#define ARROW_TYPE_UTF8 5
+
+/// Kind of a value in a row, also the type of a column.
+enum arrow_kind {
+    ARROW_NULL,
+    ARROW_INT,
+    ARROW_DOUBLE,
+    ARROW_TEXT,
+};
+
+/// A growable byte buffer.
+typedef struct arrow_buf {
+    uint8_t *data;
+    size_t len;
+    size_t size;
+} arrow_buf_t;
+
+static void arrow_buf_put(arrow_buf_t *buf, void const *bytes, size_t n)
+{
+    if (buf->len + n > buf->size) {
+        size_t size = buf->size ? buf->size * 2 : 1024;
+        while (size < buf->len + n)
+            size *= 2;
+        uint8_t *data = realloc(buf->data, size);
+        if (!data) {
+            FATAL_REALLOC("arrow_buf_put()");
+        }
+        buf->data = data;
+        buf->size = size;
+    }
+    if (n)
+        memcpy(buf->data + buf->len, bytes, n);
+    buf->len += n;
+}
+
+static void arrow_buf_le(arrow_buf_t *buf, uint64_t val, unsigned n)
+{
+    uint8_t bytes[8];
+    for (unsigned i = 0; i < n; ++i) {
+        bytes[i] = (uint8_t)(val >> (8 * i));
+    }
+    arrow_buf_put(buf, bytes, n);
+}
+
+// pad with zeros to a multiple of 8 bytes
+static void arrow_buf_align(arrow_buf_t *buf)
+{
+    static uint8_t const zeros[8] = {0};
+    arrow_buf_put(buf, zeros, (0 - buf->len) & 7);
+}
+
+/* Flatbuffers builder, just enough for the Arrow messages, see https://flatbuffers.dev/internals/
+
+   The bytes are built back to front at the end of the buffer, an object is referenced
+   by the number of bytes used when it was done, that is its distance to the end.
+*/
+
+#define FLATBUF_MAX_SLOTS 8
+
+typedef struct flatbuf {
+    uint8_t *buf;
+    size_t size;
+    size_t used;
+    size_t table_end;                 ///< bytes used at the start of the open table
+    unsigned num_slots;
+    size_t slots[FLATBUF_MAX_SLOTS]; ///< bytes used at each field of the open table, 0 if absent
+} flatbuf_t;
+
+static void fb_grow(flatbuf_t *fb, size_t n)
+{
+    if (fb->used + n <= fb->size)
+        return;
+    size_t size = fb->size ? fb->size * 2 : 1024;
+    while (size < fb->used + n)
+        size *= 2;
+    uint8_t *buf = malloc(size);
+    if (!buf) {
+        FATAL_MALLOC("fb_grow()");
+    }
+    if (fb->used)
+        memcpy(buf + size - fb->used, fb->buf + fb->size - fb->used, fb->used);
+    free(fb->buf);
+    fb->buf  = buf;
+    fb->size = size;
+}
+
+static void fb_push(flatbuf_t *fb, void const *bytes, size_t n)
+{
+    fb_grow(fb, n);
+    fb->used += n;
+    memcpy(fb->buf + fb->size - fb->used, bytes, n);
+}
+
+// pad so that the next @p extra bytes end aligned
+static void fb_pad(flatbuf_t *fb, size_t align, size_t extra)
+{
+    size_t pad = (0 - (fb->used + extra)) & (align - 1);
+    if (!pad)
+        return;
+    fb_grow(fb, pad);
+    fb->used += pad;
+    memset(fb->buf + fb->size - fb->used, 0, pad);
+}
+
+static void fb_le(flatbuf_t *fb, uint64_t val, unsigned n)
+{
+    uint8_t bytes[8];
+    for (unsigned i = 0; i < n; ++i) {
+        bytes[i] = (uint8_t)(val >> (8 * i));
+    }
+    fb_pad(fb, n, n);
+    fb_push(fb, bytes, n);
+}
+
+static void fb_offset(flatbuf_t *fb, size_t ref)
+{
+    fb_pad(fb, 4, 4);
+    fb_le(fb, fb->used + 4 - ref, 4);
+}
+
+static size_t fb_string(flatbuf_t *fb, char const *str)
+{
+    size_t len = strlen(str);
+    fb_pad(fb, 4, len + 1);
+    fb_push(fb, "", 1);
+    fb_push(fb, str, len);
+    fb_le(fb, len, 4);
+    return fb->used;
+}
+
+// a vector of structs, the elements are given as little-endian bytes
+static size_t fb_structs(flatbuf_t *fb, void const *bytes, size_t count, size_t elem_size)
+{
+    fb_pad(fb, 8, count * elem_size);
+    if (count)
+        fb_push(fb, bytes, count * elem_size);
+    fb_le(fb, count, 4);
+    return fb->used;
+}
+
+// a vector of tables
+static size_t fb_tables(flatbuf_t *fb, size_t const *refs, size_t count)
+{
+    fb_pad(fb, 4, 4 * count);
+    for (size_t i = count; i > 0; --i) {
+        fb_offset(fb, refs[i - 1]);
+    }
+    fb_le(fb, count, 4);
+    return fb->used;
+}
+
+static void fb_start(flatbuf_t *fb)
+{
+    fb->table_end = fb->used;
+    fb->num_slots = 0;
+    memset(fb->slots, 0, sizeof(fb->slots));
+}
+
+static void fb_slot(flatbuf_t *fb, unsigned slot)
+{
+    fb->slots[slot] = fb->used;
+    if (fb->num_slots <= slot)
+        fb->num_slots = slot + 1;
+}
+
+static void fb_add_scalar(flatbuf_t *fb, unsigned slot, uint64_t val, unsigned n)
+{
+    fb_le(fb, val, n);
+    fb_slot(fb, slot);
+}
+
+static void fb_add_offset(flatbuf_t *fb, unsigned slot, size_t ref)
+{
+    fb_offset(fb, ref);
+    fb_slot(fb, slot);
+}
+
+static size_t fb_end(flatbuf_t *fb)
+{
+    fb_le(fb, 0, 4); // placeholder for the offset to the vtable
+    size_t table = fb->used;
+
+    uint8_t vtable[4 + 2 * FLATBUF_MAX_SLOTS];
+    size_t vt_size  = 4 + 2 * fb->num_slots;
+    size_t fields[2 + FLATBUF_MAX_SLOTS];
+    fields[0] = vt_size;
+    fields[1] = table - fb->table_end;
+    for (unsigned i = 0; i < fb->num_slots; ++i) {
+        fields[2 + i] = fb->slots[i] ? table - fb->slots[i] : 0;
+    }
+    for (unsigned i = 0; i < 2 + fb->num_slots; ++i) {
+        vtable[2 * i]     = (uint8_t)fields[i];
+        vtable[2 * i + 1] = (uint8_t)(fields[i] >> 8);
+    }
+    fb_push(fb, vtable, vt_size);
+
+    // the vtable is before the table, at a lower address
+    size_t soffset = fb->used - table;
+    uint8_t *p = fb->buf + fb->size - table;
+    for (unsigned i = 0; i < 4; ++i) {
+        p[i] = (uint8_t)(soffset >> (8 * i));
+    }
+    return table;
+}
+
+// the finished buffer is a multiple of 8 bytes
+static uint8_t const *fb_finish(flatbuf_t *fb, size_t root)
+{
+    fb_pad(fb, 8, 4);
+    fb_offset(fb, root);
+    return fb->buf + fb->size - fb->used;
+}
+
+static void fb_reset(flatbuf_t *fb)
+{
+    fb->used = 0;
+}
+
+/* Arrow IPC file printer */
+
+/// The value of a row, the text is a slice of the column text.
+typedef struct arrow_value {
+    double num;
+    uint32_t start;
+    uint32_t len;
+} arrow_value_t;
+
+typedef struct arrow_column {
+    char const *name;
+    unsigned type;          ///< arrow_kind of the column, only widens, ARROW_NULL for the Null type
+    int warned;             ///< a value did not fit the type and was dropped
+    uint8_t *kinds;         ///< kind of the value of each row, NULL while there are none
+    arrow_value_t *values;
+    arrow_buf_t text;
+} arrow_column_t;
+
+/// Location of a message in the file.
+typedef struct arrow_block {
+    int64_t offset;
+    int32_t metadata_len;
+    int64_t body_len;
+} arrow_block_t;
+
+typedef struct {
+    struct data_output output;
+    FILE *file;
+    char *path;              ///< the path of the first file, NULL if the file can not be rolled over
+    unsigned num_files;      ///< files written before the open one
+    int started;             ///< the magic and the schema are written
+    uint64_t offset;         ///< bytes written to the file
+    unsigned num_columns;
+    arrow_column_t *columns;
+    unsigned index_mask;     ///< size of the index minus one, a power of two
+    unsigned *column_index;  ///< columns hashed by key, column + 1, 0 for an empty slot
+    unsigned rows;           ///< rows in the open batch
+    arrow_buf_t *nested;     ///< the text arrays and nested data are printed to
+    arrow_block_t *batches;
+    size_t num_batches;
+    flatbuf_t fb;
+    arrow_buf_t body;
+    arrow_buf_t scratch;
+} data_output_arrow_t;
+
+// FNV-1a hash of a key
+static unsigned arrow_key_hash(char const *key)
+{
+    unsigned h = 2166136261U;
+    for (; *key; ++key)
+        h = (h ^ (unsigned char)*key) * 16777619U;
+    return h;
+}
+
+static arrow_column_t *arrow_find_column(data_output_arrow_t *arrow, char const *key)
+{
+    if (!arrow->column_index)
+        return NULL;
+    for (unsigned h = arrow_key_hash(key);; ++h) {
+        unsigned slot = arrow->column_index[h & arrow->index_mask];
+        if (!slot)
+            return NULL;
+        if (!strcmp(arrow->columns[slot - 1].name, key))
+            return &arrow->columns[slot - 1];
+    }
+}
+
+/* nested values are printed as JSON text */
+
+static void arrow_nested_cat(data_output_arrow_t *arrow, char const *str)
+{
+    arrow_buf_put(arrow->nested, str, strlen(str));
+}
+
+static void R_API_CALLCONV print_arrow_array(data_output_t *output, data_array_t *array, char const *format)
+{
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    arrow_nested_cat(arrow, "[");
+    for (int c = 0; c < array->num_values; ++c) {
+        if (c)
+            arrow_nested_cat(arrow, ", ");
+        print_array_value(output, array, format, c);
+    }
+    arrow_nested_cat(arrow, "]");
+}
+
+static void R_API_CALLCONV print_arrow_data(data_output_t *output, data_t *data, char const *format)
+{
+    UNUSED(format);
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    arrow_nested_cat(arrow, "{");
+    for (data_t *d = data; d; d = d->next) {
+        if (d != data)
+            arrow_nested_cat(arrow, ", ");
+        output->print_string(output, d->key, NULL);
+        arrow_nested_cat(arrow, " : ");
+        print_value(output, d->type, d->value, d->format);
+    }
+    arrow_nested_cat(arrow, "}");
+}
+
+static void R_API_CALLCONV print_arrow_string(data_output_t *output, char const *str, char const *format)
+{
+    UNUSED(format);
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    arrow_nested_cat(arrow, "\"");
+    for (; *str; ++str) {
+        if (*str == '\r')
+            arrow_nested_cat(arrow, "\\r");
+        else if (*str == '\n')
+            arrow_nested_cat(arrow, "\\n");
+        else if (*str == '\t')
+            arrow_nested_cat(arrow, "\\t");
+        else if (*str == '"' || *str == '\\') {
+            arrow_nested_cat(arrow, "\\");
+            arrow_buf_put(arrow->nested, str, 1);
+        }
+        else
+            arrow_buf_put(arrow->nested, str, 1);
+    }
+    arrow_nested_cat(arrow, "\"");
+}
+
+static void R_API_CALLCONV print_arrow_double(data_output_t *output, double data, char const *format)
+{
+    UNUSED(format);
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    char buf[64];
+    abuf_t text = {0};
+    abuf_init(&text, buf, sizeof(buf));
+    abuf_print_double(&text, "%.3f", data);
+    arrow_nested_cat(arrow, buf);
+}
+
+static void R_API_CALLCONV print_arrow_int(data_output_t *output, int data, char const *format)
+{
+    UNUSED(format);
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    char buf[32];
+    abuf_t text = {0};
+    abuf_init(&text, buf, sizeof(buf));
+    abuf_print_int(&text, "%d", data);
+    arrow_nested_cat(arrow, buf);
+}
+
+/* messages */
+
+static void arrow_write(data_output_arrow_t *arrow, void const *bytes, size_t n)
+{
+    fwrite(bytes, 1, n, arrow->file);
+    arrow->offset += n;
+}
+
+// write an encapsulated message, the metadata is a finished flatbuffer
+static arrow_block_t arrow_write_message(data_output_arrow_t *arrow, uint8_t const *metadata, arrow_buf_t const *body)
+{
+    arrow_block_t block;
+    block.offset       = (int64_t)arrow->offset;
+    block.metadata_len = (int32_t)(8 + arrow->fb.used);
+    block.body_len     = body ? (int64_t)body->len : 0;
+
+    uint8_t prefix[8] = {0xff, 0xff, 0xff, 0xff};
+    for (unsigned i = 0; i < 4; ++i) {
+        prefix[4 + i] = (uint8_t)(arrow->fb.used >> (8 * i));
+    }
+    arrow_write(arrow, prefix, sizeof(prefix));
+    arrow_write(arrow, metadata, arrow->fb.used);
+    if (body)
+        arrow_write(arrow, body->data, body->len);
+    return block;
+}
+
+static size_t arrow_build_schema(data_output_arrow_t *arrow)
+{
+    flatbuf_t *fb = &arrow->fb;
+
+    size_t *fields = calloc(arrow->num_columns + 1, sizeof(*fields)); // '+ 1' so we never alloc size 0
+    if (!fields) {
+        FATAL_CALLOC("arrow_build_schema()");
+    }
+    for (unsigned i = 0; i < arrow->num_columns; ++i) {
+        arrow_column_t *col = &arrow->columns[i];
+
+        unsigned type_type;
+        fb_start(fb);
+        if (col->type == ARROW_INT) {
+            type_type = ARROW_TYPE_INT;
+            fb_add_scalar(fb, 0, 32, 4); // bitWidth
+            fb_add_scalar(fb, 1, 1, 1);  // is_signed
+        }
+        else if (col->type == ARROW_DOUBLE) {
+            type_type = ARROW_TYPE_FLOATING_POINT;
+            fb_add_scalar(fb, 0, 2, 2); // precision: DOUBLE
+        }
+        else if (col->type == ARROW_TEXT) {
+            type_type = ARROW_TYPE_UTF8;
+        }
+        else {
+            type_type = ARROW_TYPE_NULL;
+        }
+        size_t type     = fb_end(fb);
+        size_t name     = fb_string(fb, col->name);
+        size_t children = fb_tables(fb, NULL, 0);
+
+        fb_start(fb);
+        fb_add_offset(fb, 0, name);
+        fb_add_offset(fb, 3, type);
+        fb_add_offset(fb, 5, children);
+        fb_add_scalar(fb, 1, 1, 1); // nullable
+        fb_add_scalar(fb, 2, type_type, 1);
+        fields[i] = fb_end(fb);
+    }
+    size_t vec = fb_tables(fb, fields, arrow->num_columns);
+    free(fields);
+
+    fb_start(fb);
+    fb_add_offset(fb, 1, vec);
+    fb_add_scalar(fb, 0, 0, 2); // endianness: Little
+    return fb_end(fb);
+}
+
+static uint8_t const *arrow_build_message(data_output_arrow_t *arrow, unsigned header_type, size_t header, size_t body_len)
+{
+    flatbuf_t *fb = &arrow->fb;
+
+    fb_start(fb);
+    fb_add_scalar(fb, 3, body_len, 8);
+    fb_add_offset(fb, 2, header);
+    fb_add_scalar(fb, 0, ARROW_METADATA_V5, 2);
+    fb_add_scalar(fb, 1, header_type, 1);
+    return fb_finish(fb, fb_end(fb));
+}
+
+// the types of a new file widen to the values of the first batch
+static void arrow_set_types(data_output_arrow_t *arrow)
+{
+    for (unsigned i = 0; i < arrow->num_columns; ++i) {
+        arrow_column_t *col = &arrow->columns[i];
+        for (unsigned r = 0; col->kinds && r < arrow->rows; ++r) {
+            if (col->kinds[r] > col->type)
+                col->type = col->kinds[r];
+        }
+    }
+}
+
+static void arrow_start_file(data_output_arrow_t *arrow)
+{
+    arrow_set_types(arrow);
+
+    arrow_write(arrow, "ARROW1\0\0", 8);
+
+    fb_reset(&arrow->fb);
+    size_t schema = arrow_build_schema(arrow);
+    uint8_t const *metadata = arrow_build_message(arrow, ARROW_HEADER_SCHEMA, schema, 0);
+    arrow_write_message(arrow, metadata, NULL);
+    arrow->started = 1;
+}
+
+// a value fits an Int32 column if it is integral
+static int arrow_value_fits(unsigned type, unsigned kind, double num)
+{
+    if (type == ARROW_INT && kind == ARROW_DOUBLE)
+        return num == (int32_t)num && num >= INT32_MIN && num <= INT32_MAX;
+    return kind <= type || type == ARROW_TEXT;
+}
+
+// append the validity bitmap and the values of a column to the body, returns the null count
+static unsigned arrow_write_column(data_output_arrow_t *arrow, arrow_column_t *col, uint64_t *buffers)
+{
+    arrow_buf_t *body = &arrow->body;
+    unsigned rows     = arrow->rows;
+    unsigned nulls    = 0;
+
+    if (col->type == ARROW_NULL)
+        return rows; // the Null type has no buffers
+
+    // validity bitmap
+    buffers[0] = body->len;
+    for (unsigned r = 0; r < rows; r += 8) {
+        uint8_t byte = 0;
+        for (unsigned b = 0; b < 8 && r + b < rows; ++b) {
+            int valid = col->kinds && col->kinds[r + b] != ARROW_NULL;
+            byte |= valid << b;
+            nulls += !valid;
+        }
+        arrow_buf_put(body, &byte, 1);
+    }
+    buffers[1] = body->len - buffers[0];
+    arrow_buf_align(body);
+
+    if (col->type != ARROW_TEXT) {
+        buffers[2] = body->len;
+        for (unsigned r = 0; r < rows; ++r) {
+            double num = col->kinds && col->kinds[r] != ARROW_NULL ? col->values[r].num : 0.0;
+            if (col->type == ARROW_INT) {
+                arrow_buf_le(body, (uint32_t)(int32_t)num, 4);
+            }
+            else {
+                uint64_t raw;
+                memcpy(&raw, &num, sizeof(raw));
+                arrow_buf_le(body, raw, 8);
+            }
+        }
+        buffers[3] = body->len - buffers[2];
+        arrow_buf_align(body);
+        return nulls;
+    }
+
+    // the text of each row, numbers are printed as in JSON
+    arrow_buf_t *text = &arrow->scratch;
+    text->len  = 0;
+    buffers[2] = body->len;
+    arrow_buf_le(body, 0, 4);
+    for (unsigned r = 0; r < rows; ++r) {
+        unsigned kind = col->kinds ? col->kinds[r] : ARROW_NULL;
+        arrow_value_t *val = &col->values[r];
+        if (kind == ARROW_TEXT) {
+            arrow_buf_put(text, col->text.data + val->start, val->len);
+        }
+        else if (kind != ARROW_NULL) {
+            char buf[64];
+            abuf_t num = {0};
+            abuf_init(&num, buf, sizeof(buf));
+            if (kind == ARROW_INT)
+                abuf_print_int(&num, "%d", (int)val->num);
+            else
+                abuf_print_double(&num, "%.3f", val->num);
+            arrow_buf_put(text, buf, strlen(buf));
+        }
+        arrow_buf_le(body, text->len, 4);
+    }
+    buffers[3] = body->len - buffers[2];
+    arrow_buf_align(body);
+    buffers[4] = body->len;
+    buffers[5] = text->len;
+    arrow_buf_put(body, text->data, text->len);
+    arrow_buf_align(body);
+    return nulls;
+}
+
+static void arrow_write_batch(data_output_arrow_t *arrow)
+{
+    if (!arrow->started)
+        arrow_start_file(arrow);
+    if (!arrow->rows)
+        return;
+
+    // each column has one field node, and up to a validity, an offsets, and a data buffer
+    uint8_t *nodes = malloc(16 * arrow->num_columns + 1);
+    if (!nodes) {
+        FATAL_MALLOC("arrow_write_batch()");
+    }
+    uint8_t *buffers = malloc(16 * 3 * arrow->num_columns + 1);
+    if (!buffers) {
+        FATAL_MALLOC("arrow_write_batch()");
+    }
+    size_t num_buffers = 0;
+    arrow->body.len    = 0;
+    for (unsigned i = 0; i < arrow->num_columns; ++i) {
+        arrow_column_t *col = &arrow->columns[i];
+        uint64_t spans[6];
+        uint64_t node[2];
+        node[0] = arrow->rows;
+        node[1] = arrow_write_column(arrow, col, spans);
+        unsigned count = col->type == ARROW_TEXT ? 6 : col->type == ARROW_NULL ? 0 : 4;
+        for (unsigned k = 0; k < 2; ++k) {
+            for (unsigned b = 0; b < 8; ++b) {
+                nodes[16 * i + 8 * k + b] = (uint8_t)(node[k] >> (8 * b));
+            }
+        }
+        for (unsigned k = 0; k < count; ++k) {
+            for (unsigned b = 0; b < 8; ++b) {
+                buffers[8 * (2 * num_buffers + k) + b] = (uint8_t)(spans[k] >> (8 * b));
+            }
+        }
+        num_buffers += count / 2;
+    }
+
+    flatbuf_t *fb = &arrow->fb;
+    fb_reset(fb);
+    size_t buffer_vec = fb_structs(fb, buffers, num_buffers, 16);
+    size_t node_vec   = fb_structs(fb, nodes, arrow->num_columns, 16);
+    free(nodes);
+    free(buffers);
+    fb_start(fb);
+    fb_add_scalar(fb, 0, arrow->rows, 8);
+    fb_add_offset(fb, 1, node_vec);
+    fb_add_offset(fb, 2, buffer_vec);
+    size_t batch = fb_end(fb);
+    uint8_t const *metadata = arrow_build_message(arrow, ARROW_HEADER_RECORD_BATCH, batch, arrow->body.len);
+
+    arrow_block_t *blocks = realloc(arrow->batches, (arrow->num_batches + 1) * sizeof(*blocks));
+    if (!blocks) {
+        FATAL_REALLOC("arrow_write_batch()");
+    }
+    arrow->batches = blocks;
+    arrow->batches[arrow->num_batches++] = arrow_write_message(arrow, metadata, &arrow->body);
+    fflush(arrow->file);
+
+    for (unsigned i = 0; i < arrow->num_columns; ++i) {
+        arrow_column_t *col = &arrow->columns[i];
+        if (col->kinds)
+            memset(col->kinds, ARROW_NULL, ARROW_BATCH_ROWS);
+        col->text.len = 0;
+    }
+    arrow->rows = 0;
+}
+
+static void arrow_write_footer(data_output_arrow_t *arrow)
+{
+    static uint8_t const end_of_stream[8] = {0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0};
+    arrow_write(arrow, end_of_stream, sizeof(end_of_stream));
+
+    uint8_t *blocks = calloc(arrow->num_batches + 1, 24);
+    if (!blocks) {
+        FATAL_CALLOC("arrow_write_footer()");
+    }
+    for (size_t i = 0; i < arrow->num_batches; ++i) {
+        arrow_block_t *block = &arrow->batches[i];
+        for (unsigned b = 0; b < 8; ++b) {
+            blocks[24 * i + b]      = (uint8_t)((uint64_t)block->offset >> (8 * b));
+            blocks[24 * i + 16 + b] = (uint8_t)((uint64_t)block->body_len >> (8 * b));
+        }
+        for (unsigned b = 0; b < 4; ++b) {
+            blocks[24 * i + 8 + b] = (uint8_t)((uint32_t)block->metadata_len >> (8 * b));
+        }
+    }
+
+    flatbuf_t *fb = &arrow->fb;
+    fb_reset(fb);
+    size_t batches = fb_structs(fb, blocks, arrow->num_batches, 24);
+    free(blocks);
+    size_t schema = arrow_build_schema(arrow);
+    fb_start(fb);
+    fb_add_offset(fb, 1, schema);
+    fb_add_offset(fb, 3, batches);
+    fb_add_scalar(fb, 0, ARROW_METADATA_V5, 2);
+    uint8_t const *footer = fb_finish(fb, fb_end(fb));
+    arrow_write(arrow, footer, fb->used);
+
+    uint8_t len[4];
+    for (unsigned i = 0; i < 4; ++i) {
+        len[i] = (uint8_t)(fb->used >> (8 * i));
+    }
+    arrow_write(arrow, len, 4);
+    arrow_write(arrow, "ARROW1", 6);
+    fflush(arrow->file);
+}
+
+// close the file and continue in the next one, e.g. "events.1.arrow" after "events.arrow"
+static void arrow_next_file(data_output_arrow_t *arrow)
+{
+    arrow_write_batch(arrow);
+    arrow_write_footer(arrow);
+    fclose(arrow->file);
+    arrow->file        = NULL;
+    arrow->started     = 0;
+    arrow->offset      = 0;
+    arrow->num_batches = 0;
+    arrow->num_files += 1;
+
+    char const *base = strrchr(arrow->path, '/');
+    char const *ext  = strrchr(base ? base : arrow->path, '.');
+    size_t stem      = ext && ext != base + 1 && ext != arrow->path ? (size_t)(ext - arrow->path) : strlen(arrow->path);
+    size_t size      = strlen(arrow->path) + 16;
+    char *path       = malloc(size);
+    if (!path) {
+        FATAL_MALLOC("arrow_next_file()");
+    }
+    snprintf(path, size, "%.*s.%u%s", (int)stem, arrow->path, arrow->num_files, arrow->path + stem);
+    print_logf(LOG_NOTICE, "Arrow", "The columns changed, continuing in \"%s\"", path);
+    arrow->file = fopen(path, "wb");
+    if (!arrow->file) {
+        print_logf(LOG_ERROR, "Arrow", "Failed to open \"%s\"", path);
+    }
+    free(path);
+}
+
+static void R_API_CALLCONV data_output_arrow_print(data_output_t *output, data_t *data)
+{
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    if (!arrow->file)
+        return;
+
+    // a value that does not fit the columns of the file needs a new file with wider columns
+    int fits = 1;
+    for (data_t *d = data; arrow->started && d; d = d->next) {
+        arrow_column_t *col = arrow_find_column(arrow, d->key);
+        unsigned kind = d->type == DATA_INT ? ARROW_INT : d->type == DATA_DOUBLE ? ARROW_DOUBLE : ARROW_TEXT;
+        if (col && !arrow_value_fits(col->type, kind, d->type == DATA_DOUBLE ? d->value.v_dbl : 0.0))
+            fits = 0;
+    }
+    if (!fits && arrow->path) {
+        arrow_next_file(arrow);
+        if (!arrow->file)
+            return;
+    }
+
+    unsigned row = arrow->rows;
+    for (data_t *d = data; d; d = d->next) {
+        arrow_column_t *col = arrow_find_column(arrow, d->key);
+        if (!col || (col->kinds && col->kinds[row] != ARROW_NULL))
+            continue; // not a column, or a repeated key
+
+        unsigned kind = d->type == DATA_INT ? ARROW_INT : d->type == DATA_DOUBLE ? ARROW_DOUBLE : ARROW_TEXT;
+        double num    = d->type == DATA_INT ? d->value.v_int : d->type == DATA_DOUBLE ? d->value.v_dbl : 0.0;
+        if (arrow->started && !arrow_value_fits(col->type, kind, num)) {
+            if (!col->warned)
+                print_logf(LOG_WARNING, "Arrow", "Values of column \"%s\" do not fit its type, these are written as null", col->name);
+            col->warned = 1;
+            continue;
+        }
+
+        if (!col->kinds) {
+            col->kinds = calloc(ARROW_BATCH_ROWS, sizeof(*col->kinds));
+            if (!col->kinds) {
+                FATAL_CALLOC("data_output_arrow_print()");
+            }
+            col->values = calloc(ARROW_BATCH_ROWS, sizeof(*col->values));
+            if (!col->values) {
+                FATAL_CALLOC("data_output_arrow_print()");
+            }
+        }
+        arrow_value_t *val = &col->values[row];
+        col->kinds[row]    = kind;
+        val->num           = num;
+        if (kind == ARROW_TEXT) {
+            val->start = (uint32_t)col->text.len;
+            if (d->type == DATA_STRING) {
+                arrow_buf_put(&col->text, d->value.v_ptr, strlen(d->value.v_ptr));
+            }
+            else {
+                arrow->nested = &col->text;
+                print_value(output, d->type, d->value, d->format);
+            }
+            val->len = (uint32_t)(col->text.len - val->start);
+        }
+    }
+
+    arrow->rows += 1;
+    if (arrow->rows >= ARROW_BATCH_ROWS)
+        arrow_write_batch(arrow);
+}
+
+static void R_API_CALLCONV data_output_arrow_start(struct data_output *output, char const *const *fields, int num_fields)
+{
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    arrow->columns = calloc(num_fields + 1, sizeof(*arrow->columns)); // '+ 1' so we never alloc size 0
+    if (!arrow->columns) {
+        FATAL_CALLOC("data_output_arrow_start()");
+    }
+    unsigned index_size = 2;
+    while (index_size < 2 * (unsigned)num_fields)
+        index_size *= 2;
+    arrow->index_mask   = index_size - 1;
+    arrow->column_index = calloc(index_size, sizeof(*arrow->column_index));
+    if (!arrow->column_index) {
+        FATAL_CALLOC("data_output_arrow_start()");
+    }
+
+    // the columns in the order of the fields, without duplicates
+    for (int i = 0; i < num_fields; ++i) {
+        if (arrow_find_column(arrow, fields[i]))
+            continue;
+        unsigned h = arrow_key_hash(fields[i]);
+        while (arrow->column_index[h & arrow->index_mask])
+            ++h;
+        arrow->columns[arrow->num_columns].name = fields[i];
+        arrow->num_columns += 1;
+        arrow->column_index[h & arrow->index_mask] = arrow->num_columns;
+    }
+}
+
+static void R_API_CALLCONV data_output_arrow_free(data_output_t *output)
+{
+    data_output_arrow_t *arrow = (data_output_arrow_t *)output;
+
+    if (!arrow)
+        return;
+
+    if (arrow->file) {
+        arrow_write_batch(arrow);
+        arrow_write_footer(arrow);
+        if (arrow->path)
+            fclose(arrow->file);
+    }
+
+    for (unsigned i = 0; i < arrow->num_columns; ++i) {
+        free(arrow->columns[i].kinds);
+        free(arrow->columns[i].values);
+        free(arrow->columns[i].text.data);
+    }
+    free(arrow->columns);
+    free(arrow->column_index);
+    free(arrow->batches);
+    free(arrow->fb.buf);
+    free(arrow->body.data);
+    free(arrow->scratch.data);
+    free(arrow->path);
+    free(arrow);
+}
+
+struct data_output *data_output_arrow_create(int log_level, FILE *file, char const *path)
+{
+    data_output_arrow_t *arrow = calloc(1, sizeof(data_output_arrow_t));
+    if (!arrow) {
+        WARN_CALLOC("data_output_arrow_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    if (path) {
+        arrow->path = strdup(path);
+        if (!arrow->path) {
+            WARN_STRDUP("data_output_arrow_create()");
+            free(arrow);
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+    }
+
+    arrow->output.print_data   = print_arrow_data;
+    arrow->output.print_array  = print_arrow_array;
+    arrow->output.print_string = print_arrow_string;
+    arrow->output.print_double = print_arrow_double;
+    arrow->output.print_int    = print_arrow_int;
+    arrow->output.output_start = data_output_arrow_start;
+    arrow->output.output_print = data_output_arrow_print;
+    arrow->output.output_free  = data_output_arrow_free;
+    arrow->output.log_level    = log_level;
+    arrow->file                = file;
+
+    return (struct data_output *)arrow;
+}
@@ -0,0 +1,296 @@
+/** @file
+    Asynchronous output stage, prints the events of an output on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_async.h"
+
+#include "data.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_time.h"
+#include "compat_pthread.h"
+#include "thread_sched.h"
+
+#include <stdlib.h>
+#include <signal.h>
+
+#ifdef THREADS
+
+typedef struct {
+    struct data_output output;
+    struct data_output *inner; ///< the wrapped output, only used on the thread
+    output_queue_policy_t policy;
+
+    pthread_t thread;
+    pthread_mutex_t lock;  ///< lock for the queue, never held while printing
+    pthread_cond_t cond;   ///< signals queued events, room in the queue, and the thread being idle
+
+    data_t **queue;        ///< ring of retained events
+    uint64_t *queued_ns;   ///< ring of the times the events were queued
+    unsigned queue_size;
+    unsigned queue_head;   ///< next event to print
+    unsigned queue_len;    ///< number of queued events
+    int busy;              ///< an event is being printed
+    int poll;              ///< the timer asked the output to write buffered events
+    int exit_thread;       ///< request the thread to exit once the queue is empty
+
+    output_queue_stats_t stats;
+    unsigned reported;     ///< dropped count already reported
+} data_output_async_t;
+
+static THREAD_RETURN THREAD_CALL output_async_run(void *arg)
+{
+    data_output_async_t *async = arg;
+    thread_sched_apply(THREAD_ROLE_OUTPUT);
+
+    pthread_mutex_lock(&async->lock);
+    while (!async->exit_thread || async->queue_len > 0) {
+        if (async->queue_len == 0 && !async->poll) {
+            pthread_cond_wait(&async->cond, &async->lock);
+            continue;
+        }
+        if (async->queue_len == 0) {
+            async->poll = 0;
+            async->busy = 1;
+            pthread_mutex_unlock(&async->lock);
+            data_output_poll(async->inner);
+            pthread_mutex_lock(&async->lock);
+            async->busy = 0;
+            pthread_cond_broadcast(&async->cond);
+            continue;
+        }
+        data_t *data       = async->queue[async->queue_head];
+        uint64_t queued_ns = async->queued_ns[async->queue_head];
+        async->queue_head = (async->queue_head + 1) % async->queue_size;
+        async->queue_len -= 1;
+        async->busy = 1;
+        unsigned dropped = async->stats.dropped;
+        pthread_cond_broadcast(&async->cond);
+        pthread_mutex_unlock(&async->lock);
+
+        if (dropped > async->reported) {
+            print_logf(LOG_WARNING, "Output", "Output too slow, dropped %u events.", dropped - async->reported);
+        }
+        async->reported = dropped;
+        data_output_print(async->inner, data);
+        data_free(data);
+        uint64_t sent_ns = time_monotonic_ns();
+
+        pthread_mutex_lock(&async->lock);
+        latency_hist_add(&async->stats.send, (int64_t)(sent_ns - queued_ns) / 1000);
+        async->busy = 0;
+        pthread_cond_broadcast(&async->cond);
+    }
+    pthread_mutex_unlock(&async->lock);
+
+    return (THREAD_RETURN)(0);
+}
+
+static void R_API_CALLCONV data_output_async_print(data_output_t *output, data_t *data)
+{
+    data_output_async_t *async = (data_output_async_t *)output;
+
+    data_t *dropped = NULL;
+    pthread_mutex_lock(&async->lock);
+    if (async->queue_len >= async->queue_size && async->policy == OUTPUT_QUEUE_BLOCK) {
+        async->stats.blocked += 1;
+        while (async->queue_len >= async->queue_size)
+            pthread_cond_wait(&async->cond, &async->lock);
+    }
+    if (async->queue_len >= async->queue_size && async->policy == OUTPUT_QUEUE_DROP_NEWEST) {
+        async->stats.dropped += 1;
+        pthread_mutex_unlock(&async->lock);
+        return;
+    }
+    if (async->queue_len >= async->queue_size) {
+        // drop oldest
+        dropped = async->queue[async->queue_head];
+        async->queue_head = (async->queue_head + 1) % async->queue_size;
+        async->queue_len -= 1;
+        async->stats.dropped += 1;
+    }
+    unsigned tail          = (async->queue_head + async->queue_len) % async->queue_size;
+    async->queue[tail]     = data_retain(data);
+    async->queued_ns[tail] = time_monotonic_ns();
+    async->queue_len += 1;
+    if (async->queue_len > async->stats.max_depth)
+        async->stats.max_depth = async->queue_len;
+    pthread_cond_broadcast(&async->cond);
+    pthread_mutex_unlock(&async->lock);
+
+    data_free(dropped);
+}
+
+static void R_API_CALLCONV data_output_async_start(data_output_t *output, char const *const *fields, int num_fields)
+{
+    data_output_async_t *async = (data_output_async_t *)output;
+
+    // no events are queued before the outputs are started
+    data_output_start(async->inner, fields, num_fields);
+}
+
+static void R_API_CALLCONV data_output_async_flush(data_output_t *output)
+{
+    data_output_async_t *async = (data_output_async_t *)output;
+
+    pthread_mutex_lock(&async->lock);
+    while (async->queue_len > 0 || async->busy)
+        pthread_cond_wait(&async->cond, &async->lock);
+    pthread_mutex_unlock(&async->lock);
+}
+
+static void R_API_CALLCONV data_output_async_poll(data_output_t *output)
+{
+    data_output_async_t *async = (data_output_async_t *)output;
+
+    // the wrapped output is polled on the thread
+    pthread_mutex_lock(&async->lock);
+    async->poll = 1;
+    pthread_cond_broadcast(&async->cond);
+    pthread_mutex_unlock(&async->lock);
+}
+
+static void R_API_CALLCONV data_output_async_free(data_output_t *output)
+{
+    data_output_async_t *async = (data_output_async_t *)output;
+
+    if (!async)
+        return;
+
+    // the thread prints what is queued before it exits
+    pthread_mutex_lock(&async->lock);
+    async->exit_thread = 1;
+    pthread_cond_broadcast(&async->cond);
+    pthread_mutex_unlock(&async->lock);
+
+    pthread_join(async->thread, NULL);
+
+    pthread_mutex_destroy(&async->lock);
+    pthread_cond_destroy(&async->cond);
+    data_output_free(async->inner);
+    free(async->queue);
+    free(async->queued_ns);
+    free(async);
+}
+
+struct data_output *data_output_async_create(struct data_output *output, output_queue_policy_t policy, unsigned depth)
+{
+    if (!output)
+        return NULL;
+
+    data_output_async_t *async = calloc(1, sizeof(data_output_async_t));
+    if (!async) {
+        WARN_CALLOC("data_output_async_create()");
+        return output; // NOTE: prints synchronously on alloc failure.
+    }
+    async->queue_size = depth ? depth : OUTPUT_QUEUE_DEPTH;
+    async->queue      = calloc(async->queue_size, sizeof(*async->queue));
+    if (!async->queue) {
+        WARN_CALLOC("data_output_async_create()");
+        free(async);
+        return output; // NOTE: prints synchronously on alloc failure.
+    }
+    async->queued_ns = calloc(async->queue_size, sizeof(*async->queued_ns));
+    if (!async->queued_ns) {
+        WARN_CALLOC("data_output_async_create()");
+        free(async->queue);
+        free(async);
+        return output; // NOTE: prints synchronously on alloc failure.
+    }
+
+    async->output.log_level    = output->log_level;
+    async->output.output_start = data_output_async_start;
+    async->output.output_print = data_output_async_print;
+    async->output.output_flush = data_output_async_flush;
+    async->output.output_poll  = data_output_async_poll;
+    async->output.output_free  = data_output_async_free;
+    async->inner               = output;
+    async->policy              = policy;
+
+    pthread_mutex_init(&async->lock, NULL);
+    pthread_cond_init(&async->cond, NULL);
+
+#ifndef _WIN32
+    // Block all signals from the output thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&async->thread, NULL, output_async_run, async);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+        pthread_mutex_destroy(&async->lock);
+        pthread_cond_destroy(&async->cond);
+        free(async->queue);
+        free(async->queued_ns);
+        free(async);
+        return output;
+    }
+
+    return (struct data_output *)async;
+}
+
+int data_output_async_stats(struct data_output *output, output_queue_stats_t *stats, int reset)
+{
+    if (!output || output->output_print != data_output_async_print)
+        return 0;
+
+    data_output_async_t *async = (data_output_async_t *)output;
+    pthread_mutex_lock(&async->lock);
+    *stats       = async->stats;
+    stats->depth = async->queue_len;
+    if (reset) {
+        async->stats.max_depth = async->queue_len;
+        async->stats.dropped   = 0;
+        async->stats.blocked   = 0;
+        async->stats.send      = (latency_hist_t){0};
+        async->reported        = 0;
+    }
+    pthread_mutex_unlock(&async->lock);
+    return 1;
+}
+
+int data_output_async_is_current(struct data_output *output)
+{
+    if (!output || output->output_print != data_output_async_print)
+        return 0;
+
+    data_output_async_t *async = (data_output_async_t *)output;
+    return pthread_equal(async->thread, pthread_self());
+}
+
+#else
+
+struct data_output *data_output_async_create(struct data_output *output, output_queue_policy_t policy, unsigned depth)
+{
+    (void)policy;
+    (void)depth;
+    return output;
+}
+
+int data_output_async_stats(struct data_output *output, output_queue_stats_t *stats, int reset)
+{
+    (void)output;
+    (void)stats;
+    (void)reset;
+    return 0;
+}
+
+int data_output_async_is_current(struct data_output *output)
+{
+    (void)output;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,392 @@
+/** @file
+    Binary (CBOR and MessagePack) outputs for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_binary.h"
+
+#include "data.h"
+#include "r_util.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Events in one CBOR stringref namespace, the strings are sent again in the next one.
+#define BINARY_CBOR_CHUNK 100
+
+/// Strings in one CBOR stringref namespace, a namespace with more is closed after the event.
+#define BINARY_STRINGREF_MAX 4096
+
+/// A string of the stringref namespace.
+typedef struct stringref {
+    char *str;      ///< NULL for an empty slot
+    size_t len;
+    unsigned index; ///< the index a reference sends
+} stringref_t;
+
+typedef struct {
+    struct data_output output;
+    binary_format_t format;
+    FILE *file;
+    uint8_t *buf;      ///< the encoded event
+    size_t len;
+    size_t size;
+    int fixed;         ///< the buffer is given and does not grow
+    int overflow;      ///< the event did not fit the buffer
+    int namespaced;    ///< strings are sent once for each namespace
+    unsigned events;   ///< events written in the open namespace, 0 if none is open
+    unsigned count;    ///< strings in the namespace
+    unsigned mask;     ///< size of the string slots minus one, a power of two
+    stringref_t *refs; ///< the string slots, hashed
+} data_output_binary_t;
+
+static void binary_put(data_output_binary_t *bin, void const *bytes, size_t n)
+{
+    if (bin->overflow)
+        return;
+    if (bin->len + n > bin->size) {
+        size_t size = bin->size ? bin->size * 2 : 512;
+        while (size < bin->len + n)
+            size *= 2;
+        uint8_t *buf = bin->fixed ? NULL : realloc(bin->buf, size);
+        if (!buf) {
+            if (!bin->fixed)
+                WARN_REALLOC("binary_put()");
+            bin->overflow = 1;
+            return;
+        }
+        bin->buf  = buf;
+        bin->size = size;
+    }
+    memcpy(bin->buf + bin->len, bytes, n);
+    bin->len += n;
+}
+
+static void binary_put_byte(data_output_binary_t *bin, uint8_t byte)
+{
+    binary_put(bin, &byte, 1);
+}
+
+// put a type byte and a big-endian value of n bytes
+static void binary_put_be(data_output_binary_t *bin, uint8_t type, uint64_t val, unsigned n)
+{
+    uint8_t bytes[9];
+    bytes[0] = type;
+    for (unsigned i = 0; i < n; ++i) {
+        bytes[n - i] = (uint8_t)(val >> (8 * i));
+    }
+    binary_put(bin, bytes, n + 1);
+}
+
+// CBOR initial byte of a major type and the shortest argument
+static void cbor_head(data_output_binary_t *bin, unsigned major, uint64_t val)
+{
+    uint8_t type = (uint8_t)(major << 5);
+    if (val < 24)
+        binary_put_byte(bin, type | (uint8_t)val);
+    else if (val < 0x100)
+        binary_put_be(bin, type | 24, val, 1);
+    else if (val < 0x10000)
+        binary_put_be(bin, type | 25, val, 2);
+    else if (val < 0x100000000)
+        binary_put_be(bin, type | 26, val, 4);
+    else
+        binary_put_be(bin, type | 27, val, 8);
+}
+
+// MessagePack head of a map (0x80), an array (0x90), or a string (0xa0)
+static void msgpack_head(data_output_binary_t *bin, uint8_t fix, size_t len)
+{
+    unsigned fix_max = fix == 0xa0 ? 32 : 16;
+    uint8_t type16   = fix == 0x80 ? 0xde : fix == 0x90 ? 0xdc : 0xda;
+    if (len < fix_max)
+        binary_put_byte(bin, fix | (uint8_t)len);
+    else if (fix == 0xa0 && len < 0x100)
+        binary_put_be(bin, 0xd9, len, 1);
+    else if (len < 0x10000)
+        binary_put_be(bin, type16, len, 2);
+    else
+        binary_put_be(bin, type16 + 1, len, 4);
+}
+
+/* stringref namespace, see http://cbor.schmorp.de/stringref */
+
+// FNV-1a hash of a string
+static unsigned stringref_hash(char const *str, size_t len)
+{
+    unsigned h = 2166136261U;
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ (unsigned char)str[i]) * 16777619U;
+    return h;
+}
+
+static void stringref_clear(data_output_binary_t *bin)
+{
+    for (unsigned i = 0; bin->refs && i <= bin->mask; ++i) {
+        free(bin->refs[i].str);
+    }
+    free(bin->refs);
+    bin->refs  = NULL;
+    bin->mask  = 0;
+    bin->count = 0;
+}
+
+static stringref_t *stringref_find(data_output_binary_t *bin, char const *str, size_t len)
+{
+    for (unsigned i = stringref_hash(str, len);; ++i) {
+        stringref_t *ref = &bin->refs[i & bin->mask];
+        if (!ref->str || (ref->len == len && !memcmp(ref->str, str, len)))
+            return ref;
+    }
+}
+
+// a string long enough for its index is added to the namespace, returns 0 if the namespace is broken
+static int stringref_add(data_output_binary_t *bin, char const *str, size_t len)
+{
+    unsigned next = bin->count;
+    size_t min_len = next < 24 ? 3 : next < 0x100 ? 4 : next < 0x10000 ? 5 : 7;
+    if (len < min_len)
+        return 1;
+
+    // keep the slots at most half full
+    if (2 * (bin->count + 1) > bin->mask + 1) {
+        unsigned mask     = bin->mask ? bin->mask * 2 + 1 : 63;
+        stringref_t *refs = calloc(mask + 1, sizeof(*refs));
+        if (!refs) {
+            WARN_CALLOC("stringref_add()");
+            return 0;
+        }
+        stringref_t *old    = bin->refs;
+        unsigned old_mask   = bin->mask;
+        bin->refs = refs;
+        bin->mask = mask;
+        for (unsigned i = 0; old && i <= old_mask; ++i) {
+            if (old[i].str)
+                *stringref_find(bin, old[i].str, old[i].len) = old[i];
+        }
+        free(old);
+    }
+
+    stringref_t *ref = stringref_find(bin, str, len);
+    ref->str = malloc(len);
+    if (!ref->str) {
+        WARN_MALLOC("stringref_add()");
+        return 0;
+    }
+    memcpy(ref->str, str, len);
+    ref->len   = len;
+    ref->index = next;
+    bin->count += 1;
+    return 1;
+}
+
+/* Binary printer */
+
+static void R_API_CALLCONV print_binary_string(data_output_t *output, char const *str, char const *format)
+{
+    UNUSED(format);
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    size_t len = strlen(str);
+    if (bin->format == BINARY_MSGPACK) {
+        msgpack_head(bin, 0xa0, len);
+        binary_put(bin, str, len);
+        return;
+    }
+
+    if (bin->namespaced && bin->refs) {
+        stringref_t *ref = stringref_find(bin, str, len);
+        if (ref->str) {
+            cbor_head(bin, 6, 25); // tag 25: stringref
+            cbor_head(bin, 0, ref->index);
+            return;
+        }
+    }
+    cbor_head(bin, 3, len);
+    binary_put(bin, str, len);
+    if (bin->namespaced && !stringref_add(bin, str, len))
+        bin->overflow = 1;
+}
+
+static void R_API_CALLCONV print_binary_int(data_output_t *output, int data, char const *format)
+{
+    UNUSED(format);
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    if (bin->format == BINARY_CBOR) {
+        if (data >= 0)
+            cbor_head(bin, 0, (uint64_t)data);
+        else
+            cbor_head(bin, 1, (uint64_t)(-1 - (int64_t)data));
+    }
+    else if (data >= 0) {
+        if (data < 0x80)
+            binary_put_byte(bin, (uint8_t)data);
+        else if (data < 0x100)
+            binary_put_be(bin, 0xcc, (uint64_t)data, 1);
+        else if (data < 0x10000)
+            binary_put_be(bin, 0xcd, (uint64_t)data, 2);
+        else
+            binary_put_be(bin, 0xce, (uint64_t)data, 4);
+    }
+    else {
+        if (data >= -32)
+            binary_put_byte(bin, (uint8_t)data);
+        else if (data >= -0x80)
+            binary_put_be(bin, 0xd0, (uint8_t)data, 1);
+        else if (data >= -0x8000)
+            binary_put_be(bin, 0xd1, (uint16_t)data, 2);
+        else
+            binary_put_be(bin, 0xd2, (uint32_t)data, 4);
+    }
+}
+
+static void R_API_CALLCONV print_binary_double(data_output_t *output, double data, char const *format)
+{
+    UNUSED(format);
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    // most values come from float math, those fit single precision exactly
+    float single = (float)data;
+    if ((double)single == data || data != data) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        binary_put_be(bin, bin->format == BINARY_CBOR ? 0xfa : 0xca, bits, 4);
+    }
+    else {
+        uint64_t bits;
+        memcpy(&bits, &data, sizeof(bits));
+        binary_put_be(bin, bin->format == BINARY_CBOR ? 0xfb : 0xcb, bits, 8);
+    }
+}
+
+static void R_API_CALLCONV print_binary_array(data_output_t *output, data_array_t *array, char const *format)
+{
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    if (bin->format == BINARY_CBOR)
+        cbor_head(bin, 4, (uint64_t)array->num_values);
+    else
+        msgpack_head(bin, 0x90, (size_t)array->num_values);
+    for (int c = 0; c < array->num_values; ++c) {
+        print_array_value(output, array, format, c);
+    }
+}
+
+static void R_API_CALLCONV print_binary_data(data_output_t *output, data_t *data, char const *format)
+{
+    UNUSED(format);
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    size_t count = 0;
+    for (data_t *d = data; d; d = d->next) {
+        ++count;
+    }
+    if (bin->format == BINARY_CBOR)
+        cbor_head(bin, 5, count);
+    else
+        msgpack_head(bin, 0x80, count);
+    for (; data; data = data->next) {
+        print_binary_string(output, data->key, NULL);
+        print_value(output, data->type, data->value, data->format);
+    }
+}
+
+static void R_API_CALLCONV data_output_binary_print(data_output_t *output, data_t *data)
+{
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    if (!bin->file)
+        return;
+
+    bin->len      = 0;
+    bin->overflow = 0;
+    if (bin->namespaced && !bin->events) {
+        cbor_head(bin, 6, 256); // tag 256: stringref namespace
+        binary_put_byte(bin, 0x9f); // indefinite length array
+    }
+    print_binary_data(output, data, NULL);
+
+    if (bin->overflow) {
+        // the event is dropped, the strings it added are not known to the reader
+        if (bin->events)
+            fputc(0xff, bin->file);
+        stringref_clear(bin);
+        bin->events = 0;
+        return;
+    }
+    if (bin->namespaced) {
+        bin->events += 1;
+        if (bin->events >= BINARY_CBOR_CHUNK || bin->count >= BINARY_STRINGREF_MAX) {
+            binary_put_byte(bin, 0xff); // break
+            stringref_clear(bin);
+            bin->events = 0;
+        }
+    }
+    fwrite(bin->buf, 1, bin->len, bin->file);
+    fflush(bin->file);
+}
+
+static void R_API_CALLCONV data_output_binary_free(data_output_t *output)
+{
+    data_output_binary_t *bin = (data_output_binary_t *)output;
+
+    if (!bin)
+        return;
+
+    if (bin->file && bin->events) {
+        fputc(0xff, bin->file); // close the namespace
+        fflush(bin->file);
+    }
+    stringref_clear(bin);
+    free(bin->buf);
+    free(bin);
+}
+
+static void binary_init(data_output_binary_t *bin, binary_format_t format)
+{
+    bin->format              = format;
+    bin->output.print_data   = print_binary_data;
+    bin->output.print_array  = print_binary_array;
+    bin->output.print_string = print_binary_string;
+    bin->output.print_double = print_binary_double;
+    bin->output.print_int    = print_binary_int;
+}
+
+struct data_output *data_output_binary_create(binary_format_t format, int log_level, FILE *file)
+{
+    data_output_binary_t *bin = calloc(1, sizeof(data_output_binary_t));
+    if (!bin) {
+        WARN_CALLOC("data_output_binary_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    binary_init(bin, format);
+    bin->output.log_level    = log_level;
+    bin->output.output_print = data_output_binary_print;
+    bin->output.output_free  = data_output_binary_free;
+    bin->file                = file;
+    bin->namespaced          = format == BINARY_CBOR;
+
+    return (struct data_output *)bin;
+}
+
+size_t data_encode_binary(binary_format_t format, data_t *data, uint8_t *dst, size_t size)
+{
+    data_output_binary_t bin = {0};
+    binary_init(&bin, format);
+    bin.buf   = dst;
+    bin.size  = size;
+    bin.fixed = 1;
+
+    print_binary_data(&bin.output, data, NULL);
+    return bin.overflow ? 0 : bin.len;
+}
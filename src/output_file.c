@@ -12,8 +12,10 @@
 #include "output_file.h"
 
 #include "data.h"
+#include "abuf.h"
 #include "term_ctl.h"
 #include "r_util.h"
+#include "compat_time.h"
 #include "logger.h"
 #include "fatal.h"
 
@@ -22,11 +24,95 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#ifdef _WIN32
+#include <io.h>
+#define fsync(fd) _commit(fd)
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+/* File buffering */
+
+typedef struct file_buffer {
+    file_flush_t flush;
+    uint64_t written_ns;    ///< monotonic time of the last write
+    int pending;            ///< events are buffered
+} file_buffer_t;
+
+static void file_buffer_init(file_buffer_t *buf, FILE *file, file_flush_t const *flush)
+{
+    if (!flush || !file)
+        return;
+    buf->flush = *flush;
+    if (flush->interval_ms || flush->buffer_size) {
+        // the buffer must be set before the first write
+        setvbuf(file, NULL, _IOFBF, flush->buffer_size ? flush->buffer_size : FILE_FLUSH_BUFFER);
+    }
+    buf->written_ns = time_monotonic_ns();
+}
+
+static void file_buffer_write(file_buffer_t *buf, FILE *file)
+{
+    fflush(file);
+    if (buf->flush.sync)
+        fsync(fileno(file));
+    buf->pending = 0;
+}
+
+// write the events if the interval is over, or on each event if there is no buffering
+static void file_buffer_poll(file_buffer_t *buf, FILE *file, int event)
+{
+    buf->pending |= event;
+    if (!buf->pending)
+        return;
+    if (!buf->flush.interval_ms && !buf->flush.buffer_size) {
+        file_buffer_write(buf, file);
+        return;
+    }
+    if (!buf->flush.interval_ms)
+        return; // stdio writes when the buffer is full
+    uint64_t now_ns = time_monotonic_ns();
+    if (now_ns - buf->written_ns >= (uint64_t)buf->flush.interval_ms * 1000000) {
+        file_buffer_write(buf, file);
+        buf->written_ns = now_ns;
+    }
+}
+
+/* Number printers */
+
+// print a double without fprintf for the common formats, returns the number of chars printed
+static int fprint_double(FILE *file, char const *format, double val)
+{
+    char str[64];
+    abuf_t buf;
+    abuf_init(&buf, str, sizeof(str));
+    abuf_print_double(&buf, format, val);
+    if (!buf.left) // truncated
+        return fprintf(file, format, val);
+    fputs(str, file);
+    return (int)(buf.tail - str);
+}
+
+// print an int without fprintf for the common formats, returns the number of chars printed
+static int fprint_int(FILE *file, char const *format, int val)
+{
+    char str[64];
+    abuf_t buf;
+    abuf_init(&buf, str, sizeof(str));
+    abuf_print_int(&buf, format, val);
+    if (!buf.left) // truncated
+        return fprintf(file, format, val);
+    fputs(str, file);
+    return (int)(buf.tail - str);
+}
+
 /* JSON printer */
 
 typedef struct {
     struct data_output output;
     FILE *file;
+    file_buffer_t buffer;
 } data_output_json_t;
 
 static void R_API_CALLCONV print_json_array(data_output_t *output, data_array_t *array, char const *format)
@@ -100,7 +186,7 @@ static void R_API_CALLCONV print_json_double(data_output_t *output, double data,
     UNUSED(format);
     data_output_json_t *json = (data_output_json_t *)output;
 
-    fprintf(json->file, "%.3f", data);
+    fprint_double(json->file, "%.3f", data);
 }
 
 static void R_API_CALLCONV print_json_int(data_output_t *output, int data, char const *format)
@@ -108,7 +194,7 @@ static void R_API_CALLCONV print_json_int(data_output_t *output, int data, char
     UNUSED(format);
     data_output_json_t *json = (data_output_json_t *)output;
 
-    fprintf(json->file, "%d", data);
+    fprint_int(json->file, "%d", data);
 }
 
 static void R_API_CALLCONV data_output_json_print(data_output_t *output, data_t *data)
@@ -118,19 +204,33 @@ static void R_API_CALLCONV data_output_json_print(data_output_t *output, data_t
     if (json && json->file) {
         json->output.print_data(output, data, NULL);
         fputc('\n', json->file);
-        fflush(json->file);
+        file_buffer_poll(&json->buffer, json->file, 1);
+    }
+}
+
+static void R_API_CALLCONV data_output_json_poll(data_output_t *output)
+{
+    data_output_json_t *json = (data_output_json_t *)output;
+
+    if (json && json->file) {
+        file_buffer_poll(&json->buffer, json->file, 0);
     }
 }
 
 static void R_API_CALLCONV data_output_json_free(data_output_t *output)
 {
-    if (!output)
+    data_output_json_t *json = (data_output_json_t *)output;
+
+    if (!json)
         return;
 
-    free(output);
+    if (json->file && json->buffer.pending)
+        file_buffer_write(&json->buffer, json->file);
+
+    free(json);
 }
 
-struct data_output *data_output_json_create(int log_level, FILE *file)
+struct data_output *data_output_json_create(int log_level, FILE *file, file_flush_t const *flush)
 {
     data_output_json_t *json = calloc(1, sizeof(data_output_json_t));
     if (!json) {
@@ -145,47 +245,53 @@ struct data_output *data_output_json_create(int log_level, FILE *file)
     json->output.print_double = print_json_double;
     json->output.print_int    = print_json_int;
     json->output.output_print = data_output_json_print;
+    json->output.output_poll  = data_output_json_poll;
     json->output.output_free  = data_output_json_free;
     json->file                = file;
+    file_buffer_init(&json->buffer, file, flush);
 
     return (struct data_output *)json;
 }
 
 /* Pretty Key-Value printer */
 
-static int kv_color_for_key(char const *key)
+static int kv_color_for_key(data_t const *data)
 {
-    if (!key || !*key)
+    if (!*data->key)
         return TERM_COLOR_RESET;
-    if (!strcmp(key, "tag") || !strcmp(key, "time"))
+    switch (data->storage >> DATA_KEY_SHIFT) {
+    case DATA_KEY_TAG:
+    case DATA_KEY_TIME:
         return TERM_COLOR_BLUE;
-    if (!strcmp(key, "model") || !strcmp(key, "type") || !strcmp(key, "id"))
+    case DATA_KEY_MODEL:
+    case DATA_KEY_TYPE:
+    case DATA_KEY_ID:
         return TERM_COLOR_RED;
-    if (!strcmp(key, "mic"))
+    case DATA_KEY_MIC:
         return TERM_COLOR_CYAN;
-    if (!strcmp(key, "mod") || !strcmp(key, "freq") || !strcmp(key, "freq1") || !strcmp(key, "freq2"))
+    case DATA_KEY_MOD:
+    case DATA_KEY_FREQ:
+    case DATA_KEY_FREQ1:
+    case DATA_KEY_FREQ2:
         return TERM_COLOR_MAGENTA;
-    if (!strcmp(key, "rssi") || !strcmp(key, "snr") || !strcmp(key, "noise"))
+    case DATA_KEY_RSSI:
+    case DATA_KEY_SNR:
+    case DATA_KEY_NOISE:
         return TERM_COLOR_YELLOW;
-    return TERM_COLOR_GREEN;
+    default:
+        return TERM_COLOR_GREEN;
+    }
 }
 
-static int kv_break_before_key(char const *key)
+static int kv_break_before_key(data_t const *data)
 {
-    if (!key || !*key)
-        return 0;
-    if (!strcmp(key, "model") || !strcmp(key, "mod") || !strcmp(key, "rssi") || !strcmp(key, "codes"))
-        return 1;
-    return 0;
+    return data_key_is(data, DATA_KEY_MODEL) || data_key_is(data, DATA_KEY_MOD)
+            || data_key_is(data, DATA_KEY_RSSI) || data_key_is(data, DATA_KEY_CODES);
 }
 
-static int kv_break_after_key(char const *key)
+static int kv_break_after_key(data_t const *data)
 {
-    if (!key || !*key)
-        return 0;
-    if (!strcmp(key, "id") || !strcmp(key, "mic"))
-        return 1;
-    return 0;
+    return data_key_is(data, DATA_KEY_ID) || data_key_is(data, DATA_KEY_MIC);
 }
 
 typedef struct {
@@ -197,10 +303,39 @@ typedef struct {
     int term_width;
     int data_recursion;
     int column;
+    uint64_t width_ns; ///< monotonic time the term width was last queried
+    gbuf_t line;       ///< the event being rendered, written in one go
 } data_output_kv_t;
 
 #define KV_SEP "_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ "
 
+/// Interval to query the term width, a resized terminal applies to the events after this.
+#define KV_WIDTH_INTERVAL_NS 1000000000
+
+static void kv_set_fg(data_output_kv_t *kv, term_color_t color)
+{
+    char seq[16];
+    gbuf_put(&kv->line, seq, (size_t)term_fg_sequence(color, seq, sizeof(seq)));
+}
+
+static void kv_set_bg(data_output_kv_t *kv, term_color_t bg, term_color_t fg)
+{
+    char seq[16];
+    gbuf_put(&kv->line, seq, (size_t)term_bg_sequence(bg, fg, seq, sizeof(seq)));
+}
+
+// pad with 1 to 26 spaces, returns the number of chars added
+static int kv_pad(data_output_kv_t *kv, int width)
+{
+    static char const spaces[] = "                          ";
+    if (width < 1)
+        width = 1;
+    if (width > (int)sizeof(spaces) - 1)
+        width = (int)sizeof(spaces) - 1;
+    gbuf_put(&kv->line, spaces, (size_t)width);
+    return width;
+}
+
 static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, char const *format)
 {
     UNUSED(format);
@@ -217,27 +352,33 @@ static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, ch
         data_t *data_lvl  = NULL;
         data_t *data_msg  = NULL;
         for (data_t *d = data; d; d = d->next) {
-            if (!strcmp(d->key, "src"))
+            if (data_key_is(d, DATA_KEY_SRC))
                 data_src = d;
-            else if (!strcmp(d->key, "lvl"))
+            else if (data_key_is(d, DATA_KEY_LVL))
                 data_lvl = d;
-            else if (!strcmp(d->key, "msg"))
+            else if (data_key_is(d, DATA_KEY_MSG))
                 data_msg = d;
         }
         is_log = data_src && data_lvl && data_msg;
 
-        kv->term_width = term_get_columns(kv->term); // update current term width
+        // update current term width, at most once per interval
+        uint64_t now_ns = time_monotonic_ns();
+        if (!kv->width_ns || now_ns - kv->width_ns >= KV_WIDTH_INTERVAL_NS) {
+            kv->term_width = term_get_columns(kv->term);
+            kv->width_ns   = now_ns;
+        }
         if (!is_log) {
         if (color)
-            term_set_fg(kv->term, TERM_COLOR_BLACK);
+            kv_set_fg(kv, TERM_COLOR_BLACK);
         if (ring_bell)
             term_ring_bell(kv->term);
-        char sep[] = KV_SEP KV_SEP KV_SEP KV_SEP;
-        if (kv->term_width < (int)sizeof(sep))
-            sep[kv->term_width > 0 ? kv->term_width - 1 : 40] = '\0';
-        fprintf(kv->file, "%s\n", sep);
+        int sep_len = (int)sizeof(KV_SEP KV_SEP KV_SEP KV_SEP) - 1;
+        if (kv->term_width <= sep_len)
+            sep_len = kv->term_width > 0 ? kv->term_width - 1 : 40;
+        gbuf_put(&kv->line, KV_SEP KV_SEP KV_SEP KV_SEP, (size_t)sep_len);
+        gbuf_put(&kv->line, "\n", 1);
         if (color)
-            term_set_fg(kv->term, TERM_COLOR_RESET);
+            kv_set_fg(kv, TERM_COLOR_RESET);
         }
 
         // print special log format
@@ -273,17 +414,17 @@ static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, ch
                 src_bg = TERM_COLOR_BRIGHT_BLACK;
                 src_fg = TERM_COLOR_WHITE;
             }
-            term_set_bg(kv->term, src_bg, src_bg); // hides the brackets
-            fprintf(kv->file, "[");
-            term_set_bg(kv->term, 0, src_fg);
+            kv_set_bg(kv, src_bg, src_bg); // hides the brackets
+            gbuf_put(&kv->line, "[", 1);
+            kv_set_bg(kv, 0, src_fg);
             print_value(output, data_src->type, data_src->value, data_src->format);
-            term_set_bg(kv->term, 0, src_bg); // hides the brackets
-            fprintf(kv->file, "]");
-            term_set_fg(kv->term, TERM_COLOR_RESET);
-            // fprintf(kv->file, " (");
+            kv_set_bg(kv, 0, src_bg); // hides the brackets
+            gbuf_put(&kv->line, "]", 1);
+            kv_set_fg(kv, TERM_COLOR_RESET);
+            // gbuf_put(&kv->line, " (", 2);
             // print_value(output, data_lvl->type, data_lvl->value, data_lvl->format);
-            // fprintf(kv->file, ") ");
-            fprintf(kv->file, " ");
+            // gbuf_put(&kv->line, ") ", 2);
+            gbuf_put(&kv->line, " ", 1);
             print_value(output, data_msg->type, data_msg->value, data_msg->format);
             // force break on next key
             kv->column = kv->term_width;
@@ -292,46 +433,51 @@ static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, ch
     // nested data object: break before
     else {
         if (color)
-            term_set_fg(kv->term, TERM_COLOR_RESET);
-        fprintf(kv->file, "\n");
+            kv_set_fg(kv, TERM_COLOR_RESET);
+        gbuf_put(&kv->line, "\n", 1);
         kv->column = 0;
     }
 
     ++kv->data_recursion;
     for (; data; data = data->next) {
         // skip logging keys
-        if (is_log && (!strcmp(data->key, "time") || !strcmp(data->key, "src") || !strcmp(data->key, "lvl")
-                || !strcmp(data->key, "msg") || !strcmp(data->key, "num_rows"))) {
+        if (is_log && (data_key_is(data, DATA_KEY_TIME) || data_key_is(data, DATA_KEY_SRC) || data_key_is(data, DATA_KEY_LVL)
+                || data_key_is(data, DATA_KEY_MSG) || data_key_is(data, DATA_KEY_NUM_ROWS))) {
             continue;
         }
 
         // break before some known keys
-        if (kv->column > 0 && kv_break_before_key(data->key)) {
-            fprintf(kv->file, "\n");
+        if (kv->column > 0 && kv_break_before_key(data)) {
+            gbuf_put(&kv->line, "\n", 1);
             kv->column = 0;
         }
         // break if not enough width left
         else if (kv->column >= kv->term_width - 26) {
-            fprintf(kv->file, "\n");
+            gbuf_put(&kv->line, "\n", 1);
             kv->column = 0;
         }
         // pad to next alignment if there is enough width left
         else if (kv->column > 0 && kv->column < kv->term_width - 26) {
-            kv->column += fprintf(kv->file, "%*s", 25 - kv->column % 26, " ");
+            kv->column += kv_pad(kv, 25 - kv->column % 26);
         }
 
-        // print key
+        // print key, padded to 10 chars
         char *key = *data->pretty_key ? data->pretty_key : data->key;
-        kv->column += fprintf(kv->file, "%-10s: ", key);
+        int key_len = (int)strlen(key);
+        gbuf_put(&kv->line, key, (size_t)key_len);
+        if (key_len < 10)
+            key_len += kv_pad(kv, 10 - key_len);
+        gbuf_put(&kv->line, ": ", 2);
+        kv->column += key_len + 2;
         // print value
         if (color)
-            term_set_fg(kv->term, kv_color_for_key(data->key));
+            kv_set_fg(kv, kv_color_for_key(data));
         print_value(output, data->type, data->value, data->format);
         if (color)
-            term_set_fg(kv->term, TERM_COLOR_RESET);
+            kv_set_fg(kv, TERM_COLOR_RESET);
 
         // force break after some known keys
-        if (kv->column > 0 && kv_break_after_key(data->key)) {
+        if (kv->column > 0 && kv_break_after_key(data)) {
             kv->column = kv->term_width; // force break;
         }
     }
@@ -339,7 +485,7 @@ static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, ch
 
     // top-level: always end with newline
     if (!kv->data_recursion && kv->column > 0) {
-        //fprintf(kv->file, "\n"); // data_output_print() already adds a newline
+        //gbuf_put(&kv->line, "\n", 1); // data_output_print() already adds a newline
         kv->column = 0;
     }
 }
@@ -348,34 +494,44 @@ static void R_API_CALLCONV print_kv_array(data_output_t *output, data_array_t *a
 {
     data_output_kv_t *kv = (data_output_kv_t *)output;
 
-    //fprintf(kv->file, "[ ");
+    //gbuf_put(&kv->line, "[ ", 2);
     for (int c = 0; c < array->num_values; ++c) {
         if (c)
-            fprintf(kv->file, ", ");
+            gbuf_put(&kv->line, ", ", 2);
         print_array_value(output, array, format, c);
     }
-    //fprintf(kv->file, " ]");
+    //gbuf_put(&kv->line, " ]", 2);
 }
 
 static void R_API_CALLCONV print_kv_double(data_output_t *output, double data, char const *format)
 {
     data_output_kv_t *kv = (data_output_kv_t *)output;
 
-    kv->column += fprintf(kv->file, format ? format : "%.3f", data);
+    size_t len = kv->line.len;
+    gbuf_print_double(&kv->line, format ? format : "%.3f", data);
+    kv->column += (int)(kv->line.len - len);
 }
 
 static void R_API_CALLCONV print_kv_int(data_output_t *output, int data, char const *format)
 {
     data_output_kv_t *kv = (data_output_kv_t *)output;
 
-    kv->column += fprintf(kv->file, format ? format : "%d", data);
+    size_t len = kv->line.len;
+    gbuf_print_int(&kv->line, format ? format : "%d", data);
+    kv->column += (int)(kv->line.len - len);
 }
 
 static void R_API_CALLCONV print_kv_string(data_output_t *output, const char *data, char const *format)
 {
     data_output_kv_t *kv = (data_output_kv_t *)output;
 
-    kv->column += fprintf(kv->file, format ? format : "%s", data);
+    if (!format) {
+        size_t len = strlen(data);
+        gbuf_put(&kv->line, data, len);
+        kv->column += (int)len;
+        return;
+    }
+    kv->column += gbuf_printf(&kv->line, format, data);
 }
 
 static void R_API_CALLCONV data_output_kv_print(data_output_t *output, data_t *data)
@@ -383,8 +539,14 @@ static void R_API_CALLCONV data_output_kv_print(data_output_t *output, data_t *d
     data_output_kv_t *kv = (data_output_kv_t *)output;
 
     if (kv && kv->file) {
+        // render the event with colors and breaks, then write it at once
+        gbuf_clear(&kv->line);
         kv->output.print_data(output, data, NULL);
-        fputc('\n', kv->file);
+        gbuf_put(&kv->line, "\n", 1); // on alloc failure the event is truncated
+        if (kv->line.len && kv->color)
+            term_write(kv->term, kv->line.data, kv->line.len);
+        else if (kv->line.len)
+            fwrite(kv->line.data, 1, kv->line.len, kv->file);
         fflush(kv->file);
     }
 }
@@ -399,6 +561,7 @@ static void R_API_CALLCONV data_output_kv_free(data_output_t *output)
     if (kv->color)
         term_free(kv->term);
 
+    gbuf_free(&kv->line);
     free(output);
 }
 struct data_output *data_output_kv_create(int log_level, FILE *file)
@@ -432,10 +595,37 @@ struct data_output *data_output_kv_create(int log_level, FILE *file)
 typedef struct {
     struct data_output output;
     FILE *file;
+    file_buffer_t buffer;
     const char **fields;
     const char *separator;
+    unsigned num_fields;
+    unsigned index_mask;   ///< size of the field index minus one, a power of two
+    unsigned *field_index; ///< column plus one of the fields by key hash, 0 if empty
+    unsigned known_column[DATA_KEY_COUNT]; ///< column plus one of the well-known keys, 0 if not a field
+    data_t **slots;        ///< the item of each column in the event being printed
 } data_output_csv_t;
 
+// FNV-1a hash of a key
+static unsigned csv_key_hash(char const *key)
+{
+    unsigned h = 2166136261U;
+    for (; *key; ++key)
+        h = (h ^ (unsigned char)*key) * 16777619U;
+    return h;
+}
+
+// the column of a key, -1 if the key is not a field
+static int csv_field_column(data_output_csv_t *csv, char const *key)
+{
+    for (unsigned i = csv_key_hash(key);; ++i) {
+        unsigned col = csv->field_index[i & csv->index_mask];
+        if (!col)
+            return -1;
+        if (!strcmp(csv->fields[col - 1], key))
+            return (int)col - 1;
+    }
+}
+
 static void R_API_CALLCONV print_csv_data(data_output_t *output, data_t *data, char const *format)
 {
     UNUSED(format);
@@ -546,6 +736,36 @@ static void R_API_CALLCONV data_output_csv_start(struct data_output *output, cha
     csv->fields[csv_fields] = NULL;
     free((void *)allowed);
     free(use_count);
+    allowed   = NULL;
+    use_count = NULL;
+
+    // index the columns by key, the index is kept at most half full
+    unsigned index_size = 2;
+    while (index_size < 2 * (unsigned)csv_fields)
+        index_size *= 2;
+    csv->num_fields  = csv_fields;
+    csv->index_mask  = index_size - 1;
+    csv->field_index = calloc(index_size, sizeof(*csv->field_index));
+    if (!csv->field_index) {
+        WARN_CALLOC("data_output_csv_start()");
+        goto alloc_error;
+    }
+    csv->slots = calloc(csv_fields + 1, sizeof(*csv->slots)); // '+ 1' so we never alloc size 0
+    if (!csv->slots) {
+        WARN_CALLOC("data_output_csv_start()");
+        goto alloc_error;
+    }
+    for (i = 0; i < csv_fields; ++i) {
+        unsigned h = csv_key_hash(csv->fields[i]);
+        while (csv->field_index[h & csv->index_mask])
+            ++h;
+        csv->field_index[h & csv->index_mask] = i + 1;
+    }
+    // the well-known keys skip the hash
+    for (unsigned k = DATA_KEY_OTHER + 1; k < DATA_KEY_COUNT; ++k) {
+        int col = csv_field_column(csv, data_key_name((enum data_key)k));
+        csv->known_column[k] = col >= 0 ? (unsigned)col + 1 : 0;
+    }
 
     // Output the CSV header
     for (i = 0; csv->fields[i]; ++i) {
@@ -557,8 +777,11 @@ static void R_API_CALLCONV data_output_csv_start(struct data_output *output, cha
 alloc_error:
     free(use_count);
     free((void *)allowed);
-    if (csv)
+    if (csv) {
         free((void *)csv->fields);
+        free(csv->field_index);
+        free(csv->slots);
+    }
     free(csv);
 }
 
@@ -567,7 +790,7 @@ static void R_API_CALLCONV print_csv_double(data_output_t *output, double data,
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    fprintf(csv->file, "%.3f", data);
+    fprint_double(csv->file, "%.3f", data);
 }
 
 static void R_API_CALLCONV print_csv_int(data_output_t *output, int data, char const *format)
@@ -575,51 +798,66 @@ static void R_API_CALLCONV print_csv_int(data_output_t *output, int data, char c
     UNUSED(format);
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    fprintf(csv->file, "%d", data);
+    fprint_int(csv->file, "%d", data);
 }
 
 static void R_API_CALLCONV data_output_csv_print(data_output_t *output, data_t *data)
 {
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
-    const char **fields = csv->fields;
-
+    // one pass over the items puts each into the slot of its column, the first item of a key is used
+    data_t **slots = csv->slots;
+    memset(slots, 0, csv->num_fields * sizeof(*slots));
     int regular = 0; // skip "states" output
-    for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "msg") || !strcmp(d->key, "codes") || !strcmp(d->key, "model")) {
-            regular = 1;
-            break;
+    for (data_t *iter = data; iter; iter = iter->next) {
+        enum data_key known = data_key_of(iter);
+        int col;
+        if (known) {
+            regular |= known == DATA_KEY_MSG || known == DATA_KEY_CODES || known == DATA_KEY_MODEL;
+            col = (int)csv->known_column[known] - 1;
         }
+        else {
+            col = csv_field_column(csv, iter->key);
+        }
+        if (col >= 0 && !slots[col])
+            slots[col] = iter;
     }
     if (!regular)
         return;
 
-    for (int i = 0; fields[i]; ++i) {
-        const char *key = fields[i];
-        data_t *found   = NULL;
+    for (unsigned i = 0; i < csv->num_fields; ++i) {
+        data_t *found = slots[i];
         if (i)
             fprintf(csv->file, "%s", csv->separator);
-        for (data_t *iter = data; !found && iter; iter = iter->next)
-            if (strcmp(iter->key, key) == 0)
-                found = iter;
-
         if (found)
             print_value(output, found->type, found->value, found->format);
     }
 
     fputc('\n', csv->file);
-    fflush(csv->file);
+    file_buffer_poll(&csv->buffer, csv->file, 1);
+}
+
+static void R_API_CALLCONV data_output_csv_poll(data_output_t *output)
+{
+    data_output_csv_t *csv = (data_output_csv_t *)output;
+
+    file_buffer_poll(&csv->buffer, csv->file, 0);
 }
 
 static void R_API_CALLCONV data_output_csv_free(data_output_t *output)
 {
     data_output_csv_t *csv = (data_output_csv_t *)output;
 
+    if (csv->buffer.pending)
+        file_buffer_write(&csv->buffer, csv->file);
+
     free((void *)csv->fields);
+    free(csv->field_index);
+    free(csv->slots);
     free(csv);
 }
 
-struct data_output *data_output_csv_create(int log_level, FILE *file)
+struct data_output *data_output_csv_create(int log_level, FILE *file, file_flush_t const *flush)
 {
     data_output_csv_t *csv = calloc(1, sizeof(data_output_csv_t));
     if (!csv) {
@@ -635,8 +873,10 @@ struct data_output *data_output_csv_create(int log_level, FILE *file)
     csv->output.print_int    = print_csv_int;
     csv->output.output_start = data_output_csv_start;
     csv->output.output_print = data_output_csv_print;
+    csv->output.output_poll  = data_output_csv_poll;
     csv->output.output_free  = data_output_csv_free;
     csv->file                = file;
+    file_buffer_init(&csv->buffer, file, flush);
 
     return (struct data_output *)csv;
 }
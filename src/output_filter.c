@@ -0,0 +1,412 @@
+/** @file
+    Filter expressions of the outputs, evaluated on the events before formatting.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_filter.h"
+
+#include "data.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Deepest nesting of parentheses and negations.
+#define FILTER_MAX_DEPTH 64
+
+typedef enum {
+    FILTER_OR,
+    FILTER_AND,
+    FILTER_NOT,
+    FILTER_HAS,
+    FILTER_EQ,
+    FILTER_NE,
+    FILTER_LT,
+    FILTER_LE,
+    FILTER_GT,
+    FILTER_GE,
+    FILTER_MATCH,
+    FILTER_NO_MATCH,
+} filter_op_t;
+
+typedef struct {
+    filter_op_t op;
+    unsigned left;    ///< the operand of NOT, the first operand of AND and OR
+    unsigned right;   ///< the second operand of AND and OR
+    unsigned key_id;  ///< the well-known key, DATA_KEY_OTHER if matched by name
+    char const *key;  ///< the key of a comparison
+    char const *str;  ///< the string compared to, NULL for a number
+    double num;       ///< the number compared to
+} filter_node_t;
+
+struct output_filter {
+    filter_node_t *nodes;
+    unsigned num_nodes;
+    unsigned root;
+    char *strings; ///< the keys and strings of the nodes
+};
+
+typedef struct {
+    output_filter_t *filter;
+    char const *expr;
+    char const *p;
+    char *strings; ///< the free space of the keys and strings
+    char *err;
+    size_t err_size;
+    int failed;
+    unsigned depth;
+} filter_parser_t;
+
+/* Compile */
+
+static void parse_error(filter_parser_t *parser, char const *msg)
+{
+    if (parser->failed)
+        return;
+    parser->failed = 1;
+    if (parser->err && parser->err_size)
+        snprintf(parser->err, parser->err_size, "%s at position %d of \"%s\"", msg, (int)(parser->p - parser->expr), parser->expr);
+}
+
+static void skip_ws(filter_parser_t *parser)
+{
+    while (*parser->p == ' ' || *parser->p == '\t')
+        parser->p++;
+}
+
+static unsigned add_node(filter_parser_t *parser, filter_op_t op, unsigned left, unsigned right)
+{
+    // a node takes at least one char of the expression, the nodes fit
+    unsigned n          = parser->filter->num_nodes++;
+    filter_node_t *node = &parser->filter->nodes[n];
+    node->op            = op;
+    node->left          = left;
+    node->right         = right;
+    return n;
+}
+
+static int is_key_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static unsigned parse_or(filter_parser_t *parser);
+
+static unsigned parse_comparison(filter_parser_t *parser)
+{
+    char const *key = parser->p;
+    while (is_key_char(*parser->p))
+        parser->p++;
+    size_t key_len = parser->p - key;
+    if (!key_len) {
+        parse_error(parser, "Expected a key");
+        return 0;
+    }
+
+    unsigned n          = add_node(parser, FILTER_HAS, 0, 0);
+    filter_node_t *node = &parser->filter->nodes[n];
+    node->key           = memcpy(parser->strings, key, key_len);
+    node->key_id        = DATA_KEY_OTHER;
+    parser->strings[key_len] = '\0';
+    parser->strings += key_len + 1;
+    for (unsigned k = DATA_KEY_OTHER + 1; k < DATA_KEY_COUNT; ++k) {
+        if (!strcmp(data_key_name(k), node->key))
+            node->key_id = k;
+    }
+
+    skip_ws(parser);
+    char const *p = parser->p;
+    if (p[0] == '=' && p[1] == '=')
+        node->op = FILTER_EQ;
+    else if (p[0] == '!' && p[1] == '=')
+        node->op = FILTER_NE;
+    else if (p[0] == '<' && p[1] == '=')
+        node->op = FILTER_LE;
+    else if (p[0] == '>' && p[1] == '=')
+        node->op = FILTER_GE;
+    else if (p[0] == '!' && p[1] == '~')
+        node->op = FILTER_NO_MATCH;
+    else if (p[0] == '<')
+        node->op = FILTER_LT;
+    else if (p[0] == '>')
+        node->op = FILTER_GT;
+    else if (p[0] == '~')
+        node->op = FILTER_MATCH;
+    else
+        return n; // a key alone
+    parser->p += node->op == FILTER_LT || node->op == FILTER_GT || node->op == FILTER_MATCH ? 1 : 2;
+    skip_ws(parser);
+
+    if (*parser->p == '"') {
+        // a string, only \" is an escape, other backslashes are kept for the regular expressions
+        parser->p++;
+        char *str = parser->strings;
+        while (*parser->p && *parser->p != '"') {
+            if (parser->p[0] == '\\' && parser->p[1] == '"')
+                parser->p++;
+            *str++ = *parser->p++;
+        }
+        if (*parser->p != '"') {
+            parse_error(parser, "Unterminated string");
+            return n;
+        }
+        parser->p++;
+        *str++          = '\0';
+        node->str       = parser->strings;
+        parser->strings = str;
+    }
+    else {
+        char *end;
+        node->num = strtod(parser->p, &end);
+        if (end == parser->p) {
+            parse_error(parser, "Expected a number or a string");
+            return n;
+        }
+        parser->p = end;
+    }
+    if (node->str == NULL && (node->op == FILTER_MATCH || node->op == FILTER_NO_MATCH)) {
+        parse_error(parser, "Expected a string to match");
+    }
+    return n;
+}
+
+static unsigned parse_unary(filter_parser_t *parser)
+{
+    skip_ws(parser);
+    if (parser->depth >= FILTER_MAX_DEPTH) {
+        parse_error(parser, "Expression nested too deep");
+        return 0;
+    }
+    if (parser->p[0] == '!' && parser->p[1] != '=' && parser->p[1] != '~') {
+        parser->p++;
+        parser->depth++;
+        unsigned operand = parse_unary(parser);
+        parser->depth--;
+        return add_node(parser, FILTER_NOT, operand, 0);
+    }
+    if (*parser->p == '(') {
+        parser->p++;
+        parser->depth++;
+        unsigned n = parse_or(parser);
+        parser->depth--;
+        skip_ws(parser);
+        if (*parser->p != ')') {
+            parse_error(parser, "Expected )");
+            return n;
+        }
+        parser->p++;
+        return n;
+    }
+    return parse_comparison(parser);
+}
+
+static unsigned parse_and(filter_parser_t *parser)
+{
+    unsigned n = parse_unary(parser);
+    skip_ws(parser);
+    while (!parser->failed && parser->p[0] == '&' && parser->p[1] == '&') {
+        parser->p += 2;
+        unsigned right = parse_unary(parser);
+        n              = add_node(parser, FILTER_AND, n, right);
+        skip_ws(parser);
+    }
+    return n;
+}
+
+static unsigned parse_or(filter_parser_t *parser)
+{
+    unsigned n = parse_and(parser);
+    skip_ws(parser);
+    while (!parser->failed && parser->p[0] == '|' && parser->p[1] == '|') {
+        parser->p += 2;
+        unsigned right = parse_and(parser);
+        n              = add_node(parser, FILTER_OR, n, right);
+        skip_ws(parser);
+    }
+    return n;
+}
+
+output_filter_t *output_filter_create(char const *expr, char *err, size_t err_size)
+{
+    size_t len = strlen(expr);
+
+    output_filter_t *filter = calloc(1, sizeof(*filter));
+    if (!filter) {
+        WARN_CALLOC("output_filter_create()");
+        return NULL;
+    }
+    filter->nodes = calloc(len + 1, sizeof(*filter->nodes));
+    if (!filter->nodes) {
+        WARN_CALLOC("output_filter_create()");
+        output_filter_free(filter);
+        return NULL;
+    }
+    // each key and string is shorter than its text, plus the terminator
+    filter->strings = malloc(2 * len + 2);
+    if (!filter->strings) {
+        WARN_MALLOC("output_filter_create()");
+        output_filter_free(filter);
+        return NULL;
+    }
+
+    filter_parser_t parser = {
+            .filter   = filter,
+            .expr     = expr,
+            .p        = expr,
+            .strings  = filter->strings,
+            .err      = err,
+            .err_size = err_size,
+    };
+    filter->root = parse_or(&parser);
+    if (!parser.failed && *parser.p) {
+        parse_error(&parser, "Unexpected text");
+    }
+    if (parser.failed) {
+        output_filter_free(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+void output_filter_free(output_filter_t *filter)
+{
+    if (!filter)
+        return;
+    free(filter->nodes);
+    free(filter->strings);
+    free(filter);
+}
+
+/* Evaluate */
+
+// a character matches an atom of the regular expression, a `.`, an escaped or a plain character
+static int match_atom(char const *re, char c)
+{
+    if (re[0] == '\\')
+        return re[1] == c;
+    return re[0] == '.' || re[0] == c;
+}
+
+static int atom_len(char const *re)
+{
+    return re[0] == '\\' && re[1] ? 2 : 1;
+}
+
+static int match_here(char const *re, char const *text);
+
+// the atom repeated any number of times, shortest first
+static int match_star(char const *atom, char const *re, char const *text)
+{
+    do {
+        if (match_here(re, text))
+            return 1;
+    } while (*text && match_atom(atom, *text++));
+    return 0;
+}
+
+static int match_here(char const *re, char const *text)
+{
+    if (re[0] == '\0')
+        return 1;
+    if (re[0] == '$' && re[1] == '\0')
+        return *text == '\0';
+    int len = atom_len(re);
+    if (re[len] == '*')
+        return match_star(re, &re[len + 1], text);
+    if (re[len] == '+')
+        return *text && match_atom(re, *text) && match_star(re, &re[len + 1], text + 1);
+    if (re[len] == '?')
+        return (*text && match_atom(re, *text) && match_here(&re[len + 1], text + 1)) || match_here(&re[len + 1], text);
+    if (*text && match_atom(re, *text))
+        return match_here(&re[len], text + 1);
+    return 0;
+}
+
+// the regular expression matches anywhere in the text, unless anchored with `^`
+static int match_regex(char const *re, char const *text)
+{
+    if (re[0] == '^')
+        return match_here(re + 1, text);
+    do {
+        if (match_here(re, text))
+            return 1;
+    } while (*text++);
+    return 0;
+}
+
+static data_t const *find_key(filter_node_t const *node, data_t const *data)
+{
+    for (; data; data = data->next) {
+        if (node->key_id != DATA_KEY_OTHER ? data_key_is(data, node->key_id) : !strcmp(data->key, node->key))
+            return data;
+    }
+    return NULL;
+}
+
+static int compare(filter_node_t const *node, data_t const *d)
+{
+    int cmp;
+    if (node->str && d->type == DATA_STRING) {
+        char const *str = d->value.v_ptr;
+        if (node->op == FILTER_MATCH)
+            return match_regex(node->str, str);
+        if (node->op == FILTER_NO_MATCH)
+            return !match_regex(node->str, str);
+        cmp = strcmp(str, node->str);
+    }
+    else if (!node->str && (d->type == DATA_INT || d->type == DATA_DOUBLE)) {
+        double val = d->type == DATA_INT ? d->value.v_int : d->value.v_dbl;
+        cmp        = val < node->num ? -1 : val > node->num ? 1 : 0;
+    }
+    else {
+        return 0; // a string and a number
+    }
+
+    switch (node->op) {
+    case FILTER_EQ:
+        return cmp == 0;
+    case FILTER_NE:
+        return cmp != 0;
+    case FILTER_LT:
+        return cmp < 0;
+    case FILTER_LE:
+        return cmp <= 0;
+    case FILTER_GT:
+        return cmp > 0;
+    case FILTER_GE:
+        return cmp >= 0;
+    default:
+        return 0;
+    }
+}
+
+static int eval_node(output_filter_t const *filter, unsigned n, data_t const *data)
+{
+    filter_node_t const *node = &filter->nodes[n];
+    switch (node->op) {
+    case FILTER_OR:
+        return eval_node(filter, node->left, data) || eval_node(filter, node->right, data);
+    case FILTER_AND:
+        return eval_node(filter, node->left, data) && eval_node(filter, node->right, data);
+    case FILTER_NOT:
+        return !eval_node(filter, node->left, data);
+    case FILTER_HAS:
+        return find_key(node, data) != NULL;
+    default: {
+        data_t const *d = find_key(node, data);
+        return d && compare(node, d);
+    }
+    }
+}
+
+int output_filter_match(output_filter_t const *filter, data_t const *data)
+{
+    return !filter || eval_node(filter, filter->root, data);
+}
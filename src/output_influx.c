@@ -1,5 +1,5 @@
 /** @file
-    InfluxDB output for rtl_433 events.
+    InfluxDB and HTTP webhook outputs for rtl_433 events.
 
     Copyright (C) 2019 Daniel Krueger
     based on output_mqtt.c
@@ -17,6 +17,8 @@
 #include "logger.h"
 #include "fatal.h"
 #include "r_util.h"
+#include "abuf.h"
+#include "mem_acct.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -25,32 +27,218 @@
 
 #include "mongoose.h"
 
-/* InfluxDB client abstraction / printer */
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
+/* Batched HTTP POST client abstraction, InfluxDB and webhook printers */
+
+#define INFLUX_PREFIX_SLOTS 256 ///< slots of the line prefix cache, a power of two
+#define INFLUX_PREFIX_KEY   256 ///< longest key of the model and tag values to cache
+
+/// The line prefix "measurement,tag=value,..." of the model and tag values of a sensor.
+typedef struct {
+    uint32_t hash;
+    unsigned key_len;
+    unsigned prefix_len;
+    char text[]; ///< the key, then the prefix
+} influx_prefix_t;
 
 typedef struct {
     struct data_output output;
     struct mg_mgr *mgr;
     struct mg_connection *conn;
     struct mg_connection *timer;
+    char const *name;  ///< the server for the log, "InfluxDB" or "Webhook"
     int reconnect_delay;
     int prev_status;
     int prev_resp_code;
     char hostname[64];
     char url[400];
-    char extra_headers[150];
+    char address[300]; ///< the server as "tcp://host:port"
+    char host[300];    ///< the Host header
+    char target[400];  ///< the path and query of the request
+    char extra_headers[400];
     tls_opts_t tls_opts;
-    int databufidxfill;
-    struct mbuf databufs[2];
-
+    tls_session_t *tls_session; ///< the session to resume on a reconnect, NULL without TLS
+    int tls_saved;     ///< the session of the connection was kept
+    int connected;     ///< the connection is established and kept alive
+    int in_flight;     ///< the batch was sent and waits for the reply
+    double sent_at;    ///< time the batch was sent
+    double retry_at;   ///< earliest time to connect or send again
+    double timer_at;   ///< time the timer is set for, 0 if not set
+    struct mbuf lines; ///< line protocol waiting to be batched
+    unsigned lines_count;
+    double lines_since; ///< arrival time of the oldest waiting line
+    struct mbuf batch;  ///< the request body, kept until written
+    unsigned batch_lines;
+    unsigned batch_size; ///< uncompressed size of the batch
+    int batch_gzip;      ///< the batch is compressed
+    double batch_since;  ///< arrival time of the oldest line of the batch
+    int json_array;      ///< the webhook body is a JSON array of the events, otherwise a line for each
+    struct mbuf array;   ///< the JSON array of a webhook batch before compression
+    unsigned max_lines;  ///< most lines in a batch
+    unsigned max_size;   ///< most bytes in a batch
+    unsigned buffer_size; ///< most bytes of waiting lines before the oldest are dropped
+    unsigned flush_ms;   ///< how long lines wait for a batch to fill up
+    int gzip;
+    int dropping;        ///< lines are being dropped
+    influx_stats_t stats;
+    influx_prefix_t *prefixes[INFLUX_PREFIX_SLOTS]; ///< the line prefixes by hash of the key, a collision replaces
 } influx_client_t;
 
 static void influx_client_send(influx_client_t *ctx);
 
+// schedule a call to influx_client_send(), the earliest time wins
+static void influx_client_wakeup(influx_client_t *ctx, double at)
+{
+    if (!ctx->timer || (ctx->timer_at > 0 && ctx->timer_at <= at))
+        return;
+    ctx->timer_at = at;
+    mg_set_timer(ctx->timer, at);
+}
+
+static void influx_client_backoff(influx_client_t *ctx)
+{
+    ctx->retry_at = mg_time() + ctx->reconnect_delay;
+    if (ctx->reconnect_delay < 60) {
+        // 0, 1, 3, 6, 10, 16, 25, 39, 60
+        ctx->reconnect_delay = (ctx->reconnect_delay + 1) * 3 / 2;
+    }
+}
+
+static void influx_client_reply(influx_client_t *ctx, struct http_message *hm)
+{
+    if (!ctx->in_flight)
+        return; // not a reply to a batch
+    ctx->in_flight = 0;
+
+    if (hm->resp_code >= 200 && hm->resp_code < 300) {
+        // mark influx data as sent
+        unsigned write_ms = (unsigned)((mg_time() - ctx->sent_at) * 1000);
+        ctx->stats.batches += 1;
+        ctx->stats.lines += ctx->batch_lines;
+        ctx->stats.write_ms += write_ms;
+        if (ctx->stats.max_write_ms < write_ms)
+            ctx->stats.max_write_ms = write_ms;
+        unsigned latency_ms = (unsigned)((mg_time() - ctx->batch_since) * 1000);
+        ctx->stats.latency_ms += latency_ms;
+        if (ctx->stats.max_latency_ms < latency_ms)
+            ctx->stats.max_latency_ms = latency_ms;
+        if (ctx->stats.max_lines < ctx->batch_lines)
+            ctx->stats.max_lines = ctx->batch_lines;
+        if (ctx->stats.max_bytes < ctx->batch_size)
+            ctx->stats.max_bytes = ctx->batch_size;
+        ctx->batch.len       = 0;
+        ctx->reconnect_delay = 0;
+        ctx->retry_at        = 0;
+        if (ctx->dropping)
+            print_logf(LOG_NOTICE, ctx->name, "%s caught up, %u lines dropped so far", ctx->name, ctx->stats.dropped);
+        ctx->dropping = 0;
+    }
+    else {
+        if (ctx->prev_resp_code != hm->resp_code)
+            print_logf(LOG_WARNING, ctx->name, "%s replied HTTP code: %d with message:\n%.*s", ctx->name, hm->resp_code, (int)hm->body.len, hm->body.p);
+        if (hm->resp_code == 429 || hm->resp_code >= 500) {
+            // the server is busy, send the batch again later
+            ctx->stats.retries += 1;
+            influx_client_backoff(ctx);
+        }
+        else {
+            // the server rejected the batch, sending it again won't help
+            ctx->stats.dropped += ctx->batch_lines;
+            ctx->batch.len = 0;
+        }
+    }
+    ctx->prev_resp_code = hm->resp_code;
+}
+
+// returns the length of a complete chunked body, 0 if incomplete
+static size_t http_chunked_len(char const *body, size_t len)
+{
+    size_t pos = 0;
+    while (pos < len) {
+        char *end;
+        unsigned long chunk = strtoul(&body[pos], &end, 16);
+        // skip the chunk size and extensions
+        char const *eol = memchr(end, '\n', len - (end - body));
+        if (!eol)
+            return 0;
+        pos = eol + 1 - body;
+        if (chunk == 0) {
+            // skip trailers up to the empty line
+            while (pos < len) {
+                eol = memchr(&body[pos], '\n', len - pos);
+                if (!eol)
+                    return 0;
+                if (eol == &body[pos] || (eol == &body[pos + 1] && body[pos] == '\r'))
+                    return eol + 1 - body;
+                pos = eol + 1 - body;
+            }
+            return 0;
+        }
+        pos += chunk + 2; // the data and CRLF
+    }
+    return 0;
+}
+
+// parse replies, mongoose would wait for the end of a 204 reply without Content-Length
+static void influx_client_recv(influx_client_t *ctx, struct mg_connection *nc)
+{
+    struct mbuf *io = &nc->recv_mbuf;
+    int keep_alive = 1;
+    while (io->len > 0 && keep_alive) {
+        struct http_message hm;
+        int req_len = mg_parse_http(io->buf, io->len, &hm, 0);
+        if (req_len == 0)
+            return; // headers incomplete
+        if (req_len < 0) {
+            print_logf(LOG_WARNING, ctx->name, "%s sent an invalid reply", ctx->name);
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return;
+        }
+        struct mg_str *s = mg_get_http_header(&hm, "Connection");
+        if (s && !mg_vcasecmp(s, "close"))
+            keep_alive = 0;
+
+        size_t len;
+        if (hm.resp_code < 200 || hm.resp_code == 204 || hm.resp_code == 304) {
+            len = req_len; // never a body
+        }
+        else if (hm.body.len != (size_t)~0) {
+            len = req_len + hm.body.len;
+        }
+        else if ((s = mg_get_http_header(&hm, "Transfer-Encoding")) && !mg_vcasecmp(s, "chunked")) {
+            size_t chunked = http_chunked_len(io->buf + req_len, io->len - req_len);
+            if (!chunked)
+                return; // body incomplete
+            len = req_len + chunked;
+        }
+        else {
+            // the body ends with the connection, what we have is good enough for a message
+            len        = io->len;
+            keep_alive = 0;
+        }
+        if (len > io->len)
+            return; // body incomplete
+
+        hm.body.len = len - req_len;
+        influx_client_reply(ctx, &hm);
+        mbuf_remove(io, len);
+    }
+
+    if (keep_alive) {
+        influx_client_send(ctx);
+    }
+    else {
+        nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+}
+
 static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
     influx_client_t *ctx = (influx_client_t *)nc->user_data;
-    struct http_message *hm = (struct http_message *)ev_data;
 
     switch (ev) {
     case MG_EV_CONNECT: {
@@ -58,14 +246,17 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
         if (connect_status == 0) {
             // Success
             if (ctx) {
-                ctx->reconnect_delay = 0;
+                tls_session_connected(ctx->tls_session, nc, 0, &ctx->stats.tls);
+                ctx->tls_saved = 0;
+                ctx->connected = 1;
+                influx_client_send(ctx);
             }
         } else {
             // Error, print only once
             if (ctx) {
+                tls_session_connected(ctx->tls_session, nc, connect_status, &ctx->stats.tls);
                 if (ctx->prev_status != connect_status)
-                    print_logf(LOG_WARNING, "InfluxDB", "InfluxDB connect error: %s", strerror(connect_status));
-                ctx->conn = NULL;
+                    print_logf(LOG_WARNING, ctx->name, "%s connect error: %s", ctx->name, strerror(connect_status));
             }
         }
         if (ctx) {
@@ -73,34 +264,37 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
         }
         break;
     }
-    case MG_EV_HTTP_CHUNK: // response is normally empty (so mongoose thinks we received a chunk only)
-    case MG_EV_HTTP_REPLY:
-        nc->flags |= MG_F_CLOSE_IMMEDIATELY;
-        if (hm->resp_code == 204) {
-            // mark influx data as sent
-        }
-        else {
-            if (ctx && ctx->prev_resp_code != hm->resp_code)
-                print_logf(LOG_WARNING, "InfluxDB", "InfluxDB replied HTTP code: %d with message:\n%s", hm->resp_code, hm->body.p);
+    case MG_EV_RECV:
+        if (ctx && !ctx->tls_saved) {
+            // TLS 1.3 servers send the session tickets after the handshake
+            tls_session_save(ctx->tls_session, nc);
+            ctx->tls_saved = 1;
         }
         if (ctx) {
-            ctx->prev_resp_code = hm->resp_code;
+            influx_client_recv(ctx, nc);
+        }
+        else {
+            mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
         }
         break;
     case MG_EV_CLOSE:
         if (!ctx) {
             break; // shutting down
         }
-        ctx->conn = NULL;
+        tls_session_save(ctx->tls_session, nc);
+        ctx->conn      = NULL;
+        ctx->connected = 0;
+        if (ctx->in_flight) {
+            // the batch is sent again on the next connection
+            ctx->in_flight = 0;
+            ctx->stats.retries += 1;
+        }
         if (!ctx->timer) {
             break; // shutting down
         }
-        // Timer for next connect attempt, sends us MG_EV_TIMER event
-        mg_set_timer(ctx->timer, mg_time() + ctx->reconnect_delay);
-        if (ctx->reconnect_delay < 60) {
-            // 0, 1, 3, 6, 10, 16, 25, 39, 60
-            ctx->reconnect_delay = (ctx->reconnect_delay + 1) * 3 / 2;
-        }
+        // Delay the next connect attempt
+        influx_client_backoff(ctx);
+        influx_client_send(ctx);
         break;
     }
 }
@@ -113,7 +307,10 @@ static void influx_client_timer(struct mg_connection *nc, int ev, void *ev_data)
 
     switch (ev) {
     case MG_EV_TIMER: {
-        // Try to reconnect, ends if no data to send
+        if (!ctx)
+            break;
+        // Try to reconnect or send, ends if no data to send
+        ctx->timer_at = 0;
         influx_client_send(ctx);
         break;
     }
@@ -123,26 +320,150 @@ static void influx_client_timer(struct mg_connection *nc, int ev, void *ev_data)
 static influx_client_t *influx_client_init(influx_client_t *ctx, char const *url, char const *token)
 {
     snprintf(ctx->url, sizeof(ctx->url), "%s", url);
-    snprintf(ctx->extra_headers, sizeof (ctx->extra_headers), "Authorization: Token %s\r\n", token);
+
+    struct mg_str scheme, user_info, host, path, query, fragment;
+    unsigned int port = 0;
+    mg_parse_uri(mg_mk_str(url), &scheme, &user_info, &host, &port, &path, &query, &fragment);
+    if (!port)
+        port = mg_vcmp(&scheme, "https") ? 80 : 443;
+    snprintf(ctx->address, sizeof(ctx->address), "tcp://%.*s:%u", (int)host.len, host.p, port);
+    // the Host header includes the port as given
+    snprintf(ctx->host, sizeof(ctx->host), "%.*s", (int)(path.p - host.p), host.p);
+    snprintf(ctx->target, sizeof(ctx->target), "%.*s%s%.*s", (int)path.len, path.p, query.len ? "?" : "", (int)query.len, query.p);
+
+    abuf_t headers;
+    abuf_init(&headers, ctx->extra_headers, sizeof(ctx->extra_headers));
+    if (user_info.len) {
+        struct mbuf auth;
+        mbuf_init(&auth, 0);
+        mg_basic_auth_header(user_info, mg_mk_str(NULL), &auth);
+        abuf_printf(&headers, "%.*s", (int)auth.len, auth.buf);
+        mbuf_free(&auth);
+    }
+    if (token) {
+        abuf_printf(&headers, "Authorization: Token %s\r\n", token);
+    }
 
     return ctx;
 }
 
+#ifdef ZLIB
+// compress to a gzip stream, returns 0 on success
+static int influx_gzip(struct mbuf *dst, char const *src, size_t len)
+{
+    z_stream zs = {0};
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return -1;
+    size_t bound = deflateBound(&zs, (uLong)len);
+    mbuf_resize(dst, bound);
+    if (dst->size < bound) {
+        deflateEnd(&zs);
+        return -1;
+    }
+    zs.next_in   = (Bytef *)src;
+    zs.avail_in  = (uInt)len;
+    zs.next_out  = (Bytef *)dst->buf;
+    zs.avail_out = (uInt)bound;
+    int ret      = deflate(&zs, Z_FINISH);
+    dst->len     = zs.total_out;
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END ? 0 : -1;
+}
+#endif
+
+// move the oldest lines, up to the batch limits, to the batch
+static void influx_client_batch(influx_client_t *ctx)
+{
+    size_t size    = 0;
+    unsigned count = 0;
+    while (size < ctx->lines.len && count < ctx->max_lines) {
+        char const *eol = memchr(&ctx->lines.buf[size], '\n', ctx->lines.len - size);
+        size_t next     = eol ? (size_t)(eol + 1 - ctx->lines.buf) : ctx->lines.len;
+        if (count && next > ctx->max_size)
+            break;
+        size = next;
+        count++;
+    }
+
+    // the events of a webhook as a JSON array, the line ends separate them
+    char const *body = ctx->lines.buf;
+    size_t body_len  = size;
+    if (ctx->json_array) {
+        ctx->array.len = 0;
+        mbuf_append(&ctx->array, "[", 1);
+        mbuf_append(&ctx->array, ctx->lines.buf, size);
+        for (size_t i = 1; i < ctx->array.len; ++i) {
+            if (ctx->array.buf[i] == '\n')
+                ctx->array.buf[i] = ',';
+        }
+        if (ctx->array.len == size + 1)
+            ctx->array.buf[size] = ']'; // the last line end
+        body     = ctx->array.buf;
+        body_len = ctx->array.len;
+    }
+
+    ctx->batch.len  = 0;
+    ctx->batch_gzip = 0;
+#ifdef ZLIB
+    if (ctx->gzip && !influx_gzip(&ctx->batch, body, body_len))
+        ctx->batch_gzip = 1;
+#endif
+    if (!ctx->batch_gzip) {
+        ctx->batch.len = 0;
+        mbuf_append(&ctx->batch, body, body_len);
+    }
+    ctx->batch_lines = count;
+    ctx->batch_size  = (unsigned)body_len;
+    ctx->batch_since = ctx->lines_since;
+
+    mbuf_remove(&ctx->lines, size);
+    ctx->lines_count -= count;
+    ctx->lines_since = mg_time();
+}
+
 static void influx_client_send(influx_client_t *ctx)
 {
-    struct mbuf *buf = &ctx->databufs[ctx->databufidxfill];
+    double now = mg_time();
+
+    /*fprintf(stderr, "Influx %p lines: %u (%lu) batch: %lu %s\n",
+            (void*)ctx, ctx->lines_count, ctx->lines.len, ctx->batch.len,
+            ctx->in_flight ? "in flight" : ctx->connected ? "to be sent" : "connecting");*/
+
+    // cut the next batch once it is full or has waited long enough
+    if (!ctx->batch.len && ctx->lines.len) {
+        if (ctx->lines_count >= ctx->max_lines || ctx->lines.len >= ctx->max_size
+                || now >= ctx->lines_since + ctx->flush_ms / 1000.0) {
+            influx_client_batch(ctx);
+        }
+        else {
+            influx_client_wakeup(ctx, ctx->lines_since + ctx->flush_ms / 1000.0);
+        }
+    }
+
+    if (!ctx->batch.len)
+        return;
 
-    /*fprintf(stderr, "Influx %p msg: \"%s\" with %lu/%lu %s\n",
-            (void*)ctx, buf->buf, buf->len, buf->size,
-            ctx->conn ? "buffering" : "to be sent");*/
+    if (now < ctx->retry_at) {
+        influx_client_wakeup(ctx, ctx->retry_at);
+        return;
+    }
 
-    if (ctx->conn || !buf->len)
+    if (ctx->conn) {
+        if (!ctx->connected || ctx->in_flight)
+            return;
+        mg_printf(ctx->conn, "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Length: %u\r\n%s%s\r\n",
+                ctx->target, ctx->host, (unsigned)ctx->batch.len, ctx->extra_headers,
+                ctx->batch_gzip ? "Content-Encoding: gzip\r\n" : "");
+        mg_send(ctx->conn, ctx->batch.buf, ctx->batch.len);
+        ctx->in_flight = 1;
+        ctx->sent_at   = now;
         return;
+    }
 
     char const *error_string = NULL;
     struct mg_connect_opts opts = {.user_data = ctx, .error_string = &error_string};
     if (ctx->tls_opts.tls_ca_cert) {
-        print_logf(LOG_INFO, "InfluxDB", "influxs (TLS) parameters are: "
+        print_logf(LOG_INFO, ctx->name, "%s (TLS) parameters are: "
                                        "tls_cert=%s "
                                        "tls_key=%s "
                                        "tls_ca_cert=%s "
@@ -150,6 +471,7 @@ static void influx_client_send(influx_client_t *ctx)
                                        "tls_server_name=%s "
                                        "tls_psk_identity=%s "
                                        "tls_psk_key=%s ",
+                ctx->name,
                 ctx->tls_opts.tls_cert,
                 ctx->tls_opts.tls_key,
                 ctx->tls_opts.tls_ca_cert,
@@ -167,18 +489,19 @@ static void influx_client_send(influx_client_t *ctx)
         opts.ssl_psk_identity  = ctx->tls_opts.tls_psk_identity;
         opts.ssl_psk_key       = ctx->tls_opts.tls_psk_key;
 #else
-        print_log(LOG_FATAL, __func__, "influxs (TLS) not available");
+        print_logf(LOG_FATAL, __func__, "%s (TLS) not available", ctx->name);
         exit(1);
 #endif
     }
-    if ((ctx->conn = mg_connect_http_opt(ctx->mgr, influx_client_event, opts, ctx->url, ctx->extra_headers, buf->buf)) == NULL) {
-        print_logf(LOG_WARNING, "InfluxDB", "Connect to InfluxDB (%s) failed (%s)", ctx->url, error_string);
-    }
-    else {
-        ctx->databufidxfill ^= 1;
-        buf->len = 0;
-        *buf->buf = '\0';
+    // the connection is kept alive, batches are written once it is established
+    if ((ctx->conn = mg_connect_opt(ctx->mgr, ctx->address, influx_client_event, opts)) == NULL) {
+        print_logf(LOG_WARNING, ctx->name, "Connect to %s (%s) failed (%s)", ctx->name, ctx->url, error_string);
+        influx_client_backoff(ctx);
+        influx_client_wakeup(ctx, ctx->retry_at);
+        return;
     }
+    // a reconnect resumes the session, skipping the certificate exchange and key agreement
+    tls_session_resume(ctx->tls_session, ctx->conn);
 }
 
 /* Helper */
@@ -214,244 +537,343 @@ static size_t mbuf_reserve(struct mbuf *a, size_t len)
     return len;
 }
 
-static char *mbuf_snprintf(struct mbuf *a, char const *format, ...)
-#if defined(__GNUC__) || defined(__clang__)
-        __attribute__((format(printf, 2, 3)))
-#endif
-;
-static char *mbuf_snprintf(struct mbuf *a, char const *format, ...)
+/// append the tag/identifier cleaned like influx_sanitize_tag()
+static void influx_put_tag(struct mbuf *buf, char const *tag, size_t len)
 {
-    char *str = &a->buf[a->len];
-    int size;
-    va_list ap;
-    va_start(ap, format);
-    size = vsnprintf(str, a->size - a->len, format, ap);
-    va_end(ap);
-    if (size > 0) {
-        // vsnprintf might return size larger than actually filled
-        size_t len = strlen(str);
-        a->len += len;
+    if (mbuf_reserve(buf, len + 1) < len + 1)
+        return;
+    char *p      = &buf->buf[buf->len];
+    bool leading = true;
+    for (size_t i = 0; i < len; ++i) {
+        char c = tag[i];
+        if (c != '-' && c != '.' && (c < 'A' || c > 'Z') && (c < 'a' || c > 'z') && (c < '0' || c > '9'))
+            c = '_';
+        if (leading && c == '_')
+            c = 'x';
+        else
+            leading = false;
+        *p++ = c;
     }
-    return str;
+    buf->len = p - buf->buf;
 }
 
-static void mbuf_remove_part(struct mbuf *a, char *pos, size_t len)
+/// append the string as quoted field value with ", \ and control chars escaped
+static void influx_put_string(struct mbuf *buf, char const *str)
 {
-    if (pos >= a->buf && pos < &a->buf[a->len] && &pos[len] <= &a->buf[a->len]) {
-        memmove(pos, &pos[len], a->len - (pos - a->buf) - len);
-        a->len -= len;
+    size_t len = strlen(str);
+    if (mbuf_reserve(buf, 2 * len + 3) < 2 * len + 3)
+        return;
+    char *p = &buf->buf[buf->len];
+    *p++    = '"';
+    for (; *str; ++str) {
+        if (*str == '\r' || *str == '\n' || *str == '\t') {
+            *p++ = '\\';
+            *p++ = *str == '\r' ? 'r' : *str == '\n' ? 'n' : 't';
+            continue;
+        }
+        if (*str == '"' || *str == '\\')
+            *p++ = '\\';
+        *p++ = *str;
     }
+    *p++     = '"';
+    buf->len = p - buf->buf;
 }
 
-static void R_API_CALLCONV print_influx_array(data_output_t *output, data_array_t *array, char const *format)
+/// the text of a tag value or number, str is the space to format into
+static char const *influx_value_text(data_t const *d, char *str, size_t size)
 {
-    UNUSED(array);
-    UNUSED(format);
-    influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
-    mbuf_snprintf(buf, "\"array\""); // TODO
+    abuf_t num;
+    abuf_init(&num, str, size);
+    switch (d->type) {
+    case DATA_STRING:
+        return d->value.v_ptr;
+    case DATA_INT:
+        abuf_print_int(&num, "%d", d->value.v_int);
+        return str;
+    case DATA_DOUBLE:
+        abuf_print_fixed(&num, d->value.v_dbl, 6);
+        return str;
+    case DATA_DATA:
+        data_print_jsons(d->value.v_ptr, str, size);
+        return str;
+    default:
+        return "array"; // TODO
+    }
 }
 
-static void R_API_CALLCONV print_influx_data_escaped(data_output_t *output, data_t *data, char const *format)
+static int influx_is_tag(data_t const *d)
 {
-    char str[1000];
-    data_print_jsons(data, str, sizeof (str));
-    output->print_string(output, str, format);
+    return data_key_is(d, DATA_KEY_TYPE)
+            || data_key_is(d, DATA_KEY_SUBTYPE)
+            || data_key_is(d, DATA_KEY_ID)
+            || data_key_is(d, DATA_KEY_CHANNEL)
+            || data_key_is(d, DATA_KEY_MIC);
 }
 
-static void R_API_CALLCONV print_influx_string_escaped(data_output_t *output, char const *str, char const *format)
+/// append the measurement and the tags, "measurement,tag=value,..."
+static void influx_put_prefix(influx_client_t *influx, struct mbuf *buf, data_t const *data, data_t const *data_model)
 {
-    UNUSED(format);
-    influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *databuf = &influx->databufs[influx->databufidxfill];
-    size_t size = databuf->size - databuf->len;
-    char *buf = &databuf->buf[databuf->len];
-
-    if (size < strlen(str) + 3) {
-        return;
+    char str[1000];
+    if (!data_model) {
+        // data isn't from device (maybe report for example)
+        // use hostname for measurement
+        mbuf_append(buf, "rtl_433_", 8);
+        mbuf_append(buf, influx->hostname, strlen(influx->hostname));
+    }
+    else {
+        // use model for measurement
+        char const *model = influx_value_text(data_model, str, sizeof(str));
+        influx_put_tag(buf, model, strlen(model));
     }
 
-    *buf++ = '"';
-    size--;
-    for (; *str && size >= 3; ++str) {
-        if (*str == '\r') {
-            *buf++ = '\\';
-            size--;
-            *buf++ = 'r';
-            size--;
-            continue;
-        }
-        if (*str == '\n') {
-            *buf++ = '\\';
-            size--;
-            *buf++ = 'n';
-            size--;
+    for (data_t const *d = data; d; d = d->next) {
+        if (!influx_is_tag(d))
             continue;
-        }
-        if (*str == '\t') {
-            *buf++ = '\\';
-            size--;
-            *buf++ = 't';
-            size--;
+        mbuf_append(buf, ",", 1);
+        influx_put_tag(buf, d->key, strlen(d->key));
+        mbuf_append(buf, "=", 1);
+        char const *value = influx_value_text(d, str, sizeof(str));
+        influx_put_tag(buf, value, strlen(value));
+    }
+}
+
+// FNV-1a hash of a prefix key
+static uint32_t influx_prefix_hash(char const *key, size_t len)
+{
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ (unsigned char)key[i]) * 16777619U;
+    return h;
+}
+
+/// append the prefix of the tag values from the cache, built and kept on a miss
+static void influx_put_cached_prefix(influx_client_t *influx, struct mbuf *buf, data_t const *data, data_t const *data_model)
+{
+    // the key is the model and the tag values, unsanitized, each ended by a NUL
+    char key[INFLUX_PREFIX_KEY];
+    size_t key_len = 0;
+    char str[32];
+    key[key_len++] = data_model ? 'M' : 'H';
+    for (data_t const *d = data; d; d = d->next) {
+        if (d != data_model && !influx_is_tag(d))
             continue;
+        char const *text = NULL;
+        if (d->type == DATA_STRING || d->type == DATA_INT || d->type == DATA_DOUBLE)
+            text = influx_value_text(d, str, sizeof(str));
+        size_t len = text ? strlen(text) + 1 : 0;
+        if (!text || key_len + len + 1 > sizeof(key)) {
+            // not cached
+            influx_put_prefix(influx, buf, data, data_model);
+            return;
         }
-        if (*str == '"' || *str == '\\') {
-            *buf++ = '\\';
-            size--;
-        }
-        *buf++ = *str;
-        size--;
+        key[key_len++] = (char)data_key_of(d);
+        memcpy(&key[key_len], text, len);
+        key_len += len;
+    }
+
+    uint32_t hash           = influx_prefix_hash(key, key_len);
+    influx_prefix_t **slot  = &influx->prefixes[hash & (INFLUX_PREFIX_SLOTS - 1)];
+    influx_prefix_t *prefix = *slot;
+    if (prefix && prefix->hash == hash && prefix->key_len == key_len && !memcmp(prefix->text, key, key_len)) {
+        mbuf_append(buf, &prefix->text[key_len], prefix->prefix_len);
+        return;
+    }
+
+    // a miss builds the prefix in place and keeps it in the slot
+    size_t start = buf->len;
+    influx_put_prefix(influx, buf, data, data_model);
+    size_t prefix_len = buf->len - start;
+    mem_put(MEM_TAG_INFLUX, prefix);
+    *slot = prefix = mem_get(MEM_TAG_INFLUX, sizeof(*prefix) + key_len + prefix_len);
+    if (!prefix) {
+        WARN_MALLOC("influx_put_cached_prefix()");
+        return;
+    }
+    prefix->hash       = hash;
+    prefix->key_len    = (unsigned)key_len;
+    prefix->prefix_len = (unsigned)prefix_len;
+    memcpy(prefix->text, key, key_len);
+    memcpy(&prefix->text[key_len], &buf->buf[start], prefix_len);
+}
+
+/// append the field value, strings quoted and escaped
+static void influx_put_field(struct mbuf *buf, data_t const *d)
+{
+    char str[1000];
+    if (d->type == DATA_STRING) {
+        influx_put_string(buf, d->value.v_ptr);
+        return;
     }
-    if (size >= 2) {
-        *buf++ = '"';
-        size--;
+    char const *text = influx_value_text(d, str, sizeof(str));
+    if (d->type == DATA_INT || d->type == DATA_DOUBLE)
+        mbuf_append(buf, text, strlen(text));
+    else
+        influx_put_string(buf, text);
+}
+
+/// append the timestamp in ns, InfluxDB doesn't understand the relative and date time formats
+static void influx_put_time(struct mbuf *buf, data_t const *data_time)
+{
+    if (data_time->type != DATA_STRING)
+        return;
+    char const *str = data_time->value.v_ptr;
+    size_t len      = strlen(str);
+    if (str[0] == '@' // relative time format configured
+            || (len > 10 && (str[10] == ' ' // date time format configured
+                                    || str[10] == 'T'))) { // ISO date time format configured
+        return;
+    }
+    if (mbuf_reserve(buf, len + 11) < len + 11)
+        return;
+    char *p   = &buf->buf[buf->len];
+    *p++      = ' ';
+    int usec = 0;
+    for (; *str; ++str) {
+        if (*str == '.')
+            usec = 1; // unix usec timestamp format configured
+        else
+            *p++ = *str;
     }
-    *buf = '\0';
+    // to ns, the unix timestamp has seconds or usec resolution
+    char const *zeros = usec ? "000" : "000000000";
+    size_t zeros_len  = usec ? 3 : 9;
+    memcpy(p, zeros, zeros_len);
+    buf->len = p + zeros_len - buf->buf;
+}
 
-    databuf->len = databuf->size - size;
+static void R_API_CALLCONV print_influx_array(data_output_t *output, data_array_t *array, char const *format)
+{
+    UNUSED(array);
+    UNUSED(format);
+    influx_client_t *influx = (influx_client_t *)output;
+    mbuf_append(&influx->lines, "\"array\"", 7); // TODO
 }
 
 static void R_API_CALLCONV print_influx_string(data_output_t *output, char const *str, char const *format)
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
-    mbuf_snprintf(buf, "%s", str);
+    mbuf_append(&influx->lines, str, strlen(str));
+}
+
+// count the line just appended, drop the oldest lines over the limits, and send
+static void influx_client_queued(influx_client_t *ctx)
+{
+    struct mbuf *buf = &ctx->lines;
+
+    if (!ctx->lines_count)
+        ctx->lines_since = mg_time();
+    ctx->lines_count += 1;
+
+    // drop the oldest lines if the server can't keep up
+    while (ctx->lines.len > ctx->buffer_size && ctx->lines_count > 1) {
+        char const *eol = memchr(buf->buf, '\n', buf->len);
+        mbuf_remove(buf, eol + 1 - buf->buf);
+        ctx->lines_count -= 1;
+        ctx->stats.dropped += 1;
+        if (!ctx->dropping)
+            print_logf(LOG_WARNING, ctx->name, "%s too slow, dropping the oldest lines (buffer is %u bytes)", ctx->name, ctx->buffer_size);
+        ctx->dropping = 1;
+    }
+
+    // shed the older half of the waiting lines if the InfluxDB and webhook outputs are over their memory limit
+    if (mem_acct_over(MEM_TAG_INFLUX) && ctx->lines_count > 1) {
+        unsigned drop = ctx->lines_count / 2;
+        size_t size   = 0;
+        for (unsigned i = 0; i < drop; ++i) {
+            char const *eol = memchr(buf->buf + size, '\n', buf->len - size);
+            size = eol + 1 - buf->buf;
+        }
+        mbuf_remove(buf, size);
+        mbuf_trim(buf);
+        ctx->lines_count -= drop;
+        ctx->stats.dropped += drop;
+        mem_acct_shed(MEM_TAG_INFLUX);
+    }
+
+    influx_client_send(ctx);
 }
 
-// Generate InfluxDB line protocol
+// Generate InfluxDB line protocol, in one pass with the measurement and tags from the cache
 static void R_API_CALLCONV print_influx_data(data_output_t *output, data_t *data, char const *format)
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    char *str;
-    char *end;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
+    struct mbuf *buf = &influx->lines;
     bool comma = false;
 
-    data_t *data_org = data;
     data_t *data_model = NULL;
     data_t *data_time = NULL;
     for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "model"))
+        if (data_key_is(d, DATA_KEY_MODEL))
             data_model = d;
-        if (!strcmp(d->key, "time"))
+        if (data_key_is(d, DATA_KEY_TIME))
             data_time = d;
     }
 
-    if (!data_model) {
-        // data isn't from device (maybe report for example)
-        // use hostname for measurement
-
-        mbuf_reserve(buf, 20000);
-        mbuf_snprintf(buf, "rtl_433_%s", influx->hostname);
-    }
-    else {
-        // use model for measurement
-
-        mbuf_reserve(buf, 1000);
-        str = &buf->buf[buf->len];
-        print_value(output, data_model->type, data_model->value, data_model->format);
-        influx_sanitize_tag(str, NULL);
-    }
-
-    // write tags
-    while (data) {
-        if (!strcmp(data->key, "model")
-                || !strcmp(data->key, "time")) {
-            // skip
-        }
-        else if (!strcmp(data->key, "type")
-                || !strcmp(data->key, "subtype")
-                || !strcmp(data->key, "id")
-                || !strcmp(data->key, "channel")
-                || !strcmp(data->key, "mic")) {
-            str = mbuf_snprintf(buf, ",%s=", data->key);
-            str++;
-            end = &buf->buf[buf->len - 1];
-            influx_sanitize_tag(str, end);
-            str = end + 1;
-            print_value(output, data->type, data->value, data->format);
-            influx_sanitize_tag(str, NULL);
-        }
-        data = data->next;
-    }
-
-    mbuf_snprintf(buf, " ");
-
-    // activate escaped output functions
-    influx->output.print_data   = print_influx_data_escaped;
-    influx->output.print_string = print_influx_string_escaped;
+    influx_put_cached_prefix(influx, buf, data, data_model);
+    mbuf_append(buf, " ", 1);
 
     // write fields
-    data = data_org;
-    while (data) {
-        if (!strcmp(data->key, "model")
-                || !strcmp(data->key, "time")) {
-            // skip
-        }
-        else if (!strcmp(data->key, "type")
-                || !strcmp(data->key, "subtype")
-                || !strcmp(data->key, "id")
-                || !strcmp(data->key, "channel")
-                || !strcmp(data->key, "mic")) {
-            // skip
-        }
-        else {
-            str = mbuf_snprintf(buf, comma ? ",%s=" : "%s=", data->key);
-            if (comma)
-                str++;
-            end = &buf->buf[buf->len - 1];
-            influx_sanitize_tag(str, end);
-            print_value(output, data->type, data->value, data->format);
-            comma = true;
+    for (data_t *d = data; d; d = d->next) {
+        if (data_key_is(d, DATA_KEY_MODEL)
+                || data_key_is(d, DATA_KEY_TIME)
+                || influx_is_tag(d)) {
+            continue;
         }
-        data = data->next;
+        if (comma)
+            mbuf_append(buf, ",", 1);
+        influx_put_tag(buf, d->key, strlen(d->key));
+        mbuf_append(buf, "=", 1);
+        influx_put_field(buf, d);
+        comma = true;
     }
 
-    // restore original output functions
-    influx->output.print_data   = print_influx_data;
-    influx->output.print_string = print_influx_string;
-
     // write time if available
     if (data_time) {
-        str = mbuf_snprintf(buf, " ");
-        print_value(output, data_time->type, data_time->value, data_time->format);
-        if (str[1] == '@' // relative time format configured
-                || str[11] == ' ' // date time format configured
-                || str[11] == 'T') {  // ISO date time format configured
-            // -> bad, because InfluxDB doesn't under stand those formats -> remove timestamp
-            buf->len = str - buf->buf;
-        }
-        else if ((str = strchr(str, '.'))) {
-            // unix usec timestamp format configured
-            mbuf_remove_part(buf, str, 1);
-            mbuf_snprintf(buf, "000");
-        }
-        else {
-            // unix timestamp with seconds resolution configured
-            mbuf_snprintf(buf, "000000000");
-        }
+        influx_put_time(buf, data_time);
+    }
+    mbuf_append(buf, "\n", 1);
+
+    influx_client_queued(influx);
+}
+
+// Append the JSON text of the event as a line, the batch makes the lines a JSON array or keeps them as NDJSON
+static void R_API_CALLCONV print_webhook(data_output_t *output, data_t *data)
+{
+    influx_client_t *hook = (influx_client_t *)output;
+
+    size_t len;
+    char const *json = data_output_jsons(output, data, &len);
+    if (!json) {
+        return; // NOTE: skip output on alloc failure.
     }
-    mbuf_snprintf(buf, "\n");
+    mbuf_append(&hook->lines, json, len);
+    mbuf_append(&hook->lines, "\n", 1);
 
-    influx_client_send(influx);
+    influx_client_queued(hook);
 }
 
 static void R_API_CALLCONV print_influx_double(data_output_t *output, double data, char const *format)
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
-    mbuf_snprintf(buf, "%f", data);
+    char str[32];
+    abuf_t num;
+    abuf_init(&num, str, sizeof(str));
+    abuf_print_fixed(&num, data, 6);
+    mbuf_append(&influx->lines, str, strlen(str));
 }
 
 static void R_API_CALLCONV print_influx_int(data_output_t *output, int data, char const *format)
 {
     UNUSED(format);
     influx_client_t *influx = (influx_client_t *)output;
-    struct mbuf *buf = &influx->databufs[influx->databufidxfill];
-    mbuf_snprintf(buf, "%d", data);
+    char str[16];
+    abuf_t num;
+    abuf_init(&num, str, sizeof(str));
+    abuf_print_int(&num, "%d", data);
+    mbuf_append(&influx->lines, str, strlen(str));
 }
 
 static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
@@ -466,7 +888,17 @@ static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
         influx->conn->user_data = NULL;
         influx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (influx->timer) {
+        influx->timer->user_data = NULL;
+        influx->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
 
+    tls_session_put(influx->tls_session);
+    for (unsigned i = 0; i < INFLUX_PREFIX_SLOTS; ++i)
+        mem_put(MEM_TAG_INFLUX, influx->prefixes[i]);
+    mbuf_free(&influx->lines);
+    mbuf_free(&influx->batch);
+    mbuf_free(&influx->array);
     free(influx);
 }
 
@@ -486,6 +918,9 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
     influx_sanitize_tag(influx->hostname, NULL);
 
     char *token = NULL;
+    influx->max_lines   = INFLUX_BATCH_LINES;
+    influx->max_size    = INFLUX_BATCH_SIZE;
+    influx->buffer_size = INFLUX_BUFFER_SIZE;
 
     // param/opts starts with URL
     if (!opts) {
@@ -527,6 +962,16 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
             continue;
         else if (!strcasecmp(key, "t") || !strcasecmp(key, "token"))
             token = val;
+        else if (!strcasecmp(key, "batch"))
+            influx->max_lines = atouint32_metric(val, "batch= ");
+        else if (!strcasecmp(key, "batch_size"))
+            influx->max_size = atouint32_metric(val, "batch_size= ");
+        else if (!strcasecmp(key, "buffer"))
+            influx->buffer_size = atouint32_metric(val, "buffer= ");
+        else if (!strcasecmp(key, "flush"))
+            influx->flush_ms = atoi_ms(val, "flush= ");
+        else if (!strcasecmp(key, "gzip"))
+            influx->gzip = atobv(val, 1);
         else if (!tls_param(&influx->tls_opts, key, val)) {
             // ok
         }
@@ -536,6 +981,15 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
         }
     }
 
+#ifndef ZLIB
+    if (influx->gzip) {
+        print_log(LOG_FATAL, __func__, "influx gzip not available");
+        exit(1);
+    }
+#endif
+    if (!influx->max_lines)
+        influx->max_lines = 1;
+
     influx->output.print_data   = print_influx_data;
     influx->output.print_array  = print_influx_array;
     influx->output.print_string = print_influx_string;
@@ -545,13 +999,155 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
 
     print_logf(LOG_CRITICAL, "InfluxDB", "Publishing data to InfluxDB (%s)", url);
 
-    influx->mgr = mgr;
+    influx->name      = "InfluxDB";
+    influx->mgr       = mgr;
+    influx->lines.tag = MEM_TAG_INFLUX;
+    influx->batch.tag = MEM_TAG_INFLUX;
 
     // add dummy socket to receive timer events
     struct mg_add_sock_opts timer_opts = {.user_data = influx};
     influx->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, influx_client_timer, timer_opts);
 
     influx_client_init(influx, url, token);
+    if (influx->tls_opts.tls_ca_cert) {
+        influx->tls_session = tls_session_get(influx->address, &influx->tls_opts);
+    }
 
     return (struct data_output *)influx;
 }
+
+struct data_output *data_output_webhook_create(struct mg_mgr *mgr, char *opts)
+{
+    influx_client_t *hook = calloc(1, sizeof(influx_client_t));
+    if (!hook) {
+        FATAL_CALLOC("data_output_webhook_create()");
+    }
+
+    char *token       = NULL;
+    hook->max_lines   = WEBHOOK_BATCH_EVENTS;
+    hook->max_size    = WEBHOOK_BATCH_SIZE;
+    hook->buffer_size = INFLUX_BUFFER_SIZE;
+    hook->json_array  = 1;
+
+    // param/opts starts with URL
+    if (!opts) {
+        opts = "";
+    }
+    char *url = opts;
+    opts = strchr(opts, ',');
+    if (opts) {
+        *opts = '\0';
+        opts++;
+    }
+    // "http_post://..." and "https_post://..." are plain URLs without the suffix
+    char *suffix = strstr(url, "_post");
+    if (suffix && (suffix == url + 4 || suffix == url + 5)) {
+        memmove(suffix, suffix + 5, strlen(suffix + 5) + 1);
+    }
+    if (strncmp(url, "https", 5) == 0) {
+        hook->tls_opts.tls_ca_cert = "*"; // TLS is enabled but no cert verification is performed.
+    }
+
+    // check if valid URL has been provided
+    struct mg_str scheme, host, path;
+    if (mg_parse_uri(mg_mk_str(url), &scheme, NULL, &host, NULL, &path, NULL, NULL) != 0
+            || (mg_vcmp(&scheme, "http") && mg_vcmp(&scheme, "https"))
+            || !host.len || !path.len) {
+        print_logf(LOG_FATAL, __func__, "Invalid webhook URL specified.%s%s"
+                        " Something like \"http_post://<host>/<path>\" required at least.",
+                !host.len ? " No host specified." : "",
+                !path.len ? " No path component specified." : "");
+        exit(1);
+    }
+
+    abuf_t headers;
+    char header_opts[400] = {0};
+    abuf_init(&headers, header_opts, sizeof(header_opts));
+
+    // parse auth and format options
+    char *key, *val;
+    while (getkwargs(&opts, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "t") || !strcasecmp(key, "token"))
+            token = val;
+        else if (!strcasecmp(key, "header") && val && strchr(val, ':'))
+            abuf_printf(&headers, "%s\r\n", val);
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "array"))
+            hook->json_array = 1;
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "ndjson"))
+            hook->json_array = 0;
+        else if (!strcasecmp(key, "batch"))
+            hook->max_lines = atouint32_metric(val, "batch= ");
+        else if (!strcasecmp(key, "batch_size"))
+            hook->max_size = atouint32_metric(val, "batch_size= ");
+        else if (!strcasecmp(key, "buffer"))
+            hook->buffer_size = atouint32_metric(val, "buffer= ");
+        else if (!strcasecmp(key, "flush"))
+            hook->flush_ms = atoi_ms(val, "flush= ");
+        else if (!strcasecmp(key, "gzip"))
+            hook->gzip = atobv(val, 1);
+        else if (!tls_param(&hook->tls_opts, key, val)) {
+            // ok
+        }
+        else {
+            print_logf(LOG_FATAL, __func__, "Invalid key \"%s\" option.", key);
+            exit(1);
+        }
+    }
+
+#ifndef ZLIB
+    if (hook->gzip) {
+        print_log(LOG_FATAL, __func__, "webhook gzip not available");
+        exit(1);
+    }
+#endif
+    if (!hook->max_lines)
+        hook->max_lines = 1;
+
+    hook->output.output_print = print_webhook;
+    hook->output.output_free  = data_output_influx_free;
+
+    print_logf(LOG_CRITICAL, "Webhook", "Posting data to a webhook (%s) as %s", url, hook->json_array ? "JSON arrays" : "NDJSON");
+
+    hook->name      = "Webhook";
+    hook->mgr       = mgr;
+    hook->lines.tag = MEM_TAG_INFLUX;
+    hook->batch.tag = MEM_TAG_INFLUX;
+    hook->array.tag = MEM_TAG_INFLUX;
+
+    // add dummy socket to receive timer events
+    struct mg_add_sock_opts timer_opts = {.user_data = hook};
+    hook->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, influx_client_timer, timer_opts);
+
+    influx_client_init(hook, url, NULL);
+    // after the basic auth of the URL
+    size_t auth_len = strlen(hook->extra_headers);
+    abuf_t extra;
+    abuf_init(&extra, hook->extra_headers + auth_len, sizeof(hook->extra_headers) - auth_len);
+    abuf_printf(&extra, "Content-Type: %s\r\n", hook->json_array ? "application/json" : "application/x-ndjson");
+    if (token)
+        abuf_printf(&extra, "Authorization: Bearer %s\r\n", token);
+    abuf_printf(&extra, "%s", header_opts);
+    if (hook->tls_opts.tls_ca_cert) {
+        hook->tls_session = tls_session_get(hook->address, &hook->tls_opts);
+    }
+
+    return (struct data_output *)hook;
+}
+
+int data_output_influx_stats(struct data_output *output, influx_stats_t *stats, int reset)
+{
+    if (!output || output->output_free != data_output_influx_free)
+        return 0;
+
+    influx_client_t *influx = (influx_client_t *)output;
+    *stats        = influx->stats;
+    stats->queued = influx->lines_count + (influx->batch.len ? influx->batch_lines : 0);
+    if (reset) {
+        memset(&influx->stats, 0, sizeof(influx->stats));
+    }
+    return 1;
+}
@@ -12,6 +12,7 @@
 #include "output_log.h"
 
 #include "data.h"
+#include "abuf.h"
 #include "r_util.h"
 #include "fatal.h"
 
@@ -25,19 +26,20 @@
 typedef struct {
     struct data_output output;
     FILE *file;
+    gbuf_t line; ///< the message being rendered, written in one go
 } data_output_log_t;
 
 static void R_API_CALLCONV print_log_array(data_output_t *output, data_array_t *array, char const *format)
 {
     data_output_log_t *log = (data_output_log_t *)output;
 
-    fprintf(log->file, "[");
+    gbuf_put(&log->line, "[", 1);
     for (int c = 0; c < array->num_values; ++c) {
         if (c)
-            fprintf(log->file, ", ");
+            gbuf_put(&log->line, ", ", 2);
         print_array_value(output, array, format, c);
     }
-    fprintf(log->file, "]");
+    gbuf_put(&log->line, "]", 1);
 }
 
 static void R_API_CALLCONV print_log_data(data_output_t *output, data_t *data, char const *format)
@@ -45,16 +47,16 @@ static void R_API_CALLCONV print_log_data(data_output_t *output, data_t *data, c
     UNUSED(format);
     data_output_log_t *log = (data_output_log_t *)output;
 
-    fputc('{', log->file);
+    gbuf_put(&log->line, "{", 1);
     for (bool separator = false; data; data = data->next) {
         if (separator)
-            fprintf(log->file, ", ");
+            gbuf_put(&log->line, ", ", 2);
         output->print_string(output, data->key, NULL);
-        fprintf(log->file, ": ");
+        gbuf_put(&log->line, ": ", 2);
         print_value(output, data->type, data->value, data->format);
         separator = true;
     }
-    fputc('}', log->file);
+    gbuf_put(&log->line, "}", 1);
 }
 
 static void R_API_CALLCONV print_log_string(data_output_t *output, const char *str, char const *format)
@@ -62,7 +64,7 @@ static void R_API_CALLCONV print_log_string(data_output_t *output, const char *s
     UNUSED(format);
     data_output_log_t *log = (data_output_log_t *)output;
 
-    fprintf(log->file, "%s", str);
+    gbuf_cat(&log->line, str);
 }
 
 static void R_API_CALLCONV print_log_double(data_output_t *output, double data, char const *format)
@@ -70,7 +72,7 @@ static void R_API_CALLCONV print_log_double(data_output_t *output, double data,
     UNUSED(format);
     data_output_log_t *log = (data_output_log_t *)output;
 
-    fprintf(log->file, "%.3f", data);
+    gbuf_print_double(&log->line, "%.3f", data);
 }
 
 static void R_API_CALLCONV print_log_int(data_output_t *output, int data, char const *format)
@@ -78,7 +80,7 @@ static void R_API_CALLCONV print_log_int(data_output_t *output, int data, char c
     UNUSED(format);
     data_output_log_t *log = (data_output_log_t *)output;
 
-    fprintf(log->file, "%d", data);
+    gbuf_print_int(&log->line, "%d", data);
 }
 
 static void R_API_CALLCONV data_output_log_print(data_output_t *output, data_t *data)
@@ -90,11 +92,11 @@ static void R_API_CALLCONV data_output_log_print(data_output_t *output, data_t *
     data_t *data_lvl = NULL;
     data_t *data_msg = NULL;
     for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "src"))
+        if (data_key_is(d, DATA_KEY_SRC))
             data_src = d;
-        else if (!strcmp(d->key, "lvl"))
+        else if (data_key_is(d, DATA_KEY_LVL))
             data_lvl = d;
-        else if (!strcmp(d->key, "msg"))
+        else if (data_key_is(d, DATA_KEY_MSG))
             data_msg = d;
     }
 
@@ -103,42 +105,48 @@ static void R_API_CALLCONV data_output_log_print(data_output_t *output, data_t *
         return; // print log messages only
     }
 
+    gbuf_clear(&log->line);
     // int level = 0;
     // if (data_lvl->type == DATA_INT) {
     //     level = data_lvl->value.v_int;
     // }
     print_value(output, data_src->type, data_src->value, data_src->format);
-    // fprintf(log->file, "(");
+    // gbuf_put(&log->line, "(", 1);
     // print_value(output, data_lvl->type, data_lvl->value, data_lvl->format);
-    // fprintf(log->file, ") ");
-    fprintf(log->file, ": ");
+    // gbuf_put(&log->line, ") ", 2);
+    gbuf_put(&log->line, ": ", 2);
     print_value(output, data_msg->type, data_msg->value, data_msg->format);
 
     for (; data; data = data->next) {
         // skip logging keys
-        if (!strcmp(data->key, "time")
-                || !strcmp(data->key, "src")
-                || !strcmp(data->key, "lvl")
-                || !strcmp(data->key, "msg")
-                || !strcmp(data->key, "num_rows")) {
+        if (data_key_is(data, DATA_KEY_TIME)
+                || data_key_is(data, DATA_KEY_SRC)
+                || data_key_is(data, DATA_KEY_LVL)
+                || data_key_is(data, DATA_KEY_MSG)
+                || data_key_is(data, DATA_KEY_NUM_ROWS)) {
             continue;
         }
 
-        fprintf(log->file, " ");
+        gbuf_put(&log->line, " ", 1);
         output->print_string(output, data->key, NULL);
-        fprintf(log->file, " ");
+        gbuf_put(&log->line, " ", 1);
         print_value(output, data->type, data->value, data->format);
     }
 
-    fputc('\n', log->file);
+    gbuf_put(&log->line, "\n", 1); // on alloc failure the message is truncated
+    if (log->line.len)
+        fwrite(log->line.data, 1, log->line.len, log->file);
     fflush(log->file);
 }
 
 static void R_API_CALLCONV data_output_log_free(data_output_t *output)
 {
+    data_output_log_t *log = (data_output_log_t *)output;
+
     if (!output) {
         return;
     }
+    gbuf_free(&log->line);
     free(output);
 }
 
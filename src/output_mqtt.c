@@ -1,5 +1,5 @@
 /** @file
-    MQTT output for rtl_433 events
+    MQTT and MQTT-SN output for rtl_433 events
 
     Copyright (C) 2019 Christian Zuckschwerdt
 
@@ -13,9 +13,11 @@
 #include "output_mqtt.h"
 #include "optparse.h"
 #include "bit_util.h"
+#include "abuf.h"
 #include "logger.h"
 #include "fatal.h"
 #include "r_util.h"
+#include "mem_acct.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -25,6 +27,14 @@
 
 /* MQTT client abstraction */
 
+/// Most messages held back while the QoS 1 in-flight window is full.
+#define MQTT_BACKLOG_SIZE 1024
+
+typedef struct mqtt_message {
+    char *topic;
+    char *payload;
+} mqtt_message_t;
+
 typedef struct mqtt_client {
     struct mg_connect_opts connect_opts;
     struct mg_send_mqtt_handshake_opts mqtt_opts;
@@ -36,8 +46,18 @@ typedef struct mqtt_client {
     char client_id[256];
     uint16_t message_id;
     int publish_flags; // MG_MQTT_RETAIN | MG_MQTT_QOS(0)
+    int window;        ///< most unacknowledged QoS 1 messages, 0 if unlimited
+    int inflight;      ///< sent QoS 1 messages not yet acknowledged
+    mqtt_message_t backlog[MQTT_BACKLOG_SIZE]; ///< ring of messages waiting for the window
+    unsigned backlog_head;
+    unsigned backlog_len;
+    unsigned dropped;  ///< backlog messages dropped since the last warning
+    tls_session_t *tls_session; ///< the session to resume on a reconnect, NULL without TLS
+    tls_stats_t tls_stats;
 } mqtt_client_t;
 
+static void mqtt_client_drain(mqtt_client_t *ctx);
+
 char const *mqtt_availability_online  = "online";
 char const *mqtt_availability_offline = "offline";
 
@@ -59,12 +79,16 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
             print_log(LOG_NOTICE, "MQTT", "MQTT Connected...");
             mg_set_protocol_mqtt(nc);
             if (ctx) {
+                tls_session_connected(ctx->tls_session, nc, 0, &ctx->tls_stats);
                 ctx->reconnect_delay = 0;
                 mg_send_mqtt_handshake_opt(nc, ctx->client_id, ctx->mqtt_opts);
             }
         }
         else {
             // Error, print only once
+            if (ctx) {
+                tls_session_connected(ctx->tls_session, nc, connect_status, &ctx->tls_stats);
+            }
             if (ctx && ctx->prev_status != connect_status) {
                 print_logf(LOG_WARNING, "MQTT", "MQTT connect error: %s", strerror(connect_status));
             }
@@ -80,14 +104,21 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
         }
         else {
             print_log(LOG_NOTICE, "MQTT", "MQTT Connection established.");
+            // TLS 1.3 brokers send the session tickets after the handshake
+            tls_session_save(ctx->tls_session, nc);
             if (ctx->mqtt_opts.will_topic) {
                 ctx->message_id++;
                 mg_mqtt_publish(ctx->conn, ctx->mqtt_opts.will_topic, ctx->message_id, MG_MQTT_QOS(0) | MG_MQTT_RETAIN, mqtt_availability_online, strlen(mqtt_availability_online));
             }
+            mqtt_client_drain(ctx);
         }
         break;
     case MG_EV_MQTT_PUBACK:
         print_logf(LOG_NOTICE, "MQTT", "MQTT Message publishing acknowledged (msg_id: %u)", msg->message_id);
+        if (ctx && ctx->inflight > 0) {
+            ctx->inflight--;
+            mqtt_client_drain(ctx);
+        }
         break;
     case MG_EV_MQTT_SUBACK:
         print_log(LOG_NOTICE, "MQTT", "MQTT Subscription acknowledged.");
@@ -101,7 +132,9 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
         if (!ctx) {
             break; // shutting down
         }
+        tls_session_save(ctx->tls_session, nc);
         ctx->conn = NULL;
+        ctx->inflight = 0; // unacknowledged messages are not resent
         if (!ctx->timer) {
             break; // shutting down
         }
@@ -134,6 +167,8 @@ static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
         ctx->connect_opts.error_string = &error_string;
         ctx->conn = mg_connect_opt(nc->mgr, ctx->address, mqtt_client_event, ctx->connect_opts);
         ctx->connect_opts.error_string = NULL;
+        // a reconnect resumes the session, skipping the certificate exchange and key agreement
+        tls_session_resume(ctx->tls_session, ctx->conn);
         if (!ctx->conn) {
             print_logf(LOG_WARNING, "MQTT", "MQTT connect (%s) failed%s%s", ctx->address,
                     error_string ? ": " : "", error_string ? error_string : "");
@@ -143,7 +178,7 @@ static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
-static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, char const *availability)
+static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, int window, char const *availability)
 {
     mqtt_client_t *ctx = calloc(1, sizeof(*ctx));
     if (!ctx)
@@ -155,6 +190,7 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     ctx->mqtt_opts.will_message = mqtt_availability_offline;
     ctx->mqtt_opts.flags |= (availability ? MG_MQTT_WILL_RETAIN : 0);
     ctx->publish_flags  = MG_MQTT_QOS(qos) | (retain ? MG_MQTT_RETAIN : 0);
+    ctx->window         = qos > 0 ? window : 0;
     // TODO: these should be user configurable options
     //ctx->mqtt_opts.keepalive = 60;
     //ctx->timeout = 10000L;
@@ -192,6 +228,7 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
         ctx->connect_opts.ssl_server_name   = tls_opts->tls_server_name;
         ctx->connect_opts.ssl_psk_identity  = tls_opts->tls_psk_identity;
         ctx->connect_opts.ssl_psk_key       = tls_opts->tls_psk_key;
+        ctx->tls_session = tls_session_get(ctx->address, tls_opts);
 #else
         print_log(LOG_FATAL, __func__, "mqtts (TLS) not available");
         exit(1);
@@ -215,13 +252,72 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     return ctx;
 }
 
+static void mqtt_client_send(mqtt_client_t *ctx, char const *topic, char const *str)
+{
+    ctx->message_id++;
+    if (!ctx->message_id)
+        ctx->message_id++; // a message id of 0 is not allowed with QoS 1
+    // the packets are appended to the send buffer, all packets of an event go out in one write
+    mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+    if (MG_MQTT_GET_QOS(ctx->publish_flags) > 0)
+        ctx->inflight++;
+}
+
+// send held back messages while the in-flight window has room
+static void mqtt_client_drain(mqtt_client_t *ctx)
+{
+    if (ctx->dropped) {
+        print_logf(LOG_WARNING, "MQTT", "MQTT broker too slow, dropped %u messages.", ctx->dropped);
+        ctx->dropped = 0;
+    }
+    while (ctx->backlog_len && ctx->conn && ctx->conn->proto_handler && ctx->inflight < ctx->window) {
+        mqtt_message_t *m = &ctx->backlog[ctx->backlog_head];
+        mqtt_client_send(ctx, m->topic, m->payload);
+        mem_put(MEM_TAG_MQTT, m->topic);
+        mem_put(MEM_TAG_MQTT, m->payload);
+        ctx->backlog_head = (ctx->backlog_head + 1) % MQTT_BACKLOG_SIZE;
+        ctx->backlog_len--;
+    }
+}
+
 static void mqtt_client_publish(mqtt_client_t *ctx, char const *topic, char const *str)
 {
     if (!ctx->conn || !ctx->conn->proto_handler)
         return;
 
-    ctx->message_id++;
-    mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+    if (!ctx->window || (ctx->inflight < ctx->window && !ctx->backlog_len)) {
+        mqtt_client_send(ctx, topic, str);
+        return;
+    }
+
+    // the window is full, hold the message back until the broker acknowledges,
+    // the oldest are dropped if the backlog is full or, by half, over the memory limit
+    unsigned drop = ctx->backlog_len == MQTT_BACKLOG_SIZE ? 1 : 0;
+    if (mem_acct_over(MEM_TAG_MQTT) && ctx->backlog_len / 2 > drop) {
+        drop = ctx->backlog_len / 2;
+        mem_acct_shed(MEM_TAG_MQTT);
+    }
+    for (; drop > 0; --drop) {
+        mqtt_message_t *m = &ctx->backlog[ctx->backlog_head];
+        mem_put(MEM_TAG_MQTT, m->topic);
+        mem_put(MEM_TAG_MQTT, m->payload);
+        ctx->backlog_head = (ctx->backlog_head + 1) % MQTT_BACKLOG_SIZE;
+        ctx->backlog_len--;
+        ctx->dropped++;
+    }
+    mqtt_message_t *m = &ctx->backlog[(ctx->backlog_head + ctx->backlog_len) % MQTT_BACKLOG_SIZE];
+    m->topic = mem_dup(MEM_TAG_MQTT, topic);
+    if (!m->topic) {
+        WARN_STRDUP("mqtt_client_publish()");
+        return; // NOTE: skip message on alloc failure.
+    }
+    m->payload = mem_dup(MEM_TAG_MQTT, str);
+    if (!m->payload) {
+        WARN_STRDUP("mqtt_client_publish()");
+        mem_put(MEM_TAG_MQTT, m->topic);
+        return; // NOTE: skip message on alloc failure.
+    }
+    ctx->backlog_len++;
 }
 
 static void mqtt_client_free(mqtt_client_t *ctx)
@@ -230,6 +326,437 @@ static void mqtt_client_free(mqtt_client_t *ctx)
         ctx->conn->user_data = NULL;
         ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    for (unsigned i = 0; ctx && i < ctx->backlog_len; ++i) {
+        mqtt_message_t *m = &ctx->backlog[(ctx->backlog_head + i) % MQTT_BACKLOG_SIZE];
+        mem_put(MEM_TAG_MQTT, m->topic);
+        mem_put(MEM_TAG_MQTT, m->payload);
+    }
+    if (ctx) {
+        tls_session_put(ctx->tls_session);
+    }
+    free(ctx);
+}
+
+/* MQTT-SN client abstraction, MQTT for Sensor Networks v1.2 over UDP */
+
+/// Most topics registered with the gateway, a power of two.
+#define MQTTSN_TOPIC_SLOTS 4096
+/// Largest message sent, a datagram that fits an Ethernet MTU.
+#define MQTTSN_MESSAGE_MAX 1472
+
+enum mqttsn_msg_type {
+    MQTTSN_CONNECT      = 0x04,
+    MQTTSN_CONNACK      = 0x05,
+    MQTTSN_WILLTOPICREQ = 0x06,
+    MQTTSN_WILLTOPIC    = 0x07,
+    MQTTSN_WILLMSGREQ   = 0x08,
+    MQTTSN_WILLMSG      = 0x09,
+    MQTTSN_REGISTER     = 0x0a,
+    MQTTSN_REGACK       = 0x0b,
+    MQTTSN_PUBLISH      = 0x0c,
+    MQTTSN_PUBACK       = 0x0d,
+    MQTTSN_PINGREQ      = 0x16,
+    MQTTSN_PINGRESP     = 0x17,
+    MQTTSN_DISCONNECT   = 0x18,
+};
+
+#define MQTTSN_FLAG_RETAIN 0x10
+#define MQTTSN_FLAG_WILL   0x08
+#define MQTTSN_FLAG_CLEAN  0x04
+
+/// Return code of a rejected topic id, the gateway lost the registration.
+#define MQTTSN_RC_INVALID_TOPIC 0x02
+
+typedef struct mqttsn_topic {
+    char *name;
+    uint16_t id;     ///< topic id assigned by the gateway, 0 while not registered
+    uint16_t msg_id; ///< message id of the pending REGISTER, 0 if none was sent
+    int rejected;    ///< the gateway refused the topic, its messages are dropped
+    int retain;      ///< the messages are retained, always for the availability
+} mqttsn_topic_t;
+
+typedef struct mqttsn_client {
+    sock_t sock;
+    char address[253 + 6 + 1]; // dns max + port
+    char client_id[24];
+    char const *availability; ///< the will topic, NULL if none
+    int retain;
+    unsigned keepalive; ///< seconds, the gateway drops the client after 1.5 times that without a message
+    int connected;      ///< the gateway accepted the CONNECT
+    double connect_at;  ///< time of the last CONNECT
+    double ping_at;     ///< time of the last PINGREQ
+    double recv_at;     ///< time of the last message received
+    int reconnect_delay;
+    uint16_t message_id;
+    mqttsn_topic_t *topics; ///< topic ids of the topic names, cleared on each connect
+    unsigned topics_len;
+    mqtt_message_t backlog[MQTT_BACKLOG_SIZE]; ///< messages waiting for their topic id or the connection
+    unsigned backlog_len;
+    unsigned dropped; ///< backlog messages dropped since the last warning
+} mqttsn_client_t;
+
+// send one message as a datagram, the length header is one byte or three bytes
+static void mqttsn_client_send(mqttsn_client_t *ctx, uint8_t type, uint8_t const *head, size_t head_len, char const *body, size_t body_len)
+{
+    uint8_t msg[MQTTSN_MESSAGE_MAX];
+    size_t len = 2 + head_len + body_len;
+    size_t pos = 0;
+    if (len > 255) {
+        len += 2;
+        if (len > sizeof(msg)) {
+            print_logf_limited(LOG_WARNING, "MQTT-SN", "Message of %zu bytes dropped, at most %d bytes fit a datagram", len, MQTTSN_MESSAGE_MAX);
+            return;
+        }
+        msg[pos++] = 0x01;
+        msg[pos++] = (uint8_t)(len >> 8);
+    }
+    msg[pos++] = (uint8_t)len;
+    msg[pos++] = type;
+    if (head_len)
+        memcpy(&msg[pos], head, head_len);
+    if (body_len)
+        memcpy(&msg[pos + head_len], body, body_len);
+
+    if (send(ctx->sock, (char const *)msg, (int)len, 0) < 0) {
+        print_logf_limited(LOG_WARNING, "MQTT-SN", "Sending to %s failed: %s", ctx->address, strerror(errno));
+    }
+}
+
+static void mqttsn_client_connect(mqttsn_client_t *ctx)
+{
+    // a clean session, the topic ids are registered again
+    for (unsigned i = 0; i < MQTTSN_TOPIC_SLOTS; ++i) {
+        free(ctx->topics[i].name);
+    }
+    memset(ctx->topics, 0, MQTTSN_TOPIC_SLOTS * sizeof(*ctx->topics));
+    ctx->topics_len = 0;
+    ctx->connected  = 0;
+    ctx->connect_at = mg_time();
+
+    uint8_t head[4] = {MQTTSN_FLAG_CLEAN | (ctx->availability ? MQTTSN_FLAG_WILL : 0), 0x01, (uint8_t)(ctx->keepalive >> 8), (uint8_t)ctx->keepalive};
+    mqttsn_client_send(ctx, MQTTSN_CONNECT, head, sizeof(head), ctx->client_id, strlen(ctx->client_id));
+}
+
+static void mqttsn_client_register(mqttsn_client_t *ctx, mqttsn_topic_t *topic)
+{
+    ctx->message_id++;
+    if (!ctx->message_id)
+        ctx->message_id++;
+    topic->msg_id = ctx->message_id;
+
+    uint8_t head[4] = {0, 0, (uint8_t)(topic->msg_id >> 8), (uint8_t)topic->msg_id};
+    mqttsn_client_send(ctx, MQTTSN_REGISTER, head, sizeof(head), topic->name, strlen(topic->name));
+}
+
+static void mqttsn_client_send_publish(mqttsn_client_t *ctx, mqttsn_topic_t const *topic, char const *str)
+{
+    // QoS 0 with a normal topic id, the message id is not used
+    uint8_t head[5] = {topic->retain ? MQTTSN_FLAG_RETAIN : 0, (uint8_t)(topic->id >> 8), (uint8_t)topic->id, 0, 0};
+    mqttsn_client_send(ctx, MQTTSN_PUBLISH, head, sizeof(head), str, strlen(str));
+}
+
+// FNV-1a hash of a topic name
+static unsigned mqttsn_topic_hash(char const *name)
+{
+    unsigned h = 2166136261U;
+    for (; *name; ++name)
+        h = (h ^ (unsigned char)*name) * 16777619U;
+    return h;
+}
+
+// find the topic of a name, adds it if missing, returns NULL if the table is full or on alloc failure
+static mqttsn_topic_t *mqttsn_client_topic(mqttsn_client_t *ctx, char const *name)
+{
+    for (unsigned i = mqttsn_topic_hash(name);; ++i) {
+        mqttsn_topic_t *topic = &ctx->topics[i & (MQTTSN_TOPIC_SLOTS - 1)];
+        if (topic->name && !strcmp(topic->name, name)) {
+            return topic;
+        }
+        if (topic->name) {
+            continue;
+        }
+        // the gateway keeps the topic ids of a session, no topics are forgotten
+        if (ctx->topics_len >= MQTTSN_TOPIC_SLOTS * 3 / 4) {
+            print_logf_limited(LOG_WARNING, "MQTT-SN", "More than %d topics, topic \"%s\" dropped", MQTTSN_TOPIC_SLOTS * 3 / 4, name);
+            return NULL;
+        }
+        topic->name = strdup(name);
+        if (!topic->name) {
+            WARN_STRDUP("mqttsn_client_topic()");
+            return NULL; // NOTE: drops the message on alloc failure.
+        }
+        topic->retain = ctx->retain || (ctx->availability && !strcmp(name, ctx->availability));
+        ctx->topics_len++;
+        return topic;
+    }
+}
+
+// publish the held back messages whose topic is registered, register the topics of the others
+static void mqttsn_client_drain(mqttsn_client_t *ctx)
+{
+    if (!ctx->connected)
+        return;
+    if (ctx->dropped) {
+        print_logf(LOG_WARNING, "MQTT-SN", "MQTT-SN gateway too slow, dropped %u messages.", ctx->dropped);
+        ctx->dropped = 0;
+    }
+
+    unsigned kept = 0;
+    for (unsigned i = 0; i < ctx->backlog_len; ++i) {
+        mqtt_message_t *m     = &ctx->backlog[i];
+        mqttsn_topic_t *topic = mqttsn_client_topic(ctx, m->topic);
+        if (topic && !topic->id && !topic->rejected) {
+            if (!topic->msg_id)
+                mqttsn_client_register(ctx, topic);
+            ctx->backlog[kept++] = *m; // keep the order
+            continue;
+        }
+        if (topic && topic->id) {
+            mqttsn_client_send_publish(ctx, topic, m->payload);
+        }
+        mem_put(MEM_TAG_MQTT, m->topic);
+        mem_put(MEM_TAG_MQTT, m->payload);
+    }
+    ctx->backlog_len = kept;
+}
+
+// hold a message back until its topic is registered
+static void mqttsn_client_queue(mqttsn_client_t *ctx, char const *topic, char const *str)
+{
+    // the oldest are dropped if the backlog is full or, by half, over the memory limit
+    unsigned drop = ctx->backlog_len == MQTT_BACKLOG_SIZE ? 1 : 0;
+    if (mem_acct_over(MEM_TAG_MQTT) && ctx->backlog_len / 2 > drop) {
+        drop = ctx->backlog_len / 2;
+        mem_acct_shed(MEM_TAG_MQTT);
+    }
+    if (drop) {
+        for (unsigned i = 0; i < drop; ++i) {
+            mem_put(MEM_TAG_MQTT, ctx->backlog[i].topic);
+            mem_put(MEM_TAG_MQTT, ctx->backlog[i].payload);
+        }
+        memmove(ctx->backlog, &ctx->backlog[drop], (ctx->backlog_len - drop) * sizeof(*ctx->backlog));
+        ctx->backlog_len -= drop;
+        ctx->dropped += drop;
+    }
+    mqtt_message_t *m = &ctx->backlog[ctx->backlog_len];
+    m->topic = mem_dup(MEM_TAG_MQTT, topic);
+    if (!m->topic) {
+        WARN_STRDUP("mqttsn_client_queue()");
+        return; // NOTE: skip message on alloc failure.
+    }
+    m->payload = mem_dup(MEM_TAG_MQTT, str);
+    if (!m->payload) {
+        WARN_STRDUP("mqttsn_client_queue()");
+        mem_put(MEM_TAG_MQTT, m->topic);
+        return; // NOTE: skip message on alloc failure.
+    }
+    ctx->backlog_len++;
+}
+
+static void mqttsn_client_recv(mqttsn_client_t *ctx)
+{
+    uint8_t msg[MQTTSN_MESSAGE_MAX];
+    int n;
+    while ((n = (int)recv(ctx->sock, (char *)msg, sizeof(msg), 0)) > 0) {
+        uint8_t const *body = &msg[2];
+        size_t len          = msg[0];
+        if (msg[0] == 0x01 && n >= 4) {
+            body = &msg[4];
+            len  = (size_t)msg[1] << 8 | msg[2];
+        }
+        if (len < 2 || len > (size_t)n)
+            continue; // not MQTT-SN
+        uint8_t type    = body[-1];
+        size_t body_len = len - (size_t)(body - msg);
+        ctx->recv_at    = mg_time();
+
+        switch (type) {
+        case MQTTSN_CONNACK:
+            if (body_len < 1 || body[0]) {
+                print_logf(LOG_WARNING, "MQTT-SN", "MQTT-SN Connection error: %u", body_len ? body[0] : 0);
+                break;
+            }
+            print_log(LOG_NOTICE, "MQTT-SN", "MQTT-SN Connection established.");
+            ctx->connected       = 1;
+            ctx->reconnect_delay = 0;
+            if (ctx->availability)
+                mqttsn_client_queue(ctx, ctx->availability, mqtt_availability_online);
+            mqttsn_client_drain(ctx);
+            break;
+        case MQTTSN_WILLTOPICREQ: {
+            uint8_t head[1] = {MQTTSN_FLAG_RETAIN};
+            char const *will = ctx->availability ? ctx->availability : "";
+            mqttsn_client_send(ctx, MQTTSN_WILLTOPIC, head, sizeof(head), will, strlen(will));
+            break;
+        }
+        case MQTTSN_WILLMSGREQ:
+            mqttsn_client_send(ctx, MQTTSN_WILLMSG, NULL, 0, mqtt_availability_offline, strlen(mqtt_availability_offline));
+            break;
+        case MQTTSN_REGACK: {
+            if (body_len < 5)
+                break;
+            uint16_t topic_id = (uint16_t)(body[0] << 8 | body[1]);
+            uint16_t msg_id   = (uint16_t)(body[2] << 8 | body[3]);
+            for (unsigned i = 0; i < MQTTSN_TOPIC_SLOTS; ++i) {
+                mqttsn_topic_t *topic = &ctx->topics[i];
+                if (!topic->name || topic->id || topic->msg_id != msg_id)
+                    continue;
+                if (body[4] || !topic_id) {
+                    print_logf(LOG_WARNING, "MQTT-SN", "MQTT-SN gateway refused topic \"%s\": %u", topic->name, body[4]);
+                    topic->rejected = 1;
+                }
+                topic->id = topic_id;
+                break;
+            }
+            mqttsn_client_drain(ctx);
+            break;
+        }
+        case MQTTSN_PUBACK: {
+            if (body_len < 5 || body[4] != MQTTSN_RC_INVALID_TOPIC)
+                break;
+            // the gateway lost the registration, the topic is registered again on the next message
+            uint16_t topic_id = (uint16_t)(body[0] << 8 | body[1]);
+            for (unsigned i = 0; i < MQTTSN_TOPIC_SLOTS; ++i) {
+                mqttsn_topic_t *topic = &ctx->topics[i];
+                if (topic->name && topic->id == topic_id) {
+                    topic->id     = 0;
+                    topic->msg_id = 0;
+                }
+            }
+            break;
+        }
+        case MQTTSN_DISCONNECT:
+            print_log(LOG_WARNING, "MQTT-SN", "MQTT-SN gateway disconnected, reconnecting...");
+            ctx->connected = 0;
+            break;
+        default:
+            break; // PINGRESP only updates the time
+        }
+    }
+}
+
+// read the replies of the gateway, keep the connection alive, and reconnect if it is lost
+static void mqttsn_client_poll(mqttsn_client_t *ctx)
+{
+    mqttsn_client_recv(ctx);
+
+    double now = mg_time();
+    if (ctx->connected && now - ctx->recv_at > ctx->keepalive * 1.5) {
+        print_log(LOG_WARNING, "MQTT-SN", "MQTT-SN gateway lost, reconnecting...");
+        ctx->connected = 0;
+    }
+    if (!ctx->connected && now - ctx->connect_at >= ctx->reconnect_delay) {
+        mqttsn_client_connect(ctx);
+        if (ctx->reconnect_delay < 60) {
+            // 1, 3, 6, 10, 16, 25, 39, 60
+            ctx->reconnect_delay = (ctx->reconnect_delay + 1) * 3 / 2;
+        }
+    }
+    // QoS 0 publishes are not answered, a ping checks that the gateway is still there
+    else if (ctx->connected && now - (ctx->recv_at > ctx->ping_at ? ctx->recv_at : ctx->ping_at) >= ctx->keepalive / 2.0) {
+        mqttsn_client_send(ctx, MQTTSN_PINGREQ, NULL, 0, NULL, 0);
+        ctx->ping_at = now;
+    }
+    mqttsn_client_drain(ctx);
+}
+
+static void mqttsn_client_publish(mqttsn_client_t *ctx, char const *topic, char const *str)
+{
+    // don't wait for the next poll while connecting or registering
+    if (!ctx->connected || ctx->backlog_len) {
+        mqttsn_client_recv(ctx);
+    }
+    if (ctx->connected && !ctx->backlog_len) {
+        mqttsn_topic_t *t = mqttsn_client_topic(ctx, topic);
+        if (!t || t->rejected) {
+            return;
+        }
+        if (t->id) {
+            mqttsn_client_send_publish(ctx, t, str);
+            return;
+        }
+    }
+
+    // the first message of a topic waits for the topic id
+    mqttsn_client_queue(ctx, topic, str);
+    mqttsn_client_drain(ctx);
+}
+
+static mqttsn_client_t *mqttsn_client_init(char const *host, char const *port, char const *client_id, int retain, unsigned keepalive, char const *availability)
+{
+    mqttsn_client_t *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx)
+        FATAL_CALLOC("mqttsn_client_init()");
+    ctx->topics = calloc(MQTTSN_TOPIC_SLOTS, sizeof(*ctx->topics));
+    if (!ctx->topics)
+        FATAL_CALLOC("mqttsn_client_init()");
+
+    ctx->availability = availability;
+    ctx->retain       = retain;
+    ctx->keepalive    = keepalive;
+    snprintf(ctx->client_id, sizeof(ctx->client_id), "%s", client_id);
+    snprintf(ctx->address, sizeof(ctx->address), "%s:%s", host, port);
+
+    struct addrinfo hints = {0};
+    struct addrinfo *res  = NULL;
+    hints.ai_family       = AF_UNSPEC;
+    hints.ai_socktype     = SOCK_DGRAM;
+    int error             = getaddrinfo(host, port, &hints, &res);
+    if (error) {
+        print_logf(LOG_FATAL, "MQTT-SN", "MQTT-SN gateway (%s) not found: %s", ctx->address, gai_strerror(error));
+        exit(1);
+    }
+    ctx->sock = INVALID_SOCKET;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        ctx->sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (ctx->sock == INVALID_SOCKET)
+            continue;
+        // a connected socket only receives from the gateway
+        if (connect(ctx->sock, ai->ai_addr, (int)ai->ai_addrlen) == 0)
+            break;
+        closesocket(ctx->sock);
+        ctx->sock = INVALID_SOCKET;
+    }
+    freeaddrinfo(res);
+    if (ctx->sock == INVALID_SOCKET) {
+        print_logf(LOG_FATAL, "MQTT-SN", "MQTT-SN connect (%s) failed", ctx->address);
+        exit(1);
+    }
+    // the replies are read when polled
+#ifdef _WIN32
+    unsigned long on = 1;
+    ioctlsocket(ctx->sock, FIONBIO, &on);
+#else
+    fcntl(ctx->sock, F_SETFL, fcntl(ctx->sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    mqttsn_client_connect(ctx);
+    ctx->reconnect_delay = 1;
+
+    return ctx;
+}
+
+static void mqttsn_client_free(mqttsn_client_t *ctx)
+{
+    if (!ctx)
+        return;
+
+    // a clean disconnect does not publish the will
+    if (ctx->connected && ctx->availability) {
+        mqttsn_client_publish(ctx, ctx->availability, mqtt_availability_offline);
+    }
+    if (ctx->connected) {
+        mqttsn_client_send(ctx, MQTTSN_DISCONNECT, NULL, 0, NULL, 0);
+    }
+    closesocket(ctx->sock);
+    for (unsigned i = 0; i < ctx->backlog_len; ++i) {
+        mem_put(MEM_TAG_MQTT, ctx->backlog[i].topic);
+        mem_put(MEM_TAG_MQTT, ctx->backlog[i].payload);
+    }
+    for (unsigned i = 0; i < MQTTSN_TOPIC_SLOTS; ++i) {
+        free(ctx->topics[i].name);
+    }
+    free(ctx->topics);
     free(ctx);
 }
 
@@ -247,19 +774,81 @@ static char *mqtt_sanitize_topic(char *topic)
 
 /* MQTT printer */
 
+/// Number of device topics whose last value is kept, a power of two.
+#define MQTT_CHANGED_SLOTS 4096
+
+/// Kinds of the tokens of a topic template, the well-known keys follow the hostname.
+typedef enum mqtt_token_kind {
+    MQTT_TOKEN_LITERAL,
+    MQTT_TOKEN_HOSTNAME,
+    MQTT_TOKEN_TYPE,
+    MQTT_TOKEN_MODEL,
+    MQTT_TOKEN_SUBTYPE,
+    MQTT_TOKEN_CHANNEL,
+    MQTT_TOKEN_ID,
+    MQTT_TOKEN_PROTOCOL,
+} mqtt_token_kind_t;
+
+/// Number of well-known keys in topic templates.
+#define MQTT_TOKEN_KEYS (MQTT_TOKEN_PROTOCOL - MQTT_TOKEN_TYPE + 1)
+
+typedef struct mqtt_token {
+    mqtt_token_kind_t kind;
+    char leading_slash; ///< separator before the token, 0 if none
+    char const *text;   ///< the literal, or the default of the token, NULL if none
+    int text_len;
+} mqtt_token_t;
+
+/// Number of rendered topics cached for a template, a power of two.
+#define MQTT_TOPIC_CACHE 256
+
+typedef struct mqtt_topic_entry {
+    char *key; ///< the values of the well-known keys of the topic
+    size_t key_len;
+    char *topic;
+} mqtt_topic_entry_t;
+
+/// A topic format string compiled into tokens.
+typedef struct mqtt_template {
+    mqtt_token_t *tokens;
+    unsigned count;
+    unsigned keys; ///< bit mask of the well-known keys used
+    mqtt_topic_entry_t *cache;
+    unsigned cache_len;
+} mqtt_template_t;
+
+typedef struct mqtt_value {
+    char *topic;
+    char *value;
+} mqtt_value_t;
+
 typedef struct {
     struct data_output output;
     mqtt_client_t *mqc;
+    mqttsn_client_t *snc; ///< the MQTT-SN client instead of the MQTT client, NULL if none
     char topic[256];
     char hostname[64];
     char *availability;
     char *devices;
     char *events;
     char *states;
+    mqtt_template_t devices_topic;
+    mqtt_template_t events_topic;
+    mqtt_template_t states_topic;
+    mqtt_value_t *changed; ///< last value of each device topic, NULL to publish all values
+    unsigned changed_len;
     //char *homie;
     //char *hass;
 } data_output_mqtt_t;
 
+static void mqtt_publish(data_output_mqtt_t *mqtt, char const *topic, char const *str)
+{
+    if (mqtt->snc)
+        mqttsn_client_publish(mqtt->snc, topic, str);
+    else
+        mqtt_client_publish(mqtt->mqc, topic, str);
+}
+
 static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t *array, char const *format)
 {
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
@@ -273,77 +862,64 @@ static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t
     *orig = '\0'; // restore topic
 }
 
-static char *append_topic(char *topic, data_t *data)
+// FNV-1a hash of the values of a topic
+static unsigned mqtt_key_hash(char const *key, size_t len)
 {
-    if (data->type == DATA_STRING) {
-        strcpy(topic, data->value.v_ptr); // NOLINT
-        mqtt_sanitize_topic(topic);
-        topic += strlen(data->value.v_ptr);
-    }
-    else if (data->type == DATA_INT) {
-        topic += sprintf(topic, "%d", data->value.v_int);
-    }
-    else {
-        print_logf(LOG_ERROR, __func__, "Can't append data type %d to topic", data->type);
-    }
-
-    return topic;
+    unsigned h = 2166136261U;
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ (unsigned char)key[i]) * 16777619U;
+    return h;
 }
 
-static char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname)
+// parse a topic format string like "devices[/type][/model][/subtype][/channel][/id]" into tokens
+static void mqtt_template_compile(mqtt_template_t *tpl, char const *format)
 {
-    // collect well-known top level keys
-    data_t *data_type    = NULL;
-    data_t *data_model   = NULL;
-    data_t *data_subtype = NULL;
-    data_t *data_channel = NULL;
-    data_t *data_id      = NULL;
-    data_t *data_protocol = NULL;
-    for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "type"))
-            data_type = d;
-        else if (!strcmp(d->key, "model"))
-            data_model = d;
-        else if (!strcmp(d->key, "subtype"))
-            data_subtype = d;
-        else if (!strcmp(d->key, "channel"))
-            data_channel = d;
-        else if (!strcmp(d->key, "id"))
-            data_id = d;
-        else if (!strcmp(d->key, "protocol")) // NOTE: needs "-M protocol"
-            data_protocol = d;
+    // each '[' starts a token and might end a literal
+    size_t size = 1;
+    for (char const *p = format; *p; ++p) {
+        if (*p == '[')
+            size += 2;
     }
+    tpl->tokens = calloc(size, sizeof(*tpl->tokens));
+    if (!tpl->tokens)
+        FATAL_CALLOC("mqtt_template_compile()");
+    tpl->cache = calloc(MQTT_TOPIC_CACHE, sizeof(*tpl->cache));
+    if (!tpl->cache)
+        FATAL_CALLOC("mqtt_template_compile()");
 
     // consume entire format string
-    while (format && *format) {
-        data_t *data_token  = NULL;
-        char const *string_token = NULL;
-        int leading_slash   = 0;
-        char const *t_start = NULL;
-        char const *t_end   = NULL;
-        char const *d_start = NULL;
-        char const *d_end   = NULL;
+    while (*format) {
         // copy until '['
+        char const *literal = format;
         while (*format && *format != '[')
-            *topic++ = *format++;
+            format++;
+        if (format > literal) {
+            mqtt_token_t *tok = &tpl->tokens[tpl->count++];
+            tok->kind         = MQTT_TOKEN_LITERAL;
+            tok->text         = literal;
+            tok->text_len     = (int)(format - literal);
+        }
         // skip '['
         if (!*format)
             break;
         ++format;
+        mqtt_token_t *tok = &tpl->tokens[tpl->count++];
         // read slash
-        if (!leading_slash && (*format < 'a' || *format > 'z')) {
-            leading_slash = *format;
+        if (*format && (*format < 'a' || *format > 'z')) {
+            tok->leading_slash = *format;
             format++;
         }
         // read key until : or ]
-        t_start = t_end = format;
+        char const *t_start = format;
+        char const *t_end   = format;
         while (*format && *format != ':' && *format != ']' && *format != '[')
             t_end = ++format;
         // read default until ]
         if (*format == ':') {
-            d_start = d_end = ++format;
+            tok->text = ++format;
             while (*format && *format != ']' && *format != '[')
-                d_end = ++format;
+                ++format;
+            tok->text_len = (int)(format - tok->text);
         }
         // check for proper closing
         if (*format != ']') {
@@ -354,39 +930,178 @@ static char *expand_topic(char *topic, char const *format, data_t *data, char co
 
         // resolve token
         if (!strncmp(t_start, "hostname", t_end - t_start))
-            string_token = hostname;
+            tok->kind = MQTT_TOKEN_HOSTNAME;
         else if (!strncmp(t_start, "type", t_end - t_start))
-            data_token = data_type;
+            tok->kind = MQTT_TOKEN_TYPE;
         else if (!strncmp(t_start, "model", t_end - t_start))
-            data_token = data_model;
+            tok->kind = MQTT_TOKEN_MODEL;
         else if (!strncmp(t_start, "subtype", t_end - t_start))
-            data_token = data_subtype;
+            tok->kind = MQTT_TOKEN_SUBTYPE;
         else if (!strncmp(t_start, "channel", t_end - t_start))
-            data_token = data_channel;
+            tok->kind = MQTT_TOKEN_CHANNEL;
         else if (!strncmp(t_start, "id", t_end - t_start))
-            data_token = data_id;
+            tok->kind = MQTT_TOKEN_ID;
         else if (!strncmp(t_start, "protocol", t_end - t_start))
-            data_token = data_protocol;
+            tok->kind = MQTT_TOKEN_PROTOCOL;
         else {
             print_logf(LOG_FATAL, __func__, "unknown token \"%.*s\"", (int)(t_end - t_start), t_start);
             exit(1);
         }
+        if (tok->kind >= MQTT_TOKEN_TYPE)
+            tpl->keys |= 1U << (tok->kind - MQTT_TOKEN_TYPE);
+    }
+}
+
+static void mqtt_template_clear(mqtt_template_t *tpl)
+{
+    for (unsigned i = 0; i < MQTT_TOPIC_CACHE; ++i) {
+        free(tpl->cache[i].key);
+        free(tpl->cache[i].topic);
+        tpl->cache[i].key   = NULL;
+        tpl->cache[i].topic = NULL;
+    }
+    tpl->cache_len = 0;
+}
+
+static void mqtt_template_free(mqtt_template_t *tpl)
+{
+    if (tpl->cache) {
+        mqtt_template_clear(tpl);
+        free(tpl->cache);
+    }
+    free(tpl->tokens);
+}
 
+// write the topic of the well-known keys, with defaults for missing keys
+static char *mqtt_template_write(mqtt_template_t const *tpl, char *topic, size_t size, data_t *const *keys, char const *hostname)
+{
+    abuf_t buf;
+    abuf_init(&buf, topic, size);
+    *topic = '\0';
+    for (unsigned i = 0; i < tpl->count; ++i) {
+        mqtt_token_t const *tok = &tpl->tokens[i];
+        if (tok->kind == MQTT_TOKEN_LITERAL) {
+            abuf_printf(&buf, "%.*s", tok->text_len, tok->text);
+            continue;
+        }
+        data_t *data_token       = tok->kind >= MQTT_TOKEN_TYPE ? keys[tok->kind - MQTT_TOKEN_TYPE] : NULL;
+        char const *string_token = tok->kind == MQTT_TOKEN_HOSTNAME ? hostname : NULL;
         // append token or default
-        if (!data_token && !string_token && !d_start)
+        if (!data_token && !string_token && !tok->text)
             continue;
-        if (leading_slash)
-            *topic++ = leading_slash;
-        if (data_token)
-            topic = append_topic(topic, data_token);
+        if (tok->leading_slash)
+            abuf_printf(&buf, "%c", tok->leading_slash);
+        if (data_token && data_token->type == DATA_STRING) {
+            char *value = buf.tail;
+            abuf_cat(&buf, data_token->value.v_ptr);
+            mqtt_sanitize_topic(value);
+        }
+        else if (data_token && data_token->type == DATA_INT)
+            abuf_print_int(&buf, "%d", data_token->value.v_int);
+        else if (data_token)
+            print_logf(LOG_ERROR, __func__, "Can't append data type %d to topic", data_token->type);
         else if (string_token)
-            topic += sprintf(topic, "%s", string_token);
+            abuf_cat(&buf, string_token);
         else
-            topic += sprintf(topic, "%.*s", (int)(d_end - d_start), d_start);
+            abuf_printf(&buf, "%.*s", tok->text_len, tok->text);
     }
+    return buf.tail;
+}
 
-    *topic = '\0';
-    return topic;
+/** Render a compiled topic template for an event.
+
+    The topic of each combination of values of the well-known keys is cached,
+    e.g. the device topic prefix of each model, channel, and id.
+
+    @return the end of the topic
+*/
+static char *mqtt_template_render(mqtt_template_t *tpl, char *topic, size_t size, data_t *data, char const *hostname)
+{
+    // collect well-known top level keys
+    data_t *keys[MQTT_TOKEN_KEYS] = {0};
+    for (data_t *d = tpl->keys ? data : NULL; d; d = d->next) {
+        if (data_key_is(d, DATA_KEY_TYPE))
+            keys[MQTT_TOKEN_TYPE - MQTT_TOKEN_TYPE] = d;
+        else if (data_key_is(d, DATA_KEY_MODEL))
+            keys[MQTT_TOKEN_MODEL - MQTT_TOKEN_TYPE] = d;
+        else if (data_key_is(d, DATA_KEY_SUBTYPE))
+            keys[MQTT_TOKEN_SUBTYPE - MQTT_TOKEN_TYPE] = d;
+        else if (data_key_is(d, DATA_KEY_CHANNEL))
+            keys[MQTT_TOKEN_CHANNEL - MQTT_TOKEN_TYPE] = d;
+        else if (data_key_is(d, DATA_KEY_ID))
+            keys[MQTT_TOKEN_ID - MQTT_TOKEN_TYPE] = d;
+        else if (data_key_is(d, DATA_KEY_PROTOCOL)) // NOTE: needs "-M protocol"
+            keys[MQTT_TOKEN_PROTOCOL - MQTT_TOKEN_TYPE] = d;
+    }
+
+    // the cache key is the type and value of each key used
+    char key[256];
+    size_t key_len = 0;
+    for (unsigned i = 0; i < MQTT_TOKEN_KEYS && key_len < sizeof(key); ++i) {
+        data_t *d = keys[i];
+        if (!(tpl->keys & (1U << i)))
+            continue;
+        if (!d) {
+            key[key_len++] = '-';
+        }
+        else if (d->type == DATA_STRING) {
+            size_t len = strlen(d->value.v_ptr) + 1;
+            if (key_len + 1 + len > sizeof(key)) {
+                key_len = sizeof(key); // too long to cache
+                break;
+            }
+            key[key_len++] = 's';
+            memcpy(&key[key_len], d->value.v_ptr, len);
+            key_len += len;
+        }
+        else if (d->type == DATA_INT && key_len + 1 + sizeof(int) <= sizeof(key)) {
+            key[key_len++] = 'i';
+            memcpy(&key[key_len], &d->value.v_int, sizeof(int));
+            key_len += sizeof(int);
+        }
+        else {
+            key_len = sizeof(key); // not cached
+        }
+    }
+    if (key_len >= sizeof(key)) {
+        return mqtt_template_write(tpl, topic, size, keys, hostname);
+    }
+
+    // forget all topics if the cache fills up
+    if (tpl->cache_len >= MQTT_TOPIC_CACHE * 3 / 4) {
+        mqtt_template_clear(tpl);
+    }
+    for (unsigned i = mqtt_key_hash(key, key_len);; ++i) {
+        mqtt_topic_entry_t *entry = &tpl->cache[i & (MQTT_TOPIC_CACHE - 1)];
+        if (entry->topic && (entry->key_len != key_len || memcmp(entry->key, key, key_len))) {
+            continue;
+        }
+        if (entry->topic) {
+            size_t len = strlen(entry->topic);
+            if (len >= size)
+                len = size - 1;
+            memcpy(topic, entry->topic, len);
+            topic[len] = '\0';
+            return topic + len;
+        }
+        char *end  = mqtt_template_write(tpl, topic, size, keys, hostname);
+        char *copy = malloc(key_len + 1); // an empty key still needs an allocation
+        if (!copy) {
+            WARN_MALLOC("mqtt_template_render()");
+            return end; // NOTE: not cached on alloc failure.
+        }
+        entry->topic = strdup(topic);
+        if (!entry->topic) {
+            WARN_STRDUP("mqtt_template_render()");
+            free(copy);
+            return end; // NOTE: not cached on alloc failure.
+        }
+        entry->key = copy;
+        memcpy(copy, key, key_len);
+        entry->key_len = key_len;
+        tpl->cache_len++;
+        return end;
+    }
 }
 
 // <prefix>[/type][/model][/subtype][/channel][/id]/battery: "OK"|"LOW"
@@ -403,35 +1118,34 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
         // collect well-known top level keys
         data_t *data_model = NULL;
         for (data_t *d = data; d; d = d->next) {
-            if (!strcmp(d->key, "model"))
+            if (data_key_is(d, DATA_KEY_MODEL))
                 data_model = d;
         }
 
         // "states" topic
         if (!data_model) {
             if (mqtt->states) {
-                size_t message_size = 20000; // state message need a large buffer
-                char *message       = malloc(message_size);
+                size_t len;
+                char const *message = data_output_jsons(output, data, &len);
                 if (!message) {
-                    WARN_MALLOC("print_mqtt_data()");
                     return; // NOTE: skip output on alloc failure.
                 }
-                data_print_jsons(data, message, message_size);
-                expand_topic(mqtt->topic, mqtt->states, data, mqtt->hostname);
-                mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
+                mqtt_template_render(&mqtt->states_topic, mqtt->topic, sizeof(mqtt->topic), data, mqtt->hostname);
+                mqtt_publish(mqtt, mqtt->topic, message);
                 *mqtt->topic = '\0'; // clear topic
-                free(message);
             }
             return;
         }
 
         // "events" topic
         if (mqtt->events) {
-            char message[2048]; // we expect the biggest strings to be around 500 bytes.
-            data_print_jsons(data, message, sizeof(message));
-            expand_topic(mqtt->topic, mqtt->events, data, mqtt->hostname);
-            mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
-            *mqtt->topic = '\0'; // clear topic
+            size_t len;
+            char const *message = data_output_jsons(output, data, &len);
+            if (message) {
+                mqtt_template_render(&mqtt->events_topic, mqtt->topic, sizeof(mqtt->topic), data, mqtt->hostname);
+                mqtt_publish(mqtt, mqtt->topic, message);
+                *mqtt->topic = '\0'; // clear topic
+            }
         }
 
         // "devices" topic
@@ -439,13 +1153,13 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
             return;
         }
 
-        end = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+        end = mqtt_template_render(&mqtt->devices_topic, mqtt->topic, sizeof(mqtt->topic), data, mqtt->hostname);
     }
 
     while (data) {
-        if (!strcmp(data->key, "type")
-                || !strcmp(data->key, "model")
-                || !strcmp(data->key, "subtype")) {
+        if (data_key_is(data, DATA_KEY_TYPE)
+                || data_key_is(data, DATA_KEY_MODEL)
+                || data_key_is(data, DATA_KEY_SUBTYPE)) {
             // skip, except "id", "channel"
         }
         else {
@@ -460,11 +1174,70 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
     *orig = '\0'; // restore topic
 }
 
+// FNV-1a hash of a topic
+static unsigned mqtt_topic_hash(char const *topic)
+{
+    unsigned h = 2166136261U;
+    for (; *topic; ++topic)
+        h = (h ^ (unsigned char)*topic) * 16777619U;
+    return h;
+}
+
+static void mqtt_changed_clear(data_output_mqtt_t *mqtt)
+{
+    for (unsigned i = 0; i < MQTT_CHANGED_SLOTS; ++i) {
+        free(mqtt->changed[i].topic);
+        free(mqtt->changed[i].value);
+        mqtt->changed[i].topic = NULL;
+        mqtt->changed[i].value = NULL;
+    }
+    mqtt->changed_len = 0;
+}
+
+// remember the value of a device topic, returns 0 if the topic had that value already
+static int mqtt_value_changed(data_output_mqtt_t *mqtt, char const *topic, char const *value)
+{
+    // forget all values if the table fills up, they are published again once
+    if (mqtt->changed_len >= MQTT_CHANGED_SLOTS * 3 / 4) {
+        mqtt_changed_clear(mqtt);
+    }
+    for (unsigned i = mqtt_topic_hash(topic);; ++i) {
+        mqtt_value_t *slot = &mqtt->changed[i & (MQTT_CHANGED_SLOTS - 1)];
+        if (slot->topic && strcmp(slot->topic, topic)) {
+            continue;
+        }
+        if (slot->value && !strcmp(slot->value, value)) {
+            return 0;
+        }
+        char *copy = strdup(value);
+        if (!copy) {
+            WARN_STRDUP("mqtt_value_changed()");
+            return 1; // NOTE: publish on alloc failure.
+        }
+        if (!slot->topic) {
+            slot->topic = strdup(topic);
+            if (!slot->topic) {
+                WARN_STRDUP("mqtt_value_changed()");
+                free(copy);
+                return 1; // NOTE: publish on alloc failure.
+            }
+            mqtt->changed_len++;
+        }
+        free(slot->value);
+        slot->value = copy;
+        return 1;
+    }
+}
+
 static void R_API_CALLCONV print_mqtt_string(data_output_t *output, char const *str, char const *format)
 {
     UNUSED(format);
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
-    mqtt_client_publish(mqtt->mqc, mqtt->topic, str);
+
+    if (mqtt->changed && !mqtt_value_changed(mqtt, mqtt->topic, str)) {
+        return;
+    }
+    mqtt_publish(mqtt, mqtt->topic, str);
 }
 
 static void R_API_CALLCONV print_mqtt_double(data_output_t *output, double data, char const *format)
@@ -475,9 +1248,11 @@ static void R_API_CALLCONV print_mqtt_double(data_output_t *output, double data,
         snprintf(str, sizeof(str), "%g", data);
     }
     else {
-        int ret = snprintf(str, sizeof(str), "%.5f", data);
+        abuf_t buf;
+        abuf_init(&buf, str, sizeof(str));
+        abuf_print_fixed(&buf, data, 5);
         // remove trailing zeros, always keep one digit after the decimal point
-        char *p = str + ret - 1;
+        char *p = buf.tail - 1;
         while (*p == '0' && p[-1] != '.') {
             *p-- = '\0';
         }
@@ -489,7 +1264,9 @@ static void R_API_CALLCONV print_mqtt_double(data_output_t *output, double data,
 static void R_API_CALLCONV print_mqtt_int(data_output_t *output, int data, char const *format)
 {
     char str[20];
-    snprintf(str, sizeof(str), "%d", data);
+    abuf_t buf;
+    abuf_init(&buf, str, sizeof(str));
+    abuf_print_int(&buf, "%d", data);
     print_mqtt_string(output, str, format);
 }
 
@@ -500,10 +1277,20 @@ static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
     if (!mqtt)
         return;
 
+    // publishes the availability before the topic is freed
+    mqttsn_client_free(mqtt->snc);
+
     free(mqtt->availability);
     free(mqtt->devices);
     free(mqtt->events);
     free(mqtt->states);
+    mqtt_template_free(&mqtt->devices_topic);
+    mqtt_template_free(&mqtt->events_topic);
+    mqtt_template_free(&mqtt->states_topic);
+    if (mqtt->changed) {
+        mqtt_changed_clear(mqtt);
+        free(mqtt->changed);
+    }
     //free(mqtt->homie);
     //free(mqtt->hass);
 
@@ -512,6 +1299,13 @@ static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
     free(mqtt);
 }
 
+static void R_API_CALLCONV data_output_mqttsn_poll(data_output_t *output)
+{
+    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+
+    mqttsn_client_poll(mqtt->snc);
+}
+
 static char *mqtt_topic_default(char const *topic, char const *base, char const *suffix)
 {
     char path[256];
@@ -571,17 +1365,24 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     char const *pass = getenv("MQTT_PASSWORD");
     int retain       = 0;
     int qos          = 0;
+    int window       = 64;
+    int changed      = 0;
+    int keepalive    = 60;
 
     // parse host and port
     tls_opts_t tls_opts = {0};
-    if (param && strncmp(param, "mqtts", 5) == 0) {
+    int sn              = param && strncmp(param, "mqttsn", 6) == 0;
+    if (param && !sn && strncmp(param, "mqtts", 5) == 0) {
         tls_opts.tls_ca_cert = "*"; // TLS is enabled but no cert verification is performed.
     }
     param      = arg_param(param); // strip scheme
     char const *host = "localhost";
-    char const *port = tls_opts.tls_ca_cert ? "8883" : "1883";
+    char const *port = sn ? "1884" : tls_opts.tls_ca_cert ? "8883" : "1883";
     char *opts = hostport_param(param, &host, &port);
-    print_logf(LOG_CRITICAL, "MQTT", "Publishing MQTT data to %s port %s%s", host, port, tls_opts.tls_ca_cert ? " (TLS)" : "");
+    if (sn)
+        print_logf(LOG_CRITICAL, "MQTT", "Publishing MQTT-SN data to %s port %s", host, port);
+    else
+        print_logf(LOG_CRITICAL, "MQTT", "Publishing MQTT data to %s port %s%s", host, port, tls_opts.tls_ca_cert ? " (TLS)" : "");
 
     // parse auth and format options
     char *key, *val;
@@ -598,6 +1399,12 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
             retain = atobv(val, 1);
         else if (!strcasecmp(key, "q") || !strcasecmp(key, "qos"))
             qos = atoiv(val, 1);
+        else if (!strcasecmp(key, "w") || !strcasecmp(key, "window"))
+            window = atoiv(val, 64);
+        else if (!strcasecmp(key, "changed"))
+            changed = atobv(val, 1);
+        else if (!strcasecmp(key, "k") || !strcasecmp(key, "keepalive"))
+            keepalive = atoiv(val, 60);
         else if (!strcasecmp(key, "b") || !strcasecmp(key, "base"))
             base_topic = val;
         // LWT availability status topic
@@ -645,6 +1452,13 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     if (!mqtt->availability) {
         mqtt->availability = mqtt_topic_default(NULL, base_topic, path_availability);
     }
+    // the templates point into the format strings
+    if (mqtt->devices)
+        mqtt_template_compile(&mqtt->devices_topic, mqtt->devices);
+    if (mqtt->events)
+        mqtt_template_compile(&mqtt->events_topic, mqtt->events);
+    if (mqtt->states)
+        mqtt_template_compile(&mqtt->states_topic, mqtt->states);
     if (mqtt->availability)
         print_logf(LOG_NOTICE, "MQTT", "Publishing availability to MQTT topic \"%s\".", mqtt->availability);
     if (mqtt->devices)
@@ -653,6 +1467,12 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
         print_logf(LOG_NOTICE, "MQTT", "Publishing events info to MQTT topic \"%s\".", mqtt->events);
     if (mqtt->states)
         print_logf(LOG_NOTICE, "MQTT", "Publishing states info to MQTT topic \"%s\".", mqtt->states);
+    if (changed && mqtt->devices) {
+        mqtt->changed = calloc(MQTT_CHANGED_SLOTS, sizeof(*mqtt->changed));
+        if (!mqtt->changed)
+            FATAL_CALLOC("data_output_mqtt_create()");
+        print_log(LOG_NOTICE, "MQTT", "Publishing only changed device info.");
+    }
 
     mqtt->output.print_data   = print_mqtt_data;
     mqtt->output.print_array  = print_mqtt_array;
@@ -661,7 +1481,40 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     mqtt->output.print_int    = print_mqtt_int;
     mqtt->output.output_free  = data_output_mqtt_free;
 
-    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, mqtt->availability);
+    if (sn) {
+        // MQTT-SN has no authentication, TLS, or acknowledged QoS 0 messages
+        if (tls_opts.tls_ca_cert || tls_opts.tls_cert) {
+            print_log(LOG_FATAL, "MQTT", "MQTT-SN does not support TLS.");
+            exit(1);
+        }
+        if (qos) {
+            print_log(LOG_WARNING, "MQTT", "MQTT-SN publishes with qos=0.");
+        }
+        if (keepalive < 1 || keepalive > 65535) {
+            print_log(LOG_FATAL, "MQTT", "MQTT-SN keepalive must be 1 to 65535 seconds.");
+            exit(1);
+        }
+        mqtt->output.output_poll = data_output_mqttsn_poll;
+        mqtt->snc = mqttsn_client_init(host, port, client_id, retain, (unsigned)keepalive, mqtt->availability);
+    }
+    else {
+        mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, window, mqtt->availability);
+    }
 
     return (struct data_output *)mqtt;
 }
+
+int data_output_mqtt_stats(struct data_output *output, tls_stats_t *stats, int reset)
+{
+    if (!output || output->output_free != data_output_mqtt_free)
+        return 0;
+
+    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+    if (!mqtt->mqc || !mqtt->mqc->tls_session)
+        return 0;
+    *stats = mqtt->mqc->tls_stats;
+    if (reset) {
+        memset(&mqtt->mqc->tls_stats, 0, sizeof(mqtt->mqc->tls_stats));
+    }
+    return 1;
+}
@@ -14,9 +14,12 @@
 #include "rtl_433.h"
 #include "r_api.h"
 #include "r_util.h"
+#include "output_squelch.h"
+#include "rtltcp_codec.h"
 #include "optparse.h"
 #include "logger.h"
 #include "fatal.h"
+#include "list.h"
 #include "compat_pthread.h"
 
 #include <string.h>
@@ -43,6 +46,8 @@
 
     #include <winsock2.h>
     #include <ws2tcpip.h>
+
+    #define SHUT_RDWR       SD_BOTH
 #else
     #include <sys/types.h>
     #include <sys/socket.h>
@@ -93,31 +98,72 @@ typedef SSIZE_T ssize_t;
 /* rtl_tcp server */
 
 // Only available if Threads are enabled.
-// Currently serves a maximum of 1 client connection.
-// The data backing from the SDR is assumed to be persistent, which is the case
-// since we never restart the SDR with different parameters or close it while active.
+// Each client has a sender thread and a bounded queue of frames,
+// a client that does not keep up has the oldest frames dropped.
+// The SDR buffer is reused, frames are copied once and shared by all queues.
 // Should use shared memory for sendfile() someday.
 
 #ifdef THREADS
 
+/// Default number of frames queued for a client.
+#define RTLTCP_QUEUE_DEPTH 16
+/// Time a client has to request the compressed transport before the samples are sent.
+#define RTLTCP_NEGOTIATE_MS 200
+
+/// A copy of the SDR data, shared by the queues of all clients.
+typedef struct rtltcp_frame {
+    unsigned refs; ///< guarded by the server lock
+    uint32_t len;
+    uint8_t data[];
+} rtltcp_frame_t;
+
+struct rtltcp_server;
+
+typedef struct rtltcp_client {
+    struct rtltcp_server *srv;
+    SOCKET sock;
+    pthread_t thread;
+    char host[INET6_ADDRSTRLEN];
+    char port[NI_MAXSERV];
+
+    rtltcp_frame_t **queue; ///< ring of depth frames, guarded by the server lock
+    unsigned queue_head;    ///< next frame to send
+    unsigned queue_len;     ///< number of queued frames
+    unsigned sent;          ///< frames sent
+    unsigned dropped;       ///< frames dropped because the client did not keep up
+    unsigned reported;      ///< dropped count already reported
+
+    rtltcp_codec_t *codec; ///< encoder of the compressed transport, NULL for raw samples
+    unsigned method;       ///< the method of the compressed transport
+    uint64_t raw_bytes;    ///< samples sent, before compression
+    uint64_t wire_bytes;   ///< bytes sent of compressed blocks
+} rtltcp_client_t;
+
 typedef struct rtltcp_server {
     struct sockaddr_storage addr;
     socklen_t addr_len;
     SOCKET sock;
-    int client_count; ///< number of connected clients
     int control;      ///< are clients allowed to change SDR parameters
+    unsigned depth;   ///< frames queued for each client
+    unsigned compress; ///< compressed transport methods offered to clients, 0 if off
 
-    uint8_t const *data_buf; ///< data buffer with most recent data, NULL otherwise
-    uint32_t data_len;       ///< data buffer length in bytes, 0 otherwise
-    unsigned data_cnt;       ///< data buffer update counter
+    list_t clients;   ///< the connected rtltcp_client_t
+    int exit_clients; ///< request the client threads to exit
 
     pthread_t thread;
-    pthread_mutex_t lock; ///< lock for data buffer
-    pthread_cond_t cond;  ///< wait for data buffer
+    pthread_mutex_t lock; ///< lock for the clients and their queues
+    pthread_cond_t cond;  ///< signals queued frames and clients exiting
     r_cfg_t *cfg;
     struct raw_output *output;
 } rtltcp_server_t;
 
+// the server lock needs to be held
+static void rtltcp_frame_release(rtltcp_frame_t *frame)
+{
+    if (frame && --frame->refs == 0)
+        free(frame);
+}
+
 static ssize_t send_all(int sockfd, void const *buf, size_t len, int flags)
 {
     size_t sent = 0;
@@ -230,6 +276,10 @@ static int parse_command(r_cfg_t *cfg, int control, uint8_t const *buf, int len)
     case RTLTCP_SET_BIAS_TEE:
         print_logf(LOG_DEBUG, "rtl_tcp", "received command SET_BIAS_TEE with %u", arg);
         break;
+    case RTLTCP_SET_COMPRESSION:
+        // only before the first samples, this client gets raw samples
+        print_logf(LOG_DEBUG, "rtl_tcp", "ignored command SET_COMPRESSION with %u", arg);
+        break;
     default:
         print_logf(LOG_WARNING, "rtl_tcp", "received unknown command %d with %u", cmd, arg);
         break;
@@ -238,21 +288,186 @@ static int parse_command(r_cfg_t *cfg, int control, uint8_t const *buf, int len)
     return 5;
 }
 
-// event handler to broadcast to all our sockets
+// copy the frame once and queue it for all clients, never waits on the network
 static void rtltcp_broadcast_send(rtltcp_server_t *srv, uint8_t const *data, uint32_t len)
 {
     // print_logf(LOG_TRACE, __func__, "%d byte frame", len);
     pthread_mutex_lock(&srv->lock);
+    size_t client_count = srv->clients.len;
+    pthread_mutex_unlock(&srv->lock);
+    if (!client_count)
+        return;
 
-    // update the data buffer reference
-    srv->data_buf = data;
-    srv->data_len = len;
-    srv->data_cnt += 1;
+    rtltcp_frame_t *frame = malloc(sizeof(*frame) + len);
+    if (!frame) {
+        WARN_MALLOC("rtltcp_broadcast_send()");
+        return; // NOTE: skip frame on alloc failure.
+    }
+    frame->refs = 1; // our reference
+    frame->len  = len;
+    memcpy(frame->data, data, len);
 
+    pthread_mutex_lock(&srv->lock);
+    for (void **iter = srv->clients.elems; iter && *iter; ++iter) {
+        rtltcp_client_t *client = *iter;
+        if (client->queue_len >= srv->depth) {
+            // drop oldest
+            rtltcp_frame_release(client->queue[client->queue_head]);
+            client->queue_head = (client->queue_head + 1) % srv->depth;
+            client->queue_len -= 1;
+            client->dropped += 1;
+        }
+        client->queue[(client->queue_head + client->queue_len) % srv->depth] = frame;
+        client->queue_len += 1;
+        frame->refs += 1;
+    }
+    rtltcp_frame_release(frame);
+    pthread_cond_broadcast(&srv->cond);
     pthread_mutex_unlock(&srv->lock);
-    pthread_cond_signal(&srv->cond);
-    // perhaps broadcast if we want to support multiple clients
-    //int pthread_cond_broadcast(&srv->cond);
+}
+
+// wait a moment for the client to request the compressed transport, a stock client gets raw samples
+static void negotiate_compression(rtltcp_client_t *client)
+{
+    rtltcp_server_t *srv = client->srv;
+    SOCKET sock          = client->sock;
+
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    struct timeval timeout = {0, RTLTCP_NEGOTIATE_MS * 1000};
+    if (select(sock + 1, &fds, NULL, NULL, &timeout) <= 0)
+        return;
+
+    uint8_t buf[128] = {0};
+    ssize_t len = recv(sock, buf, sizeof(buf), 0);
+    int pos = 0;
+    while (pos + 5 <= len) {
+        if (buf[pos] != RTLTCP_SET_COMPRESSION || client->codec) {
+            pos += parse_command(srv->cfg, srv->control, &buf[pos], (int)len - pos);
+            continue;
+        }
+        unsigned offered = (unsigned)buf[pos + 1] << 24 | buf[pos + 2] << 16 | buf[pos + 3] << 8 | buf[pos + 4];
+        unsigned method  = rtltcp_codec_choose(offered & srv->compress);
+        if (method) {
+            client->codec = rtltcp_codec_create(method);
+            method        = client->codec ? method : 0;
+        }
+        client->method = method;
+        uint8_t ack[RTLTCP_CODEC_HEADER];
+        rtltcp_codec_ack(ack, method);
+        send_all(sock, ack, sizeof(ack), MSG_NOSIGNAL); // ignore SIGPIPE
+        print_logf(LOG_NOTICE, "rtl_tcp", "client %s port %s requested the compressed transport, using %s", client->host, client->port, rtltcp_codec_name(method));
+        pos += 5;
+    }
+}
+
+static THREAD_RETURN THREAD_CALL client_thread(void *arg)
+{
+    rtltcp_client_t *client = arg;
+    rtltcp_server_t *srv    = client->srv;
+    SOCKET sock             = client->sock;
+
+    send_header(sock);
+    if (srv->compress)
+        negotiate_compression(client);
+
+    // Client loop
+    for (;;) {
+        // Read available commands
+        int abort = 0;
+        for (;;) {
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(sock, &fds);
+            struct timeval timeout = {0};
+
+            int ready = select(sock + 1, &fds, NULL, NULL, &timeout);
+            if (ready <= 0)
+                break;
+
+            uint8_t buf[128] = {0};
+            ssize_t len = recv(sock, buf, sizeof(buf), 0);
+            //print_logf(LOG_TRACE, "rtl_tcp", "recv %zd bytes (%d)", len, ready);
+            if (len <= 0) {
+                abort = 1;
+                break;
+            }
+            int pos = 0;
+            while (pos + 5 <= len) {
+                pos += parse_command(srv->cfg, srv->control, & buf[pos], (int)len - pos);
+            }
+        }
+        if (abort) {
+            break;
+        }
+
+        // Wait for next frame
+        pthread_mutex_lock(&srv->lock);
+        while (client->queue_len == 0 && !srv->exit_clients)
+            pthread_cond_wait(&srv->cond, &srv->lock);
+        if (srv->exit_clients) {
+            pthread_mutex_unlock(&srv->lock);
+            break;
+        }
+        rtltcp_frame_t *frame = client->queue[client->queue_head];
+        client->queue_head = (client->queue_head + 1) % srv->depth;
+        client->queue_len -= 1;
+        unsigned dropped = client->dropped;
+        pthread_mutex_unlock(&srv->lock);
+
+        if (dropped > client->reported) {
+            print_logf(LOG_WARNING, "rtl_tcp", "client %s port %s too slow, dropped %u frames", client->host, client->port, dropped - client->reported);
+        }
+        client->reported = dropped;
+
+        // Send frame, only this client waits on the network
+        uint8_t const *data = frame->data;
+        uint32_t len        = frame->len;
+        if (client->codec) {
+            data = rtltcp_codec_encode(client->codec, frame->data, frame->len, &len);
+            client->raw_bytes += frame->len;
+            client->wire_bytes += len;
+        }
+        ssize_t ret = data ? send_all(sock, data, len, MSG_NOSIGNAL) : -1; // ignore SIGPIPE
+
+        pthread_mutex_lock(&srv->lock);
+        rtltcp_frame_release(frame);
+        pthread_mutex_unlock(&srv->lock);
+
+        if (ret < 0)
+            break;
+        client->sent += 1;
+    }
+
+    pthread_mutex_lock(&srv->lock);
+    for (size_t i = 0; i < srv->clients.len; ++i) {
+        if (srv->clients.elems[i] == client) {
+            list_remove(&srv->clients, i, NULL);
+            break;
+        }
+    }
+    while (client->queue_len > 0) {
+        rtltcp_frame_release(client->queue[client->queue_head]);
+        client->queue_head = (client->queue_head + 1) % srv->depth;
+        client->queue_len -= 1;
+    }
+    unsigned sent    = client->sent;
+    unsigned dropped = client->dropped;
+    pthread_cond_broadcast(&srv->cond); // the server might wait for clients to exit
+    pthread_mutex_unlock(&srv->lock);
+
+    print_logf(LOG_NOTICE, "rtl_tcp", "client disconnected from %s port %s, sent %u frames, dropped %u frames", client->host, client->port, sent, dropped);
+    if (client->codec && client->raw_bytes) {
+        print_logf(LOG_NOTICE, "rtl_tcp", "client %s port %s was sent %.0f%% of the raw size with %s", client->host, client->port,
+                client->wire_bytes * 100.0 / client->raw_bytes, rtltcp_codec_name(client->method));
+    }
+    rtltcp_codec_free(client->codec);
+    closesocket(sock);
+    free(client->queue);
+    free(client);
+
+    return 0;
 }
 
 static THREAD_RETURN THREAD_CALL accept_thread(void *arg)
@@ -261,7 +476,7 @@ static THREAD_RETURN THREAD_CALL accept_thread(void *arg)
 
     // Start listening for clients, waits for an incoming connection
     int listen_sock = srv->sock; // make it easy for the checker
-    int r = listen(listen_sock, 1);
+    int r = listen(listen_sock, 4);
     if (r < 0) {
         perror("ERROR on listen");
         closesocket(listen_sock);
@@ -292,91 +507,50 @@ static THREAD_RETURN THREAD_CALL accept_thread(void *arg)
         }
 #endif
 
-        char host[INET6_ADDRSTRLEN] = {0};
-        char port[NI_MAXSERV]       = {0};
+        rtltcp_client_t *client = calloc(1, sizeof(*client));
+        if (!client) {
+            WARN_CALLOC("accept_thread()");
+            closesocket(sock);
+            continue;
+        }
+        client->queue = calloc(srv->depth, sizeof(*client->queue));
+        if (!client->queue) {
+            WARN_CALLOC("accept_thread()");
+            free(client);
+            closesocket(sock);
+            continue;
+        }
+        client->srv  = srv;
+        client->sock = sock;
 
         int err = getnameinfo((struct sockaddr *)&addr, addr_len,
-                host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV);
+                client->host, sizeof(client->host), client->port, sizeof(client->port), NI_NUMERICHOST | NI_NUMERICSERV);
         if (err != 0) {
             print_logf(LOG_ERROR, __func__, "failed to convert address to string (code=%d)", err);
+            free(client->queue);
+            free(client);
             closesocket(sock);
             continue;
         }
-        print_logf(LOG_NOTICE, "rtl_tcp", "client connected from %s port %s", host, port);
+        print_logf(LOG_NOTICE, "rtl_tcp", "client connected from %s port %s", client->host, client->port);
 
+        // the client thread removes and frees the client when done
         pthread_mutex_lock(&srv->lock);
-        srv->client_count += 1;
-        unsigned prev_cnt = srv->data_cnt + 9; // data sent in previous loop, random value to get the current buffer
+        list_push(&srv->clients, client);
         pthread_mutex_unlock(&srv->lock);
 
-        send_header(sock);
-
-        // Client loop
-        for (;;) {
-            // Read available commands
-            int abort = 0;
-            for (;;) {
-                fd_set fds;
-                FD_ZERO(&fds);
-                FD_SET(sock, &fds);
-                struct timeval timeout = {0};
-
-                int ready = select(sock + 1, &fds, NULL, NULL, &timeout);
-                if (ready <= 0)
-                    break;
-
-                uint8_t buf[128] = {0};
-                ssize_t len = recv(sock, buf, sizeof(buf), 0);
-                //print_logf(LOG_TRACE, "rtl_tcp", "recv %zd bytes (%d)", len, ready);
-                if (len <= 0) {
-                    abort = 1;
-                    break;
-                }
-                int pos = 0;
-                while (pos + 5 <= len) {
-                    pos += parse_command(srv->cfg, srv->control, & buf[pos], (int)len - pos);
-                }
-            }
-            if (abort) {
-                break;
-            }
-
-            // Wait for send buffer to clear
-            fd_set fds;
-            FD_ZERO(&fds);
-            FD_SET(sock, &fds);
-            struct timeval timeout = {.tv_usec = 100000}; // Wait at most 100 ms
-
-            int ready = select(sock + 1, NULL, &fds, NULL, &timeout);
-            if (ready <= 0) {
-                print_log(LOG_ERROR, "rtl_tcp", "send not ready for write?");
-                break; // Cancel the connection on network problems
-            }
-
-            // Wait for next frame
+        r = pthread_create(&client->thread, NULL, client_thread, client);
+        if (r) {
+            print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
             pthread_mutex_lock(&srv->lock);
-            while (srv->data_cnt == prev_cnt || srv->data_buf == NULL)
-                pthread_cond_wait(&srv->cond, &srv->lock);
-            // Maybe timeout to check recv()
-            // pthread_cond_timedwait(&srv->cond, &srv->lock, const struct timespec *abstime);
-
-            // Get data buffer reference
-            void const *data = srv->data_buf;
-            int data_len     = srv->data_len;
-            prev_cnt         = srv->data_cnt;
-
+            list_remove(&srv->clients, srv->clients.len - 1, NULL);
             pthread_mutex_unlock(&srv->lock);
-
-            // Send frame
-            send_all(sock, data, data_len, MSG_NOSIGNAL); // ignore SIGPIPE
+            free(client->queue);
+            free(client);
+            closesocket(sock);
+            continue;
         }
-
-        pthread_mutex_lock(&srv->lock);
-        srv->client_count -= 1;
-        pthread_mutex_unlock(&srv->lock);
-
-        print_logf(LOG_NOTICE, "rtl_tcp", "client disconnected from %s port %s", host, port);
-        closesocket(sock);
+        pthread_detach(client->thread);
     }
     return 0;
 }
@@ -466,16 +640,31 @@ static int rtltcp_server_stop(rtltcp_server_t *srv)
 
     print_logf(LOG_NOTICE, "rtl_tcp server", "Stopping rtl_tcp server...");
 
-    // thread is likely blocking in accept, recv, or send
+    // thread is likely blocking in accept
     int r = pthread_cancel(srv->thread);
     if (r) {
         fprintf(stderr, "%s: error in pthread_cancel, rc: %d\n", __func__, r);
     }
+    else {
+        pthread_join(srv->thread, NULL);
+    }
+
+    // client threads are likely blocking in send or waiting for frames
+    pthread_mutex_lock(&srv->lock);
+    srv->exit_clients = 1;
+    for (void **iter = srv->clients.elems; iter && *iter; ++iter) {
+        rtltcp_client_t *client = *iter;
+        shutdown(client->sock, SHUT_RDWR);
+    }
+    pthread_cond_broadcast(&srv->cond);
+    while (srv->clients.len > 0)
+        pthread_cond_wait(&srv->cond, &srv->lock);
+    pthread_mutex_unlock(&srv->lock);
+    list_free_elems(&srv->clients, NULL);
+
     pthread_mutex_destroy(&srv->lock);
     pthread_cond_destroy(&srv->cond);
 
-    srv->client_count = 0;
-
     // close server socket
     int ret = 0;
     if (srv->sock != INVALID_SOCKET) {
@@ -497,9 +686,10 @@ typedef struct raw_output_rtltcp {
     rtltcp_server_t server;
 } raw_output_rtltcp_t;
 
-static void raw_output_rtltcp_frame(raw_output_t *output, uint8_t const *data, uint32_t len)
+static void raw_output_rtltcp_frame(raw_output_t *output, uint8_t const *data, uint32_t len, uint64_t offset)
 {
     raw_output_rtltcp_t *rtltcp = (raw_output_rtltcp_t *)output;
+    UNUSED(offset); // the rtl_tcp stream has no framing
 
     rtltcp_broadcast_send(&rtltcp->server, data, len);
 }
@@ -533,11 +723,47 @@ struct raw_output *raw_output_rtltcp_create(const char *host, const char *port,
     }
 #endif
 
-    // If clients allowed to change SDR parameters
-    if (opts && !strcasecmp(opts, "control"))
-        rtltcp->server.control = 1;
-    else if (opts && *opts) {
-        print_logf(LOG_FATAL, __func__, "Invalid \"%s\" option.", opts);
+    rtltcp->server.depth = RTLTCP_QUEUE_DEPTH;
+
+    char *args = NULL;
+    if (opts) {
+        args = strdup(opts);
+        if (!args) {
+            FATAL_STRDUP("raw_output_rtltcp_create()");
+        }
+    }
+    char *extra = args;
+    char *key, *val;
+    int squelch = 0;
+    char *squelch_padding = NULL;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        // If clients allowed to change SDR parameters
+        else if (!strcasecmp(key, "control"))
+            rtltcp->server.control = 1;
+        else if (!strcasecmp(key, "depth"))
+            rtltcp->server.depth = atouint32_metric(val, "depth= ");
+        else if (!strcasecmp(key, "compress")) {
+            rtltcp->server.compress = rtltcp_codec_parse(val);
+            if (!rtltcp->server.compress) {
+                print_logf(LOG_FATAL, __func__, "Invalid compress=%s option.", val);
+                exit(1);
+            }
+        }
+        else if (!strcasecmp(key, "squelch")) {
+            squelch         = 1;
+            squelch_padding = val;
+        }
+        else {
+            print_logf(LOG_FATAL, __func__, "Invalid \"%s\" option.", key);
+            exit(1);
+        }
+    }
+    if (!rtltcp->server.depth) {
+        print_log(LOG_FATAL, __func__, "Invalid depth=0 option.");
         exit(1);
     }
 
@@ -549,7 +775,12 @@ struct raw_output *raw_output_rtltcp_create(const char *host, const char *port,
         exit(1);
     }
 
-    return (struct raw_output *)rtltcp;
+    struct raw_output *output = (struct raw_output *)rtltcp;
+    if (squelch)
+        output = raw_output_squelch_create(output, squelch_padding, cfg);
+    free(args);
+
+    return output;
 }
 
 #else
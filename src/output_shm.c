@@ -0,0 +1,182 @@
+/** @file
+    Shared memory ring output for rtl_433 raw data.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_shm.h"
+
+#include "rtl_433.h"
+#include "r_private.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32) && !defined(ESP32)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// readers on other cores need to see the data before the updated positions
+#if defined(__GNUC__) || defined(__clang__)
+#define SHM_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define SHM_FENCE() __sync_synchronize()
+#else
+#define SHM_STORE(p, v) (*(p) = (v))
+#define SHM_FENCE()
+#endif
+
+typedef struct raw_output_shm {
+    struct raw_output output;
+    char *name;
+    shm_header_t *hdr;
+    uint8_t *ring;
+    size_t map_size;
+    uint32_t offset; ///< offset in the ring for the next frame
+    uint64_t seq;    ///< seq of the latest frame
+    int oversize;    ///< a frame larger than the ring was skipped
+    r_cfg_t *cfg;
+} raw_output_shm_t;
+
+static void raw_output_shm_frame(raw_output_t *output, uint8_t const *data, uint32_t len, uint64_t offset)
+{
+    raw_output_shm_t *shm = (raw_output_shm_t *)output;
+    shm_header_t *hdr     = shm->hdr;
+
+    if (len > hdr->ring_size) {
+        if (!shm->oversize)
+            print_logf(LOG_WARNING, "SHM", "Frame of %u bytes is larger than the ring, skipped.", len);
+        shm->oversize = 1;
+        return;
+    }
+
+    // never split a frame at the end of the ring
+    uint64_t pos = hdr->write_begin;
+    if (shm->offset + len > hdr->ring_size) {
+        pos += hdr->ring_size - shm->offset;
+        shm->offset = 0;
+    }
+    // readers check this after using a frame, mark the bytes as overwritten first
+    SHM_STORE(&hdr->write_begin, pos + len);
+    SHM_FENCE();
+
+    memcpy(shm->ring + shm->offset, data, len);
+
+    shm->seq += 1;
+    shm_frame_t *frame      = &hdr->frames[shm->seq % SHM_FRAME_SLOTS];
+    frame->seq              = 0; // invalid while updating
+    SHM_FENCE();
+    frame->pos              = pos;
+    frame->offset           = shm->offset;
+    frame->len              = len;
+    frame->sample_offset    = offset;
+    frame->center_frequency = shm->cfg->center_frequency;
+    frame->sample_rate      = shm->cfg->samp_rate;
+    SHM_STORE(&frame->seq, shm->seq);
+    hdr->sample_size = shm->cfg->demod ? (uint32_t)shm->cfg->demod->sample_size : 0;
+    SHM_STORE(&hdr->frame_seq, shm->seq);
+
+    shm->offset += len;
+}
+
+static void raw_output_shm_free(raw_output_t *output)
+{
+    raw_output_shm_t *shm = (raw_output_shm_t *)output;
+
+    if (!shm)
+        return;
+
+    // attached readers keep their mapping, new readers won't find the name
+    munmap(shm->hdr, shm->map_size);
+    shm_unlink(shm->name);
+    free(shm->name);
+    free(shm);
+}
+
+struct raw_output *raw_output_shm_create(char const *name, unsigned ring_size, r_cfg_t *cfg)
+{
+    raw_output_shm_t *shm = calloc(1, sizeof(raw_output_shm_t));
+    if (!shm) {
+        WARN_CALLOC("raw_output_shm_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    if (!name || !*name)
+        name = SHM_DEFAULT_NAME;
+    if (!ring_size)
+        ring_size = SHM_RING_SIZE;
+
+    // the name needs a leading slash
+    shm->name = malloc(strlen(name) + 2);
+    if (!shm->name) {
+        WARN_MALLOC("raw_output_shm_create()");
+        free(shm);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    snprintf(shm->name, strlen(name) + 2, "%s%s", *name == '/' ? "" : "/", name);
+
+    size_t header_size = (sizeof(shm_header_t) + 4095) & ~(size_t)4095; // page align the ring
+    shm->map_size      = header_size + ring_size;
+
+    int fd = shm_open(shm->name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        print_logf(LOG_FATAL, "SHM", "Failed to open shared memory \"%s\": %s", shm->name, strerror(errno));
+        exit(1);
+    }
+    if (ftruncate(fd, (off_t)shm->map_size) < 0) {
+        print_logf(LOG_FATAL, "SHM", "Failed to size shared memory \"%s\": %s", shm->name, strerror(errno));
+        exit(1);
+    }
+    void *map = mmap(NULL, shm->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        print_logf(LOG_FATAL, "SHM", "Failed to map shared memory \"%s\": %s", shm->name, strerror(errno));
+        exit(1);
+    }
+
+    shm->hdr  = map;
+    shm->ring = (uint8_t *)map + header_size;
+    shm->cfg  = cfg;
+
+    // a previous writer might have left the object, start over
+    memset(shm->hdr, 0, sizeof(shm_header_t));
+    shm->hdr->version     = SHM_VERSION;
+    shm->hdr->header_size = (uint32_t)header_size;
+    shm->hdr->ring_size   = ring_size;
+    shm->hdr->frame_slots = SHM_FRAME_SLOTS;
+    shm->hdr->pid         = (uint32_t)getpid();
+    SHM_FENCE();
+    memcpy(shm->hdr->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+
+    shm->output.output_frame = raw_output_shm_frame;
+    shm->output.output_free  = raw_output_shm_free;
+
+    print_logf(LOG_CRITICAL, "SHM", "Publishing I/Q frames to shared memory \"%s\" with a %u byte ring", shm->name, ring_size);
+
+    return (struct raw_output *)shm;
+}
+
+#else
+
+struct raw_output *raw_output_shm_create(char const *name, unsigned ring_size, r_cfg_t *cfg)
+{
+    UNUSED(name);
+    UNUSED(ring_size);
+    UNUSED(cfg);
+    print_log(LOG_ERROR, "SHM", "shm output not available in this build!");
+    return NULL;
+}
+
+#endif
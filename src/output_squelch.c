@@ -0,0 +1,195 @@
+/** @file
+    Squelch for raw outputs, only passes frames around activity.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_squelch.h"
+
+#include "rtl_433.h"
+#include "r_private.h"
+#include "baseband.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct squelch_frame {
+    uint8_t *data;
+    uint32_t size; ///< allocated bytes
+    uint32_t len;
+    uint64_t offset;
+} squelch_frame_t;
+
+typedef struct raw_output_squelch {
+    struct raw_output output;
+    struct raw_output *inner;
+    r_cfg_t *cfg;
+
+    unsigned pre;           ///< frames passed before activity
+    unsigned post;          ///< frames passed after activity
+    squelch_frame_t *ring;  ///< the last pre silent frames
+    unsigned ring_head;     ///< oldest frame in the ring
+    unsigned ring_len;
+    unsigned post_left;     ///< frames still to pass after activity
+
+    unsigned long frames_passed;
+    unsigned long frames_skipped;
+} raw_output_squelch_t;
+
+static int squelch_frame_active(r_cfg_t *cfg, uint8_t const *data, uint32_t len)
+{
+    struct dm_state *demod = cfg->demod;
+
+    // pass everything until the noise level is known, and for formats without a level estimate
+    if (!demod || demod->noise_level == 0.0f || !demod->sample_size)
+        return 1;
+
+    uint32_t n_samples = len / demod->sample_size;
+    float est_db;
+    if (demod->sample_format == BASEBAND_CU8 && !demod->use_mag_est)
+        est_db = envelope_level_strided(data, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else if (demod->sample_format == BASEBAND_CU8)
+        est_db = magnitude_level_strided_cu8(data, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else if (demod->sample_format == BASEBAND_CS16)
+        est_db = magnitude_level_strided_cs16((int16_t const *)data, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else
+        return 1;
+
+    return est_db >= demod->noise_level + 3.0f - SQUELCH_PREFILTER_MARGIN;
+}
+
+static void squelch_keep(raw_output_squelch_t *squelch, uint8_t const *data, uint32_t len, uint64_t offset)
+{
+    if (!squelch->pre) {
+        squelch->frames_skipped += 1;
+        return;
+    }
+
+    squelch_frame_t *frame;
+    if (squelch->ring_len == squelch->pre) {
+        // the oldest frame is skipped and its buffer reused
+        frame = &squelch->ring[squelch->ring_head];
+        squelch->ring_head = (squelch->ring_head + 1) % squelch->pre;
+        squelch->frames_skipped += 1;
+    }
+    else {
+        frame = &squelch->ring[(squelch->ring_head + squelch->ring_len) % squelch->pre];
+        squelch->ring_len += 1;
+    }
+
+    if (frame->size < len) {
+        uint8_t *buf = realloc(frame->data, len);
+        if (!buf) {
+            WARN_REALLOC("squelch_keep()");
+            // skip the frame
+            squelch->ring_len -= 1;
+            squelch->frames_skipped += 1;
+            return;
+        }
+        frame->data = buf;
+        frame->size = len;
+    }
+    memcpy(frame->data, data, len);
+    frame->len    = len;
+    frame->offset = offset;
+}
+
+static void raw_output_squelch_frame(raw_output_t *output, uint8_t const *data, uint32_t len, uint64_t offset)
+{
+    raw_output_squelch_t *squelch = (raw_output_squelch_t *)output;
+
+    if (!squelch_frame_active(squelch->cfg, data, len)) {
+        if (squelch->post_left) {
+            squelch->post_left -= 1;
+            squelch->frames_passed += 1;
+            raw_output_frame(squelch->inner, data, len, offset);
+        }
+        else {
+            squelch_keep(squelch, data, len, offset);
+        }
+        return;
+    }
+
+    // pass the frames before the activity
+    for (; squelch->ring_len; --squelch->ring_len) {
+        squelch_frame_t *frame = &squelch->ring[squelch->ring_head];
+        squelch->ring_head     = (squelch->ring_head + 1) % squelch->pre;
+        squelch->frames_passed += 1;
+        raw_output_frame(squelch->inner, frame->data, frame->len, frame->offset);
+    }
+    squelch->ring_head = 0;
+
+    squelch->post_left = squelch->post;
+    squelch->frames_passed += 1;
+    raw_output_frame(squelch->inner, data, len, offset);
+}
+
+static void raw_output_squelch_free(raw_output_t *output)
+{
+    raw_output_squelch_t *squelch = (raw_output_squelch_t *)output;
+
+    if (!squelch)
+        return;
+
+    print_logf(LOG_NOTICE, "Squelch", "Passed %lu of %lu raw frames.",
+            squelch->frames_passed, squelch->frames_passed + squelch->frames_skipped + squelch->ring_len);
+
+    raw_output_free(squelch->inner);
+    for (unsigned i = 0; i < squelch->pre; ++i) {
+        free(squelch->ring[i].data);
+    }
+    free(squelch->ring);
+    free(squelch);
+}
+
+struct raw_output *raw_output_squelch_create(struct raw_output *output, char const *padding, r_cfg_t *cfg)
+{
+    if (!output)
+        return NULL;
+
+    unsigned pre  = SQUELCH_PRE_FRAMES;
+    unsigned post = SQUELCH_POST_FRAMES;
+    if (padding && *padding) {
+        char *endptr;
+        pre = strtoul(padding, &endptr, 10);
+        if (*endptr == ':')
+            post = strtoul(endptr + 1, &endptr, 10);
+        if (*endptr) {
+            print_logf(LOG_FATAL, "Squelch", "Invalid squelch padding \"%s\", use squelch=<pre>:<post>", padding);
+            raw_output_free(output);
+            exit(1);
+        }
+    }
+
+    raw_output_squelch_t *squelch = calloc(1, sizeof(raw_output_squelch_t));
+    if (!squelch) {
+        WARN_CALLOC("raw_output_squelch_create()");
+        return output; // NOTE: passes all frames on alloc failure.
+    }
+    if (pre) {
+        squelch->ring = calloc(pre, sizeof(*squelch->ring));
+        if (!squelch->ring) {
+            WARN_CALLOC("raw_output_squelch_create()");
+            free(squelch);
+            return output; // NOTE: passes all frames on alloc failure.
+        }
+    }
+
+    squelch->output.output_frame = raw_output_squelch_frame;
+    squelch->output.output_free  = raw_output_squelch_free;
+    squelch->inner               = output;
+    squelch->cfg                 = cfg;
+    squelch->pre                 = pre;
+    squelch->post                = post;
+
+    print_logf(LOG_NOTICE, "Squelch", "Passing raw frames with activity, %u before and %u after", pre, post);
+
+    return (struct raw_output *)squelch;
+}
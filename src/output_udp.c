@@ -16,6 +16,7 @@
 #include "r_util.h"
 #include "logger.h"
 #include "fatal.h"
+#include "compat_time.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -82,6 +83,12 @@ typedef struct {
     struct sockaddr_storage addr;
     socklen_t addr_len;
     SOCKET sock;
+    datagram_batch_t batch;
+    unsigned count;       ///< number of queued messages
+    uint64_t since_ns;    ///< time the oldest message was queued
+    size_t buf_len;
+    char *buf;            ///< the queued messages, each at most DATAGRAM_MESSAGE_MAX bytes
+    size_t offset[DATAGRAM_BATCH_MAX + 1];
 } datagram_client_t;
 
 static int datagram_client_open(datagram_client_t *client, const char *host, const char *port)
@@ -131,11 +138,17 @@ static int datagram_client_open(datagram_client_t *client, const char *host, con
     return 0;
 }
 
+static void datagram_client_flush(datagram_client_t *client);
+
 static void datagram_client_close(datagram_client_t *client)
 {
     if (!client)
         return;
 
+    datagram_client_flush(client);
+    free(client->buf);
+    client->buf = NULL;
+
     if (client->sock != INVALID_SOCKET) {
         closesocket(client->sock);
         client->sock = INVALID_SOCKET;
@@ -154,12 +167,100 @@ static void datagram_client_send(datagram_client_t *client, const char *message,
     }
 }
 
+/// Queue messages to be sent in batches, sends each message at once if not set.
+static void datagram_client_batch(datagram_client_t *client, datagram_batch_t const *batch)
+{
+    if (!batch || batch->messages <= 1)
+        return;
+
+    client->buf = malloc(DATAGRAM_BATCH_MAX * DATAGRAM_MESSAGE_MAX);
+    if (!client->buf) {
+        WARN_MALLOC("datagram_client_batch()");
+        return; // NOTE: sends each message at once on alloc failure.
+    }
+    client->batch = *batch;
+    if (client->batch.messages > DATAGRAM_BATCH_MAX)
+        client->batch.messages = DATAGRAM_BATCH_MAX;
+}
+
+static void datagram_client_flush(datagram_client_t *client)
+{
+    if (!client->count)
+        return;
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+    // one syscall for the whole batch
+    struct mmsghdr msgs[DATAGRAM_BATCH_MAX];
+    struct iovec iov[DATAGRAM_BATCH_MAX];
+    memset(msgs, 0, sizeof(msgs));
+    for (unsigned i = 0; i < client->count; ++i) {
+        iov[i].iov_base                = &client->buf[client->offset[i]];
+        iov[i].iov_len                 = client->offset[i + 1] - client->offset[i];
+        msgs[i].msg_hdr.msg_iov        = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen     = 1;
+        msgs[i].msg_hdr.msg_name       = &client->addr;
+        msgs[i].msg_hdr.msg_namelen    = client->addr_len;
+    }
+    unsigned sent = 0;
+    while (sent < client->count) {
+        int r = sendmmsg(client->sock, &msgs[sent], client->count - sent, 0);
+        if (r == -1 && errno == EINTR)
+            continue;
+        if (r == -1) {
+            perror("sendmmsg");
+            break;
+        }
+        sent += r;
+    }
+#else
+    for (unsigned i = 0; i < client->count; ++i) {
+        datagram_client_send(client, &client->buf[client->offset[i]], client->offset[i + 1] - client->offset[i]);
+    }
+#endif
+
+    client->count   = 0;
+    client->buf_len = 0;
+}
+
+/// Send a message, or queue it until the batch is full or the oldest message waited long enough.
+static void datagram_client_queue(datagram_client_t *client, const char *message, size_t message_len)
+{
+    if (!client->buf || message_len > DATAGRAM_MESSAGE_MAX) {
+        datagram_client_flush(client); // keep the order
+        datagram_client_send(client, message, message_len);
+        return;
+    }
+
+    uint64_t now_ns = time_monotonic_ns();
+    if (!client->count)
+        client->since_ns = now_ns;
+    memcpy(&client->buf[client->buf_len], message, message_len);
+    client->offset[client->count] = client->buf_len;
+    client->buf_len += message_len;
+    client->count += 1;
+    client->offset[client->count] = client->buf_len;
+
+    if (client->count >= client->batch.messages
+            || (client->batch.interval_ms && now_ns - client->since_ns >= (uint64_t)client->batch.interval_ms * 1000000)) {
+        datagram_client_flush(client);
+    }
+}
+
+/// Send the queued messages if the oldest waited long enough.
+static void datagram_client_poll(datagram_client_t *client)
+{
+    if (client->count && time_monotonic_ns() - client->since_ns >= (uint64_t)client->batch.interval_ms * 1000000) {
+        datagram_client_flush(client);
+    }
+}
+
 /* Syslog UDP printer, RFC 5424 (IETF-syslog protocol) */
 
 typedef struct {
     struct data_output output;
     datagram_client_t client;
     int pri;
+    int raw; ///< send the JSON without the syslog header
     char hostname[_POSIX_HOST_NAME_MAX + 1];
 } data_output_syslog_t;
 
@@ -184,14 +285,26 @@ static void R_API_CALLCONV data_output_syslog_print(data_output_t *output, data_
     char timestamp[21];
     strftime(timestamp, 21, "%Y-%m-%dT%H:%M:%SZ", &tm_info);
 
-    abuf_printf(&msg, "<%d>1 %s %s rtl_433 - - - ", syslog->pri, timestamp, syslog->hostname);
+    if (!syslog->raw) {
+        abuf_printf(&msg, "<%d>1 %s %s rtl_433 - - - ", syslog->pri, timestamp, syslog->hostname);
+    }
 
-    msg.tail += data_print_jsons(data, msg.tail, msg.left);
-    if (msg.tail >= msg.head + sizeof(message))
+    size_t len;
+    char const *json = data_output_jsons(output, data, &len);
+    if (!json || len >= msg.left)
         return; // abort on overflow, we don't actually want to send more than fits the MTU
+    memcpy(msg.tail, json, len);
+    msg.tail += len;
 
     size_t abuf_len = msg.tail - msg.head;
-    datagram_client_send(&syslog->client, message, abuf_len);
+    datagram_client_queue(&syslog->client, message, abuf_len);
+}
+
+static void R_API_CALLCONV data_output_syslog_poll(data_output_t *output)
+{
+    data_output_syslog_t *syslog = (data_output_syslog_t *)output;
+
+    datagram_client_poll(&syslog->client);
 }
 
 static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
@@ -206,7 +319,7 @@ static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
     free(syslog);
 }
 
-struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port)
+struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port, int raw, datagram_batch_t const *batch)
 {
     data_output_syslog_t *syslog = calloc(1, sizeof(data_output_syslog_t));
     if (!syslog) {
@@ -225,7 +338,9 @@ struct data_output *data_output_syslog_create(int log_level, const char *host, c
 
     syslog->output.log_level    = log_level;
     syslog->output.output_print = data_output_syslog_print;
+    syslog->output.output_poll  = data_output_syslog_poll;
     syslog->output.output_free  = data_output_syslog_free;
+    syslog->raw                 = raw;
     // Severity 5 "Notice", Facility 20 "local use 4"
     syslog->pri = 20 * 8 + 5;
     #ifdef ESP32
@@ -242,6 +357,66 @@ struct data_output *data_output_syslog_create(int log_level, const char *host, c
     #endif
     syslog->hostname[_POSIX_HOST_NAME_MAX] = '\0';
     datagram_client_open(&syslog->client, host, port);
+    datagram_client_batch(&syslog->client, batch);
 
     return (struct data_output *)syslog;
 }
+
+/* Binary UDP printer, one standalone CBOR or MessagePack map in each datagram */
+
+typedef struct {
+    struct data_output output;
+    datagram_client_t client;
+    binary_format_t format;
+} data_output_binary_udp_t;
+
+static void R_API_CALLCONV data_output_binary_udp_print(data_output_t *output, data_t *data)
+{
+    data_output_binary_udp_t *udp = (data_output_binary_udp_t *)output;
+
+    // a datagram that fits an Ethernet MTU, larger events are dropped
+    uint8_t message[1472];
+    size_t len = data_encode_binary(udp->format, data, message, sizeof(message));
+    if (!len)
+        return;
+
+    datagram_client_send(&udp->client, (char const *)message, len);
+}
+
+static void R_API_CALLCONV data_output_binary_udp_free(data_output_t *output)
+{
+    data_output_binary_udp_t *udp = (data_output_binary_udp_t *)output;
+
+    if (!udp)
+        return;
+
+    datagram_client_close(&udp->client);
+
+    free(udp);
+}
+
+struct data_output *data_output_binary_udp_create(binary_format_t format, int log_level, const char *host, const char *port)
+{
+    data_output_binary_udp_t *udp = calloc(1, sizeof(data_output_binary_udp_t));
+    if (!udp) {
+        WARN_CALLOC("data_output_binary_udp_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+#ifdef _WIN32
+    WSADATA wsa;
+
+    if (WSAStartup(MAKEWORD(2,2),&wsa) != 0) {
+        perror("WSAStartup()");
+        free(udp);
+        return NULL;
+    }
+#endif
+
+    udp->output.log_level    = log_level;
+    udp->output.output_print = data_output_binary_udp_print;
+    udp->output.output_free  = data_output_binary_udp_free;
+    udp->format              = format;
+    datagram_client_open(&udp->client, host, port);
+
+    return (struct data_output *)udp;
+}
@@ -0,0 +1,286 @@
+/** @file
+    Unix domain socket output for rtl_433 events.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_unix.h"
+
+#include "data.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32) && !defined(ESP32)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stddef.h>
+
+// MSG_NOSIGNAL is Linux and most BSDs only, not macOS
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef struct {
+    int fd;                    ///< the connection with seqpacket, -1 with dgram
+    struct sockaddr_un addr;   ///< the address of the subscriber with dgram
+    socklen_t addr_len;
+    unsigned id;               ///< number of the subscriber, for the log
+    unsigned sent;             ///< events sent
+    unsigned dropped;          ///< events dropped because the subscriber did not keep up
+    unsigned reported;         ///< dropped count already reported
+} unix_client_t;
+
+typedef struct {
+    struct data_output output;
+    char *path;
+    int fd;                    ///< the listening socket with seqpacket, the bound socket with dgram
+    int dgram;
+    unsigned max_clients;
+    unsigned num_clients;
+    unsigned next_id;
+    unix_client_t *clients;
+} data_output_unix_t;
+
+static void unix_client_remove(data_output_unix_t *unx, unsigned i, char const *reason)
+{
+    unix_client_t *client = &unx->clients[i];
+    print_logf(LOG_NOTICE, "Unix socket", "subscriber %u %s, sent %u events, dropped %u events", client->id, reason, client->sent, client->dropped);
+    if (client->fd >= 0)
+        close(client->fd);
+    unx->num_clients -= 1;
+    unx->clients[i] = unx->clients[unx->num_clients];
+}
+
+static void unix_client_add(data_output_unix_t *unx, int fd, struct sockaddr_un const *addr, socklen_t addr_len)
+{
+    if (unx->num_clients >= unx->max_clients) {
+        print_logf(LOG_WARNING, "Unix socket", "Too many subscribers (%u), refused", unx->max_clients);
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+    unix_client_t *client = &unx->clients[unx->num_clients++];
+    *client               = (unix_client_t){.fd = fd, .id = ++unx->next_id};
+    if (addr) {
+        client->addr     = *addr;
+        client->addr_len = addr_len;
+    }
+    print_logf(LOG_NOTICE, "Unix socket", "subscriber %u joined%s%s", client->id, addr ? " from " : "", addr ? addr->sun_path : "");
+}
+
+/// Take the new subscribers, and drop the subscribers that hung up, never waits.
+static void unix_accept(data_output_unix_t *unx)
+{
+    if (!unx->dgram) {
+        int fd;
+        while ((fd = accept(unx->fd, NULL, NULL)) >= 0) {
+#ifdef SO_NOSIGPIPE
+            int opt = 1;
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt));
+#endif
+            unix_client_add(unx, fd, NULL, 0);
+        }
+        // a subscriber has nothing to say, a read is a hang up
+        for (unsigned i = 0; i < unx->num_clients;) {
+            char buf[64];
+            ssize_t ret = recv(unx->clients[i].fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                unix_client_remove(unx, i, "left");
+            else
+                i++;
+        }
+        return;
+    }
+
+    // a datagram from a bound socket subscribes its address
+    for (;;) {
+        char buf[64];
+        struct sockaddr_un addr;
+        socklen_t addr_len = sizeof(addr);
+        memset(&addr, 0, sizeof(addr));
+        ssize_t ret = recvfrom(unx->fd, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr *)&addr, &addr_len);
+        if (ret < 0)
+            break;
+        if (addr_len <= offsetof(struct sockaddr_un, sun_path)) {
+            print_log(LOG_WARNING, "Unix socket", "A subscriber needs to bind its socket, ignored");
+            continue;
+        }
+        unsigned i = 0;
+        while (i < unx->num_clients && (unx->clients[i].addr_len != addr_len || memcmp(&unx->clients[i].addr, &addr, addr_len)))
+            i++;
+        if (i == unx->num_clients)
+            unix_client_add(unx, -1, &addr, addr_len);
+    }
+}
+
+static void unix_send(data_output_unix_t *unx, char const *msg, size_t len)
+{
+    for (unsigned i = 0; i < unx->num_clients;) {
+        unix_client_t *client = &unx->clients[i];
+        ssize_t ret;
+        do {
+            if (unx->dgram)
+                ret = sendto(unx->fd, msg, len, MSG_DONTWAIT | MSG_NOSIGNAL, (struct sockaddr *)&client->addr, client->addr_len);
+            else
+                ret = send(client->fd, msg, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret >= 0) {
+            client->sent += 1;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS || errno == EMSGSIZE) {
+            client->dropped += 1;
+        }
+        else {
+            unix_client_remove(unx, i, "left");
+            continue;
+        }
+        i++;
+    }
+}
+
+static void R_API_CALLCONV data_output_unix_print(data_output_t *output, data_t *data)
+{
+    data_output_unix_t *unx = (data_output_unix_t *)output;
+
+    unix_accept(unx);
+    if (!unx->num_clients)
+        return;
+
+    size_t len;
+    char const *json = data_output_jsons(output, data, &len);
+    if (!json)
+        return;
+    unix_send(unx, json, len);
+}
+
+static void R_API_CALLCONV data_output_unix_poll(data_output_t *output)
+{
+    data_output_unix_t *unx = (data_output_unix_t *)output;
+
+    unix_accept(unx);
+    for (unsigned i = 0; i < unx->num_clients; ++i) {
+        unix_client_t *client = &unx->clients[i];
+        if (client->dropped > client->reported) {
+            print_logf(LOG_WARNING, "Unix socket", "subscriber %u too slow, dropped %u events", client->id, client->dropped - client->reported);
+        }
+        client->reported = client->dropped;
+    }
+}
+
+static void R_API_CALLCONV data_output_unix_free(data_output_t *output)
+{
+    data_output_unix_t *unx = (data_output_unix_t *)output;
+
+    if (!unx)
+        return;
+
+    while (unx->num_clients) {
+        unix_client_remove(unx, unx->num_clients - 1, "closed");
+    }
+    if (unx->fd >= 0) {
+        close(unx->fd);
+        unlink(unx->path);
+    }
+    free(unx->clients);
+    free(unx->path);
+    free(unx);
+}
+
+struct data_output *data_output_unix_create(int log_level, char const *path, int dgram, unsigned max_clients)
+{
+    if (!path || !*path)
+        path = UNIX_DEFAULT_PATH;
+    if (!max_clients)
+        max_clients = UNIX_DEFAULT_CLIENTS;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        print_logf(LOG_FATAL, "Unix socket", "The path \"%s\" is too long", path);
+        exit(1);
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    data_output_unix_t *unx = calloc(1, sizeof(data_output_unix_t));
+    if (!unx) {
+        WARN_CALLOC("data_output_unix_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    unx->clients = calloc(max_clients, sizeof(*unx->clients));
+    if (!unx->clients) {
+        WARN_CALLOC("data_output_unix_create()");
+        free(unx);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    unx->path = strdup(path);
+    if (!unx->path) {
+        WARN_STRDUP("data_output_unix_create()");
+        free(unx->clients);
+        free(unx);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    unx->dgram       = dgram;
+    unx->max_clients = max_clients;
+
+    // a previous run might have left the socket, but don't replace any other file
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    unx->fd = socket(AF_UNIX, dgram ? SOCK_DGRAM : SOCK_SEQPACKET, 0);
+    if (unx->fd < 0) {
+        print_logf(LOG_FATAL, "Unix socket", "Failed to create a %s socket: %s", dgram ? "dgram" : "seqpacket", strerror(errno));
+        exit(1);
+    }
+    if (bind(unx->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        print_logf(LOG_FATAL, "Unix socket", "Failed to bind \"%s\": %s", path, strerror(errno));
+        exit(1);
+    }
+    if (!dgram && listen(unx->fd, 8) < 0) {
+        print_logf(LOG_FATAL, "Unix socket", "Failed to listen on \"%s\": %s", path, strerror(errno));
+        exit(1);
+    }
+    // the subscribers are taken on each event and timer, never wait for one
+    fcntl(unx->fd, F_SETFL, fcntl(unx->fd, F_GETFL) | O_NONBLOCK);
+
+    unx->output.log_level    = log_level;
+    unx->output.output_print = data_output_unix_print;
+    unx->output.output_poll  = data_output_unix_poll;
+    unx->output.output_free  = data_output_unix_free;
+
+    print_logf(LOG_CRITICAL, "Unix socket", "Sending events to up to %u subscribers of \"%s\" (%s)", max_clients, path, dgram ? "dgram" : "seqpacket");
+
+    return (struct data_output *)unx;
+}
+
+#else
+
+struct data_output *data_output_unix_create(int log_level, char const *path, int dgram, unsigned max_clients)
+{
+    UNUSED(log_level);
+    UNUSED(path);
+    UNUSED(dgram);
+    UNUSED(max_clients);
+    print_log(LOG_ERROR, "Unix socket", "unix output not available in this build!");
+    return NULL;
+}
+
+#endif
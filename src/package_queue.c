@@ -0,0 +1,366 @@
+/** @file
+    Pipelined queue of the detected packages to decode.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "package_queue.h"
+
+#include "data.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "thread_sched.h"
+
+#include <stdlib.h>
+#include <signal.h>
+
+#ifdef THREADS
+
+struct package_output {
+    package_output_t *next;
+    data_t *data;
+    int level;
+};
+
+struct package_queue {
+    package_decode_fn decode;
+    package_deliver_fn deliver;
+    package_retire_fn retire;
+    void *ctx;
+
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the counters and the current packages
+    pthread_cond_t cond;  ///< signals pushed and decoded packages and state changes
+
+    package_t *slots;     ///< the package of sequence number n is in slot n & mask
+    unsigned mask;        ///< number of slots minus one
+    unsigned size;        ///< number of packages pushed and not retired at most
+    unsigned pushed;      ///< sequence number of the next package pushed
+    unsigned decoded;     ///< sequence number of the next package to decode
+    unsigned retired;     ///< sequence number of the next package to retire
+    package_t *current;   ///< the package on the decode thread, NULL if none
+    package_t *retiring;  ///< the package being retired, NULL if none
+    pthread_t retire_thread; ///< the thread retiring, valid with retiring
+    int exit_thread;      ///< request the thread to exit
+};
+
+static THREAD_RETURN THREAD_CALL package_queue_run(void *arg)
+{
+    package_queue_t *queue = arg;
+    thread_sched_apply(THREAD_ROLE_WORKER);
+
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->exit_thread) {
+        if (queue->decoded == queue->pushed) {
+            pthread_cond_wait(&queue->cond, &queue->lock);
+            continue;
+        }
+        queue->current = &queue->slots[queue->decoded & queue->mask];
+        pthread_mutex_unlock(&queue->lock);
+
+        queue->decode(queue->current, queue->ctx);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->current = NULL;
+        queue->decoded += 1;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return (THREAD_RETURN)(0);
+}
+
+static void free_output(package_t *package)
+{
+    package_output_t *out = package->output;
+    while (out) {
+        package_output_t *next = out->next;
+        data_free(out->data);
+        free(out);
+        out = next;
+    }
+    package->output      = NULL;
+    package->output_tail = NULL;
+}
+
+package_queue_t *package_queue_create(unsigned size, package_decode_fn decode, package_deliver_fn deliver, package_retire_fn retire, void *ctx)
+{
+    unsigned slots = 1;
+    while (slots < size) {
+        slots *= 2;
+    }
+
+    package_queue_t *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        WARN_CALLOC("package_queue_create()");
+        return NULL;
+    }
+    queue->slots = calloc(slots, sizeof(*queue->slots));
+    if (!queue->slots) {
+        WARN_CALLOC("package_queue_create()");
+        free(queue);
+        return NULL;
+    }
+    queue->mask    = slots - 1;
+    queue->size    = size ? size : 1;
+    queue->decode  = decode;
+    queue->deliver = deliver;
+    queue->retire  = retire;
+    queue->ctx     = ctx;
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+
+#ifndef _WIN32
+    // Block all signals from the worker thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&queue->thread, NULL, package_queue_run, queue);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+        pthread_mutex_destroy(&queue->lock);
+        pthread_cond_destroy(&queue->cond);
+        free(queue->slots);
+        free(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+void package_queue_free(package_queue_t *queue)
+{
+    if (!queue)
+        return;
+
+    pthread_mutex_lock(&queue->lock);
+    queue->exit_thread = 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+
+    pthread_join(queue->thread, NULL);
+
+    for (unsigned i = 0; i <= queue->mask; ++i) {
+        free_output(&queue->slots[i]);
+        pulse_data_free(&queue->slots[i].pulses);
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->cond);
+    free(queue->slots);
+    free(queue);
+}
+
+// retires the oldest package, returns 0 if there is none or it is not decoded yet and not waited for
+static int retire_next(package_queue_t *queue, int wait)
+{
+    pthread_mutex_lock(&queue->lock);
+    while (wait && queue->retired != queue->pushed && queue->retired == queue->decoded) {
+        pthread_cond_wait(&queue->cond, &queue->lock);
+    }
+    if (queue->retired == queue->decoded) {
+        pthread_mutex_unlock(&queue->lock);
+        return 0;
+    }
+    package_t *package     = &queue->slots[queue->retired & queue->mask];
+    queue->retiring        = package;
+    queue->retire_thread   = pthread_self();
+    pthread_mutex_unlock(&queue->lock);
+
+    // the output is delivered in the order the decoders kept it
+    package_output_t *out = package->output;
+    package->output       = NULL;
+    package->output_tail  = NULL;
+    while (out) {
+        package_output_t *next = out->next;
+        queue->deliver(out->data, out->level, queue->ctx);
+        free(out);
+        out = next;
+    }
+    queue->retire(package, queue->ctx);
+
+    pthread_mutex_lock(&queue->lock);
+    queue->retiring = NULL;
+    queue->retired += 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+package_t *package_queue_reserve(package_queue_t *queue)
+{
+    while (retire_next(queue, 0)) {
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    int full = queue->pushed - queue->retired >= queue->size;
+    pthread_mutex_unlock(&queue->lock);
+    if (full) {
+        retire_next(queue, 1);
+    }
+
+    // only the caller pushes, the slot stays free
+    pthread_mutex_lock(&queue->lock);
+    package_t *package = &queue->slots[queue->pushed & queue->mask];
+    pthread_mutex_unlock(&queue->lock);
+
+    package->events         = 0;
+    package->decode_ns      = 0;
+    package->budget_skipped = 0;
+    return package;
+}
+
+void package_queue_push(package_queue_t *queue, package_t *package)
+{
+    pthread_mutex_lock(&queue->lock);
+    package->seq   = queue->pushed;
+    queue->pushed += 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void package_queue_retire(package_queue_t *queue, int wait)
+{
+    if (!queue)
+        return;
+
+    while (retire_next(queue, wait)) {
+    }
+}
+
+package_t const *package_queue_current(package_queue_t *queue)
+{
+    if (!queue)
+        return NULL;
+
+    pthread_t self     = pthread_self();
+    package_t *package = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->current && pthread_equal(queue->thread, self))
+        package = queue->current;
+    else if (queue->retiring && pthread_equal(queue->retire_thread, self))
+        package = queue->retiring;
+    pthread_mutex_unlock(&queue->lock);
+    return package;
+}
+
+package_t const *package_queue_oldest(package_queue_t *queue)
+{
+    if (!queue)
+        return NULL;
+
+    pthread_mutex_lock(&queue->lock);
+    package_t *package = queue->retired != queue->pushed ? &queue->slots[queue->retired & queue->mask] : NULL;
+    pthread_mutex_unlock(&queue->lock);
+    return package;
+}
+
+package_t const *package_queue_decoding(package_queue_t *queue)
+{
+    if (!queue)
+        return NULL;
+
+    pthread_mutex_lock(&queue->lock);
+    package_t *package = queue->current;
+    pthread_mutex_unlock(&queue->lock);
+    return package;
+}
+
+int package_queue_keep_output(package_queue_t *queue, data_t *data, int level)
+{
+    // the current package is only changed by the decode thread itself
+    if (!queue || !pthread_equal(queue->thread, pthread_self()) || !queue->current)
+        return 0;
+
+    package_output_t *out = malloc(sizeof(*out));
+    if (!out) {
+        WARN_MALLOC("package_queue_keep_output()");
+        data_free(data);
+        return 1;
+    }
+    out->next  = NULL;
+    out->data  = data;
+    out->level = level;
+
+    package_t *package = queue->current;
+    if (package->output_tail)
+        package->output_tail->next = out;
+    else
+        package->output = out;
+    package->output_tail = out;
+    return 1;
+}
+
+#else
+
+package_queue_t *package_queue_create(unsigned size, package_decode_fn decode, package_deliver_fn deliver, package_retire_fn retire, void *ctx)
+{
+    (void)size;
+    (void)decode;
+    (void)deliver;
+    (void)retire;
+    (void)ctx;
+    return NULL;
+}
+
+void package_queue_free(package_queue_t *queue)
+{
+    (void)queue;
+}
+
+package_t *package_queue_reserve(package_queue_t *queue)
+{
+    (void)queue;
+    return NULL;
+}
+
+void package_queue_push(package_queue_t *queue, package_t *package)
+{
+    (void)queue;
+    (void)package;
+}
+
+void package_queue_retire(package_queue_t *queue, int wait)
+{
+    (void)queue;
+    (void)wait;
+}
+
+package_t const *package_queue_current(package_queue_t *queue)
+{
+    (void)queue;
+    return NULL;
+}
+
+package_t const *package_queue_oldest(package_queue_t *queue)
+{
+    (void)queue;
+    return NULL;
+}
+
+package_t const *package_queue_decoding(package_queue_t *queue)
+{
+    (void)queue;
+    return NULL;
+}
+
+int package_queue_keep_output(package_queue_t *queue, data_t *data, int level)
+{
+    (void)queue;
+    (void)data;
+    (void)level;
+    return 0;
+}
+
+#endif
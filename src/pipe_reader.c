@@ -0,0 +1,283 @@
+/** @file
+    Sample pipe reader, reads stdin or a pipe ahead on its own thread.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "pipe_reader.h"
+
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(ESP32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+/*
+    The reader thread fills a ring of blocks from the pipe and the caller drains them.
+*/
+
+struct pipe_reader {
+    FILE *file;
+    char *name;
+
+    uint8_t *blocks[PIPE_READER_BLOCKS];
+    size_t lens[PIPE_READER_BLOCKS];
+    unsigned head;  ///< next block to read
+    unsigned count; ///< blocks read ahead
+    size_t pos;     ///< read position in the head block
+    int eof;        ///< no more blocks follow
+    int started;    ///< the caller got a block, waiting before it is no underrun
+
+    unsigned stalls;    ///< times the ring ran full
+    unsigned underruns; ///< times the caller waited on an empty ring
+    unsigned peak;      ///< most blocks read ahead
+    unsigned stalls_logged;
+    unsigned underruns_logged;
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the ring, never held while reading
+    pthread_cond_t cond;  ///< signals a block or room for a block
+    int running;          ///< the thread was started
+    int reading;          ///< the thread is blocked on the pipe
+    int exit_thread;
+    int detached;         ///< the caller closed the reader while the thread was reading, the thread frees it
+#endif
+};
+
+int pipe_reader_is_pipe(FILE *file)
+{
+#if !defined(_WIN32) && !defined(ESP32)
+    struct stat st;
+    int fd = fileno(file);
+    return fd >= 0 && fstat(fd, &st) == 0 && !S_ISREG(st.st_mode);
+#else
+    return file == stdin;
+#endif
+}
+
+// a larger pipe buffer lets the source write on while the reader waits for room
+static void enlarge_pipe(FILE *file, char const *name)
+{
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    struct stat st;
+    int fd = fileno(file);
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISFIFO(st.st_mode))
+        return;
+    int size = fcntl(fd, F_GETPIPE_SZ);
+    if (size >= PIPE_READER_PIPE_SIZE)
+        return;
+    if (fcntl(fd, F_SETPIPE_SZ, PIPE_READER_PIPE_SIZE) < 0) {
+        print_logf(LOG_INFO, "Input", "The pipe buffer of \"%s\" stays at %d bytes, see /proc/sys/fs/pipe-max-size", name, size);
+        return;
+    }
+    print_logf(LOG_INFO, "Input", "Enlarged the pipe buffer of \"%s\" to %d bytes", name, fcntl(fd, F_GETPIPE_SZ));
+#else
+    (void)file;
+    (void)name;
+#endif
+}
+
+static void reader_free(pipe_reader_t *reader)
+{
+#ifdef THREADS
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->cond);
+#endif
+    for (unsigned i = 0; i < PIPE_READER_BLOCKS; ++i) {
+        free(reader->blocks[i]);
+    }
+    free(reader->name);
+    free(reader);
+}
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL reader_run(void *arg)
+{
+    pipe_reader_t *reader = arg;
+    int stalled           = 0;
+
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->exit_thread && !reader->eof) {
+        if (reader->count == PIPE_READER_BLOCKS) {
+            // the source waits on the pipe until the caller catches up
+            reader->stalls += !stalled;
+            stalled = 1;
+            pthread_cond_wait(&reader->cond, &reader->lock);
+            continue;
+        }
+        stalled         = 0;
+        unsigned slot   = (reader->head + reader->count) % PIPE_READER_BLOCKS;
+        reader->reading = 1;
+        pthread_mutex_unlock(&reader->lock);
+
+        // a short read is the end of the pipe or an error
+        size_t len = fread(reader->blocks[slot], 1, PIPE_READER_BLOCK_SIZE, reader->file);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->reading    = 0;
+        reader->lens[slot] = len;
+        if (len) {
+            reader->count += 1;
+            reader->peak = reader->count > reader->peak ? reader->count : reader->peak;
+        }
+        reader->eof = len < PIPE_READER_BLOCK_SIZE;
+        pthread_cond_broadcast(&reader->cond);
+    }
+    int detached = reader->detached;
+    pthread_mutex_unlock(&reader->lock);
+
+    if (detached) {
+        reader_free(reader);
+    }
+    return (THREAD_RETURN)(intptr_t)0;
+}
+#endif
+
+pipe_reader_t *pipe_reader_open(FILE *file, char const *name)
+{
+    pipe_reader_t *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        WARN_CALLOC("pipe_reader_open()");
+        return NULL;
+    }
+    reader->file = file;
+#ifdef THREADS
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->cond, NULL);
+#endif
+
+    reader->name = strdup(name);
+    if (!reader->name) {
+        WARN_STRDUP("pipe_reader_open()");
+        reader_free(reader);
+        return NULL;
+    }
+    for (unsigned i = 0; i < PIPE_READER_BLOCKS; ++i) {
+        reader->blocks[i] = malloc(PIPE_READER_BLOCK_SIZE);
+        if (!reader->blocks[i]) {
+            WARN_MALLOC("pipe_reader_open()");
+            reader_free(reader);
+            return NULL;
+        }
+    }
+    enlarge_pipe(file, name);
+
+#ifdef THREADS
+    if (pthread_create(&reader->thread, NULL, reader_run, reader)) {
+        print_log(LOG_ERROR, "Input", "Unable to create the pipe reader thread.");
+        reader_free(reader);
+        return NULL;
+    }
+    reader->running = 1;
+#endif
+
+    return reader;
+}
+
+size_t pipe_reader_read(pipe_reader_t *reader, void *dst, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+#ifdef THREADS
+        pthread_mutex_lock(&reader->lock);
+        if (reader->count == 0 && !reader->eof && reader->started) {
+            reader->underruns += 1;
+        }
+        while (reader->count == 0 && !reader->eof) {
+            pthread_cond_wait(&reader->cond, &reader->lock);
+        }
+        unsigned count     = reader->count;
+        unsigned stalls    = reader->stalls;
+        unsigned underruns = reader->underruns;
+        pthread_mutex_unlock(&reader->lock);
+
+        // reported as they happen, the demodulation goes on
+        if (stalls > reader->stalls_logged) {
+            print_logf_limited(LOG_WARNING, "Input", "Reading \"%s\" ahead stalled %u times, the demodulation is behind and the source waits",
+                    reader->name, stalls);
+            reader->stalls_logged = stalls;
+        }
+        if (underruns > reader->underruns_logged) {
+            print_logf_limited(LOG_DEBUG, "Input", "Waited %u times for the samples of \"%s\"", underruns, reader->name);
+            reader->underruns_logged = underruns;
+        }
+#else
+        if (reader->count == 0 && !reader->eof) {
+            reader->lens[reader->head] = fread(reader->blocks[reader->head], 1, PIPE_READER_BLOCK_SIZE, reader->file);
+            reader->count              = reader->lens[reader->head] ? 1 : 0;
+            reader->eof                = reader->lens[reader->head] < PIPE_READER_BLOCK_SIZE;
+        }
+        unsigned count = reader->count;
+#endif
+        if (count == 0) {
+            break; // end of the pipe
+        }
+        reader->started = 1;
+
+        size_t block_len = reader->lens[reader->head];
+        size_t n         = block_len - reader->pos < len - done ? block_len - reader->pos : len - done;
+        memcpy((uint8_t *)dst + done, reader->blocks[reader->head] + reader->pos, n);
+        reader->pos += n;
+        done += n;
+
+        if (reader->pos == block_len) {
+#ifdef THREADS
+            pthread_mutex_lock(&reader->lock);
+#endif
+            reader->head = (reader->head + 1) % PIPE_READER_BLOCKS;
+            reader->count -= 1;
+            reader->pos = 0;
+#ifdef THREADS
+            pthread_cond_broadcast(&reader->cond);
+            pthread_mutex_unlock(&reader->lock);
+#endif
+        }
+    }
+    return done;
+}
+
+void pipe_reader_close(pipe_reader_t *reader)
+{
+    if (!reader)
+        return;
+
+#ifdef THREADS
+    pthread_mutex_lock(&reader->lock);
+    if (reader->stalls || reader->underruns) {
+        print_logf(LOG_NOTICE, "Input", "Read \"%s\" ahead with %u stalls and %u underruns, at most %u of %u blocks queued",
+                reader->name, reader->stalls, reader->underruns, reader->peak, PIPE_READER_BLOCKS);
+    }
+    if (reader->running) {
+        reader->exit_thread = 1;
+        pthread_cond_broadcast(&reader->cond);
+        // a source that writes nothing more would block the close, the thread frees the reader once its read returns
+        if (reader->reading) {
+            pthread_t thread = reader->thread;
+            reader->detached = 1;
+            pthread_mutex_unlock(&reader->lock);
+            pthread_detach(thread);
+            return;
+        }
+        pthread_mutex_unlock(&reader->lock);
+        pthread_join(reader->thread, NULL);
+    }
+    else {
+        pthread_mutex_unlock(&reader->lock);
+    }
+#endif
+
+    reader_free(reader);
+}
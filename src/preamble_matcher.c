@@ -0,0 +1,382 @@
+/** @file
+    Shared search of the fixed preambles of a slice group.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "preamble_matcher.h"
+
+#include "bitbuffer.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The states are indexed with 16 bits, the root is state 0.
+#define PREAMBLE_MATCHER_MAX_STATES 65535
+
+struct preamble_matcher {
+    unsigned patterns;
+    unsigned pattern_bits[PREAMBLE_MATCHER_MAX_PATTERNS];
+    uint8_t *pattern[PREAMBLE_MATCHER_MAX_PATTERNS]; ///< as found in the bits, the unused bits of the last byte are zero
+    unsigned states;
+    uint16_t (*next)[2]; ///< the next state for a 0 and a 1 bit
+    uint64_t *out;       ///< the patterns ending in each state
+};
+
+preamble_matcher_t *preamble_matcher_create(void)
+{
+    preamble_matcher_t *matcher = calloc(1, sizeof(*matcher));
+    if (!matcher) {
+        WARN_CALLOC("preamble_matcher_create()");
+        return NULL;
+    }
+    return matcher;
+}
+
+void preamble_matcher_free(preamble_matcher_t *matcher)
+{
+    if (!matcher)
+        return;
+
+    for (unsigned k = 0; k < matcher->patterns; ++k) {
+        free(matcher->pattern[k]);
+    }
+    free(matcher->next);
+    free(matcher->out);
+    free(matcher);
+}
+
+static int pattern_bit(uint8_t const *pattern, unsigned i)
+{
+    return pattern[i / 8] >> (7 - i % 8) & 1;
+}
+
+// build the automaton of the first @p patterns patterns, the old automaton is kept on failure
+static int matcher_build(preamble_matcher_t *matcher, unsigned patterns)
+{
+    unsigned size = 1;
+    for (unsigned k = 0; k < patterns; ++k) {
+        size += matcher->pattern_bits[k];
+    }
+    if (size > PREAMBLE_MATCHER_MAX_STATES) {
+        return 0;
+    }
+
+    uint16_t (*next)[2] = calloc(size, sizeof(*next));
+    if (!next) {
+        WARN_CALLOC("preamble_matcher_add()");
+        return 0;
+    }
+    uint64_t *out = calloc(size, sizeof(*out));
+    if (!out) {
+        WARN_CALLOC("preamble_matcher_add()");
+        free(next);
+        return 0;
+    }
+    // the failure of each state and the queue of the states to visit
+    uint16_t *fail = calloc(size * 2, sizeof(*fail));
+    if (!fail) {
+        WARN_CALLOC("preamble_matcher_add()");
+        free(next);
+        free(out);
+        return 0;
+    }
+    uint16_t *queue = &fail[size];
+
+    // the trie of all patterns, no state links back to the root yet
+    unsigned states = 1;
+    for (unsigned k = 0; k < patterns; ++k) {
+        unsigned s = 0;
+        for (unsigned i = 0; i < matcher->pattern_bits[k]; ++i) {
+            int b = pattern_bit(matcher->pattern[k], i);
+            if (!next[s][b])
+                next[s][b] = (uint16_t)states++;
+            s = next[s][b];
+        }
+        out[s] |= 1ULL << k;
+    }
+
+    // breadth first, the failure of a state is shallower and complete when the state is reached
+    unsigned head = 0;
+    unsigned tail = 0;
+    for (int b = 0; b < 2; ++b) {
+        if (next[0][b])
+            queue[tail++] = next[0][b];
+    }
+    while (head < tail) {
+        unsigned s = queue[head++];
+        out[s] |= out[fail[s]];
+        for (int b = 0; b < 2; ++b) {
+            unsigned c = next[s][b];
+            if (c) {
+                fail[c]       = next[fail[s]][b];
+                queue[tail++] = (uint16_t)c;
+            }
+            else {
+                next[s][b] = next[fail[s]][b];
+            }
+        }
+    }
+    free(fail);
+
+    free(matcher->next);
+    free(matcher->out);
+    matcher->next   = next;
+    matcher->out    = out;
+    matcher->states = states;
+    return 1;
+}
+
+unsigned preamble_matcher_add(preamble_matcher_t *matcher, uint8_t const *pattern, unsigned bits, int inverted)
+{
+    if (!matcher || !bits)
+        return 0;
+
+    unsigned bytes = (bits + 7) / 8;
+    uint8_t *copy = malloc(bytes);
+    if (!copy) {
+        WARN_MALLOC("preamble_matcher_add()");
+        return 0;
+    }
+    for (unsigned i = 0; i < bytes; ++i) {
+        copy[i] = inverted ? ~pattern[i] : pattern[i];
+    }
+    if (bits % 8)
+        copy[bytes - 1] &= 0xff << (8 - bits % 8);
+
+    for (unsigned k = 0; k < matcher->patterns; ++k) {
+        if (matcher->pattern_bits[k] == bits && !memcmp(matcher->pattern[k], copy, bytes)) {
+            free(copy);
+            return k + 1;
+        }
+    }
+
+    unsigned k = matcher->patterns;
+    if (k >= PREAMBLE_MATCHER_MAX_PATTERNS) {
+        free(copy);
+        return 0;
+    }
+    matcher->pattern[k]      = copy;
+    matcher->pattern_bits[k] = bits;
+    if (!matcher_build(matcher, k + 1)) {
+        free(copy);
+        return 0;
+    }
+    matcher->patterns = k + 1;
+    return k + 1;
+}
+
+// one pass over each row, keeps the first offsets of each pattern
+static void preamble_scan_run(preamble_scan_t *scan)
+{
+    preamble_matcher_t const *matcher = scan->matcher;
+    bitbuffer_t const *source = scan->source;
+    unsigned patterns = matcher->patterns;
+
+    unsigned cells = source->num_rows * patterns;
+    if (cells > scan->size) {
+        uint8_t *counts = realloc(scan->counts, cells * sizeof(*counts));
+        if (!counts) {
+            FATAL_REALLOC("preamble_scan_find()");
+        }
+        scan->counts = counts;
+        uint16_t *offsets = realloc(scan->offsets, cells * PREAMBLE_SCAN_HITS * sizeof(*offsets));
+        if (!offsets) {
+            FATAL_REALLOC("preamble_scan_find()");
+        }
+        scan->offsets = offsets;
+        scan->size    = cells;
+    }
+    memset(scan->counts, 0, cells * sizeof(*scan->counts));
+
+    for (unsigned row = 0; row < source->num_rows; ++row) {
+        // a long row spills into the following rows, the bits of each row are contiguous
+        uint8_t const *bits = source->bb[row];
+        unsigned len        = source->bits_per_row[row];
+        uint8_t *counts     = &scan->counts[row * patterns];
+        uint16_t *offsets   = &scan->offsets[row * patterns * PREAMBLE_SCAN_HITS];
+        unsigned state      = 0;
+        for (unsigned i = 0; i < len; ++i) {
+            state = matcher->next[state][bits[i / 8] >> (7 - i % 8) & 1];
+            uint64_t out = matcher->out[state];
+            for (unsigned k = 0; out; ++k, out >>= 1) {
+                if (!(out & 1))
+                    continue;
+                unsigned n = counts[k];
+                if (n < PREAMBLE_SCAN_HITS)
+                    offsets[k * PREAMBLE_SCAN_HITS + n] = (uint16_t)(i + 1 - matcher->pattern_bits[k]);
+                if (n <= PREAMBLE_SCAN_HITS)
+                    counts[k] = (uint8_t)(n + 1);
+            }
+        }
+    }
+    scan->done = 1;
+}
+
+unsigned preamble_scan_find(preamble_scan_t *scan, unsigned slot, unsigned row, unsigned start)
+{
+    preamble_matcher_t const *matcher = scan->matcher;
+    if (!matcher || !slot || slot > matcher->patterns || row >= scan->source->num_rows)
+        return PREAMBLE_SCAN_UNKNOWN;
+
+    if (!scan->done)
+        preamble_scan_run(scan);
+
+    unsigned cell = row * matcher->patterns + slot - 1;
+    unsigned n    = scan->counts[cell];
+    uint16_t const *offsets = &scan->offsets[cell * PREAMBLE_SCAN_HITS];
+    for (unsigned i = 0; i < n && i < PREAMBLE_SCAN_HITS; ++i) {
+        if (offsets[i] >= start)
+            return offsets[i];
+    }
+    if (n > PREAMBLE_SCAN_HITS)
+        return PREAMBLE_SCAN_UNKNOWN;
+    return scan->source->bits_per_row[row];
+}
+
+void preamble_scan_free(preamble_scan_t *scan)
+{
+    free(scan->counts);
+    free(scan->offsets);
+    scan->counts  = NULL;
+    scan->offsets = NULL;
+    scan->size    = 0;
+}
+
+#ifdef _TEST
+#include <stdio.h>
+
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL: %u <> %u\n", (unsigned)(a), (unsigned)(b)); \
+        } \
+    } while (0)
+
+// the plain search the scan is checked against, as bitbuffer_search()
+static unsigned search_bits(bitbuffer_t const *bits, unsigned row, unsigned start, uint8_t const *pattern, unsigned pattern_bits, int inverted)
+{
+    unsigned len = bits->bits_per_row[row];
+    for (unsigned ipos = start; ipos + pattern_bits <= len; ++ipos) {
+        unsigned i = 0;
+        for (; i < pattern_bits; ++i) {
+            int b = bits->bb[row][(ipos + i) / 8] >> (7 - (ipos + i) % 8) & 1;
+            if (b != (pattern_bit(pattern, i) ^ inverted))
+                break;
+        }
+        if (i == pattern_bits)
+            return ipos;
+    }
+    return len;
+}
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+
+    fprintf(stderr, "preamble_matcher::preamble_matcher_add():\n");
+    uint8_t const p0[] = {0xaa, 0xa9};
+    uint8_t const p1[] = {0x55, 0x56};
+    uint8_t const p2[] = {0xaa, 0xaa, 0x2d, 0xd4};
+    uint8_t const p3[] = {0x2d, 0xd4};
+    uint8_t const p4[] = {0xa9, 0xe0};
+    uint8_t const p5[] = {0xaa, 0xaa, 0xaa, 0xa9};
+    preamble_matcher_t *matcher = preamble_matcher_create();
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p0, 16, 0), 1);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p1, 16, 1), 1); // the same bits
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p0, 16, 1), 2);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p2, 32, 0), 3);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p3, 16, 0), 4); // a suffix of another pattern
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p4, 12, 0), 5);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p4, 11, 0), 6);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p5, 32, 1), 7);
+    ASSERT_EQUALS(preamble_matcher_add(matcher, p0, 0, 0), 0);
+
+    fprintf(stderr, "preamble_matcher::preamble_scan_find():\n");
+    struct {
+        uint8_t const *pattern;
+        unsigned bits;
+        int inverted;
+    } const slots[] = {
+            {p0, 16, 0},
+            {p0, 16, 1},
+            {p2, 32, 0},
+            {p3, 16, 0},
+            {p4, 12, 0},
+            {p4, 11, 0},
+            {p5, 32, 1},
+    };
+    static bitbuffer_t bits = {0};
+    preamble_scan_t scan = {0};
+    unsigned seed = 1;
+    unsigned mismatch = 0;
+    for (int round = 0; round < 200; ++round) {
+        // rows of preamble like bits with planted patterns, some rows overflow the kept offsets
+        memset(&bits, 0, sizeof(bits));
+        bits.num_rows = 1 + round % 7;
+        for (unsigned row = 0; row < bits.num_rows; ++row) {
+            unsigned len = round % 5 ? 40 + (seed >> 16) % 400 : (seed >> 16) % 24;
+            bits.bits_per_row[row] = (uint16_t)len;
+            for (unsigned i = 0; i < (len + 7) / 8; ++i) {
+                seed = seed * 1103515245 + 12345;
+                bits.bb[row][i] = (seed >> 16) % 3 ? 0xaa : (uint8_t)(seed >> 8);
+                if ((seed >> 20) % 11 == 0)
+                    bits.bb[row][i] = 0x2d;
+                if ((seed >> 20) % 11 == 1)
+                    bits.bb[row][i] = 0xa9;
+                if ((seed >> 20) % 11 == 2)
+                    bits.bb[row][i] = 0x56;
+            }
+        }
+        scan.matcher = matcher;
+        scan.source  = &bits;
+        scan.done    = 0;
+        for (unsigned k = 0; k < sizeof(slots) / sizeof(*slots); ++k) {
+            for (unsigned row = 0; row < bits.num_rows; ++row) {
+                for (unsigned start = 0; start <= bits.bits_per_row[row] + 1u; ++start) {
+                    unsigned pos = preamble_scan_find(&scan, k + 1, row, start);
+                    if (pos == PREAMBLE_SCAN_UNKNOWN)
+                        continue;
+                    unsigned ref = search_bits(&bits, row, start, slots[k].pattern, slots[k].bits, slots[k].inverted);
+                    mismatch += pos != ref;
+                }
+            }
+        }
+    }
+    ASSERT_EQUALS(mismatch, 0);
+    ASSERT_EQUALS(preamble_scan_find(&scan, 8, 0, 0), PREAMBLE_SCAN_UNKNOWN);
+    ASSERT_EQUALS(preamble_scan_find(&scan, 1, bits.num_rows, 0), PREAMBLE_SCAN_UNKNOWN);
+
+    // more matches than kept are left to the caller past the last kept offset
+    memset(&bits, 0, sizeof(bits));
+    bits.num_rows = 1;
+    bits.bits_per_row[0] = 8 * (PREAMBLE_SCAN_HITS + 2) * 2;
+    for (unsigned i = 0; i < (PREAMBLE_SCAN_HITS + 2) * 2; i += 2) {
+        bits.bb[0][i]     = 0xaa;
+        bits.bb[0][i + 1] = 0xa9;
+    }
+    scan.done = 0;
+    ASSERT_EQUALS(preamble_scan_find(&scan, 1, 0, 0), 0);
+    ASSERT_EQUALS(preamble_scan_find(&scan, 1, 0, 1), 16);
+    ASSERT_EQUALS(preamble_scan_find(&scan, 1, 0, 16 * (PREAMBLE_SCAN_HITS - 1)), 16 * (PREAMBLE_SCAN_HITS - 1));
+    ASSERT_EQUALS(preamble_scan_find(&scan, 1, 0, 16 * (PREAMBLE_SCAN_HITS - 1) + 1), PREAMBLE_SCAN_UNKNOWN);
+    ASSERT_EQUALS(preamble_scan_find(&scan, 2, 0, 0), bits.bits_per_row[0]);
+
+    preamble_scan_free(&scan);
+    preamble_matcher_free(matcher);
+
+    fprintf(stderr, "preamble_matcher:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
+#endif /* _TEST */
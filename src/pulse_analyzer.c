@@ -11,164 +11,14 @@
 
 #include "pulse_analyzer.h"
 #include "pulse_slicer.h"
+#include "histogram.h"
 #include "c_util.h" // for MIN(), MAX()
+#include "fatal.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-
-#define MAX_HIST_BINS 16
-
-/// Histogram data for single bin
-typedef struct {
-    unsigned count;
-    int sum;
-    int mean;
-    int min;
-    int max;
-} hist_bin_t;
-
-/// Histogram data for all bins
-typedef struct {
-    unsigned bins_count;
-    hist_bin_t bins[MAX_HIST_BINS];
-} histogram_t;
-
-/// Generate a histogram (unsorted)
-static void histogram_sum(histogram_t *hist, int const *data, unsigned len, float tolerance)
-{
-    unsigned bin;    // Iterator will be used outside for!
-
-    for (unsigned n = 0; n < len; ++n) {
-        // Search for match in existing bins
-        for (bin = 0; bin < hist->bins_count; ++bin) {
-            int bn = data[n];
-            int bm = hist->bins[bin].mean;
-            if (abs(bn - bm) < (tolerance * MAX(bn, bm))) {
-                hist->bins[bin].count++;
-                hist->bins[bin].sum += data[n];
-                hist->bins[bin].mean = hist->bins[bin].sum / hist->bins[bin].count;
-                hist->bins[bin].min    = MIN(data[n], hist->bins[bin].min);
-                hist->bins[bin].max    = MAX(data[n], hist->bins[bin].max);
-                break;    // Match found! Data added to existing bin
-            }
-        }
-        // No match found? Add new bin
-        if (bin == hist->bins_count && bin < MAX_HIST_BINS) {
-            hist->bins[bin].count    = 1;
-            hist->bins[bin].sum        = data[n];
-            hist->bins[bin].mean    = data[n];
-            hist->bins[bin].min        = data[n];
-            hist->bins[bin].max        = data[n];
-            hist->bins_count++;
-        } // for bin
-    } // for data
-}
-
-/// Delete bin from histogram
-static void histogram_delete_bin(histogram_t *hist, unsigned index)
-{
-    hist_bin_t const zerobin = {0};
-    if (hist->bins_count < 1) return;    // Avoid out of bounds
-    // Move all bins afterwards one forward
-    for (unsigned n = index; n < hist->bins_count-1; ++n) {
-        hist->bins[n] = hist->bins[n+1];
-    }
-    hist->bins_count--;
-    hist->bins[hist->bins_count] = zerobin;    // Clear previously last bin
-}
-
-
-/// Swap two bins in histogram
-static void histogram_swap_bins(histogram_t *hist, unsigned index1, unsigned index2)
-{
-    hist_bin_t    tempbin;
-    if ((index1 < hist->bins_count) && (index2 < hist->bins_count)) {        // Avoid out of bounds
-        tempbin = hist->bins[index1];
-        hist->bins[index1] = hist->bins[index2];
-        hist->bins[index2] = tempbin;
-    }
-}
-
-
-/// Sort histogram with mean value (order lowest to highest)
-static void histogram_sort_mean(histogram_t *hist)
-{
-    if (hist->bins_count < 2) return;        // Avoid underflow
-    // Compare all bins (bubble sort)
-    for (unsigned n = 0; n < hist->bins_count-1; ++n) {
-        for (unsigned m = n+1; m < hist->bins_count; ++m) {
-            if (hist->bins[m].mean < hist->bins[n].mean) {
-                histogram_swap_bins(hist, m, n);
-            }
-        }
-    }
-}
-
-
-/// Sort histogram with count value (order lowest to highest)
-static void histogram_sort_count(histogram_t *hist)
-{
-    if (hist->bins_count < 2) return;        // Avoid underflow
-    // Compare all bins (bubble sort)
-    for (unsigned n = 0; n < hist->bins_count-1; ++n) {
-        for (unsigned m = n+1; m < hist->bins_count; ++m) {
-            if (hist->bins[m].count < hist->bins[n].count) {
-                histogram_swap_bins(hist, m, n);
-            }
-        }
-    }
-}
-
-
-/// Fuse histogram bins with means within tolerance
-static void histogram_fuse_bins(histogram_t *hist, float tolerance)
-{
-    if (hist->bins_count < 2) return;        // Avoid underflow
-    // Compare all bins
-    for (unsigned n = 0; n < hist->bins_count-1; ++n) {
-        for (unsigned m = n+1; m < hist->bins_count; ++m) {
-            int bn = hist->bins[n].mean;
-            int bm = hist->bins[m].mean;
-            // if within tolerance
-            if (abs(bn - bm) < (tolerance * MAX(bn, bm))) {
-                // Fuse data for bin[n] and bin[m]
-                hist->bins[n].count += hist->bins[m].count;
-                hist->bins[n].sum    += hist->bins[m].sum;
-                hist->bins[n].mean    = hist->bins[n].sum / hist->bins[n].count;
-                hist->bins[n].min    = MIN(hist->bins[n].min, hist->bins[m].min);
-                hist->bins[n].max    = MAX(hist->bins[n].max, hist->bins[m].max);
-                // Delete bin[m]
-                histogram_delete_bin(hist, m);
-                m--;    // Compare new bin in same place!
-            }
-        }
-    }
-}
-
-/// Find bin index
-static int histogram_find_bin_index(histogram_t const *hist, int width)
-{
-    for (unsigned n = 0; n < hist->bins_count; ++n) {
-        if (hist->bins[n].min <= width && width <= hist->bins[n].max) {
-            return n;
-        }
-    }
-    return -1;
-}
-
-/// Print a histogram
-static void histogram_print(histogram_t const *hist, uint32_t samp_rate)
-{
-    for (unsigned n = 0; n < hist->bins_count; ++n) {
-        fprintf(stderr, " [%2u] count: %4u,  width: %4.0f us [%.0f;%.0f]\t(%4i S)\n", n,
-                hist->bins[n].count,
-                hist->bins[n].mean * 1e6 / samp_rate,
-                hist->bins[n].min * 1e6 / samp_rate,
-                hist->bins[n].max * 1e6 / samp_rate,
-                hist->bins[n].mean);
-    }
-}
+#include <math.h>
 
 #define HEXSTR_BUILDER_SIZE 1024
 #define HEXSTR_MAX_COUNT 32
@@ -201,174 +51,234 @@ static void hexstr_print(hexstr_t *h, FILE *out)
 
 #define TOLERANCE (0.2f) // 20% tolerance should still discern between the pulse widths: 0.33, 0.66, 1.0
 
-/// Analyze the statistics of a pulse data structure and print result
-void pulse_analyzer(pulse_data_t *data, int package_type, r_device* device)
+/// Histograms of a package, the timings and the gap + pulse periods are only needed to print.
+typedef struct {
+    histogram_t pulses;
+    histogram_t gaps;
+    histogram_t periods_pg; // Pulse+Gap periods
+    histogram_t periods_gp; // Gap+Pulse periods
+    histogram_t timings;
+} package_hists_t;
+
+/// Cluster the widths of a package, returns the total period or -1 on alloc failure.
+static int package_hists(package_hists_t *h, pulse_data_t const *data, int all)
 {
-    if (data->num_pulses == 0) {
-        fprintf(stderr, "No pulses detected.\n");
-        return;
+    memset(h, 0, sizeof(*h));
+    unsigned const num_periods = data->num_pulses;
+    // pulse + gap periods, gap + pulse periods, and the pulses followed by the gaps
+    int *periods_pg = malloc(4 * num_periods * sizeof(*periods_pg));
+    if (!periods_pg) {
+        WARN_MALLOC("pulse_analyzer()");
+        return -1;
     }
-
-    double to_ms = 1e3 / data->sample_rate;
-    double to_us = 1e6 / data->sample_rate;
     // Generate pulse period data (pulse + gap, trailing gap)
     int pulse_total_period = 0;
-    pulse_data_t pulse_periods_pg = {0};
-    pulse_periods_pg.num_pulses = data->num_pulses;
-    for (unsigned n = 0; n < pulse_periods_pg.num_pulses; ++n) {
-        pulse_periods_pg.pulse[n] = data->pulse[n] + data->gap[n];
+    for (unsigned n = 0; n < num_periods; ++n) {
+        periods_pg[n] = data->pulse[n] + data->gap[n];
         pulse_total_period += data->pulse[n] + data->gap[n];
     }
-    pulse_total_period -= data->gap[pulse_periods_pg.num_pulses - 1];
+    pulse_total_period -= data->gap[num_periods - 1];
     // Generate pulse period data (gap + pulse, leading gap)
-    pulse_data_t pulse_periods_gp = {0};
-    pulse_periods_gp.num_pulses   = data->num_pulses;
-    pulse_periods_gp.pulse[0] = data->pulse[0];
-    for (unsigned n = 1; n < pulse_periods_gp.num_pulses; ++n) {
-        pulse_periods_gp.pulse[n] = data->pulse[n] + data->gap[n - 1];
+    int *periods_gp = &periods_pg[num_periods];
+    periods_gp[0] = data->pulse[0];
+    for (unsigned n = 1; n < num_periods; ++n) {
+        periods_gp[n] = data->pulse[n] + data->gap[n - 1];
     }
 
-    histogram_t hist_pulses  = {0};
-    histogram_t hist_gaps    = {0};
-    histogram_t hist_periods_pg = {0}; // Pulse+Gap periods
-    histogram_t hist_periods_gp = {0}; // Gap+Pulse periods
-    histogram_t hist_timings = {0};
-
-    // Generate statistics
-    histogram_sum(&hist_pulses, data->pulse, data->num_pulses, TOLERANCE);
-    histogram_sum(&hist_gaps, data->gap, data->num_pulses - 1, TOLERANCE);                      // Leave out last gap (end)
-    histogram_sum(&hist_periods_pg, pulse_periods_pg.pulse, pulse_periods_pg.num_pulses - 1, TOLERANCE); // Leave out last gap (end)
-    histogram_sum(&hist_periods_gp, pulse_periods_gp.pulse, pulse_periods_gp.num_pulses, TOLERANCE);
-    histogram_sum(&hist_timings, data->pulse, data->num_pulses, TOLERANCE);
-    histogram_sum(&hist_timings, data->gap, data->num_pulses, TOLERANCE);
-
-    // Fuse overlapping bins
-    histogram_fuse_bins(&hist_pulses, TOLERANCE);
-    histogram_fuse_bins(&hist_gaps, TOLERANCE);
-    histogram_fuse_bins(&hist_periods_pg, TOLERANCE);
-    histogram_fuse_bins(&hist_timings, TOLERANCE);
-
-    fprintf(stderr, "Analyzing pulses...\n");
-    fprintf(stderr, "Total count: %4u,  width: %4.2f ms\t\t(%5i S)\n",
-            data->num_pulses, pulse_total_period * to_ms, pulse_total_period);
-    fprintf(stderr, "Pulse width distribution:\n");
-    histogram_print(&hist_pulses, data->sample_rate);
-    fprintf(stderr, "Gap width distribution:\n");
-    histogram_print(&hist_gaps, data->sample_rate);
-    fprintf(stderr, "Pulse+gap period distribution:\n");
-    histogram_print(&hist_periods_pg, data->sample_rate);
-    fprintf(stderr, "Gap+pulse period distribution:\n");
-    histogram_print(&hist_periods_gp, data->sample_rate);
-    fprintf(stderr, "Timing distribution:\n");
-    histogram_print(&hist_timings, data->sample_rate);
-    fprintf(stderr, "Level estimates [high, low]: %6i, %6i\n",
-            data->ook_high_estimate, data->ook_low_estimate);
-    fprintf(stderr, "RSSI: %.1f dB SNR: %.1f dB Noise: %.1f dB\n",
-            data->rssi_db, data->snr_db, data->noise_db);
-    fprintf(stderr, "Frequency offsets [F1, F2]:  %6i, %6i\t(%+.1f kHz, %+.1f kHz)\n",
-            data->fsk_f1_est, data->fsk_f2_est,
-            (float)data->fsk_f1_est / INT16_MAX * data->sample_rate / 2.0 / 1000.0,
-            (float)data->fsk_f2_est / INT16_MAX * data->sample_rate / 2.0 / 1000.0);
+    // Generate statistics, the clusters are sorted by mean and don't overlap
+    histogram_cluster(&h->pulses, data->pulse, data->num_pulses, TOLERANCE);
+    histogram_cluster(&h->gaps, data->gap, data->num_pulses - 1, TOLERANCE);         // Leave out last gap (end)
+    histogram_cluster(&h->periods_pg, periods_pg, num_periods - 1, TOLERANCE); // Leave out last gap (end)
+    if (all) {
+        histogram_cluster(&h->periods_gp, periods_gp, num_periods, TOLERANCE);
+        int *timings = &periods_pg[2 * num_periods];
+        memcpy(timings, data->pulse, num_periods * sizeof(*timings));
+        memcpy(&timings[num_periods], data->gap, num_periods * sizeof(*timings));
+        histogram_cluster(&h->timings, timings, 2 * num_periods, TOLERANCE);
+    }
+    free(periods_pg); // the other periods and the timings are in the same block
+    return pulse_total_period;
+}
 
-    fprintf(stderr, "Guessing modulation: ");
-    device->name    = "Analyzer Device",
-    device->verbose = 2,
-    histogram_sort_mean(&hist_pulses); // Easier to work with sorted data
-    histogram_sort_mean(&hist_gaps);
-    if (hist_pulses.bins[0].mean == 0) {
-        histogram_delete_bin(&hist_pulses, 0);
+/// Guess the modulation and set the device parameters, returns a description.
+static char const *guess_modulation(package_hists_t *h, int package_type, unsigned num_pulses, double to_us, r_device *device)
+{
+    histogram_t *hist_pulses = &h->pulses;
+    histogram_t *hist_gaps   = &h->gaps;
+    histogram_t *hist_periods_pg = &h->periods_pg;
+
+    histogram_sort_mean(hist_pulses); // Easier to work with sorted data
+    histogram_sort_mean(hist_gaps);
+    if (hist_pulses->bins[0].mean == 0) {
+        histogram_delete_bin(hist_pulses, 0);
     } // Remove FSK initial zero-bin
 
     // Attempt to find a matching modulation
-    if (data->num_pulses == 1) {
-        fprintf(stderr, "Single pulse detected. Probably Frequency Shift Keying or just noise...\n");
+    if (num_pulses == 1) {
+        return "Single pulse detected. Probably Frequency Shift Keying or just noise...";
     }
-    else if (hist_pulses.bins_count == 1 && hist_gaps.bins_count == 1) {
-        fprintf(stderr, "Un-modulated signal. Maybe a preamble...\n");
+    else if (hist_pulses->bins_count == 1 && hist_gaps->bins_count == 1) {
+        return "Un-modulated signal. Maybe a preamble...";
     }
-    else if (hist_pulses.bins_count == 1 && hist_gaps.bins_count > 1) {
-        fprintf(stderr, "Pulse Position Modulation with fixed pulse width\n");
+    else if (hist_pulses->bins_count == 1 && hist_gaps->bins_count > 1) {
         device->modulation  = OOK_PULSE_PPM; // TODO: there is not FSK_PULSE_PPM
-        device->short_width = to_us * hist_gaps.bins[0].mean;
-        device->long_width  = to_us * hist_gaps.bins[1].mean;
-        device->gap_limit   = to_us * (hist_gaps.bins[1].max + 1);                        // Set limit above next lower gap
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1); // Set limit above biggest gap
+        device->short_width = to_us * hist_gaps->bins[0].mean;
+        device->long_width  = to_us * hist_gaps->bins[1].mean;
+        device->gap_limit   = to_us * (hist_gaps->bins[1].max + 1);                         // Set limit above next lower gap
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1); // Set limit above biggest gap
+        return "Pulse Position Modulation with fixed pulse width";
     }
-    else if (hist_pulses.bins_count == 2 && hist_gaps.bins_count == 1) {
-        fprintf(stderr, "Pulse Width Modulation with fixed gap\n");
+    else if (hist_pulses->bins_count == 2 && hist_gaps->bins_count == 1) {
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_PWM : OOK_PULSE_PWM;
-        device->short_width = to_us * hist_pulses.bins[0].mean;
-        device->long_width  = to_us * hist_pulses.bins[1].mean;
+        device->short_width = to_us * hist_pulses->bins[0].mean;
+        device->long_width  = to_us * hist_pulses->bins[1].mean;
         device->tolerance   = (device->long_width - device->short_width) * 0.4;
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1); // Set limit above biggest gap
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1); // Set limit above biggest gap
+        return "Pulse Width Modulation with fixed gap";
     }
-    else if (hist_pulses.bins_count == 2 && hist_gaps.bins_count == 2 && hist_periods_pg.bins_count == 1) {
-        fprintf(stderr, "Pulse Width Modulation with fixed period\n");
+    else if (hist_pulses->bins_count == 2 && hist_gaps->bins_count == 2 && hist_periods_pg->bins_count == 1) {
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_PWM : OOK_PULSE_PWM;
-        device->short_width = to_us * hist_pulses.bins[0].mean;
-        device->long_width  = to_us * hist_pulses.bins[1].mean;
+        device->short_width = to_us * hist_pulses->bins[0].mean;
+        device->long_width  = to_us * hist_pulses->bins[1].mean;
         device->tolerance   = (device->long_width - device->short_width) * 0.4;
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1); // Set limit above biggest gap
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1); // Set limit above biggest gap
+        return "Pulse Width Modulation with fixed period";
     }
-    else if (hist_pulses.bins_count == 2 && hist_gaps.bins_count == 2 && hist_periods_pg.bins_count == 3) {
-        fprintf(stderr, "Manchester coding\n");
+    else if (hist_pulses->bins_count == 2 && hist_gaps->bins_count == 2 && hist_periods_pg->bins_count == 3) {
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_MANCHESTER_ZEROBIT : OOK_PULSE_MANCHESTER_ZEROBIT;
-        device->short_width = to_us * MIN(hist_pulses.bins[0].mean, hist_pulses.bins[1].mean); // Assume shortest pulse is half period
-        device->long_width  = 0;                                                               // Not used
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1);      // Set limit above biggest gap
+        device->short_width = to_us * MIN(hist_pulses->bins[0].mean, hist_pulses->bins[1].mean); // Assume shortest pulse is half period
+        device->long_width  = 0;                                                                 // Not used
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1);     // Set limit above biggest gap
+        return "Manchester coding";
     }
-    else if (hist_pulses.bins_count == 2 && hist_gaps.bins_count >= 3) {
-        fprintf(stderr, "Pulse Width Modulation with multiple packets\n");
+    else if (hist_pulses->bins_count == 2 && hist_gaps->bins_count >= 3) {
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_PWM : OOK_PULSE_PWM;
-        device->short_width = to_us * hist_pulses.bins[0].mean;
-        device->long_width  = to_us * hist_pulses.bins[1].mean;
-        device->gap_limit   = to_us * (hist_gaps.bins[1].max + 1); // Set limit above second gap
+        device->short_width = to_us * hist_pulses->bins[0].mean;
+        device->long_width  = to_us * hist_pulses->bins[1].mean;
+        device->gap_limit   = to_us * (hist_gaps->bins[1].max + 1); // Set limit above second gap
         device->tolerance   = (device->long_width - device->short_width) * 0.4;
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1); // Set limit above biggest gap
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1); // Set limit above biggest gap
+        return "Pulse Width Modulation with multiple packets";
     }
-    else if ((hist_pulses.bins_count >= 3 && hist_gaps.bins_count >= 3)
-            && (abs(hist_pulses.bins[1].mean - 2*hist_pulses.bins[0].mean) <= hist_pulses.bins[0].mean/8)    // Pulses are multiples of shortest pulse
-            && (abs(hist_pulses.bins[2].mean - 3*hist_pulses.bins[0].mean) <= hist_pulses.bins[0].mean/8)
-            && (abs(hist_gaps.bins[0].mean   -   hist_pulses.bins[0].mean) <= hist_pulses.bins[0].mean/8)    // Gaps are multiples of shortest pulse
-            && (abs(hist_gaps.bins[1].mean   - 2*hist_pulses.bins[0].mean) <= hist_pulses.bins[0].mean/8)
-            && (abs(hist_gaps.bins[2].mean   - 3*hist_pulses.bins[0].mean) <= hist_pulses.bins[0].mean/8)) {
-        fprintf(stderr, "Non Return to Zero coding (Pulse Code)\n");
+    else if ((hist_pulses->bins_count >= 3 && hist_gaps->bins_count >= 3)
+            && (abs(hist_pulses->bins[1].mean - 2*hist_pulses->bins[0].mean) <= hist_pulses->bins[0].mean/8)    // Pulses are multiples of shortest pulse
+            && (abs(hist_pulses->bins[2].mean - 3*hist_pulses->bins[0].mean) <= hist_pulses->bins[0].mean/8)
+            && (abs(hist_gaps->bins[0].mean   -   hist_pulses->bins[0].mean) <= hist_pulses->bins[0].mean/8)    // Gaps are multiples of shortest pulse
+            && (abs(hist_gaps->bins[1].mean   - 2*hist_pulses->bins[0].mean) <= hist_pulses->bins[0].mean/8)
+            && (abs(hist_gaps->bins[2].mean   - 3*hist_pulses->bins[0].mean) <= hist_pulses->bins[0].mean/8)) {
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_PCM : OOK_PULSE_PCM;
-        device->short_width = to_us * hist_pulses.bins[0].mean;        // Shortest pulse is bit width
-        device->long_width  = to_us * hist_pulses.bins[0].mean;        // Bit period equal to pulse length (NRZ)
-        device->reset_limit = to_us * hist_pulses.bins[0].mean * 1024; // No limit to run of zeros...
+        device->short_width = to_us * hist_pulses->bins[0].mean;        // Shortest pulse is bit width
+        device->long_width  = to_us * hist_pulses->bins[0].mean;        // Bit period equal to pulse length (NRZ)
+        device->reset_limit = to_us * hist_pulses->bins[0].mean * 1024; // No limit to run of zeros...
+        return "Non Return to Zero coding (Pulse Code)";
     }
-    else if (hist_pulses.bins_count == 3) {
-        fprintf(stderr, "Pulse Width Modulation with sync/delimiter\n");
+    else if (hist_pulses->bins_count == 3) {
         // Re-sort to find lowest pulse count index (is probably delimiter)
-        histogram_sort_count(&hist_pulses);
-        int p1 = hist_pulses.bins[1].mean;
-        int p2 = hist_pulses.bins[2].mean;
+        histogram_sort_count(hist_pulses);
+        int p1 = hist_pulses->bins[1].mean;
+        int p2 = hist_pulses->bins[2].mean;
         device->modulation  = (package_type == PULSE_DATA_FSK) ? FSK_PULSE_PWM : OOK_PULSE_PWM;
-        device->short_width = to_us * (p1 < p2 ? p1 : p2);                                // Set to shorter pulse width
-        device->long_width  = to_us * (p1 < p2 ? p2 : p1);                                // Set to longer pulse width
-        device->sync_width  = to_us * hist_pulses.bins[0].mean;                           // Set to lowest count pulse width
-        device->reset_limit = to_us * (hist_gaps.bins[hist_gaps.bins_count - 1].max + 1); // Set limit above biggest gap
+        device->short_width = to_us * (p1 < p2 ? p1 : p2);                                  // Set to shorter pulse width
+        device->long_width  = to_us * (p1 < p2 ? p2 : p1);                                  // Set to longer pulse width
+        device->sync_width  = to_us * hist_pulses->bins[0].mean;                            // Set to lowest count pulse width
+        device->reset_limit = to_us * (hist_gaps->bins[hist_gaps->bins_count - 1].max + 1); // Set limit above biggest gap
+        return "Pulse Width Modulation with sync/delimiter";
+    }
+    return "No clue...";
+}
+
+/// Format the flex decoder options of a guessed modulation, returns 0 if the modulation is not supported.
+static int flex_spec(r_device const *device, char *spec, size_t size)
+{
+    switch (device->modulation) {
+    case FSK_PULSE_PCM:
+        snprintf(spec, size, "-X 'n=name,m=FSK_PCM,s=%.0f,l=%.0f,r=%.0f'",
+                device->short_width, device->long_width, device->reset_limit);
+        return 1;
+    case OOK_PULSE_PPM:
+        snprintf(spec, size, "-X 'n=name,m=OOK_PPM,s=%.0f,l=%.0f,g=%.0f,r=%.0f'",
+                device->short_width, device->long_width,
+                device->gap_limit, device->reset_limit);
+        return 1;
+    case OOK_PULSE_PWM:
+        snprintf(spec, size, "-X 'n=name,m=OOK_PWM,s=%.0f,l=%.0f,r=%.0f,g=%.0f,t=%.0f,y=%.0f'",
+                device->short_width, device->long_width, device->reset_limit,
+                device->gap_limit, device->tolerance, device->sync_width);
+        return 1;
+    case FSK_PULSE_PWM:
+        snprintf(spec, size, "-X 'n=name,m=FSK_PWM,s=%.0f,l=%.0f,r=%.0f,g=%.0f,t=%.0f,y=%.0f'",
+                device->short_width, device->long_width, device->reset_limit,
+                device->gap_limit, device->tolerance, device->sync_width);
+        return 1;
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+        snprintf(spec, size, "-X 'n=name,m=OOK_MC_ZEROBIT,s=%.0f,l=%.0f,r=%.0f'",
+                device->short_width, device->long_width, device->reset_limit);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/// Analyze the statistics of a pulse data structure and print result
+void pulse_analyzer(pulse_data_t *data, int package_type, r_device* device)
+{
+    if (data->num_pulses == 0) {
+        fprintf(stderr, "No pulses detected.\n");
+        return;
     }
-    else {
-        fprintf(stderr, "No clue...\n");
+
+    double to_ms = 1e3 / data->sample_rate;
+    double to_us = 1e6 / data->sample_rate;
+
+    package_hists_t hists;
+    histogram_t *hist_gaps    = &hists.gaps;
+    histogram_t *hist_timings = &hists.timings;
+    int pulse_total_period = package_hists(&hists, data, 1);
+    if (pulse_total_period < 0) {
+        return;
     }
 
+    fprintf(stderr, "Analyzing pulses...\n");
+    fprintf(stderr, "Total count: %4u,  width: %4.2f ms\t\t(%5i S)\n",
+            data->num_pulses, pulse_total_period * to_ms, pulse_total_period);
+    fprintf(stderr, "Pulse width distribution:\n");
+    histogram_print(&hists.pulses, data->sample_rate);
+    fprintf(stderr, "Gap width distribution:\n");
+    histogram_print(&hists.gaps, data->sample_rate);
+    fprintf(stderr, "Pulse+gap period distribution:\n");
+    histogram_print(&hists.periods_pg, data->sample_rate);
+    fprintf(stderr, "Gap+pulse period distribution:\n");
+    histogram_print(&hists.periods_gp, data->sample_rate);
+    fprintf(stderr, "Timing distribution:\n");
+    histogram_print(&hists.timings, data->sample_rate);
+    fprintf(stderr, "Level estimates [high, low]: %6i, %6i\n",
+            data->ook_high_estimate, data->ook_low_estimate);
+    fprintf(stderr, "RSSI: %.1f dB SNR: %.1f dB Noise: %.1f dB\n",
+            data->rssi_db, data->snr_db, data->noise_db);
+    fprintf(stderr, "Frequency offsets [F1, F2]:  %6i, %6i\t(%+.1f kHz, %+.1f kHz)\n",
+            data->fsk_f1_est, data->fsk_f2_est,
+            (float)data->fsk_f1_est / INT16_MAX * data->sample_rate / 2.0 / 1000.0,
+            (float)data->fsk_f2_est / INT16_MAX * data->sample_rate / 2.0 / 1000.0);
+
+    device->name    = "Analyzer Device";
+    device->verbose = 2;
+    fprintf(stderr, "Guessing modulation: %s\n", guess_modulation(&hists, package_type, data->num_pulses, to_us, device));
+
     // Output RfRaw line (if possible)
-    if (hist_timings.bins_count <= 8) {
+    if (hist_timings->bins_count <= 8) {
         // if there is no 3rd gap length output one long B1 code
-        if (hist_gaps.bins_count <= 2) {
+        if (hist_gaps->bins_count <= 2) {
             hexstr_t hexstr = {.p = {0}};
             hexstr_push_byte(&hexstr, 0xaa);
             hexstr_push_byte(&hexstr, 0xb1);
-            hexstr_push_byte(&hexstr, hist_timings.bins_count);
-            for (unsigned b = 0; b < hist_timings.bins_count; ++b) {
-                double w = hist_timings.bins[b].mean * to_us;
+            hexstr_push_byte(&hexstr, hist_timings->bins_count);
+            for (unsigned b = 0; b < hist_timings->bins_count; ++b) {
+                double w = hist_timings->bins[b].mean * to_us;
                 hexstr_push_word(&hexstr, w < USHRT_MAX ? w : USHRT_MAX);
             }
             for (unsigned i = 0; i < data->num_pulses; ++i) {
-                int p = histogram_find_bin_index(&hist_timings, data->pulse[i]);
-                int g = histogram_find_bin_index(&hist_timings, data->gap[i]);
+                int p = histogram_find_bin_index(hist_timings, data->pulse[i]);
+                int g = histogram_find_bin_index(hist_timings, data->gap[i]);
                 if (p < 0 || g < 0) {
                     fprintf(stderr, "%s: this can't happen\n", __func__);
                     exit(1);
@@ -383,8 +293,8 @@ void pulse_analyzer(pulse_data_t *data, int package_type, r_device* device)
         // otherwise try to group as B0 codes
         else {
             // pick last gap length but a most the 4th
-            int limit_bin = MIN(3, hist_gaps.bins_count - 1);
-            int limit = hist_gaps.bins[limit_bin].min;
+            int limit_bin = MIN(3, hist_gaps->bins_count - 1);
+            int limit = hist_gaps->bins[limit_bin].min;
             hexstr_t hexstrs[HEXSTR_MAX_COUNT] = {{.p = {0}}};
             unsigned hexstr_cnt = 0;
             unsigned i = 0;
@@ -393,15 +303,15 @@ void pulse_analyzer(pulse_data_t *data, int package_type, r_device* device)
                 hexstr_push_byte(hexstr, 0xaa);
                 hexstr_push_byte(hexstr, 0xb0);
                 hexstr_push_byte(hexstr, 0); // len
-                hexstr_push_byte(hexstr, hist_timings.bins_count);
+                hexstr_push_byte(hexstr, hist_timings->bins_count);
                 hexstr_push_byte(hexstr, 1); // repeats
-                for (unsigned b = 0; b < hist_timings.bins_count; ++b) {
-                    double w =hist_timings.bins[b].mean * to_us;
+                for (unsigned b = 0; b < hist_timings->bins_count; ++b) {
+                    double w =hist_timings->bins[b].mean * to_us;
                     hexstr_push_word(hexstr, w < USHRT_MAX ? w : USHRT_MAX);
                 }
                 for (; i < data->num_pulses; ++i) {
-                    int p = histogram_find_bin_index(&hist_timings, data->pulse[i]);
-                    int g = histogram_find_bin_index(&hist_timings, data->gap[i]);
+                    int p = histogram_find_bin_index(hist_timings, data->pulse[i]);
+                    int g = histogram_find_bin_index(hist_timings, data->gap[i]);
                     if (p < 0 || g < 0) {
                         fprintf(stderr, "%s: this can't happen\n", __func__);
                         exit(1);
@@ -438,46 +348,183 @@ void pulse_analyzer(pulse_data_t *data, int package_type, r_device* device)
 
     // Demodulate (if detected)
     if (device->modulation) {
+        bitbuffer_t bits = {0};
         fprintf(stderr, "Attempting demodulation... short_width: %.0f, long_width: %.0f, reset_limit: %.0f, sync_width: %.0f\n",
                 device->short_width, device->long_width,
                 device->reset_limit, device->sync_width);
-        switch (device->modulation) {
-        case FSK_PULSE_PCM:
-            fprintf(stderr, "Use a flex decoder with -X 'n=name,m=FSK_PCM,s=%.0f,l=%.0f,r=%.0f'\n",
-                    device->short_width, device->long_width, device->reset_limit);
-            pulse_slicer_pcm(data, device);
-            break;
-        case OOK_PULSE_PPM:
-            fprintf(stderr, "Use a flex decoder with -X 'n=name,m=OOK_PPM,s=%.0f,l=%.0f,g=%.0f,r=%.0f'\n",
-                    device->short_width, device->long_width,
-                    device->gap_limit, device->reset_limit);
-            data->gap[data->num_pulses - 1] = device->reset_limit / to_us + 1; // Be sure to terminate package
-            pulse_slicer_ppm(data, device);
-            break;
-        case OOK_PULSE_PWM:
-            fprintf(stderr, "Use a flex decoder with -X 'n=name,m=OOK_PWM,s=%.0f,l=%.0f,r=%.0f,g=%.0f,t=%.0f,y=%.0f'\n",
-                    device->short_width, device->long_width, device->reset_limit,
-                    device->gap_limit, device->tolerance, device->sync_width);
-            data->gap[data->num_pulses - 1] = device->reset_limit / to_us + 1; // Be sure to terminate package
-            pulse_slicer_pwm(data, device);
-            break;
-        case FSK_PULSE_PWM:
-            fprintf(stderr, "Use a flex decoder with -X 'n=name,m=FSK_PWM,s=%.0f,l=%.0f,r=%.0f,g=%.0f,t=%.0f,y=%.0f'\n",
-                    device->short_width, device->long_width, device->reset_limit,
-                    device->gap_limit, device->tolerance, device->sync_width);
-            data->gap[data->num_pulses - 1] = device->reset_limit / to_us + 1; // Be sure to terminate package
-            pulse_slicer_pwm(data, device);
-            break;
-        case OOK_PULSE_MANCHESTER_ZEROBIT:
-            fprintf(stderr, "Use a flex decoder with -X 'n=name,m=OOK_MC_ZEROBIT,s=%.0f,l=%.0f,r=%.0f'\n",
-                    device->short_width, device->long_width, device->reset_limit);
-            data->gap[data->num_pulses - 1] = device->reset_limit / to_us + 1; // Be sure to terminate package
-            pulse_slicer_manchester_zerobit(data, device);
-            break;
-        default:
+        char spec[256];
+        if (!flex_spec(device, spec, sizeof(spec))) {
             fprintf(stderr, "Unsupported\n");
         }
+        else {
+            fprintf(stderr, "Use a flex decoder with %s\n", spec);
+            if (device->modulation != FSK_PULSE_PCM) {
+                data->gap[data->num_pulses - 1] = device->reset_limit / to_us + 1; // Be sure to terminate package
+            }
+            switch (device->modulation) {
+            case FSK_PULSE_PCM:
+                pulse_slicer_pcm(data, device, &bits);
+                break;
+            case OOK_PULSE_PPM:
+                pulse_slicer_ppm(data, device, &bits);
+                break;
+            case OOK_PULSE_MANCHESTER_ZEROBIT:
+                pulse_slicer_manchester_zerobit(data, device, &bits);
+                break;
+            default:
+                pulse_slicer_pwm(data, device, &bits);
+            }
+        }
     }
 
     fprintf(stderr, "\n");
 }
+
+/// Most groups of guessed modulations kept by a batch, the packages of further groups count as other.
+#define BATCH_MAX_GROUPS 64
+
+/// Packages with the same guess and widths, the widths are summed in us.
+typedef struct batch_group {
+    char const *guess;   ///< the description of the guess
+    unsigned modulation; ///< the guessed modulation, 0 if none
+    unsigned count;
+    unsigned pulses;
+    double short_width;
+    double long_width;
+    double gap_limit;
+    double sync_width;
+    double tolerance;
+    double reset_limit; ///< the largest reset limit
+} batch_group_t;
+
+struct pulse_analyzer_batch {
+    unsigned packages;
+    unsigned fsk_packages;
+    unsigned other; ///< packages of the groups beyond BATCH_MAX_GROUPS
+    unsigned groups_count;
+    batch_group_t groups[BATCH_MAX_GROUPS];
+};
+
+pulse_analyzer_batch_t *pulse_analyzer_batch_create(void)
+{
+    pulse_analyzer_batch_t *batch = calloc(1, sizeof(*batch));
+    if (!batch) {
+        WARN_CALLOC("pulse_analyzer_batch_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    return batch;
+}
+
+void pulse_analyzer_batch_free(pulse_analyzer_batch_t *batch)
+{
+    free(batch);
+}
+
+static int same_width(double sum_a, unsigned count_a, double sum_b, unsigned count_b)
+{
+    double a = sum_a / count_a;
+    double b = sum_b / count_b;
+    return fabs(a - b) <= TOLERANCE * MAX(a, b);
+}
+
+// add a group to the batch, into the group with the same guess and widths if any
+static void batch_add_group(pulse_analyzer_batch_t *batch, batch_group_t const *add)
+{
+    for (unsigned i = 0; i < batch->groups_count; ++i) {
+        batch_group_t *group = &batch->groups[i];
+        if (group->modulation == add->modulation && !strcmp(group->guess, add->guess)
+                && same_width(group->short_width, group->count, add->short_width, add->count)
+                && same_width(group->long_width, group->count, add->long_width, add->count)) {
+            group->count += add->count;
+            group->pulses += add->pulses;
+            group->short_width += add->short_width;
+            group->long_width += add->long_width;
+            group->gap_limit += add->gap_limit;
+            group->sync_width += add->sync_width;
+            group->tolerance += add->tolerance;
+            group->reset_limit = MAX(group->reset_limit, add->reset_limit);
+            return;
+        }
+    }
+    if (batch->groups_count == BATCH_MAX_GROUPS) {
+        batch->other += add->count;
+        return;
+    }
+    batch->groups[batch->groups_count++] = *add;
+}
+
+void pulse_analyzer_batch_add(pulse_analyzer_batch_t *batch, pulse_data_t const *data, int package_type)
+{
+    if (data->num_pulses == 0) {
+        return;
+    }
+    package_hists_t hists;
+    if (package_hists(&hists, data, 0) < 0) {
+        return;
+    }
+    r_device device = {0};
+    char const *guess = guess_modulation(&hists, package_type, data->num_pulses, 1e6 / data->sample_rate, &device);
+
+    batch->packages++;
+    batch->fsk_packages += package_type == PULSE_DATA_FSK;
+    batch_group_t group = {
+            .guess       = guess,
+            .modulation  = device.modulation,
+            .count       = 1,
+            .pulses      = data->num_pulses,
+            .short_width = device.short_width,
+            .long_width  = device.long_width,
+            .gap_limit   = device.gap_limit,
+            .sync_width  = device.sync_width,
+            .tolerance   = device.tolerance,
+            .reset_limit = device.reset_limit,
+    };
+    batch_add_group(batch, &group);
+}
+
+void pulse_analyzer_batch_merge(pulse_analyzer_batch_t *batch, pulse_analyzer_batch_t const *other)
+{
+    batch->packages += other->packages;
+    batch->fsk_packages += other->fsk_packages;
+    batch->other += other->other;
+    for (unsigned i = 0; i < other->groups_count; ++i) {
+        batch_add_group(batch, &other->groups[i]);
+    }
+}
+
+static int cmp_group_count(void const *a, void const *b)
+{
+    batch_group_t const *group_a = a;
+    batch_group_t const *group_b = b;
+    return (group_a->count < group_b->count) - (group_a->count > group_b->count);
+}
+
+void pulse_analyzer_batch_print(pulse_analyzer_batch_t *batch)
+{
+    qsort(batch->groups, batch->groups_count, sizeof(*batch->groups), cmp_group_count);
+
+    fprintf(stderr, "Analyzed %u packages (%u FSK) in %u groups:\n",
+            batch->packages, batch->fsk_packages, batch->groups_count);
+    for (unsigned i = 0; i < batch->groups_count; ++i) {
+        batch_group_t const *group = &batch->groups[i];
+        fprintf(stderr, " [%2u] count: %5u, pulses: %4u, %s\n", i,
+                group->count, group->pulses / group->count, group->guess);
+        // the mean widths of the group, above the largest reset limit
+        r_device device = {
+                .modulation  = group->modulation,
+                .short_width = group->short_width / group->count,
+                .long_width  = group->long_width / group->count,
+                .gap_limit   = group->gap_limit / group->count,
+                .sync_width  = group->sync_width / group->count,
+                .tolerance   = group->tolerance / group->count,
+                .reset_limit = group->reset_limit,
+        };
+        char spec[256];
+        if (flex_spec(&device, spec, sizeof(spec))) {
+            fprintf(stderr, "      Use a flex decoder with %s\n", spec);
+        }
+    }
+    if (batch->other) {
+        fprintf(stderr, "      %u packages in further groups\n", batch->other);
+    }
+}
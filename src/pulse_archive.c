@@ -0,0 +1,390 @@
+/** @file
+    Binary indexed archive of pulse data packages.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "pulse_archive.h"
+
+#include "pulse_data.h"
+#include "pulse_net.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(ESP32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Encoding */
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    p = put_u32(p, (uint32_t)v);
+    return put_u32(p, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u32(uint8_t const *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(uint8_t const *p)
+{
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+static void put_header(uint8_t *p, uint32_t sample_rate, unsigned depth_bits, uint64_t count, uint64_t index_pos, int64_t created_us)
+{
+    *p++ = 'R';
+    *p++ = 'P';
+    *p++ = 'A';
+    *p++ = PULSE_ARCHIVE_VERSION;
+    p = put_u32(p, PULSE_ARCHIVE_HEADER_SIZE);
+    p = put_u32(p, sample_rate);
+    p = put_u32(p, depth_bits);
+    p = put_u64(p, count);
+    p = put_u64(p, index_pos);
+    put_u64(p, (uint64_t)created_us);
+}
+
+/* Writer */
+
+struct pulse_archive_writer {
+    FILE *file;
+    int seekable;         ///< the index and header can be written on close
+    int failed;           ///< a write failed, the archive is incomplete
+    uint64_t pos;         ///< bytes written
+    uint64_t count;       ///< packages written
+    uint32_t sample_rate; ///< of the first package
+    unsigned depth_bits;  ///< of the first package
+    int64_t created_us;
+    uint8_t *buf;         ///< the record being written
+    size_t buf_size;
+    uint8_t *index;       ///< the encoded index entries
+    size_t index_size;
+};
+
+pulse_archive_writer_t *pulse_archive_writer_open(FILE *file, uint32_t sample_rate)
+{
+    pulse_archive_writer_t *writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        WARN_CALLOC("pulse_archive_writer_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    struct timeval now;
+    get_time_now(&now);
+    writer->file        = file;
+    writer->seekable    = fseek(file, 0, SEEK_CUR) == 0;
+    writer->sample_rate = sample_rate;
+    writer->created_us  = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+
+    uint8_t header[PULSE_ARCHIVE_HEADER_SIZE];
+    put_header(header, sample_rate, 0, 0, 0, writer->created_us);
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        print_log(LOG_ERROR, __func__, "Writing the pulse archive header failed");
+        free(writer);
+        return NULL;
+    }
+    writer->pos = sizeof(header);
+
+    return writer;
+}
+
+int pulse_archive_write(pulse_archive_writer_t *writer, pulse_data_t const *data, int package_type)
+{
+    if (writer->failed)
+        return -1;
+
+    // each width takes at most five bytes
+    size_t size = PULSE_ARCHIVE_RECORD_SIZE + PULSE_NET_HEADER_SIZE + (size_t)data->num_pulses * 10;
+    if (size > writer->buf_size) {
+        uint8_t *buf = realloc(writer->buf, size);
+        if (!buf) {
+            WARN_REALLOC("pulse_archive_write()");
+            writer->failed = 1;
+            return -1;
+        }
+        writer->buf      = buf;
+        writer->buf_size = size;
+    }
+    if ((writer->count + 1) * PULSE_ARCHIVE_INDEX_SIZE > writer->index_size) {
+        size_t index_size = writer->index_size ? writer->index_size * 2 : 4096 * PULSE_ARCHIVE_INDEX_SIZE;
+        uint8_t *index    = realloc(writer->index, index_size);
+        if (!index) {
+            WARN_REALLOC("pulse_archive_write()");
+            writer->failed = 1;
+            return -1;
+        }
+        writer->index      = index;
+        writer->index_size = index_size;
+    }
+
+    int64_t time_us = data->received_us;
+    if (!time_us) {
+        struct timeval now;
+        get_time_now(&now);
+        time_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    }
+    size_t len = pulse_net_encode(data, package_type, (uint32_t)writer->count, writer->buf + PULSE_ARCHIVE_RECORD_SIZE, writer->buf_size - PULSE_ARCHIVE_RECORD_SIZE);
+    uint8_t *p = put_u32(writer->buf, (uint32_t)len);
+    put_u64(p, (uint64_t)time_us);
+    len += PULSE_ARCHIVE_RECORD_SIZE;
+    if (fwrite(writer->buf, 1, len, writer->file) != len) {
+        print_log(LOG_ERROR, __func__, "Writing the pulse archive failed, the archive is incomplete");
+        writer->failed = 1;
+        return -1;
+    }
+
+    p = put_u64(&writer->index[writer->count * PULSE_ARCHIVE_INDEX_SIZE], writer->pos);
+    put_u64(p, (uint64_t)time_us);
+    if (!writer->count) {
+        writer->sample_rate = data->sample_rate;
+        writer->depth_bits  = data->depth_bits;
+    }
+    writer->pos += len;
+    writer->count += 1;
+    return 0;
+}
+
+int pulse_archive_writer_close(pulse_archive_writer_t *writer)
+{
+    if (!writer)
+        return 0;
+
+    int ret = writer->failed ? -1 : 0;
+    // a pipe has no index, the reader scans the records
+    if (!writer->failed && writer->seekable) {
+        size_t index_len = writer->count * PULSE_ARCHIVE_INDEX_SIZE;
+        uint8_t header[PULSE_ARCHIVE_HEADER_SIZE];
+        put_header(header, writer->sample_rate, writer->depth_bits, writer->count, writer->pos, writer->created_us);
+        if (fwrite(writer->index, 1, index_len, writer->file) != index_len
+                || fseek(writer->file, 0, SEEK_SET) != 0
+                || fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)
+                || fseek(writer->file, 0, SEEK_END) != 0) {
+            print_log(LOG_ERROR, __func__, "Writing the pulse archive index failed");
+            ret = -1;
+        }
+    }
+    if (fflush(writer->file) != 0)
+        ret = -1;
+
+    free(writer->buf);
+    free(writer->index);
+    free(writer);
+    return ret;
+}
+
+/* Reader */
+
+struct pulse_archive {
+    uint8_t const *buf;
+    size_t size;
+    int mapped;           ///< the buf is a mapping, allocated otherwise
+    uint8_t const *index; ///< in the buf, or the index_buf if the index was scanned
+    uint8_t *index_buf;
+    unsigned count;
+    uint32_t sample_rate;
+};
+
+// map a regular file, NULL for pipes, empty files, or if mapping fails
+static uint8_t *map_file(FILE *file, size_t *size)
+{
+#if !defined(_WIN32) && !defined(ESP32)
+    int fd = fileno(file);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX)
+        return NULL;
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+    *size = (size_t)st.st_size;
+    return map;
+#else
+    (void)file;
+    (void)size;
+    return NULL;
+#endif
+}
+
+static uint8_t *read_file(FILE *file, size_t *size)
+{
+    uint8_t *buf    = NULL;
+    size_t len      = 0;
+    size_t buf_size = 0;
+    while (1) {
+        if (len == buf_size) {
+            buf_size     = buf_size ? buf_size * 2 : 1024 * 1024;
+            uint8_t *tmp = realloc(buf, buf_size);
+            if (!tmp) {
+                WARN_REALLOC("pulse_archive_open()");
+                free(buf);
+                return NULL;
+            }
+            buf = tmp;
+        }
+        size_t n = fread(buf + len, 1, buf_size - len, file);
+        if (!n)
+            break;
+        len += n;
+    }
+    *size = len;
+    return buf;
+}
+
+// build the index of an archive without one, a truncated last record is dropped
+static int scan_index(pulse_archive_t *archive)
+{
+    size_t index_size = 0;
+    unsigned count    = 0;
+    size_t pos        = PULSE_ARCHIVE_HEADER_SIZE;
+    while (archive->size - pos >= PULSE_ARCHIVE_RECORD_SIZE && count < UINT32_MAX) {
+        size_t len = get_u32(&archive->buf[pos]);
+        if (archive->size - pos - PULSE_ARCHIVE_RECORD_SIZE < len)
+            break;
+        if (((size_t)count + 1) * PULSE_ARCHIVE_INDEX_SIZE > index_size) {
+            index_size     = index_size ? index_size * 2 : 4096 * PULSE_ARCHIVE_INDEX_SIZE;
+            uint8_t *index = realloc(archive->index_buf, index_size);
+            if (!index) {
+                WARN_REALLOC("pulse_archive_open()");
+                return -1;
+            }
+            archive->index_buf = index;
+        }
+        uint8_t *p = put_u64(&archive->index_buf[count * PULSE_ARCHIVE_INDEX_SIZE], pos);
+        put_u64(p, get_u64(&archive->buf[pos + 4]));
+        pos += PULSE_ARCHIVE_RECORD_SIZE + len;
+        count += 1;
+    }
+    archive->index = archive->index_buf;
+    archive->count = count;
+    return 0;
+}
+
+pulse_archive_t *pulse_archive_open(FILE *file)
+{
+    pulse_archive_t *archive = calloc(1, sizeof(*archive));
+    if (!archive) {
+        WARN_CALLOC("pulse_archive_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    archive->buf = map_file(file, &archive->size);
+    if (archive->buf) {
+        archive->mapped = 1;
+    }
+    else {
+        archive->buf = read_file(file, &archive->size);
+        if (!archive->buf) {
+            free(archive);
+            return NULL;
+        }
+    }
+
+    uint8_t const *header = archive->buf;
+    if (archive->size < PULSE_ARCHIVE_HEADER_SIZE
+            || header[0] != 'R' || header[1] != 'P' || header[2] != 'A' || header[3] != PULSE_ARCHIVE_VERSION
+            || get_u32(&header[4]) != PULSE_ARCHIVE_HEADER_SIZE) {
+        print_log(LOG_ERROR, __func__, "Not a pulse archive");
+        pulse_archive_close(archive);
+        return NULL;
+    }
+    archive->sample_rate = get_u32(&header[8]);
+
+    uint64_t count     = get_u64(&header[16]);
+    uint64_t index_pos = get_u64(&header[24]);
+    if (index_pos && count <= UINT32_MAX && index_pos <= archive->size
+            && (archive->size - index_pos) / PULSE_ARCHIVE_INDEX_SIZE >= count) {
+        archive->index = &archive->buf[index_pos];
+        archive->count = (unsigned)count;
+    }
+    else if (scan_index(archive) < 0) {
+        pulse_archive_close(archive);
+        return NULL;
+    }
+
+    return archive;
+}
+
+void pulse_archive_close(pulse_archive_t *archive)
+{
+    if (!archive)
+        return;
+
+#if !defined(_WIN32) && !defined(ESP32)
+    if (archive->mapped)
+        munmap((void *)archive->buf, archive->size);
+#endif
+    if (!archive->mapped)
+        free((void *)archive->buf);
+    free(archive->index_buf);
+    free(archive);
+}
+
+unsigned pulse_archive_count(pulse_archive_t const *archive)
+{
+    return archive->count;
+}
+
+uint32_t pulse_archive_sample_rate(pulse_archive_t const *archive)
+{
+    return archive->sample_rate;
+}
+
+int64_t pulse_archive_time(pulse_archive_t const *archive, unsigned idx)
+{
+    return (int64_t)get_u64(&archive->index[(size_t)idx * PULSE_ARCHIVE_INDEX_SIZE + 8]);
+}
+
+unsigned pulse_archive_seek(pulse_archive_t const *archive, int64_t time_us)
+{
+    unsigned lo = 0;
+    unsigned hi = archive->count;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (pulse_archive_time(archive, mid) < time_us)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int pulse_archive_read(pulse_archive_t const *archive, unsigned idx, pulse_data_t *data)
+{
+    if (idx >= archive->count)
+        return 0;
+
+    uint64_t pos = get_u64(&archive->index[(size_t)idx * PULSE_ARCHIVE_INDEX_SIZE]);
+    if (pos > archive->size || archive->size - pos < PULSE_ARCHIVE_RECORD_SIZE)
+        return 0;
+    uint8_t const *record = &archive->buf[pos];
+    size_t len = get_u32(record);
+    if (archive->size - pos - PULSE_ARCHIVE_RECORD_SIZE < len)
+        return 0;
+
+    int package_type = pulse_net_decode(record + PULSE_ARCHIVE_RECORD_SIZE, len, data, NULL);
+    if (package_type)
+        data->received_us = (int64_t)get_u64(record + 4);
+    return package_type;
+}
@@ -18,18 +18,124 @@
 #include <stdlib.h>
 #include <string.h>
 
+/// Initial room of the store, it doubles as needed.
+#define PD_STORE_MIN_PULSES 256
+
 void pulse_data_clear(pulse_data_t *data)
 {
+    *data = (pulse_data_t const){
+            .max_pulses = data->max_pulses,
+            .capacity   = data->capacity,
+            .pulse      = data->pulse,
+            .gap        = data->gap,
+            .start      = data->start,
+    };
+    if (data->capacity) {
+        data->pulse[0] = 0;
+        data->gap[0]   = 0;
+    }
+}
+
+void pulse_data_free(pulse_data_t *data)
+{
+    free(data->pulse); // the gaps and the index are in the same block
     *data = (pulse_data_t const){0};
 }
 
+void pulse_data_grow(pulse_data_t *data, unsigned num_pulses)
+{
+    unsigned capacity = data->capacity ? data->capacity : PD_STORE_MIN_PULSES;
+    while (capacity < num_pulses) {
+        capacity *= 2;
+    }
+
+    // pulses, gaps, and the starts of the index share one block, in thirds
+    int *store = calloc(3 * capacity, sizeof(*store));
+    if (!store) {
+        FATAL_CALLOC("pulse_data_grow()");
+    }
+    if (data->capacity) {
+        memcpy(store, data->pulse, data->capacity * sizeof(*store));
+        memcpy(&store[capacity], data->gap, data->capacity * sizeof(*store));
+        memcpy(&store[2 * capacity], data->start, data->capacity * sizeof(*store));
+    }
+    free(data->pulse);
+    data->pulse    = store;
+    data->gap      = &store[capacity];
+    data->start    = &store[2 * capacity];
+    data->capacity = capacity;
+}
+
+void pulse_data_index(pulse_data_t *data)
+{
+    unsigned const num_pulses = data->num_pulses;
+    data->indexed = 0;
+    if (!num_pulses)
+        return;
+    // the total duration is the start after the last pulse
+    pulse_data_reserve(data, num_pulses + 1);
+
+    int const *pulse = data->pulse;
+    int const *gap   = data->gap;
+    int *start       = data->start;
+    int pulse_min = pulse[0], pulse_max = pulse[0];
+    int gap_min = gap[0], gap_max = gap[0];
+    int period_min = pulse[0] + gap[0], period_max = period_min;
+    int pos = 0;
+    for (unsigned n = 0; n < num_pulses; ++n) {
+        int period = pulse[n] + gap[n];
+        start[n]   = pos;
+        pos += period;
+        pulse_min  = pulse[n] < pulse_min ? pulse[n] : pulse_min;
+        pulse_max  = pulse[n] > pulse_max ? pulse[n] : pulse_max;
+        gap_min    = gap[n] < gap_min ? gap[n] : gap_min;
+        gap_max    = gap[n] > gap_max ? gap[n] : gap_max;
+        period_min = period < period_min ? period : period_min;
+        period_max = period > period_max ? period : period_max;
+    }
+    start[num_pulses] = pos;
+
+    data->pulse_min  = pulse_min;
+    data->pulse_max  = pulse_max;
+    data->gap_min    = gap_min;
+    data->gap_max    = gap_max;
+    data->period_min = period_min;
+    data->period_max = period_max;
+    data->indexed    = num_pulses;
+}
+
+void pulse_data_copy(pulse_data_t *dst, pulse_data_t const *src)
+{
+    unsigned const num_pulses = src->num_pulses;
+    pulse_data_reserve(dst, num_pulses + 1);
+
+    pulse_data_t const store = *dst;
+    *dst            = *src;
+    dst->max_pulses = store.max_pulses;
+    dst->capacity   = store.capacity;
+    dst->pulse      = store.pulse;
+    dst->gap        = store.gap;
+    dst->start      = store.start;
+    dst->indexed    = 0;
+    if (num_pulses) {
+        memcpy(dst->pulse, src->pulse, num_pulses * sizeof(*dst->pulse));
+        memcpy(dst->gap, src->gap, num_pulses * sizeof(*dst->gap));
+    }
+    // the entry at num_pulses reads as zero
+    dst->pulse[num_pulses] = 0;
+    dst->gap[num_pulses]   = 0;
+}
+
 void pulse_data_shift(pulse_data_t *data)
 {
-    int offs = PD_MAX_PULSES / 2; // shift out half the data
-    memmove(data->pulse, &data->pulse[offs], (PD_MAX_PULSES - offs) * sizeof(*data->pulse));
-    memmove(data->gap, &data->gap[offs], (PD_MAX_PULSES - offs) * sizeof(*data->gap));
+    unsigned offs = pulse_data_max_pulses(data) / 2; // shift out half the data
+    if (offs > data->num_pulses)
+        offs = data->num_pulses;
+    memmove(data->pulse, &data->pulse[offs], (data->num_pulses - offs) * sizeof(*data->pulse));
+    memmove(data->gap, &data->gap[offs], (data->num_pulses - offs) * sizeof(*data->gap));
     data->num_pulses -= offs;
     data->offset += offs;
+    data->indexed = 0;
 }
 
 void pulse_data_print(pulse_data_t const *data)
@@ -119,11 +225,110 @@ void pulse_data_print_vcd(FILE *file, pulse_data_t const *data, int ch_id)
         chk_ret(fprintf(file, "#%.f 0/\n", pos * scale));
 }
 
+void pulse_data_print_rle_header(FILE *file, uint32_t sample_rate)
+{
+    uint8_t header[12] = {'R', 'L', 'E', '4', '3', '3', 0, 1};
+    for (int i = 0; i < 4; ++i)
+        header[8 + i] = (uint8_t)(sample_rate >> (8 * i));
+    chk_ret(fwrite(header, 1, sizeof(header), file) == sizeof(header) ? 0 : -1);
+}
+
+// a run of a state, the length as unsigned LEB128
+static void print_rle_run(FILE *file, uint8_t state, uint64_t len)
+{
+    uint8_t buf[11];
+    unsigned n = 0;
+    buf[n++]   = state;
+    do {
+        buf[n++] = (uint8_t)((len & 0x7f) | (len > 0x7f ? 0x80 : 0));
+        len >>= 7;
+    } while (len);
+    chk_ret(fwrite(buf, 1, n, file) == n ? 0 : -1);
+}
+
+uint64_t pulse_data_dump_rle(FILE *file, uint64_t pos, pulse_data_t const *data, uint8_t bits)
+{
+    uint64_t end = data->offset;
+    if (end > pos) {
+        print_rle_run(file, 0x00, end - pos);
+        pos = end;
+    }
+    // an overlap with a package already written is clipped
+    for (unsigned n = 0; n < data->num_pulses; ++n) {
+        end += data->pulse[n];
+        if (end > pos) {
+            print_rle_run(file, 0x01 | bits, end - pos);
+            pos = end;
+        }
+        end += data->gap[n];
+        if (end > pos) {
+            print_rle_run(file, 0x01, end - pos);
+            pos = end;
+        }
+    }
+    return pos;
+}
+
+void pulse_data_print_rle_end(FILE *file, uint64_t pos, uint64_t end)
+{
+    if (end > pos)
+        print_rle_run(file, 0x00, end - pos);
+}
+
+// parse a time as printed by usecs_time_str() with the time zone, 0 on error
+static int64_t parse_received_us(char const *s)
+{
+    int year, mon, day, hour, min, sec, usec, len = 0;
+    if (sscanf(s, "%d-%d-%d %d:%d:%d.%6d%n", &year, &mon, &day, &hour, &min, &sec, &usec, &len) != 7)
+        return 0;
+    s += len;
+    int tz_min = 0;
+    if (*s == '+' || *s == '-') {
+        int tz = atoi(s + 1);
+        tz_min = (tz / 100 * 60 + tz % 100) * (*s == '-' ? -1 : 1);
+    }
+    else if (*s != 'Z') {
+        return 0; // local time without a zone
+    }
+    // days since the epoch of the civil date
+    year -= mon <= 2;
+    int era      = (year >= 0 ? year : year - 399) / 400;
+    int yoe      = year - era * 400;
+    int doy      = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe      = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+    int64_t secs = days * 86400 + hour * 3600 + min * 60 + sec - tz_min * 60;
+    return secs * 1000000 + usec;
+}
+
+// parse the package info of a header line of the OOK text format
+static void parse_header_line(pulse_data_t *data, char const *s)
+{
+    if (!strncmp(s, ";received ", 10))
+        data->received_us = parse_received_us(s + 10);
+    else if (!strncmp(s, ";freq1 ", 7))
+        data->freq1_hz = strtol(s + 7, NULL, 10);
+    else if (!strncmp(s, ";freq2 ", 7))
+        data->freq2_hz = strtol(s + 7, NULL, 10);
+    else if (!strncmp(s, ";centerfreq ", 12))
+        data->centerfreq_hz = strtol(s + 12, NULL, 10);
+    else if (!strncmp(s, ";sampledepth ", 13))
+        data->depth_bits = strtol(s + 13, NULL, 10);
+    else if (!strncmp(s, ";range ", 7))
+        data->range_db = strtof(s + 7, NULL);
+    else if (!strncmp(s, ";rssi ", 6))
+        data->rssi_db = strtof(s + 6, NULL);
+    else if (!strncmp(s, ";snr ", 5))
+        data->snr_db = strtof(s + 5, NULL);
+    else if (!strncmp(s, ";noise ", 7))
+        data->noise_db = strtof(s + 7, NULL);
+}
+
 void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
 {
     char s[1024];
-    int i    = 0;
-    int size = sizeof(data->pulse) / sizeof(*data->pulse);
+    unsigned i    = 0;
+    unsigned size = pulse_data_max_pulses(data);
 
     pulse_data_clear(data);
     data->sample_rate = sample_rate;
@@ -131,17 +336,12 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
     // read line-by-line
     while (i < size && fgets(s, sizeof(s), file)) {
         // TODO: we should parse sample rate and timescale
-        if (!strncmp(s, ";freq1", 6)) {
-            data->freq1_hz = strtol(s + 6, NULL, 10);
-        }
-        if (!strncmp(s, ";freq2", 6)) {
-            data->freq2_hz = strtol(s + 6, NULL, 10);
-        }
         if (*s == ';') {
             if (i) {
                 break; // end or next header found
             }
             else {
+                parse_header_line(data, s);
                 continue; // still reading a header
             }
         }
@@ -157,6 +357,7 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
         p          = endptr + 1;
         long space = strtol(p, &endptr, 10);
         // fprintf(stderr, "read: mark %ld space %ld\n", mark, space);
+        pulse_data_reserve(data, i + 1);
         data->pulse[i] = (int)(to_sample * mark);
         data->gap[i++] = (int)(to_sample * space);
     }
@@ -187,7 +388,13 @@ void pulse_data_dump(FILE *file, pulse_data_t const *data)
 
     char time_str[LOCAL_TIME_BUFLEN];
 
-    chk_ret(fprintf(file, ";received %s\n", usecs_time_str(time_str, NULL, 1, 0)));
+    // a loaded package keeps its receive time
+    struct timeval received = {0};
+    if (data->received_us) {
+        received.tv_sec  = (time_t)(data->received_us / 1000000);
+        received.tv_usec = (long)(data->received_us % 1000000);
+    }
+    chk_ret(fprintf(file, ";received %s\n", usecs_time_str(time_str, NULL, 1, data->received_us ? &received : NULL)));
     if (data->fsk_f2_est) {
         chk_ret(fprintf(file, ";fsk %u pulses\n", data->num_pulses));
         chk_ret(fprintf(file, ";freq1 %.0f\n", data->freq1_hz));
@@ -212,20 +419,37 @@ void pulse_data_dump(FILE *file, pulse_data_t const *data)
     chk_ret(fprintf(file, ";end\n"));
 }
 
-data_t *pulse_data_print_data(pulse_data_t const *data)
+data_t *pulse_data_print_data(pulse_data_t const *data, int rfraw)
 {
-    int pulses[2 * PD_MAX_PULSES];
-    double to_us = 1e6 / data->sample_rate;
-    for (unsigned i = 0; i < data->num_pulses; ++i) {
-        pulses[i * 2 + 0] = data->pulse[i] * to_us;
-        pulses[i * 2 + 1] = data->gap[i] * to_us;
+    // an RfRaw code is two hex digits for each pulse and gap instead of an array of the widths
+    char *code          = NULL;
+    int *pulses         = NULL;
+    unsigned num_widths = 0;
+    if (rfraw) {
+        code = rfraw_encode(data);
+        if (!code)
+            return NULL;
+    }
+    else {
+        pulses = malloc(2 * (data->num_pulses + 1) * sizeof(*pulses));
+        if (!pulses) {
+            WARN_MALLOC("pulse_data_print_data()");
+            return NULL;
+        }
+        double to_us = 1e6 / data->sample_rate;
+        for (unsigned i = 0; i < data->num_pulses; ++i) {
+            pulses[i * 2 + 0] = data->pulse[i] * to_us;
+            pulses[i * 2 + 1] = data->gap[i] * to_us;
+        }
+        num_widths = 2 * data->num_pulses;
     }
 
     /* clang-format off */
-    return data_make(
+    data_t *out = data_make(
             "mod",              "", DATA_STRING, (data->fsk_f2_est) ? "FSK" : "OOK",
             "count",            "", DATA_INT,    data->num_pulses,
-            "pulses",           "", DATA_ARRAY,  data_array(2 * data->num_pulses, DATA_INT, pulses),
+            "pulses",           "", DATA_COND,   !rfraw, DATA_ARRAY, data_array(num_widths, DATA_INT, pulses),
+            "rfraw",            "", DATA_COND,   rfraw, DATA_STRING, code,
             "freq1_Hz",         "", DATA_FORMAT, "%u Hz", DATA_INT, (unsigned)data->freq1_hz,
             "freq2_Hz",         "", DATA_COND,   data->fsk_f2_est, DATA_FORMAT, "%u Hz", DATA_INT, (unsigned)data->freq2_hz,
             "freq_Hz",          "", DATA_INT,    (unsigned)data->centerfreq_hz,
@@ -237,4 +461,7 @@ data_t *pulse_data_print_data(pulse_data_t const *data)
             "noise_dB",         "", DATA_FORMAT, "%.1f dB", DATA_DOUBLE, data->noise_db,
             NULL);
     /* clang-format on */
+    free(pulses);
+    free(code);
+    return out;
 }
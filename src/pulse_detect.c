@@ -20,12 +20,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 // OOK adaptive level estimator constants
-#define OOK_MAX_HIGH_LEVEL  DB_TO_AMP(0)   // Maximum estimate for high level (-0 dB)
-#define OOK_MAX_LOW_LEVEL   DB_TO_AMP(-15) // Maximum estimate for low level
+#define OOK_MAX_HIGH_LEVEL  16384       // DB_TO_AMP(0), maximum estimate for high level (-0 dB)
+#define OOK_MAX_LOW_LEVEL   518         // DB_TO_AMP(-15), maximum estimate for low level
 #define OOK_EST_HIGH_RATIO  64          // Constant for slowness of OOK high level estimator
 #define OOK_EST_LOW_RATIO   1024        // Constant for slowness of OOK low level (noise) estimator (very slow)
 
+/// Samples checked per step of the idle scan, a multiple of 8.
+#define PD_IDLE_SCAN_LEN    64
+
 /// Internal state data for pulse_pulse_package()
 struct pulse_detect {
     int use_mag_est;          ///< Whether the envelope data is an amplitude or magnitude.
@@ -39,8 +48,9 @@ struct pulse_detect {
         PD_OOK_STATE_GAP_START = 2,
         PD_OOK_STATE_GAP       = 3,
     } ook_state;
-    int pulse_length; ///< Counter for internal pulse detection
-    int max_pulse;    ///< Size of biggest pulse detected
+    int pulse_length;    ///< Counter for internal pulse detection
+    int max_pulse;       ///< Size of biggest pulse detected
+    unsigned max_gap_us; ///< Gap to exceed to declare End Of Package, 0 for PD_MAX_GAP_MS
 
     int data_counter;    ///< Counter for how much of data chunk is processed
     int lead_in_counter; ///< Counter for allowing initial noise estimate to settle
@@ -83,6 +93,45 @@ void pulse_detect_reset(pulse_detect_t *pulse_detect)
     pulse_detect_fsk_init(&pulse_detect->pulse_detect_fsk);
 }
 
+void pulse_detect_get_levels(pulse_detect_t const *pulse_detect, pulse_detect_levels_t *levels)
+{
+    levels->ook_low_estimate  = pulse_detect->ook_low_estimate;
+    levels->ook_high_estimate = pulse_detect->ook_high_estimate;
+    levels->lead_in_counter   = pulse_detect->lead_in_counter;
+}
+
+int pulse_detect_carrier_level(pulse_detect_t const *pulse_detect)
+{
+    // the threshold is at least half the minimum high level, a pulse lasts down to the threshold less the hysteresis
+    int threshold = pulse_detect->ook_fixed_high_level;
+    if (threshold == 0)
+        threshold = MIN(pulse_detect->ook_min_high_level, OOK_MAX_HIGH_LEVEL) / 2;
+    return threshold - threshold / 8 - 2; // the low estimate may be slightly negative
+}
+
+unsigned pulse_detect_ook_pending(pulse_detect_t const *pulse_detect, pulse_data_t *pulses)
+{
+    if (pulse_detect->ook_state == PD_OOK_STATE_IDLE)
+        return 0;
+    // the pulse and gap being measured are not stored yet
+    pulses->ook_low_estimate  = pulse_detect->ook_low_estimate;
+    pulses->ook_high_estimate = pulse_detect->ook_high_estimate;
+    return pulses->num_pulses;
+}
+
+void pulse_detect_restore_levels(pulse_detect_t *pulse_detect, pulse_detect_levels_t const *levels)
+{
+    pulse_detect_reset(pulse_detect);
+    pulse_detect->ook_low_estimate  = levels->ook_low_estimate;
+    pulse_detect->ook_high_estimate = levels->ook_high_estimate;
+    pulse_detect->lead_in_counter   = levels->lead_in_counter;
+}
+
+void pulse_detect_set_max_gap(pulse_detect_t *pulse_detect, unsigned max_gap_us)
+{
+    pulse_detect->max_gap_us = max_gap_us;
+}
+
 void pulse_detect_set_levels(pulse_detect_t *pulse_detect, int use_mag_est, float fixed_high_level, float min_high_level, float high_low_ratio, int verbosity)
 {
     pulse_detect->use_mag_est = use_mag_est;
@@ -195,11 +244,115 @@ static void print_att_hist(char const *s, int att_hist[])
     }
 }
 
+/// Find the minimum and maximum of a block of PD_IDLE_SCAN_LEN envelope samples.
+static void idle_block_minmax(int16_t const *buf, int *min_out, int *max_out)
+{
+#if defined(__SSE2__)
+    __m128i vmin = _mm_loadu_si128((__m128i const *)buf);
+    __m128i vmax = vmin;
+    for (int i = 8; i < PD_IDLE_SCAN_LEN; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&buf[i]);
+        vmin = _mm_min_epi16(vmin, v);
+        vmax = _mm_max_epi16(vmax, v);
+    }
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 8));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 8));
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 4));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 4));
+    vmin = _mm_min_epi16(vmin, _mm_srli_si128(vmin, 2));
+    vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 2));
+    *min_out = (int16_t)_mm_cvtsi128_si32(vmin);
+    *max_out = (int16_t)_mm_cvtsi128_si32(vmax);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    int16x8_t vmin = vld1q_s16(buf);
+    int16x8_t vmax = vmin;
+    for (int i = 8; i < PD_IDLE_SCAN_LEN; i += 8) {
+        int16x8_t v = vld1q_s16(&buf[i]);
+        vmin = vminq_s16(vmin, v);
+        vmax = vmaxq_s16(vmax, v);
+    }
+    *min_out = vminvq_s16(vmin);
+    *max_out = vmaxvq_s16(vmax);
+#else
+    int lo = buf[0];
+    int hi = buf[0];
+    for (int i = 1; i < PD_IDLE_SCAN_LEN; ++i) {
+        lo = MIN(lo, buf[i]);
+        hi = MAX(hi, buf[i]);
+    }
+    *min_out = lo;
+    *max_out = hi;
+#endif
+}
+
+/// Level an idle sample must exceed to start a package, for a given low (noise) estimate.
+static int idle_trigger_level(pulse_detect_t const *pulse_detect, int ook_low_estimate)
+{
+    int const ook_high_estimate = MAX(pulse_detect->ook_high_low_ratio * ook_low_estimate, pulse_detect->ook_min_high_level);
+    int16_t ook_threshold = (ook_low_estimate + MIN(ook_high_estimate, OOK_MAX_HIGH_LEVEL)) / 2;
+    if (pulse_detect->ook_fixed_high_level != 0) {
+        ook_threshold = pulse_detect->ook_fixed_high_level;
+    }
+    int16_t const ook_hysteresis = ook_threshold / 8;
+    return ook_threshold + ook_hysteresis;
+}
+
+/** Skip ahead over idle samples that can not start a package.
+
+    The trigger level only grows with the low estimate, and the low estimate can only
+    fall by a bounded step per sample, so if the block maximum is below the trigger
+    level for the lowest reachable estimate no sample in the block triggers. The noise
+    estimate is then updated over the block exactly as the state machine would.
+
+    @return number of samples skipped, a multiple of PD_IDLE_SCAN_LEN
+*/
+static int pulse_detect_idle_scan(pulse_detect_t *pulse_detect, int16_t const *envelope_data, int len)
+{
+    pulse_detect_t *s = pulse_detect;
+    int low = s->ook_low_estimate;
+    int pos = 0;
+    while (len - pos >= PD_IDLE_SCAN_LEN) {
+        int16_t const *buf = &envelope_data[pos];
+        int am_min, am_max;
+        idle_block_minmax(buf, &am_min, &am_max);
+        // bound the low estimate over the block
+        int const low_hi  = MAX(low, am_max);
+        int const low_min = low - PD_IDLE_SCAN_LEN * ((low_hi - am_min) / OOK_EST_LOW_RATIO + 1);
+        if (am_max > idle_trigger_level(pulse_detect, low_min)) {
+            break;
+        }
+        for (int i = 0; i < PD_IDLE_SCAN_LEN; ++i) {
+            int const ook_low_delta = buf[i] - low;
+            low += ook_low_delta / OOK_EST_LOW_RATIO;
+            low += ((ook_low_delta > 0) ? 1 : -1);
+        }
+        pos += PD_IDLE_SCAN_LEN;
+    }
+    if (pos) {
+        s->ook_low_estimate  = low;
+        s->ook_high_estimate = MAX(pulse_detect->ook_high_low_ratio * low, pulse_detect->ook_min_high_level);
+    }
+    return pos;
+}
+
+/// Run the FSK detector over a span of FM samples.
+static void pulse_detect_fsk_span(pulse_detect_t *pulse_detect, int16_t const *fm_data, int from, int to, pulse_data_t *fsk_pulses, unsigned fpdm)
+{
+    if (fpdm == FSK_PULSE_DETECT_OLD) {
+        pulse_detect_fsk_classic_block(&pulse_detect->pulse_detect_fsk, &fm_data[from], to - from, fsk_pulses);
+    } else {
+        pulse_detect_fsk_minmax_block(&pulse_detect->pulse_detect_fsk, &fm_data[from], to - from, fsk_pulses);
+    }
+}
+
 /// Demodulate On/Off Keying (OOK) and Frequency Shift Keying (FSK) from an envelope signal
 int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_data, int16_t const *fm_data, int len, uint32_t samp_rate, uint64_t sample_offset, pulse_data_t *pulses, pulse_data_t *fsk_pulses, unsigned fpdm)
 {
     int att_hist[37] = {0};
     int const samples_per_ms = samp_rate / 1000;
+    // the gap limits, the heuristic minimum gap is at most the maximum gap
+    int const max_gap = pulse_detect->max_gap_us ? (int)((uint64_t)pulse_detect->max_gap_us * samp_rate / 1000000) : PD_MAX_GAP_MS * samples_per_ms;
+    int const min_gap = MIN(PD_MIN_GAP_MS * samples_per_ms, max_gap);
     pulse_detect_t *s = pulse_detect;
     s->ook_high_estimate = MAX(s->ook_high_estimate, pulse_detect->ook_min_high_level);    // Be sure to set initial minimum level
 
@@ -210,8 +363,33 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
     }
 
     int eop_on_spurious = 0;
+    int scan_resume = s->data_counter;
+    int fsk_from = -1; // start of the samples pending for the FSK detector, -1 if none
     // Process all new samples
     while (s->data_counter < len) {
+        // FSK Demodulation runs only during the first pulse (and its short gaps), collect that span
+        int const fsk_sample = (s->ook_state == PD_OOK_STATE_PULSE || s->ook_state == PD_OOK_STATE_GAP_START) && pulses->num_pulses == 0;
+        if (fsk_sample && fsk_from < 0) {
+            fsk_from = s->data_counter;
+        }
+        else if (!fsk_sample && fsk_from >= 0) {
+            pulse_detect_fsk_span(s, fm_data, fsk_from, s->data_counter, fsk_pulses, fpdm);
+            fsk_from = -1;
+        }
+
+        // Fast path for settled idle, the histogram needs every sample
+        if (s->ook_state == PD_OOK_STATE_IDLE
+                && s->data_counter >= scan_resume
+                && s->lead_in_counter > OOK_EST_LOW_RATIO
+                && pulse_detect->verbosity < LOG_NOTICE
+                && s->ook_high_estimate == MAX(pulse_detect->ook_high_low_ratio * s->ook_low_estimate, pulse_detect->ook_min_high_level)) {
+            s->data_counter += pulse_detect_idle_scan(s, &envelope_data[s->data_counter], len - s->data_counter);
+            // step the state machine over at least one block before scanning again
+            scan_resume = s->data_counter + PD_IDLE_SCAN_LEN;
+            if (s->data_counter >= len) {
+                break;
+            }
+        }
         // Calculate OOK detection threshold and hysteresis
         int16_t const am_n    = envelope_data[s->data_counter];
         if (pulse_detect->verbosity >= LOG_NOTICE) {
@@ -232,6 +410,7 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                     // Initialize all data
                     pulse_data_clear(pulses);
                     pulse_data_clear(fsk_pulses);
+                    pulse_data_reserve(pulses, 1);
                     pulses->sample_rate = samp_rate;
                     fsk_pulses->sample_rate = samp_rate;
                     pulses->offset = sample_offset + s->data_counter;
@@ -285,14 +464,7 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                     // Estimate pulse carrier frequency
                     pulses->fsk_f1_est += fm_data[s->data_counter] / OOK_EST_HIGH_RATIO - pulses->fsk_f1_est / OOK_EST_HIGH_RATIO;
                 }
-                // FSK Demodulation
-                if (pulses->num_pulses == 0) {    // Only during first pulse
-                    if (fpdm == FSK_PULSE_DETECT_OLD) {
-                        pulse_detect_fsk_classic(&s->pulse_detect_fsk, fm_data[s->data_counter], fsk_pulses);
-                    } else {
-                        pulse_detect_fsk_minmax(&s->pulse_detect_fsk, fm_data[s->data_counter], fsk_pulses);
-                    }
-                }
+                // FSK Demodulation is run in spans, see fsk_from
                 break;
             case PD_OOK_STATE_GAP_START:    // Beginning of gap - it might be a spurious gap
                 s->pulse_length += 1;
@@ -304,6 +476,11 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                 // Or this gap is for real?
                 else if (s->pulse_length >= PD_MIN_PULSE_SAMPLES) {
                     s->ook_state = PD_OOK_STATE_GAP;
+                    // Catch up the FSK detector, this sample is still pending
+                    if (fsk_from >= 0) {
+                        pulse_detect_fsk_span(s, fm_data, fsk_from, s->data_counter, fsk_pulses, fpdm);
+                        fsk_from = s->data_counter;
+                    }
                     // Determine if FSK modulation is detected
                     if (fsk_pulses->num_pulses > PD_MIN_PULSES) {
                         // Store last pulse/gap
@@ -331,13 +508,6 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                     }
                 } // if
                 // FSK Demodulation (continue during short gap - we might return...)
-                if (pulses->num_pulses == 0) {    // Only during first pulse
-                    if (fpdm == FSK_PULSE_DETECT_OLD) {
-                        pulse_detect_fsk_classic(&s->pulse_detect_fsk, fm_data[s->data_counter], fsk_pulses);
-                    } else {
-                        pulse_detect_fsk_minmax(&s->pulse_detect_fsk, fm_data[s->data_counter], fsk_pulses);
-                    }
-                }
                 break;
             case PD_OOK_STATE_GAP:
                 s->pulse_length += 1;
@@ -347,7 +517,7 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                     pulses->num_pulses += 1;    // Next pulse
 
                     // EOP if too many pulses
-                    if (pulses->num_pulses >= PD_MAX_PULSES) {
+                    if (pulses->num_pulses >= pulse_data_max_pulses(pulses)) {
                         s->ook_state = PD_OOK_STATE_IDLE;
                         // Store estimates
                         pulses->ook_low_estimate = s->ook_low_estimate;
@@ -358,6 +528,7 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                         }
                         return PULSE_DATA_OOK;    // End Of Package!!
                     }
+                    pulse_data_start_pulse(pulses);
 
                     s->pulse_length = 0;
                     s->ook_state = PD_OOK_STATE_PULSE;
@@ -366,8 +537,8 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                 // EOP if gap is too long
                 if (eop_on_spurious
                         || (s->pulse_length > (PD_MAX_GAP_RATIO * s->max_pulse)    // gap/pulse ratio exceeded
-                            && s->pulse_length > (PD_MIN_GAP_MS * samples_per_ms)) // Minimum gap exceeded
-                        || s->pulse_length > (PD_MAX_GAP_MS * samples_per_ms)) {   // maximum gap exceeded
+                            && s->pulse_length > min_gap)                          // Minimum gap exceeded
+                        || s->pulse_length > max_gap) {                            // maximum gap exceeded
                     pulses->gap[pulses->num_pulses] = s->pulse_length;    // Store gap width
                     pulses->num_pulses += 1;    // Store last pulse
                     s->ook_state = PD_OOK_STATE_IDLE;
@@ -395,6 +566,9 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
         s->data_counter += 1;
     } // while
 
+    if (fsk_from >= 0) {
+        pulse_detect_fsk_span(s, fm_data, fsk_from, len, fsk_pulses, fpdm);
+    }
     s->data_counter = 0;
     if (pulse_detect->verbosity >= LOG_DEBUG) {
         print_att_hist("Out of data", att_hist);
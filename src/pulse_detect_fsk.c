@@ -31,7 +31,7 @@ void pulse_detect_fsk_init(pulse_detect_fsk_t *s)
     s->skip_samples = 40;
 }
 
-void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
+static inline void fsk_classic_sample(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
 {
     int const fm_f1_delta = abs(fm_n - s->fm_f1_est); // Get delta from F1 frequency estimate
     int const fm_f2_delta = abs(fm_n - s->fm_f2_est); // Get delta from F2 frequency estimate
@@ -53,6 +53,7 @@ void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t
                     fsk_pulses->pulse[0] = 0;        // Initial frequency was a gap...
                     fsk_pulses->gap[0] = s->fsk_pulse_length;        // Store gap width
                     fsk_pulses->num_pulses += 1;
+                    pulse_data_start_pulse(fsk_pulses);
                     s->fsk_pulse_length = 0;
                 }
                 // Negative Frequency delta - Initial frequency was high (pulse)
@@ -107,12 +108,13 @@ void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t
                     fsk_pulses->num_pulses += 1;    // Go to next pulse
                     s->fsk_pulse_length = 0;
                     // When pulse buffer is full go to error state
-                    if (fsk_pulses->num_pulses >= PD_MAX_PULSES) {
+                    if (fsk_pulses->num_pulses >= pulse_data_max_pulses(fsk_pulses)) {
                         //fprintf(stderr, "pulse_detect_fsk_classic(): Maximum number of pulses reached!\n");
                         //s->fsk_state = PD_FSK_STATE_ERROR;
                         // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
                         pulse_data_shift(fsk_pulses);
                     }
+                    pulse_data_start_pulse(fsk_pulses);
                 }
                 // Else rewind to last pulse
                 else {
@@ -140,9 +142,25 @@ void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t
     } // switch(s->fsk_state)
 }
 
+void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
+{
+    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
+    fsk_classic_sample(s, fm_n, fsk_pulses);
+}
+
+void pulse_detect_fsk_classic_block(pulse_detect_fsk_t *s, int16_t const *fm_data, int len, pulse_data_t *fsk_pulses)
+{
+    // the store keeps room for the next pulse, it grows as pulses are added
+    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
+    for (int i = 0; i < len; ++i) {
+        fsk_classic_sample(s, fm_data[i], fsk_pulses);
+    }
+}
+
 void pulse_detect_fsk_wrap_up(pulse_detect_fsk_t *s, pulse_data_t *fsk_pulses)
 {
-    if (fsk_pulses->num_pulses < PD_MAX_PULSES) { // Avoid overflow
+    if (fsk_pulses->num_pulses < pulse_data_max_pulses(fsk_pulses)) { // Avoid overflow
+        pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
         s->fsk_pulse_length += 1;
         if (s->fsk_state == PD_FSK_STATE_FH) {
             fsk_pulses->pulse[fsk_pulses->num_pulses] = s->fsk_pulse_length; // Store last pulse
@@ -155,7 +173,7 @@ void pulse_detect_fsk_wrap_up(pulse_detect_fsk_t *s, pulse_data_t *fsk_pulses)
     }
 }
 
-void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
+static inline void fsk_minmax_sample(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
 {
     int16_t mid = 0;
 
@@ -198,12 +216,13 @@ void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *
                     fsk_pulses->num_pulses += 1;
                     s->fsk_pulse_length = 0;
                     // When pulse buffer is full go to error state
-                    if (fsk_pulses->num_pulses >= PD_MAX_PULSES) {
+                    if (fsk_pulses->num_pulses >= pulse_data_max_pulses(fsk_pulses)) {
                         //fprintf(stderr, "pulse_detect_fsk_minmax(): Maximum number of pulses reached!\n");
                         //s->fsk_state = PD_FSK_STATE_ERROR;
                         // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
                         pulse_data_shift(fsk_pulses);
                     }
+                    pulse_data_start_pulse(fsk_pulses);
                 }
                 s->fm_f1_est += fm_n / FSK_EST_SLOW - s->fm_f1_est / FSK_EST_SLOW; // Slow estimator
                 break;
@@ -219,3 +238,18 @@ void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *
         s->skip_samples -= 1;
     }
 }
+
+void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses)
+{
+    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
+    fsk_minmax_sample(s, fm_n, fsk_pulses);
+}
+
+void pulse_detect_fsk_minmax_block(pulse_detect_fsk_t *s, int16_t const *fm_data, int len, pulse_data_t *fsk_pulses)
+{
+    // the store keeps room for the next pulse, it grows as pulses are added
+    pulse_data_reserve(fsk_pulses, fsk_pulses->num_pulses + 1);
+    for (int i = 0; i < len; ++i) {
+        fsk_minmax_sample(s, fm_data[i], fsk_pulses);
+    }
+}
@@ -0,0 +1,448 @@
+/** @file
+    Binary pulse data transport between remote receivers and a central decoder.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "pulse_net.h"
+
+#include "pulse_data.h"
+#include "pulse_detect.h"
+#include "compat_atomic.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+    #if !defined(_WIN32_WINNT) || (_WIN32_WINNT < 0x0600)
+    #undef _WIN32_WINNT
+    #define _WIN32_WINNT 0x0600   /* Needed to pull in 'struct sockaddr_storage' */
+    #endif
+
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+
+    #define SOCKET          int
+    #define INVALID_SOCKET  (-1)
+    #define closesocket(x)  close(x)
+#endif
+
+#ifdef _WIN32
+    #define perror(str)           ws2_perror(str)
+
+    static void ws2_perror (const char *str)
+    {
+        if (str && *str)
+            fprintf(stderr, "%s: ", str);
+        fprintf(stderr, "Winsock error %d.\n", WSAGetLastError());
+    }
+#endif
+
+/* Encoding */
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    p = put_u32(p, (uint32_t)v);
+    return put_u32(p, (uint32_t)(v >> 32));
+}
+
+static uint8_t *put_f32(uint8_t *p, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return put_u32(p, v);
+}
+
+static uint32_t get_u32(uint8_t const *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(uint8_t const *p)
+{
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+static float get_f32(uint8_t const *p)
+{
+    uint32_t v = get_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+size_t pulse_net_encode(pulse_data_t const *data, int package_type, uint32_t seq, uint8_t *dst, size_t size)
+{
+    if (size < PULSE_NET_HEADER_SIZE)
+        return 0;
+
+    uint8_t *p = dst;
+    *p++ = PULSE_NET_MAGIC0;
+    *p++ = PULSE_NET_MAGIC1;
+    *p++ = PULSE_NET_VERSION;
+    *p++ = (uint8_t)package_type;
+    p = put_u32(p, seq);
+    p = put_u64(p, data->offset);
+    p = put_u32(p, data->sample_rate);
+    p = put_u32(p, data->num_pulses);
+    p = put_u32(p, (uint32_t)data->ook_low_estimate);
+    p = put_u32(p, (uint32_t)data->ook_high_estimate);
+    p = put_u32(p, (uint32_t)data->fsk_f1_est);
+    p = put_u32(p, (uint32_t)data->fsk_f2_est);
+    p = put_f32(p, data->centerfreq_hz);
+    p = put_f32(p, data->freq1_hz);
+    p = put_f32(p, data->freq2_hz);
+    p = put_f32(p, data->rssi_db);
+    p = put_f32(p, data->snr_db);
+    p = put_f32(p, data->noise_db);
+    p = put_f32(p, data->range_db);
+    *p++ = (uint8_t)data->depth_bits;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+
+    uint8_t *end = dst + size;
+    for (unsigned i = 0; i < data->num_pulses; ++i) {
+        int const widths[2] = {data->pulse[i], data->gap[i]};
+        for (int j = 0; j < 2; ++j) {
+            uint32_t v = widths[j] > 0 ? (uint32_t)widths[j] : 0;
+            do {
+                if (p >= end)
+                    return 0;
+                *p++ = (uint8_t)((v & 0x7f) | (v > 0x7f ? 0x80 : 0));
+                v >>= 7;
+            } while (v);
+        }
+    }
+
+    return (size_t)(p - dst);
+}
+
+int pulse_net_decode(uint8_t const *src, size_t len, pulse_data_t *data, uint32_t *seq)
+{
+    if (len < PULSE_NET_HEADER_SIZE
+            || src[0] != PULSE_NET_MAGIC0 || src[1] != PULSE_NET_MAGIC1 || src[2] != PULSE_NET_VERSION
+            || (src[3] != PULSE_DATA_OOK && src[3] != PULSE_DATA_FSK))
+        return 0;
+
+    unsigned num_pulses = get_u32(&src[20]);
+    // every pulse takes at least two bytes
+    if (num_pulses > PD_MAX_PULSES_LIMIT || num_pulses > (len - PULSE_NET_HEADER_SIZE) / 2)
+        return 0;
+
+    pulse_data_clear(data);
+    if (seq)
+        *seq = get_u32(&src[4]);
+    data->offset            = get_u64(&src[8]);
+    data->sample_rate       = get_u32(&src[16]);
+    data->ook_low_estimate  = (int)get_u32(&src[24]);
+    data->ook_high_estimate = (int)get_u32(&src[28]);
+    data->fsk_f1_est        = (int)get_u32(&src[32]);
+    data->fsk_f2_est        = (int)get_u32(&src[36]);
+    data->centerfreq_hz     = get_f32(&src[40]);
+    data->freq1_hz          = get_f32(&src[44]);
+    data->freq2_hz          = get_f32(&src[48]);
+    data->rssi_db           = get_f32(&src[52]);
+    data->snr_db            = get_f32(&src[56]);
+    data->noise_db          = get_f32(&src[60]);
+    data->range_db          = get_f32(&src[64]);
+    data->depth_bits        = src[68];
+
+    // keep room for the zero entry at num_pulses
+    pulse_data_reserve(data, num_pulses + 1);
+    uint8_t const *p   = src + PULSE_NET_HEADER_SIZE;
+    uint8_t const *end = src + len;
+    for (unsigned i = 0; i < num_pulses * 2; ++i) {
+        uint32_t v = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (p >= end || shift > 28) {
+                pulse_data_clear(data);
+                return 0;
+            }
+            v |= (uint32_t)(*p & 0x7f) << shift;
+            if (!(*p++ & 0x80))
+                break;
+        }
+        if (v > INT32_MAX) {
+            pulse_data_clear(data);
+            return 0;
+        }
+        if (i & 1)
+            data->gap[i / 2] = (int)v;
+        else
+            data->pulse[i / 2] = (int)v;
+    }
+    data->num_pulses = num_pulses;
+    data->pulse[num_pulses] = 0;
+    data->gap[num_pulses]   = 0;
+
+    return src[3];
+}
+
+/* UDP output */
+
+struct pulse_output {
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    SOCKET sock;
+    unsigned seq; ///< next sequence number, shared by all channels and receivers
+};
+
+pulse_output_t *pulse_output_udp_create(char const *host, char const *port)
+{
+    pulse_output_t *output = calloc(1, sizeof(*output));
+    if (!output) {
+        WARN_CALLOC("pulse_output_udp_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    output->sock = INVALID_SOCKET;
+#ifdef _WIN32
+    WSADATA wsa;
+
+    if (WSAStartup(MAKEWORD(2,2),&wsa) != 0) {
+        perror("WSAStartup()");
+        free(output);
+        return NULL;
+    }
+#endif
+
+    struct addrinfo hints, *res, *res0;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = PF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = AI_ADDRCONFIG;
+    int error = getaddrinfo(host, port, &hints, &res0);
+    if (error) {
+        print_log(LOG_ERROR, __func__, gai_strerror(error));
+        free(output);
+        return NULL;
+    }
+    for (res = res0; res; res = res->ai_next) {
+        SOCKET sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (sock != INVALID_SOCKET) {
+            output->sock = sock;
+            memcpy(&output->addr, res->ai_addr, res->ai_addrlen);
+            output->addr_len = res->ai_addrlen;
+            break; // success
+        }
+    }
+    freeaddrinfo(res0);
+    if (output->sock == INVALID_SOCKET) {
+        perror("socket");
+        free(output);
+        return NULL;
+    }
+
+    return output;
+}
+
+void pulse_output_send(pulse_output_t *output, pulse_data_t const *data, int package_type)
+{
+    if (!output)
+        return;
+
+    uint8_t message[PULSE_NET_DATAGRAM_MAX];
+    uint32_t seq = atomic_fetch_add_unsigned(&output->seq, 1);
+    size_t len = pulse_net_encode(data, package_type, seq, message, sizeof(message));
+    if (!len) {
+        print_logf(LOG_WARNING, "Pulses UDP", "Package of %u pulses is too large to send", data->num_pulses);
+        return;
+    }
+
+    int r = sendto(output->sock, (char const *)message, len, 0, (struct sockaddr *)&output->addr, output->addr_len);
+    if (r == -1) {
+        perror("sendto");
+    }
+}
+
+void pulse_output_free(pulse_output_t *output)
+{
+    if (!output)
+        return;
+
+    if (output->sock != INVALID_SOCKET) {
+        closesocket(output->sock);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    free(output);
+}
+
+/* UDP input */
+
+/// Number of senders whose sequence numbers are tracked.
+#define PULSE_INPUT_PEERS 16
+
+typedef struct pulse_peer {
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    uint32_t next_seq;
+} pulse_peer_t;
+
+struct pulse_input {
+    SOCKET sock;
+    unsigned lost;
+    unsigned num_peers;
+    pulse_peer_t peers[PULSE_INPUT_PEERS];
+    uint8_t buf[PULSE_NET_DATAGRAM_MAX];
+};
+
+pulse_input_t *pulse_input_udp_open(char const *host, char const *port)
+{
+    pulse_input_t *input = calloc(1, sizeof(*input));
+    if (!input) {
+        WARN_CALLOC("pulse_input_udp_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    input->sock = INVALID_SOCKET;
+#ifdef _WIN32
+    WSADATA wsa;
+
+    if (WSAStartup(MAKEWORD(2,2),&wsa) != 0) {
+        perror("WSAStartup()");
+        free(input);
+        return NULL;
+    }
+#endif
+
+    struct addrinfo hints, *res, *res0;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = PF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = AI_PASSIVE;
+    int error = getaddrinfo(host, port, &hints, &res0);
+    if (error) {
+        print_log(LOG_ERROR, __func__, gai_strerror(error));
+        free(input);
+        return NULL;
+    }
+    for (res = res0; res; res = res->ai_next) {
+        SOCKET sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (sock == INVALID_SOCKET)
+            continue;
+        if (bind(sock, res->ai_addr, res->ai_addrlen) == 0) {
+            input->sock = sock;
+            break; // success
+        }
+        closesocket(sock);
+    }
+    freeaddrinfo(res0);
+    if (input->sock == INVALID_SOCKET) {
+        perror("bind");
+        pulse_input_close(input);
+        return NULL;
+    }
+
+    return input;
+}
+
+// count the datagrams skipped since the last one of this sender
+static void pulse_input_track(pulse_input_t *input, struct sockaddr_storage const *addr, socklen_t addr_len, uint32_t seq)
+{
+    pulse_peer_t *peer = NULL;
+    for (unsigned i = 0; i < input->num_peers; ++i) {
+        if (input->peers[i].addr_len == addr_len && !memcmp(&input->peers[i].addr, addr, addr_len)) {
+            peer = &input->peers[i];
+            break;
+        }
+    }
+    if (!peer) {
+        // the oldest sender is replaced if there are too many
+        peer = &input->peers[input->num_peers < PULSE_INPUT_PEERS ? input->num_peers++ : 0];
+        memcpy(&peer->addr, addr, addr_len);
+        peer->addr_len = addr_len;
+    }
+    else {
+        uint32_t skipped = seq - peer->next_seq;
+        // a large jump is a restarted sender
+        if (skipped > 0 && skipped < 0x10000)
+            input->lost += skipped;
+    }
+    peer->next_seq = seq + 1;
+}
+
+int pulse_input_recv(pulse_input_t *input, pulse_data_t *data, int timeout_ms)
+{
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(input->sock, &fds);
+    struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    int r = select((int)input->sock + 1, &fds, NULL, NULL, &tv);
+    if (r < 0) {
+        if (errno == EINTR)
+            return 0;
+        perror("select");
+        return -1;
+    }
+    if (r == 0)
+        return 0;
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    int len = recvfrom(input->sock, (char *)input->buf, sizeof(input->buf), 0, (struct sockaddr *)&addr, &addr_len);
+    if (len < 0) {
+        perror("recvfrom");
+        return -1;
+    }
+
+    uint32_t seq = 0;
+    int package_type = pulse_net_decode(input->buf, (size_t)len, data, &seq);
+    if (!package_type) {
+        input->lost += 1;
+        print_logf(LOG_WARNING, "Pulses UDP", "Invalid datagram of %d bytes", len);
+        return 0;
+    }
+    pulse_input_track(input, &addr, addr_len, seq);
+
+    return package_type;
+}
+
+unsigned pulse_input_lost(pulse_input_t const *input)
+{
+    return input ? input->lost : 0;
+}
+
+void pulse_input_close(pulse_input_t *input)
+{
+    if (!input)
+        return;
+
+    if (input->sock != INVALID_SOCKET) {
+        closesocket(input->sock);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    free(input);
+}
@@ -0,0 +1,236 @@
+/** @file
+    Bounded ring of the latest pulse data packages, to dump or re-decode on request.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "pulse_recorder.h"
+
+#include "pulse_archive.h"
+#include "pulse_data.h"
+#include "pulse_net.h"
+#include "r_util.h"
+#include "compat_pthread.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// Header of a package in the ring, followed by the encoded package.
+typedef struct {
+    uint32_t len;    ///< bytes of the encoded package
+    int64_t time_us; ///< receive time in us since the epoch
+} record_t;
+
+struct pulse_recorder {
+    uint8_t *buf;
+    size_t size;      ///< bytes in the ring
+    size_t head;      ///< offset of the oldest package
+    size_t used;      ///< bytes of all packages
+    unsigned count;   ///< number of packages
+    unsigned dropped; ///< packages larger than the ring
+    int64_t keep_us;  ///< the time the packages are kept, 0 for no limit
+    uint8_t *enc;     ///< the package being encoded
+    size_t enc_size;
+#ifdef THREADS
+    pthread_mutex_t lock; ///< the receivers add from their own threads
+#endif
+};
+
+pulse_recorder_t *pulse_recorder_create(unsigned secs, size_t size)
+{
+    pulse_recorder_t *rec = calloc(1, sizeof(*rec));
+    if (!rec) {
+        WARN_CALLOC("pulse_recorder_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    rec->buf = malloc(size);
+    if (!rec->buf) {
+        WARN_MALLOC("pulse_recorder_create()");
+        free(rec);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    rec->size    = size;
+    rec->keep_us = (int64_t)secs * 1000000;
+#ifdef THREADS
+    pthread_mutex_init(&rec->lock, NULL);
+#endif
+    return rec;
+}
+
+void pulse_recorder_free(pulse_recorder_t *rec)
+{
+    if (!rec)
+        return;
+
+#ifdef THREADS
+    pthread_mutex_destroy(&rec->lock);
+#endif
+    free(rec->enc);
+    free(rec->buf);
+    free(rec);
+}
+
+static void ring_read(pulse_recorder_t const *rec, size_t ofs, void *dst, size_t len)
+{
+    ofs %= rec->size;
+    size_t part = rec->size - ofs < len ? rec->size - ofs : len;
+    memcpy(dst, rec->buf + ofs, part);
+    memcpy((uint8_t *)dst + part, rec->buf, len - part);
+}
+
+static void ring_write(pulse_recorder_t *rec, size_t ofs, void const *src, size_t len)
+{
+    ofs %= rec->size;
+    size_t part = rec->size - ofs < len ? rec->size - ofs : len;
+    memcpy(rec->buf + ofs, src, part);
+    memcpy(rec->buf, (uint8_t const *)src + part, len - part);
+}
+
+static void drop_oldest(pulse_recorder_t *rec)
+{
+    record_t oldest;
+    ring_read(rec, rec->head, &oldest, sizeof(oldest));
+    rec->head = (rec->head + sizeof(oldest) + oldest.len) % rec->size;
+    rec->used -= sizeof(oldest) + oldest.len;
+    rec->count -= 1;
+}
+
+int pulse_recorder_add(pulse_recorder_t *rec, pulse_data_t const *data, int package_type)
+{
+    record_t record = {.time_us = data->received_us};
+    if (!record.time_us) {
+        struct timeval now;
+        get_time_now(&now);
+        record.time_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    }
+
+#ifdef THREADS
+    pthread_mutex_lock(&rec->lock);
+#endif
+    int ret = -1;
+    // each width takes at most five bytes
+    size_t size = PULSE_NET_HEADER_SIZE + (size_t)data->num_pulses * 10;
+    if (size > rec->enc_size) {
+        uint8_t *enc = realloc(rec->enc, size);
+        if (!enc) {
+            WARN_REALLOC("pulse_recorder_add()");
+            goto out;
+        }
+        rec->enc      = enc;
+        rec->enc_size = size;
+    }
+    record.len  = (uint32_t)pulse_net_encode(data, package_type, 0, rec->enc, rec->enc_size);
+    size_t need = sizeof(record) + record.len;
+    if (!record.len || need > rec->size) {
+        rec->dropped += 1;
+        goto out;
+    }
+
+    // the oldest first, by the time kept, then to make room
+    while (rec->count && rec->keep_us) {
+        record_t oldest;
+        ring_read(rec, rec->head, &oldest, sizeof(oldest));
+        if (oldest.time_us >= record.time_us - rec->keep_us)
+            break;
+        drop_oldest(rec);
+    }
+    while (rec->used + need > rec->size) {
+        drop_oldest(rec);
+    }
+    size_t ofs = rec->head + rec->used;
+    ring_write(rec, ofs, &record, sizeof(record));
+    ring_write(rec, ofs + sizeof(record), rec->enc, record.len);
+    rec->used += need;
+    rec->count += 1;
+    ret = 0;
+
+out:
+#ifdef THREADS
+    pthread_mutex_unlock(&rec->lock);
+#endif
+    return ret;
+}
+
+void pulse_recorder_stats(pulse_recorder_t *rec, unsigned *count, size_t *used, unsigned *dropped)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&rec->lock);
+#endif
+    *count   = rec->count;
+    *used    = rec->used;
+    *dropped = rec->dropped;
+#ifdef THREADS
+    pthread_mutex_unlock(&rec->lock);
+#endif
+}
+
+int pulse_recorder_replay(pulse_recorder_t *rec, int64_t from_us, int64_t to_us, pulse_recorder_fn fn, void *ctx)
+{
+    // copy the range out, the receivers keep adding while the packages are replayed
+#ifdef THREADS
+    pthread_mutex_lock(&rec->lock);
+#endif
+    uint8_t *copy = malloc(rec->used ? rec->used : 1);
+    if (!copy) {
+        WARN_MALLOC("pulse_recorder_replay()");
+#ifdef THREADS
+        pthread_mutex_unlock(&rec->lock);
+#endif
+        return -1;
+    }
+    size_t len = 0;
+    size_t ofs = rec->head;
+    for (unsigned i = 0; i < rec->count; ++i) {
+        record_t record;
+        ring_read(rec, ofs, &record, sizeof(record));
+        size_t rec_len = sizeof(record) + record.len;
+        if (record.time_us >= from_us && record.time_us < to_us) {
+            ring_read(rec, ofs, copy + len, rec_len);
+            len += rec_len;
+        }
+        ofs += rec_len;
+    }
+#ifdef THREADS
+    pthread_mutex_unlock(&rec->lock);
+#endif
+
+    int count         = 0;
+    pulse_data_t data = {0};
+    for (size_t pos = 0; pos < len;) {
+        record_t record;
+        memcpy(&record, copy + pos, sizeof(record));
+        pos += sizeof(record);
+        int package_type = pulse_net_decode(copy + pos, record.len, &data, NULL);
+        pos += record.len;
+        if (!package_type)
+            continue;
+        data.received_us = record.time_us;
+        fn(ctx, &data, package_type);
+        count += 1;
+    }
+    pulse_data_free(&data);
+    free(copy);
+    return count;
+}
+
+static void write_package(void *ctx, pulse_data_t *data, int package_type)
+{
+    pulse_archive_write(ctx, data, package_type);
+}
+
+int pulse_recorder_write(pulse_recorder_t *rec, FILE *file, int64_t from_us, int64_t to_us)
+{
+    pulse_archive_writer_t *writer = pulse_archive_writer_open(file, 0);
+    if (!writer)
+        return -1;
+    int count = pulse_recorder_replay(rec, from_us, to_us, write_package, writer);
+    if (pulse_archive_writer_close(writer) < 0)
+        return -1;
+    return count;
+}
@@ -16,20 +16,103 @@
 #include "bitbuffer.h"
 #include "c_util.h" // for MIN()
 #include "logger.h"
+#include "fatal.h"
 #include "decoder_util.h" // TODO: this should be refactored
+#include "compat_time.h"
+#include "r_trace.h"
+#include "baseband.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <limits.h>
 
-static int account_event(r_device *device, bitbuffer_t *bits, char const *demod_name)
+/// The precise widths are in 1/256 samples.
+#define SLICER_WIDTH_ONE 256
+/// Widths classified at once into symbols on the stack.
+#define SLICER_SYMBOL_CHUNK 256
+
+// convert the widths of a decoder to samples
+static void slicer_timing_convert(slicer_timing_t *t, r_device const *device, uint32_t sample_rate)
+{
+    float samples_per_us = sample_rate / 1.0e6f;
+
+    t->sample_rate = sample_rate;
+    t->converted   = 1;
+    t->s_short     = device->short_width * samples_per_us;
+    t->s_long      = device->long_width * samples_per_us;
+    t->s_reset     = device->reset_limit * samples_per_us;
+    t->s_gap       = device->gap_limit * samples_per_us;
+    t->s_sync      = device->sync_width * samples_per_us;
+    t->s_tolerance = device->tolerance * samples_per_us;
+
+    // check for rounding to zero
+    t->too_low = (device->short_width > 0 && t->s_short <= 0)
+            || (device->long_width > 0 && t->s_long <= 0)
+            || (device->reset_limit > 0 && t->s_reset <= 0)
+            || (device->gap_limit > 0 && t->s_gap <= 0)
+            || (device->sync_width > 0 && t->s_sync <= 0)
+            || (device->tolerance > 0 && t->s_tolerance <= 0);
+
+    // precise widths, the slicers round to bit periods in integer arithmetic
+    t->q_short = device->short_width > 0.0f ? (int)(device->short_width * samples_per_us * SLICER_WIDTH_ONE + 0.5f) : 0;
+    t->q_long  = device->long_width > 0.0f ? (int)(device->long_width * samples_per_us * SLICER_WIDTH_ONE + 0.5f) : 0;
+}
+
+/// Round a width to bit periods of num / den samples, truncated toward zero like (int)(x + 0.5), 0 without a period.
+static inline int bit_periods(int width, int num, int den)
+{
+    return num > 0 ? (int)((2 * (int64_t)width * den + num) / (2 * (int64_t)num)) : 0;
+}
+
+/// Get the timing of a decoder, converted and checked only once for each sample rate.
+static slicer_timing_t const *slicer_timing(pulse_data_t const *pulses, r_device *device, char const *demod_name)
+{
+    slicer_timing_t *t = &device->timing;
+    if (t->converted && t->sample_rate == pulses->sample_rate) {
+        return t;
+    }
+    slicer_timing_convert(t, device, pulses->sample_rate);
+    if (t->too_low) {
+        print_logf_limited(LOG_WARNING, demod_name, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    }
+    return t;
+}
+
+// the bits are already transformed as the decoder asks for
+// check the declared rows of a decoder, not with verbosity as the decoder may log why it aborts
+static int rows_rejected(r_device const *device, bitbuffer_t const *bits)
+{
+    decoder_rows_t const *r = &device->rows;
+    if (device->verbose) {
+        return 0;
+    }
+    unsigned first = bits->bits_per_row[0];
+    unsigned rows  = bits->num_rows;
+    return (r->min_bits && first < r->min_bits) || (r->max_bits && first > r->max_bits)
+            || (r->min_rows && rows < r->min_rows) || (r->max_rows && rows > r->max_rows);
+}
+
+static int account_transformed_event(r_device *device, bitbuffer_t *bits, char const *demod_name)
 {
     // run decoder
     int ret = 0;
-    if (device->decode_fn) {
+    if (device->decode_fn && rows_rejected(device, bits)) {
+        // what the decoder would return first thing, without the call
+        ret = DECODE_ABORT_LENGTH;
+    }
+    else if (device->decode_fn && device->report_cost) {
+        uint64_t start = time_monotonic_ns();
         ret = device->decode_fn(device, bits);
+        device->decode_ns += time_monotonic_ns() - start;
+        device->decode_calls += 1;
     }
+    else if (device->decode_fn) {
+        ret = device->decode_fn(device, bits);
+    }
+    R_TRACE3(decode, device->protocol_num, ret, bits->num_rows);
 
     // statistics accounting
     device->decode_events += 1;
@@ -62,46 +145,143 @@ static int account_event(r_device *device, bitbuffer_t *bits, char const *demod_
     return ret;
 }
 
-int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
+static int account_event(r_device *device, bitbuffer_t *bits, char const *demod_name)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
+    bitbuffer_transform(bits, device->transform);
+    return account_transformed_event(device, bits, demod_name);
+}
 
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
-        return 0;
+/// Lower and upper bounds (non inclusive) of the symbols of a slicer, in samples.
+typedef struct slicer_bounds {
+    int one_l, one_u;
+    int zero_l, zero_u;
+    int sync_l, sync_u;
+} slicer_bounds_t;
+
+// gap bounds of the PPM slicer
+static slicer_bounds_t ppm_bounds(int s_short, int s_long, int s_reset, int s_gap, int s_sync, int s_tolerance)
+{
+    slicer_bounds_t b = {0};
+
+    if (s_tolerance > 0) {
+        // precise
+        b.zero_l = s_short - s_tolerance;
+        b.zero_u = s_short + s_tolerance;
+        b.one_l  = s_long - s_tolerance;
+        b.one_u  = s_long + s_tolerance;
+        if (s_sync > 0) {
+            b.sync_l = s_sync - s_tolerance;
+            b.sync_u = s_sync + s_tolerance;
+        }
+    }
+    else {
+        // no sync, short=0, long=1
+        b.zero_l = 0;
+        b.zero_u = (s_short + s_long) / 2 + 1;
+        b.one_l  = b.zero_u - 1;
+        b.one_u  = s_gap ? s_gap : s_reset;
+    }
+    return b;
+}
+
+// pulse bounds of the PWM slicer
+static slicer_bounds_t pwm_bounds(int s_short, int s_long, int s_sync, int s_tolerance)
+{
+    slicer_bounds_t b = {0};
+
+    if (s_tolerance > 0) {
+        // precise
+        b.one_l  = s_short - s_tolerance;
+        b.one_u  = s_short + s_tolerance;
+        b.zero_l = s_long - s_tolerance;
+        b.zero_u = s_long + s_tolerance;
+        if (s_sync > 0) {
+            b.sync_l = s_sync - s_tolerance;
+            b.sync_u = s_sync + s_tolerance;
+        }
+    }
+    else if (s_sync <= 0) {
+        // no sync, short=1, long=0
+        b.one_l  = 0;
+        b.one_u  = (s_short + s_long) / 2 + 1;
+        b.zero_l = b.one_u - 1;
+        b.zero_u = INT_MAX;
+    }
+    else if (s_sync < s_short) {
+        // short=sync, middle=1, long=0
+        b.sync_l = 0;
+        b.sync_u = (s_sync + s_short) / 2 + 1;
+        b.one_l  = b.sync_u - 1;
+        b.one_u  = (s_short + s_long) / 2 + 1;
+        b.zero_l = b.one_u - 1;
+        b.zero_u = INT_MAX;
+    }
+    else if (s_sync < s_long) {
+        // short=1, middle=sync, long=0
+        b.one_l  = 0;
+        b.one_u  = (s_short + s_sync) / 2 + 1;
+        b.sync_l = b.one_u - 1;
+        b.sync_u = (s_sync + s_long) / 2 + 1;
+        b.zero_l = b.sync_u - 1;
+        b.zero_u = INT_MAX;
     }
+    else {
+        // short=1, middle=0, long=sync
+        b.one_l  = 0;
+        b.one_u  = (s_short + s_long) / 2 + 1;
+        b.zero_l = b.one_u - 1;
+        b.zero_u = (s_long + s_sync) / 2 + 1;
+        b.sync_l = b.zero_u - 1;
+        b.sync_u = INT_MAX;
+    }
+    return b;
+}
 
-    // precision reciprocals
-    float f_short = device->short_width > 0.0f ? 1.0f / (device->short_width * samples_per_us) : 0;
-    float f_long  = device->long_width > 0.0f ? 1.0f / (device->long_width * samples_per_us) : 0;
+int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
+{
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
+        return 0;
+    }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_gap   = t->s_gap;
+    int s_tolerance = t->s_tolerance;
+
+    // precise bit periods as num / den samples
+    int short_num = t->q_short;
+    int short_den = SLICER_WIDTH_ONE;
+    int long_num  = t->q_long;
+    int long_den  = SLICER_WIDTH_ONE;
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
 
     int const gap_limit = s_gap ? s_gap : s_reset;
     int const max_zeros = gap_limit / s_long;
     if (s_tolerance <= 0)
         s_tolerance = s_long / 4; // default tolerance is +-25% of a bit period
 
+    // the index of the package rules out the width scans which can not find a width in tolerance
+    int const rz_scan = s_short != s_long
+            && pulse_data_may_have_pulse(pulses, s_short - s_tolerance, s_short + s_tolerance)
+            && pulse_data_may_have_period(pulses, s_long - s_tolerance, s_long + s_tolerance);
+    // a run of single bit periods, pulses and gaps which round to one bit
+    int const nrz_run_scan = s_short == s_long
+            && pulse_data_may_have_pulse(pulses, t->q_short / (2 * SLICER_WIDTH_ONE), 3 * t->q_short / (2 * SLICER_WIDTH_ONE) + 1)
+            && pulse_data_may_have_gap(pulses, t->q_long / (2 * SLICER_WIDTH_ONE), 3 * t->q_long / (2 * SLICER_WIDTH_ONE) + 1);
+    int const nrz_scan = s_short == s_long
+            && (pulse_data_may_have_pulse(pulses, s_short - s_tolerance, 2 * s_short + s_tolerance)
+                    || pulse_data_may_have_gap(pulses, s_long - s_tolerance, 2 * s_long + s_tolerance));
+
     // if there is a run of bit-wide toggles (preamble) tune the bit period
     int min_count = s_short == s_long ? 12 : 4;
     int preamble_len = 0;
     // RZ
-    for (unsigned n = 0; s_short != s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; rz_scan && n < pulses->num_pulses; ++n) {
+        unsigned first = n;
         int swidth = 0;
-        int lwidth = 0;
         int count = 0;
         while (n < pulses->num_pulses
                 && pulses->pulse[n] >= s_short - s_tolerance
@@ -109,21 +289,23 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
                 && pulses->pulse[n] + pulses->gap[n] >= s_long - s_tolerance
                 && pulses->pulse[n] + pulses->gap[n] <= s_long + s_tolerance) {
             swidth += pulses->pulse[n];
-            lwidth += pulses->pulse[n] + pulses->gap[n];
             count += 1;
             n++;
         }
+        int lwidth = pulse_data_span(pulses, first, n);
         // require at least min_count bits preamble
         if (count >= min_count) {
-            f_long  = (float)count / lwidth;
-            f_short = (float)count / swidth;
+            long_num  = lwidth;
+            long_den  = count;
+            short_num = swidth;
+            short_den = count;
             min_count = count;
             preamble_len = count;
             if (device->verbose > 1) {
                 float to_us = 1e6f / pulses->sample_rate;
                 print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit preamble",
-                        to_us / f_long, to_us * s_long,
-                        to_us / f_short, to_us * s_short, count);
+                        to_us * long_num / long_den, to_us * s_long,
+                        to_us * short_num / short_den, to_us * s_short, count);
             }
         }
     }
@@ -131,7 +313,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     int rzs_width = 0;
     int rzl_width = 0;
     int rz_count = 0;
-    for (unsigned n = 0; preamble_len == 0 && s_short != s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; preamble_len == 0 && rz_scan && n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] >= s_short - s_tolerance
                 && pulses->pulse[n] <= s_short + s_tolerance
                 && pulses->pulse[n] + pulses->gap[n] >= s_long - s_tolerance
@@ -143,42 +325,45 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     }
     // require at least 8 bits measured
     if (rz_count > 8) {
-        f_long  = (float)rz_count / rzl_width;
-        f_short = (float)rz_count / rzs_width;
+        long_num  = rzl_width;
+        long_den  = rz_count;
+        short_num = rzs_width;
+        short_den = rz_count;
         if (device->verbose > 1) {
             float to_us = 1e6 / pulses->sample_rate;
             print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit measured",
-                    to_us / f_long, to_us * s_long,
-                    to_us / f_short, to_us * s_short, rz_count);
+                    to_us * long_num / long_den, to_us * s_long,
+                    to_us * short_num / short_den, to_us * s_short, rz_count);
         }
     }
     // NRZ
-    for (unsigned n = 0; s_short == s_long && n < pulses->num_pulses; ++n) {
-        int width = 0;
+    for (unsigned n = 0; nrz_run_scan && n < pulses->num_pulses; ++n) {
+        unsigned first = n;
         int count = 0;
         while (n < pulses->num_pulses
-                && (int)(pulses->pulse[n] * f_short + 0.5) == 1
-                && (int)(pulses->gap[n] * f_long + 0.5) == 1) {
-            width += pulses->pulse[n] + pulses->gap[n];
+                && bit_periods(pulses->pulse[n], short_num, short_den) == 1
+                && bit_periods(pulses->gap[n], long_num, long_den) == 1) {
             count += 2;
             n++;
         }
+        int width = pulse_data_span(pulses, first, n);
         // require at least min_count full bits preamble
         if (count >= min_count) {
-            f_short = f_long = (float)count / width;
+            short_num = long_num = width;
+            short_den = long_den = count;
             min_count = count;
             preamble_len = count;
             if (device->verbose > 1) {
                 float to_us = 1e6f / pulses->sample_rate;
                 print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f, %d bit preamble",
-                        to_us / f_short, to_us * s_short, count);
+                        to_us * short_num / short_den, to_us * s_short, count);
             }
         }
     }
     // NRZ pulse/gap of len 1 or 2 within tolerance anywhere
     int nrz_width = 0;
     int nrz_count = 0;
-    for (unsigned n = 0; preamble_len == 0 && s_short == s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; preamble_len == 0 && nrz_scan && n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] >= s_short - s_tolerance
                 && pulses->pulse[n] <= s_short + s_tolerance) {
             nrz_width += pulses->pulse[n];
@@ -202,29 +387,30 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     }
     // require at least 10 bits measured
     if (nrz_count > 20) {
-        f_short = f_long = (float)nrz_count / nrz_width;
+        short_num = long_num = nrz_width;
+        short_den = long_den = nrz_count;
         if (device->verbose > 1) {
             float to_us = 1e6 / pulses->sample_rate;
             print_logf(LOG_INFO, __func__, "%s: Exact bit width (in us) is %.2f vs %.2f, %d bit measured", device->name,
-                    to_us / f_short, to_us * s_short, nrz_count);
+                    to_us * short_num / short_den, to_us * s_short, nrz_count);
         }
     }
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
         // Determine number of high bit periods for NRZ coding, where bits may not be separated
-        int highs = (pulses->pulse[n]) * f_short + 0.5f;
+        int highs = bit_periods(pulses->pulse[n], short_num, short_den);
         // Determine number of low bit periods in current gap length (rounded)
         // for RZ subtract the nominal bit-gap
-        int lows = (pulses->gap[n] + s_short - s_long) * f_long + 0.5f;
+        int lows = bit_periods(pulses->gap[n] + s_short - s_long, long_num, long_den);
 
         // Add run of ones (1 for RZ, many for NRZ)
-        for (int i = 0; i < highs; ++i) {
-            bitbuffer_add_bit(&bits, 1);
+        if (highs > 0) {
+            bitbuffer_add_bits_run(bits, 1, (unsigned)highs);
         }
         // Add run of zeros, handle possibly negative "lows" gracefully
         lows = MIN(lows, max_zeros); // Don't overflow at end of message
-        for (int i = 0; i < lows; ++i) {
-            bitbuffer_add_bit(&bits, 0);
+        if (lows > 0) {
+            bitbuffer_add_bits_run(bits, 0, (unsigned)lows);
         }
 
         // Validate data
@@ -237,245 +423,164 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
                         n, pulses->pulse[n], pulses->gap[n],
                         pulses->pulse[n] + pulses->gap[n]);
             }
-            bitbuffer_clear(&bits);
+            bitbuffer_clear(bits);
         }
 
         // Check for new packet in multipacket
         else if (pulses->gap[n] > gap_limit && pulses->gap[n] <= s_reset) {
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
         // End of Message?
         if (((n == pulses->num_pulses - 1)                            // No more pulses? (FSK)
                     || (pulses->gap[n] > s_reset))      // Long silence (OOK)
-                && (bits.bits_per_row[0] > 0 || bits.num_rows > 1)) { // Only if data has been accumulated
+                && (bits->bits_per_row[0] > 0 || bits->num_rows > 1)) { // Only if data has been accumulated
 
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
+            events += account_event(device, bits, __func__);
+            bitbuffer_clear(bits);
         }
     } // for
     return events;
 }
 
-int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_gap   = t->s_gap;
+    int s_sync  = t->s_sync;
+    int s_tolerance = t->s_tolerance;
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
+
+    slicer_bounds_t b = ppm_bounds(s_short, s_long, s_reset, s_gap, s_sync, s_tolerance);
+    int zero_l = b.zero_l, zero_u = b.zero_u;
+    int one_l  = b.one_l, one_u   = b.one_u;
+    int sync_l = b.sync_l, sync_u = b.sync_u;
+
+    int const lower[BASEBAND_WINDOWS] = {zero_l, one_l, sync_l};
+    int const upper[BASEBAND_WINDOWS] = {zero_u, one_u, sync_u};
+    baseband_kernels_t const *kernels = baseband_kernels();
+    uint8_t symbols[SLICER_SYMBOL_CHUNK];
+
+    for (unsigned c = 0; c < pulses->num_pulses; c += SLICER_SYMBOL_CHUNK) {
+        unsigned len = MIN(SLICER_SYMBOL_CHUNK, pulses->num_pulses - c);
+        kernels->classify_widths(&pulses->gap[c], symbols, len, lower, upper);
+
+        for (unsigned n = c; n < c + len; ++n) {
+            unsigned symbol = symbols[n - c];
+            if (symbol < 2) {
+                // Short gap is 0, long gap is 1
+                bitbuffer_add_bit(bits, symbol);
+            }
+            else if (symbol == 2) {
+                // Sync gap
+                bitbuffer_add_sync(bits);
+            }
 
-    // lower and upper bounds (non inclusive)
-    int zero_l, zero_u;
-    int one_l, one_u;
-    int sync_l = 0, sync_u = 0;
+            // Check for new packet in multipacket
+            else if (pulses->gap[n] < s_reset) {
+                bitbuffer_add_row(bits);
+            }
+            // End of Message?
+            if (((n == pulses->num_pulses - 1)                            // No more pulses? (FSK)
+                        || (pulses->gap[n] >= s_reset))     // Long silence (OOK)
+                    && (bits->bits_per_row[0] > 0 || bits->num_rows > 1)) { // Only if data has been accumulated
 
-    if (s_tolerance > 0) {
-        // precise
-        zero_l = s_short - s_tolerance;
-        zero_u = s_short + s_tolerance;
-        one_l  = s_long - s_tolerance;
-        one_u  = s_long + s_tolerance;
-        if (s_sync > 0) {
-            sync_l = s_sync - s_tolerance;
-            sync_u = s_sync + s_tolerance;
-        }
-    }
-    else {
-        // no sync, short=0, long=1
-        zero_l = 0;
-        zero_u = (s_short + s_long) / 2 + 1;
-        one_l  = zero_u - 1;
-        one_u  = s_gap ? s_gap : s_reset;
+                events += account_event(device, bits, __func__);
+                bitbuffer_clear(bits);
+            }
+        } // for pulses
     }
-
-    for (unsigned n = 0; n < pulses->num_pulses; ++n) {
-        if (pulses->gap[n] > zero_l && pulses->gap[n] < zero_u) {
-            // Short gap
-            bitbuffer_add_bit(&bits, 0);
-        }
-        else if (pulses->gap[n] > one_l && pulses->gap[n] < one_u) {
-            // Long gap
-            bitbuffer_add_bit(&bits, 1);
-        }
-        else if (pulses->gap[n] > sync_l && pulses->gap[n] < sync_u) {
-            // Sync gap
-            bitbuffer_add_sync(&bits);
-        }
-
-        // Check for new packet in multipacket
-        else if (pulses->gap[n] < s_reset) {
-            bitbuffer_add_row(&bits);
-        }
-        // End of Message?
-        if (((n == pulses->num_pulses - 1)                            // No more pulses? (FSK)
-                    || (pulses->gap[n] >= s_reset))     // Long silence (OOK)
-                && (bits.bits_per_row[0] > 0 || bits.num_rows > 1)) { // Only if data has been accumulated
-
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
-        }
-    } // for pulses
     return events;
 }
 
-int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_gap   = t->s_gap;
+    int s_sync  = t->s_sync;
+    int s_tolerance = t->s_tolerance;
 
     int events = 0;
-    bitbuffer_t bits = {0};
-
-    // lower and upper bounds (non inclusive)
-    int one_l, one_u;
-    int zero_l, zero_u;
-    int sync_l = 0, sync_u = 0;
-
-    if (s_tolerance > 0) {
-        // precise
-        one_l  = s_short - s_tolerance;
-        one_u  = s_short + s_tolerance;
-        zero_l = s_long - s_tolerance;
-        zero_u = s_long + s_tolerance;
-        if (s_sync > 0) {
-            sync_l = s_sync - s_tolerance;
-            sync_u = s_sync + s_tolerance;
-        }
-    }
-    else if (s_sync <= 0) {
-        // no sync, short=1, long=0
-        one_l  = 0;
-        one_u  = (s_short + s_long) / 2 + 1;
-        zero_l = one_u - 1;
-        zero_u = INT_MAX;
-    }
-    else if (s_sync < s_short) {
-        // short=sync, middle=1, long=0
-        sync_l = 0;
-        sync_u = (s_sync + s_short) / 2 + 1;
-        one_l  = sync_u - 1;
-        one_u  = (s_short + s_long) / 2 + 1;
-        zero_l = one_u - 1;
-        zero_u = INT_MAX;
-    }
-    else if (s_sync < s_long) {
-        // short=1, middle=sync, long=0
-        one_l  = 0;
-        one_u  = (s_short + s_sync) / 2 + 1;
-        sync_l = one_u - 1;
-        sync_u = (s_sync + s_long) / 2 + 1;
-        zero_l = sync_u - 1;
-        zero_u = INT_MAX;
-    }
-    else {
-        // short=1, middle=0, long=sync
-        one_l  = 0;
-        one_u  = (s_short + s_long) / 2 + 1;
-        zero_l = one_u - 1;
-        zero_u = (s_long + s_sync) / 2 + 1;
-        sync_l = zero_u - 1;
-        sync_u = INT_MAX;
-    }
-
-    for (unsigned n = 0; n < pulses->num_pulses; ++n) {
-        if (pulses->pulse[n] > one_l && pulses->pulse[n] < one_u) {
-            // 'Short' 1 pulse
-            bitbuffer_add_bit(&bits, 1);
-        }
-        else if (pulses->pulse[n] > zero_l && pulses->pulse[n] < zero_u) {
-            // 'Long' 0 pulse
-            bitbuffer_add_bit(&bits, 0);
-        }
-        else if (pulses->pulse[n] > sync_l && pulses->pulse[n] < sync_u) {
-            // Sync pulse
-            bitbuffer_add_sync(&bits);
-        }
-        else if (pulses->pulse[n] <= one_l) {
-            // Ignore spurious short pulses
-        }
-        else {
-            // Pulse outside specified timing
-            bitbuffer_add_row(&bits);
-        }
+    bitbuffer_clear(bits);
+
+    slicer_bounds_t b = pwm_bounds(s_short, s_long, s_sync, s_tolerance);
+    int one_l  = b.one_l, one_u   = b.one_u;
+    int zero_l = b.zero_l, zero_u = b.zero_u;
+    int sync_l = b.sync_l, sync_u = b.sync_u;
+
+    int const lower[BASEBAND_WINDOWS] = {one_l, zero_l, sync_l};
+    int const upper[BASEBAND_WINDOWS] = {one_u, zero_u, sync_u};
+    baseband_kernels_t const *kernels = baseband_kernels();
+    uint8_t symbols[SLICER_SYMBOL_CHUNK];
+
+    for (unsigned c = 0; c < pulses->num_pulses; c += SLICER_SYMBOL_CHUNK) {
+        unsigned len = MIN(SLICER_SYMBOL_CHUNK, pulses->num_pulses - c);
+        kernels->classify_widths(&pulses->pulse[c], symbols, len, lower, upper);
+
+        for (unsigned n = c; n < c + len; ++n) {
+            unsigned symbol = symbols[n - c];
+            if (symbol < 2) {
+                // 'Short' 1 pulse, 'Long' 0 pulse
+                bitbuffer_add_bit(bits, symbol ^ 1);
+            }
+            else if (symbol == 2) {
+                // Sync pulse
+                bitbuffer_add_sync(bits);
+            }
+            else if (pulses->pulse[n] <= one_l) {
+                // Ignore spurious short pulses
+            }
+            else {
+                // Pulse outside specified timing
+                bitbuffer_add_row(bits);
+            }
 
-        // End of Message?
-        if (((n == pulses->num_pulses - 1)                       // No more pulses? (FSK)
-                    || (pulses->gap[n] > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                        // Only if data has been accumulated
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
-        }
-        else if (s_gap > 0 && pulses->gap[n] > s_gap
-                && bits.num_rows > 0 && bits.bits_per_row[bits.num_rows - 1] > 0) {
-            // New packet in multipacket
-            bitbuffer_add_row(&bits);
+            // End of Message?
+            if (((n == pulses->num_pulses - 1)                       // No more pulses? (FSK)
+                        || (pulses->gap[n] > s_reset)) // Long silence (OOK)
+                    && (bits->num_rows > 0)) {                        // Only if data has been accumulated
+                events += account_event(device, bits, __func__);
+                bitbuffer_clear(bits);
+            }
+            else if (s_gap > 0 && pulses->gap[n] > s_gap
+                    && bits->num_rows > 0 && bits->bits_per_row[bits->num_rows - 1] > 0) {
+                // New packet in multipacket
+                bitbuffer_add_row(bits);
+            }
         }
     }
     return events;
 }
 
-int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_reset = t->s_reset;
+    int s_tolerance = t->s_tolerance;
 
     int events = 0;
     int time_since_last = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
 
     // First rising edge is always counted as a zero (Seems to be hardcoded policy for the Oregon Scientific sensors...)
-    bitbuffer_add_bit(&bits, 0);
+    bitbuffer_add_bit(bits, 0);
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
         // The pulse or gap is too long or too short, thus invalid
@@ -487,17 +592,17 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
             if (pulses->pulse[n] > s_short * 1.5
                     && pulses->pulse[n] <= s_short * 2 + s_tolerance) {
                 // Long last pulse means with the gap this is a [1]10 transition, add a one
-                bitbuffer_add_bit(&bits, 1);
+                bitbuffer_add_bit(bits, 1);
             }
-            bitbuffer_add_row(&bits);
-            bitbuffer_add_bit(&bits, 0); // Prepare for new message with hardcoded 0
+            bitbuffer_add_row(bits);
+            bitbuffer_add_bit(bits, 0); // Prepare for new message with hardcoded 0
             time_since_last = 0;
         }
         // Falling edge is on end of pulse
         else if (pulses->pulse[n] + time_since_last > (s_short * 1.5)) {
             // Last bit was recorded more than short_width*1.5 samples ago
             // so this pulse start must be a data edge (falling data edge means bit = 1)
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
             time_since_last = 0;
         }
         else {
@@ -507,17 +612,17 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
         // End of Message?
         if (((n == pulses->num_pulses - 1)                       // No more pulses? (FSK)
                     || (pulses->gap[n] > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                        // Only if data has been accumulated
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
-            bitbuffer_add_bit(&bits, 0); // Prepare for new message with hardcoded 0
+                && (bits->num_rows > 0)) {                        // Only if data has been accumulated
+            events += account_event(device, bits, __func__);
+            bitbuffer_clear(bits);
+            bitbuffer_add_bit(bits, 0); // Prepare for new message with hardcoded 0
             time_since_last = 0;
         }
         // Rising edge is on end of gap
         else if (pulses->gap[n] + time_since_last > (s_short * 1.5)) {
             // Last bit was recorded more than short_width*1.5 samples ago
             // so this pulse end is a data edge (rising data edge means bit = 0)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
             time_since_last = 0;
         }
         else {
@@ -535,29 +640,18 @@ static inline int pulse_slicer_get_symbol(pulse_data_t const *pulses, unsigned i
         return pulses->gap[n / 2];
 }
 
-int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_tolerance = t->s_tolerance;
 
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
@@ -565,15 +659,15 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
 
         if (abs(symbol - s_short) < s_tolerance) {
             // Short - 1
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
             symbol = n + 1 < pulses->num_pulses * 2 ? pulse_slicer_get_symbol(pulses, ++n) : 0;
             if (abs(symbol - s_short) > s_tolerance) {
                 if (symbol >= s_reset - s_tolerance) {
                     // Don't expect another short gap at end of message
                     n--;
                 }
-                else if (bits.num_rows > 0 && bits.bits_per_row[bits.num_rows - 1] > 0) {
-                    bitbuffer_add_row(&bits);
+                else if (bits->num_rows > 0 && bits->bits_per_row[bits->num_rows - 1] > 0) {
+                    bitbuffer_add_row(bits);
 /*
                     print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_dmc(): %s",
                             device->name);
@@ -583,63 +677,51 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
         }
         else if (abs(symbol - s_long) < s_tolerance) {
             // Long - 0
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (symbol >= s_reset - s_tolerance
-                && bits.num_rows > 0) { // Only if data has been accumulated
+                && bits->num_rows > 0) { // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += account_event(device, bits, __func__);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_tolerance = t->s_tolerance;
 
-    // precision reciprocal
-    float f_short = device->short_width > 0.0f ? 1.0f / (device->short_width * samples_per_us) : 0;
+    int q_short = t->q_short;
 
     int w;
 
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
         int symbol = pulse_slicer_get_symbol(pulses, n);
-        w = symbol * f_short + 0.5;
+        w = bit_periods(symbol, q_short, SLICER_WIDTH_ONE);
         if (symbol > s_long) {
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
         else if (abs(symbol - w * s_short) < s_tolerance) {
             // Add w symbols
             for (; w > 0; --w)
-                bitbuffer_add_bit(&bits, 1 - n % 2);
+                bitbuffer_add_bit(bits, 1 - n % 2);
         }
         else if (symbol < s_reset
-                && bits.num_rows > 0
-                && bits.bits_per_row[bits.num_rows - 1] > 0) {
-            bitbuffer_add_row(&bits);
+                && bits->num_rows > 0
+                && bits->bits_per_row[bits->num_rows - 1] > 0) {
+            bitbuffer_add_row(bits);
 /*
             print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_piwm_raw(): %s",
                     device->name);
@@ -648,54 +730,43 @@ int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
 
         if (((n == pulses->num_pulses * 2 - 1)              // No more pulses? (FSK)
                     || (symbol > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                   // Only if data has been accumulated
+                && (bits->num_rows > 0)) {                   // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += account_event(device, bits, __func__);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_tolerance = t->s_tolerance;
 
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
         int symbol = pulse_slicer_get_symbol(pulses, n);
         if (abs(symbol - s_short) < s_tolerance) {
             // Short - 1
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         }
         else if (abs(symbol - s_long) < s_tolerance) {
             // Long - 0
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (symbol < s_reset
-                && bits.num_rows > 0
-                && bits.bits_per_row[bits.num_rows - 1] > 0) {
-            bitbuffer_add_row(&bits);
+                && bits->num_rows > 0
+                && bits->bits_per_row[bits->num_rows - 1] > 0) {
+            bitbuffer_add_row(bits);
 /*
             print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_piwm_dc(): %s",
                     device->name);
@@ -704,55 +775,40 @@ int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device)
 
         if (((n == pulses->num_pulses * 2 - 1)              // No more pulses? (FSK)
                     || (symbol > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                   // Only if data has been accumulated
+                && (bits->num_rows > 0)) {                   // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += account_event(device, bits, __func__);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_reset = t->s_reset;
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
     int limit = s_short;
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] > limit) {
-            for (int i = 0 ; i < (pulses->pulse[n]/limit) ; i++) {
-                bitbuffer_add_bit(&bits, 1);
-            }
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bits_run(bits, 1, (unsigned)(pulses->pulse[n] / limit));
+            bitbuffer_add_bit(bits, 0);
         } else if (pulses->pulse[n] < limit) {
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
 
         if (n == pulses->num_pulses - 1
                     || pulses->gap[n] >= s_reset) {
 
-            events += account_event(device, &bits, __func__);
+            events += account_event(device, bits, __func__);
         }
     }
 
@@ -773,33 +829,20 @@ int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
  * bit is discarded.
  */
 
-int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
+int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
 {
-    float samples_per_us = pulses->sample_rate / 1.0e6f;
-
-    int s_short = device->short_width * samples_per_us;
-    int s_long  = device->long_width * samples_per_us;
-    int s_reset = device->reset_limit * samples_per_us;
-    int s_gap   = device->gap_limit * samples_per_us;
-    int s_sync  = device->sync_width * samples_per_us;
-    int s_tolerance = device->tolerance * samples_per_us;
-
-    // check for rounding to zero
-    if ((device->short_width > 0 && s_short <= 0)
-            || (device->long_width > 0 && s_long <= 0)
-            || (device->reset_limit > 0 && s_reset <= 0)
-            || (device->gap_limit > 0 && s_gap <= 0)
-            || (device->sync_width > 0 && s_sync <= 0)
-            || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+    slicer_timing_t const *t = slicer_timing(pulses, device, __func__);
+    if (t->too_low) {
         return 0;
     }
+    int s_short = t->s_short;
+    int s_reset = t->s_reset;
 
     unsigned int n;
     int preamble = 0;
     int events = 0;
     int manbit = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_clear(bits);
     int halfbit_min = s_short / 2;
     int halfbit_max = s_short * 3 / 2;
     int sync_min = 2 * halfbit_max;
@@ -832,33 +875,33 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
     if (pulses->gap[n] > pulses->pulse[n]) {
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
     }
 
     /* remaining data bits */
     for (n++; n < pulses->num_pulses; ++n) {
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         if (pulses->pulse[n] > halfbit_max) {
             manbit ^= 1;
             if (manbit)
-                bitbuffer_add_bit(&bits, 1);
+                bitbuffer_add_bit(bits, 1);
         }
         if ((n == pulses->num_pulses - 1
                     || pulses->gap[n] > s_reset)
-                && (bits.num_rows > 0)) { // Only if data has been accumulated
+                && (bits->num_rows > 0)) { // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += account_event(device, bits, __func__);
             return events;
         }
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         if (pulses->gap[n] > halfbit_max) {
             manbit ^= 1;
             if (manbit)
-                bitbuffer_add_bit(&bits, 0);
+                bitbuffer_add_bit(bits, 0);
         }
     }
     return events;
@@ -866,12 +909,308 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
 
 int pulse_slicer_string(const char *code, r_device *device)
 {
-    int events = 0;
     bitbuffer_t bits = {0};
 
     bitbuffer_parse(&bits, code);
 
-    events += account_event(device, &bits, __func__);
+    return pulse_slicer_bits(&bits, device);
+}
+
+int pulse_slicer_bits(bitbuffer_t *bits, r_device *device)
+{
+    // reported as the string slicer, the bits are a parsed code string
+    return account_event(device, bits, "pulse_slicer_string");
+}
+
+void slicer_cache_reset(slicer_cache_t *cache)
+{
+    cache->generation += 1;
+    if (!cache->generation) {
+        // the generation wrapped, entries of the first generation would look valid
+        for (unsigned i = 0; i < cache->size; ++i) {
+            cache->entries[i].generation = 0;
+        }
+        cache->generation = 1;
+    }
+}
+
+void slicer_cache_free(slicer_cache_t *cache)
+{
+    for (unsigned i = 0; i < cache->size; ++i) {
+        slicer_cache_entry_t *entry = &cache->entries[i];
+        for (unsigned k = 0; k < entry->size; ++k) {
+            preamble_scan_free(&entry->scans[k]);
+            manchester_view_free(&entry->views[k]);
+            free(entry->transforms[k].bytes);
+        }
+        free(entry->bits);
+        free(entry->bytes);
+        free(entry->scans);
+        free(entry->views);
+        free(entry->transforms);
+        preamble_matcher_free(entry->matcher);
+    }
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->size    = 0;
+}
+
+void slicer_cache_reserve(slicer_cache_t *cache, unsigned groups)
+{
+    if (groups <= cache->size) {
+        return;
+    }
+    unsigned size = groups + 15;
+    slicer_cache_entry_t *entries = realloc(cache->entries, size * sizeof(*entries));
+    if (!entries) {
+        FATAL_REALLOC("slicer_cache_reserve()");
+    }
+    memset(&entries[cache->size], 0, (size - cache->size) * sizeof(*entries));
+    cache->entries = entries;
+    cache->size    = size;
+}
+
+// stands in for the decode_fn while slicing for a group, keeps a copy of the used part of the bits
+static int slicer_cache_record(r_device *decoder, bitbuffer_t *bitbuffer)
+{
+    slicer_cache_entry_t *entry = decoder->decode_ctx;
+    if (entry->count >= entry->size) {
+        unsigned size = entry->size ? entry->size * 2 : 4;
+        bitbuffer_t *bits = realloc(entry->bits, size * sizeof(*bits));
+        if (!bits) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        entry->bits = bits;
+        unsigned *bytes = realloc(entry->bytes, size * sizeof(*bytes));
+        if (!bytes) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        entry->bytes = bytes;
+        preamble_scan_t *scans = realloc(entry->scans, size * sizeof(*scans));
+        if (!scans) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        memset(&scans[entry->size], 0, (size - entry->size) * sizeof(*scans));
+        entry->scans = scans;
+        manchester_view_t *views = realloc(entry->views, size * sizeof(*views));
+        if (!views) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        memset(&views[entry->size], 0, (size - entry->size) * sizeof(*views));
+        entry->views = views;
+        slicer_transforms_t *transforms = realloc(entry->transforms, size * sizeof(*transforms));
+        if (!transforms) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        memset(&transforms[entry->size], 0, (size - entry->size) * sizeof(*transforms));
+        entry->transforms = transforms;
+        entry->size       = size;
+    }
+
+    // a long row spills into the following rows, the bits of each row are contiguous
+    unsigned used = 0;
+    for (unsigned row = 0; row < bitbuffer->num_rows; ++row) {
+        used = MAX(used, row * BITBUF_COLS + (bitbuffer->bits_per_row[row] + 7) / 8);
+    }
+    bitbuffer_t *bits = &entry->bits[entry->count];
+    memcpy(bits, bitbuffer, offsetof(bitbuffer_t, bb));
+    memcpy(bits->bb, bitbuffer->bb, used);
+    entry->bytes[entry->count] = used;
+    entry->scans[entry->count].done = 0;
+    entry->views[entry->count].done = 0;
+    slicer_transforms_t *transforms = &entry->transforms[entry->count];
+    if (used > transforms->size) {
+        uint8_t *bytes = realloc(transforms->bytes, (BITBUFFER_TRANSFORMS - 1) * used);
+        if (!bytes) {
+            FATAL_REALLOC("slicer_cache_record()");
+        }
+        transforms->bytes = bytes;
+        transforms->size  = used;
+    }
+    transforms->done = 0;
+    entry->count += 1;
+    return 0;
+}
+
+typedef int (*pulse_slicer_fn)(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits);
+
+int pulse_slicer_cached(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits, slicer_cache_t *cache)
+{
+    pulse_slicer_fn slicer;
+    char const *demod_name;
+    switch (device->modulation) {
+    case OOK_PULSE_PCM:
+    case FSK_PULSE_PCM:
+        slicer     = pulse_slicer_pcm;
+        demod_name = "pulse_slicer_pcm";
+        break;
+    case OOK_PULSE_PPM:
+        slicer     = pulse_slicer_ppm;
+        demod_name = "pulse_slicer_ppm";
+        break;
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        slicer     = pulse_slicer_pwm;
+        demod_name = "pulse_slicer_pwm";
+        break;
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        slicer     = pulse_slicer_manchester_zerobit;
+        demod_name = "pulse_slicer_manchester_zerobit";
+        break;
+    case OOK_PULSE_PIWM_RAW:
+        slicer     = pulse_slicer_piwm_raw;
+        demod_name = "pulse_slicer_piwm_raw";
+        break;
+    case OOK_PULSE_PIWM_DC:
+        slicer     = pulse_slicer_piwm_dc;
+        demod_name = "pulse_slicer_piwm_dc";
+        break;
+    case OOK_PULSE_DMC:
+        slicer     = pulse_slicer_dmc;
+        demod_name = "pulse_slicer_dmc";
+        break;
+    case OOK_PULSE_PWM_OSV1:
+        slicer     = pulse_slicer_osv1;
+        demod_name = "pulse_slicer_osv1";
+        break;
+    case OOK_PULSE_NRZS:
+        slicer     = pulse_slicer_nrzs;
+        demod_name = "pulse_slicer_nrzs";
+        break;
+    default:
+        print_logf(LOG_ERROR, __func__, "Unknown modulation %u in protocol!", device->modulation);
+        return 0;
+    }
+
+    slicer_cache_reserve(cache, device->slice_group + 1);
+
+    slicer_cache_entry_t *entry = &cache->entries[device->slice_group];
+    if (entry->generation != cache->generation) {
+        // the first decoder of the group for this package, slice into the cache
+        slicer_timing(pulses, device, demod_name); // convert on the decoder, the recorder is a copy
+        r_device recorder = *device;
+        recorder.decode_fn  = slicer_cache_record;
+        recorder.decode_ctx = entry;
+        recorder.transform  = BITBUFFER_AS_IS; // the cache keeps the bits as sliced
+        entry->count = 0;
+        slicer(pulses, &recorder, bits);
+        entry->generation = cache->generation;
+    }
 
+    unsigned transform = device->transform < BITBUFFER_TRANSFORMS ? device->transform : BITBUFFER_AS_IS;
+    // the scans and views answer for the bits as is and inverted only
+    int scannable = transform == BITBUFFER_AS_IS || transform == BITBUFFER_INVERTED;
+    int events = 0;
+    for (unsigned i = 0; i < entry->count; ++i) {
+        if (device->decode_fn && rows_rejected(device, &entry->bits[i])) {
+            // the transforms keep the row lengths, the bits are not copied for a rejection
+            events += account_transformed_event(device, &entry->bits[i], demod_name);
+            continue;
+        }
+        // the decoder may change the bits, each decoder gets a fresh copy
+        bitbuffer_clear(bits);
+        slicer_transforms_t *transforms = &entry->transforms[i];
+        uint8_t *transformed = transform ? &transforms->bytes[(transform - 1) * transforms->size] : NULL;
+        if (transform && transforms->done >> transform & 1) {
+            // another decoder of the group transformed the same bits
+            memcpy(bits, &entry->bits[i], offsetof(bitbuffer_t, bb));
+            memcpy(bits->bb, transformed, entry->bytes[i]);
+        }
+        else {
+            memcpy(bits, &entry->bits[i], offsetof(bitbuffer_t, bb) + entry->bytes[i]);
+            if (transform) {
+                bitbuffer_transform(bits, transform);
+                memcpy(transformed, bits->bb, entry->bytes[i]);
+                transforms->done |= 1U << transform;
+            }
+        }
+        if (entry->matcher && device->preamble_slot && scannable) {
+            // the group scans the bits once for the preambles of all decoders
+            preamble_scan_t *scan = &entry->scans[i];
+            scan->matcher         = entry->matcher;
+            scan->source          = &entry->bits[i];
+            scan->bits            = bits;
+            device->preamble_scan = scan;
+        }
+        if (scannable) {
+            // the group decodes the rows once for the Manchester decoders
+            manchester_view_t *view = &entry->views[i];
+            view->source            = &entry->bits[i];
+            view->bits              = bits;
+            device->manchester_view = view;
+        }
+        events += account_transformed_event(device, bits, demod_name);
+        device->preamble_scan   = NULL;
+        device->manchester_view = NULL;
+    }
     return events;
 }
+
+/// Width tolerance of the signature clusters, the clusters are only used as bounds.
+#define SIGNATURE_TOLERANCE 0.2f
+
+void pulse_signature_make(pulse_signature_t *sig, pulse_data_t const *pulses)
+{
+    sig->sample_rate       = pulses->sample_rate;
+    sig->pulses.bins_count = 0;
+    sig->gaps.bins_count   = 0;
+    sig->complete = !histogram_sum(&sig->pulses, pulses->pulse, pulses->num_pulses, SIGNATURE_TOLERANCE)
+            && !histogram_sum(&sig->gaps, pulses->gap, pulses->num_pulses, SIGNATURE_TOLERANCE);
+}
+
+// check if any cluster may hold a width between the non inclusive bounds
+static int signature_has_width(histogram_t const *hist, int lower, int upper)
+{
+    for (unsigned n = 0; n < hist->bins_count; ++n) {
+        if (hist->bins[n].max > lower && hist->bins[n].min < upper) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int pulse_slicer_may_match(pulse_signature_t const *sig, r_device const *device)
+{
+    if (!sig->complete || device->verbose || device->reports_empty) {
+        return 1;
+    }
+    int const pcm = device->modulation == OOK_PULSE_PCM || device->modulation == FSK_PULSE_PCM;
+    if (device->modulation != OOK_PULSE_PWM && device->modulation != FSK_PULSE_PWM
+            && device->modulation != OOK_PULSE_PPM && !pcm) {
+        return 1;
+    }
+
+    slicer_timing_t local;
+    slicer_timing_t const *t = &device->timing;
+    if (!t->converted || t->sample_rate != sig->sample_rate) {
+        slicer_timing_convert(&local, device, sig->sample_rate);
+        t = &local;
+    }
+    // leave rounding to zero to the slicer, it warns about the sample rate
+    if (t->too_low) {
+        return 1;
+    }
+    int s_short = t->s_short;
+    int s_long  = t->s_long;
+    int s_reset = t->s_reset;
+    int s_gap   = t->s_gap;
+    int s_sync  = t->s_sync;
+    int s_tolerance = t->s_tolerance;
+
+    if (pcm) {
+        // the RZ slicer clears the bits on every pulse out of tolerance, NRZ takes any width
+        if (s_short == s_long)
+            return 1;
+        int tolerance = s_tolerance > 0 ? s_tolerance : s_long / 4;
+        return signature_has_width(&sig->pulses, s_short - tolerance - 1, s_short + tolerance + 1);
+    }
+    if (device->modulation == OOK_PULSE_PPM) {
+        slicer_bounds_t b = ppm_bounds(s_short, s_long, s_reset, s_gap, s_sync, s_tolerance);
+        return signature_has_width(&sig->gaps, b.zero_l, b.zero_u)
+                || signature_has_width(&sig->gaps, b.one_l, b.one_u);
+    }
+    slicer_bounds_t b = pwm_bounds(s_short, s_long, s_sync, s_tolerance);
+    return signature_has_width(&sig->pulses, b.one_l, b.one_u)
+            || signature_has_width(&sig->pulses, b.zero_l, b.zero_u);
+}
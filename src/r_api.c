@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
 
 #include "r_api.h"
 #include "r_util.h"
@@ -23,25 +24,63 @@
 #include "rtl_433_devices.h"
 #include "r_device.h"
 #include "pulse_slicer.h"
+#include "pulse_analyzer.h"
 #include "pulse_detect_fsk.h"
 #include "sdr.h"
 #include "data.h"
 #include "data_tag.h"
 #include "list.h"
+#include "log_ring.h"
+#include "mem_acct.h"
 #include "optparse.h"
 #include "output_file.h"
 #include "output_log.h"
 #include "output_udp.h"
+#include "output_unix.h"
+#include "output_binary.h"
+#include "output_arrow.h"
+#include "output_async.h"
 #include "output_mqtt.h"
 #include "output_influx.h"
 #include "output_trigger.h"
 #include "output_rtltcp.h"
+#include "output_shm.h"
+#include "output_squelch.h"
+#include "pulse_net.h"
+#include "event_fusion.h"
+#include "event_merge.h"
+#include "decoder_usage.h"
+#include "event_throttle.h"
+#include "sensor_state.h"
+#include "pulse_archive.h"
+#include "pulse_recorder.h"
+#include "sigmf.h"
+#include "hop_scheduler.h"
+#include "duty_cycle.h"
+#include "load_shed.h"
+#include "buf_tune.h"
+#include "freq_plan.h"
+#include "file_writer.h"
+#include "convert.h"
 #include "write_sigrok.h"
 #include "mongoose.h"
 #include "compat_time.h"
+#include "compat_atomic.h"
 #include "logger.h"
 #include "fatal.h"
+#include "event_store.h"
 #include "http_server.h"
+#include "demod_thread.h"
+#include "worker_pool.h"
+#include "decoder_pool.h"
+#include "package_queue.h"
+#include "channelizer.h"
+#include "decimator.h"
+#include "spectrum.h"
+#include "r_trace.h"
+#include "trace_event.h"
+#include "sample_buf.h"
+#include "warm_start.h"
 
 #ifndef _WIN32
 #include <sys/stat.h>
@@ -89,6 +128,12 @@ char const *version_string(void)
 #ifdef SOAPYSDR
             " SoapySDR"
 #endif
+#ifdef ZSTD
+            " zstd"
+#endif
+#ifdef OPENCL
+            " OpenCL"
+#endif
 #ifdef OPENSSL
             " with TLS"
 #endif
@@ -144,8 +189,69 @@ void set_gain_str(struct r_cfg *cfg, char const *gain_str)
     sdr_set_tuner_gain(cfg->dev, gain_str, 0);
 }
 
+int start_trace(r_cfg_t *cfg, char const *path, unsigned secs)
+{
+    if (!cfg->trace) {
+        trace_event_t *trace = trace_event_create();
+        if (!trace)
+            return -1;
+        // the demod reads the trace of the primary for each buffer
+        atomic_store_release(&cfg->trace, trace);
+    }
+    if (trace_event_start(cfg->trace, path, secs) < 0)
+        return -1;
+
+    trace_event_thread_name(cfg->trace, 0, "outputs");
+    trace_event_thread_name(cfg->trace, cfg->trace_tid, "demod");
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        r_cfg_t *ch = *iter;
+        char name[32];
+        snprintf(name, sizeof(name), "channel %u", ch->trace_tid - 2);
+        trace_event_thread_name(cfg->trace, ch->trace_tid, name);
+    }
+    return 0;
+}
+
+void stop_trace(r_cfg_t *cfg)
+{
+    if (cfg->trace)
+        trace_event_stop(cfg->trace);
+}
+
 /* general */
 
+/// The decoder protocols of rtl_433_devices.h, the protocol number is the index plus one.
+static r_device const *const protocol_list[] = {
+#define DECL(name) &name,
+        DEVICES
+#undef DECL
+};
+
+#define PROTOCOL_COUNT (sizeof(protocol_list) / sizeof(*protocol_list))
+
+/// The numbered protocols, built on the first config and shared by all configs, channels, and receivers.
+/// Configs may be created on any thread, the registry is read-only once built.
+static r_device const *protocol_registry(uint16_t *count)
+{
+    static r_device registry[PROTOCOL_COUNT];
+    static unsigned registry_built;
+    static unsigned registry_lock;
+
+    if (!atomic_load_acquire(&registry_built)) {
+        atomic_spin_lock(&registry_lock);
+        if (!registry_built) {
+            for (unsigned i = 0; i < PROTOCOL_COUNT; i++) {
+                registry[i]              = *protocol_list[i];
+                registry[i].protocol_num = i + 1;
+            }
+            atomic_store_release(&registry_built, 1);
+        }
+        atomic_spin_unlock(&registry_lock);
+    }
+    *count = PROTOCOL_COUNT;
+    return registry;
+}
+
 void r_init_cfg(r_cfg_t *cfg)
 {
     cfg->out_block_size  = DEFAULT_BUF_LENGTH;
@@ -159,22 +265,7 @@ void r_init_cfg(r_cfg_t *cfg)
     list_ensure_size(&cfg->in_files, 100);
     list_ensure_size(&cfg->output_handler, 16);
 
-    // collect devices list, this should be a module
-    r_device r_devices[] = {
-#define DECL(name) name,
-            DEVICES
-#undef DECL
-    };
-
-    cfg->num_r_devices = sizeof(r_devices) / sizeof(*r_devices);
-    for (unsigned i = 0; i < cfg->num_r_devices; i++) {
-        r_devices[i].protocol_num = i + 1;
-    }
-    cfg->devices = malloc(sizeof(r_devices));
-    if (!cfg->devices)
-        FATAL_CALLOC("r_init_cfg()");
-
-    memcpy(cfg->devices, r_devices, sizeof(r_devices));
+    cfg->devices = protocol_registry(&cfg->num_r_devices);
 
     cfg->demod = calloc(1, sizeof(*cfg->demod));
     if (!cfg->demod)
@@ -190,12 +281,17 @@ void r_init_cfg(r_cfg_t *cfg)
     cfg->demod->pulse_detect = pulse_detect_create();
     // initialize tables
     baseband_init();
+    convert_init();
 
     time(&cfg->running_since);
     time(&cfg->frames_since);
+    cfg->frames_allocs_since = data_alloc_count();
+    cfg->trace_tid = 1;
     get_time_now(&cfg->demod->now);
 
     list_ensure_size(&cfg->demod->r_devs, 100);
+    list_ensure_size(&cfg->demod->ook_devs, 100);
+    list_ensure_size(&cfg->demod->fsk_devs, 100);
     list_ensure_size(&cfg->demod->dumper, 32);
 }
 
@@ -210,8 +306,256 @@ r_cfg_t *r_create_cfg(void)
     return cfg;
 }
 
+r_cfg_t *r_create_receiver(r_cfg_t *cfg, char *dev_query)
+{
+    r_cfg_t *rcv = r_create_cfg();
+
+    rcv->primary   = cfg;
+    rcv->dev_query = dev_query;
+    // tuner settings given so far are the defaults for this receiver
+    rcv->samp_rate    = cfg->samp_rate;
+    rcv->settings_str = cfg->settings_str;
+    rcv->ppm_error    = cfg->ppm_error;
+    if (cfg->gain_str) {
+        rcv->gain_str = strdup(cfg->gain_str);
+        if (!rcv->gain_str)
+            FATAL_STRDUP("r_create_receiver()");
+    }
+
+    list_push(&cfg->receivers, rcv);
+    return rcv;
+}
+
+r_cfg_t *r_create_channel(r_cfg_t *cfg)
+{
+    r_cfg_t *ch = r_create_cfg();
+
+    ch->primary   = cfg;
+    ch->dev_query = cfg->dev_query;
+    ch->trace_tid = 2 + (unsigned)cfg->channels.len;
+    r_setup_receiver(ch);
+    // the input config hops, times, and reports for all its channels
+    ch->frequencies       = 1;
+    ch->hop_times         = 0;
+    ch->duration          = 0;
+    ch->report_stats      = 0;
+    ch->after_successful_events_flag = 0;
+    // channels are CS16 magnitude
+    ch->demod->sample_size   = sizeof(int16_t) * 2;
+    ch->demod->sample_format = BASEBAND_CS16;
+    ch->demod->use_mag_est = 1;
+    pulse_detect_set_levels(ch->demod->pulse_detect, ch->demod->use_mag_est, ch->demod->level_limit, ch->demod->min_level, ch->demod->min_snr, ch->demod->detect_verbosity);
+
+    list_push(&cfg->channels, ch);
+    return ch;
+}
+
+// the demod buffers are sample buffers, aligned and backed by huge pages where available
+static void *demod_buf_create(size_t size)
+{
+    void *buf = sample_buf_create(size);
+    if (!buf) {
+        FATAL_MALLOC("demod_buf_create()");
+    }
+    return buf;
+}
+
+static void free_demod_buffers(struct dm_state *demod)
+{
+    sample_buf_free(demod->am_buf);
+    sample_buf_free(demod->buf.fm);
+    sample_buf_free(demod->u8_buf);
+    demod->am_buf      = NULL;
+    demod->buf.fm      = NULL;
+    demod->u8_buf      = NULL;
+    demod->buf_samples = 0;
+}
+
+void r_reserve_demod_buffers(r_cfg_t *cfg, unsigned long n_samples)
+{
+    struct dm_state *demod = cfg->demod;
+    if (n_samples <= demod->buf_samples) {
+        return;
+    }
+    free_demod_buffers(demod);
+
+    // only a logic dumper needs the logic buffer, formats are converted into the buffers of the writers
+    int need_u8 = 0;
+    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t const *dumper = *iter;
+        if (dumper->format == U8_LOGIC)
+            need_u8 = 1;
+    }
+
+    demod->am_buf = demod_buf_create(n_samples * sizeof(*demod->am_buf));
+    demod->buf.fm = demod_buf_create(n_samples * sizeof(*demod->buf.fm));
+    if (need_u8)
+        demod->u8_buf = demod_buf_create(n_samples * sizeof(*demod->u8_buf));
+    demod->buf_samples = n_samples;
+}
+
+void r_setup_receiver(r_cfg_t *rcv)
+{
+    r_cfg_t *cfg = rcv->primary;
+
+    // frequencies and hop times are lists, use the primary ones if none were given
+    if (rcv->frequencies == 0) {
+        memcpy(rcv->frequency, cfg->frequency, sizeof(cfg->frequency));
+        rcv->frequencies = cfg->frequencies;
+        for (int i = 0; i < cfg->frequencies; ++i) {
+            unsigned const *protocols = cfg->frequency_protocols[i];
+            if (!protocols)
+                continue;
+            size_t n = 0;
+            while (protocols[n])
+                n++;
+            rcv->frequency_protocols[i] = malloc((n + 1) * sizeof(*protocols));
+            if (!rcv->frequency_protocols[i])
+                FATAL_MALLOC("r_setup_receiver()");
+            memcpy(rcv->frequency_protocols[i], protocols, (n + 1) * sizeof(*protocols));
+        }
+    }
+    if (rcv->hop_times == 0) {
+        memcpy(rcv->hop_time, cfg->hop_time, sizeof(cfg->hop_time));
+        rcv->hop_times = cfg->hop_times;
+    }
+    if (rcv->frequencies > 1 && rcv->hop_times == 0) {
+        rcv->hop_time[rcv->hop_times++] = DEFAULT_HOP_TIME;
+    }
+    rcv->hop_adaptive = rcv->hop_adaptive || cfg->hop_adaptive;
+    rcv->center_frequency = rcv->frequency[rcv->frequency_index];
+
+    rcv->dev_mode        = cfg->dev_mode;
+    rcv->out_block_size  = cfg->out_block_size;
+    rcv->buf_num         = cfg->buf_num;
+    rcv->low_latency     = cfg->low_latency;
+    rcv->buf_tune_s      = cfg->buf_tune_s;
+    rcv->fsk_pulse_detect_mode = cfg->fsk_pulse_detect_mode;
+    rcv->duration        = cfg->duration;
+    rcv->after_successful_events_flag = cfg->after_successful_events_flag;
+    rcv->raw_mode        = cfg->raw_mode;
+    rcv->raw_rfraw       = cfg->raw_rfraw;
+    rcv->verbosity       = cfg->verbosity;
+    rcv->verbose_bits    = cfg->verbose_bits;
+    rcv->conversion_mode = cfg->conversion_mode;
+    rcv->report_meta     = cfg->report_meta;
+    rcv->report_noise    = cfg->report_noise;
+    rcv->report_latency  = cfg->report_latency;
+    rcv->report_protocol = cfg->report_protocol;
+    rcv->report_time     = cfg->report_time;
+    rcv->report_time_hires = cfg->report_time_hires;
+    rcv->report_time_tz  = cfg->report_time_tz;
+    rcv->report_time_utc = cfg->report_time_utc;
+    rcv->report_description = cfg->report_description;
+    rcv->report_stats    = cfg->report_stats;
+    rcv->stats_interval  = cfg->stats_interval;
+    rcv->stats_time      = cfg->stats_time;
+    rcv->has_logout      = cfg->has_logout;
+    rcv->tag_input       = cfg->tag_input;
+    rcv->worker_threads  = cfg->worker_threads;
+    rcv->decoder_threads = cfg->decoder_threads;
+    rcv->pipeline_packages = cfg->pipeline_packages;
+    rcv->dedup_ms        = cfg->dedup_ms;
+    rcv->early_decode    = cfg->early_decode;
+    rcv->decode_budget_us = cfg->decode_budget_us;
+
+    struct dm_state *demod = rcv->demod;
+    demod->auto_level       = cfg->demod->auto_level;
+    demod->squelch_offset   = cfg->demod->squelch_offset;
+    demod->level_limit      = cfg->demod->level_limit;
+    demod->min_level        = cfg->demod->min_level;
+    demod->min_snr          = cfg->demod->min_snr;
+    demod->low_pass         = cfg->demod->low_pass;
+    baseband_low_pass_filter_init(&demod->lowpass_filter_state, cfg->demod->lowpass_filter_state.order);
+    demod->use_mag_est      = cfg->demod->use_mag_est;
+    demod->detect_verbosity = cfg->demod->detect_verbosity;
+    demod->analyze_pulses   = cfg->demod->analyze_pulses;
+    demod->max_gap_ms       = cfg->demod->max_gap_ms;
+    demod->pulse_data.max_pulses     = cfg->demod->pulse_data.max_pulses;
+    demod->fsk_pulse_data.max_pulses = cfg->demod->fsk_pulse_data.max_pulses;
+    pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level, demod->min_snr, demod->detect_verbosity);
+
+    // outputs and tags are owned by the primary
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        list_push(&rcv->output_handler, cfg->output_handler.elems[i]);
+    }
+    list_push_all(&rcv->data_tags, cfg->data_tags.elems);
+    rcv->mgr = get_mgr(cfg);
+}
+
+// queued events borrow strings of the decoders, print them before decoders are freed
+void free_tenant(tenant_t *tenant)
+{
+    free(tenant->name);
+    free(tenant);
+}
+
+static void flush_outputs(r_cfg_t *cfg)
+{
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_flush(cfg->output_handler.elems[i]);
+    }
+}
+
 void r_free_cfg(r_cfg_t *cfg)
 {
+    if (!cfg->primary) {
+        // the events held for the merge, then those held for the fusion are output now
+        event_merge_t *merge = cfg->merge;
+        cfg->merge           = NULL;
+        event_merge_free(merge);
+        event_fusion_free(cfg->fusion);
+        cfg->fusion = NULL;
+        flush_outputs(cfg);
+    }
+
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        r_free_cfg(rcv);
+        free(rcv);
+    }
+    list_free_elems(&cfg->receivers, NULL);
+
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        r_cfg_t *ch = *iter;
+        r_free_cfg(ch);
+        free(ch);
+    }
+    list_free_elems(&cfg->channels, NULL);
+
+    for (void **iter = cfg->in_file_cfgs.elems; iter && *iter; ++iter) {
+        r_cfg_t *fc = *iter;
+        r_free_cfg(fc);
+        free(fc);
+    }
+    list_free_elems(&cfg->in_file_cfgs, NULL);
+
+    // a reload still in progress
+    r_cfg_t *stages[] = {cfg->staged_decoders, cfg->retired_decoders};
+    for (size_t i = 0; i < sizeof(stages) / sizeof(*stages); ++i) {
+        if (stages[i]) {
+            r_free_cfg(stages[i]);
+            free(stages[i]);
+        }
+    }
+    cfg->staged_decoders  = NULL;
+    cfg->retired_decoders = NULL;
+
+    channelizer_free(cfg->channelizer);
+    cfg->channelizer = NULL;
+    decimator_free(cfg->decimator);
+    cfg->decimator = NULL;
+    spectrum_free(cfg->spectrum);
+    cfg->spectrum = NULL;
+    worker_pool_free(cfg->worker_pool);
+    cfg->worker_pool = NULL;
+    decoder_pool_free(cfg->decoder_pool);
+    cfg->decoder_pool = NULL;
+    package_queue_free(cfg->package_queue);
+    cfg->package_queue = NULL;
+    // the output of a channel is replayed after each frame, nothing is pending here
+    list_free_elems(&cfg->pending_output, NULL);
+
     if (cfg->dev) {
         sdr_deactivate(cfg->dev);
         sdr_close(cfg->dev);
@@ -221,40 +565,119 @@ void r_free_cfg(r_cfg_t *cfg)
     free(cfg->gain_str);
     cfg->gain_str = NULL;
 
+    for (int i = 0; i < MAX_FREQS; ++i) {
+        free(cfg->frequency_protocols[i]);
+        cfg->frequency_protocols[i] = NULL;
+    }
+
+    hop_scheduler_free(cfg->hop_scheduler);
+    cfg->hop_scheduler = NULL;
+
+    duty_cycle_free(cfg->duty_cycle);
+    cfg->duty_cycle = NULL;
+
+    load_shed_free(cfg->load_shed);
+    cfg->load_shed = NULL;
+
+    buf_tune_free(cfg->buf_tune);
+    cfg->buf_tune = NULL;
+
+    event_throttle_free(cfg->throttle);
+    cfg->throttle = NULL;
+    pulse_recorder_free(cfg->pulse_recorder);
+    cfg->pulse_recorder = NULL;
+
+    sensor_state_free(cfg->sensor_state);
+    cfg->sensor_state = NULL;
+
+    warm_start_free(cfg->warm_start);
+    cfg->warm_start = NULL;
+    free(cfg->warm_start_path);
+    cfg->warm_start_path = NULL;
+
+    freq_plan_free(cfg->freq_plan);
+    cfg->freq_plan = NULL;
+    list_free_elems(&cfg->plan_receivers, NULL);
+    list_free_elems(&cfg->tenants, (list_elem_free_fn)free_tenant);
+
+    // the channels only borrow the trace of the primary
+    if (!cfg->primary)
+        trace_event_free(cfg->trace);
+    cfg->trace = NULL;
+    free(cfg->trace_path);
+    cfg->trace_path = NULL;
+    free(cfg->kernel_cache_path);
+    cfg->kernel_cache_path = NULL;
+    decoder_usage_free(cfg->decoder_usage);
+    cfg->decoder_usage = NULL;
+    free(cfg->decoder_usage_path);
+    cfg->decoder_usage_path = NULL;
+    free(cfg->shard_costs);
+    cfg->shard_costs = NULL;
+
     for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
-        file_info_t const *dumper = *iter;
+        file_info_t *dumper = *iter;
+        file_writer_close(dumper->writer);
         if (dumper->file && (dumper->file != stdout))
             fclose(dumper->file);
     }
     list_free_elems(&cfg->demod->dumper, free);
 
+    list_free_elems(&cfg->demod->ook_devs, NULL);
+    list_free_elems(&cfg->demod->fsk_devs, NULL);
+    list_free_elems(&cfg->demod->band_ook_devs, NULL);
+    list_free_elems(&cfg->demod->band_fsk_devs, NULL);
+    list_free_elems(&cfg->demod->early_devs, NULL);
     list_free_elems(&cfg->demod->r_devs, (list_elem_free_fn)free_protocol);
+    free(cfg->demod->packed_devs);
+    cfg->demod->packed_devs = NULL;
+    slicer_cache_free(&cfg->demod->slicer_cache);
 
     if (cfg->demod->am_analyze)
         am_analyze_free(cfg->demod->am_analyze);
     cfg->demod->am_analyze = NULL;
 
+    // pending grabs are written with the samples received so far
+    samp_grab_free(cfg->demod->samp_grab);
+    cfg->demod->samp_grab = NULL;
+
     pulse_detect_free(cfg->demod->pulse_detect);
     cfg->demod->pulse_detect = NULL;
 
+    pulse_analyzer_batch_free(cfg->demod->analyzer_batch);
+    cfg->demod->analyzer_batch = NULL;
+
     list_free_elems(&cfg->raw_handler, (list_elem_free_fn)raw_output_free);
+    list_free_elems(&cfg->pulse_handler, (list_elem_free_fn)pulse_output_free);
 
-    r_logger_set_log_handler(NULL, NULL);
+    if (cfg->primary) {
+        // a receiver only references the outputs and tags of the primary
+        list_free_elems(&cfg->output_handler, NULL);
+        list_free_elems(&cfg->data_tags, NULL);
+    }
+    else {
+        r_logger_set_log_handler(NULL, NULL);
 
-    list_free_elems(&cfg->output_handler, (list_elem_free_fn)data_output_free);
+        list_free_elems(&cfg->output_handler, (list_elem_free_fn)data_output_free);
 
-    list_free_elems(&cfg->data_tags, (list_elem_free_fn)data_tag_free);
+        list_free_elems(&cfg->data_tags, (list_elem_free_fn)data_tag_free);
+    }
 
     list_free_elems(&cfg->in_files, NULL);
 
+    free_demod_buffers(cfg->demod);
+    pulse_data_free(&cfg->demod->pulse_data);
+    pulse_data_free(&cfg->demod->fsk_pulse_data);
+    free(cfg->demod->load_spec);
     free(cfg->demod);
     cfg->demod = NULL;
 
-    free(cfg->devices);
-    cfg->devices = NULL;
+    cfg->devices = NULL; // the registry is shared
 
-    mg_mgr_free(cfg->mgr);
-    free(cfg->mgr);
+    if (!cfg->primary) {
+        mg_mgr_free(cfg->mgr);
+        free(cfg->mgr);
+    }
     cfg->mgr = NULL;
 
     //free(cfg);
@@ -262,7 +685,347 @@ void r_free_cfg(r_cfg_t *cfg)
 
 /* device decoder protocols */
 
-void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
+// insert a decoder after all decoders of the same or a smaller priority
+static void dispatch_insert(list_t *list, r_device *r_dev)
+{
+    list_push(list, r_dev);
+    size_t i = list->len - 1;
+    for (; i > 0; --i) {
+        r_device *p = list->elems[i - 1];
+        if (p->priority <= r_dev->priority)
+            break;
+        list->elems[i] = p;
+    }
+    list->elems[i] = r_dev;
+}
+
+// decoders slicing the pulses the same way, verbose slicers log with the decoder name
+static int same_slicer(r_device const *a, r_device const *b)
+{
+    return a->modulation == b->modulation
+            && a->short_width == b->short_width
+            && a->long_width == b->long_width
+            && a->reset_limit == b->reset_limit
+            && a->gap_limit == b->gap_limit
+            && a->sync_width == b->sync_width
+            && a->tolerance == b->tolerance
+            && !a->verbose && !b->verbose;
+}
+
+// put a decoder in the slice group of another decoder with the same slicer parameters
+static void dispatch_group(struct dm_state *demod, list_t *list, r_device *r_dev)
+{
+    r_dev->slice_group = 0;
+    for (void **iter = list->elems; iter && *iter; ++iter) {
+        r_device *p = *iter;
+        if (p != r_dev && same_slicer(p, r_dev)) {
+            if (!p->slice_group)
+                p->slice_group = ++demod->slice_groups;
+            r_dev->slice_group = p->slice_group;
+            return;
+        }
+    }
+}
+
+// compile the preambles of a slice group into one matcher, if more than one decoder of the group has a preamble
+static void dispatch_preambles(struct dm_state *demod, list_t *list, unsigned group)
+{
+    if (!group)
+        return;
+
+    slicer_cache_reserve(&demod->slicer_cache, group + 1);
+    slicer_cache_entry_t *entry = &demod->slicer_cache.entries[group];
+    preamble_matcher_free(entry->matcher);
+    entry->matcher = NULL;
+
+    unsigned count = 0;
+    for (void **iter = list->elems; iter && *iter; ++iter) {
+        r_device *p = *iter;
+        if (p->slice_group == group) {
+            p->preamble_slot = 0;
+            count += p->preamble.bits > 0;
+        }
+    }
+    if (count < 2)
+        return;
+
+    entry->matcher = preamble_matcher_create();
+    for (void **iter = list->elems; iter && *iter; ++iter) {
+        r_device *p = *iter;
+        if (p->slice_group == group && p->preamble.bits) {
+            p->preamble_slot = preamble_matcher_add(entry->matcher, p->preamble.pattern, p->preamble.bits, p->preamble.inverted);
+        }
+    }
+}
+
+static void dispatch_remove(list_t *list, r_device *r_dev)
+{
+    for (size_t i = 0; i < list->len; ++i) {
+        if (list->elems[i] == r_dev) {
+            list_remove(list, i, NULL);
+            return;
+        }
+    }
+}
+
+// the band of a frequency, 0 if it is in none of the bands
+static unsigned frequency_band(uint32_t frequency)
+{
+    if (frequency >= 300000000 && frequency < 350000000)
+        return FREQ_BAND_315;
+    if (frequency >= 420000000 && frequency < 450000000)
+        return FREQ_BAND_433;
+    if (frequency >= 850000000 && frequency < 890000000)
+        return FREQ_BAND_868;
+    if (frequency >= 900000000 && frequency < 930000000)
+        return FREQ_BAND_915;
+    return 0;
+}
+
+static int band_runs(r_device const *r_dev, unsigned band, unsigned const *protocols)
+{
+    if (!r_dev->protocol_num)
+        return 1;
+    if (protocols) {
+        for (; *protocols; ++protocols) {
+            if (*protocols == r_dev->protocol_num)
+                return 1;
+        }
+        return 0;
+    }
+    return !band || !r_dev->bands || (r_dev->bands & band);
+}
+
+// the gap that ends an OOK package, the longest reset limit of the OOK decoders that run if selected with -R
+static void dispatch_max_gap(struct dm_state *demod)
+{
+    list_t const *devs = demod->band_frequency ? &demod->band_ook_devs : &demod->ook_devs;
+    float max_reset    = 0.0f;
+    // the analyzer sees the whole packages, the default decoders keep the default package splitting
+    int unlimited = !devs->len || demod->analyze_pulses || demod->default_devices;
+    for (void **iter = devs->elems; iter && *iter; ++iter) {
+        r_device const *r_dev = *iter;
+        unlimited |= r_dev->reset_limit <= 0.0f;
+        max_reset = MAX(max_reset, r_dev->reset_limit);
+    }
+    unsigned max_gap_us = 0; // the default of PD_MAX_GAP_MS
+    if (demod->max_gap_ms > 0)
+        max_gap_us = (unsigned)demod->max_gap_ms * 1000;
+    else if (!unlimited && max_reset < PD_MAX_GAP_MS * 1000)
+        max_gap_us = (unsigned)ceilf(max_reset);
+    pulse_detect_set_max_gap(demod->pulse_detect, max_gap_us);
+}
+
+// filter the dispatch lists for the selected frequency, the order by priority is kept
+static void dispatch_bands(struct dm_state *demod)
+{
+    list_clear(&demod->band_ook_devs, NULL);
+    list_clear(&demod->band_fsk_devs, NULL);
+    if (demod->band_frequency) {
+        unsigned band = frequency_band(demod->band_frequency);
+        for (void **iter = demod->ook_devs.elems; iter && *iter; ++iter) {
+            if (band_runs(*iter, band, demod->band_protocols))
+                list_push(&demod->band_ook_devs, *iter);
+        }
+        for (void **iter = demod->fsk_devs.elems; iter && *iter; ++iter) {
+            if (band_runs(*iter, band, demod->band_protocols))
+                list_push(&demod->band_fsk_devs, *iter);
+        }
+    }
+    dispatch_max_gap(demod);
+}
+
+void r_update_max_gap(r_cfg_t *cfg)
+{
+    dispatch_max_gap(cfg->demod);
+}
+
+/// A unit conversion of the double fields with a key suffix.
+typedef struct unit_conversion {
+    conversion_mode_t mode;
+    char const *suffix;     ///< key suffix of the native unit
+    char const *new_suffix; ///< key suffix of the converted unit
+    char const *unit;       ///< unit in the format
+    char const *new_unit;   ///< converted unit in the format
+    int last_letter;        ///< only the last letter of the unit in the format is changed
+    float (*convert)(float value);
+} unit_conversion_t;
+
+// the first conversion with a matching suffix of a mode applies
+static unit_conversion_t const unit_conversions[] = {
+        {CONVERT_SI, "_F", "_C", "F", "C", 1, fahrenheit2celsius},
+        {CONVERT_SI, "_mi_h", "_km_h", "mi/h", "km/h", 0, mph2kmph},
+        {CONVERT_SI, "_in", "_mm", "in", "mm", 0, inch2mm},
+        {CONVERT_SI, "_in_h", "_mm_h", "in/h", "mm/h", 0, inch2mm},
+        {CONVERT_SI, "_inHg", "_hPa", "inHg", "hPa", 0, inhg2hpa},
+        {CONVERT_SI, "_PSI", "_kPa", "PSI", "kPa", 0, psi2kpa},
+        {CONVERT_CUSTOMARY, "_C", "_F", "C", "F", 1, celsius2fahrenheit},
+        {CONVERT_CUSTOMARY, "_km_h", "_mi_h", "km/h", "mi/h", 0, kmph2mph},
+        {CONVERT_CUSTOMARY, "_mm", "_in", "mm", "in", 0, mm2inch},
+        {CONVERT_CUSTOMARY, "_mm_h", "_in_h", "mm/h", "in/h", 0, mm2inch},
+        {CONVERT_CUSTOMARY, "_hPa", "_inHg", "hPa", "inHg", 0, hpa2inhg},
+        {CONVERT_CUSTOMARY, "_kPa", "_PSI", "kPa", "PSI", 0, kpa2psi},
+};
+
+/// The conversion of one field of a decoder.
+typedef struct field_conversion {
+    char const *key;               ///< the field as output by the decoder
+    char *new_key;                 ///< the converted key
+    unit_conversion_t const *conv;
+    int seen;                      ///< the field was converted before, the format is known
+    char *format;                  ///< the format of the first conversion
+    char *new_format;              ///< the converted format, used while the format stays the same
+} field_conversion_t;
+
+/// The unit conversions of the fields of a decoder, made when the decoder is registered.
+typedef struct conversion_plan {
+    unsigned count;
+    field_conversion_t fields[];
+} conversion_plan_t;
+
+static unit_conversion_t const *find_unit_conversion(char const *key, conversion_mode_t mode)
+{
+    for (size_t i = 0; i < sizeof(unit_conversions) / sizeof(*unit_conversions); ++i) {
+        if (unit_conversions[i].mode == mode && str_endswith(key, unit_conversions[i].suffix))
+            return &unit_conversions[i];
+    }
+    return NULL;
+}
+
+// the format of a converted field, NULL if there is no format
+static char *convert_format(unit_conversion_t const *conv, char const *format)
+{
+    if (!format)
+        return NULL;
+    char *new_format;
+    if (conv->last_letter) {
+        new_format = strdup(format);
+        if (!new_format)
+            FATAL_STRDUP("convert_format()");
+        char *pos = strrchr(new_format, conv->unit[0]);
+        if (pos)
+            *pos = conv->new_unit[0];
+    }
+    else {
+        new_format = str_replace(format, conv->unit, conv->new_unit);
+        if (!new_format)
+            FATAL_MALLOC("convert_format()");
+    }
+    return new_format;
+}
+
+static conversion_plan_t *conversion_plan_create(char const *const *fields)
+{
+    conversion_mode_t const modes[] = {CONVERT_SI, CONVERT_CUSTOMARY};
+    unsigned count = 0;
+    for (char const *const *p = fields; p && *p; ++p) {
+        for (unsigned m = 0; m < 2; ++m)
+            count += find_unit_conversion(*p, modes[m]) != NULL;
+    }
+    if (!count)
+        return NULL;
+
+    conversion_plan_t *plan = calloc(1, sizeof(*plan) + count * sizeof(*plan->fields));
+    if (!plan)
+        FATAL_CALLOC("conversion_plan_create()");
+    for (char const *const *p = fields; *p; ++p) {
+        for (unsigned m = 0; m < 2; ++m) {
+            unit_conversion_t const *conv = find_unit_conversion(*p, modes[m]);
+            if (!conv)
+                continue;
+            field_conversion_t *f = &plan->fields[plan->count++];
+            f->key     = *p;
+            f->conv    = conv;
+            f->new_key = str_replace(*p, conv->suffix, conv->new_suffix);
+            if (!f->new_key)
+                FATAL_MALLOC("conversion_plan_create()");
+        }
+    }
+    return plan;
+}
+
+static void conversion_plan_free(conversion_plan_t *plan)
+{
+    if (!plan)
+        return;
+    for (unsigned i = 0; i < plan->count; ++i) {
+        free(plan->fields[i].new_key);
+        free(plan->fields[i].format);
+        free(plan->fields[i].new_format);
+    }
+    free(plan);
+}
+
+// convert the double fields of a decoder output with the plan of the decoder
+static void convert_units(r_device *r_dev, conversion_mode_t mode, data_t *data)
+{
+    conversion_plan_t *plan = r_dev->conversions;
+    if (!plan || mode == CONVERT_NATIVE)
+        return;
+
+    for (data_t *d = data; d; d = d->next) {
+        if (d->type != DATA_DOUBLE)
+            continue;
+        for (unsigned i = 0; i < plan->count; ++i) {
+            field_conversion_t *f = &plan->fields[i];
+            if (f->conv->mode != mode || strcmp(d->key, f->key))
+                continue;
+            d->value.v_dbl = f->conv->convert(d->value.v_dbl);
+            data_borrow_key(d, f->new_key);
+            // the converted format is kept for the first format, the plan belongs to the decoder task
+            if (!f->seen) {
+                f->seen = 1;
+                if (d->format) {
+                    f->format = strdup(d->format);
+                    if (!f->format)
+                        FATAL_STRDUP("convert_units()");
+                }
+                f->new_format = convert_format(f->conv, d->format);
+            }
+            if (f->format ? d->format && !strcmp(d->format, f->format) : !d->format)
+                data_borrow_format(d, f->new_format);
+            else
+                data_replace_format(d, convert_format(f->conv, d->format));
+            break;
+        }
+    }
+}
+
+// set up a decoder instance for the config and add it to the dispatch lists, the config owns it
+static void register_instance(r_cfg_t *cfg, r_device *p, int dev_verbose)
+{
+    p->verbose      = dev_verbose ? dev_verbose : (cfg->verbosity > 4 ? cfg->verbosity - 5 : 0);
+    p->verbose_bits = cfg->verbose_bits;
+    p->log_fn       = log_device_handler;
+
+    p->output_fn   = data_acquired_handler;
+    p->output_ctx  = cfg;
+    p->conversions = conversion_plan_create(p->fields);
+
+    // the decoders of all tenant pipelines share the slice groups, the events go to the outputs of their tenant
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    p->report_cost = cfg->report_stats >= 3 || root->decoder_usage_report;
+    tenant_t const *tenant = cfg->tenant && cfg->tenant <= root->tenants.len ? root->tenants.elems[cfg->tenant - 1] : NULL;
+    p->tenant              = tenant ? cfg->tenant : 0;
+    p->conversion_mode     = tenant ? tenant->conversion_mode : CONVERT_NATIVE;
+    mem_acct_add(MEM_TAG_DECODERS, (long)(sizeof(*p) + p->decode_ctx_size));
+
+    list_push(&cfg->demod->r_devs, p);
+    list_t *dispatch = p->modulation >= FSK_DEMOD_MIN_VAL ? &cfg->demod->fsk_devs : &cfg->demod->ook_devs;
+    dispatch_group(cfg->demod, dispatch, p);
+    dispatch_insert(dispatch, p);
+    dispatch_preambles(cfg->demod, dispatch, p->slice_group);
+    dispatch_bands(cfg->demod);
+
+    if (cfg->verbosity >= LOG_INFO) {
+        fprintf(stderr, "Registering protocol [%u] \"%s\"\n", p->protocol_num, p->name);
+    }
+}
+
+void register_protocol(r_cfg_t *cfg, r_device const *r_dev, char *arg)
 {
     // use arg of 'v', 'vv', 'vvv' as device verbosity
     int dev_verbose = 0;
@@ -279,6 +1042,8 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
     r_device *p;
     if (r_dev->create_fn) {
         p = r_dev->create_fn(arg);
+        // the instance is made from the unnumbered template
+        p->protocol_num = r_dev->protocol_num;
     }
     else {
         if (arg && *arg) {
@@ -290,89 +1055,641 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
         *p = *r_dev; // copy
     }
 
-    p->verbose      = dev_verbose ? dev_verbose : (cfg->verbosity > 4 ? cfg->verbosity - 5 : 0);
-    p->verbose_bits = cfg->verbose_bits;
-    p->log_fn       = log_device_handler;
+    register_instance(cfg, p, dev_verbose);
+}
+
+void register_decoder(r_cfg_t *cfg, r_device *r_dev)
+{
+    register_instance(cfg, r_dev, 0);
+}
+
+void free_protocol(r_device *r_dev)
+{
+    // free(r_dev->name);
+    mem_acct_add(MEM_TAG_DECODERS, -(long)(sizeof(*r_dev) + r_dev->decode_ctx_size));
+    if (!r_dev->packed || !r_dev->decode_ctx_size)
+        free(r_dev->decode_ctx);
+    free(r_dev->dedup);
+    conversion_plan_free(r_dev->conversions);
+    if (!r_dev->packed)
+        free(r_dev);
+}
+
+// removes the decoder at index i from the dispatch lists and frees it
+static void unregister_instance(r_cfg_t *cfg, size_t i)
+{
+    r_device *p = cfg->demod->r_devs.elems[i];
+    dispatch_remove(&cfg->demod->ook_devs, p);
+    dispatch_remove(&cfg->demod->fsk_devs, p);
+    list_t *dispatch = p->modulation >= FSK_DEMOD_MIN_VAL ? &cfg->demod->fsk_devs : &cfg->demod->ook_devs;
+    dispatch_preambles(cfg->demod, dispatch, p->slice_group);
+    list_remove(&cfg->demod->r_devs, i, (list_elem_free_fn)free_protocol);
+}
+
+void unregister_protocol(r_cfg_t *cfg, r_device const *r_dev)
+{
+    flush_outputs(cfg);
+    for (size_t i = 0; i < cfg->demod->r_devs.len; ++i) { // list might contain NULLs
+        r_device *p = cfg->demod->r_devs.elems[i];
+        // all instances of a registered protocol carry its number, only unnumbered decoders go by name
+        if (p->tenant == cfg->tenant
+                && (r_dev->protocol_num ? p->protocol_num == r_dev->protocol_num : !strcmp(p->name, r_dev->name))) {
+            unregister_instance(cfg, i);
+            i--; // so we don't skip the next elem now shifted down
+        }
+    }
+    cfg->demod->default_devices = 0;
+    dispatch_bands(cfg->demod);
+}
+
+void unregister_all_protocols(r_cfg_t *cfg)
+{
+    flush_outputs(cfg);
+    cfg->demod->default_devices = 0;
+
+    // the decoders of the other tenant pipelines stay
+    int others = 0;
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *p = *iter;
+        others |= p->tenant != cfg->tenant;
+    }
+    if (others) {
+        for (size_t i = 0; i < cfg->demod->r_devs.len; ++i) {
+            r_device *p = cfg->demod->r_devs.elems[i];
+            if (p->tenant == cfg->tenant) {
+                unregister_instance(cfg, i);
+                i--;
+            }
+        }
+        dispatch_bands(cfg->demod);
+        return;
+    }
+
+    list_clear(&cfg->demod->ook_devs, NULL);
+    list_clear(&cfg->demod->fsk_devs, NULL);
+    list_clear(&cfg->demod->band_ook_devs, NULL);
+    list_clear(&cfg->demod->band_fsk_devs, NULL);
+    list_clear(&cfg->demod->early_devs, NULL);
+    list_clear(&cfg->demod->r_devs, (list_elem_free_fn)free_protocol);
+    free(cfg->demod->packed_devs);
+    cfg->demod->packed_devs = NULL;
+    for (unsigned i = 0; i < cfg->demod->slicer_cache.size; ++i) {
+        preamble_matcher_free(cfg->demod->slicer_cache.entries[i].matcher);
+        cfg->demod->slicer_cache.entries[i].matcher = NULL;
+    }
+    dispatch_max_gap(cfg->demod);
+}
+
+void register_all_protocols(r_cfg_t *cfg, unsigned disabled)
+{
+    for (int i = 0; i < cfg->num_r_devices; i++) {
+        // register all device protocols that are not disabled
+        if (cfg->devices[i].disabled <= disabled) {
+            register_protocol(cfg, &cfg->devices[i], NULL);
+        }
+    }
+    cfg->demod->default_devices = 1;
+    dispatch_max_gap(cfg->demod);
+}
+
+/// Decoders assigned to a shard together, a slice group or a single decoder.
+typedef struct shard_unit {
+    unsigned first; ///< index of the first decoder in the dispatch list
+    double cost;
+    unsigned shard;
+} shard_unit_t;
+
+// most costly first, then in dispatch order
+static int shard_unit_cmp(void const *a, void const *b)
+{
+    shard_unit_t const *x = a;
+    shard_unit_t const *y = b;
+    if (x->cost != y->cost)
+        return x->cost > y->cost ? -1 : 1;
+    return x->first < y->first ? -1 : x->first > y->first;
+}
+
+// read the cost of each protocol number, negative if unknown, returns the number of costs read or -1
+static int read_shard_costs(char const *path, double *costs, int num_costs)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    int count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        int num;
+        double cost;
+        if (line[0] == '#' || sscanf(line, "%d %lf", &num, &cost) != 2)
+            continue;
+        if (num > 0 && num < num_costs && cost >= 0.0) {
+            costs[num] = cost;
+            count++;
+        }
+    }
+    fclose(fp);
+    return count;
+}
+
+// split one dispatch list into the shards, returns the cost kept
+static double shard_dispatch(r_cfg_t *cfg, list_t *dispatch, double const *costs, double avg_cost, double *total_cost)
+{
+    unsigned count = (unsigned)dispatch->len;
+    shard_unit_t *units = calloc(count ? count : 1, sizeof(*units));
+    if (!units)
+        FATAL_CALLOC("r_shard_decoders()");
+    unsigned *unit_of = calloc(count ? count : 1, sizeof(*unit_of));
+    if (!unit_of)
+        FATAL_CALLOC("r_shard_decoders()");
+    double *loads = calloc(cfg->decoder_shards, sizeof(*loads));
+    if (!loads)
+        FATAL_CALLOC("r_shard_decoders()");
+
+    // the decoders of a slice group share the sliced bits, they are one unit
+    unsigned num_units = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        r_device *r_dev = dispatch->elems[i];
+        double cost = r_dev->protocol_num && costs[r_dev->protocol_num] >= 0.0 ? costs[r_dev->protocol_num] : avg_cost;
+        unsigned k = num_units;
+        if (r_dev->slice_group) {
+            for (k = 0; k < num_units; ++k) {
+                r_device *first = dispatch->elems[units[k].first];
+                if (first->slice_group == r_dev->slice_group)
+                    break;
+            }
+        }
+        if (k == num_units) {
+            units[num_units].first = i;
+            units[num_units].cost  = 0.0;
+            num_units++;
+        }
+        units[k].cost += cost;
+        unit_of[i] = k;
+    }
+
+    // the most costly unit goes to the least loaded shard, the order does not depend on the shard
+    shard_unit_t *sorted = calloc(num_units ? num_units : 1, sizeof(*sorted));
+    if (!sorted)
+        FATAL_CALLOC("r_shard_decoders()");
+    memcpy(sorted, units, num_units * sizeof(*units));
+    qsort(sorted, num_units, sizeof(*sorted), shard_unit_cmp);
+    for (unsigned k = 0; k < num_units; ++k) {
+        unsigned shard = 0;
+        for (unsigned n = 1; n < cfg->decoder_shards; ++n) {
+            if (loads[n] < loads[shard])
+                shard = n;
+        }
+        loads[shard] += sorted[k].cost;
+        // find the unit by its first decoder
+        units[unit_of[sorted[k].first]].shard = shard + 1;
+    }
+
+    double kept = loads[cfg->decoder_shard - 1];
+    for (unsigned n = 0; n < cfg->decoder_shards; ++n) {
+        *total_cost += loads[n];
+    }
+
+    // unregister the decoders of the other shards, from the end as the list shrinks
+    for (unsigned i = count; i-- > 0;) {
+        if (units[unit_of[i]].shard == cfg->decoder_shard)
+            continue;
+        r_device *r_dev = dispatch->elems[i];
+        dispatch_remove(dispatch, r_dev);
+        dispatch_preambles(cfg->demod, dispatch, r_dev->slice_group);
+        for (size_t k = 0; k < cfg->demod->r_devs.len; ++k) {
+            if (cfg->demod->r_devs.elems[k] == r_dev) {
+                list_remove(&cfg->demod->r_devs, k, (list_elem_free_fn)free_protocol);
+                break;
+            }
+        }
+    }
+
+    free(sorted);
+    free(loads);
+    free(unit_of);
+    free(units);
+    return kept;
+}
+
+void r_shard_decoders(r_cfg_t *cfg)
+{
+    if (!cfg->decoder_shard || !cfg->decoder_shards) {
+        return;
+    }
+    double *costs = malloc((cfg->num_r_devices + 1) * sizeof(*costs));
+    if (!costs)
+        FATAL_MALLOC("r_shard_decoders()");
+    for (int i = 0; i <= cfg->num_r_devices; ++i) {
+        costs[i] = -1.0;
+    }
+    if (cfg->shard_costs && read_shard_costs(cfg->shard_costs, costs, cfg->num_r_devices + 1) < 0) {
+        print_logf(LOG_WARNING, "Protocol", "Can't read the decoder costs \"%s\", counting the decoders instead.", cfg->shard_costs);
+    }
+
+    // decoders without a cost count as the average of the registered decoders with a cost
+    double sum = 0.0;
+    unsigned known = 0;
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->protocol_num && costs[r_dev->protocol_num] >= 0.0) {
+            sum += costs[r_dev->protocol_num];
+            known++;
+        }
+    }
+    double avg_cost = known && sum > 0.0 ? sum / known : 1.0;
+
+    unsigned registered = (unsigned)cfg->demod->r_devs.len;
+    double total = 0.0;
+    double kept  = shard_dispatch(cfg, &cfg->demod->ook_devs, costs, avg_cost, &total);
+    kept += shard_dispatch(cfg, &cfg->demod->fsk_devs, costs, avg_cost, &total);
+    dispatch_bands(cfg->demod);
+    free(costs);
+
+    if (!cfg->primary) {
+        print_logf(LOG_NOTICE, "Protocol", "Decoder shard %u of %u: %u of %u decoders, %.0f%% of the estimated cost.",
+                cfg->decoder_shard, cfg->decoder_shards, (unsigned)cfg->demod->r_devs.len, registered,
+                total > 0.0 ? 100.0 * kept / total : 0.0);
+    }
+}
+
+void r_select_decoders(r_cfg_t *cfg, uint32_t frequency, unsigned const *protocols)
+{
+    cfg->demod->band_frequency = frequency;
+    cfg->demod->band_protocols = frequency ? protocols : NULL;
+    dispatch_bands(cfg->demod);
+}
+
+/// Alignment of the decoders and their user data in the packed decoders.
+#define PACKED_DEVS_ALIGN 16
+
+static size_t packed_size(size_t size)
+{
+    return (size + PACKED_DEVS_ALIGN - 1) & ~(size_t)(PACKED_DEVS_ALIGN - 1);
+}
+
+// a pointer into the user data of a decoder moved to the same offset in the user data of the copy
+static void const *packed_rebase(void const *ptr, r_device const *old, r_device const *dev)
+{
+    char const *ctx = old->decode_ctx;
+    char const *pos = ptr;
+    if (pos >= ctx && pos < ctx + old->decode_ctx_size)
+        return (char const *)dev->decode_ctx + (pos - ctx);
+    return ptr;
+}
+
+void r_pack_decoders(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+    list_t *lists[] = {&demod->ook_devs, &demod->fsk_devs};
+
+    size_t size = 0;
+    for (size_t k = 0; k < sizeof(lists) / sizeof(*lists); ++k) {
+        for (void **iter = lists[k]->elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            size += packed_size(sizeof(*r_dev)) + packed_size(r_dev->decode_ctx_size);
+        }
+    }
+    if (!size)
+        return;
+    char *packed = calloc(1, size);
+    if (!packed) {
+        WARN_CALLOC("r_pack_decoders()");
+        return; // NOTE: the decoders are not packed on alloc failure.
+    }
+
+    char *pos = packed;
+    for (size_t k = 0; k < sizeof(lists) / sizeof(*lists); ++k) {
+        for (void **iter = lists[k]->elems; iter && *iter; ++iter) {
+            r_device *old = *iter;
+            r_device *dev = (r_device *)pos;
+            pos += packed_size(sizeof(*dev));
+            *dev = *old; // copy, takes the dedup, the conversions and an unsized decode_ctx
+            if (old->decode_ctx_size) {
+                memcpy(pos, old->decode_ctx, old->decode_ctx_size);
+                dev->decode_ctx = pos;
+                pos += packed_size(old->decode_ctx_size);
+                // e.g. flex decoders point the preamble and the fields into their params
+                dev->preamble.pattern = packed_rebase(old->preamble.pattern, old, dev);
+                dev->fields           = packed_rebase(old->fields, old, dev);
+            }
+            dev->packed = 1;
+
+            *iter = dev;
+            for (size_t i = 0; i < demod->r_devs.len; ++i) {
+                if (demod->r_devs.elems[i] == old)
+                    demod->r_devs.elems[i] = dev;
+            }
+            if (old->decode_ctx_size)
+                free(old->decode_ctx);
+            if (!old->packed)
+                free(old);
+        }
+    }
+    free(demod->packed_devs);
+    demod->packed_devs = packed;
+    dispatch_bands(demod);
+}
+
+/// An output handing the events of a re-decode to a callback.
+typedef struct {
+    data_output_t output;
+    r_redecode_fn event_fn;
+    void *ctx;
+} redecode_output_t;
+
+static void R_API_CALLCONV redecode_output_print(data_output_t *output, data_t *data)
+{
+    redecode_output_t *out = (redecode_output_t *)output;
+    out->event_fn(out->ctx, data);
+}
+
+static void R_API_CALLCONV redecode_output_free(data_output_t *output)
+{
+    free(output);
+}
+
+// a copy of the information of a decoder with its own user data, the counters and the dispatch are fresh, NULL on failure
+static r_device *copy_decoder(r_device const *old)
+{
+    r_device *dev = calloc(1, sizeof(*dev));
+    if (!dev) {
+        WARN_CALLOC("copy_decoder()");
+        return NULL;
+    }
+    dev->protocol_num  = old->protocol_num;
+    dev->name          = old->name;
+    dev->modulation    = old->modulation;
+    dev->bands         = old->bands;
+    dev->short_width   = old->short_width;
+    dev->long_width    = old->long_width;
+    dev->reset_limit   = old->reset_limit;
+    dev->gap_limit     = old->gap_limit;
+    dev->sync_width    = old->sync_width;
+    dev->tolerance     = old->tolerance;
+    dev->decode_fn     = old->decode_fn;
+    dev->create_fn     = old->create_fn;
+    dev->priority      = old->priority;
+    dev->disabled      = old->disabled;
+    dev->fields        = old->fields;
+    dev->reports_empty = old->reports_empty;
+    dev->preamble      = old->preamble;
+    dev->rows          = old->rows;
+    dev->transform     = old->transform;
+    dev->early_pulses  = old->early_pulses;
+    dev->verbose       = old->verbose;
+    if (old->decode_ctx_size) {
+        dev->decode_ctx = malloc(old->decode_ctx_size);
+        if (!dev->decode_ctx) {
+            WARN_MALLOC("copy_decoder()");
+            free(dev);
+            return NULL;
+        }
+        memcpy(dev->decode_ctx, old->decode_ctx, old->decode_ctx_size);
+        dev->decode_ctx_size = old->decode_ctx_size;
+        // e.g. flex decoders point the preamble and the fields into their params
+        dev->preamble.pattern = packed_rebase(old->preamble.pattern, old, dev);
+        dev->fields           = packed_rebase(old->fields, old, dev);
+    }
+    return dev;
+}
+
+typedef struct {
+    r_cfg_t *cfg; ///< the config with the copies of the decoders
+    int events;
+} redecode_t;
 
-    p->output_fn  = data_acquired_handler;
-    p->output_ctx = cfg;
+// decode a recorded package as read from a pulse archive, with the time and the meta data of the package
+static void redecode_package(void *ctx, pulse_data_t *data, int package_type)
+{
+    redecode_t *redecode   = ctx;
+    r_cfg_t *cfg           = redecode->cfg;
+    struct dm_state *demod = cfg->demod;
+
+    cfg->samp_rate        = data->sample_rate;
+    cfg->center_frequency = (uint32_t)data->centerfreq_hz;
+    demod->now.tv_sec     = (time_t)(data->received_us / 1000000);
+    demod->now.tv_usec    = (long)(data->received_us % 1000000);
+    if (package_type == PULSE_DATA_FSK) {
+        pulse_data_clear(&demod->pulse_data);
+        pulse_data_copy(&demod->fsk_pulse_data, data);
+        redecode->events += run_fsk_demods(&demod->fsk_devs, &demod->fsk_pulse_data, &demod->slicer_cache, NULL);
+    }
+    else {
+        pulse_data_clear(&demod->fsk_pulse_data);
+        pulse_data_copy(&demod->pulse_data, data);
+        redecode->events += run_ook_demods(&demod->ook_devs, &demod->pulse_data, &demod->slicer_cache, NULL);
+    }
+}
 
-    list_push(&cfg->demod->r_devs, p);
+int r_redecode_recorded(r_cfg_t *cfg, int64_t from_us, int64_t to_us, r_redecode_fn event_fn, void *ctx)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (!root->pulse_recorder) {
+        return -1;
+    }
+
+    redecode_output_t *out = calloc(1, sizeof(*out));
+    if (!out) {
+        WARN_CALLOC("r_redecode_recorded()");
+        return -1;
+    }
+    out->output.output_print = redecode_output_print;
+    out->output.output_free  = redecode_output_free;
+    out->event_fn            = event_fn;
+    out->ctx                 = ctx;
+
+    // a config of its own, the decoders of the primary keep running on their threads
+    r_cfg_t *scratch = r_create_cfg();
+    list_push(&scratch->output_handler, out);
+    scratch->verbosity          = LOG_WARNING;
+    scratch->conversion_mode    = root->conversion_mode;
+    scratch->report_meta        = root->report_meta;
+    scratch->report_protocol    = root->report_protocol;
+    scratch->report_description = root->report_description;
+    scratch->report_time_hires  = root->report_time_hires;
+    scratch->report_time_tz     = root->report_time_tz;
+    scratch->report_time_utc    = root->report_time_utc;
+    // the sample positions are of the live input, the packages have a receive time
+    int dated = root->report_time == REPORT_TIME_DATE || root->report_time == REPORT_TIME_UNIX || root->report_time == REPORT_TIME_ISO;
+    scratch->report_time = dated ? root->report_time : REPORT_TIME_DATE;
+
+    int ret = 0;
+    for (void **iter = root->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device const *old = *iter;
+        // user data without a size can't be copied
+        if (old->tenant || (old->decode_ctx && !old->decode_ctx_size)) {
+            continue;
+        }
+        r_device *dev = copy_decoder(old);
+        if (!dev) {
+            ret = -1;
+            break;
+        }
+        register_instance(scratch, dev, dev->verbose);
+    }
 
-    if (cfg->verbosity >= LOG_INFO) {
-        fprintf(stderr, "Registering protocol [%u] \"%s\"\n", r_dev->protocol_num, r_dev->name);
+    redecode_t redecode = {.cfg = scratch};
+    if (ret == 0) {
+        ret = pulse_recorder_replay(root->pulse_recorder, from_us, to_us, redecode_package, &redecode);
     }
+    if (ret >= 0) {
+        print_logf(LOG_INFO, "Redecode", "Re-decoded %d recorded packages with %zu decoders, %d events.",
+                ret, scratch->demod->r_devs.len, redecode.events);
+    }
+    r_free_cfg(scratch);
+    free(scratch);
+    return ret;
 }
 
-void free_protocol(r_device *r_dev)
+void r_stage_decoders(r_cfg_t *cfg, r_cfg_t *stage)
 {
-    // free(r_dev->name);
-    free(r_dev->decode_ctx);
-    free(r_dev);
+    atomic_store_release(&cfg->staged_decoders, stage);
 }
 
-void unregister_protocol(r_cfg_t *cfg, r_device *r_dev)
+void r_apply_staged_decoders(r_cfg_t *cfg)
 {
-    for (size_t i = 0; i < cfg->demod->r_devs.len; ++i) { // list might contain NULLs
-        r_device *p = cfg->demod->r_devs.elems[i];
-        if (!strcmp(p->name, r_dev->name)) {
-            list_remove(&cfg->demod->r_devs, i, (list_elem_free_fn)free_protocol);
-            i--; // so we don't skip the next elem now shifted down
-        }
+    r_cfg_t *stage = atomic_load_acquire(&cfg->staged_decoders);
+    if (!stage) {
+        return;
     }
+    struct dm_state *demod = cfg->demod;
+    struct dm_state *next  = stage->demod;
+
+    // the dispatch lists and the slicer cache go with the decoders, the detector state stays
+    list_t r_devs = demod->r_devs;
+    demod->r_devs = next->r_devs;
+    next->r_devs  = r_devs;
+    list_t ook_devs = demod->ook_devs;
+    demod->ook_devs = next->ook_devs;
+    next->ook_devs  = ook_devs;
+    list_t fsk_devs = demod->fsk_devs;
+    demod->fsk_devs = next->fsk_devs;
+    next->fsk_devs  = fsk_devs;
+    slicer_cache_t slicer_cache = demod->slicer_cache;
+    demod->slicer_cache = next->slicer_cache;
+    next->slicer_cache  = slicer_cache;
+    unsigned slice_groups = demod->slice_groups;
+    demod->slice_groups = next->slice_groups;
+    next->slice_groups  = slice_groups;
+    void *packed_devs = demod->packed_devs;
+    demod->packed_devs = next->packed_devs;
+    next->packed_devs  = packed_devs;
+    int default_devices = demod->default_devices;
+    demod->default_devices = next->default_devices;
+    next->default_devices  = default_devices;
+
+    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        r_dev->output_ctx = cfg;
+        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL)
+            demod->enable_FM_demod = 1;
+    }
+    dispatch_bands(demod);
+
+    // the old decoders are freed on the event loop once their events are delivered
+    atomic_store_release(&cfg->retired_decoders, stage);
+    atomic_store_release(&cfg->staged_decoders, NULL);
 }
 
-void register_all_protocols(r_cfg_t *cfg, unsigned disabled)
+int r_free_retired_decoders(r_cfg_t *cfg)
 {
-    for (int i = 0; i < cfg->num_r_devices; i++) {
-        // register all device protocols that are not disabled
-        if (cfg->devices[i].disabled <= disabled) {
-            register_protocol(cfg, &cfg->devices[i], NULL);
+    r_cfg_t *stage = atomic_load_acquire(&cfg->retired_decoders);
+    if (stage) {
+        atomic_store_release(&cfg->retired_decoders, NULL);
+        r_cfg_t *primary = cfg;
+        while (primary->primary) {
+            primary = primary->primary;
         }
+        flush_outputs(primary);
+        r_free_cfg(stage);
+        free(stage);
     }
+    return atomic_load_acquire(&cfg->staged_decoders) != NULL;
 }
 
 /* output helper */
 
 void calc_rssi_snr(r_cfg_t *cfg, pulse_data_t *pulse_data)
 {
-    float ook_high_estimate = pulse_data->ook_high_estimate > 0 ? pulse_data->ook_high_estimate : 1;
-    float ook_low_estimate = pulse_data->ook_low_estimate > 0 ? pulse_data->ook_low_estimate : 1;
-    int const OOK_MAX_HIGH_LEVEL = DB_TO_AMP(0); // Maximum estimate for high level (-0 dB)
-    float ook_max_estimate = ook_high_estimate < OOK_MAX_HIGH_LEVEL ? ook_high_estimate : OOK_MAX_HIGH_LEVEL;
-    float asnr   = ook_max_estimate / ook_low_estimate;
+    // the levels are ratios to the full scale of 16384, in integer arithmetic
+    int const OOK_MAX_HIGH_LEVEL = 16384; // DB_TO_AMP(0), maximum estimate for high level (-0 dB)
+    int ook_high_estimate = pulse_data->ook_high_estimate > 0 ? pulse_data->ook_high_estimate : 1;
+    int ook_low_estimate  = pulse_data->ook_low_estimate > 0 ? pulse_data->ook_low_estimate : 1;
+    int ook_max_estimate  = ook_high_estimate < OOK_MAX_HIGH_LEVEL ? ook_high_estimate : OOK_MAX_HIGH_LEVEL;
+    int rssi_q16  = ratio_to_db_q16(ook_high_estimate, OOK_MAX_HIGH_LEVEL);
+    int noise_q16 = ratio_to_db_q16(ook_low_estimate, OOK_MAX_HIGH_LEVEL);
+    int snr_q16   = ratio_to_db_q16(ook_max_estimate, ook_low_estimate);
     float foffs1 = (float)pulse_data->fsk_f1_est / INT16_MAX * cfg->samp_rate / 2.0f;
     float foffs2 = (float)pulse_data->fsk_f2_est / INT16_MAX * cfg->samp_rate / 2.0f;
     pulse_data->freq1_hz = (foffs1 + cfg->center_frequency);
     pulse_data->freq2_hz = (foffs2 + cfg->center_frequency);
     pulse_data->centerfreq_hz = cfg->center_frequency;
-    pulse_data->depth_bits    = cfg->demod->sample_size * 4;
+    pulse_data->depth_bits    = cfg->demod->sample_format == BASEBAND_CF32 ? 16 : cfg->demod->sample_size * 4; // CF32 on the CS16 scale
     // NOTE: for (CU8) amplitude is 10x (because it's squares)
-    if (cfg->demod->sample_size == 2 && !cfg->demod->use_mag_est) { // amplitude (CU8)
+    if (cfg->demod->sample_size == 2 && !cfg->demod->use_mag_est) { // amplitude (CU8, CS8)
         pulse_data->range_db = 42.1442f; // 10*log10f(16384.0f) == 20*log10f(128.0f)
-        pulse_data->rssi_db  = 10.0f * log10f(ook_high_estimate) - 42.1442f; // 10*log10f(16384.0f)
-        pulse_data->noise_db = 10.0f * log10f(ook_low_estimate) - 42.1442f; // 10*log10f(16384.0f)
-        pulse_data->snr_db   = 10.0f * log10f(asnr);
+        pulse_data->rssi_db  = rssi_q16 * (1.0f / 65536);
+        pulse_data->noise_db = noise_q16 * (1.0f / 65536);
+        pulse_data->snr_db   = snr_q16 * (1.0f / 65536);
     }
     else { // magnitude (CU8, CS16)
         pulse_data->range_db = 84.2884f; // 20*log10f(16384.0f)
         // lowest (scaled x128) reading at  8 bit is -20*log10(128) = -42.1442 (eff. -36 dB)
         // lowest (scaled div2) reading at 12 bit is -20*log10(1024) = -60.2060 (eff. -54 dB)
         // lowest (scaled div2) reading at 16 bit is -20*log10(16384) = -84.2884 (eff. -78 dB)
-        pulse_data->rssi_db  = 20.0f * log10f(ook_high_estimate) - 84.2884f; // 20*log10f(16384.0f)
-        pulse_data->noise_db = 20.0f * log10f(ook_low_estimate) - 84.2884f; // 20*log10f(16384.0f)
-        pulse_data->snr_db   = 20.0f * log10f(asnr);
+        pulse_data->rssi_db  = rssi_q16 * (2.0f / 65536);
+        pulse_data->noise_db = noise_q16 * (2.0f / 65536);
+        pulse_data->snr_db   = snr_q16 * (2.0f / 65536);
     }
 }
 
+// the package the events are from, a queued package while it is decoded or retired, otherwise the one just detected
+static package_meta_t const *current_package(r_cfg_t *cfg, package_meta_t *live)
+{
+    package_t const *package = package_queue_current(cfg->package_queue);
+    // the decode thread may run the decoders on the decoder pool
+    if (!package && cfg->package_queue && decoder_pool_is_current(cfg->decoder_pool)) {
+        package = package_queue_decoding(cfg->package_queue);
+    }
+    if (package) {
+        return &package->meta;
+    }
+    struct dm_state const *demod = cfg->demod;
+    *live = (package_meta_t){
+            .pulse_data      = &demod->pulse_data,
+            .fsk_pulse_data  = &demod->fsk_pulse_data,
+            .now             = demod->now,
+            .sample_file_pos = demod->sample_file_pos,
+            .publish_ns      = demod->publish_ns,
+            .demod_start_ns  = demod->demod_start_ns,
+            .detect_ns       = demod->detect_ns,
+            .package_end_ns  = demod->package_end_ns,
+    };
+    return live;
+}
+
+// the pulses of the package a decoder output an event for
+static pulse_data_t const *event_pulses(r_cfg_t *cfg, r_device const *r_dev)
+{
+    package_meta_t live;
+    package_meta_t const *package = current_package(cfg, &live);
+    return r_dev->modulation >= FSK_DEMOD_MIN_VAL ? package->fsk_pulse_data : package->pulse_data;
+}
+
 char *time_pos_str(r_cfg_t *cfg, unsigned samples_ago, char *buf)
 {
+    package_meta_t live;
+    package_meta_t const *package = current_package(cfg, &live);
     if (cfg->report_time == REPORT_TIME_SAMPLES) {
         double s_per_sample = 1.0f / cfg->samp_rate;
-        return sample_pos_str(cfg->demod->sample_file_pos - samples_ago * s_per_sample, buf);
+        return sample_pos_str(package->sample_file_pos - samples_ago * s_per_sample, buf);
     }
     else {
-        struct timeval ago = cfg->demod->now;
+        struct timeval ago = package->now;
         double us_per_sample = 1e6 / cfg->samp_rate;
         unsigned usecs_ago   = samples_ago * us_per_sample;
         while (ago.tv_usec < (int)usecs_ago) {
@@ -387,11 +1704,53 @@ char *time_pos_str(r_cfg_t *cfg, unsigned samples_ago, char *buf)
         else if (cfg->report_time == REPORT_TIME_ISO)
             format = "%Y-%m-%dT%H:%M:%S";
 
-        if (cfg->report_time_hires)
-            return usecs_time_str(buf, format, cfg->report_time_tz, &ago);
-        else
-            return format_time_str(buf, format, cfg->report_time_tz, ago.tv_sec);
+        // the events and log lines of a second share the rendered date and time
+        static time_str_cache_t time_cache;
+        return cached_time_str(&time_cache, buf, format, cfg->report_time_tz, &ago, cfg->report_time_hires);
+    }
+}
+
+/// Upper bounds of the latency histogram bins in ms, the last bin counts the rest.
+static int const latency_bounds_ms[LATENCY_HIST_BINS - 1] = LATENCY_HIST_BOUNDS_MS;
+
+void record_latency(r_cfg_t *cfg, unsigned end_ago)
+{
+    package_meta_t live;
+    package_meta_t const *package = current_package(cfg, &live);
+    // only live input is timed
+    if (!package->publish_ns || !cfg->samp_rate) {
+        return;
+    }
+    struct timeval now;
+    get_time_now(&now);
+    int64_t now_ns   = (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_usec * 1000;
+    int64_t delay_us = (now_ns - package->publish_ns) / 1000 + (int64_t)end_ago * 1000000 / cfg->samp_rate;
+    unsigned delay_ms = delay_us > 0 ? (unsigned)(delay_us / 1000) : 0;
+
+    unsigned bin = 0;
+    while (bin < LATENCY_HIST_BINS - 1 && delay_ms >= (unsigned)latency_bounds_ms[bin]) {
+        bin++;
+    }
+    cfg->frames_latency[bin] += 1;
+    if (delay_ms > cfg->frames_latency_max_ms) {
+        cfg->frames_latency_max_ms = delay_ms;
+    }
+}
+
+void record_stage_latency(r_cfg_t *cfg)
+{
+    package_meta_t live;
+    package_meta_t const *package = current_package(cfg, &live);
+    if (!cfg->report_latency || !package->detect_ns) {
+        return;
     }
+    // file input has no buffer and queue delays
+    if (package->publish_ns) {
+        latency_hist_add(&cfg->frames_stage_latency[LATENCY_BUFFER], (package->publish_ns - package->package_end_ns) / 1000);
+        latency_hist_add(&cfg->frames_stage_latency[LATENCY_QUEUE], (package->demod_start_ns - package->publish_ns) / 1000);
+    }
+    latency_hist_add(&cfg->frames_stage_latency[LATENCY_DSP], (package->detect_ns - package->demod_start_ns) / 1000);
+    latency_hist_add(&cfg->frames_stage_latency[LATENCY_DECODE], (get_time_now_ns() - package->detect_ns) / 1000);
 }
 
 // well-known fields "time", "msg" and "codes" are used to output general decoder messages
@@ -400,6 +1759,8 @@ char *time_pos_str(r_cfg_t *cfg, unsigned samples_ago, char *buf)
 // well-known field "protocol" is only used when model protocol is requested
 // well-known field "description" is only used when model description is requested
 // well-known fields "mod", "freq", "freq1", "freq2", "rssi", "snr", "noise" are used by meta report option
+// well-known field "input" is used with multiple input devices
+// well-known fields "lat_buffer", "lat_queue", "lat_dsp", "lat_decode" are used by the latency report option
 char const **well_known_output_fields(r_cfg_t *cfg)
 {
     list_t field_list = {0};
@@ -435,14 +1796,22 @@ char const **well_known_output_fields(r_cfg_t *cfg)
         list_push(&field_list, "snr");
         list_push(&field_list, "noise");
     }
+    if (cfg->tag_input)
+        list_push(&field_list, "input");
+    if (cfg->report_latency) {
+        list_push(&field_list, "lat_buffer");
+        list_push(&field_list, "lat_queue");
+        list_push(&field_list, "lat_dsp");
+        list_push(&field_list, "lat_decode");
+    }
 
     return (char const **)field_list.elems;
 }
 
 /** Convert CSV keys according to selected conversion mode. Replacement is static but in-place. */
-static char const **convert_csv_fields(r_cfg_t *cfg, char const **fields)
+static char const **convert_csv_fields(conversion_mode_t conversion_mode, char const **fields)
 {
-    if (cfg->conversion_mode == CONVERT_SI) {
+    if (conversion_mode == CONVERT_SI) {
         for (char const **p = fields; *p; ++p) {
             if (!strcmp(*p, "temperature_F")) *p = "temperature_C";
             else if (!strcmp(*p, "pressure_PSI")) *p = "pressure_kPa";
@@ -453,7 +1822,7 @@ static char const **convert_csv_fields(r_cfg_t *cfg, char const **fields)
         }
     }
 
-    if (cfg->conversion_mode == CONVERT_CUSTOMARY) {
+    if (conversion_mode == CONVERT_CUSTOMARY) {
         for (char const **p = fields; *p; ++p) {
             if (!strcmp(*p, "temperature_C")) *p = "temperature_F";
             else if (!strcmp(*p, "temperature_1_C")) *p = "temperature_1_F";
@@ -470,8 +1839,8 @@ static char const **convert_csv_fields(r_cfg_t *cfg, char const **fields)
     return fields;
 }
 
-// find the fields output for CSV
-char const **determine_csv_fields(r_cfg_t *cfg, char const *const *well_known, int *num_fields)
+// find the fields output for CSV by the decoders of a tenant pipeline
+static char const **tenant_csv_fields(r_cfg_t *cfg, unsigned tenant, char const *const *well_known, int *num_fields)
 {
     list_t field_list = {0};
     list_ensure_size(&field_list, 100);
@@ -482,129 +1851,234 @@ char const **determine_csv_fields(r_cfg_t *cfg, char const *const *well_known, i
     list_t *r_devs = &cfg->demod->r_devs;
     for (void **iter = r_devs->elems; iter && *iter; ++iter) {
         r_device *r_dev = *iter;
+        if (r_dev->tenant != tenant)
+            continue;
         if (r_dev->fields)
             list_push_all(&field_list, (void **)r_dev->fields);
         else
             fprintf(stderr, "rtl_433: warning: %u \"%s\" does not support CSV output\n",
                     r_dev->protocol_num, r_dev->name);
     }
-    convert_csv_fields(cfg, (char const **)field_list.elems);
+    tenant_t const *t = tenant && tenant <= cfg->tenants.len ? cfg->tenants.elems[tenant - 1] : NULL;
+    convert_csv_fields(t ? t->conversion_mode : cfg->conversion_mode, (char const **)field_list.elems);
 
     if (num_fields)
         *num_fields = field_list.len;
     return (char const **)field_list.elems;
 }
 
-int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
+// find the fields output for CSV
+char const **determine_csv_fields(r_cfg_t *cfg, char const *const *well_known, int *num_fields)
 {
-    int p_events = 0;
+    return tenant_csv_fields(cfg, 0, well_known, num_fields);
+}
 
-    unsigned next_priority = 0; // next smallest on each loop through decoders
-    // run all decoders of each priority, stop if an event is produced
-    for (unsigned priority = 0; !p_events && priority < UINT_MAX; priority = next_priority) {
-        next_priority = UINT_MAX;
-        for (void **iter = r_devs->elems; iter && *iter; ++iter) {
-            r_device *r_dev = *iter;
+// slices the pulses for one OOK decoder
+static int run_ook_demod(r_device *r_dev, pulse_data_t *pulse_data, bitbuffer_t *bits, slicer_cache_t *cache)
+{
+    if (cache && r_dev->slice_group) {
+        return pulse_slicer_cached(pulse_data, r_dev, bits, cache);
+    }
+
+    switch (r_dev->modulation) {
+    case OOK_PULSE_PCM:
+    // case OOK_PULSE_RZ:
+        return pulse_slicer_pcm(pulse_data, r_dev, bits);
+    case OOK_PULSE_PPM:
+        return pulse_slicer_ppm(pulse_data, r_dev, bits);
+    case OOK_PULSE_PWM:
+        return pulse_slicer_pwm(pulse_data, r_dev, bits);
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+        return pulse_slicer_manchester_zerobit(pulse_data, r_dev, bits);
+    case OOK_PULSE_PIWM_RAW:
+        return pulse_slicer_piwm_raw(pulse_data, r_dev, bits);
+    case OOK_PULSE_PIWM_DC:
+        return pulse_slicer_piwm_dc(pulse_data, r_dev, bits);
+    case OOK_PULSE_DMC:
+        return pulse_slicer_dmc(pulse_data, r_dev, bits);
+    case OOK_PULSE_PWM_OSV1:
+        return pulse_slicer_osv1(pulse_data, r_dev, bits);
+    case OOK_PULSE_NRZS:
+        return pulse_slicer_nrzs(pulse_data, r_dev, bits);
+    // FSK decoders
+    case FSK_PULSE_PCM:
+    case FSK_PULSE_PWM:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return 0;
+    default:
+        fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+        return 0;
+    }
+}
 
-            // Find next smallest priority
-            if (r_dev->priority > priority && r_dev->priority < next_priority)
-                next_priority = r_dev->priority;
-            // Run only current priority
-            if (r_dev->priority != priority)
-                continue;
+// slices the pulses for one FSK decoder
+static int run_fsk_demod(r_device *r_dev, pulse_data_t *fsk_pulse_data, bitbuffer_t *bits, slicer_cache_t *cache)
+{
+    if (cache && r_dev->slice_group) {
+        return pulse_slicer_cached(fsk_pulse_data, r_dev, bits, cache);
+    }
+
+    switch (r_dev->modulation) {
+    // OOK decoders
+    case OOK_PULSE_PCM:
+    // case OOK_PULSE_RZ:
+    case OOK_PULSE_PPM:
+    case OOK_PULSE_PWM:
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case OOK_PULSE_PIWM_RAW:
+    case OOK_PULSE_PIWM_DC:
+    case OOK_PULSE_DMC:
+    case OOK_PULSE_PWM_OSV1:
+    case OOK_PULSE_NRZS:
+        return 0;
+    case FSK_PULSE_PCM:
+        return pulse_slicer_pcm(fsk_pulse_data, r_dev, bits);
+    case FSK_PULSE_PWM:
+        return pulse_slicer_pwm(fsk_pulse_data, r_dev, bits);
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return pulse_slicer_manchester_zerobit(fsk_pulse_data, r_dev, bits);
+    default:
+        fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+        return 0;
+    }
+}
 
-            switch (r_dev->modulation) {
-            case OOK_PULSE_PCM:
-            // case OOK_PULSE_RZ:
-                p_events += pulse_slicer_pcm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PPM:
-                p_events += pulse_slicer_ppm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PWM:
-                p_events += pulse_slicer_pwm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_MANCHESTER_ZEROBIT:
-                p_events += pulse_slicer_manchester_zerobit(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PIWM_RAW:
-                p_events += pulse_slicer_piwm_raw(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PIWM_DC:
-                p_events += pulse_slicer_piwm_dc(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_DMC:
-                p_events += pulse_slicer_dmc(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PWM_OSV1:
-                p_events += pulse_slicer_osv1(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_NRZS:
-                p_events += pulse_slicer_nrzs(pulse_data, r_dev);
-                break;
-            // FSK decoders
-            case FSK_PULSE_PCM:
-            case FSK_PULSE_PWM:
-            case FSK_PULSE_MANCHESTER_ZEROBIT:
-                break;
-            default:
-                fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
-            }
+typedef int (*run_demod_fn)(r_device *r_dev, pulse_data_t *pulse_data, bitbuffer_t *bits, slicer_cache_t *cache);
+
+/// Hit rate of a decoder with events in about the last 40 packages, it is not skipped past the decode budget.
+#define DECODE_BUDGET_HOT_RATE 256
+/// A decoder is reported once it took longer than the whole decode budget this many times.
+#define DECODE_BUDGET_OVERRUNS_REPORT 3
+
+typedef struct demod_package {
+    pulse_data_t *pulse_data;
+    slicer_cache_t *cache;
+    pulse_signature_t sig;
+    run_demod_fn run_fn;
+    uint64_t budget_ns; ///< time for the decoders of the package, 0 for no limit
+    uint64_t deadline_ns; ///< end of the budget in monotonic ns
+    unsigned skipped; ///< decoder runs skipped past the budget, added to by the workers of a pool
+} demod_package_t;
+
+static int run_demod(r_device *r_dev, bitbuffer_t *bits, void *ctx)
+{
+    demod_package_t *package = ctx;
+
+    // decay the hit rate by 1/16 for each package, a decoder with events on every package settles at 65536
+    r_dev->hit_rate -= r_dev->hit_rate >> 4;
+
+    // skip the decoders that would only see empty rows
+    if (!pulse_slicer_may_match(&package->sig, r_dev))
+        return 0;
+
+    int events;
+    if (package->budget_ns) {
+        // past the budget only the decoders with recent events run, the others are likely just slow on noise
+        uint64_t start = time_monotonic_ns();
+        if (start > package->deadline_ns && r_dev->hit_rate < DECODE_BUDGET_HOT_RATE) {
+            atomic_fetch_add_unsigned(&package->skipped, 1);
+            return 0;
+        }
+        uint64_t decode_ns = r_dev->decode_ns;
+        events = package->run_fn(r_dev, package->pulse_data, bits, package->cache);
+        uint64_t elapsed = time_monotonic_ns() - start;
+        if (r_dev->report_cost) {
+            r_dev->slice_ns += elapsed - (r_dev->decode_ns - decode_ns);
+            r_dev->slice_calls += 1;
+        }
+        if (elapsed > package->budget_ns && ++r_dev->budget_overruns == DECODE_BUDGET_OVERRUNS_REPORT) {
+            print_logf(LOG_WARNING, "Decode", "Decoder %u \"%s\" took longer than the decode budget %u times, last %u us.",
+                    r_dev->protocol_num, r_dev->name, r_dev->budget_overruns, (unsigned)(elapsed / 1000));
         }
     }
-
-    return p_events;
+    else if (!r_dev->report_cost) {
+        events = package->run_fn(r_dev, package->pulse_data, bits, package->cache);
+    }
+    else {
+        // the slicer calls decode_fn, keep only the slicer time
+        uint64_t decode_ns = r_dev->decode_ns;
+        uint64_t start     = time_monotonic_ns();
+        events = package->run_fn(r_dev, package->pulse_data, bits, package->cache);
+        r_dev->slice_ns += time_monotonic_ns() - start - (r_dev->decode_ns - decode_ns);
+        r_dev->slice_calls += 1;
+    }
+    R_TRACE4(slice, r_dev->protocol_num, r_dev->modulation, package->pulse_data->num_pulses, events);
+    if (events > 0)
+        r_dev->hit_rate += 4096;
+    return events;
 }
 
-int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
+static int run_demods(list_t *r_devs, pulse_data_t *pulse_data, slicer_cache_t *cache, decoder_pool_t *pool, run_demod_fn run_fn,
+        trace_event_t *trace, unsigned tid, uint64_t budget_ns, unsigned max_priority, unsigned *skipped)
 {
+    demod_package_t package = {.pulse_data = pulse_data, .cache = cache, .run_fn = run_fn, .budget_ns = budget_ns};
+    if (budget_ns)
+        package.deadline_ns = time_monotonic_ns() + budget_ns;
+    if (cache)
+        slicer_cache_reset(cache);
+    pulse_data_index(pulse_data);
+    pulse_signature_make(&package.sig, pulse_data);
+
+    // the decoders on this thread share the scratch bits, it is cleared by the rows used
+    bitbuffer_t bits = {0};
     int p_events = 0;
+    // run all decoders of each priority, stop at the next priority if an event is produced
+    void **iter = r_devs->elems;
+    while (iter && *iter && !p_events && ((r_device *)*iter)->priority <= max_priority) {
+        unsigned priority = ((r_device *)*iter)->priority;
+        uint64_t start_ns = trace ? time_monotonic_ns() : 0;
+        unsigned count = 0;
+        unsigned groups = 0;
+        for (; iter[count] && ((r_device *)iter[count])->priority == priority; ++count) {
+            groups = MAX(groups, ((r_device *)iter[count])->slice_group + 1);
+        }
 
-    unsigned next_priority = 0; // next smallest on each loop through decoders
-    // run all decoders of each priority, stop if an event is produced
-    for (unsigned priority = 0; !p_events && priority < UINT_MAX; priority = next_priority) {
-        next_priority = UINT_MAX;
-        for (void **iter = r_devs->elems; iter && *iter; ++iter) {
-            r_device *r_dev = *iter;
-
-            // Find next smallest priority
-            if (r_dev->priority > priority && r_dev->priority < next_priority)
-                next_priority = r_dev->priority;
-            // Run only current priority
-            if (r_dev->priority != priority)
-                continue;
-
-            switch (r_dev->modulation) {
-            // OOK decoders
-            case OOK_PULSE_PCM:
-            // case OOK_PULSE_RZ:
-            case OOK_PULSE_PPM:
-            case OOK_PULSE_PWM:
-            case OOK_PULSE_MANCHESTER_ZEROBIT:
-            case OOK_PULSE_PIWM_RAW:
-            case OOK_PULSE_PIWM_DC:
-            case OOK_PULSE_DMC:
-            case OOK_PULSE_PWM_OSV1:
-            case OOK_PULSE_NRZS:
-                break;
-            case FSK_PULSE_PCM:
-                p_events += pulse_slicer_pcm(fsk_pulse_data, r_dev);
-                break;
-            case FSK_PULSE_PWM:
-                p_events += pulse_slicer_pwm(fsk_pulse_data, r_dev);
-                break;
-            case FSK_PULSE_MANCHESTER_ZEROBIT:
-                p_events += pulse_slicer_manchester_zerobit(fsk_pulse_data, r_dev);
-                break;
-            default:
-                fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+        if (pool && count > 1) {
+            // the cache entries can not grow while the decoders run
+            if (cache)
+                slicer_cache_reserve(cache, groups);
+            p_events += decoder_pool_run(pool, iter, count, run_demod, &package);
+        }
+        else {
+            for (unsigned i = 0; i < count; ++i) {
+                p_events += run_demod(iter[i], &bits, &package);
             }
         }
+        if (trace) {
+            char name[32];
+            snprintf(name, sizeof(name), "decode %s priority %u", run_fn == run_fsk_demod ? "FSK" : "OOK", priority);
+            trace_event_span(trace, name, "decode", tid, start_ns, time_monotonic_ns());
+        }
+        iter += count;
     }
+    if (skipped)
+        *skipped += package.skipped;
 
     return p_events;
 }
 
+int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data, slicer_cache_t *cache, decoder_pool_t *pool)
+{
+    return run_demods(r_devs, pulse_data, cache, pool, run_ook_demod, NULL, 0, 0, UINT_MAX, NULL);
+}
+
+int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data, slicer_cache_t *cache, decoder_pool_t *pool)
+{
+    return run_demods(r_devs, fsk_pulse_data, cache, pool, run_fsk_demod, NULL, 0, 0, UINT_MAX, NULL);
+}
+
+int run_ook_demods_traced(list_t *r_devs, pulse_data_t *pulse_data, slicer_cache_t *cache, decoder_pool_t *pool, trace_event_t *trace, unsigned tid,
+        uint64_t budget_ns, unsigned max_priority, unsigned *skipped)
+{
+    return run_demods(r_devs, pulse_data, cache, pool, run_ook_demod, trace_event_active(trace) ? trace : NULL, tid, budget_ns, max_priority, skipped);
+}
+
+int run_fsk_demods_traced(list_t *r_devs, pulse_data_t *fsk_pulse_data, slicer_cache_t *cache, decoder_pool_t *pool, trace_event_t *trace, unsigned tid,
+        uint64_t budget_ns, unsigned max_priority, unsigned *skipped)
+{
+    return run_demods(r_devs, fsk_pulse_data, cache, pool, run_fsk_demod, trace_event_active(trace) ? trace : NULL, tid, budget_ns, max_priority, skipped);
+}
+
 /* handlers */
 
 static void log_handler(log_level_t level, char const *src, char const *msg, void *userdata)
@@ -614,6 +2088,23 @@ static void log_handler(log_level_t level, char const *src, char const *msg, voi
     if (cfg->verbosity < (int)level) {
         return;
     }
+    // messages of other threads are queued for the event loop, errors are delivered at once
+    if (level > LOG_ERROR && log_ring_defer()) {
+        log_ring_push(level, src, msg);
+        return;
+    }
+    // outputs are not thread-safe, messages of an output thread only go to stderr
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        if (data_output_async_is_current(cfg->output_handler.elems[i])) {
+            fprintf(stderr, "%s: %s\n", src, msg);
+            return;
+        }
+    }
+    // the device is opened on a thread during the startup, the outputs are in use
+    if (sdr_open_is_current(cfg->sdr_opener)) {
+        fprintf(stderr, "%s: %s\n", src, msg);
+        return;
+    }
     /* clang-format off */
     data_t *data = data_make(
             "src",     "",     DATA_STRING, src,
@@ -630,13 +2121,7 @@ static void log_handler(log_level_t level, char const *src, char const *msg, voi
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        if (output && output->log_level >= (int)level) {
-            data_output_print(output, data);
-        }
-    }
-    data_free(data);
+    output_data(cfg, data, (int)level);
 }
 
 void r_redirect_logging(r_cfg_t *cfg)
@@ -644,6 +2129,187 @@ void r_redirect_logging(r_cfg_t *cfg)
     r_logger_set_log_handler(log_handler, cfg);
 }
 
+void r_drain_logging(r_cfg_t *cfg)
+{
+    log_ring_drain(log_handler, cfg);
+}
+
+// returns the demod thread of the config or of one of its receivers if that is the caller
+static struct demod_thread *current_demod_thread(r_cfg_t *cfg)
+{
+    // channels run on the demod thread of the config feeding them
+    while (!cfg->demod_thread && cfg->primary && cfg->primary->channels.len) {
+        cfg = cfg->primary;
+    }
+    if (demod_thread_is_current(cfg->demod_thread)) {
+        return cfg->demod_thread;
+    }
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        if (demod_thread_is_current(rcv->demod_thread)) {
+            return rcv->demod_thread;
+        }
+    }
+    return NULL;
+}
+
+typedef struct pending_output {
+    data_t *data;
+    int level;
+} pending_output_t;
+
+// returns the channel or input file config the caller demodulates on a worker pool, NULL if none
+static r_cfg_t *current_pool_channel(r_cfg_t *cfg)
+{
+    while (cfg->primary) {
+        cfg = cfg->primary;
+    }
+    for (size_t i = 0; i <= cfg->receivers.len; ++i) {
+        r_cfg_t *rcv = i == 0 ? cfg : cfg->receivers.elems[i - 1];
+        int k = worker_pool_current_task(rcv->worker_pool);
+        if (k >= 0 && (size_t)k < rcv->channels.len) {
+            return rcv->channels.elems[k];
+        }
+        if (k >= 0 && (size_t)k < rcv->in_file_cfgs.len) {
+            return rcv->in_file_cfgs.elems[k];
+        }
+    }
+    return NULL;
+}
+
+// the merge of the events of a config, NULL if not merged, the parts of parallel input files are already output in order
+static event_merge_t *input_merge(r_cfg_t *cfg)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (!root->merge || !cfg->samp_rate) {
+        return NULL;
+    }
+    for (r_cfg_t *up = cfg; up->primary; up = up->primary) {
+        for (size_t i = 0; i < root->in_file_cfgs.len; ++i) {
+            if (root->in_file_cfgs.elems[i] == up) {
+                return NULL;
+            }
+        }
+    }
+    return root->merge;
+}
+
+void r_merge_progress(r_cfg_t *cfg)
+{
+    if (!input_merge(cfg)) {
+        return;
+    }
+    // the events of the packages still queued for the decoders are output later
+    uint64_t pos             = cfg->input_pos;
+    package_t const *package = package_queue_oldest(cfg->package_queue);
+    if (package && package->pulses.offset < pos) {
+        pos = package->pulses.offset;
+    }
+    output_data(cfg, event_merge_mark(NULL, cfg, (int64_t)(pos * 1000000 / cfg->samp_rate)), 0);
+}
+
+void r_flush_channel_output(r_cfg_t *ch)
+{
+    for (size_t i = 0; i < ch->pending_output.len; ++i) {
+        pending_output_t *out = ch->pending_output.elems[i];
+        output_data(ch, out->data, out->level);
+        free(out);
+    }
+    list_clear(&ch->pending_output, NULL);
+}
+
+// keeps the output of a decoder run on the decoder pool of the receiver, returns 1 if the data was taken
+static int keep_decoder_output(r_cfg_t *cfg, data_t *data, int level)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    for (size_t i = 0; i <= root->receivers.len; ++i) {
+        r_cfg_t *rcv = i == 0 ? root : root->receivers.elems[i - 1];
+        if (decoder_pool_keep_output(rcv->decoder_pool, cfg, data, level)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void output_data(r_cfg_t *cfg, data_t *data, int level)
+{
+    // decoders on the decoder pool keep their output, it is replayed in the order of the decoders
+    if (keep_decoder_output(cfg, data, level)) {
+        return;
+    }
+
+    // the decode thread of the pipeline keeps the output, it is replayed in package order
+    if (package_queue_keep_output(cfg->package_queue, data, level)) {
+        return;
+    }
+
+    // channels on the worker pool keep their output, it is replayed in channel order
+    r_cfg_t *ch = current_pool_channel(cfg);
+    if (ch) {
+        pending_output_t *out = malloc(sizeof(*out));
+        if (!out) {
+            WARN_MALLOC("output_data()");
+            data_free(data);
+            return;
+        }
+        out->data  = data;
+        out->level = level;
+        list_push(&ch->pending_output, out);
+        return;
+    }
+
+    // outputs are not thread-safe, hand over to the event loop
+    struct demod_thread *demod_thread = current_demod_thread(cfg);
+    if (demod_thread) {
+        demod_thread_post(demod_thread, data, level);
+        return;
+    }
+
+    // the outputs are traced on the trace of the primary
+    r_cfg_t *primary = cfg;
+    while (primary->primary) {
+        primary = primary->primary;
+    }
+
+    // the events of an input wait for the earlier events of the other inputs
+    if (level == 0 && primary->merge && event_merge_hold(primary->merge, data)) {
+        return;
+    }
+
+    // the events of the decoders wait for the announcements of the other receivers
+    if (level == 0 && primary->fusion && event_fusion_hold(primary->fusion, data)) {
+        return;
+    }
+
+    trace_event_t *trace = trace_event_active(primary->trace) ? primary->trace : NULL;
+
+    // the JSON text is made once for all outputs of the event
+    data_json_t json = {.data = data};
+    unsigned tenant = level < 0 ? (unsigned)-level : 0;
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (output && (level <= 0 ? output->tenant == tenant : output->log_level >= level)) {
+            uint64_t start_ns = trace ? time_monotonic_ns() : 0;
+            R_TRACE2(output_entry, i, level);
+            data_output_print_shared(output, data, &json);
+            R_TRACE1(output_exit, i);
+            if (trace) {
+                char name[32];
+                snprintf(name, sizeof(name), "output %zu", i);
+                trace_event_span(trace, name, "output", 0, start_ns, time_monotonic_ns());
+            }
+        }
+    }
+    free(json.text);
+    data_free(data);
+}
+
 /** Pass the data structure to all output handlers. Frees data afterwards. */
 void event_occurred_handler(r_cfg_t *cfg, data_t *data)
 {
@@ -655,11 +2321,11 @@ void event_occurred_handler(r_cfg_t *cfg, data_t *data)
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_print(output, data);
+    if (cfg->tag_input) {
+        data = data_str(data, "input", "Input", NULL, cfg->dev_query ? cfg->dev_query : "");
     }
-    data_free(data);
+
+    output_data(cfg, data, 0);
 }
 
 /** Pass the data structure to all output handlers. Frees data afterwards. */
@@ -670,18 +2336,156 @@ void log_device_handler(r_device *r_dev, int level, data_t *data)
     // prepend "time" if requested
     if (cfg->report_time != REPORT_TIME_OFF) {
         char time_str[LOCAL_TIME_BUFLEN];
-        time_pos_str(cfg, cfg->demod->pulse_data.start_ago, time_str);
+        package_meta_t live;
+        time_pos_str(cfg, current_package(cfg, &live)->pulse_data->start_ago, time_str);
         data = data_prepend(data,
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        if (output && output->log_level >= level) {
-            data_output_print(output, data);
+    output_data(cfg, data, level);
+}
+
+/// Number of recent messages of a decoder to drop the repeats of, enough for a few sensors sending at once.
+#define DEDUP_SLOTS 8
+
+typedef struct decoder_dedup {
+    uint64_t hash[DEDUP_SLOTS];
+    uint64_t time_ms[DEDUP_SLOTS];
+    unsigned next;
+} decoder_dedup_t;
+
+static uint64_t dedup_hash_bytes(uint64_t hash, void const *buf, size_t len)
+{
+    uint8_t const *p = buf;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ p[i]) * 0x100000001b3ULL; // FNV-1a
+    }
+    return hash;
+}
+
+static uint64_t dedup_hash_data(uint64_t hash, data_t const *data);
+
+static uint64_t dedup_hash_value(uint64_t hash, data_type_t type, void const *value)
+{
+    hash = dedup_hash_bytes(hash, &type, sizeof(type));
+    switch (type) {
+    case DATA_INT:
+        return dedup_hash_bytes(hash, value, sizeof(int));
+    case DATA_DOUBLE:
+        return dedup_hash_bytes(hash, value, sizeof(double));
+    case DATA_STRING: {
+        char const *str = *(char const *const *)value;
+        return dedup_hash_bytes(hash, str, strlen(str) + 1);
+    }
+    case DATA_DATA:
+        return dedup_hash_data(hash, *(data_t const *const *)value);
+    case DATA_ARRAY: {
+        data_array_t const *array = *(data_array_t const *const *)value;
+        size_t size = array->type == DATA_INT ? sizeof(int) : array->type == DATA_DOUBLE ? sizeof(double) : sizeof(void *);
+        for (int i = 0; i < array->num_values; ++i) {
+            hash = dedup_hash_value(hash, array->type, (uint8_t const *)array->values + i * size);
         }
+        return hash;
     }
-    data_free(data);
+    default:
+        return hash;
+    }
+}
+
+// hash of the keys and values, the formats and pretty keys only change the output
+static uint64_t dedup_hash_data(uint64_t hash, data_t const *data)
+{
+    for (; data; data = data->next) {
+        hash = dedup_hash_bytes(hash, data->key, strlen(data->key) + 1);
+        hash = dedup_hash_value(hash, data->type, &data->value);
+    }
+    return hash;
+}
+
+/// Check if the decoder output the same message within dedup_ms before this package, remembers the message if not.
+/// The time is the sample position of the package, repeats are found the same on file inputs and live.
+static int is_duplicate_output(r_cfg_t *cfg, r_device *r_dev, data_t const *data)
+{
+    if (!r_dev->dedup) {
+        r_dev->dedup = calloc(1, sizeof(*r_dev->dedup));
+        if (!r_dev->dedup) {
+            WARN_CALLOC("is_duplicate_output()");
+            return 0;
+        }
+    }
+    decoder_dedup_t *dedup = r_dev->dedup;
+
+    pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+    uint64_t time_ms = cfg->samp_rate ? pulses->offset * 1000 / cfg->samp_rate : 0;
+    uint64_t hash    = dedup_hash_data(0xcbf29ce484222325ULL, data);
+
+    for (unsigned i = 0; i < DEDUP_SLOTS; ++i) {
+        if (dedup->hash[i] == hash && dedup->time_ms[i] + (unsigned)cfg->dedup_ms >= time_ms) {
+            return 1;
+        }
+    }
+    dedup->hash[dedup->next]    = hash;
+    dedup->time_ms[dedup->next] = time_ms;
+    dedup->next                 = (dedup->next + 1) % DEDUP_SLOTS;
+    return 0;
+}
+
+// the transmitter of an event is its model and id, and the channel if any, returns 0 without a model
+static int transmitter_key(data_t const *data, char *key, size_t size)
+{
+    char const *model = NULL;
+    char id[32]       = "";
+    char channel[32]  = "";
+    for (data_t const *d = data; d; d = d->next) {
+        char *buf = !strcmp(d->key, "id") ? id : !strcmp(d->key, "channel") ? channel : NULL;
+        if (!strcmp(d->key, "model") && d->type == DATA_STRING)
+            model = d->value.v_ptr;
+        else if (buf && d->type == DATA_INT)
+            snprintf(buf, sizeof(id), "%d", d->value.v_int);
+        else if (buf && d->type == DATA_STRING)
+            snprintf(buf, sizeof(id), "%s", (char const *)d->value.v_ptr);
+    }
+    if (!model)
+        return 0;
+
+    snprintf(key, size, "%s|%s|%s", model, id, channel);
+    return 1;
+}
+
+// the time is the package position
+static void track_duty_cycle(duty_cycle_t *dc, r_cfg_t *cfg, r_device *r_dev, data_t const *data)
+{
+    char key[256];
+    if (!transmitter_key(data, key, sizeof(key)))
+        return;
+
+    pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+    duty_cycle_event(dc, key, pulses->offset * 1000 / cfg->samp_rate);
+}
+
+// an event without a model is always output
+static int pass_throttle(event_throttle_t *throttle, r_cfg_t *cfg, r_device *r_dev, data_t *data)
+{
+    char key[256];
+    if (!transmitter_key(data, key, sizeof(key)))
+        return 1;
+
+    pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+    return event_throttle_pass(throttle, key, data, pulses->offset * 1000 / cfg->samp_rate);
+}
+
+// the last-known state of a sensor is its event as output, with the level of the package
+static void keep_sensor_state(sensor_state_t *state, r_cfg_t *cfg, r_device *r_dev, data_t *data)
+{
+    char key[256];
+    if (!transmitter_key(data, key, sizeof(key)))
+        return;
+
+    pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+    package_meta_t live;
+    char time_str[LOCAL_TIME_BUFLEN];
+    time_pos_str(cfg, current_package(cfg, &live)->pulse_data->start_ago, time_str);
+    sensor_state_update(state, key, data, time_str, pulses->rssi_db, pulses->snr_db);
 }
 
 /** Pass the data structure to all output handlers. Frees data afterwards. */
@@ -703,139 +2507,60 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
             fprintf(stderr, "WARNING: Undeclared field \"%s\" in [%u] \"%s\"\n", d->key, r_dev->protocol_num, r_dev->name);
         }
     }
-#endif
+#endif
+
+    // an event of an unfinished package marks it, the events of the whole package were already output
+    if (cfg->early_decode) {
+        uint64_t early_offset = event_pulses(cfg, r_dev)->offset + 1;
+        if (cfg->demod->early_decoding) {
+            r_dev->early_offset = early_offset;
+        }
+        else if (r_dev->early_offset == early_offset) {
+            r_dev->decode_duplicates++;
+            data_free(data);
+            return;
+        }
+    }
+
+    // drop the repeats of a message before any conversion or output, the decoders run on their own task
+    if (cfg->dedup_ms > 0 && is_duplicate_output(cfg, r_dev, data)) {
+        r_dev->decode_duplicates++;
+        data_free(data);
+        return;
+    }
+
+    r_cfg_t *primary = cfg;
+    while (primary->primary) {
+        primary = primary->primary;
+    }
 
-    if (cfg->conversion_mode == CONVERT_SI) {
-        for (data_t *d = data; d; d = d->next) {
-            // Convert double type fields ending in _F to _C
-            if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_F")) {
-                d->value.v_dbl = fahrenheit2celsius(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_F", "_C");
-                free(d->key);
-                d->key = new_label;
-                char *pos;
-                if (d->format && (pos = strrchr(d->format, 'F'))) {
-                    *pos = 'C';
-                }
-            }
-            // Convert double type fields ending in _mi_h to _km_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mi_h")) {
-                d->value.v_dbl = mph2kmph(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mi_h", "_km_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mi/h", "km/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _in to _mm
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_in")) {
-                d->value.v_dbl = inch2mm(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_in", "_mm");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "in", "mm");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _in_h to _mm_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_in_h")) {
-                d->value.v_dbl = inch2mm(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_in_h", "_mm_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "in/h", "mm/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _inHg to _hPa
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_inHg")) {
-                d->value.v_dbl = inhg2hpa(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_inHg", "_hPa");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "inHg", "hPa");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _PSI to _kPa
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_PSI")) {
-                d->value.v_dbl = psi2kpa(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_PSI", "_kPa");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "PSI", "kPa");
-                free(d->format);
-                d->format = new_format_label;
-            }
-        }
+    // the throttle, the fusion, and the sensor state are of the default pipeline
+    int tenant = r_dev->tenant != 0;
+
+    // a sensor is output at most once per interval, drop the events in between before any conversion or output
+    if (!tenant && primary->throttle && cfg->samp_rate && !pass_throttle(primary->throttle, cfg, r_dev, data)) {
+        data_free(data);
+        return;
     }
-    if (cfg->conversion_mode == CONVERT_CUSTOMARY) {
-        for (data_t *d = data; d; d = d->next) {
-            // Convert double type fields ending in _C to _F
-            if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_C")) {
-                d->value.v_dbl = celsius2fahrenheit(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_C", "_F");
-                free(d->key);
-                d->key = new_label;
-                char *pos;
-                if (d->format && (pos = strrchr(d->format, 'C'))) {
-                    *pos = 'F';
-                }
-            }
-            // Convert double type fields ending in _km_h to _mi_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_km_h")) {
-                d->value.v_dbl = kmph2mph(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_km_h", "_mi_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "km/h", "mi/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _mm to _in
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mm")) {
-                d->value.v_dbl = mm2inch(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mm", "_in");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mm", "in");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _mm_h to _in_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mm_h")) {
-                d->value.v_dbl = mm2inch(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mm_h", "_in_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mm/h", "in/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _hPa to _inHg
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_hPa")) {
-                d->value.v_dbl = hpa2inhg(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_hPa", "_inHg");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "hPa", "inHg");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _kPa to _PSI
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_kPa")) {
-                d->value.v_dbl = kpa2psi(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_kPa", "_PSI");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "kPa", "PSI");
-                free(d->format);
-                d->format = new_format_label;
-            }
-        }
+
+    // the fingerprint of the message for the fusion, the other receivers may add different items
+    uint64_t fusion_hash = 0;
+    float fusion_rssi    = 0.0f;
+    if (!tenant && primary->fusion) {
+        pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+        fusion_hash = dedup_hash_bytes(0xcbf29ce484222325ULL, &r_dev->protocol_num, sizeof(r_dev->protocol_num));
+        fusion_hash = dedup_hash_data(fusion_hash, data);
+        fusion_rssi = pulses->rssi_db;
     }
 
+    // the duty cycle of the input learns when the transmitter is due next
+    r_cfg_t *input = cfg->duty_cycle || !cfg->primary ? cfg : cfg->primary;
+    if (input->duty_cycle && cfg->samp_rate) {
+        track_duty_cycle(input->duty_cycle, cfg, r_dev, data);
+    }
+
+    convert_units(r_dev, tenant ? (conversion_mode_t)r_dev->conversion_mode : cfg->conversion_mode, data);
+
     // prepend "description" if requested
     if (cfg->report_description) {
         data = data_prepend(data,
@@ -848,26 +2573,46 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
                 data_int(NULL, "protocol", "Protocol", NULL, r_dev->protocol_num));
     }
 
-    if (cfg->report_meta && cfg->demod->fsk_pulse_data.fsk_f2_est) {
+    // a pipelined package has its own copy of the state when it was detected
+    package_meta_t live;
+    package_meta_t const *package = current_package(cfg, &live);
+    pulse_data_t const *ook_pulses = package->pulse_data;
+    pulse_data_t const *fsk_pulses = package->fsk_pulse_data;
+
+    if (cfg->report_meta && fsk_pulses->fsk_f2_est) {
         data = data_str(data, "mod",   "Modulation",  NULL,         "FSK");
-        data = data_dbl(data, "freq1", "Freq1",       "%.1f MHz",   cfg->demod->fsk_pulse_data.freq1_hz / 1000000.0);
-        data = data_dbl(data, "freq2", "Freq2",       "%.1f MHz",   cfg->demod->fsk_pulse_data.freq2_hz / 1000000.0);
-        data = data_dbl(data, "rssi",  "RSSI",        "%.1f dB",    cfg->demod->fsk_pulse_data.rssi_db);
-        data = data_dbl(data, "snr",   "SNR",         "%.1f dB",    cfg->demod->fsk_pulse_data.snr_db);
-        data = data_dbl(data, "noise", "Noise",       "%.1f dB",    cfg->demod->fsk_pulse_data.noise_db);
+        data = data_dbl(data, "freq1", "Freq1",       "%.1f MHz",   fsk_pulses->freq1_hz / 1000000.0);
+        data = data_dbl(data, "freq2", "Freq2",       "%.1f MHz",   fsk_pulses->freq2_hz / 1000000.0);
+        data = data_dbl(data, "rssi",  "RSSI",        "%.1f dB",    fsk_pulses->rssi_db);
+        data = data_dbl(data, "snr",   "SNR",         "%.1f dB",    fsk_pulses->snr_db);
+        data = data_dbl(data, "noise", "Noise",       "%.1f dB",    fsk_pulses->noise_db);
     }
     else if (cfg->report_meta) {
         data = data_str(data, "mod",   "Modulation",  NULL,         "ASK");
-        data = data_dbl(data, "freq",  "Freq",        "%.1f MHz",   cfg->demod->pulse_data.freq1_hz / 1000000.0);
-        data = data_dbl(data, "rssi",  "RSSI",        "%.1f dB",    cfg->demod->pulse_data.rssi_db);
-        data = data_dbl(data, "snr",   "SNR",         "%.1f dB",    cfg->demod->pulse_data.snr_db);
-        data = data_dbl(data, "noise", "Noise",       "%.1f dB",    cfg->demod->pulse_data.noise_db);
+        data = data_dbl(data, "freq",  "Freq",        "%.1f MHz",   ook_pulses->freq1_hz / 1000000.0);
+        data = data_dbl(data, "rssi",  "RSSI",        "%.1f dB",    ook_pulses->rssi_db);
+        data = data_dbl(data, "snr",   "SNR",         "%.1f dB",    ook_pulses->snr_db);
+        data = data_dbl(data, "noise", "Noise",       "%.1f dB",    ook_pulses->noise_db);
+    }
+
+    if (cfg->tag_input) {
+        data = data_str(data, "input", "Input", NULL, cfg->dev_query ? cfg->dev_query : "");
+    }
+
+    // the stage delays of the package up to this event, file input has no buffer and queue delays
+    if (cfg->report_latency && package->detect_ns) {
+        if (package->publish_ns) {
+            data = data_int(data, "lat_buffer", "Buffer delay", "%d us", (int)((package->publish_ns - package->package_end_ns) / 1000));
+            data = data_int(data, "lat_queue",  "Queue delay",  "%d us", (int)((package->demod_start_ns - package->publish_ns) / 1000));
+        }
+        data = data_int(data, "lat_dsp",    "DSP delay",    "%d us", (int)((package->detect_ns - package->demod_start_ns) / 1000));
+        data = data_int(data, "lat_decode", "Decode delay", "%d us", (int)((get_time_now_ns() - package->detect_ns) / 1000));
     }
 
     // prepend "time" if requested
     if (cfg->report_time != REPORT_TIME_OFF) {
         char time_str[LOCAL_TIME_BUFLEN];
-        time_pos_str(cfg, cfg->demod->pulse_data.start_ago, time_str);
+        time_pos_str(cfg, ook_pulses->start_ago, time_str);
         data = data_prepend(data,
                 data_str(NULL, "time", "", NULL, time_str));
     }
@@ -878,14 +2623,98 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
         data            = data_tag_apply(tag, data, cfg->in_filename);
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_print(output, data);
+    if (!tenant && primary->sensor_state) {
+        keep_sensor_state(primary->sensor_state, cfg, r_dev, data);
     }
-    data_free(data);
+
+    if (!tenant && primary->fusion) {
+        data = event_fusion_mark(data, fusion_hash, fusion_rssi);
+    }
+
+    // the events of the inputs are merged by the sample time of the package
+    if (!tenant && input_merge(cfg)) {
+        pulse_data_t const *pulses = event_pulses(cfg, r_dev);
+        data = event_merge_mark(data, cfg, (int64_t)(pulses->offset * 1000000 / cfg->samp_rate));
+    }
+
+    output_data(cfg, data, OUTPUT_TENANT_LEVEL(r_dev->tenant));
+}
+
+// the percentiles and the counts of a stage delay histogram
+static data_t *latency_hist_data(latency_hist_t const *hist)
+{
+    /* clang-format off */
+    return data_make(
+            "count",        "", DATA_INT, (int)latency_hist_count(hist),
+            "p50_us",       "", DATA_INT, (int)latency_hist_percentile(hist, 50),
+            "p90_us",       "", DATA_INT, (int)latency_hist_percentile(hist, 90),
+            "p99_us",       "", DATA_INT, (int)latency_hist_percentile(hist, 99),
+            "max_us",       "", DATA_INT, (int)hist->max_us,
+            "bounds_us",    "", DATA_ARRAY, data_array(LATENCY_HIST_US_BINS - 1, DATA_INT, latency_hist_bounds_us),
+            "counts",       "", DATA_ARRAY, data_array(LATENCY_HIST_US_BINS, DATA_INT, hist->counts),
+            NULL);
+    /* clang-format on */
+}
+
+// level 0: do not report (don't call this), 1: report successful devices, 2: report active devices, 3: report all with the decoder cost
+// the level, the noise floor, and the occupancy of each channel, taken from its loudest and busiest bins
+static data_t *create_channel_spectrum_data(r_cfg_t *cfg)
+{
+    unsigned channels = (unsigned)cfg->channel_count;
+    unsigned half     = SPECTRUM_BINS / channels;
+    list_t ch_data_list = {0};
+    list_ensure_size(&ch_data_list, channels);
+    for (unsigned k = 0; k < channels; ++k) {
+        int offset   = channelizer_offset(cfg->channelizer, k, cfg->samp_rate);
+        unsigned bin = spectrum_bin(offset, cfg->samp_rate);
+        float level = -120.0f, noise = 0.0f, occupancy = 0.0f;
+        for (unsigned i = 0; i <= 2 * half; ++i) {
+            unsigned b = (bin + SPECTRUM_BINS - half + i) % SPECTRUM_BINS;
+            level      = MAX(level, spectrum_level_db(cfg->spectrum, b));
+            noise     += spectrum_noise_db(cfg->spectrum, b) / (2 * half + 1);
+            occupancy  = MAX(occupancy, spectrum_occupancy(cfg->spectrum, b));
+        }
+        list_push(&ch_data_list, data_make(
+                "offset",       "", DATA_INT, offset,
+                "level_db",     "", DATA_FORMAT, "%.1f", DATA_DOUBLE, (double)level,
+                "noise_db",     "", DATA_FORMAT, "%.1f", DATA_DOUBLE, (double)noise,
+                "occupancy",    "", DATA_FORMAT, "%.1f", DATA_DOUBLE, (double)occupancy,
+                NULL));
+    }
+    data_t *data = data_make(
+            "channels",     "", DATA_ARRAY, data_array(ch_data_list.len, DATA_DATA, ch_data_list.elems),
+            NULL);
+    list_free_elems(&ch_data_list, NULL);
+    return data;
+}
+
+data_t *create_spectrum_data(r_cfg_t *cfg)
+{
+    if (!cfg->spectrum)
+        return NULL;
+
+    // ordered from the lowest to the highest frequency
+    double level[SPECTRUM_BINS];
+    double noise[SPECTRUM_BINS];
+    double occupancy[SPECTRUM_BINS];
+    for (unsigned i = 0; i < SPECTRUM_BINS; ++i) {
+        unsigned bin = (i + SPECTRUM_BINS / 2) % SPECTRUM_BINS;
+        level[i]     = round(spectrum_level_db(cfg->spectrum, bin) * 10.0) / 10.0;
+        noise[i]     = round(spectrum_noise_db(cfg->spectrum, bin) * 10.0) / 10.0;
+        occupancy[i] = round(spectrum_occupancy(cfg->spectrum, bin) * 10.0) / 10.0;
+    }
+    return data_make(
+            "center_frequency", "", DATA_INT, (int)cfg->center_frequency,
+            "sample_rate",  "", DATA_INT, (int)cfg->samp_rate,
+            "bins",         "", DATA_INT, SPECTRUM_BINS,
+            "first_hz",     "", DATA_INT, (int)(cfg->center_frequency - cfg->samp_rate / 2),
+            "bin_hz",       "", DATA_DOUBLE, (double)cfg->samp_rate / SPECTRUM_BINS,
+            "level_db",     "", DATA_ARRAY, data_array(SPECTRUM_BINS, DATA_DOUBLE, level),
+            "noise_db",     "", DATA_ARRAY, data_array(SPECTRUM_BINS, DATA_DOUBLE, noise),
+            "occupancy",    "", DATA_ARRAY, data_array(SPECTRUM_BINS, DATA_DOUBLE, occupancy),
+            NULL);
 }
 
-// level 0: do not report (don't call this), 1: report successful devices, 2: report active devices, 3: report all
 data_t *create_report_data(r_cfg_t *cfg, int level)
 {
     list_t *r_devs = &cfg->demod->r_devs;
@@ -895,9 +2724,10 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
 
     for (void **iter = r_devs->elems; iter && *iter; ++iter) {
         r_device *r_dev = *iter;
-        if (level <= 2 && r_dev->decode_events == 0)
+        // a decoder over the decode budget is flagged even without events
+        if (level <= 2 && r_dev->decode_events == 0 && r_dev->budget_overruns == 0)
             continue;
-        if (level <= 1 && r_dev->decode_ok == 0)
+        if (level <= 1 && r_dev->decode_ok == 0 && r_dev->budget_overruns == 0)
             continue;
         if (level <= 0)
             continue;
@@ -920,6 +2750,16 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             data = data_int(data, "fail_mic",     "", NULL, r_dev->decode_fails[-DECODE_FAIL_MIC]);
         if (r_dev->decode_fails[-DECODE_FAIL_SANITY])
             data = data_int(data, "fail_sanity",  "", NULL, r_dev->decode_fails[-DECODE_FAIL_SANITY]);
+        if (r_dev->decode_duplicates)
+            data = data_int(data, "duplicates",   "", NULL, r_dev->decode_duplicates);
+        if (r_dev->budget_overruns)
+            data = data_int(data, "over_budget",  "", NULL, r_dev->budget_overruns);
+        if (level >= 3 && r_dev->slice_calls) {
+            data = data_int(data, "slice_calls",  "", NULL, r_dev->slice_calls);
+            data = data_int(data, "slice_us",     "", NULL, (int)(r_dev->slice_ns / 1000));
+            data = data_int(data, "decode_calls", "", NULL, r_dev->decode_calls);
+            data = data_int(data, "decode_us",    "", NULL, (int)(r_dev->decode_ns / 1000));
+        }
 
         list_push(&dev_data_list, data);
     }
@@ -928,7 +2768,140 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             "count",            "", DATA_INT, cfg->frames_ook,
             "fsk",              "", DATA_INT, cfg->frames_fsk,
             "events",           "", DATA_INT, cfg->frames_events,
+            "dropped",          "", DATA_INT, cfg->frames_dropped,
+            "overflow",         "", DATA_INT, cfg->frames_overflow,
+            "lowpass_order",    "", DATA_INT, cfg->demod->lowpass_filter_state.order > 1 ? cfg->demod->lowpass_filter_state.order : 1,
+            "baseband_us",      "", DATA_INT, (int)cfg->frames_baseband_us,
+            "detect_us",        "", DATA_INT, (int)(cfg->frames_detect_ns / 1000),
+            "decode_us",        "", DATA_INT, (int)(cfg->frames_decode_ns / 1000),
             NULL);
+    if (cfg->frames_buffers) {
+        // allocations since the last report, before this report allocates
+        unsigned allocs = data_alloc_count() - cfg->frames_allocs_since;
+        data = data_int(data, "buffers", "", NULL, cfg->frames_buffers);
+        data = data_int(data, "squelch", "", NULL, cfg->frames_squelch);
+        data = data_int(data, "kbytes", "", NULL, (int)(cfg->frames_bytes / 1024));
+        data = data_dbl(data, "load", "", "%.3f", cfg->frames_duration_ns ? (double)cfg->frames_busy_ns / cfg->frames_duration_ns : 0.0);
+        data = data_dat(data, "callback_us", "", NULL, latency_hist_data(&cfg->frames_callback));
+        data = data_int(data, "allocs", "", NULL, allocs);
+        data = data_dbl(data, "allocs_per_event", "", "%.1f", cfg->frames_events ? (double)allocs / cfg->frames_events : 0.0);
+    }
+    if (cfg->demod->squelch_offset > 0) {
+        data = data_int(data, "prefilter_hit", "", NULL, cfg->frames_prefilter_hit);
+        data = data_int(data, "prefilter_miss", "", NULL, cfg->frames_prefilter_miss);
+        data = data_int(data, "subblock", "", NULL, cfg->frames_subblock);
+    }
+    if (cfg->frames_fm_total) {
+        data = data_dbl(data, "fm_share", "", "%.3f", (double)cfg->frames_fm_samples / cfg->frames_fm_total);
+    }
+    if (cfg->spectrum_gate > 0) {
+        data = data_int(data, "gated", "", NULL, cfg->frames_gated);
+    }
+    if (cfg->duty_cycle) {
+        data = data_int(data, "dozed", "", NULL, cfg->frames_dozed);
+        data = data_int(data, "periodic", "", NULL, (int)duty_cycle_periodic(cfg->duty_cycle));
+    }
+    if (cfg->load_shed) {
+        // totals since the start of the input, the steps from 1 on
+        int raised[LOAD_SHED_STEPS - 1];
+        int lowered[LOAD_SHED_STEPS - 1];
+        int step_ms[LOAD_SHED_STEPS];
+        for (int i = 0; i < LOAD_SHED_STEPS; ++i) {
+            if (i > 0) {
+                raised[i - 1]  = (int)load_shed_raised(cfg->load_shed, i);
+                lowered[i - 1] = (int)load_shed_lowered(cfg->load_shed, i);
+            }
+            uint64_t ms = load_shed_step_ms(cfg->load_shed, i);
+            step_ms[i]  = ms < INT_MAX ? (int)ms : INT_MAX;
+        }
+        data_t *shed_data = data_make(
+                "step",         "", DATA_INT, (int)load_shed_step(cfg->load_shed),
+                "load",         "", DATA_FORMAT, "%.3f", DATA_DOUBLE, (double)load_shed_load(cfg->load_shed),
+                "raised",       "", DATA_ARRAY, data_array(LOAD_SHED_STEPS - 1, DATA_INT, raised),
+                "lowered",      "", DATA_ARRAY, data_array(LOAD_SHED_STEPS - 1, DATA_INT, lowered),
+                "step_ms",      "", DATA_ARRAY, data_array(LOAD_SHED_STEPS, DATA_INT, step_ms),
+                NULL);
+        data = data_dat(data, "shed", "", NULL, shed_data);
+    }
+    if (cfg->buf_tune) {
+        // the transfers are 0 while measuring
+        data_t *tune_data = data_make(
+                "buf_num",      "", DATA_INT, (int)buf_tune_buf_num(cfg->buf_tune),
+                "buf_len",      "", DATA_INT, (int)buf_tune_buf_len(cfg->buf_tune),
+                "jitter_us",    "", DATA_INT, (int)buf_tune_jitter_us(cfg->buf_tune, 99),
+                "busy_us",      "", DATA_INT, (int)buf_tune_busy_us(cfg->buf_tune, 99),
+                "wait_us",      "", DATA_INT, (int)buf_tune_wait_us(cfg->buf_tune, 99),
+                "lost",         "", DATA_INT, (int)buf_tune_lost(cfg->buf_tune),
+                NULL);
+        data = data_dat(data, "buf_tune", "", NULL, tune_data);
+    }
+    if (cfg->early_decode) {
+        data = data_int(data, "early", "", NULL, cfg->frames_early);
+    }
+    if (cfg->dedup_ms > 0 || cfg->early_decode) {
+        unsigned duplicates = cfg->frames_duplicates;
+        for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            duplicates += r_dev->decode_duplicates;
+        }
+        data = data_int(data, "duplicates", "", NULL, duplicates);
+    }
+    if (cfg->decode_budget_us > 0) {
+        data = data_int(data, "over_budget", "", NULL, cfg->frames_over_budget);
+        data = data_int(data, "budget_skipped", "", NULL, cfg->frames_budget_skipped);
+    }
+    if (cfg->kernel_autotune) {
+        char names[256];
+        baseband_kernel_names(names, sizeof(names));
+        data = data_str(data, "kernels", "", NULL, names);
+    }
+    if (cfg->fusion) {
+        data = data_int(data, "fused", "", NULL, (int)event_fusion_dropped(cfg->fusion));
+    }
+    if (cfg->merge) {
+        data = data_int(data, "merge_late", "", NULL, (int)event_merge_late(cfg->merge));
+    }
+    if (cfg->throttle) {
+        data = data_int(data, "throttled", "", NULL, (int)event_throttle_dropped(cfg->throttle));
+        data = data_int(data, "sensors", "", NULL, (int)event_throttle_sensors(cfg->throttle));
+    }
+    if (cfg->sensor_state) {
+        data = data_int(data, "devices", "", NULL, (int)sensor_state_sensors(cfg->sensor_state));
+    }
+    sdr_link_stats_t link;
+    if (cfg->dev && sdr_get_link_stats(cfg->dev, &link) == 0) {
+        // totals since the start of the network input
+        data_t *link_data = data_make(
+                "reconnects",   "", DATA_INT, (int)link.reconnects,
+                "samples_lost", "", DATA_INT, (int)(link.samples_lost < INT_MAX ? link.samples_lost : INT_MAX),
+                "rcvbuf",       "", DATA_INT, link.rcvbuf,
+                "retransmits",  "", DATA_INT, (int)link.retransmits,
+                "rtt_us",       "", DATA_INT, (int)link.rtt_us,
+                NULL);
+        data = data_dat(data, "link", "", NULL, link_data);
+    }
+    unsigned latency_count = 0;
+    for (unsigned i = 0; i < LATENCY_HIST_BINS; ++i) {
+        latency_count += cfg->frames_latency[i];
+    }
+    if (latency_count) {
+        data_t *latency = data_make(
+                "bounds_ms",    "", DATA_ARRAY, data_array(LATENCY_HIST_BINS - 1, DATA_INT, latency_bounds_ms),
+                "counts",       "", DATA_ARRAY, data_array(LATENCY_HIST_BINS, DATA_INT, cfg->frames_latency),
+                "max_ms",       "", DATA_INT, cfg->frames_latency_max_ms,
+                NULL);
+        data = data_dat(data, "latency", "", NULL, latency);
+    }
+    if (cfg->report_latency) {
+        static char const *const stage_names[LATENCY_STAGES] = {"buffer", "queue", "dsp", "decode"};
+        data_t *stages = NULL;
+        for (unsigned i = 0; i < LATENCY_STAGES; ++i) {
+            if (latency_hist_count(&cfg->frames_stage_latency[i]))
+                stages = data_dat(stages, stage_names[i], "", NULL, latency_hist_data(&cfg->frames_stage_latency[i]));
+        }
+        if (stages)
+            data = data_dat(data, "stage_latency", "", NULL, stages);
+    }
 
     char since_str[LOCAL_TIME_BUFLEN];
     format_time_str(since_str, "%Y-%m-%dT%H:%M:%S", cfg->report_time_tz, cfg->frames_since);
@@ -941,6 +2914,91 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             NULL);
 
     list_free_elems(&dev_data_list, NULL);
+
+    if (cfg->spectrum && cfg->channelizer) {
+        data = data_dat(data, "spectrum", "", NULL, create_channel_spectrum_data(cfg));
+    }
+
+    // the kB of the sample buffers of the process by backing, e.g. if huge pages are used
+    if (!cfg->primary) {
+        data_t *backings = NULL;
+        for (int i = 0; i < SAMPLE_BUF_BACKINGS; ++i) {
+            size_t bytes = sample_buf_bytes((sample_buf_backing_t)i);
+            if (bytes)
+                backings = data_int(backings, sample_buf_backing_name((sample_buf_backing_t)i), "", NULL, (int)(bytes / 1024));
+        }
+        if (backings)
+            data = data_dat(data, "sample_buffers", "", NULL, backings);
+    }
+
+    // the log messages suppressed by rate limits, and dropped with the log ring full
+    if (!cfg->primary && (print_log_suppressed() || log_ring_dropped())) {
+        data = data_dat(data, "log", "", NULL, data_make(
+                "suppressed",   "", DATA_INT, (int)print_log_suppressed(),
+                "dropped",      "", DATA_INT, (int)log_ring_dropped(),
+                NULL));
+    }
+
+    // the queues of outputs printing on their own thread, the writes of InfluxDB and webhook outputs, and the TLS handshakes
+    list_t queue_data_list = {0};
+    for (size_t i = 0; !cfg->primary && i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        output_queue_stats_t queue;
+        influx_stats_t influx;
+        tls_stats_t tls;
+        if (data_output_async_stats(cfg->output_handler.elems[i], &queue, 0)) {
+            data_t *queue_data = data_make(
+                    "output",       "", DATA_INT, (int)i,
+                    "queued",       "", DATA_INT, (int)queue.depth,
+                    "max_queued",   "", DATA_INT, (int)queue.max_depth,
+                    "dropped",      "", DATA_INT, (int)queue.dropped,
+                    "blocked",      "", DATA_INT, (int)queue.blocked,
+                    NULL);
+            if (cfg->report_latency && latency_hist_count(&queue.send))
+                queue_data = data_dat(queue_data, "send_latency", "", NULL, latency_hist_data(&queue.send));
+            list_push(&queue_data_list, queue_data);
+        }
+        else if (data_output_influx_stats(cfg->output_handler.elems[i], &influx, 0)) {
+            list_push(&queue_data_list, data_make(
+                    "output",       "", DATA_INT, (int)i,
+                    "queued",       "", DATA_INT, (int)influx.queued,
+                    "dropped",      "", DATA_INT, (int)influx.dropped,
+                    "batches",      "", DATA_INT, (int)influx.batches,
+                    "lines",        "", DATA_INT, (int)influx.lines,
+                    "max_lines",    "", DATA_INT, (int)influx.max_lines,
+                    "max_bytes",    "", DATA_INT, (int)influx.max_bytes,
+                    "write_ms",     "", DATA_INT, influx.batches ? (int)(influx.write_ms / influx.batches) : 0,
+                    "max_write_ms", "", DATA_INT, (int)influx.max_write_ms,
+                    "latency_ms",   "", DATA_INT, influx.batches ? (int)(influx.latency_ms / influx.batches) : 0,
+                    "max_latency_ms", "", DATA_INT, (int)influx.max_latency_ms,
+                    "retries",      "", DATA_INT, (int)influx.retries,
+                    "tls_handshakes",   "", DATA_COND, influx.tls.handshakes || influx.tls.failed, DATA_INT, (int)influx.tls.handshakes,
+                    "tls_resumed",      "", DATA_COND, influx.tls.handshakes || influx.tls.failed, DATA_INT, (int)influx.tls.resumed,
+                    "tls_failed",       "", DATA_COND, influx.tls.handshakes || influx.tls.failed, DATA_INT, (int)influx.tls.failed,
+                    "handshake_ms",     "", DATA_COND, influx.tls.handshakes, DATA_INT, influx.tls.handshakes ? (int)(influx.tls.handshake_ms / influx.tls.handshakes) : 0,
+                    "max_handshake_ms", "", DATA_COND, influx.tls.handshakes, DATA_INT, (int)influx.tls.max_handshake_ms,
+                    NULL));
+        }
+        else if (data_output_mqtt_stats(cfg->output_handler.elems[i], &tls, 0)) {
+            list_push(&queue_data_list, data_make(
+                    "output",           "", DATA_INT, (int)i,
+                    "tls_handshakes",   "", DATA_INT, (int)tls.handshakes,
+                    "tls_resumed",      "", DATA_INT, (int)tls.resumed,
+                    "tls_failed",       "", DATA_INT, (int)tls.failed,
+                    "handshake_ms",     "", DATA_INT, tls.handshakes ? (int)(tls.handshake_ms / tls.handshakes) : 0,
+                    "max_handshake_ms", "", DATA_INT, (int)tls.max_handshake_ms,
+                    NULL));
+        }
+    }
+    if (queue_data_list.len) {
+        data = data_ary(data, "outputs", "", NULL, data_array(queue_data_list.len, DATA_DATA, queue_data_list.elems));
+    }
+    list_free_elems(&queue_data_list, NULL);
+
+    // the memory of the subsystems that grow at runtime, once for all receivers
+    if (!cfg->primary) {
+        data = data_ary(data, "memory", "", NULL, mem_acct_data());
+    }
+
     return data;
 }
 
@@ -952,6 +3010,42 @@ void flush_report_data(r_cfg_t *cfg)
     cfg->frames_ook = 0;
     cfg->frames_fsk = 0;
     cfg->frames_events = 0;
+    cfg->frames_dropped = 0;
+    cfg->frames_overflow = 0;
+    cfg->frames_prefilter_hit = 0;
+    cfg->frames_prefilter_miss = 0;
+    cfg->frames_subblock = 0;
+    cfg->frames_fm_samples = 0;
+    cfg->frames_fm_total = 0;
+    cfg->frames_baseband_us = 0;
+    cfg->frames_detect_ns = 0;
+    cfg->frames_decode_ns = 0;
+    memset(cfg->frames_latency, 0, sizeof(cfg->frames_latency));
+    cfg->frames_latency_max_ms = 0;
+    memset(cfg->frames_stage_latency, 0, sizeof(cfg->frames_stage_latency));
+    cfg->frames_duplicates = 0;
+    cfg->frames_early = 0;
+    cfg->frames_over_budget = 0;
+    cfg->frames_budget_skipped = 0;
+    cfg->frames_gated = 0;
+    cfg->frames_dozed = 0;
+    cfg->frames_buffers = 0;
+    cfg->frames_squelch = 0;
+    cfg->frames_bytes = 0;
+    cfg->frames_busy_ns = 0;
+    cfg->frames_duration_ns = 0;
+    memset(&cfg->frames_callback, 0, sizeof(cfg->frames_callback));
+    cfg->frames_allocs_since = data_alloc_count();
+    if (cfg->spectrum)
+        spectrum_flush(cfg->spectrum);
+
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (root->decoder_usage) {
+        r_add_decoder_usage(cfg, root->decoder_usage);
+    }
 
     for (void **iter = r_devs->elems; iter && *iter; ++iter) {
         r_device *r_dev = *iter;
@@ -964,53 +3058,167 @@ void flush_report_data(r_cfg_t *cfg)
         r_dev->decode_fails[2] = 0;
         r_dev->decode_fails[3] = 0;
         r_dev->decode_fails[4] = 0;
+        r_dev->slice_calls = 0;
+        r_dev->slice_ns = 0;
+        r_dev->decode_calls = 0;
+        r_dev->decode_ns = 0;
+        r_dev->decode_duplicates = 0;
+        r_dev->budget_overruns = 0;
+    }
+
+    for (size_t i = 0; !cfg->primary && i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        output_queue_stats_t queue;
+        influx_stats_t influx;
+        tls_stats_t tls;
+        data_output_async_stats(cfg->output_handler.elems[i], &queue, 1);
+        data_output_influx_stats(cfg->output_handler.elems[i], &influx, 1);
+        data_output_mqtt_stats(cfg->output_handler.elems[i], &tls, 1);
+    }
+}
+
+void r_add_decoder_usage(r_cfg_t *cfg, decoder_usage_t *usage)
+{
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        unsigned aborts = 0;
+        for (unsigned i = 0; i < sizeof(r_dev->decode_fails) / sizeof(*r_dev->decode_fails); ++i) {
+            aborts += r_dev->decode_fails[i];
+        }
+        decoder_usage_add(usage, r_dev->protocol_num, r_dev->name, r_dev->decode_ok, aborts, r_dev->slice_ns + r_dev->decode_ns);
+    }
+}
+
+void set_report_stats(r_cfg_t *cfg, int level)
+{
+    cfg->report_stats = level;
+
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    // timing each call is not free, only the full report and the decoder usage show the cost
+    list_t *r_devs = &cfg->demod->r_devs;
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        r_dev->report_cost = level >= 3 || root->decoder_usage_report;
     }
 }
 
 /* setup */
 
-static int lvlarg_param(char **param, int default_verb)
+/// Queue options of an output, the output prints on its own thread if queued.
+typedef struct output_queue_opt {
+    int queued;
+    output_queue_policy_t policy;
+    unsigned depth;
+} output_queue_opt_t;
+
+// parse the options ", v = %d", ", queue[=block|drop-oldest|drop-newest]", ", depth = %u", ", flush = %u[ms|s|k]", ", fsync"
+static int lvlarg_param(char **param, int default_verb, output_queue_opt_t *queue, file_flush_t *flush)
 {
+    int val = default_verb;
     if (!param || !*param) {
-        return default_verb;
+        return val;
     }
-    // parse ", v = %d"
     char *p = *param;
-    if (*p != ',') {
-        return default_verb;
-    }
-    p++;
-    while (*p == ' ' || *p == '\t')
-        p++;
-    if (*p != 'v') {
-        fprintf(stderr, "Unknown output option \"%s\"\n", *param);
-        exit(1);
-    }
-    p++;
-    while (*p == ' ' || *p == '\t')
+    while (*p == ',') {
+        char *opt = p;
         p++;
-    if (*p != '=') {
-        fprintf(stderr, "Unknown output option \"%s\"\n", *param);
-        exit(1);
+        while (*p == ' ' || *p == '\t')
+            p++;
+        char *key = p;
+        while (*p >= 'a' && *p <= 'z')
+            p++;
+        size_t key_len = p - key;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        char *arg = NULL;
+        if (*p == '=') {
+            p++;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            arg = p;
+        }
+        char *endptr = arg;
+        if (key_len == 1 && *key == 'v' && arg) {
+            val = strtol(arg, &endptr, 10);
+        }
+        else if (queue && key_len == 5 && !strncmp(key, "queue", 5)) {
+            queue->queued = 1;
+            if (!arg) {
+                endptr = p;
+            }
+            else if (!strncmp(arg, "block", 5)) {
+                queue->policy = OUTPUT_QUEUE_BLOCK;
+                endptr        = arg + 5;
+            }
+            else if (!strncmp(arg, "drop-oldest", 11)) {
+                queue->policy = OUTPUT_QUEUE_DROP_OLDEST;
+                endptr        = arg + 11;
+            }
+            else if (!strncmp(arg, "drop-newest", 11)) {
+                queue->policy = OUTPUT_QUEUE_DROP_NEWEST;
+                endptr        = arg + 11;
+            }
+        }
+        else if (queue && key_len == 5 && !strncmp(key, "depth", 5) && arg) {
+            queue->queued = 1;
+            queue->depth  = strtoul(arg, &endptr, 10);
+        }
+        else if (flush && key_len == 5 && !strncmp(key, "flush", 5) && arg) {
+            unsigned n = strtoul(arg, &endptr, 10);
+            if (endptr != arg && !strncmp(endptr, "ms", 2)) {
+                flush->interval_ms = n;
+                endptr += 2;
+            }
+            else if (endptr != arg && *endptr == 's') {
+                flush->interval_ms = n * 1000;
+                endptr += 1;
+            }
+            else if (endptr != arg && *endptr == 'k') {
+                flush->buffer_size = n * 1024;
+                endptr += 1;
+            }
+            else {
+                endptr = arg; // a unit is required
+            }
+        }
+        else if (flush && key_len == 5 && !strncmp(key, "fsync", 5) && !arg) {
+            flush->sync = 1;
+            endptr      = p;
+        }
+        else {
+            fprintf(stderr, "Unknown output option \"%s\"\n", opt);
+            exit(1);
+        }
+        if (endptr == arg || (*endptr && *endptr != ',' && *endptr != ':')) {
+            fprintf(stderr, "Invalid output option \"%s\"\n", opt);
+            exit(1);
+        }
+        p = endptr;
     }
-    p++;
-    while (*p == ' ' || *p == '\t')
-        p++;
-    char *endptr;
-    int val = strtol(p, &endptr, 10);
-    if (p == endptr) {
-        fprintf(stderr, "Invalid output option \"%s\"\n", *param);
-        exit(1);
+    if (p != *param && *p == ':') {
+        p++; // Skip the `:` after the options
     }
-    *param = endptr;
+    *param = p;
     return val;
 }
 
+// outputs with a queue print on their own thread, the others on the event loop
+static void push_output(r_cfg_t *cfg, data_output_t *output, output_queue_opt_t const *queue)
+{
+    if (output && queue->queued) {
+        output = data_output_async_create(output, queue->policy, queue->depth);
+    }
+    list_push(&cfg->output_handler, output);
+}
+
 /// Opens the path @p param (or STDOUT if empty or `-`) for append writing, removes leading `,` and `:` from path name.
-static FILE *fopen_output(char const *param)
+// the path of an output file, NULL for STDOUT
+static char const *output_path(char const *param)
 {
     if (!param || !*param) {
-        return stdout; // No path given
+        return NULL; // No path given
     }
     while (*param == ',') {
         param++; // Skip all leading `,`
@@ -1019,9 +3227,18 @@ static FILE *fopen_output(char const *param)
         param++; // Skip one leading `:`
     }
     if (*param == '-' && param[1] == '\0') {
-        return stdout; // STDOUT requested
+        return NULL; // STDOUT requested
+    }
+    return param;
+}
+
+static FILE *fopen_output_mode(char const *param, char const *mode)
+{
+    char const *path = output_path(param);
+    if (!path) {
+        return stdout;
     }
-    FILE *file = fopen(param, "a");
+    FILE *file = fopen(path, mode);
     if (!file) {
         fprintf(stderr, "rtl_433: failed to open output file\n");
         exit(1);
@@ -1029,41 +3246,97 @@ static FILE *fopen_output(char const *param)
     return file;
 }
 
+static FILE *fopen_output(char const *param)
+{
+    return fopen_output_mode(param, "a");
+}
+
 void add_json_output(r_cfg_t *cfg, char *param)
 {
-    int log_level = lvlarg_param(&param, 0);
-    list_push(&cfg->output_handler, data_output_json_create(log_level, fopen_output(param)));
+    output_queue_opt_t queue = {0};
+    file_flush_t flush = {0};
+    int log_level = lvlarg_param(&param, 0, &queue, &flush);
+    push_output(cfg, data_output_json_create(log_level, fopen_output(param), &flush), &queue);
 }
 
 void add_csv_output(r_cfg_t *cfg, char *param)
 {
-    int log_level = lvlarg_param(&param, 0);
-    list_push(&cfg->output_handler, data_output_csv_create(log_level, fopen_output(param)));
+    output_queue_opt_t queue = {0};
+    file_flush_t flush = {0};
+    int log_level = lvlarg_param(&param, 0, &queue, &flush);
+    push_output(cfg, data_output_csv_create(log_level, fopen_output(param), &flush), &queue);
 }
 
-void start_outputs(r_cfg_t *cfg, char const *const *well_known)
+static void add_binary_output(r_cfg_t *cfg, binary_format_t format, char *param)
 {
-    int num_output_fields;
-    char const **output_fields = determine_csv_fields(cfg, well_known, &num_output_fields);
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, 0, &queue, NULL);
+    if (param && strncmp(param, "udp:", 4) == 0) {
+        char const *host = "localhost";
+        char const *port = NULL;
+        char const *extra = hostport_param(param + 4, &host, &port);
+        if (!port) {
+            print_log(LOG_FATAL, "Binary UDP", "Missing port");
+            exit(1);
+        }
+        if (extra && *extra) {
+            print_logf(LOG_FATAL, "Binary UDP", "Unknown parameters \"%s\"", extra);
+        }
+        print_logf(LOG_CRITICAL, "Binary UDP", "Sending datagrams to %s port %s", host, port);
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_start(output, output_fields, num_output_fields);
+        push_output(cfg, data_output_binary_udp_create(format, log_level, host, port), &queue);
+        return;
     }
+    push_output(cfg, data_output_binary_create(format, log_level, fopen_output(param)), &queue);
+}
+
+void add_cbor_output(r_cfg_t *cfg, char *param)
+{
+    add_binary_output(cfg, BINARY_CBOR, param);
+}
+
+void add_msgpack_output(r_cfg_t *cfg, char *param)
+{
+    add_binary_output(cfg, BINARY_MSGPACK, param);
+}
+
+void add_arrow_output(r_cfg_t *cfg, char *param)
+{
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, 0, &queue, NULL);
+    // the file is written from the start, an Arrow file can not be appended to
+    push_output(cfg, data_output_arrow_create(log_level, fopen_output_mode(param, "wb"), output_path(param)), &queue);
+}
+
+void start_outputs(r_cfg_t *cfg, char const *const *well_known)
+{
+    // the outputs of a tenant pipeline only have the fields of its decoders
+    for (unsigned tenant = 0; tenant <= cfg->tenants.len; ++tenant) {
+        int num_output_fields;
+        char const **output_fields = tenant_csv_fields(cfg, tenant, well_known, &num_output_fields);
+
+        for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_t *output = cfg->output_handler.elems[i];
+            if (output && output->tenant == tenant)
+                data_output_start(output, output_fields, num_output_fields);
+        }
 
-    free((void *)output_fields);
+        free((void *)output_fields);
+    }
 }
 
 void add_log_output(r_cfg_t *cfg, char *param)
 {
-    int log_level = lvlarg_param(&param, LOG_TRACE);
-    list_push(&cfg->output_handler, data_output_log_create(log_level, fopen_output(param)));
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, LOG_TRACE, &queue, NULL);
+    push_output(cfg, data_output_log_create(log_level, fopen_output(param)), &queue);
 }
 
 void add_kv_output(r_cfg_t *cfg, char *param)
 {
-    int log_level = lvlarg_param(&param, LOG_TRACE);
-    list_push(&cfg->output_handler, data_output_kv_create(log_level, fopen_output(param)));
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, LOG_TRACE, &queue, NULL);
+    push_output(cfg, data_output_kv_create(log_level, fopen_output(param)), &queue);
 }
 
 void add_mqtt_output(r_cfg_t *cfg, char *param)
@@ -1076,18 +3349,83 @@ void add_influx_output(r_cfg_t *cfg, char *param)
     list_push(&cfg->output_handler, data_output_influx_create(get_mgr(cfg), param));
 }
 
+void add_webhook_output(r_cfg_t *cfg, char *param)
+{
+    list_push(&cfg->output_handler, data_output_webhook_create(get_mgr(cfg), param));
+}
+
 void add_syslog_output(r_cfg_t *cfg, char *param)
 {
-    int log_level = lvlarg_param(&param, LOG_WARNING);
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, LOG_WARNING, &queue, NULL);
     char const *host = "localhost";
     char const *port = "514";
-    char const *extra = hostport_param(param, &host, &port);
-    if (extra && *extra) {
-        print_logf(LOG_FATAL, "Syslog UDP", "Unknown parameters \"%s\"", extra);
+    char *extra = hostport_param(param, &host, &port);
+
+    // parse batch and format options
+    int raw                = 0;
+    datagram_batch_t batch = {0};
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "batch"))
+            batch.messages = atouint32_metric(val, "batch= ");
+        else if (!strcasecmp(key, "flush"))
+            batch.interval_ms = atoi_ms(val, "flush= ");
+        else if (!strcasecmp(key, "raw"))
+            raw = atobv(val, 1);
+        else {
+            print_logf(LOG_FATAL, "Syslog UDP", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
+    }
+    if (batch.interval_ms && !batch.messages) {
+        batch.messages = DATAGRAM_BATCH_MAX;
     }
     print_logf(LOG_CRITICAL, "Syslog UDP", "Sending datagrams to %s port %s", host, port);
 
-    list_push(&cfg->output_handler, data_output_syslog_create(log_level, host, port));
+    push_output(cfg, data_output_syslog_create(log_level, host, port, raw, &batch), &queue);
+}
+
+void add_unix_output(r_cfg_t *cfg, char *param)
+{
+    output_queue_opt_t queue = {0};
+    int log_level = lvlarg_param(&param, LOG_WARNING, &queue, NULL);
+    char *path    = param;
+    char *extra   = param ? strchr(param, ',') : NULL;
+    if (extra)
+        *extra++ = '\0';
+
+    int dgram            = 0;
+    unsigned max_clients = 0;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "type")) {
+            if (val && !strcasecmp(val, "seqpacket"))
+                dgram = 0;
+            else if (val && !strcasecmp(val, "dgram"))
+                dgram = 1;
+            else {
+                print_logf(LOG_FATAL, "Unix socket", "Unknown type \"%s\", use seqpacket or dgram", val ? val : "");
+                exit(1);
+            }
+        }
+        else if (!strcasecmp(key, "clients"))
+            max_clients = atouint32_metric(val, "clients= ");
+        else {
+            print_logf(LOG_FATAL, "Unix socket", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
+    }
+
+    push_output(cfg, data_output_unix_create(log_level, path, dgram, max_clients), &queue);
 }
 
 void add_http_output(r_cfg_t *cfg, char *param)
@@ -1095,13 +3433,48 @@ void add_http_output(r_cfg_t *cfg, char *param)
     // Note: no log_level, the HTTP-API consumes all log levels.
     char const *host = "0.0.0.0";
     char const *port = "8433";
-    char const *extra = hostport_param(param, &host, &port);
-    if (extra && *extra) {
-        print_logf(LOG_FATAL, "HTTP server", "Unknown parameters \"%s\"", extra);
+    char *extra = hostport_param(param, &host, &port);
+
+    // parse client options
+    unsigned client_bytes  = 0;
+    unsigned history_bytes = 0;
+    char const *store_dir  = NULL;
+    unsigned segment_bytes = 0;
+    unsigned segments      = 0;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "buffer"))
+            client_bytes = atouint32_metric(val, "buffer= ");
+        else if (!strcasecmp(key, "history"))
+            history_bytes = atouint32_metric(val, "history= ");
+        else if (!strcasecmp(key, "store") && val && *val)
+            store_dir = val;
+        else if (!strcasecmp(key, "segment"))
+            segment_bytes = atouint32_metric(val, "segment= ");
+        else if (!strcasecmp(key, "segments"))
+            segments = atouint32_metric(val, "segments= ");
+        else {
+            print_logf(LOG_FATAL, "HTTP server", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
     }
     print_logf(LOG_CRITICAL, "HTTP server", "Starting HTTP server at %s port %s", host, port);
 
-    list_push(&cfg->output_handler, data_output_http_create(get_mgr(cfg), host, port, cfg));
+    event_store_t *store = NULL;
+    if (store_dir) {
+        store = event_store_open(store_dir, segment_bytes, segments);
+        if (!store) {
+            print_logf(LOG_FATAL, "HTTP server", "Unable to open the event store \"%s\"", store_dir);
+            exit(1);
+        }
+    }
+
+    cfg->http_bytes += http_server_bytes(client_bytes, history_bytes);
+    list_push(&cfg->output_handler, data_output_http_create(get_mgr(cfg), host, port, cfg, client_bytes, history_bytes, store));
 }
 
 void add_trigger_output(r_cfg_t *cfg, char *param)
@@ -1120,15 +3493,120 @@ void add_rtltcp_output(r_cfg_t *cfg, char *param)
 {
     char const *host = "localhost";
     char const *port = "1234";
-    char const *extra = hostport_param(param, &host, &port);
-    if (extra && *extra) {
-        print_logf(LOG_FATAL, "rtl_tcp server", "Unknown parameters \"%s\"", extra);
-    }
+    char const *extra = hostport_param(param, &host, &port); // options are parsed by the output
     print_logf(LOG_CRITICAL, "rtl_tcp server", "Starting rtl_tcp server at %s port %s", host, port);
 
     list_push(&cfg->raw_handler, raw_output_rtltcp_create(host, port, extra, cfg));
 }
 
+void add_shm_output(r_cfg_t *cfg, char *param)
+{
+    char *name  = param;
+    char *extra = param ? strchr(param, ',') : NULL;
+    if (extra)
+        *extra++ = '\0';
+
+    unsigned ring_size    = 0;
+    int squelch           = 0;
+    char *squelch_padding = NULL;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "size"))
+            ring_size = atouint32_metric(val, "size= ");
+        else if (!strcasecmp(key, "squelch")) {
+            squelch         = 1;
+            squelch_padding = val;
+        }
+        else {
+            print_logf(LOG_FATAL, "SHM", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
+    }
+
+    raw_output_t *output = raw_output_shm_create(name, ring_size, cfg);
+    if (squelch)
+        output = raw_output_squelch_create(output, squelch_padding, cfg);
+    if (output)
+        list_push(&cfg->raw_handler, output);
+}
+
+void add_pulses_output(r_cfg_t *cfg, char *param)
+{
+    if (!param || strncmp(param, "udp:", 4) != 0) {
+        print_log(LOG_FATAL, "Pulses UDP", "Expected e.g. pulses:udp://host:port");
+        exit(1);
+    }
+    char const *host = "localhost";
+    char const *port = NULL;
+    char const *extra = hostport_param(param + 4, &host, &port);
+    if (!port) {
+        print_log(LOG_FATAL, "Pulses UDP", "Missing port");
+        exit(1);
+    }
+    if (extra && *extra) {
+        print_logf(LOG_FATAL, "Pulses UDP", "Unknown parameters \"%s\"", extra);
+        exit(1);
+    }
+    print_logf(LOG_CRITICAL, "Pulses UDP", "Sending pulse data to %s port %s", host, port);
+
+    pulse_output_t *output = pulse_output_udp_create(host, port);
+    if (output)
+        list_push(&cfg->pulse_handler, output);
+}
+
+static void fusion_output(void *ctx, data_t *data)
+{
+    output_data(ctx, data, 0);
+}
+
+void add_fusion_output(r_cfg_t *cfg, char *param)
+{
+    if (!param || strncmp(param, "udp:", 4) != 0) {
+        print_log(LOG_FATAL, "Fusion", "Expected e.g. fusion:udp://239.255.43.3:4433");
+        exit(1);
+    }
+    if (cfg->fusion) {
+        print_log(LOG_FATAL, "Fusion", "Only one fusion group is supported");
+        exit(1);
+    }
+    char const *host = NULL;
+    char const *port = NULL;
+    char *extra = hostport_param(param + 4, &host, &port);
+    if (!host || !port) {
+        print_log(LOG_FATAL, "Fusion", "Missing multicast group or port");
+        exit(1);
+    }
+
+    // parse window and TTL options
+    unsigned window_ms = 300;
+    int ttl            = 1;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "window"))
+            window_ms = atoi_ms(val, "window= ");
+        else if (!strcasecmp(key, "ttl"))
+            ttl = atoi(val);
+        else {
+            print_logf(LOG_FATAL, "Fusion", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
+    }
+
+    cfg->fusion = event_fusion_create(get_mgr(cfg), host, port, window_ms, ttl, fusion_output, cfg);
+    if (!cfg->fusion) {
+        exit(1);
+    }
+    print_logf(LOG_CRITICAL, "Fusion", "Fusing events with the receivers in group %s port %s, window %u ms", host, port, window_ms);
+}
+
 void add_sr_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
 {
     // create channels
@@ -1165,15 +3643,36 @@ void reopen_dumpers(struct r_cfg *cfg)
 
             // Reopen the file
             print_logf(LOG_INFO, "Dumper", "Reopening \"%s\"", dumper->path);
+            file_writer_close(dumper->writer);
+            dumper->writer = NULL;
+            pulse_archive_writer_close(dumper->archive);
+            dumper->archive = NULL;
             fclose(dumper->file);
             dumper->file = fopen(dumper->path, "wb");
             if (!dumper->file) {
                 fprintf(stderr, "Failed to open %s\n", dumper->path);
                 exit(1);
             }
+            if (dumper->format == PULSE_ARCHIVE) {
+                dumper->archive = pulse_archive_writer_open(dumper->file, cfg->samp_rate);
+                if (!dumper->archive) {
+                    exit(1);
+                }
+            }
+            else if (dumper->format != VCD_LOGIC && dumper->format != PULSE_OOK && dumper->format != RLE_LOGIC) {
+                dumper->writer = file_writer_open(dumper->file, dumper->zstd, FILE_WRITER_BUFFER_MB);
+                if (!dumper->writer) {
+                    exit(1);
+                }
+            }
             if (dumper->format == VCD_LOGIC) {
                 pulse_data_print_vcd_header(dumper->file, cfg->samp_rate);
             }
+            if (dumper->format == RLE_LOGIC) {
+                // the runs start at the input start again, as the VCD times do
+                pulse_data_print_rle_header(dumper->file, cfg->samp_rate);
+                dumper->rle_pos = 0;
+            }
             if (dumper->format == PULSE_OOK) {
                 pulse_data_print_pulse_header(dumper->file);
             }
@@ -1186,9 +3685,26 @@ void close_dumpers(struct r_cfg *cfg)
 {
     for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
         file_info_t *dumper = *iter;
+        if (file_writer_close(dumper->writer) < 0) {
+            print_logf(LOG_ERROR, "Dumper", "Writing \"%s\" failed, the file is incomplete.", dumper->path);
+        }
+        dumper->writer = NULL;
+        if (pulse_archive_writer_close(dumper->archive) < 0) {
+            print_logf(LOG_ERROR, "Dumper", "Writing \"%s\" failed, the archive is incomplete.", dumper->path);
+        }
+        dumper->archive = NULL;
+        // the idle samples after the last package
+        if (dumper->format == RLE_LOGIC && dumper->file) {
+            pulse_data_print_rle_end(dumper->file, dumper->rle_pos, cfg->input_pos);
+            dumper->rle_pos = cfg->input_pos;
+        }
         if (dumper->file && (dumper->file != stdout)) {
             fclose(dumper->file);
             dumper->file = NULL;
+            // the meta data is written last, the recording is complete
+            if (dumper->sigmf) {
+                sigmf_write_meta(dumper, cfg->samp_rate, cfg->center_frequency);
+            }
         }
     }
 
@@ -1223,6 +3739,14 @@ void add_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
     list_push(&cfg->demod->dumper, dumper);
 
     file_info_parse_filename(dumper, spec);
+    if (dumper->zstd && (dumper->format == VCD_LOGIC || dumper->format == PULSE_OOK || dumper->format == PULSE_ARCHIVE || dumper->format == RLE_LOGIC)) {
+        fprintf(stderr, "Only sample outputs can be compressed (%s)\n", spec);
+        exit(1);
+    }
+    if (dumper->sigmf && (dumper->zstd || !sigmf_datatype(dumper->format))) {
+        fprintf(stderr, "Only uncompressed CU8, CS8, CS16, or CF32 samples can be written as SigMF (%s)\n", spec);
+        exit(1);
+    }
     if (strcmp(dumper->path, "-") == 0) { /* Write samples to stdout */
         dumper->file = stdout;
 #ifdef _WIN32
@@ -1240,9 +3764,25 @@ void add_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
             exit(1);
         }
     }
+    if (dumper->format == PULSE_ARCHIVE) {
+        dumper->archive = pulse_archive_writer_open(dumper->file, cfg->samp_rate);
+        if (!dumper->archive) {
+            exit(1);
+        }
+    }
+    // samples are written on a thread, a slow disk does not stall the receiver
+    else if (dumper->format != VCD_LOGIC && dumper->format != PULSE_OOK && dumper->format != RLE_LOGIC) {
+        dumper->writer = file_writer_open(dumper->file, dumper->zstd, FILE_WRITER_BUFFER_MB);
+        if (!dumper->writer) {
+            exit(1);
+        }
+    }
     if (dumper->format == VCD_LOGIC) {
         pulse_data_print_vcd_header(dumper->file, cfg->samp_rate);
     }
+    if (dumper->format == RLE_LOGIC) {
+        pulse_data_print_rle_header(dumper->file, cfg->samp_rate);
+    }
     if (dumper->format == PULSE_OOK) {
         pulse_data_print_pulse_header(dumper->file);
     }
@@ -0,0 +1,224 @@
+/** @file
+    Embeddable decoding API, events are passed to a callback.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "r_lib.h"
+
+#include "r_api.h"
+#include "r_private.h"
+#include "r_device.h"
+#include "rtl_433.h"
+#include "pulse_data.h"
+#include "pulse_detect.h"
+#include "data.h"
+#include "list.h"
+#include "r_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// The output passing the events to the callback of an instance.
+typedef struct {
+    struct data_output output;
+    r_lib_event_fn event_fn;
+    void *ctx;
+} callback_output_t;
+
+struct r_lib {
+    r_cfg_t *cfg;
+    int prepared; ///< the decoders are packed and the demod is set up for them
+};
+
+static void R_API_CALLCONV callback_output_print(data_output_t *output, data_t *data)
+{
+    callback_output_t *cb = (callback_output_t *)output;
+
+    cb->event_fn(data, cb->ctx);
+}
+
+static void R_API_CALLCONV callback_output_free(data_output_t *output)
+{
+    free(output);
+}
+
+r_lib_t *r_lib_create(uint32_t sample_rate, r_lib_event_fn event_fn, void *ctx)
+{
+    r_lib_t *lib = calloc(1, sizeof(*lib));
+    if (!lib) {
+        WARN_CALLOC("r_lib_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    callback_output_t *cb = calloc(1, sizeof(*cb));
+    if (!cb) {
+        WARN_CALLOC("r_lib_create()");
+        free(lib);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    cb->output.log_level    = LOG_WARNING;
+    cb->output.output_print = callback_output_print;
+    cb->output.output_free  = callback_output_free;
+    cb->event_fn            = event_fn;
+    cb->ctx                 = ctx;
+
+    lib->cfg = r_create_cfg();
+    lib->cfg->samp_rate   = sample_rate;
+    lib->cfg->report_time = REPORT_TIME_DATE;
+    list_push(&lib->cfg->output_handler, cb);
+
+    struct dm_state *demod = lib->cfg->demod;
+    pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit,
+            demod->min_level, demod->min_snr, demod->detect_verbosity);
+
+    return lib;
+}
+
+void r_lib_free(r_lib_t *lib)
+{
+    if (!lib) {
+        return;
+    }
+    r_free_cfg(lib->cfg);
+    free(lib->cfg);
+    free(lib);
+}
+
+r_cfg_t *r_lib_cfg(r_lib_t *lib)
+{
+    return lib->cfg;
+}
+
+void r_lib_register_all(r_lib_t *lib)
+{
+    register_all_protocols(lib->cfg, 0);
+    lib->prepared = 0;
+}
+
+int r_lib_register_protocol(r_lib_t *lib, unsigned protocol_num, char *arg)
+{
+    r_cfg_t *cfg = lib->cfg;
+    for (int i = 0; i < cfg->num_r_devices; ++i) {
+        if (cfg->devices[i].protocol_num == protocol_num) {
+            register_protocol(cfg, &cfg->devices[i], arg);
+            lib->prepared = 0;
+            return 0;
+        }
+    }
+    print_logf(LOG_ERROR, "Protocol", "Unknown protocol number %u.", protocol_num);
+    return -1;
+}
+
+void r_lib_set_frequency(r_lib_t *lib, uint32_t frequency)
+{
+    r_cfg_t *cfg = lib->cfg;
+    cfg->frequency[0]     = frequency;
+    cfg->frequencies      = 1;
+    cfg->center_frequency = frequency;
+}
+
+// pack the decoders registered since the last push, and enable the FM demod if one needs it
+static void lib_prepare(r_lib_t *lib)
+{
+    if (lib->prepared) {
+        return;
+    }
+    struct dm_state *demod = lib->cfg->demod;
+    r_pack_decoders(lib->cfg);
+    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL) {
+            demod->enable_FM_demod = 1;
+        }
+    }
+    lib->prepared = 1;
+}
+
+static unsigned format_sample_size(baseband_format_t format)
+{
+    switch (format) {
+    case BASEBAND_CS16:
+        return 4;
+    case BASEBAND_CF32:
+        return 8;
+    default:
+        return 2; // CU8, CS8
+    }
+}
+
+int r_lib_push_iq(r_lib_t *lib, void const *iq_buf, size_t n_samples, baseband_format_t format)
+{
+    r_cfg_t *cfg           = lib->cfg;
+    struct dm_state *demod = cfg->demod;
+
+    lib_prepare(lib);
+    if (!n_samples) {
+        return 0;
+    }
+    demod->sample_format = format;
+    demod->sample_size   = format_sample_size(format);
+    get_time_now(&demod->now);
+    r_reserve_demod_buffers(cfg, n_samples);
+
+    unsigned fpdm = cfg->fsk_pulse_detect_mode;
+    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
+        fpdm = cfg->center_frequency > FSK_PULSE_DETECTOR_LIMIT ? FSK_PULSE_DETECT_NEW : FSK_PULSE_DETECT_OLD;
+    }
+    float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
+
+    // the FSK pulse detector only reads the FM of the pulses
+    baseband_demod_fused(&demod->lowpass_filter_state, &demod->demod_FM_state, iq_buf, format, demod->use_mag_est,
+            demod->am_buf, NULL, n_samples, cfg->samp_rate, low_pass);
+    if (demod->enable_FM_demod) {
+        baseband_demod_FM_carrier(&demod->demod_FM_state, iq_buf, format, demod->am_buf, pulse_detect_carrier_level(demod->pulse_detect),
+                demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+    }
+
+    int events = 0;
+    for (;;) {
+        int package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, (int)n_samples,
+                cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
+        if (package_type == PULSE_DATA_OOK) {
+            calc_rssi_snr(cfg, &demod->pulse_data);
+            events += run_ook_demods(&demod->ook_devs, &demod->pulse_data, &demod->slicer_cache, NULL);
+        }
+        else if (package_type == PULSE_DATA_FSK) {
+            calc_rssi_snr(cfg, &demod->fsk_pulse_data);
+            events += run_fsk_demods(&demod->fsk_devs, &demod->fsk_pulse_data, &demod->slicer_cache, NULL);
+        }
+        else {
+            break;
+        }
+    }
+    cfg->input_pos += n_samples;
+    return events;
+}
+
+int r_lib_push_pulses(r_lib_t *lib, pulse_data_t *pulses, int fsk)
+{
+    struct dm_state *demod = lib->cfg->demod;
+
+    lib_prepare(lib);
+    get_time_now(&demod->now);
+    if (fsk) {
+        return run_fsk_demods(&demod->fsk_devs, pulses, &demod->slicer_cache, NULL);
+    }
+    return run_ook_demods(&demod->ook_devs, pulses, &demod->slicer_cache, NULL);
+}
+
+data_t const *r_lib_event_find(data_t const *event, char const *key)
+{
+    for (; event; event = event->next) {
+        if (!strcmp(event->key, key)) {
+            return event;
+        }
+    }
+    return NULL;
+}
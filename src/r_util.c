@@ -11,6 +11,7 @@
 
 #include "r_util.h"
 #include "fatal.h"
+#include "compat_atomic.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -22,6 +23,13 @@ void get_time_now(struct timeval *tv)
         perror("gettimeofday");
 }
 
+int64_t get_time_now_ns(void)
+{
+    struct timeval tv;
+    get_time_now(&tv);
+    return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+}
+
 char *format_time_str(char *buf, char const *format, int with_tz, time_t time_secs)
 {
     time_t etime;
@@ -82,6 +90,58 @@ char *usecs_time_str(char *buf, char const *format, int with_tz, struct timeval
     return buf;
 }
 
+char *cached_time_str(time_str_cache_t *cache, char *buf, char const *format, int with_tz, struct timeval const *tv, int with_usecs)
+{
+    if (!atomic_cas_unsigned(&cache->busy, 0, 1)) {
+        struct timeval t = *tv;
+        if (with_usecs)
+            return usecs_time_str(buf, format, with_tz, &t);
+        return format_time_str(buf, format, with_tz, t.tv_sec);
+    }
+
+    if (!cache->valid || cache->secs != tv->tv_sec || cache->format != format || cache->with_tz != with_tz) {
+        time_t t_secs = tv->tv_sec;
+        struct tm tm_info;
+#ifdef _WIN32 /* MinGW might have localtime_r but apparently not MinGW64 */
+        localtime_s(&tm_info, &t_secs); // win32 doesn't have localtime_r()
+#else
+        localtime_r(&t_secs, &tm_info); // thread-safe
+#endif
+        strftime(cache->date, sizeof(cache->date), format && *format ? format : "%Y-%m-%d %H:%M:%S", &tm_info);
+        cache->tz[0] = '\0';
+        if (with_tz) {
+            strftime(cache->tz, sizeof(cache->tz), "%z", &tm_info);
+            if (!strcmp(cache->tz, "+0000"))
+                strcpy(cache->tz, "Z"); // NOLINT
+        }
+        cache->secs    = tv->tv_sec;
+        cache->format  = format;
+        cache->with_tz = with_tz;
+        cache->valid   = 1;
+    }
+
+    // the date, the usecs patched in as digits, and the offset
+    size_t l = strlen(cache->date);
+    memcpy(buf, cache->date, l);
+    if (with_usecs && l + 7 < LOCAL_TIME_BUFLEN) {
+        long usecs = (long)tv->tv_usec;
+        buf[l] = '.';
+        for (int i = 6; i > 0; --i) {
+            buf[l + i] = (char)('0' + usecs % 10);
+            usecs /= 10;
+        }
+        l += 7;
+    }
+    size_t tz_len = strlen(cache->tz);
+    if (l + tz_len >= LOCAL_TIME_BUFLEN)
+        tz_len = LOCAL_TIME_BUFLEN - 1 - l;
+    memcpy(buf + l, cache->tz, tz_len);
+    buf[l + tz_len] = '\0';
+
+    atomic_store_release(&cache->busy, 0);
+    return buf;
+}
+
 char *sample_pos_str(float sample_file_pos, char *buf)
 {
     snprintf(buf, LOCAL_TIME_BUFLEN, "@%fs", sample_file_pos);
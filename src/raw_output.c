@@ -15,11 +15,11 @@
 
 /* generic raw_output */
 
-void raw_output_frame(struct raw_output *output, uint8_t const *data, uint32_t len)
+void raw_output_frame(struct raw_output *output, uint8_t const *data, uint32_t len, uint64_t offset)
 {
     if (!output)
         return;
-    output->output_frame(output, data, len);
+    output->output_frame(output, data, len, offset);
 }
 
 void raw_output_free(struct raw_output *output)
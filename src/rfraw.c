@@ -10,29 +10,29 @@
 */
 
 #include "rfraw.h"
+#include "histogram.h"
 #include "fatal.h"
+#include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
+// the value of each hex digit plus one, zero for all other chars
+static signed char const hex_digit_values[256] = {
+        ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+        ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+        ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+        ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
+
 static int hexstr_get_nibble(char const **p)
 {
     if (!p || !*p || !**p) return -1;
     while (**p == ' ' || **p == '\t' || **p == '-' || **p == ':') ++*p;
 
-    int c = **p;
-    if (c >= '0' && c <= '9') {
-        ++*p;
-        return c - '0';
-    }
-    if (c >= 'A' && c <= 'F') {
+    int v = hex_digit_values[(unsigned char)**p] - 1;
+    if (v >= 0)
         ++*p;
-        return c - 'A' + 10;
-    }
-    if (c >= 'a' && c <= 'f') {
-        ++*p;
-        return c - 'a' + 10;
-    }
-
-    return -1;
+    return v;
 }
 
 static int hexstr_get_byte(char const **p)
@@ -148,10 +148,12 @@ static bool parse_rfraw(pulse_data_t *data, char const **p)
                 data->gap[data->num_pulses] = 0;
                 data->num_pulses++;
             }
+            pulse_data_reserve(data, data->num_pulses + 1);
             data->pulse[data->num_pulses] = bins[w & 7];
             pulse_needed = false;
         }
         else { // gap
+            pulse_data_reserve(data, data->num_pulses + 1);
             if (pulse_needed) {
                 data->pulse[data->num_pulses] = 0;
             }
@@ -163,7 +165,8 @@ static bool parse_rfraw(pulse_data_t *data, char const **p)
     //data->gap[data->num_pulses - 1] = 3000; // TODO: extend last gap?
 
     unsigned pkt_pulses = data->num_pulses - prev_pulses;
-    for (int i = 1; i < repeats && data->num_pulses + pkt_pulses <= PD_MAX_PULSES; ++i) {
+    for (int i = 1; i < repeats && data->num_pulses + pkt_pulses <= pulse_data_max_pulses(data); ++i) {
+        pulse_data_reserve(data, data->num_pulses + pkt_pulses);
         memcpy(&data->pulse[data->num_pulses], &data->pulse[prev_pulses], pkt_pulses * sizeof (*data->pulse));
         memcpy(&data->gap[data->num_pulses], &data->gap[prev_pulses], pkt_pulses * sizeof (*data->pulse));
         data->num_pulses += pkt_pulses;
@@ -193,3 +196,83 @@ bool rfraw_parse(pulse_data_t *data, char const *p)
     //pulse_data_print(data);
     return true;
 }
+
+#define RFRAW_MAX_BINS 8
+
+// merge the closest neighbour bins, the bins are sorted by mean and don't overlap
+static void merge_closest_bins(histogram_t *hist)
+{
+    unsigned best     = 0;
+    double best_ratio = 0.0;
+    for (unsigned i = 0; i + 1 < hist->bins_count; ++i) {
+        double ratio = (double)hist->bins[i + 1].mean / (hist->bins[i].mean > 0 ? hist->bins[i].mean : 1);
+        if (i == 0 || ratio < best_ratio) {
+            best       = i;
+            best_ratio = ratio;
+        }
+    }
+    hist_bin_t *a       = &hist->bins[best];
+    hist_bin_t const *b = &hist->bins[best + 1];
+    a->count += b->count;
+    a->sum += b->sum;
+    a->mean = a->sum / (int)a->count;
+    a->max  = b->max;
+    histogram_delete_bin(hist, best + 1);
+}
+
+static char *hexstr_put_byte(char *p, unsigned v)
+{
+    static char const hex[] = "0123456789ABCDEF";
+    *p++ = hex[(v >> 4) & 0xf];
+    *p++ = hex[v & 0xf];
+    return p;
+}
+
+char *rfraw_encode(pulse_data_t const *data)
+{
+    unsigned num = data->num_pulses;
+    if (!num || !data->sample_rate)
+        return NULL;
+
+    // the pulses followed by the gaps
+    int *timings = malloc(2 * num * sizeof(*timings));
+    if (!timings) {
+        WARN_MALLOC("rfraw_encode()");
+        return NULL;
+    }
+    memcpy(timings, data->pulse, num * sizeof(*timings));
+    memcpy(&timings[num], data->gap, num * sizeof(*timings));
+    histogram_t hist;
+    histogram_cluster(&hist, timings, 2 * num, 0.2f);
+    free(timings);
+    while (hist.bins_count > RFRAW_MAX_BINS) {
+        merge_closest_bins(&hist);
+    }
+
+    // header, bin count, bins, a byte for each pulse and gap, sync, and the terminator
+    char *str = malloc(2 * (3 + 2 * hist.bins_count + num + 1) + 1);
+    if (!str) {
+        WARN_MALLOC("rfraw_encode()");
+        return NULL;
+    }
+    double to_us = 1e6 / data->sample_rate;
+    char *p      = str;
+    p            = hexstr_put_byte(p, 0xaa);
+    p            = hexstr_put_byte(p, 0xb1);
+    p            = hexstr_put_byte(p, hist.bins_count);
+    for (unsigned b = 0; b < hist.bins_count; ++b) {
+        double w   = hist.bins[b].mean * to_us + 0.5;
+        unsigned v = w < USHRT_MAX ? (unsigned)w : USHRT_MAX;
+        p = hexstr_put_byte(p, v >> 8);
+        p = hexstr_put_byte(p, v & 0xff);
+    }
+    for (unsigned i = 0; i < num; ++i) {
+        // every width is in the range of a bin
+        int pb = histogram_find_bin_index(&hist, data->pulse[i]);
+        int gb = histogram_find_bin_index(&hist, data->gap[i]);
+        p = hexstr_put_byte(p, 0x80 | (pb < 0 ? 0 : pb) << 4 | (gb < 0 ? 0 : gb));
+    }
+    p  = hexstr_put_byte(p, 0x55);
+    *p = '\0';
+    return str;
+}
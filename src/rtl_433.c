@@ -26,6 +26,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 
 #include "rtl_433.h"
@@ -33,7 +34,15 @@
 #include "r_device.h"
 #include "r_api.h"
 #include "sdr.h"
+#include "demod_thread.h"
+#include "worker_pool.h"
+#include "decoder_pool.h"
+#include "package_queue.h"
+#include "channelizer.h"
+#include "decimator.h"
+#include "spectrum.h"
 #include "baseband.h"
+#include "convert.h"
 #include "pulse_analyzer.h"
 #include "pulse_detect.h"
 #include "pulse_detect_fsk.h"
@@ -41,18 +50,46 @@
 #include "rfraw.h"
 #include "data.h"
 #include "raw_output.h"
+#include "pulse_net.h"
+#include "pulse_archive.h"
+#include "pulse_recorder.h"
+#include "batch_net.h"
+#include "sigmf.h"
+#include "hop_scheduler.h"
+#include "duty_cycle.h"
+#include "load_shed.h"
+#include "buf_tune.h"
+#include "event_throttle.h"
+#include "event_merge.h"
+#include "decoder_usage.h"
+#include "sensor_state.h"
+#include "freq_plan.h"
+#include "file_zstd.h"
+#include "file_writer.h"
+#include "pipe_reader.h"
 #include "r_util.h"
 #include "optparse.h"
 #include "abuf.h"
 #include "fileformat.h"
 #include "samp_grab.h"
+#include "sample_buf.h"
 #include "am_analyze.h"
 #include "confparse.h"
 #include "term_ctl.h"
 #include "compat_paths.h"
+#include "compat_time.h"
+#include "compat_atomic.h"
 #include "logger.h"
+#include "log_ring.h"
 #include "fatal.h"
 #include "write_sigrok.h"
+#include "r_trace.h"
+#include "trace_event.h"
+#include "output_async.h"
+#include "output_filter.h"
+#include "warm_start.h"
+#include "thread_sched.h"
+#include "mem_acct.h"
 #include "mongoose.h"
 
 #ifdef _WIN32
@@ -65,6 +102,11 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#if !defined(_WIN32) && !defined(ESP32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#endif
 
 #ifndef _MSC_VER
 #include <getopt.h>
@@ -122,6 +164,12 @@ static void delay_timer_wait(delay_timer_t *delay_timer, unsigned delay_us)
         usleep(delay_us - elapsed_us);
 }
 
+/// Time of a number of samples in ns, without overflow for long inputs.
+static int64_t samples_to_ns(uint64_t samples, uint32_t samp_rate)
+{
+    return (int64_t)(samples / samp_rate) * 1000000000 + (int64_t)(samples % samp_rate * 1000000000 / samp_rate);
+}
+
 r_device *flex_create_device(char *spec); // maybe put this in some header file?
 
 static void print_version(void)
@@ -151,18 +199,38 @@ static void usage(int exit_code)
             "  [-c <path>] Read config options from a file\n"
             "\t\t= Tuner options =\n"
             "  [-d <RTL-SDR USB device index> | :<RTL-SDR USB device serial> | <SoapySDR device query> | rtl_tcp | help]\n"
+            "       (can be used multiple times to receive from multiple devices)\n"
             "  [-g <gain> | help] (default: auto)\n"
             "  [-t <settings>] apply a list of keyword=value settings to the SDR device\n"
             "       e.g. for SoapySDR -t \"antenna=A,bandwidth=4.5M,rfnotch_ctrl=false\"\n"
-            "       for RTL-SDR use \"direct_samp[=1]\", \"offset_tune[=1]\", \"digital_agc[=1]\", \"biastee[=1]\"\n"
-            "  [-f <frequency>] Receive frequency(s) (default: %d Hz)\n"
-            "  [-H <seconds>] Hop interval for polling of multiple frequencies (default: %d seconds)\n"
+            "       for RTL-SDR use \"direct_samp[=1]\", \"offset_tune[=1]\", \"digital_agc[=1]\", \"biastee[=1]\", \"zero_copy[=1]\"\n"
+            "  [-f <frequency>[:<protocol>,...]] Receive frequency(s) (default: %d Hz)\n"
+            "       optionally only run the listed protocols there, otherwise the decoders of its band\n"
+            "  [-H <seconds> | adaptive] Hop interval for polling of multiple frequencies (default: %d seconds)\n"
+            "       adaptive shares the hop intervals by the activity of each frequency and returns for periodic transmitters\n"
             "  [-p <ppm_error>] Correct rtl-sdr tuner frequency offset error (default: 0)\n"
             "  [-s <sample rate>] Set sample rate (default: %d Hz)\n"
-            "  [-D quit | restart | pause | manual] Input device run mode options (default: quit).\n"
+            "  [-N <channels>[:gpu][:gate[=<dB>]]] Split the sample rate into this many channels and decode each one\n"
+            "       e.g. -s 2400k -N 8 decodes eight channels 300 kHz apart, channel rate is 600 kHz\n"
+            "       Use \"gpu\" to split the channels on a GPU with OpenCL, the CPU is used if there is none\n"
+            "       Use \"gate\" to only demodulate channels with a signal over the noise floor (default: 10 dB)\n"
+            "  [-Z <factor>[:<shift>]] Decimate the sample rate by a power of two, optionally shifting the band by a frequency offset\n"
+            "       e.g. -f 433.62M -s 2048k -Z 8:300k decodes 433.92 MHz at 256 kHz, away from the DC spike\n"
+            "  [-P] Plan the center frequencies of all input devices so each frequency (-f) is in the passband of one,\n"
+            "       away from the DC spike, only a device left with several frequencies hops\n"
+            "  [-L] Low latency mode, small SDR transfers that are merged into larger blocks while the demodulator is busy\n"
+            "       The delay from the end of a package to the output is reported with -M stats\n"
+            "  [-b <bytes>[:<count>] | tune[=<s>]] Size and count of the SDR transfers (default: 262144, count of the SDR)\n"
+            "       tune starts with low latency transfers, measures the jitter and load for <s> seconds (default: 60), then restarts with the shortest safe ones\n"
+            "  [-D quit | restart | pause | manual] Input device run mode options (default: quit).\n",
+            DEFAULT_FREQUENCY, DEFAULT_HOP_TIME, DEFAULT_SAMPLE_RATE);
+    // split in parts, the string is longer than C99 compilers need to support
+    term_help_fprintf(exit_code ? stderr : stdout,
             "\t\t= Demodulator options =\n"
             "  [-R <device> | help] Enable only the specified device decoding protocol (can be used multiple times)\n"
             "       Specify a negative number to disable a device decoding protocol (can be used multiple times)\n"
+            "  [-R shard=<k>/<n>[:<costs>]] Keep only shard k of n of the decoders, split by the decoder costs in a file of \"<protocol> <cost>\" lines\n"
+            "       e.g. run n processes on the pulses of one receiver with -F pulses:udp://host:port and -r pulses:udp://:port\n"
             "  [-X <spec> | help] Add a general purpose decoder (prepend -R 0 to disable all decoders)\n"
             "  [-Y auto | classic | minmax] FSK pulse detector mode.\n"
             "  [-Y level=<dB level>] Manual detection level used to determine pulses (-1.0 to -30.0) (0=auto).\n"
@@ -171,34 +239,52 @@ static void usage(int exit_code)
             "  [-Y autolevel] Set minlevel automatically based on average estimated noise.\n"
             "  [-Y squelch] Skip frames below estimated noise level to reduce cpu load.\n"
             "  [-Y ampest | magest] Choose amplitude or magnitude level estimator.\n"
+            "  [-Y amfilter=<order>] AM low pass filter order, 1 (default) or a steeper 2, 4, 6, 8 at more cpu load.\n"
+            "  [-Y kernels=<name>] Use the scalar reference, sse2, avx2, or neon baseband and conversion kernels (default: the best the CPU supports).\n"
+            "  [-Y maxpulses=<n>] Maximum number of pulses in a package (default: 1200), raise for long frames.\n"
+            "  [-Y maxgap=<ms>] Gap that ends a package (default: 100 ms, with -R the longest reset limit of the decoders).\n"
+            "  [-Y dedup[=<ms>]] Drop repeats of a message a decoder output in the last <ms> (default: off, 1000 without ms).\n"
+            "  [-Y early] Decode the unfinished packages with the decoders that opt in, output their first event before the package ends (default: off).\n"
+            "  [-Y budget=<us>] Decode time per package, past it only the decoders with recent events run (default: off).\n"
+            "  [-Y pipeline[=<n>]] Decode on a thread of its own, up to <n> packages behind the detection (default: off, 16 without n).\n"
+            "  [-Y tones=<deviation>[@<frequency>]] Detect FSK of a known deviation by its two tones instead of the FM demod (default: off).\n"
+            "  [-Y shed[=<high>[:<low>]]] Shed FM demod, fallback decoders, then noise frames over a realtime load (default: 0.9:0.6).\n"
+            "  [-Y warmstart=<file>] Keep the noise floor and detector levels of each input and frequency in a file, restored on start (default: off).\n"
+            "  [-j <threads>] Demodulate and decode the channels (-N), or the input files (-r) with large files split in parts, on this many threads (default: 1).\n"
+            "  [-j batch:tcp://[bind]:port] Hand the input files to workers with -r batch:tcp://host:port, output their events in input order.\n"
+            "  [-J <threads>] Run the decoders of each priority on this many threads (default: 1).\n");
+    term_help_fprintf(exit_code ? stderr : stdout,
             "\t\t= Analyze/Debug options =\n"
             "  [-A] Pulse Analyzer. Enable pulse analysis and decode attempt.\n"
             "       Disable all decoders with -R 0 if you want analyzer output only.\n"
+            "  [-A batch] Aggregate the pulse analysis of all packages, print a summary at exit.\n"
             "  [-y <code>] Verify decoding of demodulated test data (e.g. \"{25}fb2dd58\") with enabled devices\n"
             "\t\t= File I/O options =\n"
-            "  [-S none | all | unknown | known] Signal auto save. Creates one file per signal.\n"
+            "  [-S none | all | unknown | known][,pre=<ms>][,post=<ms>] Signal auto save. Creates one file per signal.\n"
             "       Note: Saves raw I/Q samples (uint8 pcm, 2 channel). Preferred mode for generating test files.\n"
+            "       Saves pre and post (or pad for both) ms around the signal, default is an eighth of a buffer.\n"
             "  [-r <filename> | help] Read data from input file instead of a receiver\n"
             "  [-w <filename> | help] Save data stream to output file (a '-' dumps samples to stdout)\n"
             "  [-W <filename> | help] Save data stream to output file, overwrite existing file\n"
             "\t\t= Data output options =\n"
-            "  [-F log | kv | json | csv | mqtt | influx | syslog | trigger | rtl_tcp | http | null | help] Produce decoded output in given format.\n"
+            "  [-F log | kv | json | csv | cbor | msgpack | arrow | mqtt | influx | http_post | syslog | unix | trigger | rtl_tcp | shm | pulses | http | null | help] Produce decoded output in given format.\n"
             "       Append output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "       Specify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
             "  [-M time[:<options>] | protocol | level | noise[:<secs>] | stats | bits | help] Add various meta data to each output.\n"
             "  [-K FILE | PATH | <tag> | <key>=<tag>] Add an expanded token or fixed tag to every output line.\n"
             "  [-C native | si | customary] Convert units in decoded output.\n"
+            "  [-u <name>] Start a tenant pipeline, the -R, -X, -C, and -F options that follow are its own.\n"
+            "       A tenant pipeline only has the decoders and outputs it lists, it shares the input and the slicing.\n"
             "  [-n <value>] Specify number of samples to take (each sample is an I/Q pair)\n"
             "  [-T <seconds>] Specify number of seconds to run, also 12:34 or 1h23m45s\n"
             "  [-E hop | quit] Hop/Quit after outputting successful event(s)\n"
             "  [-h] Output this usage help and exit\n"
-            "       Use -d, -g, -R, -X, -F, -M, -r, -w, or -W without argument for more help\n\n",
-            DEFAULT_FREQUENCY, DEFAULT_HOP_TIME, DEFAULT_SAMPLE_RATE);
+            "       Use -d, -g, -R, -X, -F, -M, -r, -w, or -W without argument for more help\n\n");
     exit(exit_code);
 }
 
 _Noreturn
-static void help_protocols(r_device *devices, unsigned num_devices, int exit_code)
+static void help_protocols(r_device const *devices, unsigned num_devices, int exit_code)
 {
     unsigned i;
     char disabledc;
@@ -238,8 +324,21 @@ static void help_device_selection(void)
             "  [-d \"\"] Open default SoapySDR device\n"
             "  [-d driver=rtlsdr] Open e.g. specific SoapySDR device\n"
             "\tTo set gain for SoapySDR use -g ELEM=val,ELEM=val,... e.g. -g LNA=20,TIA=8,PGA=2 (for LimeSDR).\n"
+            "  [-d driver=lime,channel=1] Open one RX channel of e.g. a SoapySDR device with two\n"
+            "\tThe channels of a device opened with a repeated -d are read in one stream, each tuned on its own,\n"
+            "\tthe channels share the sample rate, e.g. -d driver=lime,channel=0 -f 433.92M -d driver=lime,channel=1 -f 868.3M\n"
             "  [-d rtl_tcp[:[//]host[:port]] (default: localhost:1234)\n"
-            "\tSpecify host/port to connect to with e.g. -d rtl_tcp:127.0.0.1:1234\n");
+            "\tSpecify host/port to connect to with e.g. -d rtl_tcp:127.0.0.1:1234\n"
+            "\tAdd ,compress[=zstd|4bit] to ask a rtl_433 server for a compressed stream, a stock rtl_tcp sends raw samples\n"
+            "\tAdd ,rcvbuf=<size> (e.g. 4M) for a larger socket buffer and ,reconnect[=<seconds>] (default: 30) to reconnect in place\n"
+            "  [-d synth[:sensors=<n>,every=<s>,mix=nexus+acurite+tpms,rate=<S/s>|max,noise=<dB>,level=<dB>,seed=<n>]]\n"
+            "\tGenerate simulated sensors in noise for load tests (default: 100 sensors every 30 s of all templates),\n"
+            "\tpaced to the sample rate unless rate is given, e.g. -d synth:sensors=1000,rate=max -s 1M\n"
+            "\tRepeat -d to receive from multiple devices at once, events are then tagged with the \"input\".\n"
+            "\tTuner options (-f -H -g -t -p -s -N -Z) following a repeated -d apply to that device,\n"
+            "\tunset options default to the ones given before, e.g. -d 0 -f 433.92M -d 1 -f 868M\n"
+            "\tWith -P the frequencies given before the second -d are planned over all devices without their own -f,\n"
+            "\te.g. -P -f 433.92M -f 868.3M -f 915M -d 0 -s 1M -d 1 -s 1M\n");
     exit(0);
 }
 
@@ -275,14 +374,23 @@ static void help_output(void)
 {
     term_help_fprintf(stdout,
             "\t\t= Output format option =\n"
-            "  [-F log|kv|json|csv|mqtt|influx|syslog|trigger|rtl_tcp|http|null] Produce decoded output in given format.\n"
+            "  [-F log|kv|json|csv|cbor|msgpack|arrow|mqtt|influx|http_post|syslog|unix|trigger|rtl_tcp|shm|pulses|http|null] Produce decoded output in given format.\n"
             "\tWithout this option the default is LOG and KV output. Use \"-F null\" to remove the default.\n"
             "\tAppend output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
+            "\tPrint log, kv, json, csv, cbor, msgpack, arrow, syslog, or unix output on its own thread\n"
+            "\twith a queue of 256 events, e.g. -F json,queue=drop-oldest,depth=1000:log.json\n"
+            "\tQueue options are: queue[=block|drop-oldest|drop-newest] (default: block), depth=<events>\n"
+            "\tJSON and CSV files are flushed on each event, buffer with e.g. -F json,flush=10s:log.json\n"
+            "\tFlush options are: flush=<ms>ms|<secs>s|<KiB>k, fsync (sync to disk on each flush)\n"
+            "\tAny event output takes a filter, e.g. -F 'mqtt://host,filter=model~\"Acurite.*\"&&id==1234'\n"
+            "\tFilters compare keys with ==, !=, <, <=, >, >=, ~ (match), !~ and combine with !, &&, ||, ( )\n");
+    term_help_fprintf(stdout,
             "  [-F mqtt[s][:[//]host[:port][,<options>]] (default: localhost:1883)\n"
             "\tSpecify MQTT server with e.g. -F mqtt://localhost:1883\n"
             "\tDefault user and password are read from MQTT_USERNAME and MQTT_PASSWORD env vars.\n"
             "\tAdd MQTT options with e.g. -F \"mqtt://host:1883,opt=arg\"\n"
-            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], <format>[=topic]\n"
+            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], qos=0|1, window=<n>, changed[=0|1], <format>[=topic]\n"
+            "\tWith qos=1 at most \"window\" messages (default: 64) wait for acknowledgement, changed=1 skips unchanged device info\n"
             "\tSupported MQTT formats: (default is all)\n"
             "\t  availability: posts availability (online/offline)\n"
             "\t  events: posts JSON event data, default \"<base>/events\"\n"
@@ -293,20 +401,59 @@ static void help_output(void)
             "\tAny topic string overrides the base topic and will expand keys like [/model]\n"
             "\tE.g. -F \"mqtt://localhost:1883,user=USERNAME,pass=PASSWORD,retain=0,devices=rtl_433[/id]\"\n"
             "\tFor TLS use e.g. -F \"mqtts://host,tls_cert=<path>,tls_key=<path>,tls_ca_cert=<path>\"\n"
+            "\tFor MQTT-SN over UDP use e.g. -F \"mqttsn://gateway:1884,keepalive=60\" (default port: 1884), the same formats\n"
+            "\t  are published with qos=0, each topic is registered once and then published by its topic id\n"
             "\tWith MQTT each rtl_433 instance needs a distinct driver selection. The MQTT Client-ID is computed from the driver string.\n"
             "\tIf you use multiple RTL-SDR, perhaps set a serial and select by that (helps not to get the wrong antenna).\n"
             "  [-F influx[:[//]host[:port][/<path and options>]]\n"
             "\tSpecify InfluxDB 2.0 server with e.g. -F \"influx://localhost:9999/api/v2/write?org=<org>&bucket=<bucket>,token=<authtoken>\"\n"
             "\tSpecify InfluxDB 1.x server with e.g. -F \"influx://localhost:8086/write?db=<db>&p=<password>&u=<user>\"\n"
             "\t  Additional parameter -M time:unix:usec:utc for correct timestamps in InfluxDB recommended\n"
+            "\tInfluxDB options are: token=<authtoken>, batch=<lines> (default: 5000), batch_size=<bytes> (default: 1M),\n"
+            "\t  flush=<ms>ms|<secs>s (wait to fill a batch, default: 0), buffer=<bytes> (default: 16M), gzip\n"
+            "\tThe connection is kept alive, failed batches are sent again, the oldest lines are dropped if the buffer is full\n");
+    term_help_fprintf(stdout,
+            "  [-F http_post://host[:port]/<path>[,<options>] | https_post://...]\n"
+            "\tPost batches of events to a webhook with e.g. -F \"https_post://example.com/hook,token=<token>,batch=50,flush=1s\"\n"
+            "\tWebhook options are: format=array|ndjson (default: array), token=<bearer token>, header=\"<name>: <value>\",\n"
+            "\t  batch=<events> (default: 100), batch_size=<bytes> (default: 256k), flush, buffer, gzip as for InfluxDB\n"
             "  [-F syslog[:[//]host[:port] (default: localhost:514)\n"
             "\tSpecify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
+            "\tSyslog options are: batch=<n> (send up to 64 events at once), flush=<ms>ms|<secs>s (wait to fill a batch),\n"
+            "\t  raw (send only the JSON, without the RFC 5424 header), e.g. -F syslog:127.0.0.1:1514,batch=32,flush=50ms\n"
+            "  [-F unix[:<path>[,type=seqpacket|dgram][,clients=<n>]]] (default: /tmp/rtl_433.sock)\n"
+            "\tSend the JSON of each event as one message to each subscriber of a Unix domain socket, e.g. -F unix:/run/rtl_433.sock\n"
+            "\t  seqpacket subscribers connect, dgram subscribers bind a socket and send any datagram to subscribe,\n"
+            "\t  up to <n> subscribers (default: 16), the events are dropped for a subscriber that does not keep up\n"
+            "  [-F cbor[:<filename>|:udp:host:port] | msgpack[:<filename>|:udp:host:port]]\n"
+            "\tWrite binary CBOR or MessagePack events to a file, CBOR sends the keys once per 100 events\n"
+            "\tSend one event per UDP datagram with e.g. -F msgpack:udp:127.0.0.1:5515\n"
+            "  [-F arrow:<filename>]\n"
+            "\tWrite an Arrow IPC file, with columns as for CSV, in batches of 1024 events\n"
             "  [-F trigger:/path/to/file]\n"
             "\tAdd an output that writes a \"1\" to the path for each event, use with a e.g. a GPIO\n"
             "  [-F rtl_tcp[:[//]bind[:port]] (default: localhost:1234)\n"
             "\tAdd a rtl_tcp pass-through server\n"
+            "\trtl_tcp options are: control (clients may change SDR parameters), depth=<frames> (default: 16),\n"
+            "\t  each client is sent from its own queue, the oldest frames are dropped for a slow client\n"
+            "\t  compress[=zstd|4bit] (clients may ask for a compressed stream, 4bit sends noise frames with 4 bits per sample)\n"
+            "  [-F shm[:<name>][,size=<bytes>]] (default: /rtl_433, size=16M)\n"
+            "\tPublish I/Q frames in a shared memory ring for local readers, e.g. /dev/shm/rtl_433\n"
+            "\t  the writer never waits, a slow reader detects overwritten frames, see output_shm.h\n"
+            "\trtl_tcp and shm also take squelch[=<pre>:<post>] (default: 1:1) to only send frames with activity\n"
+            "\t  and the given frames before and after, shm frames carry the sample offset to restore the timing\n"
+            "  [-F pulses:udp://host:port] Send each package as a binary datagram, for -r pulses:udp://[bind]:port\n");
+    term_help_fprintf(stdout,
+            "  [-F fusion:udp://group:port[,window=<ms>][,ttl=<n>]] (default: window=300, ttl=1)\n"
+            "\tFuse the events with other rtl_433 receivers in the multicast group, e.g. 239.255.43.3:4433,\n"
+            "\t  each event is held for the window and only output by the receiver with the best RSSI\n"
             "  [-F http[:[//]bind[:port]] (default: 0.0.0.0:8433)\n"
-            "\tAdd a HTTP API server, a UI is at e.g. http://localhost:8433/\n");
+            "\tAdd a HTTP API server, a UI is at e.g. http://localhost:8433/\n"
+            "\tHTTP options are: buffer=<bytes> (events queued for a slow client before the oldest are dropped, default: 1M),\n"
+            "\t  history=<bytes> (events kept to replay, default: 64k), resume with \"Last-Event-ID\" or \"?since=<id>\"\n"
+            "\t  store=<dir> (keep the events in segment files for \"/history?from=<secs>&to=<secs>&model=<model>&id=<id>\"),\n"
+            "\t  segment=<bytes> (size of a segment file, default: 16M), segments=<n> (segment files kept, default: 16)\n"
+            "\tThe event streams are compressed for clients accepting gzip, deflate, or permessage-deflate (with zlib)\n");
     exit(0);
 }
 
@@ -348,11 +495,41 @@ static void help_meta(void)
             "\t\t(this may also be accomplished by invocation with TZ environment variable set).\n"
             "\t\t\"usec\" and \"utc\" can be combined with other options, eg. \"time:iso:utc\" or \"time:unix:usec\".\n"
             "\tUse \"replay[:N]\" to replay file inputs at (N-times) realtime.\n"
+            "\tUse \"replay:max[:<start>]\" to replay file inputs as fast as possible and report the throughput,\n"
+            "\t  the time of the samples counts from <start> in unix seconds (default: the file time minus its length).\n"
+            "\tUse \"bench[:<repeats>]\" to decode the file inputs <repeats> times (default: 10) as fast as possible without output,\n"
+            "\t  and report the samples/s, packages/s, events/s, and the time in the baseband, pulse detect, and decode stages.\n");
+    term_help_fprintf(stdout,
+            "\tUse \"startup\" to log the time of each startup phase up to the first sample.\n"
+            "\tUse \"autotune[:<file>]\" to time the baseband kernel variants at startup and use the fastest of each,\n"
+            "\t  the choice is kept in <file> for the next start on the same CPU and build. The stats report the kernels.\n"
+            "\tUse \"threads:<thread>=<cpus>[/fifo|rr[/<priority>]],...\" to pin the acquire, demod, output, http,\n"
+            "\t  or worker threads to CPUs and request real-time scheduling, e.g. \"threads:acquire=0/fifo/50,demod=1,output=2-3\".\n"
+            "\tUse \"memory:<subsystem>=<bytes>,...\" to set soft limits of the network, http, influx, mqtt, or decoders memory,\n"
+            "\t  over the limit the subsystem sheds memory, e.g. \"memory:http=2M,network=4M\". The stats report the memory.\n"
+            "\tUse \"duty[:<listen>[:<every>]]\" to learn the period of each sensor and only demodulate the input when one is due,\n"
+            "\t  with a full listen for new sensors of <listen> (default: 3m) every <every> (default: 1h), e.g. \"duty:5m:2h\".\n"
+            "\tUse \"throttle[:<interval>[:latest|avg|min|max]]\" to output each sensor (by model, id, and channel) at most once\n"
+            "\t  per <interval> (default: 1m), with the latest values or their average, minimum, or maximum, e.g. \"throttle:5m:avg\".\n"
+            "\tUse \"recorder[:<time>[:<bytes>]]\" to keep the packages of all inputs, decoded or not, for <time> (default: 10m)\n"
+            "\t  in up to <bytes> (default: 4M), to dump or re-decode with the HTTP \"/pulses\" and \"/redecode\", e.g. \"recorder:1h:16M\".\n"
+            "\tUse \"order[:<window>]\" to output the events of all receivers, channels, and input files in the order of their\n"
+            "\t  sample time, an input lagging more than <window> (default: 1s) behind the others is not waited for.\n"
+            "\tUse \"devices[:<count>]\" to keep the latest event of up to <count> sensors (default: 1000) for the HTTP \"/devices\",\n"
+            "\t  the sensor not heard the longest is evicted first.\n"
             "\tUse \"protocol\" / \"noprotocol\" to output the decoder protocol number meta data.\n"
             "\tUse \"level\" to add Modulation, Frequency, RSSI, SNR, and Noise meta data.\n"
+            "\tUse \"raw[:all|unknown|known][:rfraw]\" to output the pulses of all packages, or those without or with events,\n"
+            "\t  as an array of the widths in us, or with \"rfraw\" compact as an RfRaw code of up to 8 widths, e.g. \"raw:unknown:rfraw\".\n"
+            "\tUse \"latency\" to add the delays of the buffer, queue, DSP, and decode stages in us to each event,\n"
+            "\t  and their histograms, and the send delay of queued outputs, to the stats report.\n"
+            "\tUse \"trace:<file>[:<secs>]\" to write the spans of each buffer, decode, and output, and the noise level\n"
+            "\t  and output queue depths to a Chrome trace event JSON file for Perfetto (default: until exit).\n"
             "\tUse \"noise[:<secs>]\" to report estimated noise level at intervals (default: 10 seconds).\n"
             "\tUse \"stats[:[<level>][:<interval>]]\" to report statistics (default: 600 seconds).\n"
-            "\t  level 0: no report, 1: report successful devices, 2: report active devices, 3: report all\n"
+            "\t  level 0: no report, 1: report successful devices, 2: report active devices, 3: report all with the decoder cost\n"
+            "\tUse \"usage[:<file>]\" to record the decodes and the time of each decoder and write a config of the protocols seen\n"
+            "\t  with the time saved to <file> (default: stderr) at exit and on SIGINFO, e.g. \"usage:site.conf\".\n"
             "\tUse \"bits\" to add bit representation to code outputs (for debug).\n");
     exit(0);
 }
@@ -369,13 +546,24 @@ static void help_read(void)
             "\tA sample rate is detected as (fractional) number suffixed with 'k',\n"
             "\t'sps', 'ksps', 'Msps', or 'Gsps'.\n\n"
             "\tFile content and format are detected as parameters, possible options are:\n"
-            "\t'cu8', 'cs16', 'cf32' ('IQ' implied), and 'am.s16'.\n\n"
+            "\t'cu8', 'cs16', 'cf32' ('IQ' implied), and 'am.s16'.\n"
+            "\tPulse data is read from 'ook' text and 'rpa' pulse archives.\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
             "\tforced overrides: am:s16:path/filename.ext\n\n"
+            "\tA directory is read as the sample files below it, in sorted order, e.g. a checkout of rtl_433_tests.\n\n"
             "\tReading from pipes also support format options.\n"
-            "\tE.g reading complex 32-bit float: CU32:-\n");
+            "\tE.g reading complex 32-bit float: CU32:-\n\n"
+            "\tSamples compressed with zstd are read with a 'zst' extension, e.g. path/filename.cu8.zst\n\n"
+            "\tA SigMF recording is read from the 'sigmf-data' (or 'sigmf-meta') file,\n"
+            "\tformat, sample rate, and center frequency are read from the 'sigmf-meta' file.\n\n"
+            "\tA time range is read with a suffix ':start=<time>,len=<time>', e.g. path/filename.cu8:start=90s,len=500ms\n"
+            "\tSamples are read from the offset of the start, a pulse archive counts from its first package.\n\n"
+            "  [-r pulses:udp://[bind]:port] Decode the packages sent by remote rtl_433 with -F pulses:udp://host:port\n"
+            "  [-r batch:tcp://host:port] Decode the files handed out by a coordinator with -j batch:tcp://[bind]:port, send back the events\n"
+            "  [-r codes:<filename> | codes:-] Decode a file of test codes, one per line as with -y,\n"
+            "\te.g. bitbuffer codes \"{25}fb2dd58\" or RfRaw codes \"AAB0...55\", optionally prefixed with \"[<protocol>]\"\n");
     exit(0);
 }
 
@@ -390,11 +578,17 @@ static void help_write(void)
             "\tFile content and format are detected as parameters, possible options are:\n"
             "\t'cu8', 'cs8', 'cs16', 'cf32' ('IQ' implied),\n"
             "\t'am.s16', 'am.f32', 'fm.s16', 'fm.f32',\n"
-            "\t'i.f32', 'q.f32', 'logic.u8', 'ook', and 'vcd'.\n\n"
+            "\t'i.f32', 'q.f32', 'logic.u8', 'logic.rle', 'ook', 'rpa', and 'vcd'.\n\n"
+            "\tA run-length logic dump 'rle' has the states of 'logic.u8' as runs, written per package.\n\n"
+            "\tA pulse archive 'rpa' is a compact indexed binary of the 'ook' pulse data,\n"
+            "\tconvert with e.g. -r path/filename.ook -w path/filename.rpa and back.\n\n"
+            "\tA SigMF recording 'sigmf-data' of 'cu8', 'cs8', 'cs16', or 'cf32' samples is written\n"
+            "\twith a 'sigmf-meta' file, e.g. cs16:path/filename.sigmf-data\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
-            "\tforced overrides: am:s16:path/filename.ext\n");
+            "\tforced overrides: am:s16:path/filename.ext\n\n"
+            "\tSample outputs are compressed with zstd by a 'zst' extension, e.g. path/filename.cu8.zst\n");
     exit(0);
 }
 
@@ -402,6 +596,9 @@ static void reset_sdr_callback(r_cfg_t *cfg)
 {
     struct dm_state *demod = cfg->demod;
 
+    // the queued packages are finished with the frame they belong to
+    package_queue_retire(cfg->package_queue, 1);
+
     get_time_now(&demod->now);
 
     demod->frame_start_ago   = 0;
@@ -411,375 +608,472 @@ static void reset_sdr_callback(r_cfg_t *cfg)
     demod->min_level_auto = 0.0f;
     demod->noise_level    = 0.0f;
 
+    demod->detect_frequency = 0;
+    memset(demod->detect_states, 0, sizeof(demod->detect_states));
+
     baseband_low_pass_filter_reset(&demod->lowpass_filter_state);
     baseband_demod_FM_reset(&demod->demod_FM_state);
+    baseband_demod_tones_reset(&demod->demod_tones_state);
 
     pulse_detect_reset(demod->pulse_detect);
+
+    if (cfg->channelizer) {
+        channelizer_reset(cfg->channelizer);
+    }
+    if (cfg->decimator) {
+        decimator_reset(cfg->decimator);
+    }
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        reset_sdr_callback(*iter);
+    }
 }
 
-static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
+// the kept detector state of a frequency, otherwise a free entry or the one to displace
+static detect_state_t *detect_state_slot(struct dm_state *demod, uint32_t frequency)
+{
+    detect_state_t *free_slot = NULL;
+    for (unsigned i = 0; i < MAX_FREQS; ++i) {
+        if (demod->detect_states[i].frequency == frequency)
+            return &demod->detect_states[i];
+        if (!free_slot && !demod->detect_states[i].frequency)
+            free_slot = &demod->detect_states[i];
+    }
+    return free_slot ? free_slot : &demod->detect_states[frequency % MAX_FREQS];
+}
+
+// switch the noise floor and pulse detector levels to the ones of a new frequency instead of starting over
+static void retune_sdr_callback(r_cfg_t *cfg, uint32_t frequency)
 {
-    //fprintf(stderr, "sdr_callback... %u\n", len);
-    r_cfg_t *cfg = ctx;
     struct dm_state *demod = cfg->demod;
-    char time_str[LOCAL_TIME_BUFLEN];
-    unsigned long n_samples;
 
-    if (!demod) {
-        // might happen when the demod closed and we get a last data frame
-        return; // ignore the data
-    }
+    // the queued packages are decoded with the decoders of the previous frequency
+    package_queue_retire(cfg->package_queue, 1);
 
-    // do this here and not in sdr_handler so realtime replay can use rtl_tcp output
-    for (void **iter = cfg->raw_handler.elems; iter && *iter; ++iter) {
-        raw_output_t *output = *iter;
-        raw_output_frame(output, iq_buf, len);
+    if (demod->detect_frequency) {
+        detect_state_t *prev = detect_state_slot(demod, demod->detect_frequency);
+        prev->frequency      = demod->detect_frequency;
+        prev->noise_level    = demod->noise_level;
+        prev->min_level_auto = demod->min_level_auto;
+        pulse_detect_get_levels(demod->pulse_detect, &prev->levels);
     }
 
-    if ((cfg->bytes_to_read > 0) && (cfg->bytes_to_read <= len)) {
-        len = cfg->bytes_to_read;
-        cfg->exit_async = 1;
+    detect_state_t fresh = {0};
+    detect_state_t *next = detect_state_slot(demod, frequency);
+    if (next->frequency != frequency)
+        next = &fresh;
+    demod->detect_frequency = frequency;
+    demod->noise_level      = next->noise_level;
+    demod->min_level_auto   = next->min_level_auto;
+    pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit,
+            demod->min_level_auto != 0.0f ? demod->min_level_auto : demod->min_level, demod->min_snr, demod->detect_verbosity);
+    pulse_detect_restore_levels(demod->pulse_detect, &next->levels);
+
+    // a package in progress and the filter history are from the previous frequency
+    demod->frame_start_ago = 0;
+    demod->frame_end_ago   = 0;
+    baseband_low_pass_filter_reset(&demod->lowpass_filter_state);
+    baseband_demod_FM_reset(&demod->demod_FM_state);
+    baseband_demod_tones_reset(&demod->demod_tones_state);
+
+    if (cfg->channelizer) {
+        channelizer_reset(cfg->channelizer);
+    }
+    if (cfg->decimator) {
+        decimator_reset(cfg->decimator);
+    }
+    if (cfg->spectrum) {
+        spectrum_reset(cfg->spectrum);
     }
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        retune_sdr_callback(*iter, frequency);
+    }
+}
 
-    // save last frame time to see if a new second started
-    time_t last_frame_sec = demod->now.tv_sec;
-    get_time_now(&demod->now);
+/// Interval to keep the detector levels for the warm start, the primary saves them.
+#define WARM_START_KEEP_NS (60 * 1000000000ULL)
 
-    n_samples = len / demod->sample_size;
-    if (n_samples * demod->sample_size != len) {
-        print_log(LOG_WARNING, __func__, "Sample buffer length not aligned to sample size!");
+// keep the detector levels of the input and its channels, those of the current frequency are the live ones
+static void keep_warm_start(r_cfg_t *cfg, warm_start_t *warm)
+{
+    struct dm_state *demod = cfg->demod;
+    if (cfg->warm_start_key[0]) {
+        detect_state_t states[MAX_FREQS];
+        memcpy(states, demod->detect_states, sizeof(states));
+        if (demod->detect_frequency) {
+            detect_state_t *cur = &states[detect_state_slot(demod, demod->detect_frequency) - demod->detect_states];
+            cur->frequency      = demod->detect_frequency;
+            cur->noise_level    = demod->noise_level;
+            cur->min_level_auto = demod->min_level_auto;
+            pulse_detect_get_levels(demod->pulse_detect, &cur->levels);
+        }
+        warm_start_keep(warm, cfg->warm_start_key, states, MAX_FREQS);
     }
-    if (!n_samples) {
-        print_log(LOG_WARNING, __func__, "Sample buffer too short!");
-        return; // keep the watchdog timer running
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        keep_warm_start(*iter, warm);
     }
+}
 
-    // age the frame position if there is one
-    if (demod->frame_start_ago)
-        demod->frame_start_ago += n_samples;
-    if (demod->frame_end_ago)
-        demod->frame_end_ago += n_samples;
+// restore the detector levels kept for the input and its channels, the next samples retune to them
+static void restore_warm_start(r_cfg_t *cfg, warm_start_t *warm, char const *key)
+{
+    struct dm_state *demod = cfg->demod;
+    snprintf(cfg->warm_start_key, sizeof(cfg->warm_start_key), "%s", key);
+    warm_start_restore(warm, key, demod->detect_states, MAX_FREQS);
+    demod->detect_frequency = 0;
+
+    int i = 0;
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        char channel_key[sizeof(cfg->warm_start_key)];
+        snprintf(channel_key, sizeof(channel_key), "%.*s ch%d", (int)sizeof(channel_key) - 16, key, i++);
+        restore_warm_start(*iter, warm, channel_key);
+    }
+}
 
-    cfg->watchdog++; // reset the frame acquire watchdog
+// the levels are kept by receiver: the device serial or query, the gain, and the level estimator
+static void start_warm_start(r_cfg_t *cfg)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary)
+        root = root->primary;
+    if (!root->warm_start)
+        return;
 
-    if (demod->samp_grab) {
-        samp_grab_push(demod->samp_grab, iq_buf, len);
+    char const *device = cfg->dev_query && *cfg->dev_query ? cfg->dev_query : "0";
+    int device_len     = (int)strlen(device);
+    char const *serial = cfg->dev_info ? strstr(cfg->dev_info, "\"serial\":\"") : NULL;
+    if (serial) {
+        device     = serial + 10;
+        device_len = (int)strcspn(device, "\"");
     }
+    char key[sizeof(cfg->warm_start_key)];
+    snprintf(key, sizeof(key), "%.*s gain=%s %s", device_len, device, cfg->gain_str && *cfg->gain_str ? cfg->gain_str : "auto",
+            cfg->demod->use_mag_est ? "magest" : "ampest");
 
-    // AM demodulation
-    float avg_db;
-    if (demod->sample_size == 2) { // CU8
-        if (demod->use_mag_est) {
-            //magnitude_true_cu8(iq_buf, demod->buf.temp, n_samples);
-            avg_db = magnitude_est_cu8(iq_buf, demod->buf.temp, n_samples);
-        }
-        else { // amp est
-            avg_db = envelope_detect(iq_buf, demod->buf.temp, n_samples);
-        }
-    } else { // CS16
-        //magnitude_true_cs16((int16_t *)iq_buf, demod->buf.temp, n_samples);
-        avg_db = magnitude_est_cs16((int16_t *)iq_buf, demod->buf.temp, n_samples);
-    }
+    // a restart of the same device goes on with the levels it has
+    if (!strcmp(cfg->warm_start_key, key))
+        return;
+    keep_warm_start(cfg, root->warm_start);
+    restore_warm_start(cfg, root->warm_start, key);
+    cfg->warm_start_ns = time_monotonic_ns();
+}
 
-    //fprintf(stderr, "noise level: %.1f dB current: %.1f dB min level: %.1f dB\n", demod->noise_level, avg_db, demod->min_level_auto);
-    if (demod->min_level_auto == 0.0f) {
-        demod->min_level_auto = demod->min_level;
-    }
-    if (demod->noise_level == 0.0f) {
-        demod->noise_level = demod->min_level_auto - 3.0f;
-    }
-    int noise_only = avg_db < demod->noise_level + 3.0f; // or demod->min_level_auto?
-    // always process frames if loader, dumper, or analyzers are in use, otherwise skip silent frames
-    int process_frame = demod->squelch_offset <= 0 || !noise_only || demod->load_info.format || demod->analyze_pulses || demod->dumper.len || demod->samp_grab;
-    cfg->total_frames_count += 1;
-    if (noise_only) {
-        cfg->total_frames_squelch += 1;
-        demod->noise_level = (demod->noise_level * 7 + avg_db) / 8; // fast fall over 8 frames
-        // If auto_level and noise level well below min_level and significant change in noise level
-        if (demod->auto_level > 0 && demod->noise_level < demod->min_level - 3.0f
-                && fabsf(demod->min_level_auto - demod->noise_level - 3.0f) > 1.0f) {
-            demod->min_level_auto = demod->noise_level + 3.0f;
-            print_logf(LOG_WARNING, "Auto Level", "Estimated noise level is %.1f dB, adjusting minimum detection level to %.1f dB",
-                    demod->noise_level, demod->min_level_auto);
-            pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level_auto, demod->min_snr, demod->detect_verbosity);
-        }
-    } else {
-        demod->noise_level = (demod->noise_level * 31 + avg_db) / 32; // slow rise over 32 frames
-    }
-    // Report noise every report_noise seconds, but only for the first frame that second
-    if (cfg->report_noise && last_frame_sec != demod->now.tv_sec && demod->now.tv_sec % cfg->report_noise == 0) {
-        print_logf(LOG_WARNING, "Auto Level", "Current %s level %.1f dB, estimated noise %.1f dB",
-                noise_only ? "noise" : "signal", avg_db, demod->noise_level);
+// run the decoders selected for a frequency on the input and its channels
+static void select_sdr_decoders(r_cfg_t *cfg, uint32_t frequency, unsigned const *protocols)
+{
+    r_select_decoders(cfg, frequency, protocols);
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        select_sdr_decoders(*iter, frequency, protocols);
     }
+}
 
-    if (process_frame) {
-        baseband_low_pass_filter(&demod->lowpass_filter_state, demod->buf.temp, demod->am_buf, n_samples);
+// the tone deviation set for the frequency of the samples, 0 to use the FM demod
+static uint32_t fsk_tones_deviation(r_cfg_t const *cfg)
+{
+    r_cfg_t const *root = cfg;
+    while (root->primary)
+        root = root->primary;
+    for (int i = 0; i < root->fsk_tones; ++i) {
+        uint32_t frequency = root->fsk_tones_frequency[i];
+        uint32_t deviation = root->fsk_tones_deviation[i];
+        // a channel is near the frequency, within the deviation
+        if (!frequency || (cfg->center_frequency + deviation >= frequency && cfg->center_frequency <= frequency + deviation))
+            return deviation;
     }
+    return 0;
+}
 
-    // FM demodulation
-    // Select the correct fsk pulse detector
-    unsigned fpdm = cfg->fsk_pulse_detect_mode;
-    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
-        if (cfg->frequency[cfg->frequency_index] > FSK_PULSE_DETECTOR_LIMIT)
-            fpdm = FSK_PULSE_DETECT_NEW;
-        else
-            fpdm = FSK_PULSE_DETECT_OLD;
+// the protocols given for a frequency, NULL if there are none
+static unsigned const *frequency_protocols(r_cfg_t *cfg, uint32_t frequency)
+{
+    for (int i = 0; i < cfg->frequencies; ++i) {
+        if (cfg->frequency[i] == frequency)
+            return cfg->frequency_protocols[i];
     }
+    return NULL;
+}
 
-    if (demod->enable_FM_demod && process_frame) {
-        float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
-        if (demod->sample_size == 2) { // CU8
-            baseband_demod_FM(&demod->demod_FM_state, iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
-        } else { // CS16
-            baseband_demod_FM_cs16(&demod->demod_FM_state, (int16_t *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
-        }
+// print the analysis of a package, or aggregate it with -A batch
+static void analyze_package(r_cfg_t *cfg, pulse_data_t *data, int package_type)
+{
+    struct dm_state *demod = cfg->demod;
+    if (demod->analyze_pulses == 2) {
+        if (!demod->analyzer_batch)
+            demod->analyzer_batch = pulse_analyzer_batch_create();
+        if (demod->analyzer_batch)
+            pulse_analyzer_batch_add(demod->analyzer_batch, data, package_type);
+        return;
     }
+    r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
+    pulse_analyzer(data, package_type, &device);
+}
 
-    // Handle special input formats
-    if (demod->load_info.format == S16_AM) { // The IQ buffer is really AM demodulated data
-        if (len > sizeof(demod->am_buf))
-            FATAL("Buffer too small");
-        memcpy(demod->am_buf, iq_buf, len);
-    } else if (demod->load_info.format == S16_FM) { // The IQ buffer is really FM demodulated data
-        // we would need AM for the envelope too
-        if (len > sizeof(demod->buf.fm))
-            FATAL("Buffer too small");
-        memcpy(demod->buf.fm, iq_buf, len);
-    }
+static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx);
+static void write_decoder_usage(r_cfg_t *cfg);
 
-    int d_events = 0; // Sensor events successfully detected
-    if (demod->r_devs.len || demod->analyze_pulses || demod->dumper.len || demod->samp_grab) {
-        // Detect a package and loop through demodulators with pulse data
-        int package_type = PULSE_DATA_OOK;  // Just to get us started
-        for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
-            file_info_t const *dumper = *iter;
-            if (dumper->format == U8_LOGIC) {
-                memset(demod->u8_buf, 0, n_samples);
-                break;
-            }
+// adds the frame counters of a channel to the input config, the channels report no stats of their own
+static void merge_channel_stats(r_cfg_t *cfg, r_cfg_t *ch)
+{
+    cfg->total_frames_ook    += ch->total_frames_ook;
+    cfg->total_frames_fsk    += ch->total_frames_fsk;
+    cfg->total_frames_events += ch->total_frames_events;
+    cfg->frames_ook    += ch->frames_ook;
+    cfg->frames_fsk    += ch->frames_fsk;
+    cfg->frames_events += ch->frames_events;
+    cfg->frames_baseband_us += ch->frames_baseband_us;
+    cfg->frames_detect_ns   += ch->frames_detect_ns;
+    cfg->frames_decode_ns   += ch->frames_decode_ns;
+    cfg->frames_over_budget    += ch->frames_over_budget;
+    cfg->frames_budget_skipped += ch->frames_budget_skipped;
+    cfg->frames_early          += ch->frames_early;
+    for (unsigned i = 0; i < LATENCY_HIST_BINS; ++i) {
+        cfg->frames_latency[i] += ch->frames_latency[i];
+    }
+    cfg->frames_latency_max_ms = MAX(cfg->frames_latency_max_ms, ch->frames_latency_max_ms);
+    for (unsigned i = 0; i < LATENCY_STAGES; ++i) {
+        latency_hist_merge(&cfg->frames_stage_latency[i], &ch->frames_stage_latency[i]);
+    }
+    if (ch->dedup_ms > 0 || ch->early_decode) {
+        for (void **iter = ch->demod->r_devs.elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            cfg->frames_duplicates += r_dev->decode_duplicates;
+            r_dev->decode_duplicates = 0;
         }
-        while (package_type && process_frame) {
-            int p_events = 0; // Sensor events successfully detected per package
-            package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
-            if (package_type) {
-                // new package: set a first frame start if we are not tracking one already
-                if (!demod->frame_start_ago)
-                    demod->frame_start_ago = demod->pulse_data.start_ago;
-                // always update the last frame end
-                demod->frame_end_ago = demod->pulse_data.end_ago;
-            }
-            if (package_type == PULSE_DATA_OOK) {
-                calc_rssi_snr(cfg, &demod->pulse_data);
-                if (demod->analyze_pulses) fprintf(stderr, "Detected OOK package\t%s\n", time_pos_str(cfg, demod->pulse_data.start_ago, time_str));
-
-                p_events += run_ook_demods(&demod->r_devs, &demod->pulse_data);
-                cfg->total_frames_ook += 1;
-                cfg->total_frames_events += p_events > 0;
-                cfg->frames_ook +=1;
-                cfg->frames_events += p_events > 0;
-
-                for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
-                    file_info_t const *dumper = *iter;
-                    if (dumper->format == VCD_LOGIC) pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
-                    if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->pulse_data, 0x02);
-                    if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->pulse_data);
-                }
+    }
 
-                if (cfg->verbosity >= LOG_TRACE) pulse_data_print(&demod->pulse_data);
-                if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
-                    data_t *data = pulse_data_print_data(&demod->pulse_data);
-                    event_occurred_handler(cfg, data);
-                }
-                if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0)) ) {
-                    r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
-                    pulse_analyzer(&demod->pulse_data, package_type, &device);
-                }
+    ch->total_frames_ook    = 0;
+    ch->total_frames_fsk    = 0;
+    ch->total_frames_events = 0;
+    ch->frames_ook    = 0;
+    ch->frames_fsk    = 0;
+    ch->frames_events = 0;
+    ch->frames_baseband_us = 0;
+    ch->frames_detect_ns   = 0;
+    ch->frames_decode_ns   = 0;
+    ch->frames_over_budget    = 0;
+    ch->frames_budget_skipped = 0;
+    ch->frames_early          = 0;
+    memset(ch->frames_latency, 0, sizeof(ch->frames_latency));
+    ch->frames_latency_max_ms = 0;
+    memset(ch->frames_stage_latency, 0, sizeof(ch->frames_stage_latency));
+}
 
-            } else if (package_type == PULSE_DATA_FSK) {
-                calc_rssi_snr(cfg, &demod->fsk_pulse_data);
-                if (demod->analyze_pulses) fprintf(stderr, "Detected FSK package\t%s\n", time_pos_str(cfg, demod->fsk_pulse_data.start_ago, time_str));
-
-                p_events += run_fsk_demods(&demod->r_devs, &demod->fsk_pulse_data);
-                cfg->total_frames_fsk +=1;
-                cfg->total_frames_events += p_events > 0;
-                cfg->frames_fsk += 1;
-                cfg->frames_events += p_events > 0;
-
-                for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
-                    file_info_t const *dumper = *iter;
-                    if (dumper->format == VCD_LOGIC) pulse_data_print_vcd(dumper->file, &demod->fsk_pulse_data, '"');
-                    if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->fsk_pulse_data, 0x04);
-                    if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->fsk_pulse_data);
-                }
+typedef struct channel_task {
+    r_cfg_t *ch;
+    int16_t *buf;
+    uint32_t len;
+} channel_task_t;
 
-                if (cfg->verbosity >= LOG_TRACE) pulse_data_print(&demod->fsk_pulse_data);
-                if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
-                    data_t *data = pulse_data_print_data(&demod->fsk_pulse_data);
-                    event_occurred_handler(cfg, data);
-                }
-                if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
-                    r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
-                    pulse_analyzer(&demod->fsk_pulse_data, package_type, &device);
-                }
-            } // if (package_type == ...
-            d_events += p_events;
-        } // while (package_type)...
+// demodulate one channel, runs on any of the worker pool threads
+static void demod_channel_task(void *arg)
+{
+    channel_task_t *task = arg;
+    sdr_callback((unsigned char *)task->buf, task->len, task->ch);
+}
 
-        // add event counter to the frames currently tracked
-        demod->frame_event_count += d_events;
+// a channel without activity is not demodulated, only its input position advances
+static void skip_channel_frame(r_cfg_t *ch, unsigned long n_samples)
+{
+    struct dm_state *demod = ch->demod;
 
-        // end frame tracking if older than a whole buffer
-        if (demod->frame_start_ago && demod->frame_end_ago > n_samples) {
-            if (demod->samp_grab) {
-                if (cfg->grab_mode == 1
-                        || (cfg->grab_mode == 2 && demod->frame_event_count == 0)
-                        || (cfg->grab_mode == 3 && demod->frame_event_count > 0)) {
-                    unsigned frame_pad = n_samples / 8; // this could also be a fixed value, e.g. 10000 samples
-                    unsigned start_padded = demod->frame_start_ago + frame_pad;
-                    unsigned end_padded = demod->frame_end_ago - frame_pad;
-                    unsigned len_padded = start_padded - end_padded;
-                    samp_grab_write(demod->samp_grab, len_padded, end_padded);
-                }
-            }
-            demod->frame_start_ago = 0;
-            demod->frame_event_count = 0;
-        }
+    if (demod->frame_start_ago)
+        demod->frame_start_ago += n_samples;
+    if (demod->frame_end_ago)
+        demod->frame_end_ago += n_samples;
+    ch->input_pos += n_samples;
+    r_merge_progress(ch);
+}
 
-        // dump partial pulse_data for this buffer
-        for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
-            file_info_t const *dumper = *iter;
-            if (dumper->format == U8_LOGIC) {
-                pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->pulse_data, 0x02);
-                pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->fsk_pulse_data, 0x04);
-                break;
-            }
-        }
+// the duty cycle skipped a frame of the input, the channels only advance their input position
+static void skip_channels(r_cfg_t *cfg, unsigned long n_samples)
+{
+    uint32_t rate = cfg->decimator ? decimator_rate(cfg->decimator, cfg->samp_rate) : channelizer_rate(cfg->channelizer, cfg->samp_rate);
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        skip_channel_frame(*iter, (unsigned long)((uint64_t)n_samples * rate / cfg->samp_rate));
     }
+}
 
-    if (demod->am_analyze) {
-        am_analyze(demod->am_analyze, demod->am_buf, n_samples, cfg->verbosity >= LOG_INFO, NULL);
-    }
+// input samples from one FFT of the channel gate to the next, a package spans many
+#define SPECTRUM_GATE_STRIDE 2048
+// time a channel stays open after the last signal, the gaps in a package or between repeats are shorter
+#define SPECTRUM_GATE_HOLD_MS 1000
 
-    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
-        file_info_t const *dumper = *iter;
-        if (!dumper->file
-                || dumper->format == VCD_LOGIC
-                || dumper->format == PULSE_OOK)
-            continue;
-        uint8_t *out_buf = iq_buf;  // Default is to dump IQ samples
-        unsigned long out_len = n_samples * demod->sample_size;
+// split or decimate the input into channels and demodulate each of them, returns the number of frames with events
+static int demod_channels(r_cfg_t *cfg, unsigned char *iq_buf, unsigned long n_samples)
+{
+    struct dm_state *demod = cfg->demod;
+    uint64_t start_ns = time_monotonic_ns();
 
-        if (dumper->format == CU8_IQ) {
-            if (demod->sample_size == 4) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((uint8_t *)demod->buf.temp)[n] = (((int16_t *)iq_buf)[n] / 256) + 128; // scale Q0.15 to Q0.7
-                out_buf = (uint8_t *)demod->buf.temp;
-                out_len = n_samples * 2 * sizeof(uint8_t);
-            }
-        }
-        else if (dumper->format == CS16_IQ) {
-            if (demod->sample_size == 2) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int16_t *)demod->buf.temp)[n] = (iq_buf[n] * 256) - 32768; // scale Q0.7 to Q0.15
-                out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
-                out_len = n_samples * 2 * sizeof(int16_t);
-            }
-        }
-        else if (dumper->format == CS8_IQ) {
-            if (demod->sample_size == 2) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = (iq_buf[n] - 128);
-            }
-            else if (demod->sample_size == 4) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] >> 8;
-            }
-            out_buf = (uint8_t *)demod->buf.temp;
-            out_len = n_samples * 2 * sizeof(int8_t);
-        }
-        else if (dumper->format == CF32_IQ) {
-            if (demod->sample_size == 2) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = (iq_buf[n] - 128) / 128.0f;
-            }
-            else if (demod->sample_size == 4) {
-                for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] / 32768.0f;
+    int n_out;
+    if (cfg->decimator) {
+        n_out = decimator_process(cfg->decimator, iq_buf, demod->sample_size, n_samples, cfg->samp_rate);
+    }
+    else {
+        if (cfg->spectrum)
+            spectrum_process(cfg->spectrum, iq_buf, demod->sample_size, n_samples);
+        n_out = channelizer_process(cfg->channelizer, iq_buf, demod->sample_size, n_samples);
+    }
+    if (trace_event_active(cfg->trace)) {
+        trace_event_span(cfg->trace, "channelize", "dsp", cfg->trace_tid, start_ns, time_monotonic_ns());
+    }
+    if (n_out <= 0) {
+        return 0;
+    }
+
+    channel_task_t tasks[CHANNELIZER_MAX_CHANNELS];
+    void *args[CHANNELIZER_MAX_CHANNELS];
+    unsigned k = 0;
+    unsigned channel = 0;
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter, ++channel) {
+        r_cfg_t *ch = *iter;
+        // under load the channels are gated by the activity the spectrum monitor sees
+        if ((cfg->spectrum_gate > 0 || demod->shed_step >= LOAD_SHED_SQUELCH) && cfg->spectrum) {
+            // the bins of a channel span its sample rate, twice the channel spacing
+            unsigned bin = spectrum_bin(channelizer_offset(cfg->channelizer, channel, cfg->samp_rate), cfg->samp_rate);
+            uint64_t hold = (uint64_t)cfg->samp_rate * SPECTRUM_GATE_HOLD_MS / 1000;
+            if (!spectrum_active(cfg->spectrum, bin, SPECTRUM_BINS / cfg->channel_count, hold)) {
+                skip_channel_frame(ch, n_out);
+                cfg->frames_gated += 1;
+                continue;
             }
-            out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
-            out_len = n_samples * 2 * sizeof(float);
-        }
-        else if (dumper->format == S16_AM) {
-            out_buf = (uint8_t *)demod->am_buf;
-            out_len = n_samples * sizeof(int16_t);
-        }
-        else if (dumper->format == S16_FM) {
-            out_buf = (uint8_t *)demod->buf.fm;
-            out_len = n_samples * sizeof(int16_t);
-        }
-        else if (dumper->format == F32_AM) {
-            for (unsigned long n = 0; n < n_samples; ++n)
-                demod->f32_buf[n] = demod->am_buf[n] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
-            out_len = n_samples * sizeof(float);
-        }
-        else if (dumper->format == F32_FM) {
-            for (unsigned long n = 0; n < n_samples; ++n)
-                demod->f32_buf[n] = demod->buf.fm[n] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
-            out_len = n_samples * sizeof(float);
-        }
-        else if (dumper->format == F32_I) {
-            if (demod->sample_size == 2)
-                for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = (iq_buf[n * 2] - 128) * (1.0f / 0x80); // scale from Q0.7
-            else
-                for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = ((int16_t *)iq_buf)[n * 2] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
-            out_len = n_samples * sizeof(float);
         }
-        else if (dumper->format == F32_Q) {
-            if (demod->sample_size == 2)
-                for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = (iq_buf[n * 2 + 1] - 128) * (1.0f / 0x80); // scale from Q0.7
-            else
-                for (unsigned long n = 0; n < n_samples; ++n)
-                    demod->f32_buf[n] = ((int16_t *)iq_buf)[n * 2 + 1] * (1.0f / 0x8000); // scale from Q0.15
-            out_buf = (uint8_t *)demod->f32_buf;
-            out_len = n_samples * sizeof(float);
+        if (cfg->decimator) {
+            ch->center_frequency = cfg->center_frequency + decimator_shift(cfg->decimator);
+            ch->samp_rate        = decimator_rate(cfg->decimator, cfg->samp_rate);
+            tasks[k].buf         = decimator_output(cfg->decimator);
         }
-        else if (dumper->format == U8_LOGIC) { // state data
-            out_buf = demod->u8_buf;
-            out_len = n_samples;
+        else {
+            ch->center_frequency = cfg->center_frequency + channelizer_offset(cfg->channelizer, channel, cfg->samp_rate);
+            ch->samp_rate        = channelizer_rate(cfg->channelizer, cfg->samp_rate);
+            tasks[k].buf         = channelizer_output(cfg->channelizer, channel);
         }
+        ch->demod->sample_time_ns  = demod->sample_time_ns;
+        ch->demod->publish_ns      = demod->publish_ns;
+        ch->demod->demod_start_ns  = demod->demod_start_ns;
+        ch->trace                  = cfg->trace;
+        ch->demod->sample_file_pos = demod->sample_file_pos;
+        tasks[k].ch  = ch;
+        tasks[k].len = n_out * ch->demod->sample_size;
+        args[k]      = &tasks[k];
+        k += 1;
+    }
 
-        if (fwrite(out_buf, 1, out_len, dumper->file) != out_len) {
-            print_log(LOG_ERROR, __func__, "Short write, samples lost, exiting!");
-            cfg->exit_async = 1;
+    if (cfg->worker_pool) {
+        worker_pool_run(cfg->worker_pool, demod_channel_task, args, k);
+    }
+    else {
+        for (unsigned i = 0; i < k; ++i) {
+            demod_channel_task(args[i]);
         }
     }
 
-    cfg->input_pos += n_samples;
-    if (cfg->bytes_to_read > 0)
-        cfg->bytes_to_read -= len;
-
-    if (cfg->after_successful_events_flag && (d_events > 0)) {
-        if (cfg->after_successful_events_flag == 1) {
+    // collect in channel order, the output does not depend on the thread timing
+    int d_events = 0;
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        r_cfg_t *ch = *iter;
+        r_flush_channel_output(ch);
+        d_events += ch->total_frames_events;
+        merge_channel_stats(cfg, ch);
+        if (ch->exit_async) {
             cfg->exit_async = 1;
         }
-        else {
-            cfg->hop_now = 1;
+    }
+    return d_events;
+}
+
+// the noise level and the depth of each queued output, on the primary after each buffer
+static void trace_counters(r_cfg_t *cfg, uint64_t ts_ns)
+{
+    trace_event_counter(cfg->trace, "noise dB", ts_ns, cfg->demod->noise_level);
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        output_queue_stats_t queue;
+        if (data_output_async_stats(cfg->output_handler.elems[i], &queue, 0)) {
+            char name[40];
+            snprintf(name, sizeof(name), "output %zu queued", i);
+            trace_event_counter(cfg->trace, name, ts_ns, queue.depth);
+        }
+    }
+}
+
+static char const *const load_shed_names[LOAD_SHED_STEPS] = {
+        "all stages run",
+        "no FM demod on frequencies without FSK decoders",
+        "only the decoders of priority 0",
+        "noise frames squelched and channels gated",
+};
+
+// set the load shedding step of an input and its channels, the decode thread reads it too
+static void set_shed_step(r_cfg_t *cfg, unsigned step)
+{
+    atomic_store_release(&cfg->demod->shed_step, step);
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        set_shed_step(*iter, step);
+    }
+}
+
+// step the load shedding of an input by the realtime load of a buffer
+static void shed_load(r_cfg_t *cfg, uint64_t busy_ns, unsigned long n_samples)
+{
+    unsigned prev = cfg->demod->shed_step;
+    unsigned step = load_shed_buffer(cfg->load_shed, busy_ns, (uint64_t)n_samples * 1000000000 / cfg->samp_rate);
+    if (step == prev)
+        return;
+    print_logf(step > prev ? LOG_WARNING : LOG_NOTICE, "Input", "Realtime load %.2f, load shedding %s to step %u: %s.",
+            load_shed_load(cfg->load_shed), step > prev ? "raised" : "lowered", step, load_shed_names[step]);
+    set_shed_step(cfg, step);
+}
+
+// advance the input position, then handle hopping, the duration, and stats reports after a frame
+static void end_sdr_frame(r_cfg_t *cfg, uint32_t len, unsigned long n_samples, int d_events)
+{
+    cfg->input_pos += n_samples;
+    r_merge_progress(cfg);
+    cfg->demod->demod_start_ns = 0;
+
+    // the time in the sample callback against the signal time of the buffer gives the realtime load
+    uint64_t busy_ns = time_monotonic_ns() - cfg->demod->callback_start_ns;
+    latency_hist_add(&cfg->frames_callback, (int64_t)(busy_ns / 1000));
+    cfg->frames_buffers += 1;
+    cfg->frames_bytes += len;
+    cfg->frames_busy_ns += busy_ns;
+    if (cfg->samp_rate)
+        cfg->frames_duration_ns += (uint64_t)n_samples * 1000000000 / cfg->samp_rate;
+    if (cfg->load_shed && cfg->samp_rate)
+        shed_load(cfg, busy_ns, n_samples);
+    R_TRACE3(callback_exit, n_samples, d_events, busy_ns);
+    cfg->demod->callback_end_ns = cfg->demod->callback_start_ns + busy_ns;
+    if (trace_event_active(cfg->trace)) {
+        trace_event_span(cfg->trace, "buffer", "input", cfg->trace_tid, cfg->demod->callback_start_ns, cfg->demod->callback_end_ns);
+        if (!cfg->primary)
+            trace_counters(cfg, cfg->demod->callback_end_ns);
+    }
+    if (cfg->bytes_to_read > 0)
+        cfg->bytes_to_read -= len;
+
+    if (cfg->after_successful_events_flag && (d_events > 0)) {
+        if (cfg->after_successful_events_flag == 1) {
+            cfg->exit_async = 1;
+        }
+        else {
+            cfg->hop_now = 1;
         }
     }
 
     time_t rawtime;
     time(&rawtime);
-    // choose hop_index as frequency_index, if there are too few hop_times use the last one
-    int hop_index = cfg->hop_times > cfg->frequency_index ? cfg->frequency_index : cfg->hop_times - 1;
-    if (cfg->hop_times > 0 && cfg->frequencies > 1
-            && difftime(rawtime, cfg->hop_start_time) >= cfg->hop_time[hop_index]) {
-        cfg->hop_now = 1;
+    if (cfg->hop_scheduler) {
+        // the dwell times count samples, the packages are counted since the last frame
+        unsigned packages = cfg->total_frames_ook + cfg->total_frames_fsk - cfg->hop_packages;
+        cfg->hop_packages += packages;
+        if (hop_scheduler_frame(cfg->hop_scheduler, cfg->input_pos, packages, d_events > 0 ? (unsigned)d_events : 0))
+            cfg->hop_now = 1;
+    }
+    else {
+        // choose hop_index as frequency_index, if there are too few hop_times use the last one
+        int hop_index = cfg->hop_times > cfg->frequency_index ? cfg->frequency_index : cfg->hop_times - 1;
+        if (cfg->hop_times > 0 && cfg->frequencies > 1
+                && difftime(rawtime, cfg->hop_start_time) >= cfg->hop_time[hop_index]) {
+            cfg->hop_now = 1;
+        }
     }
     if (cfg->duration > 0 && rawtime >= cfg->stop_time) {
         cfg->exit_async = 1;
@@ -790,6 +1084,8 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         flush_report_data(cfg);
         if (rawtime >= cfg->stats_time)
             cfg->stats_time += cfg->stats_interval;
+        if (cfg->stats_now && !cfg->primary)
+            write_decoder_usage(cfg);
         if (cfg->stats_now)
             cfg->stats_now--;
     }
@@ -797,845 +1093,4324 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
     if (cfg->hop_now && !cfg->exit_async) {
         cfg->hop_now = 0;
         time(&cfg->hop_start_time);
-        cfg->frequency_index = (cfg->frequency_index + 1) % cfg->frequencies;
+        if (cfg->hop_scheduler)
+            cfg->frequency_index = (int)hop_scheduler_next(cfg->hop_scheduler, cfg->input_pos);
+        else
+            cfg->frequency_index = (cfg->frequency_index + 1) % cfg->frequencies;
         sdr_set_center_freq(cfg->dev, cfg->frequency[cfg->frequency_index], 1);
     }
 }
 
-static int hasopt(int test, int argc, char *argv[], char const *optstring)
+// channels and receivers send their packages to the pulse outputs of the primary
+static void send_pulses(r_cfg_t *cfg, pulse_data_t const *pulse_data, int package_type)
 {
-    int opt;
-
-    optind = 1; // reset getopt
-    while ((opt = getopt(argc, argv, optstring)) != -1) {
-        if (opt == test || optopt == test)
-            return opt;
+    while (cfg->primary)
+        cfg = cfg->primary;
+    for (void **iter = cfg->pulse_handler.elems; iter && *iter; ++iter) {
+        pulse_output_send(*iter, pulse_data, package_type);
     }
-    return 0;
 }
 
-static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg);
+// any pulse outputs detect the packages, also without decoders
+static int has_pulse_outputs(r_cfg_t *cfg)
+{
+    while (cfg->primary)
+        cfg = cfg->primary;
+    return cfg->pulse_handler.len > 0;
+}
 
-#define OPTSTRING "hVvqD:c:x:z:p:a:AI:S:m:M:r:w:W:l:d:t:f:H:g:s:b:n:R:X:F:K:C:T:UGy:E:Y:"
+// receive time of the first pulse of a package in us since the epoch
+static int64_t package_time_us(r_cfg_t *cfg, pulse_data_t const *pulse_data)
+{
+    struct timeval const *now = &cfg->demod->now;
+    return (int64_t)now->tv_sec * 1000000 + now->tv_usec - (int64_t)pulse_data->start_ago * 1000000 / cfg->samp_rate;
+}
 
-// these should match the short options exactly
-static struct conf_keywords const conf_keywords[] = {
-        {"help", 'h'},
-        {"verbose", 'v'},
-        {"version", 'V'},
-        {"config_file", 'c'},
-        {"report_meta", 'M'},
-        {"device", 'd'},
-        {"device_mode", 'D'},
-        {"settings", 't'},
-        {"gain", 'g'},
-        {"frequency", 'f'},
-        {"hop_interval", 'H'},
-        {"ppm_error", 'p'},
-        {"sample_rate", 's'},
-        {"protocol", 'R'},
-        {"decoder", 'X'},
-        {"register_all", 'G'},
-        {"out_block_size", 'b'},
-        {"level_limit", 'l'},
-        {"samples_to_read", 'n'},
-        {"analyze", 'a'},
-        {"analyze_pulses", 'A'},
-        {"include_only", 'I'},
-        {"read_file", 'r'},
-        {"write_file", 'w'},
-        {"overwrite_file", 'W'},
-        {"signal_grabber", 'S'},
-        {"override_short", 'z'},
-        {"override_long", 'x'},
-        {"pulse_detect", 'Y'},
-        {"output", 'F'},
-        {"output_tag", 'K'},
-        {"convert", 'C'},
-        {"duration", 'T'},
-        {"test_data", 'y'},
-        {"stop_after_successful_events", 'E'},
-        {NULL, 0}};
+// run the decoders selected for the frequency on a package, returns the number of events
+static int decode_pulses(r_cfg_t *cfg, pulse_data_t *pulses, int package_type, unsigned tid, unsigned *budget_skipped, uint64_t *decode_ns)
+{
+    struct dm_state *demod = cfg->demod;
+    trace_event_t *trace   = trace_event_active(cfg->trace) ? cfg->trace : NULL;
+    uint64_t budget_ns     = (uint64_t)cfg->decode_budget_us * 1000;
+    // the decoders selected for the frequency of an SDR input, all of them for file inputs
+    list_t *ook_devs = demod->band_frequency ? &demod->band_ook_devs : &demod->ook_devs;
+    list_t *fsk_devs = demod->band_frequency ? &demod->band_fsk_devs : &demod->fsk_devs;
+    // under load only the decoders of priority 0 run, the fallback decoders are shed
+    unsigned max_priority = atomic_load_acquire(&demod->shed_step) >= LOAD_SHED_PRIORITY ? 0 : UINT_MAX;
+
+    uint64_t decode_start = time_monotonic_ns();
+    int events;
+    if (package_type == PULSE_DATA_FSK)
+        events = run_fsk_demods_traced(fsk_devs, pulses, &demod->slicer_cache, demod->decoder_pool, trace, tid, budget_ns, max_priority, budget_skipped);
+    else
+        events = run_ook_demods_traced(ook_devs, pulses, &demod->slicer_cache, demod->decoder_pool, trace, tid, budget_ns, max_priority, budget_skipped);
+    *decode_ns = time_monotonic_ns() - decode_start;
+    return events;
+}
 
-static void parse_conf_text(r_cfg_t *cfg, char *conf)
+// count, dump, and analyze a decoded package, on the demod in the order the packages are detected
+static void finish_package(r_cfg_t *cfg, pulse_data_t *pulses, int package_type, int p_events, uint64_t decode_ns)
 {
-    int opt;
-    char *arg;
-    char *p = conf;
+    struct dm_state *demod = cfg->demod;
+    uint64_t budget_ns     = (uint64_t)cfg->decode_budget_us * 1000;
 
-    if (!conf || !*conf)
-        return;
+    cfg->frames_decode_ns += decode_ns;
+    cfg->frames_over_budget += budget_ns && decode_ns > budget_ns;
+    if (p_events > 0) {
+        record_latency(cfg, pulses->end_ago);
+        record_stage_latency(cfg);
+    }
+    if (package_type == PULSE_DATA_FSK) {
+        cfg->total_frames_fsk += 1;
+        cfg->frames_fsk += 1;
+    }
+    else {
+        cfg->total_frames_ook += 1;
+        cfg->frames_ook += 1;
+    }
+    cfg->total_frames_events += p_events > 0;
+    cfg->frames_events += p_events > 0;
+    // add the events to the frame currently tracked
+    demod->frame_event_count += p_events;
 
-    while ((opt = getconf(&p, conf_keywords, &arg)) != -1) {
-        parse_conf_option(cfg, opt, arg);
+    // the logic dump is written as the package is detected, it is part of the buffer
+    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t *dumper = *iter;
+        if (dumper->format == VCD_LOGIC) pulse_data_print_vcd(dumper->file, pulses, package_type == PULSE_DATA_FSK ? '"' : '\'');
+        if (dumper->format == RLE_LOGIC) dumper->rle_pos = pulse_data_dump_rle(dumper->file, dumper->rle_pos, pulses, package_type == PULSE_DATA_FSK ? 0x04 : 0x02);
+        if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, pulses);
+        if (dumper->format == PULSE_ARCHIVE) pulse_archive_write(dumper->archive, pulses, package_type);
+    }
+
+    // the recorder of the primary keeps the packages of all inputs, decoded or not
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (root->pulse_recorder) {
+        pulse_recorder_add(root->pulse_recorder, pulses, package_type);
+    }
+
+    if (cfg->verbosity >= LOG_TRACE) pulse_data_print(pulses);
+    if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
+        data_t *data = pulse_data_print_data(pulses, cfg->raw_rfraw);
+        event_occurred_handler(cfg, data);
+    }
+    if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+        analyze_package(cfg, pulses, package_type);
     }
 }
 
-static void parse_conf_file(r_cfg_t *cfg, char const *path)
+// decode the unfinished OOK package with the decoders that set early_pulses, its first events are output right away
+static void decode_early(r_cfg_t *cfg)
 {
-    if (!path || !*path || !strcmp(path, "null") || !strcmp(path, "0"))
+    struct dm_state *demod = cfg->demod;
+    pulse_data_t *pulses   = &demod->pulse_data;
+    // under load only the whole packages are decoded
+    if (atomic_load_acquire(&demod->shed_step) >= LOAD_SHED_PRIORITY)
+        return;
+    unsigned num_pulses = pulse_detect_ook_pending(demod->pulse_detect, pulses);
+    if (!num_pulses)
+        return;
+    // a chunk of a file only decodes the packages starting in its own range
+    if (pulses->offset < cfg->package_begin || (cfg->package_end && pulses->offset >= cfg->package_end))
+        return;
+    if (demod->early_offset != pulses->offset + 1) {
+        demod->early_offset = pulses->offset + 1;
+        demod->early_pulses = 0;
+        demod->early_done   = 0;
+    }
+    // once decoded the package is left to the end, otherwise tried again with more pulses
+    if (demod->early_done || num_pulses <= demod->early_pulses)
         return;
+    demod->early_pulses = num_pulses;
 
-    char *conf = readconf(path);
-    parse_conf_text(cfg, conf);
-    //free(conf); // TODO: check no args are dangling, then use free
-}
+    list_t *ook_devs = demod->band_frequency ? &demod->band_ook_devs : &demod->ook_devs;
+    list_clear(&demod->early_devs, NULL);
+    for (void **iter = ook_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->early_pulses && r_dev->early_pulses <= num_pulses)
+            list_push(&demod->early_devs, r_dev);
+    }
+    if (!demod->early_devs.len)
+        return;
 
-static void parse_conf_try_default_files(r_cfg_t *cfg)
-{
-    char **paths = compat_get_default_conf_paths();
-    for (int a = 0; paths[a]; a++) {
-        // fprintf(stderr, "Trying conf file at \"%s\"...\n", paths[a]);
-        if (hasconf(paths[a])) {
-            fprintf(stderr, "Reading conf from \"%s\".\n", paths[a]);
-            parse_conf_file(cfg, paths[a]);
-            break;
-        }
+    calc_rssi_snr(cfg, pulses);
+    pulses->received_us = package_time_us(cfg, pulses);
+    uint64_t decode_start = time_monotonic_ns();
+    demod->early_decoding = 1;
+    int events = run_ook_demods(&demod->early_devs, pulses, &demod->slicer_cache, demod->decoder_pool);
+    demod->early_decoding = 0;
+    cfg->frames_decode_ns += time_monotonic_ns() - decode_start;
+    if (events > 0) {
+        demod->early_done = 1;
+        cfg->frames_early += 1;
+        demod->frame_event_count += events;
     }
 }
 
-static void parse_conf_args(r_cfg_t *cfg, int argc, char *argv[])
+// decode a queued package, on the decode thread of the pipeline
+static void decode_queued_package(package_t *package, void *ctx)
 {
-    int opt;
+    r_cfg_t *cfg = ctx;
+    // the decode thread is traced next to the demod, a pipelined receiver has no channels
+    package->events = decode_pulses(cfg, &package->pulses, package->type, cfg->trace_tid + 1, &package->budget_skipped, &package->decode_ns);
+}
 
-    optind = 1; // reset getopt
-    while ((opt = getopt(argc, argv, OPTSTRING)) != -1) {
-        if (opt == '?')
-            opt = optopt; // allow missing arguments
-        parse_conf_option(cfg, opt, optarg);
-    }
+// finish a queued package once decoded, its events are already delivered
+static void retire_package(package_t *package, void *ctx)
+{
+    r_cfg_t *cfg = ctx;
+    cfg->frames_budget_skipped += package->budget_skipped;
+    finish_package(cfg, &package->pulses, package->type, package->events, package->decode_ns);
 }
 
-static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
+// copy a detected package to the pipeline, with the state of the demod its events are stamped with
+static void queue_package(r_cfg_t *cfg, pulse_data_t const *pulses, int package_type)
 {
-    int n;
-    r_device *flex_device;
+    struct dm_state *demod = cfg->demod;
+    package_t *package     = package_queue_reserve(cfg->package_queue);
+
+    package->type = package_type;
+    pulse_data_copy(&package->pulses, pulses);
+    // only the levels of the other modulation are kept
+    package->other            = package_type == PULSE_DATA_FSK ? demod->pulse_data : demod->fsk_pulse_data;
+    package->other.num_pulses = 0;
+    package->other.capacity   = 0;
+    package->other.pulse      = NULL;
+    package->other.gap        = NULL;
+    package->other.start      = NULL;
+    package->other.indexed    = 0;
+    package->meta = (package_meta_t){
+            .pulse_data      = package_type == PULSE_DATA_FSK ? &package->other : &package->pulses,
+            .fsk_pulse_data  = package_type == PULSE_DATA_FSK ? &package->pulses : &package->other,
+            .now             = demod->now,
+            .sample_file_pos = demod->sample_file_pos,
+            .publish_ns      = demod->publish_ns,
+            .demod_start_ns  = demod->demod_start_ns,
+            .detect_ns       = demod->detect_ns,
+            .package_end_ns  = demod->package_end_ns,
+    };
+    package_queue_push(cfg->package_queue, package);
+}
 
-    if (arg && (!strcmp(arg, "help") || !strcmp(arg, "?"))) {
-        arg = NULL; // remove the arg if it's a request for the usage help
+// bytes per sample written by a sample dumper, IQ samples that need no conversion are written as is
+static unsigned dumper_sample_size(uint32_t format, int sample_size)
+{
+    switch (format) {
+    case CU8_IQ:   return sample_size == 4 ? 2 : sample_size;
+    case CS16_IQ:  return sample_size == 2 ? 4 : sample_size;
+    case CS8_IQ:   return 2;
+    case CF32_IQ:  return 8;
+    case S16_AM:   return 2;
+    case S16_FM:   return 2;
+    case F32_AM:   return 4;
+    case F32_FM:   return 4;
+    case F32_I:    return 4;
+    case F32_Q:    return 4;
+    case U8_LOGIC: return 1;
+    default:       return sample_size;
     }
+}
 
-    switch (opt) {
-    case 'h':
-        usage(0);
-        break;
-    case 'V':
-        exit(0); // we already printed the version
-        break;
-    case 'v':
-        if (!arg)
-            cfg->verbosity++;
-        else
-            cfg->verbosity = atobv(arg, 1);
-        break;
-    case 'c':
-        parse_conf_file(cfg, arg);
-        break;
-    case 'd':
-        if (!arg)
-            help_device_selection();
+/// Strided level estimate of the samples on the scale of the full envelope pass.
+static float squelch_level(struct dm_state const *demod, uint8_t const *iq_buf, uint32_t n_samples)
+{
+    if (demod->sample_format == BASEBAND_CS8 && !demod->use_mag_est)
+        return envelope_level_strided_cs8((int8_t const *)iq_buf, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else if (demod->sample_format == BASEBAND_CS8)
+        return magnitude_level_strided_cs8((int8_t const *)iq_buf, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else if (demod->sample_size == 2 && !demod->use_mag_est)
+        return envelope_level_strided(iq_buf, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else if (demod->sample_size == 2)
+        return magnitude_level_strided_cu8(iq_buf, n_samples, SQUELCH_PREFILTER_STRIDE);
+    else
+        return magnitude_level_strided_cs16((int16_t const *)iq_buf, n_samples, SQUELCH_PREFILTER_STRIDE);
+}
 
-        cfg->dev_query = arg;
-        break;
-    case 'D':
-        if (!arg)
-            help_device_mode();
+/// Mark the sub-blocks with a level estimate above the squelch level, and their neighbours as margin.
+/// @return the number of marked sub-blocks
+static unsigned squelch_subblocks(struct dm_state const *demod, uint8_t const *iq_buf, uint32_t n_samples, uint32_t block_len, uint8_t *active)
+{
+    unsigned blocks = (n_samples + block_len - 1) / block_len;
+    uint8_t above[SQUELCH_SUBBLOCKS_MAX];
+    for (unsigned i = 0; i < blocks; ++i) {
+        uint32_t pos = i * block_len;
+        uint32_t n   = n_samples - pos < block_len ? n_samples - pos : block_len;
+        above[i]     = squelch_level(demod, &iq_buf[pos * demod->sample_size], n) >= demod->noise_level + 3.0f - SQUELCH_PREFILTER_MARGIN;
+    }
+    unsigned marked = 0;
+    for (unsigned i = 0; i < blocks; ++i) {
+        active[i] = above[i] || (i > 0 && above[i - 1]) || (i + 1 < blocks && above[i + 1]);
+        marked += active[i];
+    }
+    return marked;
+}
 
-        if (strcmp(arg, "quit") == 0) {
-            cfg->dev_mode = DEVICE_MODE_QUIT;
-        }
-        else if (strcmp(arg, "restart") == 0) {
-            cfg->dev_mode = DEVICE_MODE_RESTART;
-        }
-        else if (strcmp(arg, "pause") == 0) {
-            cfg->dev_mode = DEVICE_MODE_PAUSE;
-        }
-        else if (strcmp(arg, "manual") == 0) {
-            cfg->dev_mode = DEVICE_MODE_MANUAL;
-        }
-        else {
-            fprintf(stderr, "Invalid input device run mode: %s\n", arg);
-            help_device_mode();
+/// Envelope, low pass filter, and FM demod (unless @p with_fm is 0) of the active sub-blocks only.
+/// The skipped samples read as the noise floor of the pulse detector, the filters restart after a gap.
+static void demod_subblocks(struct dm_state *demod, uint8_t const *iq_buf, uint32_t n_samples, uint32_t block_len, uint8_t const *active,
+        int with_fm, uint32_t samp_rate, float low_pass)
+{
+    pulse_detect_levels_t levels;
+    pulse_detect_get_levels(demod->pulse_detect, &levels);
+    int16_t quiet = (int16_t)(levels.ook_low_estimate < INT16_MAX ? levels.ook_low_estimate : INT16_MAX);
+
+    unsigned blocks = (n_samples + block_len - 1) / block_len;
+    for (unsigned i = 0; i < blocks;) {
+        unsigned end = i;
+        while (end < blocks && active[end] == active[i])
+            end++;
+        uint32_t pos = i * block_len;
+        uint32_t n   = (end * block_len < n_samples ? end * block_len : n_samples) - pos;
+        if (!active[i]) {
+            for (uint32_t k = 0; k < n; ++k)
+                demod->am_buf[pos + k] = quiet;
+            if (with_fm)
+                memset(&demod->buf.fm[pos], 0, n * sizeof(*demod->buf.fm));
+            i = end;
+            continue;
         }
-        break;
-    case 't':
-        // this option changed, check and warn if old meaning is used
-        if (!arg || *arg == '-') {
-            fprintf(stderr, "test_mode (-t) is deprecated. Use -S none|all|unknown|known\n");
-            exit(1);
+        // a run at the frame start continues the previous frame
+        if (pos) {
+            baseband_low_pass_filter_reset(&demod->lowpass_filter_state);
+            baseband_demod_FM_reset(&demod->demod_FM_state);
         }
-        cfg->settings_str = arg;
-        break;
-    case 'f':
-        if (cfg->frequencies < MAX_FREQS) {
-            uint32_t sr = atouint32_metric(arg, "-f: ");
-            /* If the frequency is above 800MHz sample at 1MS/s */
-            if ((sr > FSK_PULSE_DETECTOR_LIMIT) && (cfg->samp_rate == DEFAULT_SAMPLE_RATE)) {
-                cfg->samp_rate = 1000000;
-                fprintf(stderr, "\nNew defaults active, use \"-Y classic -s 250k\" if you need the old defaults\n\n");
-            }
-            cfg->frequency[cfg->frequencies++] = sr;
-        } else
-            fprintf(stderr, "Max number of frequencies reached %d\n", MAX_FREQS);
-        break;
-    case 'H':
-        if (cfg->hop_times < MAX_FREQS)
-            cfg->hop_time[cfg->hop_times++] = atoi_time(arg, "-H: ");
+        if (demod->sample_format == BASEBAND_CU8 && !demod->use_mag_est)
+            envelope_detect(&iq_buf[2 * pos], demod->buf.temp, n);
+        else if (demod->sample_format == BASEBAND_CU8)
+            magnitude_est_cu8(&iq_buf[2 * pos], demod->buf.temp, n);
         else
-            fprintf(stderr, "Max number of hop times reached %d\n", MAX_FREQS);
-        break;
-    case 'g':
-        if (!arg)
-            help_gain();
+            magnitude_est_cs16((int16_t const *)iq_buf + 2 * pos, demod->buf.temp, n);
+        baseband_low_pass_filter(&demod->lowpass_filter_state, demod->buf.temp, &demod->am_buf[pos], n);
+        if (with_fm && demod->sample_format == BASEBAND_CU8)
+            baseband_demod_FM(&demod->demod_FM_state, &iq_buf[2 * pos], &demod->buf.fm[pos], n, samp_rate, low_pass);
+        else if (with_fm)
+            baseband_demod_FM_cs16(&demod->demod_FM_state, (int16_t const *)iq_buf + 2 * pos, &demod->buf.fm[pos], n, samp_rate, low_pass);
+        i = end;
+    }
+}
 
-        free(cfg->gain_str);
-        cfg->gain_str = strdup(arg);
-        if (!cfg->gain_str)
-            FATAL_STRDUP("parse_conf_option()");
-        break;
-    case 'G':
-        fprintf(stderr, "register_all (-G) is deprecated. Use -R or a config file to enable additional protocols.\n");
-        exit(1);
-        break;
-    case 'p':
-        cfg->ppm_error = atobv(arg, 0);
-        break;
-    case 's':
-        cfg->samp_rate = atouint32_metric(arg, "-s: ");
-        break;
-    case 'b':
-        cfg->out_block_size = atouint32_metric(arg, "-b: ");
-        break;
-    case 'l':
-        n = 1000;
-        if (arg && atoi(arg) > 0)
-            n = atoi(arg);
-        fprintf(stderr, "\n\tLevel limit has changed from \"-l %d\" to \"-Y level=%.1f\" in dB.\n\n", n, AMP_TO_DB(n));
-        exit(1);
-        break;
-    case 'n':
-        cfg->bytes_to_read = atouint32_metric(arg, "-n: ") * 2;
-        break;
-    case 'a':
-        if (atobv(arg, 1) == 42 && !cfg->demod->am_analyze) {
-            cfg->demod->am_analyze = am_analyze_create();
-        }
-        else {
+// log the time of a startup phase with -M startup
+static void startup_phase(r_cfg_t *cfg, char const *phase)
+{
+    if (!cfg->startup_profile) {
+        return;
+    }
+    uint64_t now_ns = time_monotonic_ns();
+    // Essential information (not quiet)
+    print_logf(LOG_CRITICAL, "Startup", "%-13s %8.1f ms, %8.1f ms since start", phase,
+            (now_ns - cfg->startup_last_ns) / 1e6, (now_ns - cfg->startup_ns) / 1e6);
+    cfg->startup_last_ns = now_ns;
+}
+
+static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
+{
+    //fprintf(stderr, "sdr_callback... %u\n", len);
+    r_cfg_t *cfg = ctx;
+    struct dm_state *demod = cfg->demod;
+    char time_str[LOCAL_TIME_BUFLEN];
+    unsigned long n_samples;
+
+    if (!demod) {
+        // might happen when the demod closed and we get a last data frame
+        return; // ignore the data
+    }
+    demod->callback_start_ns = time_monotonic_ns();
+    R_TRACE2(callback_entry, len, cfg->input_pos);
+    if (cfg->startup_profile) {
+        startup_phase(cfg, "first sample");
+        cfg->startup_profile = 0;
+    }
+    // a reload swaps the decoders between two buffers, the channels are idle now too, the pipeline is drained
+    if (atomic_load_acquire(&cfg->staged_decoders)) {
+        package_queue_retire(cfg->package_queue, 1);
+    }
+    r_apply_staged_decoders(cfg);
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        r_apply_staged_decoders(*iter);
+    }
+    trace_event_t *trace = trace_event_active(cfg->trace) ? cfg->trace : NULL;
+    // the channels are fed by the primary, only the primary waits for the input
+    if (trace && demod->callback_end_ns && !cfg->primary) {
+        trace_event_span(trace, "acquire", "input", cfg->trace_tid, demod->callback_end_ns, demod->callback_start_ns);
+    }
+
+    // do this here and not in sdr_handler so realtime replay can use rtl_tcp output
+    for (void **iter = cfg->raw_handler.elems; iter && *iter; ++iter) {
+        raw_output_t *output = *iter;
+        raw_output_frame(output, iq_buf, len, cfg->input_pos);
+    }
+
+    if ((cfg->bytes_to_read > 0) && (cfg->bytes_to_read <= len)) {
+        len = cfg->bytes_to_read;
+        cfg->exit_async = 1;
+    }
+
+    // a channel keeps the demod start of its input
+    if (cfg->report_latency && !demod->demod_start_ns)
+        demod->demod_start_ns = get_time_now_ns();
+
+    // save last frame time to see if a new second started
+    time_t last_frame_sec = demod->now.tv_sec;
+
+    n_samples = len / demod->sample_size;
+    if (n_samples * demod->sample_size != len) {
+        print_logf_limited(LOG_WARNING, __func__, "Sample buffer length not aligned to sample size!");
+    }
+
+    if (demod->sample_time_ns && cfg->samp_rate) {
+        // hardware time of the buffer end, not skewed by scheduling
+        int64_t end_ns = demod->sample_time_ns + (int64_t)n_samples * 1000000000 / cfg->samp_rate;
+        demod->now.tv_sec  = (time_t)(end_ns / 1000000000);
+        demod->now.tv_usec = (long)(end_ns % 1000000000 / 1000);
+    }
+    else {
+        get_time_now(&demod->now);
+    }
+    if (!n_samples) {
+        print_logf_limited(LOG_WARNING, __func__, "Sample buffer too short!");
+        return; // keep the watchdog timer running
+    }
+
+    // age the frame position if there is one
+    if (demod->frame_start_ago)
+        demod->frame_start_ago += n_samples;
+    if (demod->frame_end_ago)
+        demod->frame_end_ago += n_samples;
+
+    cfg->watchdog++; // reset the frame acquire watchdog
+
+    if (demod->samp_grab) {
+        samp_grab_push(demod->samp_grab, iq_buf, len);
+    }
+
+    // between the expected transmissions the frame is skipped, the stream keeps running to stay in sync
+    if (cfg->duty_cycle && cfg->samp_rate && !duty_cycle_listen(cfg->duty_cycle, cfg->input_pos * 1000 / cfg->samp_rate)) {
+        if (cfg->channelizer || cfg->decimator)
+            skip_channels(cfg, n_samples);
+        cfg->frames_dozed += 1;
+        end_sdr_frame(cfg, len, n_samples, 0);
+        return;
+    }
+
+    // AM and FM input files are already demodulated
+    if ((cfg->channelizer || cfg->decimator) && demod->load_info.format != S16_AM && demod->load_info.format != S16_FM) {
+        int d_events = demod_channels(cfg, iq_buf, n_samples);
+        end_sdr_frame(cfg, len, n_samples, d_events);
+        return;
+    }
+
+    r_reserve_demod_buffers(cfg, n_samples);
+
+    // Select the correct fsk pulse detector
+    unsigned fpdm = cfg->fsk_pulse_detect_mode;
+    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
+        if (cfg->frequency[cfg->frequency_index] > FSK_PULSE_DETECTOR_LIMIT)
+            fpdm = FSK_PULSE_DETECT_NEW;
+        else
+            fpdm = FSK_PULSE_DETECT_OLD;
+    }
+    float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
+
+    // time the AM demod, low pass filter, and FM demod for the stats report
+    struct timeval bb_start;
+    get_time_now(&bb_start);
+    uint64_t bb_start_ns = trace ? time_monotonic_ns() : 0;
+
+    // AM demodulation
+    float avg_db;
+    // under load the FM demod is shed on a frequency without FSK decoders, and the squelch turned on
+    int fm_demod = demod->enable_FM_demod && !(demod->shed_step >= LOAD_SHED_FM && demod->band_frequency && !demod->band_fsk_devs.len);
+    // FSK of a known deviation is detected by its two tones instead
+    uint32_t tones = fm_demod ? fsk_tones_deviation(cfg) : 0;
+    fm_demod       = fm_demod && !tones;
+    int squelch  = demod->squelch_offset > 0 || demod->shed_step >= LOAD_SHED_SQUELCH;
+    // without squelch every frame is processed, run the AM and FM demod in one cache friendly pass
+    int fused = !squelch;
+    // the FSK pulse detector only reads the FM of the pulses, demod only the parts with a carrier unless all FM samples are used
+    int all_fm     = demod->analyze_pulses || demod->dumper.len || demod->samp_grab;
+    int carrier_fm = fm_demod && !all_fm;
+    // with squelch a strided level estimate can rule out a silent frame before the full envelope pass
+    int prefilter = squelch && demod->noise_level != 0.0f
+            && !demod->load_info.format && !demod->analyze_pulses && !demod->dumper.len && !demod->samp_grab;
+    int prefiltered = 0;
+    // a frame with activity in parts only runs the demod over the active sub-blocks
+    uint8_t active[SQUELCH_SUBBLOCKS_MAX];
+    uint32_t block_len = 0;
+    unsigned marked    = 0;
+    if (prefilter) {
+        float est_db    = squelch_level(demod, iq_buf, n_samples);
+        unsigned blocks = 0;
+        if (demod->sample_format == BASEBAND_CU8 || demod->sample_format == BASEBAND_CS16) {
+            // a short burst is averaged away over a long frame, decide on sub-blocks of whole strides
+            block_len = cfg->samp_rate / 1000 * SQUELCH_SUBBLOCK_MS;
+            if (block_len < (n_samples + SQUELCH_SUBBLOCKS_MAX - 1) / SQUELCH_SUBBLOCKS_MAX)
+                block_len = (n_samples + SQUELCH_SUBBLOCKS_MAX - 1) / SQUELCH_SUBBLOCKS_MAX;
+            block_len = (block_len + SQUELCH_PREFILTER_STRIDE - 1) / SQUELCH_PREFILTER_STRIDE * SQUELCH_PREFILTER_STRIDE;
+            blocks    = (n_samples + block_len - 1) / block_len;
+            marked    = squelch_subblocks(demod, iq_buf, n_samples, block_len, active);
+        }
+        // only trust the estimate if it is clearly below the squelch level
+        if (blocks ? !marked : est_db < demod->noise_level + 3.0f - SQUELCH_PREFILTER_MARGIN) {
+            avg_db      = est_db;
+            prefiltered = 1;
+            block_len   = 0;
+            cfg->total_frames_prefilter += 1;
+            cfg->frames_prefilter_hit += 1;
+        }
+        else if (marked < blocks) {
+            avg_db = est_db;
+            cfg->frames_prefilter_miss += 1;
+            cfg->frames_subblock += 1;
+        }
+        else {
+            block_len = 0; // active throughout, the full pass gives the exact level
+            cfg->frames_prefilter_miss += 1;
+        }
+    }
+    if (fused) {
+        avg_db = baseband_demod_fused(&demod->lowpass_filter_state, &demod->demod_FM_state, iq_buf, demod->sample_format, demod->use_mag_est,
+                demod->am_buf, fm_demod && !carrier_fm ? demod->buf.fm : NULL, n_samples, cfg->samp_rate, low_pass);
+    }
+    else if (prefiltered) {
+        // silent frame, skip the envelope
+    }
+    else if (block_len) {
+        demod_subblocks(demod, iq_buf, n_samples, block_len, active, fm_demod && !carrier_fm, cfg->samp_rate, low_pass);
+    }
+    else if (demod->sample_format == BASEBAND_CS8) {
+        if (demod->use_mag_est)
+            avg_db = magnitude_est_cs8((int8_t *)iq_buf, demod->buf.temp, n_samples);
+        else
+            avg_db = envelope_detect_cs8((int8_t *)iq_buf, demod->buf.temp, n_samples);
+    }
+    else if (demod->sample_format == BASEBAND_CF32) {
+        avg_db = magnitude_est_cf32((float *)iq_buf, demod->buf.temp, n_samples);
+    }
+    else if (demod->sample_size == 2) { // CU8
+        if (demod->use_mag_est) {
+            //magnitude_true_cu8(iq_buf, demod->buf.temp, n_samples);
+            avg_db = magnitude_est_cu8(iq_buf, demod->buf.temp, n_samples);
+        }
+        else { // amp est
+            avg_db = envelope_detect(iq_buf, demod->buf.temp, n_samples);
+        }
+    } else { // CS16
+        //magnitude_true_cs16((int16_t *)iq_buf, demod->buf.temp, n_samples);
+        avg_db = magnitude_est_cs16((int16_t *)iq_buf, demod->buf.temp, n_samples);
+    }
+
+    //fprintf(stderr, "noise level: %.1f dB current: %.1f dB min level: %.1f dB\n", demod->noise_level, avg_db, demod->min_level_auto);
+    if (demod->min_level_auto == 0.0f) {
+        demod->min_level_auto = demod->min_level;
+    }
+    if (demod->noise_level == 0.0f) {
+        demod->noise_level = demod->min_level_auto - 3.0f;
+    }
+    int noise_only = avg_db < demod->noise_level + 3.0f; // or demod->min_level_auto?
+    // always process frames if loader, dumper, or analyzers are in use, otherwise skip silent frames
+    int process_frame = !squelch || !noise_only || marked || demod->load_info.format || demod->analyze_pulses || demod->dumper.len || demod->samp_grab;
+    cfg->total_frames_count += 1;
+    if (noise_only) {
+        cfg->total_frames_squelch += 1;
+        cfg->frames_squelch += 1;
+        demod->noise_level = (demod->noise_level * 7 + avg_db) / 8; // fast fall over 8 frames
+        // If auto_level and noise level well below min_level and significant change in noise level
+        if (demod->auto_level > 0 && demod->noise_level < demod->min_level - 3.0f
+                && fabsf(demod->min_level_auto - demod->noise_level - 3.0f) > 1.0f) {
+            demod->min_level_auto = demod->noise_level + 3.0f;
+            print_logf(LOG_WARNING, "Auto Level", "Estimated noise level is %.1f dB, adjusting minimum detection level to %.1f dB",
+                    demod->noise_level, demod->min_level_auto);
+            pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level_auto, demod->min_snr, demod->detect_verbosity);
+        }
+    } else {
+        demod->noise_level = (demod->noise_level * 31 + avg_db) / 32; // slow rise over 32 frames
+    }
+    // Report noise every report_noise seconds, but only for the first frame that second
+    if (cfg->report_noise && last_frame_sec != demod->now.tv_sec && demod->now.tv_sec % cfg->report_noise == 0) {
+        print_logf(LOG_WARNING, "Auto Level", "Current %s level %.1f dB, estimated noise %.1f dB",
+                noise_only ? "noise" : "signal", avg_db, demod->noise_level);
+    }
+
+    if (process_frame && !fused && !block_len) {
+        baseband_low_pass_filter(&demod->lowpass_filter_state, demod->buf.temp, demod->am_buf, n_samples);
+    }
+
+    // FM demodulation
+    if (carrier_fm && process_frame) {
+        int carrier_level = pulse_detect_carrier_level(demod->pulse_detect);
+        cfg->frames_fm_samples += baseband_demod_FM_carrier(&demod->demod_FM_state, iq_buf, demod->sample_format, demod->am_buf, carrier_level,
+                demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+        cfg->frames_fm_total += n_samples;
+    }
+    else if (fm_demod && process_frame && !fused && !block_len) {
+        if (demod->sample_format == BASEBAND_CS8) {
+            baseband_demod_FM_cs8(&demod->demod_FM_state, (int8_t *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+        } else if (demod->sample_format == BASEBAND_CF32) {
+            baseband_demod_FM_cf32(&demod->demod_FM_state, (float *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+        } else if (demod->sample_size == 2) { // CU8
+            baseband_demod_FM(&demod->demod_FM_state, iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+        } else { // CS16
+            baseband_demod_FM_cs16(&demod->demod_FM_state, (int16_t *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+        }
+    }
+    else if (tones && process_frame) {
+        int carrier_level = all_fm ? 0 : pulse_detect_carrier_level(demod->pulse_detect);
+        cfg->frames_fm_samples += baseband_demod_tones(&demod->demod_tones_state, iq_buf, demod->sample_format, demod->am_buf, carrier_level,
+                demod->buf.fm, n_samples, cfg->samp_rate, tones);
+        cfg->frames_fm_total += n_samples;
+    }
+
+    struct timeval bb_end, bb_elapsed;
+    get_time_now(&bb_end);
+    timeval_subtract(&bb_elapsed, &bb_end, &bb_start);
+    cfg->frames_baseband_us += bb_elapsed.tv_sec * 1000000 + bb_elapsed.tv_usec;
+    if (trace) {
+        trace_event_span(trace, "baseband", "dsp", cfg->trace_tid, bb_start_ns, time_monotonic_ns());
+    }
+
+    // Handle special input formats
+    if (demod->load_info.format == S16_AM) { // The IQ buffer is really AM demodulated data
+        memcpy(demod->am_buf, iq_buf, n_samples * sizeof(*demod->am_buf));
+    } else if (demod->load_info.format == S16_FM) { // The IQ buffer is really FM demodulated data
+        // we would need AM for the envelope too
+        memcpy(demod->buf.fm, iq_buf, n_samples * sizeof(*demod->buf.fm));
+    }
+
+    int d_events = 0; // Sensor events successfully detected
+    if (demod->r_devs.len || cfg->raw_mode || demod->analyze_pulses || demod->dumper.len || demod->samp_grab || has_pulse_outputs(cfg)) {
+        // Detect a package and loop through demodulators with pulse data
+        int package_type = PULSE_DATA_OOK;  // Just to get us started
+        unsigned frame_events = demod->frame_event_count;
+        for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+            file_info_t const *dumper = *iter;
+            if (dumper->format == U8_LOGIC) {
+                memset(demod->u8_buf, 0, n_samples);
+                break;
+            }
+        }
+        while (package_type && process_frame) {
+            uint64_t detect_start = time_monotonic_ns();
+            package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
+            uint64_t detect_end = time_monotonic_ns();
+            cfg->frames_detect_ns += detect_end - detect_start;
+            if (trace) {
+                trace_event_span(trace, "pulse detect", "dsp", cfg->trace_tid, detect_start, detect_end);
+            }
+            if (!package_type) {
+                break;
+            }
+            pulse_data_t *pulses = package_type == PULSE_DATA_FSK ? &demod->fsk_pulse_data : &demod->pulse_data;
+            R_TRACE6(package, package_type, pulses->num_pulses, pulses->start_ago - pulses->end_ago, pulses->pulse, pulses->gap, cfg->samp_rate);
+            if (cfg->report_latency) {
+                demod->detect_ns      = get_time_now_ns();
+                demod->package_end_ns = demod->publish_ns && cfg->samp_rate ? demod->publish_ns - (int64_t)pulses->end_ago * 1000000000 / cfg->samp_rate : 0;
+            }
+            // new package: set a first frame start if we are not tracking one already
+            if (!demod->frame_start_ago)
+                demod->frame_start_ago = demod->pulse_data.start_ago;
+            // always update the last frame end
+            demod->frame_end_ago = demod->pulse_data.end_ago;
+            // a chunk of a file only decodes the packages starting in its own range
+            if (pulses->offset < cfg->package_begin || (cfg->package_end && pulses->offset >= cfg->package_end))
+                continue;
+
+            calc_rssi_snr(cfg, pulses);
+            pulses->received_us = package_time_us(cfg, pulses);
+            send_pulses(cfg, pulses, package_type);
+            if (demod->analyze_pulses == 1) fprintf(stderr, "Detected %s package\t%s\n", package_type == PULSE_DATA_FSK ? "FSK" : "OOK", time_pos_str(cfg, pulses->start_ago, time_str));
+            for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+                file_info_t const *dumper = *iter;
+                if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, pulses, package_type == PULSE_DATA_FSK ? 0x04 : 0x02);
+            }
+
+            // the pipeline decodes the package while the detection goes on, it is finished once retired
+            if (cfg->package_queue) {
+                queue_package(cfg, pulses, package_type);
+                continue;
+            }
+            uint64_t decode_ns;
+            int p_events = decode_pulses(cfg, pulses, package_type, cfg->trace_tid, &cfg->frames_budget_skipped, &decode_ns);
+            finish_package(cfg, pulses, package_type, p_events, decode_ns);
+        } // while (package_type)...
+        // the pipeline only decodes whole packages
+        if (cfg->early_decode && process_frame && !cfg->package_queue)
+            decode_early(cfg);
+
+        // the events of a frame decide the grab, all its packages are decoded when it ends
+        package_queue_retire(cfg->package_queue, demod->frame_start_ago && demod->frame_end_ago > n_samples);
+        d_events = (int)(demod->frame_event_count - frame_events);
+
+        // end frame tracking if older than a whole buffer
+        if (demod->frame_start_ago && demod->frame_end_ago > n_samples) {
+            if (demod->samp_grab) {
+                if (cfg->grab_mode == 1
+                        || (cfg->grab_mode == 2 && demod->frame_event_count == 0)
+                        || (cfg->grab_mode == 3 && demod->frame_event_count > 0)) {
+                    samp_grab_write_frame(demod->samp_grab, demod->frame_start_ago, demod->frame_end_ago, n_samples);
+                }
+            }
+            demod->frame_start_ago = 0;
+            demod->frame_event_count = 0;
+        }
+
+        // dump partial pulse_data for this buffer
+        for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+            file_info_t const *dumper = *iter;
+            if (dumper->format == U8_LOGIC) {
+                pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->pulse_data, 0x02);
+                pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->fsk_pulse_data, 0x04);
+                break;
+            }
+        }
+    }
+
+    if (demod->am_analyze) {
+        am_analyze(demod->am_analyze, demod->am_buf, n_samples, cfg->verbosity >= LOG_INFO, NULL);
+    }
+
+    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t const *dumper = *iter;
+        if (!dumper->writer) // pulse dumpers print each package as it is detected
+            continue;
+        // samples are converted into the next buffer of the writer, the thread writes the file
+        unsigned long out_len = n_samples * dumper_sample_size(dumper->format, demod->sample_size);
+        uint8_t *out_buf      = file_writer_reserve(dumper->writer, out_len);
+        if (!out_buf) {
+            print_log(LOG_ERROR, __func__, "No buffer for the samples, exiting!");
+            cfg->exit_async = 1;
+            continue;
+        }
+        float *f32_buf                = (float *)out_buf;
+        int16_t const *cs16_buf       = (int16_t const *)iq_buf;
+        convert_kernels_t const *conv = convert_kernels();
+
+        if (dumper->format == CU8_IQ && demod->sample_size == 4) {
+            conv->cs16_to_cu8(cs16_buf, out_buf, n_samples * 2);
+        }
+        else if (dumper->format == CS16_IQ && demod->sample_size == 2) {
+            conv->cu8_to_cs16(iq_buf, (int16_t *)out_buf, n_samples * 2);
+        }
+        else if (dumper->format == CS8_IQ) {
+            if (demod->sample_size == 2)
+                conv->cu8_cs8(iq_buf, out_buf, n_samples * 2);
+            else if (demod->sample_size == 4)
+                conv->cs16_to_cs8(cs16_buf, (int8_t *)out_buf, n_samples * 2);
+        }
+        else if (dumper->format == CF32_IQ) {
+            if (demod->sample_size == 2)
+                conv->u8_to_f32(iq_buf, f32_buf, n_samples * 2);
+            else if (demod->sample_size == 4)
+                conv->s16_to_f32(cs16_buf, f32_buf, n_samples * 2);
+        }
+        else if (dumper->format == S16_AM) {
+            memcpy(out_buf, demod->am_buf, out_len);
+        }
+        else if (dumper->format == S16_FM) {
+            memcpy(out_buf, demod->buf.fm, out_len);
+        }
+        else if (dumper->format == F32_AM) {
+            conv->s16_to_f32(demod->am_buf, f32_buf, n_samples);
+        }
+        else if (dumper->format == F32_FM) {
+            conv->s16_to_f32(demod->buf.fm, f32_buf, n_samples);
+        }
+        else if (dumper->format == F32_I || dumper->format == F32_Q) {
+            int q = dumper->format == F32_Q; // the Q channel starts at the second value
+            if (demod->sample_size == 2)
+                conv->u8_channel_to_f32(iq_buf + q, f32_buf, n_samples);
+            else
+                conv->s16_channel_to_f32(cs16_buf + q, f32_buf, n_samples);
+        }
+        else if (dumper->format == U8_LOGIC) { // state data
+            memcpy(out_buf, demod->u8_buf, out_len);
+        }
+        else { // the IQ samples as is
+            memcpy(out_buf, iq_buf, out_len);
+        }
+
+        if (file_writer_commit(dumper->writer, out_len) < 0) {
+            print_log(LOG_ERROR, __func__, "Short write, samples lost, exiting!");
+            cfg->exit_async = 1;
+        }
+    }
+
+    end_sdr_frame(cfg, len, n_samples, d_events);
+}
+
+// -A takes an optional mode word, i.e. "-A batch", consumed here as getopt can't
+static char *opt_mode_arg(int opt, int argc, char *argv[])
+{
+    if (opt == 'A' && optind < argc && !strcasecmp(argv[optind], "batch"))
+        return argv[optind++];
+    return optarg;
+}
+
+static int hasopt(int test, int argc, char *argv[], char const *optstring)
+{
+    int opt;
+
+    optind = 1; // reset getopt
+    while ((opt = getopt(argc, argv, optstring)) != -1) {
+        opt_mode_arg(opt, argc, argv);
+        if (opt == test || optopt == test)
+            return opt;
+    }
+    return 0;
+}
+
+static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg);
+
+/// Packages the pipeline decodes behind the detection, unless given (-Y pipeline).
+#define PIPELINE_PACKAGES 16
+/// Upper bound for the packages of the pipeline set by the user.
+#define PIPELINE_PACKAGES_LIMIT 1024
+/// Realtime load to shed load at, unless given (-Y shed), it is restored under 2/3 of it.
+#define LOAD_SHED_HIGH 0.9f
+/// Signal time to measure the SDR transfers over, unless given (-b tune).
+#define BUF_TUNE_SECONDS 60
+
+#define OPTSTRING "hVvqD:c:x:z:p:a:AI:S:m:M:r:w:W:l:d:t:f:H:g:s:N:Z:j:J:b:LPn:R:X:F:K:C:T:UGy:E:Y:u:"
+
+// these should match the short options exactly
+static struct conf_keywords const conf_keywords[] = {
+        {"help", 'h'},
+        {"verbose", 'v'},
+        {"version", 'V'},
+        {"config_file", 'c'},
+        {"report_meta", 'M'},
+        {"device", 'd'},
+        {"device_mode", 'D'},
+        {"settings", 't'},
+        {"gain", 'g'},
+        {"frequency", 'f'},
+        {"hop_interval", 'H'},
+        {"ppm_error", 'p'},
+        {"sample_rate", 's'},
+        {"channels", 'N'},
+        {"decimate", 'Z'},
+        {"threads", 'j'},
+        {"decoder_threads", 'J'},
+        {"protocol", 'R'},
+        {"decoder", 'X'},
+        {"register_all", 'G'},
+        {"out_block_size", 'b'},
+        {"low_latency", 'L'},
+        {"frequency_plan", 'P'},
+        {"level_limit", 'l'},
+        {"samples_to_read", 'n'},
+        {"analyze", 'a'},
+        {"analyze_pulses", 'A'},
+        {"include_only", 'I'},
+        {"read_file", 'r'},
+        {"write_file", 'w'},
+        {"overwrite_file", 'W'},
+        {"signal_grabber", 'S'},
+        {"override_short", 'z'},
+        {"override_long", 'x'},
+        {"pulse_detect", 'Y'},
+        {"output", 'F'},
+        {"output_tag", 'K'},
+        {"convert", 'C'},
+        {"tenant", 'u'},
+        {"duration", 'T'},
+        {"test_data", 'y'},
+        {"stop_after_successful_events", 'E'},
+        {NULL, 0}};
+
+static void parse_conf_text(r_cfg_t *cfg, char *conf)
+{
+    int opt;
+    char *arg;
+    char *p = conf;
+
+    if (!conf || !*conf)
+        return;
+
+    // the tenant pipelines of a config file end with it
+    unsigned tenant = cfg->tenant;
+    cfg->tenant     = 0;
+    while ((opt = getconf(&p, conf_keywords, &arg)) != -1) {
+        parse_conf_option(cfg, opt, arg);
+    }
+    cfg->tenant = tenant;
+}
+
+static void parse_conf_file(r_cfg_t *cfg, char const *path)
+{
+    if (!path || !*path || !strcmp(path, "null") || !strcmp(path, "0"))
+        return;
+
+    char *conf = readconf(path);
+    parse_conf_text(cfg, conf);
+    //free(conf); // TODO: check no args are dangling, then use free
+}
+
+static void parse_conf_try_default_files(r_cfg_t *cfg)
+{
+    char **paths = compat_get_default_conf_paths();
+    for (int a = 0; paths[a]; a++) {
+        // fprintf(stderr, "Trying conf file at \"%s\"...\n", paths[a]);
+        if (hasconf(paths[a])) {
+            fprintf(stderr, "Reading conf from \"%s\".\n", paths[a]);
+            parse_conf_file(cfg, paths[a]);
+            break;
+        }
+    }
+}
+
+static void parse_conf_args(r_cfg_t *cfg, int argc, char *argv[])
+{
+    int opt;
+
+    optind = 1; // reset getopt
+    while ((opt = getopt(argc, argv, OPTSTRING)) != -1) {
+        if (opt == '?')
+            opt = optopt; // allow missing arguments
+        parse_conf_option(cfg, opt, opt_mode_arg(opt, argc, argv));
+    }
+    cfg->tenant = 0;
+}
+
+/// Protocol options (-R, -X, -u) as option char and arg, replayed on each additional receiver.
+static list_t protocol_opts;
+
+static void record_protocol_opt(r_cfg_t *cfg, int opt, char const *arg)
+{
+    if (cfg->primary || !arg) {
+        return; // only record options on the primary
+    }
+    size_t len = strlen(arg);
+    char *rec = malloc(len + 2);
+    if (!rec)
+        FATAL_MALLOC("record_protocol_opt()");
+    rec[0] = (char)opt;
+    memcpy(rec + 1, arg, len + 1);
+    list_push(&protocol_opts, rec);
+}
+
+static void replay_protocol_opts(r_cfg_t *rcv, list_t *args)
+{
+    for (void **iter = protocol_opts.elems; iter && *iter; ++iter) {
+        char const *rec = *iter;
+        // decoders may keep or modify the arg, use a copy for each receiver
+        char *arg = strdup(rec + 1);
+        if (!arg)
+            FATAL_STRDUP("replay_protocol_opts()");
+        list_push(args, arg);
+        parse_conf_option(rcv, rec[0], arg);
+    }
+    rcv->tenant = 0;
+}
+
+// selects the tenant pipeline of the name for the options that follow, the primary adds a new one
+static void select_tenant(r_cfg_t *cfg, char const *name)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    for (size_t i = 0; i < root->tenants.len; ++i) {
+        tenant_t const *tenant = root->tenants.elems[i];
+        if (!strcmp(tenant->name, name)) {
+            cfg->tenant = (unsigned)i + 1;
+            return;
+        }
+    }
+    if (root != cfg) {
+        fprintf(stderr, "Unknown tenant \"%s\"\n", name);
+        exit(1);
+    }
+    tenant_t *tenant = calloc(1, sizeof(*tenant));
+    if (!tenant)
+        FATAL_CALLOC("select_tenant()");
+    tenant->name = strdup(name);
+    if (!tenant->name)
+        FATAL_STRDUP("select_tenant()");
+    tenant->conversion_mode = CONVERT_NATIVE;
+    list_push(&cfg->tenants, tenant);
+    cfg->tenant = (unsigned)cfg->tenants.len;
+}
+
+// takes the option ",filter=<expr>" out of an output option, the expression ends at a `,` or `:` outside of a string
+static output_filter_t *take_output_filter(char *arg)
+{
+    char *opt = strstr(arg, ",filter=");
+    if (!opt) {
+        return NULL;
+    }
+    char *expr = opt + 8;
+    char *end  = expr;
+    for (int quoted = 0; *end && (quoted || (*end != ',' && *end != ':')); ++end) {
+        if (quoted && end[0] == '\\' && end[1] == '"')
+            end++;
+        else if (*end == '"')
+            quoted = !quoted;
+    }
+    char next = *end;
+    *end      = '\0';
+    char err[256];
+    output_filter_t *filter = output_filter_create(expr, err, sizeof(err));
+    if (!filter) {
+        fprintf(stderr, "Invalid output filter: %s\n", err);
+        exit(1);
+    }
+    *end = next;
+    memmove(opt, end, strlen(end) + 1);
+    return filter;
+}
+
+// adds the output of an output option (-F)
+// the webhook outputs post to a server, the "http" output is the server
+static int is_webhook_output(char const *arg)
+{
+    return strncmp(arg, "http_post", 9) == 0 || strncmp(arg, "https_post", 10) == 0;
+}
+
+static void add_output(r_cfg_t *cfg, char *arg)
+{
+    output_filter_t *filter = take_output_filter(arg);
+    size_t len              = cfg->output_handler.len;
+
+    if (strncmp(arg, "json", 4) == 0) {
+        add_json_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "csv", 3) == 0) {
+        add_csv_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "cbor", 4) == 0) {
+        add_cbor_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "msgpack", 7) == 0) {
+        add_msgpack_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "arrow", 5) == 0) {
+        add_arrow_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "log", 3) == 0) {
+        add_log_output(cfg, arg_param(arg));
+        cfg->has_logout = 1;
+    }
+    else if (strncmp(arg, "kv", 2) == 0) {
+        add_kv_output(cfg, arg_param(arg));
+        cfg->has_logout = 1;
+    }
+    else if (strncmp(arg, "mqtt", 4) == 0) {
+        add_mqtt_output(cfg, arg);
+    }
+    else if (strncmp(arg, "influx", 6) == 0) {
+        add_influx_output(cfg, arg);
+    }
+    else if (strncmp(arg, "syslog", 6) == 0) {
+        add_syslog_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "unix", 4) == 0) {
+        add_unix_output(cfg, arg_param(arg));
+    }
+    else if (is_webhook_output(arg)) {
+        add_webhook_output(cfg, arg);
+    }
+    else if (strncmp(arg, "http", 4) == 0) {
+        add_http_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "trigger", 7) == 0) {
+        add_trigger_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "null", 4) == 0) {
+        add_null_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "rtl_tcp", 7) == 0) {
+        add_rtltcp_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "shm", 3) == 0) {
+        add_shm_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "pulses", 6) == 0) {
+        add_pulses_output(cfg, arg_param(arg));
+    }
+    else if (strncmp(arg, "fusion", 6) == 0) {
+        add_fusion_output(cfg, arg_param(arg));
+    }
+    else {
+        fprintf(stderr, "Invalid output format: %s\n", arg);
+        usage(1);
+    }
+
+    // the events are filtered before any output formats them, e.g. before a queue
+    if (filter) {
+        data_output_t *output = cfg->output_handler.len > len ? cfg->output_handler.elems[len] : NULL;
+        if (!output) {
+            fprintf(stderr, "The output \"%s\" has no events to filter\n", arg);
+            exit(1);
+        }
+        output->filter = filter;
+    }
+}
+
+/// An output option (-F) and the event output it added, kept to reuse unchanged outputs on a reload.
+typedef struct output_opt {
+    char *arg;             ///< the option, NULL for the default output
+    data_output_t *output; ///< the event output, NULL for the null output and the outputs of samples and pulses
+    unsigned tenant;       ///< the tenant pipeline of the output, 0 for the default pipeline
+    int claimed;           ///< reused by the reload in progress
+} output_opt_t;
+
+/// Output options of the primary in the order given.
+static list_t output_opts;
+/// Output options parsed by the reload in progress.
+static list_t reload_output_opts;
+
+// the outputs of the samples and pulses feed on the input, the HTTP server also serves the commands,
+// the fusion holds events, a reload keeps them
+static int output_is_fixed(char const *arg)
+{
+    return arg && ((strncmp(arg, "http", 4) == 0 && !is_webhook_output(arg))
+            || strncmp(arg, "rtl_tcp", 7) == 0
+            || strncmp(arg, "shm", 3) == 0
+            || strncmp(arg, "pulses", 6) == 0
+            || strncmp(arg, "fusion", 6) == 0);
+}
+
+static void free_output_opt(output_opt_t *rec)
+{
+    free(rec->arg);
+    free(rec);
+}
+
+// adds the output of an option, or the default output for a NULL arg, a reload reuses an unchanged output
+static void add_output_opt(r_cfg_t *cfg, char *arg)
+{
+    if (cfg->tenant && output_is_fixed(arg)) {
+        fprintf(stderr, "The output \"%s\" can not be used in a tenant pipeline\n", arg);
+        exit(1);
+    }
+    if (cfg->parse_reload && output_is_fixed(arg)) {
+        return; // the output started with the option is kept
+    }
+    output_opt_t *rec = calloc(1, sizeof(*rec));
+    if (!rec)
+        FATAL_CALLOC("add_output_opt()");
+    rec->tenant = cfg->tenant;
+    if (arg) {
+        // the output may modify the arg
+        rec->arg = strdup(arg);
+        if (!rec->arg)
+            FATAL_STRDUP("add_output_opt()");
+    }
+
+    if (cfg->parse_reload) {
+        list_push(&reload_output_opts, rec);
+        for (void **iter = output_opts.elems; iter && *iter; ++iter) {
+            output_opt_t *old = *iter;
+            if (!old->claimed && old->tenant == rec->tenant && (arg ? old->arg && !strcmp(old->arg, arg) : !old->arg)) {
+                old->claimed = 1;
+                rec->output  = old->output;
+                return;
+            }
+        }
+    }
+    else {
+        list_push(&output_opts, rec);
+    }
+
+    size_t len = cfg->output_handler.len;
+    if (arg)
+        add_output(cfg, arg);
+    else
+        add_kv_output(cfg, NULL);
+    if (cfg->output_handler.len > len)
+        rec->output = cfg->output_handler.elems[len];
+    for (size_t i = len; i < cfg->output_handler.len; ++i) {
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (output)
+            output->tenant = cfg->tenant;
+    }
+}
+
+// the decoders of the tenant pipeline convert to its mode
+static void set_tenant_conversion(r_cfg_t *cfg, conversion_mode_t mode)
+{
+    tenant_t *tenant = cfg->tenants.elems[cfg->tenant - 1];
+    tenant->conversion_mode = mode;
+    for (void **iter = cfg->demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->tenant == cfg->tenant)
+            r_dev->conversion_mode = mode;
+    }
+}
+
+// parse a list of protocol numbers separated by commas, zero terminated
+static unsigned *parse_protocol_list(r_cfg_t *cfg, char const *arg)
+{
+    unsigned *protocols = calloc(strlen(arg) / 2 + 2, sizeof(*protocols));
+    if (!protocols)
+        FATAL_CALLOC("parse_protocol_list()");
+    unsigned n = 0;
+    for (char const *p = arg; *p;) {
+        char *end;
+        long num = strtol(p, &end, 10);
+        if (end == p || (*end && *end != ',') || num < 1 || num > cfg->num_r_devices) {
+            fprintf(stderr, "-f: Invalid protocol list \"%s\"\n", arg);
+            exit(1);
+        }
+        protocols[n++] = (unsigned)num;
+        p = *end ? end + 1 : end;
+    }
+    return protocols;
+}
+
+static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
+{
+    int n;
+    r_device *flex_device;
+    conversion_mode_t conversion_mode;
+
+    if (arg && (!strcmp(arg, "help") || !strcmp(arg, "?"))) {
+        arg = NULL; // remove the arg if it's a request for the usage help
+    }
+
+    // a reload only applies the decoder and output options, the config files are read again
+    if (cfg->parse_reload && (!opt || !strchr("cRXFu", opt)) && !(opt == 'C' && cfg->tenant)) {
+        return;
+    }
+
+    // tuner options following a repeated input device option apply to that receiver
+    if (cfg->receivers.len && opt && strchr("ftgpsHNZ", opt)) {
+        cfg = cfg->receivers.elems[cfg->receivers.len - 1];
+    }
+
+    switch (opt) {
+    case 'h':
+        usage(0);
+        break;
+    case 'V':
+        exit(0); // we already printed the version
+        break;
+    case 'v':
+        if (!arg)
+            cfg->verbosity++;
+        else
+            cfg->verbosity = atobv(arg, 1);
+        break;
+    case 'c':
+        parse_conf_file(cfg, arg);
+        break;
+    case 'd':
+        if (!arg)
+            help_device_selection();
+
+        if (cfg->dev_query) {
+            r_create_receiver(cfg, arg);
+        }
+        else {
+            cfg->dev_query = arg;
+        }
+        break;
+    case 'D':
+        if (!arg)
+            help_device_mode();
+
+        if (strcmp(arg, "quit") == 0) {
+            cfg->dev_mode = DEVICE_MODE_QUIT;
+        }
+        else if (strcmp(arg, "restart") == 0) {
+            cfg->dev_mode = DEVICE_MODE_RESTART;
+        }
+        else if (strcmp(arg, "pause") == 0) {
+            cfg->dev_mode = DEVICE_MODE_PAUSE;
+        }
+        else if (strcmp(arg, "manual") == 0) {
+            cfg->dev_mode = DEVICE_MODE_MANUAL;
+        }
+        else {
+            fprintf(stderr, "Invalid input device run mode: %s\n", arg);
+            help_device_mode();
+        }
+        break;
+    case 't':
+        // this option changed, check and warn if old meaning is used
+        if (!arg || *arg == '-') {
+            fprintf(stderr, "test_mode (-t) is deprecated. Use -S none|all|unknown|known\n");
+            exit(1);
+        }
+        cfg->settings_str = arg;
+        break;
+    case 'f':
+        if (cfg->frequencies < MAX_FREQS) {
+            char *protocols = arg ? strchr(arg, ':') : NULL;
+            if (protocols) {
+                *protocols++ = '\0';
+                cfg->frequency_protocols[cfg->frequencies] = parse_protocol_list(cfg, protocols);
+            }
+            uint32_t sr = atouint32_metric(arg, "-f: ");
+            /* If the frequency is above 800MHz sample at 1MS/s */
+            if ((sr > FSK_PULSE_DETECTOR_LIMIT) && (cfg->samp_rate == DEFAULT_SAMPLE_RATE)) {
+                cfg->samp_rate = 1000000;
+                fprintf(stderr, "\nNew defaults active, use \"-Y classic -s 250k\" if you need the old defaults\n\n");
+            }
+            cfg->frequency[cfg->frequencies++] = sr;
+        } else
+            fprintf(stderr, "Max number of frequencies reached %d\n", MAX_FREQS);
+        break;
+    case 'H':
+        if (arg && !strcasecmp(arg, "adaptive"))
+            cfg->hop_adaptive = 1;
+        else if (cfg->hop_times < MAX_FREQS)
+            cfg->hop_time[cfg->hop_times++] = atoi_time(arg, "-H: ");
+        else
+            fprintf(stderr, "Max number of hop times reached %d\n", MAX_FREQS);
+        break;
+    case 'g':
+        if (!arg)
+            help_gain();
+
+        free(cfg->gain_str);
+        cfg->gain_str = strdup(arg);
+        if (!cfg->gain_str)
+            FATAL_STRDUP("parse_conf_option()");
+        break;
+    case 'G':
+        fprintf(stderr, "register_all (-G) is deprecated. Use -R or a config file to enable additional protocols.\n");
+        exit(1);
+        break;
+    case 'p':
+        cfg->ppm_error = atobv(arg, 0);
+        break;
+    case 's':
+        cfg->samp_rate = atouint32_metric(arg, "-s: ");
+        break;
+    case 'N':
+        cfg->channel_count = atoiv(arg, 0);
+        cfg->spectrum_gate = 0.0f;
+        cfg->channel_gpu   = 0;
+        char const *gate   = arg_param(arg);
+        if (gate && !strncasecmp(gate, "gpu", 3) && (gate[3] == '\0' || gate[3] == ':')) {
+            cfg->channel_gpu = 1;
+            gate = arg_param(gate);
+        }
+        if (gate) {
+            char const *val  = NULL;
+            if (!kwargs_match(gate, "gate", &val)) {
+                fprintf(stderr, "Invalid channel option \"%s\", use e.g. -N 8:gate, -N 8:gate=12, or -N 8:gpu:gate\n", gate);
+                exit(1);
+            }
+            cfg->spectrum_gate = val ? (float)arg_float(val, "-N gate: ") : SPECTRUM_THRESHOLD_DB;
+            if (cfg->spectrum_gate <= 0.0f) {
+                fprintf(stderr, "The channel gate level must be above 0 dB.\n");
+                exit(1);
+            }
+        }
+        if (cfg->channel_count != 0 && (cfg->channel_count < 2 || cfg->channel_count > CHANNELIZER_MAX_CHANNELS || cfg->channel_count % 2)) {
+            fprintf(stderr, "Number of channels must be an even number from 2 to %d.\n", CHANNELIZER_MAX_CHANNELS);
+            exit(1);
+        }
+        break;
+    case 'j':
+        if (arg && strncmp(arg, "batch:", 6) == 0) {
+            if (strncmp(arg + 6, "tcp:", 4) != 0) {
+                fprintf(stderr, "Expected e.g. -j batch:tcp://:4434, not \"%s\".\n", arg);
+                exit(1);
+            }
+            cfg->batch_listen = arg + 6;
+            break;
+        }
+        cfg->worker_threads = atoiv(arg, 1);
+        if (cfg->worker_threads < 1 || cfg->worker_threads > WORKER_POOL_MAX_THREADS) {
+            fprintf(stderr, "Number of threads must be from 1 to %d.\n", WORKER_POOL_MAX_THREADS);
+            exit(1);
+        }
+        break;
+    case 'J':
+        cfg->decoder_threads = atoiv(arg, 1);
+        if (cfg->decoder_threads < 1 || cfg->decoder_threads > WORKER_POOL_MAX_THREADS) {
+            fprintf(stderr, "Number of threads must be from 1 to %d.\n", WORKER_POOL_MAX_THREADS);
+            exit(1);
+        }
+        break;
+    case 'Z':
+        if (!arg)
+            usage(1);
+        cfg->decimation = atoiv(arg, 0);
+        if (cfg->decimation != 0 && (cfg->decimation < 2 || cfg->decimation > DECIMATOR_MAX_FACTOR || (cfg->decimation & (cfg->decimation - 1)))) {
+            fprintf(stderr, "Decimation must be a power of two from 2 to %d.\n", DECIMATOR_MAX_FACTOR);
+            exit(1);
+        }
+        char const *shift = strchr(arg, ':');
+        cfg->decimation_shift = 0;
+        if (shift && shift[1] == '-')
+            cfg->decimation_shift = -(int)atouint32_metric(shift + 2, "-Z: ");
+        else if (shift)
+            cfg->decimation_shift = (int)atouint32_metric(shift + 1, "-Z: ");
+        break;
+    case 'b':
+        if (arg && !strncmp(arg, "tune", 4)) {
+            // small transfers to start with, merged while the demod is behind
+            cfg->low_latency = 1;
+            cfg->buf_tune_s  = arg[4] == '=' ? atoi_time(arg + 5, "-b tune: ") : BUF_TUNE_SECONDS;
+            if (cfg->buf_tune_s <= 0) {
+                fprintf(stderr, "-b tune: the tuning time must be positive\n");
+                usage(1);
+            }
+        }
+        else {
+            // the size and the count of the SDR transfers, e.g. as reported by -b tune
+            char size[32] = {0};
+            char const *count = arg ? strchr(arg, ':') : NULL;
+            if (count && (size_t)(count - arg) < sizeof(size))
+                memcpy(size, arg, count - arg);
+            cfg->out_block_size = atouint32_metric(count ? size : arg, "-b: ");
+            cfg->buf_num        = count ? atouint32_metric(count + 1, "-b: ") : 0;
+        }
+        break;
+    case 'L':
+        cfg->low_latency = atobv(arg, 1);
+        break;
+    case 'P':
+        cfg->plan_frequencies = atobv(arg, 1);
+        break;
+    case 'l':
+        n = 1000;
+        if (arg && atoi(arg) > 0)
+            n = atoi(arg);
+        fprintf(stderr, "\n\tLevel limit has changed from \"-l %d\" to \"-Y level=%.1f\" in dB.\n\n", n, AMP_TO_DB(n));
+        exit(1);
+        break;
+    case 'n':
+        cfg->bytes_to_read = atouint32_metric(arg, "-n: ") * 2;
+        break;
+    case 'a':
+        if (atobv(arg, 1) == 42 && !cfg->demod->am_analyze) {
+            cfg->demod->am_analyze = am_analyze_create();
+        }
+        else {
             fprintf(stderr, "\n\tUse -a for testing only. Enable if you know how ;)\n\n");
             exit(1);
         }
-        break;
-    case 'A':
-        cfg->demod->analyze_pulses = atobv(arg, 1);
-        break;
-    case 'I':
-        fprintf(stderr, "include_only (-I) is deprecated. Use -S none|all|unknown|known\n");
+        break;
+    case 'A':
+        if (arg && !strcasecmp(arg, "batch"))
+            cfg->demod->analyze_pulses = 2;
+        else
+            cfg->demod->analyze_pulses = atobv(arg, 1);
+        break;
+    case 'I':
+        fprintf(stderr, "include_only (-I) is deprecated. Use -S none|all|unknown|known\n");
+        exit(1);
+        break;
+    case 'r':
+        if (!arg)
+            help_read();
+
+        add_infile(cfg, arg);
+        // TODO: file_info_check_read()
+        break;
+    case 'w':
+        if (!arg)
+            help_write();
+
+        add_dumper(cfg, arg, 0);
+        break;
+    case 'W':
+        if (!arg)
+            help_write();
+
+        add_dumper(cfg, arg, 1);
+        break;
+    case 'S':
+        if (!arg)
+            usage(1);
+        size_t mode_len = strcspn(arg, ",");
+        if (mode_len == 3 && strncasecmp(arg, "all", mode_len) == 0)
+            cfg->grab_mode = 1;
+        else if (mode_len == 7 && strncasecmp(arg, "unknown", mode_len) == 0)
+            cfg->grab_mode = 2;
+        else if (mode_len == 5 && strncasecmp(arg, "known", mode_len) == 0)
+            cfg->grab_mode = 3;
+        else
+            cfg->grab_mode = atobv(arg, 1);
+        if (cfg->grab_mode && !cfg->demod->samp_grab)
+            cfg->demod->samp_grab = samp_grab_create(SIGNAL_GRABBER_BUFFER);
+        if (cfg->demod->samp_grab) {
+            int pre_ms  = -1;
+            int post_ms = -1;
+            for (char const *p = kwargs_skip(arg); p && *p; p = kwargs_skip(p)) {
+                char const *val = NULL;
+                if (kwargs_match(p, "pre", &val))
+                    pre_ms = atoiv(val, -1);
+                else if (kwargs_match(p, "post", &val))
+                    post_ms = atoiv(val, -1);
+                else if (kwargs_match(p, "pad", &val))
+                    pre_ms = post_ms = atoiv(val, -1);
+                else {
+                    fprintf(stderr, "Unknown signal grabber setting: %s\n", p);
+                    usage(1);
+                }
+            }
+            samp_grab_set_padding(cfg->demod->samp_grab, pre_ms, post_ms);
+        }
+        break;
+    case 'm':
+        fprintf(stderr, "sample mode option is deprecated.\n");
+        usage(1);
+        break;
+    case 'M':
+        if (!arg)
+            help_meta();
+
+        if (!strncasecmp(arg, "time", 4)) {
+            char *p = arg_param(arg);
+            // time  time:1  time:on  time:yes
+            // time:0  time:off  time:no
+            // time:rel
+            // time:unix
+            // time:iso
+            // time:...:usec  time:...:sec
+            // time:...:utc  time:...:local
+            cfg->report_time = REPORT_TIME_DATE;
+            while (p && *p) {
+                if (!strncasecmp(p, "0", 1) || !strncasecmp(p, "no", 2) || !strncasecmp(p, "off", 3))
+                    cfg->report_time = REPORT_TIME_OFF;
+                else if (!strncasecmp(p, "1", 1) || !strncasecmp(p, "yes", 3) || !strncasecmp(p, "on", 2))
+                    cfg->report_time = REPORT_TIME_DATE;
+                else if (!strncasecmp(p, "rel", 3))
+                    cfg->report_time = REPORT_TIME_SAMPLES;
+                else if (!strncasecmp(p, "unix", 4))
+                    cfg->report_time = REPORT_TIME_UNIX;
+                else if (!strncasecmp(p, "iso", 3))
+                    cfg->report_time = REPORT_TIME_ISO;
+                else if (!strncasecmp(p, "usec", 4))
+                    cfg->report_time_hires = 1;
+                else if (!strncasecmp(p, "sec", 3))
+                    cfg->report_time_hires = 0;
+                else if (!strncasecmp(p, "tz", 2))
+                    cfg->report_time_tz = 1;
+                else if (!strncasecmp(p, "notz", 4))
+                    cfg->report_time_tz = 0;
+                else if (!strncasecmp(p, "utc", 3))
+                    cfg->report_time_utc = 1;
+                else if (!strncasecmp(p, "local", 5))
+                    cfg->report_time_utc = 0;
+                else {
+                    fprintf(stderr, "Unknown time format option: %s\n", p);
+                    help_meta();
+                }
+
+                p = arg_param(p);
+            }
+            // fprintf(stderr, "time format: %d, usec:%d utc:%d\n", cfg->report_time, cfg->report_time_hires, cfg->report_time_utc);
+        }
+
+        // TODO: old time options, remove someday
+        else if (!strcasecmp(arg, "reltime"))
+            cfg->report_time = REPORT_TIME_SAMPLES;
+        else if (!strcasecmp(arg, "notime"))
+            cfg->report_time = REPORT_TIME_OFF;
+        else if (!strcasecmp(arg, "hires"))
+            cfg->report_time_hires = 1;
+        else if (!strcasecmp(arg, "utc"))
+            cfg->report_time_utc = 1;
+        else if (!strcasecmp(arg, "noutc"))
+            cfg->report_time_utc = 0;
+
+        else if (!strcasecmp(arg, "protocol"))
+            cfg->report_protocol = 1;
+        else if (!strcasecmp(arg, "noprotocol"))
+            cfg->report_protocol = 0;
+        else if (!strcasecmp(arg, "level"))
+            cfg->report_meta = 1;
+        else if (!strcasecmp(arg, "latency"))
+            cfg->report_latency = 1;
+        else if (!strncasecmp(arg, "noise", 5))
+            cfg->report_noise = atoiv(arg_param(arg), 10); // atoi_time_default()
+        else if (!strcasecmp(arg, "bits"))
+            cfg->verbose_bits = 1;
+        else if (!strcasecmp(arg, "description"))
+            cfg->report_description = 1;
+        else if (!strncasecmp(arg, "raw", 3) && (!arg[3] || arg[3] == ':')) {
+            // raw  raw:unknown  raw:known:rfraw
+            char *p       = arg_param(arg);
+            cfg->raw_mode = 1;
+            while (p && *p) {
+                if (!strncasecmp(p, "all", 3))
+                    cfg->raw_mode = 1;
+                else if (!strncasecmp(p, "unknown", 7))
+                    cfg->raw_mode = 2;
+                else if (!strncasecmp(p, "known", 5))
+                    cfg->raw_mode = 3;
+                else if (!strncasecmp(p, "rfraw", 5))
+                    cfg->raw_rfraw = 1;
+                else if (!strncasecmp(p, "pulses", 6))
+                    cfg->raw_rfraw = 0;
+                else {
+                    fprintf(stderr, "Unknown raw option: %s\n", p);
+                    help_meta();
+                }
+                p = arg_param(p);
+            }
+        }
+        else if (!strcasecmp(arg, "newmodel"))
+            fprintf(stderr, "newmodel option (-M) is deprecated.\n");
+        else if (!strcasecmp(arg, "oldmodel"))
+            fprintf(stderr, "oldmodel option (-M) is deprecated.\n");
+        else if (!strncasecmp(arg, "stats", 5)) {
+            // there also should be options to set whether to flush on report
+            char *p = arg_param(arg);
+            set_report_stats(cfg, atoiv(p, 1));
+            cfg->stats_interval = atoiv(arg_param(p), 600); // atoi_time_default()
+            time(&cfg->stats_time);
+            cfg->stats_time += cfg->stats_interval;
+        }
+        else if (!strncasecmp(arg, "trace", 5)) {
+            char *p = arg_param(arg);
+            if (!p || !*p) {
+                fprintf(stderr, "-M trace: missing file name\n");
+                usage(1);
+            }
+            free(cfg->trace_path);
+            cfg->trace_path = strdup(p);
+            if (!cfg->trace_path)
+                FATAL_STRDUP("parse_conf_option()");
+            // a trailing ":<secs>" limits the duration, a path might contain colons
+            char *secs = strrchr(cfg->trace_path, ':');
+            if (secs && secs[1] && strspn(secs + 1, "0123456789") == strlen(secs + 1)) {
+                *secs = '\0';
+                cfg->trace_secs = atoiv(secs + 1, 0);
+            }
+        }
+        else if (!strcasecmp(arg, "startup")) {
+            cfg->startup_profile = 1;
+        }
+        else if (!strncasecmp(arg, "usage", 5) && (!arg[5] || arg[5] == ':')) {
+            char *p = arg_param(arg);
+            // the decoders registered so far are timed from now on
+            cfg->decoder_usage_report = 1;
+            set_report_stats(cfg, cfg->report_stats);
+            free(cfg->decoder_usage_path);
+            cfg->decoder_usage_path = NULL;
+            if (p && *p) {
+                cfg->decoder_usage_path = strdup(p);
+                if (!cfg->decoder_usage_path)
+                    FATAL_STRDUP("parse_conf_option()");
+            }
+        }
+        else if (!strncasecmp(arg, "autotune", 8)) {
+            char *p              = arg_param(arg);
+            cfg->kernel_autotune = 1;
+            free(cfg->kernel_cache_path);
+            cfg->kernel_cache_path = NULL;
+            if (p && *p) {
+                cfg->kernel_cache_path = strdup(p);
+                if (!cfg->kernel_cache_path)
+                    FATAL_STRDUP("parse_conf_option()");
+            }
+        }
+        else if (!strncasecmp(arg, "threads", 7)) {
+            char *spec = arg_param(arg);
+            if (!spec || !*spec) {
+                fprintf(stderr, "-M threads: missing settings, e.g. threads:acquire=0/fifo/50,demod=1\n");
+                usage(1);
+            }
+            spec = strdup(spec);
+            if (!spec)
+                FATAL_STRDUP("parse_conf_option()");
+            char *p = spec;
+            char *key;
+            char *val;
+            while (getkwargs(&p, &key, &val)) {
+                key = remove_ws(key);
+                val = trim_ws(val);
+                if (!key || !*key)
+                    continue;
+                if (thread_sched_set(key, val)) {
+                    fprintf(stderr, "-M threads: invalid setting \"%s=%s\"\n", key, val ? val : "");
+                    usage(1);
+                }
+            }
+            free(spec);
+        }
+        else if (!strncasecmp(arg, "memory", 6)) {
+            char *spec = arg_param(arg);
+            if (!spec || !*spec) {
+                fprintf(stderr, "-M memory: missing limits, e.g. memory:http=2M,network=4M\n");
+                usage(1);
+            }
+            spec = strdup(spec);
+            if (!spec)
+                FATAL_STRDUP("parse_conf_option()");
+            char *p = spec;
+            char *key;
+            char *val;
+            while (getkwargs(&p, &key, &val)) {
+                key = remove_ws(key);
+                val = trim_ws(val);
+                if (!key || !*key)
+                    continue;
+                if (mem_acct_set_limit(key, atouint32_metric(val, "-M memory: "))) {
+                    fprintf(stderr, "-M memory: unknown subsystem \"%s\"\n", key);
+                    usage(1);
+                }
+            }
+            free(spec);
+        }
+        else if (!strncasecmp(arg, "duty", 4)) {
+            // the times may not use the h:m:s form, the colon separates them
+            char times[64] = "";
+            snprintf(times, sizeof(times), "%s", arg_param(arg) ? arg_param(arg) : "");
+            char *every = strchr(times, ':');
+            if (every)
+                *every++ = '\0';
+            cfg->duty_survey = *times ? atoi_time(times, "-M duty: ") : 180;
+            cfg->duty_every  = every && *every ? atoi_time(every, "-M duty: ") : 3600;
+            if (cfg->duty_survey <= 0 || cfg->duty_every < cfg->duty_survey) {
+                fprintf(stderr, "-M duty: the full listen window needs to be positive and not longer than its interval\n");
+                usage(1);
+            }
+        }
+        else if (!strncasecmp(arg, "recorder", 8)) {
+            // the time may not use the h:m:s form, the colon separates the size
+            char secs[64] = "";
+            snprintf(secs, sizeof(secs), "%s", arg_param(arg) ? arg_param(arg) : "");
+            char *size = strchr(secs, ':');
+            if (size)
+                *size++ = '\0';
+            int recorder_secs  = *secs ? atoi_time(secs, "-M recorder: ") : 600;
+            cfg->recorder_size = size && *size ? atouint32_metric(size, "-M recorder: ") : 4000000;
+            if (recorder_secs <= 0 || cfg->recorder_size < 4000) {
+                fprintf(stderr, "-M recorder: the time needs to be positive and the size at least 4k\n");
+                usage(1);
+            }
+            cfg->recorder_secs = (unsigned)recorder_secs;
+        }
+        else if (!strncasecmp(arg, "throttle", 8)) {
+            // the interval may not use the h:m:s form, the colon separates the mode
+            char interval[64] = "";
+            snprintf(interval, sizeof(interval), "%s", arg_param(arg) ? arg_param(arg) : "");
+            char *mode = strchr(interval, ':');
+            if (mode)
+                *mode++ = '\0';
+            cfg->throttle_secs = *interval ? atoi_time(interval, "-M throttle: ") : 60;
+            if (cfg->throttle_secs <= 0) {
+                fprintf(stderr, "-M throttle: the interval needs to be positive\n");
+                usage(1);
+            }
+            if (!mode || !*mode || !strcasecmp(mode, "latest"))
+                cfg->throttle_mode = THROTTLE_LATEST;
+            else if (!strcasecmp(mode, "avg"))
+                cfg->throttle_mode = THROTTLE_AVG;
+            else if (!strcasecmp(mode, "min"))
+                cfg->throttle_mode = THROTTLE_MIN;
+            else if (!strcasecmp(mode, "max"))
+                cfg->throttle_mode = THROTTLE_MAX;
+            else {
+                fprintf(stderr, "-M throttle: unknown mode \"%s\", use latest, avg, min, or max\n", mode);
+                usage(1);
+            }
+        }
+        else if (!strncasecmp(arg, "order", 5)) {
+            char *window = arg_param(arg);
+            cfg->merge_window_ms = window && *window ? atoi_ms(window, "-M order: ") : 1000;
+            if (!cfg->merge_window_ms) {
+                fprintf(stderr, "-M order: the window needs to be positive\n");
+                usage(1);
+            }
+        }
+        else if (!strncasecmp(arg, "devices", 7)) {
+            int max_sensors = atoiv(arg_param(arg), 1000);
+            if (max_sensors <= 0 || max_sensors > 1000000) {
+                fprintf(stderr, "-M devices: the count needs to be 1 to 1000000\n");
+                usage(1);
+            }
+            cfg->max_sensors = (unsigned)max_sensors;
+        }
+        else if (!strncasecmp(arg, "bench", 5)) {
+            cfg->in_replay     = -1;
+            cfg->bench_repeats = atoiv(arg_param(arg), 10);
+        }
+        else if (!strncasecmp(arg, "replay", 6)) {
+            char *p = arg_param(arg);
+            if (p && !strncasecmp(p, "max", 3)) {
+                cfg->in_replay = -1;
+                p = arg_param(p);
+                if (p)
+                    cfg->replay_clock_ns = (int64_t)(arg_float(p, "-M replay:max: ") * 1e9);
+            }
+            else {
+                cfg->in_replay = atobv(p, 1);
+            }
+        }
+        else
+            cfg->report_meta = atobv(arg, 1);
+        break;
+    case 'z':
+        fprintf(stderr, "override_short (-z) is deprecated.\n");
+        break;
+    case 'x':
+        fprintf(stderr, "override_long (-x) is deprecated.\n");
+        break;
+    case 'R':
+        if (!arg)
+            help_protocols(cfg->devices, cfg->num_r_devices, 0);
+
+        // use arg of 'v', 'vv', 'vvv' as global device verbosity
+        if (*arg == 'v') {
+            int decoder_verbosity = 0;
+            for (int i = 0; arg[i] == 'v'; ++i) {
+                decoder_verbosity += 1;
+            }
+            (void)decoder_verbosity; // FIXME: use this
+            break;
+        }
+
+        record_protocol_opt(cfg, opt, arg);
+        if (!strncasecmp(arg, "shard=", 6)) {
+            unsigned shard = 0, shards = 0;
+            if (sscanf(arg + 6, "%u/%u", &shard, &shards) != 2 || shard < 1 || shard > shards) {
+                fprintf(stderr, "Invalid decoder shard \"%s\", use e.g. shard=1/4\n", arg + 6);
+                exit(1);
+            }
+            cfg->decoder_shard  = shard;
+            cfg->decoder_shards = shards;
+            char const *costs   = strchr(arg + 6, ':');
+            free(cfg->shard_costs);
+            cfg->shard_costs = NULL;
+            if (costs) {
+                cfg->shard_costs = strdup(costs + 1);
+                if (!cfg->shard_costs)
+                    FATAL_STRDUP("parse_conf_option()");
+            }
+            break;
+        }
+        n = atoi(arg);
+        if (n > cfg->num_r_devices || -n > cfg->num_r_devices) {
+            fprintf(stderr, "Protocol number specified (%d) is larger than number of protocols\n\n", n);
+            help_protocols(cfg->devices, cfg->num_r_devices, 1);
+        }
+        if ((n > 0 && cfg->devices[n - 1].disabled > 2) || (n < 0 && cfg->devices[-n - 1].disabled > 2)) {
+            fprintf(stderr, "Protocol number specified (%d) is invalid\n\n", n);
+            help_protocols(cfg->devices, cfg->num_r_devices, 1);
+        }
+
+        // a tenant pipeline only has the decoders it lists
+        if (n < 0 && !cfg->no_default_devices && !cfg->tenant) {
+            register_all_protocols(cfg, 0); // register all defaults
+        }
+        if (!cfg->tenant) {
+            cfg->no_default_devices = 1;
+        }
+
+        if (n >= 1) {
+            register_protocol(cfg, &cfg->devices[n - 1], arg_param(arg));
+        }
+        else if (n <= -1) {
+            unregister_protocol(cfg, &cfg->devices[-n - 1]);
+        }
+        else {
+            fprintf(stderr, "Disabling all device decoders.\n");
+            unregister_all_protocols(cfg);
+        }
+        break;
+    case 'X':
+        if (!arg)
+            flex_create_device(NULL);
+
+        record_protocol_opt(cfg, opt, arg);
+        flex_device = flex_create_device(arg);
+        register_decoder(cfg, flex_device);
+        break;
+    case 'q':
+        fprintf(stderr, "quiet option (-q) is default and deprecated. See -v to increase verbosity\n");
+        break;
+    case 'F':
+        if (!arg)
+            help_output();
+
+        add_output_opt(cfg, arg);
+        break;
+    case 'K':
+        if (!arg)
+            help_tags();
+        add_data_tag(cfg, arg);
+        break;
+    case 'C':
+        if (!arg)
+            usage(1);
+        if (strcmp(arg, "native") == 0) {
+            conversion_mode = CONVERT_NATIVE;
+        }
+        else if (strcmp(arg, "si") == 0) {
+            conversion_mode = CONVERT_SI;
+        }
+        else if (strcmp(arg, "customary") == 0) {
+            conversion_mode = CONVERT_CUSTOMARY;
+        }
+        else {
+            fprintf(stderr, "Invalid conversion mode: %s\n", arg);
+            usage(1);
+        }
+        if (cfg->tenant)
+            set_tenant_conversion(cfg, conversion_mode);
+        else
+            cfg->conversion_mode = conversion_mode;
+        break;
+    case 'u':
+        if (!arg || !*arg)
+            usage(1);
+        record_protocol_opt(cfg, opt, arg);
+        select_tenant(cfg, arg);
+        break;
+    case 'U':
+        fprintf(stderr, "UTC mode option (-U) is deprecated. Please use \"-M utc\".\n");
+        exit(1);
+        break;
+    case 'T':
+        cfg->duration = atoi_time(arg, "-T: ");
+        if (cfg->duration < 1) {
+            fprintf(stderr, "Duration '%s' not a positive number; will continue indefinitely\n", arg);
+        }
+        break;
+    case 'y':
+        cfg->test_data = arg;
+        break;
+    case 'Y':
+        if (!arg)
+            usage(1);
+        char const *p = arg;
+        while (p && *p) {
+            char const *val = NULL;
+            if (kwargs_match(p, "autolevel", &val))
+                cfg->demod->auto_level = atoiv(val, 1); // arg_float_default(p + 9, "-Y autolevel: ");
+            else if (kwargs_match(p, "squelch", &val))
+                cfg->demod->squelch_offset = atoiv(val, 1); // arg_float_default(p + 7, "-Y squelch: ");
+            else if (kwargs_match(p, "auto", &val))
+                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_AUTO;
+            else if (kwargs_match(p, "classic", &val))
+                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_OLD;
+            else if (kwargs_match(p, "minmax", &val))
+                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_NEW;
+            else if (kwargs_match(p, "ampest", &val))
+                cfg->demod->use_mag_est = 0;
+            else if (kwargs_match(p, "verbose", &val))
+                cfg->demod->detect_verbosity++;
+            else if (kwargs_match(p, "magest", &val))
+                cfg->demod->use_mag_est = 1;
+            else if (kwargs_match(p, "level", &val))
+                cfg->demod->level_limit = arg_float(val, "-Y level: ");
+            else if (kwargs_match(p, "minlevel", &val))
+                cfg->demod->min_level = arg_float(val, "-Y minlevel: ");
+            else if (kwargs_match(p, "minsnr", &val))
+                cfg->demod->min_snr = arg_float(val, "-Y minsnr: ");
+            else if (kwargs_match(p, "maxpulses", &val)) {
+                int max_pulses = atoiv(val, PD_MAX_PULSES);
+                if (max_pulses < PD_MIN_PULSES || max_pulses > PD_MAX_PULSES_LIMIT) {
+                    fprintf(stderr, "Maximum number of pulses must be from %d to %d.\n", PD_MIN_PULSES, PD_MAX_PULSES_LIMIT);
+                    exit(1);
+                }
+                cfg->demod->pulse_data.max_pulses     = (unsigned)max_pulses;
+                cfg->demod->fsk_pulse_data.max_pulses = (unsigned)max_pulses;
+            }
+            else if (kwargs_match(p, "maxgap", &val)) {
+                cfg->demod->max_gap_ms = atoiv(val, 0);
+                if (cfg->demod->max_gap_ms < 0 || cfg->demod->max_gap_ms > 1000) {
+                    fprintf(stderr, "Maximum gap must be from 1 to 1000 ms, 0 for the reset limits of the decoders.\n");
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "dedup", &val)) {
+                cfg->dedup_ms = atoiv(val, 1000);
+                if (cfg->dedup_ms < 0) {
+                    fprintf(stderr, "Repeat window must be a positive number of ms.\n");
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "early", &val))
+                cfg->early_decode = atobv(val, 1);
+            else if (kwargs_match(p, "kernels", &val)) {
+                if (!val || baseband_select(val) < 0 || convert_select(val) < 0) {
+                    fprintf(stderr, "Kernels \"%s\" are not supported, e.g. scalar, sse2, avx2, or neon as the CPU supports.\n", val ? val : "");
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "budget", &val)) {
+                cfg->decode_budget_us = atoiv(val, 0);
+                if (cfg->decode_budget_us <= 0) {
+                    fprintf(stderr, "Decode budget must be a positive number of us.\n");
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "pipeline", &val)) {
+                cfg->pipeline_packages = atoiv(val, PIPELINE_PACKAGES);
+                if (cfg->pipeline_packages < 1 || cfg->pipeline_packages > PIPELINE_PACKAGES_LIMIT) {
+                    fprintf(stderr, "Pipeline must be from 1 to %d packages.\n", PIPELINE_PACKAGES_LIMIT);
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "shed", &val)) {
+                char *end = NULL;
+                cfg->load_shed_high = val && *val && *val != ',' ? (float)strtod(val, &end) : LOAD_SHED_HIGH;
+                cfg->load_shed_low  = end && *end == ':' ? (float)strtod(end + 1, NULL) : cfg->load_shed_high * 2 / 3;
+                if (cfg->load_shed_high <= 0.0f || cfg->load_shed_low <= 0.0f || cfg->load_shed_low >= cfg->load_shed_high) {
+                    fprintf(stderr, "Load shedding needs a high load over a low load, e.g. shed=0.9:0.6.\n");
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "amfilter", &val)) {
+                if (baseband_low_pass_filter_init(&cfg->demod->lowpass_filter_state, atoiv(val, 1)) < 0) {
+                    fprintf(stderr, "AM filter order must be 1 or an even number up to %d.\n", FILTER_MAX_ORDER);
+                    exit(1);
+                }
+            }
+            else if (kwargs_match(p, "warmstart", &val)) {
+                size_t len = val ? strcspn(val, ",") : 0;
+                if (!len) {
+                    fprintf(stderr, "Warm start needs a state file.\n");
+                    exit(1);
+                }
+                free(cfg->warm_start_path);
+                cfg->warm_start_path = malloc(len + 1);
+                if (!cfg->warm_start_path)
+                    FATAL_MALLOC("parse_conf_option()");
+                memcpy(cfg->warm_start_path, val, len);
+                cfg->warm_start_path[len] = '\0';
+            }
+            else if (kwargs_match(p, "filter", &val))
+                cfg->demod->low_pass = arg_float(val, "-Y filter: ");
+            else if (kwargs_match(p, "tones", &val)) {
+                char tones[64];
+                snprintf(tones, sizeof(tones), "%.*s", val ? (int)strcspn(val, ",") : 0, val ? val : "");
+                char *at = strchr(tones, '@');
+                if (at)
+                    *at++ = '\0';
+                if (cfg->fsk_tones >= MAX_FREQS) {
+                    fprintf(stderr, "Max number of tone settings reached %d\n", MAX_FREQS);
+                    exit(1);
+                }
+                uint32_t deviation = atouint32_metric(tones, "-Y tones: ");
+                if (deviation < 1000) {
+                    fprintf(stderr, "Tone deviation must be at least 1 kHz, e.g. tones=20k or tones=20k@868.3M.\n");
+                    exit(1);
+                }
+                cfg->fsk_tones_deviation[cfg->fsk_tones] = deviation;
+                cfg->fsk_tones_frequency[cfg->fsk_tones] = at ? atouint32_metric(at, "-Y tones: ") : 0;
+                cfg->fsk_tones += 1;
+            }
+            else {
+                fprintf(stderr, "Unknown pulse detector setting: %s\n", p);
+                usage(1);
+            }
+            p = kwargs_skip(p);
+        }
+        break;
+    case 'E':
+        if (arg && !strcmp(arg, "hop")) {
+            cfg->after_successful_events_flag = 2;
+        }
+        else if (arg && !strcmp(arg, "quit")) {
+            cfg->after_successful_events_flag = 1;
+        }
+        else {
+            cfg->after_successful_events_flag = atobv(arg, 1);
+        }
+        break;
+    default:
+        usage(1);
+        break;
+    }
+}
+
+// the protocols of the frequencies a planned center covers, NULL if one of them runs the decoders of its band
+static unsigned *plan_protocols(freq_plan_t const *plan, unsigned *const *wanted_protocols, unsigned device, unsigned index)
+{
+    size_t n = 0;
+    for (unsigned i = 0; i < freq_plan_wanted_count(plan); ++i) {
+        unsigned center;
+        if (freq_plan_device(plan, i, &center) != device || center != index)
+            continue;
+        if (!wanted_protocols[i])
+            return NULL;
+        for (unsigned const *p = wanted_protocols[i]; *p; ++p)
+            n++;
+    }
+
+    unsigned *protocols = calloc(n + 1, sizeof(*protocols));
+    if (!protocols)
+        FATAL_CALLOC("plan_protocols()");
+    size_t len = 0;
+    for (unsigned i = 0; i < freq_plan_wanted_count(plan); ++i) {
+        unsigned center;
+        if (freq_plan_device(plan, i, &center) != device || center != index)
+            continue;
+        for (unsigned const *p = wanted_protocols[i]; *p; ++p) {
+            size_t k = 0;
+            while (k < len && protocols[k] != *p)
+                k++;
+            if (k == len)
+                protocols[len++] = *p;
+        }
+    }
+    return protocols;
+}
+
+// tune the receivers so each frequency is in the passband of one, receivers with their own frequencies are kept
+static void plan_receiver_frequencies(r_cfg_t *cfg)
+{
+    uint32_t samp_rate[FREQ_PLAN_MAX_DEVICES];
+    unsigned devices = 0;
+    list_push(&cfg->plan_receivers, cfg);
+    samp_rate[devices++] = cfg->samp_rate;
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        if (rcv->frequencies)
+            continue;
+        if (devices == FREQ_PLAN_MAX_DEVICES) {
+            fprintf(stderr, "Max number of devices for the frequency plan reached %d\n", FREQ_PLAN_MAX_DEVICES);
+            exit(1);
+        }
+        list_push(&cfg->plan_receivers, rcv);
+        samp_rate[devices++] = rcv->samp_rate;
+    }
+
+    cfg->freq_plan = freq_plan_create(cfg->frequency, cfg->frequencies, samp_rate, devices);
+    if (!cfg->freq_plan) {
+        FATAL("Failed to plan the frequencies");
+    }
+    freq_plan_t const *plan = cfg->freq_plan;
+
+    // the planned centers replace the frequencies, the protocols move to the centers covering them
+    unsigned *wanted_protocols[MAX_FREQS];
+    memcpy(wanted_protocols, cfg->frequency_protocols, sizeof(wanted_protocols));
+    memset(cfg->frequency_protocols, 0, sizeof(cfg->frequency_protocols));
+
+    for (unsigned d = 0; d < devices; ++d) {
+        r_cfg_t *rcv = cfg->plan_receivers.elems[d];
+        unsigned centers = freq_plan_centers(plan, d);
+        for (unsigned i = 0; i < centers; ++i) {
+            rcv->frequency[i]           = freq_plan_center(plan, d, i);
+            rcv->frequency_protocols[i] = plan_protocols(plan, wanted_protocols, d, i);
+        }
+        rcv->frequencies     = (int)centers;
+        rcv->frequency_index = 0;
+        char const *input = rcv->dev_query ? rcv->dev_query : "0";
+        if (centers > 1)
+            print_logf(LOG_NOTICE, "Input", "Planned device \"%s\" to hop over %u center frequencies.", input, centers);
+        else
+            print_logf(LOG_NOTICE, "Input", "Planned device \"%s\" to %u Hz.", input, rcv->frequency[0]);
+    }
+    for (int i = 0; i < MAX_FREQS; ++i) {
+        free(wanted_protocols[i]);
+    }
+}
+
+static r_cfg_t g_cfg;
+static volatile sig_atomic_t sig_hup;
+
+// TODO: SIGINFO is not in POSIX...
+#ifndef SIGINFO
+#define SIGINFO 29
+#endif
+
+// NOTE: printf is not async safe per signal-safety(7)
+// writes a static string, without the terminating zero, to stderr, ignores return value
+#define write_err(s) (void)!write(STDERR_FILENO, (s), sizeof(s) - 1)
+
+#ifdef _WIN32
+BOOL WINAPI
+console_handler(int signum)
+{
+    if (CTRL_C_EVENT == signum) {
+        write_err("Signal caught, exiting!\n");
+        g_cfg.exit_async = 1;
+        // Uninstall handler, next Ctrl-C is a hard abort
+        SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_handler, FALSE);
+        return TRUE;
+    }
+    else if (CTRL_BREAK_EVENT == signum) {
+        write_err("CTRL-BREAK detected, hopping to next frequency (-f). Use CTRL-C to quit.\n");
+        g_cfg.hop_now = 1;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+#else
+static void sighandler(int signum)
+{
+    if (signum == SIGPIPE) {
+        // NOTE: we already ignore most network SIGPIPE's, this might be a STDOUT/STDERR problem.
+        // Printing is likely not the correct way to handle this.
+        write_err("Ignoring received signal SIGPIPE, Broken pipe.\n");
+        return;
+    }
+    else if (signum == SIGHUP) {
+        sig_hup = 1;
+        return;
+    }
+    else if (signum == SIGINFO/* TODO: maybe SIGUSR1 */) {
+        g_cfg.stats_now++;
+        return;
+    }
+    else if (signum == SIGUSR1) {
+        g_cfg.hop_now = 1;
+        return;
+    }
+    else {
+        write_err("Signal caught, exiting!\n");
+    }
+    g_cfg.exit_async = 1;
+
+    // Uninstall handler, next Ctrl-C is a hard abort
+    struct sigaction sigact;
+    sigact.sa_handler = NULL;
+    sigemptyset(&sigact.sa_mask);
+    sigact.sa_flags = 0;
+    sigaction(SIGINT, &sigact, NULL);
+    sigaction(SIGTERM, &sigact, NULL);
+    sigaction(SIGQUIT, &sigact, NULL);
+    sigaction(SIGPIPE, &sigact, NULL);
+}
+#endif
+
+static void install_signal_handlers(void)
+{
+#ifndef _WIN32
+    struct sigaction sigact;
+    sigact.sa_handler = sighandler;
+    sigemptyset(&sigact.sa_mask);
+    sigact.sa_flags = 0;
+    sigaction(SIGHUP, &sigact, NULL);
+    sigaction(SIGINT, &sigact, NULL);
+    sigaction(SIGTERM, &sigact, NULL);
+    sigaction(SIGQUIT, &sigact, NULL);
+    sigaction(SIGPIPE, &sigact, NULL);
+    sigaction(SIGUSR1, &sigact, NULL);
+    sigaction(SIGINFO, &sigact, NULL);
+#else
+    SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_handler, TRUE);
+#endif
+}
+
+static void timer_handler(struct mg_connection *nc, int ev, void *ev_data);
+
+// called on the demod thread, or by sdr_handler() if there is no demod thread.
+// the SDR transfers of an input, 0 for the default of the SDR
+static uint32_t sdr_buf_num(r_cfg_t const *cfg)
+{
+    return cfg->buf_num ? cfg->buf_num : cfg->low_latency ? LOW_LATENCY_BUF_NUMBER : DEFAULT_ASYNC_BUF_NUMBER;
+}
+
+// the events queued for the demod thread, the acquire thread never has more buffers outstanding than transfers
+static unsigned demod_queue_size(r_cfg_t const *cfg)
+{
+    unsigned size = cfg->low_latency ? LOW_LATENCY_BUF_NUMBER : SDR_DEFAULT_BUF_NUMBER;
+    return cfg->buf_num > size ? cfg->buf_num : size;
+}
+
+// measure the SDR transfers of an input, once measured the input restarts with the chosen ones
+static void tune_buffers(r_cfg_t *cfg, sdr_event_t const *ev, int64_t wait_ns, uint64_t busy_ns)
+{
+    uint32_t bytes_per_s = ev->sample_rate * (uint32_t)cfg->demod->sample_size;
+    uint64_t duration_ns = (uint64_t)ev->len * 1000000000 / bytes_per_s;
+    if (!buf_tune_buffer(cfg->buf_tune, ev->publish_ns, wait_ns > 0 ? (uint64_t)wait_ns : 0, busy_ns, duration_ns, ev->dropped + ev->overflows))
+        return;
+
+    // the ring stays within what the memory budget counted
+    uint32_t buf_num = sdr_buf_num(cfg) ? sdr_buf_num(cfg) : SDR_DEFAULT_BUF_NUMBER;
+    if (buf_tune_choose(cfg->buf_tune, bytes_per_s, cfg->out_block_size, (uint64_t)buf_num * cfg->out_block_size, demod_queue_size(cfg)) < 0)
+        return;
+    uint32_t num = buf_tune_buf_num(cfg->buf_tune);
+    uint32_t len = buf_tune_buf_len(cfg->buf_tune);
+    print_logf(LOG_NOTICE, "Input", "Tuned the SDR transfers to %u x %u bytes (p99 jitter %u us, processing %u us, wait %u us, %u lost), keep them with -b %u:%u",
+            num, len, buf_tune_jitter_us(cfg->buf_tune, 99), buf_tune_busy_us(cfg->buf_tune, 99), buf_tune_wait_us(cfg->buf_tune, 99),
+            buf_tune_lost(cfg->buf_tune), len, num);
+    if (num == buf_num && len == cfg->out_block_size)
+        return;
+    // later restarts of the input keep the tuned transfers
+    cfg->buf_num        = num;
+    cfg->out_block_size = len;
+    atomic_store_release(&cfg->buf_tune_restart, 1);
+}
+
+static void process_sdr_event(sdr_event_t *ev, void *ctx)
+{
+    r_cfg_t *cfg = ctx;
+
+    data_t *data = NULL;
+    if (ev->ev & SDR_EV_RATE) {
+        // cfg->samp_rate = ev->sample_rate;
+        data = data_int(data, "sample_rate", "", NULL, ev->sample_rate);
+    }
+    if (ev->ev & SDR_EV_CORR) {
+        // cfg->ppm_error = ev->freq_correction;
+        data = data_int(data, "freq_correction", "", NULL, ev->freq_correction);
+    }
+    if (ev->ev & SDR_EV_FREQ) {
+        // cfg->center_frequency = ev->center_frequency;
+        data = data_int(data, "center_frequency", "", NULL, ev->center_frequency);
+        if (cfg->frequencies > 1) {
+            data = data_ary(data, "frequencies", "", NULL, data_array(cfg->frequencies, DATA_INT, cfg->frequency));
+            data = data_ary(data, "hop_times", "", NULL, data_array(cfg->hop_times, DATA_INT, cfg->hop_time));
+        }
+        if (cfg->hop_scheduler) {
+            int dwells[MAX_FREQS];
+            for (int i = 0; i < cfg->frequencies; ++i) {
+                dwells[i] = (int)hop_scheduler_dwell_ms(cfg->hop_scheduler, (unsigned)i);
+            }
+            data = data_ary(data, "hop_dwells_ms", "", NULL, data_array(cfg->frequencies, DATA_INT, dwells));
+        }
+    }
+    if (ev->ev & SDR_EV_GAIN) {
+        data = data_str(data, "gain", "", NULL, ev->gain_str);
+    }
+    if (data) {
+        event_occurred_handler(cfg, data);
+    }
+
+    if (ev->ev == SDR_EV_DATA) {
+        cfg->samp_rate        = ev->sample_rate;
+        cfg->center_frequency = ev->center_frequency;
+        if (ev->dropped) {
+            // tell CPU overload apart from RF trouble, warn once per report interval
+            if (!cfg->frames_dropped)
+                print_logf(LOG_WARNING, "Input", "Processing too slow, dropped %u sample buffers.", ev->dropped);
+            cfg->frames_dropped += ev->dropped;
+            cfg->total_frames_dropped += ev->dropped;
+        }
+        if (ev->overflows) {
+            // samples were lost in the device or driver, warn once per report interval
+            if (!cfg->frames_overflow)
+                print_logf(LOG_WARNING, "Input", "Input overflow, samples lost %u times.", ev->overflows);
+            cfg->frames_overflow += ev->overflows;
+            cfg->total_frames_overflow += ev->overflows;
+        }
+        if (ev->lost) {
+            // a gap of the input, e.g. while a network input reconnected, is reported as an event
+            int lost_ms = ev->sample_rate ? (int)MIN(ev->lost * 1000 / ev->sample_rate, INT_MAX) : 0;
+            print_logf(LOG_WARNING, "Input", "Input gap, %d ms of samples lost.", lost_ms);
+            /* clang-format off */
+            event_occurred_handler(cfg, data_make(
+                    "samples_lost", "", DATA_INT, (int)MIN(ev->lost, INT_MAX),
+                    "lost_ms",      "", DATA_INT, lost_ms,
+                    NULL));
+            /* clang-format on */
+            cfg->input_pos += ev->lost;
+        }
+        struct dm_state *demod = cfg->demod;
+        unsigned char *buf = sdr_lease_begin(cfg->dev, ev);
+        uint32_t len       = (uint32_t)ev->len;
+        int64_t time_ns    = ev->time_ns;
+        if (ev->center_frequency && ev->center_frequency != demod->detect_frequency) {
+            retune_sdr_callback(cfg, ev->center_frequency);
+            select_sdr_decoders(cfg, ev->center_frequency, frequency_protocols(cfg, ev->center_frequency));
+        }
+        if (ev->settle) {
+            // drop the samples received while the tuner settled, they still count as input
+            uint32_t skip = MIN(ev->settle * (uint32_t)demod->sample_size, len);
+            buf += skip;
+            len -= skip;
+            cfg->input_pos += ev->settle;
+            if (time_ns && ev->sample_rate)
+                time_ns += (int64_t)ev->settle * 1000000000 / ev->sample_rate;
+            cfg->watchdog++; // the input is alive even if nothing is left
+        }
+        demod->sample_time_ns = time_ns;
+        demod->publish_ns     = ev->publish_ns;
+        // the wait since the handover tells how many transfers the ring held
+        int64_t wait_ns   = ev->publish_ns ? get_time_now_ns() - ev->publish_ns : 0;
+        uint64_t start_ns = time_monotonic_ns();
+        if (cfg->cs8_to_cu8) {
+            // flip the sign bits in place, the slot is ours until released
+            convert_kernels()->cu8_cs8(buf, buf, len);
+        }
+        if (len > 0) {
+            sdr_callback(buf, len, cfg);
+        }
+        if (cfg->buf_tune && ev->sample_rate && demod->sample_size) {
+            tune_buffers(cfg, ev, wait_ns, time_monotonic_ns() - start_ns);
+        }
+        warm_start_t *warm = cfg->primary ? cfg->primary->warm_start : cfg->warm_start;
+        if (warm && time_monotonic_ns() - cfg->warm_start_ns >= WARM_START_KEEP_NS) {
+            keep_warm_start(cfg, warm);
+            cfg->warm_start_ns = time_monotonic_ns();
+        }
+        // a merged event holds the ring slots of all its buffers
+        for (unsigned i = 0; i <= ev->merged; ++i) {
+            sdr_release(cfg->dev);
+        }
+    }
+}
+
+// called on the event loop thread with data queued by the demod thread.
+static void deliver_output(data_t *data, int level, void *ctx)
+{
+    output_data(ctx, data, level);
+}
+
+/// SDR event broadcast to the event loop, tagged with the receiving config.
+typedef struct sdr_broadcast {
+    r_cfg_t *cfg;
+    sdr_event_t ev;
+} sdr_broadcast_t;
+
+// called by mg_mgr_poll() for each connection.
+// NOTE: this handler might be called while already in `r_free_cfg()`.
+static void sdr_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    //fprintf(stderr, "%s: %d, %d, %p, %p\n", __func__, nc->sock, ev_type, nc->user_data, ev_data);
+    // only process polls on the dummy nc
+    if (nc->sock != INVALID_SOCKET || ev_type != MG_EV_POLL) {
+        return;
+    }
+    // only process a broadcast on our defined timer nc
+    if (nc->handler != timer_handler) {
+        return;
+    }
+
+    r_cfg_t *cfg     = nc->user_data;
+    sdr_broadcast_t *msg = ev_data;
+    // each receiver has its own timer nc, only process our own events
+    if (msg->cfg != cfg) {
+        return;
+    }
+    //fprintf(stderr, "sdr_handler...\n");
+
+    process_sdr_event(&msg->ev, cfg);
+
+    if (cfg->exit_async) {
+        if (cfg->verbosity >= 2)
+            print_log(LOG_INFO, "Input", "sdr_handler exit");
+        sdr_stop(cfg->dev);
+        cfg->exit_async++;
+    }
+}
+
+// note that this function is called in a different thread
+static void acquire_callback(sdr_event_t *ev, void *ctx)
+{
+    //struct timeval now;
+    //get_time_now(&now);
+    //fprintf(stderr, "%ld.%06ld acquire_callback...\n", (long)now.tv_sec, (long)now.tv_usec);
+
+    r_cfg_t *cfg = ctx;
+
+    // demodulate on the demod thread, the queue never blocks the acquire thread
+    // and has room for a data event in each ring slot, only control events are dropped
+    if (cfg->demod_thread) {
+        if (demod_thread_push(cfg->demod_thread, ev) < 0 && (ev->ev & SDR_EV_DATA)) {
+            print_log(LOG_ERROR, "Input", "Dropped a data event, the ring has more slots than the demod queue.");
+        }
+        return;
+    }
+
+    // thread-safe dispatch, ev_data is the iq buffer pointer and length
+    // mg_mgr_poll() calls specified callback for each connection.
+    //fprintf(stderr, "acquire_callback bc send...\n");
+    sdr_broadcast_t msg = {.cfg = cfg, .ev = *ev};
+    mg_broadcast(cfg->mgr, sdr_handler, (void *)&msg, sizeof(msg));
+    //fprintf(stderr, "acquire_callback bc done...\n");
+}
+
+// CS8 and CF32 are demodulated natively unless the raw samples are passed on as CU8 or CS16
+static int native_sample_format(r_cfg_t const *cfg)
+{
+    struct dm_state const *demod = cfg->demod;
+    return !cfg->raw_handler.len && !demod->dumper.len && !demod->samp_grab && !cfg->channel_count && !cfg->decimation;
+}
+
+static int start_sdr(r_cfg_t *cfg)
+{
+    int r;
+    if (cfg->dev) {
+        // queued events still reference the buffers of this device
+        demod_thread_drain(cfg->demod_thread);
+        r = sdr_close(cfg->dev);
+        cfg->dev = NULL;
+        if (r < 0) {
+            print_logf(LOG_ERROR, "Input", "Closing SDR failed (%d)", r);
+        }
+    }
+    if (cfg->sdr_opener) {
+        // opened in the background during startup
+        r = sdr_open_finish(cfg->sdr_opener, &cfg->dev);
+        cfg->sdr_opener = NULL;
+    }
+    else {
+        r = sdr_open(&cfg->dev, cfg->dev_query, cfg->verbosity);
+    }
+    if (r < 0) {
+        return -1; // exit(2);
+    }
+    startup_phase(cfg, "sdr open");
+    cfg->dev_info = sdr_get_dev_info(cfg->dev);
+    start_warm_start(cfg);
+    cfg->demod->sample_size = sdr_get_sample_size(cfg->dev);
+    int cs8 = cfg->demod->sample_size == 2 && sdr_get_sample_signed(cfg->dev);
+    cfg->cs8_to_cu8 = cs8 && !native_sample_format(cfg);
+    cfg->demod->sample_format = cfg->demod->sample_size == 4 ? BASEBAND_CS16 : cs8 && !cfg->cs8_to_cu8 ? BASEBAND_CS8 : BASEBAND_CU8;
+
+    /* Set the sample rate */
+    sdr_set_sample_rate(cfg->dev, cfg->samp_rate, 1); // always verbose
+
+    if (cfg->verbosity || cfg->demod->level_limit < 0.0)
+        print_logf(LOG_NOTICE, "Input", "Bit detection level set to %.1f%s.", cfg->demod->level_limit, (cfg->demod->level_limit < 0.0 ? "" : " (Auto)"));
+
+    sdr_apply_settings(cfg->dev, cfg->settings_str, 1); // always verbose for soapy
+
+    /* Enable automatic gain if gain_str empty (or 0 for RTL-SDR), set manual gain otherwise */
+    sdr_set_tuner_gain(cfg->dev, cfg->gain_str, 1); // always verbose
+
+    if (cfg->ppm_error) {
+        sdr_set_freq_correction(cfg->dev, cfg->ppm_error, 1); // always verbose
+    }
+
+    /* Reset endpoint before we start reading from it (mandatory) */
+    r = sdr_reset(cfg->dev, cfg->verbosity);
+    if (r < 0) {
+        print_log(LOG_ERROR, "Input", "Failed to reset buffers.");
+    }
+    sdr_activate(cfg->dev);
+
+    if (cfg->verbosity) {
+        print_log(LOG_NOTICE, "Input", "Reading samples in async mode...");
+    }
+
+    sdr_set_center_freq(cfg->dev, cfg->center_frequency, 1); // always verbose
+    startup_phase(cfg, "sdr settings");
+
+    r = sdr_start(cfg->dev, acquire_callback, (void *)cfg, sdr_buf_num(cfg), cfg->out_block_size);
+    if (r < 0) {
+        print_logf(LOG_ERROR, "Input", "async start failed (%d).", r);
+    }
+
+    cfg->dev_state = DEVICE_STATE_STARTING;
+    return r;
+}
+
+/// The options to read again on a reload.
+static int conf_argc;
+static char **conf_argv;
+/// Args of the protocol options replayed by reloads, decoders may keep them.
+static list_t reload_args;
+/// Outputs of the last reload to close once the demods swapped the decoders.
+static list_t retired_outputs;
+
+// the configs with decoders of their own: the primary, the receivers, and the channels of each
+static void demod_configs(r_cfg_t *cfg, list_t *cfgs)
+{
+    for (size_t i = 0; i <= cfg->receivers.len; ++i) {
+        r_cfg_t *rcv = i == 0 ? cfg : cfg->receivers.elems[i - 1];
+        list_push(cfgs, rcv);
+        list_push_all(cfgs, rcv->channels.elems);
+    }
+}
+
+// print the packages aggregated with -A batch by all configs
+static void print_analyzer_batch(r_cfg_t *cfg)
+{
+    if (cfg->demod->analyze_pulses != 2) {
+        return;
+    }
+    pulse_analyzer_batch_t *batch = pulse_analyzer_batch_create();
+    if (!batch) {
+        return;
+    }
+    list_t cfgs = {0};
+    demod_configs(cfg, &cfgs);
+    list_push_all(&cfgs, cfg->in_file_cfgs.elems);
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        if (rcv->demod->analyzer_batch)
+            pulse_analyzer_batch_merge(batch, rcv->demod->analyzer_batch);
+    }
+    list_free_elems(&cfgs, NULL);
+    pulse_analyzer_batch_print(batch);
+    pulse_analyzer_batch_free(batch);
+}
+
+// write the config of the protocols seen with -M usage, with the counts of all configs not yet flushed
+static void write_decoder_usage(r_cfg_t *cfg)
+{
+    if (!cfg->decoder_usage) {
+        return;
+    }
+    decoder_usage_t *usage = decoder_usage_clone(cfg->decoder_usage);
+    if (!usage) {
+        return;
+    }
+    list_t cfgs = {0};
+    demod_configs(cfg, &cfgs);
+    list_push_all(&cfgs, cfg->in_file_cfgs.elems);
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_add_decoder_usage(*iter, usage);
+    }
+    list_free_elems(&cfgs, NULL);
+
+    FILE *fp = stderr;
+    if (cfg->decoder_usage_path) {
+        fp = fopen(cfg->decoder_usage_path, "w");
+        if (!fp) {
+            print_logf(LOG_ERROR, "Usage", "Failed to open \"%s\"", cfg->decoder_usage_path);
+            decoder_usage_free(usage);
+            return;
+        }
+    }
+    if (decoder_usage_write(usage, fp, difftime(time(NULL), cfg->running_since)) < 0) {
+        print_logf(LOG_ERROR, "Usage", "Failed to write the decoder usage");
+    }
+    if (fp != stderr) {
+        fclose(fp);
+    }
+    decoder_usage_free(usage);
+}
+
+// print the estimated memory map and refuse a configuration exceeding the budget
+static void check_memory_budget(r_cfg_t *cfg)
+{
+    size_t samples = 0, buffers = 0, pulses = 0, grabber = 0, decoders = 0;
+    unsigned buf_num = sdr_buf_num(cfg) ? sdr_buf_num(cfg) : SDR_DEFAULT_BUF_NUMBER;
+    size_t configs = 0;
+    for (size_t i = 0; i <= cfg->receivers.len; ++i) {
+        r_cfg_t *rcv = i == 0 ? cfg : cfg->receivers.elems[i - 1];
+        // each receiver has a SDR ring, its channels demod at most a block of the receiver
+        samples += (size_t)(buf_num + 1) * rcv->out_block_size;
+        for (size_t j = 0; j <= rcv->channels.len; ++j) {
+            struct dm_state *demod = j == 0 ? rcv->demod : ((r_cfg_t *)rcv->channels.elems[j - 1])->demod;
+            // the AM and the FM (or temp) buffer of int16 per sample
+            buffers += 2 * (size_t)rcv->out_block_size;
+            // the OOK and the FSK pulse data each store pulse and gap widths, and the starts of the index
+            pulses += 2 * (size_t)(pulse_data_max_pulses(&demod->pulse_data) + 1) * 3 * sizeof(int);
+            // and each slot of the pipeline of a receiver without channels
+            if (rcv->pipeline_packages > 0 && !rcv->channels.len) {
+                pulses += (size_t)rcv->pipeline_packages * (pulse_data_max_pulses(&demod->pulse_data) + 1) * 3 * sizeof(int);
+            }
+            if (demod->samp_grab) {
+                grabber += SIGNAL_GRABBER_BUFFER;
+            }
+            decoders += demod->r_devs.len * sizeof(r_device);
+            configs++;
+        }
+    }
+    size_t total = samples + buffers + pulses + grabber + cfg->http_bytes + decoders;
+
+    print_logf(LOG_CRITICAL, "Memory", "Sample buffers  %8zu kB (%u x %u bytes per receiver)",
+            samples / 1024, buf_num + 1, cfg->out_block_size);
+    print_logf(LOG_CRITICAL, "Memory", "Demod buffers   %8zu kB (%zu demods)", buffers / 1024, configs);
+    print_logf(LOG_CRITICAL, "Memory", "Pulse data      %8zu kB (%u pulses)",
+            pulses / 1024, pulse_data_max_pulses(&cfg->demod->pulse_data));
+    print_logf(LOG_CRITICAL, "Memory", "Signal grabber  %8zu kB", grabber / 1024);
+    print_logf(LOG_CRITICAL, "Memory", "HTTP server     %8zu kB", cfg->http_bytes / 1024);
+    print_logf(LOG_CRITICAL, "Memory", "Decoders        %8zu kB", decoders / 1024);
+    print_logf(LOG_CRITICAL, "Memory", "Total           %8zu kB of a %zu kB budget",
+            total / 1024, (size_t)MEMORY_BUDGET / 1024);
+
+    if (total > MEMORY_BUDGET) {
+        print_log(LOG_FATAL, "Memory", "The configuration exceeds the memory budget, reduce the block size (-b), the pulses (-Y maxpulses), the receivers or channels, or drop the signal grabber (-S)");
         exit(1);
-        break;
-    case 'r':
-        if (!arg)
-            help_read();
+    }
+}
 
-        add_infile(cfg, arg);
-        // TODO: file_info_check_read()
-        break;
-    case 'w':
-        if (!arg)
-            help_write();
+// a decoder set for a receiver or channel from the protocol options recorded
+static r_cfg_t *stage_decoders(r_cfg_t *cfg)
+{
+    r_cfg_t *stage = r_create_cfg();
+    stage->primary      = cfg; // owns no outputs
+    stage->verbosity    = cfg->verbosity;
+    stage->verbose_bits = cfg->verbose_bits;
+    stage->report_stats = cfg->report_stats;
+    replay_protocol_opts(stage, &reload_args);
+    if (!stage->no_default_devices) {
+        register_all_protocols(stage, 0); // register all defaults
+    }
+    r_shard_decoders(stage);
+    r_pack_decoders(stage);
+    return stage;
+}
 
-        add_dumper(cfg, arg, 0);
-        break;
-    case 'W':
-        if (!arg)
-            help_write();
+// the event loop is the only user of the outputs, the old list is kept with the old decoders
+static void stage_outputs(r_cfg_t *cfg, r_cfg_t *stage, list_t *outputs)
+{
+    list_free_elems(&stage->output_handler, NULL);
+    stage->output_handler = cfg->output_handler;
 
-        add_dumper(cfg, arg, 1);
-        break;
-    case 'S':
-        if (!arg)
-            usage(1);
-        if (strcasecmp(arg, "all") == 0)
-            cfg->grab_mode = 1;
-        else if (strcasecmp(arg, "unknown") == 0)
-            cfg->grab_mode = 2;
-        else if (strcasecmp(arg, "known") == 0)
-            cfg->grab_mode = 3;
-        else
-            cfg->grab_mode = atobv(arg, 1);
-        if (cfg->grab_mode && !cfg->demod->samp_grab)
-            cfg->demod->samp_grab = samp_grab_create(SIGNAL_GRABBER_BUFFER);
-        break;
-    case 'm':
-        fprintf(stderr, "sample mode option is deprecated.\n");
-        usage(1);
-        break;
-    case 'M':
-        if (!arg)
-            help_meta();
+    list_t list = {0};
+    list_ensure_size(&list, outputs->len + 1);
+    list_push_all(&list, outputs->elems);
+    cfg->output_handler = list;
+}
 
-        if (!strncasecmp(arg, "time", 4)) {
-            char *p = arg_param(arg);
-            // time  time:1  time:on  time:yes
-            // time:0  time:off  time:no
-            // time:rel
-            // time:unix
-            // time:iso
-            // time:...:usec  time:...:sec
-            // time:...:utc  time:...:local
-            cfg->report_time = REPORT_TIME_DATE;
-            while (p && *p) {
-                if (!strncasecmp(p, "0", 1) || !strncasecmp(p, "no", 2) || !strncasecmp(p, "off", 3))
-                    cfg->report_time = REPORT_TIME_OFF;
-                else if (!strncasecmp(p, "1", 1) || !strncasecmp(p, "yes", 3) || !strncasecmp(p, "on", 2))
-                    cfg->report_time = REPORT_TIME_DATE;
-                else if (!strncasecmp(p, "rel", 3))
-                    cfg->report_time = REPORT_TIME_SAMPLES;
-                else if (!strncasecmp(p, "unix", 4))
-                    cfg->report_time = REPORT_TIME_UNIX;
-                else if (!strncasecmp(p, "iso", 3))
-                    cfg->report_time = REPORT_TIME_ISO;
-                else if (!strncasecmp(p, "usec", 4))
-                    cfg->report_time_hires = 1;
-                else if (!strncasecmp(p, "sec", 3))
-                    cfg->report_time_hires = 0;
-                else if (!strncasecmp(p, "tz", 2))
-                    cfg->report_time_tz = 1;
-                else if (!strncasecmp(p, "notz", 4))
-                    cfg->report_time_tz = 0;
-                else if (!strncasecmp(p, "utc", 3))
-                    cfg->report_time_utc = 1;
-                else if (!strncasecmp(p, "local", 5))
-                    cfg->report_time_utc = 0;
-                else {
-                    fprintf(stderr, "Unknown time format option: %s\n", p);
-                    help_meta();
-                }
+// re-reads the decoder and output options, the demods swap in the new decoders, unchanged outputs are kept
+static void reload_config(r_cfg_t *cfg)
+{
+    list_t cfgs = {0};
+    demod_configs(cfg, &cfgs);
+    int pending = retired_outputs.len > 0;
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_cfg_t *c = *iter;
+        pending |= atomic_load_acquire(&c->staged_decoders) || atomic_load_acquire(&c->retired_decoders);
+    }
+    if (pending) {
+        list_free_elems(&cfgs, NULL);
+        return; // the last reload is not retired yet, try again later
+    }
+    cfg->reload_now = 0;
+    print_log(LOG_NOTICE, "Reload", "Reloading the decoders and outputs");
+
+    r_cfg_t *next = r_create_cfg();
+    next->mgr             = get_mgr(cfg);
+    next->verbosity       = cfg->verbosity;
+    next->verbose_bits    = cfg->verbose_bits;
+    next->report_stats    = cfg->report_stats;
+    next->conversion_mode = cfg->conversion_mode;
+    next->parse_reload    = 1;
+
+    // the protocol options are recorded again for the receivers and channels
+    list_clear(&protocol_opts, free);
+    if (!hasopt('c', conf_argc, conf_argv, OPTSTRING)) {
+        parse_conf_try_default_files(next);
+    }
+    parse_conf_args(next, conf_argc, conf_argv);
+    if (!next->no_default_devices) {
+        register_all_protocols(next, 0); // register all defaults
+    }
 
-                p = arg_param(p);
-            }
-            // fprintf(stderr, "time format: %d, usec:%d utc:%d\n", cfg->report_time, cfg->report_time_hires, cfg->report_time_utc);
+    // the fixed outputs come first, then the outputs in the order of the options
+    list_t opts    = {0};
+    list_t outputs = {0};
+    list_ensure_size(&outputs, 16);
+    for (void **iter = output_opts.elems; iter && *iter; ++iter) {
+        output_opt_t *old = *iter;
+        if (output_is_fixed(old->arg)) {
+            list_push(&opts, old);
+            if (old->output)
+                list_push(&outputs, old->output);
         }
+    }
+    if (!reload_output_opts.len && !outputs.len) {
+        add_output_opt(next, NULL);
+    }
 
-        // TODO: old time options, remove someday
-        else if (!strcasecmp(arg, "reltime"))
-            cfg->report_time = REPORT_TIME_SAMPLES;
-        else if (!strcasecmp(arg, "notime"))
-            cfg->report_time = REPORT_TIME_OFF;
-        else if (!strcasecmp(arg, "hires"))
-            cfg->report_time_hires = 1;
-        else if (!strcasecmp(arg, "utc"))
-            cfg->report_time_utc = 1;
-        else if (!strcasecmp(arg, "noutc"))
-            cfg->report_time_utc = 0;
+    // only the new outputs are started
+    char const **well_known = well_known_output_fields(cfg);
+    start_outputs(next, well_known);
+    free((void *)well_known);
 
-        else if (!strcasecmp(arg, "protocol"))
-            cfg->report_protocol = 1;
-        else if (!strcasecmp(arg, "noprotocol"))
-            cfg->report_protocol = 0;
-        else if (!strcasecmp(arg, "level"))
-            cfg->report_meta = 1;
-        else if (!strncasecmp(arg, "noise", 5))
-            cfg->report_noise = atoiv(arg_param(arg), 10); // atoi_time_default()
-        else if (!strcasecmp(arg, "bits"))
-            cfg->verbose_bits = 1;
-        else if (!strcasecmp(arg, "description"))
-            cfg->report_description = 1;
-        else if (!strcasecmp(arg, "newmodel"))
-            fprintf(stderr, "newmodel option (-M) is deprecated.\n");
-        else if (!strcasecmp(arg, "oldmodel"))
-            fprintf(stderr, "oldmodel option (-M) is deprecated.\n");
-        else if (!strncasecmp(arg, "stats", 5)) {
-            // there also should be options to set whether to flush on report
-            char *p = arg_param(arg);
-            cfg->report_stats = atoiv(p, 1);
-            cfg->stats_interval = atoiv(arg_param(p), 600); // atoi_time_default()
-            time(&cfg->stats_time);
-            cfg->stats_time += cfg->stats_interval;
+    for (void **iter = reload_output_opts.elems; iter && *iter; ++iter) {
+        output_opt_t *rec = *iter;
+        list_push(&opts, rec);
+        if (rec->output)
+            list_push(&outputs, rec->output);
+    }
+    list_clear(&reload_output_opts, NULL);
+    unsigned kept = 0;
+    for (void **iter = output_opts.elems; iter && *iter; ++iter) {
+        output_opt_t *old = *iter;
+        if (output_is_fixed(old->arg)) {
+            kept += old->output != NULL;
+            continue;
         }
-        else if (!strncasecmp(arg, "replay", 6))
-            cfg->in_replay = atobv(arg_param(arg), 1);
-        else
-            cfg->report_meta = atobv(arg, 1);
-        break;
-    case 'z':
-        fprintf(stderr, "override_short (-z) is deprecated.\n");
-        break;
-    case 'x':
-        fprintf(stderr, "override_long (-x) is deprecated.\n");
-        break;
-    case 'R':
-        if (!arg)
-            help_protocols(cfg->devices, cfg->num_r_devices, 0);
+        if (old->claimed)
+            kept += old->output != NULL;
+        else if (old->output)
+            list_push(&retired_outputs, old->output);
+        free_output_opt(old);
+    }
+    list_free_elems(&output_opts, NULL);
+    output_opts = opts;
+
+    // the receivers and channels look up the tenant pipelines on the primary
+    list_free_elems(&cfg->tenants, (list_elem_free_fn)free_tenant);
+    cfg->tenants = next->tenants;
+    list_t no_tenants = {0};
+    next->tenants = no_tenants;
+
+    // the receivers and channels share the outputs of the primary
+    next->primary      = cfg;
+    next->parse_reload = 0;
+    size_t decoders    = next->demod->r_devs.len;
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_cfg_t *c     = *iter;
+        r_cfg_t *stage = c == cfg ? next : stage_decoders(c);
+        stage_outputs(c, stage, &outputs);
+        r_stage_decoders(c, stage);
+    }
+    print_logf(LOG_NOTICE, "Reload", "Registered %zu out of %u device decoding protocols, %zu outputs of which %u are kept",
+            decoders, cfg->num_r_devices, outputs.len, kept);
 
-        // use arg of 'v', 'vv', 'vvv' as global device verbosity
-        if (*arg == 'v') {
-            int decoder_verbosity = 0;
-            for (int i = 0; arg[i] == 'v'; ++i) {
-                decoder_verbosity += 1;
-            }
-            (void)decoder_verbosity; // FIXME: use this
-            break;
+    list_free_elems(&outputs, NULL);
+    list_free_elems(&cfgs, NULL);
+}
+
+// frees the old decoders and closes the old outputs of a reload once every demod has swapped the decoders
+static void retire_reload(r_cfg_t *cfg)
+{
+    list_t cfgs = {0};
+    demod_configs(cfg, &cfgs);
+    int pending = 0;
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_cfg_t *c = *iter;
+        // the queued events borrow strings of the decoders
+        if (c->demod_thread)
+            demod_thread_flush(c->demod_thread);
+        pending |= r_free_retired_decoders(c);
+    }
+    list_free_elems(&cfgs, NULL);
+    if (!pending && retired_outputs.len) {
+        print_logf(LOG_INFO, "Reload", "Closing %zu outputs", retired_outputs.len);
+        list_clear(&retired_outputs, (list_elem_free_fn)data_output_free);
+    }
+}
+
+static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    //fprintf(stderr, "%s: %d, %d, %p, %p\n", __func__, nc->sock, ev, nc->user_data, ev_data);
+    r_cfg_t *cfg = (r_cfg_t *)nc->user_data;
+    if (sig_hup) {
+        reopen_dumpers(cfg);
+        sig_hup = 0;
+        // the primary reloads the decoders and outputs of all receivers
+        (cfg->primary ? cfg->primary : cfg)->reload_now = 1;
+    }
+    switch (ev) {
+    case MG_EV_TIMER: {
+        double now  = *(double *)ev_data;
+        (void) now; // unused
+        double next = mg_time() + 1.5;
+        //fprintf(stderr, "timer event, current time: %.2lf, next timer: %.2lf\n", now, next);
+        mg_set_timer(nc, next); // Send us timer event again after 1.5 seconds
+
+        if (!cfg->primary) {
+            retire_reload(cfg);
+            if (cfg->reload_now)
+                reload_config(cfg);
+            warm_start_save(cfg->warm_start);
         }
 
-        n = atoi(arg);
-        if (n > cfg->num_r_devices || -n > cfg->num_r_devices) {
-            fprintf(stderr, "Protocol number specified (%d) is larger than number of protocols\n\n", n);
-            help_protocols(cfg->devices, cfg->num_r_devices, 1);
+        // write the events buffered by outputs, receivers share the outputs of the primary
+        for (size_t i = 0; !cfg->primary && i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_poll(cfg->output_handler.elems[i]);
         }
-        if ((n > 0 && cfg->devices[n - 1].disabled > 2) || (n < 0 && cfg->devices[-n - 1].disabled > 2)) {
-            fprintf(stderr, "Protocol number specified (%d) is invalid\n\n", n);
-            help_protocols(cfg->devices, cfg->num_r_devices, 1);
+
+        // the tuned SDR transfers take effect on a restart of the input
+        if (atomic_load_acquire(&cfg->buf_tune_restart) && cfg->dev) {
+            cfg->buf_tune_restart = 0;
+            print_logf(LOG_NOTICE, "Input", "Restarting the input with %u x %u byte transfers.", cfg->buf_num, cfg->out_block_size);
+            sdr_stop(cfg->dev);
+            start_sdr(cfg);
         }
 
-        if (n < 0 && !cfg->no_default_devices) {
-            register_all_protocols(cfg, 0); // register all defaults
+        // a network input reconnecting in place is not stalled
+        sdr_link_stats_t link;
+        if (cfg->dev && sdr_get_link_stats(cfg->dev, &link) == 0 && link.reconnecting) {
+            cfg->watchdog++;
         }
-        cfg->no_default_devices = 1;
 
-        if (n >= 1) {
-            register_protocol(cfg, &cfg->devices[n - 1], arg_param(arg));
+        // Did we acquire data frames in the last interval?
+        if (cfg->watchdog != 0) {
+            if (cfg->dev_state == DEVICE_STATE_STARTING
+                    || cfg->dev_state == DEVICE_STATE_GRACE) {
+                cfg->dev_state = DEVICE_STATE_STARTED;
+                time(&cfg->sdr_since);
+            }
+            cfg->watchdog = 0;
+            break;
         }
-        else if (n <= -1) {
-            unregister_protocol(cfg, &cfg->devices[-n - 1]);
+
+        // Upon starting allow more time until the first frame
+        if (cfg->dev_state == DEVICE_STATE_STARTING) {
+            cfg->dev_state = DEVICE_STATE_GRACE;
+            break;
         }
-        else {
-            fprintf(stderr, "Disabling all device decoders.\n");
-            list_clear(&cfg->demod->r_devs, (list_elem_free_fn)free_protocol);
+        // We expect a frame at least every 250 ms but didn't get one
+        if (cfg->dev_state == DEVICE_STATE_GRACE) {
+            if (cfg->dev_mode == DEVICE_MODE_QUIT) {
+                print_log(LOG_ERROR, "Input", "Input device start failed, exiting!");
+            }
+            else if (cfg->dev_mode == DEVICE_MODE_RESTART) {
+                print_log(LOG_WARNING, "Input", "Input device start failed, restarting!");
+            }
+            else { // DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
+                print_log(LOG_WARNING, "Input", "Input device start failed, pausing!");
+            }
         }
-        break;
-    case 'X':
-        if (!arg)
-            flex_create_device(NULL);
+        else if (cfg->dev_state == DEVICE_STATE_STARTED) {
+            if (cfg->dev_mode == DEVICE_MODE_QUIT) {
+                print_log(LOG_ERROR, "Input", "Async read stalled, exiting!");
+            }
+            else if (cfg->dev_mode == DEVICE_MODE_RESTART) {
+                print_log(LOG_WARNING, "Input", "Async read stalled, restarting!");
+            }
+            else { // DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
+                print_log(LOG_WARNING, "Input", "Async read stalled, pausing!");
+            }
+        }
+        if (cfg->dev_state != DEVICE_STATE_STOPPED) {
+            cfg->exit_async = 1;
+            cfg->exit_code = 3;
+            sdr_stop(cfg->dev);
+            cfg->dev_state = DEVICE_STATE_STOPPED;
+        }
+        if (cfg->dev_mode == DEVICE_MODE_QUIT) {
+            cfg->exit_async = 1;
+        }
+        if (cfg->dev_mode == DEVICE_MODE_RESTART) {
+            start_sdr(cfg);
+        }
+        // do nothing for DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
 
-        flex_device = flex_create_device(arg);
-        register_protocol(cfg, flex_device, "");
-        break;
-    case 'q':
-        fprintf(stderr, "quiet option (-q) is default and deprecated. See -v to increase verbosity\n");
         break;
-    case 'F':
-        if (!arg)
-            help_output();
+    }
+    }
+}
 
-        if (strncmp(arg, "json", 4) == 0) {
-            add_json_output(cfg, arg_param(arg));
-        }
-        else if (strncmp(arg, "csv", 3) == 0) {
-            add_csv_output(cfg, arg_param(arg));
-        }
-        else if (strncmp(arg, "log", 3) == 0) {
-            add_log_output(cfg, arg_param(arg));
-            cfg->has_logout = 1;
+// enable the FM demod if any registered decoder needs it
+static void enable_fm_demod(struct dm_state *demod)
+{
+    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL) {
+            demod->enable_FM_demod = 1;
+            break;
         }
-        else if (strncmp(arg, "kv", 2) == 0) {
-            add_kv_output(cfg, arg_param(arg));
-            cfg->has_logout = 1;
+    }
+}
+
+// creates the channelizer or decimator and a config with the same decoders for each channel of the input
+static void setup_channels(r_cfg_t *cfg, list_t *replay_args)
+{
+    if (!cfg->channel_count && !cfg->decimation) {
+        return;
+    }
+    if (cfg->channel_count && cfg->decimation) {
+        print_log(LOG_FATAL, "Input", "Channels and decimation can not be used together.");
+        exit(1);
+    }
+    if (cfg->demod->dumper.len || cfg->demod->samp_grab || cfg->demod->am_analyze) {
+        print_log(LOG_WARNING, "Input", "Dumpers, the signal grabber, and the AM analyzer are not used with channels.");
+    }
+    if (cfg->decimation) {
+        cfg->decimator = decimator_create(cfg->decimation, cfg->decimation_shift);
+        if (!cfg->decimator) {
+            FATAL("Failed to create the decimator");
         }
-        else if (strncmp(arg, "mqtt", 4) == 0) {
-            add_mqtt_output(cfg, arg);
+        r_cfg_t *ch = r_create_channel(cfg);
+        replay_protocol_opts(ch, replay_args);
+        if (!ch->no_default_devices) {
+            register_all_protocols(ch, 0); // register all defaults
         }
-        else if (strncmp(arg, "influx", 6) == 0) {
-            add_influx_output(cfg, arg);
+        enable_fm_demod(ch->demod);
+        print_logf(LOG_NOTICE, "Input", "Decimating the input by %d to %u Hz, shifted by %d Hz.", cfg->decimation,
+                decimator_rate(cfg->decimator, cfg->samp_rate), cfg->decimation_shift);
+        return;
+    }
+    cfg->channelizer = channelizer_create(cfg->channel_count);
+    if (!cfg->channelizer) {
+        FATAL("Failed to create the channelizer");
+    }
+    if (cfg->channel_gpu && channelizer_use_gpu(cfg->channelizer) < 0) {
+        print_log(LOG_WARNING, "Input", "No OpenCL GPU found, channelizing on the CPU.");
+    }
+    for (int k = 0; k < cfg->channel_count; ++k) {
+        r_cfg_t *ch = r_create_channel(cfg);
+        replay_protocol_opts(ch, replay_args);
+        if (!ch->no_default_devices) {
+            register_all_protocols(ch, 0); // register all defaults
         }
-        else if (strncmp(arg, "syslog", 6) == 0) {
-            add_syslog_output(cfg, arg_param(arg));
+        enable_fm_demod(ch->demod);
+    }
+    print_logf(LOG_NOTICE, "Input", "Splitting the input into %d channels of %u Hz.", cfg->channel_count,
+            channelizer_rate(cfg->channelizer, cfg->samp_rate));
+
+    // one FFT per buffer shows the band activity, the gate needs FFTs spread over each buffer
+    int gate = cfg->spectrum_gate > 0;
+    cfg->spectrum = spectrum_create(gate ? SPECTRUM_GATE_STRIDE : 0, gate ? cfg->spectrum_gate : SPECTRUM_THRESHOLD_DB);
+    if (!cfg->spectrum) {
+        FATAL("Failed to create the spectrum monitor");
+    }
+    if (gate) {
+        print_logf(LOG_NOTICE, "Input", "Demodulating the channels with a signal %.1f dB over the noise floor.", cfg->spectrum_gate);
+    }
+
+    if (cfg->worker_threads > 1) {
+        unsigned threads = MIN(cfg->worker_threads, cfg->channel_count);
+        cfg->worker_pool = worker_pool_create(threads);
+        if (!cfg->worker_pool) {
+            print_log(LOG_WARNING, "Input", "Threads are not available, demodulating the channels on one thread.");
         }
-        else if (strncmp(arg, "http", 4) == 0) {
-            add_http_output(cfg, arg_param(arg));
+        else {
+            print_logf(LOG_NOTICE, "Input", "Demodulating the channels on %u threads.", threads);
         }
-        else if (strncmp(arg, "trigger", 7) == 0) {
-            add_trigger_output(cfg, arg_param(arg));
+    }
+}
+
+// creates the decoder pool of a receiver, the channels share it if they are demodulated in turn
+static void setup_decoder_pool(r_cfg_t *cfg)
+{
+    if (cfg->decoder_threads <= 1) {
+        return;
+    }
+    cfg->decoder_pool = decoder_pool_create(cfg->decoder_threads);
+    if (!cfg->decoder_pool) {
+        print_log(LOG_WARNING, "Input", "Threads are not available, running the decoders on one thread.");
+        return;
+    }
+    print_logf(LOG_NOTICE, "Input", "Running the decoders of each priority on %d threads.", cfg->decoder_threads);
+    cfg->demod->decoder_pool = cfg->decoder_pool;
+
+    // the pool runs one batch at a time, channels on worker threads run their decoders in turn
+    if (cfg->worker_pool) {
+        return;
+    }
+    for (void **iter = cfg->channels.elems; iter && *iter; ++iter) {
+        r_cfg_t *ch = *iter;
+        ch->demod->decoder_pool = cfg->decoder_pool;
+    }
+}
+
+// decodes the packages of a receiver on a thread of its own while the detection goes on
+static void setup_package_queue(r_cfg_t *cfg)
+{
+    if (cfg->pipeline_packages <= 0) {
+        return;
+    }
+    // the channels detect and decode their packages in turn or on the worker pool
+    if (cfg->channels.len) {
+        print_log(LOG_WARNING, "Input", "The package pipeline is not used with channels (-N), decoding each package as it is detected.");
+        return;
+    }
+    cfg->package_queue = package_queue_create((unsigned)cfg->pipeline_packages, decode_queued_package, deliver_output, retire_package, cfg);
+    if (!cfg->package_queue) {
+        print_log(LOG_WARNING, "Input", "Threads are not available, decoding each package as it is detected.");
+        return;
+    }
+    print_logf(LOG_NOTICE, "Input", "Decoding on a thread of its own, up to %d packages behind the detection.", cfg->pipeline_packages);
+}
+
+// starts the demod thread, the input device and the watchdog timer of a receiver
+// the duty cycle options are global, each input learns the transmitters it receives
+static void start_duty_cycle(r_cfg_t *cfg)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (root->duty_survey > 0 && !cfg->duty_cycle) {
+        cfg->duty_cycle = duty_cycle_create((uint64_t)root->duty_survey * 1000, (uint64_t)root->duty_every * 1000);
+    }
+}
+
+// the load shedding options are global, each input sheds on its own load
+static void start_load_shed(r_cfg_t *cfg)
+{
+    r_cfg_t *root = cfg;
+    while (root->primary) {
+        root = root->primary;
+    }
+    if (root->load_shed_high > 0.0f && !cfg->load_shed) {
+        cfg->load_shed = load_shed_create(root->load_shed_high, root->load_shed_low);
+    }
+}
+
+static int start_receiver(r_cfg_t *cfg)
+{
+    cfg->demod_thread = demod_thread_start(get_mgr(cfg), demod_queue_size(cfg), process_sdr_event, deliver_output, cfg);
+    // the small transfers are demodulated in default sized blocks while the demod is behind
+    if (cfg->demod_thread && cfg->low_latency) {
+        demod_thread_set_merge(cfg->demod_thread, DEFAULT_BUF_LENGTH);
+    }
+
+    if (cfg->dev_mode != DEVICE_MODE_MANUAL) {
+        int r = start_sdr(cfg);
+        if (r < 0) {
+            return r;
         }
-        else if (strncmp(arg, "null", 4) == 0) {
-            add_null_output(cfg, arg_param(arg));
+    }
+
+    if (cfg->duration > 0) {
+        time(&cfg->stop_time);
+        cfg->stop_time += cfg->duration;
+    }
+
+    time(&cfg->hop_start_time);
+    if (cfg->hop_adaptive && cfg->frequencies > 1 && !cfg->hop_scheduler) {
+        cfg->hop_scheduler = hop_scheduler_create(cfg->frequencies, cfg->hop_time, cfg->hop_times, cfg->samp_rate, cfg->frequency_index, cfg->input_pos);
+        cfg->hop_packages  = cfg->total_frames_ook + cfg->total_frames_fsk;
+    }
+    start_duty_cycle(cfg);
+    start_load_shed(cfg);
+    if (cfg->buf_tune_s > 0 && !cfg->buf_tune) {
+        cfg->buf_tune = buf_tune_create((uint64_t)cfg->buf_tune_s * 1000000000);
+    }
+
+    // add dummy socket to receive broadcasts
+    struct mg_add_sock_opts opts = {.user_data = cfg};
+    struct mg_connection *nc = mg_add_sock_opt(get_mgr(cfg), INVALID_SOCKET, timer_handler, opts);
+    // Send us MG_EV_TIMER event after 2.5 seconds
+    mg_set_timer(nc, mg_time() + 2.5);
+
+    return 0;
+}
+
+static void stop_receiver(r_cfg_t *cfg)
+{
+    sdr_stop(cfg->dev);
+    demod_thread_stop(cfg->demod_thread);
+    cfg->demod_thread = NULL;
+    // the demod is stopped, the queued packages are finished here
+    package_queue_retire(cfg->package_queue, 1);
+
+    if (cfg->report_stats > 0) {
+        event_occurred_handler(cfg, create_report_data(cfg, cfg->report_stats));
+        flush_report_data(cfg);
+    }
+}
+
+// map a regular file to read the samples in place, NULL for pipes, empty files, or if mapping fails
+static unsigned char *map_in_file(FILE *file, size_t *size)
+{
+#if !defined(_WIN32) && !defined(ESP32)
+    int fd = fileno(file);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX)
+        return NULL;
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+#ifdef MADV_SEQUENTIAL
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    *size = (size_t)st.st_size;
+    return map;
+#else
+    (void)file;
+    (void)size;
+    return NULL;
+#endif
+}
+
+static void unmap_in_file(unsigned char *map, size_t size)
+{
+#if !defined(_WIN32) && !defined(ESP32)
+    if (map)
+        munmap(map, size);
+#else
+    (void)map;
+    (void)size;
+#endif
+}
+
+// seek to a byte offset of a file, also beyond 2 GB, returns 0 on success
+static int seek_in_file(FILE *file, uint64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)pos, SEEK_SET);
+#elif defined(ESP32)
+    return fseek(file, (long)pos, SEEK_SET);
+#else
+    return fseeko(file, (off_t)pos, SEEK_SET);
+#endif
+}
+
+// write a package of a pulse input to the pulse dumpers, other dumpers are not supported
+static void dump_pulse_input(r_cfg_t *cfg, pulse_data_t const *pulse_data, int package_type, char const *input)
+{
+    for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t *dumper = *iter;
+        if (dumper->format == VCD_LOGIC) {
+            pulse_data_print_vcd(dumper->file, pulse_data, package_type == PULSE_DATA_FSK ? '"' : '\'');
+        } else if (dumper->format == RLE_LOGIC) {
+            dumper->rle_pos = pulse_data_dump_rle(dumper->file, dumper->rle_pos, pulse_data, package_type == PULSE_DATA_FSK ? 0x04 : 0x02);
+        } else if (dumper->format == PULSE_OOK) {
+            pulse_data_dump(dumper->file, pulse_data);
+        } else if (dumper->format == PULSE_ARCHIVE) {
+            pulse_archive_write(dumper->archive, pulse_data, package_type);
+        } else {
+            print_logf(LOG_ERROR, "Input", "Dumper (%s) not supported on %s input", dumper->spec, input);
+            exit(1);
         }
-        else if (strncmp(arg, "rtl_tcp", 7) == 0) {
-            add_rtltcp_output(cfg, arg_param(arg));
+    }
+}
+
+/// Bytes read at once from a file of test codes, the longest line it may have.
+#define TEST_CODES_READ_SIZE (256 * 1024)
+
+/// The state kept across test codes, nothing is allocated per code.
+typedef struct test_codes {
+    pulse_data_t pulse_data; ///< the pulses of a RfRaw code, the store is reused
+    bitbuffer_t code;        ///< a bitbuffer code, parsed once for all decoders
+    bitbuffer_t bits;        ///< the copy of the code each decoder gets, decoders may change it
+    list_t single_dev;       ///< the decoder of a code prefixed with a protocol number
+    char buf[TEST_CODES_READ_SIZE + 1];
+} test_codes_t;
+
+static test_codes_t *test_codes_create(void)
+{
+    test_codes_t *codes = calloc(1, sizeof(*codes));
+    if (!codes)
+        FATAL_CALLOC("test_codes_create()");
+    return codes;
+}
+
+static void test_codes_free(test_codes_t *codes)
+{
+    pulse_data_free(&codes->pulse_data);
+    list_free_elems(&codes->single_dev, NULL);
+    free(codes);
+}
+
+// run the pulses of a RfRaw code through the decoders, returns the events
+static int run_rfraw_code(struct dm_state *demod, test_codes_t *codes, char const *code, list_t *devs)
+{
+    pulse_data_clear(&codes->pulse_data);
+    rfraw_parse(&codes->pulse_data, code);
+    if (devs == &codes->single_dev) {
+        if (!codes->pulse_data.fsk_f2_est)
+            return run_ook_demods(devs, &codes->pulse_data, NULL, NULL);
+        else
+            return run_fsk_demods(devs, &codes->pulse_data, NULL, NULL);
+    }
+    if (!codes->pulse_data.fsk_f2_est)
+        return run_ook_demods(&demod->ook_devs, &codes->pulse_data, &demod->slicer_cache, demod->decoder_pool);
+    else
+        return run_fsk_demods(&demod->fsk_devs, &codes->pulse_data, &demod->slicer_cache, demod->decoder_pool);
+}
+
+// run a line of test data, a RfRaw or a bitbuffer code, optionally prefixed with "[<protocol number>]"
+static int run_test_code(r_cfg_t *cfg, test_codes_t *codes, char const *line)
+{
+    struct dm_state *demod = cfg->demod;
+
+    if (cfg->verbosity >= LOG_NOTICE)
+        print_logf(LOG_NOTICE, "Input", "Processing test data \"%s\"...", line);
+    // test a single decoder?
+    list_t *devs = &demod->r_devs;
+    if (*line == '[') {
+        char *e = NULL;
+        unsigned d = (unsigned)strtol(&line[1], &e, 10);
+        if (!e || *e != ']') {
+            print_logf(LOG_ERROR, "Protocol", "Bad protocol number %.5s.", line);
+            exit(1);
         }
-        else {
-            fprintf(stderr, "Invalid output format: %s\n", arg);
-            usage(1);
+        line = e + 1;
+        list_clear(&codes->single_dev, NULL);
+        for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            if (r_dev->protocol_num == d) {
+                list_push(&codes->single_dev, r_dev);
+                break;
+            }
         }
-        break;
-    case 'K':
-        if (!arg)
-            help_tags();
-        add_data_tag(cfg, arg);
-        break;
-    case 'C':
-        if (!arg)
-            usage(1);
-        if (strcmp(arg, "native") == 0) {
-            cfg->conversion_mode = CONVERT_NATIVE;
+        if (!codes->single_dev.len) {
+            print_logf(LOG_ERROR, "Protocol", "Unknown protocol number %u.", d);
+            exit(1);
         }
-        else if (strcmp(arg, "si") == 0) {
-            cfg->conversion_mode = CONVERT_SI;
+        devs = &codes->single_dev;
+    }
+
+    if (rfraw_check(line)) {
+        return run_rfraw_code(demod, codes, line, devs);
+    }
+    // parse once, each decoder gets a fresh copy
+    bitbuffer_parse(&codes->code, line);
+    int r = 0;
+    for (void **iter = devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (cfg->verbosity >= LOG_NOTICE)
+            print_logf(LOG_NOTICE, "Input", "Verifying test data with device %s.", r_dev->name);
+        bitbuffer_copy(&codes->bits, &codes->code);
+        r += pulse_slicer_bits(&codes->bits, r_dev);
+    }
+    return r;
+}
+
+// run each line of a file of test codes ("-" for stdin) through the decoders, returns the events or -1
+static int read_test_codes(r_cfg_t *cfg, test_codes_t *codes, char const *path)
+{
+    FILE *fp = stdin;
+    if (strcmp(path, "-") != 0) {
+        print_logf(LOG_CRITICAL, "Input", "Reading test data from \"%s\"", path);
+        fp = fopen(path, "rb");
+    } else {
+        print_log(LOG_CRITICAL, "Input", "Reading test data from stdin");
+    }
+    if (!fp) {
+        print_logf(LOG_ERROR, "Input", "Failed to open %s", path);
+        return -1;
+    }
+
+    uint64_t start_ns = time_monotonic_ns();
+    unsigned count = 0;
+    int events = 0;
+    char *buf = codes->buf;
+    size_t fill = 0;
+    int eof = 0;
+    int skip = 0; // dropping the rest of an overlong line
+    while (!eof || fill) {
+        if (!eof) {
+            size_t n = fread(buf + fill, 1, TEST_CODES_READ_SIZE - fill, fp);
+            fill += n;
+            eof = n == 0;
         }
-        else if (strcmp(arg, "customary") == 0) {
-            cfg->conversion_mode = CONVERT_CUSTOMARY;
+        // the lines in the buffer, the last one if the file ends without a newline
+        char *line = buf;
+        char *end = buf + fill;
+        char *nl;
+        while ((nl = memchr(line, '\n', end - line)) || (eof && line < end)) {
+            if (!nl)
+                nl = end;
+            *nl = '\0';
+            if (nl > line && nl[-1] == '\r')
+                nl[-1] = '\0';
+            if (!skip && *line && *line != '#') {
+                events += run_test_code(cfg, codes, line);
+                count += 1;
+            }
+            skip = 0;
+            line = nl < end ? nl + 1 : end;
         }
-        else {
-            fprintf(stderr, "Invalid conversion mode: %s\n", arg);
-            usage(1);
+        fill = end - line;
+        if (fill == TEST_CODES_READ_SIZE) {
+            print_logf(LOG_WARNING, "Input", "Skipping a test code line longer than %d bytes", TEST_CODES_READ_SIZE);
+            fill = 0;
+            skip = 1;
         }
-        break;
-    case 'U':
-        fprintf(stderr, "UTC mode option (-U) is deprecated. Please use \"-M utc\".\n");
+        memmove(buf, line, fill);
+    }
+
+    if (fp != stdin)
+        fclose(fp);
+
+    double secs = (time_monotonic_ns() - start_ns) / 1e9;
+    print_logf(LOG_NOTICE, "Input", "Ran %u test codes with %d events in %.3f s (%.0f codes/min)",
+            count, events, secs, secs > 0 ? count * 60 / secs : 0.0);
+    return events;
+}
+
+// special case for a file of test codes, as -y @file
+static void read_codes_input(r_cfg_t *cfg, char const *path)
+{
+    test_codes_t *codes = test_codes_create();
+    if (read_test_codes(cfg, codes, path) < 0)
         exit(1);
-        break;
-    case 'T':
-        cfg->duration = atoi_time(arg, "-T: ");
-        if (cfg->duration < 1) {
-            fprintf(stderr, "Duration '%s' not a positive number; will continue indefinitely\n", arg);
+    test_codes_free(codes);
+}
+
+// decode the packages of remote pulse outputs until stopped, spec is e.g. "udp://0.0.0.0:5433"
+static void read_pulses_input(r_cfg_t *cfg, char const *spec)
+{
+    struct dm_state *demod = cfg->demod;
+
+    if (strncmp(spec, "udp:", 4) != 0) {
+        print_logf(LOG_ERROR, "Input", "Expected e.g. pulses:udp://host:port, not \"%s\"", cfg->in_filename);
+        exit(1);
+    }
+    char *param = strdup(spec + 4);
+    if (!param)
+        FATAL_STRDUP("read_pulses_input()");
+    char const *host = NULL; // any address
+    char const *port = NULL;
+    hostport_param(param, &host, &port);
+    if (!port) {
+        print_log(LOG_ERROR, "Input", "Missing port for pulse input");
+        exit(1);
+    }
+    pulse_input_t *input = pulse_input_udp_open(host, port);
+    if (!input) {
+        print_logf(LOG_ERROR, "Input", "Receiving pulse data on %s port %s failed!", host ? host : "*", port);
+        exit(1);
+    }
+    print_logf(LOG_CRITICAL, "Input", "Receiving pulse data on %s port %s", host ? host : "*", port);
+    free(param);
+
+    install_signal_handlers();
+    unsigned lost = 0;
+    while (!cfg->exit_async) {
+        if (cfg->duration > 0 && time(NULL) >= cfg->stop_time) {
+            print_log(LOG_CRITICAL, "Input", "Time expired, exiting!");
+            break;
         }
-        break;
-    case 'y':
-        cfg->test_data = arg;
-        break;
-    case 'Y':
-        if (!arg)
-            usage(1);
-        char const *p = arg;
-        while (p && *p) {
-            char const *val = NULL;
-            if (kwargs_match(p, "autolevel", &val))
-                cfg->demod->auto_level = atoiv(val, 1); // arg_float_default(p + 9, "-Y autolevel: ");
-            else if (kwargs_match(p, "squelch", &val))
-                cfg->demod->squelch_offset = atoiv(val, 1); // arg_float_default(p + 7, "-Y squelch: ");
-            else if (kwargs_match(p, "auto", &val))
-                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_AUTO;
-            else if (kwargs_match(p, "classic", &val))
-                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_OLD;
-            else if (kwargs_match(p, "minmax", &val))
-                cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_NEW;
-            else if (kwargs_match(p, "ampest", &val))
-                cfg->demod->use_mag_est = 0;
-            else if (kwargs_match(p, "verbose", &val))
-                cfg->demod->detect_verbosity++;
-            else if (kwargs_match(p, "magest", &val))
-                cfg->demod->use_mag_est = 1;
-            else if (kwargs_match(p, "level", &val))
-                cfg->demod->level_limit = arg_float(val, "-Y level: ");
-            else if (kwargs_match(p, "minlevel", &val))
-                cfg->demod->min_level = arg_float(val, "-Y minlevel: ");
-            else if (kwargs_match(p, "minsnr", &val))
-                cfg->demod->min_snr = arg_float(val, "-Y minsnr: ");
-            else if (kwargs_match(p, "filter", &val))
-                cfg->demod->low_pass = arg_float(val, "-Y filter: ");
-            else {
-                fprintf(stderr, "Unknown pulse detector setting: %s\n", p);
-                usage(1);
-            }
-            p = kwargs_skip(p);
+        // keep the network outputs going while waiting
+        int package_type = pulse_input_recv(input, &demod->pulse_data, 100);
+        if (cfg->mgr)
+            mg_mgr_poll(cfg->mgr, 0);
+        for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_poll(cfg->output_handler.elems[i]);
         }
-        break;
-    case 'E':
-        if (arg && !strcmp(arg, "hop")) {
-            cfg->after_successful_events_flag = 2;
+        if (package_type < 0)
+            break;
+        if (!package_type)
+            continue;
+
+        if (pulse_input_lost(input) != lost) {
+            lost = pulse_input_lost(input);
+            print_logf(LOG_WARNING, "Input", "Lost %u pulse datagrams so far", lost);
         }
-        else if (arg && !strcmp(arg, "quit")) {
-            cfg->after_successful_events_flag = 1;
+        pulse_data_t *pulse_data = &demod->pulse_data;
+        cfg->samp_rate        = pulse_data->sample_rate;
+        cfg->center_frequency = (uint32_t)pulse_data->centerfreq_hz;
+        if (demod->analyze_pulses == 1) fprintf(stderr, "Received %s package\n", package_type == PULSE_DATA_FSK ? "FSK" : "OOK");
+
+        dump_pulse_input(cfg, pulse_data, package_type, "pulse");
+
+        int p_events;
+        if (package_type == PULSE_DATA_FSK) {
+            p_events = run_fsk_demods(&demod->fsk_devs, pulse_data, &demod->slicer_cache, demod->decoder_pool);
+            cfg->total_frames_fsk += 1;
+            cfg->frames_fsk += 1;
         }
         else {
-            cfg->after_successful_events_flag = atobv(arg, 1);
+            p_events = run_ook_demods(&demod->ook_devs, pulse_data, &demod->slicer_cache, demod->decoder_pool);
+            cfg->total_frames_ook += 1;
+            cfg->frames_ook += 1;
+        }
+        cfg->total_frames_events += p_events > 0;
+        cfg->frames_events += p_events > 0;
+
+        if (cfg->verbosity >= LOG_TRACE) pulse_data_print(pulse_data);
+        if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
+            data_t *data = pulse_data_print_data(pulse_data, cfg->raw_rfraw);
+            event_occurred_handler(cfg, data);
+        }
+        if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+            analyze_package(cfg, pulse_data, package_type);
         }
-        break;
-    default:
-        usage(1);
-        break;
     }
+
+    pulse_input_close(input);
 }
 
-static r_cfg_t g_cfg;
-static volatile sig_atomic_t sig_hup;
+// any receiver stopping stops all of them
+static int receivers_exiting(r_cfg_t *cfg)
+{
+    if (cfg->exit_async) {
+        return 1;
+    }
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        if (rcv->exit_async) {
+            cfg->exit_async = 1;
+            if (rcv->exit_code)
+                cfg->exit_code = rcv->exit_code;
+            return 1;
+        }
+    }
+    return 0;
+}
 
-// TODO: SIGINFO is not in POSIX...
-#ifndef SIGINFO
-#define SIGINFO 29
+/// A part of an input file to demodulate, the margins around the part are read but their packages are not decoded.
+typedef struct in_file_chunk {
+    char const *filename;
+    size_t file_index;      ///< index of the file in the input files
+    uint64_t read_begin;    ///< first byte to read
+    uint64_t read_end;      ///< end of the bytes to read, 0 to read to the end of the file
+    uint64_t package_begin; ///< sample offset of the first package to decode
+    uint64_t package_end;   ///< sample offset after the last package to decode, 0 for no limit
+} in_file_chunk_t;
+
+// time of the first sample of a file for a replay as fast as possible
+static int64_t replay_start_ns(r_cfg_t *cfg, FILE *in_file, int native)
+{
+    if (cfg->replay_clock_ns)
+        return cfg->replay_clock_ns;
+
+    struct timeval now;
+    get_time_now(&now);
+    int64_t start_ns = (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_usec * 1000;
+#if !defined(_WIN32) && !defined(ESP32)
+    // the recording ended when the file was last written
+    struct dm_state *demod = cfg->demod;
+    struct stat st;
+    if (in_file != stdin && !demod->load_info.zstd && fstat(fileno(in_file), &st) == 0) {
+        // CF32 is read as CS16 unless demodulated natively
+        int file_sample_size = demod->sample_size;
+        if (demod->load_info.format == CF32_IQ && !native)
+            file_sample_size *= 2;
+        uint64_t samples = (uint64_t)st.st_size / file_sample_size;
+        start_ns         = (int64_t)st.st_mtime * 1000000000 - samples_to_ns(samples, cfg->samp_rate);
+    }
+#else
+    (void)in_file;
+    (void)native;
 #endif
+    return start_ns;
+}
 
-// NOTE: printf is not async safe per signal-safety(7)
-// writes a static string, without the terminating zero, to stderr, ignores return value
-#define write_err(s) (void)!write(STDERR_FILENO, (s), sizeof(s) - 1)
+// the time range suffix of an input, e.g. "file.cu8:start=90s,len=500ms", NULL if there is none
+static char *in_file_range(char const *spec)
+{
+    char const *p = strrchr(spec, ':');
+    if (!p || (strncmp(p + 1, "start=", 6) && strncmp(p + 1, "len=", 4)))
+        return NULL;
+    return (char *)p;
+}
 
-#ifdef _WIN32
-BOOL WINAPI
-console_handler(int signum)
+// split the time range off an input spec, returns 1 if there is a range
+static int parse_in_file_range(char *spec, unsigned *start_ms, unsigned *len_ms)
 {
-    if (CTRL_C_EVENT == signum) {
-        write_err("Signal caught, exiting!\n");
-        g_cfg.exit_async = 1;
-        // Uninstall handler, next Ctrl-C is a hard abort
-        SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_handler, FALSE);
-        return TRUE;
-    }
-    else if (CTRL_BREAK_EVENT == signum) {
-        write_err("CTRL-BREAK detected, hopping to next frequency (-f). Use CTRL-C to quit.\n");
-        g_cfg.hop_now = 1;
-        return TRUE;
+    char *range = in_file_range(spec);
+    if (!range)
+        return 0;
+    *range++ = '\0';
+    char *key, *val;
+    while (getkwargs(&range, &key, &val)) {
+        if (!strcasecmp(key, "start"))
+            *start_ms = atoi_ms(val, "-r start= ");
+        else if (!strcasecmp(key, "len"))
+            *len_ms = atoi_ms(val, "-r len= ");
+        else {
+            print_logf(LOG_FATAL, "Input", "Unknown input range option \"%s\"", key);
+            exit(1);
+        }
     }
-    return FALSE;
+    return 1;
 }
 
-#else
-static void sighandler(int signum)
+// demodulate the samples or pulses of the file cfg->in_filename, or of a chunk, returns -1 if the file can't be read
+static int read_in_file(r_cfg_t *cfg, uint32_t sample_rate_0, int native, unsigned char *test_mode_buf, float *test_mode_float_buf, in_file_chunk_t const *chunk)
 {
-    if (signum == SIGPIPE) {
-        // NOTE: we already ignore most network SIGPIPE's, this might be a STDOUT/STDERR problem.
-        // Printing is likely not the correct way to handle this.
-        write_err("Ignoring received signal SIGPIPE, Broken pipe.\n");
-        return;
+    struct dm_state *demod = cfg->demod;
+    uint64_t read_begin = chunk ? chunk->read_begin : 0;
+    uint64_t read_end   = chunk ? chunk->read_end : 0;
+    cfg->package_begin  = chunk ? chunk->package_begin : 0;
+    cfg->package_end    = chunk ? chunk->package_end : 0;
+
+    // the load info points into the spec, a time range and a SigMF meta path are cut from it
+    free(demod->load_spec);
+    demod->load_spec = strdup(cfg->in_filename);
+    if (!demod->load_spec)
+        FATAL_STRDUP("read_in_file()");
+    unsigned range_start_ms = 0;
+    unsigned range_len_ms   = 0;
+    int ranged = parse_in_file_range(demod->load_spec, &range_start_ms, &range_len_ms);
+    sigmf_data_path(demod->load_spec);
+
+    file_info_clear(&demod->load_info); // reset all info
+    file_info_parse_filename(&demod->load_info, demod->load_spec);
+    if (demod->load_info.sigmf && strcmp(demod->load_info.path, "-") != 0) {
+        if (sigmf_read_meta(&demod->load_info) < 0)
+            return -1;
     }
-    else if (signum == SIGHUP) {
-        sig_hup = 1;
-        return;
+    // apply file info or default
+    cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : sample_rate_0;
+    cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency : cfg->frequency[0];
+
+    FILE *in_file;
+    if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
+        in_file = stdin;
+        cfg->in_filename = "<stdin>";
+    } else {
+        in_file = fopen(demod->load_info.path, "rb");
+        if (!in_file) {
+            print_logf(LOG_ERROR, "Input", "Opening file \"%s\" failed!", cfg->in_filename);
+            return -1;
+        }
     }
-    else if (signum == SIGINFO/* TODO: maybe SIGUSR1 */) {
-        g_cfg.stats_now++;
-        return;
+    // Essential information (not quiet), a benchmark reads each file many times
+    print_logf(cfg->bench_repeats > 0 ? LOG_INFO : LOG_CRITICAL, "Input", "Test mode active. Reading samples from file: %s", cfg->in_filename);
+    demod->sample_format = BASEBAND_CU8;
+    if (native && demod->load_info.format == CS8_IQ) {
+        demod->sample_size   = sizeof(int8_t) * 2; // CS8
+        demod->sample_format = BASEBAND_CS8;
+    } else if (native && demod->load_info.format == CF32_IQ) {
+        demod->sample_size   = sizeof(float) * 2; // CF32
+        demod->sample_format = BASEBAND_CF32;
+    } else if (demod->load_info.format == CU8_IQ
+            || demod->load_info.format == CS8_IQ
+            || demod->load_info.format == S16_AM
+            || demod->load_info.format == S16_FM) {
+        demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
+    } else if (demod->load_info.format == CS16_IQ
+            || demod->load_info.format == CF32_IQ) {
+        demod->sample_size   = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
+        demod->sample_format = BASEBAND_CS16;
+    } else if (demod->load_info.format == PULSE_OOK
+            || demod->load_info.format == PULSE_ARCHIVE) {
+        // ignore
+    } else {
+        print_logf(LOG_ERROR, "Input", "Input format invalid \"%s\"", file_info_string(&demod->load_info));
+        return -1;
     }
-    else if (signum == SIGUSR1) {
-        g_cfg.hop_now = 1;
-        return;
+    if (cfg->verbosity >= LOG_NOTICE) {
+        print_logf(LOG_NOTICE, "Input", "Input format \"%s\"", file_info_string(&demod->load_info));
     }
-    else {
-        write_err("Signal caught, exiting!\n");
+    // CF32 is read as CS16 unless demodulated natively
+    int file_sample_size = demod->sample_size;
+    if (demod->load_info.format == CF32_IQ && !native)
+        file_sample_size *= 2;
+    // a time range is read from the byte offset of its first sample
+    if (ranged && !chunk && file_sample_size) {
+        if (in_file == stdin || demod->load_info.zstd) {
+            print_logf(LOG_ERROR, "Input", "A time range can only be read from an uncompressed file \"%s\"", cfg->in_filename);
+            if (in_file != stdin) {
+                fclose(in_file);
+            }
+            return -1;
+        }
+        read_begin = (uint64_t)range_start_ms * cfg->samp_rate / 1000 * file_sample_size;
+        if (range_len_ms)
+            read_end = read_begin + (uint64_t)range_len_ms * cfg->samp_rate / 1000 * file_sample_size;
+    }
+    else if (ranged && demod->load_info.format == PULSE_OOK) {
+        print_logf(LOG_ERROR, "Input", "A time range can't be read from pulse data text \"%s\"", cfg->in_filename);
+        if (in_file != stdin) {
+            fclose(in_file);
+        }
+        return -1;
+    }
+    // a chunk starts at a sample offset, pulse data has no sample size and is read whole
+    uint64_t begin_samples = read_begin ? read_begin / file_sample_size : 0;
+    demod->sample_file_pos = begin_samples / (double)cfg->samp_rate;
+    if (chunk) {
+        cfg->input_pos = begin_samples;
     }
-    g_cfg.exit_async = 1;
 
-    // Uninstall handler, next Ctrl-C is a hard abort
-    struct sigaction sigact;
-    sigact.sa_handler = NULL;
-    sigemptyset(&sigact.sa_mask);
-    sigact.sa_flags = 0;
-    sigaction(SIGINT, &sigact, NULL);
-    sigaction(SIGTERM, &sigact, NULL);
-    sigaction(SIGQUIT, &sigact, NULL);
-    sigaction(SIGPIPE, &sigact, NULL);
-}
-#endif
+    // special case for pulse data file-inputs
+    if (demod->load_info.format == PULSE_OOK) {
+        if (demod->load_info.zstd) {
+            print_log(LOG_ERROR, "Input", "Compressed pulse data input is not supported.");
+            if (in_file != stdin) {
+                fclose(in_file);
+            }
+            return -1;
+        }
+        while (!cfg->exit_async) {
+            pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
+            if (!demod->pulse_data.num_pulses)
+                break;
 
-static void timer_handler(struct mg_connection *nc, int ev, void *ev_data);
+            dump_pulse_input(cfg, &demod->pulse_data, PULSE_DATA_OOK, "OOK");
 
-// called by mg_mgr_poll() for each connection.
-// NOTE: this handler might be called while already in `r_free_cfg()`.
-static void sdr_handler(struct mg_connection *nc, int ev_type, void *ev_data)
-{
-    //fprintf(stderr, "%s: %d, %d, %p, %p\n", __func__, nc->sock, ev_type, nc->user_data, ev_data);
-    // only process polls on the dummy nc
-    if (nc->sock != INVALID_SOCKET || ev_type != MG_EV_POLL) {
-        return;
-    }
-    // only process a broadcast on our defined timer nc
-    if (nc->handler != timer_handler) {
-        return;
+            if (demod->pulse_data.fsk_f2_est) {
+                run_fsk_demods(&demod->fsk_devs, &demod->pulse_data, &demod->slicer_cache, demod->decoder_pool);
+            }
+            else {
+                int p_events = run_ook_demods(&demod->ook_devs, &demod->pulse_data, &demod->slicer_cache, demod->decoder_pool);
+                if (cfg->verbosity >= LOG_DEBUG)
+                    pulse_data_print(&demod->pulse_data);
+                if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+                    analyze_package(cfg, &demod->pulse_data, PULSE_DATA_OOK);
+                }
+            }
+        }
+
+        if (in_file != stdin) {
+            fclose(in_file);
+        }
+
+        return 0;
     }
 
-    r_cfg_t *cfg     = nc->user_data;
-    sdr_event_t *ev = ev_data;
-    //fprintf(stderr, "sdr_handler...\n");
+    // special case for pulse archive file-inputs
+    if (demod->load_info.format == PULSE_ARCHIVE) {
+        if (demod->load_info.zstd) {
+            print_log(LOG_ERROR, "Input", "Compressed pulse archive input is not supported.");
+            if (in_file != stdin) {
+                fclose(in_file);
+            }
+            return -1;
+        }
+        pulse_archive_t *archive = pulse_archive_open(in_file);
+        if (in_file != stdin) {
+            fclose(in_file);
+        }
+        if (!archive) {
+            print_logf(LOG_ERROR, "Input", "Reading pulse archive \"%s\" failed!", cfg->in_filename);
+            return -1;
+        }
+        pulse_data_t *pulse_data = &demod->pulse_data;
+        unsigned first = 0;
+        unsigned count = pulse_archive_count(archive);
+        // a time range counts from the first package
+        if (ranged && count) {
+            int64_t start_us = pulse_archive_time(archive, 0) + (int64_t)range_start_ms * 1000;
+            first            = pulse_archive_seek(archive, start_us);
+            if (range_len_ms)
+                count = pulse_archive_seek(archive, start_us + (int64_t)range_len_ms * 1000);
+        }
+        for (unsigned n = first; n < count && !cfg->exit_async; ++n) {
+            int package_type = pulse_archive_read(archive, n, pulse_data);
+            if (!package_type) {
+                print_logf(LOG_WARNING, "Input", "Skipping invalid package %u of \"%s\"", n, cfg->in_filename);
+                continue;
+            }
+            // report the archived time and position of the package
+            cfg->samp_rate        = pulse_data->sample_rate;
+            cfg->center_frequency = (uint32_t)pulse_data->centerfreq_hz;
+            demod->now.tv_sec     = (time_t)(pulse_data->received_us / 1000000);
+            demod->now.tv_usec    = (long)(pulse_data->received_us % 1000000);
+            if (pulse_data->sample_rate)
+                demod->sample_file_pos = (double)pulse_data->offset / pulse_data->sample_rate;
+
+            dump_pulse_input(cfg, pulse_data, package_type, "pulse archive");
+
+            if (package_type == PULSE_DATA_FSK) {
+                run_fsk_demods(&demod->fsk_devs, pulse_data, &demod->slicer_cache, demod->decoder_pool);
+            }
+            else {
+                int p_events = run_ook_demods(&demod->ook_devs, pulse_data, &demod->slicer_cache, demod->decoder_pool);
+                if (cfg->verbosity >= LOG_DEBUG)
+                    pulse_data_print(pulse_data);
+                if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+                    analyze_package(cfg, pulse_data, PULSE_DATA_OOK);
+                }
+            }
+        }
+        pulse_archive_close(archive);
 
-    data_t *data = NULL;
-    if (ev->ev & SDR_EV_RATE) {
-        // cfg->samp_rate = ev->sample_rate;
-        data = data_int(data, "sample_rate", "", NULL, ev->sample_rate);
+        return 0;
     }
-    if (ev->ev & SDR_EV_CORR) {
-        // cfg->ppm_error = ev->freq_correction;
-        data = data_int(data, "freq_correction", "", NULL, ev->freq_correction);
+
+    // default case for file-inputs
+    int n_blocks = 0;
+    unsigned long n_read;
+    delay_timer_t delay_timer;
+    delay_timer_init(&delay_timer);
+    // a replay as fast as possible counts the time of the samples from the start of the file
+    int64_t clock_ns      = cfg->in_replay < 0 ? replay_start_ns(cfg, in_file, native) : 0;
+    uint64_t file_samples = 0;
+    // samples that need no conversion are demodulated in place from a mapped file
+    size_t map_size = 0;
+    size_t map_pos  = 0;
+    unsigned char *map = NULL;
+    // compressed samples are decompressed ahead on a thread
+    zstd_reader_t *reader = NULL;
+    if (demod->load_info.zstd) {
+        reader = zstd_reader_open(in_file);
+        if (!reader) {
+            if (in_file != stdin) {
+                fclose(in_file);
+            }
+            return -1;
+        }
     }
-    if (ev->ev & SDR_EV_FREQ) {
-        // cfg->center_frequency = ev->center_frequency;
-        data = data_int(data, "center_frequency", "", NULL, ev->center_frequency);
-        if (cfg->frequencies > 1) {
-            data = data_ary(data, "frequencies", "", NULL, data_array(cfg->frequencies, DATA_INT, cfg->frequency));
-            data = data_ary(data, "hop_times", "", NULL, data_array(cfg->hop_times, DATA_INT, cfg->hop_time));
+    int convert = !native && (demod->load_info.format == CS8_IQ || demod->load_info.format == CF32_IQ);
+    if (!convert && !reader)
+        map = map_in_file(in_file, &map_size);
+    // samples from a pipe are read ahead on a thread, the source does not wait on the demodulation
+    pipe_reader_t *ahead = NULL;
+    if (!map && !reader && pipe_reader_is_pipe(in_file))
+        ahead = pipe_reader_open(in_file, cfg->in_filename);
+    size_t map_end = map_size;
+    // a chunk or time range is read from the mapping, or from a seek if the samples are converted
+    uint64_t file_pos = read_begin;
+    if (map) {
+        map_pos = read_begin < map_size ? read_begin : map_size;
+        if (read_end && read_end < map_size)
+            map_end = read_end;
+    }
+    else if (read_begin && seek_in_file(in_file, read_begin) != 0) {
+        print_logf(LOG_ERROR, "Input", "Seeking file \"%s\" to read a range failed!", cfg->in_filename);
+        fclose(in_file);
+        return -1;
+    }
+    do {
+        unsigned char *block = test_mode_buf; // or the samples in the mapped file
+        // Replay in realtime if requested
+        if (cfg->in_replay > 0) {
+            // per block delay
+            unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
+            if (demod->load_info.format == CF32_IQ && !native)
+                delay_us /= 2; // adjust for float only reading half as many samples
+            delay_timer_wait(&delay_timer, delay_us);
+        }
+        if (map) {
+            n_read = map_end - map_pos < DEFAULT_BUF_LENGTH ? map_end - map_pos : DEFAULT_BUF_LENGTH;
+            block = map + map_pos;
+            map_pos += n_read;
+        }
+        // Convert CF32 file to CS16 buffer
+        else if (demod->load_info.format == CF32_IQ && !native) {
+            size_t len = DEFAULT_BUF_LENGTH / 2;
+            if (read_end && (read_end - file_pos) / sizeof(float) < len)
+                len = (read_end - file_pos) / sizeof(float);
+            if (reader)
+                n_read = zstd_reader_read(reader, test_mode_float_buf, sizeof(float) * len) / sizeof(float);
+            else if (ahead)
+                n_read = pipe_reader_read(ahead, test_mode_float_buf, sizeof(float) * len) / sizeof(float);
+            else
+                n_read = fread(test_mode_float_buf, sizeof(float), len, in_file);
+            file_pos += n_read * sizeof(float);
+            // clamp float to [-1,1] and scale to Q0.15
+            convert_kernels()->f32_to_s16(test_mode_float_buf, (int16_t *)test_mode_buf, n_read);
+            n_read *= 2; // convert to byte count
+        } else {
+            size_t len = DEFAULT_BUF_LENGTH;
+            if (read_end && read_end - file_pos < len)
+                len = read_end - file_pos;
+            if (reader)
+                n_read = zstd_reader_read(reader, test_mode_buf, len);
+            else if (ahead)
+                n_read = pipe_reader_read(ahead, test_mode_buf, len);
+            else
+                n_read = fread(test_mode_buf, 1, len, in_file);
+            file_pos += n_read;
+
+            // Convert CS8 file to CU8 buffer
+            if (demod->load_info.format == CS8_IQ && !native) {
+                convert_kernels()->cu8_cs8(test_mode_buf, test_mode_buf, n_read);
+            }
         }
+        if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
+        demod->sample_file_pos = ((double)begin_samples * demod->sample_size + (float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
+        n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
+        if (cfg->in_replay < 0)
+            demod->sample_time_ns = clock_ns + samples_to_ns(begin_samples + file_samples, cfg->samp_rate);
+        file_samples += n_read / demod->sample_size;
+        sdr_callback(block, n_read, cfg);
+    } while (n_read != 0 && !cfg->exit_async);
+    unmap_in_file(map, map_size);
+    zstd_reader_close(reader);
+    pipe_reader_close(ahead);
+
+    // Call a last time with cleared samples to ensure EOP detection
+    if (demod->sample_format == BASEBAND_CU8) {
+        memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
+        // or is 127.5 a better 0 in cu8 data?
+        //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
+        //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
     }
-    if (ev->ev & SDR_EV_GAIN) {
-        data = data_str(data, "gain", "", NULL, ev->gain_str);
+    else { // CS8, CF32, CS16
+            memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
     }
-    if (data) {
-        event_occurred_handler(cfg, data);
+    demod->sample_file_pos = ((double)begin_samples * demod->sample_size + ((float)n_blocks + 1) * DEFAULT_BUF_LENGTH) / cfg->samp_rate / demod->sample_size;
+    if (cfg->in_replay < 0)
+        demod->sample_time_ns = clock_ns + samples_to_ns(begin_samples + file_samples, cfg->samp_rate);
+    sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
+
+    //Always classify a signal at the end of the file
+    if (demod->am_analyze)
+        am_analyze_classify(demod->am_analyze);
+    if (cfg->verbosity >= LOG_NOTICE) {
+        print_logf(LOG_NOTICE, "Input", "Test mode file issued %d packets", n_blocks);
+    }
+    reset_sdr_callback(cfg);
+
+    if (cfg->in_replay < 0) {
+        demod->sample_time_ns = 0;
+        // a given start time continues with the next file
+        if (cfg->replay_clock_ns)
+            cfg->replay_clock_ns = clock_ns + samples_to_ns(begin_samples + file_samples, cfg->samp_rate);
+        cfg->replay_samples += file_samples;
+        cfg->replay_seconds += (double)file_samples / cfg->samp_rate;
     }
 
-    if (ev->ev == SDR_EV_DATA) {
-        cfg->samp_rate        = ev->sample_rate;
-        cfg->center_frequency = ev->center_frequency;
-        sdr_callback((unsigned char *)ev->buf, ev->len, cfg);
+    if (in_file != stdin) {
+        fclose(in_file);
     }
+    return 0;
+}
 
-    if (cfg->exit_async) {
-        if (cfg->verbosity >= 2)
-            print_log(LOG_INFO, "Input", "sdr_handler exit");
-        sdr_stop(cfg->dev);
-        cfg->exit_async++;
+// the throughput of a replay as fast as possible, a benchmark of the whole demodulation
+static void report_replay_throughput(r_cfg_t *cfg, struct timeval const *start)
+{
+    struct timeval now;
+    get_time_now(&now);
+    double elapsed = (double)(now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) / 1e6;
+    if (elapsed <= 0.0)
+        elapsed = 1e-6;
+    print_logf(LOG_CRITICAL, "Input", "Replayed %.3f s of samples in %.3f s: %.0f samples/s, %.1f times realtime",
+            cfg->replay_seconds, elapsed, cfg->replay_samples / elapsed, cfg->replay_seconds / elapsed); // Essential information (not quiet)
+}
+
+/// Input files in a batch per thread, the output of a batch is kept until all its files are done.
+#define IN_FILE_BATCH_PER_THREAD 4
+/// Samples read before and after a chunk, longer than the gap to end a package plus the longest package.
+#define IN_FILE_CHUNK_MARGIN_MS 2000
+/// A file is only split into chunks of at least this many margins.
+#define IN_FILE_CHUNK_MIN_MARGINS 30
+
+typedef struct in_file_task {
+    r_cfg_t *cfg;
+    uint32_t sample_rate_0;
+    unsigned char *buf;
+    in_file_chunk_t const *chunk;
+    int result;
+} in_file_task_t;
+
+// demodulate one input file or chunk, runs on any of the worker pool threads
+static void read_in_file_task(void *arg)
+{
+    in_file_task_t *task = arg;
+    task->result = read_in_file(task->cfg, task->sample_rate_0, 1, task->buf, NULL, task->chunk);
+}
+
+// split a large sample file into up to max_chunks chunks with overlapping margins, returns the number of chunks
+static unsigned split_in_file(char const *filename, uint32_t sample_rate_0, unsigned max_chunks, in_file_chunk_t *chunks)
+{
+    chunks[0] = (in_file_chunk_t){.filename = filename};
+
+#if !defined(_WIN32) && !defined(ESP32)
+    if (in_file_range(filename)) {
+        return 1; // a time range is read whole
+    }
+    file_info_t info = {0};
+    file_info_parse_filename(&info, filename);
+    if (info.sigmf && sigmf_read_meta(&info) < 0) {
+        return 1;
+    }
+    uint64_t sample_size;
+    if (info.format == CU8_IQ || info.format == CS8_IQ || info.format == S16_AM || info.format == S16_FM) {
+        sample_size = 2;
+    } else if (info.format == CS16_IQ) {
+        sample_size = 4;
+    } else if (info.format == CF32_IQ) {
+        sample_size = 8;
+    } else {
+        return 1; // pulse data and invalid formats are read whole
+    }
+    if (info.zstd) {
+        return 1; // compressed files can't be read from an offset
+    }
+    struct stat st;
+    if (strcmp(info.path, "-") == 0 || stat(info.path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return 1;
     }
+    uint64_t size = (uint64_t)st.st_size;
+    uint64_t rate = info.sample_rate ? info.sample_rate : sample_rate_0;
+
+    // margins and chunks are whole blocks, a block is a whole number of samples of any format
+    uint64_t margin = rate * IN_FILE_CHUNK_MARGIN_MS / 1000 * sample_size;
+    margin          = (margin + DEFAULT_BUF_LENGTH - 1) / DEFAULT_BUF_LENGTH * DEFAULT_BUF_LENGTH;
+    uint64_t n      = size / (margin * IN_FILE_CHUNK_MIN_MARGINS);
+    if (n <= 1) {
+        return 1;
+    }
+    if (n > max_chunks) {
+        n = max_chunks;
+    }
+    uint64_t chunk_len = (size + n - 1) / n;
+    chunk_len          = (chunk_len + DEFAULT_BUF_LENGTH - 1) / DEFAULT_BUF_LENGTH * DEFAULT_BUF_LENGTH;
+
+    unsigned count = 0;
+    for (uint64_t begin = 0; begin < size; begin += chunk_len) {
+        uint64_t end = begin + chunk_len;
+        int last     = end >= size;
+        // packages are decoded in the chunk where they start, the margins only settle the levels and end the packages
+        chunks[count++] = (in_file_chunk_t){
+                .filename      = filename,
+                .read_begin    = begin > margin ? begin - margin : 0,
+                .read_end      = last ? 0 : end + margin,
+                .package_begin = begin / sample_size,
+                .package_end   = last ? 0 : end / sample_size,
+        };
+    }
+    return count;
+#else
+    (void)sample_rate_0;
+    (void)max_chunks;
+    return 1;
+#endif
 }
 
-// note that this function is called in a different thread
-static void acquire_callback(sdr_event_t *ev, void *ctx)
+// returns 1 if the input files can be demodulated in parallel, each with its own config
+static int can_read_in_files_parallel(r_cfg_t *cfg)
 {
-    //struct timeval now;
-    //get_time_now(&now);
-    //fprintf(stderr, "%ld.%06ld acquire_callback...\n", (long)now.tv_sec, (long)now.tv_usec);
+    struct dm_state *demod = cfg->demod;
+
+    if (cfg->worker_threads <= 1 || cfg->in_files.len == 0) {
+        return 0;
+    }
+    // sample outputs, analyzers, and limits over all input need the files in turn
+    if (cfg->raw_handler.len || demod->dumper.len || demod->samp_grab || demod->am_analyze || demod->analyze_pulses
+            || cfg->channel_count || cfg->decimation || cfg->in_replay || cfg->bytes_to_read || cfg->after_successful_events_flag) {
+        return 0;
+    }
+    for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
+        if (strncmp(*iter, "pulses:", 7) == 0 || strncmp(*iter, "codes:", 6) == 0 || strncmp(*iter, "batch:", 6) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
 
-    struct mg_mgr *mgr = ctx;
+// demodulate the input files, and chunks of large files, on the worker pool, the output is written in file order,
+// with file_results a file that can't be read is reported there and the others are read on, otherwise the reading stops,
+// returns -1 if there is only one part to read or threads are not available
+static int read_in_files_parallel(r_cfg_t *cfg, list_t *replay_args, uint32_t sample_rate_0, int *file_results)
+{
+    // a large file is split for all threads
+    unsigned max_chunks     = (unsigned)cfg->worker_threads * IN_FILE_BATCH_PER_THREAD;
+    in_file_chunk_t *chunks = calloc(cfg->in_files.len * max_chunks, sizeof(*chunks));
+    if (!chunks)
+        FATAL_CALLOC("read_in_files_parallel()");
+    unsigned chunk_count = 0;
+    for (size_t i = 0; i < cfg->in_files.len; ++i) {
+        unsigned count = split_in_file(cfg->in_files.elems[i], sample_rate_0, max_chunks, &chunks[chunk_count]);
+        for (unsigned k = 0; k < count; ++k) {
+            chunks[chunk_count + k].file_index = i;
+        }
+        chunk_count += count;
+    }
+    if (chunk_count <= 1) {
+        free(chunks);
+        return -1;
+    }
 
-    // TODO: We should run the demod here to unblock the event loop
+    // the pool and the configs are kept for the next files of a batch input
+    unsigned threads = MIN((unsigned)cfg->worker_threads, chunk_count);
+    if (!cfg->worker_pool) {
+        cfg->worker_pool = worker_pool_create(file_results ? (unsigned)cfg->worker_threads : threads);
+    }
+    if (!cfg->worker_pool) {
+        print_log(LOG_WARNING, "Input", "Threads are not available, reading the files in turn.");
+        free(chunks);
+        return -1;
+    }
+    print_logf(LOG_NOTICE, "Input", "Reading %zu files in %u parts on %u threads.", cfg->in_files.len, chunk_count, threads);
+
+    // each task of a batch has its own demod and decoders, the outputs are those of the primary
+    unsigned slots = MIN(threads * IN_FILE_BATCH_PER_THREAD, chunk_count);
+    in_file_task_t *tasks = calloc(slots, sizeof(*tasks));
+    if (!tasks)
+        FATAL_CALLOC("read_in_files_parallel()");
+    void **args = calloc(slots, sizeof(*args));
+    if (!args)
+        FATAL_CALLOC("read_in_files_parallel()");
+    for (unsigned k = cfg->in_file_cfgs.len; k < slots; ++k) {
+        r_cfg_t *fc = r_create_cfg();
+        fc->primary   = cfg;
+        fc->dev_query = cfg->dev_query;
+        r_setup_receiver(fc);
+        fc->stop_time    = cfg->stop_time;
+        fc->report_stats = 0;
+        replay_protocol_opts(fc, replay_args);
+        if (!fc->no_default_devices) {
+            register_all_protocols(fc, 0); // register all defaults
+        }
+        r_shard_decoders(fc);
+        r_pack_decoders(fc);
+        enable_fm_demod(fc->demod);
+        list_push(&cfg->in_file_cfgs, fc);
+    }
+    for (unsigned k = 0; k < slots; ++k) {
+        tasks[k].cfg           = cfg->in_file_cfgs.elems[k];
+        tasks[k].sample_rate_0 = sample_rate_0;
+        tasks[k].buf           = sample_buf_create(DEFAULT_BUF_LENGTH * sizeof(unsigned char));
+        if (!tasks[k].buf)
+            FATAL_MALLOC("read_in_files_parallel()");
+        args[k] = &tasks[k];
+    }
 
-    // thread-safe dispatch, ev_data is the iq buffer pointer and length
-    // mg_mgr_poll() calls specified callback for each connection.
-    //fprintf(stderr, "acquire_callback bc send...\n");
-    mg_broadcast(mgr, sdr_handler, (void *)ev, sizeof(*ev));
-    //fprintf(stderr, "acquire_callback bc done...\n");
+    unsigned next = 0;
+    while (next < chunk_count && !cfg->exit_async) {
+        unsigned k = 0;
+        for (; k < slots && next < chunk_count; ++k, ++next) {
+            tasks[k].cfg->in_filename = chunks[next].filename;
+            tasks[k].chunk            = &chunks[next];
+        }
+        worker_pool_run(cfg->worker_pool, read_in_file_task, args, k);
+
+        // collect in file and chunk order, the output does not depend on the thread timing
+        for (unsigned i = 0; i < k; ++i) {
+            r_cfg_t *fc = tasks[i].cfg;
+            cfg->in_filename = fc->in_filename;
+            r_flush_channel_output(fc);
+            merge_channel_stats(cfg, fc);
+            if (tasks[i].result < 0 && file_results) {
+                file_results[tasks[i].chunk->file_index] = tasks[i].result;
+            }
+            // a file that can't be read, or an expired duration, stops after this batch
+            else if (tasks[i].result < 0 || fc->exit_async) {
+                cfg->exit_async = 1;
+            }
+        }
+    }
+
+    for (unsigned k = 0; k < slots; ++k) {
+        sample_buf_free(tasks[k].buf);
+    }
+    free(tasks);
+    free(args);
+    free(chunks);
+    return 0;
 }
 
-static int start_sdr(r_cfg_t *cfg)
+// returns 1 if the files of a batch coordinator are read
+static int has_batch_input(r_cfg_t *cfg)
 {
-    int r;
-    if (cfg->dev) {
-        r = sdr_close(cfg->dev);
-        cfg->dev = NULL;
-        if (r < 0) {
-            print_logf(LOG_ERROR, "Input", "Closing SDR failed (%d)", r);
+    for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
+        if (strncmp(*iter, "batch:", 6) == 0) {
+            return 1;
         }
     }
-    r = sdr_open(&cfg->dev, cfg->dev_query, cfg->verbosity);
-    if (r < 0) {
-        return -1; // exit(2);
+    return 0;
+}
+
+// decode the files handed out by a batch coordinator, the events are sent back to it
+static void read_batch_input(r_cfg_t *cfg, char const *spec, list_t *replay_args, uint32_t sample_rate_0, int native, unsigned char *test_mode_buf, float *test_mode_float_buf)
+{
+    if (strncmp(spec, "tcp:", 4) != 0) {
+        print_logf(LOG_ERROR, "Input", "Expected e.g. batch:tcp://host:port, not \"%s\"", cfg->in_filename);
+        exit(1);
     }
-    cfg->dev_info = sdr_get_dev_info(cfg->dev);
-    cfg->demod->sample_size = sdr_get_sample_size(cfg->dev);
-    // cfg->demod->sample_signed = sdr_get_sample_signed(cfg->dev);
+    char *param = strdup(spec + 4);
+    if (!param)
+        FATAL_STRDUP("read_batch_input()");
+    char const *host = NULL;
+    char const *port = NULL;
+    hostport_param(param, &host, &port);
+    if (!host || !port) {
+        print_log(LOG_ERROR, "Input", "Missing host or port for batch input");
+        exit(1);
+    }
+    // ask for a file per thread, large files are split on the threads anyway
+    batch_worker_t *worker = batch_worker_create(get_mgr(cfg), host, port, cfg->worker_threads > 1 ? cfg->worker_threads : 1);
+    if (!worker)
+        exit(1);
+    data_output_t *output = batch_worker_output(worker, &cfg->in_filename);
+    if (!output)
+        exit(1);
+    list_push(&cfg->output_handler, output);
+    print_logf(LOG_CRITICAL, "Input", "Decoding the files of the coordinator %s port %s", host, port);
+    free(param);
 
-    /* Set the sample rate */
-    sdr_set_sample_rate(cfg->dev, cfg->samp_rate, 1); // always verbose
+    install_signal_handlers();
+    list_t in_files         = cfg->in_files;
+    char const *in_filename = cfg->in_filename;
+    while (!cfg->exit_async) {
+        // keep the network outputs going while waiting
+        int count = batch_worker_poll(worker, 500);
+        for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_poll(cfg->output_handler.elems[i]);
+        }
+        if (count < 0)
+            break;
+        if (!count)
+            continue;
 
-    if (cfg->verbosity || cfg->demod->level_limit < 0.0)
-        print_logf(LOG_NOTICE, "Input", "Bit detection level set to %.1f%s.", cfg->demod->level_limit, (cfg->demod->level_limit < 0.0 ? "" : " (Auto)"));
+        // the assignment is read like the input files, a file that can't be read is reported and skipped
+        int *results = calloc(count, sizeof(*results));
+        if (!results)
+            FATAL_CALLOC("read_batch_input()");
+        cfg->in_files = (list_t){0};
+        for (int i = 0; i < count; ++i) {
+            list_push(&cfg->in_files, (void *)batch_worker_file(worker, i));
+        }
+        int parallel = can_read_in_files_parallel(cfg) && read_in_files_parallel(cfg, replay_args, sample_rate_0, results) == 0;
+        for (int i = 0; !parallel && i < count && !cfg->exit_async; ++i) {
+            cfg->in_filename = batch_worker_file(worker, i);
+            results[i]       = read_in_file(cfg, sample_rate_0, native, test_mode_buf, test_mode_float_buf, NULL);
+        }
+        // an interrupted assignment is not reported, the coordinator hands it out again
+        for (int i = 0; i < count && !cfg->exit_async; ++i) {
+            batch_worker_done(worker, i, results[i] >= 0);
+        }
+        free(results);
+        list_free_elems(&cfg->in_files, NULL);
+    }
+    cfg->in_files    = in_files;
+    cfg->in_filename = in_filename;
+    batch_worker_free(worker);
+}
 
-    sdr_apply_settings(cfg->dev, cfg->settings_str, 1); // always verbose for soapy
+static void batch_event_output(void *ctx, data_t *data)
+{
+    output_data(ctx, data, 0);
+}
 
-    /* Enable automatic gain if gain_str empty (or 0 for RTL-SDR), set manual gain otherwise */
-    sdr_set_tuner_gain(cfg->dev, cfg->gain_str, 1); // always verbose
+static void merge_output(void *ctx, data_t *data)
+{
+    output_data(ctx, data, 0);
+}
 
-    if (cfg->ppm_error) {
-        sdr_set_freq_correction(cfg->dev, cfg->ppm_error, 1); // always verbose
+// hand the input files to the workers connecting and output their events in input order
+static void run_batch_coordinator(r_cfg_t *cfg)
+{
+    char *param = strdup(cfg->batch_listen + 4);
+    if (!param)
+        FATAL_STRDUP("run_batch_coordinator()");
+    char const *host = NULL; // any address
+    char const *port = NULL;
+    hostport_param(param, &host, &port);
+    if (!port) {
+        print_log(LOG_ERROR, "Batch", "Missing port for the batch coordinator");
+        exit(1);
     }
+    batch_coordinator_t *coord = batch_coordinator_create(get_mgr(cfg), host, port,
+            (char const *const *)cfg->in_files.elems, cfg->in_files.len, batch_event_output, cfg);
+    if (!coord)
+        exit(1);
+    print_logf(LOG_CRITICAL, "Batch", "Handing out %zu files to the workers on %s port %s", cfg->in_files.len, host ? host : "*", port);
+    free(param);
 
-    /* Reset endpoint before we start reading from it (mandatory) */
-    r = sdr_reset(cfg->dev, cfg->verbosity);
-    if (r < 0) {
-        print_log(LOG_ERROR, "Input", "Failed to reset buffers.");
+    install_signal_handlers();
+    while (!cfg->exit_async && !batch_coordinator_done(coord)) {
+        mg_mgr_poll(cfg->mgr, 500);
+        for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+            data_output_poll(cfg->output_handler.elems[i]);
+        }
     }
-    sdr_activate(cfg->dev);
-
-    if (cfg->verbosity) {
-        print_log(LOG_NOTICE, "Input", "Reading samples in async mode...");
+    print_logf(LOG_CRITICAL, "Batch", "%s after %u workers, %u files failed, %u handed out again",
+            batch_coordinator_done(coord) ? "All files done" : "Stopped", batch_coordinator_workers(coord),
+            batch_coordinator_failed(coord), batch_coordinator_reassigned(coord));
+    batch_coordinator_free(coord);
+    // let the workers get the end
+    for (int i = 0; i < 5; ++i) {
+        mg_mgr_poll(cfg->mgr, 10);
     }
+}
 
-    sdr_set_center_freq(cfg->dev, cfg->center_frequency, 1); // always verbose
-
-    r = sdr_start(cfg->dev, acquire_callback, (void *)get_mgr(cfg),
-            DEFAULT_ASYNC_BUF_NUMBER, cfg->out_block_size);
-    if (r < 0) {
-        print_logf(LOG_ERROR, "Input", "async start failed (%d).", r);
-    }
+static list_t in_dir_files;
 
-    cfg->dev_state = DEVICE_STATE_STARTING;
-    return r;
+static int compare_names(void const *a, void const *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
 }
 
-static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
+// add the sample files below a directory to in_dir_files, in sorted order
+static void add_dir_files(char const *dir)
 {
-    //fprintf(stderr, "%s: %d, %d, %p, %p\n", __func__, nc->sock, ev, nc->user_data, ev_data);
-    r_cfg_t *cfg = (r_cfg_t *)nc->user_data;
-    if (sig_hup) {
-        reopen_dumpers(cfg);
-        sig_hup = 0;
+#if !defined(_WIN32) && !defined(ESP32)
+    DIR *d = opendir(dir);
+    if (!d) {
+        print_logf(LOG_ERROR, "Input", "Can't read directory %s", dir);
+        return;
     }
-    switch (ev) {
-    case MG_EV_TIMER: {
-        double now  = *(double *)ev_data;
-        (void) now; // unused
-        double next = mg_time() + 1.5;
-        //fprintf(stderr, "timer event, current time: %.2lf, next timer: %.2lf\n", now, next);
-        mg_set_timer(nc, next); // Send us timer event again after 1.5 seconds
-
-        // Did we acquire data frames in the last interval?
-        if (cfg->watchdog != 0) {
-            if (cfg->dev_state == DEVICE_STATE_STARTING
-                    || cfg->dev_state == DEVICE_STATE_GRACE) {
-                cfg->dev_state = DEVICE_STATE_STARTED;
-                time(&cfg->sdr_since);
-            }
-            cfg->watchdog = 0;
-            break;
+    list_t names = {0};
+    struct dirent *ent;
+    while ((ent = readdir(d))) {
+        if (ent->d_name[0] == '.')
+            continue; // also skips "." and ".."
+        size_t len = strlen(dir) + strlen(ent->d_name) + 2;
+        char *path = malloc(len);
+        if (!path)
+            FATAL_MALLOC("add_dir_files()");
+        snprintf(path, len, "%s/%s", dir, ent->d_name);
+        list_push(&names, path);
+    }
+    closedir(d);
+    if (names.len)
+        qsort(names.elems, names.len, sizeof(*names.elems), compare_names);
+
+    for (void **iter = names.elems; iter && *iter; ++iter) {
+        char *path = *iter;
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            add_dir_files(path);
+            free(path);
+            continue;
         }
+        file_info_t info = {0};
+        int format = file_info_parse_filename(&info, path);
+        if (!info.raw_format)
+            free(path); // e.g. the json of the expected output
+        else if (format == CU8_IQ || format == CS8_IQ || format == CS16_IQ || format == CF32_IQ || format == S16_AM || format == S16_FM)
+            list_push(&in_dir_files, path);
+        else
+            free(path);
+    }
+    list_free_elems(&names, NULL);
+#else
+    print_logf(LOG_ERROR, "Input", "Reading directory %s is not supported", dir);
+#endif
+}
 
-        // Upon starting allow more time until the first frame
-        if (cfg->dev_state == DEVICE_STATE_STARTING) {
-            cfg->dev_state = DEVICE_STATE_GRACE;
-            break;
-        }
-        // We expect a frame at least every 250 ms but didn't get one
-        if (cfg->dev_state == DEVICE_STATE_GRACE) {
-            if (cfg->dev_mode == DEVICE_MODE_QUIT) {
-                print_log(LOG_ERROR, "Input", "Input device start failed, exiting!");
-            }
-            else if (cfg->dev_mode == DEVICE_MODE_RESTART) {
-                print_log(LOG_WARNING, "Input", "Input device start failed, restarting!");
-            }
-            else { // DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
-                print_log(LOG_WARNING, "Input", "Input device start failed, pausing!");
-            }
-        }
-        else if (cfg->dev_state == DEVICE_STATE_STARTED) {
-            if (cfg->dev_mode == DEVICE_MODE_QUIT) {
-                print_log(LOG_ERROR, "Input", "Async read stalled, exiting!");
-            }
-            else if (cfg->dev_mode == DEVICE_MODE_RESTART) {
-                print_log(LOG_WARNING, "Input", "Async read stalled, restarting!");
-            }
-            else { // DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
-                print_log(LOG_WARNING, "Input", "Async read stalled, pausing!");
-            }
-        }
-        if (cfg->dev_state != DEVICE_STATE_STOPPED) {
-            cfg->exit_async = 1;
-            cfg->exit_code = 3;
-            sdr_stop(cfg->dev);
-            cfg->dev_state = DEVICE_STATE_STOPPED;
+// replace the directories of the input files with the sample files below them
+static void expand_in_dirs(r_cfg_t *cfg)
+{
+#if !defined(_WIN32) && !defined(ESP32)
+    list_t in_files = {0};
+    for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
+        char *in_file = *iter;
+        struct stat st;
+        if (stat(in_file, &st) != 0 || !S_ISDIR(st.st_mode)) {
+            list_push(&in_files, in_file);
+            continue;
         }
-        if (cfg->dev_mode == DEVICE_MODE_QUIT) {
-            cfg->exit_async = 1;
+        size_t first = in_dir_files.len;
+        add_dir_files(in_file);
+        if (first == in_dir_files.len)
+            print_logf(LOG_WARNING, "Input", "No sample files in directory %s", in_file);
+        for (size_t i = first; i < in_dir_files.len; ++i) {
+            list_push(&in_files, in_dir_files.elems[i]);
         }
-        if (cfg->dev_mode == DEVICE_MODE_RESTART) {
-            start_sdr(cfg);
+    }
+    list_free_elems(&cfg->in_files, NULL);
+    cfg->in_files = in_files;
+#else
+    (void)cfg;
+#endif
+}
+
+// decode the input files repeatedly and report the throughput, the first pass warms the caches and is not counted
+static void bench_in_files(r_cfg_t *cfg, uint32_t sample_rate_0, int native, unsigned char *test_mode_buf, float *test_mode_float_buf)
+{
+    uint64_t total_ns    = 0;
+    uint64_t best_ns     = 0;
+    double seconds       = 0.0;
+    uint64_t samples     = 0;
+    uint64_t packages    = 0;
+    uint64_t events      = 0;
+    uint64_t baseband_ns = 0;
+    uint64_t detect_ns   = 0;
+    uint64_t decode_ns   = 0;
+    int passes           = 0;
+
+    for (int pass = 0; pass <= cfg->bench_repeats && !cfg->exit_async; ++pass) {
+        flush_report_data(cfg);
+        uint64_t pass_samples = cfg->replay_samples;
+        double pass_seconds   = cfg->replay_seconds;
+
+        uint64_t start = time_monotonic_ns();
+        for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
+            cfg->in_filename = *iter;
+            if (strncmp(cfg->in_filename, "pulses:", 7) == 0 || strncmp(cfg->in_filename, "codes:", 6) == 0 || strncmp(cfg->in_filename, "batch:", 6) == 0)
+                continue; // not a file
+            if (read_in_file(cfg, sample_rate_0, native, test_mode_buf, test_mode_float_buf, NULL) < 0)
+                return;
         }
-        // do nothing for DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
+        uint64_t elapsed = time_monotonic_ns() - start;
 
-        break;
-    }
+        if (pass == 0)
+            continue;
+        passes += 1;
+        total_ns += elapsed;
+        best_ns = !best_ns || elapsed < best_ns ? elapsed : best_ns;
+        seconds += cfg->replay_seconds - pass_seconds;
+        samples += cfg->replay_samples - pass_samples;
+        packages += cfg->frames_ook + cfg->frames_fsk;
+        events += cfg->frames_events;
+        baseband_ns += (uint64_t)cfg->frames_baseband_us * 1000;
+        detect_ns += cfg->frames_detect_ns;
+        decode_ns += cfg->frames_decode_ns;
     }
+    if (!passes || !samples)
+        return;
+
+    double elapsed = total_ns / 1e9;
+    if (elapsed <= 0.0)
+        elapsed = 1e-9;
+    // Essential information (not quiet)
+    print_logf(LOG_CRITICAL, "Bench", "Decoded %zu files %d times, %.3f s of samples in %.3f s (fastest pass %.3f s)",
+            cfg->in_files.len, passes, seconds, elapsed, best_ns / 1e9);
+    print_logf(LOG_CRITICAL, "Bench", "%.0f samples/s, %.1f times realtime, %.1f packages/s, %.1f events/s",
+            samples / elapsed, seconds / elapsed, packages / elapsed, events / elapsed);
+    print_logf(LOG_CRITICAL, "Bench", "baseband %.2f ns/sample (%.0f%%), pulse detect %.2f ns/sample (%.0f%%), decode %.0f ns/package (%.0f%%)",
+            (double)baseband_ns / samples, 100.0 * baseband_ns / total_ns,
+            (double)detect_ns / samples, 100.0 * detect_ns / total_ns,
+            packages ? (double)decode_ns / packages : 0.0, 100.0 * decode_ns / total_ns);
 }
 
 int main(int argc, char **argv) {
     int r = 0;
     struct dm_state *demod;
     r_cfg_t *cfg = &g_cfg;
+    uint64_t start_ns = time_monotonic_ns();
 
+    mem_acct_init(); // before any network buffer is allocated
     print_version(); // always print the version info
     sdr_redirect_logging();
 
     r_init_cfg(cfg);
+    cfg->startup_ns      = start_ns;
+    cfg->startup_last_ns = start_ns;
 
     setbuf(stdout, NULL);
     setbuf(stderr, NULL);
 
     demod = cfg->demod;
 
+    conf_argc = argc;
+    conf_argv = argv;
     // if there is no explicit conf file option look for default conf files
     if (!hasopt('c', argc, argv, OPTSTRING)) {
         parse_conf_try_default_files(cfg);
@@ -1647,6 +5422,9 @@ int main(int argc, char **argv) {
         cfg->frequency[0] = DEFAULT_FREQUENCY;
         cfg->frequencies  = 1;
     }
+    if (cfg->plan_frequencies) {
+        plan_receiver_frequencies(cfg);
+    }
     cfg->center_frequency = cfg->frequency[cfg->frequency_index];
     if (cfg->frequencies > 1 && cfg->hop_times == 0) {
         cfg->hop_time[cfg->hop_times++] = DEFAULT_HOP_TIME;
@@ -1658,8 +5436,10 @@ int main(int argc, char **argv) {
     while (argc > optind) {
         add_infile(cfg, argv[optind++]);
     }
+    expand_in_dirs(cfg);
 
     pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level, demod->min_snr, demod->detect_verbosity);
+    r_update_max_gap(cfg);
 
     if (demod->am_analyze) {
         demod->am_analyze->level_limit = DB_TO_AMP(demod->level_limit);
@@ -1669,13 +5449,12 @@ int main(int argc, char **argv) {
     }
 
     if (demod->samp_grab) {
-        demod->samp_grab->frequency   = &cfg->center_frequency;
-        demod->samp_grab->samp_rate   = &cfg->samp_rate;
-        demod->samp_grab->sample_size = &demod->sample_size;
+        samp_grab_set_input(demod->samp_grab, &cfg->center_frequency, &cfg->samp_rate, &demod->sample_size);
     }
 
     if (cfg->report_time == REPORT_TIME_DEFAULT) {
-        if (cfg->in_files.len)
+        // the simulated sample clock of a replay gives real dates
+        if (cfg->in_files.len && cfg->in_replay >= 0)
             cfg->report_time = REPORT_TIME_SAMPLES;
         else
             cfg->report_time = REPORT_TIME_DATE;
@@ -1690,9 +5469,28 @@ int main(int argc, char **argv) {
             fprintf(stderr, "Unable to set TZ to UTC; error code: %d\n", r);
 #endif
     }
+    startup_phase(cfg, "config");
+
+    if (cfg->kernel_autotune) {
+        int tuned = baseband_autotune(cfg->kernel_cache_path);
+        char names[256];
+        baseband_kernel_names(names, sizeof(names));
+        if (tuned < 0)
+            print_logf(LOG_WARNING, "Baseband", "Kernels not autotuned, using %s", names);
+        else
+            print_logf(LOG_NOTICE, "Baseband", "Autotuned kernels%s: %s", tuned ? " (cached)" : "", names);
+        startup_phase(cfg, "autotune");
+    }
 
-    if (!cfg->output_handler.len) {
-        add_kv_output(cfg, NULL);
+    if (!cfg->output_handler.len && cfg->bench_repeats > 0) {
+        // the benchmark times the decoding, only the log messages are printed
+        add_log_output(cfg, NULL);
+        cfg->has_logout = 1;
+    }
+    else if (!cfg->output_handler.len) {
+        // the events of a batch input only go to the coordinator
+        if (!has_batch_input(cfg))
+            add_output_opt(cfg, NULL);
     }
     else if (!cfg->has_logout) {
         // Warn if no log outputs are enabled
@@ -1701,19 +5499,51 @@ int main(int argc, char **argv) {
     // Change log handler after outputs are set up
     r_redirect_logging(cfg);
 
+    // open the SDR in the background while the decoders and outputs are set up
+    if (!cfg->in_files.len && !cfg->batch_listen && !cfg->test_data && !cfg->sr_filename && cfg->dev_mode != DEVICE_MODE_MANUAL) {
+        sdr_open_start(&cfg->sdr_opener, cfg->dev_query, cfg->verbosity);
+    }
+
     // register default decoders if nothing is configured
     if (!cfg->no_default_devices) {
         register_all_protocols(cfg, 0); // register all defaults
     }
 
-    // check if we need FM demod
-    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
-        r_device *r_dev = *iter;
-        if (r_dev->modulation >= FSK_DEMOD_MIN_VAL) {
-            demod->enable_FM_demod = 1;
-            break;
+    // low latency mode picks a small block size unless one is set
+    if (cfg->low_latency && cfg->out_block_size == DEFAULT_BUF_LENGTH) {
+        cfg->out_block_size = LOW_LATENCY_BUF_LENGTH;
+    }
+
+    // additional receivers get the same decoders and share the outputs
+    cfg->tag_input = cfg->receivers.len > 0;
+    list_t replay_args = {0};
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r_cfg_t *rcv = *iter;
+        r_setup_receiver(rcv);
+        replay_protocol_opts(rcv, &replay_args);
+        if (!rcv->no_default_devices) {
+            register_all_protocols(rcv, 0); // register all defaults
         }
+        enable_fm_demod(rcv->demod);
+        setup_channels(rcv, &replay_args);
+        setup_decoder_pool(rcv);
+        setup_package_queue(rcv);
+    }
+    setup_channels(cfg, &replay_args);
+    setup_decoder_pool(cfg);
+    setup_package_queue(cfg);
+
+    // lay out the decoders of each demod in dispatch order
+    list_t cfgs = {0};
+    demod_configs(cfg, &cfgs);
+    for (void **iter = cfgs.elems; iter && *iter; ++iter) {
+        r_shard_decoders(*iter);
+        r_pack_decoders(*iter);
     }
+    list_free_elems(&cfgs, NULL);
+
+    // check if we need FM demod
+    enable_fm_demod(demod);
     // if any dumpers are requested the FM demod might be needed
     if (cfg->demod->dumper.len) {
         demod->enable_FM_demod = 1;
@@ -1745,11 +5575,47 @@ int main(int argc, char **argv) {
         print_logf(LOG_NOTICE, "Protocols", "Registered %zu out of %u device decoding protocols%s",
                 demod->r_devs.len, cfg->num_r_devices, decoders_str);
     }
+    startup_phase(cfg, "decoders");
 
     char const **well_known = well_known_output_fields(cfg);
     start_outputs(cfg, well_known);
     free((void *)well_known);
 
+    if (cfg->trace_path && start_trace(cfg, cfg->trace_path, cfg->trace_secs) < 0) {
+        exit(1);
+    }
+    if (cfg->merge_window_ms) {
+        cfg->merge = event_merge_create(cfg->merge_window_ms, merge_output, cfg);
+        if (!cfg->merge)
+            exit(1);
+    }
+    if (cfg->decoder_usage_report) {
+        cfg->decoder_usage = decoder_usage_create();
+        if (!cfg->decoder_usage)
+            exit(1);
+    }
+    if (cfg->recorder_secs) {
+        cfg->pulse_recorder = pulse_recorder_create(cfg->recorder_secs, cfg->recorder_size);
+        if (!cfg->pulse_recorder)
+            exit(1);
+    }
+    if (cfg->throttle_secs > 0) {
+        cfg->throttle = event_throttle_create((uint64_t)cfg->throttle_secs * 1000, cfg->throttle_mode);
+        if (!cfg->throttle)
+            exit(1);
+    }
+    if (cfg->max_sensors) {
+        cfg->sensor_state = sensor_state_create(cfg->max_sensors);
+        if (!cfg->sensor_state)
+            exit(1);
+    }
+    if (cfg->warm_start_path) {
+        cfg->warm_start = warm_start_create(cfg->warm_start_path);
+        if (!cfg->warm_start)
+            exit(1);
+    }
+    startup_phase(cfg, "outputs");
+
     if (cfg->out_block_size < MINIMAL_BUF_LENGTH ||
             cfg->out_block_size > MAXIMAL_BUF_LENGTH) {
         print_logf(LOG_ERROR, "Block Size",
@@ -1761,87 +5627,17 @@ int main(int argc, char **argv) {
         cfg->out_block_size = DEFAULT_BUF_LENGTH;
     }
 
+    if (MEMORY_BUDGET) {
+        check_memory_budget(cfg);
+    }
+
     // Special case for streaming test data
     if (cfg->test_data && (!strcasecmp(cfg->test_data, "-") || *cfg->test_data == '@')) {
-        FILE *fp;
-        char line[INPUT_LINE_MAX];
-
-        if (*cfg->test_data == '@') {
-            print_logf(LOG_CRITICAL, "Input", "Reading test data from \"%s\"", &cfg->test_data[1]);
-            fp = fopen(&cfg->test_data[1], "r");
-        } else {
-            print_log(LOG_CRITICAL, "Input", "Reading test data from stdin");
-            fp = stdin;
-        }
-        if (!fp) {
-            print_logf(LOG_ERROR, "Input", "Failed to open %s", cfg->test_data);
-            exit(1);
-        }
-
-        while (fgets(line, INPUT_LINE_MAX, fp)) {
-            if (cfg->verbosity >= LOG_NOTICE)
-                print_logf(LOG_NOTICE, "Input", "Processing test data \"%s\"...", line);
-            r = 0;
-            // test a single decoder?
-            if (*line == '[') {
-                char *e = NULL;
-                unsigned d = (unsigned)strtol(&line[1], &e, 10);
-                if (!e || *e != ']') {
-                    print_logf(LOG_ERROR, "Protocol", "Bad protocol number %.5s.", line);
-                    exit(1);
-                }
-                e++;
-                r_device *r_dev = NULL;
-                for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
-                    r_device *r_dev_i = *iter;
-                    if (r_dev_i->protocol_num == d) {
-                        r_dev = r_dev_i;
-                        break;
-                    }
-                }
-                if (!r_dev) {
-                    print_logf(LOG_ERROR, "Protocol", "Unknown protocol number %u.", d);
-                    exit(1);
-                }
-                if (cfg->verbosity >= LOG_NOTICE)
-                    print_logf(LOG_NOTICE, "Input", "Verifying test data with device %s.", r_dev->name);
-                if (rfraw_check(e)) {
-                    pulse_data_t pulse_data = {0};
-                    rfraw_parse(&pulse_data, e);
-                    list_t single_dev = {0};
-                    list_push(&single_dev, r_dev);
-                    if (!pulse_data.fsk_f2_est)
-                        r += run_ook_demods(&single_dev, &pulse_data);
-                    else
-                        r += run_fsk_demods(&single_dev, &pulse_data);
-                    list_free_elems(&single_dev, NULL);
-                } else
-                r += pulse_slicer_string(e, r_dev);
-                continue;
-            }
-            // otherwise test all decoders
-            if (rfraw_check(line)) {
-                pulse_data_t pulse_data = {0};
-                rfraw_parse(&pulse_data, line);
-                if (!pulse_data.fsk_f2_est)
-                    r += run_ook_demods(&demod->r_devs, &pulse_data);
-                else
-                    r += run_fsk_demods(&demod->r_devs, &pulse_data);
-            } else
-            for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
-                r_device *r_dev = *iter;
-                if (cfg->verbosity >= LOG_NOTICE)
-                    print_logf(LOG_NOTICE, "Input", "Verifying test data with device %s.", r_dev->name);
-                r += pulse_slicer_string(line, r_dev);
-            }
-        }
-
-        if (*cfg->test_data == '@') {
-            fclose(fp);
-        }
-
+        test_codes_t *codes = test_codes_create();
+        r = read_test_codes(cfg, codes, *cfg->test_data == '@' ? &cfg->test_data[1] : "-");
+        test_codes_free(codes);
         r_free_cfg(cfg);
-        exit(!r);
+        exit(r <= 0);
     }
     // Special case for string test data
     if (cfg->test_data) {
@@ -1850,9 +5646,10 @@ int main(int argc, char **argv) {
             pulse_data_t pulse_data = {0};
             rfraw_parse(&pulse_data, cfg->test_data);
             if (!pulse_data.fsk_f2_est)
-                r += run_ook_demods(&demod->r_devs, &pulse_data);
+                r += run_ook_demods(&demod->ook_devs, &pulse_data, &demod->slicer_cache, demod->decoder_pool);
             else
-                r += run_fsk_demods(&demod->r_devs, &pulse_data);
+                r += run_fsk_demods(&demod->fsk_devs, &pulse_data, &demod->slicer_cache, demod->decoder_pool);
+            pulse_data_free(&pulse_data);
         } else
         for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
             r_device *r_dev = *iter;
@@ -1864,173 +5661,87 @@ int main(int argc, char **argv) {
         exit(!r);
     }
 
+    // the input files are handed to remote workers, their events are output here
+    if (!cfg->in_files.len && cfg->batch_listen) {
+        print_log(LOG_ERROR, "Batch", "Hand out input files (-r) with -j batch:");
+        exit(1);
+    }
+    if (cfg->in_files.len && cfg->batch_listen) {
+        run_batch_coordinator(cfg);
+        r_free_cfg(cfg);
+        list_free_elems(&in_dir_files, free);
+        exit(0);
+    }
+
     // Special case for in files
     if (cfg->in_files.len) {
-        unsigned char *test_mode_buf = malloc(DEFAULT_BUF_LENGTH * sizeof(unsigned char));
+        unsigned char *test_mode_buf = sample_buf_create(DEFAULT_BUF_LENGTH * sizeof(unsigned char));
         if (!test_mode_buf)
             FATAL_MALLOC("test_mode_buf");
-        float *test_mode_float_buf = malloc(DEFAULT_BUF_LENGTH / sizeof(int16_t) * sizeof(float));
-        if (!test_mode_float_buf)
-            FATAL_MALLOC("test_mode_float_buf");
+        int native = native_sample_format(cfg);
+        float *test_mode_float_buf = NULL;
+        if (!native) {
+            test_mode_float_buf = sample_buf_create(DEFAULT_BUF_LENGTH / sizeof(int16_t) * sizeof(float));
+            if (!test_mode_float_buf)
+                FATAL_MALLOC("test_mode_float_buf");
+        }
 
         if (cfg->duration > 0) {
             time(&cfg->stop_time);
             cfg->stop_time += cfg->duration;
         }
 
-        for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
-            cfg->in_filename = *iter;
+        struct timeval replay_start;
+        get_time_now(&replay_start);
 
-            file_info_clear(&demod->load_info); // reset all info
-            file_info_parse_filename(&demod->load_info, cfg->in_filename);
-            // apply file info or default
-            cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : sample_rate_0;
-            cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency : cfg->frequency[0];
-
-            FILE *in_file;
-            if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
-                in_file = stdin;
-                cfg->in_filename = "<stdin>";
-            } else {
-                in_file = fopen(demod->load_info.path, "rb");
-                if (!in_file) {
-                    print_logf(LOG_ERROR, "Input", "Opening file \"%s\" failed!", cfg->in_filename);
-                    break;
-                }
-            }
-            print_logf(LOG_CRITICAL, "Input", "Test mode active. Reading samples from file: %s", cfg->in_filename); // Essential information (not quiet)
-            if (demod->load_info.format == CU8_IQ
-                    || demod->load_info.format == CS8_IQ
-                    || demod->load_info.format == S16_AM
-                    || demod->load_info.format == S16_FM) {
-                demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
-            } else if (demod->load_info.format == CS16_IQ
-                    || demod->load_info.format == CF32_IQ) {
-                demod->sample_size = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
-            } else if (demod->load_info.format == PULSE_OOK) {
-                // ignore
-            } else {
-                print_logf(LOG_ERROR, "Input", "Input format invalid \"%s\"", file_info_string(&demod->load_info));
-                break;
-            }
-            if (cfg->verbosity >= LOG_NOTICE) {
-                print_logf(LOG_NOTICE, "Input", "Input format \"%s\"", file_info_string(&demod->load_info));
-            }
-            demod->sample_file_pos = 0.0;
-
-            // special case for pulse data file-inputs
-            if (demod->load_info.format == PULSE_OOK) {
-                while (!cfg->exit_async) {
-                    pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
-                    if (!demod->pulse_data.num_pulses)
-                        break;
-
-                    for (void **iter2 = demod->dumper.elems; iter2 && *iter2; ++iter2) {
-                        file_info_t const *dumper = *iter2;
-                        if (dumper->format == VCD_LOGIC) {
-                            pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
-                        } else if (dumper->format == PULSE_OOK) {
-                            pulse_data_dump(dumper->file, &demod->pulse_data);
-                        } else {
-                            print_logf(LOG_ERROR, "Input", "Dumper (%s) not supported on OOK input", dumper->spec);
-                            exit(1);
-                        }
-                    }
-
-                    if (demod->pulse_data.fsk_f2_est) {
-                        run_fsk_demods(&demod->r_devs, &demod->pulse_data);
-                    }
-                    else {
-                        int p_events = run_ook_demods(&demod->r_devs, &demod->pulse_data);
-                        if (cfg->verbosity >= LOG_DEBUG)
-                            pulse_data_print(&demod->pulse_data);
-                        if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
-                            r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
-                            pulse_analyzer(&demod->pulse_data, PULSE_DATA_OOK, &device);
-                        }
-                    }
-                }
+        // the benchmark reads the files itself, repeatedly
+        int bench = cfg->bench_repeats > 0;
+        if (bench) {
+            bench_in_files(cfg, sample_rate_0, native, test_mode_buf, test_mode_float_buf);
+        }
 
-                if (in_file != stdin) {
-                    fclose(in_file);
-                }
+        // with -j the files are read in parallel if their output does not depend on the order
+        int parallel = !bench && can_read_in_files_parallel(cfg) && read_in_files_parallel(cfg, &replay_args, sample_rate_0, NULL) == 0;
 
-                continue;
-            }
+        if (!bench && !parallel) {
+            start_duty_cycle(cfg);
+        }
 
-            // default case for file-inputs
-            int n_blocks = 0;
-            unsigned long n_read;
-            delay_timer_t delay_timer;
-            delay_timer_init(&delay_timer);
-            do {
-                // Replay in realtime if requested
-                if (cfg->in_replay) {
-                    // per block delay
-                    unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
-                    if (demod->load_info.format == CF32_IQ)
-                        delay_us /= 2; // adjust for float only reading half as many samples
-                    delay_timer_wait(&delay_timer, delay_us);
-                }
-                // Convert CF32 file to CS16 buffer
-                if (demod->load_info.format == CF32_IQ) {
-                    n_read = fread(test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2, in_file);
-                    // clamp float to [-1,1] and scale to Q0.15
-                    for (unsigned long n = 0; n < n_read; n++) {
-                        int s_tmp = test_mode_float_buf[n] * INT16_MAX;
-                        if (s_tmp < -INT16_MAX)
-                            s_tmp = -INT16_MAX;
-                        else if (s_tmp > INT16_MAX)
-                            s_tmp = INT16_MAX;
-                        ((int16_t *)test_mode_buf)[n] = s_tmp;
-                    }
-                    n_read *= 2; // convert to byte count
-                } else {
-                    n_read = fread(test_mode_buf, 1, DEFAULT_BUF_LENGTH, in_file);
-
-                    // Convert CS8 file to CU8 buffer
-                    if (demod->load_info.format == CS8_IQ) {
-                        for (unsigned long n = 0; n < n_read; n++) {
-                            test_mode_buf[n] = ((int8_t)test_mode_buf[n]) + 128;
-                        }
-                    }
-                }
-                if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
-                demod->sample_file_pos = ((float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
-                n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
-                sdr_callback(test_mode_buf, n_read, cfg);
-            } while (n_read != 0 && !cfg->exit_async);
+        for (void **iter = cfg->in_files.elems; !bench && !parallel && iter && *iter; ++iter) {
+            cfg->in_filename = *iter;
 
-            // Call a last time with cleared samples to ensure EOP detection
-            if (demod->sample_size == 2) { // CU8
-                memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
-                // or is 127.5 a better 0 in cu8 data?
-                //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
-                //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
-            }
-            else { // CF32, CS16
-                    memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
+            // special case for pulse data from the network
+            if (strncmp(cfg->in_filename, "pulses:", 7) == 0) {
+                read_pulses_input(cfg, cfg->in_filename + 7);
+                continue;
             }
-            demod->sample_file_pos = ((float)n_blocks + 1) * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size;
-            sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
 
-            //Always classify a signal at the end of the file
-            if (demod->am_analyze)
-                am_analyze_classify(demod->am_analyze);
-            if (cfg->verbosity >= LOG_NOTICE) {
-                print_logf(LOG_NOTICE, "Input", "Test mode file issued %d packets", n_blocks);
+            if (strncmp(cfg->in_filename, "codes:", 6) == 0) {
+                read_codes_input(cfg, cfg->in_filename + 6);
+                continue;
             }
-            reset_sdr_callback(cfg);
 
-            if (in_file != stdin) {
-                fclose(in_file);
+            // special case for the files of a batch coordinator
+            if (strncmp(cfg->in_filename, "batch:", 6) == 0) {
+                read_batch_input(cfg, cfg->in_filename + 6, &replay_args, sample_rate_0, native, test_mode_buf, test_mode_float_buf);
+                continue;
             }
+
+            if (read_in_file(cfg, sample_rate_0, native, test_mode_buf, test_mode_float_buf, NULL) < 0)
+                break;
+        }
+
+        if (cfg->in_replay < 0 && !bench) {
+            report_replay_throughput(cfg, &replay_start);
         }
 
         close_dumpers(cfg);
-        free(test_mode_buf);
-        free(test_mode_float_buf);
+        sample_buf_free(test_mode_buf);
+        sample_buf_free(test_mode_float_buf);
+        print_analyzer_batch(cfg);
+        write_decoder_usage(cfg);
         r_free_cfg(cfg);
+        list_free_elems(&in_dir_files, free);
         exit(0);
     }
 
@@ -2040,47 +5751,27 @@ int main(int argc, char **argv) {
         exit(1);
     }
 
-#ifndef _WIN32
-    struct sigaction sigact;
-    sigact.sa_handler = sighandler;
-    sigemptyset(&sigact.sa_mask);
-    sigact.sa_flags = 0;
-    sigaction(SIGHUP, &sigact, NULL);
-    sigaction(SIGINT, &sigact, NULL);
-    sigaction(SIGTERM, &sigact, NULL);
-    sigaction(SIGQUIT, &sigact, NULL);
-    sigaction(SIGPIPE, &sigact, NULL);
-    sigaction(SIGUSR1, &sigact, NULL);
-    sigaction(SIGINFO, &sigact, NULL);
-#else
-    SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_handler, TRUE);
-#endif
+    install_signal_handlers();
 
     // TODO: remove this before next release
     print_log(LOG_NOTICE, "Input", "The internals of input handling changed, read about and report problems on PR #1978");
 
-    if (cfg->dev_mode != DEVICE_MODE_MANUAL) {
-        r = start_sdr(cfg);
+    r = start_receiver(cfg);
+    if (r < 0) {
+        exit(2);
+    }
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        r = start_receiver(*iter);
         if (r < 0) {
             exit(2);
         }
     }
 
-    if (cfg->duration > 0) {
-        time(&cfg->stop_time);
-        cfg->stop_time += cfg->duration;
-    }
-
-    time(&cfg->hop_start_time);
-
-    // add dummy socket to receive broadcasts
-    struct mg_add_sock_opts opts = {.user_data = cfg};
-    struct mg_connection *nc = mg_add_sock_opt(get_mgr(cfg), INVALID_SOCKET, timer_handler, opts);
-    // Send us MG_EV_TIMER event after 2.5 seconds
-    mg_set_timer(nc, mg_time() + 2.5);
-
-    while (!cfg->exit_async) {
+    // hot path warnings of the demod and worker threads are queued and delivered here
+    log_ring_start();
+    while (!receivers_exiting(cfg)) {
         mg_mgr_poll(cfg->mgr, 500);
+        r_drain_logging(cfg);
     }
     if (cfg->verbosity >= LOG_INFO)
         print_log(LOG_INFO, "rtl_433", "stopping...");
@@ -2088,13 +5779,21 @@ int main(int argc, char **argv) {
     //while (cfg->exit_async < 2) {
     //    mg_mgr_poll(cfg->mgr, 100);
     //}
-    sdr_stop(cfg->dev);
-    //print_log(LOG_INFO, "rtl_433", "stopped.");
-
-    if (cfg->report_stats > 0) {
-        event_occurred_handler(cfg, create_report_data(cfg, cfg->report_stats));
-        flush_report_data(cfg);
+    for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+        stop_receiver(*iter);
+    }
+    stop_receiver(cfg);
+    // the demods are stopped, their last levels are saved
+    if (cfg->warm_start) {
+        for (void **iter = cfg->receivers.elems; iter && *iter; ++iter) {
+            keep_warm_start(*iter, cfg->warm_start);
+        }
+        keep_warm_start(cfg, cfg->warm_start);
+        warm_start_save(cfg->warm_start);
     }
+    log_ring_stop();
+    r_drain_logging(cfg);
+    //print_log(LOG_INFO, "rtl_433", "stopped.");
 
     if (!cfg->exit_async) {
         print_logf(LOG_ERROR, "rtl_433", "Library error %d, exiting...", r);
@@ -2103,7 +5802,14 @@ int main(int argc, char **argv) {
 
     if (cfg->exit_code >= 0)
         r = cfg->exit_code;
+    print_analyzer_batch(cfg);
+    write_decoder_usage(cfg);
     r_free_cfg(cfg);
+    list_free_elems(&replay_args, free);
+    list_free_elems(&protocol_opts, free);
+    list_free_elems(&output_opts, (list_elem_free_fn)free_output_opt);
+    list_free_elems(&retired_outputs, (list_elem_free_fn)data_output_free);
+    list_free_elems(&reload_args, free);
 
     return r >= 0 ? r : -r;
 }
@@ -0,0 +1,287 @@
+/** @file
+    Compressed transport extension of the rtl_tcp protocol.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "rtltcp_codec.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef ZSTD
+#include <zstd.h>
+#endif
+
+/// Block types.
+#define BLOCK_RAW    0
+#define BLOCK_ZSTD   1
+#define BLOCK_NIBBLE 2
+
+/// Fast compression, the stream is live.
+#define RTLTCP_ZSTD_LEVEL 1
+/// Largest shift of a requantized frame, i.e. a swing of +-32 counts as noise.
+#define RTLTCP_NOISE_SHIFT 2
+
+struct rtltcp_codec {
+    unsigned method;
+    uint8_t *buf; ///< the encoded block
+    size_t buf_size;
+#ifdef ZSTD
+    ZSTD_CCtx *cctx;
+    ZSTD_DCtx *dctx;
+#endif
+};
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_be32(uint8_t const *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+unsigned rtltcp_codec_methods(void)
+{
+#ifdef ZSTD
+    return RTLTCP_COMPRESS_ZSTD | RTLTCP_COMPRESS_NIBBLE;
+#else
+    return RTLTCP_COMPRESS_NIBBLE;
+#endif
+}
+
+unsigned rtltcp_codec_parse(char const *arg)
+{
+    if (!arg || !*arg)
+        return rtltcp_codec_methods();
+    if (!strcasecmp(arg, "zstd"))
+        return RTLTCP_COMPRESS_ZSTD & rtltcp_codec_methods();
+    if (!strcasecmp(arg, "4bit"))
+        return RTLTCP_COMPRESS_NIBBLE;
+    return 0;
+}
+
+char const *rtltcp_codec_name(unsigned method)
+{
+    switch (method) {
+    case RTLTCP_COMPRESS_ZSTD:
+        return "zstd";
+    case RTLTCP_COMPRESS_NIBBLE:
+        return "4bit";
+    default:
+        return "none";
+    }
+}
+
+unsigned rtltcp_codec_choose(unsigned offered)
+{
+    offered &= rtltcp_codec_methods();
+    if (offered & RTLTCP_COMPRESS_ZSTD)
+        return RTLTCP_COMPRESS_ZSTD;
+    if (offered & RTLTCP_COMPRESS_NIBBLE)
+        return RTLTCP_COMPRESS_NIBBLE;
+    return 0;
+}
+
+void rtltcp_codec_ack(uint8_t ack[RTLTCP_CODEC_HEADER], unsigned method)
+{
+    memcpy(ack, "RTLZ", 4);
+    put_be32(&ack[4], method);
+    put_be32(&ack[8], 0);
+}
+
+int rtltcp_codec_parse_ack(uint8_t const ack[RTLTCP_CODEC_HEADER], unsigned requested)
+{
+    if (memcmp(ack, "RTLZ", 4) || get_be32(&ack[8]) != 0)
+        return -1;
+    unsigned method = get_be32(&ack[4]);
+    if (method && (method & (method - 1) || (method & ~requested)))
+        return -1; // not a single requested method
+    return (int)method;
+}
+
+rtltcp_codec_t *rtltcp_codec_create(unsigned method)
+{
+    if (rtltcp_codec_choose(method) != method)
+        return NULL;
+
+    rtltcp_codec_t *codec = calloc(1, sizeof(*codec));
+    if (!codec) {
+        WARN_CALLOC("rtltcp_codec_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    codec->method = method;
+#ifdef ZSTD
+    if (method == RTLTCP_COMPRESS_ZSTD) {
+        codec->cctx = ZSTD_createCCtx();
+        codec->dctx = ZSTD_createDCtx();
+        if (!codec->cctx || !codec->dctx) {
+            rtltcp_codec_free(codec);
+            return NULL;
+        }
+    }
+#endif
+    return codec;
+}
+
+void rtltcp_codec_free(rtltcp_codec_t *codec)
+{
+    if (!codec)
+        return;
+#ifdef ZSTD
+    ZSTD_freeCCtx(codec->cctx);
+    ZSTD_freeDCtx(codec->dctx);
+#endif
+    free(codec->buf);
+    free(codec);
+}
+
+// the smallest shift to fit all samples in 4 bits around the center, above the noise shift if none
+static unsigned nibble_shift(uint8_t const *data, uint32_t len)
+{
+    uint8_t lo = 255;
+    uint8_t hi = 0;
+    for (uint32_t i = 0; i < len; ++i) {
+        if (data[i] < lo)
+            lo = data[i];
+        if (data[i] > hi)
+            hi = data[i];
+    }
+    unsigned shift = 0;
+    while (shift <= RTLTCP_NOISE_SHIFT && ((lo >> shift) < (128 >> shift) - 8 || (hi >> shift) > (128 >> shift) + 7))
+        shift++;
+    return shift;
+}
+
+static void nibble_pack(uint8_t const *data, uint32_t len, unsigned shift, uint8_t *out)
+{
+    unsigned center = 128 >> shift;
+    for (uint32_t i = 0; i < len; i += 2) {
+        unsigned lo = ((data[i] >> shift) - center) & 0x0f;
+        unsigned hi = i + 1 < len ? ((data[i + 1] >> shift) - center) & 0x0f : 0;
+        out[i / 2]  = (uint8_t)(lo | hi << 4);
+    }
+}
+
+static void nibble_unpack(uint8_t const *in, uint32_t len, unsigned shift, uint8_t *out)
+{
+    int center = 128 >> shift;
+    int half   = shift ? 1 << (shift - 1) : 0; // reconstruct to the middle of the step
+    for (uint32_t i = 0; i < len; ++i) {
+        int n  = i & 1 ? in[i / 2] >> 4 : in[i / 2] & 0x0f;
+        int q  = n >= 8 ? n - 16 : n;
+        out[i] = (uint8_t)(((q + center) << shift) + half);
+    }
+}
+
+uint8_t const *rtltcp_codec_encode(rtltcp_codec_t *codec, uint8_t const *data, uint32_t len, uint32_t *block_len)
+{
+    size_t bound = len;
+#ifdef ZSTD
+    if (codec->method == RTLTCP_COMPRESS_ZSTD)
+        bound = ZSTD_compressBound(len);
+#endif
+    if (codec->buf_size < RTLTCP_CODEC_HEADER + bound) {
+        uint8_t *buf = realloc(codec->buf, RTLTCP_CODEC_HEADER + bound);
+        if (!buf) {
+            WARN_REALLOC("rtltcp_codec_encode()");
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+        codec->buf      = buf;
+        codec->buf_size = RTLTCP_CODEC_HEADER + bound;
+    }
+    uint8_t *payload = &codec->buf[RTLTCP_CODEC_HEADER];
+
+    unsigned type  = BLOCK_RAW;
+    unsigned shift = 0;
+    size_t out_len = len;
+    if (codec->method == RTLTCP_COMPRESS_NIBBLE) {
+        shift = nibble_shift(data, len);
+        if (shift <= RTLTCP_NOISE_SHIFT) {
+            type    = BLOCK_NIBBLE;
+            out_len = (len + 1) / 2;
+            nibble_pack(data, len, shift, payload);
+        }
+        else {
+            shift = 0;
+        }
+    }
+#ifdef ZSTD
+    if (codec->method == RTLTCP_COMPRESS_ZSTD) {
+        size_t ret = ZSTD_compressCCtx(codec->cctx, payload, bound, data, len, RTLTCP_ZSTD_LEVEL);
+        if (!ZSTD_isError(ret) && ret < len) {
+            type    = BLOCK_ZSTD;
+            out_len = ret;
+        }
+    }
+#endif
+    if (type == BLOCK_RAW)
+        memcpy(payload, data, len);
+
+    codec->buf[0] = (uint8_t)type;
+    codec->buf[1] = (uint8_t)shift;
+    codec->buf[2] = 0;
+    codec->buf[3] = 0;
+    put_be32(&codec->buf[4], len);
+    put_be32(&codec->buf[8], (uint32_t)out_len);
+    *block_len = RTLTCP_CODEC_HEADER + (uint32_t)out_len;
+    return codec->buf;
+}
+
+int rtltcp_codec_header(uint8_t const header[RTLTCP_CODEC_HEADER], uint32_t *raw_len, uint32_t *payload_len)
+{
+    unsigned type  = header[0];
+    unsigned shift = header[1];
+    *raw_len       = get_be32(&header[4]);
+    *payload_len   = get_be32(&header[8]);
+    if (header[2] || header[3] || *raw_len > RTLTCP_CODEC_MAX_BLOCK)
+        return -1;
+    if (type == BLOCK_RAW)
+        return shift || *payload_len != *raw_len ? -1 : 0;
+    if (type == BLOCK_NIBBLE)
+        return shift > RTLTCP_NOISE_SHIFT || *payload_len != (*raw_len + 1) / 2 ? -1 : 0;
+    if (type == BLOCK_ZSTD)
+        return shift || *payload_len > *raw_len ? -1 : 0;
+    return -1;
+}
+
+int rtltcp_codec_decode(rtltcp_codec_t *codec, uint8_t const header[RTLTCP_CODEC_HEADER], uint8_t const *payload, uint8_t *out)
+{
+    uint32_t raw_len;
+    uint32_t payload_len;
+    if (rtltcp_codec_header(header, &raw_len, &payload_len) < 0)
+        return -1;
+
+    switch (header[0]) {
+    case BLOCK_RAW:
+        memcpy(out, payload, raw_len);
+        return 0;
+    case BLOCK_NIBBLE:
+        nibble_unpack(payload, raw_len, header[1], out);
+        return 0;
+    case BLOCK_ZSTD:
+#ifdef ZSTD
+        if (codec->dctx) {
+            size_t ret = ZSTD_decompressDCtx(codec->dctx, out, raw_len, payload, payload_len);
+            return !ZSTD_isError(ret) && ret == raw_len ? 0 : -1;
+        }
+#endif
+        (void)codec;
+        return -1;
+    default:
+        return -1;
+    }
+}
@@ -25,7 +25,147 @@
 #endif
 
 #include "samp_grab.h"
+#include "sample_buf.h"
 #include "fatal.h"
+#include "compat_pthread.h"
+
+/*
+    The samples are copied once into the ring, grabs only reference ring positions.
+    Positions count the bytes pushed in total, the ring index is the position modulo the size.
+    A push waits if it would overwrite samples of a grab that are not written yet.
+*/
+
+typedef struct grab_job {
+    char name[64];
+    uint64_t pos; ///< next byte to write
+    uint64_t end; ///< end of the grab, might not be pushed yet
+    FILE *file;   ///< only used by the writer
+} grab_job_t;
+
+struct samp_grab {
+    uint32_t *frequency;
+    uint32_t *samp_rate;
+    int *sample_size;
+    int pre_pad_ms;
+    int post_pad_ms;
+
+    unsigned sg_counter;
+    char *sg_buf;
+    unsigned sg_size;
+    unsigned sg_len;    ///< bytes of history in the ring
+    uint64_t sg_pushed; ///< bytes pushed in total
+
+    grab_job_t jobs[SAMP_GRAB_JOBS];
+    unsigned job_head;  ///< oldest pending grab
+    unsigned job_count; ///< pending grabs
+    int closing;        ///< write the pending grabs with the samples pushed so far
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the positions and grabs, never held while writing
+    pthread_cond_t cond;  ///< signals pushed samples, a queued grab, or written samples
+    int running;          ///< the thread was started
+#endif
+};
+
+#ifdef THREADS
+#define GRAB_LOCK(g) pthread_mutex_lock(&(g)->lock)
+#define GRAB_UNLOCK(g) pthread_mutex_unlock(&(g)->lock)
+#else
+#define GRAB_LOCK(g)
+#define GRAB_UNLOCK(g)
+#endif
+
+#ifdef THREADS
+// bytes that can be pushed without overwriting samples of a pending grab, lock held
+static unsigned grab_room(samp_grab_t *g)
+{
+    uint64_t oldest = g->sg_pushed;
+    for (unsigned k = 0; k < g->job_count; ++k) {
+        grab_job_t const *job = &g->jobs[(g->job_head + k) % SAMP_GRAB_JOBS];
+        if (job->pos < oldest)
+            oldest = job->pos;
+    }
+    return g->sg_size - (unsigned)(g->sg_pushed - oldest);
+}
+#endif
+
+// write the ring from the job position to end, the range is never overwritten meanwhile
+static void grab_write_job(samp_grab_t *g, grab_job_t *job, uint64_t end)
+{
+    if (!job->file) {
+        job->file = fopen(job->name, "wb");
+        if (!job->file) {
+            fprintf(stderr, "Failed to open %s\n", job->name);
+            return;
+        }
+    }
+    for (uint64_t pos = job->pos; pos < end;) {
+        unsigned index = (unsigned)(pos % g->sg_size);
+        unsigned wlen  = g->sg_size - index;
+        if (wlen > end - pos)
+            wlen = (unsigned)(end - pos);
+        if (fwrite(&g->sg_buf[index], 1, wlen, job->file) != wlen) {
+            fprintf(stderr, "Short write to %s\n", job->name);
+            fclose(job->file);
+            job->file = NULL;
+            return;
+        }
+        pos += wlen;
+    }
+}
+
+/// Write the pushed samples of one grab or retire the finished grabs, lock held, returns 0 if there is nothing to do.
+static int grab_step(samp_grab_t *g)
+{
+    for (unsigned k = 0; k < g->job_count; ++k) {
+        grab_job_t *job = &g->jobs[(g->job_head + k) % SAMP_GRAB_JOBS];
+        uint64_t end    = job->end < g->sg_pushed ? job->end : g->sg_pushed;
+        if (job->pos < end) {
+            GRAB_UNLOCK(g);
+            grab_write_job(g, job, end);
+            GRAB_LOCK(g);
+            // a failed grab is dropped, the samples are not kept for it
+            job->pos = job->file ? end : job->end;
+            return 1;
+        }
+    }
+
+    int retired = 0;
+    while (g->job_count > 0) {
+        grab_job_t *job = &g->jobs[g->job_head];
+        if (job->pos < job->end && !g->closing)
+            break;
+        if (job->file)
+            fclose(job->file);
+        job->file   = NULL;
+        g->job_head = (g->job_head + 1) % SAMP_GRAB_JOBS;
+        g->job_count -= 1;
+        retired = 1;
+    }
+    return retired;
+}
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL grab_run(void *arg)
+{
+    samp_grab_t *g = arg;
+
+    pthread_mutex_lock(&g->lock);
+    while (1) {
+        if (grab_step(g)) {
+            pthread_cond_broadcast(&g->cond);
+            continue;
+        }
+        if (g->closing)
+            break;
+        pthread_cond_wait(&g->cond, &g->lock);
+    }
+    pthread_mutex_unlock(&g->lock);
+
+    return (THREAD_RETURN)(intptr_t)0;
+}
+#endif
 
 samp_grab_t *samp_grab_create(unsigned size)
 {
@@ -38,64 +178,122 @@ samp_grab_t *samp_grab_create(unsigned size)
 
     g->sg_size = size;
     g->sg_counter = 1;
+    g->pre_pad_ms  = -1;
+    g->post_pad_ms = -1;
 
-    g->sg_buf = malloc(size);
+    g->sg_buf = sample_buf_create(size);
     if (!g->sg_buf) {
         WARN_MALLOC("samp_grab_create()");
         free(g);
         return NULL; // NOTE: returns NULL on alloc failure.
     }
 
+#ifdef THREADS
+    pthread_mutex_init(&g->lock, NULL);
+    pthread_cond_init(&g->cond, NULL);
+    if (pthread_create(&g->thread, NULL, grab_run, g)) {
+        fprintf(stderr, "Unable to create the signal grabber thread.\n");
+        samp_grab_free(g);
+        return NULL;
+    }
+    g->running = 1;
+#endif
+
     return g;
 }
 
 void samp_grab_free(samp_grab_t *g)
 {
-    if (g->sg_buf)
-        free(g->sg_buf);
+    if (!g)
+        return;
+
+    GRAB_LOCK(g);
+    g->closing = 1;
+#ifdef THREADS
+    pthread_cond_broadcast(&g->cond);
+#else
+    while (grab_step(g)) {
+    }
+#endif
+    GRAB_UNLOCK(g);
+
+#ifdef THREADS
+    if (g->running)
+        pthread_join(g->thread, NULL);
+    pthread_mutex_destroy(&g->lock);
+    pthread_cond_destroy(&g->cond);
+#endif
+
+    sample_buf_free(g->sg_buf);
     free(g);
 }
 
+void samp_grab_set_input(samp_grab_t *g, uint32_t *frequency, uint32_t *samp_rate, int *sample_size)
+{
+    g->frequency   = frequency;
+    g->samp_rate   = samp_rate;
+    g->sample_size = sample_size;
+}
+
+void samp_grab_set_padding(samp_grab_t *g, int pre_ms, int post_ms)
+{
+    g->pre_pad_ms  = pre_ms;
+    g->post_pad_ms = post_ms;
+}
+
 void samp_grab_push(samp_grab_t *g, unsigned char *iq_buf, uint32_t len)
 {
-    //fprintf(stderr, "sg_index %d + len %d (size %d ", g->sg_index, len, g->sg_len);
+    while (len) {
+        // never more than the ring at once, a pending grab would block it
+        unsigned chunk_len = len < g->sg_size ? len : g->sg_size;
 
-    g->sg_len += len;
-    if (g->sg_len > g->sg_size)
-        g->sg_len = g->sg_size;
+        GRAB_LOCK(g);
+#ifdef THREADS
+        while (grab_room(g) < chunk_len) {
+            pthread_cond_wait(&g->cond, &g->lock);
+        }
+#endif
+        unsigned index = (unsigned)(g->sg_pushed % g->sg_size);
+        GRAB_UNLOCK(g);
 
-    //fprintf(stderr, "-> %d)\n", g->sg_len);
+        // the writer only reads older samples, copy without the lock
+        unsigned first_len = g->sg_size - index;
+        if (first_len > chunk_len)
+            first_len = chunk_len;
+        memcpy(&g->sg_buf[index], iq_buf, first_len);
+        memcpy(&g->sg_buf[0], iq_buf + first_len, chunk_len - first_len);
 
-    while (len) {
-        unsigned chunk_len = len;
-        if (g->sg_index + chunk_len > g->sg_size)
-            chunk_len = g->sg_size - g->sg_index;
+        GRAB_LOCK(g);
+        g->sg_pushed += chunk_len;
+        g->sg_len += chunk_len;
+        if (g->sg_len > g->sg_size)
+            g->sg_len = g->sg_size;
+#ifdef THREADS
+        pthread_cond_broadcast(&g->cond);
+#else
+        while (grab_step(g)) {
+        }
+#endif
+        GRAB_UNLOCK(g);
 
-        memcpy(&g->sg_buf[g->sg_index], iq_buf, chunk_len);
         iq_buf += chunk_len;
         len -= chunk_len;
-        g->sg_index += chunk_len;
-        if (g->sg_index >= g->sg_size)
-            g->sg_index = 0;
     }
 }
 
 void samp_grab_reset(samp_grab_t *g)
 {
+    GRAB_LOCK(g);
     g->sg_len = 0;
-    g->sg_index = 0;
+    GRAB_UNLOCK(g);
 }
 
-#define BLOCK_SIZE (128 * 1024) /* bytes */
-
-void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
+void samp_grab_write(samp_grab_t *g, unsigned grab_len, int grab_end)
 {
     if (!g->sg_buf)
         return;
 
-    unsigned end_pos, start_pos, signal_bsize, wlen, wrest;
     char f_name[64] = {0};
-    FILE *fp;
 
     char *format = *g->sample_size == 2 ? "cu8" : "cs16";
     double freq_mhz = *g->frequency / 1000000.0;
@@ -108,50 +306,61 @@ void samp_grab_write(samp_grab_t *g, unsigned grab_len, unsigned grab_end)
         }
     }
 
-    signal_bsize = *g->sample_size * grab_len;
-    signal_bsize += BLOCK_SIZE - (signal_bsize % BLOCK_SIZE);
+    GRAB_LOCK(g);
 
-    if (signal_bsize > g->sg_len) {
-        fprintf(stderr, "Signal bigger than buffer, signal = %u > buffer %u !!\n", signal_bsize, g->sg_len);
-        signal_bsize = g->sg_len;
+    if (g->job_count == SAMP_GRAB_JOBS) {
+        GRAB_UNLOCK(g);
+        fprintf(stderr, "Too many signals pending, not saving %s !!\n", f_name);
+        return;
     }
 
-    // relative end in bytes from current sg_index down
-    end_pos = *g->sample_size * grab_end;
-    if (g->sg_index >= end_pos)
-        end_pos = g->sg_index - end_pos;
-    else
-        end_pos = g->sg_size - end_pos + g->sg_index;
-    // end_pos is now absolute in sg_buf
-
-    if (end_pos >= signal_bsize)
-        start_pos = end_pos - signal_bsize;
-    else
-        start_pos = g->sg_size - signal_bsize + end_pos;
-
-    //fprintf(stderr, "signal_bsize = %d  -      sg_index = %d\n", signal_bsize, g->sg_index);
-    //fprintf(stderr, "start_pos    = %d  -   buffer_size = %d\n", start_pos, g->sg_size);
-
-    fprintf(stderr, "*** Saving signal to file %s (%u samples, %u bytes)\n", f_name, grab_len, signal_bsize);
-    fp = fopen(f_name, "wb");
-    if (!fp) {
-        fprintf(stderr, "Failed to open %s\n", f_name);
+    // absolute positions in bytes, the end might still be to come
+    int64_t end   = (int64_t)g->sg_pushed - (int64_t)grab_end * *g->sample_size;
+    int64_t begin = end - (int64_t)grab_len * *g->sample_size;
+    // the grab needs to be in the history and fit the ring as a whole
+    int64_t limit = (int64_t)g->sg_pushed - g->sg_len;
+    if (limit < end - g->sg_size)
+        limit = end - g->sg_size;
+    if (end <= limit) {
+        GRAB_UNLOCK(g);
+        fprintf(stderr, "Signal is not in the buffer anymore, not saving %s !!\n", f_name);
         return;
     }
-
-    wlen = signal_bsize;
-    wrest = 0;
-    if (start_pos + signal_bsize > g->sg_size) {
-        wlen  = g->sg_size - start_pos;
-        wrest = signal_bsize - wlen;
+    if (begin < limit) {
+        fprintf(stderr, "Signal bigger than buffer, signal = %u > buffer %u !!\n",
+                (unsigned)(end - begin), (unsigned)(end - limit));
+        begin = limit;
     }
-    //fprintf(stderr, "*** Writing data from %d, len %d\n", start_pos, wlen);
-    fwrite(&g->sg_buf[start_pos], 1, wlen, fp);
 
-    if (wrest) {
-        //fprintf(stderr, "*** Writing data from %d, len %d\n", 0, wrest);
-        fwrite(&g->sg_buf[0], 1, wrest, fp);
+    grab_job_t *job = &g->jobs[(g->job_head + g->job_count) % SAMP_GRAB_JOBS];
+    snprintf(job->name, sizeof(job->name), "%s", f_name);
+    job->pos  = (uint64_t)begin;
+    job->end  = (uint64_t)end;
+    job->file = NULL;
+    g->job_count += 1;
+#ifdef THREADS
+    pthread_cond_broadcast(&g->cond);
+#else
+    while (grab_step(g)) {
     }
+#endif
+    GRAB_UNLOCK(g);
+
+    fprintf(stderr, "*** Saving signal to file %s (%u samples, %u bytes)\n", f_name, grab_len, (unsigned)(end - begin));
+}
 
-    fclose(fp);
+// padding in samples, an eighth of a buffer by default
+static unsigned grab_pad(samp_grab_t *g, int pad_ms, unsigned n_samples)
+{
+    if (pad_ms < 0)
+        return n_samples / 8;
+    return (unsigned)((uint64_t)*g->samp_rate * pad_ms / 1000);
+}
+
+void samp_grab_write_frame(samp_grab_t *g, unsigned frame_start_ago, unsigned frame_end_ago, unsigned n_samples)
+{
+    unsigned pre_pad  = grab_pad(g, g->pre_pad_ms, n_samples);
+    unsigned post_pad = grab_pad(g, g->post_pad_ms, n_samples);
+    unsigned len      = frame_start_ago - frame_end_ago + pre_pad + post_pad;
+    samp_grab_write(g, len, (int)frame_end_ago - (int)post_pad);
 }
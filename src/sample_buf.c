@@ -0,0 +1,131 @@
+/** @file
+    Large sample buffers, backed by huge pages where available.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "sample_buf.h"
+
+#include "compat_atomic.h"
+#include "logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/// Size of a huge page, the common size on x86-64 and ARM64 with 4 kB pages.
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/// Kept before each buffer, the buffer is the next aligned address after the header.
+typedef struct sample_buf_header {
+    void *base;  ///< start of the allocation
+    size_t size; ///< bytes of the allocation
+    sample_buf_backing_t backing;
+} sample_buf_header_t;
+
+/// Bytes of the buffers in use for each backing.
+static unsigned backing_bytes[SAMPLE_BUF_BACKINGS];
+
+static size_t round_up(size_t size, size_t align)
+{
+    return (size + align - 1) & ~(align - 1);
+}
+
+// put the header and the aligned buffer into an allocation
+static void *place_buf(void *base, size_t size, sample_buf_backing_t backing)
+{
+    uintptr_t pos = (uintptr_t)base + sizeof(sample_buf_header_t);
+    char *buf     = (char *)base + (round_up(pos, SAMPLE_BUF_ALIGN) - (uintptr_t)base);
+
+    sample_buf_header_t *header = (sample_buf_header_t *)buf - 1;
+    header->base    = base;
+    header->size    = size;
+    header->backing = backing;
+    atomic_fetch_add_unsigned(&backing_bytes[backing], (unsigned)size);
+
+    if (size >= HUGE_PAGE_SIZE) {
+        print_logf(LOG_DEBUG, "Sample buffer", "Allocated %zu kB backed by %s", size / 1024, sample_buf_backing_name(backing));
+    }
+    return buf;
+}
+
+void *sample_buf_create(size_t size)
+{
+    // room for the header and the alignment
+    size_t full_size = size + sizeof(sample_buf_header_t) + SAMPLE_BUF_ALIGN;
+
+#ifdef __linux__
+    if (size >= HUGE_PAGE_SIZE) {
+#ifdef MAP_HUGETLB
+        // fails fast unless huge pages are reserved, e.g. with vm.nr_hugepages
+        size_t huge_size = round_up(full_size, HUGE_PAGE_SIZE);
+        void *map = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map != MAP_FAILED) {
+            return place_buf(map, huge_size, SAMPLE_BUF_HUGETLB);
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        // huge page aligned, a tail shorter than a huge page stays on small pages
+        void *base = NULL;
+        if (!posix_memalign(&base, HUGE_PAGE_SIZE, full_size)) {
+            // the kernel may ignore the advice, e.g. with transparent huge pages disabled
+            int advised = !madvise(base, full_size, MADV_HUGEPAGE);
+            return place_buf(base, full_size, advised ? SAMPLE_BUF_THP : SAMPLE_BUF_HEAP);
+        }
+#endif
+    }
+#endif
+
+    void *base = malloc(full_size);
+    if (!base) {
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    return place_buf(base, full_size, SAMPLE_BUF_HEAP);
+}
+
+void sample_buf_free(void *buf)
+{
+    if (!buf) {
+        return;
+    }
+    sample_buf_header_t *header = (sample_buf_header_t *)buf - 1;
+    atomic_fetch_sub_unsigned(&backing_bytes[header->backing], (unsigned)header->size);
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (header->backing == SAMPLE_BUF_HUGETLB) {
+        munmap(header->base, header->size);
+        return;
+    }
+#endif
+    free(header->base);
+}
+
+sample_buf_backing_t sample_buf_backing(void const *buf)
+{
+    sample_buf_header_t const *header = (sample_buf_header_t const *)buf - 1;
+    return header->backing;
+}
+
+char const *sample_buf_backing_name(sample_buf_backing_t backing)
+{
+    switch (backing) {
+    case SAMPLE_BUF_THP:
+        return "thp";
+    case SAMPLE_BUF_HUGETLB:
+        return "hugetlb";
+    default:
+        return "heap";
+    }
+}
+
+size_t sample_buf_bytes(sample_buf_backing_t backing)
+{
+    return atomic_load_acquire(&backing_bytes[backing]);
+}
@@ -23,6 +23,11 @@
 #include "logger.h"
 #include "fatal.h"
 #include "compat_pthread.h"
+#include "compat_atomic.h"
+#include "sample_buf.h"
+#include "thread_sched.h"
+#include "rtltcp_codec.h"
+#include "sdr_synth.h"
 #ifdef RTLSDR
 #include <rtl-sdr.h>
 #if defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
@@ -56,6 +61,7 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on);
     #include <winsock2.h>
     #include <ws2tcpip.h>
     #define SHUT_RDWR SD_BOTH
+    #define usleep(us) Sleep((us) / 1000)
     #define perror(str)  ws2_perror(str)
 
     static void ws2_perror (const char *str)
@@ -69,6 +75,8 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on);
     #include <sys/socket.h>
     #include <netdb.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/time.h>
 
     #define SOCKET          int
     #define INVALID_SOCKET  (-1)
@@ -76,36 +84,95 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on);
 #endif
 
 #define GAIN_STR_MAX_SIZE 64
+/// The rtl_tcp commands below this are sent again on a reconnect.
+#define RTLTCP_REPLAY_COMMANDS 16
+
+/// Longest wait of sdr_stop() for the consumer to return a leased transfer buffer.
+#define LEASE_STOP_TIMEOUT_MS 3000
+
+/// The state of a ring slot while leasing transfer buffers.
+typedef enum {
+    LEASE_NONE,    ///< the data is in the ring slot
+    LEASE_HELD,    ///< the data is in the transfer buffer, queued for the consumer
+    LEASE_IN_USE,  ///< the data is in the transfer buffer, used by the consumer
+    LEASE_COPIED,  ///< the data was copied from the transfer buffer to the ring slot before it was refilled
+    LEASE_OVERRUN, ///< the transfer buffer was refilled while used by the consumer
+} lease_state_t;
+
+/// A transfer buffer handed to the consumer in place of a ring slot.
+typedef struct sdr_lease {
+    lease_state_t state;
+    uint8_t *buf;  ///< the transfer buffer
+    uint32_t len;
+    unsigned call; ///< the transfer count when leased
+} sdr_lease_t;
 
 struct sdr_dev {
     SOCKET rtl_tcp;
     uint32_t rtl_tcp_freq; ///< last known center frequency, rtl_tcp only.
     uint32_t rtl_tcp_rate; ///< last known sample rate, rtl_tcp only.
+    rtltcp_codec_t *rtl_tcp_codec; ///< decoder of the compressed transport, rtl_tcp only.
+    uint8_t *rtl_tcp_block; ///< payload of the last compressed block, rtl_tcp only.
+    uint32_t rtl_tcp_block_size;
+    uint8_t *rtl_tcp_pending; ///< samples received but not yet read, rtl_tcp only.
+    uint32_t rtl_tcp_pending_size;
+    uint32_t rtl_tcp_pending_pos;
+    uint32_t rtl_tcp_pending_len;
+    char *rtl_tcp_host; ///< host to reconnect to, rtl_tcp only.
+    char *rtl_tcp_port;
+    unsigned rtl_tcp_compress; ///< compressed transport requested, rtl_tcp only.
+    int rtl_tcp_rcvbuf; ///< socket receive buffer requested, 0 for the system default, rtl_tcp only.
+    unsigned rtl_tcp_reconnect; ///< seconds to try to reconnect in place, 0 to end the input when the connection is lost.
+    int rtl_tcp_reconnecting; ///< the socket is invalid until reconnected
+    unsigned rtl_tcp_reconnects;
+    uint64_t rtl_tcp_lost; ///< samples lost while reconnecting
+    uint64_t rtl_tcp_lost_reported; ///< lost samples already passed with an event
+    int64_t rtl_tcp_last_ns; ///< wall time of the last samples received
+    int rtl_tcp_params[RTLTCP_REPLAY_COMMANDS]; ///< last parameter of each command sent, replayed on a reconnect
+    unsigned rtl_tcp_params_sent; ///< bit mask of the commands sent
+
+    sdr_synth_t *synth; ///< the signal generator, synthetic input only.
+    uint32_t synth_rate; ///< samples generated a second, 0 for the sample rate, SYNTH_RATE_MAX for no pacing, synthetic input only.
 
 #ifdef SOAPYSDR
     SoapySDRDevice *soapy_dev;
     SoapySDRStream *soapy_stream;
     double fullScale;
+    int64_t soapy_time_offset; ///< offset from hardware time to wall clock in ns
+    int soapy_time_valid; ///< the hardware time offset is known
+    unsigned soapy_overflows; ///< stream overflows and abrupt stream ends
+    unsigned soapy_overflows_reported; ///< overflow count already passed with an event
+    size_t soapy_channel; ///< the RX channel of the device
+    struct soapy_group *soapy_group; ///< the stream shared with the other channels of the device, NULL if reading alone
 #endif
 
 #ifdef RTLSDR
     rtlsdr_dev_t *rtlsdr_dev;
     sdr_event_cb_t rtlsdr_cb;
     void *rtlsdr_cb_ctx;
+    int rtlsdr_zero_copy; ///< lease the USB transfer buffers instead of copying to the ring
 #endif
 
     char *dev_info;
 
     int running;
-    uint8_t *buffer; ///< sdr data buffer current and past frames
-    size_t buffer_size; ///< sdr data buffer overall size (num * len)
-    size_t buffer_pos; ///< sdr data buffer next write position
+    uint8_t *buffer; ///< sdr data buffer ring slots and one spare slot to read dropped frames
+    size_t buffer_size; ///< sdr data buffer overall size ((num + 1) * len)
+    uint32_t slot_num; ///< number of ring slots
+    uint32_t slot_len; ///< size in bytes of each ring slot
+    unsigned slot_head; ///< count of slots filled, written by the acquire thread only
+    unsigned slot_tail; ///< count of slots released, written by the consumer only
+    unsigned dropped; ///< frames dropped because no slot was free
+    unsigned dropped_reported; ///< dropped count already passed with an event
+    sdr_lease_t *slot_leases; ///< per slot lease of a transfer buffer, NULL if not leasing, guarded by the lock
+    unsigned lease_calls; ///< count of transfers received while leasing, the age of a lease
 
     int sample_size;
     int sample_signed;
 
     uint32_t sample_rate;
     uint32_t center_frequency;
+    int64_t settled_ns; ///< wall time the tuner settles on the center frequency, in ns since the epoch
 
 #ifdef THREADS
     pthread_t thread;
@@ -120,6 +187,112 @@ struct sdr_dev {
 #endif
 };
 
+/* buffer ring helpers */
+
+/// Allocate the ring slots if the geometry changed and reset the ring, returns -1 on alloc failure.
+static int ring_init(sdr_dev_t *dev, uint32_t buf_num, uint32_t buf_len)
+{
+    size_t buffer_size = (size_t)(buf_num + 1) * buf_len;
+    if (dev->buffer_size != buffer_size) {
+        sample_buf_free(dev->buffer);
+        dev->buffer = sample_buf_create(buffer_size);
+        if (!dev->buffer) {
+            WARN_MALLOC("ring_init()");
+            dev->buffer_size = 0;
+            return -1;
+        }
+        dev->buffer_size = buffer_size;
+    }
+    dev->slot_num  = buf_num;
+    dev->slot_len  = buf_len;
+    dev->slot_head = 0;
+    atomic_store_release(&dev->slot_tail, 0);
+    return 0;
+}
+
+/// Get the next free slot to fill, NULL if the consumer holds all slots.
+static uint8_t *ring_next_slot(sdr_dev_t *dev)
+{
+    unsigned tail = atomic_load_acquire(&dev->slot_tail);
+    if (dev->slot_head - tail >= dev->slot_num) {
+        return NULL;
+    }
+    return &dev->buffer[(size_t)(dev->slot_head % dev->slot_num) * dev->slot_len];
+}
+
+/// Get the spare slot to read a frame that will be dropped.
+static uint8_t *ring_spare_slot(sdr_dev_t *dev)
+{
+    return &dev->buffer[(size_t)dev->slot_num * dev->slot_len];
+}
+
+static void lease_lock(sdr_dev_t *dev)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#else
+    UNUSED(dev);
+#endif
+}
+
+static void lease_unlock(sdr_dev_t *dev)
+{
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#else
+    UNUSED(dev);
+#endif
+}
+
+/** Copy the leases of at least @p max_age transfers from the transfer buffers to their ring slots, the lock must be held.
+
+    A transfer buffer is refilled after all other transfers, i.e. at an age of slot_num - 1.
+    A lease still queued is copied well before that, a lease in use at that age is counted as dropped.
+*/
+static void lease_expire(sdr_dev_t *dev, unsigned max_age)
+{
+    for (unsigned i = 0; i < dev->slot_num; ++i) {
+        sdr_lease_t *lease = &dev->slot_leases[i];
+        unsigned age       = dev->lease_calls - lease->call;
+        if (lease->state == LEASE_HELD && age >= max_age) {
+            memcpy(&dev->buffer[(size_t)i * dev->slot_len], lease->buf, lease->len);
+            lease->state = LEASE_COPIED;
+        }
+        else if (lease->state == LEASE_IN_USE && age >= dev->slot_num - 1) {
+            lease->state = LEASE_OVERRUN;
+            dev->dropped += 1;
+        }
+    }
+}
+
+/// Hand the filled slot to the consumer and prepare the data event.
+static void ring_publish(sdr_dev_t *dev, sdr_event_t *ev)
+{
+    atomic_store_release(&dev->slot_head, dev->slot_head + 1);
+    struct timeval now;
+    get_time_now(&now);
+    ev->publish_ns = (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_usec * 1000;
+    ev->dropped = dev->dropped - dev->dropped_reported;
+    dev->dropped_reported = dev->dropped;
+
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    int64_t settled_ns = dev->settled_ns;
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    // stamp the samples before the tuner settled, without a hardware time the buffer ends when published
+    unsigned n_samples = dev->sample_size > 0 ? (unsigned)ev->len / dev->sample_size : 0;
+    if (settled_ns > 0 && ev->sample_rate > 0 && n_samples > 0) {
+        int64_t first_ns = ev->time_ns ? ev->time_ns : ev->publish_ns - (int64_t)n_samples * 1000000000 / ev->sample_rate;
+        if (settled_ns > first_ns) {
+            int64_t settle = (settled_ns - first_ns) * ev->sample_rate / 1000000000;
+            ev->settle     = settle < n_samples ? (unsigned)settle : n_samples;
+        }
+    }
+}
+
 /* rtl_tcp helpers */
 
 #pragma pack(push, 1)
@@ -130,31 +303,152 @@ struct rtl_tcp_info {
 };
 #pragma pack(pop)
 
-static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
+static int rtltcp_close(SOCKET sock);
+static int rtltcp_command(sdr_dev_t *dev, char cmd, int param);
+static int rtltcp_reconnect(sdr_dev_t *dev);
+
+/// Receive exactly len bytes, returns the bytes read, less on errors or the end of the stream.
+static int rtltcp_recv_all(SOCKET sock, uint8_t *buf, unsigned len)
 {
-    UNUSED(verbose);
-    char const *host = "localhost";
-    char const *port = "1234";
-    char hostport[280]; // 253 chars DNS name plus extra chars
+    unsigned n_read = 0;
+    while (n_read < len) {
+        int r = recv(sock, (char *)&buf[n_read], len - n_read, MSG_WAITALL);
+        if (r <= 0)
+            return n_read ? (int)n_read : r;
+        n_read += r;
+    }
+    return n_read;
+}
 
-    char *param = arg_param(dev_query); // strip scheme
-    hostport[0] = '\0';
-    if (param) {
-        snprintf(hostport, sizeof(hostport), "%s", param);
+/// Grow a buffer to at least size bytes, returns -1 on alloc failure.
+static int rtltcp_reserve(uint8_t **buf, uint32_t *buf_size, uint32_t size)
+{
+    if (*buf_size >= size)
+        return 0;
+    uint8_t *grown = realloc(*buf, size);
+    if (!grown) {
+        WARN_REALLOC("rtltcp_reserve()");
+        return -1; // NOTE: returns error on alloc failure.
     }
-    hostport_param(hostport, &host, &port);
-
-    print_logf(LOG_CRITICAL, "SDR", "rtl_tcp input from %s port %s", host, port);
+    *buf      = grown;
+    *buf_size = size;
+    return 0;
+}
 
-#ifdef _WIN32
-    WSADATA wsa;
+/// Request the compressed transport, a stock server streams raw samples right away and these are kept.
+static int rtltcp_negotiate(sdr_dev_t *dev, unsigned requested)
+{
+    if (rtltcp_command(dev, RTLTCP_SET_COMPRESSION, (int)requested) < 0) {
+        perror("rtl_tcp");
+        return -1;
+    }
+    uint8_t ack[RTLTCP_CODEC_HEADER];
+    if (rtltcp_recv_all(dev->rtl_tcp, ack, sizeof(ack)) != sizeof(ack)) {
+        print_log(LOG_ERROR, __func__, "rtl_tcp connection closed");
+        return -1;
+    }
+    int method = rtltcp_codec_parse_ack(ack, requested);
+    if (method < 0) {
+        print_log(LOG_NOTICE, "SDR", "rtl_tcp server has no compressed transport, receiving raw samples");
+        if (rtltcp_reserve(&dev->rtl_tcp_pending, &dev->rtl_tcp_pending_size, sizeof(ack)) < 0)
+            return -1;
+        memcpy(dev->rtl_tcp_pending, ack, sizeof(ack));
+        dev->rtl_tcp_pending_len = sizeof(ack);
+        return 0;
+    }
+    if (method == 0) {
+        print_log(LOG_NOTICE, "SDR", "rtl_tcp server declined the compressed transport, receiving raw samples");
+        return 0;
+    }
+    dev->rtl_tcp_codec = rtltcp_codec_create((unsigned)method);
+    if (!dev->rtl_tcp_codec)
+        return -1;
+    print_logf(LOG_NOTICE, "SDR", "rtl_tcp compressed transport with %s", rtltcp_codec_name((unsigned)method));
+    return 0;
+}
 
-    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
-        perror("WSAStartup()");
+/// Receive and decode a block of the compressed transport to the pending samples, returns 1 or the recv() result.
+static int rtltcp_read_block(sdr_dev_t *dev)
+{
+    uint8_t header[RTLTCP_CODEC_HEADER];
+    int r = rtltcp_recv_all(dev->rtl_tcp, header, sizeof(header));
+    if (r != sizeof(header))
+        return r > 0 ? 0 : r;
+    uint32_t raw_len;
+    uint32_t payload_len;
+    if (rtltcp_codec_header(header, &raw_len, &payload_len) < 0) {
+        print_log(LOG_ERROR, __func__, "Bad rtl_tcp compressed block");
+        return -1;
+    }
+    if (rtltcp_reserve(&dev->rtl_tcp_block, &dev->rtl_tcp_block_size, payload_len) < 0
+            || rtltcp_reserve(&dev->rtl_tcp_pending, &dev->rtl_tcp_pending_size, raw_len) < 0)
+        return -1;
+    r = rtltcp_recv_all(dev->rtl_tcp, dev->rtl_tcp_block, payload_len);
+    if (r != (int)payload_len)
+        return r > 0 ? 0 : r;
+    if (rtltcp_codec_decode(dev->rtl_tcp_codec, header, dev->rtl_tcp_block, dev->rtl_tcp_pending) < 0) {
+        print_log(LOG_ERROR, __func__, "Bad rtl_tcp compressed block");
         return -1;
     }
+    dev->rtl_tcp_pending_pos = 0;
+    dev->rtl_tcp_pending_len = raw_len;
+    return 1;
+}
+
+/// Read up to len bytes of samples, returns the bytes read or the last recv() result if none.
+static int rtltcp_recv(sdr_dev_t *dev, uint8_t *buf, unsigned len)
+{
+    unsigned n_read = 0;
+    int r = 1;
+    while (n_read < len) {
+        if (dev->rtl_tcp_pending_pos < dev->rtl_tcp_pending_len) {
+            unsigned n = dev->rtl_tcp_pending_len - dev->rtl_tcp_pending_pos;
+            n = n < len - n_read ? n : len - n_read;
+            memcpy(&buf[n_read], &dev->rtl_tcp_pending[dev->rtl_tcp_pending_pos], n);
+            dev->rtl_tcp_pending_pos += n;
+            n_read += n;
+        }
+        else if (dev->rtl_tcp_codec) {
+            r = rtltcp_read_block(dev);
+            if (r <= 0)
+                break;
+        }
+        else {
+            r = recv(dev->rtl_tcp, (char *)&buf[n_read], len - n_read, MSG_WAITALL);
+            if (r <= 0)
+                break;
+            n_read += r;
+        }
+    }
+    return n_read ? (int)n_read : r;
+}
+
+/// Set a socket timeout option, the time is in ms.
+static int rtltcp_set_timeout(SOCKET sock, int optname, unsigned timeout_ms)
+{
+#ifdef _WIN32
+    DWORD timeout = timeout_ms;
+#else
+    struct timeval timeout = {.tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000};
 #endif
+    return setsockopt(sock, SOL_SOCKET, optname, (char const *)&timeout, sizeof(timeout));
+}
 
+/** Connect to a rtl_tcp server and read the header.
+
+    The receive buffer is set before connecting, the TCP window scale is chosen on connect.
+    With a timeout a connect and a stalled stream fail after that time instead of blocking.
+
+    @param host the server host
+    @param port the server port
+    @param rcvbuf the socket receive buffer size, 0 for the system default
+    @param timeout_ms the connect and receive timeout, 0 to block
+    @param quiet do not log connection errors, e.g. while reconnecting
+    @param[out] tuner_number the tuner type of the server
+    @return the socket, INVALID_SOCKET on failure
+*/
+static SOCKET rtltcp_connect(char const *host, char const *port, int rcvbuf, unsigned timeout_ms, int quiet, unsigned *tuner_number)
+{
     struct addrinfo hints, *res, *res0;
     int ret;
     SOCKET sock;
@@ -167,16 +461,24 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
 
     ret = getaddrinfo(host, port, &hints, &res0);
     if (ret) {
-        print_log(LOG_ERROR, __func__, gai_strerror(ret));
-        return -1;
+        if (!quiet)
+            print_log(LOG_ERROR, __func__, gai_strerror(ret));
+        return INVALID_SOCKET;
     }
     sock = INVALID_SOCKET;
     for (res = res0; res; res = res->ai_next) {
         sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
         if (sock >= 0) {
+            if (rcvbuf > 0 && setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char const *)&rcvbuf, sizeof(rcvbuf)) < 0 && !quiet)
+                perror("rtl_tcp SO_RCVBUF");
+            // the send timeout also limits the connect
+            if (timeout_ms && (rtltcp_set_timeout(sock, SO_SNDTIMEO, timeout_ms) < 0
+                    || rtltcp_set_timeout(sock, SO_RCVTIMEO, timeout_ms) < 0) && !quiet)
+                perror("rtl_tcp timeout");
             ret = connect(sock, res->ai_addr, res->ai_addrlen);
             if (ret == -1) {
-                perror("connect");
+                if (!quiet)
+                    perror("connect");
                 closesocket(sock);
                 sock = INVALID_SOCKET;
             }
@@ -186,8 +488,9 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     }
     freeaddrinfo(res0);
     if (sock == INVALID_SOCKET) {
-        perror("socket");
-        return -1;
+        if (!quiet)
+            perror("socket");
+        return INVALID_SOCKET;
     }
 
     //int const value_one = 1;
@@ -196,28 +499,109 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     //    fprintf(stderr, "rtl_tcp TCP_NODELAY failed\n");
 
     struct rtl_tcp_info info;
-    ret = recv(sock, (char *)&info, sizeof (info), 0);
-    if (ret != 12) {
-        print_logf(LOG_ERROR, __func__, "Bad rtl_tcp header (%d)", ret);
-        return -1;
+    ret = rtltcp_recv_all(sock, (uint8_t *)&info, sizeof(info));
+    if (ret != sizeof(info)) {
+        if (!quiet)
+            print_logf(LOG_ERROR, __func__, "Bad rtl_tcp header (%d)", ret);
+        closesocket(sock);
+        return INVALID_SOCKET;
     }
     if (strncmp(info.magic, "RTL0", 4)) {
         info.tuner_number = 0; // terminate magic
-        print_logf(LOG_ERROR, __func__, "Bad rtl_tcp header magic \"%s\"", info.magic);
-        return -1;
+        if (!quiet)
+            print_logf(LOG_ERROR, __func__, "Bad rtl_tcp header magic \"%s\"", info.magic);
+        closesocket(sock);
+        return INVALID_SOCKET;
     }
 
-    unsigned tuner_number = ntohl(info.tuner_number);
+    *tuner_number = ntohl(info.tuner_number);
     //int tuner_gain_count  = ntohl(info.tuner_gain_count);
+    return sock;
+}
+
+/// Timeout to detect a stalled stream and to connect when reconnecting in place, below the watchdog interval.
+#define RTLTCP_STALL_TIMEOUT_MS 1000
+
+static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
+{
+    UNUSED(verbose);
+    char const *host = "localhost";
+    char const *port = "1234";
+    char hostport[280]; // 253 chars DNS name plus extra chars
+
+    char *param = arg_param(dev_query); // strip scheme
+    hostport[0] = '\0';
+    if (param) {
+        snprintf(hostport, sizeof(hostport), "%s", param);
+    }
+    char *extra = hostport_param(hostport, &host, &port);
+
+    unsigned compress  = 0;
+    int rcvbuf         = 0;
+    unsigned reconnect = 0;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "compress")) {
+            compress = rtltcp_codec_parse(val);
+            if (!compress) {
+                print_logf(LOG_ERROR, __func__, "Invalid compress=%s option.", val);
+                return -1;
+            }
+        }
+        else if (!strcasecmp(key, "rcvbuf")) {
+            rcvbuf = val ? (int)atouint32_metric(val, "rcvbuf= ") : 0;
+            if (rcvbuf <= 0) {
+                print_logf(LOG_ERROR, __func__, "Invalid rcvbuf=%s option.", val ? val : "");
+                return -1;
+            }
+        }
+        else if (!strcasecmp(key, "reconnect")) {
+            reconnect = val && *val ? (unsigned)atoiv(val, 0) : 30;
+        }
+        else {
+            print_logf(LOG_ERROR, __func__, "Invalid \"%s\" option.", key);
+            return -1;
+        }
+    }
+
+    print_logf(LOG_CRITICAL, "SDR", "rtl_tcp input from %s port %s", host, port);
+
+#ifdef _WIN32
+    WSADATA wsa;
+
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        perror("WSAStartup()");
+        return -1;
+    }
+#endif
+
+    unsigned tuner_number = 0;
+    SOCKET sock = rtltcp_connect(host, port, rcvbuf, reconnect ? RTLTCP_STALL_TIMEOUT_MS : 0, 0, &tuner_number);
+    if (sock == INVALID_SOCKET) {
+        return -1;
+    }
 
     char const *tuner_names[] = { "Unknown", "E4000", "FC0012", "FC0013", "FC2580", "R820T", "R828D" };
     char const *tuner_name = tuner_number > sizeof (tuner_names) ? "Invalid" : tuner_names[tuner_number];
 
     print_logf(LOG_CRITICAL, "SDR", "rtl_tcp connected to %s:%s (Tuner: %s)", host, port, tuner_name);
 
+    if (rcvbuf) {
+        // Linux doubles the requested size for its bookkeeping and caps it at net.core.rmem_max
+        int effective   = 0;
+        socklen_t len   = sizeof(effective);
+        getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&effective, &len);
+        print_logf(LOG_NOTICE, "SDR", "rtl_tcp receive buffer of %d bytes (requested %d)", effective, rcvbuf);
+    }
+
     sdr_dev_t *dev = calloc(1, sizeof(sdr_dev_t));
     if (!dev) {
         WARN_CALLOC("rtltcp_open()");
+        rtltcp_close(sock);
         return -1; // NOTE: returns error on alloc failure.
     }
 #ifdef THREADS
@@ -227,6 +611,32 @@ static int rtltcp_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     dev->rtl_tcp = sock;
     dev->sample_size = sizeof(uint8_t) * 2; // CU8
     dev->sample_signed = 0;
+    dev->rtl_tcp_compress  = compress;
+    dev->rtl_tcp_rcvbuf    = rcvbuf;
+    dev->rtl_tcp_reconnect = reconnect;
+
+    if (reconnect) {
+        dev->rtl_tcp_host = strdup(host);
+        if (!dev->rtl_tcp_host)
+            WARN_STRDUP("rtltcp_open()");
+        dev->rtl_tcp_port = strdup(port);
+        if (!dev->rtl_tcp_port)
+            WARN_STRDUP("rtltcp_open()");
+        if (!dev->rtl_tcp_host || !dev->rtl_tcp_port)
+            dev->rtl_tcp_reconnect = 0; // the input ends when the connection is lost
+    }
+
+    if (compress && rtltcp_negotiate(dev, compress) < 0) {
+        rtltcp_close(sock);
+#ifdef THREADS
+        pthread_mutex_destroy(&dev->lock);
+#endif
+        free(dev->rtl_tcp_host);
+        free(dev->rtl_tcp_port);
+        free(dev->rtl_tcp_pending);
+        free(dev);
+        return -1;
+    }
 
     *out_dev = dev;
     return 0;
@@ -251,45 +661,327 @@ static int rtltcp_close(SOCKET sock)
 
 static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
 {
-    size_t buffer_size = (size_t)buf_num * buf_len;
-    if (dev->buffer_size != buffer_size) {
-        free(dev->buffer);
-        dev->buffer = malloc(buffer_size);
-        if (!dev->buffer) {
-            WARN_MALLOC("rtltcp_read_loop()");
-            return -1; // NOTE: returns error on alloc failure.
-        }
-        dev->buffer_size = buffer_size;
-        dev->buffer_pos = 0;
+    if (ring_init(dev, buf_num, buf_len) < 0) {
+        return -1; // NOTE: returns error on alloc failure.
     }
 
     dev->running = 1;
     do {
-        if (dev->buffer_pos + buf_len > buffer_size)
-            dev->buffer_pos = 0;
-        uint8_t *buffer = &dev->buffer[dev->buffer_pos];
-        dev->buffer_pos += buf_len;
-
-        unsigned n_read = 0;
-        int r;
-
-        do {
-            r = recv(dev->rtl_tcp, &buffer[n_read], buf_len - n_read, MSG_WAITALL);
-            if (r <= 0)
-                break;
-            n_read += r;
-            //fprintf(stderr, "readStream ret=%d (of %u)\n", r, n_read);
-        } while (n_read < buf_len);
+        // we need to keep reading even if all slots are in use
+        uint8_t *buffer = ring_next_slot(dev);
+        int drop = !buffer;
+        if (drop)
+            buffer = ring_spare_slot(dev);
+
+        int r = rtltcp_recv(dev, buffer, buf_len);
+        unsigned n_read = r > 0 ? (unsigned)r : 0;
         //fprintf(stderr, "readStream ret=%d (read %u)\n", r, n_read);
 
         if (r < 0) {
             print_logf(LOG_WARNING, __func__, "sync read failed. %d", r);
         }
         if (n_read == 0) {
+            // the slot is read again, the demod and its detector state stay up
+            if (dev->rtl_tcp_reconnect && rtltcp_reconnect(dev) == 0)
+                continue;
             perror("rtl_tcp");
             dev->running = 0;
         }
+        dev->rtl_tcp_last_ns = get_time_now_ns();
+
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+#endif
+        uint32_t sample_rate      = dev->sample_rate;
+        uint32_t center_frequency = dev->center_frequency;
+#ifdef THREADS
+        pthread_mutex_unlock(&dev->lock);
+#endif
+        sdr_event_t ev = {
+                .ev               = SDR_EV_DATA,
+                .sample_rate      = sample_rate,
+                .center_frequency = center_frequency,
+                .buf              = buffer,
+                .len              = n_read,
+        };
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+        int exit_acquire = dev->exit_acquire;
+        pthread_mutex_unlock(&dev->lock);
+        if (exit_acquire) {
+            break; // do not deliver any more events
+        }
+#endif
+        if (n_read == 0) // prevent a crash in callback
+            continue;
+        if (drop) {
+            dev->dropped += 1;
+            continue;
+        }
+        ev.lost = dev->rtl_tcp_lost - dev->rtl_tcp_lost_reported;
+        dev->rtl_tcp_lost_reported = dev->rtl_tcp_lost;
+        ring_publish(dev, &ev);
+        cb(&ev, ctx);
+
+    } while (dev->running);
+
+    return 0;
+}
+
+#pragma pack(push, 1)
+struct command {
+    unsigned char cmd;
+    unsigned int param;
+};
+#pragma pack(pop)
+
+// rtl_tcp API
+#define RTLTCP_SET_FREQ 0x01
+#define RTLTCP_SET_SAMPLE_RATE 0x02
+#define RTLTCP_SET_GAIN_MODE 0x03
+#define RTLTCP_SET_GAIN 0x04
+#define RTLTCP_SET_FREQ_CORRECTION 0x05
+#define RTLTCP_SET_IF_TUNER_GAIN 0x06
+#define RTLTCP_SET_TEST_MODE 0x07
+#define RTLTCP_SET_AGC_MODE 0x08
+#define RTLTCP_SET_DIRECT_SAMPLING 0x09
+#define RTLTCP_SET_OFFSET_TUNING 0x0a
+#define RTLTCP_SET_RTL_XTAL 0x0b
+#define RTLTCP_SET_TUNER_XTAL 0x0c
+#define RTLTCP_SET_TUNER_GAIN_BY_ID 0x0d
+#define RTLTCP_SET_BIAS_TEE 0x0e
+
+static int rtltcp_send_command(SOCKET sock, char cmd, int param)
+{
+    struct command command;
+    command.cmd   = cmd;
+    command.param = htonl(param);
+
+    return sizeof(command) == send(sock, (const char*) &command, sizeof(command), 0) ? 0 : -1;
+}
+
+static int rtltcp_command(sdr_dev_t *dev, char cmd, int param)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    unsigned char c = (unsigned char)cmd;
+    if (c < RTLTCP_REPLAY_COMMANDS && c != RTLTCP_SET_COMPRESSION) {
+        dev->rtl_tcp_params[c] = param;
+        dev->rtl_tcp_params_sent |= 1u << c;
+    }
+    // while reconnecting the setting is recorded and sent on connect
+    int r = dev->rtl_tcp_reconnecting ? 0 : rtltcp_send_command(dev->rtl_tcp, cmd, param);
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    return r;
+}
+
+/** Connect again after the stream ended or stalled, with the same settings.
+
+    Retries with a backoff until the configured time is up or the acquisition is stopped.
+    The samples missed from the last data received until the stream resumes are counted
+    as lost, the next data event passes them on.
+
+    @return 0 on success, -1 to end the input
+*/
+static int rtltcp_reconnect(sdr_dev_t *dev)
+{
+    int64_t start_ns = get_time_now_ns();
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    SOCKET old_sock = dev->rtl_tcp;
+    dev->rtl_tcp              = INVALID_SOCKET;
+    dev->rtl_tcp_reconnecting = 1;
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    closesocket(old_sock);
+    print_logf(LOG_WARNING, "SDR", "rtl_tcp connection to %s:%s lost, reconnecting", dev->rtl_tcp_host, dev->rtl_tcp_port);
+
+    unsigned delay_ms = 100;
+    unsigned tuner_number;
+    SOCKET sock = INVALID_SOCKET;
+    while (sock == INVALID_SOCKET) {
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+        int exit_acquire = dev->exit_acquire;
+        pthread_mutex_unlock(&dev->lock);
+        if (exit_acquire)
+            goto fail;
+#endif
+        if (get_time_now_ns() - start_ns > (int64_t)dev->rtl_tcp_reconnect * 1000000000) {
+            print_logf(LOG_ERROR, "SDR", "rtl_tcp reconnect to %s:%s failed for %u s, giving up", dev->rtl_tcp_host, dev->rtl_tcp_port, dev->rtl_tcp_reconnect);
+            goto fail;
+        }
+        sock = rtltcp_connect(dev->rtl_tcp_host, dev->rtl_tcp_port, dev->rtl_tcp_rcvbuf, RTLTCP_STALL_TIMEOUT_MS, 1, &tuner_number);
+        if (sock == INVALID_SOCKET) {
+            usleep(delay_ms * 1000);
+            delay_ms = delay_ms < 1000 ? delay_ms * 2 : 2000;
+        }
+    }
+
+    // a new stream, nothing of the old transport is kept
+    rtltcp_codec_free(dev->rtl_tcp_codec);
+    dev->rtl_tcp_codec       = NULL;
+    dev->rtl_tcp_pending_pos = 0;
+    dev->rtl_tcp_pending_len = 0;
+
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    dev->rtl_tcp              = sock;
+    dev->rtl_tcp_reconnecting = 0;
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    if (dev->rtl_tcp_compress && rtltcp_negotiate(dev, dev->rtl_tcp_compress) < 0) {
+        return -1; // the input ends with the socket closed on sdr_close()
+    }
+
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    // the frequency last, the tuner settles with all other settings applied
+    int r = 0;
+    for (unsigned c = 0; c < RTLTCP_REPLAY_COMMANDS; ++c) {
+        if (c != RTLTCP_SET_FREQ && (dev->rtl_tcp_params_sent & (1u << c)))
+            r |= rtltcp_send_command(sock, (char)c, dev->rtl_tcp_params[c]);
+    }
+    if (dev->rtl_tcp_params_sent & (1u << RTLTCP_SET_FREQ))
+        r |= rtltcp_send_command(sock, RTLTCP_SET_FREQ, dev->rtl_tcp_params[RTLTCP_SET_FREQ]);
+    uint32_t sample_rate = dev->sample_rate;
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    if (r < 0) {
+        perror("rtl_tcp");
+        return -1;
+    }
+
+    int64_t now_ns  = get_time_now_ns();
+    int64_t last_ns = dev->rtl_tcp_last_ns ? dev->rtl_tcp_last_ns : start_ns;
+    dev->rtl_tcp_lost += (uint64_t)(now_ns - last_ns) * sample_rate / 1000000000;
+    dev->rtl_tcp_reconnects += 1;
+    print_logf(LOG_NOTICE, "SDR", "rtl_tcp reconnected to %s:%s after %.1f s", dev->rtl_tcp_host, dev->rtl_tcp_port, (now_ns - last_ns) / 1e9);
+    return 0;
+
+fail:
+    // the input ends, the watchdog must see it stalled
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    dev->rtl_tcp_reconnecting = 0;
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    return -1;
+}
+
+/* synthetic input */
+
+/// No pacing, the samples are generated as fast as possible.
+#define SYNTH_RATE_MAX UINT32_MAX
+
+static int synth_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
+{
+    UNUSED(verbose);
+    char args[256] = {0};
+    char *param = arg_param(dev_query); // strip scheme
+    if (param) {
+        snprintf(args, sizeof(args), "%s", param);
+    }
+
+    sdr_synth_opts_t opts = {0};
+    uint32_t rate = 0;
+    char mix[128] = {0};
+    char *extra = args;
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "rate")) {
+            rate = val && !strcasecmp(val, "max") ? SYNTH_RATE_MAX : val ? atouint32_metric(val, "rate= ") : 0;
+        }
+        else if (!strcasecmp(key, "sensors")) {
+            opts.sensors = val ? (unsigned)atoiv(val, 0) : 0;
+        }
+        else if (!strcasecmp(key, "mix")) {
+            snprintf(mix, sizeof(mix), "%s", val ? val : "");
+        }
+        else if (!strcasecmp(key, "every")) {
+            opts.every_ms = val ? (unsigned)(arg_float(val, "every= ") * 1000) : 0;
+        }
+        else if (!strcasecmp(key, "noise")) {
+            opts.noise_db = val ? (float)arg_float(val, "noise= ") : 0.0f;
+        }
+        else if (!strcasecmp(key, "level")) {
+            opts.level_db = val ? (float)arg_float(val, "level= ") : 0.0f;
+        }
+        else if (!strcasecmp(key, "seed")) {
+            opts.seed = val ? (uint32_t)atoiv(val, 1) : 1;
+        }
+        else if (*mix && !val) {
+            // the mix is a list, e.g. mix=acurite,tpms
+            size_t len = strlen(mix);
+            snprintf(mix + len, sizeof(mix) - len, ",%s", key);
+        }
+        else {
+            print_logf(LOG_ERROR, __func__, "Invalid \"%s\" option.", key);
+            return -1;
+        }
+    }
+    opts.mix = mix;
+
+    sdr_synth_t *synth = sdr_synth_create(&opts);
+    if (!synth) {
+        return -1;
+    }
+
+    sdr_dev_t *dev = calloc(1, sizeof(sdr_dev_t));
+    if (!dev) {
+        WARN_CALLOC("synth_open()");
+        sdr_synth_free(synth);
+        return -1; // NOTE: returns error on alloc failure.
+    }
+#ifdef THREADS
+    pthread_mutex_init(&dev->lock, NULL);
+#endif
+
+    dev->synth         = synth;
+    dev->synth_rate    = rate;
+    dev->sample_size   = sizeof(uint8_t) * 2; // CU8
+    dev->sample_signed = 0;
+    dev->dev_info      = strdup("{\"vendor\":\"rtl_433\", \"product\":\"Synthetic input\", \"serial\":\"synth\"}");
+    if (!dev->dev_info)
+        WARN_STRDUP("synth_open()");
+
+    if (rate == SYNTH_RATE_MAX)
+        print_logf(LOG_CRITICAL, "SDR", "Synthetic input of %s, as fast as possible", *mix ? mix : "all sensors");
+    else if (rate)
+        print_logf(LOG_CRITICAL, "SDR", "Synthetic input of %s, at %u samples a second", *mix ? mix : "all sensors", rate);
+    else
+        print_logf(LOG_CRITICAL, "SDR", "Synthetic input of %s, in real time", *mix ? mix : "all sensors");
 
+    *out_dev = dev;
+    return 0;
+}
+
+static int synth_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+{
+    if (ring_init(dev, buf_num, buf_len) < 0) {
+        return -1; // NOTE: returns error on alloc failure.
+    }
+
+    // the samples are paced by the wall clock, falling behind by more than a second starts over
+    int64_t start_ns   = get_time_now_ns();
+    uint64_t generated = 0;
+    dev->running = 1;
+    do {
 #ifdef THREADS
         pthread_mutex_lock(&dev->lock);
 #endif
@@ -298,12 +990,34 @@ static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
 #ifdef THREADS
         pthread_mutex_unlock(&dev->lock);
 #endif
+        uint32_t rate = dev->synth_rate ? dev->synth_rate : sample_rate;
+        if (rate && rate != SYNTH_RATE_MAX) {
+            int64_t due_ns = start_ns + (int64_t)(generated * 1e9 / rate);
+            int64_t now_ns = get_time_now_ns();
+            if (due_ns > now_ns) {
+                usleep((unsigned)((due_ns - now_ns) / 1000));
+            }
+            else if (now_ns - due_ns > 1000000000) {
+                start_ns  = now_ns;
+                generated = 0;
+            }
+        }
+
+        // like a device the samples go on while all slots are in use
+        uint8_t *buffer = ring_next_slot(dev);
+        int drop = !buffer;
+        if (drop)
+            buffer = ring_spare_slot(dev);
+        unsigned n_samples = buf_len / 2;
+        sdr_synth_fill(dev->synth, buffer, n_samples, sample_rate ? sample_rate : 250000);
+        generated += n_samples;
+
         sdr_event_t ev = {
                 .ev               = SDR_EV_DATA,
                 .sample_rate      = sample_rate,
                 .center_frequency = center_frequency,
                 .buf              = buffer,
-                .len              = n_read,
+                .len              = n_samples * 2,
         };
 #ifdef THREADS
         pthread_mutex_lock(&dev->lock);
@@ -313,46 +1027,20 @@ static int rtltcp_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
             break; // do not deliver any more events
         }
 #endif
-        if (n_read > 0) // prevent a crash in callback
-            cb(&ev, ctx);
+        if (drop) {
+            dev->dropped += 1;
+            continue;
+        }
+        ring_publish(dev, &ev);
+        cb(&ev, ctx);
 
     } while (dev->running);
 
+    print_logf(LOG_NOTICE, "SDR", "Synthetic input sent %u messages, %u skipped as too many overlapped.",
+            sdr_synth_sent(dev->synth), sdr_synth_skipped(dev->synth));
     return 0;
 }
 
-#pragma pack(push, 1)
-struct command {
-    unsigned char cmd;
-    unsigned int param;
-};
-#pragma pack(pop)
-
-// rtl_tcp API
-#define RTLTCP_SET_FREQ 0x01
-#define RTLTCP_SET_SAMPLE_RATE 0x02
-#define RTLTCP_SET_GAIN_MODE 0x03
-#define RTLTCP_SET_GAIN 0x04
-#define RTLTCP_SET_FREQ_CORRECTION 0x05
-#define RTLTCP_SET_IF_TUNER_GAIN 0x06
-#define RTLTCP_SET_TEST_MODE 0x07
-#define RTLTCP_SET_AGC_MODE 0x08
-#define RTLTCP_SET_DIRECT_SAMPLING 0x09
-#define RTLTCP_SET_OFFSET_TUNING 0x0a
-#define RTLTCP_SET_RTL_XTAL 0x0b
-#define RTLTCP_SET_TUNER_XTAL 0x0c
-#define RTLTCP_SET_TUNER_GAIN_BY_ID 0x0d
-#define RTLTCP_SET_BIAS_TEE 0x0e
-
-static int rtltcp_command(sdr_dev_t *dev, char cmd, int param)
-{
-    struct command command;
-    command.cmd   = cmd;
-    command.param = htonl(param);
-
-    return sizeof(command) == send(dev->rtl_tcp, (const char*) &command, sizeof(command), 0) ? 0 : -1;
-}
-
 /* RTL-SDR helpers */
 
 #ifdef RTLSDR
@@ -498,13 +1186,44 @@ static void rtlsdr_read_cb(unsigned char *iq_buf, uint32_t len, void *ctx)
     }
 #endif
 
-    if (dev->buffer_pos + len > dev->buffer_size)
-        dev->buffer_pos = 0;
-    uint8_t *buffer = &dev->buffer[dev->buffer_pos];
-    dev->buffer_pos += len;
+    if (len == 0) // prevent a crash in callback
+        return;
+
+    // The transfer buffers are resubmitted when we return and refilled after all other transfers,
+    // a lease not yet used by the consumer after half of the transfers is copied to its ring slot.
+    if (dev->slot_leases) {
+        lease_lock(dev);
+        dev->lease_calls += 1;
+        lease_expire(dev, dev->slot_num / 2);
+        lease_unlock(dev);
+    }
+
+    uint8_t *buffer = ring_next_slot(dev);
+    if (!buffer || len > dev->slot_len) {
+        dev->dropped += 1;
+        return;
+    }
 
-    // NOTE: we need to copy the buffer, it might go away on cancel_async
-    memcpy(buffer, iq_buf, len);
+    // lease it only while the consumer keeps up, i.e. holds less than half of the buffers.
+    unsigned held = dev->slot_head - atomic_load_acquire(&dev->slot_tail);
+    int lease     = 0;
+    if (dev->slot_leases) {
+        lease_lock(dev);
+        lease = held < dev->slot_num / 2;
+#ifdef THREADS
+        lease = lease && !dev->exit_acquire; // sdr_stop() copies the leases given before
+#endif
+        sdr_lease_t *slot = &dev->slot_leases[dev->slot_head % dev->slot_num];
+        *slot = lease ? (sdr_lease_t){.state = LEASE_HELD, .buf = iq_buf, .len = len, .call = dev->lease_calls} : (sdr_lease_t){0};
+        lease_unlock(dev);
+    }
+    if (lease) {
+        buffer = iq_buf;
+    }
+    else {
+        // NOTE: we need to copy the buffer, it might go away on cancel_async
+        memcpy(buffer, iq_buf, len);
+    }
 
 #ifdef THREADS
     pthread_mutex_lock(&dev->lock);
@@ -520,28 +1239,30 @@ static void rtlsdr_read_cb(unsigned char *iq_buf, uint32_t len, void *ctx)
             .center_frequency = center_frequency,
             .buf              = buffer,
             .len              = len,
+            .leased           = lease,
     };
     //fprintf(stderr, "rtlsdr_read_cb cb...\n");
-    if (len > 0) // prevent a crash in callback
-        dev->rtlsdr_cb(&ev, dev->rtlsdr_cb_ctx);
+    ring_publish(dev, &ev);
+    dev->rtlsdr_cb(&ev, dev->rtlsdr_cb_ctx);
     //fprintf(stderr, "rtlsdr_read_cb cb done.\n");
     // NOTE: we actually need to copy the buffer to prevent it going away on cancel_async
 }
 
 static int rtlsdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
 {
-    size_t buffer_size = (size_t)buf_num * buf_len;
-    if (dev->buffer_size != buffer_size) {
-        free(dev->buffer);
-        dev->buffer = malloc(buffer_size);
-        if (!dev->buffer) {
-            WARN_MALLOC("rtlsdr_read_loop()");
-            return -1; // NOTE: returns error on alloc failure.
-        }
-        dev->buffer_size = buffer_size;
-        dev->buffer_pos = 0;
+    if (ring_init(dev, buf_num, buf_len) < 0) {
+        return -1; // NOTE: returns error on alloc failure.
     }
 
+    free(dev->slot_leases);
+    dev->slot_leases = NULL;
+    if (dev->rtlsdr_zero_copy) {
+        dev->slot_leases = calloc(buf_num, sizeof(*dev->slot_leases));
+        if (!dev->slot_leases)
+            WARN_CALLOC("rtlsdr_read_loop()"); // NOTE: falls back to copying.
+    }
+    dev->lease_calls = 0;
+
     int r = 0;
 
     dev->rtlsdr_cb = cb;
@@ -580,6 +1301,19 @@ static int rtlsdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32
 
 #ifdef SOAPYSDR
 
+/// Most RX channels of a device read with one stream.
+#define SOAPY_GROUP_MAX_CHANNELS 8
+
+typedef struct soapy_group soapy_group_t;
+
+#ifdef THREADS
+static int soapy_group_open(sdr_dev_t *dev, char const *args, size_t channel, int verbose);
+static void soapy_group_close(sdr_dev_t *dev);
+static void soapy_group_set_sample_rate(sdr_dev_t *dev, uint32_t rate);
+static int soapy_group_start(sdr_dev_t *dev, uint32_t buf_num, uint32_t buf_len);
+static int soapy_group_stop(sdr_dev_t *dev);
+#endif
+
 static int soapysdr_set_bandwidth(SoapySDRDevice *dev, uint32_t bandwidth)
 {
     int r;
@@ -656,13 +1390,13 @@ static int soapysdr_offset_tuning(SoapySDRDevice *dev)
     return r;
 }
 
-static int soapysdr_auto_gain(SoapySDRDevice *dev, int verbose)
+static int soapysdr_auto_gain(SoapySDRDevice *dev, size_t channel, int verbose)
 {
     int r = 0;
 
-    r = SoapySDRDevice_hasGainMode(dev, SOAPY_SDR_RX, 0);
+    r = SoapySDRDevice_hasGainMode(dev, SOAPY_SDR_RX, channel);
     if (r) {
-        r = SoapySDRDevice_setGainMode(dev, SOAPY_SDR_RX, 0, 1);
+        r = SoapySDRDevice_setGainMode(dev, SOAPY_SDR_RX, channel, 1);
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to enable automatic gain.");
         }
@@ -679,15 +1413,15 @@ static int soapysdr_auto_gain(SoapySDRDevice *dev, int verbose)
         // even though it logs HACKRF_ERROR_INVALID_PARAM? https://github.com/rxseger/rx_tools/issues/9
         // Total gain is distributed amongst all gains, 116 = 37,65,1; the LNA is OK (<40) but VGA is out of range (65 > 62)
         // TODO: generic means to set all gains, of any SDR? string parsing LNA=#,VGA=#,AMP=#?
-        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, 0, "LNA", 40.); // max 40
+        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, channel, "LNA", 40.); // max 40
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to set LNA tuner gain.");
         }
-        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, 0, "VGA", 20.); // max 65
+        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, channel, "VGA", 20.); // max 65
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to set VGA tuner gain.");
         }
-        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, 0, "AMP", 0.); // on or off
+        r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, channel, "AMP", 0.); // on or off
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to set AMP tuner gain.");
         }
@@ -699,7 +1433,7 @@ static int soapysdr_auto_gain(SoapySDRDevice *dev, int verbose)
     return r;
 }
 
-static int soapysdr_gain_str_set(SoapySDRDevice *dev, char const *gain_str, int verbose)
+static int soapysdr_gain_str_set(SoapySDRDevice *dev, size_t channel, char const *gain_str, int verbose)
 {
     if (!gain_str || !*gain_str || strlen(gain_str) >= GAIN_STR_MAX_SIZE)
         return -1;
@@ -707,9 +1441,9 @@ static int soapysdr_gain_str_set(SoapySDRDevice *dev, char const *gain_str, int
     int r = 0;
 
     // Disable automatic gain
-    r = SoapySDRDevice_hasGainMode(dev, SOAPY_SDR_RX, 0);
+    r = SoapySDRDevice_hasGainMode(dev, SOAPY_SDR_RX, channel);
     if (r) {
-        r = SoapySDRDevice_setGainMode(dev, SOAPY_SDR_RX, 0, 0);
+        r = SoapySDRDevice_setGainMode(dev, SOAPY_SDR_RX, channel, 0);
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to disable automatic gain.");
         }
@@ -730,7 +1464,7 @@ static int soapysdr_gain_str_set(SoapySDRDevice *dev, char const *gain_str, int
             double num = atof(value);
             if (verbose)
                 print_logf(LOG_NOTICE, "SDR", "Setting gain element %s: %f dB", name, num);
-            r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, 0, name, num);
+            r = SoapySDRDevice_setGainElement(dev, SOAPY_SDR_RX, channel, name, num);
             if (r != 0) {
                 print_logf(LOG_WARNING, __func__, "setGainElement(%s, %f) failed: %d", name, num, r);
             }
@@ -739,7 +1473,7 @@ static int soapysdr_gain_str_set(SoapySDRDevice *dev, char const *gain_str, int
     else {
         // Set overall gain and let SoapySDR distribute amongst components
         double value = atof(gain_str);
-        r = SoapySDRDevice_setGain(dev, SOAPY_SDR_RX, 0, value);
+        r = SoapySDRDevice_setGain(dev, SOAPY_SDR_RX, channel, value);
         if (r != 0) {
             print_log(LOG_WARNING, __func__, "Failed to set tuner gain.");
         }
@@ -750,10 +1484,10 @@ static int soapysdr_gain_str_set(SoapySDRDevice *dev, char const *gain_str, int
         // read back and print each individual gain element
         if (verbose) {
             size_t len = 0;
-            char **gains = SoapySDRDevice_listGains(dev, SOAPY_SDR_RX, 0, &len);
+            char **gains = SoapySDRDevice_listGains(dev, SOAPY_SDR_RX, channel, &len);
             fprintf(stderr, "Gain elements: ");
             for (size_t i = 0; i < len; ++i) {
-                double gain = SoapySDRDevice_getGain(dev, SOAPY_SDR_RX, 0);
+                double gain = SoapySDRDevice_getGain(dev, SOAPY_SDR_RX, channel);
                 fprintf(stderr, "%s=%g ", gains[i], gain);
             }
             fprintf(stderr, "\n");
@@ -861,11 +1595,109 @@ static void soapysdr_show_device_info(SoapySDRDevice *dev)
     SoapySDR_free(native_stream_format);
 }
 
+/// Select a stream format of a channel, in preference order: native CU8, CS8, CS16, forced CS16.
+static char const *soapysdr_select_format(SoapySDRDevice *soapy_dev, size_t channel, int *sample_size, int *sample_signed, double *fullScale)
+{
+    // stream_formats = SoapySDRDevice_getStreamFormats(soapy_dev, SOAPY_SDR_RX, channel, &len);
+    char *native_format = SoapySDRDevice_getNativeStreamFormat(soapy_dev, SOAPY_SDR_RX, channel, fullScale);
+    char const *selected_format;
+    if (!strcmp(SOAPY_SDR_CU8, native_format)) {
+        // actually not supported by SoapySDR
+        selected_format = SOAPY_SDR_CU8;
+        *sample_size = sizeof(uint8_t) * 2; // CU8
+        *sample_signed = 0;
+    }
+    else if (!strcmp(SOAPY_SDR_CS8, native_format)) {
+        // e.g. HackRF, RTL-SDR (8 bit), scale is 128.0
+        // half the bytes of CS16, demodulated natively or flipped to CU8 by the consumer
+        selected_format = SOAPY_SDR_CS8;
+        *sample_size = sizeof(int8_t) * 2; // CS8
+        *sample_signed = 1;
+    }
+    else if (!strcmp(SOAPY_SDR_CS16, native_format)) {
+        // e.g. LimeSDR-mini (12 bit), native scale is 2048.0
+        // e.g. SDRplay RSP1A (14 bit), native scale is 32767.0
+        selected_format = SOAPY_SDR_CS16;
+        *sample_size = sizeof(int16_t) * 2; // CS16
+        *sample_signed = 1;
+    }
+    else {
+        // force CS16
+        selected_format = SOAPY_SDR_CS16;
+        *sample_size = sizeof(int16_t) * 2; // CS16
+        *sample_signed = 1;
+        *fullScale = 32768.0; // assume max for SOAPY_SDR_CS16
+    }
+    SoapySDR_free(native_format);
+    return selected_format;
+}
+
+/// The hardware info of a device as JSON.
+static char *soapysdr_dev_info(SoapySDRDevice *soapy_dev)
+{
+    SoapySDRKwargs args = SoapySDRDevice_getHardwareInfo(soapy_dev);
+    size_t info_len     = 2;
+    for (size_t i = 0; i < args.size; ++i) {
+        info_len += strlen(args.keys[i]) + strlen(args.vals[i]) + 6;
+    }
+    char *dev_info = malloc(info_len);
+    if (!dev_info)
+        FATAL_MALLOC("sdr_open_soapy");
+    char *p = dev_info;
+    for (size_t i = 0; i < args.size; ++i) {
+        p += sprintf(p, "%s\"%s\":\"%s\"", i ? "," : "{", args.keys[i], args.vals[i]);
+    }
+    sprintf(p, "}");
+    SoapySDRKwargs_clear(&args);
+    return dev_info;
+}
+
+/// Split the channel key off a device query, returns 1 if a channel is given, 0 if not, -1 if invalid.
+static int soapysdr_split_channel(char const *dev_query, char *args, size_t args_size, size_t *channel)
+{
+    int found  = 0;
+    size_t len = 0;
+    args[0]    = '\0';
+    for (char const *s = dev_query; s && *s; s = kwargs_skip(s)) {
+        while (*s == ' ' || *s == '\t' || *s == ',')
+            ++s;
+        char const *val;
+        if (kwargs_match(s, "channel", &val)) {
+            char *end = NULL;
+            long n    = val ? strtol(val, &end, 10) : -1;
+            if (n < 0 || n >= SOAPY_GROUP_MAX_CHANNELS || end == val || (*end && *end != ',' && *end != ' ' && *end != '\t'))
+                return -1;
+            *channel = (size_t)n;
+            found    = 1;
+            continue;
+        }
+        // copy the other key/value pairs as they are
+        size_t pair = (size_t)(kwargs_skip(s) - s);
+        while (pair && (s[pair - 1] == ',' || s[pair - 1] == ' ' || s[pair - 1] == '\t'))
+            pair--;
+        if (!pair)
+            continue;
+        if (len + pair + 2 > args_size)
+            return -1;
+        len += sprintf(&args[len], "%s%.*s", len ? "," : "", (int)pair, s);
+    }
+    return found;
+}
+
 static int sdr_open_soapy(sdr_dev_t **out_dev, char const *dev_query, int verbose)
 {
     if (verbose)
         SoapySDR_setLogLevel(SOAPY_SDR_DEBUG);
 
+    // a channel key selects one channel of a device, read with the other channels in one stream
+    char group_args[256];
+    size_t channel = 0;
+    int grouped    = soapysdr_split_channel(dev_query, group_args, sizeof(group_args), &channel);
+    if (grouped < 0) {
+        print_logf(LOG_ERROR, __func__, "Invalid channel in sdr device query '%s'.", dev_query);
+        return -1;
+    }
+
     sdr_dev_t *dev = calloc(1, sizeof(sdr_dev_t));
     if (!dev) {
         WARN_CALLOC("sdr_open_soapy()");
@@ -875,6 +1707,23 @@ static int sdr_open_soapy(sdr_dev_t **out_dev, char const *dev_query, int verbos
     pthread_mutex_init(&dev->lock, NULL);
 #endif
 
+    if (grouped) {
+#ifdef THREADS
+        int r = soapy_group_open(dev, group_args, channel, verbose);
+        if (r < 0) {
+            pthread_mutex_destroy(&dev->lock);
+            free(dev);
+            return r;
+        }
+        *out_dev = dev;
+        return 0;
+#else
+        print_log(LOG_ERROR, __func__, "rtl_433 compiled without thread support, device channels not available.");
+        free(dev);
+        return -1;
+#endif
+    }
+
     dev->soapy_dev = SoapySDRDevice_makeStrArgs(dev_query);
     if (!dev->soapy_dev) {
         if (verbose)
@@ -886,177 +1735,573 @@ static int sdr_open_soapy(sdr_dev_t **out_dev, char const *dev_query, int verbos
     if (verbose)
         soapysdr_show_device_info(dev->soapy_dev);
 
-    // select a stream format, in preference order: native CU8, CS8, CS16, forced CS16
-    // stream_formats = SoapySDRDevice_getStreamFormats(dev->soapy_dev, SOAPY_SDR_RX, 0, &len);
-    char *native_format = SoapySDRDevice_getNativeStreamFormat(dev->soapy_dev, SOAPY_SDR_RX, 0, &dev->fullScale);
-    char const *selected_format;
-    if (!strcmp(SOAPY_SDR_CU8, native_format)) {
-        // actually not supported by SoapySDR
-        selected_format = SOAPY_SDR_CU8;
-        dev->sample_size = sizeof(uint8_t); // CU8
-        dev->sample_signed = 0;
-    }
-//    else if (!strcmp(SOAPY_SDR_CS8, native_format)) {
-//        // TODO: CS8 needs conversion to CU8
-//        // e.g. RTL-SDR (8 bit), scale is 128.0
-//        selected_format = SOAPY_SDR_CS8;
-//        dev->sample_size = sizeof(int8_t) * 2; // CS8
-//        dev->sample_signed = 1;
-//    }
-    else if (!strcmp(SOAPY_SDR_CS16, native_format)) {
-        // e.g. LimeSDR-mini (12 bit), native scale is 2048.0
-        // e.g. SDRplay RSP1A (14 bit), native scale is 32767.0
-        selected_format = SOAPY_SDR_CS16;
-        dev->sample_size = sizeof(int16_t) * 2; // CS16
-        dev->sample_signed = 1;
+    char const *selected_format = soapysdr_select_format(dev->soapy_dev, 0, &dev->sample_size, &dev->sample_signed, &dev->fullScale);
+
+    dev->dev_info = soapysdr_dev_info(dev->soapy_dev);
+
+    SoapySDRKwargs stream_args = {0};
+    int r;
+#if SOAPY_SDR_API_VERSION >= 0x00080000
+    // API version 0.8
+#undef SoapySDRDevice_setupStream
+    dev->soapy_stream = SoapySDRDevice_setupStream(dev->soapy_dev, SOAPY_SDR_RX, selected_format, NULL, 0, &stream_args);
+    r = dev->soapy_stream == NULL;
+#else
+    // API version 0.7
+    r = SoapySDRDevice_setupStream(dev->soapy_dev, &dev->soapy_stream, SOAPY_SDR_RX, selected_format, NULL, 0, &stream_args);
+#endif
+    if (r != 0) {
+        if (verbose)
+            print_log(LOG_ERROR, __func__, "Failed to setup sdr device");
+        free(dev->dev_info);
+        free(dev);
+        return -3;
+    }
+
+    *out_dev = dev;
+    return 0;
+}
+
+// the buffer sizes can't be proven to be correct
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-warning-option"
+#pragma GCC diagnostic ignored "-Wanalyzer-allocation-size"
+
+/// Map the hardware time of the first sample of a buffer to wall clock time in ns.
+/// The offset is anchored on the first timestamp and again if the device clock jumps.
+static int64_t soapysdr_wall_time_ns(sdr_dev_t *dev, long long time_ns, unsigned n_samples, uint32_t sample_rate)
+{
+    struct timeval now;
+    get_time_now(&now);
+    // the buffer just completed, the first sample arrived a buffer length ago
+    int64_t wall_ns = (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_usec * 1000;
+    if (sample_rate)
+        wall_ns -= (int64_t)n_samples * 1000000000 / sample_rate;
+
+    int64_t skew_ns = time_ns + dev->soapy_time_offset - wall_ns;
+    if (!dev->soapy_time_valid || skew_ns > 1000000000 || skew_ns < -1000000000) {
+        dev->soapy_time_offset = wall_ns - time_ns;
+        dev->soapy_time_valid  = 1;
+    }
+    return time_ns + dev->soapy_time_offset;
+}
+
+/// Rescale a CS16 buffer of a device with a smaller native full scale.
+static void soapysdr_rescale(int16_t *buffer, unsigned n_samples, double fullScale)
+{
+    // TODO: SoapyRemote doesn't scale properly when reading (local) CS16 from (remote) CS8
+    // rescale cs16 buffer
+    if (fullScale >= 2047.0 && fullScale <= 2048.0) {
+        for (unsigned i = 0; i < n_samples * 2; ++i)
+            buffer[i] *= 16; // prevent left shift of negative value
+    }
+    else if (fullScale < 32767.0) {
+        int upscale = 32768 / fullScale;
+        for (unsigned i = 0; i < n_samples * 2; ++i)
+            buffer[i] *= upscale;
+    }
+}
+
+static int soapysdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+{
+    if (ring_init(dev, buf_num, buf_len) < 0) {
+        return -1; // NOTE: returns error on alloc failure.
+    }
+
+    size_t buf_elems = buf_len / dev->sample_size;
+
+    dev->running = 1;
+    do {
+        // we need to keep reading even if all slots are in use
+        uint8_t *buffer = ring_next_slot(dev);
+        int drop = !buffer;
+        if (drop)
+            buffer = ring_spare_slot(dev);
+
+        void *buffs[]    = {buffer};
+        int flags        = 0;
+        long long timeNs = 0;
+        long long firstNs = 0; // hardware time of the first sample
+        int has_time     = 0;
+        long timeoutUs   = 1000000; // 1 second
+        unsigned n_read  = 0;
+        int r;
+
+        do {
+            buffs[0] = &buffer[n_read * dev->sample_size];
+            flags    = 0;
+            r  = SoapySDRDevice_readStream(dev->soapy_dev, dev->soapy_stream, buffs, buf_elems - n_read, &flags, &timeNs, timeoutUs);
+            if (r < 0)
+                break;
+            if (flags & SOAPY_SDR_END_ABRUPT) {
+                dev->soapy_overflows += 1;
+            }
+            if (!has_time && (flags & SOAPY_SDR_HAS_TIME)) {
+                // the timestamp is for the first sample of this read
+                firstNs  = timeNs - (long long)n_read * 1000000000 / (dev->sample_rate ? dev->sample_rate : 1);
+                has_time = 1;
+            }
+            n_read += r; // r is number of elements read, elements=complex pairs, so buffer length is twice
+            //fprintf(stderr, "readStream ret=%d, flags=%d, timeNs=%lld (%zu - %u)\n", r, flags, timeNs, buf_elems, n_read);
+        } while (n_read < buf_elems);
+        //fprintf(stderr, "readStream ret=%u (%u), flags=%d, timeNs=%lld\n", n_read, buf_len, flags, timeNs);
+        if (r < 0) {
+            if (r == SOAPY_SDR_OVERFLOW) {
+                dev->soapy_overflows += 1;
+                fprintf(stderr, "O");
+                fflush(stderr);
+                continue;
+            }
+            print_logf(LOG_WARNING, __func__, "sync read failed. %d", r);
+        }
+
+        // CS16 is rescaled to the full range, CS8 is passed on as is
+        if (dev->sample_size == 4)
+            soapysdr_rescale((int16_t *)buffer, n_read, dev->fullScale);
+
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+#endif
+        uint32_t sample_rate      = dev->sample_rate;
+        uint32_t center_frequency = dev->center_frequency;
+#ifdef THREADS
+        pthread_mutex_unlock(&dev->lock);
+#endif
+        sdr_event_t ev = {
+                .ev               = SDR_EV_DATA,
+                .sample_rate      = sample_rate,
+                .center_frequency = center_frequency,
+                .buf              = buffer,
+                .len              = n_read * dev->sample_size,
+                .time_ns          = has_time ? soapysdr_wall_time_ns(dev, firstNs, n_read, sample_rate) : 0,
+        };
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+        int exit_acquire = dev->exit_acquire;
+        pthread_mutex_unlock(&dev->lock);
+        if (exit_acquire) {
+            break; // do not deliver any more events
+        }
+#endif
+        if (n_read == 0) // prevent a crash in callback
+            continue;
+        if (drop) {
+            dev->dropped += 1;
+            continue;
+        }
+        ev.overflows = dev->soapy_overflows - dev->soapy_overflows_reported;
+        dev->soapy_overflows_reported = dev->soapy_overflows;
+        ring_publish(dev, &ev);
+        cb(&ev, ctx);
+
+    } while (dev->running);
+
+    return 0;
+}
+
+/* SoapySDR multi-channel streams */
+
+#ifdef THREADS
+
+/// The channels of a device read with one stream, shared by the devices opened with a channel key.
+struct soapy_group {
+    struct soapy_group *next;
+    char *args; ///< the device query without the channel
+    SoapySDRDevice *soapy_dev;
+    size_t num_channels; ///< the RX channels of the device
+    char const *format; ///< the stream format of all channels
+    int sample_size;
+    int sample_signed;
+    double fullScale;
+    sdr_dev_t *open[SOAPY_GROUP_MAX_CHANNELS]; ///< the devices open, by channel
+    sdr_dev_t *started[SOAPY_GROUP_MAX_CHANNELS]; ///< the devices started, in channel order
+    unsigned num_started;
+    SoapySDRStream *soapy_stream; ///< the stream of the started channels, set up by the group thread
+    size_t buf_elems; ///< samples per read, the smallest ring slot of the started devices
+    uint8_t *buffer; ///< the read buffer of each started channel
+    size_t buffer_size;
+    unsigned overflows; ///< stream overflows and abrupt stream ends
+    int changed; ///< the started devices changed, the stream is set up again
+    int running;
+    int thread_started;
+    pthread_t thread;
+    pthread_mutex_t lock; ///< lock for the started devices and the stream
+};
+
+/// The groups open, the lock is only held while a device is opened or closed.
+static soapy_group_t *soapy_groups;
+static unsigned soapy_groups_lock;
+
+static void soapy_group_free(soapy_group_t *group)
+{
+    if (group->soapy_dev)
+        SoapySDRDevice_unmake(group->soapy_dev);
+    pthread_mutex_destroy(&group->lock);
+    free(group->buffer);
+    free(group->args);
+    free(group);
+}
+
+static soapy_group_t *soapy_group_create(char const *args, int verbose)
+{
+    soapy_group_t *group = calloc(1, sizeof(*group));
+    if (!group) {
+        WARN_CALLOC("soapy_group_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    pthread_mutex_init(&group->lock, NULL);
+    group->args = strdup(args);
+    if (!group->args) {
+        WARN_STRDUP("soapy_group_create()");
+        soapy_group_free(group);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    group->soapy_dev = SoapySDRDevice_makeStrArgs(args);
+    if (!group->soapy_dev) {
+        if (verbose)
+            print_logf(LOG_ERROR, __func__, "Failed to open sdr device matching '%s'.", args);
+        soapy_group_free(group);
+        return NULL;
+    }
+    if (verbose)
+        soapysdr_show_device_info(group->soapy_dev);
+
+    group->num_channels = SoapySDRDevice_getNumChannels(group->soapy_dev, SOAPY_SDR_RX);
+    group->format       = soapysdr_select_format(group->soapy_dev, 0, &group->sample_size, &group->sample_signed, &group->fullScale);
+    return group;
+}
+
+static int soapy_group_open(sdr_dev_t *dev, char const *args, size_t channel, int verbose)
+{
+    atomic_spin_lock(&soapy_groups_lock);
+    soapy_group_t *group = soapy_groups;
+    while (group && strcmp(group->args, args)) {
+        group = group->next;
+    }
+    int created = !group;
+    if (created) {
+        group = soapy_group_create(args, verbose);
+        if (!group) {
+            atomic_spin_unlock(&soapy_groups_lock);
+            return -1;
+        }
+    }
+    if (channel >= group->num_channels || group->open[channel]) {
+        if (channel >= group->num_channels)
+            print_logf(LOG_ERROR, __func__, "The sdr device '%s' has no channel %zu.", args, channel);
+        else
+            print_logf(LOG_ERROR, __func__, "Channel %zu of the sdr device '%s' is already open.", channel, args);
+        if (created)
+            soapy_group_free(group);
+        atomic_spin_unlock(&soapy_groups_lock);
+        return -1;
     }
-    else {
-        // force CS16
-        selected_format = SOAPY_SDR_CS16;
-        dev->sample_size = sizeof(int16_t) * 2; // CS16
-        dev->sample_signed = 1;
-        dev->fullScale = 32768.0; // assume max for SOAPY_SDR_CS16
+    if (created) {
+        group->next  = soapy_groups;
+        soapy_groups = group;
     }
-    SoapySDR_free(native_format);
+    group->open[channel] = dev;
+    atomic_spin_unlock(&soapy_groups_lock);
 
-    SoapySDRKwargs args = SoapySDRDevice_getHardwareInfo(dev->soapy_dev);
-    size_t info_len     = 2;
-    for (size_t i = 0; i < args.size; ++i) {
-        info_len += strlen(args.keys[i]) + strlen(args.vals[i]) + 6;
+    dev->soapy_dev     = group->soapy_dev;
+    dev->soapy_channel = channel;
+    dev->soapy_group   = group;
+    dev->sample_size   = group->sample_size;
+    dev->sample_signed = group->sample_signed;
+    dev->fullScale     = group->fullScale;
+    dev->dev_info      = soapysdr_dev_info(group->soapy_dev);
+    if (verbose)
+        print_logf(LOG_NOTICE, "SDR", "Opened channel %zu of %zu of the sdr device '%s'.", channel, group->num_channels, args);
+    return 0;
+}
+
+static void soapy_group_close(sdr_dev_t *dev)
+{
+    soapy_group_t *group = dev->soapy_group;
+    atomic_spin_lock(&soapy_groups_lock);
+    group->open[dev->soapy_channel] = NULL;
+    int unused = 1;
+    for (size_t i = 0; i < SOAPY_GROUP_MAX_CHANNELS; ++i) {
+        unused = unused && !group->open[i];
+    }
+    if (unused) {
+        soapy_group_t **prev = &soapy_groups;
+        while (*prev != group) {
+            prev = &(*prev)->next;
+        }
+        *prev = group->next;
     }
-    char *p = dev->dev_info = malloc(info_len);
-    if (!dev->dev_info)
-        FATAL_MALLOC("sdr_open_soapy");
-    for (size_t i = 0; i < args.size; ++i) {
-        p += sprintf(p, "%s\"%s\":\"%s\"", i ? "," : "{", args.keys[i], args.vals[i]);
+    atomic_spin_unlock(&soapy_groups_lock);
+    dev->soapy_dev   = NULL;
+    dev->soapy_group = NULL;
+    if (unused)
+        soapy_group_free(group);
+}
+
+/// The channels share the sample rate, the other open devices are told the rate set.
+static void soapy_group_set_sample_rate(sdr_dev_t *dev, uint32_t rate)
+{
+    soapy_group_t *group = dev->soapy_group;
+    atomic_spin_lock(&soapy_groups_lock);
+    for (size_t i = 0; i < SOAPY_GROUP_MAX_CHANNELS; ++i) {
+        sdr_dev_t *other = group->open[i];
+        if (!other || other == dev)
+            continue;
+        pthread_mutex_lock(&other->lock);
+        if (other->sample_rate && other->sample_rate != rate)
+            print_logf(LOG_WARNING, "SDR", "The channels of a device share the sample rate, channel %zu now at %u S/s.", i, rate);
+        other->sample_rate = rate;
+        pthread_mutex_unlock(&other->lock);
+    }
+    atomic_spin_unlock(&soapy_groups_lock);
+}
+
+/// Set up the stream of the started channels again, called with the group lock held.
+static void soapy_group_setup_stream(soapy_group_t *group)
+{
+    if (group->soapy_stream) {
+        SoapySDRDevice_deactivateStream(group->soapy_dev, group->soapy_stream, 0, 0);
+        SoapySDRDevice_closeStream(group->soapy_dev, group->soapy_stream);
+        group->soapy_stream = NULL;
+    }
+    if (!group->num_started)
+        return;
+
+    size_t channels[SOAPY_GROUP_MAX_CHANNELS];
+    size_t buf_elems = SIZE_MAX;
+    char channels_str[SOAPY_GROUP_MAX_CHANNELS * 4] = {0};
+    for (unsigned k = 0; k < group->num_started; ++k) {
+        sdr_dev_t *dev = group->started[k];
+        channels[k]    = dev->soapy_channel;
+        if (dev->slot_len / group->sample_size < buf_elems)
+            buf_elems = dev->slot_len / group->sample_size;
+        sprintf(&channels_str[strlen(channels_str)], "%s%zu", k ? "," : "", dev->soapy_channel);
+    }
+    size_t buffer_size = group->num_started * buf_elems * group->sample_size;
+    if (buffer_size > group->buffer_size) {
+        uint8_t *buffer = realloc(group->buffer, buffer_size);
+        if (!buffer) {
+            WARN_REALLOC("soapy_group_setup_stream()");
+            return;
+        }
+        group->buffer      = buffer;
+        group->buffer_size = buffer_size;
     }
-    sprintf(p, "}");
-    SoapySDRKwargs_clear(&args);
+    group->buf_elems = buf_elems;
 
     SoapySDRKwargs stream_args = {0};
     int r;
 #if SOAPY_SDR_API_VERSION >= 0x00080000
     // API version 0.8
-#undef SoapySDRDevice_setupStream
-    dev->soapy_stream = SoapySDRDevice_setupStream(dev->soapy_dev, SOAPY_SDR_RX, selected_format, NULL, 0, &stream_args);
-    r = dev->soapy_stream == NULL;
+    group->soapy_stream = SoapySDRDevice_setupStream(group->soapy_dev, SOAPY_SDR_RX, group->format, channels, group->num_started, &stream_args);
+    r = group->soapy_stream == NULL;
 #else
     // API version 0.7
-    r = SoapySDRDevice_setupStream(dev->soapy_dev, &dev->soapy_stream, SOAPY_SDR_RX, selected_format, NULL, 0, &stream_args);
+    r = SoapySDRDevice_setupStream(group->soapy_dev, &group->soapy_stream, SOAPY_SDR_RX, group->format, channels, group->num_started, &stream_args);
 #endif
     if (r != 0) {
-        if (verbose)
-            print_log(LOG_ERROR, __func__, "Failed to setup sdr device");
-        free(dev->dev_info);
-        free(dev);
-        return -3;
+        print_logf(LOG_ERROR, __func__, "Failed to setup the stream of channels %s of '%s'", channels_str, group->args);
+        group->soapy_stream = NULL;
+        return;
     }
-
-    *out_dev = dev;
-    return 0;
+    if (SoapySDRDevice_activateStream(group->soapy_dev, group->soapy_stream, 0, 0, 0) != 0) {
+        print_logf(LOG_ERROR, __func__, "Failed to activate the stream of channels %s of '%s'", channels_str, group->args);
+        SoapySDRDevice_closeStream(group->soapy_dev, group->soapy_stream);
+        group->soapy_stream = NULL;
+        return;
+    }
+    print_logf(LOG_NOTICE, "SDR", "Streaming channels %s of '%s'.", channels_str, group->args);
 }
 
-// the buffer sizes can't be proven to be correct
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunknown-warning-option"
-#pragma GCC diagnostic ignored "-Wanalyzer-allocation-size"
-
-static int soapysdr_read_loop(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_num, uint32_t buf_len)
+/// Hand the samples read to each started device, called with the group lock held.
+static void soapy_group_publish(soapy_group_t *group, unsigned n_read, int has_time, long long firstNs)
 {
-    size_t buffer_size = (size_t)buf_num * buf_len;
-    if (dev->buffer_size != buffer_size) {
-        free(dev->buffer);
-        dev->buffer = malloc(buffer_size);
-        if (!dev->buffer) {
-            WARN_MALLOC("soapysdr_read_loop()");
-            return -1; // NOTE: returns error on alloc failure.
+    size_t channel_size = group->buf_elems * group->sample_size;
+    for (unsigned k = 0; k < group->num_started; ++k) {
+        sdr_dev_t *dev = group->started[k];
+        uint8_t *slot  = ring_next_slot(dev);
+        if (!slot) {
+            dev->dropped += 1;
+            continue;
         }
-        dev->buffer_size = buffer_size;
-        dev->buffer_pos = 0;
-    }
-
-    size_t buf_elems = buf_len / dev->sample_size;
+        memcpy(slot, &group->buffer[k * channel_size], n_read * group->sample_size);
+        if (group->sample_size == 4)
+            soapysdr_rescale((int16_t *)slot, n_read, group->fullScale);
 
-    dev->running = 1;
-    do {
-        if (dev->buffer_pos + buf_len > buffer_size)
-            dev->buffer_pos = 0;
-        int16_t *buffer = (void *)&dev->buffer[dev->buffer_pos];
-        dev->buffer_pos += buf_len;
+        pthread_mutex_lock(&dev->lock);
+        uint32_t sample_rate      = dev->sample_rate;
+        uint32_t center_frequency = dev->center_frequency;
+        pthread_mutex_unlock(&dev->lock);
+        sdr_event_t ev = {
+                .ev               = SDR_EV_DATA,
+                .sample_rate      = sample_rate,
+                .center_frequency = center_frequency,
+                .buf              = slot,
+                .len              = n_read * group->sample_size,
+                .time_ns          = has_time ? soapysdr_wall_time_ns(dev, firstNs, n_read, sample_rate) : 0,
+                .overflows        = group->overflows - dev->soapy_overflows_reported,
+        };
+        dev->soapy_overflows_reported = group->overflows;
+        ring_publish(dev, &ev);
+        dev->async_cb(&ev, dev->async_ctx);
+    }
+}
 
-        void *buffs[]    = {buffer};
-        int flags        = 0;
-        long long timeNs = 0;
-        long timeoutUs   = 1000000; // 1 second
-        unsigned n_read  = 0, i;
+static THREAD_RETURN THREAD_CALL soapy_group_thread(void *arg)
+{
+    soapy_group_t *group = arg;
+    thread_sched_apply(THREAD_ROLE_ACQUIRE);
+    print_log(LOG_DEBUG, __func__, "soapy_group_thread enter...");
+
+    pthread_mutex_lock(&group->lock);
+    while (group->running) {
+        if (group->changed) {
+            group->changed = 0;
+            soapy_group_setup_stream(group);
+        }
+        if (!group->soapy_stream) {
+            // the devices see no data and are restarted by their watchdog
+            pthread_mutex_unlock(&group->lock);
+            usleep(100000);
+            pthread_mutex_lock(&group->lock);
+            continue;
+        }
+        unsigned num_channels = group->num_started;
+        size_t buf_elems      = group->buf_elems;
+        size_t channel_size   = buf_elems * group->sample_size;
+        pthread_mutex_lock(&group->started[0]->lock);
+        uint32_t sample_rate = group->started[0]->sample_rate;
+        pthread_mutex_unlock(&group->started[0]->lock);
+        pthread_mutex_unlock(&group->lock);
+
+        // only the group thread sets up the stream and the buffer, read without the lock
+        void *buffs[SOAPY_GROUP_MAX_CHANNELS];
+        int flags         = 0;
+        long long timeNs  = 0;
+        long long firstNs = 0; // hardware time of the first sample
+        int has_time      = 0;
+        long timeoutUs    = 1000000; // 1 second
+        unsigned n_read   = 0;
         int r;
-
         do {
-            buffs[0] = &buffer[n_read * 2];
-            r  = SoapySDRDevice_readStream(dev->soapy_dev, dev->soapy_stream, buffs, buf_elems - n_read, &flags, &timeNs, timeoutUs);
+            for (unsigned k = 0; k < num_channels; ++k) {
+                buffs[k] = &group->buffer[k * channel_size + n_read * group->sample_size];
+            }
+            flags = 0;
+            r     = SoapySDRDevice_readStream(group->soapy_dev, group->soapy_stream, buffs, buf_elems - n_read, &flags, &timeNs, timeoutUs);
             if (r < 0)
                 break;
-            n_read += r; // r is number of elements read, elements=complex pairs, so buffer length is twice
-            //fprintf(stderr, "readStream ret=%d, flags=%d, timeNs=%lld (%zu - %u)\n", r, flags, timeNs, buf_elems, n_read);
-        } while (n_read < buf_elems);
-        //fprintf(stderr, "readStream ret=%u (%u), flags=%d, timeNs=%lld\n", n_read, buf_len, flags, timeNs);
+            if (flags & SOAPY_SDR_END_ABRUPT) {
+                group->overflows += 1;
+            }
+            if (!has_time && (flags & SOAPY_SDR_HAS_TIME)) {
+                // the timestamp is for the first sample of this read
+                firstNs  = timeNs - (long long)n_read * 1000000000 / (sample_rate ? sample_rate : 1);
+                has_time = 1;
+            }
+            n_read += r;
+        } while (n_read < buf_elems && group->running);
+
+        pthread_mutex_lock(&group->lock);
         if (r < 0) {
             if (r == SOAPY_SDR_OVERFLOW) {
-                fprintf(stderr, "O");
-                fflush(stderr);
+                group->overflows += 1;
                 continue;
             }
             print_logf(LOG_WARNING, __func__, "sync read failed. %d", r);
         }
+        // the samples of a stream set up for other channels are dropped
+        if (group->changed || !group->running || n_read == 0)
+            continue;
+        soapy_group_publish(group, n_read, has_time, firstNs);
+    }
+    soapy_group_setup_stream(group); // closes the stream, no channels are started
+    pthread_mutex_unlock(&group->lock);
 
-        // convert to CS16 or CU8 if needed
-        // if converting CS8 to CU8 -- vectorized with -O3
-        //for (i = 0; i < n_read * 2; ++i)
-        //    cu8buf[i] = (int8_t)cu8buf[i] + 128;
+    print_log(LOG_DEBUG, __func__, "soapy_group_thread done...");
+    return (THREAD_RETURN)(intptr_t)0;
+}
 
-        // TODO: SoapyRemote doesn't scale properly when reading (local) CS16 from (remote) CS8
-        // rescale cs16 buffer
-        if (dev->fullScale >= 2047.0 && dev->fullScale <= 2048.0) {
-            for (i = 0; i < n_read * 2; ++i)
-                buffer[i] *= 16; // prevent left shift of negative value
-        }
-        else if (dev->fullScale < 32767.0) {
-            int upscale = 32768 / dev->fullScale;
-            for (i = 0; i < n_read * 2; ++i)
-                buffer[i] *= upscale;
-        }
+/// Add a device to the stream, the group thread is started with the first device.
+static int soapy_group_start(sdr_dev_t *dev, uint32_t buf_num, uint32_t buf_len)
+{
+    soapy_group_t *group = dev->soapy_group;
+    if (ring_init(dev, buf_num, buf_len) < 0) {
+        return -1; // NOTE: returns error on alloc failure.
+    }
 
-#ifdef THREADS
-        pthread_mutex_lock(&dev->lock);
+    pthread_mutex_lock(&group->lock);
+    // keep the channels in order, the stream is set up again by the group thread
+    unsigned k = group->num_started;
+    while (k > 0 && group->started[k - 1]->soapy_channel > dev->soapy_channel) {
+        group->started[k] = group->started[k - 1];
+        k--;
+    }
+    group->started[k] = dev;
+    group->num_started++;
+    group->changed = 1;
+    int start      = !group->running;
+    group->running = 1;
+    pthread_mutex_unlock(&group->lock);
+
+    int r = 0;
+    if (start) {
+        if (group->thread_started)
+            pthread_join(group->thread, NULL); // the thread of the last devices started
+#ifndef _WIN32
+        // Block all signals from the worker thread
+        sigset_t sigset;
+        sigset_t oldset;
+        sigfillset(&sigset);
+        pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
 #endif
-        uint32_t sample_rate      = dev->sample_rate;
-        uint32_t center_frequency = dev->center_frequency;
-#ifdef THREADS
-        pthread_mutex_unlock(&dev->lock);
+        r = pthread_create(&group->thread, NULL, soapy_group_thread, group);
+#ifndef _WIN32
+        pthread_sigmask(SIG_SETMASK, &oldset, NULL);
 #endif
-        sdr_event_t ev = {
-                .ev               = SDR_EV_DATA,
-                .sample_rate      = sample_rate,
-                .center_frequency = center_frequency,
-                .buf              = buffer,
-                .len              = n_read * dev->sample_size,
-        };
-#ifdef THREADS
-        pthread_mutex_lock(&dev->lock);
-        int exit_acquire = dev->exit_acquire;
-        pthread_mutex_unlock(&dev->lock);
-        if (exit_acquire) {
-            break; // do not deliver any more events
+        group->thread_started = !r;
+        if (r) {
+            fprintf(stderr, "%s: error in pthread_create, rc: %d\n", __func__, r);
         }
-#endif
-        if (n_read > 0) // prevent a crash in callback
-            cb(&ev, ctx);
-
-    } while (dev->running);
+    }
+    dev->thread = group->thread;
+    return r;
+}
 
+/// Remove a device from the stream, the group thread exits with the last device.
+static int soapy_group_stop(sdr_dev_t *dev)
+{
+    soapy_group_t *group = dev->soapy_group;
+    pthread_mutex_lock(&group->lock);
+    unsigned k = 0;
+    while (k < group->num_started && group->started[k] != dev) {
+        k++;
+    }
+    if (k == group->num_started) {
+        pthread_mutex_unlock(&group->lock);
+        return 0; // not started
+    }
+    for (; k + 1 < group->num_started; ++k) {
+        group->started[k] = group->started[k + 1];
+    }
+    group->num_started--;
+    group->changed = 1;
+    int stop       = !group->num_started;
+    if (stop)
+        group->running = 0;
+    pthread_mutex_unlock(&group->lock);
+
+    if (stop && group->thread_started) {
+        print_log(LOG_DEBUG, __func__, "JOINING...");
+        pthread_join(group->thread, NULL);
+        group->thread_started = 0;
+    }
     return 0;
 }
 
+#endif /* THREADS */
+
 #pragma GCC diagnostic pop
 
 #endif
@@ -1068,6 +2313,9 @@ int sdr_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     if (dev_query && !strncmp(dev_query, "rtl_tcp", 7))
         return rtltcp_open(out_dev, dev_query, verbose);
 
+    if (dev_query && !strncmp(dev_query, "synth", 5))
+        return synth_open(out_dev, dev_query, verbose);
+
 #if !defined(RTLSDR) && !defined(SOAPYSDR)
     if (verbose)
         print_log(LOG_ERROR, __func__, "No input drivers (RTL-SDR or SoapySDR) compiled in.");
@@ -1097,6 +2345,88 @@ int sdr_open(sdr_dev_t **out_dev, char const *dev_query, int verbose)
     return -1;
 }
 
+struct sdr_opener {
+    char const *dev_query;
+    int verbose;
+    sdr_dev_t *dev;
+    int r;
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock; ///< held until the opener is returned to the caller
+    int started;
+#endif
+};
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL sdr_open_run(void *arg)
+{
+    sdr_opener_t *opener = arg;
+    pthread_mutex_lock(&opener->lock);
+    pthread_mutex_unlock(&opener->lock);
+    opener->r = sdr_open(&opener->dev, opener->dev_query, opener->verbose);
+    return (THREAD_RETURN)(intptr_t)0;
+}
+#endif
+
+int sdr_open_start(sdr_opener_t **out_opener, char const *dev_query, int verbose)
+{
+    sdr_opener_t *opener = calloc(1, sizeof(*opener));
+    if (!opener) {
+        WARN_CALLOC("sdr_open_start()");
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    opener->dev_query = dev_query;
+    opener->verbose   = verbose;
+#ifdef THREADS
+    // signals are handled by the main thread
+#ifndef _WIN32
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    pthread_mutex_init(&opener->lock, NULL);
+    pthread_mutex_lock(&opener->lock);
+    // without a thread the device is opened when finished
+    opener->started = pthread_create(&opener->thread, NULL, sdr_open_run, opener) == 0;
+    *out_opener = opener;
+    pthread_mutex_unlock(&opener->lock);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+#else
+    *out_opener = opener;
+#endif
+    return 0;
+}
+
+int sdr_open_is_current(sdr_opener_t *opener)
+{
+#ifdef THREADS
+    return opener && opener->started && pthread_equal(opener->thread, pthread_self());
+#else
+    (void)opener;
+    return 0;
+#endif
+}
+
+int sdr_open_finish(sdr_opener_t *opener, sdr_dev_t **out_dev)
+{
+#ifdef THREADS
+    if (opener->started)
+        pthread_join(opener->thread, NULL);
+    else
+#endif
+        opener->r = sdr_open(&opener->dev, opener->dev_query, opener->verbose);
+#ifdef THREADS
+    pthread_mutex_destroy(&opener->lock);
+#endif
+    int r    = opener->r;
+    *out_dev = opener->dev;
+    free(opener);
+    return r;
+}
+
 int sdr_close(sdr_dev_t *dev)
 {
     if (!dev)
@@ -1104,10 +2434,14 @@ int sdr_close(sdr_dev_t *dev)
 
     int ret = sdr_stop(dev);
 
-    if (dev->rtl_tcp)
+    if (dev->rtl_tcp && dev->rtl_tcp != INVALID_SOCKET)
         ret = rtltcp_close(dev->rtl_tcp);
 
 #ifdef SOAPYSDR
+#ifdef THREADS
+    if (dev->soapy_group)
+        soapy_group_close(dev); // the last channel closes the device
+#endif
     if (dev->soapy_dev)
         ret = SoapySDRDevice_unmake(dev->soapy_dev);
 #endif
@@ -1121,12 +2455,63 @@ int sdr_close(sdr_dev_t *dev)
     pthread_mutex_destroy(&dev->lock);
 #endif
 
+    sdr_synth_free(dev->synth);
+    rtltcp_codec_free(dev->rtl_tcp_codec);
+    free(dev->rtl_tcp_block);
+    free(dev->rtl_tcp_pending);
+    free(dev->rtl_tcp_host);
+    free(dev->rtl_tcp_port);
     free(dev->dev_info);
-    free(dev->buffer);
+    sample_buf_free(dev->buffer);
+    free(dev->slot_leases);
     free(dev);
     return ret;
 }
 
+void sdr_release(sdr_dev_t *dev)
+{
+    if (!dev)
+        return;
+
+    if (dev->slot_tail == atomic_load_acquire(&dev->slot_head)) {
+        print_log(LOG_WARNING, __func__, "no buffer to release");
+        return;
+    }
+    if (dev->slot_leases) {
+        lease_lock(dev);
+        dev->slot_leases[dev->slot_tail % dev->slot_num].state = LEASE_NONE;
+        atomic_store_release(&dev->slot_tail, dev->slot_tail + 1);
+        lease_unlock(dev);
+        return;
+    }
+    atomic_store_release(&dev->slot_tail, dev->slot_tail + 1);
+}
+
+uint8_t *sdr_lease_begin(sdr_dev_t *dev, sdr_event_t const *ev)
+{
+    if (!dev || !dev->slot_leases || !ev->leased)
+        return ev->buf;
+
+    lease_lock(dev);
+    unsigned slot      = dev->slot_tail % dev->slot_num;
+    sdr_lease_t *lease = &dev->slot_leases[slot];
+    uint8_t *buf       = ev->buf;
+    if (lease->state == LEASE_HELD)
+        lease->state = LEASE_IN_USE;
+    else if (lease->state == LEASE_COPIED)
+        buf = &dev->buffer[(size_t)slot * dev->slot_len];
+    lease_unlock(dev);
+    return buf;
+}
+
+unsigned sdr_get_dropped(sdr_dev_t *dev)
+{
+    if (!dev)
+        return 0;
+
+    return dev->dropped;
+}
+
 char const *sdr_get_dev_info(sdr_dev_t *dev)
 {
     if (!dev)
@@ -1170,10 +2555,21 @@ int sdr_set_center_freq(sdr_dev_t *dev, uint32_t freq, int verbose)
         r = rtltcp_command(dev, RTLTCP_SET_FREQ, freq);
     }
 
+    if (dev->synth) {
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+#endif
+        dev->center_frequency = freq;
+#ifdef THREADS
+        pthread_mutex_unlock(&dev->lock);
+#endif
+        r = 0;
+    }
+
 #ifdef SOAPYSDR
     SoapySDRKwargs args = {0};
     if (dev->soapy_dev) {
-        r = SoapySDRDevice_setFrequency(dev->soapy_dev, SOAPY_SDR_RX, 0, (double)freq, &args);
+        r = SoapySDRDevice_setFrequency(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, (double)freq, &args);
     }
 #endif
 
@@ -1191,10 +2587,16 @@ int sdr_set_center_freq(sdr_dev_t *dev, uint32_t freq, int verbose)
             print_logf(LOG_NOTICE, "SDR", "Tuned to %s.", nice_freq(sdr_get_center_freq(dev)));
     }
 
+    // the samples received until the PLL locked are from no defined frequency
+    struct timeval now;
+    get_time_now(&now);
+    int64_t settled_ns = (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_usec * 1000 + SDR_RETUNE_SETTLE_MS * 1000000;
+
 #ifdef THREADS
     pthread_mutex_lock(&dev->lock);
 #endif
     dev->center_frequency = freq;
+    dev->settled_ns       = settled_ns;
 #ifdef THREADS
     pthread_mutex_unlock(&dev->lock);
 #endif
@@ -1210,9 +2612,12 @@ uint32_t sdr_get_center_freq(sdr_dev_t *dev)
     if (dev->rtl_tcp)
         return dev->rtl_tcp_freq;
 
+    if (dev->synth)
+        return dev->center_frequency;
+
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        return (uint32_t)SoapySDRDevice_getFrequency(dev->soapy_dev, SOAPY_SDR_RX, 0);
+        return (uint32_t)SoapySDRDevice_getFrequency(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel);
 #endif
 
 #ifdef RTLSDR
@@ -1240,9 +2645,12 @@ int sdr_set_freq_correction(sdr_dev_t *dev, int ppm, int verbose)
     if (dev->rtl_tcp)
         r = rtltcp_command(dev, RTLTCP_SET_FREQ_CORRECTION, ppm);
 
+    if (dev->synth)
+        r = 0;
+
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        r = SoapySDRDevice_setFrequencyComponent(dev->soapy_dev, SOAPY_SDR_RX, 0, "CORR", (double)ppm, NULL);
+        r = SoapySDRDevice_setFrequencyComponent(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, "CORR", (double)ppm, NULL);
 #endif
 
 #ifdef RTLSDR
@@ -1279,9 +2687,12 @@ int sdr_set_auto_gain(sdr_dev_t *dev, int verbose)
     if (dev->rtl_tcp)
         r = rtltcp_command(dev, RTLTCP_SET_GAIN_MODE, 0);
 
+    if (dev->synth)
+        r = 0;
+
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        r = soapysdr_auto_gain(dev->soapy_dev, verbose);
+        r = soapysdr_auto_gain(dev->soapy_dev, dev->soapy_channel, verbose);
 #endif
 
 #ifdef RTLSDR
@@ -1320,7 +2731,7 @@ int sdr_set_tuner_gain(sdr_dev_t *dev, char const *gain_str, int verbose)
 #ifdef SOAPYSDR
     /* Enable manual gain */
     if (dev->soapy_dev)
-        return soapysdr_gain_str_set(dev->soapy_dev, gain_str, verbose);
+        return soapysdr_gain_str_set(dev->soapy_dev, dev->soapy_channel, gain_str, verbose);
 #endif
 
     int gain = (int)(atof(gain_str) * 10); /* tenths of a dB */
@@ -1334,6 +2745,12 @@ int sdr_set_tuner_gain(sdr_dev_t *dev, char const *gain_str, int verbose)
                 || rtltcp_command(dev, RTLTCP_SET_GAIN, gain);
     }
 
+    if (dev->synth) {
+        if (verbose)
+            print_log(LOG_NOTICE, "SDR", "The synthetic input has no gain.");
+        return 0;
+    }
+
 #ifdef RTLSDR
     /* Enable manual gain */
     r = rtlsdr_set_tuner_gain_mode(dev->rtlsdr_dev, 1);
@@ -1383,14 +2800,14 @@ int sdr_set_antenna(sdr_dev_t *dev, char const *antenna_str, int verbose)
 
 #ifdef SOAPYSDR
     if (dev->soapy_dev) {
-        r = SoapySDRDevice_setAntenna(dev->soapy_dev, SOAPY_SDR_RX, 0, antenna_str);
+        r = SoapySDRDevice_setAntenna(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, antenna_str);
 
         if (verbose) {
             if (r < 0)
                 print_log(LOG_WARNING, __func__, "Failed to set antenna.");
 
             // report the antenna that is actually used
-            char *antenna = SoapySDRDevice_getAntenna(dev->soapy_dev, SOAPY_SDR_RX, 0);
+            char *antenna = SoapySDRDevice_getAntenna(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel);
             print_logf(LOG_NOTICE, "SDR", "Antenna set to '%s'.", antenna);
             free(antenna);
         }
@@ -1423,9 +2840,24 @@ int sdr_set_sample_rate(sdr_dev_t *dev, uint32_t rate, int verbose)
         r = rtltcp_command(dev, RTLTCP_SET_SAMPLE_RATE, rate);
     }
 
+    if (dev->synth) {
+#ifdef THREADS
+        pthread_mutex_lock(&dev->lock);
+#endif
+        dev->sample_rate = rate;
+#ifdef THREADS
+        pthread_mutex_unlock(&dev->lock);
+#endif
+        r = 0;
+    }
+
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        r = SoapySDRDevice_setSampleRate(dev->soapy_dev, SOAPY_SDR_RX, 0, (double)rate);
+        r = SoapySDRDevice_setSampleRate(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, (double)rate);
+#ifdef THREADS
+    if (dev->soapy_group)
+        soapy_group_set_sample_rate(dev, rate);
+#endif
 #endif
 
 #ifdef RTLSDR
@@ -1459,9 +2891,12 @@ uint32_t sdr_get_sample_rate(sdr_dev_t *dev)
     if (dev->rtl_tcp)
         return dev->rtl_tcp_rate;
 
+    if (dev->synth)
+        return dev->sample_rate;
+
 #ifdef SOAPYSDR
     if (dev->soapy_dev)
-        return (uint32_t)SoapySDRDevice_getSampleRate(dev->soapy_dev, SOAPY_SDR_RX, 0);
+        return (uint32_t)SoapySDRDevice_getSampleRate(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel);
 #endif
 
 #ifdef RTLSDR
@@ -1525,14 +2960,14 @@ int sdr_apply_settings(sdr_dev_t *dev, char const *sdr_settings, int verbose)
                 print_logf(LOG_NOTICE, "SDR", "Setting %s to %s", key, value);
             }
             if (!strcmp(key, "antenna")) {
-                if (SoapySDRDevice_setAntenna(dev->soapy_dev, SOAPY_SDR_RX, 0, value) != 0) {
+                if (SoapySDRDevice_setAntenna(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, value) != 0) {
                     r = -1;
                     print_logf(LOG_WARNING, __func__, "Antenna setting failed: %s", SoapySDRDevice_lastError());
                 }
             }
             else if (!strcmp(key, "bandwidth")) {
                 uint32_t f_value = atouint32_metric(value, "-t bandwidth= ");
-                if (SoapySDRDevice_setBandwidth(dev->soapy_dev, SOAPY_SDR_RX, 0, (double)f_value) != 0) {
+                if (SoapySDRDevice_setBandwidth(dev->soapy_dev, SOAPY_SDR_RX, dev->soapy_channel, (double)f_value) != 0) {
                     r = -1;
                     print_logf(LOG_WARNING, __func__, "Bandwidth setting failed: %s", SoapySDRDevice_lastError());
                 }
@@ -1577,6 +3012,11 @@ int sdr_apply_settings(sdr_dev_t *dev, char const *sdr_settings, int verbose)
                 int biastee = atobv(val, 1);
                 r = rtlsdr_set_bias_tee(dev->rtlsdr_dev, biastee);
             }
+            else if (kwargs_match(sdr_settings, "zero_copy", &val)) {
+                // takes effect on the next sdr_start()
+                dev->rtlsdr_zero_copy = atobv(val, 1);
+                r = 0;
+            }
             else {
                 print_logf(LOG_ERROR, __func__, "Unknown RTLSDR setting: %s", sdr_settings);
                 return -1;
@@ -1598,7 +3038,8 @@ int sdr_activate(sdr_dev_t *dev)
         return -1;
 
 #ifdef SOAPYSDR
-    if (dev->soapy_dev) {
+    // the stream of a channel is activated once the channel is started
+    if (dev->soapy_dev && !dev->soapy_group) {
         if (SoapySDRDevice_activateStream(dev->soapy_dev, dev->soapy_stream, 0, 0, 0) != 0) {
             print_log(LOG_ERROR, __func__, "Failed to activate stream");
             exit(1);
@@ -1615,7 +3056,8 @@ int sdr_deactivate(sdr_dev_t *dev)
         return -1;
 
 #ifdef SOAPYSDR
-    if (dev->soapy_dev) {
+    // the stream of a channel is closed once the last channel is stopped
+    if (dev->soapy_dev && !dev->soapy_group) {
         SoapySDRDevice_deactivateStream(dev->soapy_dev, dev->soapy_stream, 0, 0);
         SoapySDRDevice_closeStream(dev->soapy_dev, dev->soapy_stream);
     }
@@ -1656,7 +3098,14 @@ int sdr_start_sync(sdr_dev_t *dev, sdr_event_cb_t cb, void *ctx, uint32_t buf_nu
     if (dev->rtl_tcp)
         return rtltcp_read_loop(dev, cb, ctx, buf_num, buf_len);
 
+    if (dev->synth)
+        return synth_read_loop(dev, cb, ctx, buf_num, buf_len);
+
 #ifdef SOAPYSDR
+    if (dev->soapy_group) {
+        print_log(LOG_ERROR, __func__, "The channels of a device are read by the device, use sdr_start().");
+        return -1;
+    }
     if (dev->soapy_dev)
         return soapysdr_read_loop(dev, cb, ctx, buf_num, buf_len);
 #endif
@@ -1674,7 +3123,7 @@ int sdr_stop_sync(sdr_dev_t *dev)
     if (!dev)
         return -1;
 
-    if (dev->rtl_tcp) {
+    if (dev->rtl_tcp || dev->synth) {
         dev->running = 0;
         return 0;
     }
@@ -1696,6 +3145,38 @@ int sdr_stop_sync(sdr_dev_t *dev)
     return -1;
 }
 
+int sdr_get_link_stats(sdr_dev_t *dev, sdr_link_stats_t *stats)
+{
+    if (!dev || !dev->rtl_tcp)
+        return -1;
+
+#ifdef THREADS
+    pthread_mutex_lock(&dev->lock);
+#endif
+    *stats = (sdr_link_stats_t){
+            .reconnecting = dev->rtl_tcp_reconnecting,
+            .reconnects   = dev->rtl_tcp_reconnects,
+            .samples_lost = dev->rtl_tcp_lost,
+    };
+    if (!dev->rtl_tcp_reconnecting) {
+        socklen_t len = sizeof(stats->rcvbuf);
+        getsockopt(dev->rtl_tcp, SOL_SOCKET, SO_RCVBUF, (char *)&stats->rcvbuf, &len);
+#if defined(__linux__) && defined(TCP_INFO)
+        // the receiving side only knows its own retransmits, i.e. of the commands and ACKs
+        struct tcp_info info;
+        len = sizeof(info);
+        if (getsockopt(dev->rtl_tcp, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) {
+            stats->retransmits = info.tcpi_total_retrans;
+            stats->rtt_us      = info.tcpi_rcv_rtt;
+        }
+#endif
+    }
+#ifdef THREADS
+    pthread_mutex_unlock(&dev->lock);
+#endif
+    return 0;
+}
+
 #ifdef SOAPYSDR
 static void soapysdr_log_handler(const SoapySDRLogLevel level, const char *message)
 {
@@ -1717,6 +3198,7 @@ void sdr_redirect_logging(void)
 static THREAD_RETURN THREAD_CALL acquire_thread(void *arg)
 {
     sdr_dev_t *dev = arg;
+    thread_sched_apply(THREAD_ROLE_ACQUIRE);
     print_log(LOG_DEBUG, __func__, "acquire_thread enter...");
 
     int r = sdr_start_sync(dev, dev->async_cb, dev->async_ctx, dev->buf_num, dev->buf_len);
@@ -1746,6 +3228,12 @@ int sdr_start(sdr_dev_t *dev, sdr_event_cb_t async_cb, void *async_ctx, uint32_t
     dev->buf_num = buf_num;
     dev->buf_len = buf_len;
 
+#ifdef SOAPYSDR
+    // the channels of a device are read by one thread
+    if (dev->soapy_group)
+        return soapy_group_start(dev, buf_num ? buf_num : SDR_DEFAULT_BUF_NUMBER, buf_len ? buf_len : SDR_DEFAULT_BUF_LENGTH);
+#endif
+
 #ifndef _WIN32
     // Block all signals from the worker thread
     sigset_t sigset;
@@ -1781,6 +3269,44 @@ int sdr_stop(sdr_dev_t *dev)
         return 0;
     }
     dev->exit_acquire = 1; // for rtl_tcp and SoapySDR
+    pthread_mutex_unlock(&dev->lock);
+
+    // leased transfer buffers are freed on cancel, copy the queued leases to the ring
+    // and wait a while for the consumer to finish the lease it uses
+    for (int i = 0; dev->slot_leases; ++i) {
+        int timeout = i * 10 >= LEASE_STOP_TIMEOUT_MS;
+        int in_use  = 0;
+        lease_lock(dev);
+        lease_expire(dev, 0);
+        for (unsigned s = 0; s < dev->slot_num; ++s) {
+            sdr_lease_t *lease = &dev->slot_leases[s];
+            if (lease->state != LEASE_IN_USE && lease->state != LEASE_OVERRUN)
+                continue;
+            in_use += 1;
+            // a consumer that never returns its lease must not hang the stop, the buffer is dropped
+            if (timeout && lease->state == LEASE_IN_USE) {
+                lease->state = LEASE_OVERRUN;
+                dev->dropped += 1;
+            }
+        }
+        lease_unlock(dev);
+        if (!in_use)
+            break;
+        if (timeout) {
+            print_logf(LOG_ERROR, __func__, "Dropped %d leased buffers still in use after %d ms.", in_use, LEASE_STOP_TIMEOUT_MS);
+            break;
+        }
+        if (i == 100)
+            print_log(LOG_WARNING, __func__, "Waiting for a leased buffer still in use.");
+        usleep(10000);
+    }
+
+#ifdef SOAPYSDR
+    if (dev->soapy_group)
+        return soapy_group_stop(dev);
+#endif
+
+    pthread_mutex_lock(&dev->lock);
     sdr_stop_sync(dev); // for rtlsdr
     pthread_mutex_unlock(&dev->lock);
 
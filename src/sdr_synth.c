@@ -0,0 +1,480 @@
+/** @file
+    Synthetic input: the bursts of simulated sensors in noise, for load tests.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "sdr_synth.h"
+
+#include "pulse_data.h"
+#include "bit_util.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// Most bursts on the air at once, a message past it is skipped.
+#define SYNTH_MAX_BURSTS 64
+/// Samples of the noise table, a power of two.
+#define SYNTH_NOISE_SIZE 16384
+/// Longest message in bytes.
+#define SYNTH_MAX_BYTES 32
+/// Carrier offsets of the sensors, up to this fraction of the sample rate.
+#define SYNTH_OFFSET_RATIO 0.125f
+/// FSK deviation in Hz.
+#define SYNTH_FSK_DEVIATION 30000.0f
+
+typedef struct synth_sensor synth_sensor_t;
+
+typedef struct {
+    char const *name;
+    int fsk;          ///< FSK PCM, otherwise OOK PPM
+    int pulse_us;     ///< the OOK pulse, the FSK bit
+    int zero_us;      ///< the OOK gap of a 0 bit
+    int one_us;       ///< the OOK gap of a 1 bit
+    int sync_us;      ///< the gap between the repeats
+    unsigned repeats; ///< the message is sent this many times
+    unsigned (*encode)(synth_sensor_t const *sensor, uint8_t *bits); ///< the bits of the message, returns the number of bits
+} synth_template_t;
+
+struct synth_sensor {
+    synth_template_t const *tmpl;
+    uint32_t id;
+    int channel;       ///< 1 to 3
+    int temperature;   ///< in 0.1 C, wanders by each message
+    int humidity;      ///< in %
+    float amplitude;   ///< full scale is 1
+    float offset;      ///< the carrier offset, -1 to 1 of the offset range
+    uint64_t next_tx;  ///< the sample of the next message
+};
+
+typedef struct {
+    int active;
+    int fsk;
+    pulse_data_t pulses; ///< the pulse and gap widths in samples, for FSK the mark and space runs
+    uint64_t pos;        ///< the sample of the cursor
+    unsigned index;      ///< the pulse of the cursor
+    int in_gap;          ///< the cursor is in the gap of the pulse
+    int left;            ///< samples left of the pulse or gap
+    float amplitude;
+    float freq;      ///< the carrier in cycles a sample
+    float deviation; ///< the FSK deviation in cycles a sample
+    float re, im;    ///< the carrier phase
+} synth_burst_t;
+
+struct sdr_synth {
+    sdr_synth_opts_t opts;
+    uint32_t rng;
+    synth_sensor_t *sensors;
+    synth_burst_t bursts[SYNTH_MAX_BURSTS];
+    float noise[2 * SYNTH_NOISE_SIZE];
+    float *acc; ///< the I/Q sums of a block
+    unsigned acc_size;
+    uint64_t pos; ///< the sample count so far
+    int started;  ///< the sensors are scheduled
+    unsigned sent;
+    unsigned skipped;
+};
+
+/* Templates */
+
+// Nexus-TH: id, battery, channel, 12 bit temperature, const 1111, humidity
+static unsigned encode_nexus(synth_sensor_t const *sensor, uint8_t *bits)
+{
+    unsigned temp = (unsigned)sensor->temperature & 0xfff;
+    bits[0]       = sensor->id & 0xff;
+    bits[1]       = 0x80 | (sensor->channel - 1) << 4 | temp >> 8;
+    bits[2]       = temp & 0xff;
+    bits[3]       = 0xf0 | sensor->humidity >> 4;
+    bits[4]       = (sensor->humidity & 0x0f) << 4;
+    return 36;
+}
+
+// Acurite 606TX: id, battery, channel, 12 bit temperature, LFSR digest
+static unsigned encode_acurite(synth_sensor_t const *sensor, uint8_t *bits)
+{
+    unsigned temp = (unsigned)sensor->temperature & 0xfff;
+    bits[0]       = sensor->id & 0xff;
+    bits[1]       = 0x80 | (sensor->channel - 1) << 4 | temp >> 8;
+    bits[2]       = temp & 0xff;
+    bits[3]       = lfsr_digest8(bits, 3, 0x98, 0xf1);
+    return 32;
+}
+
+// append a bit to a message
+static void put_bit(uint8_t *bits, unsigned *n, int bit)
+{
+    if (bit)
+        bits[*n / 8] |= 0x80 >> (*n % 8);
+    else
+        bits[*n / 8] &= ~(0x80 >> (*n % 8));
+    (*n)++;
+}
+
+// Ford TPMS: preamble 55 55 55 56, then Manchester coded id, pressure, temperature, flags, and sum
+static unsigned encode_tpms(synth_sensor_t const *sensor, uint8_t *bits)
+{
+    uint8_t b[8];
+    b[0] = sensor->id >> 24;
+    b[1] = sensor->id >> 16;
+    b[2] = sensor->id >> 8;
+    b[3] = sensor->id;
+    b[4] = 128 + sensor->humidity % 16; // 32 to 36 PSI
+    b[5] = (sensor->temperature / 10 + 56) & 0x7f;
+    b[6] = 0x04; // at rest
+    b[7] = add_bytes(b, 7);
+
+    unsigned n = 0;
+    uint8_t const preamble[4] = {0x55, 0x55, 0x55, 0x56};
+    for (unsigned i = 0; i < 32; ++i)
+        put_bit(bits, &n, preamble[i / 8] >> (7 - i % 8) & 1);
+    // the decoder inverts the bits, a 0 is sent as 01 and a 1 as 10
+    for (unsigned i = 0; i < 64; ++i) {
+        int bit = b[i / 8] >> (7 - i % 8) & 1;
+        put_bit(bits, &n, bit);
+        put_bit(bits, &n, !bit);
+    }
+    return n;
+}
+
+static synth_template_t const templates[] = {
+        {"nexus", 0, 500, 1000, 2000, 4000, 12, encode_nexus},
+        {"acurite", 0, 500, 2000, 4000, 8500, 6, encode_acurite},
+        {"tpms", 1, 52, 0, 0, 5000, 4, encode_tpms},
+};
+
+#define SYNTH_TEMPLATES (sizeof(templates) / sizeof(*templates))
+
+/* Generator */
+
+static uint32_t next_random(sdr_synth_t *synth)
+{
+    // xorshift32
+    uint32_t x = synth->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    synth->rng = x;
+    return x;
+}
+
+// uniform in [0, 1)
+static float next_uniform(sdr_synth_t *synth)
+{
+    return (next_random(synth) >> 8) * (1.0f / 16777216.0f);
+}
+
+// the templates of the mix, returns the count, 0 on an unknown name
+static unsigned parse_mix(char const *mix, synth_template_t const **out)
+{
+    if (!mix || !*mix) {
+        for (unsigned i = 0; i < SYNTH_TEMPLATES; ++i)
+            out[i] = &templates[i];
+        return SYNTH_TEMPLATES;
+    }
+    unsigned count = 0;
+    while (*mix) {
+        size_t len = strcspn(mix, ",+");
+        unsigned i = 0;
+        while (i < SYNTH_TEMPLATES && (strlen(templates[i].name) != len || strncmp(templates[i].name, mix, len)))
+            ++i;
+        if (i == SYNTH_TEMPLATES) {
+            print_logf(LOG_ERROR, "SDR", "Unknown synthetic sensor \"%.*s\", use nexus, acurite, or tpms.", (int)len, mix);
+            return 0;
+        }
+        if (count < SYNTH_TEMPLATES)
+            out[count++] = &templates[i];
+        mix += len;
+        if (*mix)
+            mix++;
+    }
+    return count;
+}
+
+sdr_synth_t *sdr_synth_create(sdr_synth_opts_t const *opts)
+{
+    sdr_synth_t *synth = calloc(1, sizeof(*synth));
+    if (!synth) {
+        WARN_CALLOC("sdr_synth_create()");
+        return NULL;
+    }
+    if (opts)
+        synth->opts = *opts;
+    sdr_synth_opts_t *o = &synth->opts;
+    o->sensors          = o->sensors ? o->sensors : 100;
+    o->every_ms         = o->every_ms ? o->every_ms : 30000;
+    o->noise_db         = o->noise_db != 0.0f ? o->noise_db : -40.0f;
+    o->level_db         = o->level_db != 0.0f ? o->level_db : -6.0f;
+    o->seed             = o->seed ? o->seed : 1;
+    o->mix              = NULL; // not kept
+    // spread the seed, xorshift starts slowly from small seeds
+    uint32_t h = o->seed * 0x9e3779b9u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    synth->rng = h ? h : 1;
+
+    synth_template_t const *mix[SYNTH_TEMPLATES];
+    unsigned mix_count = parse_mix(opts ? opts->mix : NULL, mix);
+    if (!mix_count) {
+        free(synth);
+        return NULL;
+    }
+
+    synth->sensors = calloc(o->sensors, sizeof(*synth->sensors));
+    if (!synth->sensors) {
+        WARN_CALLOC("sdr_synth_create()");
+        free(synth);
+        return NULL;
+    }
+    for (unsigned i = 0; i < o->sensors; ++i) {
+        synth_sensor_t *sensor = &synth->sensors[i];
+        sensor->tmpl           = mix[i % mix_count];
+        sensor->id             = next_random(synth);
+        sensor->channel        = 1 + (int)(next_random(synth) % 3);
+        sensor->temperature    = -100 + (int)(next_random(synth) % 400);
+        sensor->humidity       = 20 + (int)(next_random(synth) % 70);
+        sensor->amplitude      = powf(10.0f, (o->level_db - 12.0f * next_uniform(synth)) / 20.0f);
+        sensor->offset         = 2.0f * next_uniform(synth) - 1.0f;
+    }
+
+    // gaussian noise, Box-Muller
+    float sigma = powf(10.0f, o->noise_db / 20.0f);
+    for (unsigned i = 0; i < SYNTH_NOISE_SIZE; ++i) {
+        float u1 = next_uniform(synth) + 1e-7f;
+        float u2 = next_uniform(synth);
+        float r  = sigma * sqrtf(-2.0f * logf(u1));
+        synth->noise[2 * i]     = r * cosf(2.0f * (float)M_PI * u2);
+        synth->noise[2 * i + 1] = r * sinf(2.0f * (float)M_PI * u2);
+    }
+    return synth;
+}
+
+void sdr_synth_free(sdr_synth_t *synth)
+{
+    if (!synth)
+        return;
+    for (unsigned i = 0; i < SYNTH_MAX_BURSTS; ++i)
+        pulse_data_free(&synth->bursts[i].pulses);
+    free(synth->sensors);
+    free(synth->acc);
+    free(synth);
+}
+
+unsigned sdr_synth_sent(sdr_synth_t const *synth)
+{
+    return synth ? synth->sent : 0;
+}
+
+unsigned sdr_synth_skipped(sdr_synth_t const *synth)
+{
+    return synth ? synth->skipped : 0;
+}
+
+static synth_burst_t *start_burst(sdr_synth_t *synth, synth_sensor_t const *sensor, uint64_t start, uint32_t sample_rate)
+{
+    for (unsigned i = 0; i < SYNTH_MAX_BURSTS; ++i) {
+        synth_burst_t *burst = &synth->bursts[i];
+        if (burst->active)
+            continue;
+        pulse_data_clear(&burst->pulses);
+        burst->pulses.sample_rate = sample_rate;
+        burst->active             = 1;
+        burst->fsk                = sensor->tmpl->fsk;
+        burst->pos                = start;
+        burst->index              = 0;
+        burst->in_gap             = 0;
+        burst->left               = 0;
+        burst->amplitude          = sensor->amplitude;
+        burst->freq               = sensor->offset * SYNTH_OFFSET_RATIO;
+        burst->deviation          = SYNTH_FSK_DEVIATION / sample_rate;
+        burst->re                 = 1.0f;
+        burst->im                 = 0.0f;
+        return burst;
+    }
+    return NULL;
+}
+
+static void add_pulse(pulse_data_t *pulses, int pulse, int gap)
+{
+    pulse_data_reserve(pulses, pulses->num_pulses + 1);
+    pulses->pulse[pulses->num_pulses] = pulse;
+    pulses->gap[pulses->num_pulses]   = gap;
+    pulses->num_pulses++;
+}
+
+// the bursts of a message, an OOK message is one burst, each FSK repeat is a burst of its own
+static void transmit(sdr_synth_t *synth, synth_sensor_t *sensor, uint64_t start, uint32_t sample_rate)
+{
+    synth_template_t const *tmpl = sensor->tmpl;
+    uint8_t bits[SYNTH_MAX_BYTES] = {0};
+    unsigned num_bits = tmpl->encode(sensor, bits);
+
+    int pulse_len = (int)((int64_t)tmpl->pulse_us * sample_rate / 1000000);
+    int zero_len  = (int)((int64_t)tmpl->zero_us * sample_rate / 1000000);
+    int one_len   = (int)((int64_t)tmpl->one_us * sample_rate / 1000000);
+    int sync_len  = (int)((int64_t)tmpl->sync_us * sample_rate / 1000000);
+
+    synth_burst_t *burst = NULL;
+    for (unsigned r = 0; r < tmpl->repeats; ++r) {
+        if (!burst) {
+            burst = start_burst(synth, sensor, start, sample_rate);
+            if (!burst) {
+                synth->skipped++;
+                return;
+            }
+        }
+        pulse_data_t *pulses = &burst->pulses;
+        if (!tmpl->fsk) {
+            // each bit is the gap after a pulse, a last pulse ends the repeat
+            for (unsigned i = 0; i < num_bits; ++i) {
+                int bit = bits[i / 8] >> (7 - i % 8) & 1;
+                add_pulse(pulses, pulse_len, bit ? one_len : zero_len);
+            }
+            add_pulse(pulses, pulse_len, sync_len);
+            continue;
+        }
+        // the runs of marks and spaces, a message starting with a space has an empty first mark
+        unsigned i = 0;
+        while (i < num_bits) {
+            int mark = 0, space = 0;
+            for (; i < num_bits && (bits[i / 8] >> (7 - i % 8) & 1); ++i)
+                mark += pulse_len;
+            for (; i < num_bits && !(bits[i / 8] >> (7 - i % 8) & 1); ++i)
+                space += pulse_len;
+            add_pulse(pulses, mark, space);
+        }
+        start += (uint64_t)num_bits * pulse_len + sync_len;
+        burst = NULL;
+    }
+    if (burst)
+        burst->pulses.gap[burst->pulses.num_pulses - 1] = 0; // the carrier ends with the last pulse
+    synth->sent++;
+
+    // the readings wander between the messages
+    sensor->temperature += (int)(next_random(synth) % 3) - 1;
+}
+
+// render a burst into the block, returns 0 once the burst ended
+static int render_burst(sdr_synth_t *synth, synth_burst_t *burst, uint64_t block_start, unsigned n_samples)
+{
+    uint64_t block_end = block_start + n_samples;
+    pulse_data_t const *pulses = &burst->pulses;
+    if (burst->pos >= block_end)
+        return 1; // not yet started
+
+    while (burst->pos < block_end) {
+        if (burst->left <= 0) {
+            if (burst->index >= pulses->num_pulses)
+                return 0;
+            burst->left = burst->in_gap ? pulses->gap[burst->index] : pulses->pulse[burst->index];
+            if (burst->left <= 0) {
+                // an empty first mark or last gap
+                if (burst->in_gap)
+                    burst->index++;
+                burst->in_gap = !burst->in_gap;
+                continue;
+            }
+        }
+        unsigned len = (unsigned)burst->left;
+        if (burst->pos + len > block_end)
+            len = (unsigned)(block_end - burst->pos);
+
+        // OOK is off in the gaps, FSK sends the space frequency
+        int on = !burst->in_gap || burst->fsk;
+        if (on) {
+            float freq = burst->freq;
+            if (burst->fsk)
+                freq += burst->in_gap ? -burst->deviation : burst->deviation;
+            float c  = cosf(2.0f * (float)M_PI * freq);
+            float s  = sinf(2.0f * (float)M_PI * freq);
+            float re = burst->re, im = burst->im;
+            float a  = burst->amplitude;
+            float *acc = &synth->acc[2 * (burst->pos - block_start)];
+            for (unsigned k = 0; k < len; ++k) {
+                acc[2 * k] += a * re;
+                acc[2 * k + 1] += a * im;
+                float t = re * c - im * s;
+                im      = re * s + im * c;
+                re      = t;
+            }
+            // keep the phasor on the unit circle
+            float m   = 1.0f / sqrtf(re * re + im * im);
+            burst->re = re * m;
+            burst->im = im * m;
+        }
+        burst->pos += len;
+        burst->left -= (int)len;
+        if (burst->left <= 0) {
+            if (burst->in_gap)
+                burst->index++;
+            burst->in_gap = !burst->in_gap;
+        }
+    }
+    return 1;
+}
+
+void sdr_synth_fill(sdr_synth_t *synth, uint8_t *buf, unsigned n_samples, uint32_t sample_rate)
+{
+    if (!n_samples || !sample_rate)
+        return;
+    if (synth->acc_size < n_samples) {
+        float *acc = realloc(synth->acc, 2 * sizeof(*acc) * n_samples);
+        if (!acc) {
+            WARN_REALLOC("sdr_synth_fill()");
+            memset(buf, 128, 2 * (size_t)n_samples);
+            return;
+        }
+        synth->acc      = acc;
+        synth->acc_size = n_samples;
+    }
+
+    uint64_t every = (uint64_t)synth->opts.every_ms * sample_rate / 1000;
+    if (!synth->started) {
+        // the sensors start at random phases of their interval
+        for (unsigned i = 0; i < synth->opts.sensors; ++i)
+            synth->sensors[i].next_tx = synth->pos + (uint64_t)(next_uniform(synth) * every);
+        synth->started = 1;
+    }
+
+    // the noise floor, from a random part of the table
+    unsigned offset = next_random(synth) % SYNTH_NOISE_SIZE;
+    for (unsigned k = 0; k < n_samples; ++k) {
+        unsigned i             = (offset + k) % SYNTH_NOISE_SIZE;
+        synth->acc[2 * k]     = synth->noise[2 * i];
+        synth->acc[2 * k + 1] = synth->noise[2 * i + 1];
+    }
+
+    uint64_t block_end = synth->pos + n_samples;
+    for (unsigned i = 0; i < synth->opts.sensors; ++i) {
+        synth_sensor_t *sensor = &synth->sensors[i];
+        while (sensor->next_tx < block_end) {
+            transmit(synth, sensor, sensor->next_tx, sample_rate);
+            // each interval varies by 10%
+            sensor->next_tx += every * 9 / 10 + (uint64_t)(next_uniform(synth) * every / 5) + 1;
+        }
+    }
+
+    for (unsigned i = 0; i < SYNTH_MAX_BURSTS; ++i) {
+        synth_burst_t *burst = &synth->bursts[i];
+        if (burst->active && !render_burst(synth, burst, synth->pos, n_samples))
+            burst->active = 0;
+    }
+
+    for (unsigned k = 0; k < 2 * n_samples; ++k) {
+        float v = 127.5f + 127.5f * synth->acc[k];
+        buf[k]  = v <= 0.0f ? 0 : v >= 255.0f ? 255 : (uint8_t)(v + 0.5f);
+    }
+    synth->pos = block_end;
+}
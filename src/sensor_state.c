@@ -0,0 +1,261 @@
+/** @file
+    Last-known state of each sensor, the latest event kept for queries.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "sensor_state.h"
+
+#include "compat_atomic.h"
+#include "data.h"
+#include "fatal.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Length of the time of an event kept, e.g. "2026-10-15 12:34:56.123456".
+#define SENSOR_TIME_LEN 32
+
+typedef struct {
+    uint64_t hash; ///< the sensor
+    data_t *data;  ///< the latest event, retained
+    char time[SENSOR_TIME_LEN];
+    float rssi_db;
+    float snr_db;
+    unsigned count;
+    int chain; ///< the next entry of the bucket, -1 at the end
+    int newer; ///< the entry heard next, -1 for the newest
+    int older; ///< the entry heard before, -1 for the oldest
+} sensor_entry_t;
+
+struct sensor_state {
+    unsigned lock;
+    unsigned max_sensors;
+    unsigned used;
+    unsigned mask;    ///< buckets minus one, a power of two minus one
+    int *buckets;     ///< the first entry of each bucket, -1 if empty
+    sensor_entry_t *entries;
+    int newest;
+    int oldest;
+    unsigned evicted;
+};
+
+static uint64_t str_hash(char const *str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (; *str; ++str) {
+        hash = (hash ^ (unsigned char)*str) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static int find_entry(sensor_state_t *state, uint64_t hash)
+{
+    int i = state->buckets[hash & state->mask];
+    while (i >= 0 && state->entries[i].hash != hash) {
+        i = state->entries[i].chain;
+    }
+    return i;
+}
+
+static void lru_unlink(sensor_state_t *state, int i)
+{
+    sensor_entry_t *entry = &state->entries[i];
+    if (entry->newer >= 0)
+        state->entries[entry->newer].older = entry->older;
+    else
+        state->newest = entry->older;
+    if (entry->older >= 0)
+        state->entries[entry->older].newer = entry->newer;
+    else
+        state->oldest = entry->newer;
+}
+
+static void lru_push(sensor_state_t *state, int i)
+{
+    sensor_entry_t *entry = &state->entries[i];
+    entry->newer = -1;
+    entry->older = state->newest;
+    if (state->newest >= 0)
+        state->entries[state->newest].newer = i;
+    else
+        state->oldest = i;
+    state->newest = i;
+}
+
+static void bucket_unlink(sensor_state_t *state, int i)
+{
+    int *link = &state->buckets[state->entries[i].hash & state->mask];
+    while (*link != i) {
+        link = &state->entries[*link].chain;
+    }
+    *link = state->entries[i].chain;
+}
+
+sensor_state_t *sensor_state_create(unsigned max_sensors)
+{
+    if (!max_sensors)
+        return NULL;
+
+    sensor_state_t *state = calloc(1, sizeof(*state));
+    if (!state) {
+        WARN_CALLOC("sensor_state_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    // at most half a sensor per bucket
+    unsigned buckets = 64;
+    while (buckets < max_sensors * 2) {
+        buckets *= 2;
+    }
+    state->buckets = malloc(buckets * sizeof(*state->buckets));
+    if (!state->buckets) {
+        WARN_MALLOC("sensor_state_create()");
+        free(state);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    state->entries = calloc(max_sensors, sizeof(*state->entries));
+    if (!state->entries) {
+        WARN_CALLOC("sensor_state_create()");
+        free(state->buckets);
+        free(state);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    for (unsigned i = 0; i < buckets; ++i) {
+        state->buckets[i] = -1;
+    }
+    state->max_sensors = max_sensors;
+    state->mask        = buckets - 1;
+    state->newest      = -1;
+    state->oldest      = -1;
+    return state;
+}
+
+void sensor_state_free(sensor_state_t *state)
+{
+    if (!state)
+        return;
+    for (unsigned i = 0; i < state->used; ++i) {
+        data_free(state->entries[i].data);
+    }
+    free(state->entries);
+    free(state->buckets);
+    free(state);
+}
+
+void sensor_state_update(sensor_state_t *state, char const *key, data_t *data, char const *time_str, float rssi_db, float snr_db)
+{
+    uint64_t hash = str_hash(key);
+    data_t *old   = NULL;
+
+    atomic_spin_lock(&state->lock);
+    int i = find_entry(state, hash);
+    if (i >= 0) {
+        lru_unlink(state, i);
+        old = state->entries[i].data;
+    }
+    else if (state->used < state->max_sensors) {
+        i = (int)state->used++;
+        state->entries[i] = (sensor_entry_t){.hash = hash};
+    }
+    else {
+        // the sensor not heard the longest makes room
+        i = state->oldest;
+        lru_unlink(state, i);
+        bucket_unlink(state, i);
+        old               = state->entries[i].data;
+        state->entries[i] = (sensor_entry_t){.hash = hash};
+        state->evicted++;
+    }
+    sensor_entry_t *entry = &state->entries[i];
+    if (!entry->count) {
+        entry->chain                       = state->buckets[hash & state->mask];
+        state->buckets[hash & state->mask] = i;
+    }
+    entry->data    = data_retain(data);
+    entry->rssi_db = rssi_db;
+    entry->snr_db  = snr_db;
+    entry->count++;
+    snprintf(entry->time, sizeof(entry->time), "%s", time_str);
+    lru_push(state, i);
+    atomic_spin_unlock(&state->lock);
+
+    data_free(old); // the outputs may still hold the event
+}
+
+data_t *sensor_state_data(sensor_state_t *state)
+{
+    // copy the entries, the snapshot is made without holding up the decoders
+    atomic_spin_lock(&state->lock);
+    unsigned used           = state->used;
+    unsigned evicted        = state->evicted;
+    sensor_entry_t *entries = malloc((used ? used : 1) * sizeof(*entries));
+    if (!entries) {
+        atomic_spin_unlock(&state->lock);
+        WARN_MALLOC("sensor_state_data()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    unsigned n = 0;
+    for (int i = state->newest; i >= 0; i = state->entries[i].older) {
+        entries[n]      = state->entries[i];
+        entries[n].data = data_retain(state->entries[i].data);
+        n++;
+    }
+    atomic_spin_unlock(&state->lock);
+
+    data_t **sensors = calloc(n ? n : 1, sizeof(*sensors));
+    if (!sensors) {
+        WARN_CALLOC("sensor_state_data()");
+        for (unsigned k = 0; k < n; ++k) {
+            data_free(entries[k].data);
+        }
+        free(entries);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    for (unsigned k = 0; k < n; ++k) {
+        sensor_entry_t const *entry = &entries[k];
+        /* clang-format off */
+        sensors[k] = data_make(
+                "time",     "", DATA_STRING, entry->time,
+                "count",    "", DATA_INT,    (int)entry->count,
+                "rssi",     "", DATA_DOUBLE, round(entry->rssi_db * 10.0) / 10.0,
+                "snr",      "", DATA_DOUBLE, round(entry->snr_db * 10.0) / 10.0,
+                "event",    "", DATA_DATA,   entry->data,
+                NULL);
+        /* clang-format on */
+    }
+    free(entries);
+
+    /* clang-format off */
+    data_t *data = data_make(
+            "count",        "", DATA_INT, (int)n,
+            "max",          "", DATA_INT, (int)state->max_sensors,
+            "evicted",      "", DATA_INT, (int)evicted,
+            "devices",      "", DATA_ARRAY, data_array((int)n, DATA_DATA, sensors),
+            NULL);
+    /* clang-format on */
+    free(sensors);
+    return data;
+}
+
+unsigned sensor_state_sensors(sensor_state_t *state)
+{
+    atomic_spin_lock(&state->lock);
+    unsigned used = state->used;
+    atomic_spin_unlock(&state->lock);
+    return used;
+}
+
+unsigned sensor_state_evicted(sensor_state_t *state)
+{
+    atomic_spin_lock(&state->lock);
+    unsigned evicted = state->evicted;
+    atomic_spin_unlock(&state->lock);
+    return evicted;
+}
@@ -0,0 +1,238 @@
+/** @file
+    SigMF recording meta data.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "sigmf.h"
+
+#include "jsmn.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIGMF_DATA_EXT ".sigmf-data"
+#define SIGMF_META_EXT ".sigmf-meta"
+/// The meta data read, larger meta data would only add annotations.
+#define SIGMF_META_MAX (1024 * 1024)
+
+static struct {
+    uint32_t format;
+    char const *datatype;
+} const sigmf_datatypes[] = {
+        {CU8_IQ, "cu8"},
+        {CS8_IQ, "ci8"},
+        {CS16_IQ, "ci16_le"},
+        {CF32_IQ, "cf32_le"},
+};
+
+char const *sigmf_datatype(uint32_t format)
+{
+    for (size_t i = 0; i < sizeof(sigmf_datatypes) / sizeof(*sigmf_datatypes); ++i) {
+        if (sigmf_datatypes[i].format == format)
+            return sigmf_datatypes[i].datatype;
+    }
+    return NULL;
+}
+
+static int has_suffix(char const *str, char const *suffix)
+{
+    size_t len     = strlen(str);
+    size_t sfx_len = strlen(suffix);
+    return len >= sfx_len && !strcmp(str + len - sfx_len, suffix);
+}
+
+void sigmf_data_path(char *path)
+{
+    if (has_suffix(path, SIGMF_META_EXT))
+        memcpy(path + strlen(path) - strlen(SIGMF_META_EXT), SIGMF_DATA_EXT, strlen(SIGMF_DATA_EXT));
+}
+
+// the meta file next to a data file, or the data path with the meta extension appended
+static char *meta_path(char const *path)
+{
+    size_t len = strlen(path);
+    if (has_suffix(path, SIGMF_DATA_EXT))
+        len -= strlen(SIGMF_DATA_EXT);
+    else if (has_suffix(path, SIGMF_META_EXT))
+        len -= strlen(SIGMF_META_EXT);
+    char *meta = malloc(len + strlen(SIGMF_META_EXT) + 1);
+    if (!meta) {
+        WARN_MALLOC("sigmf meta_path()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    memcpy(meta, path, len);
+    strcpy(meta + len, SIGMF_META_EXT); // NOLINT
+    return meta;
+}
+
+// index of the token after the value at i, including all nested tokens
+static int json_skip(jsmntok_t const *tok, int toks, int i)
+{
+    int pending = 1;
+    while (pending > 0 && i < toks) {
+        if (tok[i].type == JSMN_OBJECT)
+            pending += tok[i].size * 2; // keys and values
+        else if (tok[i].type == JSMN_ARRAY)
+            pending += tok[i].size;
+        pending -= 1;
+        i += 1;
+    }
+    return i;
+}
+
+static int json_eq(char const *json, jsmntok_t const *tok, char const *str)
+{
+    int len = tok->end - tok->start;
+    return tok->type == JSMN_STRING && (int)strlen(str) == len && !strncmp(json + tok->start, str, len);
+}
+
+// find the value of a key in the object at i, -1 if there is none
+static int json_find(char const *json, jsmntok_t const *tok, int toks, int i, char const *key)
+{
+    if (i < 0 || i >= toks || tok[i].type != JSMN_OBJECT)
+        return -1;
+    int keys = tok[i].size;
+    i += 1;
+    for (int k = 0; k < keys && i + 1 < toks; ++k) {
+        if (json_eq(json, &tok[i], key))
+            return i + 1;
+        i = json_skip(tok, toks, i + 1);
+    }
+    return -1;
+}
+
+static double json_number(char const *json, jsmntok_t const *tok, int i)
+{
+    if (i < 0 || tok[i].type != JSMN_PRIMITIVE)
+        return 0.0;
+    return strtod(json + tok[i].start, NULL);
+}
+
+int sigmf_read_meta(file_info_t *info)
+{
+    char *path = meta_path(info->path);
+    if (!path)
+        return -1;
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        print_logf(LOG_ERROR, "SigMF", "Opening meta data \"%s\" failed!", path);
+        free(path);
+        return -1;
+    }
+    char *json = malloc(SIGMF_META_MAX);
+    if (!json) {
+        WARN_MALLOC("sigmf_read_meta()");
+        fclose(file);
+        free(path);
+        return -1;
+    }
+    size_t len = fread(json, 1, SIGMF_META_MAX - 1, file);
+    json[len]  = '\0';
+    fclose(file);
+
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    // count the tokens first, the meta data has no fixed size
+    int toks = jsmn_parse(&parser, json, len, NULL, 0);
+    jsmntok_t *tok = calloc(toks > 0 ? toks : 1, sizeof(*tok));
+    if (!tok) {
+        WARN_CALLOC("sigmf_read_meta()");
+        free(json);
+        free(path);
+        return -1;
+    }
+    if (toks > 0) {
+        jsmn_init(&parser);
+        toks = jsmn_parse(&parser, json, len, tok, toks);
+    }
+    if (toks < 1 || tok[0].type != JSMN_OBJECT) {
+        print_logf(LOG_ERROR, "SigMF", "Invalid meta data \"%s\"", path);
+        free(tok);
+        free(json);
+        free(path);
+        return -1;
+    }
+
+    int global   = json_find(json, tok, toks, 0, "global");
+    int datatype = json_find(json, tok, toks, global, "core:datatype");
+    int rate     = json_find(json, tok, toks, global, "core:sample_rate");
+    int captures = json_find(json, tok, toks, 0, "captures");
+    // the first capture starts the recording
+    int capture = captures >= 0 && tok[captures].type == JSMN_ARRAY && tok[captures].size > 0 ? captures + 1 : -1;
+    int freq    = json_find(json, tok, toks, capture, "core:frequency");
+
+    uint32_t format = 0;
+    for (size_t i = 0; datatype >= 0 && i < sizeof(sigmf_datatypes) / sizeof(*sigmf_datatypes); ++i) {
+        if (json_eq(json, &tok[datatype], sigmf_datatypes[i].datatype))
+            format = sigmf_datatypes[i].format;
+    }
+    int ret = 0;
+    if (!format) {
+        print_logf(LOG_ERROR, "SigMF", "Datatype \"%.*s\" of \"%s\" is not supported",
+                datatype >= 0 ? tok[datatype].end - tok[datatype].start : 0, datatype >= 0 ? json + tok[datatype].start : "", path);
+        ret = -1;
+    }
+    else {
+        info->format = format;
+        if (rate >= 0)
+            info->sample_rate = (uint32_t)json_number(json, tok, rate);
+        if (freq >= 0)
+            info->center_frequency = (uint32_t)json_number(json, tok, freq);
+    }
+
+    free(tok);
+    free(json);
+    free(path);
+    return ret;
+}
+
+int sigmf_write_meta(file_info_t const *info, uint32_t sample_rate, uint32_t center_frequency)
+{
+    char const *datatype = sigmf_datatype(info->format);
+    if (!datatype)
+        return -1;
+    char *path = meta_path(info->path);
+    if (!path)
+        return -1;
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        print_logf(LOG_ERROR, "SigMF", "Writing meta data \"%s\" failed!", path);
+        free(path);
+        return -1;
+    }
+
+    int ret = fprintf(file,
+            "{\n"
+            "    \"global\": {\n"
+            "        \"core:datatype\": \"%s\",\n"
+            "        \"core:sample_rate\": %u,\n"
+            "        \"core:version\": \"1.0.0\",\n"
+            "        \"core:recorder\": \"rtl_433\"\n"
+            "    },\n"
+            "    \"captures\": [\n"
+            "        {\n"
+            "            \"core:sample_start\": 0,\n"
+            "            \"core:frequency\": %u\n"
+            "        }\n"
+            "    ],\n"
+            "    \"annotations\": []\n"
+            "}\n",
+            datatype, sample_rate, center_frequency);
+    if (fclose(file) != 0 || ret < 0) {
+        print_logf(LOG_ERROR, "SigMF", "Writing meta data \"%s\" failed!", path);
+        free(path);
+        return -1;
+    }
+
+    free(path);
+    return 0;
+}
@@ -0,0 +1,225 @@
+/** @file
+    FFT spectrum occupancy monitor.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "spectrum.h"
+
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// Adjacent bins the power is averaged over, a single FFT bin of noise varies too much to threshold.
+#define SPECTRUM_SMOOTH 4
+/// Frames the noise floor follows the unoccupied levels over.
+#define SPECTRUM_NOISE_FALL 64
+/// Frames the noise floor takes to follow a lasting carrier.
+#define SPECTRUM_NOISE_RISE 4096
+/// Frames the displayed level is averaged over.
+#define SPECTRUM_LEVEL_AVG 16
+
+struct spectrum {
+    unsigned stride;          ///< input samples from one FFT to the next, 0 for one per buffer
+    float threshold;          ///< power ratio over the noise floor of an occupied bin
+    float window[SPECTRUM_BINS];
+    float twiddle[SPECTRUM_BINS]; ///< e^(-j 2 pi i / N) for i < N/2, interleaved I/Q
+    uint8_t reverse[SPECTRUM_BINS];
+    float fft[2 * SPECTRUM_BINS];
+    float power[SPECTRUM_BINS];
+    float level[SPECTRUM_BINS]; ///< averaged power of each bin
+    float noise[SPECTRUM_BINS]; ///< noise floor power of each bin, 0 until the first FFT
+    uint64_t pos;               ///< input samples processed
+    uint32_t next;              ///< input samples to skip before the next FFT
+    uint64_t active_pos[SPECTRUM_BINS]; ///< input position after the last buffer a bin was occupied in, 0 if never
+    unsigned occupied[SPECTRUM_BINS];   ///< FFTs with the bin occupied since the last flush
+    unsigned frames;            ///< FFTs since the last flush
+};
+
+spectrum_t *spectrum_create(unsigned stride, float threshold_db)
+{
+    spectrum_t *sp = calloc(1, sizeof(*sp));
+    if (!sp) {
+        WARN_CALLOC("spectrum_create()");
+        return NULL;
+    }
+    sp->stride    = stride;
+    sp->threshold = powf(10.0f, threshold_db / 10.0f);
+
+    // Hann window, scaled so a full scale tone is 0 dB
+    double sum = 0.0;
+    for (unsigned i = 0; i < SPECTRUM_BINS; ++i) {
+        sp->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / SPECTRUM_BINS));
+        sum += sp->window[i];
+    }
+    for (unsigned i = 0; i < SPECTRUM_BINS; ++i) {
+        sp->window[i] = (float)(sp->window[i] / sum);
+    }
+    for (unsigned i = 0; i < SPECTRUM_BINS / 2; ++i) {
+        sp->twiddle[2 * i]     = (float)cos(2.0 * M_PI * i / SPECTRUM_BINS);
+        sp->twiddle[2 * i + 1] = (float)-sin(2.0 * M_PI * i / SPECTRUM_BINS);
+    }
+    unsigned bits = 0;
+    while ((1u << bits) < SPECTRUM_BINS)
+        bits++;
+    for (unsigned i = 0; i < SPECTRUM_BINS; ++i) {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        sp->reverse[i] = (uint8_t)r;
+    }
+
+    return sp;
+}
+
+void spectrum_free(spectrum_t *sp)
+{
+    free(sp);
+}
+
+void spectrum_reset(spectrum_t *sp)
+{
+    memset(sp->level, 0, sizeof(sp->level));
+    memset(sp->noise, 0, sizeof(sp->noise));
+    memset(sp->active_pos, 0, sizeof(sp->active_pos));
+    sp->next = 0;
+}
+
+// in-place radix-2 FFT of the windowed frame in bit reversed order
+static void spectrum_fft(spectrum_t *sp)
+{
+    float *x = sp->fft;
+    for (unsigned len = 2; len <= SPECTRUM_BINS; len <<= 1) {
+        unsigned half = len / 2;
+        unsigned step = SPECTRUM_BINS / len;
+        for (unsigned i = 0; i < SPECTRUM_BINS; i += len) {
+            for (unsigned j = 0; j < half; ++j) {
+                float const *w = &sp->twiddle[2 * j * step];
+                float *a = &x[2 * (i + j)];
+                float *b = &x[2 * (i + j + half)];
+                float br = b[0] * w[0] - b[1] * w[1];
+                float bi = b[0] * w[1] + b[1] * w[0];
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+            }
+        }
+    }
+}
+
+// one FFT of the samples at the frame, then update the levels, the noise floor, and the occupancy
+static void spectrum_frame(spectrum_t *sp, void const *frame, int sample_size, uint64_t end_pos)
+{
+    uint8_t const *cu8  = frame;
+    int16_t const *cs16 = frame;
+    for (unsigned i = 0; i < SPECTRUM_BINS; ++i) {
+        float si, sq;
+        if (sample_size == 2) {
+            si = (cu8[2 * i] - 127.5f) / 128.0f;
+            sq = (cu8[2 * i + 1] - 127.5f) / 128.0f;
+        }
+        else {
+            si = cs16[2 * i] / 32768.0f;
+            sq = cs16[2 * i + 1] / 32768.0f;
+        }
+        unsigned r = sp->reverse[i];
+        sp->fft[2 * r]     = si * sp->window[i];
+        sp->fft[2 * r + 1] = sq * sp->window[i];
+    }
+    spectrum_fft(sp);
+    for (unsigned k = 0; k < SPECTRUM_BINS; ++k) {
+        sp->power[k] = sp->fft[2 * k] * sp->fft[2 * k] + sp->fft[2 * k + 1] * sp->fft[2 * k + 1];
+    }
+
+    sp->frames += 1;
+    for (unsigned k = 0; k < SPECTRUM_BINS; ++k) {
+        float p = 0.0f;
+        for (unsigned s = 0; s < SPECTRUM_SMOOTH; ++s) {
+            p += sp->power[(k + s + SPECTRUM_BINS - SPECTRUM_SMOOTH / 2) % SPECTRUM_BINS];
+        }
+        p /= SPECTRUM_SMOOTH;
+        p += 1e-12f; // keep the floor above zero
+
+        if (sp->noise[k] == 0.0f) {
+            sp->noise[k] = p;
+            sp->level[k] = p;
+        }
+        sp->level[k] += (p - sp->level[k]) / SPECTRUM_LEVEL_AVG;
+        if (p > sp->noise[k] * sp->threshold) {
+            sp->noise[k] += (p - sp->noise[k]) / SPECTRUM_NOISE_RISE;
+            sp->active_pos[k] = end_pos;
+            sp->occupied[k] += 1;
+        }
+        else {
+            sp->noise[k] += (p - sp->noise[k]) / SPECTRUM_NOISE_FALL;
+        }
+    }
+}
+
+void spectrum_process(spectrum_t *sp, void const *iq_buf, int sample_size, uint32_t len)
+{
+    uint64_t end_pos = sp->pos + len;
+    uint8_t const *buf = iq_buf;
+    if (!sp->stride) {
+        if (len >= SPECTRUM_BINS)
+            spectrum_frame(sp, buf, sample_size, end_pos);
+    }
+    else {
+        uint32_t i = sp->next;
+        for (; i + SPECTRUM_BINS <= len; i += sp->stride) {
+            spectrum_frame(sp, &buf[(size_t)i * sample_size], sample_size, end_pos);
+        }
+        sp->next = i >= len ? i - len : 0;
+    }
+    sp->pos = end_pos;
+}
+
+unsigned spectrum_bin(int offset, uint32_t samp_rate)
+{
+    long bin = lround((double)offset * SPECTRUM_BINS / samp_rate);
+    return (unsigned)(((bin % SPECTRUM_BINS) + SPECTRUM_BINS) % SPECTRUM_BINS);
+}
+
+int spectrum_active(spectrum_t const *sp, unsigned bin, unsigned half_width, uint64_t hold)
+{
+    for (unsigned i = 0; i <= 2 * half_width && i < SPECTRUM_BINS; ++i) {
+        unsigned k = (bin + SPECTRUM_BINS - half_width + i) % SPECTRUM_BINS;
+        if (sp->active_pos[k] && sp->active_pos[k] + hold >= sp->pos)
+            return 1;
+    }
+    return 0;
+}
+
+float spectrum_level_db(spectrum_t const *sp, unsigned bin)
+{
+    return sp->level[bin] > 0.0f ? 10.0f * log10f(sp->level[bin]) : -120.0f;
+}
+
+float spectrum_noise_db(spectrum_t const *sp, unsigned bin)
+{
+    return sp->noise[bin] > 0.0f ? 10.0f * log10f(sp->noise[bin]) : -120.0f;
+}
+
+float spectrum_occupancy(spectrum_t const *sp, unsigned bin)
+{
+    return sp->frames ? 100.0f * sp->occupied[bin] / sp->frames : 0.0f;
+}
+
+void spectrum_flush(spectrum_t *sp)
+{
+    memset(sp->occupied, 0, sizeof(sp->occupied));
+    sp->frames = 0;
+}
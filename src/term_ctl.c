@@ -217,7 +217,7 @@ int term_get_columns(void *ctx)
     return (c_info.srWindow.Right - c_info.srWindow.Left + 1);
 #else
     FILE *fp = (FILE *)ctx;
-    struct winsize w;
+    struct winsize w = {0}; // not a terminal leaves this unset
     ioctl(fileno(fp), TIOCGWINSZ, &w);
     return w.ws_col;
 #endif
@@ -311,60 +311,86 @@ void term_ring_bell(void *ctx)
 #endif
 }
 
-void term_set_fg(void *ctx, term_color_t color)
+// the detected terminal background color, cached
+static int term_light_bg(void)
 {
-    // Cache the detected terminal background color
     static int light_bg = -1;
     if (light_bg == -1) {
         light_bg = term_get_bg();
     }
+    return light_bg;
+}
 
-#ifdef _WIN32
-    console_t *console = (console_t *)ctx;
-    if (!console->ansi) {
-        _term_set_color(ctx, TRUE, color);
-        return;
-    }
-    FILE *fp = console->file;
-#else
-    FILE *fp = (FILE *)ctx;
-#endif
+int term_fg_sequence(term_color_t color, char *buf, size_t size)
+{
     if (color == TERM_COLOR_RESET) {
-        fprintf(fp, "\033[0m");
+        return snprintf(buf, size, "\033[0m");
     }
-    else if (light_bg) {
-        fprintf(fp, "\033[%dm", color); // normal colors on light backgrounds
+    else if (term_light_bg()) {
+        return snprintf(buf, size, "\033[%dm", color); // normal colors on light backgrounds
     }
     else {
-        fprintf(fp, "\033[%d;1m", color); // bright/bold colors on dark backgrounds
+        return snprintf(buf, size, "\033[%d;1m", color); // bright/bold colors on dark backgrounds
     }
 }
 
-void term_set_bg(void *ctx, term_color_t bg, term_color_t fg)
+// drop colors that are not in the enum, returns 0 for those
+static term_color_t term_valid_color(term_color_t color)
 {
-    // Cache the detected terminal background color
-    static int light_bg = -1;
-    if (light_bg == -1) {
-        light_bg = term_get_bg();
+    if (color < TERM_COLOR_BLACK
+            || (color > TERM_COLOR_WHITE && color < TERM_COLOR_BRIGHT_BLACK)
+            || color > TERM_COLOR_BRIGHT_WHITE) {
+        return 0;
     }
-    if (light_bg && fg >= TERM_COLOR_BRIGHT_BLACK && fg <= TERM_COLOR_BRIGHT_WHITE) {
+    return color;
+}
+
+int term_bg_sequence(term_color_t bg, term_color_t fg, char *buf, size_t size)
+{
+    if (term_light_bg() && fg >= TERM_COLOR_BRIGHT_BLACK && fg <= TERM_COLOR_BRIGHT_WHITE) {
         fg -= 60; // remove bright/bold foreground on light backgrounds
     }
+    bg = term_valid_color(bg);
+    fg = term_valid_color(fg);
 
-    if (bg < TERM_COLOR_BLACK
-            || (bg > TERM_COLOR_WHITE && bg < TERM_COLOR_BRIGHT_BLACK)
-            || bg > TERM_COLOR_BRIGHT_WHITE) {
-        bg = 0;
-    }
-    if (fg < TERM_COLOR_BLACK
-            || (fg > TERM_COLOR_WHITE && fg < TERM_COLOR_BRIGHT_BLACK)
-            || fg > TERM_COLOR_BRIGHT_WHITE) {
-        fg = 0;
+    if (bg && fg)
+        return snprintf(buf, size, "\033[%d;%dm", bg + 10, fg);
+    else if (bg)
+        return snprintf(buf, size, "\033[%dm", bg + 10);
+    else if (fg)
+        return snprintf(buf, size, "\033[%dm", fg);
+    if (size)
+        buf[0] = '\0';
+    return 0;
+}
+
+void term_set_fg(void *ctx, term_color_t color)
+{
+#ifdef _WIN32
+    console_t *console = (console_t *)ctx;
+    if (!console->ansi) {
+        _term_set_color(ctx, TRUE, color);
+        return;
     }
+    FILE *fp = console->file;
+#else
+    FILE *fp = (FILE *)ctx;
+#endif
+    char seq[16];
+    term_fg_sequence(color, seq, sizeof(seq));
+    fputs(seq, fp);
+}
 
+void term_set_bg(void *ctx, term_color_t bg, term_color_t fg)
+{
 #ifdef _WIN32
     console_t *console = (console_t *)ctx;
     if (!console->ansi) {
+        if (term_light_bg() && fg >= TERM_COLOR_BRIGHT_BLACK && fg <= TERM_COLOR_BRIGHT_WHITE) {
+            fg -= 60; // remove bright/bold foreground on light backgrounds
+        }
+        bg = term_valid_color(bg);
+        fg = term_valid_color(fg);
         if (bg)
             _term_set_color(ctx, FALSE, bg);
         if (fg)
@@ -375,12 +401,53 @@ void term_set_bg(void *ctx, term_color_t bg, term_color_t fg)
 #else
     FILE *fp = (FILE *)ctx;
 #endif
-    if (bg && fg)
-        fprintf(fp, "\033[%d;%dm", bg + 10, fg);
-    else if (bg)
-        fprintf(fp, "\033[%dm", bg + 10);
-    else if (fg)
-        fprintf(fp, "\033[%dm", fg);
+    char seq[16];
+    term_bg_sequence(bg, fg, seq, sizeof(seq));
+    fputs(seq, fp);
+}
+
+int term_write(void *ctx, char const *buf, size_t len)
+{
+#ifdef _WIN32
+    console_t *console = (console_t *)ctx;
+    if (!console->ansi) {
+        // write the text between the escape sequences, set their colors with console calls
+        char const *end = buf + len;
+        while (buf < end) {
+            char const *esc = memchr(buf, '\033', end - buf);
+            char const *text_end = esc ? esc : end;
+            if (text_end > buf && console->file)
+                fwrite(buf, 1, text_end - buf, console->file);
+            if (!esc)
+                break;
+            buf = esc + 1;
+            if (buf == end || *buf != '[')
+                continue;
+            for (++buf; buf < end; ++buf) {
+                int code = 0;
+                for (; buf < end && *buf >= '0' && *buf <= '9'; ++buf)
+                    code = code * 10 + (*buf - '0');
+                if (code == 0)
+                    _term_set_color(console, TRUE, TERM_COLOR_RESET);
+                else if ((code >= 40 && code <= 47) || (code >= 100 && code <= 107))
+                    _term_set_color(console, FALSE, (term_color_t)(code - 10));
+                else if ((code >= 30 && code <= 37) || (code >= 90 && code <= 97))
+                    _term_set_color(console, TRUE, (term_color_t)code);
+                if (buf == end || *buf != ';') {
+                    buf += buf < end; // the final 'm'
+                    break;
+                }
+            }
+        }
+        return 0;
+    }
+    FILE *fp = console->file;
+    if (!fp)
+        return 0;
+#else
+    FILE *fp = (FILE *)ctx;
+#endif
+    return fwrite(buf, 1, len, fp) == len ? 0 : -1;
 }
 
 #define DIM(array) (int) (sizeof(array) / sizeof(array[0]))
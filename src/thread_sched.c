@@ -0,0 +1,304 @@
+/** @file
+    CPU affinity and scheduling policy of the acquire, demod, output, HTTP, and worker threads.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "thread_sched.h"
+
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+#include "data.h"
+#include "list.h"
+#include "optparse.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(THREADS) && !defined(_WIN32)
+#include <sched.h>
+#endif
+
+/// The CPUs are kept as a mask, enough for the boards this runs on.
+#define THREAD_SCHED_MAX_CPUS 64
+
+typedef enum {
+    POLICY_DEFAULT, ///< keep the policy of the process
+    POLICY_FIFO,
+    POLICY_RR,
+} sched_policy_t;
+
+typedef struct thread_sched {
+    int set;           ///< a setting was given
+    uint64_t cpus;     ///< the CPUs to run on, 0 for any
+    sched_policy_t policy;
+    int priority;
+    // the effective setting of the last thread started, guarded by the lock
+    unsigned lock;
+    unsigned started;  ///< threads that applied the setting
+    unsigned failed;   ///< threads that could not apply all of the setting
+    uint64_t eff_cpus; ///< 0 if not known
+    int eff_policy;    ///< a sched_policy_t, -1 for another policy
+    int eff_priority;
+} thread_sched_t;
+
+static char const *const role_names[THREAD_ROLES] = {"acquire", "demod", "output", "http", "worker"};
+static char const *const policy_names[] = {"default", "fifo", "rr"};
+
+// process wide, set while parsing the options, read by the threads once started
+static thread_sched_t scheds[THREAD_ROLES];
+
+// parse e.g. "1", "2-3", "0+2-3", or "any"
+static int parse_cpus(char const *str, uint64_t *mask)
+{
+    *mask = 0;
+    if (!strcasecmp(str, "any")) {
+        return 0;
+    }
+    char const *p = str;
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last  = first;
+        if (end == p) {
+            return -1;
+        }
+        if (*end == '-') {
+            p    = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) {
+                return -1;
+            }
+        }
+        if (first < 0 || last < first || last >= THREAD_SCHED_MAX_CPUS) {
+            return -1;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            *mask |= (uint64_t)1 << cpu;
+        }
+        if (*end == '+') {
+            end++;
+        }
+        else if (*end) {
+            return -1;
+        }
+        p = end;
+    }
+    return *mask ? 0 : -1;
+}
+
+int thread_sched_set(char const *role, char const *spec)
+{
+    int r = -1;
+    for (int i = 0; i < THREAD_ROLES; ++i) {
+        if (role && !strcasecmp(role, role_names[i])) {
+            r = i;
+        }
+    }
+    if (r < 0 || !spec || !*spec) {
+        return -1;
+    }
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    char *policy   = strchr(buf, '/');
+    char *priority = NULL;
+    if (policy) {
+        *policy++ = '\0';
+        priority  = strchr(policy, '/');
+        if (priority) {
+            *priority++ = '\0';
+        }
+    }
+
+    thread_sched_t s = {0};
+    s.set = 1;
+    if (parse_cpus(buf, &s.cpus)) {
+        return -1;
+    }
+    if (policy && !strcasecmp(policy, "fifo")) {
+        s.policy = POLICY_FIFO;
+    }
+    else if (policy && !strcasecmp(policy, "rr")) {
+        s.policy = POLICY_RR;
+    }
+    else if (policy) {
+        return -1;
+    }
+    s.priority = s.policy ? 10 : 0;
+    if (priority) {
+        char *end;
+        s.priority = (int)strtol(priority, &end, 10);
+        if (*end || s.priority < 1 || s.priority > 99) {
+            return -1;
+        }
+    }
+    scheds[r] = s;
+    return 0;
+}
+
+// list the CPUs of a mask, e.g. "0+2-3", "any" for an empty mask
+static char *format_cpus(uint64_t mask, char *buf, size_t size)
+{
+    if (!mask) {
+        snprintf(buf, size, "any");
+        return buf;
+    }
+    size_t len = 0;
+    buf[0]     = '\0';
+    for (int cpu = 0; cpu < THREAD_SCHED_MAX_CPUS; ++cpu) {
+        if (!(mask >> cpu & 1)) {
+            continue;
+        }
+        int last = cpu;
+        while (last + 1 < THREAD_SCHED_MAX_CPUS && mask >> (last + 1) & 1) {
+            last++;
+        }
+        int n = last > cpu ? snprintf(buf + len, size - len, "%s%d-%d", len ? "+" : "", cpu, last)
+                           : snprintf(buf + len, size - len, "%s%d", len ? "+" : "", cpu);
+        if (n < 0 || (size_t)n >= size - len) {
+            break;
+        }
+        len += n;
+        cpu = last;
+    }
+    return buf;
+}
+
+void thread_sched_apply(thread_role_t role)
+{
+    thread_sched_t *s = &scheds[role];
+    if (!s->set) {
+        return;
+    }
+    char const *name = role_names[role];
+    char cpus[THREAD_SCHED_MAX_CPUS * 3];
+    format_cpus(s->cpus, cpus, sizeof(cpus));
+    int failed       = 0;
+    uint64_t eff_cpus = 0;
+    int eff_policy   = POLICY_DEFAULT;
+    int eff_priority = 0;
+
+#if defined(THREADS) && defined(__linux__) && defined(_GNU_SOURCE)
+    if (s->cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < THREAD_SCHED_MAX_CPUS; ++cpu) {
+            if (s->cpus >> cpu & 1) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        int r = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (r) {
+            print_logf(LOG_WARNING, "Threads", "Pinning the %s thread to CPUs %s failed: %s", name, cpus, strerror(r));
+            failed = 1;
+        }
+    }
+    cpu_set_t set;
+    if (!pthread_getaffinity_np(pthread_self(), sizeof(set), &set)) {
+        for (int cpu = 0; cpu < THREAD_SCHED_MAX_CPUS; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                eff_cpus |= (uint64_t)1 << cpu;
+            }
+        }
+    }
+#else
+    if (s->cpus) {
+        print_logf(LOG_WARNING, "Threads", "Pinning the %s thread to CPUs %s is not supported on this platform", name, cpus);
+        failed = 1;
+    }
+#endif
+
+#if defined(THREADS) && !defined(_WIN32)
+    if (s->policy) {
+        struct sched_param param = {.sched_priority = s->priority};
+        int r = pthread_setschedparam(pthread_self(), s->policy == POLICY_FIFO ? SCHED_FIFO : SCHED_RR, &param);
+        if (r == EPERM) {
+            print_logf(LOG_WARNING, "Threads", "Real-time scheduling (%s priority %d) of the %s thread is not permitted, "
+                    "it needs CAP_SYS_NICE or a real-time priority limit (ulimit -r)", policy_names[s->policy], s->priority, name);
+            failed = 1;
+        }
+        else if (r) {
+            print_logf(LOG_WARNING, "Threads", "Real-time scheduling (%s priority %d) of the %s thread failed: %s",
+                    policy_names[s->policy], s->priority, name, strerror(r));
+            failed = 1;
+        }
+    }
+    int policy;
+    struct sched_param param;
+    if (!pthread_getschedparam(pthread_self(), &policy, &param)) {
+        eff_policy   = policy == SCHED_FIFO ? POLICY_FIFO : policy == SCHED_RR ? POLICY_RR : policy == SCHED_OTHER ? POLICY_DEFAULT : -1;
+        eff_priority = param.sched_priority;
+    }
+#else
+    if (s->policy) {
+        print_logf(LOG_WARNING, "Threads", "Real-time scheduling of the %s thread is not supported on this platform", name);
+        failed = 1;
+    }
+#endif
+
+    if (!failed) {
+        print_logf(LOG_INFO, "Threads", "The %s thread runs on CPUs %s with %s scheduling", name, cpus, policy_names[s->policy]);
+    }
+
+    atomic_spin_lock(&s->lock);
+    s->started++;
+    s->failed += failed;
+    s->eff_cpus     = eff_cpus;
+    s->eff_policy   = eff_policy;
+    s->eff_priority = eff_priority;
+    atomic_spin_unlock(&s->lock);
+}
+
+data_array_t *thread_sched_data(void)
+{
+    list_t threads = {0};
+    list_ensure_size(&threads, THREAD_ROLES + 1); // account for terminating NULL
+
+    for (int i = 0; i < THREAD_ROLES; ++i) {
+        thread_sched_t *s = &scheds[i];
+        if (!s->set) {
+            continue;
+        }
+        atomic_spin_lock(&s->lock);
+        unsigned started  = s->started;
+        unsigned failed   = s->failed;
+        uint64_t eff_cpus = s->eff_cpus;
+        int eff_policy    = s->eff_policy;
+        int eff_priority  = s->eff_priority;
+        atomic_spin_unlock(&s->lock);
+
+        char cpus[THREAD_SCHED_MAX_CPUS * 3];
+        char eff_cpus_str[THREAD_SCHED_MAX_CPUS * 3];
+        format_cpus(s->cpus, cpus, sizeof(cpus));
+        format_cpus(eff_cpus, eff_cpus_str, sizeof(eff_cpus_str));
+        list_push(&threads, data_make(
+                "thread",             "", DATA_STRING, role_names[i],
+                "cpus",               "", DATA_STRING, cpus,
+                "policy",             "", DATA_STRING, policy_names[s->policy],
+                "priority",           "", DATA_INT, s->priority,
+                "started",            "", DATA_INT, (int)started,
+                "failed",             "", DATA_INT, (int)failed,
+                "effective_cpus",     "", DATA_COND, started && eff_cpus, DATA_STRING, eff_cpus_str,
+                "effective_policy",   "", DATA_COND, started, DATA_STRING, eff_policy < 0 ? "other" : policy_names[eff_policy],
+                "effective_priority", "", DATA_COND, started, DATA_INT, eff_priority,
+                NULL));
+    }
+    if (!threads.len) {
+        list_free_elems(&threads, NULL);
+        return NULL;
+    }
+
+    data_array_t *array = data_array(threads.len, DATA_DATA, threads.elems);
+    list_free_elems(&threads, NULL);
+    return array;
+}
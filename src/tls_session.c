@@ -0,0 +1,190 @@
+/** @file
+    TLS session resumption for the network outputs.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "tls_session.h"
+
+#include "mongoose.h"
+#include "compat_atomic.h"
+#include "list.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if MG_ENABLE_SSL && MG_SSL_IF == MG_SSL_IF_OPENSSL
+
+struct tls_session {
+    char *key;     ///< the address and the settings that change the session
+    unsigned users;
+    void *session; ///< the last SSL_SESSION of the server, NULL if none
+};
+
+// the sessions of all outputs, outputs of several instances might share a server
+static list_t sessions;
+static unsigned sessions_lock;
+
+tls_session_t *tls_session_get(char const *address, tls_opts_t const *tls_opts)
+{
+    char key[1024];
+    snprintf(key, sizeof(key), "%s|%s|%s|%s", address,
+            tls_opts->tls_server_name ? tls_opts->tls_server_name : "",
+            tls_opts->tls_cert ? tls_opts->tls_cert : "",
+            tls_opts->tls_psk_identity ? tls_opts->tls_psk_identity : "");
+
+    atomic_spin_lock(&sessions_lock);
+    for (void **iter = sessions.elems; iter && *iter; ++iter) {
+        tls_session_t *s = *iter;
+        if (!strcmp(s->key, key)) {
+            s->users++;
+            atomic_spin_unlock(&sessions_lock);
+            return s;
+        }
+    }
+    atomic_spin_unlock(&sessions_lock);
+
+    tls_session_t *s = calloc(1, sizeof(*s));
+    if (!s) {
+        WARN_CALLOC("tls_session_get()");
+        return NULL; // NOTE: no resumption on alloc failure.
+    }
+    s->key = strdup(key);
+    if (!s->key) {
+        WARN_STRDUP("tls_session_get()");
+        free(s);
+        return NULL; // NOTE: no resumption on alloc failure.
+    }
+    s->users = 1;
+    atomic_spin_lock(&sessions_lock);
+    list_push(&sessions, s);
+    atomic_spin_unlock(&sessions_lock);
+    return s;
+}
+
+void tls_session_put(tls_session_t *session)
+{
+    if (!session) {
+        return;
+    }
+    atomic_spin_lock(&sessions_lock);
+    int last = --session->users == 0;
+    if (last) {
+        for (size_t i = 0; i < sessions.len; ++i) {
+            if (sessions.elems[i] == session) {
+                list_remove(&sessions, i, NULL);
+                break;
+            }
+        }
+        if (!sessions.len) {
+            list_free_elems(&sessions, NULL);
+        }
+    }
+    atomic_spin_unlock(&sessions_lock);
+    if (last) {
+        if (session->session) {
+            mg_ssl_if_session_free(session->session);
+        }
+        free(session->key);
+        free(session);
+    }
+}
+
+void tls_session_resume(tls_session_t *session, struct mg_connection *nc)
+{
+    if (!session || !nc) {
+        return;
+    }
+    atomic_spin_lock(&sessions_lock);
+    if (session->session) {
+        // the connection takes its own reference
+        mg_ssl_if_set_session(nc, session->session);
+    }
+    atomic_spin_unlock(&sessions_lock);
+}
+
+void tls_session_save(tls_session_t *session, struct mg_connection *nc)
+{
+    if (!session || !(nc->flags & MG_F_SSL_HANDSHAKE_DONE)) {
+        return;
+    }
+    void *latest = mg_ssl_if_get1_session(nc);
+    if (!latest) {
+        return; // not resumable
+    }
+    atomic_spin_lock(&sessions_lock);
+    void *prev       = session->session;
+    session->session = latest;
+    atomic_spin_unlock(&sessions_lock);
+    if (prev) {
+        mg_ssl_if_session_free(prev);
+    }
+}
+
+void tls_session_connected(tls_session_t *session, struct mg_connection *nc, int status, tls_stats_t *stats)
+{
+    if (!(nc->flags & MG_F_SSL)) {
+        return;
+    }
+    if (status) {
+        if (!mg_ssl_if_handshake_start(nc)) {
+            return; // the TCP connect failed, no handshake
+        }
+        stats->failed++;
+        return;
+    }
+    unsigned ms = (unsigned)((mg_time() - mg_ssl_if_handshake_start(nc)) * 1000);
+    stats->handshakes++;
+    stats->handshake_ms += ms;
+    if (stats->max_handshake_ms < ms) {
+        stats->max_handshake_ms = ms;
+    }
+    if (mg_ssl_if_session_reused(nc)) {
+        stats->resumed++;
+    }
+    tls_session_save(session, nc);
+}
+
+#else /* no TLS or no session support */
+
+tls_session_t *tls_session_get(char const *address, tls_opts_t const *tls_opts)
+{
+    (void)address;
+    (void)tls_opts;
+    return NULL;
+}
+
+void tls_session_put(tls_session_t *session)
+{
+    (void)session;
+}
+
+void tls_session_resume(tls_session_t *session, struct mg_connection *nc)
+{
+    (void)session;
+    (void)nc;
+}
+
+void tls_session_save(tls_session_t *session, struct mg_connection *nc)
+{
+    (void)session;
+    (void)nc;
+}
+
+void tls_session_connected(tls_session_t *session, struct mg_connection *nc, int status, tls_stats_t *stats)
+{
+    (void)session;
+    (void)nc;
+    (void)status;
+    (void)stats;
+}
+
+#endif
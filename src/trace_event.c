@@ -0,0 +1,193 @@
+/** @file
+    Trace of spans and counters in the Chrome trace event format.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "trace_event.h"
+
+#include "compat_time.h"
+#include "compat_atomic.h"
+#include "compat_pthread.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct trace_event {
+    FILE *file;
+    char path[256];
+    uint64_t start_ns; ///< monotonic time of the start, the timestamps count from here
+    uint64_t end_ns;   ///< monotonic time the trace stops, 0 to trace until stopped
+    unsigned count;    ///< events written, all but the first are preceded by a comma
+    int active;        ///< the file is open, read without the lock as a hint
+
+#ifdef THREADS
+    pthread_mutex_t lock;
+#endif
+};
+
+static void trace_lock(trace_event_t *trace)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&trace->lock);
+#else
+    (void)trace;
+#endif
+}
+
+static void trace_unlock(trace_event_t *trace)
+{
+#ifdef THREADS
+    pthread_mutex_unlock(&trace->lock);
+#else
+    (void)trace;
+#endif
+}
+
+trace_event_t *trace_event_create(void)
+{
+    trace_event_t *trace = calloc(1, sizeof(*trace));
+    if (!trace) {
+        WARN_CALLOC("trace_event_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+#ifdef THREADS
+    pthread_mutex_init(&trace->lock, NULL);
+#endif
+    return trace;
+}
+
+// close the file, the lock is held
+static unsigned trace_close(trace_event_t *trace)
+{
+    if (!trace->file) {
+        return 0;
+    }
+    fprintf(trace->file, "\n]\n");
+    fclose(trace->file);
+    trace->file = NULL;
+    atomic_store_release(&trace->active, 0);
+    return trace->count;
+}
+
+int trace_event_start(trace_event_t *trace, char const *path, unsigned secs)
+{
+    trace_lock(trace);
+    trace_close(trace);
+    trace->file = fopen(path, "w");
+    if (!trace->file) {
+        trace_unlock(trace);
+        print_logf(LOG_ERROR, "Trace", "Failed to open \"%s\"", path);
+        return -1;
+    }
+    snprintf(trace->path, sizeof(trace->path), "%s", path);
+    trace->start_ns = time_monotonic_ns();
+    trace->end_ns   = secs ? trace->start_ns + (uint64_t)secs * 1000000000 : 0;
+    trace->count    = 0;
+    fprintf(trace->file, "[\n");
+    atomic_store_release(&trace->active, 1);
+    trace_unlock(trace);
+
+    if (secs)
+        print_logf(LOG_NOTICE, "Trace", "Writing a trace of %u s to \"%s\"", secs, path);
+    else
+        print_logf(LOG_NOTICE, "Trace", "Writing a trace to \"%s\"", path);
+    return 0;
+}
+
+unsigned trace_event_stop(trace_event_t *trace)
+{
+    char path[sizeof(trace->path)];
+    trace_lock(trace);
+    int was_active = trace->file != NULL;
+    unsigned count = trace_close(trace);
+    memcpy(path, trace->path, sizeof(path));
+    trace_unlock(trace);
+
+    if (was_active)
+        print_logf(LOG_NOTICE, "Trace", "Wrote %u trace events to \"%s\"", count, path);
+    return count;
+}
+
+int trace_event_active(trace_event_t *trace)
+{
+    if (!trace || !atomic_load_acquire(&trace->active)) {
+        return 0;
+    }
+    if (trace->end_ns && time_monotonic_ns() > trace->end_ns) {
+        trace_event_stop(trace);
+        return 0;
+    }
+    return 1;
+}
+
+// start an event, returns 0 if the trace is not writing, keeps the lock otherwise
+static int trace_begin(trace_event_t *trace)
+{
+    trace_lock(trace);
+    if (!trace->file) {
+        trace_unlock(trace);
+        return 0;
+    }
+    if (trace->count++)
+        fputs(",\n", trace->file);
+    return 1;
+}
+
+// the time since the start in us, events before the start are at 0
+static double trace_us(trace_event_t *trace, uint64_t ns)
+{
+    return ns > trace->start_ns ? (ns - trace->start_ns) / 1000.0 : 0.0;
+}
+
+void trace_event_thread_name(trace_event_t *trace, unsigned tid, char const *name)
+{
+    if (!trace_begin(trace)) {
+        return;
+    }
+    fprintf(trace->file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            tid, name);
+    trace_unlock(trace);
+}
+
+void trace_event_span(trace_event_t *trace, char const *name, char const *cat, unsigned tid, uint64_t start_ns, uint64_t end_ns)
+{
+    if (!trace_begin(trace)) {
+        return;
+    }
+    double ts = trace_us(trace, start_ns);
+    double end = trace_us(trace, end_ns);
+    fprintf(trace->file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            name, cat, ts, end > ts ? end - ts : 0.0, tid);
+    trace_unlock(trace);
+}
+
+void trace_event_counter(trace_event_t *trace, char const *name, uint64_t ts_ns, double value)
+{
+    if (!trace_begin(trace)) {
+        return;
+    }
+    fprintf(trace->file, "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%g}}",
+            name, trace_us(trace, ts_ns), value);
+    trace_unlock(trace);
+}
+
+void trace_event_free(trace_event_t *trace)
+{
+    if (!trace) {
+        return;
+    }
+    trace_event_stop(trace);
+#ifdef THREADS
+    pthread_mutex_destroy(&trace->lock);
+#endif
+    free(trace);
+}
@@ -0,0 +1,221 @@
+/** @file
+    Level estimates of each receiver and frequency saved for a warm start.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "warm_start.h"
+
+#include "r_private.h"
+#include "compat_atomic.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Most states kept, the least recently kept one is displaced.
+#define WARM_START_MAX_STATES 256
+/// Longest receiver name, longer names are cut.
+#define WARM_START_RECEIVER_SIZE 192
+
+typedef struct {
+    char receiver[WARM_START_RECEIVER_SIZE]; ///< empty if the entry is unused
+    detect_state_t state;
+    unsigned stamp; ///< the order the states were kept in
+} warm_entry_t;
+
+struct warm_start {
+    unsigned lock;
+    char *path;
+    unsigned stamp;
+    int changed; ///< a state was kept since the last save
+    warm_entry_t entries[WARM_START_MAX_STATES];
+};
+
+// copy a receiver name, the tabs and line breaks of the file format are replaced
+static void copy_receiver(char *dst, char const *src)
+{
+    size_t i = 0;
+    for (; src[i] && i < WARM_START_RECEIVER_SIZE - 1; ++i)
+        dst[i] = src[i] == '\t' || src[i] == '\n' || src[i] == '\r' ? ' ' : src[i];
+    dst[i] = '\0';
+}
+
+// the entry of a receiver and frequency, otherwise an unused one or the least recently kept
+static warm_entry_t *find_entry(warm_start_t *warm, char const *receiver, uint32_t frequency)
+{
+    warm_entry_t *slot = NULL;
+    for (unsigned i = 0; i < WARM_START_MAX_STATES; ++i) {
+        warm_entry_t *entry = &warm->entries[i];
+        if (entry->state.frequency == frequency && !strcmp(entry->receiver, receiver))
+            return entry;
+        if (!slot || (slot->receiver[0] && (!entry->receiver[0] || entry->stamp < slot->stamp)))
+            slot = entry;
+    }
+    return slot;
+}
+
+// a state line: receiver, frequency, noise level, auto level, OOK low and high estimate, lead-in counter
+static int parse_line(warm_start_t *warm, char *line)
+{
+    char *tab = strchr(line, '\t');
+    if (line[0] == '#' || !tab)
+        return 0;
+    *tab = '\0';
+    char receiver[WARM_START_RECEIVER_SIZE];
+    copy_receiver(receiver, line);
+
+    detect_state_t state = {0};
+    if (sscanf(tab + 1, "%u\t%f\t%f\t%d\t%d\t%d", &state.frequency, &state.noise_level, &state.min_level_auto,
+                &state.levels.ook_low_estimate, &state.levels.ook_high_estimate, &state.levels.lead_in_counter) != 6
+            || !state.frequency)
+        return -1;
+
+    warm_entry_t *entry = find_entry(warm, receiver, state.frequency);
+    memcpy(entry->receiver, receiver, sizeof(entry->receiver));
+    entry->state = state;
+    entry->stamp = ++warm->stamp;
+    return 0;
+}
+
+warm_start_t *warm_start_create(char const *path)
+{
+    warm_start_t *warm = calloc(1, sizeof(*warm));
+    if (!warm) {
+        WARN_CALLOC("warm_start_create()");
+        return NULL;
+    }
+    warm->path = strdup(path);
+    if (!warm->path) {
+        WARN_STRDUP("warm_start_create()");
+        free(warm);
+        return NULL;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return warm; // nothing saved yet
+    char line[512];
+    unsigned bad = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        bad += parse_line(warm, line) < 0;
+    }
+    fclose(file);
+    if (bad)
+        print_logf(LOG_WARNING, "Input", "Skipped %u bad lines of the warm start state \"%s\"", bad, path);
+    return warm;
+}
+
+void warm_start_free(warm_start_t *warm)
+{
+    if (!warm)
+        return;
+    free(warm->path);
+    free(warm);
+}
+
+unsigned warm_start_restore(warm_start_t *warm, char const *receiver, detect_state_t *states, unsigned num_states)
+{
+    memset(states, 0, num_states * sizeof(*states));
+    if (!warm)
+        return 0;
+
+    char name[WARM_START_RECEIVER_SIZE];
+    copy_receiver(name, receiver);
+    unsigned n = 0;
+    atomic_spin_lock(&warm->lock);
+    for (unsigned i = 0; i < WARM_START_MAX_STATES && n < num_states; ++i) {
+        warm_entry_t *entry = &warm->entries[i];
+        if (entry->receiver[0] && !strcmp(entry->receiver, name))
+            states[n++] = entry->state;
+    }
+    atomic_spin_unlock(&warm->lock);
+    return n;
+}
+
+void warm_start_keep(warm_start_t *warm, char const *receiver, detect_state_t const *states, unsigned num_states)
+{
+    if (!warm)
+        return;
+
+    char name[WARM_START_RECEIVER_SIZE];
+    copy_receiver(name, receiver);
+    atomic_spin_lock(&warm->lock);
+    for (unsigned i = 0; i < num_states; ++i) {
+        if (!states[i].frequency)
+            continue;
+        warm_entry_t *entry = find_entry(warm, name, states[i].frequency);
+        memcpy(entry->receiver, name, sizeof(entry->receiver));
+        entry->state = states[i];
+        entry->stamp = ++warm->stamp;
+    }
+    warm->changed = 1;
+    atomic_spin_unlock(&warm->lock);
+}
+
+int warm_start_save(warm_start_t *warm)
+{
+    if (!warm)
+        return 0;
+
+    // the file is written from a copy, the demods keep their states meanwhile
+    warm_entry_t *entries = malloc(sizeof(warm->entries));
+    if (!entries) {
+        WARN_MALLOC("warm_start_save()");
+        return -1;
+    }
+    atomic_spin_lock(&warm->lock);
+    int changed = warm->changed;
+    memcpy(entries, warm->entries, sizeof(warm->entries));
+    warm->changed = 0;
+    atomic_spin_unlock(&warm->lock);
+    if (!changed) {
+        free(entries);
+        return 0;
+    }
+
+    // replace the file as a whole, a crash while writing keeps the previous states
+    size_t tmp_size = strlen(warm->path) + 5;
+    char *tmp_path  = malloc(tmp_size);
+    if (!tmp_path) {
+        WARN_MALLOC("warm_start_save()");
+        free(entries);
+        return -1;
+    }
+    snprintf(tmp_path, tmp_size, "%s.tmp", warm->path);
+    FILE *file = fopen(tmp_path, "w");
+    int r      = file ? 0 : -1;
+    if (file) {
+        fprintf(file, "# rtl_433 warm start: receiver, frequency, noise level, auto level, OOK low, OOK high, lead-in\n");
+        for (unsigned i = 0; i < WARM_START_MAX_STATES; ++i) {
+            warm_entry_t const *entry = &entries[i];
+            if (!entry->receiver[0])
+                continue;
+            detect_state_t const *s = &entry->state;
+            fprintf(file, "%s\t%u\t%.2f\t%.2f\t%d\t%d\t%d\n", entry->receiver, s->frequency, s->noise_level, s->min_level_auto,
+                    s->levels.ook_low_estimate, s->levels.ook_high_estimate, s->levels.lead_in_counter);
+        }
+        r = fclose(file) ? -1 : 0;
+    }
+#ifdef _WIN32
+    if (!r)
+        remove(warm->path); // rename() does not replace on Windows
+#endif
+    if (!r)
+        r = rename(tmp_path, warm->path);
+    if (r) {
+        print_logf(LOG_WARNING, "Input", "Failed to save the warm start state \"%s\"", warm->path);
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    free(entries);
+    return r;
+}
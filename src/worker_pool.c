@@ -0,0 +1,303 @@
+/** @file
+    Fixed size worker pool with work stealing.
+
+    Copyright (C) 2026 by the rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "worker_pool.h"
+
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "thread_sched.h"
+
+#include <stdlib.h>
+#include <signal.h>
+
+#ifdef THREADS
+
+typedef struct worker_task {
+    worker_task_fn fn;
+    void *arg;
+    unsigned index;
+} worker_task_t;
+
+typedef struct worker {
+    worker_pool_t *pool;
+    pthread_t thread;     ///< unused for the first worker, that is the caller of worker_pool_run()
+    pthread_mutex_t lock; ///< lock for the deque
+    worker_task_t *deque; ///< own tasks, taken from the tail, stolen from the head
+    unsigned head;
+    unsigned tail;
+    unsigned capacity;
+    int current;          ///< index of the task being run, -1 if none, guarded by the pool lock
+} worker_t;
+
+struct worker_pool {
+    unsigned threads;
+    worker_t workers[WORKER_POOL_MAX_THREADS];
+    pthread_mutex_t lock; ///< lock for the batch state
+    pthread_cond_t cond;  ///< signals a new batch, the end of a batch, and exit
+    pthread_t caller;     ///< thread running the current batch as the first worker
+    int running;          ///< a batch is being run
+    unsigned batch;       ///< batch counter, workers wake up when this changes
+    unsigned remaining;   ///< tasks of the batch not done yet
+    int exit_threads;     ///< request the threads to exit
+};
+
+// take a task from the own deque, or steal one from the other workers
+static int worker_take(worker_pool_t *pool, unsigned self, worker_task_t *task)
+{
+    for (unsigned i = 0; i < pool->threads; ++i) {
+        worker_t *w = &pool->workers[(self + i) % pool->threads];
+        pthread_mutex_lock(&w->lock);
+        if (w->head < w->tail) {
+            if (i == 0)
+                *task = w->deque[--w->tail];
+            else
+                *task = w->deque[w->head++];
+            pthread_mutex_unlock(&w->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+    return 0;
+}
+
+// run tasks until all deques are empty
+static void worker_work(worker_pool_t *pool, unsigned self)
+{
+    worker_task_t task;
+    while (worker_take(pool, self, &task)) {
+        pthread_mutex_lock(&pool->lock);
+        pool->workers[self].current = (int)task.index;
+        pthread_mutex_unlock(&pool->lock);
+
+        task.fn(task.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->workers[self].current = -1;
+        pool->remaining -= 1;
+        if (pool->remaining == 0)
+            pthread_cond_broadcast(&pool->cond);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static THREAD_RETURN THREAD_CALL worker_run(void *arg)
+{
+    worker_t *w = arg;
+    worker_pool_t *pool = w->pool;
+    unsigned self = (unsigned)(w - pool->workers);
+    thread_sched_apply(THREAD_ROLE_WORKER);
+
+    pthread_mutex_lock(&pool->lock);
+    unsigned batch = pool->batch;
+    while (!pool->exit_threads) {
+        if (batch == pool->batch) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            continue;
+        }
+        batch = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        worker_work(pool, self);
+
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return (THREAD_RETURN)(0);
+}
+
+worker_pool_t *worker_pool_create(unsigned threads)
+{
+    if (threads < 1 || threads > WORKER_POOL_MAX_THREADS) {
+        return NULL;
+    }
+
+    worker_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        WARN_CALLOC("worker_pool_create()");
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    for (unsigned i = 0; i < threads; ++i) {
+        pool->workers[i].pool    = pool;
+        pool->workers[i].current = -1;
+        pthread_mutex_init(&pool->workers[i].lock, NULL);
+    }
+    pool->threads = 1;
+
+#ifndef _WIN32
+    // Block all signals from the worker threads
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    for (unsigned i = 1; i < threads; ++i) {
+        int r = pthread_create(&pool->workers[i].thread, NULL, worker_run, &pool->workers[i]);
+        if (r) {
+            print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+            break;
+        }
+        pool->threads += 1;
+    }
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    // keep the workers that did start, the pool is still usable
+    for (unsigned i = pool->threads; i < threads; ++i) {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    }
+
+    return pool;
+}
+
+void worker_pool_free(worker_pool_t *pool)
+{
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->exit_threads = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 1; i < pool->threads; ++i) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (unsigned i = 0; i < pool->threads; ++i) {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+        free(pool->workers[i].deque);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+    free(pool);
+}
+
+void worker_pool_run(worker_pool_t *pool, worker_task_fn fn, void **args, unsigned count)
+{
+    // a worker still leaving the last batch can take a task as soon as it is dealt
+    pthread_mutex_lock(&pool->lock);
+    pool->caller    = pthread_self();
+    pool->running   = 1;
+    pool->remaining = count;
+    pthread_mutex_unlock(&pool->lock);
+
+    // deal the tasks round robin, a worker runs its own tasks newest first
+    unsigned need = (count + pool->threads - 1) / pool->threads;
+    for (unsigned i = 0; i < pool->threads; ++i) {
+        worker_t *w = &pool->workers[i];
+        pthread_mutex_lock(&w->lock);
+        if (need > w->capacity) {
+            worker_task_t *deque = realloc(w->deque, need * sizeof(*deque));
+            if (!deque) {
+                FATAL_REALLOC("worker_pool_run()");
+            }
+            w->deque    = deque;
+            w->capacity = need;
+        }
+        w->head = 0;
+        w->tail = 0;
+        for (unsigned k = i; k < count; k += pool->threads) {
+            w->deque[w->tail++] = (worker_task_t){.fn = fn, .arg = args[k], .index = k};
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->batch += 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    worker_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->remaining > 0)
+        pthread_cond_wait(&pool->cond, &pool->lock);
+    pool->running = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int worker_pool_current_task(worker_pool_t *pool)
+{
+    if (!pool)
+        return -1;
+
+    pthread_t self = pthread_self();
+    int current = -1;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->running && pthread_equal(pool->caller, self)) {
+        current = pool->workers[0].current;
+    }
+    for (unsigned i = 1; i < pool->threads; ++i) {
+        if (pthread_equal(pool->workers[i].thread, self)) {
+            current = pool->workers[i].current;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return current;
+}
+
+int worker_pool_current_worker(worker_pool_t *pool)
+{
+    if (!pool)
+        return -1;
+
+    pthread_t self = pthread_self();
+    int worker = -1;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->running && pthread_equal(pool->caller, self)) {
+        worker = 0;
+    }
+    for (unsigned i = 1; i < pool->threads; ++i) {
+        if (pthread_equal(pool->workers[i].thread, self)) {
+            worker = (int)i;
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return worker;
+}
+
+#else
+
+worker_pool_t *worker_pool_create(unsigned threads)
+{
+    (void)threads;
+    return NULL;
+}
+
+void worker_pool_free(worker_pool_t *pool)
+{
+    (void)pool;
+}
+
+void worker_pool_run(worker_pool_t *pool, worker_task_fn fn, void **args, unsigned count)
+{
+    (void)pool;
+    for (unsigned k = 0; k < count; ++k) {
+        fn(args[k]);
+    }
+}
+
+int worker_pool_current_task(worker_pool_t *pool)
+{
+    (void)pool;
+    return -1;
+}
+
+int worker_pool_current_worker(worker_pool_t *pool)
+{
+    (void)pool;
+    return -1;
+}
+
+#endif
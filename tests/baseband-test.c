@@ -70,6 +70,266 @@ static int write_buf(const char *filename, const void *buf, size_t nbyte)
     return ret;
 }
 
+#include <string.h>
+
+/// Compare a kernel variant against the scalar reference and print the throughput of each kernel.
+static int check_variant(baseband_kernels_t const *var, uint8_t const *cu8_buf, int16_t const *cs16_buf, unsigned long n_samples, uint16_t *ref_buf, uint16_t *y16_buf)
+{
+    int failed = 0;
+    baseband_kernels_t const *ref = baseband_kernels_variant(0);
+    char label[64];
+    uint32_t r, v;
+
+    r = ref->envelope_detect(cu8_buf, ref_buf, n_samples);
+    snprintf(label, sizeof(label), "envelope_detect (%s)", var->name);
+    MEASURE(label,
+        v = var->envelope_detect(cu8_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: %s\n", label);
+        failed++;
+    }
+
+    r = ref->magnitude_est_cu8(cu8_buf, ref_buf, n_samples);
+    snprintf(label, sizeof(label), "magnitude_est_cu8 (%s)", var->name);
+    MEASURE(label,
+        v = var->magnitude_est_cu8(cu8_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: %s\n", label);
+        failed++;
+    }
+
+    ref->demod_fm_phase_cu8(cu8_buf, (int16_t *)ref_buf, n_samples);
+    snprintf(label, sizeof(label), "demod_fm_phase_cu8 (%s)", var->name);
+    MEASURE(label,
+        var->demod_fm_phase_cu8(cu8_buf, (int16_t *)y16_buf, n_samples);
+    );
+    if (memcmp(ref_buf + 1, y16_buf + 1, sizeof(uint16_t) * (n_samples - 1))) {
+        printf("MISMATCH for: %s\n", label);
+        failed++;
+    }
+
+    // widths of up to 1023 samples around overlapping windows, an odd length for the tails
+    int widths[1021];
+    unsigned num = n_samples < 1021 ? (unsigned)n_samples : 1021;
+    int const lower[BASEBAND_WINDOWS] = {200, 300, 0};
+    int const upper[BASEBAND_WINDOWS] = {400, 900, 0};
+    for (unsigned i = 0; i < num; ++i) {
+        widths[i] = (cu8_buf[2 * i] << 2 | cu8_buf[2 * i + 1] >> 6) - (i % 7 == 0 ? 400 : 0);
+    }
+    ref->classify_widths(widths, (uint8_t *)ref_buf, num, lower, upper);
+    snprintf(label, sizeof(label), "classify_widths (%s)", var->name);
+    MEASURE(label,
+        var->classify_widths(widths, (uint8_t *)y16_buf, num, lower, upper);
+    );
+    if (memcmp(ref_buf, y16_buf, num)) {
+        printf("MISMATCH for: %s\n", label);
+        failed++;
+    }
+
+    r = ref->magnitude_est_cs16(cs16_buf, ref_buf, n_samples);
+    snprintf(label, sizeof(label), "magnitude_est_cs16 (%s)", var->name);
+    MEASURE(label,
+        v = var->magnitude_est_cs16(cs16_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: %s\n", label);
+        failed++;
+    }
+    return failed;
+}
+
+/// Compare all kernel variants against the scalar reference.
+static int check_kernels(uint8_t const *cu8_buf, int16_t const *cs16_buf, unsigned long n_samples, uint16_t *ref_buf, uint16_t *y16_buf)
+{
+    int failed = 0;
+    baseband_kernels_t const *var;
+    for (unsigned idx = 0; (var = baseband_kernels_variant(idx)); ++idx) {
+        failed += check_variant(var, cu8_buf, cs16_buf, n_samples, ref_buf, y16_buf);
+    }
+    return failed;
+}
+
+/// Compare the fused demod pass against the separate envelope, low pass filter, and FM demod.
+static int check_fused(void const *iq_buf, baseband_format_t format, int use_mag_est, unsigned long n_samples,
+        uint16_t *env_buf, int16_t *am_ref, int16_t *fm_ref, int16_t *am_buf, int16_t *fm_buf)
+{
+    filter_state_t lp_state;
+    demodfm_state_t fm_state;
+    float ref_db, avg_db;
+    char const *label;
+
+    baseband_low_pass_filter_init(&lp_state, 1);
+    baseband_demod_FM_reset(&fm_state);
+    if (format == BASEBAND_CU8) {
+        if (use_mag_est)
+            ref_db = magnitude_est_cu8(iq_buf, env_buf, n_samples);
+        else
+            ref_db = envelope_detect(iq_buf, env_buf, n_samples);
+        baseband_low_pass_filter(&lp_state, env_buf, am_ref, n_samples);
+        baseband_demod_FM(&fm_state, iq_buf, fm_ref, n_samples, 250000, 0.1f);
+        label = use_mag_est ? "baseband_demod_fused (mag cu8)" : "baseband_demod_fused (cu8)";
+    }
+    else if (format == BASEBAND_CS8) {
+        ref_db = envelope_detect_cs8(iq_buf, env_buf, n_samples);
+        baseband_low_pass_filter(&lp_state, env_buf, am_ref, n_samples);
+        baseband_demod_FM_cs8(&fm_state, iq_buf, fm_ref, n_samples, 250000, 0.1f);
+        label = "baseband_demod_fused (cs8)";
+    }
+    else if (format == BASEBAND_CF32) {
+        ref_db = magnitude_est_cf32(iq_buf, env_buf, n_samples);
+        baseband_low_pass_filter(&lp_state, env_buf, am_ref, n_samples);
+        baseband_demod_FM_cf32(&fm_state, iq_buf, fm_ref, n_samples, 250000, 0.1f);
+        label = "baseband_demod_fused (cf32)";
+    }
+    else {
+        ref_db = magnitude_est_cs16(iq_buf, env_buf, n_samples);
+        baseband_low_pass_filter(&lp_state, env_buf, am_ref, n_samples);
+        baseband_demod_FM_cs16(&fm_state, iq_buf, fm_ref, n_samples, 250000, 0.1f);
+        label = "baseband_demod_fused (cs16)";
+    }
+
+    baseband_low_pass_filter_reset(&lp_state);
+    baseband_demod_FM_reset(&fm_state);
+    MEASURE(label,
+        avg_db = baseband_demod_fused(&lp_state, &fm_state, iq_buf, format, use_mag_est, am_buf, fm_buf, n_samples, 250000, 0.1f);
+    );
+
+    if (ref_db != avg_db
+            || memcmp(am_ref, am_buf, sizeof(int16_t) * n_samples)
+            || memcmp(fm_ref, fm_buf, sizeof(int16_t) * n_samples)) {
+        printf("MISMATCH for: %s\n", label);
+        return 1;
+    }
+    return 0;
+}
+
+/// Compare the integer dB of ratios against log10(), over the range of the level sums and estimates.
+static int check_ratio_to_db(void)
+{
+    double max_err = 0;
+    for (uint64_t num = 1; num < (1ULL << 40); num = num * 3 / 2 + 1) {
+        for (uint64_t den = 1; den < (1ULL << 24); den = den * 5 / 3 + 1) {
+            double err = fabs(ratio_to_db_q16(num, den) / 65536.0 - 10.0 * log10((double)num / den));
+            max_err    = err > max_err ? err : max_err;
+        }
+    }
+    if (max_err > 0.001 || ratio_to_db_q16(0, 1) != 0 || ratio_to_db_q16(16384, 16384) != 0) {
+        printf("MISMATCH for: ratio_to_db_q16, error %.5f dB\n", max_err);
+        return 1;
+    }
+    return 0;
+}
+
+/// Detect pure tones at +/- the deviation, and the same tones off center by a quarter of the deviation, with and without summing down.
+static int check_tones(void)
+{
+    enum { n = 4096 };
+    static uint8_t cu8_buf[2 * n];
+    static int16_t am_buf[n];
+    static int16_t y_buf[n];
+    uint32_t const deviation = 20000;
+    int failed               = 0;
+    for (int k = 0; k < 8; ++k) {
+        uint32_t rate = k & 4 ? 1000000 : 250000;
+        double freq = (k & 1 ? -1.0 : 1.0) * deviation + (k & 2 ? deviation / 4.0 : 0.0);
+        for (unsigned i = 0; i < n; ++i) {
+            cu8_buf[2 * i]     = (uint8_t)lround(127.5 + 100.0 * cos(2.0 * M_PI * freq * i / rate));
+            cu8_buf[2 * i + 1] = (uint8_t)lround(127.5 + 100.0 * sin(2.0 * M_PI * freq * i / rate));
+        }
+        demodtones_state_t state = {0};
+        baseband_demod_tones(&state, cu8_buf, BASEBAND_CU8, am_buf, 0, y_buf, n, rate, deviation);
+        // the FM demod reads the deviation as deviation * 65536 / rate
+        int want = (int)(deviation * 65534.0 / rate);
+        int got  = y_buf[n - 1];
+        if (k & 1 ? got > -want / 2 : got < want / 2) {
+            printf("MISMATCH for: baseband_demod_tones at %.0f Hz, got %d for %d\n", freq, got, k & 1 ? -want : want);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+/// Compare the native CS8 and CF32 kernels against converting to CU8 and CS16 first, as the file reader did.
+static int check_native(int8_t const *cs8_buf, float const *cf32_buf, unsigned long n_samples,
+        uint8_t *cu8_buf, int16_t *cs16_buf, uint16_t *ref_buf, uint16_t *y16_buf)
+{
+    int failed = 0;
+    demodfm_state_t fm_state;
+    float r, v;
+
+    for (unsigned long n = 0; n < n_samples * 2; n++) {
+        cu8_buf[n] = cs8_buf[n] + 128;
+        int s_tmp = cf32_buf[n] * INT16_MAX;
+        if (s_tmp < -INT16_MAX)
+            s_tmp = -INT16_MAX;
+        else if (s_tmp > INT16_MAX)
+            s_tmp = INT16_MAX;
+        cs16_buf[n] = s_tmp;
+    }
+
+    r = envelope_detect(cu8_buf, ref_buf, n_samples);
+    MEASURE("envelope_detect_cs8",
+        v = envelope_detect_cs8(cs8_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: envelope_detect_cs8\n");
+        failed++;
+    }
+
+    r = magnitude_est_cu8(cu8_buf, ref_buf, n_samples);
+    MEASURE("magnitude_est_cs8",
+        v = magnitude_est_cs8(cs8_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: magnitude_est_cs8\n");
+        failed++;
+    }
+
+    // the squelch estimates of a CS8 SDR input
+    if (envelope_level_strided(cu8_buf, n_samples, 16) != envelope_level_strided_cs8(cs8_buf, n_samples, 16)) {
+        printf("MISMATCH for: envelope_level_strided_cs8\n");
+        failed++;
+    }
+    if (magnitude_level_strided_cu8(cu8_buf, n_samples, 16) != magnitude_level_strided_cs8(cs8_buf, n_samples, 16)) {
+        printf("MISMATCH for: magnitude_level_strided_cs8\n");
+        failed++;
+    }
+
+    r = magnitude_est_cs16(cs16_buf, ref_buf, n_samples);
+    MEASURE("magnitude_est_cf32",
+        v = magnitude_est_cf32(cf32_buf, y16_buf, n_samples);
+    );
+    if (r != v || memcmp(ref_buf, y16_buf, sizeof(uint16_t) * n_samples)) {
+        printf("MISMATCH for: magnitude_est_cf32\n");
+        failed++;
+    }
+
+    baseband_demod_FM_reset(&fm_state);
+    baseband_demod_FM(&fm_state, cu8_buf, (int16_t *)ref_buf, n_samples, 250000, 0.1f);
+    baseband_demod_FM_reset(&fm_state);
+    MEASURE("baseband_demod_FM_cs8",
+        baseband_demod_FM_cs8(&fm_state, cs8_buf, (int16_t *)y16_buf, n_samples, 250000, 0.1f);
+    );
+    if (memcmp(ref_buf, y16_buf, sizeof(int16_t) * n_samples)) {
+        printf("MISMATCH for: baseband_demod_FM_cs8\n");
+        failed++;
+    }
+
+    baseband_demod_FM_reset(&fm_state);
+    baseband_demod_FM_cs16(&fm_state, cs16_buf, (int16_t *)ref_buf, n_samples, 250000, 0.1f);
+    baseband_demod_FM_reset(&fm_state);
+    MEASURE("baseband_demod_FM_cf32",
+        baseband_demod_FM_cf32(&fm_state, cf32_buf, (int16_t *)y16_buf, n_samples, 250000, 0.1f);
+    );
+    if (memcmp(ref_buf, y16_buf, sizeof(int16_t) * n_samples)) {
+        printf("MISMATCH for: baseband_demod_FM_cf32\n");
+        failed++;
+    }
+    return failed;
+}
+
 int main(int argc, char *argv[])
 {
     baseband_init();
@@ -82,6 +342,8 @@ int main(int argc, char *argv[])
     uint32_t *u32_buf;
     int16_t *s16_buf;
     int32_t *s32_buf;
+    int8_t *cs8_buf;
+    float *cf32_buf;
     char *filename;
     long n_read;
     unsigned long n_samples;
@@ -142,6 +404,49 @@ int main(int argc, char *argv[])
         //cs16_buf[i] = (int16_t)cu8_buf[i] * 256 - 32640;
     }
 
+    baseband_low_pass_filter_init(&state, 1);
+    printf("Selected kernels: %s\n", baseband_kernels()->name);
+    int failed = check_kernels(cu8_buf, cs16_buf, n_samples, u16_buf, y16_buf);
+    baseband_autotune(NULL);
+    char names[256];
+    baseband_kernel_names(names, sizeof(names));
+    printf("Autotuned kernels: %s\n", names);
+    failed += check_variant(baseband_kernels(), cu8_buf, cs16_buf, n_samples, u16_buf, y16_buf);
+    failed += check_ratio_to_db();
+    failed += check_tones();
+    for (int i = 0; i < 3; ++i) {
+        failed += check_fused(i < 2 ? (void *)cu8_buf : (void *)cs16_buf, i < 2 ? BASEBAND_CU8 : BASEBAND_CS16, i == 1, n_samples,
+                y16_buf, (int16_t *)u16_buf, s16_buf, (int16_t *)u32_buf, (int16_t *)s32_buf);
+    }
+
+    cs8_buf  = malloc(sizeof(int8_t) * 2 * n_samples);
+    if (!cs8_buf) {
+        FATAL_MALLOC("main()");
+    }
+    cf32_buf = malloc(sizeof(float) * 2 * n_samples);
+    if (!cf32_buf) {
+        FATAL_MALLOC("main()");
+    }
+    for (unsigned long i = 0; i < n_samples * 2; i++) {
+        cs8_buf[i]  = cu8_buf[i] - 128;
+        cf32_buf[i] = (cu8_buf[i] - 127.5f) / 128.0f;
+    }
+    uint8_t *cu8_conv = malloc(sizeof(uint8_t) * 2 * n_samples);
+    if (!cu8_conv) {
+        FATAL_MALLOC("main()");
+    }
+    int16_t *cs16_conv = malloc(sizeof(int16_t) * 2 * n_samples);
+    if (!cs16_conv) {
+        FATAL_MALLOC("main()");
+    }
+    failed += check_native(cs8_buf, cf32_buf, n_samples, cu8_conv, cs16_conv, u16_buf, y16_buf);
+    free(cu8_conv);
+    free(cs16_conv);
+    failed += check_fused(cs8_buf, BASEBAND_CS8, 0, n_samples,
+            y16_buf, (int16_t *)u16_buf, s16_buf, (int16_t *)u32_buf, (int16_t *)s32_buf);
+    failed += check_fused(cf32_buf, BASEBAND_CF32, 1, n_samples,
+            y16_buf, (int16_t *)u16_buf, s16_buf, (int16_t *)u32_buf, (int16_t *)s32_buf);
+
     MEASURE("envelope_detect",
         envelope_detect(cu8_buf, y16_buf, n_samples);
     );
@@ -154,15 +459,45 @@ int main(int argc, char *argv[])
     MEASURE("magnitude_true_cu8",
         magnitude_true_cu8(cu8_buf, y16_buf, n_samples);
     );
+    MEASURE("envelope_level_strided",
+        envelope_level_strided(cu8_buf, n_samples, 16);
+    );
     write_buf("bb.am.s16", y16_buf, sizeof(uint16_t) * n_samples);
     MEASURE("baseband_low_pass_filter",
         baseband_low_pass_filter(&state, y16_buf, (int16_t *)u16_buf, n_samples);
     );
     write_buf("bb.lp.am.s16", u16_buf, sizeof(int16_t) * n_samples);
+    for (unsigned order = 2; order <= FILTER_MAX_ORDER; order += 2) {
+        char label[64];
+        filter_state_t hi_state;
+        baseband_low_pass_filter_init(&hi_state, order);
+        snprintf(label, sizeof(label), "baseband_low_pass_filter (order %u)", order);
+        MEASURE(label,
+            baseband_low_pass_filter(&hi_state, y16_buf, s16_buf, n_samples);
+        );
+        // unity gain, a steady level passes unchanged
+        uint16_t level[4096];
+        for (unsigned i = 0; i < 4096; ++i)
+            level[i] = 16384;
+        baseband_low_pass_filter_reset(&hi_state);
+        baseband_low_pass_filter(&hi_state, level, s16_buf, 4096);
+        if (abs(s16_buf[4095] - 16384) > 2) {
+            printf("MISMATCH for: %s gain\n", label);
+            failed++;
+        }
+    }
     MEASURE("baseband_demod_FM",
         baseband_demod_FM(&fm_state, cu8_buf, s16_buf, n_samples, 250000, 0.1f);
     );
     write_buf("bb.fm.s16", s16_buf, sizeof(int16_t) * n_samples);
+    // the tones are summed down to 8 times the deviation first, not at all at 250k and 20k
+    demodtones_state_t tones_state = {0};
+    MEASURE("baseband_demod_tones (250k, 20k)",
+        baseband_demod_tones(&tones_state, cu8_buf, BASEBAND_CU8, (int16_t *)u16_buf, 0, s16_buf, n_samples, 250000, 20000);
+    );
+    MEASURE("baseband_demod_tones (1M, 20k)",
+        baseband_demod_tones(&tones_state, cu8_buf, BASEBAND_CU8, (int16_t *)u16_buf, 0, s16_buf, n_samples, 1000000, 20000);
+    );
 
     write_buf("bb.cs16", cs16_buf, sizeof(int16_t) * 2 * n_samples);
     //envelope_detect_cs16(cs16_buf, y32_buf, n_samples);
@@ -198,4 +533,8 @@ int main(int argc, char *argv[])
     free(u32_buf);
     free(s16_buf);
     free(s32_buf);
+    free(cs8_buf);
+    free(cf32_buf);
+
+    return failed ? 1 : 0;
 }
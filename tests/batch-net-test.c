@@ -0,0 +1,98 @@
+/*
+ * Batch decoding event exchange test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch_net.h"
+#include "data.h"
+#include "test_util.h"
+
+// parse the text and print it again, returns 1 if the text is unchanged
+static int round_trip(char const *json)
+{
+    data_t *data = batch_parse_event(json, strlen(json));
+    if (!data)
+        return 0;
+    char buf[1024];
+    data_print_jsons_typed(data, buf, sizeof(buf));
+    data_free(data);
+    if (strcmp(buf, json) != 0) {
+        fprintf(stderr, "expected %s\n     got %s\n", json, buf);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    // the events of the workers read back with the types of their values
+    data_t *event = data_make(
+            "model", "", DATA_STRING, "Test-Sensor",
+            "id", "", DATA_INT, 42,
+            "temperature_C", "", DATA_FORMAT, "%.1f C", DATA_DOUBLE, -8.0,
+            "humidity", "", DATA_DOUBLE, 0.0,
+            "rain_mm", "", DATA_DOUBLE, 12.25,
+            "energy", "", DATA_DOUBLE, 2.5e9,
+            "codes", "", DATA_ARRAY, data_array(2, DATA_STRING, (char const *[]){"{25}fb2dd58", "a\"b\\c\n"}),
+            "rows", "", DATA_ARRAY, data_array(3, DATA_INT, (int[]){1, -2, 3}),
+            "levels", "", DATA_ARRAY, data_array(2, DATA_DOUBLE, (double[]){1.5, -0.5}),
+            "tags", "", DATA_DATA, data_make("site", "", DATA_STRING, "north", NULL),
+            NULL);
+    CHECK(event != NULL);
+    char json[1024];
+    data_print_jsons_typed(event, json, sizeof(json));
+    CHECK(strstr(json, "\"temperature_C\":-8.0,\"humidity\":0.0,") != NULL);
+    CHECK(round_trip(json));
+
+    // the JSON of the outputs is unchanged, negatives and zero print with %g
+    data_print_jsons(event, json, sizeof(json));
+    CHECK(strstr(json, "\"temperature_C\":-8,\"humidity\":0,\"rain_mm\":12.25,") != NULL);
+    data_free(event);
+    event = data_make(
+            "a", "", DATA_DOUBLE, -123.456789,
+            "b", "", DATA_DOUBLE, 123.456789,
+            NULL);
+    CHECK(event != NULL);
+    data_print_jsons(event, json, sizeof(json));
+    CHECK(strcmp(json, "{\"a\":-123.457,\"b\":123.45679}") == 0);
+    data_print_jsons_typed(event, json, sizeof(json));
+    CHECK(strcmp(json, "{\"a\":-123.45679,\"b\":123.45679}") == 0);
+    data_free(event);
+
+    // nested arrays and objects in arrays
+    CHECK(round_trip("{\"a\":[[1,2],[3]],\"b\":[{\"c\":1},{\"c\":2}],\"e\":[]}"));
+
+    // escapes are decoded, booleans are integers, nulls are dropped
+    char const *text = "{\"s\" : \"caf\\u00e9 \\ud83d\\ude00\", \"t\" : true, \"n\" : null, \"big\" : 12345678901}";
+    data_t *data     = batch_parse_event(text, strlen(text));
+    CHECK(data != NULL);
+    if (data) {
+        CHECK(strcmp(data->key, "s") == 0 && data->type == DATA_STRING);
+        CHECK(strcmp(data->value.v_ptr, "caf\xc3\xa9 \xf0\x9f\x98\x80") == 0);
+        data_t *t = data->next;
+        CHECK(t && strcmp(t->key, "t") == 0 && t->type == DATA_INT && t->value.v_int == 1);
+        data_t *big = t ? t->next : NULL;
+        CHECK(big && strcmp(big->key, "big") == 0 && big->type == DATA_DOUBLE && big->value.v_dbl == 12345678901.0);
+        CHECK(big && !big->next);
+    }
+    data_free(data);
+
+    // not an event
+    CHECK(batch_parse_event("", 0) == NULL);
+    CHECK(batch_parse_event("[1, 2]", 6) == NULL);
+    CHECK(batch_parse_event("{\"a\" : [1, \"x\"]}", 16) == NULL);
+    CHECK(batch_parse_event("{\"a\" : \"\\q\"}", 12) == NULL);
+    CHECK(batch_parse_event("{\"a\" : 1", 8) == NULL);
+
+    return test_result();
+}
@@ -0,0 +1,104 @@
+/*
+ * SDR transfer tuning test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "buf_tune.h"
+#include "test_util.h"
+
+/// CU8 at 1 MS/s.
+#define BYTES_PER_S 2000000
+/// A 16 KiB transfer, 8192 us.
+#define BUF_LEN 16384
+#define BUF_NS 8192000ULL
+/// The ring of the low latency mode.
+#define MAX_BYTES (128ULL * BUF_LEN)
+
+// feed a second of buffers handed over late by jitter_us every 10th buffer, returns 1 if the window was completed
+static int feed(buf_tune_t *tune, int64_t *publish_ns, unsigned jitter_us, unsigned busy_us, unsigned lost)
+{
+    int r = 0;
+    for (unsigned i = 0; i < 123; ++i) {
+        int64_t late = i % 10 == 5 ? (int64_t)jitter_us * 1000 : 0;
+        *publish_ns += BUF_NS;
+        r |= buf_tune_buffer(tune, *publish_ns + late, 20000, (uint64_t)busy_us * 1000, BUF_NS, i == 7 ? lost : 0);
+        *publish_ns += late;
+    }
+    return r;
+}
+
+int main(void)
+{
+    int64_t publish_ns = 1000000000;
+
+    // nothing measured, nothing chosen
+    buf_tune_t *tune = buf_tune_create(2000000000);
+    CHECK(tune != NULL);
+    if (!tune)
+        return 1;
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, MAX_BYTES, 128) == -1);
+    CHECK(buf_tune_buf_num(tune) == 0);
+
+    // a steady input gets the shortest transfer and a quarter second ring
+    CHECK(feed(tune, &publish_ns, 100, 500, 0) == 0);
+    CHECK(feed(tune, &publish_ns, 100, 500, 0) == 1);
+    CHECK(feed(tune, &publish_ns, 100, 500, 0) == 0); // measured once
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, MAX_BYTES, 128) == 0);
+    CHECK(buf_tune_buf_len(tune) == BUF_LEN);
+    CHECK(buf_tune_buf_num(tune) >= 250000 / 8192 && buf_tune_buf_num(tune) <= 40);
+    CHECK(buf_tune_jitter_us(tune, 99) <= 200);
+    buf_tune_free(tune);
+
+    // a jittery input gets transfers over twice the jitter, and a ring over the stalls
+    tune = buf_tune_create(2000000000);
+    CHECK(tune != NULL);
+    if (!tune)
+        return 1;
+    feed(tune, &publish_ns, 40000, 500, 0);
+    feed(tune, &publish_ns, 40000, 500, 0);
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, MAX_BYTES, 128) == 0);
+    uint32_t len = buf_tune_buf_len(tune);
+    uint32_t num = buf_tune_buf_num(tune);
+    CHECK(len % BUF_TUNE_LEN_STEP == 0);
+    CHECK((uint64_t)len * 1000000 / BYTES_PER_S >= 2 * 40000);
+    CHECK((uint64_t)num * len * 1000000 / BYTES_PER_S >= 2 * 40000);
+    CHECK((uint64_t)num * len <= MAX_BYTES);
+    buf_tune_free(tune);
+
+    // a busy input keeps its transfers, lost buffers double them
+    tune = buf_tune_create(1000000000);
+    CHECK(tune != NULL);
+    if (!tune)
+        return 1;
+    feed(tune, &publish_ns, 100, 6000, 0);
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, 4 * BUF_LEN, MAX_BYTES, 128) == 0);
+    CHECK(buf_tune_buf_len(tune) == 4 * BUF_LEN);
+    buf_tune_free(tune);
+
+    tune = buf_tune_create(1000000000);
+    CHECK(tune != NULL);
+    if (!tune)
+        return 1;
+    feed(tune, &publish_ns, 100, 500, 3);
+    CHECK(buf_tune_lost(tune) == 3);
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, MAX_BYTES, 128) == 0);
+    CHECK(buf_tune_buf_len(tune) == 2 * BUF_LEN);
+
+    // the ring stays within the memory and the queue
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, 8 * BUF_LEN, 128) == 0);
+    CHECK(buf_tune_buf_num(tune) * buf_tune_buf_len(tune) <= 8 * BUF_LEN);
+    CHECK(buf_tune_choose(tune, BYTES_PER_S, BUF_LEN, MAX_BYTES, 6) == 0);
+    CHECK(buf_tune_buf_num(tune) == 6);
+    buf_tune_free(tune);
+
+    return test_result();
+}
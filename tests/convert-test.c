@@ -0,0 +1,98 @@
+/*
+ * Sample format conversion evaluation
+ *
+ * Functional and speed test for the sample format conversion kernels.
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "convert.h"
+
+#define MEASURE(label, block)                                              \
+    do {                                                                   \
+        clock_t start = clock();                                           \
+        block;                                                             \
+        clock_t stop   = clock();                                          \
+        double elapsed = (double)(stop - start) * 1000.0 / CLOCKS_PER_SEC; \
+        printf("Time elapsed in ms: %f for: %s\n", elapsed, label);        \
+    } while (0)
+
+// an odd count of values exercises the tails of all kernels
+#define NUM_VALUES (4 * 1024 * 1024 + 13)
+
+#define CHECK(kernel, src, dst_type, len)                                           \
+    do {                                                                            \
+        snprintf(label, sizeof(label), #kernel " (%s)", var->name);                 \
+        memset(ref_buf, 0, sizeof(float) * NUM_VALUES);                             \
+        memset(out_buf, 0xff, sizeof(float) * NUM_VALUES);                          \
+        ref->kernel(src, (dst_type *)ref_buf, len);                                 \
+        MEASURE(label, var->kernel(src, (dst_type *)out_buf, len));                 \
+        if (memcmp(ref_buf, out_buf, sizeof(dst_type) * (len))) {                   \
+            printf("MISMATCH for: %s\n", label);                                    \
+            failed++;                                                               \
+        }                                                                           \
+    } while (0)
+
+int main(void)
+{
+    uint8_t *u8_buf  = malloc(NUM_VALUES);
+    int16_t *s16_buf = malloc(sizeof(int16_t) * NUM_VALUES);
+    float *f32_buf   = malloc(sizeof(float) * NUM_VALUES);
+    float *ref_buf   = malloc(sizeof(float) * NUM_VALUES);
+    float *out_buf   = malloc(sizeof(float) * NUM_VALUES);
+    if (!u8_buf || !s16_buf || !f32_buf || !ref_buf || !out_buf) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    // all values including the extremes, floats past the clamp range
+    srand(433);
+    for (unsigned long n = 0; n < NUM_VALUES; n++) {
+        u8_buf[n]  = rand() & 0xff;
+        s16_buf[n] = (int16_t)(rand() & 0xffff);
+        f32_buf[n] = (rand() % 40001 - 20000) / 10000.0f;
+    }
+    s16_buf[0] = INT16_MIN;
+    s16_buf[1] = INT16_MAX;
+    f32_buf[0] = -1.0f;
+    f32_buf[1] = 1.0f;
+
+    int failed = 0;
+    convert_kernels_t const *ref = convert_kernels_variant(0);
+    convert_kernels_t const *var;
+    for (unsigned idx = 0; (var = convert_kernels_variant(idx)); ++idx) {
+        char label[64];
+        CHECK(cu8_to_cs16, u8_buf, int16_t, NUM_VALUES);
+        CHECK(cs16_to_cu8, s16_buf, uint8_t, NUM_VALUES);
+        CHECK(cu8_cs8, u8_buf, uint8_t, NUM_VALUES);
+        CHECK(cs16_to_cs8, s16_buf, int8_t, NUM_VALUES);
+        CHECK(u8_to_f32, u8_buf, float, NUM_VALUES);
+        CHECK(s16_to_f32, s16_buf, float, NUM_VALUES);
+        // the Q channel starts one value in, the last value is not read
+        CHECK(u8_channel_to_f32, u8_buf + 1, float, NUM_VALUES / 2);
+        CHECK(s16_channel_to_f32, s16_buf + 1, float, NUM_VALUES / 2);
+        CHECK(f32_to_s16, f32_buf, int16_t, NUM_VALUES);
+    }
+
+    free(u8_buf);
+    free(s16_buf);
+    free(f32_buf);
+    free(ref_buf);
+    free(out_buf);
+
+    if (failed) {
+        printf("%d MISMATCHES\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Decoder usage test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decoder_usage.h"
+#include "test_util.h"
+
+// the config written, NUL terminated
+static char *write_config(decoder_usage_t const *usage, double seconds)
+{
+    static char buf[4096];
+    FILE *fp = tmpfile();
+    if (!fp)
+        return NULL;
+    CHECK(decoder_usage_write(usage, fp, seconds) == 0);
+    rewind(fp);
+    size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+    buf[len]   = '\0';
+    fclose(fp);
+    return buf;
+}
+
+int main(void)
+{
+    decoder_usage_t *usage = decoder_usage_create();
+    CHECK(usage != NULL);
+    if (!usage)
+        return 1;
+
+    // two stats intervals, a decoder only decodes in the second one
+    decoder_usage_add(usage, 55, "Acurite 606TX", 0, 3, 1000000000);
+    decoder_usage_add(usage, 19, "Nexus", 0, 0, 500000000);
+    decoder_usage_add(usage, 0, "doorbell", 2, 0, 100000000);
+    decoder_usage_add(usage, 0, "remote", 0, 7, 200000000);
+    decoder_usage_add(usage, 55, "Acurite 606TX", 4, 1, 1000000000);
+    decoder_usage_add(usage, 0, "doorbell", 1, 0, 100000000);
+    CHECK(decoder_usage_seen(usage) == 2);
+
+    // the counts not yet recorded are added to a copy
+    decoder_usage_t *clone = decoder_usage_clone(usage);
+    CHECK(clone != NULL);
+    if (!clone) {
+        decoder_usage_free(usage);
+        return 1;
+    }
+    decoder_usage_add(clone, 89, "Ford", 1, 0, 200000000);
+    CHECK(decoder_usage_seen(clone) == 3);
+    CHECK(decoder_usage_seen(usage) == 2);
+    decoder_usage_free(clone);
+
+    char *config = write_config(usage, 100.0);
+    CHECK(config != NULL);
+    if (config) {
+        // the decoders seen, by protocol number, the flex decoders last
+        char *acurite  = strstr(config, "\nprotocol 55 # Acurite 606TX, 4 decoded, 4 aborted, 2.000 s\n");
+        char *doorbell = strstr(config, "\n# keep the decoder \"doorbell\", 3 decoded");
+        CHECK(acurite != NULL);
+        CHECK(doorbell != NULL && doorbell > acurite);
+        // then the others by the time spent, as comments
+        char *nexus  = strstr(config, "\n# protocol 19 # Nexus, 0 decoded, 0 aborted, 0.500 s\n");
+        char *remote = strstr(config, "\n# drop the decoder \"remote\", 0 decoded, 7 aborted, 0.200 s\n");
+        CHECK(nexus != NULL && nexus > doorbell);
+        CHECK(remote != NULL && remote > nexus);
+        CHECK(!strstr(config, "\nprotocol 19"));
+        // the others used 0.7 s of 2.9 s, 0.7% of a core over 100 s
+        CHECK(strstr(config, "# 2 of 4 decoders decoded a message, the others used 24.1% of the decoder time,\n") != NULL);
+        CHECK(strstr(config, "# 0.7 s or 0.70% of a CPU core,") != NULL);
+    }
+
+    decoder_usage_free(usage);
+
+    return test_result();
+}
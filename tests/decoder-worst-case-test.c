@@ -0,0 +1,210 @@
+/*
+ * Worst case timing test of the decoders
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r_lib.h"
+#include "r_device.h"
+#include "rtl_433.h"
+#include "bitbuffer.h"
+#include "pulse_data.h"
+#include "compat_time.h"
+
+/// With a limit in ms given as argument a package taking longer on any decoder fails the test,
+/// the timing is the fastest of this many runs. Without a limit the times are only reported.
+#define TIMING_RUNS 5
+#define SAMPLE_RATE 250000
+/// Pulses in a row of the edges package, the gap after is just over the gap limit.
+#define EDGES_ROW_PULSES 24
+/// The slowest decoders are listed.
+#define REPORT_SLOWEST 5
+
+typedef enum {
+    PACKAGE_EDGES, ///< long and short widths alternating at the tolerance edges, rows split at the gap limit
+    PACKAGE_ROWS,  ///< a row break after every other pulse, the most rows after slicing
+    PACKAGE_NOISE, ///< random widths around the timing of the decoder
+    PACKAGES,
+} package_kind_t;
+
+static char const *const package_names[PACKAGES] = {"edges", "rows", "noise"};
+
+typedef struct {
+    unsigned protocol_num;
+    char const *name;
+    unsigned kind;
+    uint64_t ns;
+} timing_t;
+
+static void on_event(struct data const *event, void *ctx)
+{
+    (void)event;
+    (void)ctx;
+}
+
+static int samples(float us)
+{
+    int n = (int)(us * SAMPLE_RATE / 1000000);
+    return n > 0 ? n : 1;
+}
+
+// a package of the maximum length built from the timing of the decoder
+static void make_package(pulse_data_t *pulses, r_device const *dev, package_kind_t kind, unsigned *seed)
+{
+    float s   = dev->short_width > 0 ? dev->short_width : 100;
+    float l   = dev->long_width > s ? dev->long_width : s;
+    float tol = dev->tolerance > 0 ? dev->tolerance : (l > s ? (l - s) / 4 : s / 4);
+    // a gap just over the gap limit splits a row, a gap just over the reset limit ends the package
+    float reset = dev->reset_limit > 0 ? dev->reset_limit : 4 * l;
+    float split = dev->gap_limit > 0 && dev->gap_limit + tol < reset ? dev->gap_limit + tol : 0;
+
+    pulse_data_clear(pulses);
+    pulse_data_reserve(pulses, PD_MAX_PULSES);
+    pulses->sample_rate = SAMPLE_RATE;
+    for (unsigned i = 0; i < PD_MAX_PULSES; ++i) {
+        float pulse, gap;
+        if (kind == PACKAGE_NOISE) {
+            *seed = *seed * 1103515245 + 12345;
+            pulse = s / 2 + (float)((*seed >> 16) % 1000) * (2 * l - s / 2) / 1000;
+            *seed = *seed * 1103515245 + 12345;
+            gap   = s / 2 + (float)((*seed >> 16) % 1000) * (2 * l - s / 2) / 1000;
+        }
+        else {
+            pulse = i & 1 ? l + tol : s - tol;
+            gap   = i & 1 ? s - tol : l + tol;
+            unsigned row = kind == PACKAGE_ROWS ? 2 : EDGES_ROW_PULSES;
+            if (split > 0 && i % row == row - 1)
+                gap = split;
+        }
+        pulses->pulse[i] = samples(pulse);
+        pulses->gap[i]   = samples(gap);
+    }
+    pulses->gap[PD_MAX_PULSES - 1] = samples(reset) + 1;
+    pulses->num_pulses             = PD_MAX_PULSES;
+}
+
+// the decoder returns DECODE_ABORT_LENGTH for bits just outside its declared rows, as the dispatcher assumes
+static int check_rows(r_device const *dev)
+{
+    decoder_rows_t const *r = &dev->rows;
+    unsigned lengths[2]     = {r->min_bits ? r->min_bits - 1 : 0, r->max_bits ? r->max_bits + 1 : 0};
+    unsigned counts[2]      = {r->min_rows ? r->min_rows - 1 : 0, r->max_rows ? r->max_rows + 1 : 0};
+    int failed              = 0;
+    for (unsigned k = 0; k < 4; ++k) {
+        unsigned bits_len = k < 2 ? lengths[k] : (r->min_bits ? r->min_bits : 1);
+        unsigned rows     = k < 2 ? (r->min_rows ? r->min_rows : 1) : counts[k - 2];
+        if ((k < 2 && !bits_len) || (k >= 2 && !rows) || bits_len > BITBUF_COLS * 8 || rows > BITBUF_ROWS)
+            continue; // no bound or no bits that exceed it
+        bitbuffer_t bits = {0};
+        bits.num_rows    = (uint16_t)rows;
+        for (unsigned row = 0; row < rows; ++row) {
+            bits.bits_per_row[row] = (uint16_t)bits_len;
+        }
+        r_device decoder = *dev;
+        int ret          = decoder.decode_fn(&decoder, &bits);
+        if (ret != DECODE_ABORT_LENGTH) {
+            fprintf(stderr, "TEST failed: decoder %u \"%s\" gave %d for %u rows of %u bits outside its declared rows\n",
+                    dev->protocol_num, dev->name, ret, rows, bits_len);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+static int is_fsk(r_device const *dev)
+{
+    return dev->modulation >= FSK_DEMOD_MIN_VAL;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned limit_ms = argc > 1 ? (unsigned)atoi(argv[1]) : 0;
+    unsigned runs     = limit_ms ? TIMING_RUNS : 1;
+
+    r_lib_t *lib = r_lib_create(SAMPLE_RATE, on_event, NULL);
+    if (!lib) {
+        fprintf(stderr, "TEST failed: r_lib_create()\n");
+        return 1;
+    }
+    r_cfg_t *cfg    = r_lib_cfg(lib);
+    int num_devices = cfg->num_r_devices;
+    r_lib_free(lib);
+
+    timing_t slowest[REPORT_SLOWEST] = {{0}};
+    int failed          = 0;
+    int decoders        = 0;
+    unsigned seed       = 1;
+    pulse_data_t pulses = {0};
+    for (int i = 0; i < num_devices; ++i) {
+        // each decoder on its own, the earlier ones can not claim the package
+        lib = r_lib_create(SAMPLE_RATE, on_event, NULL);
+        if (!lib)
+            continue;
+        cfg                 = r_lib_cfg(lib);
+        r_device const *dev = &cfg->devices[i];
+        unsigned protocol   = dev->protocol_num;
+        char const *name    = dev->name;
+        if (r_lib_register_protocol(lib, protocol, NULL) < 0) {
+            r_lib_free(lib);
+            continue;
+        }
+        decoders++;
+        failed += check_rows(dev);
+        for (unsigned kind = 0; kind < PACKAGES; ++kind) {
+            // the fastest run, the others were slowed down by the rest of the machine
+            uint64_t ns        = UINT64_MAX;
+            unsigned kind_seed = seed;
+            for (unsigned run = 0; run < runs; ++run) {
+                seed = kind_seed;
+                make_package(&pulses, dev, kind, &seed);
+                uint64_t start = time_monotonic_ns();
+                r_lib_push_pulses(lib, &pulses, is_fsk(dev));
+                uint64_t run_ns = time_monotonic_ns() - start;
+                ns              = run_ns < ns ? run_ns : ns;
+            }
+
+            if (limit_ms && ns > (uint64_t)limit_ms * 1000000) {
+                fprintf(stderr, "TEST failed: decoder %u \"%s\" took %.1f ms on the %s package (limit %u ms)\n",
+                        protocol, name, ns / 1e6, package_names[kind], limit_ms);
+                failed++;
+            }
+            // keep the slowest, sorted descending
+            timing_t t = {protocol, name, kind, ns};
+            for (int k = 0; k < REPORT_SLOWEST; ++k) {
+                if (t.ns > slowest[k].ns) {
+                    timing_t swap = slowest[k];
+                    slowest[k]    = t;
+                    t             = swap;
+                }
+            }
+        }
+        r_lib_free(lib);
+    }
+    pulse_data_free(&pulses);
+
+    fprintf(stderr, "%d decoders on %d packages of %d pulses each, the slowest:\n", decoders, PACKAGES, PD_MAX_PULSES);
+    for (int k = 0; k < REPORT_SLOWEST && slowest[k].ns; ++k) {
+        fprintf(stderr, "  %.3f ms decoder %u \"%s\" on the %s package\n",
+                slowest[k].ns / 1e6, slowest[k].protocol_num, slowest[k].name, package_names[slowest[k].kind]);
+    }
+    if (!decoders) {
+        fprintf(stderr, "TEST failed: no decoders\n");
+        failed++;
+    }
+
+    if (failed) {
+        fprintf(stderr, "%d FAILED\n", failed);
+        return 1;
+    }
+    return 0;
+}
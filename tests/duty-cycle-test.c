@@ -0,0 +1,127 @@
+/*
+ * Duty-cycled listening simulation test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "duty_cycle.h"
+#include "test_util.h"
+
+#define FRAME_MS 256
+#define RUN_MS (4 * 3600 * 1000ULL)
+#define SURVEY_MS (180 * 1000ULL)
+#define EVERY_MS (3600 * 1000ULL)
+
+typedef struct {
+    char const *key;
+    unsigned period_ms; ///< the true period, the clock is off from the nominal period
+    unsigned start_ms;
+    unsigned sent;   ///< transmissions after the second full listen window
+    unsigned caught;
+} sensor_t;
+
+static void test_sensors(void)
+{
+    sensor_t sensors[] = {
+            {.key = "Acurite-Tower|1234", .period_ms = 30040, .start_ms = 2000},
+            {.key = "LaCrosse-TX141THBv2|77", .period_ms = 50500, .start_ms = 9000},
+            {.key = "Fineoffset-WH24|201", .period_ms = 48000, .start_ms = 31000},
+            {.key = "Nexus-TH|12", .period_ms = 56750, .start_ms = 40000},
+            // appears after the first full listen window
+            {.key = "Bresser-6in1|4242", .period_ms = 60000, .start_ms = 1200000},
+    };
+    unsigned count = sizeof(sensors) / sizeof(*sensors);
+
+    duty_cycle_t *dc = duty_cycle_create(SURVEY_MS, EVERY_MS);
+    CHECK(dc);
+    if (!dc)
+        return;
+    uint64_t frames   = 0;
+    uint64_t listened = 0;
+    for (uint64_t ms = 0; ms < RUN_MS; ms += FRAME_MS) {
+        int listen = duty_cycle_listen(dc, ms);
+        frames += 1;
+        listened += listen;
+        // transmissions of each sensor in [ms, ms + FRAME_MS), with two repeats
+        for (unsigned i = 0; i < count; ++i) {
+            sensor_t *s = &sensors[i];
+            if (ms + FRAME_MS <= s->start_ms)
+                continue;
+            uint64_t n  = ms > s->start_ms ? (ms - s->start_ms + s->period_ms - 1) / s->period_ms : 0;
+            uint64_t tx = s->start_ms + n * s->period_ms;
+            if (tx >= ms + FRAME_MS)
+                continue;
+            // a new transmitter is only learned in a full listen window, count after the second one
+            int counted = ms >= EVERY_MS + SURVEY_MS;
+            s->sent += counted;
+            if (listen) {
+                s->caught += counted;
+                duty_cycle_event(dc, s->key, tx);
+                duty_cycle_event(dc, s->key, tx + 120);
+            }
+        }
+    }
+    fprintf(stderr, "listened %u of %u frames\n", (unsigned)listened, (unsigned)frames);
+    for (unsigned i = 0; i < count; ++i) {
+        fprintf(stderr, "sensor %u: caught %u of %u\n", i, sensors[i].caught, sensors[i].sent);
+        CHECK(sensors[i].caught * 100 >= sensors[i].sent * 95);
+    }
+    CHECK(listened * 4 <= frames);
+    CHECK(duty_cycle_periodic(dc) == count);
+    duty_cycle_free(dc);
+}
+
+static void test_nothing_learned(void)
+{
+    duty_cycle_t *dc = duty_cycle_create(SURVEY_MS, EVERY_MS);
+    CHECK(dc);
+    if (!dc)
+        return;
+    // a transmitter seen once and no periodic one, keep listening
+    duty_cycle_event(dc, "Oregon-THN132N|88", 1000);
+    unsigned skipped = 0;
+    for (uint64_t ms = 0; ms < 2 * EVERY_MS; ms += FRAME_MS) {
+        skipped += !duty_cycle_listen(dc, ms);
+    }
+    CHECK(skipped == 0);
+    CHECK(duty_cycle_periodic(dc) == 0);
+    duty_cycle_free(dc);
+}
+
+static void test_stale(void)
+{
+    duty_cycle_t *dc = duty_cycle_create(SURVEY_MS, EVERY_MS);
+    CHECK(dc);
+    if (!dc)
+        return;
+    for (uint64_t ms = 0; ms < 4 * 30000; ms += 30000) {
+        duty_cycle_listen(dc, ms);
+        duty_cycle_event(dc, "Ambientweather-F007TH|3", ms);
+    }
+    CHECK(duty_cycle_periodic(dc) == 1);
+    // after the survey and between the transmissions the input is skipped
+    CHECK(!duty_cycle_listen(dc, SURVEY_MS + 10000));
+    CHECK(duty_cycle_listen(dc, SURVEY_MS + 30000));
+    // the transmitter went silent, it is dropped after a few periods
+    duty_cycle_listen(dc, SURVEY_MS + 10 * 30000);
+    CHECK(duty_cycle_periodic(dc) == 0);
+    CHECK(duty_cycle_listen(dc, SURVEY_MS + 10 * 30000 + 5000));
+    duty_cycle_free(dc);
+}
+
+int main(void)
+{
+    test_sensors();
+    test_nothing_learned();
+    test_stale();
+
+    return test_result();
+}
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+
+"""Check that the optimized paths of rtl_433 decode a corpus of captures exactly as the reference does.
+
+The reference is the scalar kernels on a single thread. Each configuration reads the same
+captures, the JSON events are compared after dropping the wall clock times, the package
+offsets ("@0.2s") are kept. Reports the first differing event of a configuration with its
+file, offset, and protocol, and the speedup of each configuration over the reference.
+
+Usage: equivalence.py [-b build/src/rtl_433] [-n repeat] [-c name=args ...] captures_or_dirs...
+Exits with 1 if any configuration differs from the reference.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import shlex
+import subprocess
+import sys
+import time
+
+REFERENCE = ("reference", "-Y kernels=scalar")
+
+CONFIGURATIONS = [
+    ("simd", ""),
+    ("files", "-j 4"),
+    ("decoders", "-J 4"),
+    ("pipeline", "-Y pipeline"),
+    ("all", "-j 4 -J 4"),
+]
+
+CAPTURE_EXTS = (".cu8", ".cs8", ".cs16", ".cf32", ".am.s16", ".fm.s16", ".ook", ".sr")
+
+
+def find_captures(paths):
+    """List the capture files, directories are searched recursively in sorted order."""
+    files = []
+    for path in paths:
+        if not os.path.isdir(path):
+            files.append(path)
+            continue
+        for root, dirs, names in os.walk(path):
+            dirs.sort()
+            files += [os.path.join(root, name) for name in sorted(names) if name.endswith(CAPTURE_EXTS)]
+    return files
+
+
+def canonical(line):
+    """The event without the wall clock time, None if the line is not an event."""
+    try:
+        event = json.loads(line)
+    except ValueError:
+        return None
+    if not isinstance(event, dict):
+        return None
+    stamp = event.get("time")
+    if isinstance(stamp, str) and not stamp.startswith("@"):
+        del event["time"]
+    return json.dumps(event, separators=(",", ":"))
+
+
+def run(rtl_433, args, files, repeat):
+    """Decode the files, returns the canonical events and the fastest time in seconds."""
+    cmd = [rtl_433] + args + ["-F", "json", "-K", "FILE", "-M", "protocol"] + files
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+        elapsed = time.perf_counter() - start
+        if proc.returncode != 0:
+            sys.exit("{} failed ({}):\n{}".format(" ".join(cmd), proc.returncode, proc.stderr))
+        best = elapsed if best is None else min(best, elapsed)
+    events = [e for e in (canonical(line) for line in proc.stdout.splitlines()) if e is not None]
+    return events, best
+
+
+def describe(event):
+    """The file, offset, and protocol of an event."""
+    fields = json.loads(event)
+    return "{} {} protocol {} ({})".format(
+        fields.get("tag", "?"), fields.get("time", "?"), fields.get("protocol", "?"), fields.get("model", "?"))
+
+
+def first_divergence(ref, events):
+    """Describe the first event that differs, None if the streams are equal."""
+    for i, (a, b) in enumerate(zip(ref, events)):
+        if a != b:
+            return "event {}: {}\n    expected {}\n         got {}".format(i + 1, describe(a), a, b)
+    if len(ref) > len(events):
+        return "event {} missing: {}\n    expected {}".format(len(events) + 1, describe(ref[len(events)]), ref[len(events)])
+    if len(events) > len(ref):
+        return "event {} extra: {}\n         got {}".format(len(ref) + 1, describe(events[len(ref)]), events[len(ref)])
+    return None
+
+
+def digest(events):
+    return hashlib.sha256("\n".join(events).encode("utf-8")).hexdigest()[:16]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-b", "--binary", default="rtl_433", help="the rtl_433 to run")
+    parser.add_argument("-n", "--repeat", type=int, default=3, help="time the fastest of this many runs")
+    parser.add_argument("-a", "--args", default="", help="options for all runs, e.g. decoder selections")
+    parser.add_argument("-c", "--config", action="append", metavar="NAME=ARGS",
+                        help="a configuration to check instead of the default ones")
+    parser.add_argument("paths", nargs="+", help="capture files or directories of captures")
+    args = parser.parse_args()
+
+    configs = CONFIGURATIONS
+    if args.config:
+        configs = [(c.partition("=")[0], c.partition("=")[2]) for c in args.config]
+
+    files = find_captures(args.paths)
+    if not files:
+        sys.exit("No captures found")
+    common = shlex.split(args.args)
+
+    ref, ref_time = run(args.binary, common + shlex.split(REFERENCE[1]), files, args.repeat)
+    print("{:<12} {} events {} {:8.3f} s".format(REFERENCE[0], len(ref), digest(ref), ref_time))
+
+    failed = 0
+    for name, opts in configs:
+        events, elapsed = run(args.binary, common + shlex.split(opts), files, args.repeat)
+        diverged = first_divergence(ref, events)
+        print("{:<12} {} events {} {:8.3f} s {:5.2f}x {}".format(
+            name, len(events), digest(events), elapsed, ref_time / elapsed, "DIFFERS" if diverged else "ok"))
+        if diverged:
+            print("  " + diverged)
+            failed += 1
+
+    print("{} files, {} of {} configurations differ".format(len(files), failed, len(configs)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
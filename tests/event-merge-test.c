@@ -0,0 +1,112 @@
+/*
+ * Event merge test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_merge.h"
+#include "data.h"
+#include "test_util.h"
+
+#define MAX_OUTPUT 64
+
+typedef struct {
+    int times[MAX_OUTPUT]; ///< the "time" of the events output, in order
+    unsigned count;
+} collect_t;
+
+static void collect(void *ctx, data_t *data)
+{
+    collect_t *c = ctx;
+    CHECK(data && !strcmp(data->key, "time"));
+    if (data && c->count < MAX_OUTPUT)
+        c->times[c->count++] = data->value.v_int;
+    data_free(data);
+}
+
+static int sources[3]; ///< the addresses are the sources
+
+static void event(event_merge_t *merge, unsigned source, int time_us)
+{
+    data_t *data = data_make("time", "", DATA_INT, time_us, NULL);
+    CHECK(event_merge_hold(merge, event_merge_mark(data, &sources[source], time_us)) == 1);
+}
+
+static void progress(event_merge_t *merge, unsigned source, int time_us)
+{
+    CHECK(event_merge_hold(merge, event_merge_mark(NULL, &sources[source], time_us)) == 1);
+}
+
+static int ascending(collect_t const *c)
+{
+    for (unsigned i = 1; i < c->count; ++i) {
+        if (c->times[i] < c->times[i - 1])
+            return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    collect_t c = {0};
+    event_merge_t *merge = event_merge_create(1, collect, &c); // a window of 1000 us
+    CHECK(merge != NULL);
+    if (!merge)
+        return 1;
+
+    // an event without a mark is not held
+    data_t *unmarked = data_make("time", "", DATA_INT, 0, NULL);
+    CHECK(event_merge_hold(merge, unmarked) == 0);
+    data_free(unmarked);
+
+    // three sources deliver their buffers in turn, each in order
+    progress(merge, 0, 0);
+    progress(merge, 1, 0);
+    progress(merge, 2, 0);
+    event(merge, 0, 100);
+    event(merge, 0, 300);
+    progress(merge, 0, 400);
+    event(merge, 1, 50);
+    event(merge, 1, 350);
+    progress(merge, 1, 400);
+    CHECK(c.count == 0); // the third source is still at 0
+    event(merge, 2, 200);
+    progress(merge, 2, 400);
+    CHECK(c.count == 5);
+    CHECK(c.times[0] == 50 && c.times[1] == 100 && c.times[2] == 200 && c.times[3] == 300 && c.times[4] == 350);
+
+    // a source lagging more than the window does not hold back the others
+    event(merge, 0, 500);
+    event(merge, 1, 600);
+    progress(merge, 0, 1200);
+    progress(merge, 1, 1200);
+    CHECK(c.count == 5);
+    progress(merge, 0, 1600);
+    CHECK(c.count == 7);
+    CHECK(c.times[5] == 500 && c.times[6] == 600);
+    CHECK(ascending(&c));
+    CHECK(event_merge_late(merge) == 0);
+
+    // its events are then output as they come, the early ones are late
+    event(merge, 2, 450);
+    CHECK(c.count == 8 && c.times[7] == 450);
+    CHECK(event_merge_late(merge) == 1);
+
+    // the events held are output in order on free
+    event(merge, 2, 2000);
+    event(merge, 1, 1900);
+    CHECK(c.count == 8);
+    event_merge_free(merge);
+    CHECK(c.count == 10 && c.times[8] == 1900 && c.times[9] == 2000);
+
+    return test_result();
+}
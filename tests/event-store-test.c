@@ -0,0 +1,156 @@
+/*
+ * Event store test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "event_store.h"
+#include "data.h"
+#include "test_util.h"
+
+#define NUM_EVENTS 300
+
+typedef struct {
+    unsigned count;
+    int64_t last_us;
+    int ascending;
+    char const *needle; ///< each text needs to contain this
+    int matched;
+} collect_t;
+
+static void collect(void *ctx, int64_t time_us, char const *text, size_t len)
+{
+    collect_t *c = ctx;
+    if (c->count && time_us < c->last_us)
+        c->ascending = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%.*s", (int)len, text);
+    if (c->needle && !strstr(buf, c->needle))
+        c->matched = 0;
+    c->last_us = time_us;
+    c->count += 1;
+}
+
+static unsigned query(event_store_t *store, int64_t from_us, int64_t to_us, char const *model, char const *id, unsigned limit, char const *needle, int64_t *next_us)
+{
+    event_query_t q = {.from_us = from_us, .to_us = to_us, .model = model, .id = id, .limit = limit};
+    collect_t c     = {.ascending = 1, .needle = needle, .matched = 1};
+    unsigned count  = event_store_query(store, &q, collect, &c, next_us);
+    CHECK(count == c.count);
+    CHECK(c.ascending);
+    CHECK(c.matched);
+    return count;
+}
+
+static int append(event_store_t *store, unsigned i)
+{
+    data_t *data = data_make(
+            "model", "", DATA_STRING, i % 2 ? "Test-B" : "Test-A",
+            "id", "", DATA_INT, (int)(i % 3),
+            "seq", "", DATA_INT, (int)i,
+            NULL);
+    char text[256];
+    size_t len = data_print_jsons(data, text, sizeof(text));
+    int ret    = event_store_append(store, data, text, len, (int64_t)i * 1000000);
+    data_free(data);
+    return ret;
+}
+
+static void remove_dir(char const *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    while (d && (entry = readdir(d))) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (entry->d_name[0] != '.')
+            unlink(path);
+    }
+    if (d)
+        closedir(d);
+    rmdir(dir);
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/event-store-test-XXXXXX";
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "TEST setup failed\n");
+        return 1;
+    }
+
+    // small segments rotate every few dozen events, the oldest are deleted
+    event_store_t *store = event_store_open(dir, 4096, 4);
+    CHECK(store != NULL);
+    if (!store) {
+        remove_dir(dir);
+        return 1;
+    }
+    for (unsigned i = 0; i < NUM_EVENTS; ++i) {
+        CHECK(append(store, i) == 0);
+    }
+    unsigned kept = event_store_count(store);
+    CHECK(kept > NUM_EVENTS / 3 && kept < NUM_EVENTS);
+    unsigned first = NUM_EVENTS - kept;
+
+    // events without a model are not stored
+    data_t *log = data_make("msg", "", DATA_STRING, "no model", NULL);
+    CHECK(event_store_append(store, log, "{}", 2, 0) < 0);
+    data_free(log);
+
+    int64_t next_us = -1;
+    CHECK(query(store, INT64_MIN, INT64_MAX, NULL, NULL, 0, NULL, &next_us) == kept);
+    CHECK(next_us == 0);
+
+    // a time range, inclusive
+    unsigned from = first + 17;
+    unsigned to   = NUM_EVENTS - 30;
+    CHECK(query(store, (int64_t)from * 1000000, (int64_t)to * 1000000, NULL, NULL, 0, NULL, NULL) == to - from + 1);
+    CHECK(query(store, (int64_t)NUM_EVENTS * 1000000, INT64_MAX, NULL, NULL, 0, NULL, NULL) == 0);
+
+    // a model, and a model and id, by the sensor index
+    unsigned want_b  = 0;
+    unsigned want_b2 = 0;
+    for (unsigned i = from; i <= to; ++i) {
+        want_b += i % 2;
+        want_b2 += i % 2 && i % 3 == 2;
+    }
+    CHECK(query(store, (int64_t)from * 1000000, (int64_t)to * 1000000, "Test-B", NULL, 0, "\"Test-B\"", NULL) == want_b);
+    CHECK(query(store, (int64_t)from * 1000000, (int64_t)to * 1000000, "Test-B", "2", 0, "\"id\":2,", NULL) == want_b2);
+    CHECK(query(store, INT64_MIN, INT64_MAX, "Test-C", NULL, 0, NULL, NULL) == 0);
+    CHECK(query(store, INT64_MIN, INT64_MAX, "Test-A", "7", 0, NULL, NULL) == 0);
+
+    // the limit, the next time continues the query
+    CHECK(query(store, (int64_t)from * 1000000, INT64_MAX, NULL, NULL, 5, NULL, &next_us) == 5);
+    CHECK(next_us == (int64_t)(from + 5) * 1000000);
+    CHECK(query(store, (int64_t)from * 1000000, INT64_MAX, "Test-A", "0", 3, "\"id\":0,", &next_us) == 3);
+    CHECK(next_us > (int64_t)from * 1000000 && next_us % 6000000 == 0);
+
+    // the segments are indexed again on open
+    event_store_close(store);
+    store = event_store_open(dir, 4096, 4);
+    CHECK(store != NULL);
+    if (store) {
+        unsigned reopened = event_store_count(store);
+        CHECK(reopened > 0 && reopened <= kept);
+        CHECK(query(store, (int64_t)(NUM_EVENTS - 20) * 1000000, INT64_MAX, "Test-B", NULL, 0, "\"Test-B\"", NULL) == 10);
+        CHECK(append(store, NUM_EVENTS) == 0);
+        CHECK(event_store_count(store) == reopened + 1);
+        event_store_close(store);
+    }
+
+    remove_dir(dir);
+
+    return test_result();
+}
@@ -0,0 +1,119 @@
+/*
+ * Per sensor event throttle test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "event_throttle.h"
+#include "test_util.h"
+
+#define INTERVAL_MS 60000
+
+static data_t *energy_event(int id, int power, double voltage)
+{
+    /* clang-format off */
+    return data_make(
+            "model",    "", DATA_STRING, "Efergy-Optical",
+            "id",       "", DATA_INT,    id,
+            "power_W",  "", DATA_INT,    power,
+            "voltage",  "", DATA_DOUBLE, voltage,
+            NULL);
+    /* clang-format on */
+}
+
+static data_t const *find(data_t const *data, char const *key)
+{
+    for (; data; data = data->next) {
+        if (!strcmp(data->key, key))
+            return data;
+    }
+    return NULL;
+}
+
+static void test_latest(void)
+{
+    event_throttle_t *throttle = event_throttle_create(INTERVAL_MS, THROTTLE_LATEST);
+    CHECK(throttle);
+    if (!throttle)
+        return;
+    // two sensors every 4 s for 10 minutes, the first event of each is output
+    unsigned output[2] = {0};
+    for (uint64_t ms = 0; ms < 600000; ms += 4000) {
+        for (int id = 0; id < 2; ++id) {
+            data_t *data = energy_event(id, 100, 230.0);
+            output[id] += event_throttle_pass(throttle, id ? "Efergy-Optical|1|" : "Efergy-Optical|0|", data, ms + id * 1000);
+            data_free(data);
+        }
+    }
+    CHECK(output[0] == 10);
+    CHECK(output[1] == 10);
+    CHECK(event_throttle_dropped(throttle) == 300 - 20);
+    CHECK(event_throttle_sensors(throttle) == 2);
+    event_throttle_free(throttle);
+}
+
+static void test_aggregate(throttle_mode_t mode, int power, double voltage)
+{
+    event_throttle_t *throttle = event_throttle_create(INTERVAL_MS, mode);
+    CHECK(throttle);
+    if (!throttle)
+        return;
+    data_t *data = energy_event(7, 500, 231.0);
+    CHECK(event_throttle_pass(throttle, "Efergy-Optical|7|", data, 0));
+    data_free(data);
+    // the readings since the last output are 100, 200, 300, 400 W, and the output event
+    for (int i = 1; i <= 4; ++i) {
+        data = energy_event(7, i * 100, 229.0 + i);
+        CHECK(!event_throttle_pass(throttle, "Efergy-Optical|7|", data, i * 10000));
+        data_free(data);
+    }
+    data = energy_event(7, 500, 225.0);
+    CHECK(event_throttle_pass(throttle, "Efergy-Optical|7|", data, INTERVAL_MS));
+    CHECK(find(data, "id")->value.v_int == 7);
+    CHECK(find(data, "power_W")->value.v_int == power);
+    CHECK(fabs(find(data, "voltage")->value.v_dbl - voltage) < 1e-9);
+    data_free(data);
+    event_throttle_free(throttle);
+}
+
+static void test_stale(void)
+{
+    event_throttle_t *throttle = event_throttle_create(INTERVAL_MS, THROTTLE_LATEST);
+    CHECK(throttle);
+    if (!throttle)
+        return;
+    // TPMS of passing cars, each heard for a moment only
+    char key[64];
+    for (unsigned i = 0; i < 10000; ++i) {
+        snprintf(key, sizeof(key), "Toyota|%u|", i);
+        data_t *data = energy_event((int)i, 0, 0.0);
+        CHECK(event_throttle_pass(throttle, key, data, (uint64_t)i * 1000));
+        data_free(data);
+    }
+    // the sensors of the last two intervals, the table grows by doubling
+    CHECK(event_throttle_sensors(throttle) <= 4 * INTERVAL_MS / 1000);
+    event_throttle_free(throttle);
+}
+
+int main(void)
+{
+    test_latest();
+    test_aggregate(THROTTLE_LATEST, 500, 225.0);
+    test_aggregate(THROTTLE_AVG, 300, 230.2);
+    test_aggregate(THROTTLE_MIN, 100, 225.0);
+    test_aggregate(THROTTLE_MAX, 500, 233.0);
+    test_stale();
+
+    return test_result();
+}
@@ -0,0 +1,93 @@
+/*
+ * Multi-device frequency coverage planner test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+
+#include "freq_plan.h"
+#include "test_util.h"
+
+// every wanted frequency is in the passband of a center of its device
+static void check_coverage(freq_plan_t const *plan, uint32_t const *samp_rate)
+{
+    for (unsigned i = 0; i < freq_plan_wanted_count(plan); ++i) {
+        unsigned index;
+        unsigned d = freq_plan_device(plan, i, &index);
+        CHECK(index < freq_plan_centers(plan, d));
+        CHECK(freq_plan_covers(freq_plan_center(plan, d, index), freq_plan_wanted(plan, i), samp_rate[d]));
+    }
+}
+
+static void test_static(void)
+{
+    uint32_t wanted[]    = {433920000, 434000000, 433420000, 868300000, 915000000};
+    uint32_t samp_rate[] = {1000000, 1000000, 1000000};
+
+    freq_plan_t *plan = freq_plan_create(wanted, 5, samp_rate, 3);
+    CHECK(plan);
+    if (!plan)
+        return;
+    check_coverage(plan, samp_rate);
+    // three bands on three devices, none hops
+    for (unsigned d = 0; d < 3; ++d) {
+        CHECK(freq_plan_centers(plan, d) == 1);
+    }
+    // the 433 MHz group shares a device
+    CHECK(freq_plan_device(plan, 0, NULL) == freq_plan_device(plan, 1, NULL));
+    CHECK(freq_plan_device(plan, 0, NULL) == freq_plan_device(plan, 2, NULL));
+    freq_plan_free(plan);
+}
+
+static void test_hop(void)
+{
+    uint32_t wanted[]    = {433920000, 868300000, 868950000, 915000000};
+    uint32_t samp_rate[] = {250000, 2400000};
+
+    freq_plan_t *plan = freq_plan_create(wanted, 4, samp_rate, 2);
+    CHECK(plan);
+    if (!plan)
+        return;
+    check_coverage(plan, samp_rate);
+    // the wide device covers both 868 MHz frequencies statically, the narrow one hops
+    CHECK(freq_plan_centers(plan, 1) == 1);
+    CHECK(freq_plan_device(plan, 1, NULL) == 1);
+    CHECK(freq_plan_device(plan, 2, NULL) == 1);
+    CHECK(freq_plan_centers(plan, 0) == 2);
+    freq_plan_free(plan);
+}
+
+static void test_spare(void)
+{
+    uint32_t wanted[]    = {433920000};
+    uint32_t samp_rate[] = {250000, 250000};
+
+    freq_plan_t *plan = freq_plan_create(wanted, 1, samp_rate, 2);
+    CHECK(plan);
+    if (!plan)
+        return;
+    check_coverage(plan, samp_rate);
+    // away from DC, the spare device doubles the first
+    CHECK(freq_plan_center(plan, 0, 0) != wanted[0]);
+    CHECK(freq_plan_centers(plan, 1) == 1);
+    CHECK(freq_plan_center(plan, 1, 0) == freq_plan_center(plan, 0, 0));
+    freq_plan_free(plan);
+
+    CHECK(!freq_plan_create(wanted, 0, samp_rate, 2));
+    CHECK(!freq_plan_create(wanted, 1, samp_rate, 0));
+}
+
+int main(void)
+{
+    test_static();
+    test_hop();
+    test_spare();
+
+    return test_result();
+}
@@ -0,0 +1,121 @@
+/*
+ * Adaptive hop scheduler simulation test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hop_scheduler.h"
+#include "test_util.h"
+
+#define SAMPLE_RATE 250000
+#define FRAME_SAMPLES (SAMPLE_RATE / 4)
+#define RUN_SECONDS 7200
+
+typedef struct {
+    unsigned freq;
+    unsigned period_ms;
+    unsigned start_ms;
+    unsigned sent;
+    unsigned caught;
+} sensor_t;
+
+// count the transmissions of the sensors in a frame, caught if the frequency is tuned
+static unsigned frame_events(sensor_t *sensors, unsigned count, unsigned index, uint64_t begin, uint64_t end, int second_half)
+{
+    unsigned events = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        sensor_t *s = &sensors[i];
+        uint64_t period = (uint64_t)s->period_ms * SAMPLE_RATE / 1000;
+        uint64_t start  = (uint64_t)s->start_ms * SAMPLE_RATE / 1000;
+        if (end <= start)
+            continue;
+        // a transmission in [begin, end)
+        uint64_t n = begin > start ? (begin - start + period - 1) / period : 0;
+        if (start + n * period >= end)
+            continue;
+        s->sent += second_half;
+        if (s->freq == index) {
+            s->caught += second_half;
+            events += 1;
+        }
+    }
+    return events;
+}
+
+static void test_periodic(void)
+{
+    int hop_time[] = {10};
+    sensor_t sensors[] = {
+            {.freq = 0, .period_ms = 31000, .start_ms = 2000},
+            {.freq = 1, .period_ms = 47000, .start_ms = 5000},
+            {.freq = 2, .period_ms = 60000, .start_ms = 13000},
+            {.freq = 2, .period_ms = 37500, .start_ms = 29000},
+    };
+    unsigned count = sizeof(sensors) / sizeof(*sensors);
+
+    hop_scheduler_t *sched = hop_scheduler_create(3, hop_time, 1, SAMPLE_RATE, 0, 0);
+    CHECK(sched);
+    if (!sched)
+        return;
+    unsigned index = 0;
+    for (uint64_t pos = 0; pos < (uint64_t)RUN_SECONDS * SAMPLE_RATE; pos += FRAME_SAMPLES) {
+        int second_half = pos >= (uint64_t)RUN_SECONDS / 2 * SAMPLE_RATE;
+        unsigned events = frame_events(sensors, count, index, pos, pos + FRAME_SAMPLES, second_half);
+        if (hop_scheduler_frame(sched, pos + FRAME_SAMPLES, events, events))
+            index = hop_scheduler_next(sched, pos + FRAME_SAMPLES);
+    }
+    // round-robin would catch about a third, the learned periods should catch most
+    for (unsigned i = 0; i < count; ++i) {
+        fprintf(stderr, "sensor %u: caught %u of %u\n", i, sensors[i].caught, sensors[i].sent);
+        CHECK(sensors[i].caught * 10 >= sensors[i].sent * 8);
+    }
+    CHECK(hop_scheduler_periodic(sched, 1) >= 1);
+    CHECK(hop_scheduler_periodic(sched, 2) >= 2);
+    hop_scheduler_free(sched);
+}
+
+static void test_dwell(void)
+{
+    int hop_time[] = {20, 20};
+    hop_scheduler_t *sched = hop_scheduler_create(2, hop_time, 2, SAMPLE_RATE, 0, 0);
+    CHECK(sched);
+    if (!sched)
+        return;
+    unsigned index = 0;
+    uint64_t dwell[2] = {0};
+    unsigned n = 0;
+    for (uint64_t pos = 0; pos < (uint64_t)RUN_SECONDS * SAMPLE_RATE; pos += FRAME_SAMPLES) {
+        // busy with irregular packages and events on the first frequency only
+        unsigned packages = index == 0 && (n * 7919 % 13) < 2 ? 1 : 0;
+        unsigned events   = packages && (n % 3) == 0;
+        dwell[index] += FRAME_SAMPLES;
+        n += 1;
+        if (hop_scheduler_frame(sched, pos + FRAME_SAMPLES, packages, events))
+            index = hop_scheduler_next(sched, pos + FRAME_SAMPLES);
+    }
+    unsigned busy  = hop_scheduler_dwell_ms(sched, 0);
+    unsigned quiet = hop_scheduler_dwell_ms(sched, 1);
+    fprintf(stderr, "dwell busy %u ms, quiet %u ms, time busy %u s, quiet %u s\n",
+            busy, quiet, (unsigned)(dwell[0] / SAMPLE_RATE), (unsigned)(dwell[1] / SAMPLE_RATE));
+    CHECK(busy > 2 * quiet);
+    CHECK(quiet >= 20000 / 4);
+    CHECK(dwell[0] > 2 * dwell[1]);
+    CHECK(dwell[1] > 0);
+    hop_scheduler_free(sched);
+}
+
+int main(void)
+{
+    test_periodic();
+    test_dwell();
+
+    return test_result();
+}
@@ -0,0 +1,58 @@
+/*
+ * Latency histogram test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+
+#include "latency_hist.h"
+#include "test_util.h"
+
+int main(void)
+{
+    latency_hist_t hist = {0};
+
+    // an empty histogram
+    CHECK(latency_hist_count(&hist) == 0);
+    CHECK(latency_hist_percentile(&hist, 50) == 0);
+
+    // the bins are bounded above
+    latency_hist_add(&hist, -5);
+    CHECK(hist.counts[0] == 1);
+    latency_hist_add(&hist, 9);
+    CHECK(hist.counts[0] == 2);
+    latency_hist_add(&hist, 10);
+    CHECK(hist.counts[1] == 1);
+    latency_hist_add(&hist, 2000000);
+    CHECK(hist.counts[LATENCY_HIST_US_BINS - 1] == 1);
+    CHECK(hist.max_us == 2000000);
+    CHECK(latency_hist_count(&hist) == 4);
+
+    // 90 fast and 10 slow delays
+    latency_hist_t mix = {0};
+    for (int i = 0; i < 90; ++i) {
+        latency_hist_add(&mix, 150);
+    }
+    for (int i = 0; i < 10; ++i) {
+        latency_hist_add(&mix, 30000);
+    }
+    CHECK(latency_hist_percentile(&mix, 50) == 200);
+    CHECK(latency_hist_percentile(&mix, 90) == 200);
+    CHECK(latency_hist_percentile(&mix, 91) == 30000); // capped at the largest delay
+    CHECK(latency_hist_percentile(&mix, 100) == 30000);
+    CHECK(latency_hist_percentile(&mix, 0) == 200);
+
+    // merged counts and max
+    latency_hist_merge(&hist, &mix);
+    CHECK(latency_hist_count(&hist) == 104);
+    CHECK(hist.max_us == 2000000);
+    CHECK(latency_hist_percentile(&hist, 100) == 2000000);
+
+    return test_result();
+}
@@ -0,0 +1,202 @@
+/*
+ * Embeddable decoding API test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r_lib.h"
+#include "data.h"
+#include "pulse_data.h"
+#include "compat_pthread.h"
+#include "test_util.h"
+
+#define SAMPLE_RATE 250000
+
+/// Generic Remote SC226x EV1527, house code 0x1234, command 0x42.
+#define REMOTE_PROTOCOL 30
+#define REMOTE_CODE 0x123442
+
+typedef struct {
+    int events;
+    int id;
+    int cmd;
+    char model[32];
+} events_t;
+
+static void on_event(struct data const *event, void *ctx)
+{
+    events_t *ev = ctx;
+    ev->events++;
+    data_t const *model = r_lib_event_find(event, "model");
+    data_t const *id    = r_lib_event_find(event, "id");
+    data_t const *cmd   = r_lib_event_find(event, "cmd");
+    if (model && model->type == DATA_STRING)
+        snprintf(ev->model, sizeof(ev->model), "%s", (char const *)model->value.v_ptr);
+    if (id && id->type == DATA_INT)
+        ev->id = id->value.v_int;
+    if (cmd && cmd->type == DATA_INT)
+        ev->cmd = cmd->value.v_int;
+}
+
+// the pulse and gap widths in samples of a bit, a 1 is a long pulse
+static void remote_bit(int bit, int *pulse, int *gap)
+{
+    int const short_width = 464 * SAMPLE_RATE / 1000000;
+    int const long_width  = 1404 * SAMPLE_RATE / 1000000;
+    *pulse = bit ? long_width : short_width;
+    *gap   = bit ? short_width : long_width;
+}
+
+static void remote_pulses(pulse_data_t *pulses)
+{
+    pulse_data_clear(pulses);
+    pulse_data_reserve(pulses, 26);
+    pulses->sample_rate = SAMPLE_RATE;
+    for (int i = 0; i < 25; ++i) {
+        // 24 bits of code and a final 0 bit
+        int bit = i < 24 ? (REMOTE_CODE >> (23 - i)) & 1 : 0;
+        remote_bit(bit, &pulses->pulse[i], &pulses->gap[i]);
+    }
+    pulses->gap[24]    = SAMPLE_RATE / 100; // 10 ms
+    pulses->num_pulses = 25;
+}
+
+// CU8 samples of the code with silence around, the carrier is a constant offset
+static uint8_t *remote_iq(size_t *n_samples)
+{
+    pulse_data_t pulses = {0};
+    remote_pulses(&pulses);
+    size_t len = 20000;
+    for (unsigned i = 0; i < pulses.num_pulses; ++i)
+        len += pulses.pulse[i] + pulses.gap[i];
+    len += 20000;
+
+    uint8_t *iq = malloc(len * 2);
+    if (!iq) {
+        pulse_data_free(&pulses);
+        return NULL;
+    }
+    // a little noise keeps the level estimates sane
+    unsigned seed = 1;
+    for (size_t i = 0; i < len; ++i) {
+        seed = seed * 1103515245 + 12345;
+        iq[2 * i]     = (uint8_t)(127 + (seed >> 16) % 3);
+        iq[2 * i + 1] = (uint8_t)(127 + (seed >> 24) % 3);
+    }
+    size_t pos = 20000;
+    for (unsigned i = 0; i < pulses.num_pulses; ++i) {
+        for (int k = 0; k < pulses.pulse[i]; ++k)
+            iq[2 * (pos + k)] = 228;
+        pos += pulses.pulse[i] + pulses.gap[i];
+    }
+    pulse_data_free(&pulses);
+    *n_samples = len;
+    return iq;
+}
+
+#ifdef THREADS
+#define PIPELINES 4
+#define PIPELINE_PUSHES 8
+
+typedef struct {
+    uint8_t const *iq;
+    size_t n_samples;
+    events_t ev;
+    int events;
+} pipeline_t;
+
+// an own instance on each thread, created and fed concurrently with the others
+static THREAD_RETURN THREAD_CALL pipeline_thread(void *arg)
+{
+    pipeline_t *pl = arg;
+    r_lib_t *lib   = r_lib_create(SAMPLE_RATE, on_event, &pl->ev);
+    if (!lib) {
+        return (THREAD_RETURN)0;
+    }
+    r_lib_register_all(lib);
+    for (int n = 0; n < PIPELINE_PUSHES; ++n) {
+        for (size_t pos = 0; pos < pl->n_samples; pos += 16384) {
+            size_t len = pl->n_samples - pos < 16384 ? pl->n_samples - pos : 16384;
+            pl->events += r_lib_push_iq(lib, pl->iq + 2 * pos, len, BASEBAND_CU8);
+        }
+    }
+    r_lib_free(lib);
+    return (THREAD_RETURN)0;
+}
+
+static void test_pipelines(uint8_t const *iq, size_t n_samples)
+{
+    pipeline_t pipelines[PIPELINES] = {{0}};
+    pthread_t threads[PIPELINES];
+    for (int i = 0; i < PIPELINES; ++i) {
+        pipelines[i].iq        = iq;
+        pipelines[i].n_samples = n_samples;
+        CHECK(pthread_create(&threads[i], NULL, pipeline_thread, &pipelines[i]) == 0);
+    }
+    for (int i = 0; i < PIPELINES; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < PIPELINES; ++i) {
+        CHECK(pipelines[i].events >= PIPELINE_PUSHES);
+        CHECK(pipelines[i].ev.id == 0x1234);
+        CHECK(pipelines[i].ev.cmd == 0x42);
+    }
+}
+#endif
+
+int main(void)
+{
+    // decode pulses
+    events_t ev = {0};
+    r_lib_t *lib = r_lib_create(SAMPLE_RATE, on_event, &ev);
+    CHECK(lib != NULL);
+    CHECK(r_lib_register_protocol(lib, 100000, NULL) == -1);
+    CHECK(r_lib_register_protocol(lib, REMOTE_PROTOCOL, NULL) == 0);
+
+    pulse_data_t pulses = {0};
+    remote_pulses(&pulses);
+    CHECK(r_lib_push_pulses(lib, &pulses, 0) == 1);
+    pulse_data_free(&pulses);
+    CHECK(ev.events == 1);
+    CHECK(!strcmp(ev.model, "Generic-Remote"));
+    CHECK(ev.id == 0x1234);
+    CHECK(ev.cmd == 0x42);
+
+    // demodulate and decode samples, split into buffers
+    memset(&ev, 0, sizeof(ev));
+    size_t n_samples = 0;
+    uint8_t *iq      = remote_iq(&n_samples);
+    CHECK(iq != NULL);
+    int events = 0;
+    for (size_t pos = 0; iq && pos < n_samples; pos += 16384) {
+        size_t len = n_samples - pos < 16384 ? n_samples - pos : 16384;
+        events += r_lib_push_iq(lib, iq + 2 * pos, len, BASEBAND_CU8);
+    }
+    CHECK(events == 1);
+    CHECK(ev.events == 1);
+    CHECK(ev.id == 0x1234);
+    CHECK(ev.cmd == 0x42);
+
+#ifdef THREADS
+    // independent instances on concurrent threads
+    if (iq) {
+        test_pipelines(iq, n_samples);
+    }
+#endif
+
+    free(iq);
+    r_lib_free(lib);
+    r_lib_free(NULL);
+
+    return test_result();
+}
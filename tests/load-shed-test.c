@@ -0,0 +1,75 @@
+/*
+ * Load shedding test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "load_shed.h"
+#include "test_util.h"
+
+/// Signal time of a buffer, 100 ms.
+#define BUF_NS 100000000ULL
+
+// feed buffers at a load for a time, returns the last step
+static load_shed_step_t feed(load_shed_t *shed, float load, unsigned ms)
+{
+    load_shed_step_t step = load_shed_step(shed);
+    for (unsigned t = 0; t < ms; t += 100)
+        step = load_shed_buffer(shed, (uint64_t)(load * BUF_NS), BUF_NS);
+    return step;
+}
+
+int main(void)
+{
+    CHECK(load_shed_create(0.6f, 0.9f) == NULL);
+    CHECK(load_shed_create(0.0f, 0.0f) == NULL);
+
+    load_shed_t *shed = load_shed_create(0.9f, 0.6f);
+    CHECK(shed != NULL);
+    if (!shed)
+        return 1;
+
+    // a light load sheds nothing
+    CHECK(feed(shed, 0.5f, 10000) == LOAD_SHED_OFF);
+    CHECK(load_shed_load(shed) > 0.45f && load_shed_load(shed) < 0.55f);
+
+    // a short spike is smoothed away
+    CHECK(feed(shed, 2.0f, 200) == LOAD_SHED_OFF);
+    CHECK(feed(shed, 0.5f, 3000) == LOAD_SHED_OFF);
+
+    // an overload takes a step every few seconds, up to the last
+    CHECK(feed(shed, 1.2f, 3500) == LOAD_SHED_FM);
+    CHECK(feed(shed, 1.2f, 3000) == LOAD_SHED_PRIORITY);
+    CHECK(feed(shed, 1.2f, 3000) == LOAD_SHED_SQUELCH);
+    CHECK(feed(shed, 1.2f, 10000) == LOAD_SHED_SQUELCH);
+    CHECK(load_shed_raised(shed, LOAD_SHED_FM) == 1);
+    CHECK(load_shed_raised(shed, LOAD_SHED_SQUELCH) == 1);
+
+    // between the low and the high load the step is kept
+    CHECK(feed(shed, 0.75f, 30000) == LOAD_SHED_SQUELCH);
+
+    // under the low load the steps are undone, the step held long enough goes first, the others slower than taken
+    CHECK(feed(shed, 0.3f, 2000) == LOAD_SHED_PRIORITY);
+    CHECK(feed(shed, 0.3f, 8000) == LOAD_SHED_PRIORITY);
+    CHECK(feed(shed, 0.3f, 2000) == LOAD_SHED_FM);
+    CHECK(feed(shed, 0.3f, 10000) == LOAD_SHED_OFF);
+    CHECK(load_shed_lowered(shed, LOAD_SHED_SQUELCH) == 1);
+    CHECK(load_shed_lowered(shed, LOAD_SHED_FM) == 1);
+    CHECK(load_shed_raised(shed, LOAD_SHED_OFF) == 0);
+
+    // the signal time of each step
+    CHECK(load_shed_step_ms(shed, LOAD_SHED_SQUELCH) >= 40000);
+    CHECK(load_shed_step_ms(shed, LOAD_SHED_FM) >= 3000);
+
+    load_shed_free(shed);
+
+    return test_result();
+}
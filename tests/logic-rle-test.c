@@ -0,0 +1,121 @@
+/*
+ * Run-length logic dump test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pulse_data.h"
+#include "test_util.h"
+
+#define NUM_SAMPLES 100000
+
+// expand the runs of a dump into a state per sample, returns the number of samples or -1 on a bad file
+static long expand(FILE *file, uint8_t *buf, long len, uint32_t *sample_rate)
+{
+    uint8_t header[12];
+    rewind(file);
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "RLE433\0\1", 8))
+        return -1;
+    *sample_rate = header[8] | header[9] << 8 | header[10] << 16 | (uint32_t)header[11] << 24;
+
+    long pos = 0;
+    int state;
+    while ((state = getc(file)) != EOF) {
+        uint64_t run = 0;
+        int shift    = 0;
+        int c;
+        do {
+            c = getc(file);
+            if (c == EOF || shift > 63)
+                return -1;
+            run |= (uint64_t)(c & 0x7f) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        if (run == 0 || pos + (long)run > len)
+            return -1;
+        memset(buf + pos, state, (size_t)run);
+        pos += (long)run;
+    }
+    return pos;
+}
+
+static void make_package(pulse_data_t *data, uint64_t offset, unsigned num, int width, int gap)
+{
+    pulse_data_clear(data);
+    data->offset      = offset;
+    data->sample_rate = 250000;
+    for (unsigned i = 0; i < num; ++i) {
+        pulse_data_start_pulse(data);
+        data->pulse[i] = width + (int)i % 3 * 50;
+        data->gap[i]   = gap + (int)i % 2 * 100;
+        data->num_pulses += 1;
+    }
+    data->gap[num - 1] = 20000; // a long reset gap needs three bytes
+}
+
+int main(void)
+{
+    static pulse_data_t ook;
+    static pulse_data_t fsk;
+    static pulse_data_t late;
+    static uint8_t raw[NUM_SAMPLES];
+    static uint8_t runs[NUM_SAMPLES];
+    static uint8_t overlap[NUM_SAMPLES];
+    FILE *file = tmpfile();
+    if (!file) {
+        fprintf(stderr, "TEST setup failed\n");
+        return 1;
+    }
+
+    make_package(&ook, 1000, 40, 120, 240);
+    make_package(&fsk, 40000, 60, 52, 52);
+    fsk.gap[59] = 1000;
+    make_package(&late, 0, 10, 500, 500);
+
+    pulse_data_print_rle_header(file, 250000);
+    uint64_t pos     = 0;
+    pos              = pulse_data_dump_rle(file, pos, &ook, 0x02);
+    pos              = pulse_data_dump_rle(file, pos, &fsk, 0x04);
+    uint64_t fsk_end = pos;
+    // overlaps the end of the FSK package, only the part after it is written
+    late.offset = fsk_end - 300;
+    pos         = pulse_data_dump_rle(file, pos, &late, 0x02);
+    CHECK(pos > fsk_end);
+    pulse_data_print_rle_end(file, pos, NUM_SAMPLES);
+    pulse_data_print_rle_end(file, NUM_SAMPLES, NUM_SAMPLES); // nothing left
+    fflush(file);
+
+    // the same states as the per sample dump, painted in order without overwriting
+    pulse_data_dump_raw(raw, NUM_SAMPLES, 0, &ook, 0x02);
+    pulse_data_dump_raw(raw, NUM_SAMPLES, 0, &fsk, 0x04);
+    pulse_data_dump_raw(overlap, NUM_SAMPLES, 0, &late, 0x02);
+    memcpy(raw + fsk_end, overlap + fsk_end, NUM_SAMPLES - fsk_end);
+
+    uint32_t sample_rate = 0;
+    long len             = expand(file, runs, NUM_SAMPLES, &sample_rate);
+    CHECK(sample_rate == 250000);
+    CHECK(len == NUM_SAMPLES);
+    CHECK(memcmp(raw, runs, NUM_SAMPLES) == 0);
+    CHECK(runs[999] == 0x00 && runs[1000] == 0x03 && runs[1120] == 0x01);
+    CHECK(runs[40000] == 0x05);
+    CHECK(runs[fsk_end - 1] == 0x01 && runs[fsk_end] == 0x03);
+
+    // a few bytes per pulse instead of a byte per sample
+    long size = ftell(file);
+    CHECK(size > 0 && size < 12 + 4 * 110 * 2);
+
+    fclose(file);
+    pulse_data_free(&ook);
+    pulse_data_free(&fsk);
+    pulse_data_free(&late);
+
+    return test_result();
+}
@@ -0,0 +1,120 @@
+/*
+ * Shared Manchester decoding test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitbuffer.h"
+#include "manchester_view.h"
+#include "test_util.h"
+
+static bitbuffer_t source;
+static bitbuffer_t bits;
+static bitbuffer_t out_view;
+static bitbuffer_t out_plain;
+
+// Manchester symbols with an invalid pair now and then, or plain random bits
+static void fill_row(unsigned len, int clean)
+{
+    if (source.num_rows && source.bits_per_row[source.num_rows - 1])
+        bitbuffer_add_row(&source);
+    for (unsigned i = 0; i < len; i += 2) {
+        int bit = rand() & 1;
+        int bad = clean ? rand() % 200 == 0 : rand() % 3 == 0;
+        bitbuffer_add_bit(&source, bit);
+        if (i + 1 < len)
+            bitbuffer_add_bit(&source, bad ? bit : !bit);
+    }
+}
+
+static int same_bits(bitbuffer_t const *a, bitbuffer_t const *b)
+{
+    if (a->num_rows != b->num_rows)
+        return 0;
+    for (unsigned row = 0; row < a->num_rows; ++row) {
+        unsigned len = a->bits_per_row[row];
+        if (len != b->bits_per_row[row] || memcmp(a->bb[row], b->bb[row], (len + 7) / 8))
+            return 0;
+    }
+    return 1;
+}
+
+static void test_random(void)
+{
+    manchester_view_t view = {0};
+    for (unsigned n = 0; n < 40; ++n) {
+        bitbuffer_clear(&source);
+        unsigned rows = 1 + rand() % 4;
+        for (unsigned r = 0; r < rows; ++r) {
+            fill_row(rand() % 400, n % 2);
+        }
+        if (n % 8 == 7)
+            fill_row(BITBUF_COLS * 8 + rand() % 300, 1); // spills into the next rows
+
+        int inverted = n % 4 >= 2;
+        bitbuffer_clear(&bits);
+        bitbuffer_copy(&bits, &source);
+        if (inverted)
+            bitbuffer_invert(&bits);
+        view.source = &source;
+        view.bits   = &bits;
+        view.done   = 0;
+
+        for (unsigned row = 0; row < source.num_rows; ++row) {
+            unsigned len = source.bits_per_row[row];
+            for (unsigned start = 0; start <= len + 1; ++start) {
+                unsigned max = rand() % 3 ? 0 : rand() % 120;
+                bitbuffer_clear(&out_view);
+                bitbuffer_clear(&out_plain);
+                unsigned got  = manchester_view_decode(&view, &bits, row, start, &out_view, max);
+                unsigned want = bitbuffer_manchester_decode(&bits, row, start, &out_plain, max);
+                CHECK(got == want);
+                CHECK(same_bits(&out_view, &out_plain));
+                if (got != want || !same_bits(&out_view, &out_plain)) {
+                    fprintf(stderr, "row %u of %u bits from %u max %u%s\n", row, len, start, max, inverted ? " inverted" : "");
+                    manchester_view_free(&view);
+                    return;
+                }
+            }
+        }
+    }
+    manchester_view_free(&view);
+}
+
+static void test_changed(void)
+{
+    manchester_view_t view = {0};
+    bitbuffer_clear(&source);
+    fill_row(200, 1);
+    bitbuffer_clear(&bits);
+    bitbuffer_copy(&bits, &source);
+    view.source = &source;
+    view.bits   = &bits;
+
+    // other bits, and changed bits are not answered
+    bitbuffer_t other = {0};
+    bitbuffer_copy(&other, &source);
+    CHECK(manchester_view_decode(&view, &other, 0, 0, &out_view, 0) == MANCHESTER_VIEW_UNKNOWN);
+    bits.bb[0][2] ^= 0x10;
+    CHECK(manchester_view_decode(&view, &bits, 0, 16, &out_view, 0) == MANCHESTER_VIEW_UNKNOWN);
+    CHECK(manchester_view_decode(&view, &bits, 1, 0, &out_view, 0) == MANCHESTER_VIEW_UNKNOWN);
+    manchester_view_free(&view);
+}
+
+int main(void)
+{
+    srand(433);
+    test_random();
+    test_changed();
+
+    return test_result();
+}
@@ -0,0 +1,87 @@
+/*
+ * Output filter expression test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_filter.h"
+#include "test_util.h"
+
+static int matches(char const *expr, data_t const *data)
+{
+    char err[200];
+    output_filter_t *filter = output_filter_create(expr, err, sizeof(err));
+    if (!filter) {
+        fprintf(stderr, "TEST failed: %s\n", err);
+        failed++;
+        return -1;
+    }
+    int match = output_filter_match(filter, data);
+    output_filter_free(filter);
+    return match;
+}
+
+static int invalid(char const *expr)
+{
+    char err[200];
+    output_filter_t *filter = output_filter_create(expr, err, sizeof(err));
+    output_filter_free(filter);
+    return !filter;
+}
+
+int main(void)
+{
+    /* clang-format off */
+    data_t *data = data_make(
+            "model",        "", DATA_STRING, "Acurite-Tower",
+            "id",           "", DATA_INT,    1234,
+            "channel",      "", DATA_STRING, "A",
+            "battery_ok",   "", DATA_INT,    1,
+            "temperature_C","", DATA_DOUBLE, 21.5,
+            "rssi",         "", DATA_DOUBLE, -8.25,
+            NULL);
+    /* clang-format on */
+
+    CHECK(matches("model~\"Acurite.*\"&&id==1234", data) == 1);
+    CHECK(matches("model~\"^Tower\"", data) == 0);
+    CHECK(matches("model~\"Tower$\"", data) == 1);
+    CHECK(matches("model~\"^Acu.+-T?ower$\"", data) == 1);
+    CHECK(matches("model~\"Acurite\\.\"", data) == 0);
+    CHECK(matches("model!~\"Fineoffset\"", data) == 1);
+    CHECK(matches("model == \"Acurite-Tower\"", data) == 1);
+    CHECK(matches("channel != \"B\"", data) == 1);
+    CHECK(matches("id > 1000 && id <= 1234", data) == 1);
+    CHECK(matches("id < 1234", data) == 0);
+    CHECK(matches("rssi >= -10", data) == 1);
+    CHECK(matches("temperature_C > 21.5 || rssi > -5", data) == 0);
+    CHECK(matches("battery_ok", data) == 1);
+    CHECK(matches("!humidity", data) == 1);
+    CHECK(matches("!(id==1234)", data) == 0);
+    CHECK(matches("(id==1 || id==1234) && channel==\"A\"", data) == 1);
+    // missing keys and a string against a number are false, also for !=
+    CHECK(matches("humidity != 50", data) == 0);
+    CHECK(matches("channel == 1", data) == 0);
+    CHECK(matches("id == \"1234\"", data) == 0);
+
+    CHECK(invalid(""));
+    CHECK(invalid("id =="));
+    CHECK(invalid("id == 1 &&"));
+    CHECK(invalid("(id == 1"));
+    CHECK(invalid("model == \"x"));
+    CHECK(invalid("id ~ 12"));
+    CHECK(invalid("id == 1 junk"));
+
+    data_free(data);
+
+    return test_result();
+}
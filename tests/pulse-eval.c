@@ -11,7 +11,7 @@
     (at your option) any later version.
 */
 
-// gcc -Wall -I ../include -o pulse-eval ../src/baseband.c ../src/write_sigrok.c ../tests/pulse-eval.c && ./pulse-eval FILE
+// gcc -Wall -I ../include -o pulse-eval ../src/baseband.c ../src/write_sigrok.c ../src/pulse_detect_fsk.c ../src/pulse_data.c ../src/rfraw.c ../src/r_util.c ../src/data.c ../src/abuf.c ../src/logger.c ../tests/pulse-eval.c -lm && ./pulse-eval FILE
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,8 +39,18 @@ typedef SSIZE_T ssize_t;
 #include <assert.h>
 
 #include "baseband.h"
+#include "pulse_detect_fsk.h"
 #include "write_sigrok.h"
 
+#define MEASURE(label, block)                                              \
+    do {                                                                   \
+        clock_t start = clock();                                           \
+        block;                                                             \
+        clock_t stop   = clock();                                          \
+        double elapsed = (double)(stop - start) * 1000.0 / CLOCKS_PER_SEC; \
+        printf("Time elapsed in ms: %f for: %s\n", elapsed, label);        \
+    } while (0)
+
 static int read_buf(char const *filename, void *buf, size_t nbyte)
 {
     int fd = open(filename, O_RDONLY);
@@ -168,6 +178,47 @@ static int mavgdev_dev(mavgdev_t *a)
 
 // ---
 
+typedef void (*fsk_sample_fn)(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *fsk_pulses);
+typedef void (*fsk_block_fn)(pulse_detect_fsk_t *s, int16_t const *fm_data, int len, pulse_data_t *fsk_pulses);
+
+/// Run an FSK detector per sample and per block over spans of FM data, the results must match.
+static void fsk_eval(char const *label, fsk_sample_fn sample_fn, fsk_block_fn block_fn, int16_t const *fm_data, int len)
+{
+    int const span = 2048; // a typical in-package range
+    static pulse_data_t pulses_a;
+    static pulse_data_t pulses_b;
+    pulse_detect_fsk_t state_a;
+    pulse_detect_fsk_t state_b;
+    unsigned count_a = 0;
+    unsigned count_b = 0;
+    char label_a[64];
+    char label_b[64];
+    snprintf(label_a, sizeof(label_a), "%s per sample", label);
+    snprintf(label_b, sizeof(label_b), "%s block", label);
+
+    MEASURE(label_a,
+            for (int pos = 0; pos + span <= len; pos += span) {
+                pulse_data_clear(&pulses_a);
+                pulse_detect_fsk_init(&state_a);
+                for (int i = 0; i < span; ++i) {
+                    sample_fn(&state_a, fm_data[pos + i], &pulses_a);
+                }
+                count_a += pulses_a.num_pulses;
+            });
+    MEASURE(label_b,
+            for (int pos = 0; pos + span <= len; pos += span) {
+                pulse_data_clear(&pulses_b);
+                pulse_detect_fsk_init(&state_b);
+                block_fn(&state_b, &fm_data[pos], span, &pulses_b);
+                count_b += pulses_b.num_pulses;
+            });
+    if (count_a != count_b || memcmp(&state_a, &state_b, sizeof(state_a))) {
+        fprintf(stderr, "%s: block result mismatch (%u vs %u pulses)\n", label, count_a, count_b);
+    }
+}
+
+// ---
+
 int main(int argc, char *argv[])
 {
     //baseband_init();
@@ -241,6 +292,10 @@ int main(int argc, char *argv[])
     envelope_detect_nolut(cu8_buf, am16_buf, n_samples);
     demodfm_state_t fm_state;
     baseband_demod_FM(&fm_state, cu8_buf, fm16_buf, n_samples, 250000, 0.1f);
+
+    // FSK detectors
+    fsk_eval("FSK classic", pulse_detect_fsk_classic, pulse_detect_fsk_classic_block, fm16_buf, n_samples);
+    fsk_eval("FSK minmax", pulse_detect_fsk_minmax, pulse_detect_fsk_minmax_block, fm16_buf, n_samples);
     // envelope_detect(cu8_buf, y16_buf, n_samples);
     // magnitude_est_cu8(cu8_buf, y16_buf, n_samples);
     // baseband_low_pass_filter(&state, y16_buf, (int16_t *)u16_buf, n_samples);
@@ -0,0 +1,122 @@
+/*
+ * Pulse recorder ring test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pulse_recorder.h"
+#include "pulse_archive.h"
+#include "pulse_data.h"
+#include "pulse_detect.h"
+#include "test_util.h"
+
+#define TIME_START 1700000000000000ll
+#define TIME_STEP 1000000
+
+static void make_package(pulse_data_t *data, unsigned n, unsigned num_pulses)
+{
+    test_make_package(data, n, num_pulses);
+    data->received_us = TIME_START + (int64_t)n * TIME_STEP;
+}
+
+static void add_packages(pulse_recorder_t *rec, unsigned first, unsigned count)
+{
+    pulse_data_t data = {0};
+    for (unsigned n = first; n < first + count; ++n) {
+        make_package(&data, n, 20);
+        CHECK(pulse_recorder_add(rec, &data, n % 2 ? PULSE_DATA_FSK : PULSE_DATA_OOK) == 0);
+    }
+    pulse_data_free(&data);
+}
+
+typedef struct {
+    unsigned first; ///< the package number of the first package replayed
+    unsigned count;
+} replayed_t;
+
+static void check_replayed(void *ctx, pulse_data_t *data, int package_type)
+{
+    replayed_t *r = ctx;
+    unsigned n    = r->first + r->count;
+    CHECK(data->received_us == TIME_START + (int64_t)n * TIME_STEP);
+    CHECK(package_type == (n % 2 ? PULSE_DATA_FSK : PULSE_DATA_OOK));
+    CHECK(data->num_pulses == 20);
+    CHECK(data->offset == (uint64_t)n * 100000);
+    if (data->num_pulses == 20)
+        CHECK(data->gap[19] == (int)(19 * 91 + n) % 2000);
+    r->count += 1;
+}
+
+int main(void)
+{
+    unsigned count;
+    size_t used;
+    unsigned dropped;
+
+    // the packages older than the time kept are dropped
+    pulse_recorder_t *rec = pulse_recorder_create(10, 65536);
+    CHECK(rec != NULL);
+    if (!rec)
+        return 1;
+    add_packages(rec, 0, 30);
+    pulse_recorder_stats(rec, &count, &used, &dropped);
+    CHECK(count == 11);
+    CHECK(dropped == 0);
+
+    // a time range, oldest first
+    replayed_t r = {.first = 22};
+    CHECK(pulse_recorder_replay(rec, TIME_START + 22 * TIME_STEP, TIME_START + 25 * TIME_STEP, check_replayed, &r) == 3);
+    CHECK(r.count == 3);
+    r = (replayed_t){.first = 19};
+    CHECK(pulse_recorder_replay(rec, 0, INT64_MAX, check_replayed, &r) == 11);
+
+    // the archive of a range reads back
+    FILE *file = tmpfile();
+    CHECK(file != NULL);
+    if (file) {
+        CHECK(pulse_recorder_write(rec, file, TIME_START + 25 * TIME_STEP, INT64_MAX) == 5);
+        rewind(file);
+        pulse_archive_t *archive = pulse_archive_open(file);
+        fclose(file);
+        CHECK(archive != NULL);
+        if (archive) {
+            CHECK(pulse_archive_count(archive) == 5);
+            CHECK(pulse_archive_time(archive, 0) == TIME_START + 25 * TIME_STEP);
+            CHECK(pulse_archive_sample_rate(archive) == 250000);
+            pulse_archive_close(archive);
+        }
+    }
+    pulse_recorder_free(rec);
+
+    // the oldest are dropped to make room, the ring wraps
+    rec = pulse_recorder_create(0, 1000);
+    CHECK(rec != NULL);
+    if (!rec)
+        return 1;
+    add_packages(rec, 0, 100);
+    pulse_recorder_stats(rec, &count, &used, &dropped);
+    CHECK(count > 0 && count < 20);
+    CHECK(used <= 1000);
+    r = (replayed_t){.first = 100 - count};
+    CHECK(pulse_recorder_replay(rec, 0, INT64_MAX, check_replayed, &r) == (int)count);
+
+    // a package larger than the ring is not kept
+    pulse_data_t data = {0};
+    make_package(&data, 100, 1000);
+    CHECK(pulse_recorder_add(rec, &data, PULSE_DATA_OOK) == -1);
+    pulse_data_free(&data);
+    pulse_recorder_stats(rec, &count, &used, &dropped);
+    CHECK(dropped == 1);
+    pulse_recorder_free(rec);
+
+    return test_result();
+}
@@ -0,0 +1,88 @@
+/*
+ * RfRaw encoding test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pulse_data.h"
+#include "rfraw.h"
+#include "test_util.h"
+
+// a PWM package at 250 kHz, short 500 us and long 1000 us, with a reset gap
+static void make_pwm(pulse_data_t *data)
+{
+    pulse_data_clear(data);
+    data->sample_rate = 250000;
+    for (unsigned i = 0; i < 24; ++i) {
+        pulse_data_start_pulse(data);
+        int bit        = (0xa5c3f0 >> i) & 1;
+        data->pulse[i] = bit ? 250 : 125 + (int)i % 3; // a little jitter
+        data->gap[i]   = bit ? 125 : 250;
+        data->num_pulses += 1;
+    }
+    data->gap[23] = 2500;
+}
+
+int main(void)
+{
+    static pulse_data_t data;
+    static pulse_data_t parsed;
+
+    make_pwm(&data);
+    char *code = rfraw_encode(&data);
+    CHECK(code != NULL);
+    if (code) {
+        // 3 bins: 500 us, 1000 us, 10000 us, and a byte for each pulse and gap
+        CHECK(strncmp(code, "AAB103", 6) == 0);
+        CHECK(strlen(code) == 2 * (3 + 2 * 3 + 24 + 1));
+        CHECK(strcmp(code + strlen(code) - 2, "55") == 0);
+        CHECK(rfraw_check(code));
+
+        // the code parses back to the same pulses, in us
+        pulse_data_clear(&parsed);
+        CHECK(rfraw_parse(&parsed, code));
+        CHECK(parsed.num_pulses == 24);
+        for (unsigned i = 0; i < parsed.num_pulses && i < 24; ++i) {
+            CHECK(abs(parsed.pulse[i] - data.pulse[i] * 4) <= 8);
+            CHECK(parsed.gap[i] == data.gap[i] * 4);
+        }
+    }
+    free(code);
+
+    // noise with many widths is merged into 8 bins
+    pulse_data_clear(&data);
+    data.sample_rate = 250000;
+    for (unsigned i = 0; i < 40; ++i) {
+        pulse_data_start_pulse(&data);
+        data.pulse[i] = 10 + (int)i * 37;
+        data.gap[i]   = 2000 - (int)i * 29;
+        data.num_pulses += 1;
+    }
+    code = rfraw_encode(&data);
+    CHECK(code != NULL);
+    if (code) {
+        CHECK(strncmp(code, "AAB108", 6) == 0);
+        pulse_data_clear(&parsed);
+        CHECK(rfraw_parse(&parsed, code));
+        CHECK(parsed.num_pulses == 40);
+    }
+    free(code);
+
+    // nothing to encode
+    pulse_data_clear(&data);
+    CHECK(rfraw_encode(&data) == NULL);
+
+    pulse_data_free(&data);
+    pulse_data_free(&parsed);
+
+    return test_result();
+}
@@ -0,0 +1,167 @@
+/*
+ * rtl_tcp compressed transport test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rtltcp_codec.h"
+#include "test_util.h"
+
+#define FRAME_LEN 16384
+
+static uint8_t frame[FRAME_LEN + 1];
+static uint8_t decoded[FRAME_LEN + 1];
+
+// noise of a given swing around the center
+static void fill_noise(uint8_t *buf, unsigned len, int swing)
+{
+    for (unsigned i = 0; i < len; ++i) {
+        buf[i] = (uint8_t)(128 - swing + rand() % (2 * swing));
+    }
+}
+
+// a strong carrier in noise
+static void fill_signal(uint8_t *buf, unsigned len)
+{
+    static int const cos8[] = {100, 71, 0, -71, -100, -71, 0, 71};
+    for (unsigned i = 0; i < len; i += 2) {
+        buf[i]     = (uint8_t)(128 + cos8[(i / 2) % 8] + rand() % 5 - 2);
+        buf[i + 1] = (uint8_t)(128 + cos8[(i / 2 + 2) % 8] + rand() % 5 - 2);
+    }
+}
+
+// encode and decode a frame, returns the block length or 0 on failure
+static uint32_t roundtrip(rtltcp_codec_t *enc, rtltcp_codec_t *dec, uint8_t const *data, uint32_t len)
+{
+    uint32_t block_len = 0;
+    uint8_t const *block = rtltcp_codec_encode(enc, data, len, &block_len);
+    CHECK(block);
+    if (!block)
+        return 0;
+    uint32_t raw_len, payload_len;
+    CHECK(rtltcp_codec_header(block, &raw_len, &payload_len) == 0);
+    CHECK(raw_len == len);
+    CHECK(payload_len + RTLTCP_CODEC_HEADER == block_len);
+    memset(decoded, 0, sizeof(decoded));
+    CHECK(rtltcp_codec_decode(dec, block, &block[RTLTCP_CODEC_HEADER], decoded) == 0);
+    return block_len;
+}
+
+static void test_nibble(void)
+{
+    rtltcp_codec_t *enc = rtltcp_codec_create(RTLTCP_COMPRESS_NIBBLE);
+    rtltcp_codec_t *dec = rtltcp_codec_create(RTLTCP_COMPRESS_NIBBLE);
+    CHECK(enc && dec);
+    if (!enc || !dec)
+        return;
+
+    // quiet noise fits 4 bits exactly
+    fill_noise(frame, FRAME_LEN, 8);
+    uint32_t len = roundtrip(enc, dec, frame, FRAME_LEN);
+    CHECK(len == RTLTCP_CODEC_HEADER + FRAME_LEN / 2);
+    CHECK(!memcmp(frame, decoded, FRAME_LEN));
+
+    // louder noise is requantized within half a step, an odd length is padded
+    fill_noise(frame, FRAME_LEN + 1, 30);
+    len = roundtrip(enc, dec, frame, FRAME_LEN + 1);
+    CHECK(len == RTLTCP_CODEC_HEADER + FRAME_LEN / 2 + 1);
+    int worst = 0;
+    for (unsigned i = 0; i < FRAME_LEN + 1; ++i) {
+        int err = abs(frame[i] - decoded[i]);
+        worst   = err > worst ? err : worst;
+    }
+    CHECK(worst <= 2);
+
+    // a signal is sent as is
+    fill_signal(frame, FRAME_LEN);
+    len = roundtrip(enc, dec, frame, FRAME_LEN);
+    CHECK(len == RTLTCP_CODEC_HEADER + FRAME_LEN);
+    CHECK(!memcmp(frame, decoded, FRAME_LEN));
+
+    rtltcp_codec_free(enc);
+    rtltcp_codec_free(dec);
+}
+
+static void test_zstd(void)
+{
+    if (!(rtltcp_codec_methods() & RTLTCP_COMPRESS_ZSTD)) {
+        CHECK(!rtltcp_codec_create(RTLTCP_COMPRESS_ZSTD));
+        return;
+    }
+    rtltcp_codec_t *enc = rtltcp_codec_create(RTLTCP_COMPRESS_ZSTD);
+    rtltcp_codec_t *dec = rtltcp_codec_create(RTLTCP_COMPRESS_ZSTD);
+    CHECK(enc && dec);
+    if (!enc || !dec)
+        return;
+
+    // lossless for noise and signals
+    fill_noise(frame, FRAME_LEN, 6);
+    uint32_t len = roundtrip(enc, dec, frame, FRAME_LEN);
+    CHECK(len > 0 && len < FRAME_LEN * 3 / 4);
+    CHECK(!memcmp(frame, decoded, FRAME_LEN));
+
+    fill_signal(frame, FRAME_LEN);
+    len = roundtrip(enc, dec, frame, FRAME_LEN);
+    CHECK(len > 0 && len <= RTLTCP_CODEC_HEADER + FRAME_LEN);
+    CHECK(!memcmp(frame, decoded, FRAME_LEN));
+
+    // random data is sent raw
+    for (unsigned i = 0; i < FRAME_LEN; ++i)
+        frame[i] = (uint8_t)rand();
+    len = roundtrip(enc, dec, frame, FRAME_LEN);
+    CHECK(len == RTLTCP_CODEC_HEADER + FRAME_LEN);
+    CHECK(!memcmp(frame, decoded, FRAME_LEN));
+
+    rtltcp_codec_free(enc);
+    rtltcp_codec_free(dec);
+}
+
+static void test_negotiation(void)
+{
+    unsigned offered = rtltcp_codec_parse(NULL);
+    CHECK(offered & RTLTCP_COMPRESS_NIBBLE);
+    CHECK(rtltcp_codec_parse("4bit") == RTLTCP_COMPRESS_NIBBLE);
+    CHECK(rtltcp_codec_parse("lz4") == 0);
+    CHECK(rtltcp_codec_choose(RTLTCP_COMPRESS_NIBBLE) == RTLTCP_COMPRESS_NIBBLE);
+    CHECK(rtltcp_codec_choose(0) == 0);
+
+    uint8_t ack[RTLTCP_CODEC_HEADER];
+    rtltcp_codec_ack(ack, RTLTCP_COMPRESS_NIBBLE);
+    CHECK(rtltcp_codec_parse_ack(ack, offered) == RTLTCP_COMPRESS_NIBBLE);
+    CHECK(rtltcp_codec_parse_ack(ack, RTLTCP_COMPRESS_ZSTD) == -1);
+    rtltcp_codec_ack(ack, 0);
+    CHECK(rtltcp_codec_parse_ack(ack, offered) == 0);
+
+    // the raw samples of a stock server are not an ack
+    fill_noise(ack, sizeof(ack), 20);
+    CHECK(rtltcp_codec_parse_ack(ack, offered) == -1);
+
+    // corrupt block headers are rejected
+    uint8_t header[RTLTCP_CODEC_HEADER] = {9, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0};
+    uint32_t raw_len, payload_len;
+    CHECK(rtltcp_codec_header(header, &raw_len, &payload_len) == -1);
+    header[0] = 2; // 4 bit with a wrong payload length
+    CHECK(rtltcp_codec_header(header, &raw_len, &payload_len) == -1);
+    header[10] = 0;
+    header[11] = 0x80;
+    CHECK(rtltcp_codec_header(header, &raw_len, &payload_len) == 0);
+}
+
+int main(void)
+{
+    srand(433);
+    test_nibble();
+    test_zstd();
+    test_negotiation();
+
+    return test_result();
+}
@@ -0,0 +1,118 @@
+/*
+ * Last-known sensor state test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "sensor_state.h"
+#include "test_util.h"
+
+static data_t const *find(data_t const *data, char const *key)
+{
+    for (; data; data = data->next) {
+        if (!strcmp(data->key, key))
+            return data;
+    }
+    return NULL;
+}
+
+static void update(sensor_state_t *state, int id, int temperature, char const *time_str)
+{
+    char key[64];
+    snprintf(key, sizeof(key), "Acurite-Tower|%d|A", id);
+    /* clang-format off */
+    data_t *data = data_make(
+            "model",        "", DATA_STRING, "Acurite-Tower",
+            "id",           "", DATA_INT,    id,
+            "channel",      "", DATA_STRING, "A",
+            "temperature_C", "", DATA_INT,   temperature,
+            NULL);
+    /* clang-format on */
+    sensor_state_update(state, key, data, time_str, -12.5f, 20.0f);
+    data_free(data); // the table keeps the event
+}
+
+// the ids of the sensors in the snapshot, from the most recently heard on
+static int snapshot_ids(sensor_state_t *state, int *ids, int size)
+{
+    data_t *data = sensor_state_data(state);
+    CHECK(data);
+    if (!data)
+        return -1;
+    data_array_t const *sensors = find(data, "devices")->value.v_ptr;
+    int n = 0;
+    for (; n < sensors->num_values && n < size; ++n) {
+        data_t const *sensor = ((data_t **)sensors->values)[n];
+        data_t const *event  = find(sensor, "event")->value.v_ptr;
+        ids[n]               = find(event, "id")->value.v_int;
+    }
+    CHECK(find(data, "count")->value.v_int == n);
+    data_free(data);
+    return n;
+}
+
+static void test_lru(void)
+{
+    sensor_state_t *state = sensor_state_create(3);
+    CHECK(state);
+    if (!state)
+        return;
+    update(state, 1, 20, "2026-10-15 12:00:01");
+    update(state, 2, 21, "2026-10-15 12:00:02");
+    update(state, 3, 22, "2026-10-15 12:00:03");
+    update(state, 1, 23, "2026-10-15 12:00:04");
+    // the sensor not heard the longest is evicted
+    update(state, 4, 24, "2026-10-15 12:00:05");
+    CHECK(sensor_state_sensors(state) == 3);
+    CHECK(sensor_state_evicted(state) == 1);
+
+    int ids[8];
+    int n = snapshot_ids(state, ids, 8);
+    CHECK(n == 3);
+    CHECK(n == 3 && ids[0] == 4 && ids[1] == 1 && ids[2] == 3);
+
+    data_t *data = sensor_state_data(state);
+    data_array_t const *sensors = find(data, "devices")->value.v_ptr;
+    data_t const *sensor        = ((data_t **)sensors->values)[1];
+    CHECK(find(sensor, "count")->value.v_int == 2);
+    CHECK(!strcmp(find(sensor, "time")->value.v_ptr, "2026-10-15 12:00:04"));
+    CHECK(find(find(sensor, "event")->value.v_ptr, "temperature_C")->value.v_int == 23);
+    data_free(data);
+    sensor_state_free(state);
+}
+
+static void test_many(void)
+{
+    sensor_state_t *state = sensor_state_create(100);
+    CHECK(state);
+    if (!state)
+        return;
+    // TPMS of passing cars, the table keeps the latest sensors
+    for (int i = 0; i < 10000; ++i) {
+        update(state, i % 3 ? i : 7, i, "2026-10-15 12:00:00");
+    }
+    CHECK(sensor_state_sensors(state) == 100);
+    int ids[100];
+    int n = snapshot_ids(state, ids, 100);
+    CHECK(n == 100);
+    CHECK(ids[0] == 7 && ids[1] == 9998 && ids[2] == 9997);
+    sensor_state_free(state);
+}
+
+int main(void)
+{
+    test_lru();
+    test_many();
+
+    return test_result();
+}
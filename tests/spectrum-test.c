@@ -0,0 +1,101 @@
+/*
+ * Spectrum occupancy monitor test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "spectrum.h"
+#include "test_util.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BUF_SAMPLES 16384
+#define STRIDE 2048
+
+static int16_t buf[2 * BUF_SAMPLES];
+
+// about gaussian noise from a sum of uniform values
+static float noise(float amp)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        sum += (float)rand() / RAND_MAX - 0.5f;
+    }
+    return sum * amp;
+}
+
+// noise at about -40 dB FS and an optional tone at a bin
+static void fill(int tone_bin, float tone_amp, unsigned *phase)
+{
+    for (unsigned i = 0; i < BUF_SAMPLES; ++i) {
+        float si = noise(655.0f);
+        float sq = noise(655.0f);
+        if (tone_bin) {
+            double a = 2.0 * M_PI * tone_bin * (*phase + i) / SPECTRUM_BINS;
+            si += tone_amp * (float)cos(a);
+            sq += tone_amp * (float)sin(a);
+        }
+        buf[2 * i]     = (int16_t)si;
+        buf[2 * i + 1] = (int16_t)sq;
+    }
+    *phase += BUF_SAMPLES;
+}
+
+int main(void)
+{
+    spectrum_t *sp = spectrum_create(STRIDE, 10.0f);
+    CHECK(sp);
+    if (!sp)
+        return 1;
+
+    unsigned phase = 0;
+    // let the noise floor settle
+    for (int n = 0; n < 50; ++n) {
+        fill(0, 0.0f, &phase);
+        spectrum_process(sp, buf, 4, BUF_SAMPLES);
+    }
+    // noise alone rarely occupies a bin
+    spectrum_flush(sp);
+    unsigned false_active = 0;
+    for (int n = 0; n < 100; ++n) {
+        fill(0, 0.0f, &phase);
+        spectrum_process(sp, buf, 4, BUF_SAMPLES);
+        false_active += spectrum_active(sp, SPECTRUM_BINS / 2, SPECTRUM_BINS / 2, 0);
+    }
+    fprintf(stderr, "noise: %u of 100 buffers active, noise floor %.1f dB\n", false_active, spectrum_noise_db(sp, 10));
+    CHECK(false_active <= 2);
+    CHECK(spectrum_noise_db(sp, 10) < -40.0f && spectrum_noise_db(sp, 10) > -80.0f);
+
+    // a strong tone at bin 40
+    fill(40, 6550.0f, &phase);
+    spectrum_process(sp, buf, 4, BUF_SAMPLES);
+    CHECK(spectrum_active(sp, 40, 2, 0));
+    CHECK(spectrum_active(sp, spectrum_bin(40 * 1000, SPECTRUM_BINS * 1000), 2, 0));
+    CHECK(!spectrum_active(sp, 200, 8, 0));
+    CHECK(spectrum_level_db(sp, 40) > spectrum_noise_db(sp, 40) + 3.0f);
+    CHECK(spectrum_occupancy(sp, 40) > 0.0f);
+
+    // the tone is held, then released
+    fill(0, 0.0f, &phase);
+    spectrum_process(sp, buf, 4, BUF_SAMPLES);
+    CHECK(spectrum_active(sp, 40, 2, BUF_SAMPLES));
+    CHECK(!spectrum_active(sp, 40, 2, 0));
+
+    // a negative offset wraps to the upper bins
+    CHECK(spectrum_bin(-1000, SPECTRUM_BINS * 1000) == SPECTRUM_BINS - 1);
+
+    spectrum_free(sp);
+
+    return test_result();
+}
@@ -0,0 +1,59 @@
+/*
+ * Checks and fixtures shared by the unit tests
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TESTS_TEST_UTIL_H_
+#define TESTS_TEST_UTIL_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "pulse_data.h"
+
+/// Number of failed checks of the test.
+static int failed;
+
+/// Count and report a failed check, the test goes on.
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "TEST failed: %s (line %d)\n", #cond, __LINE__); \
+            failed++;                                                        \
+        }                                                                    \
+    } while (0)
+
+/// Report the failed checks, returns the exit code of the test.
+static inline int test_result(void)
+{
+    if (!failed)
+        return 0;
+    fprintf(stderr, "%d FAILED\n", failed);
+    return 1;
+}
+
+/// A package of OOK pulses that differs with each number n, the 6th gap is long to use all lengths of the encodings.
+static inline void test_make_package(pulse_data_t *data, unsigned n, unsigned num_pulses)
+{
+    pulse_data_clear(data);
+    data->offset        = (uint64_t)n * 100000;
+    data->sample_rate   = 250000;
+    data->depth_bits    = 8;
+    data->centerfreq_hz = 433920000.0f;
+    data->rssi_db       = -(float)n / 10;
+    data->fsk_f2_est    = n % 3 == 0 ? 1234 : 0;
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        pulse_data_start_pulse(data);
+        data->pulse[i] = (int)(i * 37 + n) % 500;
+        data->gap[i]   = i == 5 ? 300000 + (int)n : (int)(i * 91 + n) % 2000;
+        data->num_pulses += 1;
+    }
+}
+
+#endif /* TESTS_TEST_UTIL_H_ */
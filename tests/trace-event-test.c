@@ -0,0 +1,68 @@
+/*
+ * Trace event test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "trace_event.h"
+#include "test_util.h"
+
+static size_t read_file(char const *path, char *buf, size_t size)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return 0;
+    size_t len = fread(buf, 1, size - 1, file);
+    buf[len] = '\0';
+    fclose(file);
+    return len;
+}
+
+int main(void)
+{
+    char const *path = "trace-event-test.json";
+    char buf[4096];
+
+    // an idle trace writes nothing
+    CHECK(trace_event_active(NULL) == 0);
+    trace_event_t *trace = trace_event_create();
+    CHECK(trace != NULL);
+    CHECK(trace_event_active(trace) == 0);
+    trace_event_span(trace, "idle", "test", 1, 0, 1000);
+
+    // spans and counters in us since the start
+    CHECK(trace_event_start(trace, path, 0) == 0);
+    CHECK(trace_event_active(trace) == 1);
+    trace_event_thread_name(trace, 1, "demod");
+    trace_event_span(trace, "baseband", "dsp", 1, 0, 0);
+    trace_event_counter(trace, "noise dB", 0, -23.5);
+    CHECK(trace_event_stop(trace) == 3);
+    CHECK(trace_event_active(trace) == 0);
+
+    CHECK(read_file(path, buf, sizeof(buf)) > 0);
+    CHECK(buf[0] == '[');
+    CHECK(strstr(buf, "\"args\":{\"name\":\"demod\"}") != NULL);
+    CHECK(strstr(buf, "{\"name\":\"baseband\",\"cat\":\"dsp\",\"ph\":\"X\",\"ts\":0.000,\"dur\":0.000,\"pid\":1,\"tid\":1},\n") != NULL);
+    CHECK(strstr(buf, "\"ph\":\"C\"") != NULL);
+    CHECK(strstr(buf, "{\"value\":-23.5}}\n]\n") != NULL);
+    CHECK(strstr(buf, "idle") == NULL);
+
+    // a new start truncates the file
+    CHECK(trace_event_start(trace, path, 0) == 0);
+    CHECK(trace_event_stop(trace) == 0);
+    CHECK(read_file(path, buf, sizeof(buf)) > 0);
+    CHECK(!strcmp(buf, "[\n\n]\n"));
+
+    trace_event_free(trace);
+    remove(path);
+
+    return test_result();
+}
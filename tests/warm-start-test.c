@@ -0,0 +1,109 @@
+/*
+ * Warm start state test
+ *
+ * Copyright (C) 2026 by the rtl_433 contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "r_private.h"
+#include "warm_start.h"
+#include "test_util.h"
+
+static detect_state_t make_state(uint32_t frequency, int ook_high)
+{
+    detect_state_t state = {0};
+    state.frequency                = frequency;
+    state.noise_level              = -21.5f;
+    state.min_level_auto           = -18.25f;
+    state.levels.ook_low_estimate  = 120;
+    state.levels.ook_high_estimate = ook_high;
+    state.levels.lead_in_counter   = 1024;
+    return state;
+}
+
+int main(void)
+{
+    char path[] = "warm-start-test.txt";
+    remove(path);
+
+    // a missing file starts empty
+    warm_start_t *warm = warm_start_create(path);
+    CHECK(warm != NULL);
+    detect_state_t states[4];
+    CHECK(warm_start_restore(warm, "00000001 gain=auto magest", states, 4) == 0);
+    CHECK(states[0].frequency == 0);
+
+    // nothing kept, nothing written
+    CHECK(warm_start_save(warm) == 0);
+    FILE *file = fopen(path, "r");
+    CHECK(file == NULL);
+    if (file)
+        fclose(file);
+
+    detect_state_t kept[3] = {make_state(433920000, 9000), {0}, make_state(868300000, 7000)};
+    warm_start_keep(warm, "00000001 gain=auto magest", kept, 3);
+    detect_state_t other = make_state(315000000, 5000);
+    warm_start_keep(warm, "00000002 gain=40 magest", &other, 1);
+    // keeping a frequency again replaces it
+    kept[0].levels.ook_high_estimate = 9500;
+    warm_start_keep(warm, "00000001 gain=auto magest", kept, 1);
+    CHECK(warm_start_save(warm) == 0);
+    warm_start_free(warm);
+
+    // the states are read back by receiver
+    warm = warm_start_create(path);
+    CHECK(warm != NULL);
+    CHECK(warm_start_restore(warm, "00000001 gain=auto magest", states, 4) == 2);
+    int found = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (states[i].frequency == 433920000) {
+            CHECK(states[i].levels.ook_high_estimate == 9500);
+            CHECK(states[i].levels.ook_low_estimate == 120);
+            CHECK(states[i].levels.lead_in_counter == 1024);
+            CHECK(states[i].noise_level == -21.5f);
+            CHECK(states[i].min_level_auto == -18.25f);
+            found++;
+        }
+        if (states[i].frequency == 868300000) {
+            CHECK(states[i].levels.ook_high_estimate == 7000);
+            found++;
+        }
+    }
+    CHECK(found == 2);
+    CHECK(states[2].frequency == 0);
+    CHECK(warm_start_restore(warm, "00000002 gain=40 magest", states, 4) == 1);
+    CHECK(states[0].frequency == 315000000);
+    CHECK(warm_start_restore(warm, "00000002 gain=auto magest", states, 4) == 0);
+
+    // the least recently kept states are displaced
+    for (uint32_t f = 1; f <= 300; ++f) {
+        detect_state_t state = make_state(f * 1000, (int)f);
+        warm_start_keep(warm, "00000003 gain=auto magest", &state, 1);
+    }
+    CHECK(warm_start_restore(warm, "00000001 gain=auto magest", states, 4) == 0);
+    warm_start_free(warm);
+
+    // bad lines are skipped
+    file = fopen(path, "w");
+    CHECK(file != NULL);
+    if (file) {
+        fprintf(file, "# comment\nbroken line\nrx\tnot a number\nrx\t915000000\t-20.00\t-17.00\t100\t8000\t512\n");
+        fclose(file);
+    }
+    warm = warm_start_create(path);
+    CHECK(warm_start_restore(warm, "rx", states, 4) == 1);
+    CHECK(states[0].frequency == 915000000);
+    CHECK(states[0].levels.ook_high_estimate == 8000);
+    warm_start_free(warm);
+    remove(path);
+
+    return test_result();
+}